@@ -0,0 +1,321 @@
+#include "AnalysisCache.h"
+#include "../../Utils/PlatformPaths.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+constexpr char entryMagic[4] = {'H', 'T', 'A', 'C'};
+constexpr int entryVersion = 2; // 2: note clips
+
+// Limits on counts read back, so a corrupt entry cannot request huge buffers
+constexpr juce::int64 maxFrames = 1ll << 28;
+constexpr int maxNotes = 1 << 22;
+
+bool readBytes(juce::InputStream &in, void *dest, size_t numBytes) {
+  return static_cast<size_t>(in.read(dest, numBytes)) == numBytes;
+}
+
+// How a note's waveform clip is stored
+enum class ClipKind { None, View, Owned };
+
+// A note as read back, before its clips are bound to the project's audio
+struct StoredNote {
+  int start = 0;
+  int end = 0;
+  float midi = 0.0f;
+  ClipKind waveformKind = ClipKind::None;
+  int waveformOffset = 0; // View: range of the render snapshot
+  int waveformSize = 0;
+  std::vector<float> waveformSamples; // Owned
+  juce::int64 melOffset = -1; // -1: no mel clip
+  juce::int64 melFrames = 0;
+};
+
+void writeClips(juce::OutputStream &out, const Note &note) {
+  const auto &clip = note.getClipWaveform();
+  if (clip.empty()) {
+    out.writeByte(static_cast<char>(ClipKind::None));
+  } else if (clip.getOwnedStorage() == nullptr) {
+    out.writeByte(static_cast<char>(ClipKind::View));
+    out.writeInt(clip.getOffset());
+    out.writeInt(clip.size());
+  } else {
+    const auto samples = clip.toVector();
+    out.writeByte(static_cast<char>(ClipKind::Owned));
+    out.writeInt(static_cast<int>(samples.size()));
+    out.write(samples.data(), samples.size() * sizeof(float));
+  }
+
+  const auto &mel = note.getClipMel();
+  out.writeInt64(mel.empty() ? -1 : static_cast<juce::int64>(mel.getOffset()));
+  out.writeInt64(static_cast<juce::int64>(mel.size()));
+}
+
+bool readClips(juce::InputStream &in, StoredNote &note) {
+  note.waveformKind = static_cast<ClipKind>(in.readByte());
+  switch (note.waveformKind) {
+  case ClipKind::None:
+    break;
+  case ClipKind::View:
+    note.waveformOffset = in.readInt();
+    note.waveformSize = in.readInt();
+    if (note.waveformOffset < 0 || note.waveformSize < 0)
+      return false;
+    break;
+  case ClipKind::Owned: {
+    const int size = in.readInt();
+    if (size < 0 || size > maxFrames)
+      return false;
+    note.waveformSamples.resize(static_cast<size_t>(size));
+    if (!readBytes(in, note.waveformSamples.data(),
+                   note.waveformSamples.size() * sizeof(float)))
+      return false;
+    break;
+  }
+  default:
+    return false;
+  }
+
+  note.melOffset = in.readInt64();
+  note.melFrames = in.readInt64();
+  return note.melOffset >= -1 && note.melFrames >= 0;
+}
+} // namespace
+
+juce::String AnalysisCache::Key::getFileName() const {
+  const auto id = audioHash + "|" + juce::String(sampleRate) + "|" +
+                  pitchDetectorTypeToString(detector) + "|" + modelVersion;
+  return juce::SHA256(id.toUTF8()).toHexString() + ".htac";
+}
+
+AnalysisCache::AnalysisCache(juce::File directoryIn, juce::int64 maxBytesIn)
+    : directory(std::move(directoryIn)), maxBytes(maxBytesIn) {}
+
+juce::File AnalysisCache::getDefaultDirectory() {
+  return PlatformPaths::getCacheDirectory().getChildFile("analysis");
+}
+
+juce::String
+AnalysisCache::hashAudio(const juce::AudioBuffer<float> &waveform) {
+  const auto channelBytes =
+      static_cast<size_t>(waveform.getNumSamples()) * sizeof(float);
+  if (waveform.getNumChannels() == 1)
+    return juce::SHA256(waveform.getReadPointer(0), channelBytes).toHexString();
+
+  // Hash each channel, then the concatenated digests
+  juce::String digests;
+  for (int ch = 0; ch < waveform.getNumChannels(); ++ch)
+    digests << juce::SHA256(waveform.getReadPointer(ch), channelBytes)
+                   .toHexString();
+  return juce::SHA256(digests.toUTF8()).toHexString();
+}
+
+juce::File AnalysisCache::getEntryFile(const Key &key) const {
+  return directory.getChildFile(key.getFileName());
+}
+
+bool AnalysisCache::load(const Key &key, Project &project) const {
+  const auto file = getEntryFile(key);
+  if (!file.existsAsFile())
+    return false;
+
+  juce::FileInputStream in(file);
+  if (!in.openedOk())
+    return false;
+
+  char magic[sizeof(entryMagic)] = {};
+  if (!readBytes(in, magic, sizeof(magic)) ||
+      std::memcmp(magic, entryMagic, sizeof(magic)) != 0 ||
+      in.readInt() != entryVersion || in.readString() != key.audioHash)
+    return false;
+
+  // Read into a scratch copy so a truncated entry changes nothing
+  AudioData analysed;
+  const int mels = in.readInt();
+  const auto melFrames = in.readInt64();
+  if (mels <= 0 || melFrames < 0 || melFrames > maxFrames)
+    return false;
+  analysed.melSpectrogram.reset(static_cast<size_t>(melFrames), mels);
+  if (!readBytes(in, analysed.melSpectrogram.data(),
+                 analysed.melSpectrogram.getNumBytes()))
+    return false;
+
+  const auto f0Frames = in.readInt64();
+  if (f0Frames < 0 || f0Frames > maxFrames)
+    return false;
+  analysed.f0.resize(static_cast<size_t>(f0Frames));
+  if (!readBytes(in, analysed.f0.data(), analysed.f0.size() * sizeof(float)))
+    return false;
+
+  const auto voicedFrames = in.readInt64();
+  if (voicedFrames < 0 || voicedFrames > maxFrames)
+    return false;
+  std::vector<uint64_t> words(static_cast<size_t>((voicedFrames + 63) / 64));
+  if (!readBytes(in, words.data(), words.size() * sizeof(uint64_t)))
+    return false;
+  analysed.voicedMask.assignWords(words.data(),
+                                  static_cast<size_t>(voicedFrames));
+
+  const int numNotes = in.readInt();
+  if (numNotes < 0 || numNotes > maxNotes)
+    return false;
+  auto &audioData = project.getAudioData();
+  const int numSamples = audioData.waveform.getNumSamples();
+  std::vector<StoredNote> storedNotes(static_cast<size_t>(numNotes));
+  for (auto &note : storedNotes) {
+    note.start = in.readInt();
+    note.end = in.readInt();
+    note.midi = in.readFloat();
+    if (note.start < 0 || note.end <= note.start ||
+        note.end > static_cast<int>(f0Frames) || !readClips(in, note))
+      return false;
+    if (note.waveformKind == ClipKind::View &&
+        note.waveformSize > numSamples - note.waveformOffset)
+      return false;
+    if (note.melOffset >= 0 && note.melFrames > melFrames - note.melOffset)
+      return false;
+  }
+  if (in.getStatus().failed())
+    return false;
+
+  audioData.melSpectrogram = std::move(analysed.melSpectrogram);
+  audioData.f0 = std::move(analysed.f0);
+  audioData.voicedMask = std::move(analysed.voicedMask);
+
+  // Clips view these as the analysis made them, rather than copying slices
+  const auto sourceSnapshot = audioData.getRenderSnapshot();
+  const auto sourceMel =
+      std::make_shared<const HalfMelBuffer>(audioData.melSpectrogram.view());
+
+  project.clearNotes();
+  for (auto &stored : storedNotes) {
+    Note note(stored.start, stored.end, stored.midi);
+    note.setF0Values(std::vector<float>(audioData.f0.begin() + stored.start,
+                                        audioData.f0.begin() + stored.end));
+    if (stored.waveformKind == ClipKind::View)
+      note.setClipWaveform(WaveformClip(
+          sourceSnapshot, stored.waveformOffset,
+          stored.waveformOffset + stored.waveformSize));
+    else if (stored.waveformKind == ClipKind::Owned)
+      note.setClipWaveform(WaveformClip(std::move(stored.waveformSamples)));
+    if (stored.melOffset >= 0 && stored.melFrames > 0)
+      note.setClipMel(MelClip(
+          sourceMel, static_cast<size_t>(stored.melOffset),
+          static_cast<size_t>(stored.melOffset + stored.melFrames)));
+    project.addNote(std::move(note));
+  }
+
+  // Keep recently used entries when pruning
+  file.setLastModificationTime(juce::Time::getCurrentTime());
+  return true;
+}
+
+bool AnalysisCache::store(const Key &key, const Project &project) const {
+  if (!directory.createDirectory())
+    return false;
+
+  const auto &audioData = project.getAudioData();
+  const auto file = getEntryFile(key);
+  juce::TemporaryFile temp(file);
+  {
+    juce::FileOutputStream out(temp.getFile());
+    if (!out.openedOk())
+      return false;
+
+    out.write(entryMagic, sizeof(entryMagic));
+    out.writeInt(entryVersion);
+    out.writeString(key.audioHash);
+
+    const auto &mel = audioData.melSpectrogram;
+    out.writeInt(mel.getNumMels());
+    out.writeInt64(static_cast<juce::int64>(mel.size()));
+    out.write(mel.data(), mel.getNumBytes());
+
+    out.writeInt64(static_cast<juce::int64>(audioData.f0.size()));
+    out.write(audioData.f0.data(), audioData.f0.size() * sizeof(float));
+
+    const auto &voiced = audioData.voicedMask;
+    out.writeInt64(static_cast<juce::int64>(voiced.size()));
+    out.write(voiced.getWords(), voiced.getNumWords() * sizeof(uint64_t));
+
+    // Detected notes only; edits are not analysis results
+    const auto &notes = project.getNotes();
+    out.writeInt(static_cast<int>(notes.size()));
+    for (const auto &note : notes) {
+      out.writeInt(note.getSrcStartFrame());
+      out.writeInt(note.getSrcEndFrame());
+      out.writeFloat(note.getMidiNote());
+      writeClips(out, note);
+    }
+
+    out.flush();
+    if (out.getStatus().failed())
+      return false;
+  }
+
+  if (!temp.overwriteTargetFileWithTemporary())
+    return false;
+
+  prune();
+  return true;
+}
+
+juce::File AnalysisCache::getEntryFile(const juce::String &fileName) const {
+  // Names may come from a host session, so never a path
+  if (!fileName.endsWith(".htac") ||
+      juce::File::createLegalFileName(fileName) != fileName ||
+      fileName.startsWithChar('.'))
+    return {};
+  return directory.getChildFile(fileName);
+}
+
+juce::MemoryBlock
+AnalysisCache::exportEntry(const juce::String &fileName) const {
+  juce::MemoryBlock bytes;
+  const auto file = getEntryFile(fileName);
+  if (file != juce::File() && file.existsAsFile())
+    file.loadFileAsData(bytes);
+  return bytes;
+}
+
+bool AnalysisCache::importEntry(const juce::String &fileName,
+                                const juce::MemoryBlock &bytes) const {
+  const auto file = getEntryFile(fileName);
+  if (file == juce::File() || bytes.getSize() < sizeof(entryMagic) ||
+      std::memcmp(bytes.getData(), entryMagic, sizeof(entryMagic)) != 0)
+    return false;
+  if (file.existsAsFile())
+    return true;
+  if (!directory.createDirectory())
+    return false;
+
+  juce::TemporaryFile temp(file);
+  if (!temp.getFile().replaceWithData(bytes.getData(), bytes.getSize()) ||
+      !temp.overwriteTargetFileWithTemporary())
+    return false;
+
+  prune();
+  return true;
+}
+
+void AnalysisCache::prune() const {
+  auto entries = directory.findChildFiles(juce::File::findFiles, false,
+                                          "*.htac");
+  juce::int64 total = 0;
+  for (const auto &entry : entries)
+    total += entry.getSize();
+  if (total <= maxBytes)
+    return;
+
+  // Oldest first; load() touches entries it reads
+  std::sort(entries.begin(), entries.end(),
+            [](const juce::File &a, const juce::File &b) {
+              return a.getLastModificationTime() < b.getLastModificationTime();
+            });
+  for (const auto &entry : entries) {
+    if (total <= maxBytes)
+      break;
+    total -= entry.getSize();
+    entry.deleteFile();
+  }
+}
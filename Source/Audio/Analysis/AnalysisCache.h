@@ -0,0 +1,72 @@
+#pragma once
+
+#include "../../JuceHeader.h"
+#include "../../Models/Project.h"
+#include "../PitchDetectorType.h"
+
+/**
+ * Persistent cache of analysis results (mel, F0, voiced mask and detected
+ * notes with their waveform and mel clips) so reopening an unchanged file
+ * skips mel/F0/SOME inference.
+ *
+ * Entries are keyed by a hash of the analysed samples together with the
+ * sample rate, pitch detector and a model version string; any change to
+ * these simply misses. Each entry is one binary file in the cache
+ * directory, and the least recently used files are removed once the
+ * directory exceeds its size limit.
+ *
+ * Stateless apart from the directory; safe to use from any thread as long
+ * as two threads do not store the same key at once.
+ */
+class AnalysisCache {
+public:
+  struct Key {
+    juce::String audioHash;
+    int sampleRate = 0;
+    PitchDetectorType detector = PitchDetectorType::RMVPE;
+    juce::String modelVersion; // Model files and analysis settings
+
+    juce::String getFileName() const;
+  };
+
+  explicit AnalysisCache(juce::File directory = getDefaultDirectory(),
+                         juce::int64 maxBytes = 2048ll * 1024 * 1024);
+
+  static juce::File getDefaultDirectory();
+
+  /** SHA-256 of all channels of the waveform, as hex. */
+  static juce::String hashAudio(const juce::AudioBuffer<float> &waveform);
+
+  /**
+   * Restore mel, F0, voiced mask and notes into project. Clips that viewed
+   * the analysed audio view the project's render snapshot and mel again, as
+   * after an analysis. Returns false on a miss or an unreadable entry,
+   * leaving project untouched.
+   */
+  bool load(const Key &key, Project &project) const;
+
+  /** Write the project's analysis results under key. */
+  bool store(const Key &key, const Project &project) const;
+
+  /**
+   * The stored bytes of the entry named fileName (Key::getFileName()), so
+   * they can travel elsewhere, such as a host session. Empty on a miss.
+   */
+  juce::MemoryBlock exportEntry(const juce::String &fileName) const;
+
+  /**
+   * Store bytes from exportEntry() under fileName, unless that entry exists
+   * already. Bytes without the entry magic are rejected.
+   */
+  bool importEntry(const juce::String &fileName,
+                   const juce::MemoryBlock &bytes) const;
+
+private:
+  juce::File getEntryFile(const Key &key) const;
+  // Null File unless fileName is a plain entry name inside directory
+  juce::File getEntryFile(const juce::String &fileName) const;
+  void prune() const;
+
+  juce::File directory;
+  juce::int64 maxBytes;
+};
@@ -1,14 +1,14 @@
 #include "AudioAnalyzer.h"
 #include "../../Utils/Constants.h"
 #include "../../Utils/PlatformPaths.h"
+#include "../../Utils/Tracing.h"
 #include <climits>
 
 AudioAnalyzer::AudioAnalyzer() = default;
 
 AudioAnalyzer::~AudioAnalyzer() {
   cancelFlag = true;
-  if (analysisThread.joinable())
-    analysisThread.join();
+  analysisJob.wait();
 }
 
 void AudioAnalyzer::initialize() {
@@ -69,6 +69,7 @@ bool AudioAnalyzer::isRMVPEAvailable() const {
 
 void AudioAnalyzer::analyze(Project &project, ProgressCallback onProgress,
                             CompleteCallback onComplete) {
+  TRACE_ZONE("AudioAnalyzer::analyze");
   auto &audioData = project.getAudioData();
   if (audioData.waveform.getNumSamples() == 0)
     return;
@@ -122,9 +123,12 @@ void AudioAnalyzer::analyze(Project &project, ProgressCallback onProgress,
   // Smooth F0
   if (onProgress)
     onProgress(0.65, "Smoothing pitch curve...");
-  audioData.f0 = F0Smoother::smoothF0(audioData.f0, audioData.voicedMask);
-  audioData.f0 = PitchCurveProcessor::interpolateWithUvMask(
-      audioData.f0, audioData.voicedMask);
+  {
+    TRACE_ZONE("AudioAnalyzer::smoothF0");
+    F0Smoother::smoothF0InPlace(audioData.f0, audioData.voicedMask);
+    audioData.f0 = PitchCurveProcessor::interpolateWithUvMask(
+        audioData.f0, audioData.voicedMask);
+  }
 
   if (cancelFlag.load())
     return;
@@ -153,27 +157,30 @@ void AudioAnalyzer::analyzeAsync(std::shared_ptr<Project> project,
   cancelFlag = false;
   isRunning = true;
 
-  if (analysisThread.joinable())
-    analysisThread.join();
-
-  analysisThread = std::thread(
-      [this, project = std::move(project), onProgress, onComplete]() mutable {
-        analyze(*project, onProgress, [this, onComplete]() {
-          isRunning = false;
-          if (onComplete)
-            onComplete();
-        });
-        isRunning = false;
-      });
+  analysisJob.wait();
+
+  auto job = [this, project = std::move(project), onProgress,
+              onComplete]() mutable {
+    analyze(*project, onProgress, [this, onComplete]() {
+      isRunning = false;
+      if (onComplete)
+        onComplete();
+    });
+    isRunning = false;
+  };
+  analysisJob = JobSystem::getInstance().submit(JobSystem::Priority::Normal,
+                                                std::move(job));
 }
 
 void AudioAnalyzer::extractF0WithRMVPE(AudioData &audioData, int targetFrames) {
+  TRACE_ZONE("AudioAnalyzer::extractF0WithRMVPE");
   const float *samples = audioData.waveform.getReadPointer(0);
   int numSamples = audioData.waveform.getNumSamples();
 
   auto *detector = rmvpeDetector ? rmvpeDetector.get() : externalRMVPEDetector;
   std::vector<float> rmvpeF0 =
-      detector->extractF0(samples, numSamples, audioData.sampleRate);
+      detector->extractF0(samples, numSamples, audioData.sampleRate,
+                          RMVPEPitchDetector::DEFAULT_THRESHOLD, &cancelFlag);
 
   if (!rmvpeF0.empty() && targetFrames > 0) {
     audioData.f0.resize(targetFrames);
@@ -225,12 +232,14 @@ void AudioAnalyzer::extractF0WithRMVPE(AudioData &audioData, int targetFrames) {
 }
 
 void AudioAnalyzer::extractF0WithFCPE(AudioData &audioData, int targetFrames) {
+  TRACE_ZONE("AudioAnalyzer::extractF0WithFCPE");
   const float *samples = audioData.waveform.getReadPointer(0);
   int numSamples = audioData.waveform.getNumSamples();
 
   auto *detector = fcpeDetector ? fcpeDetector.get() : externalFCPEDetector;
   std::vector<float> fcpeF0 =
-      detector->extractF0(samples, numSamples, audioData.sampleRate);
+      detector->extractF0(samples, numSamples, audioData.sampleRate,
+                          FCPEPitchDetector::DEFAULT_THRESHOLD, &cancelFlag);
 
   if (!fcpeF0.empty() && targetFrames > 0) {
     audioData.f0.resize(targetFrames);
@@ -282,6 +291,7 @@ void AudioAnalyzer::extractF0WithFCPE(AudioData &audioData, int targetFrames) {
 }
 
 void AudioAnalyzer::segmentIntoNotes(Project &project) {
+  TRACE_ZONE("AudioAnalyzer::segmentIntoNotes");
   auto &audioData = project.getAudioData();
   auto &notes = project.getNotes();
   notes.clear();
@@ -310,6 +320,11 @@ void AudioAnalyzer::segmentWithSOME(Project &project) {
   const int f0Size = static_cast<int>(audioData.f0.size());
   const int melSize = static_cast<int>(audioData.melSpectrogram.size());
 
+  // Note clips reference these instead of copying their slices
+  const auto sourceSnapshot = audioData.getRenderSnapshot();
+  const auto sourceMel =
+      std::make_shared<const HalfMelBuffer>(audioData.melSpectrogram.view());
+
   auto *detector = someDetector ? someDetector.get() : externalSOMEDetector;
   detector->detectNotesStreaming(
       samples, numSamples, SOMEDetector::SAMPLE_RATE,
@@ -356,12 +371,8 @@ void AudioAnalyzer::segmentWithSOME(Project &project) {
             endSample = std::max(startSample,
                                  std::min(endSample,
                                           audioData.waveform.getNumSamples()));
-            std::vector<float> clip;
-            clip.reserve(static_cast<size_t>(endSample - startSample));
-            const float *src = audioData.waveform.getReadPointer(0);
-            for (int i = startSample; i < endSample; ++i)
-              clip.push_back(src[i]);
-            note.setClipWaveform(std::move(clip));
+            note.setClipWaveform(
+                WaveformClip(sourceSnapshot, startSample, endSample));
           }
 
           // Extract mel spectrogram clip for this note
@@ -369,17 +380,16 @@ void AudioAnalyzer::segmentWithSOME(Project &project) {
             int melStart = std::max(0, f0Start);
             int melEnd = std::min(f0End, melSize);
             if (melEnd > melStart) {
-              std::vector<std::vector<float>> melClip(
-                  audioData.melSpectrogram.begin() + melStart,
-                  audioData.melSpectrogram.begin() + melEnd);
-              note.setClipMel(std::move(melClip));
+              note.setClipMel(MelClip(sourceMel,
+                                      static_cast<size_t>(melStart),
+                                      static_cast<size_t>(melEnd)));
             }
           }
 
           notes.push_back(note);
         }
       },
-      nullptr);
+      nullptr, &cancelFlag);
 
   juce::Thread::sleep(100);
 
@@ -392,6 +402,11 @@ void AudioAnalyzer::segmentFallback(Project &project) {
   auto &notes = project.getNotes();
   const int melSize = static_cast<int>(audioData.melSpectrogram.size());
 
+  // Note clips reference these instead of copying their slices
+  const auto sourceSnapshot = audioData.getRenderSnapshot();
+  const auto sourceMel =
+      std::make_shared<const HalfMelBuffer>(audioData.melSpectrogram.view());
+
   auto finalizeNote = [&](int start, int end) {
     if (end - start < 5)
       return;
@@ -423,12 +438,8 @@ void AudioAnalyzer::segmentFallback(Project &project) {
       endSample = std::max(startSample,
                            std::min(endSample,
                                     audioData.waveform.getNumSamples()));
-      std::vector<float> clip;
-      clip.reserve(static_cast<size_t>(endSample - startSample));
-      const float *src = audioData.waveform.getReadPointer(0);
-      for (int i = startSample; i < endSample; ++i)
-        clip.push_back(src[i]);
-      note.setClipWaveform(std::move(clip));
+      note.setClipWaveform(
+          WaveformClip(sourceSnapshot, startSample, endSample));
     }
 
     // Extract mel spectrogram clip
@@ -436,10 +447,8 @@ void AudioAnalyzer::segmentFallback(Project &project) {
       int melStart = std::max(0, start);
       int melEnd = std::min(end, melSize);
       if (melEnd > melStart) {
-        std::vector<std::vector<float>> melClip(
-            audioData.melSpectrogram.begin() + melStart,
-            audioData.melSpectrogram.begin() + melEnd);
-        note.setClipMel(std::move(melClip));
+        note.setClipMel(MelClip(sourceMel, static_cast<size_t>(melStart),
+                                static_cast<size_t>(melEnd)));
       }
     }
 
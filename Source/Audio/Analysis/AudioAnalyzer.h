@@ -4,6 +4,7 @@
 #include "../../Models/Project.h"
 #include "../../Utils/Constants.h"
 #include "../../Utils/F0Smoother.h"
+#include "../../Utils/JobSystem.h"
 #include "../../Utils/MelSpectrogram.h"
 #include "../../Utils/PitchCurveProcessor.h"
 #include "../FCPEPitchDetector.h"
@@ -13,7 +14,6 @@
 #include <atomic>
 #include <functional>
 #include <memory>
-#include <thread>
 
 /**
  * Coordinates audio analysis operations including:
@@ -57,6 +57,10 @@ public:
   // Note segmentation
   void segmentIntoNotes(Project &project);
 
+  // Segmentation from F0 changes alone; needs only the project's f0, uv
+  // mask and mel, so it is ready long before SOME's
+  void segmentFallback(Project &project);
+
   // Cancel ongoing analysis
   void cancel() { cancelFlag = true; }
   bool isAnalyzing() const { return isRunning.load(); }
@@ -93,9 +97,6 @@ private:
   // Segment notes using SOME model
   void segmentWithSOME(Project &project);
 
-  // Fallback segmentation based on F0 changes
-  void segmentFallback(Project &project);
-
   std::unique_ptr<FCPEPitchDetector> fcpeDetector;
   std::unique_ptr<RMVPEPitchDetector> rmvpeDetector;
   std::unique_ptr<SOMEDetector> someDetector;
@@ -109,7 +110,7 @@ private:
   PitchDetectorType detectorType = PitchDetectorType::RMVPE;
   std::atomic<bool> cancelFlag{false};
   std::atomic<bool> isRunning{false};
-  std::thread analysisThread;
+  JobSystem::JobHandle analysisJob;
 
   JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AudioAnalyzer)
 };
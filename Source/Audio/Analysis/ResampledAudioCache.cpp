@@ -0,0 +1,46 @@
+#include "ResampledAudioCache.h"
+#include "../../Utils/AudioResampler.h"
+
+ResampledAudioCache::View
+ResampledAudioCache::get(const juce::String &sourceId, const float *audio,
+                         int numSamples, int sampleRate, int targetRate) {
+  View view;
+  view.sampleRate = targetRate;
+  if (sampleRate == targetRate) {
+    view.data = audio;
+    view.numSamples = numSamples;
+    return view;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (sourceId != currentSource) {
+      entries.clear();
+      currentSource = sourceId;
+    }
+    auto it = entries.find(targetRate);
+    if (it != entries.end())
+      view.storage = it->second;
+  }
+
+  if (!view.storage) {
+    // Resample outside the lock; a racing caller just keeps the first result
+    auto resampled = std::make_shared<const std::vector<float>>(
+        AudioResampler::resample(audio, numSamples, sampleRate, targetRate));
+    std::lock_guard<std::mutex> lock(mutex);
+    if (sourceId == currentSource)
+      view.storage = entries.emplace(targetRate, resampled).first->second;
+    else
+      view.storage = std::move(resampled);
+  }
+
+  view.data = view.storage->data();
+  view.numSamples = static_cast<int>(view.storage->size());
+  return view;
+}
+
+void ResampledAudioCache::clear() {
+  std::lock_guard<std::mutex> lock(mutex);
+  entries.clear();
+  currentSource = {};
+}
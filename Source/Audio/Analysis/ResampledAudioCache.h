@@ -0,0 +1,40 @@
+#pragma once
+
+#include "../../JuceHeader.h"
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/**
+ * Mono copies of one source waveform at the detectors' input rates, so
+ * RMVPE/FCPE (16 kHz) and SOME (44.1 kHz) resample a project's audio once
+ * rather than on every analysis.
+ *
+ * Entries belong to the source identified by sourceId (the analysis
+ * cache's audio hash); asking for a different source drops them, so at most
+ * one project's resampled audio is held. Thread-safe.
+ */
+class ResampledAudioCache {
+public:
+  struct View {
+    const float *data = nullptr;
+    int numSamples = 0;
+    int sampleRate = 0;
+    std::shared_ptr<const std::vector<float>> storage; // Null when borrowed
+  };
+
+  /**
+   * audio at targetRate. When sampleRate already equals targetRate the view
+   * borrows audio itself, which must then outlive it.
+   */
+  View get(const juce::String &sourceId, const float *audio, int numSamples,
+           int sampleRate, int targetRate);
+
+  void clear();
+
+private:
+  std::mutex mutex;
+  juce::String currentSource;
+  std::map<int, std::shared_ptr<const std::vector<float>>> entries;
+};
@@ -1,9 +1,44 @@
 #include "AudioEngine.h"
+#include "../Utils/RealtimeCheck.h"
 #include <algorithm>
+#include <cmath>
+
+AudioEngine::AudioEngine() {
+  selfRef = this;
+  rateCache = std::make_unique<PlaybackRateCache>(
+      [weakThis = selfRef](RenderSnapshot::Ptr source,
+                           RenderSnapshot::Ptr converted) {
+        juce::MessageManager::callAsync([weakThis, source, converted]() {
+          auto *engine = weakThis.get();
+          // Drop conversions overtaken by a newer snapshot
+          if (engine != nullptr && engine->currentBuffers &&
+              engine->currentBuffers->source == source) {
+            auto buffers = *engine->currentBuffers;
+            buffers.converted = converted;
+            engine->publishBuffers(std::move(buffers));
+          }
+        });
+      });
+  originalRateCache = std::make_unique<PlaybackRateCache>(
+      [weakThis = selfRef](RenderSnapshot::Ptr source,
+                           RenderSnapshot::Ptr converted) {
+        juce::MessageManager::callAsync([weakThis, source, converted]() {
+          auto *engine = weakThis.get();
+          if (engine != nullptr && engine->currentBuffers &&
+              engine->currentBuffers->original == source) {
+            auto buffers = *engine->currentBuffers;
+            buffers.originalConverted = converted;
+            engine->publishBuffers(std::move(buffers));
+          }
+        });
+      });
+}
 
-AudioEngine::AudioEngine() {}
-
-AudioEngine::~AudioEngine() { shutdownAudio(); }
+AudioEngine::~AudioEngine() {
+  shutdownAudio();
+  rateCache.reset();
+  originalRateCache.reset();
+}
 
 void AudioEngine::initializeAudio() {
   // Initialize audio device
@@ -36,82 +71,296 @@ void AudioEngine::shutdownAudio() {
 void AudioEngine::prepareToPlay(int samplesPerBlockExpected,
                                 double sampleRate) {
   currentSampleRate = sampleRate;
-  playbackRatio = static_cast<double>(waveformSampleRate) / sampleRate;
-  interpolator.reset();
-  fractionalPosition = 0.0;
+  deviceSampleRate.store(juce::roundToInt(sampleRate));
+  inputScratch.resize(std::max<size_t>(
+      inputScratch.size(), static_cast<size_t>(samplesPerBlockExpected) * 8));
+  renderPlayhead.reset();
+  originalPlayhead.reset();
 
   DBG("AudioEngine::prepareToPlay - Device sample rate: " +
-      juce::String(sampleRate) +
-      " Hz, Waveform sample rate: " + juce::String(waveformSampleRate) +
-      " Hz, Playback ratio: " + juce::String(playbackRatio));
+      juce::String(sampleRate) + " Hz, Waveform sample rate: " +
+      juce::String(waveformSampleRate.load()) + " Hz");
+
+  // Convert the loaded waveform for the new device rate
+  juce::MessageManager::callAsync([weakThis = selfRef]() {
+    if (auto *engine = weakThis.get()) {
+      engine->requestConversion();
+      engine->requestOriginalConversion();
+    }
+  });
 }
 
 void AudioEngine::releaseResources() {}
 
 void AudioEngine::getNextAudioBlock(
     const juce::AudioSourceChannelInfo &bufferToFill) {
-  if (!playing || currentWaveform.getNumSamples() == 0) {
-    bufferToFill.clearActiveBufferRegion();
-    return;
+  REALTIME_SCOPE("AudioEngine::getNextAudioBlock");
+  PerformanceMetrics::ScopedAudioCallback timing(
+      PerformanceMetrics::AudioSource::Standalone, bufferToFill.numSamples,
+      currentSampleRate);
+  // Odd for the duration of the block; see reclaimRetiredBuffers()
+  callbackCounter.fetch_add(1);
+  const auto outcome = renderBlock(bufferToFill);
+  callbackCounter.fetch_add(1);
+  PerformanceMetrics::getInstance().recordBlockOutcome(
+      PerformanceMetrics::AudioSource::Standalone, outcome);
+}
+
+PerformanceMetrics::BlockOutcome
+AudioEngine::renderBlock(const juce::AudioSourceChannelInfo &bufferToFill) {
+  using Outcome = PerformanceMetrics::BlockOutcome;
+  const int64_t seekTarget = pendingSeekSample.exchange(-1);
+  if (seekTarget >= 0) {
+    renderPlayhead.reset();
+    originalPlayhead.reset();
   }
 
-  const juce::SpinLock::ScopedTryLockType lock(waveformLock);
-  if (!lock.isLocked()) {
-    // Waveform is being updated, output silence to avoid glitches
+  const PlaybackBuffers *buffers = liveBuffers.load();
+  if (!playing) {
+    // Playback starts on whichever side is selected, without a fade
+    originalMix = playOriginal.load() ? 1.0f : 0.0f;
     bufferToFill.clearActiveBufferRegion();
-    return;
+    return Outcome::Stopped;
+  }
+  if (buffers == nullptr || !buffers->source ||
+      buffers->source->getNumSamples() == 0) {
+    bufferToFill.clearActiveBufferRegion();
+    return Outcome::NoAudio;
   }
 
   auto *outputBuffer = bufferToFill.buffer;
   auto numOutputSamples = bufferToFill.numSamples;
   auto startSample = bufferToFill.startSample;
 
-  int64_t pos = currentPosition.load();
-  int64_t waveformLength = currentWaveform.getNumSamples();
-
-  bool loopActive = loopEnabled.load();
-  int64_t loopStart = loopStartSample.load();
-  int64_t loopEnd = loopEndSample.load();
-
-  if (loopActive) {
-    loopStart = juce::jlimit<int64_t>(0, waveformLength, loopStart);
-    loopEnd = juce::jlimit<int64_t>(0, waveformLength, loopEnd);
-    if (loopEnd <= loopStart)
-      loopActive = false;
+  const auto &snapshot = *buffers->source;
+  const int snapshotRate = snapshot.getSampleRate();
+  const int deviceRate = juce::roundToInt(currentSampleRate);
+  auto deviceCopy =
+      [deviceRate](const RenderSnapshot::Ptr &copy) -> const RenderSnapshot * {
+    return copy && copy->getSampleRate() == deviceRate ? copy.get() : nullptr;
+  };
+
+  PlaybackCursor cursor;
+  cursor.position = seekTarget >= 0 ? seekTarget : currentPosition.load();
+  int64_t waveformLength = snapshot.getNumSamples();
+
+  cursor.looping = loopEnabled.load();
+  if (cursor.looping) {
+    cursor.loopStart =
+        juce::jlimit<int64_t>(0, waveformLength, loopStartSample.load());
+    cursor.loopEnd =
+        juce::jlimit<int64_t>(0, waveformLength, loopEndSample.load());
+    if (cursor.loopEnd <= cursor.loopStart)
+      cursor.looping = false;
   }
 
-  if (!loopActive && pos >= waveformLength) {
+  if (!cursor.looping && cursor.position >= waveformLength) {
     bufferToFill.clearActiveBufferRegion();
     playing = false;
 
-    // Schedule callback on message thread
-    if (auto cb = std::atomic_load(&finishCallback))
-      juce::MessageManager::callAsync([cb]() { (*cb)(); });
-    return;
+    // The message thread sees this on its next poll
+    ++finishCount;
+    publishedStatus.publish(
+        {static_cast<double>(cursor.position) / snapshotRate, finishCount});
+    return Outcome::Stopped;
   }
 
-  if (loopActive && pos >= loopEnd) {
-    pos = loopStart;
-    interpolator.reset();
+  bool passStarts = seekTarget >= 0;
+  if (cursor.looping && cursor.position >= cursor.loopEnd) {
+    cursor.position = cursor.loopStart;
+    renderPlayhead.reset();
+    originalPlayhead.reset();
+    passStarts = true;
   }
 
-  // Use interpolator for sample rate conversion
-  const float *inputData = currentWaveform.getReadPointer(0);
-  float *outputData = outputBuffer->getWritePointer(0, startSample);
+  // Loop focus: a pass already under way finishes on the render it started
+  // with, and the newest render takes over where the loop wraps
+  const bool holdPass =
+      cursor.looping && !passStarts && buffers->heldSource &&
+      buffers->heldGeneration == audibleGeneration.load() &&
+      buffers->generation != buffers->heldGeneration;
+  if (!holdPass)
+    audibleGeneration.store(buffers->generation);
 
+  float *outputData = outputBuffer->getWritePointer(0, startSample);
   outputBuffer->clear(startSample, numOutputSamples);
 
-  int samplesRemaining = numOutputSamples;
-  int writeOffset = 0;
+  // A/B: the original plays from the same cursor as the render. A source
+  // not heard in this block picks up from the cursor when it is next.
+  const RenderSnapshot *original = buffers->original.get();
+  if (original != nullptr &&
+      (original->getSampleRate() != snapshotRate ||
+       original->getNumSamples() != waveformLength))
+    original = nullptr;
+  const float mixTarget = original != nullptr && playOriginal.load() ? 1.0f
+                                                                     : 0.0f;
+  if (original == nullptr)
+    originalMix = 0.0f;
+  const bool renderHeard = originalMix < 1.0f || mixTarget < 1.0f;
+  const bool originalHeard = originalMix > 0.0f || mixTarget > 0.0f;
+  if (!renderHeard)
+    renderPlayhead.reset();
+  if (!originalHeard)
+    originalPlayhead.reset();
+
+  int written = 0;
+  bool wrapped = false;
+  PlaybackCursor originalCursor = cursor;
+  if (renderHeard) {
+    if (holdPass) {
+      written = renderSource(*buffers->heldSource,
+                             deviceCopy(buffers->heldConverted), outputData,
+                             numOutputSamples, cursor, renderPlayhead, true,
+                             wrapped);
+      if (wrapped)
+        audibleGeneration.store(buffers->generation);
+    }
+    if (!holdPass || wrapped)
+      written += renderSource(snapshot, deviceCopy(buffers->converted),
+                              outputData + written, numOutputSamples - written,
+                              cursor, renderPlayhead, false, wrapped);
+  }
+  if (originalHeard && !renderHeard) {
+    written = renderSource(*original, deviceCopy(buffers->originalConverted),
+                           outputData, numOutputSamples, originalCursor,
+                           originalPlayhead, false, wrapped);
+    cursor = originalCursor;
+  } else if (originalHeard) {
+    // Both sources cover the same samples; fade in scratch-sized pieces
+    int faded = 0;
+    while (faded < written) {
+      const int count = std::min(written - faded,
+                                 static_cast<int>(originalScratch.size()));
+      bool originalWrapped = false;
+      const int got = renderSource(
+          *original, deviceCopy(buffers->originalConverted),
+          originalScratch.data(), count, originalCursor, originalPlayhead,
+          false, originalWrapped);
+      crossfadeOriginal(outputData + faded, originalScratch.data(), got,
+                        mixTarget);
+      faded += got;
+      if (got < count)
+        break;
+    }
+  }
+  const int samplesRemaining = numOutputSamples - written;
+
+  // Apply volume gain (lock-free read)
+  float gain = volumeGain.load();
+  if (std::abs(gain - 1.0f) > 0.0001f) // Only apply if not unity gain
+  {
+    juce::FloatVectorOperations::multiply(outputData, gain, numOutputSamples);
+  }
+
+  // A seek posted during this block wins; the next block applies it
+  if (pendingSeekSample.load() < 0)
+    currentPosition.store(cursor.position);
+
+  // Copy to other channels (if stereo output)
+  for (int ch = 1; ch < outputBuffer->getNumChannels(); ++ch) {
+    outputBuffer->copyFrom(ch, startSample,
+                           outputBuffer->getReadPointer(0, startSample),
+                           numOutputSamples);
+  }
+
+  if (!cursor.looping && samplesRemaining > 0) {
+    playing = false;
+    ++finishCount;
+  }
+
+  // Latest position for the UI poll; never posts a message
+  publishedStatus.publish({cursor.positionSeconds, finishCount});
+  return Outcome::Rendered;
+}
+
+int AudioEngine::renderSource(const RenderSnapshot &snapshot,
+                              const RenderSnapshot *converted, float *out,
+                              int numSamples, PlaybackCursor &cursor,
+                              SourcePlayhead &playhead, bool stopAtLoopEnd,
+                              bool &wrapped) {
+  auto &interpolator = playhead.interpolator;
+  wrapped = false;
+  const int snapshotRate = snapshot.getSampleRate();
+  const int64_t waveformLength = snapshot.getNumSamples();
+  int written = 0;
+
+  if (converted != nullptr) {
+    // Straight copy at the device rate; loop points map to exact samples
+    const int deviceRate = converted->getSampleRate();
+    auto toDevice = [&](int64_t sourceSample) {
+      return PlaybackRateCache::toDeviceSamples(sourceSample, snapshotRate,
+                                                deviceRate);
+    };
+    if (playhead.devicePositionDeviceRate != deviceRate ||
+        playhead.devicePositionSourceRate != snapshotRate) {
+      playhead.devicePosition = toDevice(cursor.position);
+      playhead.devicePositionDeviceRate = deviceRate;
+      playhead.devicePositionSourceRate = snapshotRate;
+    }
+
+    const int64_t deviceLength = converted->getNumSamples();
+    const int64_t deviceLoopStart = toDevice(cursor.loopStart);
+    const int64_t deviceLoopEnd = toDevice(cursor.loopEnd);
+    const bool deviceLoop =
+        cursor.looping && deviceLoopEnd > deviceLoopStart;
+    int64_t dpos = playhead.devicePosition;
+
+    while (written < numSamples) {
+      if (deviceLoop && dpos >= deviceLoopEnd) {
+        dpos = deviceLoopStart;
+        if (stopAtLoopEnd) {
+          wrapped = true;
+          break;
+        }
+      }
+      const int64_t segmentEnd = deviceLoop ? deviceLoopEnd : deviceLength;
+      const int count = static_cast<int>(
+          std::min<int64_t>(numSamples - written, segmentEnd - dpos));
+      if (count <= 0)
+        break;
+
+      converted->read(0, static_cast<int>(dpos), count, out + written);
+      dpos += count;
+      written += count;
+    }
+
+    playhead.devicePosition = dpos;
+    if (wrapped) {
+      // The next render may play through the interpolator instead
+      cursor.position = cursor.loopStart;
+      interpolator.reset();
+    } else {
+      cursor.position =
+          PlaybackRateCache::toSourceSamples(dpos, snapshotRate, deviceRate);
+    }
+    cursor.positionSeconds = static_cast<double>(dpos) / deviceRate;
+    return written;
+  }
+
+  // No conversion for this device rate yet: resample live
+  playhead.devicePositionDeviceRate = 0;
+  const double playbackRatio =
+      currentSampleRate > 0 ? snapshotRate / currentSampleRate : 1.0;
+  float *inputData = inputScratch.data();
+  int64_t pos = cursor.position;
+
+  // Returns true when the caller asked to stop here
+  auto wrapToLoopStart = [&]() {
+    pos = cursor.loopStart;
+    interpolator.reset();
+    wrapped = stopAtLoopEnd;
+    return wrapped;
+  };
 
-  while (samplesRemaining > 0) {
-    int64_t segmentEnd = loopActive ? loopEnd : waveformLength;
-    int64_t inputAvailable = segmentEnd - pos;
+  while (written < numSamples) {
+    int64_t segmentEnd = cursor.looping ? cursor.loopEnd : waveformLength;
+    int64_t inputAvailable = std::min<int64_t>(
+        segmentEnd - pos, static_cast<int64_t>(inputScratch.size()));
 
     if (inputAvailable <= 0) {
-      if (loopActive) {
-        pos = loopStart;
-        interpolator.reset();
+      if (cursor.looping) {
+        if (wrapToLoopStart())
+          break;
         continue;
       }
       break;
@@ -119,67 +368,67 @@ void AudioEngine::getNextAudioBlock(
 
     int maxOutput = static_cast<int>(inputAvailable / playbackRatio);
     if (maxOutput <= 0) {
-      if (loopActive) {
-        pos = loopStart;
-        interpolator.reset();
+      if (cursor.looping) {
+        if (wrapToLoopStart())
+          break;
         continue;
       }
       break;
     }
 
-    int outCount = std::min(samplesRemaining, maxOutput);
-    int samplesUsed = interpolator.process(playbackRatio, inputData + pos,
-                                           outputData + writeOffset, outCount,
-                                           static_cast<int>(inputAvailable),
+    int outCount = std::min(numSamples - written, maxOutput);
+    // Only the input this block consumes, plus a guard sample for the
+    // fractional position; read in place unless it crosses a tile
+    const int inputNeeded = static_cast<int>(std::min<int64_t>(
+        inputAvailable,
+        static_cast<int64_t>(std::ceil(outCount * playbackRatio)) + 2));
+    const float *input =
+        snapshot.getContiguous(0, static_cast<int>(pos), inputNeeded);
+    if (input == nullptr) {
+      snapshot.read(0, static_cast<int>(pos), inputNeeded, inputData);
+      input = inputData;
+    }
+    int samplesUsed = interpolator.process(playbackRatio, input,
+                                           out + written, outCount,
+                                           inputNeeded,
                                            0 // No wrap
     );
 
     pos += samplesUsed;
-    samplesRemaining -= outCount;
-    writeOffset += outCount;
+    written += outCount;
 
-    if (loopActive && pos >= loopEnd) {
-      pos = loopStart;
-      interpolator.reset();
-    }
+    if (cursor.looping && pos >= cursor.loopEnd && wrapToLoopStart())
+      break;
   }
 
-  // Apply volume gain (lock-free read)
-  float gain = volumeGain.load();
-  if (std::abs(gain - 1.0f) > 0.0001f) // Only apply if not unity gain
-  {
-    juce::FloatVectorOperations::multiply(outputData, gain, numOutputSamples);
+  cursor.position = pos;
+  cursor.positionSeconds = static_cast<double>(pos) / snapshotRate;
+  return written;
+}
+
+void AudioEngine::crossfadeOriginal(float *out, const float *other,
+                                    int numSamples, float target) {
+  const float step = static_cast<float>(
+      1.0 / std::max(1.0, abFadeSeconds * currentSampleRate));
+  for (int i = 0; i < numSamples; ++i) {
+    originalMix = originalMix < target ? std::min(target, originalMix + step)
+                                       : std::max(target, originalMix - step);
+    out[i] += (other[i] - out[i]) * originalMix;
   }
+}
 
-  currentPosition.store(pos);
+void AudioEngine::dispatchPendingCallbacks() {
+  PlaybackStatus status;
+  if (!publishedStatus.readIfChanged(status, lastSeenStatusVersion))
+    return;
 
-  // Copy to other channels (if stereo output)
-  for (int ch = 1; ch < outputBuffer->getNumChannels(); ++ch) {
-    outputBuffer->copyFrom(ch, startSample,
-                           outputBuffer->getReadPointer(0, startSample),
-                           numOutputSamples);
-  }
+  if (auto cb = std::atomic_load(&positionCallback))
+    (*cb)(status.positionSeconds);
 
-  if (!loopActive && samplesRemaining > 0) {
-    playing = false;
+  if (status.finishCount != lastSeenFinishCount) {
+    lastSeenFinishCount = status.finishCount;
     if (auto cb = std::atomic_load(&finishCallback))
-      juce::MessageManager::callAsync([cb]() { (*cb)(); });
-  }
-
-  // Update position callback
-  if (auto cb = std::atomic_load(&positionCallback)) {
-    auto state = positionUpdateState;
-    state->latestSeconds.store(static_cast<double>(currentPosition.load()) /
-                               waveformSampleRate);
-
-    // Schedule at most one pending callback to avoid flooding the message
-    // thread
-    if (!state->callbackPending.exchange(true)) {
-      juce::MessageManager::callAsync([cb, state]() {
-        state->callbackPending.store(false);
-        (*cb)(state->latestSeconds.load());
-      });
-    }
+      (*cb)();
   }
 }
 
@@ -187,47 +436,75 @@ void AudioEngine::changeListenerCallback(juce::ChangeBroadcaster *source) {}
 
 void AudioEngine::loadWaveform(const juce::AudioBuffer<float> &buffer,
                                int sampleRate, bool preservePosition) {
-  // Save playing state if we need to preserve it
-  bool wasPlaying = playing.load();
+  loadSnapshot(RenderSnapshot::fromBuffer(buffer, sampleRate),
+               preservePosition);
+}
 
-  // Stop playback first to safely update waveform
-  playing = false;
+void AudioEngine::loadSnapshot(RenderSnapshot::Ptr snapshot,
+                               bool preservePosition) {
+  if (!snapshot)
+    return;
+  const int sampleRate = snapshot->getSampleRate();
+
+  // Until the new conversion lands, keep playing the previous one if it
+  // lines up with this snapshot (an incremental re-render); otherwise the
+  // callback resamples live. Playback carries on from the same sample.
+  RenderSnapshot::Ptr interim;
+  if (sampleRate == deviceSampleRate.load()) {
+    interim = snapshot;
+  } else if (currentBuffers && currentBuffers->converted) {
+    const auto &previous = *currentBuffers->source;
+    if (previous.getSampleRate() == sampleRate &&
+        previous.getNumSamples() == snapshot->getNumSamples() &&
+        previous.getNumChannels() == snapshot->getNumChannels())
+      interim = currentBuffers->converted;
+  }
 
-  {
-    const juce::SpinLock::ScopedLockType lock(waveformLock);
-    currentWaveform = buffer;
-    waveformSampleRate = sampleRate;
+  PlaybackBuffers buffers{snapshot, std::move(interim), nextGeneration++};
+  if (currentBuffers) {
+    buffers.original = currentBuffers->original;
+    buffers.originalConverted = currentBuffers->originalConverted;
+  }
 
-    if (!preservePosition) {
-      currentPosition.store(0);
-      fractionalPosition = 0.0;
+  // Loop focus: an in-place re-render waits for the pass being played to
+  // wrap. Keep whichever render that pass started on.
+  if (preservePosition && loopFocus.load() && loopEnabled.load() &&
+      playing.load() && currentBuffers && currentBuffers->source) {
+    const auto &previous = *currentBuffers->source;
+    const uint64_t audible = audibleGeneration.load();
+    if (previous.getSampleRate() == sampleRate &&
+        previous.getNumSamples() == snapshot->getNumSamples() &&
+        previous.getNumChannels() == snapshot->getNumChannels()) {
+      if (currentBuffers->heldSource &&
+          currentBuffers->heldGeneration == audible) {
+        buffers.heldSource = currentBuffers->heldSource;
+        buffers.heldConverted = currentBuffers->heldConverted;
+        buffers.heldGeneration = audible;
+      } else if (currentBuffers->generation == audible) {
+        buffers.heldSource = currentBuffers->source;
+        buffers.heldConverted = currentBuffers->converted;
+        buffers.heldGeneration = audible;
+      }
     }
-
-    // Update playback ratio for sample rate conversion
-    if (currentSampleRate > 0)
-      playbackRatio =
-          static_cast<double>(waveformSampleRate) / currentSampleRate;
-    else
-      playbackRatio = 1.0;
-
-    interpolator.reset();
   }
 
-  // Restore playing state if preserving position (e.g., during incremental
-  // synthesis)
-  if (preservePosition && wasPlaying) {
-    playing = true;
-    DBG("Restored playback state after waveform update");
+  waveformSampleRate.store(sampleRate);
+  publishBuffers(std::move(buffers));
+  if (sampleRate != deviceSampleRate.load())
+    requestConversion();
+
+  if (!preservePosition) {
+    currentPosition.store(0);
+    pendingSeekSample.store(0);
   }
 
-  DBG("Loaded waveform: " + juce::String(buffer.getNumSamples()) +
-      " samples at " + juce::String(sampleRate) +
-      " Hz, playback ratio: " + juce::String(playbackRatio));
+  DBG("Loaded waveform: " + juce::String(getWaveformLength()) +
+      " samples at " + juce::String(sampleRate) + " Hz");
 
   if (loopEnabled.load()) {
     auto loopStart = loopStartSample.load();
     auto loopEnd = loopEndSample.load();
-    const int64_t waveformLength = currentWaveform.getNumSamples();
+    const int64_t waveformLength = getWaveformLength();
     loopStart = juce::jlimit<int64_t>(0, waveformLength, loopStart);
     loopEnd = juce::jlimit<int64_t>(0, waveformLength, loopEnd);
     loopStartSample.store(loopStart);
@@ -237,8 +514,58 @@ void AudioEngine::loadWaveform(const juce::AudioBuffer<float> &buffer,
   }
 }
 
+void AudioEngine::loadOriginal(RenderSnapshot::Ptr original) {
+  if (currentBuffers && currentBuffers->original == original)
+    return;
+  PlaybackBuffers buffers = currentBuffers ? *currentBuffers : PlaybackBuffers{};
+  buffers.original = std::move(original);
+  buffers.originalConverted = nullptr;
+  if (buffers.original &&
+      buffers.original->getSampleRate() == deviceSampleRate.load())
+    buffers.originalConverted = buffers.original;
+  publishBuffers(std::move(buffers));
+  if (currentBuffers->original && !currentBuffers->originalConverted)
+    requestOriginalConversion();
+}
+
+void AudioEngine::publishBuffers(PlaybackBuffers buffers) {
+  auto previous = std::move(currentBuffers);
+  currentBuffers = std::make_shared<const PlaybackBuffers>(std::move(buffers));
+  liveBuffers.store(currentBuffers.get());
+
+  if (previous) {
+    const uint64_t count = callbackCounter.load();
+    // Even: no callback was running, and any later one sees the new pointer
+    if ((count & 1) != 0)
+      retiredBuffers.push_back({std::move(previous), count});
+  }
+  reclaimRetiredBuffers();
+}
+
+void AudioEngine::requestConversion() {
+  const int deviceRate = deviceSampleRate.load();
+  if (currentBuffers && currentBuffers->source && deviceRate > 0)
+    rateCache->request(currentBuffers->source, deviceRate);
+}
+
+void AudioEngine::requestOriginalConversion() {
+  const int deviceRate = deviceSampleRate.load();
+  if (currentBuffers && currentBuffers->original && deviceRate > 0)
+    originalRateCache->request(currentBuffers->original, deviceRate);
+}
+
+void AudioEngine::reclaimRetiredBuffers() {
+  const uint64_t count = callbackCounter.load();
+  retiredBuffers.erase(
+      std::remove_if(retiredBuffers.begin(), retiredBuffers.end(),
+                     [count](const RetiredBuffers &retired) {
+                       return retired.callbackCount != count;
+                     }),
+      retiredBuffers.end());
+}
+
 void AudioEngine::play() {
-  if (currentWaveform.getNumSamples() == 0) {
+  if (getWaveformLength() == 0) {
     DBG("Cannot play: no waveform loaded");
     return;
   }
@@ -252,31 +579,36 @@ void AudioEngine::pause() { playing = false; }
 
 void AudioEngine::stop() {
   playing = false;
-
-  const juce::SpinLock::ScopedLockType lock(waveformLock);
   currentPosition.store(0);
-  interpolator.reset();
-  fractionalPosition = 0.0;
+  pendingSeekSample.store(0);
+  reclaimRetiredBuffers();
 }
 
 void AudioEngine::seek(double timeSeconds) {
-  const juce::SpinLock::ScopedLockType lock(waveformLock);
-  int64_t newPos = static_cast<int64_t>(timeSeconds * waveformSampleRate);
-  newPos = juce::jlimit<int64_t>(0, currentWaveform.getNumSamples(), newPos);
+  int64_t newPos =
+      static_cast<int64_t>(timeSeconds * waveformSampleRate.load());
+  newPos = juce::jlimit<int64_t>(0, getWaveformLength(), newPos);
   currentPosition.store(newPos);
-  interpolator.reset();
-  fractionalPosition = 0.0;
+  pendingSeekSample.store(newPos);
+  reclaimRetiredBuffers();
+}
+
+double AudioEngine::getLoopStart() const {
+  return static_cast<double>(loopStartSample.load()) / waveformSampleRate.load();
+}
+
+double AudioEngine::getLoopEnd() const {
+  return static_cast<double>(loopEndSample.load()) / waveformSampleRate.load();
 }
 
 void AudioEngine::setLoopRange(double startSeconds, double endSeconds) {
   if (startSeconds > endSeconds)
     std::swap(startSeconds, endSeconds);
 
-  const juce::SpinLock::ScopedLockType lock(waveformLock);
-  const int64_t waveformLength = currentWaveform.getNumSamples();
-  int64_t startSample =
-      static_cast<int64_t>(startSeconds * waveformSampleRate);
-  int64_t endSample = static_cast<int64_t>(endSeconds * waveformSampleRate);
+  const int64_t waveformLength = getWaveformLength();
+  const int sampleRate = waveformSampleRate.load();
+  int64_t startSample = static_cast<int64_t>(startSeconds * sampleRate);
+  int64_t endSample = static_cast<int64_t>(endSeconds * sampleRate);
 
   startSample = juce::jlimit<int64_t>(0, waveformLength, startSample);
   endSample = juce::jlimit<int64_t>(0, waveformLength, endSample);
@@ -300,14 +632,15 @@ void AudioEngine::clearLoopRange() {
 }
 
 double AudioEngine::getPosition() const {
-  return static_cast<double>(currentPosition.load()) / waveformSampleRate;
+  return static_cast<double>(currentPosition.load()) /
+         waveformSampleRate.load();
 }
 
 double AudioEngine::getDuration() const {
-  if (currentWaveform.getNumSamples() == 0)
+  const int64_t waveformLength = getWaveformLength();
+  if (waveformLength == 0)
     return 0.0;
-  return static_cast<double>(currentWaveform.getNumSamples()) /
-         waveformSampleRate;
+  return static_cast<double>(waveformLength) / waveformSampleRate.load();
 }
 
 void AudioEngine::setVolumeDb(float dB) {
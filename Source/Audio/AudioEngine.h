@@ -2,9 +2,14 @@
 
 #include "../JuceHeader.h"
 #include "../Models/Project.h"
+#include "../Utils/PublishedState.h"
+#include "Engine/PlaybackRateCache.h"
+#include "PerformanceMetrics.h"
 #include <atomic>
+#include <cstdint>
 #include <functional>
 #include <memory>
+#include <vector>
 
 /**
  * Audio engine for playback and synthesis.
@@ -27,6 +32,18 @@ public:
   void setProject(Project *proj) { project = proj; }
   void loadWaveform(const juce::AudioBuffer<float> &buffer, int sampleRate,
                     bool preservePosition = false);
+  // Swap in a rendered snapshot without copying samples
+  void loadSnapshot(RenderSnapshot::Ptr snapshot,
+                    bool preservePosition = false);
+
+  // A/B comparison against the unedited audio. The original stays loaded
+  // beside the render (sharing its unedited tiles) and is heard in its
+  // place while setPlayingOriginal(true); the switch cross-fades over
+  // abFadeSeconds at the play position, with no re-render. An original of
+  // another length or rate than the render is not played.
+  void loadOriginal(RenderSnapshot::Ptr original);
+  void setPlayingOriginal(bool original) { playOriginal.store(original); }
+  bool isPlayingOriginal() const { return playOriginal.load(); }
 
   void play();
   void pause();
@@ -38,6 +55,13 @@ public:
   void setLoopEnabled(bool enabled);
   void clearLoopRange();
   bool isLoopEnabled() const { return loopEnabled.load(); }
+  // Loop range in seconds, whether or not looping is enabled
+  double getLoopStart() const;
+  double getLoopEnd() const;
+  // Loop focus: while looping, a re-render loaded with preservePosition
+  // starts at the next pass, so every pass plays one complete render
+  void setLoopFocus(bool enabled) { loopFocus.store(enabled); }
+  bool isLoopFocus() const { return loopFocus.load(); }
 
   bool isPlaying() const { return playing; }
   double getPosition() const; // Returns position in seconds
@@ -60,6 +84,11 @@ public:
     std::atomic_store(&finishCallback, std::shared_ptr<FinishCallback>{});
   }
 
+  // The audio thread only publishes its position and end-of-playback; call
+  // this from the message thread (once per display frame) to run the
+  // callbacks for whatever changed since the last call.
+  void dispatchPendingCallbacks();
+
   // Audio device management
   juce::AudioDeviceManager &getDeviceManager() { return deviceManager; }
   void initializeAudio();
@@ -70,38 +99,137 @@ public:
   float getVolumeDb() const;
 
 private:
-  struct PositionUpdateState {
-    std::atomic<double> latestSeconds{0.0};
-    std::atomic<bool> callbackPending{false};
+  struct PlaybackStatus {
+    double positionSeconds = 0.0;
+    uint32_t finishCount = 0; // Bumped each time playback runs off the end
   };
 
   juce::AudioDeviceManager deviceManager;
   juce::AudioSourcePlayer audioSourcePlayer;
 
   Project *project = nullptr;
-  juce::AudioBuffer<float> currentWaveform;
-  int waveformSampleRate = 44100;
+
+  // Playback buffer handoff. The message thread owns currentBuffers and
+  // publishes its raw pointer through liveBuffers; the audio callback only
+  // ever loads that pointer, so it never blocks. Replaced buffers are kept
+  // in retiredBuffers until the callback that may still be reading them has
+  // returned (callbackCounter is odd while a callback runs), so the audio
+  // thread never frees sample memory.
+  struct PlaybackBuffers {
+    RenderSnapshot::Ptr source;
+    // Device-rate copy the callback plays directly, if ready. While a new
+    // source is being converted this may still hold the previous source's
+    // conversion, when the two line up sample for sample.
+    RenderSnapshot::Ptr converted;
+    uint64_t generation = 0; // Bumped for each new source
+    // Loop focus: the render the current pass started on, played until the
+    // loop wraps. Same length and rate as source.
+    RenderSnapshot::Ptr heldSource;
+    RenderSnapshot::Ptr heldConverted;
+    uint64_t heldGeneration = 0;
+    // A/B comparison source and its device-rate copy, if ready
+    RenderSnapshot::Ptr original;
+    RenderSnapshot::Ptr originalConverted;
+  };
+  struct RetiredBuffers {
+    std::shared_ptr<const PlaybackBuffers> buffers;
+    uint64_t callbackCount = 0;
+  };
+  std::shared_ptr<const PlaybackBuffers> currentBuffers;
+  std::atomic<const PlaybackBuffers *> liveBuffers{nullptr};
+  std::atomic<uint64_t> callbackCounter{0};
+  std::vector<RetiredBuffers> retiredBuffers;
+  std::atomic<int> waveformSampleRate{44100};
+  std::atomic<int> deviceSampleRate{0};
+  int64_t getWaveformLength() const {
+    return currentBuffers && currentBuffers->source
+               ? currentBuffers->source->getNumSamples()
+               : 0;
+  }
+  void publishBuffers(PlaybackBuffers buffers);
+  void requestConversion();
+  void requestOriginalConversion();
+  void reclaimRetiredBuffers();
+  PerformanceMetrics::BlockOutcome
+  renderBlock(const juce::AudioSourceChannelInfo &bufferToFill);
+
+  // Where one block of playback runs; loop bounds are already clipped
+  struct PlaybackCursor {
+    int64_t position = 0; // Waveform samples
+    bool looping = false;
+    int64_t loopStart = 0;
+    int64_t loopEnd = 0;
+    double positionSeconds = 0.0;
+  };
+  // Audio thread only: how far one source has been read. Carries the play
+  // position in the converted buffer between blocks, so device-rate
+  // playback never rounds through the source rate; invalid after a seek or
+  // when the rates change. The render and the original each keep one.
+  struct SourcePlayhead {
+    juce::LagrangeInterpolator interpolator; // Live conversion
+    int64_t devicePosition = 0;
+    int devicePositionSourceRate = 0;
+    int devicePositionDeviceRate = 0;
+    // Pick up from the cursor next time
+    void reset() {
+      interpolator.reset();
+      devicePositionDeviceRate = 0;
+    }
+  };
+  // Play snapshot (or its device-rate copy) into out, returning the samples
+  // written: fewer than numSamples when playback runs off the end, or when
+  // stopAtLoopEnd is set and the loop wraps (cursor is then at its start)
+  int renderSource(const RenderSnapshot &snapshot,
+                   const RenderSnapshot *converted, float *out,
+                   int numSamples, PlaybackCursor &cursor,
+                   SourcePlayhead &playhead, bool stopAtLoopEnd,
+                   bool &wrapped);
+  // Cross-fade out towards other, sample by sample, moving originalMix
+  // towards target
+  void crossfadeOriginal(float *out, const float *other, int numSamples,
+                         float target);
+
+  // Background device-rate conversion; results are published on the
+  // message thread through selfRef
+  std::unique_ptr<PlaybackRateCache> rateCache;
+  std::unique_ptr<PlaybackRateCache> originalRateCache;
+  juce::WeakReference<AudioEngine> selfRef;
+
+  SourcePlayhead renderPlayhead;
+  SourcePlayhead originalPlayhead;
+
+  // Render generation the current loop pass plays (written by the audio
+  // thread, read when deciding what a new pass-held render must keep)
+  std::atomic<uint64_t> audibleGeneration{0};
+  uint64_t nextGeneration = 1; // Message thread only
+
+  // Contiguous input for the interpolator, gathered from snapshot tiles
+  std::vector<float> inputScratch = std::vector<float>(8192);
+  // The original while cross-fading; longer blocks fade in pieces
+  std::vector<float> originalScratch = std::vector<float>(4096);
+
+  static constexpr double abFadeSeconds = 0.01;
+  std::atomic<bool> playOriginal{false};
+  float originalMix = 0.0f; // Audio thread only: 1 plays only the original
 
   std::atomic<int64_t> currentPosition{0}; // Position in waveform samples
+  // Seek target for the audio thread to apply (and reset its interpolator),
+  // or -1; the interpolator is only touched from the callback
+  std::atomic<int64_t> pendingSeekSample{-1};
   std::atomic<bool> playing{false};
   std::atomic<bool> shouldStop{false};
 
   std::shared_ptr<PositionCallback> positionCallback;
   std::shared_ptr<FinishCallback> finishCallback;
 
-  std::shared_ptr<PositionUpdateState> positionUpdateState =
-      std::make_shared<PositionUpdateState>();
+  PublishedState<PlaybackStatus> publishedStatus;
+  uint32_t finishCount = 0; // Audio thread only
+  // Message thread only
+  uint64_t lastSeenStatusVersion = publishedStatus.getVersion();
+  uint32_t lastSeenFinishCount = 0;
 
   double currentSampleRate = 44100.0;
 
-  // For sample rate conversion
-  juce::LagrangeInterpolator interpolator;
-  double playbackRatio = 1.0;      // waveformSampleRate / deviceSampleRate
-  double fractionalPosition = 0.0; // Sub-sample position for interpolation
-
-  // Thread safety for waveform updates
-  juce::SpinLock waveformLock;
-
   // Volume control (linear gain, lock-free for audio thread)
   std::atomic<float> volumeGain{1.0f};
 
@@ -109,6 +237,8 @@ private:
   std::atomic<bool> loopEnabled{false};
   std::atomic<int64_t> loopStartSample{0};
   std::atomic<int64_t> loopEndSample{0};
+  std::atomic<bool> loopFocus{false};
 
+  JUCE_DECLARE_WEAK_REFERENCEABLE(AudioEngine)
   JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AudioEngine)
 };
@@ -0,0 +1,71 @@
+#include "ChunkSizer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cctype>
+#include <iterator>
+#include <string>
+
+ChunkSizer::ChunkSizer(std::vector<int> sizes, int defaultChunkSize)
+    : candidates([&sizes]() {
+        std::sort(sizes.begin(), sizes.end());
+        sizes.erase(std::unique(sizes.begin(), sizes.end()), sizes.end());
+        return sizes;
+      }()),
+      defaultSize(defaultChunkSize), current(defaultChunkSize) {}
+
+int ChunkSizer::calibrate(const Trial &trial, double maxSecondsPerChunk) {
+  int best = 0;
+  double bestThroughput = 0.0;
+  for (const int size : candidates) {
+    // The first run of a shape pays for kernel selection; time the second
+    if (!trial(size))
+      break;
+    const auto start = std::chrono::steady_clock::now();
+    if (!trial(size))
+      break;
+    const double seconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start)
+            .count();
+    const double throughput = size / std::max(seconds, 1.0e-6);
+    if (seconds <= maxSecondsPerChunk && throughput > bestThroughput) {
+      best = size;
+      bestThroughput = throughput;
+    }
+    if (seconds > maxSecondsPerChunk)
+      break;
+  }
+  if (best > 0)
+    current.store(best);
+  return current.load();
+}
+
+int ChunkSizer::shrink(int failedSize) {
+  const auto below =
+      std::lower_bound(candidates.begin(), candidates.end(), failedSize);
+  const int smaller = below == candidates.begin() ? 0 : *std::prev(below);
+  if (smaller <= 0)
+    return 0;
+  // Concurrent failures only ever lower the size
+  int expected = current.load();
+  while (expected > smaller &&
+         !current.compare_exchange_weak(expected, smaller)) {
+  }
+  return smaller;
+}
+
+bool ChunkSizer::isOutOfMemory(const char *message) {
+  if (message == nullptr)
+    return false;
+  std::string text(message);
+  std::transform(text.begin(), text.end(), text.begin(),
+                 [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+  // CUDA, DirectML, CoreML and std::bad_alloc phrasings
+  for (const char *marker : {"out of memory", "failed to allocate",
+                             "allocation failed", "bad_alloc",
+                             "bad allocation", "e_outofmemory"}) {
+    if (text.find(marker) != std::string::npos)
+      return true;
+  }
+  return false;
+}
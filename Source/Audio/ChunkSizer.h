@@ -0,0 +1,50 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <vector>
+
+/**
+ * The chunk size a model wrapper feeds its device, picked from measurement.
+ *
+ * The size starts at defaultSize. calibrate() times one trial run per
+ * candidate, smallest first, and keeps the size with the best throughput
+ * whose run finished within the latency cap; a failed trial (usually an
+ * allocation the device could not make) ends the search. When a real run
+ * fails for want of memory, shrink() moves to the next smaller candidate so
+ * the rest of the session stays below it. ONNX Runtime reports no per-run
+ * memory figure, so memory is only ever measured this way, by trial.
+ *
+ * get() and shrink() are safe from any thread; calibrate() is meant for
+ * warm-up, before real runs start.
+ */
+class ChunkSizer {
+public:
+  // Runs one chunk of the given size; false when it failed
+  using Trial = std::function<bool(int size)>;
+
+  ChunkSizer(std::vector<int> candidates, int defaultSize);
+
+  int get() const { return current.load(); }
+
+  /** @return the size chosen; the current one when no trial succeeded */
+  int calibrate(const Trial &trial, double maxSecondsPerChunk);
+
+  /**
+   * A run of failedSize ran out of memory: use the largest candidate below
+   * it from now on.
+   * @return that size, or 0 when failedSize is already the smallest
+   */
+  int shrink(int failedSize);
+
+  /** Back to defaultSize, e.g. after the model moved to another device. */
+  void reset() { current.store(defaultSize); }
+
+  /** Whether an exception message describes a failed allocation. */
+  static bool isOutOfMemory(const char *message);
+
+private:
+  const std::vector<int> candidates; // Ascending
+  const int defaultSize;
+  std::atomic<int> current;
+};
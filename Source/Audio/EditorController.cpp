@@ -1,17 +1,25 @@
 #include "EditorController.h"
+#include "HardwareCapabilities.h"
+#include "PerformanceMetrics.h"
+#include "RemoteInference.h"
+#include "../Utils/AudioResampler.h"
 #include "../Utils/Constants.h"
 #include "../Utils/F0Smoother.h"
 #include "../Utils/Localization.h"
+#include "../Utils/MelFormantShift.h"
 #include "../Utils/MelSpectrogram.h"
 #include "../Utils/PitchCurveProcessor.h"
 #include "../Utils/PlatformPaths.h"
 
 #include <algorithm>
+#include <chrono>
 #include <climits>
 #include <cmath>
+#include <map>
+#include <mutex>
+#include <thread>
 
 EditorController::EditorController(bool enableAudioDevice) {
-  project = std::make_unique<Project>();
   if (enableAudioDevice)
     audioEngine = std::make_unique<AudioEngine>();
 
@@ -19,42 +27,336 @@ EditorController::EditorController(bool enableAudioDevice) {
   rmvpePitchDetector = std::make_unique<RMVPEPitchDetector>();
   someDetector = std::make_unique<SOMEDetector>();
   vocoder = std::make_unique<Vocoder>();
+  // Extra vocoder sessions let export and preview renders run side by side;
+  // only worth the memory on machines with cores to spare.
+  vocoder->setSessionPoolSize(std::clamp(
+      static_cast<int>(std::thread::hardware_concurrency()) / 8, 1, 4));
+  previewVocoder = std::make_unique<Vocoder>();
   audioAnalyzer = std::make_unique<AudioAnalyzer>();
-  incrementalSynth = std::make_unique<IncrementalSynthesizer>();
   playbackController = std::make_unique<PlaybackController>();
 
-  auto modelsDir = PlatformPaths::getModelsDirectory();
-  fcpeModelPath = modelsDir.getChildFile("fcpe.onnx");
-  melFilterbankPath = modelsDir.getChildFile("mel_filterbank.bin");
-  centTablePath = modelsDir.getChildFile("cent_table.bin");
-  rmvpeModelPath = modelsDir.getChildFile("rmvpe.onnx");
-  someModelPath = modelsDir.getChildFile("some.onnx");
+  setModelsDirectory(PlatformPaths::getModelsDirectory());
 
   audioAnalyzer->setFCPEDetector(fcpePitchDetector.get());
   audioAnalyzer->setRMVPEDetector(rmvpePitchDetector.get());
   audioAnalyzer->setSOMEDetector(someDetector.get());
   audioAnalyzer->setPitchDetectorType(pitchDetectorType);
 
-  incrementalSynth->setVocoder(vocoder.get());
-  if (audioEngine)
+  if (audioEngine) {
     playbackController->setAudioEngine(audioEngine.get());
+
+    // Edits near the playhead are synthesized first while playing; with loop
+    // focus the loop comes first even while stopped. Every track plays at
+    // once, so each one's synthesizer follows the same transport.
+    playheadProvider =
+        [engine = audioEngine.get()]()
+            -> std::optional<SynthesisScheduler::Playhead> {
+          const bool focusedLoop =
+              engine->isLoopFocus() && engine->isLoopEnabled();
+          if (!engine->isPlaying() && !focusedLoop)
+            return std::nullopt;
+          SynthesisScheduler::Playhead playhead;
+          playhead.positionSeconds = engine->isPlaying()
+                                         ? engine->getPosition()
+                                         : engine->getLoopStart();
+          playhead.looping = engine->isLoopEnabled();
+          playhead.loopStartSeconds = engine->getLoopStart();
+          playhead.loopEndSeconds = engine->getLoopEnd();
+          playhead.loopFocus = focusedLoop;
+          return playhead;
+        };
+  }
+
+  tracks.push_back(makeTrack(std::make_unique<Project>(), {}));
+}
+
+void EditorController::setOfflineRenderFocus(
+    std::function<double()> waitPosition) {
+  if (audioEngine)
+    return;
+  playheadProvider = nullptr;
+  if (waitPosition)
+    playheadProvider = [waitPosition = std::move(waitPosition)]()
+        -> std::optional<SynthesisScheduler::Playhead> {
+      const double position = waitPosition();
+      if (position < 0.0)
+        return std::nullopt;
+      SynthesisScheduler::Playhead playhead;
+      playhead.positionSeconds = position;
+      return playhead;
+    };
+  for (auto &track : tracks)
+    track.synth->setPlayheadProvider(playheadProvider);
 }
 
 EditorController::~EditorController() {
-  if (modelReloadThread.joinable())
-    modelReloadThread.join();
+  cancelBenchmarkFlag = true;
+  benchmarkJob.wait();
+  modelLoadJobs.wait();
   cancelLoadingFlag = true;
-  if (loaderThread.joinable())
-    loaderThread.join();
-  if (loaderJoinerThread.joinable())
-    loaderJoinerThread.join();
+  loaderJobs.wait();
+  preanalysisJob.wait();
+  stopBackgroundAnalysis = true;
+  backgroundAnalysis.wait();
   cancelRenderFlag = true;
-  if (renderThread.joinable())
-    renderThread.join();
+  renderJob.wait();
+  cancelExportFlag = true;
+  exportJob.wait();
 }
 
 void EditorController::setProject(std::unique_ptr<Project> newProject) {
-  project = std::move(newProject);
+  auto &track = tracks[static_cast<size_t>(focusedTrack)];
+  track.project = std::move(newProject);
+  track.original =
+      track.project ? track.project->getAudioData().getRenderSnapshot()
+                    : nullptr;
+  ++projectGeneration;
+}
+
+EditorController::Track
+EditorController::makeTrack(std::unique_ptr<Project> trackProject,
+                            const juce::String &name) {
+  Track track;
+  track.name = name;
+  track.project = std::move(trackProject);
+  track.original = track.project->getAudioData().getRenderSnapshot();
+  track.synth = std::make_unique<IncrementalSynthesizer>();
+  track.synth->setVocoder(vocoder.get());
+  track.synth->setSharedCache(&synthesisCache);
+  track.synth->setPlayheadProvider(playheadProvider);
+  track.synth->setPreviewTier(previewTier);
+  if (!tracks.empty()) {
+    const auto &focused = *getIncrementalSynth();
+    track.synth->setPreviewVocoder(focused.getPreviewVocoder());
+    track.synth->setWindowedResynthesis(focused.isWindowedResynthesis());
+    track.synth->setInstantPreview(focused.isInstantPreview());
+    track.synth->setBackground(true);
+  }
+  return track;
+}
+
+void EditorController::setEditPreviewVocoder(Vocoder *editVocoder) {
+  std::lock_guard<std::mutex> lock(tracksMutex);
+  for (auto &track : tracks)
+    track.synth->setPreviewVocoder(editVocoder);
+}
+
+IncrementalSynthesizer *
+EditorController::getSynthFor(const Project &target) const {
+  for (const auto &track : tracks)
+    if (track.project.get() == &target)
+      return track.synth.get();
+  return getIncrementalSynth();
+}
+
+int EditorController::addTrack(std::unique_ptr<Project> trackProject,
+                               const juce::String &name) {
+  if (!trackProject)
+    trackProject = std::make_unique<Project>();
+  {
+    std::lock_guard<std::mutex> lock(tracksMutex);
+    tracks.push_back(makeTrack(std::move(trackProject), name));
+  }
+  publishPlayback();
+  return getNumTracks() - 1;
+}
+
+void EditorController::removeTrack(int index) {
+  if (index < 0 || index >= getNumTracks() || getNumTracks() == 1)
+    return;
+  const bool wasFocused = index == focusedTrack;
+  {
+    std::lock_guard<std::mutex> lock(tracksMutex);
+    tracks.erase(tracks.begin() + index);
+  }
+  if (index < focusedTrack)
+    --focusedTrack;
+  focusedTrack = std::min(focusedTrack, getNumTracks() - 1);
+  if (wasFocused)
+    focusTrack(focusedTrack);
+  else
+    publishPlayback();
+}
+
+void EditorController::focusTrack(int index) {
+  if (index < 0 || index >= getNumTracks())
+    return;
+  focusedTrack = index;
+  for (int i = 0; i < getNumTracks(); ++i)
+    tracks[static_cast<size_t>(i)].synth->setBackground(i != focusedTrack);
+  // Work in flight for the previous focus (note refinement, range analysis)
+  // no longer lands on getProject()
+  ++projectGeneration;
+  publishPlayback();
+}
+
+void EditorController::setTrackGain(int index, float gain) {
+  if (index < 0 || index >= getNumTracks())
+    return;
+  tracks[static_cast<size_t>(index)].gain = std::max(0.0f, gain);
+  publishPlayback();
+}
+
+void EditorController::setTrackMuted(int index, bool muted) {
+  if (index < 0 || index >= getNumTracks())
+    return;
+  tracks[static_cast<size_t>(index)].muted = muted;
+  publishPlayback();
+}
+
+void EditorController::setTrackName(int index, const juce::String &name) {
+  if (index >= 0 && index < getNumTracks())
+    tracks[static_cast<size_t>(index)].name = name;
+}
+
+void EditorController::publishPlayback(bool preservePosition) {
+  if (!audioEngine)
+    return;
+
+  // A project whose audio was replaced in place starts a new original
+  for (auto &track : tracks)
+    if (track.project) {
+      const auto render = track.project->getAudioData().getRenderSnapshot();
+      if (!track.original ||
+          track.original->getNumSamples() != render->getNumSamples() ||
+          track.original->getSampleRate() != render->getSampleRate())
+        track.original = render;
+    }
+
+  // The render as heard: the notes' gain lane on top of the vocoder output
+  auto playedRender = [](Track &track) {
+    const auto &audioData = track.project->getAudioData();
+    return track.gainStage.apply(
+        audioData.getRenderSnapshot(),
+        GainLane::fromNotes(track.project->getNotes(),
+                            audioData.getNumFrames(), HOP_SIZE));
+  };
+
+  auto &only = tracks.front();
+  if (tracks.size() == 1 && !only.muted && only.gain == 1.0f) {
+    sessionMixer.reset();
+    originalMixer.reset();
+    if (only.project) {
+      audioEngine->loadSnapshot(playedRender(only), preservePosition);
+      audioEngine->loadOriginal(only.original);
+    }
+    return;
+  }
+
+  // Muted tracks stay in at zero gain, so muting keeps the mix's length
+  std::vector<SessionMixer::Input> inputs;
+  std::vector<SessionMixer::Input> originals;
+  for (auto &track : tracks)
+    if (track.project) {
+      const float gain = track.muted ? 0.0f : track.gain;
+      inputs.push_back({playedRender(track), gain});
+      originals.push_back({track.original, gain});
+    }
+  audioEngine->loadSnapshot(sessionMixer.mix(inputs), preservePosition);
+  audioEngine->loadOriginal(originalMixer.mix(originals));
+}
+
+void EditorController::setModelsDirectory(const juce::File &modelsDir) {
+  fcpeModelPath = modelsDir.getChildFile("fcpe.onnx");
+  melFilterbankPath = modelsDir.getChildFile("mel_filterbank.bin");
+  centTablePath = modelsDir.getChildFile("cent_table.bin");
+  rmvpeModelPath = modelsDir.getChildFile("rmvpe.onnx");
+  someModelPath = modelsDir.getChildFile("some.onnx");
+  vocoderModelPath = modelsDir.getChildFile("pc_nsf_hifigan.onnx");
+}
+
+juce::File EditorController::getVocoderModelFile() const {
+  return resolveModelVariant(vocoderModelPath,
+                             getDeviceFor(OnnxThreading::Model::Vocoder),
+                             modelPrecision);
+}
+
+void EditorController::setPreviewTier(bool enabled) {
+  previewTier = enabled;
+  for (auto &track : tracks)
+    track.synth->setPreviewTier(enabled);
+}
+
+void EditorController::setRemoteInference(const juce::String &endpoint) {
+  const auto trimmed = endpoint.trim();
+  if (trimmed.isEmpty())
+    setRemoteInference(std::shared_ptr<RemoteInference>());
+  else if (!remoteInference || trimmed != remoteInference->getEndpoint())
+    setRemoteInference(std::make_shared<RemoteInference>(trimmed));
+}
+
+void EditorController::setRemoteInference(
+    std::shared_ptr<RemoteInference> remote) {
+  if (remote == remoteInference)
+    return;
+  remoteInference = std::move(remote);
+  vocoder->setRemoteInference(remoteInference);
+  rmvpePitchDetector->setRemoteInference(remoteInference);
+  LOG(remoteInference ? "EditorController: remote inference at " +
+                            remoteInference->getEndpoint()
+                      : juce::String("EditorController: remote inference off"));
+}
+
+std::vector<float>
+EditorController::extractPitchForClient(const std::vector<float> &audio16k,
+                                        float threshold) {
+  if (!waitForModel(OnnxThreading::Model::RMVPE))
+    return {};
+  std::lock_guard<std::mutex> lock(pitchDetectorMutex);
+  if (!rmvpePitchDetector->isLoaded())
+    return {};
+  return rmvpePitchDetector->extractF0(
+      audio16k.data(), static_cast<int>(audio16k.size()),
+      RMVPEPitchDetector::SAMPLE_RATE, threshold);
+}
+
+juce::File EditorController::getPreviewVocoderModelFile(
+    const juce::String &vocoderDevice) const {
+  // A distilled model first, then the fastest precision variant
+  const auto distilled = vocoderModelPath.getSiblingFile(
+      vocoderModelPath.getFileNameWithoutExtension() + ".preview" +
+      vocoderModelPath.getFileExtension());
+  const auto preview =
+      distilled.existsAsFile()
+          ? distilled
+          : resolveModelVariant(vocoderModelPath, vocoderDevice,
+                                ModelPrecision::Speed);
+  return preview == getVocoderModelFile() ? juce::File() : preview;
+}
+
+juce::String EditorController::getDeviceFor(OnnxThreading::Model model) const {
+  const auto &choice = modelDevices[static_cast<size_t>(model)];
+  return choice.first.isNotEmpty() ? choice.first : device;
+}
+
+int EditorController::getDeviceIdFor(OnnxThreading::Model model) const {
+  const auto &choice = modelDevices[static_cast<size_t>(model)];
+  return choice.first.isNotEmpty() ? choice.second : deviceId;
+}
+
+AnalysisCache::Key
+EditorController::makeAnalysisCacheKey(const AudioData &audioData) const {
+  using Model = OnnxThreading::Model;
+  auto describeModel = [this](Model model, const juce::File &baseModel) {
+    const auto file =
+        resolveModelVariant(baseModel, getDeviceFor(model), modelPrecision);
+    return file.getFileName() + ":" + juce::String(file.getSize()) + ":" +
+           juce::String(file.getLastModificationTime().toMilliseconds());
+  };
+
+  AnalysisCache::Key key;
+  key.audioHash = AnalysisCache::hashAudio(audioData.waveform);
+  key.sampleRate = audioData.sampleRate;
+  key.detector = pitchDetectorType;
+  key.modelVersion =
+      (pitchDetectorType == PitchDetectorType::FCPE
+           ? describeModel(Model::FCPE, fcpeModelPath)
+           : describeModel(Model::RMVPE, rmvpeModelPath)) +
+      "|" + describeModel(Model::SOME, someModelPath) + "|" +
+      juce::String::formatted("mel %d %d %d %g %g", N_FFT, HOP_SIZE, NUM_MELS,
+                              static_cast<double>(FMIN),
+                              static_cast<double>(FMAX));
+  return key;
 }
 
 GPUProvider EditorController::getProviderFromDevice(
@@ -70,100 +372,298 @@ GPUProvider EditorController::getProviderFromDevice(
   return GPUProvider::CPU;
 }
 
-void EditorController::reloadInferenceModels(bool async) {
-  auto provider = getProviderFromDevice(device);
-  int resolvedDeviceId = deviceId < 0 ? 0 : deviceId;
-
-  auto fcpePath = fcpeModelPath;
-  auto melPath = melFilterbankPath;
-  auto centPath = centTablePath;
-  auto rmvpePath = rmvpeModelPath;
-  auto somePath = someModelPath;
-
-  auto reloadTask = [device = device,
-                     provider,
-                     resolvedDeviceId,
-                     fcpePath,
-                     melPath,
-                     centPath,
-                     rmvpePath,
-                     somePath](EditorController *self) {
-    if (!self)
-      return;
+EditorController::ModelTarget
+EditorController::makeModelTarget(OnnxThreading::Model model) const {
+  using Model = OnnxThreading::Model;
+  const juce::File *baseModel = &vocoderModelPath;
+  if (model == Model::RMVPE)
+    baseModel = &rmvpeModelPath;
+  else if (model == Model::FCPE)
+    baseModel = &fcpeModelPath;
+  else if (model == Model::SOME)
+    baseModel = &someModelPath;
+
+  // Each model may run on its own device (benchmark picks); pick FP16/INT8
+  // variants where installed and preferred
+  auto modelDevice = getDeviceFor(model);
+  int modelDeviceId = std::max(0, getDeviceIdFor(model));
+
+  // Settings can name a provider or GPU this machine does not have (copied
+  // from another machine, an eGPU unplugged); those models load on the
+  // first GPU or the CPU instead of failing
+  const auto hardware = HardwareCapabilities::getInstance().get();
+  const auto &adapters = hardware->getAdapters(modelDevice);
+  if (!hardware->devices.contains(modelDevice)) {
+    LOG_WARNING("EditorController: " + modelDevice + " is not available, " +
+                OnnxThreading::getModelKey(model) + " runs on the CPU");
+    modelDevice = "CPU";
+    modelDeviceId = 0;
+  } else if (!adapters.empty() &&
+             modelDeviceId >= static_cast<int>(adapters.size())) {
+    LOG_WARNING("EditorController: no " + modelDevice + " device " +
+                juce::String(modelDeviceId) + ", " +
+                OnnxThreading::getModelKey(model) + " runs on device 0");
+    modelDeviceId = 0;
+  }
+  return ModelTarget{modelDevice, getProviderFromDevice(modelDevice),
+                     modelDeviceId,
+                     resolveModelVariant(*baseModel, modelDevice,
+                                         modelPrecision)};
+}
 
-    if (self->fcpePitchDetector) {
-      if (fcpePath.existsAsFile()) {
-        LOG("EditorController: loading FCPE model (device " + device +
-            ", id " + juce::String(resolvedDeviceId) + ")...");
-        if (self->fcpePitchDetector->loadModel(fcpePath, melPath, centPath,
-                                               provider, resolvedDeviceId)) {
-          LOG("FCPE pitch detector loaded successfully");
-        } else {
-          LOG("Failed to load FCPE model");
-        }
-      } else {
-        LOG("FCPE model not found at: " + fcpePath.getFullPathName());
-      }
+bool EditorController::loadModelNow(OnnxThreading::Model model,
+                                    const ModelTarget &target) {
+  using Model = OnnxThreading::Model;
+  const char *name = OnnxThreading::getModelKey(model);
+  if (!target.path.existsAsFile()) {
+    LOG(juce::String(name) + " model not found at: " +
+        target.path.getFullPathName());
+    return model == Model::Vocoder && vocoder->isLoaded();
+  }
+
+  LOG("EditorController: loading " + juce::String(name) + " model (device " +
+      target.device + ", id " + juce::String(target.deviceId) + ")...");
+  const double loadStart = juce::Time::getMillisecondCounterHiRes();
+  // Detectors are warmed up as soon as they load, so first-inference cost
+  // (EP init, kernel selection) is paid here rather than on the user's first
+  // analysis. The vocoder warms its own sessions.
+  bool loaded = false;
+  switch (model) {
+  case Model::Vocoder: {
+    // A loaded vocoder only switches when device or precision changed
+    loaded = (vocoder->isLoaded() && vocoder->getModelFile() == target.path) ||
+             vocoder->loadModel(target.path);
+    // Edits fall back to the full model until the preview one is in
+    setEditPreviewVocoder(nullptr);
+    const auto previewPath = previewTier && loaded
+                                 ? getPreviewVocoderModelFile(target.device)
+                                 : juce::File();
+    if (previewPath.existsAsFile() &&
+        ((previewVocoder->isLoaded() &&
+          previewVocoder->getModelFile() == previewPath) ||
+         previewVocoder->loadModel(previewPath))) {
+      LOG("EditorController: preview vocoder " + previewPath.getFileName());
+      setEditPreviewVocoder(previewVocoder.get());
     }
+    break;
+  }
+  case Model::RMVPE: {
+    // Warm-up runs under the detector's lock too: it shares the sessions
+    // and I/O bindings with the analysis that waits on this load
+    std::lock_guard<std::mutex> lock(pitchDetectorMutex);
+    loaded = rmvpePitchDetector->loadModel(target.path, target.provider,
+                                           target.deviceId);
+    if (loaded)
+      rmvpePitchDetector->warmUp();
+    break;
+  }
+  case Model::FCPE: {
+    std::lock_guard<std::mutex> lock(pitchDetectorMutex);
+    loaded = fcpePitchDetector->loadModel(target.path, melFilterbankPath,
+                                          centTablePath, target.provider,
+                                          target.deviceId);
+    if (loaded)
+      fcpePitchDetector->warmUp();
+    break;
+  }
+  case Model::SOME: {
+    std::lock_guard<std::mutex> lock(noteDetectorMutex);
+    loaded = someDetector->loadModel(target.path, target.provider,
+                                     target.deviceId);
+    if (loaded)
+      someDetector->warmUp();
+    break;
+  }
+  }
 
-    if (self->rmvpePitchDetector) {
-      if (rmvpePath.existsAsFile()) {
-        LOG("EditorController: loading RMVPE model (device " + device +
-            ", id " + juce::String(resolvedDeviceId) + ")...");
-        if (self->rmvpePitchDetector->loadModel(rmvpePath, provider,
-                                                resolvedDeviceId)) {
-          LOG("RMVPE pitch detector loaded successfully");
-        } else {
-          LOG("Failed to load RMVPE model");
-        }
-      } else {
-        LOG("RMVPE model not found at: " + rmvpePath.getFullPathName());
+  LOG(juce::String(name) +
+      (loaded ? " model ready" : " model failed to load") + " after " +
+      juce::String(juce::Time::getMillisecondCounterHiRes() - loadStart, 1) +
+      " ms");
+  return loaded;
+}
+
+void EditorController::startModelLoad(OnnxThreading::Model model) {
+  auto &slot = modelLoads[static_cast<size_t>(model)];
+  auto loaded = std::make_shared<std::atomic<bool>>(false);
+  slot.loaded = loaded;
+  slot.job = modelLoadJobs.submit(
+      JobSystem::Priority::Normal,
+      [this, model, target = makeModelTarget(model), loaded]() {
+        loaded->store(loadModelNow(model, target));
+      });
+}
+
+void EditorController::reloadInferenceModels(bool async) {
+  using Model = OnnxThreading::Model;
+
+  std::vector<JobSystem::JobHandle> started;
+  {
+    std::unique_lock<std::mutex> lock(modelLoadMutex);
+    for (;;) {
+      std::vector<JobSystem::JobHandle> inFlight;
+      for (const auto &load : modelLoads)
+        if (load.loaded && !load.job.isDone())
+          inFlight.push_back(load.job);
+      if (inFlight.empty())
+        break;
+      if (async) {
+        LOG("EditorController: models still loading, reload skipped");
+        return;
       }
+      // A batch or bench caller runs with the new settings next, so the
+      // loads in progress finish first and the reload follows
+      lock.unlock();
+      for (auto &job : inFlight)
+        job.wait();
+      lock.lock();
     }
 
-    if (self->someDetector) {
-      if (somePath.existsAsFile()) {
-        LOG("EditorController: loading SOME model (device " + device + ", id " +
-            juce::String(resolvedDeviceId) + ")...");
-        if (self->someDetector->loadModel(somePath, provider,
-                                          resolvedDeviceId)) {
-          LOG("SOME detector loaded successfully");
-        } else {
-          LOG("Failed to load SOME model");
-        }
+    const auto vocoderTarget = makeModelTarget(Model::Vocoder);
+    vocoder->setExecutionDevice(vocoderTarget.device);
+    if (vocoderDeviceIds.size() > 1)
+      vocoder->setExecutionDeviceIds(vocoderDeviceIds);
+    else
+      vocoder->setExecutionDeviceId(vocoderTarget.deviceId);
+    // One session on the first device: it only serves edits
+    previewVocoder->setExecutionDevice(vocoderTarget.device);
+    previewVocoder->setExecutionDeviceId(vocoderTarget.deviceId);
+
+    // The vocoder, SOME and the selected pitch detector load side by side
+    // now; the other detector waits until something asks for it
+    const auto selectedDetector = pitchDetectorType == PitchDetectorType::FCPE
+                                      ? Model::FCPE
+                                      : Model::RMVPE;
+    for (auto model :
+         {Model::Vocoder, Model::RMVPE, Model::FCPE, Model::SOME}) {
+      if (model == Model::Vocoder || model == Model::SOME ||
+          model == selectedDetector) {
+        startModelLoad(model);
+        started.push_back(modelLoads[static_cast<size_t>(model)].job);
       } else {
-        LOG("SOME model not found at: " + somePath.getFullPathName());
+        modelLoads[static_cast<size_t>(model)] = {};
       }
     }
-  };
-
-  if (!async) {
-    reloadTask(this);
-    return;
   }
 
-  if (isReloadingModels.exchange(true))
-    return;
+  if (!async)
+    for (auto &load : started)
+      load.wait();
+}
 
-  if (modelReloadThread.joinable())
-    modelReloadThread.join();
+bool EditorController::waitForModel(OnnxThreading::Model model) {
+  ModelLoad load;
+  {
+    std::lock_guard<std::mutex> lock(modelLoadMutex);
+    if (!modelLoads[static_cast<size_t>(model)].loaded)
+      startModelLoad(model); // Not needed until now: load it on first use
+    load = modelLoads[static_cast<size_t>(model)];
+  }
+  load.job.wait();
+  return load.loaded->load();
+}
 
-  modelReloadThread = std::thread([this, reloadTask]() mutable {
-    reloadTask(this);
-    isReloadingModels = false;
-  });
+bool EditorController::isModelReady(OnnxThreading::Model model) const {
+  std::lock_guard<std::mutex> lock(modelLoadMutex);
+  const auto &load = modelLoads[static_cast<size_t>(model)];
+  return load.loaded && load.job.isDone();
+}
+
+bool EditorController::areModelsLoading() const {
+  std::lock_guard<std::mutex> lock(modelLoadMutex);
+  for (const auto &load : modelLoads)
+    if (load.loaded && !load.job.isDone())
+      return true;
+  return false;
 }
 
 bool EditorController::isInferenceBusy() const {
   if (audioAnalyzer && audioAnalyzer->isAnalyzing())
     return true;
-  if (incrementalSynth && incrementalSynth->isSynthesizing())
+  for (const auto &track : tracks)
+    if (track.synth->isSynthesizing())
+      return true;
+  if (areModelsLoading())
+    return true;
+  if (isBenchmarkingFlag.load())
     return true;
-  if (isReloadingModels.load())
+  if (isAnalyzingRangeFlag.load())
     return true;
   return false;
 }
 
+void EditorController::runProviderBenchmarkAsync(
+    const ProgressCallback &onProgress,
+    const BenchmarkCompleteCallback &onComplete) {
+  if (isBenchmarkingFlag.exchange(true))
+    return;
+
+  benchmarkJob.wait();
+
+  ProviderBenchmark::ModelFiles files;
+  files.vocoder = getVocoderModelFile();
+  files.rmvpe = rmvpeModelPath;
+  files.fcpe = fcpeModelPath;
+  files.melFilterbank = melFilterbankPath;
+  files.centTable = centTablePath;
+  files.some = someModelPath;
+
+  // Models already loaded (or loading) are timed where they are rather
+  // than loaded a second time; the others are not loaded for this
+  using Model = OnnxThreading::Model;
+  ProviderBenchmark::LoadedModels loaded;
+  loaded.vocoder = vocoder.get();
+  loaded.rmvpe = rmvpePitchDetector.get();
+  loaded.fcpe = fcpePitchDetector.get();
+  loaded.some = someDetector.get();
+  loaded.pitchDetectorMutex = &pitchDetectorMutex;
+  loaded.noteDetectorMutex = &noteDetectorMutex;
+  std::array<ModelLoad, 4> loads;
+  {
+    std::lock_guard<std::mutex> lock(modelLoadMutex);
+    loads = modelLoads;
+  }
+  for (auto model : {Model::Vocoder, Model::RMVPE, Model::FCPE, Model::SOME}) {
+    const auto target = makeModelTarget(model);
+    loaded.placements[static_cast<size_t>(model)] = {target.device,
+                                                     target.deviceId};
+  }
+
+  cancelBenchmarkFlag = false;
+  auto benchmark = [this, files, loaded, loads, onProgress,
+                    onComplete]() mutable {
+    for (size_t i = 0; i < loads.size(); ++i) {
+      if (loads[i].loaded)
+        loads[i].job.wait();
+      if (!loads[i].loaded || !loads[i].loaded->load())
+        loaded.placements[i] = {};
+    }
+
+    auto results = ProviderBenchmark::run(
+        files, *HardwareCapabilities::getInstance().get(), loaded,
+        [onProgress](double progress, const juce::String &message) {
+          if (onProgress)
+            juce::MessageManager::callAsync([onProgress, progress, message]() {
+              onProgress(progress, message);
+            });
+        },
+        cancelBenchmarkFlag);
+
+    const bool cancelled = cancelBenchmarkFlag.load();
+    isBenchmarkingFlag = false;
+    if (cancelled)
+      return;
+
+    juce::MessageManager::callAsync(
+        [onComplete, results = std::move(results)]() {
+          if (onComplete)
+            onComplete(results);
+        });
+  };
+  benchmarkJob = JobSystem::getInstance().submit(
+      JobSystem::Priority::Background, std::move(benchmark));
+}
+
 void EditorController::requestCancelLoading() {
   cancelLoadingFlag = true;
 }
@@ -172,55 +672,65 @@ void EditorController::loadAudioFileAsync(
     const juce::File &file,
     const ProgressCallback &onProgress,
     const LoadCompleteCallback &onComplete,
-    const CancelCallback &onCancelled) {
+    const CancelCallback &onCancelled,
+    const AnalysisPreviewCallback &onPreview,
+    const NotesRefinedCallback &onNotesRefined) {
   if (isLoadingAudio.load())
     return;
 
+  // The previous import's notes are of no use once this one replaces it
+  if (refiningNotes.load())
+    cancelLoadingFlag = true;
+  loaderJobs.wait();
+
   cancelLoadingFlag = false;
   isLoadingAudio = true;
 
-  if (loaderThread.joinable())
-    loaderThread.join();
-
-  loaderThread = std::thread([this, file, onProgress, onComplete, onCancelled]() {
+  auto load = [this, file, onProgress, onComplete, onCancelled, onPreview,
+               onNotesRefined]() {
     auto updateProgress = [&](double p, const juce::String &msg) {
       if (onProgress)
         onProgress(p, msg);
     };
 
-    updateProgress(0.05, TR("progress.loading_audio"));
-
-    juce::AudioFormatManager formatManager;
-    formatManager.registerBasicFormats();
+    // Show the waveform while the rest decodes. The preview gets copies of
+    // the decoded prefix at doubling lengths, so copying stays linear in
+    // the length of the file; analysis itself needs all of it
+    constexpr int firstPreviewSamples = SAMPLE_RATE * 10;
+    int previewedSamples = 0;
+    auto onDecoded = [&](const juce::AudioBuffer<float> &decoding,
+                         int numDecoded) {
+      const int totalSamples = decoding.getNumSamples();
+      if (!onPreview || numDecoded >= totalSamples ||
+          numDecoded < std::max(firstPreviewSamples, 2 * previewedSamples))
+        return;
+      previewedSamples = numDecoded;
+
+      AnalysisPreview partial;
+      partial.totalFrames = std::max(1, totalSamples / HOP_SIZE + 1);
+      partial.sampleRate = SAMPLE_RATE;
+      partial.waveform =
+          std::make_shared<juce::AudioBuffer<float>>(1, numDecoded);
+      partial.waveform->copyFrom(0, 0, decoding, 0, 0, numDecoded);
+      onPreview(std::move(partial));
+    };
 
-    std::unique_ptr<juce::AudioFormatReader> reader(
-        formatManager.createReaderFor(file));
-    if (reader == nullptr || cancelLoadingFlag.load()) {
+    juce::AudioBuffer<float> buffer;
+    int sourceSampleRate = SAMPLE_RATE;
+    if (!readAudioFile(file, buffer, updateProgress, &cancelLoadingFlag,
+                       onDecoded, &sourceSampleRate)) {
       isLoadingAudio = false;
       if (onCancelled)
         juce::MessageManager::callAsync(onCancelled);
       return;
     }
 
-    const int numSamples = static_cast<int>(reader->lengthInSamples);
-    const int srcSampleRate = static_cast<int>(reader->sampleRate);
-
-    juce::AudioBuffer<float> buffer(1, numSamples);
-
-    updateProgress(0.10, "Reading audio...");
-    if (reader->numChannels == 1) {
-      reader->read(&buffer, 0, numSamples, 0, true, false);
-    } else {
-      juce::AudioBuffer<float> stereoBuffer(2, numSamples);
-      reader->read(&stereoBuffer, 0, numSamples, 0, true, true);
-
-      const float *left = stereoBuffer.getReadPointer(0);
-      const float *right = stereoBuffer.getReadPointer(1);
-      float *mono = buffer.getWritePointer(0);
-
-      for (int i = 0; i < numSamples; ++i)
-        mono[i] = (left[i] + right[i]) * 0.5f;
-    }
+    updateProgress(0.22, "Preparing project...");
+    auto newProject = std::make_unique<Project>();
+    newProject->setFilePath(file);
+    auto &audioData = newProject->getAudioData();
+    audioData.setSourceAudio(std::move(buffer), SAMPLE_RATE);
+    audioData.sessionSampleRate = sourceSampleRate;
 
     if (cancelLoadingFlag.load()) {
       isLoadingAudio = false;
@@ -229,37 +739,55 @@ void EditorController::loadAudioFileAsync(
       return;
     }
 
-    if (srcSampleRate != SAMPLE_RATE) {
-      updateProgress(0.18, "Resampling...");
-      const double ratio = static_cast<double>(srcSampleRate) / SAMPLE_RATE;
-      const int newNumSamples = static_cast<int>(numSamples / ratio);
-
-      juce::AudioBuffer<float> resampledBuffer(1, newNumSamples);
-      const float *src = buffer.getReadPointer(0);
-      float *dst = resampledBuffer.getWritePointer(0);
+    // The generation setProject() gives the loaded project, for a
+    // refinement to tell whether it is still the one shown
+    auto generation = std::make_shared<std::uint64_t>(0);
+    auto handOver = [&](std::unique_ptr<Project> loaded) {
+      updateProgress(0.95, "Finalizing...");
+
+      juce::AudioBuffer<float> originalWaveform;
+      originalWaveform.makeCopyOf(loaded->getAudioData().waveform);
+
+      juce::MessageManager::callAsync(
+          [this, project = std::move(loaded), generation,
+           original = std::move(originalWaveform), onComplete]() mutable {
+            setProject(std::move(project));
+            *generation = projectGeneration;
+            isLoadingAudio = false;
+            if (onComplete)
+              onComplete(original);
+          });
+    };
 
-      for (int i = 0; i < newNumSamples; ++i) {
-        const double srcPos = i * ratio;
-        const int srcIndex = static_cast<int>(srcPos);
-        const double frac = srcPos - srcIndex;
+    std::vector<Note> provisionalNotes;
+    bool handedOver = false;
+    std::function<void(const Project &)> onProvisional;
+    if (onNotesRefined)
+      onProvisional = [&](const Project &provisional) {
+        provisionalNotes = provisional.getNotes();
+        handedOver = true;
+        refiningNotes = true;
+        handOver(std::make_unique<Project>(provisional));
+      };
 
-        if (srcIndex + 1 < numSamples)
-          dst[i] = static_cast<float>(src[srcIndex] * (1.0 - frac) +
-                                      src[srcIndex + 1] * frac);
-        else
-          dst[i] = src[srcIndex];
-      }
+    updateProgress(0.25, TR("progress.analyzing_audio"));
+    analyzeAudio(*newProject, updateProgress, nullptr, onPreview,
+                 &cancelLoadingFlag, onProvisional);
 
-      buffer = std::move(resampledBuffer);
+    if (handedOver) {
+      refiningNotes = false;
+      if (cancelLoadingFlag.load() || newProject->getNotes().empty())
+        return;
+      juce::MessageManager::callAsync(
+          [this, generation, onNotesRefined,
+           provisional = std::move(provisionalNotes),
+           refined = newProject->getNotes()]() mutable {
+            if (getProject() && projectGeneration == *generation)
+              onNotesRefined(provisional, std::move(refined));
+          });
+      return;
     }
 
-    updateProgress(0.22, "Preparing project...");
-    auto newProject = std::make_unique<Project>();
-    newProject->setFilePath(file);
-    auto &audioData = newProject->getAudioData();
-    audioData.waveform = std::move(buffer);
-    audioData.sampleRate = SAMPLE_RATE;
-
     if (cancelLoadingFlag.load()) {
       isLoadingAudio = false;
       if (onCancelled)
@@ -267,30 +795,63 @@ void EditorController::loadAudioFileAsync(
       return;
     }
 
-    updateProgress(0.25, TR("progress.analyzing_audio"));
-    analyzeAudio(*newProject, updateProgress);
+    handOver(std::move(newProject));
+  };
+  loaderJobs.submit(JobSystem::Priority::Normal, std::move(load));
+}
 
-    if (cancelLoadingFlag.load()) {
-      isLoadingAudio = false;
-      if (onCancelled)
-        juce::MessageManager::callAsync(onCancelled);
-      return;
-    }
+bool EditorController::readAudioFile(
+    const juce::File &file, juce::AudioBuffer<float> &mono,
+    const ProgressCallback &onProgress, const std::atomic<bool> *cancelFlag,
+    const AudioFileManager::DecodeCallback &onDecoded, int *sourceSampleRate) {
+  if (onProgress)
+    onProgress(0.05, TR("progress.loading_audio"));
 
-    updateProgress(0.95, "Finalizing...");
+  return AudioFileManager::decodeMono(
+      file, mono, SAMPLE_RATE,
+      [&](const juce::AudioBuffer<float> &decoding, int numDecoded) {
+        if (onProgress)
+          onProgress(0.10 + 0.10 * numDecoded /
+                                std::max(1, decoding.getNumSamples()),
+                     "Reading audio...");
+        if (onDecoded)
+          onDecoded(decoding, numDecoded);
+      },
+      cancelFlag, sourceSampleRate);
+}
 
-    juce::AudioBuffer<float> originalWaveform;
-    originalWaveform.makeCopyOf(audioData.waveform);
+// Host audio to SAMPLE_RATE, each channel through the same windowed-sinc
+// resampler as file imports. The whole take is converted once here; the
+// session keeps its own rate for playback and export.
+static juce::AudioBuffer<float>
+resampleHostAudio(const juce::AudioBuffer<float> &buffer, int sampleRate) {
+  const auto resampler = AudioResampler::get(sampleRate, SAMPLE_RATE);
+  juce::AudioBuffer<float> resampled(
+      buffer.getNumChannels(),
+      resampler->getOutputLength(buffer.getNumSamples()));
+  for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+    resampler->process(buffer.getReadPointer(ch), buffer.getNumSamples(),
+                       resampled.getWritePointer(ch));
+  return resampled;
+}
 
-    juce::MessageManager::callAsync(
-        [this, project = std::move(newProject),
-         original = std::move(originalWaveform), onComplete]() mutable {
-          setProject(std::move(project));
-          isLoadingAudio = false;
-          if (onComplete)
-            onComplete(original);
-        });
-  });
+// Host audio into audioData at SAMPLE_RATE, as every host analysis sees it.
+// The waveform is channel 0; the other channels only live in the render
+// snapshot, for the ranges that are never resynthesized.
+static void loadHostAudio(AudioData &audioData,
+                          const juce::AudioBuffer<float> &buffer,
+                          double sampleRate) {
+  const int hostRate = static_cast<int>(std::lround(sampleRate));
+  if (hostRate > 0 && hostRate != SAMPLE_RATE) {
+    auto resampled = resampleHostAudio(buffer, hostRate);
+    if (resampled.getNumSamples() > 0) {
+      audioData.setSourceAudio(std::move(resampled), SAMPLE_RATE);
+      audioData.sessionSampleRate = hostRate;
+      return;
+    }
+  }
+  audioData.setSourceAudio(buffer, static_cast<int>(sampleRate));
+  audioData.sessionSampleRate = audioData.sampleRate;
 }
 
 void EditorController::setHostAudioAsync(
@@ -299,59 +860,23 @@ void EditorController::setHostAudioAsync(
     const ProgressCallback &onProgress,
     const LoadCompleteCallback &onComplete) {
   isLoadingAudio = true;
+  // The load being replaced sees the new job id and drops its result; it
+  // finishes on its own instead of being waited for here
   cancelLoadingFlag.store(true);
-  if (loaderThread.joinable()) {
-    if (loaderJoinerThread.joinable())
-      loaderJoinerThread.join();
-    auto old = std::move(loaderThread);
-    loaderJoinerThread = std::thread([t = std::move(old)]() mutable {
-      if (t.joinable())
-        t.join();
-    });
-  }
   cancelLoadingFlag.store(false);
 
   const auto jobId = hostAnalysisJobId.fetch_add(1) + 1;
 
-  loaderThread = std::thread([this, buffer, sampleRate, onProgress, onComplete, jobId]() mutable {
+  auto load = [this, buffer, sampleRate, onProgress, onComplete,
+               jobId]() mutable {
     if (cancelLoadingFlag.load() || hostAnalysisJobId.load() != jobId)
     {
       isLoadingAudio = false;
       return;
     }
 
-    juce::AudioBuffer<float> resampledBuffer;
-    const double inputSampleRate = sampleRate;
-    if (inputSampleRate > 0.0 &&
-        std::abs(inputSampleRate - static_cast<double>(SAMPLE_RATE)) > 1e-6) {
-      const int inSamples = buffer.getNumSamples();
-      const int outSamples = static_cast<int>(
-          std::llround(static_cast<double>(inSamples) *
-                       (static_cast<double>(SAMPLE_RATE) / inputSampleRate)));
-      const int channels = buffer.getNumChannels();
-      resampledBuffer.setSize(channels, std::max(0, outSamples), false, false,
-                              true);
-      resampledBuffer.clear();
-
-      const double ratio = inputSampleRate / static_cast<double>(SAMPLE_RATE);
-      for (int ch = 0; ch < channels; ++ch) {
-        juce::LagrangeInterpolator interp;
-        interp.reset();
-        interp.process(ratio, buffer.getReadPointer(ch),
-                       resampledBuffer.getWritePointer(ch),
-                       resampledBuffer.getNumSamples());
-      }
-    }
-
-    const juce::AudioBuffer<float> &stored =
-        resampledBuffer.getNumSamples() > 0 ? resampledBuffer : buffer;
-    const double storedSampleRate = resampledBuffer.getNumSamples() > 0
-                                        ? static_cast<double>(SAMPLE_RATE)
-                                        : inputSampleRate;
-
     auto projectCopy = std::make_unique<Project>();
-    projectCopy->getAudioData().waveform = stored;
-    projectCopy->getAudioData().sampleRate = static_cast<int>(storedSampleRate);
+    loadHostAudio(projectCopy->getAudioData(), buffer, sampleRate);
 
     auto updateProgress = [&](double p, const juce::String &msg) {
       if (cancelLoadingFlag.load() || hostAnalysisJobId.load() != jobId)
@@ -360,7 +885,8 @@ void EditorController::setHostAudioAsync(
         onProgress(p, msg);
     };
 
-    analyzeAudio(*projectCopy, updateProgress);
+    analyzeAudio(*projectCopy, updateProgress, nullptr, nullptr,
+                 &cancelLoadingFlag);
 
     if (cancelLoadingFlag.load() || hostAnalysisJobId.load() != jobId)
     {
@@ -381,6 +907,82 @@ void EditorController::setHostAudioAsync(
           if (onComplete)
             onComplete(original);
         });
+  };
+  loaderJobs.submit(JobSystem::Priority::Normal, std::move(load));
+}
+
+bool EditorController::preanalyzeHostAudio(
+    const juce::AudioBuffer<float> &prefix, double sampleRate) {
+  if (pitchDetectorType != PitchDetectorType::RMVPE || !rmvpePitchDetector ||
+      !rmvpePitchDetector->isLoaded() || prefix.getNumChannels() == 0 ||
+      sampleRate <= 0.0)
+    return false;
+  if (preanalysisBusy.exchange(true))
+    return false;
+
+  // Prepare channel 0 exactly as setHostAudioAsync() and analyzeAudio() will,
+  // short of the tail whose samples still depend on audio not captured yet:
+  // a resampler stream only emits outputs its input so far determines
+  juce::AudioBuffer<float> mono;
+  int monoRate = SAMPLE_RATE;
+  const int hostRate = static_cast<int>(std::lround(sampleRate));
+  if (hostRate != SAMPLE_RATE) {
+    AudioResampler::Stream stream(hostRate, SAMPLE_RATE);
+    std::vector<float> stable;
+    stream.push(prefix.getReadPointer(0), prefix.getNumSamples(), stable);
+    mono.setSize(1, static_cast<int>(stable.size()));
+    std::copy(stable.begin(), stable.end(), mono.getWritePointer(0));
+  } else {
+    mono.setSize(1, prefix.getNumSamples());
+    mono.copyFrom(0, 0, prefix, 0, 0, prefix.getNumSamples());
+    monoRate = hostRate;
+  }
+
+  auto preanalyze = [this, mono = std::move(mono), monoRate]() {
+    constexpr int resamplerMarginSamples = RMVPEPitchDetector::SAMPLE_RATE / 10;
+    const auto audio16k = AudioResampler::resample(
+        mono.getReadPointer(0), mono.getNumSamples(), monoRate,
+        RMVPEPitchDetector::SAMPLE_RATE);
+    const int stableSamples =
+        static_cast<int>(audio16k.size()) - resamplerMarginSamples;
+
+    int inferred = 0;
+    {
+      std::lock_guard<std::mutex> lock(pitchDetectorMutex);
+      if (stableSamples > 0)
+        inferred =
+            rmvpePitchDetector->precomputeChunks(audio16k.data(), stableSamples);
+    }
+    if (inferred > 0)
+      LOG("Capture pre-analysis: " + juce::String(inferred) +
+          " pitch chunk(s) inferred ahead of finalize");
+    preanalysisBusy = false;
+  };
+  preanalysisJob = JobSystem::getInstance().submit(
+      JobSystem::Priority::Background, std::move(preanalyze));
+  return true;
+}
+
+void EditorController::analyzeHostAudioInBackground(
+    const juce::AudioBuffer<float> &buffer, double sampleRate,
+    const std::function<void(const juce::String &)> &onComplete) {
+  backgroundAnalysis.submit([this, buffer, sampleRate, onComplete]() {
+    if (stopBackgroundAnalysis.load())
+      return;
+
+    Project hidden;
+    loadHostAudio(hidden.getAudioData(), buffer, sampleRate);
+    analyzeAudio(hidden, [](double, const juce::String &) {});
+
+    // analyzeAudio() caches only complete results
+    juce::String cacheEntry;
+    if (hidden.getAudioData().waveform.getNumSamples() > 0 &&
+        !hidden.getNotes().empty())
+      cacheEntry = makeAnalysisCacheKey(hidden.getAudioData()).getFileName();
+    juce::MessageManager::callAsync([onComplete, cacheEntry]() {
+      if (onComplete)
+        onComplete(cacheEntry);
+    });
   });
 }
 
@@ -391,23 +993,21 @@ void EditorController::requestCancelRender() {
 void EditorController::renderProcessedAudioAsync(
     const Project &project,
     float globalPitchOffset,
-    const std::function<void(bool)> &onComplete) {
+    const std::function<void(bool)> &onComplete,
+    std::pair<int, int> frameRange) {
   cancelRenderFlag = true;
-  if (renderThread.joinable())
-    renderThread.join();
+  renderJob.wait();
   isRenderingFlag = false;
   cancelRenderFlag = false;
 
-  auto f0Snapshot = project.getAudioData().f0;
-  auto voicedMaskSnapshot = project.getAudioData().voicedMask;
-  auto melSpecSnapshot = project.getAudioData().melSpectrogram;
+  // Pinned rather than copied: the contiguous curves are built on the job
+  auto snapshot = project.getSnapshot();
   Vocoder *voc = vocoder.get();
 
-  renderThread = std::thread(
-      [this, f0Snapshot = std::move(f0Snapshot),
-       voicedMaskSnapshot = std::move(voicedMaskSnapshot),
-       melSpecSnapshot = std::move(melSpecSnapshot), globalPitchOffset, voc,
-       onComplete]() mutable {
+  renderJob = JobSystem::getInstance().submit(
+      JobSystem::Priority::Normal,
+      [this, snapshot = std::move(snapshot), globalPitchOffset, voc,
+       skipOptions = silenceSkipping, onComplete, frameRange]() mutable {
         isRenderingFlag = true;
 
         auto finishRendering = [this]() { isRenderingFlag = false; };
@@ -415,6 +1015,16 @@ void EditorController::renderProcessedAudioAsync(
         if (cancelRenderFlag.load())
           return finishRendering();
 
+        std::vector<float> f0Snapshot;
+        VoicedMask voicedMaskSnapshot;
+        MelBuffer melSpecSnapshot;
+        snapshot.curves->copyF0(f0Snapshot);
+        snapshot.curves->copyVoicedMask(voicedMaskSnapshot);
+        snapshot.curves->copyMel(melSpecSnapshot);
+        if (snapshot.formantShift != 0.0f)
+          melSpecSnapshot =
+              MelFormantShift::apply(melSpecSnapshot, snapshot.formantShift);
+
         if (f0Snapshot.empty() || melSpecSnapshot.empty()) {
           if (onComplete)
             juce::MessageManager::callAsync([onComplete]() { onComplete(false); });
@@ -424,43 +1034,487 @@ void EditorController::renderProcessedAudioAsync(
         if (voicedMaskSnapshot.size() < f0Snapshot.size())
           voicedMaskSnapshot.resize(f0Snapshot.size(), true);
 
-        for (size_t i = 0; i < f0Snapshot.size(); ++i) {
-          if (cancelRenderFlag.load())
-            return finishRendering();
-          if (voicedMaskSnapshot[i] && f0Snapshot[i] > 0)
-            f0Snapshot[i] *= std::pow(2.0f, globalPitchOffset / 12.0f);
-        }
+        shiftVoicedF0(f0Snapshot, voicedMaskSnapshot, globalPitchOffset);
 
         if (cancelRenderFlag.load())
           return finishRendering();
 
-        auto synthesized = voc ? voc->infer(melSpecSnapshot, f0Snapshot)
-                               : std::vector<float>{};
+        if (frameRange.second > frameRange.first) {
+          const bool ok = renderRange(
+              melSpecSnapshot, f0Snapshot, frameRange,
+              [this](const float *, int, juce::int64) {
+                return !cancelRenderFlag.load();
+              },
+              &cancelRenderFlag);
+          if (cancelRenderFlag.load())
+            return finishRendering();
+          if (onComplete)
+            juce::MessageManager::callAsync(
+                [onComplete, ok]() { onComplete(ok); });
+          return finishRendering();
+        }
+
+        // Stream in chunks so peak memory stays flat for long takes.
+        Vocoder::StreamingOptions streaming;
+        streaming.skipFrames = SilenceSkipping::findSpans(
+            melSpecSnapshot, voicedMaskSnapshot, skipOptions);
+        juce::int64 renderedSamples = 0;
+        const bool streamed =
+            voc && voc->inferStreaming(
+                       melSpecSnapshot, f0Snapshot,
+                       [this, &renderedSamples](const float *, int numSamples,
+                                                juce::int64) {
+                         renderedSamples += numSamples;
+                         return !cancelRenderFlag.load();
+                       },
+                       streaming, &cancelRenderFlag);
 
         if (cancelRenderFlag.load())
           return finishRendering();
 
+        // A take that is silent throughout renders nothing and is still done
+        const bool ok = streamed && (renderedSamples > 0 ||
+                                     !streaming.skipFrames.empty());
         if (onComplete)
           juce::MessageManager::callAsync(
-              [onComplete, ok = !synthesized.empty()]() { onComplete(ok); });
+              [onComplete, ok]() { onComplete(ok); });
         finishRendering();
       });
 }
 
+bool EditorController::renderProcessedAudio(const Project &sourceProject,
+                                            juce::AudioBuffer<float> &output,
+                                            const std::atomic<bool> *cancelFlag) {
+  const auto &audioData = sourceProject.getAudioData();
+  if (!vocoder || !vocoder->isLoaded() || audioData.f0.empty() ||
+      audioData.melSpectrogram.empty())
+    return false;
+
+  auto f0 = audioData.f0;
+  auto voicedMask = audioData.voicedMask;
+  if (voicedMask.size() < f0.size())
+    voicedMask.resize(f0.size(), true);
+  shiftVoicedF0(f0, voicedMask, sourceProject.getGlobalPitchOffset());
+
+  const float formantShift = sourceProject.getFormantShift();
+  MelBuffer shiftedMel;
+  if (formantShift != 0.0f)
+    shiftedMel = MelFormantShift::apply(audioData.melSpectrogram, formantShift);
+
+  const MelView mel = formantShift != 0.0f ? shiftedMel.view()
+                                           : audioData.melSpectrogram.view();
+  Vocoder::StreamingOptions streaming;
+  streaming.skipFrames =
+      SilenceSkipping::findSpans(mel, voicedMask, silenceSkipping);
+  const auto original = audioData.getRenderSnapshot();
+
+  // Sized for the expected length up front; chunks past it grow the buffer
+  const int expectedSamples = static_cast<int>(f0.size()) * HOP_SIZE;
+  output.setSize(1, expectedSamples, false, true);
+  int renderedSamples = 0;
+  auto fillTo = [&](int end) {
+    if (end > renderedSamples)
+      SilenceSkipping::fillGap(silenceSkipping, original.get(),
+                               vocoder->getSampleRate(), renderedSamples,
+                               end - renderedSamples,
+                               output.getWritePointer(0, renderedSamples));
+  };
+  const bool streamed = vocoder->inferStreaming(
+      mel, f0,
+      [&](const float *samples, int numSamples, juce::int64 startSample) {
+        const int end = static_cast<int>(startSample) + numSamples;
+        if (end > output.getNumSamples())
+          output.setSize(1, end, true, true);
+        fillTo(static_cast<int>(startSample));
+        output.copyFrom(0, static_cast<int>(startSample), samples, numSamples);
+        renderedSamples = std::max(renderedSamples, end);
+        return cancelFlag == nullptr || !cancelFlag->load();
+      },
+      streaming, cancelFlag);
+  // A skipped stretch can run to the end of the take
+  if (streamed && !streaming.skipFrames.empty())
+    fillTo(expectedSamples);
+
+  output.setSize(1, renderedSamples, true, false, true);
+  if (const auto gain = GainLane::fromNotes(
+          sourceProject.getNotes(), static_cast<int>(f0.size()), HOP_SIZE))
+    gain->apply(output.getWritePointer(0), renderedSamples, 0);
+  return streamed && renderedSamples > 0;
+}
+
+bool EditorController::exportProcessedAudio(
+    const Project &sourceProject, StreamingExporter &exporter,
+    const ExportProgressCallback &onProgress,
+    const std::atomic<bool> *cancelFlag) {
+  const auto &audioData = sourceProject.getAudioData();
+  const float formantShift = sourceProject.getFormantShift();
+  MelBuffer shiftedMel;
+  if (formantShift != 0.0f)
+    shiftedMel = MelFormantShift::apply(audioData.melSpectrogram, formantShift);
+  return streamToExporter(formantShift != 0.0f ? shiftedMel
+                                               : audioData.melSpectrogram,
+                          audioData.f0, audioData.voicedMask,
+                          sourceProject.getGlobalPitchOffset(),
+                          audioData.getRenderSnapshot(), exporter, onProgress,
+                          cancelFlag, {0, 0},
+                          GainLane::fromNotes(sourceProject.getNotes(),
+                                              audioData.getNumFrames(),
+                                              HOP_SIZE));
+}
+
+void EditorController::exportProcessedAudioAsync(
+    const Project &project, std::vector<StreamingExporter::Target> targets,
+    const ExportProgressCallback &onProgress,
+    const ExportCompleteCallback &onComplete, std::pair<int, int> frameRange) {
+  if (isExportingFlag.load())
+    return;
+  exportJob.wait();
+  cancelExportFlag = false;
+  isExportingFlag = true;
+
+  auto exportAudio = [this, snapshot = project.getSnapshot(),
+                      targets = std::move(targets), onProgress, onComplete,
+                      frameRange]() mutable {
+    auto complete = [&](bool ok, const juce::String &error) {
+      isExportingFlag = false;
+      if (onComplete)
+        juce::MessageManager::callAsync(
+            [onComplete, ok, error]() { onComplete(ok, error); });
+    };
+
+    StreamingExporter exporter;
+    juce::String error;
+    if (!exporter.open(targets, error))
+      return complete(false, error);
+
+    int postedPercent = -1;
+    auto postProgress = [&](double progress) {
+      const int percent = static_cast<int>(progress * 100.0);
+      if (!onProgress || percent == postedPercent)
+        return;
+      postedPercent = percent;
+      juce::MessageManager::callAsync(
+          [onProgress, progress]() { onProgress(progress); });
+    };
+
+    std::vector<float> f0;
+    VoicedMask voicedMask;
+    MelBuffer mel;
+    snapshot.curves->copyF0(f0);
+    snapshot.curves->copyVoicedMask(voicedMask);
+    snapshot.curves->copyMel(mel);
+    if (snapshot.formantShift != 0.0f)
+      mel = MelFormantShift::apply(mel, snapshot.formantShift);
+    auto gain = snapshot.notes
+                    ? GainLane::fromNotes(*snapshot.notes,
+                                          static_cast<int>(f0.size()), HOP_SIZE)
+                    : nullptr;
+
+    const bool rendered = streamToExporter(
+        mel, std::move(f0), std::move(voicedMask), snapshot.globalPitchOffset,
+        snapshot.audio, exporter, postProgress, &cancelExportFlag,
+        frameRange, std::move(gain));
+    if (cancelExportFlag.load()) {
+      exporter.abort();
+      return complete(false, {});
+    }
+    if (!rendered) {
+      exporter.abort();
+      return complete(false, TR("dialog.failed_render"));
+    }
+    const bool finished = exporter.finish(error);
+    complete(finished, error);
+  };
+  exportJob = JobSystem::getInstance().submit(JobSystem::Priority::Normal,
+                                              std::move(exportAudio));
+}
+
+bool EditorController::exportVariants(
+    const Project &sourceProject, const std::vector<ExportVariant> &variants,
+    int numThreads, const VariantCompleteCallback &onVariantDone,
+    const std::atomic<bool> *cancelFlag) {
+  const auto &audioData = sourceProject.getAudioData();
+
+  // Variants sharing a formant shift share its mel; built before any render
+  // starts so the workers only read them
+  std::map<float, MelBuffer> shiftedMels;
+  for (const auto &variant : variants)
+    if (variant.formantShift != 0.0f &&
+        shiftedMels.find(variant.formantShift) == shiftedMels.end())
+      shiftedMels.emplace(variant.formantShift,
+                          MelFormantShift::apply(audioData.melSpectrogram,
+                                                 variant.formantShift));
+
+  // Built here, not lazily by several workers at once
+  const auto original = audioData.getRenderSnapshot();
+  const auto gain = GainLane::fromNotes(
+      sourceProject.getNotes(), audioData.getNumFrames(), HOP_SIZE);
+
+  std::atomic<size_t> nextVariant{0};
+  std::atomic<bool> allWritten{true};
+  auto worker = [&]() {
+    for (size_t index = nextVariant++; index < variants.size();
+         index = nextVariant++) {
+      const auto &variant = variants[index];
+      const auto &mel = variant.formantShift == 0.0f
+                            ? audioData.melSpectrogram
+                            : shiftedMels.at(variant.formantShift);
+
+      StreamingExporter exporter;
+      juce::String error;
+      bool ok = exporter.open(variant.targets, error);
+      if (ok && !streamToExporter(mel, audioData.f0, audioData.voicedMask,
+                                  variant.globalPitchOffset, original,
+                                  exporter, nullptr, cancelFlag, {0, 0},
+                                  gain)) {
+        exporter.abort();
+        ok = false;
+        if (cancelFlag == nullptr || !cancelFlag->load())
+          error = TR("dialog.failed_render");
+      }
+      if (ok)
+        ok = exporter.finish(error);
+
+      if (!ok)
+        allWritten = false;
+      if (onVariantDone)
+        onVariantDone(index, ok, error);
+    }
+  };
+
+  const int numWorkers =
+      std::clamp(numThreads, 1, std::max(1, static_cast<int>(variants.size())));
+  JobSystem::Group workers;
+  for (int i = 0; i < numWorkers; ++i)
+    workers.submit(JobSystem::Priority::Normal, worker);
+  workers.wait();
+  return allWritten.load();
+}
+
+bool EditorController::streamToExporter(
+    const MelBuffer &mel, std::vector<float> f0, VoicedMask voicedMask,
+    float semitones, RenderSnapshot::Ptr original,
+    StreamingExporter &exporter, const ExportProgressCallback &onProgress,
+    const std::atomic<bool> *cancelFlag, std::pair<int, int> frameRange,
+    GainLane::Ptr gain) {
+  if (!vocoder || !vocoder->isLoaded() || f0.empty() || mel.empty())
+    return false;
+
+  // Chunks arrive read-only; the gain lane is applied to a copy
+  std::vector<float> gained;
+  auto write = [&](const float *samples, int numSamples, juce::int64 start) {
+    if (gain) {
+      gained.assign(samples, samples + numSamples);
+      gain->apply(gained.data(), numSamples, start);
+      samples = gained.data();
+    }
+    return exporter.write(samples, numSamples, cancelFlag);
+  };
+
+  if (voicedMask.size() < f0.size())
+    voicedMask.resize(f0.size(), true);
+  shiftVoicedF0(f0, voicedMask, semitones);
+
+  if (frameRange.second > frameRange.first) {
+    const double rangeSamples =
+        static_cast<double>(frameRange.second - frameRange.first) * HOP_SIZE;
+    const juce::int64 rangeStart =
+        static_cast<juce::int64>(std::max(0, frameRange.first)) * HOP_SIZE;
+    juce::int64 rangeWritten = 0;
+    const bool rendered = renderRange(
+        mel, f0, frameRange,
+        [&](const float *samples, int numSamples, juce::int64 startSample) {
+          if (!write(samples, numSamples, rangeStart + startSample))
+            return false;
+          rangeWritten += numSamples;
+          if (onProgress)
+            onProgress(std::min(1.0, static_cast<double>(rangeWritten) /
+                                         rangeSamples));
+          return cancelFlag == nullptr || !cancelFlag->load();
+        },
+        cancelFlag);
+    return rendered && rangeWritten > 0 &&
+           (cancelFlag == nullptr || !cancelFlag->load());
+  }
+
+  Vocoder::StreamingOptions streaming;
+  streaming.skipFrames =
+      SilenceSkipping::findSpans(mel, voicedMask, silenceSkipping);
+
+  const double expectedSamples = static_cast<double>(f0.size()) * HOP_SIZE;
+  juce::int64 written = 0;
+  // Chunks arrive in order; a gap between two was skipped as silence
+  std::vector<float> fill;
+  auto fillTo = [&](juce::int64 end) {
+    while (written < end) {
+      const int count =
+          static_cast<int>(std::min<juce::int64>(end - written, 1 << 16));
+      fill.resize(static_cast<size_t>(count));
+      SilenceSkipping::fillGap(silenceSkipping, original.get(),
+                               vocoder->getSampleRate(), written, count,
+                               fill.data());
+      if (!write(fill.data(), count, written))
+        return false;
+      written += count;
+    }
+    return true;
+  };
+  const bool streamed = vocoder->inferStreaming(
+      mel, f0,
+      [&](const float *samples, int numSamples, juce::int64 startSample) {
+        if (!fillTo(startSample))
+          return false;
+        const auto overlap =
+            static_cast<int>(std::min<juce::int64>(written - startSample,
+                                                   numSamples));
+        if (!write(samples + overlap, numSamples - overlap,
+                   startSample + overlap))
+          return false;
+        written = std::max(written, startSample + numSamples);
+
+        if (onProgress)
+          onProgress(std::min(1.0, static_cast<double>(written) /
+                                       expectedSamples));
+        return cancelFlag == nullptr || !cancelFlag->load();
+      },
+      streaming, cancelFlag);
+  // A skipped stretch can run to the end of the take
+  const bool filled =
+      streamed && fillTo(static_cast<juce::int64>(expectedSamples));
+
+  return filled && written > 0 &&
+         (cancelFlag == nullptr || !cancelFlag->load());
+}
+
+bool EditorController::renderRange(const MelBuffer &mel,
+                                   const std::vector<float> &f0,
+                                   std::pair<int, int> range,
+                                   const Vocoder::ChunkCallback &onChunk,
+                                   const std::atomic<bool> *cancelFlag) {
+  const int totalFrames = static_cast<int>(std::min(mel.size(), f0.size()));
+  const int startFrame = std::clamp(range.first, 0, totalFrames);
+  const int endFrame = std::clamp(range.second, startFrame, totalFrames);
+  if (!vocoder || !vocoder->isLoaded() || startFrame >= endFrame)
+    return false;
+
+  // The shifts are in the hashed mel and f0 already, so they stay 0 here
+  SynthesisCache::Context context;
+  context.modelPath = vocoder->getModelFile().getFullPathName();
+  context.modelModified =
+      vocoder->getModelFile().getLastModificationTime().toMilliseconds();
+  context.device = vocoder->getExecutionDevice();
+  context.deviceId = vocoder->getExecutionDeviceId();
+  context.noiseSeed =
+      vocoder->isDeterministic() ? vocoder->getNoiseSeed() + 1 : 0;
+
+  const size_t hop = static_cast<size_t>(vocoder->getHopSize());
+  std::vector<float> audio;
+  for (int blockStart = startFrame / rangeBlockFrames * rangeBlockFrames;
+       blockStart < endFrame; blockStart += rangeBlockFrames) {
+    if (cancelFlag != nullptr && cancelFlag->load())
+      return false;
+
+    const int blockEnd = std::min(blockStart + rangeBlockFrames, totalFrames);
+    const int paddedStart = std::max(0, blockStart - rangeContextFrames);
+    const int paddedEnd = std::min(totalFrames, blockEnd + rangeContextFrames);
+    const auto paddedMel = mel.view(static_cast<size_t>(paddedStart),
+                                    static_cast<size_t>(paddedEnd));
+    const uint64_t key = SynthesisCache::makeKey(
+        paddedMel, f0.data() + paddedStart, blockStart - paddedStart,
+        blockEnd - blockStart, context);
+
+    if (!synthesisCache.lookup(key, audio)) {
+      audio = vocoder->infer(
+          paddedMel, std::vector<float>(f0.begin() + paddedStart,
+                                        f0.begin() + paddedEnd));
+      if (audio.empty())
+        return false;
+      // Drop the context: one hop per frame from the block's first frame
+      audio.resize(static_cast<size_t>(paddedEnd - paddedStart) * hop, 0.0f);
+      audio.erase(audio.begin(),
+                  audio.begin() + static_cast<std::ptrdiff_t>(
+                                      (blockStart - paddedStart) * hop));
+      audio.resize(static_cast<size_t>(blockEnd - blockStart) * hop);
+      synthesisCache.insert(key, audio);
+    }
+
+    const int keepStart = std::max(startFrame, blockStart);
+    const int keepEnd = std::min(endFrame, blockEnd);
+    if (!onChunk(audio.data() + static_cast<size_t>(keepStart - blockStart) *
+                                    hop,
+                 static_cast<int>(static_cast<size_t>(keepEnd - keepStart) *
+                                  hop),
+                 static_cast<juce::int64>(keepStart - startFrame) *
+                     static_cast<juce::int64>(hop)))
+      return false;
+  }
+  return true;
+}
+
+void EditorController::shiftVoicedF0(std::vector<float> &f0,
+                                     const VoicedMask &voicedMask,
+                                     float semitones) {
+  if (semitones == 0.0f)
+    return;
+
+  // Shift voiced runs only; unvoiced runs are skipped a word at a time
+  const float pitchRatio = std::pow(2.0f, semitones / 12.0f);
+  const int numFrames = static_cast<int>(f0.size());
+  for (int runStart = voicedMask.findNext(0, true); runStart < numFrames;) {
+    const int runEnd = std::min(numFrames, voicedMask.findNext(runStart, false));
+    for (int i = runStart; i < runEnd; ++i) {
+      if (f0[static_cast<size_t>(i)] > 0)
+        f0[static_cast<size_t>(i)] *= pitchRatio;
+    }
+    runStart = voicedMask.findNext(runEnd, true);
+  }
+}
+
+void EditorController::prefetchIncrementalSynthesis(Project &targetProject,
+                                                    int startFrame,
+                                                    int endFrame) {
+  auto *synth = getSynthFor(targetProject);
+  if (!synth || !vocoder || !vocoder->isLoaded() || startFrame >= endFrame)
+    return;
+
+  auto &audioData = targetProject.getAudioData();
+  if (audioData.melSpectrogram.empty() || audioData.f0.empty())
+    return;
+
+  synth->setProject(&targetProject);
+  synth->setVocoder(vocoder.get());
+  const auto dirtyRanges =
+      targetProject.getDirtyFrameRangesWith(startFrame, endFrame);
+
+  // The base pitch the release would produce around the edit, computed
+  // aside: the live curves stay as the drag preview and the render threads
+  // see them. Curves a range rebuild cannot patch would need a full
+  // rebuild, which is not worth a guess.
+  IncrementalSynthesizer::BasePitchPatch patch;
+  std::pair<int, int> span;
+  patch.basePitch = PitchCurveProcessor::computeBaseInRange(
+      targetProject, startFrame, endFrame, span);
+  if (patch.basePitch.empty())
+    return;
+  patch.startFrame = span.first;
+  synth->prefetchRegion(dirtyRanges, patch);
+}
+
 void EditorController::resynthesizeIncrementalAsync(
     Project &project,
     const std::function<void(const juce::String &)> &onProgress,
     const std::function<void(bool)> &onComplete,
     std::atomic<bool> &pendingRerun,
     bool isPluginMode) {
-  auto *synth = incrementalSynth.get();
+  auto *synth = getSynthFor(project);
   if (!synth || !vocoder) {
     if (onComplete)
       onComplete(false);
     return;
   }
 
-  if (synth->isSynthesizing()) {
+  // A refinement is just superseded by the new job
+  if (synth->isSynthesizing() && !synth->isRefining()) {
     pendingRerun.store(true);
     synth->cancel();
     return;
@@ -523,10 +1577,8 @@ void EditorController::resynthesizeIncrementalAsync(
         }
 
         if (audioEnginePtr && !isPluginMode) {
-          auto &audioData = projectPtr->getAudioData();
           try {
-            audioEnginePtr->loadWaveform(audioData.waveform,
-                                         audioData.sampleRate, true);
+            publishPlayback(true);
           } catch (...) {
             DBG("resynthesizeIncrementalAsync: EXCEPTION in loadWaveform!");
           }
@@ -542,13 +1594,55 @@ void EditorController::resynthesizeIncrementalAsync(
                                          *pending, isPluginMode);
           });
         }
+      },
+      [this, audioEnginePtr]() {
+        // The edits playback reaches next are rendered; play them while the
+        // rest is still synthesizing
+        if (audioEnginePtr)
+          publishPlayback(true);
+      });
+}
+
+bool EditorController::auditionIncrementalAsync(Project &targetProject,
+                                                bool isPluginMode) {
+  auto *synth = getSynthFor(targetProject);
+  if (!synth || !vocoder)
+    return false;
+
+  synth->setProject(&targetProject);
+  synth->setVocoder(vocoder.get());
+  AudioEngine *audioEnginePtr = isPluginMode ? nullptr : audioEngine.get();
+  return synth->auditionRegion([this, audioEnginePtr]() {
+    if (audioEnginePtr)
+      publishPlayback(true);
+  });
+}
+
+bool EditorController::refinePreviewRenderAsync(
+    Project &targetProject, double idleSeconds,
+    const std::function<void(bool)> &onComplete) {
+  auto *synth = getSynthFor(targetProject);
+  if (!synth || !synth->needsRefinement(idleSeconds))
+    return false;
+
+  synth->setProject(&targetProject);
+  synth->setVocoder(vocoder.get());
+  return synth->refinePreviewRegions(
+      [this, onComplete](bool success) {
+        if (success)
+          publishPlayback(true);
+        if (onComplete)
+          onComplete(success);
       });
 }
 
 void EditorController::analyzeAudio(
     Project &targetProject,
     const std::function<void(double, const juce::String &)> &onProgress,
-    std::function<void()> onComplete) {
+    std::function<void()> onComplete,
+    const AnalysisPreviewCallback &onPreview,
+    const std::atomic<bool> *cancelFlag,
+    const std::function<void(const Project &)> &onProvisional) {
   auto &audioData = targetProject.getAudioData();
   if (audioData.waveform.getNumSamples() == 0)
     return;
@@ -563,18 +1657,58 @@ void EditorController::analyzeAudio(
     });
   };
 
-  // Extract F0
-  const float *samples = audioData.waveform.getReadPointer(0);
-  int numSamples = audioData.waveform.getNumSamples();
+  auto loadVocoder = [&]() {
+    auto modelPath = getVocoderModelFile();
 
-  onProgress(0.35, "Computing mel spectrogram...");
-  MelSpectrogram melComputer(audioData.sampleRate, N_FFT, HOP_SIZE, NUM_MELS,
-                             FMIN, FMAX);
-  audioData.melSpectrogram = melComputer.compute(samples, numSamples);
+    if (!modelPath.existsAsFile() && !vocoder->isLoaded()) {
+      showMissingModelAndAbort("pc_nsf_hifigan.onnx", modelPath);
+      return false;
+    }
 
-  int targetFrames = static_cast<int>(audioData.melSpectrogram.size());
+    if (modelPath.existsAsFile() && !vocoder->isLoaded()) {
+      if (waitForModel(OnnxThreading::Model::Vocoder)) {
+        DBG("Vocoder model loaded successfully: " +
+            modelPath.getFullPathName());
+      } else {
+        juce::MessageManager::callAsync([modelPath]() {
+          juce::AlertWindow::showMessageBoxAsync(
+              juce::AlertWindow::WarningIcon, "Inference failed",
+              "Failed to load vocoder model at:\n" +
+                  modelPath.getFullPathName() +
+                  "\n\nPlease check your model installation and try again.");
+        });
+        return false;
+      }
+    }
+    return true;
+  };
 
-  onProgress(0.55, "Extracting pitch (F0)...");
+  // Unchanged audio analysed with the same models: skip inference entirely
+  onProgress(0.30, "Checking analysis cache...");
+  const auto cacheKey = makeAnalysisCacheKey(audioData);
+  const bool cacheHit = analysisCache.load(cacheKey, targetProject);
+  PerformanceMetrics::getInstance().recordCacheLookup(
+      PerformanceMetrics::Cache::Analysis, cacheHit);
+  if (cacheHit) {
+    LOG("Analysis cache hit: " + cacheKey.getFileName());
+    onProgress(0.75, TR("progress.loading_vocoder"));
+    if (!loadVocoder())
+      return;
+
+    PitchCurveProcessor::rebuildCurvesFromSource(targetProject, audioData.f0);
+    if (onComplete)
+      onComplete();
+    return;
+  }
+
+  const float *samples = audioData.waveform.getReadPointer(0);
+  int numSamples = audioData.waveform.getNumSamples();
+
+  // Usually loaded in the background by now; otherwise wait for just the
+  // models this analysis needs
+  waitForModel(pitchDetectorType == PitchDetectorType::FCPE
+                   ? OnnxThreading::Model::FCPE
+                   : OnnxThreading::Model::RMVPE);
 
   if (pitchDetectorType == PitchDetectorType::RMVPE) {
     if (!rmvpeModelPath.existsAsFile() || !rmvpePitchDetector ||
@@ -608,16 +1742,163 @@ void EditorController::analyzeAudio(
       juce::String(fcpePitchDetector && fcpePitchDetector->isLoaded() ? "YES"
                                                                       : "NO"));
 
-  std::vector<float> extractedF0;
-  if (pitchDetectorType == PitchDetectorType::RMVPE) {
-    extractedF0 = rmvpePitchDetector->extractF0(samples, numSamples,
-                                                audioData.sampleRate);
-  } else if (pitchDetectorType == PitchDetectorType::FCPE) {
-    extractedF0 =
-        fcpePitchDetector->extractF0(samples, numSamples, audioData.sampleRate);
+  // Partial F0 and notes for onPreview, fed by the F0 and SOME threads.
+  // Frames are published once both neural neighbours are known; notes once
+  // their last frame is published.
+  struct PreviewState {
+    std::mutex mutex;
+    std::vector<float> neuralF0;
+    std::vector<float> f0;
+    std::vector<SOMEDetector::NoteEvent> events;
+    size_t eventsPublished = 0;
+  } preview;
+  const int expectedFrames = std::max(1, numSamples / HOP_SIZE + 1);
+
+  auto publishPreview = [&]() { // Caller holds preview.mutex
+    const int sampleRate = audioData.sampleRate;
+    const double neuralPerFrame = static_cast<double>(HOP_SIZE) /
+                                  std::max(1, sampleRate) / (160.0 / 16000.0);
+    int available = 0;
+    if (preview.neuralF0.size() >= 2)
+      available = static_cast<int>(std::ceil(
+          static_cast<double>(preview.neuralF0.size() - 1) / neuralPerFrame));
+    available = std::min(available, expectedFrames);
+
+    AnalysisPreview update;
+    update.startFrame = static_cast<int>(preview.f0.size());
+    update.endFrame = std::max(update.startFrame, available);
+    update.totalFrames = expectedFrames;
+    update.sampleRate = sampleRate;
+    for (int i = update.startFrame; i < update.endFrame; ++i)
+      update.f0.push_back(neuralF0AtFrame(preview.neuralF0, i, sampleRate));
+    preview.f0.insert(preview.f0.end(), update.f0.begin(), update.f0.end());
+
+    const auto firstEvent = preview.events.begin() + static_cast<std::ptrdiff_t>(
+                                                         preview.eventsPublished);
+    auto lastEvent = firstEvent;
+    while (lastEvent != preview.events.end() &&
+           lastEvent->endFrame <= static_cast<int>(preview.f0.size()))
+      ++lastEvent;
+    preview.eventsPublished += static_cast<size_t>(lastEvent - firstEvent);
+    appendNotesFromEvents(update.notes, preview.f0,
+                          std::vector<SOMEDetector::NoteEvent>(firstEvent,
+                                                               lastEvent));
+
+    if (update.endFrame > update.startFrame || !update.notes.empty())
+      onPreview(std::move(update));
+  };
+
+  if (onPreview) {
+    AnalysisPreview first;
+    first.totalFrames = expectedFrames;
+    first.sampleRate = audioData.sampleRate;
+    first.waveform =
+        std::make_shared<juce::AudioBuffer<float>>(audioData.waveform);
+    onPreview(std::move(first));
+  }
+
+  // Mel, F0 and SOME all read only the waveform, so they run side by side
+  // (CPU mel work overlaps GPU inference); their results are combined below
+  onProgress(0.35, "Analyzing (mel, pitch, notes)...");
+  auto &jobs = JobSystem::getInstance();
+  constexpr auto priority = JobSystem::Priority::Normal;
+  auto melTask = jobs.submitWithResult(priority, [&]() {
+    MelSpectrogram melComputer(audioData.sampleRate, N_FFT, HOP_SIZE, NUM_MELS,
+                               FMIN, FMAX);
+    return melComputer.compute(samples, numSamples);
+  });
+  auto f0Task = jobs.submitWithResult(priority, [&]() {
+    // Both detectors read 16 kHz audio; re-analysing the same source (for
+    // example after a detector change) reuses the resampled copy
+    const auto audio16k = resampledAudio.get(
+        cacheKey.audioHash, samples, numSamples, audioData.sampleRate,
+        RMVPEPitchDetector::SAMPLE_RATE);
+    std::lock_guard<std::mutex> lock(pitchDetectorMutex);
+    if (pitchDetectorType == PitchDetectorType::RMVPE) {
+      RMVPEPitchDetector::F0ChunkCallback onChunk;
+      if (onPreview)
+        onChunk = [&](const std::vector<float> &frames, int) {
+          std::lock_guard<std::mutex> lock(preview.mutex);
+          preview.neuralF0.insert(preview.neuralF0.end(), frames.begin(),
+                                  frames.end());
+          publishPreview();
+        };
+      return rmvpePitchDetector->extractF0WithProgress(
+          audio16k.data, audio16k.numSamples, audio16k.sampleRate,
+          RMVPEPitchDetector::DEFAULT_THRESHOLD, nullptr, onChunk,
+          cancelFlag);
+    }
+    if (pitchDetectorType == PitchDetectorType::FCPE)
+      return fcpePitchDetector->extractF0(audio16k.data, audio16k.numSamples,
+                                          audio16k.sampleRate,
+                                          FCPEPitchDetector::DEFAULT_THRESHOLD,
+                                          cancelFlag);
+    return std::vector<float>();
+  });
+  bool canSegment = false; // Set by noteTask, read after it finishes
+  auto noteTask = jobs.submitWithResult(priority, [&]() {
+    std::vector<SOMEDetector::NoteEvent> events;
+    canSegment = waitForModel(OnnxThreading::Model::SOME) && someDetector &&
+                 someDetector->isLoaded();
+    std::lock_guard<std::mutex> lock(noteDetectorMutex);
+    if (canSegment)
+      someDetector->detectNotesStreaming(
+          samples, numSamples, SOMEDetector::SAMPLE_RATE,
+          [&](const std::vector<SOMEDetector::NoteEvent> &chunk) {
+            events.insert(events.end(), chunk.begin(), chunk.end());
+            if (onPreview) {
+              std::lock_guard<std::mutex> lock(preview.mutex);
+              preview.events.insert(preview.events.end(), chunk.begin(),
+                                    chunk.end());
+              publishPreview();
+            }
+          },
+          nullptr, cancelFlag);
+    return events;
+  });
+
+  // Report each stage as it finishes (from this thread only). Waiting on a
+  // stage lets a pool worker run queued stages meanwhile. With
+  // onProvisional the first wait ends once mel and F0 are in.
+  struct Stage {
+    std::function<bool(int)> waitFor;
+    const char *message;
+    bool done = false;
+  };
+  Stage stages[] = {
+      {[&](int ms) { return melTask.waitFor(ms); }, "Mel spectrogram ready"},
+      {[&](int ms) { return f0Task.waitFor(ms); }, "Pitch (F0) extracted"},
+      {[&](int ms) { return noteTask.waitFor(ms); }, "Notes detected"}};
+  int finished = 0;
+  auto waitForStages = [&](bool withNotes) {
+    while (!stages[0].done || !stages[1].done ||
+           (withNotes && !stages[2].done)) {
+      bool waited = false;
+      for (auto &stage : stages) {
+        if (stage.done || !stage.waitFor(waited ? 0 : 20)) {
+          waited = waited || !stage.done;
+          continue;
+        }
+        stage.done = true;
+        ++finished;
+        onProgress(0.35 + 0.1 * finished, stage.message);
+      }
+    }
+  };
+  waitForStages(!onProvisional);
+
+  // noteTask uses this frame, so nothing returns before it finishes
+  audioData.melSpectrogram = melTask.get();
+  auto extractedF0 = f0Task.get();
+  int targetFrames = static_cast<int>(audioData.melSpectrogram.size());
+
+  if (cancelFlag != nullptr && cancelFlag->load()) {
+    noteTask.get();
+    return;
   }
 
   if (extractedF0.empty() || targetFrames <= 0) {
+    noteTask.get();
     juce::MessageManager::callAsync([]() {
       juce::AlertWindow::showMessageBoxAsync(
           juce::AlertWindow::WarningIcon, "Inference failed",
@@ -630,39 +1911,9 @@ void EditorController::analyzeAudio(
   {
     audioData.f0.resize(targetFrames);
 
-    const double neuralFrameTime = 160.0 / 16000.0;
-    const double vocoderFrameTime =
-        static_cast<double>(HOP_SIZE) /
-        static_cast<double>(std::max(1, audioData.sampleRate));
-
-    for (int i = 0; i < targetFrames; ++i) {
-      double vocoderTime = i * vocoderFrameTime;
-      double neuralFramePos = vocoderTime / neuralFrameTime;
-      int srcIdx = static_cast<int>(neuralFramePos);
-      double frac = neuralFramePos - srcIdx;
-
-      if (srcIdx + 1 < static_cast<int>(extractedF0.size())) {
-        float f0_a = extractedF0[srcIdx];
-        float f0_b = extractedF0[srcIdx + 1];
-
-        if (f0_a > 0.0f && f0_b > 0.0f) {
-          float logF0_a = std::log(f0_a);
-          float logF0_b = std::log(f0_b);
-          float logF0_interp = logF0_a * (1.0 - frac) + logF0_b * frac;
-          audioData.f0[i] = std::exp(logF0_interp);
-        } else if (f0_a > 0.0f) {
-          audioData.f0[i] = f0_a;
-        } else if (f0_b > 0.0f) {
-          audioData.f0[i] = f0_b;
-        } else {
-          audioData.f0[i] = 0.0f;
-        }
-      } else if (srcIdx < static_cast<int>(extractedF0.size())) {
-        audioData.f0[i] = extractedF0[srcIdx];
-      } else {
-        audioData.f0[i] = extractedF0.back() > 0.0f ? extractedF0.back() : 0.0f;
-      }
-    }
+    for (int i = 0; i < targetFrames; ++i)
+      audioData.f0[i] =
+          neuralF0AtFrame(extractedF0, i, audioData.sampleRate);
 
     audioData.voicedMask.resize(audioData.f0.size());
     for (size_t i = 0; i < audioData.f0.size(); ++i) {
@@ -670,36 +1921,43 @@ void EditorController::analyzeAudio(
     }
 
     onProgress(0.65, "Smoothing pitch curve...");
-    audioData.f0 = F0Smoother::smoothF0(audioData.f0, audioData.voicedMask);
+    F0Smoother::smoothF0InPlace(audioData.f0, audioData.voicedMask);
     audioData.f0 = PitchCurveProcessor::interpolateWithUvMask(
         audioData.f0, audioData.voicedMask);
   }
 
   onProgress(0.75, TR("progress.loading_vocoder"));
-  auto modelPath =
-      PlatformPaths::getModelsDirectory().getChildFile("pc_nsf_hifigan.onnx");
-
-  if (!modelPath.existsAsFile() && !vocoder->isLoaded()) {
-    showMissingModelAndAbort("pc_nsf_hifigan.onnx", modelPath);
+  if (!loadVocoder()) {
+    noteTask.get();
     return;
   }
 
-  if (modelPath.existsAsFile() && !vocoder->isLoaded()) {
-    if (vocoder->loadModel(modelPath)) {
-      DBG("Vocoder model loaded successfully: " + modelPath.getFullPathName());
-    } else {
-      juce::MessageManager::callAsync([modelPath]() {
-        juce::AlertWindow::showMessageBoxAsync(
-            juce::AlertWindow::WarningIcon, "Inference failed",
-            "Failed to load vocoder model at:\n" + modelPath.getFullPathName() +
-                "\n\nPlease check your model installation and try again.");
-      });
-      return;
-    }
+  if (onProvisional && !noteTask.isDone()) {
+    targetProject.clearNotes();
+    audioAnalyzer->segmentFallback(targetProject);
+    targetProject.invalidateNoteIndex();
+    PitchCurveProcessor::rebuildCurvesFromSource(targetProject, audioData.f0);
+    onProvisional(targetProject);
   }
+  waitForStages(true);
+  const auto noteEvents = noteTask.get();
+  if (cancelFlag != nullptr && cancelFlag->load())
+    return;
 
   onProgress(0.90, "Segmenting notes...");
-  segmentIntoNotes(targetProject);
+  if (canSegment) {
+    targetProject.clearNotes();
+    appendNotesFromEvents(targetProject.getNotes(), audioData.f0, noteEvents);
+    targetProject.invalidateNoteIndex();
+    DBG("SOME segmented into " << targetProject.getNotes().size() << " notes");
+  } else {
+    segmentIntoNotes(targetProject); // Reports the missing model
+  }
+
+  // Only complete results are worth reusing
+  if (!targetProject.getNotes().empty() &&
+      analysisCache.store(cacheKey, targetProject))
+    LOG("Analysis cached: " + cacheKey.getFileName());
 
   PitchCurveProcessor::rebuildCurvesFromSource(targetProject, audioData.f0);
 
@@ -710,24 +1968,24 @@ void EditorController::analyzeAudio(
 void EditorController::analyzeAudioAsync(
     const std::function<void(Project &)> &onProjectReady,
     const std::function<void()> &onProjectChanged) {
-  if (loaderThread.joinable())
-    loaderThread.join();
+  loaderJobs.wait();
 
-  loaderThread = std::thread([this, onProjectReady, onProjectChanged]() {
-    if (!project)
+  auto analyze = [this, onProjectReady, onProjectChanged]() {
+    if (!getProject())
       return;
 
-    auto projectCopy = std::make_shared<Project>(*project);
+    auto projectCopy = std::make_shared<Project>(*getProject());
 
     analyzeAudio(*projectCopy, [](double, const juce::String &) {});
 
     juce::MessageManager::callAsync([this, projectCopy, onProjectReady,
                                      onProjectChanged]() {
+      auto *project = getProject();
       if (!project)
         return;
 
       project->getAudioData().melSpectrogram =
-          projectCopy->getAudioData().melSpectrogram;
+          std::move(projectCopy->getAudioData().melSpectrogram);
       project->getAudioData().f0 = projectCopy->getAudioData().f0;
       project->getAudioData().voicedMask =
           projectCopy->getAudioData().voicedMask;
@@ -741,35 +1999,231 @@ void EditorController::analyzeAudioAsync(
       if (onProjectChanged)
         onProjectChanged();
     });
-  });
+  };
+  loaderJobs.submit(JobSystem::Priority::Normal, std::move(analyze));
 }
 
 void EditorController::segmentIntoNotesAsync(
     const std::function<void(Project &)> &onProjectReady,
     const std::function<void()> &onNotesChanged) {
-  if (loaderThread.joinable())
-    loaderThread.join();
+  loaderJobs.wait();
 
-  loaderThread = std::thread([this, onProjectReady, onNotesChanged]() {
-    if (!project)
+  auto segment = [this, onProjectReady, onNotesChanged]() {
+    if (!getProject())
       return;
 
-    auto projectCopy = std::make_shared<Project>(*project);
+    auto projectCopy = std::make_shared<Project>(*getProject());
     segmentIntoNotes(*projectCopy);
 
     juce::MessageManager::callAsync([this, projectCopy, onProjectReady,
                                      onNotesChanged]() {
+      auto *project = getProject();
       if (!project)
         return;
 
       project->getNotes() = projectCopy->getNotes();
+      project->invalidateNoteIndex();
 
       if (onProjectReady)
         onProjectReady(*project);
       if (onNotesChanged)
         onNotesChanged();
     });
-  });
+  };
+  loaderJobs.submit(JobSystem::Priority::Normal, std::move(segment));
+}
+
+bool EditorController::analyzeRangeAsync(
+    int startFrame, int endFrame, bool detectPitch, bool detectNotes,
+    std::function<void(RangeAnalysis)> onComplete) {
+  if (!getProject() || isAnalyzingRangeFlag.load())
+    return false;
+
+  const auto &audioData = getProject()->getAudioData();
+  const int totalFrames = static_cast<int>(audioData.f0.size());
+  startFrame = std::max(0, startFrame);
+  endFrame = std::min(totalFrames, endFrame);
+  if (endFrame <= startFrame || audioData.waveform.getNumSamples() == 0)
+    return false;
+
+  // Whole notes are re-segmented, never parts of them
+  if (detectNotes) {
+    for (const auto *note : getProject()->getNotesInRange(startFrame, endFrame)) {
+      if (note->isRest())
+        continue;
+      startFrame = std::min(startFrame, note->getStartFrame());
+      endFrame = std::max(endFrame, note->getEndFrame());
+    }
+    endFrame = std::min(totalFrames, endFrame);
+  }
+
+  constexpr int contextFrames = SAMPLE_RATE / HOP_SIZE; // ~1 s
+  const int segmentStart = std::max(0, startFrame - contextFrames);
+  const int segmentEnd = std::min(totalFrames, endFrame + contextFrames);
+  const int numSamples = audioData.waveform.getNumSamples();
+  const int sampleStart = std::min(numSamples, segmentStart * HOP_SIZE);
+  const int sampleEnd = std::min(numSamples, segmentEnd * HOP_SIZE);
+
+  // Copy the inputs now; the project keeps changing on the message thread
+  const float *source = audioData.waveform.getReadPointer(0);
+  auto samples = std::make_shared<std::vector<float>>(source + sampleStart,
+                                                      source + sampleEnd);
+  auto currentF0 = std::make_shared<std::vector<float>>(
+      audioData.f0.begin() + segmentStart, audioData.f0.begin() + segmentEnd);
+  const int sampleRate = audioData.sampleRate;
+  const Project *target = getProject();
+
+  loaderJobs.wait();
+
+  isAnalyzingRangeFlag = true;
+  auto analyze = [this, startFrame, endFrame, detectPitch, detectNotes,
+                  onComplete, samples, currentF0, segmentStart, sampleRate,
+                  target]() {
+    RangeAnalysis result;
+    result.startFrame = startFrame;
+    result.endFrame = endFrame;
+
+    const int numSegmentSamples = static_cast<int>(samples->size());
+    const int segmentFrames = static_cast<int>(currentF0->size());
+    auto localF0 = *currentF0;
+
+    if (detectPitch) {
+      std::vector<float> neuralF0;
+      waitForModel(pitchDetectorType == PitchDetectorType::FCPE
+                       ? OnnxThreading::Model::FCPE
+                       : OnnxThreading::Model::RMVPE);
+      std::unique_lock<std::mutex> pitchLock(pitchDetectorMutex);
+      if (pitchDetectorType == PitchDetectorType::RMVPE && rmvpePitchDetector &&
+          rmvpePitchDetector->isLoaded())
+        neuralF0 = rmvpePitchDetector->extractF0(
+            samples->data(), numSegmentSamples, sampleRate);
+      else if (pitchDetectorType == PitchDetectorType::FCPE &&
+               fcpePitchDetector && fcpePitchDetector->isLoaded())
+        neuralF0 = fcpePitchDetector->extractF0(
+            samples->data(), numSegmentSamples, sampleRate);
+      pitchLock.unlock();
+
+      if (!neuralF0.empty()) {
+        // Same post-processing as analyzeAudio, over the range and context
+        VoicedMask localVoiced(static_cast<size_t>(segmentFrames));
+        for (int i = 0; i < segmentFrames; ++i) {
+          localF0[i] = neuralF0AtFrame(neuralF0, i, sampleRate);
+          localVoiced[i] = localF0[i] > 0;
+        }
+        F0Smoother::smoothF0InPlace(localF0, localVoiced);
+        localF0 =
+            PitchCurveProcessor::interpolateWithUvMask(localF0, localVoiced);
+
+        const int offset = startFrame - segmentStart;
+        result.f0.assign(localF0.begin() + offset,
+                         localF0.begin() + offset + (endFrame - startFrame));
+        result.voicedMask.resize(static_cast<size_t>(endFrame - startFrame));
+        for (int i = startFrame; i < endFrame; ++i)
+          result.voicedMask[static_cast<size_t>(i - startFrame)] =
+              localVoiced[static_cast<size_t>(i - segmentStart)];
+        result.hasPitch = true;
+      }
+    }
+
+    if (detectNotes && waitForModel(OnnxThreading::Model::SOME) &&
+        someDetector && someDetector->isLoaded()) {
+      std::vector<SOMEDetector::NoteEvent> events;
+      {
+        std::lock_guard<std::mutex> lock(noteDetectorMutex);
+        events = someDetector->detectNotes(
+            samples->data(), numSegmentSamples, SOMEDetector::SAMPLE_RATE);
+      }
+      std::vector<Note> detected;
+      appendNotesFromEvents(detected, localF0, events);
+
+      // Keep what falls inside the range, clipped to it
+      for (const auto &note : detected) {
+        const int noteStart =
+            std::max(startFrame, segmentStart + note.getStartFrame());
+        const int noteEnd = std::min(endFrame, segmentStart + note.getEndFrame());
+        if (noteEnd - noteStart < 3)
+          continue;
+        Note clipped(noteStart, noteEnd, note.getMidiNote());
+        clipped.setF0Values(
+            std::vector<float>(localF0.begin() + (noteStart - segmentStart),
+                               localF0.begin() + (noteEnd - segmentStart)));
+        result.notes.push_back(std::move(clipped));
+      }
+      result.hasNotes = true;
+    }
+
+    juce::MessageManager::callAsync(
+        [this, target, onComplete, result = std::move(result)]() mutable {
+          isAnalyzingRangeFlag = false;
+          // Dropped if another project was loaded meanwhile
+          if (getProject() == target && onComplete)
+            onComplete(std::move(result));
+        });
+  };
+  loaderJobs.submit(JobSystem::Priority::Normal, std::move(analyze));
+  return true;
+}
+
+float EditorController::neuralF0AtFrame(const std::vector<float> &neuralF0,
+                                        int frame, int sampleRate) {
+  if (neuralF0.empty())
+    return 0.0f;
+
+  const double neuralFrameTime = 160.0 / 16000.0;
+  const double vocoderFrameTime =
+      static_cast<double>(HOP_SIZE) / static_cast<double>(std::max(1, sampleRate));
+
+  double vocoderTime = frame * vocoderFrameTime;
+  double neuralFramePos = vocoderTime / neuralFrameTime;
+  int srcIdx = static_cast<int>(neuralFramePos);
+  double frac = neuralFramePos - srcIdx;
+
+  if (srcIdx + 1 < static_cast<int>(neuralF0.size())) {
+    float f0_a = neuralF0[srcIdx];
+    float f0_b = neuralF0[srcIdx + 1];
+
+    if (f0_a > 0.0f && f0_b > 0.0f) {
+      float logF0_a = std::log(f0_a);
+      float logF0_b = std::log(f0_b);
+      float logF0_interp = logF0_a * (1.0 - frac) + logF0_b * frac;
+      return std::exp(logF0_interp);
+    }
+    if (f0_a > 0.0f)
+      return f0_a;
+    if (f0_b > 0.0f)
+      return f0_b;
+    return 0.0f;
+  }
+  if (srcIdx < static_cast<int>(neuralF0.size()))
+    return neuralF0[srcIdx];
+  return neuralF0.back() > 0.0f ? neuralF0.back() : 0.0f;
+}
+
+void EditorController::appendNotesFromEvents(
+    std::vector<Note> &notes, const std::vector<float> &f0,
+    const std::vector<SOMEDetector::NoteEvent> &events) {
+  const int f0Size = static_cast<int>(f0.size());
+  if (f0Size == 0)
+    return;
+
+  for (const auto &someNote : events) {
+    if (someNote.isRest)
+      continue;
+
+    int f0Start = someNote.startFrame;
+    int f0End = someNote.endFrame;
+
+    f0Start = std::max(0, std::min(f0Start, f0Size - 1));
+    f0End = std::max(f0Start + 1, std::min(f0End, f0Size));
+
+    if (f0End - f0Start < 3)
+      continue;
+
+    Note note(f0Start, f0End, someNote.midiNote);
+    std::vector<float> f0Values(f0.begin() + f0Start, f0.begin() + f0End);
+    note.setF0Values(std::move(f0Values));
+    notes.push_back(note);
+  }
 }
 
 void EditorController::segmentIntoNotes(Project &targetProject,
@@ -781,7 +2235,8 @@ void EditorController::segmentIntoNotes(Project &targetProject,
   if (audioData.f0.empty())
     return;
 
-  if (!someDetector || !someDetector->isLoaded()) {
+  if (!waitForModel(OnnxThreading::Model::SOME) || !someDetector ||
+      !someDetector->isLoaded()) {
     juce::MessageManager::callAsync([path = someModelPath]() {
       juce::AlertWindow::showMessageBoxAsync(
           juce::AlertWindow::WarningIcon, "Missing model file",
@@ -796,36 +2251,20 @@ void EditorController::segmentIntoNotes(Project &targetProject,
 
     const float *samples = audioData.waveform.getReadPointer(0);
     int numSamples = audioData.waveform.getNumSamples();
-    const int f0Size = static_cast<int>(audioData.f0.size());
-
-    someDetector->detectNotesStreaming(
-        samples, numSamples, SOMEDetector::SAMPLE_RATE,
-        [&](const std::vector<SOMEDetector::NoteEvent> &chunkNotes) {
-          for (const auto &someNote : chunkNotes) {
-            if (someNote.isRest)
-              continue;
-
-            int f0Start = someNote.startFrame;
-            int f0End = someNote.endFrame;
-
-            f0Start = std::max(0, std::min(f0Start, f0Size - 1));
-            f0End = std::max(f0Start + 1, std::min(f0End, f0Size));
-
-            if (f0End - f0Start < 3)
-              continue;
 
-            Note note(f0Start, f0End, someNote.midiNote);
-            std::vector<float> f0Values(audioData.f0.begin() + f0Start,
-                                        audioData.f0.begin() + f0End);
-            note.setF0Values(std::move(f0Values));
-            notes.push_back(note);
-          }
-
-          if (onStreamingUpdate) {
-            juce::MessageManager::callAsync(onStreamingUpdate);
-          }
-        },
-        nullptr);
+    {
+      std::lock_guard<std::mutex> lock(noteDetectorMutex);
+      someDetector->detectNotesStreaming(
+          samples, numSamples, SOMEDetector::SAMPLE_RATE,
+          [&](const std::vector<SOMEDetector::NoteEvent> &chunkNotes) {
+            appendNotesFromEvents(notes, audioData.f0, chunkNotes);
+
+            if (onStreamingUpdate) {
+              juce::MessageManager::callAsync(onStreamingUpdate);
+            }
+          },
+          nullptr);
+    }
 
     juce::Thread::sleep(100);
 
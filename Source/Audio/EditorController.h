@@ -1,42 +1,112 @@
 #pragma once
 
 #include "../JuceHeader.h"
+#include "Analysis/AnalysisCache.h"
 #include "Analysis/AudioAnalyzer.h"
+#include "Analysis/ResampledAudioCache.h"
 #include "AudioEngine.h"
+#include "Engine/GainStage.h"
 #include "Engine/PlaybackController.h"
+#include "Engine/SessionMixer.h"
 #include "FCPEPitchDetector.h"
+#include "IO/AudioFileManager.h"
+#include "IO/StreamingExporter.h"
+#include "ModelPrecision.h"
 #include "PitchDetectorType.h"
+#include "ProviderBenchmark.h"
 #include "RMVPEPitchDetector.h"
 #include "SOMEDetector.h"
 #include "Synthesis/IncrementalSynthesizer.h"
 #include "Vocoder.h"
 #include "../Models/Project.h"
 #include "../Utils/AppLogger.h"
+#include "../Utils/JobSystem.h"
+#include "../Utils/SilenceSkipping.h"
 
+#include <array>
 #include <atomic>
 #include <cstdint>
 #include <functional>
 #include <memory>
-#include <thread>
+#include <mutex>
+#include <vector>
 
 class EditorController {
 public:
   explicit EditorController(bool enableAudioDevice);
   ~EditorController();
 
-  Project *getProject() const { return project.get(); }
+  // The focused track's project; see the session methods below
+  Project *getProject() const {
+    return tracks[static_cast<size_t>(focusedTrack)].project.get();
+  }
+  // Replaces the focused track's project
   void setProject(std::unique_ptr<Project> newProject);
 
+  /**
+   * One take of a standalone session: its project and the synthesizer that
+   * keeps the project's render. Models, the vocoder and its queue, the job
+   * system and the synthesis cache are shared by every track, so a lead and
+   * four harmonies cost one set of sessions and threads.
+   */
+  struct Track {
+    juce::String name;
+    float gain = 1.0f;
+    bool muted = false;
+    std::unique_ptr<Project> project;
+    std::unique_ptr<IncrementalSynthesizer> synth; // After project: goes first
+    // The project's render as it was handed over, before any edit: what
+    // AudioEngine's A/B comparison plays (tiles shared with the render)
+    RenderSnapshot::Ptr original;
+    GainStage gainStage; // The notes' gain lane on the played render
+  };
+
+  /**
+   * A controller starts with one track, and with one unmuted track at unity
+   * gain playback is that track's render as before. With more, the audio
+   * engine plays the sum of all tracks (see publishPlayback()), while edits,
+   * analysis and getProject() act on the focused track. The focused track's
+   * edits come first in the vocoder queue; the others render behind them.
+   * Message thread only.
+   */
+  int getNumTracks() const { return static_cast<int>(tracks.size()); }
+  int getFocusedTrack() const { return focusedTrack; }
+  const Track &getTrack(int index) const {
+    return tracks[static_cast<size_t>(index)];
+  }
+  // Appends a track and returns its index; focus stays where it is
+  int addTrack(std::unique_ptr<Project> trackProject, const juce::String &name);
+  // The last remaining track cannot be removed
+  void removeTrack(int index);
+  void focusTrack(int index);
+  void setTrackGain(int index, float gain);
+  void setTrackMuted(int index, bool muted);
+  void setTrackName(int index, const juce::String &name);
+
+  /**
+   * Hand the audio engine what the session plays: the focused track's
+   * render alone, or the mix of every track, and the same of the tracks'
+   * originals to compare against. Renders started here call it when they
+   * land; call it after changing a project's render otherwise, or a note's
+   * gain (which needs no render: see GainLane).
+   */
+  void publishPlayback(bool preservePosition = true);
+
   AudioEngine *getAudioEngine() const { return audioEngine.get(); }
   Vocoder *getVocoder() const { return vocoder.get(); }
   AudioAnalyzer *getAudioAnalyzer() const { return audioAnalyzer.get(); }
+  // The focused track's synthesizer
   IncrementalSynthesizer *getIncrementalSynth() const {
-    return incrementalSynth.get();
+    return tracks[static_cast<size_t>(focusedTrack)].synth.get();
   }
   PlaybackController *getPlaybackController() const {
     return playbackController.get();
   }
 
+  // Plugin mode, no audio engine: synthesis starting while an offline host
+  // render waits (position >= 0) does the audio it waits at first
+  void setOfflineRenderFocus(std::function<double()> waitPosition);
+
   void setPitchDetectorType(PitchDetectorType type) {
     pitchDetectorType = type;
     if (audioAnalyzer)
@@ -48,7 +118,78 @@ public:
     deviceId = gpuDeviceId;
   }
 
+  // Per-model device override (e.g. from the provider benchmark). An empty
+  // device name falls back to the global setDeviceConfig() choice.
+  void setModelDevice(OnnxThreading::Model model,
+                      const juce::String &deviceName, int gpuDeviceId) {
+    modelDevices[static_cast<size_t>(model)] = {deviceName, gpuDeviceId};
+  }
+
+  // GPUs to spread the vocoder's sessions and streamed renders over (see
+  // Vocoder::setExecutionDeviceIds()). Two or more replace the vocoder's
+  // single device ID; call reloadInferenceModels() after.
+  void setVocoderDeviceIds(std::vector<int> gpuDeviceIds) {
+    vocoderDeviceIds = std::move(gpuDeviceIds);
+  }
+
+  // Directory holding the ONNX models and tables; defaults to
+  // PlatformPaths::getModelsDirectory(). Call reloadInferenceModels() after.
+  void setModelsDirectory(const juce::File &modelsDir);
+
+  void setModelPrecision(ModelPrecision precision) {
+    modelPrecision = precision;
+  }
+  ModelPrecision getModelPrecision() const { return modelPrecision; }
+
+  // Vocoder model variant for the current device and precision
+  juce::File getVocoderModelFile() const;
+
+  /**
+   * Preview tier (on by default): edits render through a lighter vocoder,
+   * pc_nsf_hifigan.preview.onnx when installed, else the Speed precision
+   * variant, and refinePreviewRenderAsync() re-renders them with the full
+   * model later. Exports and full renders always use the full model. With
+   * no lighter model on the device, edits use the full one. Call
+   * reloadInferenceModels() after.
+   */
+  void setPreviewTier(bool enabled);
+  bool isPreviewTier() const { return previewTier; }
+  // Lighter vocoder model for the device, or an empty File when none is
+  // lighter than the full model
+  juce::File getPreviewVocoderModelFile(const juce::String &vocoderDevice) const;
+
+  /**
+   * Try full-vocoder and RMVPE runs on the inference server at endpoint
+   * ("host:port", see RemoteInference) before the local models; empty runs
+   * everything locally. The preview vocoder stays local: its renders are
+   * refined on the full vocoder anyway.
+   */
+  void setRemoteInference(const juce::String &endpoint);
+  // The same with a client shared by several controllers (InferenceHost)
+  void setRemoteInference(std::shared_ptr<RemoteInference> remote);
+
+  /**
+   * RMVPE F0 of 16 kHz audio, for an inference server answering its
+   * clients. Empty when RMVPE is not loaded.
+   */
+  std::vector<float> extractPitchForClient(const std::vector<float> &audio16k,
+                                           float threshold);
+
+  /**
+   * (Re)load models for the current device settings on background threads:
+   * the vocoder, SOME and the selected pitch detector in parallel. The other
+   * detector loads on first use. With async false this waits for them.
+   * Skipped while an earlier load is still running.
+   */
   void reloadInferenceModels(bool async);
+
+  /**
+   * Block until model has finished loading, starting the load if nothing
+   * has asked for it yet. Returns whether it is usable. Not for the message
+   * thread while loads are running.
+   */
+  bool waitForModel(OnnxThreading::Model model);
+  bool isModelReady(OnnxThreading::Model model) const;
   bool isInferenceBusy() const;
   bool isLoading() const { return isLoadingAudio.load(); }
   bool isRendering() const { return isRenderingFlag.load(); }
@@ -59,21 +200,176 @@ public:
       std::function<void(const juce::AudioBuffer<float> &)>;
   using CancelCallback = std::function<void()>;
 
+  /**
+   * Part of an analysis still in progress: F0 for frames
+   * [startFrame, endFrame) and the notes that end inside those frames.
+   * The first preview of an analysis has an empty range and carries the
+   * waveform; later ones only the new frames and notes. An import also sends
+   * waveform-only previews with the part decoded so far, before analysis.
+   */
+  struct AnalysisPreview {
+    int startFrame = 0;
+    int endFrame = 0;
+    int totalFrames = 0;
+    int sampleRate = 0;
+    std::shared_ptr<juce::AudioBuffer<float>> waveform;
+    std::vector<float> f0;
+    std::vector<Note> notes;
+  };
+  // Called on analysis threads, one call at a time
+  using AnalysisPreviewCallback = std::function<void(AnalysisPreview)>;
+
+  // On the message thread: the notes the project was handed over with and
+  // SOME's notes for the same audio
+  using NotesRefinedCallback = std::function<void(
+      const std::vector<Note> &provisional, std::vector<Note> refined)>;
+
+  /**
+   * With onNotesRefined, onComplete runs as soon as pitch is known if SOME
+   * is still running: the project then has notes segmented from F0, and
+   * onNotesRefined follows with SOME's unless the project is replaced or
+   * another load starts first (which cancels the refinement).
+   */
   void loadAudioFileAsync(const juce::File &file,
                           const ProgressCallback &onProgress,
                           const LoadCompleteCallback &onComplete,
-                          const CancelCallback &onCancelled);
+                          const CancelCallback &onCancelled,
+                          const AnalysisPreviewCallback &onPreview = nullptr,
+                          const NotesRefinedCallback &onNotesRefined = nullptr);
+  /**
+   * Read file as mono audio at SAMPLE_RATE on the calling thread, through
+   * AudioFileManager::decodeMono(); onDecoded sees each decoded chunk and
+   * sourceSampleRate, if given, receives the file's own rate. Returns false
+   * if the file cannot be read or cancelFlag is raised meanwhile.
+   */
+  static bool
+  readAudioFile(const juce::File &file, juce::AudioBuffer<float> &mono,
+                const ProgressCallback &onProgress,
+                const std::atomic<bool> *cancelFlag = nullptr,
+                const AudioFileManager::DecodeCallback &onDecoded = nullptr,
+                int *sourceSampleRate = nullptr);
   void setHostAudioAsync(const juce::AudioBuffer<float> &buffer,
                          double sampleRate,
                          const ProgressCallback &onProgress,
                          const LoadCompleteCallback &onComplete);
+  /**
+   * Infer pitch for the finished chunks of a host capture still in
+   * progress, on a background thread, so setHostAudioAsync() on the whole
+   * take later reuses them. prefix is the take so far at sampleRate. Returns
+   * false without doing anything while the previous call is running or when
+   * RMVPE is not the loaded detector; call again with a longer prefix.
+   */
+  bool preanalyzeHostAudio(const juce::AudioBuffer<float> &prefix,
+                           double sampleRate);
+  /**
+   * Analyse host audio into the analysis cache without showing it, on a
+   * background thread, so setHostAudioAsync() on the same audio later is a
+   * cache hit. onComplete gets the cache entry name (AnalysisCache::Key::
+   * getFileName(); empty if analysis did not finish) on the message thread.
+   * Calls queue up and run one at a time; never blocks.
+   */
+  void analyzeHostAudioInBackground(
+      const juce::AudioBuffer<float> &buffer, double sampleRate,
+      const std::function<void(const juce::String &)> &onComplete);
   void requestCancelLoading();
 
+  /**
+   * Render on a background thread. A non-empty frameRange renders only
+   * frames [first, second), in blocks shared with other range renders
+   * through the synthesis cache (see renderRange()).
+   */
   void renderProcessedAudioAsync(const Project &project,
                                  float globalPitchOffset,
-                                 const std::function<void(bool)> &onComplete);
+                                 const std::function<void(bool)> &onComplete,
+                                 std::pair<int, int> frameRange = {0, 0});
   void requestCancelRender();
 
+  // Full renders and exports skip long quiet stretches and fill them from
+  // the original audio; see SilenceSkipping. Not while one is running.
+  void setSilenceSkipping(const SilenceSkipping::Options &options) {
+    silenceSkipping = options;
+  }
+  const SilenceSkipping::Options &getSilenceSkipping() const {
+    return silenceSkipping;
+  }
+
+  /**
+   * Synthesize an analysed project, edits and global pitch offset included,
+   * into output on the calling thread. Used by the batch tool; safe to call
+   * from several threads at once (the vocoder keeps one session per caller
+   * up to its pool size). Returns false on failure or cancellation.
+   */
+  bool renderProcessedAudio(const Project &sourceProject,
+                            juce::AudioBuffer<float> &output,
+                            const std::atomic<bool> *cancelFlag = nullptr);
+
+  using ExportProgressCallback = std::function<void(double)>;
+  using ExportCompleteCallback =
+      std::function<void(bool ok, const juce::String &error)>;
+
+  /**
+   * Synthesize like renderProcessedAudio(), but hand each chunk to exporter
+   * as the vocoder finishes it instead of keeping the whole render. The
+   * exporter must be open; the caller finishes or aborts it. onProgress
+   * gets the fraction of the expected length written so far.
+   */
+  bool exportProcessedAudio(const Project &sourceProject,
+                            StreamingExporter &exporter,
+                            const ExportProgressCallback &onProgress = nullptr,
+                            const std::atomic<bool> *cancelFlag = nullptr);
+
+  /**
+   * exportProcessedAudio() to every target on a background thread, from a
+   * copy of the project's analysis and edits. Callbacks run on the message
+   * thread, progress once per percent. A cancelled export completes with
+   * ok false and an empty error. Ignored while an export is running.
+   * A non-empty frameRange exports only frames [first, second), rendered
+   * like renderProcessedAudioAsync() does it.
+   */
+  void exportProcessedAudioAsync(const Project &project,
+                                 std::vector<StreamingExporter::Target> targets,
+                                 const ExportProgressCallback &onProgress,
+                                 const ExportCompleteCallback &onComplete,
+                                 std::pair<int, int> frameRange = {0, 0});
+  /** One render of a project: its own key, formant shift and outputs. */
+  struct ExportVariant {
+    float globalPitchOffset = 0.0f; // Replaces the project's, in semitones
+    float formantShift = 0.0f;      // Semitones; see MelFormantShift
+    std::vector<StreamingExporter::Target> targets;
+  };
+  using VariantCompleteCallback =
+      std::function<void(size_t index, bool ok, const juce::String &error)>;
+
+  /**
+   * Export every variant of one analysed project. The analysis is shared and
+   * each distinct formant shift builds one shifted mel, so N variants cost N
+   * vocoder passes and nothing else is repeated. Up to numThreads variants
+   * render at once as JobSystem jobs; give the vocoder as many sessions
+   * (Vocoder::setSessionPoolSize()) for them not to queue. Blocks until all
+   * are done; onVariantDone runs on the job that rendered the variant. Returns true when every
+   * variant was written.
+   */
+  bool exportVariants(const Project &sourceProject,
+                      const std::vector<ExportVariant> &variants,
+                      int numThreads,
+                      const VariantCompleteCallback &onVariantDone = nullptr,
+                      const std::atomic<bool> *cancelFlag = nullptr);
+
+  void requestCancelExport() { cancelExportFlag = true; }
+  bool isExporting() const { return isExportingFlag.load(); }
+
+  using BenchmarkCompleteCallback =
+      std::function<void(const std::vector<ProviderBenchmark::Result> &)>;
+
+  /**
+   * Time every device and GPU this machine has for each model on a
+   * background thread, using the loaded models where they are loaded.
+   * Callbacks run on the message thread; onComplete gets all results.
+   */
+  void runProviderBenchmarkAsync(const ProgressCallback &onProgress,
+                                 const BenchmarkCompleteCallback &onComplete);
+  bool isBenchmarking() const { return isBenchmarkingFlag.load(); }
+
   void resynthesizeIncrementalAsync(
       Project &project,
       const std::function<void(const juce::String &)> &onProgress,
@@ -81,10 +377,44 @@ public:
       std::atomic<bool> &pendingRerun,
       bool isPluginMode);
 
+  /**
+   * Play the project's dirty regions pitch-shifted from the current audio
+   * with PSOLA, without rendering them (IncrementalSynthesizer::
+   * auditionRegion); outside plugin mode the audio engine gets the result
+   * on the message thread. Returns whether the audition started.
+   */
+  bool auditionIncrementalAsync(Project &project, bool isPluginMode);
+
+  /**
+   * Re-render what the preview tier rendered with the full vocoder, once
+   * edits have been idle for idleSeconds. Returns whether it started;
+   * onComplete then runs on the message thread, after the audio engine has
+   * the new render.
+   */
+  bool refinePreviewRenderAsync(Project &project, double idleSeconds,
+                                const std::function<void(bool)> &onComplete);
+
+  /**
+   * Warm the incremental synthesizer's cache for frames [startFrame,
+   * endFrame) as they would render with the notes' current pitch offsets.
+   * Project curves are left untouched; releasing the drag at the same pitch
+   * then commits straight from the cache.
+   */
+  void prefetchIncrementalSynthesis(Project &targetProject, int startFrame,
+                                    int endFrame);
+
+  // Raising cancelFlag aborts the model runs in flight. onProvisional, if
+  // given, is called on this thread when pitch is done but SOME is not, with
+  // targetProject holding notes segmented from F0; they are replaced with
+  // SOME's before onComplete.
   void analyzeAudio(Project &targetProject,
                     const std::function<void(double, const juce::String &)>
                         &onProgress,
-                    std::function<void()> onComplete = nullptr);
+                    std::function<void()> onComplete = nullptr,
+                    const AnalysisPreviewCallback &onPreview = nullptr,
+                    const std::atomic<bool> *cancelFlag = nullptr,
+                    const std::function<void(const Project &)> &onProvisional =
+                        nullptr);
 
   void segmentIntoNotes(Project &targetProject,
                         std::function<void()> onStreamingUpdate = nullptr);
@@ -97,43 +427,188 @@ public:
       const std::function<void(Project &)> &onProjectReady,
       const std::function<void()> &onNotesChanged);
 
+  /** Detection results for one frame range; see analyzeRangeAsync(). */
+  struct RangeAnalysis {
+    int startFrame = 0; // Frames [startFrame, endFrame) to replace
+    int endFrame = 0;
+    bool hasPitch = false;
+    std::vector<float> f0; // Dense source pitch (Hz) for the range
+    VoicedMask voicedMask;
+    bool hasNotes = false;
+    std::vector<Note> notes; // Replace the notes overlapping the range
+  };
+
+  /**
+   * Re-detect pitch and/or notes for frames [startFrame, endFrame) of the
+   * current project without touching the rest of the file. With detectNotes
+   * the range first grows to cover the notes it overlaps. The detectors see
+   * the range plus a second of context on each side, so its edges are
+   * analysed as they would be in a full pass. onComplete runs on the message
+   * thread; splicing the results in is left to the caller. Returns false
+   * (and never calls onComplete) when nothing was started.
+   */
+  bool analyzeRangeAsync(int startFrame, int endFrame, bool detectPitch,
+                         bool detectNotes,
+                         std::function<void(RangeAnalysis)> onComplete);
+  bool isAnalyzingRange() const { return isAnalyzingRangeFlag.load(); }
+
 private:
+  // Turn SOME note events into notes over f0, skipping rests and short notes
+  static void appendNotesFromEvents(
+      std::vector<Note> &notes, const std::vector<float> &f0,
+      const std::vector<SOMEDetector::NoteEvent> &events);
+
+  // F0 at vocoder frame `frame`, interpolated in log space from neural
+  // (RMVPE/FCPE, 100 fps) frames
+  static float neuralF0AtFrame(const std::vector<float> &neuralF0, int frame,
+                               int sampleRate);
+
+  // Scale voiced F0 frames by a global offset in semitones
+  static void shiftVoicedF0(std::vector<float> &f0, const VoicedMask &voicedMask,
+                            float semitones);
+
+  // exportProcessedAudio() over copies of a project's curves. original
+  // fills the skipped silences. A non-empty frameRange goes through
+  // renderRange() instead. gain, if any, is applied to what is written.
+  bool streamToExporter(const MelBuffer &mel, std::vector<float> f0,
+                        VoicedMask voicedMask, float semitones,
+                        RenderSnapshot::Ptr original,
+                        StreamingExporter &exporter,
+                        const ExportProgressCallback &onProgress,
+                        const std::atomic<bool> *cancelFlag,
+                        std::pair<int, int> frameRange = {0, 0},
+                        GainLane::Ptr gain = nullptr);
+
+  /**
+   * Frames [range.first, range.second) of a render of mel and f0 (both with
+   * their shifts applied). The take is cut into rangeBlockFrames blocks on
+   * a grid fixed from frame 0, each vocoded with rangeContextFrames of
+   * input on either side and kept in synthesisCache, so a range rendered
+   * again, or one overlapping it, only vocodes the blocks whose input
+   * changed. onChunk gets the range's samples in order, startSample
+   * counted from range.first.
+   */
+  bool renderRange(const MelBuffer &mel, const std::vector<float> &f0,
+                   std::pair<int, int> range,
+                   const Vocoder::ChunkCallback &onChunk,
+                   const std::atomic<bool> *cancelFlag);
+  static constexpr int rangeBlockFrames = 512;
+  static constexpr int rangeContextFrames = 32;
+
+  // Model file and execution provider for one model under current settings
+  struct ModelTarget {
+    juce::String device;
+    GPUProvider provider;
+    int deviceId;
+    juce::File path;
+  };
+  ModelTarget makeModelTarget(OnnxThreading::Model model) const;
+  // Load (and warm up) one model on the calling thread
+  bool loadModelNow(OnnxThreading::Model model, const ModelTarget &target);
+  bool areModelsLoading() const;
+
   GPUProvider getProviderFromDevice(const juce::String &device) const;
+  juce::String getDeviceFor(OnnxThreading::Model model) const;
+  int getDeviceIdFor(OnnxThreading::Model model) const;
+  // Cache key for analysing audioData with the current detector and models
+  AnalysisCache::Key makeAnalysisCacheKey(const AudioData &audioData) const;
+
+  // A track whose synthesizer renders with the shared models and cache
+  Track makeTrack(std::unique_ptr<Project> trackProject,
+                  const juce::String &name);
+  // The synthesizer of the track holding target, else the focused one
+  IncrementalSynthesizer *getSynthFor(const Project &target) const;
+  // Every track's preview vocoder; callable from model loads
+  void setEditPreviewVocoder(Vocoder *editVocoder);
 
-  std::unique_ptr<Project> project;
   std::unique_ptr<AudioEngine> audioEngine;
   std::unique_ptr<FCPEPitchDetector> fcpePitchDetector;
   std::unique_ptr<RMVPEPitchDetector> rmvpePitchDetector;
   std::unique_ptr<SOMEDetector> someDetector;
   std::unique_ptr<Vocoder> vocoder;
+  std::unique_ptr<Vocoder> previewVocoder; // Loaded with the vocoder
   std::unique_ptr<AudioAnalyzer> audioAnalyzer;
-  std::unique_ptr<IncrementalSynthesizer> incrementalSynth;
   std::unique_ptr<PlaybackController> playbackController;
+  // Shared by the tracks' synthesizers; before them, so it outlives them
+  SynthesisCache synthesisCache;
+  IncrementalSynthesizer::PlayheadProvider playheadProvider;
+  std::vector<Track> tracks;
+  int focusedTrack = 0;
+  // Held while tracks grows or shrinks, and by model loads going over it
+  std::mutex tracksMutex;
+  SessionMixer sessionMixer;
+  SessionMixer originalMixer;
+  AnalysisCache analysisCache;
+  ResampledAudioCache resampledAudio; // Last analysed audio at 16 kHz
+
+  // Detectors keep per-session IO bindings, so analyses running side by
+  // side (batch jobs, range re-analysis) take turns on each model
+  std::mutex pitchDetectorMutex;
+  std::mutex noteDetectorMutex;
 
   juce::File fcpeModelPath;
   juce::File melFilterbankPath;
   juce::File centTablePath;
   juce::File rmvpeModelPath;
   juce::File someModelPath;
+  juce::File vocoderModelPath;
 
   PitchDetectorType pitchDetectorType = PitchDetectorType::RMVPE;
   juce::String device = "CPU";
   int deviceId = 0;
+  ModelPrecision modelPrecision = ModelPrecision::Balanced;
+  bool previewTier = true;
+  std::array<std::pair<juce::String, int>, 4> modelDevices;
+  std::vector<int> vocoderDeviceIds;
+  SilenceSkipping::Options silenceSkipping;
+  std::shared_ptr<RemoteInference> remoteInference;
 
-  std::atomic<bool> isReloadingModels{false};
-  std::thread modelReloadThread;
+  // Model loads in flight or done, indexed by OnnxThreading::Model; no
+  // result yet means the model loads on first use
+  struct ModelLoad {
+    JobSystem::JobHandle job;
+    std::shared_ptr<std::atomic<bool>> loaded;
+  };
+  // Caller holds modelLoadMutex
+  void startModelLoad(OnnxThreading::Model model);
+  mutable std::mutex modelLoadMutex;
+  std::array<ModelLoad, 4> modelLoads;
+  JobSystem::Group modelLoadJobs;
 
-  // Async load state
-  std::thread loaderThread;
-  std::thread loaderJoinerThread;
+  // Async load state. Host audio loads may overlap (the one replaced is
+  // cancelled); other loader jobs wait for the previous one first.
+  JobSystem::Group loaderJobs;
   std::atomic<bool> isLoadingAudio{false};
   std::atomic<bool> cancelLoadingFlag{false};
+  // A file load that handed its project over and still waits for SOME
+  std::atomic<bool> refiningNotes{false};
+  // Bumped by setProject() and by focus changes; message thread only
+  std::uint64_t projectGeneration = 0;
   std::atomic<std::uint64_t> hostAnalysisJobId{0};
 
+  // Pitch inference on a host capture in progress
+  JobSystem::JobHandle preanalysisJob;
+  std::atomic<bool> preanalysisBusy{false};
+  // Analysis of host audio that is not shown (other ARA sources), one at a
+  // time
+  JobSystem::Serial backgroundAnalysis{JobSystem::Priority::Background};
+  std::atomic<bool> stopBackgroundAnalysis{false};
+
   // Async render state
-  std::thread renderThread;
+  JobSystem::JobHandle renderJob;
   std::atomic<bool> cancelRenderFlag{false};
   std::atomic<bool> isRenderingFlag{false};
 
+  // Async export state
+  JobSystem::JobHandle exportJob;
+  std::atomic<bool> cancelExportFlag{false};
+  std::atomic<bool> isExportingFlag{false};
+
+  // Provider benchmark state
+  JobSystem::JobHandle benchmarkJob;
+  std::atomic<bool> cancelBenchmarkFlag{false};
+  std::atomic<bool> isBenchmarkingFlag{false};
+  std::atomic<bool> isAnalyzingRangeFlag{false};
+
   JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(EditorController)
 };
@@ -0,0 +1,56 @@
+#include "GainStage.h"
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+RenderSnapshot::Ptr GainStage::apply(RenderSnapshot::Ptr render, GainLane::Ptr lane) {
+    if (!render || !lane || render->getNumSamples() == 0) {
+        reset();
+        return render;
+    }
+    if (render == previousRender && lane == previousLane)
+        return previousOutput;
+
+    auto applyTile = [&render, &lane](int start, juce::AudioBuffer<float>& tile) {
+        const int count = tile.getNumSamples();
+        for (int ch = 0; ch < tile.getNumChannels(); ++ch) {
+            render->read(ch, start, count, tile.getWritePointer(ch));
+            lane->apply(tile.getWritePointer(ch), count, start);
+        }
+    };
+
+    RenderSnapshot::Ptr output;
+    if (previousOutput && previousRender->getNumSamples() == render->getNumSamples()
+        && previousRender->getNumChannels() == render->getNumChannels()
+        && previousRender->getSampleRate() == render->getSampleRate()) {
+        // Tiles start at the same samples in every snapshot of this length
+        std::vector<std::pair<int, int>> changedRanges;
+        for (int tile = 0; tile < render->getNumTiles(); ++tile) {
+            const int start = tile * RenderSnapshot::tileSize;
+            const int end = std::min(start + RenderSnapshot::tileSize, render->getNumSamples());
+            if (render->sharesTile(*previousRender, tile)
+                && !GainLane::differ(lane.get(), previousLane.get(), start, end))
+                continue;
+            if (!changedRanges.empty() && changedRanges.back().second == start)
+                changedRanges.back().second = end;
+            else
+                changedRanges.emplace_back(start, end);
+        }
+        output = changedRanges.empty() ? previousOutput
+                                       : previousOutput->withGeneratedRanges(changedRanges, applyTile);
+    } else {
+        output = RenderSnapshot::generate(render->getNumChannels(), render->getNumSamples(),
+                                          render->getSampleRate(), applyTile);
+    }
+
+    previousRender = std::move(render);
+    previousLane = std::move(lane);
+    previousOutput = output;
+    return output;
+}
+
+void GainStage::reset() {
+    previousRender.reset();
+    previousLane.reset();
+    previousOutput.reset();
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "../../JuceHeader.h"
+#include "../../Utils/GainLane.h"
+#include "../../Utils/RenderSnapshot.h"
+
+/**
+ * Applies a track's GainLane to its render for playback.
+ *
+ * Like SessionMixer, the stage remembers its previous input and output:
+ * a new render re-applies the lane to the tiles the render replaced, and a
+ * new lane to the tiles whose gain it changed, sharing every other tile
+ * with the previous output. Without a lane the render itself is played.
+ *
+ * Message thread only.
+ */
+class GainStage {
+public:
+    /** render with lane applied; render itself when lane is null. */
+    RenderSnapshot::Ptr apply(RenderSnapshot::Ptr render, GainLane::Ptr lane);
+
+    /** Forget the previous output; the next one is built in full. */
+    void reset();
+
+private:
+    RenderSnapshot::Ptr previousRender;
+    GainLane::Ptr previousLane;
+    RenderSnapshot::Ptr previousOutput;
+};
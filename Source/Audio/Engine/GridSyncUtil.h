@@ -6,7 +6,9 @@
  * Grid Sync Utility
  *
  * Provides utilities for synchronizing the piano roll grid with host tempo.
- * Enables beat-aligned editing and display.
+ * Enables beat-aligned editing and display. Conversions go through the
+ * service's TempoMap, so they follow tempo changes the host played through.
+ * Message thread only.
  *
  * Usage:
  *   GridSyncUtil grid(hostSyncService);
@@ -60,19 +62,9 @@ public:
      */
     double snapToGrid(double timeSeconds, GridResolution resolution) const
     {
-        if (hostSync == nullptr || resolution == GridResolution::None)
+        if (!hasTempoMap() || resolution == GridResolution::None)
             return timeSeconds;
-
-        auto state = hostSync->getCurrentState();
-        if (!state.tempo.hasBpm || state.tempo.bpm <= 0.0)
-            return timeSeconds;
-
-        double gridInterval = getGridIntervalSeconds(resolution, state.tempo);
-        if (gridInterval <= 0.0)
-            return timeSeconds;
-
-        // Round to nearest grid position
-        return std::round(timeSeconds / gridInterval) * gridInterval;
+        return hostSync->getTempoMap().snapSeconds(timeSeconds, getStepBeats(resolution));
     }
 
     /**
@@ -80,18 +72,9 @@ public:
      */
     double snapToPreviousGrid(double timeSeconds, GridResolution resolution) const
     {
-        if (hostSync == nullptr || resolution == GridResolution::None)
-            return timeSeconds;
-
-        auto state = hostSync->getCurrentState();
-        if (!state.tempo.hasBpm || state.tempo.bpm <= 0.0)
-            return timeSeconds;
-
-        double gridInterval = getGridIntervalSeconds(resolution, state.tempo);
-        if (gridInterval <= 0.0)
+        if (!hasTempoMap() || resolution == GridResolution::None)
             return timeSeconds;
-
-        return std::floor(timeSeconds / gridInterval) * gridInterval;
+        return hostSync->getTempoMap().snapSecondsDown(timeSeconds, getStepBeats(resolution));
     }
 
     /**
@@ -99,18 +82,9 @@ public:
      */
     double snapToNextGrid(double timeSeconds, GridResolution resolution) const
     {
-        if (hostSync == nullptr || resolution == GridResolution::None)
+        if (!hasTempoMap() || resolution == GridResolution::None)
             return timeSeconds;
-
-        auto state = hostSync->getCurrentState();
-        if (!state.tempo.hasBpm || state.tempo.bpm <= 0.0)
-            return timeSeconds;
-
-        double gridInterval = getGridIntervalSeconds(resolution, state.tempo);
-        if (gridInterval <= 0.0)
-            return timeSeconds;
-
-        return std::ceil(timeSeconds / gridInterval) * gridInterval;
+        return hostSync->getTempoMap().snapSecondsUp(timeSeconds, getStepBeats(resolution));
     }
 
     // ========== Grid Information ==========
@@ -138,52 +112,27 @@ public:
                                            GridResolution resolution = GridResolution::Beat) const
     {
         std::vector<GridMarker> markers;
+        getGridMarkers(startSeconds, endSeconds, resolution, markers);
+        return markers;
+    }
 
-        if (hostSync == nullptr)
-            return markers;
-
-        auto state = hostSync->getCurrentState();
-        if (!state.tempo.hasBpm || state.tempo.bpm <= 0.0)
-            return markers;
-
-        double beatInterval = state.tempo.getSecondsPerBeat();
-        double barInterval = state.tempo.getSecondsPerBar();
-        double gridInterval = getGridIntervalSeconds(resolution, state.tempo);
-
-        if (gridInterval <= 0.0)
-            return markers;
-
-        // Start from the previous bar
-        double startBar = std::floor(startSeconds / barInterval) * barInterval;
-
-        for (double time = startBar; time <= endSeconds; time += gridInterval)
-        {
-            if (time < startSeconds)
-                continue;
-
-            GridMarker marker;
-            marker.timeSeconds = time;
-            marker.ppqPosition = state.secondsToPpq(time);
-
-            // Calculate bar and beat numbers
-            int totalBeats = static_cast<int>(std::round(time / beatInterval));
-            int beatsPerBar = state.tempo.timeSigNumerator;
-
-            marker.barNumber = (totalBeats / beatsPerBar) + 1;
-            marker.beatNumber = (totalBeats % beatsPerBar) + 1;
-
-            // Determine marker type
-            double barRemainder = std::fmod(time, barInterval);
-            double beatRemainder = std::fmod(time, beatInterval);
-
-            marker.isBarLine = std::abs(barRemainder) < 0.001 || std::abs(barRemainder - barInterval) < 0.001;
-            marker.isBeatLine = std::abs(beatRemainder) < 0.001 || std::abs(beatRemainder - beatInterval) < 0.001;
-            marker.isSubdivision = !marker.isBarLine && !marker.isBeatLine;
-
-            markers.push_back(marker);
-        }
+    /**
+     * Grid markers for a time range into markers (cleared first), so a
+     * repaint can reuse its storage.
+     */
+    void getGridMarkers(double startSeconds, double endSeconds, GridResolution resolution,
+                        std::vector<GridMarker>& markers) const
+    {
+        markers.clear();
+        if (!hasTempoMap() || resolution == GridResolution::None)
+            return;
 
-        return markers;
+        lines.clear();
+        hostSync->getTempoMap().getGridLines(startSeconds, endSeconds, getStepBeats(resolution), lines);
+        markers.reserve(lines.size());
+        for (const auto& line : lines)
+            markers.push_back({line.timeSeconds, line.ppqPosition, line.barNumber, line.beatNumber,
+                               line.isBarLine, line.isBeatLine, !line.isBarLine && !line.isBeatLine});
     }
 
     // ========== Time Conversion ==========
@@ -193,23 +142,15 @@ public:
      */
     juce::String formatBarBeatTick(double timeSeconds, int ticksPerBeat = 480) const
     {
-        if (hostSync == nullptr)
-            return formatTimeOnly(timeSeconds);
-
-        auto state = hostSync->getCurrentState();
-        if (!state.tempo.hasBpm || state.tempo.bpm <= 0.0)
+        if (!hasTempoMap())
             return formatTimeOnly(timeSeconds);
 
-        double beatInterval = state.tempo.getSecondsPerBeat();
-        int beatsPerBar = state.tempo.timeSigNumerator;
-
-        double totalBeats = timeSeconds / beatInterval;
-        int bar = static_cast<int>(totalBeats / beatsPerBar) + 1;
-        double beatInBar = std::fmod(totalBeats, static_cast<double>(beatsPerBar));
-        int beat = static_cast<int>(beatInBar) + 1;
-        int tick = static_cast<int>((beatInBar - std::floor(beatInBar)) * ticksPerBeat);
+        const auto& map = hostSync->getTempoMap();
+        const auto position = map.ppqToBarBeat(map.secondsToPpq(timeSeconds));
+        int beat = static_cast<int>(std::floor(position.beat));
+        int tick = static_cast<int>((position.beat - beat) * ticksPerBeat);
 
-        return juce::String::formatted("%d.%d.%03d", bar, beat, tick);
+        return juce::String::formatted("%d.%d.%03d", position.bar, beat, tick);
     }
 
     /**
@@ -274,6 +215,32 @@ public:
 
 private:
     HostSyncService* hostSync = nullptr;
+    mutable std::vector<TempoMap::GridLine> lines;  // Reused by getGridMarkers()
+
+    bool hasTempoMap() const { return hostSync != nullptr && hostSync->hasTempoMap(); }
+
+    // Grid step in beats of the time signature; 0 = bars
+    static double getStepBeats(GridResolution resolution)
+    {
+        switch (resolution)
+        {
+            case GridResolution::Bar:
+                return 0.0;
+            case GridResolution::Beat:
+                return 1.0;
+            case GridResolution::HalfBeat:
+                return 0.5;
+            case GridResolution::QuarterBeat:
+                return 0.25;
+            case GridResolution::EighthBeat:
+                return 0.125;
+            case GridResolution::Triplet:
+                return 1.0 / 3.0;
+            case GridResolution::None:
+            default:
+                return 0.0;
+        }
+    }
 
     double getGridIntervalSeconds(GridResolution resolution, const HostSyncService::TempoInfo& tempo) const
     {
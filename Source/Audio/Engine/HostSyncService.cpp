@@ -1,9 +1,25 @@
 #include "HostSyncService.h"
 
-HostSyncService::HostSyncService()
-    : atomicState(std::make_shared<AtomicSyncState>())
+namespace
 {
-}
+    bool tempoDiffers(const HostSyncService::TempoInfo& a, const HostSyncService::TempoInfo& b)
+    {
+        return (a.hasBpm && std::abs(a.bpm - b.bpm) > 0.001) ||
+               (a.hasTimeSignature &&
+                (a.timeSigNumerator != b.timeSigNumerator ||
+                 a.timeSigDenominator != b.timeSigDenominator));
+    }
+
+    bool loopDiffers(const HostSyncService::LoopInfo& a, const HostSyncService::LoopInfo& b)
+    {
+        return a.isLoopEnabled != b.isLoopEnabled ||
+               a.hasLoopPoints != b.hasLoopPoints ||
+               a.loopStartPpq != b.loopStartPpq ||
+               a.loopEndPpq != b.loopEndPpq;
+    }
+} // namespace
+
+HostSyncService::HostSyncService() = default;
 
 HostSyncService::~HostSyncService()
 {
@@ -102,59 +118,160 @@ void HostSyncService::updateFromPositionInfo(const juce::AudioPlayHead::Position
         }
     }
 
+    // Transitions are queued as well as published, so none is coalesced away.
+    // The snapshot goes out first: whatever state an event carries is then
+    // never newer than the snapshot the UI reads after draining it
+    TransportEvent event;
+    if (!hasUpdated || newTransport != currentState.transport)
+        event.changes |= TransportEvent::transportChanged;
+    if (!hasUpdated || tempoDiffers(newTempo, currentState.tempo))
+        event.changes |= TransportEvent::tempoChanged;
+    if (!hasUpdated || loopDiffers(newLoop, currentState.loop))
+        event.changes |= TransportEvent::loopChanged;
+    hasUpdated = true;
+
     // Store in current state
     currentState.transport = newTransport;
     currentState.position = newPosition;
     currentState.tempo = newTempo;
     currentState.loop = newLoop;
 
-    // Update atomic state for UI thread
-    auto state = atomicState;
-    state->positionSeconds.store(newPosition.timeInSeconds, std::memory_order_relaxed);
-    state->bpm.store(newTempo.bpm, std::memory_order_relaxed);
-    state->isPlaying.store(newTransport.isPlaying, std::memory_order_relaxed);
-    state->isRecording.store(newTransport.isRecording, std::memory_order_relaxed);
-    state->isLooping.store(newTransport.isLooping, std::memory_order_relaxed);
+    // Hand the whole state to the UI; it polls for changes
+    publishedState.publish(currentState);
 
-    // Notify UI thread of changes (coalesced)
+    if (event.changes != 0)
+    {
+        event.transport = newTransport;
+        event.position = newPosition;
+        event.tempo = newTempo;
+        event.loop = newLoop;
+        pushEvent(event);
+    }
+}
 
-    // Transport change notification
-    if (newTransport != previousTransport)
+HostSyncService::SyncState HostSyncService::getCurrentState() const
+{
+    return publishedState.read();
+}
+
+void HostSyncService::pushEvent(const TransportEvent& event)
+{
+    int start1, size1, start2, size2;
+    eventFifo.prepareToWrite(1, start1, size1, start2, size2);
+    if (size1 == 0)
     {
-        previousTransport = newTransport;
-        notifyTransportChange(newTransport);
+        // The snapshot, published already, carries the latest state
+        droppedEvents.fetch_add(1, std::memory_order_release);
+        return;
     }
+    events[static_cast<size_t>(start1)] = event;
+    eventFifo.finishedWrite(1);
+}
 
-    // Tempo change notification
-    bool tempoChanged = (newTempo.hasBpm && std::abs(newTempo.bpm - previousTempo.bpm) > 0.001) ||
-                        (newTempo.hasTimeSignature &&
-                         (newTempo.timeSigNumerator != previousTempo.timeSigNumerator ||
-                          newTempo.timeSigDenominator != previousTempo.timeSigDenominator));
+// ========== UI Thread Methods ==========
 
-    if (tempoChanged)
+void HostSyncService::dispatchPendingCallbacks()
+{
+    // Every queued transition in order, then the latest snapshot
+    while (eventFifo.getNumReady() > 0)
     {
-        previousTempo = newTempo;
-        notifyTempoChange(newTempo);
+        int start1, size1, start2, size2;
+        eventFifo.prepareToRead(1, start1, size1, start2, size2);
+        const TransportEvent event = events[static_cast<size_t>(start1)];
+        eventFifo.finishedRead(1);
+
+        dispatchChanges((event.changes & TransportEvent::transportChanged) != 0
+                            ? event.transport : lastDispatched.transport,
+                        (event.changes & TransportEvent::tempoChanged) != 0
+                            ? event.tempo : lastDispatched.tempo,
+                        (event.changes & TransportEvent::loopChanged) != 0
+                            ? event.loop : lastDispatched.loop,
+                        event.position);
     }
 
-    // Position update notification (throttled)
-    if (newTransport.isPlaying && positionCallbackEnabled)
+    // Transitions come from the ring alone, in order. The snapshot stands in
+    // for them only once the ring has dropped some; otherwise it may lag an
+    // event still on its way, and replaying it would toggle back
+    const uint32_t dropped = droppedEvents.load(std::memory_order_acquire);
+    SyncState state;
+    const bool changed = publishedState.readIfChanged(state, lastSeenVersion);
+    if (dropped != lastDroppedEvents)
     {
-        auto now = juce::Time::getMillisecondCounter();
+        lastDroppedEvents = dropped;
+        if (!changed)
+            state = publishedState.read();
+        dispatchChanges(state.transport, state.tempo, state.loop, state.position);
+        lastDispatched = state;
+    }
+    else if (changed)
+    {
+        lastDispatched.position = state.position;
+    }
+    else
+    {
+        return;
+    }
+
+    if (state.transport.isPlaying && positionCallbackEnabled)
+    {
+        auto now = static_cast<juce::int64>(juce::Time::getMillisecondCounter());
         if (now - lastPositionCallbackTime >= static_cast<juce::int64>(positionUpdateIntervalMs))
         {
             lastPositionCallbackTime = now;
-            notifyPositionUpdate(newPosition.timeInSeconds);
+            if (auto cb = std::atomic_load(&positionCallback); cb && *cb)
+                (*cb)(state.position.timeInSeconds);
         }
     }
+
+    if (auto cb = std::atomic_load(&fullSyncCallback); cb && *cb)
+        (*cb)(state);
 }
 
-HostSyncService::SyncState HostSyncService::getCurrentState() const
+void HostSyncService::dispatchChanges(const TransportState& transport, const TempoInfo& tempo,
+                                      const LoopInfo& loop, const PositionInfo& position)
 {
-    return currentState;
+    const SyncState previous = lastDispatched;
+    lastDispatched.transport = transport;
+    lastDispatched.tempo = tempo;
+    lastDispatched.loop = loop;
+
+    if (transport != previous.transport)
+        if (auto cb = std::atomic_load(&transportCallback); cb && *cb)
+            (*cb)(transport);
+
+    if (tempoDiffers(tempo, previous.tempo))
+    {
+        updateTempoMap(tempo, position, transport.isPlaying);
+        if (auto cb = std::atomic_load(&tempoCallback); cb && *cb)
+            (*cb)(tempo);
+    }
+
+    if (loopDiffers(loop, previous.loop))
+        if (auto cb = std::atomic_load(&loopCallback); cb && *cb)
+            (*cb)(loop);
 }
 
-// ========== UI Thread Methods ==========
+void HostSyncService::updateTempoMap(const TempoInfo& tempo, const PositionInfo& position, bool playing)
+{
+    if (!tempo.hasBpm || tempo.bpm <= 0.0)
+        return;
+
+    const int numerator = tempo.hasTimeSignature ? tempo.timeSigNumerator : 4;
+    const int denominator = tempo.hasTimeSignature ? tempo.timeSigDenominator : 4;
+    const double seconds = position.hasTimeInSeconds ? position.timeInSeconds : 0.0;
+
+    // Stopped, the session tempo was edited; playing, it is tempo automation
+    // taking effect where playback is
+    if (!playing || !tempoMapFromHost)
+    {
+        const double ppq = position.hasPpqPosition ? position.ppqPosition : seconds * tempo.bpm / 60.0;
+        tempoMap = TempoMap::constant(tempo.bpm, numerator, denominator, seconds, ppq);
+        tempoMapFromHost = true;
+        return;
+    }
+    const double ppq = position.hasPpqPosition ? position.ppqPosition : tempoMap.secondsToPpq(seconds);
+    tempoMap.setTempoFrom(seconds, ppq, tempo.bpm, numerator, denominator);
+}
 
 void HostSyncService::setTransportCallback(TransportCallback callback)
 {
@@ -225,93 +342,3 @@ void HostSyncService::processPendingRequests(juce::AudioPlayHead* playHead)
         playHead->transportPlay(shouldPlay);
     }
 }
-
-// ========== Internal Notification Methods ==========
-
-void HostSyncService::notifyTransportChange(const TransportState& state)
-{
-    auto state_ptr = atomicState;
-
-    if (!state_ptr->transportPending.exchange(true, std::memory_order_acq_rel))
-    {
-        auto cb = std::atomic_load(&transportCallback);
-        if (cb && *cb)
-        {
-            TransportState stateCopy = state;
-            juce::MessageManager::callAsync([cb, stateCopy, state_ptr]()
-            {
-                state_ptr->transportPending.store(false, std::memory_order_release);
-                if (*cb)
-                    (*cb)(stateCopy);
-            });
-        }
-        else
-        {
-            state_ptr->transportPending.store(false, std::memory_order_release);
-        }
-    }
-}
-
-void HostSyncService::notifyPositionUpdate(double seconds)
-{
-    juce::ignoreUnused(seconds);
-    auto state_ptr = atomicState;
-
-    if (!state_ptr->positionPending.exchange(true, std::memory_order_acq_rel))
-    {
-        auto cb = std::atomic_load(&positionCallback);
-        if (cb && *cb)
-        {
-            juce::MessageManager::callAsync([cb, state_ptr]()
-            {
-                state_ptr->positionPending.store(false, std::memory_order_release);
-                // Use latest position from atomic state
-                double latestSeconds = state_ptr->positionSeconds.load(std::memory_order_relaxed);
-                if (*cb)
-                    (*cb)(latestSeconds);
-            });
-        }
-        else
-        {
-            state_ptr->positionPending.store(false, std::memory_order_release);
-        }
-    }
-}
-
-void HostSyncService::notifyTempoChange(const TempoInfo& tempo)
-{
-    auto state_ptr = atomicState;
-
-    if (!state_ptr->tempoPending.exchange(true, std::memory_order_acq_rel))
-    {
-        auto cb = std::atomic_load(&tempoCallback);
-        if (cb && *cb)
-        {
-            TempoInfo tempoCopy = tempo;
-            juce::MessageManager::callAsync([cb, tempoCopy, state_ptr]()
-            {
-                state_ptr->tempoPending.store(false, std::memory_order_release);
-                if (*cb)
-                    (*cb)(tempoCopy);
-            });
-        }
-        else
-        {
-            state_ptr->tempoPending.store(false, std::memory_order_release);
-        }
-    }
-}
-
-void HostSyncService::notifyLoopChange(const LoopInfo& loop)
-{
-    auto cb = std::atomic_load(&loopCallback);
-    if (cb && *cb)
-    {
-        LoopInfo loopCopy = loop;
-        juce::MessageManager::callAsync([cb, loopCopy]()
-        {
-            if (*cb)
-                (*cb)(loopCopy);
-        });
-    }
-}
@@ -1,7 +1,11 @@
 #pragma once
 
 #include "../../JuceHeader.h"
+#include "../../Utils/PublishedState.h"
+#include "TempoMap.h"
+#include <array>
 #include <atomic>
+#include <cstdint>
 #include <functional>
 
 /**
@@ -12,14 +16,18 @@
  *
  * Design principles:
  * - Lock-free communication between audio and UI threads
- * - Coalesced updates to avoid flooding the message thread
+ * - The audio thread publishes a snapshot; the UI polls it, so nothing is
+ *   posted to the message thread per block
+ * - Transport, tempo and loop changes also go through a fixed-size event
+ *   ring, so a change undone before the next poll is still dispatched;
+ *   positions are coalesced to the latest
  * - Safe pointer handling to prevent dangling references
  * - Decoupled from UI components (pure service layer)
  *
  * Thread safety:
  * - All public methods are thread-safe
  * - Audio thread methods are real-time safe (no allocations, no locks)
- * - UI thread methods use MessageManager::callAsync for safe updates
+ * - Callbacks run on the message thread, from dispatchPendingCallbacks()
  */
 class HostSyncService
 {
@@ -164,23 +172,47 @@ public:
      */
     SyncState getCurrentState() const;
 
+    /**
+     * State of the last update, for the audio thread that made it; unlike
+     * getCurrentState() it never retries a read.
+     */
+    const SyncState& getAudioThreadState() const { return currentState; }
+
+    /**
+     * Tempo map of the host session as seen so far: rebuilt when the tempo
+     * changes while stopped, extended from the change point when it changes
+     * during playback. Message thread only; updated by
+     * dispatchPendingCallbacks().
+     */
+    const TempoMap& getTempoMap() const { return tempoMap; }
+    bool hasTempoMap() const { return tempoMapFromHost; }
+
+    /** Transitions lost because the UI had not drained the ring. */
+    uint32_t getDroppedEventCount() const { return droppedEvents.load(std::memory_order_relaxed); }
+
     /**
      * Check if host is currently playing.
      */
-    bool isHostPlaying() const { return currentState.transport.isPlaying; }
+    bool isHostPlaying() const { return getCurrentState().transport.isPlaying; }
 
     /**
      * Get current playback position in seconds.
      */
-    double getPositionSeconds() const { return currentState.position.timeInSeconds; }
+    double getPositionSeconds() const { return getCurrentState().position.timeInSeconds; }
 
     /**
      * Get current tempo in BPM.
      */
-    double getTempoBpm() const { return currentState.tempo.bpm; }
+    double getTempoBpm() const { return getCurrentState().tempo.bpm; }
 
     // ========== UI Thread Methods ==========
 
+    /**
+     * Run the callbacks for whatever changed since the last call.
+     * Call this from the message thread, once per display frame.
+     */
+    void dispatchPendingCallbacks();
+
     /**
      * Set callback for transport state changes.
      * Called on the message thread when transport state changes.
@@ -248,7 +280,7 @@ public:
 
     /**
      * Set minimum interval between position callbacks (in milliseconds).
-     * Default is 16ms (~60fps).
+     * Default is 16ms (~60fps); polling less often than that also limits them.
      */
     void setPositionUpdateInterval(int intervalMs) { positionUpdateIntervalMs = intervalMs; }
 
@@ -258,22 +290,44 @@ public:
     void setPositionCallbackEnabled(bool enabled) { positionCallbackEnabled = enabled; }
 
 private:
-    // Current sync state (updated on audio thread)
-    SyncState currentState;
-
-    // Atomic state for lock-free UI updates
-    struct AtomicSyncState
+    // A change seen by the audio thread, with the state after it
+    struct TransportEvent
     {
-        std::atomic<double> positionSeconds{0.0};
-        std::atomic<double> bpm{120.0};
-        std::atomic<bool> isPlaying{false};
-        std::atomic<bool> isRecording{false};
-        std::atomic<bool> isLooping{false};
-        std::atomic<bool> positionPending{false};
-        std::atomic<bool> transportPending{false};
-        std::atomic<bool> tempoPending{false};
+        enum : uint8_t
+        {
+            transportChanged = 1,
+            tempoChanged = 2,
+            loopChanged = 4
+        };
+
+        uint8_t changes = 0;
+        TransportState transport;
+        PositionInfo position;
+        TempoInfo tempo;
+        LoopInfo loop;
     };
-    std::shared_ptr<AtomicSyncState> atomicState;
+
+    static constexpr int eventCapacity = 64;
+
+    // Audio thread: queue a transition, or count it as dropped
+    void pushEvent(const TransportEvent& event);
+    // Message thread: run the callbacks for what differs from lastDispatched
+    void dispatchChanges(const TransportState& transport, const TempoInfo& tempo,
+                         const LoopInfo& loop, const PositionInfo& position);
+    // Message thread: fold a tempo change at position into tempoMap
+    void updateTempoMap(const TempoInfo& tempo, const PositionInfo& position, bool playing);
+
+    // Sync state being assembled (audio thread only)
+    SyncState currentState;
+    bool hasUpdated = false;
+
+    // Latest state, published by the audio thread for everyone else
+    PublishedState<SyncState> publishedState;
+
+    // Single producer (audio thread), single consumer (message thread)
+    juce::AbstractFifo eventFifo{eventCapacity};
+    std::array<TransportEvent, eventCapacity> events;
+    std::atomic<uint32_t> droppedEvents{0};
 
     // Callbacks (stored with atomic_load/store for thread safety)
     std::shared_ptr<TransportCallback> transportCallback;
@@ -291,18 +345,16 @@ private:
     int positionUpdateIntervalMs = 16;
     bool positionCallbackEnabled = true;
 
-    // Previous state for change detection
-    TransportState previousTransport;
-    TempoInfo previousTempo;
+    // Last state handed to the callbacks, for change detection
+    // (message thread only)
+    uint64_t lastSeenVersion = publishedState.getVersion();
+    uint32_t lastDroppedEvents = 0;
+    SyncState lastDispatched;
+    TempoMap tempoMap;
+    bool tempoMapFromHost = false;
 
     // Throttling
     juce::int64 lastPositionCallbackTime = 0;
 
-    // Internal methods
-    void notifyTransportChange(const TransportState& state);
-    void notifyPositionUpdate(double seconds);
-    void notifyTempoChange(const TempoInfo& tempo);
-    void notifyLoopChange(const LoopInfo& loop);
-
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(HostSyncService)
 };
@@ -0,0 +1,142 @@
+#include "PlaybackRateCache.h"
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+namespace {
+
+// Nodes -2..3 around the output position; weights are products of
+// (t - m) over the other nodes, divided by these constants
+constexpr int lagrangeBefore = 2;
+constexpr int lagrangeAfter = 3;
+constexpr float lagrangeDenominators[6] = {-120.0f, 24.0f, -12.0f, 12.0f, -24.0f, 120.0f};
+
+void resampleTile(const RenderSnapshot& source, int deviceRate, int start, juce::AudioBuffer<float>& tile) {
+    const int sourceRate = source.getSampleRate();
+    const int count = tile.getNumSamples();
+
+    // Source span read by this tile, with the interpolator's support
+    const auto firstIndex = PlaybackRateCache::toSourceSamples(start, sourceRate, deviceRate);
+    const auto lastIndex = PlaybackRateCache::toSourceSamples(start + count - 1, sourceRate, deviceRate);
+    const int readStart = static_cast<int>(firstIndex) - lagrangeBefore;
+    const int readCount = static_cast<int>(lastIndex - firstIndex) + lagrangeBefore + lagrangeAfter + 1;
+
+    // Where the source holds one channel for all, resample it once
+    const bool singleChannel = source.isSingleChannel(readStart, readCount);
+    const int channelsToResample = singleChannel ? std::min(1, tile.getNumChannels()) : tile.getNumChannels();
+
+    std::vector<float> input(static_cast<size_t>(readCount));
+    for (int ch = 0; ch < channelsToResample; ++ch) {
+        source.read(ch, readStart, readCount, input.data());
+        float* out = tile.getWritePointer(ch);
+
+        for (int i = 0; i < count; ++i) {
+            // Exact rational position: index + remainder / deviceRate
+            const int64_t scaled = static_cast<int64_t>(start + i) * sourceRate;
+            const int64_t index = scaled / deviceRate;
+            const float t = static_cast<float>(scaled % deviceRate) / static_cast<float>(deviceRate);
+            const float* x = input.data() + (index - firstIndex);
+
+            float d[6];
+            for (int k = 0; k < 6; ++k)
+                d[k] = t - static_cast<float>(k - lagrangeBefore);
+
+            float prefix = 1.0f;
+            float suffix[6];
+            suffix[5] = 1.0f;
+            for (int k = 4; k >= 0; --k)
+                suffix[k] = suffix[k + 1] * d[k + 1];
+
+            float sum = 0.0f;
+            for (int k = 0; k < 6; ++k) {
+                sum += x[k] * prefix * suffix[k] / lagrangeDenominators[k];
+                prefix *= d[k];
+            }
+            out[i] = sum;
+        }
+    }
+    for (int ch = channelsToResample; ch < tile.getNumChannels(); ++ch)
+        tile.copyFrom(ch, 0, tile, 0, 0, count);
+}
+
+} // namespace
+
+PlaybackRateCache::PlaybackRateCache(ReadyCallback onReadyIn)
+    : onReady(std::move(onReadyIn)), worker([this]() { workerLoop(); }) {}
+
+PlaybackRateCache::~PlaybackRateCache() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopWorker = true;
+    }
+    condition.notify_all();
+    if (worker.joinable())
+        worker.join();
+}
+
+void PlaybackRateCache::request(RenderSnapshot::Ptr source, int deviceRate) {
+    if (!source || deviceRate <= 0)
+        return;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pendingSource = std::move(source);
+        pendingDeviceRate = deviceRate;
+    }
+    condition.notify_one();
+}
+
+RenderSnapshot::Ptr PlaybackRateCache::convert(const RenderSnapshot::Ptr& source, int deviceRate) {
+    const int sourceRate = source->getSampleRate();
+    if (sourceRate == deviceRate || sourceRate <= 0)
+        return source;
+
+    auto generator = [&source, deviceRate](int start, juce::AudioBuffer<float>& tile) {
+        resampleTile(*source, deviceRate, start, tile);
+    };
+
+    const bool incremental = lastSource && lastConverted &&
+                             lastConverted->getSampleRate() == deviceRate &&
+                             lastSource->getSampleRate() == sourceRate &&
+                             lastSource->getNumChannels() == source->getNumChannels() &&
+                             lastSource->getNumSamples() == source->getNumSamples();
+    if (!incremental) {
+        const auto length = toDeviceSamples(source->getNumSamples(), sourceRate, deviceRate);
+        return RenderSnapshot::generate(source->getNumChannels(), static_cast<int>(length), deviceRate,
+                                        generator);
+    }
+
+    // Output samples whose support overlaps a changed source tile
+    std::vector<std::pair<int, int>> dirty;
+    for (int i = 0; i < source->getNumTiles(); ++i) {
+        if (source->sharesTile(*lastSource, i))
+            continue;
+        const int64_t begin = static_cast<int64_t>(i) * RenderSnapshot::tileSize - lagrangeAfter;
+        const int64_t end = static_cast<int64_t>(i + 1) * RenderSnapshot::tileSize + lagrangeBefore;
+        dirty.emplace_back(static_cast<int>(std::max<int64_t>(0, toDeviceSamples(begin, sourceRate, deviceRate))),
+                           static_cast<int>(toDeviceSamples(end, sourceRate, deviceRate) + 1));
+    }
+    if (dirty.empty())
+        return lastConverted;
+    return lastConverted->withGeneratedRanges(dirty, generator);
+}
+
+void PlaybackRateCache::workerLoop() {
+    while (true) {
+        RenderSnapshot::Ptr source;
+        int deviceRate = 0;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            condition.wait(lock, [this]() { return stopWorker || pendingSource != nullptr; });
+            if (stopWorker)
+                return;
+            source = std::move(pendingSource);
+            deviceRate = pendingDeviceRate;
+        }
+
+        auto converted = convert(source, deviceRate);
+        lastSource = source;
+        lastConverted = converted;
+        if (onReady)
+            onReady(std::move(source), std::move(converted));
+    }
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "../../JuceHeader.h"
+#include "../../Utils/RenderSnapshot.h"
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+/**
+ * Keeps a device-rate copy of the playback snapshot, so the audio callback
+ * copies samples instead of resampling them block by block.
+ *
+ * Conversion runs on a worker thread with a stateless 6-point Lagrange
+ * interpolator: every output sample depends only on its own position, so a
+ * tile can be regenerated on its own and still join its neighbours exactly.
+ * When a new source shares tiles with the previous one (incremental
+ * resynthesis), only the output tiles fed by changed source tiles are
+ * regenerated; the rest are shared with the previous conversion.
+ */
+class PlaybackRateCache {
+public:
+    /** Called on the worker thread with a finished conversion. */
+    using ReadyCallback = std::function<void(RenderSnapshot::Ptr source, RenderSnapshot::Ptr converted)>;
+
+    explicit PlaybackRateCache(ReadyCallback onReady);
+    ~PlaybackRateCache();
+
+    /**
+     * Convert source to deviceRate. Replaces a request the worker has not
+     * started yet. When the rates match, source itself is reported back.
+     */
+    void request(RenderSnapshot::Ptr source, int deviceRate);
+
+    /** Position conversions between the two rates, rounded down. */
+    static int64_t toDeviceSamples(int64_t sourceSamples, int sourceRate, int deviceRate) {
+        return sourceSamples * deviceRate / sourceRate;
+    }
+    static int64_t toSourceSamples(int64_t deviceSamples, int sourceRate, int deviceRate) {
+        return deviceSamples * sourceRate / deviceRate;
+    }
+
+private:
+    RenderSnapshot::Ptr convert(const RenderSnapshot::Ptr& source, int deviceRate);
+    void workerLoop();
+
+    ReadyCallback onReady;
+
+    // Worker thread only: the previous conversion, reused incrementally
+    RenderSnapshot::Ptr lastSource;
+    RenderSnapshot::Ptr lastConverted;
+
+    std::mutex mutex;
+    std::condition_variable condition;
+    RenderSnapshot::Ptr pendingSource;
+    int pendingDeviceRate = 0;
+    bool stopWorker = false;
+    std::thread worker;  // Last: starts in the constructor
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PlaybackRateCache)
+};
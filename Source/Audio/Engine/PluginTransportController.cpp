@@ -11,25 +11,14 @@ PluginTransportController::PluginTransportController()
 
             auto cb = std::atomic_load(&playStateCallback);
             if (cb && *cb)
-            {
-                bool playing = state.isPlaying;
-                juce::MessageManager::callAsync([cb, playing]() {
-                    if (*cb)
-                        (*cb)(playing);
-                });
-            }
+                (*cb)(state.isPlaying);
         }
     });
 
     hostSync.setPositionCallback([this](double timeInSeconds) {
         auto cb = std::atomic_load(&positionCallback);
         if (cb && *cb)
-        {
-            juce::MessageManager::callAsync([cb, timeInSeconds]() {
-                if (*cb)
-                    (*cb)(timeInSeconds);
-            });
-        }
+            (*cb)(timeInSeconds);
     });
 }
 
@@ -55,7 +44,7 @@ void PluginTransportController::processBlock(juce::AudioPlayHead* playHead, doub
     // If we have a pending seek and host is not playing, update internal cursor
     if (useInternalCursor.load(std::memory_order_relaxed))
     {
-        auto state = hostSync.getCurrentState();
+        const auto& state = hostSync.getAudioThreadState();
         if (!state.transport.isPlaying)
         {
             // Use internal cursor position when host is stopped
@@ -101,15 +90,8 @@ void PluginTransportController::processPendingRequests(juce::AudioPlayHead* play
         internalCursorPosition.store(seekPos, std::memory_order_relaxed);
         useInternalCursor.store(true, std::memory_order_relaxed);
 
-        // Notify UI of the seek position
-        auto cb = std::atomic_load(&positionCallback);
-        if (cb && *cb)
-        {
-            juce::MessageManager::callAsync([cb, seekPos]() {
-                if (*cb)
-                    (*cb)(seekPos);
-            });
-        }
+        // The UI reports the seek position on its next poll
+        seekNotificationPending.store(true, std::memory_order_release);
     }
 
     // Process play request
@@ -179,6 +161,18 @@ void PluginTransportController::togglePlayPause()
 
 // ========== UI Thread Methods - Callbacks ==========
 
+void PluginTransportController::dispatchPendingCallbacks()
+{
+    if (seekNotificationPending.exchange(false, std::memory_order_acquire))
+    {
+        auto cb = std::atomic_load(&positionCallback);
+        if (cb && *cb)
+            (*cb)(internalCursorPosition.load(std::memory_order_relaxed));
+    }
+
+    hostSync.dispatchPendingCallbacks();
+}
+
 void PluginTransportController::setPlayStateCallback(PlayStateCallback callback)
 {
     std::atomic_store(&playStateCallback, std::make_shared<PlayStateCallback>(std::move(callback)));
@@ -187,16 +181,6 @@ void PluginTransportController::setPlayStateCallback(PlayStateCallback callback)
 void PluginTransportController::setPositionCallback(PositionCallback callback)
 {
     std::atomic_store(&positionCallback, std::make_shared<PositionCallback>(std::move(callback)));
-    hostSync.setPositionCallback([this](double timeInSeconds) {
-        auto cb = std::atomic_load(&positionCallback);
-        if (cb && *cb)
-        {
-            juce::MessageManager::callAsync([cb, timeInSeconds]() {
-                if (*cb)
-                    (*cb)(timeInSeconds);
-            });
-        }
-    });
 }
 
 void PluginTransportController::setTransportCallback(TransportCallback callback)
@@ -25,6 +25,7 @@
  *   transportController->processBlock(getPlayHead(), getSampleRate());
  *
  *   // From UI thread:
+ *   transportController->dispatchPendingCallbacks(); // every display frame
  *   transportController->requestPlay(true);
  *   transportController->requestSeek(5.0); // seek to 5 seconds
  */
@@ -105,6 +106,12 @@ public:
 
     // ========== UI Thread Methods - Callbacks ==========
 
+    /**
+     * Run the callbacks for host changes seen since the last call.
+     * Call this from the message thread, once per display frame.
+     */
+    void dispatchPendingCallbacks();
+
     /**
      * Set callback for play state changes.
      * Called on the message thread when play state changes.
@@ -166,6 +173,7 @@ private:
     // Internal state for seek tracking
     std::atomic<double> internalCursorPosition{0.0};
     std::atomic<bool> useInternalCursor{false};
+    std::atomic<bool> seekNotificationPending{false};
 
     // Callbacks (stored with atomic operations for thread safety)
     std::shared_ptr<PlayStateCallback> playStateCallback;
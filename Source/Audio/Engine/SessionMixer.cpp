@@ -0,0 +1,88 @@
+#include "SessionMixer.h"
+#include <algorithm>
+
+RenderSnapshot::Ptr SessionMixer::mix(const std::vector<Input>& inputs) {
+    std::vector<Input> playable;
+    for (const auto& input : inputs)
+        if (input.snapshot && input.snapshot->getNumSamples() > 0
+            && (playable.empty() || input.snapshot->getSampleRate() == playable.front().snapshot->getSampleRate()))
+            playable.push_back(input);
+    if (playable.empty()) {
+        reset();
+        return nullptr;
+    }
+
+    int numChannels = 1;
+    int numSamples = 0;
+    for (const auto& input : playable) {
+        numChannels = std::max(numChannels, input.snapshot->getNumChannels());
+        numSamples = std::max(numSamples, input.snapshot->getNumSamples());
+    }
+
+    std::vector<float> scratch(static_cast<size_t>(RenderSnapshot::tileSize));
+    auto sumTile = [&playable, &scratch](int start, juce::AudioBuffer<float>& tile) {
+        tile.clear();
+        for (const auto& input : playable) {
+            const auto& source = *input.snapshot;
+            const int count = std::min(tile.getNumSamples(), source.getNumSamples() - start);
+            if (count <= 0 || input.gain == 0.0f)
+                continue;
+            // A mono track reads the same samples on every channel
+            for (int ch = 0; ch < tile.getNumChannels(); ++ch) {
+                source.read(std::min(ch, source.getNumChannels() - 1), start, count, scratch.data());
+                tile.addFrom(ch, 0, scratch.data(), count, input.gain);
+            }
+        }
+    };
+
+    std::vector<std::pair<int, int>> changedRanges;
+    RenderSnapshot::Ptr result;
+    if (previousMix && previousMix->getNumChannels() == numChannels && previousMix->getNumSamples() == numSamples
+        && findChangedTiles(playable, changedRanges))
+        result = changedRanges.empty() ? previousMix : previousMix->withGeneratedRanges(changedRanges, sumTile);
+    else
+        result = RenderSnapshot::generate(numChannels, numSamples, playable.front().snapshot->getSampleRate(), sumTile);
+
+    previousInputs = std::move(playable);
+    previousMix = result;
+    return result;
+}
+
+void SessionMixer::reset() {
+    previousInputs.clear();
+    previousMix.reset();
+}
+
+bool SessionMixer::findChangedTiles(const std::vector<Input>& inputs, std::vector<std::pair<int, int>>& ranges) const {
+    if (inputs.size() != previousInputs.size())
+        return false;
+
+    std::vector<bool> changed(static_cast<size_t>(previousMix->getNumTiles()), false);
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        const auto& current = *inputs[i].snapshot;
+        const auto& previous = *previousInputs[i].snapshot;
+        if (inputs[i].gain != previousInputs[i].gain || current.getNumSamples() != previous.getNumSamples()
+            || current.getNumChannels() != previous.getNumChannels())
+            return false;
+        if (inputs[i].snapshot == previousInputs[i].snapshot)
+            continue;
+        // Tiles start at the same samples in every snapshot
+        for (int tile = 0; tile < current.getNumTiles(); ++tile)
+            if (!current.sharesTile(previous, tile))
+                changed[static_cast<size_t>(tile)] = true;
+    }
+
+    ranges.clear();
+    for (size_t tile = 0; tile < changed.size(); ++tile) {
+        if (!changed[tile])
+            continue;
+        const int start = static_cast<int>(tile) * RenderSnapshot::tileSize;
+        if (!ranges.empty() && ranges.back().second == start)
+            ranges.back().second += RenderSnapshot::tileSize;
+        else
+            ranges.emplace_back(start, start + RenderSnapshot::tileSize);
+    }
+    if (!ranges.empty())
+        ranges.back().second = std::min(ranges.back().second, previousMix->getNumSamples());
+    return true;
+}
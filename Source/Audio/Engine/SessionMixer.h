@@ -0,0 +1,44 @@
+#pragma once
+
+#include "../../JuceHeader.h"
+#include "../../Utils/RenderSnapshot.h"
+#include <utility>
+#include <vector>
+
+/**
+ * Sums the renders of a session's tracks into the one snapshot the audio
+ * engine plays.
+ *
+ * Every track renders into its own tiled snapshot, and an edit on one
+ * track replaces only the tiles it touched. The mixer remembers the inputs
+ * of its previous mix, so a new mix re-sums just the tiles where some input
+ * holds a new tile and shares the rest with the previous mix: an edit costs
+ * a tile's worth of additions per track, not a pass over the whole session.
+ *
+ * Message thread only.
+ */
+class SessionMixer {
+public:
+    struct Input {
+        RenderSnapshot::Ptr snapshot;
+        float gain = 1.0f;
+    };
+
+    /**
+     * The sum of inputs, as long as the longest and as wide as the widest.
+     * Inputs at another sample rate than the first one are left out. Returns
+     * the previous mix itself when no input changed, and null for no inputs.
+     */
+    RenderSnapshot::Ptr mix(const std::vector<Input>& inputs);
+
+    /** Forget the previous mix; the next one is summed in full. */
+    void reset();
+
+private:
+    // Sample ranges of the tiles where inputs differ from previousInputs,
+    // or false when the shapes changed and everything has to be summed
+    bool findChangedTiles(const std::vector<Input>& inputs, std::vector<std::pair<int, int>>& ranges) const;
+
+    std::vector<Input> previousInputs;
+    RenderSnapshot::Ptr previousMix;
+};
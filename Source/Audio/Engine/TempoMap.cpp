@@ -0,0 +1,197 @@
+#include "TempoMap.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    // Grid lines closer than this (in PPQ) to a bar or beat are that line
+    constexpr double lineTolerance = 1.0e-6;
+
+    double toSeconds(const TempoMap::Segment& segment, double ppq)
+    {
+        return segment.startSeconds + (ppq - segment.startPpq) * 60.0 / segment.bpm;
+    }
+
+    double toPpq(const TempoMap::Segment& segment, double seconds)
+    {
+        return segment.startPpq + (seconds - segment.startSeconds) * segment.bpm / 60.0;
+    }
+} // namespace
+
+TempoMap::TempoMap()
+{
+    segments.push_back({});
+}
+
+TempoMap TempoMap::constant(double bpm, int numerator, int denominator, double seconds, double ppq)
+{
+    TempoMap map;
+    map.segments.clear();
+    map.setTempoFrom(seconds, ppq, bpm, numerator, denominator);
+    return map;
+}
+
+void TempoMap::setTempoFrom(double seconds, double ppq, double bpm, int numerator, int denominator)
+{
+    Segment segment;
+    segment.startSeconds = seconds;
+    segment.startPpq = ppq;
+    segment.bpm = bpm > 0.0 ? bpm : 120.0;
+    segment.numerator = std::max(1, numerator);
+    segment.denominator = std::max(1, denominator);
+
+    const auto later = std::lower_bound(segments.begin(), segments.end(), seconds,
+                                        [](const Segment& s, double t) { return s.startSeconds < t; });
+    segments.erase(later, segments.end());
+
+    if (segments.empty())
+    {
+        // The first segment also covers everything before it; bar 1 at PPQ 0
+        segment.barOriginPpq = 0.0;
+        segment.barOriginNumber = 1;
+        segments.push_back(segment);
+        return;
+    }
+    if (segments.size() >= maxSegments)
+        return;
+
+    const Segment& previous = segments.back();
+    const double previousBar = barPpq(previous);
+    const double barsIn = (ppq - previous.barOriginPpq) / previousBar;
+    if (segment.numerator == previous.numerator && segment.denominator == previous.denominator)
+    {
+        // Tempo only: the bars carry on
+        const double bars = std::floor(barsIn + lineTolerance);
+        segment.barOriginPpq = previous.barOriginPpq + bars * previousBar;
+        segment.barOriginNumber = previous.barOriginNumber + static_cast<int>(bars);
+    }
+    else
+    {
+        // New signature: a new bar here, numbered after the one it cuts short
+        segment.barOriginPpq = ppq;
+        segment.barOriginNumber = previous.barOriginNumber + static_cast<int>(std::ceil(barsIn - lineTolerance));
+    }
+    segments.push_back(segment);
+}
+
+const TempoMap::Segment& TempoMap::segmentAtSeconds(double seconds) const
+{
+    auto it = std::upper_bound(segments.begin(), segments.end(), seconds,
+                               [](double t, const Segment& s) { return t < s.startSeconds; });
+    return it == segments.begin() ? segments.front() : *(it - 1);
+}
+
+const TempoMap::Segment& TempoMap::segmentAtPpq(double ppq) const
+{
+    auto it = std::upper_bound(segments.begin(), segments.end(), ppq,
+                               [](double p, const Segment& s) { return p < s.startPpq; });
+    return it == segments.begin() ? segments.front() : *(it - 1);
+}
+
+double TempoMap::secondsToPpq(double seconds) const
+{
+    return toPpq(segmentAtSeconds(seconds), seconds);
+}
+
+double TempoMap::ppqToSeconds(double ppq) const
+{
+    return toSeconds(segmentAtPpq(ppq), ppq);
+}
+
+TempoMap::BarBeat TempoMap::ppqToBarBeat(double ppq) const
+{
+    const Segment& segment = segmentAtPpq(ppq);
+    const double bar = barPpq(segment);
+    const double bars = std::floor((ppq - segment.barOriginPpq) / bar);
+    const double inBar = ppq - segment.barOriginPpq - bars * bar;
+
+    BarBeat result;
+    result.bar = segment.barOriginNumber + static_cast<int>(bars);
+    result.beat = inBar / beatPpq(segment) + 1.0;
+    return result;
+}
+
+double TempoMap::stepPpq(const Segment& segment, double stepBeats)
+{
+    return stepBeats > 0.0 ? stepBeats * beatPpq(segment) : barPpq(segment);
+}
+
+void TempoMap::getGridLines(double startSeconds, double endSeconds, double stepBeats,
+                            std::vector<GridLine>& out) const
+{
+    if (endSeconds < startSeconds)
+        return;
+
+    for (size_t i = 0; i < segments.size(); ++i)
+    {
+        const Segment& segment = segments[i];
+        const bool last = i + 1 == segments.size();
+        const double from = i == 0 ? startSeconds : std::max(startSeconds, segment.startSeconds);
+        const double to = last ? endSeconds : std::min(endSeconds, segments[i + 1].startSeconds);
+        if (from > to || (!last && from == to))
+            continue;
+
+        const double step = stepPpq(segment, stepBeats);
+        const double bar = barPpq(segment);
+        const double beat = beatPpq(segment);
+        const double firstStep = std::ceil((toPpq(segment, from) - segment.barOriginPpq) / step - lineTolerance);
+        const double lastStep = std::floor((toPpq(segment, to) - segment.barOriginPpq) / step + lineTolerance);
+        if (lastStep >= firstStep)
+            out.reserve(out.size() + static_cast<size_t>(lastStep - firstStep) + 1);
+
+        for (double k = firstStep; k <= lastStep; k += 1.0)
+        {
+            const double ppq = segment.barOriginPpq + k * step;
+            const double seconds = toSeconds(segment, ppq);
+            // The next segment starts its own lines
+            if (!last && seconds >= segments[i + 1].startSeconds)
+                break;
+
+            const double bars = std::floor((ppq - segment.barOriginPpq) / bar + lineTolerance);
+            const double inBar = std::max(0.0, ppq - segment.barOriginPpq - bars * bar);
+            const double beats = std::floor(inBar / beat + lineTolerance);
+
+            GridLine line;
+            line.timeSeconds = seconds;
+            line.ppqPosition = ppq;
+            line.barNumber = segment.barOriginNumber + static_cast<int>(bars);
+            line.beatNumber = static_cast<int>(beats) + 1;
+            line.isBarLine = inBar < lineTolerance;
+            line.isBeatLine = std::abs(inBar - beats * beat) < lineTolerance;
+            out.push_back(line);
+        }
+    }
+}
+
+double TempoMap::snapSeconds(double seconds, double stepBeats) const
+{
+    const double down = snapSecondsDown(seconds, stepBeats);
+    const double up = snapSecondsUp(seconds, stepBeats);
+    return seconds - down <= up - seconds ? down : up;
+}
+
+double TempoMap::snapSecondsDown(double seconds, double stepBeats) const
+{
+    const Segment& segment = segmentAtSeconds(seconds);
+    const double step = stepPpq(segment, stepBeats);
+    const double k = std::floor((toPpq(segment, seconds) - segment.barOriginPpq) / step + lineTolerance);
+    const double snapped = toSeconds(segment, segment.barOriginPpq + k * step);
+    // Before the segment the previous one's grid applies; its start is a line
+    return &segment == &segments.front() ? snapped : std::max(snapped, segment.startSeconds);
+}
+
+double TempoMap::snapSecondsUp(double seconds, double stepBeats) const
+{
+    const Segment& segment = segmentAtSeconds(seconds);
+    const double step = stepPpq(segment, stepBeats);
+    const double k = std::ceil((toPpq(segment, seconds) - segment.barOriginPpq) / step - lineTolerance);
+    double snapped = toSeconds(segment, segment.barOriginPpq + k * step);
+
+    // Past the segment the next one's grid starts at its own first line
+    auto next = std::upper_bound(segments.begin(), segments.end(), seconds,
+                                 [](double t, const Segment& s) { return t < s.startSeconds; });
+    if (next != segments.end() && snapped > next->startSeconds)
+        snapped = next->startSeconds;
+    return snapped;
+}
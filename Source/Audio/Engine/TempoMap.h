@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * Tempo and time signature over the timeline, as piecewise-constant
+ * segments.
+ *
+ * Built once per host tempo change (see HostSyncService) rather than derived
+ * from the latest tempo on every conversion. Seconds and quarter notes
+ * (PPQ) convert through a binary search over the segments, and grid lines
+ * for a visible range are generated in one pass per segment.
+ *
+ * A beat is one time signature denominator (a quarter in 4/4, an eighth
+ * in 6/8); a time signature change starts a new bar.
+ */
+class TempoMap
+{
+public:
+    struct Segment
+    {
+        double startSeconds = 0.0;
+        double startPpq = 0.0;
+        double bpm = 120.0;         // Quarter notes per minute
+        int numerator = 4;
+        int denominator = 4;
+        double barOriginPpq = 0.0;  // A bar line at or before startPpq
+        int barOriginNumber = 1;    // Its bar number
+    };
+
+    struct BarBeat
+    {
+        int bar = 1;        // From 1
+        double beat = 1.0;  // From 1; the fraction is the position in the beat
+    };
+
+    struct GridLine
+    {
+        double timeSeconds = 0.0;
+        double ppqPosition = 0.0;
+        int barNumber = 1;
+        int beatNumber = 1;
+        bool isBarLine = false;
+        bool isBeatLine = false;
+    };
+
+    // 120 BPM, 4/4 from timeline 0
+    TempoMap();
+
+    // One tempo everywhere, with ppq at timeline position seconds
+    static TempoMap constant(double bpm, int numerator, int denominator,
+                             double seconds = 0.0, double ppq = 0.0);
+
+    /**
+     * The tempo from seconds (at ppq) on, replacing whatever the map had
+     * from there. Segments before it are kept.
+     */
+    void setTempoFrom(double seconds, double ppq, double bpm, int numerator, int denominator);
+
+    double secondsToPpq(double seconds) const;
+    double ppqToSeconds(double ppq) const;
+    BarBeat ppqToBarBeat(double ppq) const;
+
+    const Segment& segmentAtSeconds(double seconds) const;
+    const Segment& segmentAtPpq(double ppq) const;
+    const std::vector<Segment>& getSegments() const { return segments; }
+
+    /**
+     * Lines every stepBeats beats (of each segment's signature; 0 or less
+     * means bars only) within [startSeconds, endSeconds], appended to out in
+     * time order.
+     */
+    void getGridLines(double startSeconds, double endSeconds, double stepBeats,
+                      std::vector<GridLine>& out) const;
+
+    // Nearest, previous and next grid position of time, stepBeats apart
+    double snapSeconds(double seconds, double stepBeats) const;
+    double snapSecondsDown(double seconds, double stepBeats) const;
+    double snapSecondsUp(double seconds, double stepBeats) const;
+
+private:
+    // Tempo ramps would otherwise grow the map without bound
+    static constexpr size_t maxSegments = 4096;
+
+    static double beatPpq(const Segment& segment) { return 4.0 / segment.denominator; }
+    static double barPpq(const Segment& segment) { return segment.numerator * beatPpq(segment); }
+
+    // stepBeats of the segment in PPQ; a bar for 0 or less
+    static double stepPpq(const Segment& segment, double stepBeats);
+
+    std::vector<Segment> segments;  // By startSeconds; never empty
+};
@@ -1,4 +1,12 @@
 #include "FCPEPitchDetector.h"
+#include "OnnxCancellation.h"
+#include "OnnxGpuMemory.h"
+#include "OnnxSessionRegistry.h"
+#include "OnnxThreading.h"
+#include "PerformanceMetrics.h"
+#include "../Utils/AudioResampler.h"
+#include "../Utils/SalienceDecoder.h"
+#include "../Utils/Tracing.h"
 #include <algorithm>
 #include <cmath>
 #include <numeric>
@@ -12,58 +20,9 @@ FCPEPitchDetector::FCPEPitchDetector() {
 FCPEPitchDetector::~FCPEPitchDetector() = default;
 
 void FCPEPitchDetector::initMelFilterbank() {
-  // Create mel filterbank matching librosa's implementation (Slaney
-  // normalization)
-  const int numBins = N_FFT / 2 + 1; // 513
-
-  // Hz to Mel conversion (HTK formula used by librosa by default when htk=False
-  // is NOT used) Actually librosa uses Slaney by default, but the mel function
-  // with htk=False uses HTK For compatibility with FCPE, we use the HTK formula
-  auto hzToMel = [](float hz) -> float {
-    return 2595.0f * std::log10(1.0f + hz / 700.0f);
-  };
-
-  auto melToHz = [](float mel) -> float {
-    return 700.0f * (std::pow(10.0f, mel / 2595.0f) - 1.0f);
-  };
-
-  float melMin = hzToMel(FMIN);
-  float melMax = hzToMel(FMAX);
-
-  // Create mel points (N_MELS + 2 for triangular filters)
-  std::vector<float> melPoints(N_MELS + 2);
-  for (int i = 0; i <= N_MELS + 1; ++i) {
-    melPoints[i] = melMin + (melMax - melMin) * i / (N_MELS + 1);
-  }
-
-  // Convert to Hz
-  std::vector<float> hzPoints(N_MELS + 2);
-  for (int i = 0; i <= N_MELS + 1; ++i) {
-    hzPoints[i] = melToHz(melPoints[i]);
-  }
-
-  // Create filterbank with Slaney normalization
-  melFilterbank.resize(N_MELS);
-  for (int m = 0; m < N_MELS; ++m) {
-    melFilterbank[m].resize(numBins, 0.0f);
-
-    float fLow = hzPoints[m];
-    float fCenter = hzPoints[m + 1];
-    float fHigh = hzPoints[m + 2];
-
-    // Slaney normalization: 2 / (fHigh - fLow)
-    float enorm = 2.0f / (fHigh - fLow);
-
-    for (int k = 0; k < numBins; ++k) {
-      float freq = static_cast<float>(k) * FCPE_SAMPLE_RATE / N_FFT;
-
-      if (freq >= fLow && freq < fCenter) {
-        melFilterbank[m][k] = enorm * (freq - fLow) / (fCenter - fLow);
-      } else if (freq >= fCenter && freq <= fHigh) {
-        melFilterbank[m][k] = enorm * (fHigh - freq) / (fHigh - fCenter);
-      }
-    }
-  }
+  // FCPE was trained on HTK-scale mels with Slaney area normalization
+  melFilterbank = MelFilterbank::get(FCPE_SAMPLE_RATE, N_FFT, N_MELS, FMIN,
+                                     FMAX, MelFilterbank::Scale::Htk);
 }
 
 void FCPEPitchDetector::initHannWindow() {
@@ -101,13 +60,7 @@ bool FCPEPitchDetector::loadModel(const juce::File &modelPath,
         std::vector<float> data(N_MELS * numBins);
         stream.read(data.data(), data.size() * sizeof(float));
 
-        melFilterbank.resize(N_MELS);
-        for (int m = 0; m < N_MELS; ++m) {
-          melFilterbank[m].resize(numBins);
-          for (int k = 0; k < numBins; ++k) {
-            melFilterbank[m][k] = data[m * numBins + k];
-          }
-        }
+        melFilterbank = MelFilterbank::fromDense(data.data(), N_MELS, numBins);
         DBG("Loaded mel filterbank from file");
       }
     }
@@ -122,15 +75,16 @@ bool FCPEPitchDetector::loadModel(const juce::File &modelPath,
       }
     }
 
-    // Initialize ONNX Runtime
-    onnxEnv = std::make_unique<Ort::Env>(ORT_LOGGING_LEVEL_WARNING,
-                                         "FCPEPitchDetector");
-
     Ort::SessionOptions sessionOptions;
-    sessionOptions.SetIntraOpNumThreads(1);
+    auto threading = OnnxThreading::apply(sessionOptions,
+                                          OnnxThreading::Model::FCPE);
+    DBG("FCPE: " << threading.intraOpThreads << " intra-op thread(s)");
     sessionOptions.SetGraphOptimizationLevel(
         GraphOptimizationLevel::ORT_ENABLE_ALL);
 
+    // Tag of the EP actually in use; keys the optimized-graph cache
+    juce::String deviceTag = "CPU";
+
     // Configure execution provider based on GPU settings
 #if defined(_WIN32) && defined(USE_DIRECTML)
     if (provider == GPUProvider::DirectML) {
@@ -146,6 +100,7 @@ bool FCPEPitchDetector::loadModel(const juce::File &modelPath,
 
         Ort::ThrowOnError(ortDmlApi->SessionOptionsAppendExecutionProvider_DML(
             sessionOptions, deviceId));
+        deviceTag = "DirectML";
         DBG("FCPE: DirectML execution provider added");
       } catch (const Ort::Exception &e) {
         DBG("FCPE: Failed to add DirectML provider, using CPU: " << e.what());
@@ -157,7 +112,9 @@ bool FCPEPitchDetector::loadModel(const juce::File &modelPath,
       try {
         OrtCUDAProviderOptions cudaOptions;
         cudaOptions.device_id = deviceId;
+        OnnxGpuMemory::apply(cudaOptions);
         sessionOptions.AppendExecutionProvider_CUDA(cudaOptions);
+        deviceTag = "CUDA" + juce::String(deviceId);
         DBG("FCPE: CUDA execution provider added, device: " << deviceId);
       } catch (const Ort::Exception &e) {
         DBG("FCPE: Failed to add CUDA provider, using CPU: " << e.what());
@@ -167,6 +124,7 @@ bool FCPEPitchDetector::loadModel(const juce::File &modelPath,
         if (provider == GPUProvider::CoreML) {
       try {
         sessionOptions.AppendExecutionProvider("CoreML");
+        deviceTag = "CoreML";
         DBG("FCPE: CoreML execution provider added");
       } catch (const Ort::Exception &e) {
         DBG("FCPE: Failed to add CoreML provider, using CPU: " << e.what());
@@ -178,15 +136,9 @@ bool FCPEPitchDetector::loadModel(const juce::File &modelPath,
       }
     }
 
-#ifdef _WIN32
-    std::wstring modelPathW = modelPath.getFullPathName().toWideCharPointer();
-    onnxSession = std::make_unique<Ort::Session>(*onnxEnv, modelPathW.c_str(),
-                                                 sessionOptions);
-#else
-    std::string modelPathStr = modelPath.getFullPathName().toStdString();
-    onnxSession = std::make_unique<Ort::Session>(*onnxEnv, modelPathStr.c_str(),
-                                                 sessionOptions);
-#endif
+    onnxSession = OnnxSessionRegistry::acquire(
+        modelPath, sessionOptions, deviceTag,
+        OnnxThreading::describe(threading) + " id " + juce::String(deviceId));
 
     allocator = std::make_unique<Ort::AllocatorWithDefaultOptions>();
 
@@ -215,6 +167,8 @@ bool FCPEPitchDetector::loadModel(const juce::File &modelPath,
       outputNames.push_back(name.c_str());
 
     loaded = true;
+    PerformanceMetrics::getInstance().setDevice(OnnxThreading::Model::FCPE,
+                                                deviceTag);
     DBG("FCPE model loaded successfully");
     return true;
   } catch (const Ort::Exception &e) {
@@ -232,217 +186,148 @@ bool FCPEPitchDetector::loadModel(const juce::File &modelPath,
 #endif
 }
 
-std::vector<float> FCPEPitchDetector::resampleTo16k(const float *audio,
-                                                    int numSamples,
-                                                    int srcRate) {
-  if (srcRate == FCPE_SAMPLE_RATE) {
-    return std::vector<float>(audio, audio + numSamples);
-  }
-
-  // Simple linear interpolation resampling
-  // For production, consider using a proper resampler (e.g., libsamplerate)
-  double ratio = static_cast<double>(FCPE_SAMPLE_RATE) / srcRate;
-  int outSamples = static_cast<int>(numSamples * ratio);
-
-  std::vector<float> resampled(outSamples);
-
-  for (int i = 0; i < outSamples; ++i) {
-    double srcPos = i / ratio;
-    int srcIdx = static_cast<int>(srcPos);
-    double frac = srcPos - srcIdx;
-
-    if (srcIdx + 1 < numSamples) {
-      resampled[i] = static_cast<float>(audio[srcIdx] * (1.0 - frac) +
-                                        audio[srcIdx + 1] * frac);
-    } else if (srcIdx < numSamples) {
-      resampled[i] = audio[srcIdx];
-    }
-  }
-
-  return resampled;
-}
-
-std::vector<std::vector<float>>
-FCPEPitchDetector::extractMel(const std::vector<float> &audio) {
+float *FCPEPitchDetector::extractMel(const float *audio, int numSamples,
+                                     ScratchArena::Scope &scratch,
+                                     int &numFrames) {
   const int numBins = N_FFT / 2 + 1;
 
   // Pad audio (same as PyTorch FCPE)
   int padLeft = (WIN_SIZE - HOP_SIZE) / 2;
   int padRight = std::max((WIN_SIZE - HOP_SIZE + 1) / 2,
-                          WIN_SIZE - static_cast<int>(audio.size()) - padLeft);
+                          WIN_SIZE - numSamples - padLeft);
 
-  std::vector<float> paddedAudio;
+  const int paddedSize = padLeft + numSamples + padRight;
+  float *paddedAudio = scratch.allocate<float>(paddedSize, 0.0f);
 
   // Reflect padding if possible, otherwise zero padding
-  if (padRight < static_cast<int>(audio.size())) {
-    // Reflect padding
-    paddedAudio.reserve(padLeft + audio.size() + padRight);
-
+  if (padRight < numSamples) {
     // Left reflection
-    for (int i = padLeft; i > 0; --i) {
-      paddedAudio.push_back(
-          audio[std::min(i, static_cast<int>(audio.size()) - 1)]);
-    }
+    for (int i = padLeft; i > 0; --i)
+      paddedAudio[padLeft - i] = audio[std::min(i, numSamples - 1)];
 
     // Original audio
-    paddedAudio.insert(paddedAudio.end(), audio.begin(), audio.end());
+    std::copy(audio, audio + numSamples, paddedAudio + padLeft);
 
     // Right reflection
-    int audioSize = static_cast<int>(audio.size());
-    for (int i = 0; i < padRight; ++i) {
-      int idx = audioSize - 2 - i;
-      if (idx < 0)
-        idx = 0;
-      paddedAudio.push_back(audio[idx]);
-    }
+    for (int i = 0; i < padRight; ++i)
+      paddedAudio[padLeft + numSamples + i] =
+          audio[std::max(0, numSamples - 2 - i)];
   } else {
     // Zero padding
-    paddedAudio.resize(padLeft + audio.size() + padRight, 0.0f);
-    std::copy(audio.begin(), audio.end(), paddedAudio.begin() + padLeft);
+    std::copy(audio, audio + numSamples, paddedAudio + padLeft);
   }
 
   // Calculate number of frames
-  int numFrames =
-      1 + (static_cast<int>(paddedAudio.size()) - WIN_SIZE) / HOP_SIZE;
+  numFrames = 1 + (paddedSize - WIN_SIZE) / HOP_SIZE;
   if (numFrames < 1)
     numFrames = 1;
 
-  std::vector<std::vector<float>> mel(numFrames);
+  float *mel = scratch.allocate<float>(static_cast<size_t>(numFrames) * N_MELS);
 
-  // FFT buffer (real + imaginary interleaved for JUCE FFT)
-  std::vector<float> fftBuffer(N_FFT * 2, 0.0f);
+  // FFT buffer (real + imaginary interleaved for JUCE FFT); the magnitudes
+  // are written over its front
+  float *fftBuffer = scratch.allocate<float>(N_FFT * 2);
   juce::dsp::FFT fft(static_cast<int>(std::log2(N_FFT)));
 
   for (int frame = 0; frame < numFrames; ++frame) {
     int start = frame * HOP_SIZE;
 
     // Apply window and prepare FFT input
-    std::fill(fftBuffer.begin(), fftBuffer.end(), 0.0f);
-    for (int i = 0;
-         i < WIN_SIZE && start + i < static_cast<int>(paddedAudio.size());
-         ++i) {
+    std::fill(fftBuffer, fftBuffer + N_FFT * 2, 0.0f);
+    for (int i = 0; i < WIN_SIZE && start + i < paddedSize; ++i) {
       fftBuffer[i] = paddedAudio[start + i] * hannWindow[i];
     }
 
     // Perform FFT
-    fft.performRealOnlyForwardTransform(fftBuffer.data());
+    fft.performRealOnlyForwardTransform(fftBuffer);
 
     // Compute magnitude spectrum
-    std::vector<float> mag(numBins);
     for (int k = 0; k < numBins; ++k) {
       float real = fftBuffer[k * 2];
       float imag = fftBuffer[k * 2 + 1];
-      mag[k] = std::sqrt(real * real + imag * imag + 1e-9f);
+      fftBuffer[k] = std::sqrt(real * real + imag * imag + 1e-9f);
     }
 
     // Apply mel filterbank
-    mel[frame].resize(N_MELS);
-    for (int m = 0; m < N_MELS; ++m) {
-      float sum = 0.0f;
-      for (int k = 0; k < numBins; ++k) {
-        sum += mag[k] * melFilterbank[m][k];
-      }
+    float *melFrame = mel + static_cast<size_t>(frame) * N_MELS;
+    melFilterbank->apply(fftBuffer, melFrame);
 
-      // Dynamic range compression (log)
-      mel[frame][m] = std::log(std::max(sum, CLIP_VAL));
-    }
+    // Dynamic range compression (log)
+    for (int m = 0; m < N_MELS; ++m)
+      melFrame[m] = std::log(std::max(melFrame[m], CLIP_VAL));
   }
 
   return mel;
 }
 
-std::vector<float>
-FCPEPitchDetector::decodeF0(const std::vector<std::vector<float>> &latent,
-                            float threshold) {
-  int numFrames = static_cast<int>(latent.size());
-  std::vector<float> f0(numFrames, 0.0f);
-
-  for (int t = 0; t < numFrames; ++t) {
-    const auto &frame = latent[t];
-
-    // Find max index and confidence
-    int maxIdx = 0;
-    float maxVal = frame[0];
-    for (int i = 1; i < OUT_DIMS; ++i) {
-      if (frame[i] > maxVal) {
-        maxVal = frame[i];
-        maxIdx = i;
-      }
-    }
-
-    // Check confidence threshold
-    if (maxVal <= threshold) {
-      f0[t] = 0.0f;
-      continue;
-    }
-
-    // Local argmax decoder: weighted average around max index
-    int localStart = std::max(0, maxIdx - 4);
-    int localEnd = std::min(OUT_DIMS - 1, maxIdx + 4);
-
-    float weightedSum = 0.0f;
-    float weightSum = 0.0f;
+std::vector<float> FCPEPitchDetector::decodeF0(const float *latent,
+                                               int numFrames,
+                                               float threshold) {
+  // Local argmax decoder: weighted average around max index
+  SalienceDecoder::Layout layout;
+  layout.binCents = centTable.data();
+  layout.numBins = OUT_DIMS;
+  layout.minWeightSum = 1e-9f;
 
-    for (int i = localStart; i <= localEnd; ++i) {
-      weightedSum += centTable[i] * frame[i];
-      weightSum += frame[i];
-    }
+  std::vector<float> f0(numFrames, 0.0f);
+  SalienceDecoder::decode(latent, numFrames, layout, threshold, f0.data());
+  return f0;
+}
 
-    if (weightSum > 1e-9f) {
-      float cent = weightedSum / weightSum;
-      f0[t] = centToF0(cent);
-    } else {
-      f0[t] = 0.0f;
-    }
-  }
+void FCPEPitchDetector::warmUp() {
+  if (!loaded)
+    return;
 
-  return f0;
+  // 0.5 s at the model rate, so no resampling is involved
+  std::vector<float> silence(FCPE_SAMPLE_RATE / 2, 0.0f);
+  extractF0(silence.data(), static_cast<int>(silence.size()),
+            FCPE_SAMPLE_RATE);
+  DBG("FCPE: warm-up done");
 }
 
-std::vector<float> FCPEPitchDetector::extractF0(const float *audio,
-                                                int numSamples, int sampleRate,
-                                                float threshold) {
+std::vector<float>
+FCPEPitchDetector::extractF0(const float *audio, int numSamples, int sampleRate,
+                             float threshold,
+                             const std::atomic<bool> *cancelFlag) {
 #ifdef HAVE_ONNXRUNTIME
   if (!loaded) {
     DBG("FCPE model not loaded");
     return {};
   }
 
-  try {
-    // Step 1: Resample to 16kHz
-    auto audio16k = resampleTo16k(audio, numSamples, sampleRate);
-
-    // Step 2: Extract mel spectrogram
-    auto mel = extractMel(audio16k);
-
-    if (mel.empty()) {
-      DBG("Empty mel spectrogram");
-      return {};
-    }
+  PerformanceMetrics::ScopedInference timing(
+      OnnxThreading::Model::FCPE,
+      static_cast<double>(numSamples) / sampleRate);
 
-    // Step 3: Prepare input tensor [1, T, N_MELS]
-    int numFrames = static_cast<int>(mel.size());
-    std::vector<float> inputData(numFrames * N_MELS);
+  try {
+    // Step 1: Resample to 16kHz, unless the caller passed 16 kHz audio
+    ScratchArena::Scope scratch;
+    audio = AudioResampler::resample(audio, numSamples, sampleRate,
+                                     FCPE_SAMPLE_RATE, scratch);
 
-    for (int t = 0; t < numFrames; ++t) {
-      for (int m = 0; m < N_MELS; ++m) {
-        inputData[t * N_MELS + m] = mel[t][m];
-      }
-    }
+    // Step 2: Extract mel spectrogram, already laid out as [1, T, N_MELS]
+    int numFrames = 0;
+    float *inputData = extractMel(audio, numSamples, scratch, numFrames);
 
+    // Step 3: Input tensor [1, T, N_MELS] over the mel frames
     std::array<int64_t, 3> inputShape = {1, numFrames, N_MELS};
 
     Ort::MemoryInfo memoryInfo = Ort::MemoryInfo::CreateCpu(
         OrtAllocatorType::OrtArenaAllocator, OrtMemType::OrtMemTypeDefault);
 
     Ort::Value inputTensor = Ort::Value::CreateTensor<float>(
-        memoryInfo, inputData.data(), inputData.size(), inputShape.data(),
-        inputShape.size());
+        memoryInfo, inputData, static_cast<size_t>(numFrames) * N_MELS,
+        inputShape.data(), inputShape.size());
 
     // Step 4: Run inference
-    auto outputTensors =
-        onnxSession->Run(Ort::RunOptions{nullptr}, inputNames.data(),
-                         &inputTensor, 1, outputNames.data(), 1);
+    std::vector<Ort::Value> outputTensors;
+    {
+      TRACE_ZONE("FCPE Run");
+      Ort::RunOptions runOptions;
+      OnnxCancellation::ScopedRun cancellation(runOptions, cancelFlag);
+      outputTensors = onnxSession->Run(runOptions, inputNames.data(),
+                                       &inputTensor, 1, outputNames.data(), 1);
+    }
 
     // Step 5: Get output [1, T, OUT_DIMS]
     float *outputData = outputTensors[0].GetTensorMutableData<float>();
@@ -450,17 +335,8 @@ std::vector<float> FCPEPitchDetector::extractF0(const float *audio,
 
     int outFrames = static_cast<int>(outputShape[1]);
 
-    // Convert to 2D vector
-    std::vector<std::vector<float>> latent(outFrames);
-    for (int t = 0; t < outFrames; ++t) {
-      latent[t].resize(OUT_DIMS);
-      for (int d = 0; d < OUT_DIMS; ++d) {
-        latent[t][d] = outputData[t * OUT_DIMS + d];
-      }
-    }
-
     // Step 6: Decode to F0
-    return decodeF0(latent, threshold);
+    return decodeF0(outputData, outFrames, threshold);
   } catch (const Ort::Exception &e) {
     DBG("ONNX Runtime error during inference: " << e.what());
     return {};
@@ -476,60 +352,59 @@ std::vector<float> FCPEPitchDetector::extractF0(const float *audio,
 
 std::vector<float> FCPEPitchDetector::extractF0WithProgress(
     const float *audio, int numSamples, int sampleRate, float threshold,
-    std::function<void(double)> progressCallback) {
+    std::function<void(double)> progressCallback,
+    const std::atomic<bool> *cancelFlag) {
 #ifdef HAVE_ONNXRUNTIME
   if (!loaded) {
     DBG("FCPE model not loaded");
     return {};
   }
 
+  PerformanceMetrics::ScopedInference timing(
+      OnnxThreading::Model::FCPE,
+      static_cast<double>(numSamples) / sampleRate);
+
   try {
     if (progressCallback)
       progressCallback(0.1);
 
-    // Step 1: Resample to 16kHz
-    auto audio16k = resampleTo16k(audio, numSamples, sampleRate);
+    // Step 1: Resample to 16kHz, unless the caller passed 16 kHz audio
+    ScratchArena::Scope scratch;
+    audio = AudioResampler::resample(audio, numSamples, sampleRate,
+                                     FCPE_SAMPLE_RATE, scratch);
 
     if (progressCallback)
       progressCallback(0.3);
 
-    // Step 2: Extract mel spectrogram
-    auto mel = extractMel(audio16k);
-
-    if (mel.empty()) {
-      DBG("Empty mel spectrogram");
-      return {};
-    }
+    // Step 2: Extract mel spectrogram, already laid out as [1, T, N_MELS]
+    int numFrames = 0;
+    float *inputData = extractMel(audio, numSamples, scratch, numFrames);
 
     if (progressCallback)
       progressCallback(0.5);
 
-    // Step 3: Prepare input tensor [1, T, N_MELS]
-    int numFrames = static_cast<int>(mel.size());
-    std::vector<float> inputData(numFrames * N_MELS);
-
-    for (int t = 0; t < numFrames; ++t) {
-      for (int m = 0; m < N_MELS; ++m) {
-        inputData[t * N_MELS + m] = mel[t][m];
-      }
-    }
-
+    // Step 3: Input tensor [1, T, N_MELS] over the mel frames
     std::array<int64_t, 3> inputShape = {1, numFrames, N_MELS};
 
     Ort::MemoryInfo memoryInfo = Ort::MemoryInfo::CreateCpu(
         OrtAllocatorType::OrtArenaAllocator, OrtMemType::OrtMemTypeDefault);
 
     Ort::Value inputTensor = Ort::Value::CreateTensor<float>(
-        memoryInfo, inputData.data(), inputData.size(), inputShape.data(),
-        inputShape.size());
+        memoryInfo, inputData, static_cast<size_t>(numFrames) * N_MELS,
+        inputShape.data(), inputShape.size());
 
     if (progressCallback)
       progressCallback(0.6);
 
     // Step 4: Run inference
-    auto outputTensors =
-        onnxSession->Run(Ort::RunOptions{nullptr}, inputNames.data(),
-                         &inputTensor, 1, outputNames.data(), 1);
+    std::vector<Ort::Value> outputTensors;
+    {
+      TRACE_ZONE("FCPE Run");
+      Ort::RunOptions runOptions;
+      OnnxCancellation::ScopedRun cancellation(runOptions, cancelFlag);
+      outputTensors = onnxSession->Run(runOptions, inputNames.data(),
+                                       &inputTensor, 1, outputNames.data(), 1);
+    }
 
     if (progressCallback)
       progressCallback(0.8);
@@ -540,20 +415,11 @@ std::vector<float> FCPEPitchDetector::extractF0WithProgress(
 
     int outFrames = static_cast<int>(outputShape[1]);
 
-    // Convert to 2D vector
-    std::vector<std::vector<float>> latent(outFrames);
-    for (int t = 0; t < outFrames; ++t) {
-      latent[t].resize(OUT_DIMS);
-      for (int d = 0; d < OUT_DIMS; ++d) {
-        latent[t][d] = outputData[t * OUT_DIMS + d];
-      }
-    }
-
     if (progressCallback)
       progressCallback(0.9);
 
     // Step 6: Decode to F0
-    auto result = decodeF0(latent, threshold);
+    auto result = decodeF0(outputData, outFrames, threshold);
 
     if (progressCallback)
       progressCallback(1.0);
@@ -1,8 +1,11 @@
 #pragma once
 
 #include "../JuceHeader.h"
+#include "../Utils/MelFilterbank.h"
+#include "../Utils/ScratchArena.h"
 #include <vector>
 #include <array>
+#include <atomic>
 #include <memory>
 
 #ifdef HAVE_ONNXRUNTIME
@@ -36,6 +39,7 @@ public:
     static constexpr float F0_MAX = 1975.5f;
     static constexpr int OUT_DIMS = 360;
     static constexpr int INPUT_CHANNELS = 128;
+    static constexpr float DEFAULT_THRESHOLD = 0.05f;
     
     // Mel extraction constants (must match training)
     static constexpr int FCPE_SAMPLE_RATE = 16000;
@@ -69,6 +73,13 @@ public:
      * Check if model is loaded.
      */
     bool isLoaded() const { return loaded; }
+
+    /**
+     * Run one short inference on silence so graph initialization and kernel
+     * selection happen now rather than on the first real call. Blocking;
+     * call from a background thread, not concurrently with other calls.
+     */
+    void warmUp();
     
     /**
      * Extract F0 from audio buffer.
@@ -77,18 +88,21 @@ public:
      * @param audio Audio samples
      * @param numSamples Number of samples
      * @param sampleRate Original sample rate
-     * @param threshold Confidence threshold (default 0.05)
+     * @param threshold Confidence threshold (DEFAULT_THRESHOLD)
+     * @param cancelFlag Raising it aborts the run; the result is then empty
      * @return F0 values in Hz (0 for unvoiced frames)
      */
     std::vector<float> extractF0(const float* audio, int numSamples,
-                                  int sampleRate, float threshold = 0.05f);
+                                  int sampleRate, float threshold = DEFAULT_THRESHOLD,
+                                  const std::atomic<bool>* cancelFlag = nullptr);
 
     /**
      * Extract F0 with progress callback.
      */
     std::vector<float> extractF0WithProgress(const float* audio, int numSamples,
                                               int sampleRate, float threshold,
-                                              std::function<void(double)> progressCallback);
+                                              std::function<void(double)> progressCallback,
+                                              const std::atomic<bool>* cancelFlag = nullptr);
 
     /**
      * Get the number of F0 frames that will be produced for given audio length.
@@ -108,8 +122,8 @@ public:
 private:
     bool loaded = false;
     
-    // Mel filterbank matrix [N_MELS x (N_FFT/2+1)]
-    std::vector<std::vector<float>> melFilterbank;
+    // Mel filterbank [N_MELS x (N_FFT/2+1)], stored sparsely
+    MelFilterbank::Ptr melFilterbank;
     
     // Hann window [WIN_SIZE]
     std::vector<float> hannWindow;
@@ -126,15 +140,12 @@ private:
     // Initialize cent table
     void initCentTable();
     
-    // Resample audio to 16kHz
-    std::vector<float> resampleTo16k(const float* audio, int numSamples, int srcRate);
-    
-    // Extract mel spectrogram
-    std::vector<std::vector<float>> extractMel(const std::vector<float>& audio);
+    // Log-mel frames [numFrames, N_MELS], the model's input layout, in scratch
+    float* extractMel(const float* audio, int numSamples, ScratchArena::Scope& scratch,
+                      int& numFrames);
     
-    // Decode latent to F0 (local argmax decoder)
-    std::vector<float> decodeF0(const std::vector<std::vector<float>>& latent, 
-                                 float threshold);
+    // Decode latent [numFrames, OUT_DIMS] to F0 (local argmax decoder)
+    std::vector<float> decodeF0(const float* latent, int numFrames, float threshold);
     
     // Convert cent to F0
     static float centToF0(float cent) {
@@ -147,8 +158,7 @@ private:
     }
     
 #ifdef HAVE_ONNXRUNTIME
-    std::unique_ptr<Ort::Env> onnxEnv;
-    std::unique_ptr<Ort::Session> onnxSession;
+    std::shared_ptr<Ort::Session> onnxSession; // From OnnxSessionRegistry
     std::unique_ptr<Ort::AllocatorWithDefaultOptions> allocator;
     
     std::vector<const char*> inputNames;
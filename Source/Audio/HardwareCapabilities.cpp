@@ -0,0 +1,301 @@
+#include "HardwareCapabilities.h"
+#include "../Utils/AppLogger.h"
+
+#ifdef HAVE_ONNXRUNTIME
+#include <onnxruntime_cxx_api.h>
+#endif
+
+#if JUCE_WINDOWS
+#include <dxgi1_6.h>
+#include <windows.h>
+#endif
+
+namespace {
+#if JUCE_WINDOWS
+constexpr const char *cudaDriverName = "nvcuda.dll";
+#else
+constexpr const char *cudaDriverName = "libcuda.so.1";
+#endif
+
+// Drivers raise the adapters-changed event several times while an adapter
+// comes up; one enumeration after they settle covers all of them
+constexpr int adapterChangeSettleMs = 500;
+
+juce::StringArray getProviderDevices() {
+  juce::StringArray devices{"CPU"};
+#ifdef HAVE_ONNXRUNTIME
+  try {
+    bool hasCuda = false, hasDml = false, hasCoreML = false,
+         hasTensorRT = false;
+    for (const auto &provider : Ort::GetAvailableProviders()) {
+      if (provider == "CUDAExecutionProvider")
+        hasCuda = true;
+      else if (provider == "DmlExecutionProvider")
+        hasDml = true;
+      else if (provider == "CoreMLExecutionProvider")
+        hasCoreML = true;
+      else if (provider == "TensorrtExecutionProvider")
+        hasTensorRT = true;
+    }
+
+    // DML and CUDA are mutually exclusive; a CPU build lists whichever
+    // the runtime library happens to have
+#ifdef USE_DIRECTML
+    if (hasDml)
+      devices.add("DirectML");
+#elif defined(USE_CUDA)
+    if (hasCuda)
+      devices.add("CUDA");
+#else
+    if (hasCuda)
+      devices.add("CUDA");
+    if (hasDml)
+      devices.add("DirectML");
+#endif
+    if (hasCoreML)
+      devices.add("CoreML");
+    if (hasTensorRT)
+      devices.add("TensorRT");
+  } catch (const std::exception &e) {
+    LOG_WARNING("HardwareCapabilities: cannot list ONNX Runtime providers: " +
+                juce::String(e.what()));
+  }
+#endif
+  return devices;
+}
+
+// Through the driver API rather than the runtime: the driver is installed
+// with every NVIDIA driver, whichever CUDA version the runtime is, and
+// none of these calls creates a context
+std::vector<HardwareCapabilities::Adapter> getCudaDevices() {
+  std::vector<HardwareCapabilities::Adapter> adapters;
+  juce::DynamicLibrary driver;
+  if (!driver.open(cudaDriverName))
+    return adapters;
+
+  using InitFn = int (*)(unsigned int);
+  using CountFn = int (*)(int *);
+  using GetFn = int (*)(int *, int);
+  using NameFn = int (*)(char *, int, int);
+  using MemoryFn = int (*)(size_t *, int);
+  using AttributeFn = int (*)(int *, int, int);
+  auto cuInit = reinterpret_cast<InitFn>(driver.getFunction("cuInit"));
+  auto cuDeviceGetCount =
+      reinterpret_cast<CountFn>(driver.getFunction("cuDeviceGetCount"));
+  auto cuDeviceGet = reinterpret_cast<GetFn>(driver.getFunction("cuDeviceGet"));
+  auto cuDeviceGetName =
+      reinterpret_cast<NameFn>(driver.getFunction("cuDeviceGetName"));
+  auto cuDeviceTotalMem =
+      reinterpret_cast<MemoryFn>(driver.getFunction("cuDeviceTotalMem_v2"));
+  auto cuDeviceGetAttribute = reinterpret_cast<AttributeFn>(
+      driver.getFunction("cuDeviceGetAttribute"));
+  int count = 0;
+  if (cuInit == nullptr || cuDeviceGetCount == nullptr ||
+      cuDeviceGet == nullptr || cuInit(0) != 0 ||
+      cuDeviceGetCount(&count) != 0)
+    return adapters;
+
+  constexpr int computeMajorAttribute = 75; // CU_DEVICE_ATTRIBUTE_COMPUTE_*
+  constexpr int computeMinorAttribute = 76;
+  for (int ordinal = 0; ordinal < count; ++ordinal) {
+    int device = 0;
+    if (cuDeviceGet(&device, ordinal) != 0)
+      continue;
+
+    HardwareCapabilities::Adapter adapter;
+    adapter.deviceId = ordinal;
+    adapter.name = "GPU " + juce::String(ordinal);
+    char name[256] = {};
+    if (cuDeviceGetName != nullptr &&
+        cuDeviceGetName(name, static_cast<int>(sizeof(name)) - 1, device) ==
+            0 &&
+        name[0] != '\0')
+      adapter.name = juce::String(name);
+    size_t memory = 0;
+    if (cuDeviceTotalMem != nullptr && cuDeviceTotalMem(&memory, device) == 0)
+      adapter.memoryBytes = static_cast<juce::int64>(memory);
+    if (cuDeviceGetAttribute != nullptr) {
+      cuDeviceGetAttribute(&adapter.computeMajor, computeMajorAttribute,
+                           device);
+      cuDeviceGetAttribute(&adapter.computeMinor, computeMinorAttribute,
+                           device);
+    }
+    adapters.push_back(adapter);
+  }
+  return adapters;
+}
+
+std::vector<HardwareCapabilities::Adapter> getDxgiAdapters() {
+  std::vector<HardwareCapabilities::Adapter> adapters;
+#if JUCE_WINDOWS
+  IDXGIFactory1 *factory = nullptr;
+  if (FAILED(CreateDXGIFactory1(__uuidof(IDXGIFactory1),
+                                reinterpret_cast<void **>(&factory))) ||
+      factory == nullptr)
+    return adapters;
+
+  for (UINT i = 0;; ++i) {
+    IDXGIAdapter1 *adapter = nullptr;
+    const auto hr = factory->EnumAdapters1(i, &adapter);
+    if (hr == DXGI_ERROR_NOT_FOUND)
+      break;
+    if (FAILED(hr) || adapter == nullptr)
+      continue;
+
+    DXGI_ADAPTER_DESC1 desc{};
+    if (SUCCEEDED(adapter->GetDesc1(&desc)) &&
+        (desc.Flags & DXGI_ADAPTER_FLAG_SOFTWARE) == 0) {
+      HardwareCapabilities::Adapter entry;
+      entry.name = juce::String(desc.Description);
+      entry.deviceId = static_cast<int>(adapters.size());
+      entry.memoryBytes = static_cast<juce::int64>(desc.DedicatedVideoMemory);
+      adapters.push_back(entry);
+    }
+    adapter->Release();
+  }
+  factory->Release();
+#endif
+  return adapters;
+}
+} // namespace
+
+const std::vector<HardwareCapabilities::Adapter> &
+HardwareCapabilities::Snapshot::getAdapters(const juce::String &device) const {
+  static const std::vector<Adapter> none;
+  if (device == "CUDA" || device == "TensorRT")
+    return cudaDevices;
+  if (device == "DirectML")
+    return dxgiAdapters;
+  return none;
+}
+
+HardwareCapabilities &HardwareCapabilities::getInstance() {
+  static HardwareCapabilities instance;
+  return instance;
+}
+
+HardwareCapabilities::~HardwareCapabilities() { stop(); }
+
+void HardwareCapabilities::init() {
+  auto &capabilities = getInstance();
+  std::lock_guard<std::mutex> lock(capabilities.lifecycleMutex);
+  if (capabilities.numUsers++ > 0)
+    return;
+#if JUCE_WINDOWS
+  capabilities.stopEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+#endif
+  capabilities.thread = std::thread([&capabilities]() { capabilities.run(); });
+}
+
+void HardwareCapabilities::shutdown() {
+  auto &capabilities = getInstance();
+  std::lock_guard<std::mutex> lock(capabilities.lifecycleMutex);
+  if (capabilities.numUsers > 0 && --capabilities.numUsers == 0)
+    capabilities.stop();
+}
+
+void HardwareCapabilities::stop() {
+#if JUCE_WINDOWS
+  if (stopEvent != nullptr)
+    SetEvent(static_cast<HANDLE>(stopEvent));
+#endif
+  if (thread.joinable())
+    thread.join();
+#if JUCE_WINDOWS
+  if (stopEvent != nullptr)
+    CloseHandle(static_cast<HANDLE>(stopEvent));
+  stopEvent = nullptr;
+#endif
+}
+
+HardwareCapabilities::Ptr HardwareCapabilities::get() {
+  bool started = false;
+  {
+    std::lock_guard<std::mutex> lifecycleLock(lifecycleMutex);
+    started = numUsers > 0;
+  }
+  std::unique_lock<std::mutex> lock(mutex);
+  if (snapshot == nullptr && !started) {
+    lock.unlock();
+    auto fresh = enumerate();
+    lock.lock();
+    if (snapshot == nullptr)
+      snapshot = std::move(fresh);
+    return snapshot;
+  }
+  published.wait(lock, [this]() { return snapshot != nullptr; });
+  return snapshot;
+}
+
+HardwareCapabilities::Ptr HardwareCapabilities::enumerate() {
+  const auto start = juce::Time::getMillisecondCounterHiRes();
+  auto fresh = std::make_shared<Snapshot>();
+  fresh->devices = getProviderDevices();
+  if (fresh->devices.contains("CUDA") || fresh->devices.contains("TensorRT"))
+    fresh->cudaDevices = getCudaDevices();
+  if (fresh->devices.contains("CUDA") || fresh->devices.contains("DirectML"))
+    fresh->dxgiAdapters = getDxgiAdapters();
+
+  juce::StringArray adapters;
+  for (const auto *list : {&fresh->cudaDevices, &fresh->dxgiAdapters})
+    for (const auto &adapter : *list)
+      adapters.add(adapter.memoryBytes > 0
+                       ? adapter.name + " " +
+                             juce::File::descriptionOfSizeInBytes(
+                                 adapter.memoryBytes)
+                       : adapter.name);
+  LOG("HardwareCapabilities: " + fresh->devices.joinIntoString(", ") +
+      (adapters.isEmpty() ? juce::String()
+                          : "; " + adapters.joinIntoString(", ")) +
+      " (" +
+      juce::String(juce::Time::getMillisecondCounterHiRes() - start, 0) +
+      " ms)");
+  return fresh;
+}
+
+void HardwareCapabilities::publish(Ptr fresh) {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    snapshot = std::move(fresh);
+  }
+  published.notify_all();
+  sendChangeMessage();
+}
+
+void HardwareCapabilities::run() {
+  juce::Thread::setCurrentThreadName("HachiTune Hardware");
+  publish(enumerate());
+
+#if JUCE_WINDOWS
+  // IDXGIFactory7 needs Windows 10 1803; without it the first snapshot stays
+  IDXGIFactory1 *factory = nullptr;
+  IDXGIFactory7 *watcher = nullptr;
+  if (FAILED(CreateDXGIFactory1(__uuidof(IDXGIFactory1),
+                                reinterpret_cast<void **>(&factory))) ||
+      factory == nullptr)
+    return;
+  factory->QueryInterface(__uuidof(IDXGIFactory7),
+                          reinterpret_cast<void **>(&watcher));
+  factory->Release();
+  if (watcher == nullptr)
+    return;
+
+  HANDLE changed = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+  DWORD cookie = 0;
+  if (changed != nullptr &&
+      SUCCEEDED(watcher->RegisterAdaptersChangedEvent(changed, &cookie))) {
+    const HANDLE events[] = {static_cast<HANDLE>(stopEvent), changed};
+    while (WaitForMultipleObjects(2, events, FALSE, INFINITE) ==
+           WAIT_OBJECT_0 + 1) {
+      if (WaitForSingleObject(events[0], adapterChangeSettleMs) ==
+          WAIT_OBJECT_0)
+        break;
+      publish(enumerate());
+    }
+    watcher->UnregisterAdaptersChangedEvent(cookie);
+  }
+  if (changed != nullptr)
+    CloseHandle(changed);
+  watcher->Release();
+#endif
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "../JuceHeader.h"
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * The execution providers and GPUs this machine has, enumerated once on a
+ * background thread at startup and shared by the settings dialog and model
+ * loading.
+ *
+ * Asking the CUDA driver and DXGI costs hundreds of milliseconds on some
+ * drivers, so nothing enumerates on demand. On Windows the thread then
+ * waits for DXGI's adapters-changed event (an eGPU plugged in, a driver
+ * update) and enumerates again; listeners get a change message on the
+ * message thread whenever a new snapshot is published.
+ */
+class HardwareCapabilities : public juce::ChangeBroadcaster {
+public:
+  struct Adapter {
+    juce::String name;
+    int deviceId = 0;             // Index the execution provider takes
+    juce::int64 memoryBytes = 0;  // Dedicated video memory; 0 if unknown
+    int computeMajor = 0;         // CUDA compute capability; 0 elsewhere
+    int computeMinor = 0;
+  };
+
+  struct Snapshot {
+    // Devices models can be loaded on: "CPU", then the available providers
+    juce::StringArray devices;
+    std::vector<Adapter> cudaDevices;  // From the CUDA driver
+    std::vector<Adapter> dxgiAdapters; // Hardware adapters, in DirectML order
+
+    // The adapters device ids index for device; empty when it has none or
+    // they are unknown (CPU, CoreML)
+    const std::vector<Adapter> &getAdapters(const juce::String &device) const;
+  };
+
+  using Ptr = std::shared_ptr<const Snapshot>;
+
+  static HardwareCapabilities &getInstance();
+
+  // Start the enumeration thread on the first call and stop it after the
+  // last shutdown(), like JobSystem::init()
+  static void init();
+  static void shutdown();
+
+  /**
+   * The latest snapshot. Waits for the first enumeration if it is still
+   * running, and enumerates on the calling thread if init() was never
+   * called (command line tools).
+   */
+  Ptr get();
+
+  ~HardwareCapabilities() override;
+
+private:
+  HardwareCapabilities() = default;
+
+  static Ptr enumerate();
+  void publish(Ptr snapshot);
+  void run();
+  void stop();
+
+  std::mutex mutex;
+  std::condition_variable published;
+  Ptr snapshot;
+
+  std::mutex lifecycleMutex;
+  std::thread thread;
+  int numUsers = 0;
+#if JUCE_WINDOWS
+  void *stopEvent = nullptr; // Wakes run() from its adapter change wait
+#endif
+
+  JUCE_DECLARE_NON_COPYABLE(HardwareCapabilities)
+};
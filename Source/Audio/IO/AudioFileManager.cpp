@@ -1,116 +1,95 @@
 #include "AudioFileManager.h"
+#include "../../Utils/AudioResampler.h"
 #include "../../Utils/Localization.h"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+
+namespace {
+std::unique_ptr<juce::AudioFormatReader>
+createReader(juce::AudioFormatManager &formatManager, const juce::File &file) {
+  // WAV and AIFF read straight out of the page cache instead of through a
+  // stream buffer
+  if (auto *format =
+          formatManager.findFormatForFileExtension(file.getFileExtension())) {
+    std::unique_ptr<juce::MemoryMappedAudioFormatReader> mapped(
+        format->createMemoryMappedReader(file));
+    if (mapped != nullptr && mapped->mapEntireFile())
+      return mapped;
+  }
+  return std::unique_ptr<juce::AudioFormatReader>(
+      formatManager.createReaderFor(file));
+}
+} // namespace
 
-AudioFileManager::AudioFileManager() {
-  workerThread = std::thread([this]() {
-    for (;;) {
-      LoadTask task;
-      {
-        std::unique_lock<std::mutex> lock(queueMutex);
-        queueCv.wait(lock, [this]() {
-          return isShuttingDown.load() || !loadQueue.empty();
-        });
-
-        if (isShuttingDown.load() && loadQueue.empty())
-          return;
-
-        task = std::move(loadQueue.front());
-        loadQueue.pop_front();
-        currentCancelFlag = task.cancelFlag;
-        isLoadingAudio = true;
-      }
-
-      auto finishTask = [this]() {
-        std::lock_guard<std::mutex> lock(queueMutex);
-        currentCancelFlag.reset();
-        isLoadingAudio = false;
-      };
-
-      // Early cancel
-      if (task.cancelFlag && task.cancelFlag->load()) {
-        finishTask();
-        continue;
-      }
-
-      if (isShuttingDown.load()) {
-        finishTask();
-        continue;
-      }
-
-      if (task.onProgress)
-        task.onProgress(0.05, TR("progress.loading_audio"));
-
-      juce::AudioFormatManager formatManager;
-      formatManager.registerBasicFormats();
-
-      std::unique_ptr<juce::AudioFormatReader> reader(
-          formatManager.createReaderFor(task.file));
-      if (reader == nullptr || (task.cancelFlag && task.cancelFlag->load()) ||
-          isShuttingDown.load()) {
-        finishTask();
-        continue;
-      }
-
-      const int numSamples = static_cast<int>(reader->lengthInSamples);
-      const int srcSampleRate = static_cast<int>(reader->sampleRate);
+AudioFileManager::AudioFileManager() = default;
 
-      if (task.onProgress)
-        task.onProgress(0.10, TR("progress.reading_audio"));
+AudioFileManager::~AudioFileManager() {
+  cancelLoading();
+  isShuttingDown = true;
+  loadJobs.wait();
+}
 
-      juce::AudioBuffer<float> buffer;
-      if (reader->numChannels == 1) {
-        buffer.setSize(1, numSamples);
-        reader->read(&buffer, 0, numSamples, 0, true, false);
-      } else {
-        juce::AudioBuffer<float> stereoBuffer(2, numSamples);
-        reader->read(&stereoBuffer, 0, numSamples, 0, true, true);
-        buffer = convertToMono(stereoBuffer);
-      }
+// One queued load per call; cancelLoading() may have emptied the queue since
+void AudioFileManager::runNextLoad() {
+  LoadTask task;
+  {
+    std::lock_guard<std::mutex> lock(queueMutex);
+    if (isShuttingDown.load() || loadQueue.empty())
+      return;
 
-      if ((task.cancelFlag && task.cancelFlag->load()) ||
-          isShuttingDown.load()) {
-        finishTask();
-        continue;
-      }
+    task = std::move(loadQueue.front());
+    loadQueue.pop_front();
+    currentCancelFlag = task.cancelFlag;
+    isLoadingAudio = true;
+  }
 
-      if (srcSampleRate != SAMPLE_RATE) {
-        if (task.onProgress)
-          task.onProgress(0.18, TR("progress.resampling"));
-        buffer = resampleIfNeeded(buffer, srcSampleRate, SAMPLE_RATE);
-      }
+  auto finishTask = [this]() {
+    std::lock_guard<std::mutex> lock(queueMutex);
+    currentCancelFlag.reset();
+    isLoadingAudio = false;
+  };
 
-      if ((task.cancelFlag && task.cancelFlag->load()) ||
-          isShuttingDown.load()) {
-        finishTask();
-        continue;
-      }
+  // Early cancel
+  if (task.cancelFlag && task.cancelFlag->load()) {
+    finishTask();
+    return;
+  }
 
-      if (task.onProgress)
-        task.onProgress(0.22, TR("progress.audio_loaded"));
+  if (task.onProgress)
+    task.onProgress(0.05, TR("progress.loading_audio"));
+
+  juce::AudioBuffer<float> buffer;
+  auto onDecoded = [&task](const juce::AudioBuffer<float> &mono,
+                           int numDecoded) {
+    if (task.onProgress)
+      task.onProgress(0.05 + 0.17 * numDecoded /
+                                 std::max(1, mono.getNumSamples()),
+                      TR("progress.reading_audio"));
+  };
+  if (!decodeMono(task.file, buffer, SAMPLE_RATE, onDecoded,
+                  task.cancelFlag.get()) ||
+      isShuttingDown.load()) {
+    finishTask();
+    return;
+  }
 
-      auto onComplete = std::move(task.onComplete);
-      auto cancelFlag = task.cancelFlag;
-      auto file = task.file;
-      finishTask();
+  if (task.onProgress)
+    task.onProgress(0.22, TR("progress.audio_loaded"));
 
-      if ((cancelFlag && cancelFlag->load()) || isShuttingDown.load())
-        continue;
+  auto onComplete = std::move(task.onComplete);
+  auto cancelFlag = task.cancelFlag;
+  auto file = task.file;
+  finishTask();
 
-      juce::MessageManager::callAsync(
-          [onComplete, buffer = std::move(buffer), file]() mutable {
-            if (onComplete)
-              onComplete(std::move(buffer), SAMPLE_RATE, file);
-          });
-    }
-  });
-}
+  if ((cancelFlag && cancelFlag->load()) || isShuttingDown.load())
+    return;
 
-AudioFileManager::~AudioFileManager() {
-  cancelLoading();
-  isShuttingDown = true;
-  queueCv.notify_all();
-  if (workerThread.joinable())
-    workerThread.join();
+  juce::MessageManager::callAsync(
+      [onComplete, buffer = std::move(buffer), file]() mutable {
+        if (onComplete)
+          onComplete(std::move(buffer), SAMPLE_RATE, file);
+      });
 }
 
 void AudioFileManager::cancelLoading() {
@@ -207,8 +186,8 @@ void AudioFileManager::showExportDialog(
   if (fileChooser != nullptr)
     return;
 
-  fileChooser = std::make_unique<juce::FileChooser>(TR("dialog.export_audio"),
-                                                    defaultPath, "*.wav");
+  fileChooser = std::make_unique<juce::FileChooser>(
+      TR("dialog.export_audio"), defaultPath, "*.wav;*.flac;*.aiff");
 
   auto chooserFlags = juce::FileBrowserComponent::saveMode |
                       juce::FileBrowserComponent::canSelectFiles |
@@ -237,46 +216,7 @@ void AudioFileManager::loadAudioFileAsync(const juce::File &file,
     loadQueue.push_back(LoadTask{file, std::move(onProgress),
                                  std::move(onComplete), cancelFlag});
   }
-  queueCv.notify_one();
-}
-
-void AudioFileManager::exportAudioFileAsync(
-    const juce::File &file, const juce::AudioBuffer<float> &buffer,
-    int sampleRate, ProgressCallback onProgress,
-    ExportCompleteCallback onComplete) {
-  if (onProgress)
-    onProgress(0.0, TR("progress.exporting"));
-
-  // Export synchronously for now (could be made async if needed)
-  juce::WavAudioFormat wavFormat;
-  auto writerOptions = juce::AudioFormatWriterOptions{}
-                           .withSampleRate(sampleRate)
-                           .withNumChannels(buffer.getNumChannels())
-                           .withBitsPerSample(16);
-  auto fileStream = std::make_unique<juce::FileOutputStream>(file);
-  if (!fileStream->openedOk()) {
-    if (onProgress)
-      onProgress(1.0, TR("progress.export_failed"));
-    if (onComplete)
-      onComplete(false);
-    return;
-  }
-  std::unique_ptr<juce::OutputStream> outputStream = std::move(fileStream);
-  std::unique_ptr<juce::AudioFormatWriter> writer(
-      wavFormat.createWriterFor(outputStream, writerOptions));
-
-  bool success = false;
-  if (writer) {
-    success =
-        writer->writeFromAudioSampleBuffer(buffer, 0, buffer.getNumSamples());
-  }
-
-  if (onProgress)
-    onProgress(1.0, success ? TR("progress.export_complete")
-                            : TR("progress.export_failed"));
-
-  if (onComplete)
-    onComplete(success);
+  loadJobs.submit([this]() { runNextLoad(); });
 }
 
 bool AudioFileManager::isInterestedInFileDrag(const juce::StringArray &files) {
@@ -301,46 +241,88 @@ juce::File AudioFileManager::getFirstAudioFile(const juce::StringArray &files) {
   return {};
 }
 
-juce::AudioBuffer<float>
-AudioFileManager::resampleIfNeeded(const juce::AudioBuffer<float> &buffer,
-                                   int srcSampleRate, int targetSampleRate) {
-  if (srcSampleRate == targetSampleRate)
-    return buffer;
-
-  const double ratio = static_cast<double>(srcSampleRate) / targetSampleRate;
-  const int numSamples = buffer.getNumSamples();
-  const int newNumSamples = static_cast<int>(numSamples / ratio);
-
-  juce::AudioBuffer<float> resampledBuffer(1, newNumSamples);
-  const float *src = buffer.getReadPointer(0);
-  float *dst = resampledBuffer.getWritePointer(0);
-
-  for (int i = 0; i < newNumSamples; ++i) {
-    const double srcPos = i * ratio;
-    const int srcIndex = static_cast<int>(srcPos);
-    const double frac = srcPos - srcIndex;
-
-    if (srcIndex + 1 < numSamples)
-      dst[i] = static_cast<float>(src[srcIndex] * (1.0 - frac) +
-                                  src[srcIndex + 1] * frac);
-    else
-      dst[i] = src[srcIndex];
-  }
-
-  return resampledBuffer;
-}
-
-juce::AudioBuffer<float>
-AudioFileManager::convertToMono(const juce::AudioBuffer<float> &stereoBuffer) {
-  const int numSamples = stereoBuffer.getNumSamples();
-  juce::AudioBuffer<float> monoBuffer(1, numSamples);
+bool AudioFileManager::decodeMono(const juce::File &file,
+                                  juce::AudioBuffer<float> &mono,
+                                  int targetSampleRate,
+                                  const DecodeCallback &onDecoded,
+                                  const std::atomic<bool> *cancelFlag,
+                                  int *sourceSampleRate) {
+  auto isCancelled = [cancelFlag]() {
+    return cancelFlag != nullptr && cancelFlag->load();
+  };
+
+  juce::AudioFormatManager formatManager;
+  formatManager.registerBasicFormats();
+  auto reader = createReader(formatManager, file);
+  if (reader == nullptr || isCancelled() || reader->lengthInSamples <= 0 ||
+      reader->lengthInSamples > INT_MAX || reader->sampleRate <= 0.0)
+    return false;
+
+  const int numSamples = static_cast<int>(reader->lengthInSamples);
+  const int srcSampleRate = static_cast<int>(std::lround(reader->sampleRate));
+  if (sourceSampleRate != nullptr)
+    *sourceSampleRate = srcSampleRate;
+  const bool resample = srcSampleRate != targetSampleRate;
+  const int outSamples =
+      resample ? static_cast<int>(static_cast<juce::int64>(numSamples) *
+                                  targetSampleRate / srcSampleRate)
+               : numSamples;
+  const bool stereo = reader->numChannels > 1;
+
+  mono.setSize(1, outSamples);
+  float *dst = mono.getWritePointer(0);
+
+  juce::AudioBuffer<float> chunk(stereo ? 2 : 1, decodeChunkSamples);
+  float *src = chunk.getWritePointer(0);
+  // The one conversion to the model rate; windowed sinc, so 48 and 96 kHz
+  // material does not alias into what the models hear
+  AudioResampler::Stream resampler(srcSampleRate, targetSampleRate);
+  std::vector<float> resampled;
+
+  int written = 0;
+  auto append = [&]() {
+    const int count = std::min(static_cast<int>(resampled.size()),
+                               outSamples - written);
+    std::copy(resampled.begin(), resampled.begin() + count, dst + written);
+    written += count;
+    resampled.clear();
+  };
+
+  for (int chunkStart = 0; chunkStart < numSamples;
+       chunkStart += decodeChunkSamples) {
+    if (isCancelled())
+      return false;
+
+    const int chunkLength = std::min(decodeChunkSamples, numSamples - chunkStart);
+    const int chunkEnd = chunkStart + chunkLength;
+
+    if (!resample && !stereo) {
+      reader->read(&mono, chunkStart, chunkLength, chunkStart, true, false);
+      written = chunkEnd;
+    } else {
+      reader->read(&chunk, 0, chunkLength, chunkStart, true, stereo);
+      if (stereo) {
+        // Downmix in place into channel 0
+        juce::FloatVectorOperations::add(src, chunk.getReadPointer(1),
+                                         chunkLength);
+        juce::FloatVectorOperations::multiply(src, 0.5f, chunkLength);
+      }
 
-  const float *left = stereoBuffer.getReadPointer(0);
-  const float *right = stereoBuffer.getReadPointer(1);
-  float *mono = monoBuffer.getWritePointer(0);
+      if (!resample) {
+        std::copy(src, src + chunkLength, dst + chunkStart);
+        written = chunkEnd;
+      } else {
+        // Outputs whose kernel reaches past this chunk wait for the next
+        resampler.push(src, chunkLength, resampled);
+        if (chunkEnd == numSamples)
+          resampler.finish(resampled);
+        append();
+      }
+    }
 
-  for (int i = 0; i < numSamples; ++i)
-    mono[i] = (left[i] + right[i]) * 0.5f;
+    if (onDecoded)
+      onDecoded(mono, written);
+  }
 
-  return monoBuffer;
+  return !isCancelled();
 }
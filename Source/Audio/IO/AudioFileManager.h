@@ -2,17 +2,17 @@
 
 #include "../../JuceHeader.h"
 #include "../../Utils/Constants.h"
+#include "../../Utils/JobSystem.h"
 #include <atomic>
-#include <condition_variable>
 #include <deque>
 #include <functional>
 #include <memory>
 #include <mutex>
-#include <thread>
 
 /**
- * Manages audio file loading, saving, and export operations.
- * Handles async file operations with progress callbacks.
+ * Manages audio file loading and the open, save and export dialogs.
+ * Handles async file operations with progress callbacks; exports are
+ * written by StreamingExporter.
  */
 class AudioFileManager {
 public:
@@ -21,7 +21,12 @@ public:
   using LoadCompleteCallback =
       std::function<void(juce::AudioBuffer<float> &&buffer, int sampleRate,
                          const juce::File &file)>;
-  using ExportCompleteCallback = std::function<void(bool success)>;
+  // The buffer being decoded into; samples below numDecoded are final
+  using DecodeCallback = std::function<void(
+      const juce::AudioBuffer<float> &mono, int numDecoded)>;
+
+  // Source samples decoded per step of decodeMono()
+  static constexpr int decodeChunkSamples = 1 << 16;
 
   AudioFileManager();
   ~AudioFileManager();
@@ -37,15 +42,24 @@ public:
   void loadAudioFileAsync(const juce::File &file, ProgressCallback onProgress,
                           LoadCompleteCallback onComplete);
 
-  void exportAudioFileAsync(const juce::File &file,
-                            const juce::AudioBuffer<float> &buffer,
-                            int sampleRate, ProgressCallback onProgress,
-                            ExportCompleteCallback onComplete);
-
   // State
   bool isLoading() const { return isLoadingAudio.load(); }
   void cancelLoading();
 
+  /**
+   * Decode file to mono at targetSampleRate on the calling thread, one chunk
+   * at a time into a buffer allocated once at its final size. WAV and AIFF
+   * are read from a memory map of the file; other rates are converted once,
+   * with AudioResampler. onDecoded is called after each chunk.
+   * sourceSampleRate, if given, receives the file's own rate. Returns false
+   * if the file cannot be read or cancelFlag is raised meanwhile.
+   */
+  static bool decodeMono(const juce::File &file,
+                         juce::AudioBuffer<float> &mono, int targetSampleRate,
+                         const DecodeCallback &onDecoded = nullptr,
+                         const std::atomic<bool> *cancelFlag = nullptr,
+                         int *sourceSampleRate = nullptr);
+
   // Drag and drop support
   static bool isInterestedInFileDrag(const juce::StringArray &files);
   static juce::File getFirstAudioFile(const juce::StringArray &files);
@@ -58,27 +72,21 @@ private:
     std::shared_ptr<std::atomic<bool>> cancelFlag;
   };
 
-  // Resample audio to target sample rate
-  static juce::AudioBuffer<float>
-  resampleIfNeeded(const juce::AudioBuffer<float> &buffer, int srcSampleRate,
-                   int targetSampleRate);
-
-  // Convert stereo to mono
-  static juce::AudioBuffer<float>
-  convertToMono(const juce::AudioBuffer<float> &stereoBuffer);
+  void runNextLoad();
 
   std::unique_ptr<juce::FileChooser> fileChooser;
-  std::thread workerThread;
   std::atomic<bool> isLoadingAudio{false};
   std::atomic<bool> isShuttingDown{false};
 
   std::mutex queueMutex;
-  std::condition_variable queueCv;
   std::deque<LoadTask> loadQueue;
 
   // Current task cancel flag (if any)
   std::shared_ptr<std::atomic<bool>> currentCancelFlag;
 
+  // Loads run one at a time, in order; last so it is waited on first
+  JobSystem::Serial loadJobs;
+
   JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AudioFileManager)
   JUCE_DECLARE_WEAK_REFERENCEABLE(AudioFileManager)
 };
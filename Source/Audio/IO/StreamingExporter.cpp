@@ -0,0 +1,124 @@
+#include "StreamingExporter.h"
+#include "../../Utils/Localization.h"
+#include <algorithm>
+
+StreamingExporter::Output::Output(const Target &exportTarget)
+    : target(exportTarget), temporary(exportTarget.file),
+      resampler(SAMPLE_RATE, exportTarget.sampleRate),
+      thread("HachiTune Export") {}
+
+StreamingExporter::StreamingExporter() {
+  formatManager.registerBasicFormats();
+}
+
+StreamingExporter::~StreamingExporter() { abort(); }
+
+bool StreamingExporter::isSupportedFile(const juce::File &file) {
+  return file.hasFileExtension("wav;aiff;aif;flac");
+}
+
+bool StreamingExporter::open(const std::vector<Target> &targets,
+                             juce::String &error) {
+  abort();
+  numSamplesWritten = 0;
+
+  for (const auto &target : targets) {
+    const auto path = target.file.getFullPathName();
+    auto fail = [&](const juce::String &reason) {
+      error = reason + "\n" + path;
+      abort();
+      return false;
+    };
+
+    auto *format =
+        formatManager.findFormatForFileExtension(target.file.getFileExtension());
+    if (format == nullptr ||
+        !format->getPossibleSampleRates().contains(target.sampleRate) ||
+        !format->getPossibleBitDepths().contains(target.bitsPerSample))
+      return fail(TR("dialog.failed_create_writer"));
+
+    auto output = std::make_unique<Output>(target);
+    auto fileStream =
+        std::make_unique<juce::FileOutputStream>(output->temporary.getFile());
+    if (!fileStream->openedOk())
+      return fail(TR("dialog.failed_open"));
+    std::unique_ptr<juce::OutputStream> outputStream = std::move(fileStream);
+
+    auto writerOptions = juce::AudioFormatWriterOptions{}
+                             .withSampleRate(target.sampleRate)
+                             .withNumChannels(1)
+                             .withBitsPerSample(target.bitsPerSample);
+    std::unique_ptr<juce::AudioFormatWriter> writer(
+        format->createWriterFor(outputStream, writerOptions));
+    if (writer == nullptr)
+      return fail(TR("dialog.failed_create_writer"));
+
+    output->thread.startThread();
+    output->writer = std::make_unique<juce::AudioFormatWriter::ThreadedWriter>(
+        writer.release(), output->thread, fifoSamples);
+    outputs.push_back(std::move(output));
+  }
+  return true;
+}
+
+bool StreamingExporter::write(const float *samples, int numSamples,
+                              const std::atomic<bool> *cancelFlag) {
+  for (auto &output : outputs) {
+    output->resampled.clear();
+    output->resampler.push(samples, numSamples, output->resampled);
+    if (!enqueue(*output, output->resampled.data(),
+                 static_cast<int>(output->resampled.size()), cancelFlag))
+      return false;
+  }
+  numSamplesWritten += numSamples;
+  return true;
+}
+
+bool StreamingExporter::finish(juce::String &error) {
+  bool ok = true;
+  for (auto &output : outputs) {
+    output->resampled.clear();
+    output->resampler.finish(output->resampled);
+    enqueue(*output, output->resampled.data(),
+            static_cast<int>(output->resampled.size()), nullptr);
+  }
+
+  for (auto &output : outputs) {
+    // Writes out whatever the FIFO still holds, then closes the file
+    output->writer.reset();
+    output->thread.stopThread(1000);
+    if (ok && !output->temporary.overwriteTargetFileWithTemporary()) {
+      error = TR("dialog.failed_write") + "\n" +
+              output->target.file.getFullPathName();
+      ok = false;
+    }
+  }
+  outputs.clear();
+  return ok;
+}
+
+void StreamingExporter::abort() {
+  for (auto &output : outputs) {
+    output->writer.reset();
+    output->thread.stopThread(1000);
+  }
+  // Each temporary file goes with its output
+  outputs.clear();
+}
+
+bool StreamingExporter::enqueue(Output &output, const float *samples,
+                                int numSamples,
+                                const std::atomic<bool> *cancelFlag) {
+  // A quarter of the FIFO at a time, so no write needs all of it free
+  while (numSamples > 0) {
+    const int piece = std::min(numSamples, fifoSamples / 4);
+    while (!output.writer->write(&samples, piece)) {
+      if (cancelFlag != nullptr && cancelFlag->load())
+        return false;
+      juce::Thread::sleep(2);
+    }
+    samples += piece;
+    numSamples -= piece;
+  }
+  return true;
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "../../JuceHeader.h"
+#include "../../Utils/AudioResampler.h"
+#include "../../Utils/Constants.h"
+#include <atomic>
+#include <memory>
+#include <vector>
+
+/**
+ * Encodes one mono stream at SAMPLE_RATE into several files as it arrives.
+ *
+ * Each target takes its format from the file extension (WAV, AIFF or FLAC)
+ * and has its own sample rate and bit depth. Every target encodes on its own
+ * thread behind a FIFO of fifoSamples, so the targets run in parallel with
+ * each other and with the producer, and memory stays flat however long the
+ * stream is. write() only waits when a FIFO is full.
+ *
+ * Files are written next to their targets and moved into place by finish(),
+ * so a failed or cancelled export leaves any existing file untouched.
+ */
+class StreamingExporter {
+public:
+  struct Target {
+    juce::File file;
+    int sampleRate = SAMPLE_RATE;
+    int bitsPerSample = 16;
+  };
+
+  // Output samples each target buffers ahead of its encoder
+  static constexpr int fifoSamples = 1 << 17;
+
+  StreamingExporter();
+  ~StreamingExporter();
+
+  static bool isSupportedFile(const juce::File &file);
+
+  /**
+   * Create a writer for every target. On failure nothing is kept and error
+   * names the file that could not be created.
+   */
+  bool open(const std::vector<Target> &targets, juce::String &error);
+
+  /**
+   * Append samples to every target. Returns false when cancelFlag is
+   * raised while waiting for room.
+   */
+  bool write(const float *samples, int numSamples,
+             const std::atomic<bool> *cancelFlag = nullptr);
+
+  /** Drain every encoder and move the files into place. */
+  bool finish(juce::String &error);
+
+  /** Drop everything written so far. Also what destruction does. */
+  void abort();
+
+  juce::int64 getNumSamplesWritten() const { return numSamplesWritten; }
+
+private:
+  struct Output {
+    explicit Output(const Target &target);
+
+    Target target;
+    juce::TemporaryFile temporary;
+    AudioResampler::Stream resampler;
+    std::vector<float> resampled;
+    juce::TimeSliceThread thread;
+    std::unique_ptr<juce::AudioFormatWriter::ThreadedWriter> writer;
+  };
+
+  // Hand samples to one output's FIFO, waiting for room as needed
+  static bool enqueue(Output &output, const float *samples, int numSamples,
+                      const std::atomic<bool> *cancelFlag);
+
+  juce::AudioFormatManager formatManager;
+  std::vector<std::unique_ptr<Output>> outputs;
+  juce::int64 numSamplesWritten = 0;
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(StreamingExporter)
+};
@@ -0,0 +1,140 @@
+#include "InferenceBatcher.h"
+#include "Vocoder.h"
+#include <algorithm>
+#include <chrono>
+
+namespace {
+// The vocoder's floor for log mel; padding comes out as silence
+constexpr float silentMel = -15.0f;
+} // namespace
+
+InferenceBatcher::InferenceBatcher(Vocoder &owner, Options batchOptions)
+    : vocoder(owner), options(batchOptions) {}
+
+int InferenceBatcher::getMaxFrames() const {
+  return options.maxFrames > 0 ? options.maxFrames : vocoder.getChunkFrames();
+}
+
+std::vector<float> InferenceBatcher::vocode(const MelView &mel,
+                                            const std::vector<float> &f0) {
+  if (!vocoder.isLoaded() || mel.empty() || f0.empty())
+    return {};
+
+  const size_t frames = std::min(mel.size(), f0.size());
+  const size_t gap = static_cast<size_t>(std::max(0, options.gapFrames));
+  const size_t maxFrames = static_cast<size_t>(std::max(1, getMaxFrames()));
+  if (options.windowMs <= 0 || frames + gap >= maxFrames)
+    return vocoder.infer(mel, f0);
+
+  Request request;
+  request.mel = mel;
+  request.f0 = &f0;
+  request.frames = frames;
+
+  std::unique_lock<std::mutex> lock(mutex);
+  pending.push_back(&request);
+  pendingFrames += frames + gap;
+  // A gatherer stops waiting once its run is full
+  condition.notify_all();
+
+  for (;;) {
+    if (request.done)
+      return std::move(request.audio);
+    const bool taken =
+        std::find(pending.begin(), pending.end(), &request) == pending.end();
+    if (gathering || taken) {
+      condition.wait(lock);
+      continue;
+    }
+
+    // Gather for this caller's run, which may also be someone else's
+    gathering = true;
+    condition.wait_for(lock, std::chrono::milliseconds(options.windowMs),
+                       [&]() { return pendingFrames >= maxFrames; });
+    const auto batch = takeBatch();
+    gathering = false;
+    condition.notify_all();
+
+    lock.unlock();
+    runBatch(batch);
+    lock.lock();
+    for (auto *done : batch)
+      done->done = true;
+    condition.notify_all();
+  }
+}
+
+std::vector<InferenceBatcher::Request *> InferenceBatcher::takeBatch() {
+  const size_t gap = static_cast<size_t>(std::max(0, options.gapFrames));
+  const size_t maxFrames = static_cast<size_t>(std::max(1, getMaxFrames()));
+  std::vector<Request *> batch;
+  size_t total = 0;
+  while (!pending.empty()) {
+    auto *next = pending.front();
+    const size_t needed = total + (batch.empty() ? 0 : gap) + next->frames;
+    if (!batch.empty() && needed > maxFrames)
+      break;
+    batch.push_back(next);
+    total = needed;
+    pending.pop_front();
+    pendingFrames -= std::min(pendingFrames, next->frames + gap);
+  }
+  if (batch.size() > 1) {
+    ++numBatches;
+    numBatchedRequests += batch.size();
+  }
+  return batch;
+}
+
+void InferenceBatcher::runBatch(const std::vector<Request *> &batch) {
+  if (batch.empty())
+    return;
+  if (batch.size() == 1) {
+    auto *request = batch.front();
+    request->audio = vocoder.infer(request->mel, *request->f0);
+    return;
+  }
+
+  const int numMels = batch.front()->mel.getNumMels();
+  const size_t gap = static_cast<size_t>(std::max(0, options.gapFrames));
+  const MelBuffer silence(gap, numMels, silentMel);
+
+  MelBuffer mel(0, numMels);
+  std::vector<float> f0;
+  std::vector<size_t> offsets;
+  offsets.reserve(batch.size());
+  for (size_t i = 0; i < batch.size(); ++i) {
+    const auto *request = batch[i];
+    if (i > 0) {
+      mel.append(silence);
+      f0.insert(f0.end(), gap, 0.0f);
+    }
+    offsets.push_back(mel.size());
+    mel.append(request->mel.slice(0, request->frames));
+    f0.insert(f0.end(), request->f0->begin(),
+              request->f0->begin() +
+                  static_cast<std::ptrdiff_t>(request->frames));
+  }
+
+  auto audio = vocoder.infer(mel, f0);
+  if (audio.empty())
+    return;
+  const size_t hop = static_cast<size_t>(vocoder.getHopSize());
+  audio.resize(mel.size() * hop, 0.0f);
+  for (size_t i = 0; i < batch.size(); ++i) {
+    const auto begin =
+        audio.begin() + static_cast<std::ptrdiff_t>(offsets[i] * hop);
+    batch[i]->audio.assign(
+        begin, begin + static_cast<std::ptrdiff_t>(batch[i]->frames * hop));
+  }
+}
+
+size_t InferenceBatcher::getNumBatches() const {
+  std::lock_guard<std::mutex> lock(mutex);
+  return numBatches;
+}
+
+size_t InferenceBatcher::getNumBatchedRequests() const {
+  std::lock_guard<std::mutex> lock(mutex);
+  return numBatchedRequests;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "../Utils/MelBuffer.h"
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+class Vocoder;
+
+/**
+ * Gathers vocoder requests that arrive together from independent callers
+ * (the connections of a RemoteInferenceServer) and runs them as one model
+ * call.
+ *
+ * The first caller waits up to windowMs for others, then packs the pending
+ * requests it can fit under maxFrames end to end along time, with
+ * gapFrames of silence between them, as one run (which the vocoder pads to
+ * a shape bucket on a GPU). The output is split back to each caller.
+ * Requests of maxFrames or more run on their own. While one batch runs the
+ * next caller gathers the next, on another session.
+ *
+ * vocode() is safe from any number of threads.
+ */
+class InferenceBatcher {
+public:
+  struct Options {
+    int windowMs = 4;      // Longest a request waits for company; 0: none
+    int maxFrames = 0;     // Frames per packed run; 0: the vocoder's chunk
+    int gapFrames = 16;    // Silence between packed requests
+  };
+
+  InferenceBatcher(Vocoder &vocoder, Options options);
+
+  /** Vocoder::infer() of mel and f0, possibly run with other requests. */
+  std::vector<float> vocode(const MelView &mel, const std::vector<float> &f0);
+
+  /** Runs of more than one request so far, and the requests in them. */
+  size_t getNumBatches() const;
+  size_t getNumBatchedRequests() const;
+
+private:
+  struct Request {
+    MelView mel;
+    const std::vector<float> *f0 = nullptr;
+    size_t frames = 0;
+    std::vector<float> audio;
+    bool done = false;
+  };
+
+  int getMaxFrames() const;
+  // Pending requests for one run, oldest first; caller holds mutex
+  std::vector<Request *> takeBatch();
+  void runBatch(const std::vector<Request *> &batch);
+
+  Vocoder &vocoder;
+  const Options options;
+
+  mutable std::mutex mutex;
+  std::condition_variable condition;
+  std::deque<Request *> pending;
+  size_t pendingFrames = 0; // With a gap after each request
+  bool gathering = false;   // A caller is waiting out the window
+  size_t numBatches = 0;
+  size_t numBatchedRequests = 0;
+};
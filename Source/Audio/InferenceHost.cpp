@@ -0,0 +1,101 @@
+#include "InferenceHost.h"
+#include "RemoteInference.h"
+#include "../Utils/AppLogger.h"
+#include <mutex>
+
+namespace {
+constexpr double relaunchIntervalMs = 10000.0;
+
+struct HostState {
+  std::mutex mutex;
+  std::weak_ptr<RemoteInference> client;
+  InferenceHost::Config config;
+  std::unique_ptr<juce::ChildProcess> helper;
+  double lastLaunchMs = -relaunchIntervalMs;
+};
+
+HostState &getState() {
+  static HostState state;
+  return state;
+}
+} // namespace
+
+juce::File InferenceHost::getExecutable() {
+#if JUCE_MAC
+  return juce::File::getSpecialLocation(juce::File::currentApplicationFile)
+      .getChildFile("Contents/MacOS/HachiTuneBatch");
+#elif JUCE_WINDOWS
+  return juce::File::getSpecialLocation(juce::File::currentExecutableFile)
+      .getSiblingFile("HachiTuneBatch.exe");
+#else
+  return juce::File::getSpecialLocation(juce::File::currentExecutableFile)
+      .getSiblingFile("HachiTuneBatch");
+#endif
+}
+
+std::shared_ptr<RemoteInference> InferenceHost::connect(const Config &config) {
+  if (!getExecutable().existsAsFile()) {
+    LOG_WARNING("InferenceHost: " + getExecutable().getFullPathName() +
+                " not found, models run in this process");
+    return nullptr;
+  }
+
+  auto &state = getState();
+  std::lock_guard<std::mutex> lock(state.mutex);
+  state.config = config;
+  if (auto client = state.client.lock())
+    return client;
+
+  // Started now rather than on the first failed request, so its models
+  // load while the instance loads its own
+  juce::StreamingSocket probe;
+  if (!probe.connect("127.0.0.1", port, 200))
+    launch(state.config);
+
+  auto client = std::make_shared<RemoteInference>(
+      "127.0.0.1:" + juce::String(port), maxConcurrent, []() {
+        auto &relaunchState = getState();
+        std::lock_guard<std::mutex> relaunchLock(relaunchState.mutex);
+        launch(relaunchState.config);
+      });
+  state.client = client;
+  return client;
+}
+
+void InferenceHost::launch(const Config &config) {
+  auto &state = getState();
+  const double now = juce::Time::getMillisecondCounterHiRes();
+  if ((state.helper && state.helper->isRunning()) ||
+      now - state.lastLaunchMs < relaunchIntervalMs)
+    return;
+  state.lastLaunchMs = now;
+
+  juce::StringArray args{getExecutable().getFullPathName(),
+                         "--serve",
+                         juce::String(port),
+                         "--bind",
+                         "127.0.0.1",
+                         "--idle-exit",
+                         juce::String(idleExitSeconds),
+                         "--jobs",
+                         juce::String(maxConcurrent),
+                         "--device",
+                         config.device,
+                         "--device-id",
+                         juce::String(config.deviceId),
+                         "--precision",
+                         modelPrecisionToString(config.precision)};
+  if (config.modelsDir != juce::File{})
+    args.addArray({"--models", config.modelsDir.getFullPathName()});
+
+  // No pipes: the helper outlives this process's interest in its output
+  auto helper = std::make_unique<juce::ChildProcess>();
+  if (!helper->start(args, 0)) {
+    LOG_WARNING("InferenceHost: cannot start " +
+                getExecutable().getFullPathName());
+    return;
+  }
+  LOG("InferenceHost: started helper on port " + juce::String(port) + " (" +
+      config.device + ")");
+  state.helper = std::move(helper);
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "../JuceHeader.h"
+#include "ModelPrecision.h"
+#include <memory>
+
+class RemoteInference;
+
+/**
+ * Helper process that runs the models for every plugin instance on the
+ * machine: HachiTuneBatch --serve on a loopback port, started by the first
+ * instance that asks for it.
+ *
+ * Instances reach it through RemoteInference, so all of them share one set
+ * of loaded models and the helper's session pool as their scheduler, and a
+ * GPU driver fault ends the helper instead of the DAW. If the helper cannot
+ * answer, the instance's own models take over as for any remote backend,
+ * and the next failed connection starts the helper again. The helper exits
+ * once no instance has been connected for idleExitSeconds.
+ */
+class InferenceHost {
+public:
+  static constexpr int port = 7428;
+  static constexpr int idleExitSeconds = 120;
+  // Requests the helper runs at once; also the vocoder sessions it loads
+  static constexpr int maxConcurrent = 4;
+
+  // Models the helper loads; set by the instance that starts it
+  struct Config {
+    juce::String device = "CPU";
+    int deviceId = 0;
+    ModelPrecision precision = ModelPrecision::Balanced;
+    juce::File modelsDir;
+  };
+
+  /**
+   * The process-wide client for the helper, started now unless it already
+   * answers. Null when the helper executable is not installed.
+   */
+  static std::shared_ptr<RemoteInference> connect(const Config &config);
+
+  /** HachiTuneBatch beside the plugin binary; may not exist. */
+  static juce::File getExecutable();
+
+private:
+  // Start the helper unless ours is still running; throttled so instances
+  // asking at once start it once
+  static void launch(const Config &config);
+};
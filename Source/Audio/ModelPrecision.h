@@ -0,0 +1,62 @@
+#pragma once
+
+#include "../JuceHeader.h"
+
+/**
+ * Quality/speed preference used to pick between shipped model variants.
+ *
+ * Variants sit next to the full-precision model and share its base name:
+ *   rmvpe.onnx        - FP32 reference
+ *   rmvpe.fp16.onnx   - FP16 weights, for GPU execution providers
+ *   rmvpe.int8.onnx   - INT8 dynamic quantization, for CPU
+ * Variants must keep FP32 inputs and outputs so callers are unaffected.
+ */
+enum class ModelPrecision
+{
+    Quality = 0,  // Always the FP32 model
+    Balanced,     // FP16 on GPU, FP32 on CPU (default)
+    Speed         // FP16 on GPU, INT8 on CPU
+};
+
+inline const char* modelPrecisionToString(ModelPrecision precision)
+{
+    switch (precision)
+    {
+        case ModelPrecision::Quality:  return "Quality";
+        case ModelPrecision::Balanced: return "Balanced";
+        case ModelPrecision::Speed:    return "Speed";
+        default: return "Balanced";
+    }
+}
+
+inline ModelPrecision stringToModelPrecision(const juce::String& str)
+{
+    if (str == "Quality") return ModelPrecision::Quality;
+    if (str == "Speed")   return ModelPrecision::Speed;
+    return ModelPrecision::Balanced;  // Default
+}
+
+/**
+ * Pick the model file to load for a device and preference. Falls back to
+ * baseModel when the preferred variant is not installed.
+ */
+inline juce::File resolveModelVariant(const juce::File& baseModel,
+                                      const juce::String& device,
+                                      ModelPrecision precision)
+{
+    if (precision == ModelPrecision::Quality)
+        return baseModel;
+
+    const bool isGpu = device.isNotEmpty() && device != "CPU";
+    juce::String suffix;
+    if (isGpu)
+        suffix = ".fp16";
+    else if (precision == ModelPrecision::Speed)
+        suffix = ".int8";
+    else
+        return baseModel;
+
+    auto variant = baseModel.getSiblingFile(baseModel.getFileNameWithoutExtension()
+                                            + suffix + baseModel.getFileExtension());
+    return variant.existsAsFile() ? variant : baseModel;
+}
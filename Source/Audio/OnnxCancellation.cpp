@@ -0,0 +1,105 @@
+#include "OnnxCancellation.h"
+
+#ifdef HAVE_ONNXRUNTIME
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace OnnxCancellation {
+namespace {
+class Watcher {
+public:
+  static Watcher &get() {
+    static Watcher watcher;
+    return watcher;
+  }
+
+  ~Watcher() {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      stopping = true;
+    }
+    wake.notify_all();
+    if (thread.joinable())
+      thread.join();
+  }
+
+  void add(const ScopedRun *owner, Ort::RunOptions &options,
+           const std::atomic<bool> *flag) {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      // A flag raised before the run starts makes Run return right away
+      if (flag->load())
+        options.SetTerminate();
+      runs.push_back({owner, &options, flag});
+      if (!thread.joinable())
+        thread = std::thread([this]() { watch(); });
+    }
+    wake.notify_one();
+  }
+
+  // Once this returns the watcher no longer touches the owner's options
+  void remove(const ScopedRun *owner) {
+    std::lock_guard<std::mutex> lock(mutex);
+    runs.erase(std::remove_if(runs.begin(), runs.end(),
+                              [owner](const Run &run) {
+                                return run.owner == owner;
+                              }),
+               runs.end());
+  }
+
+private:
+  struct Run {
+    const ScopedRun *owner;
+    Ort::RunOptions *options;
+    const std::atomic<bool> *flag;
+    bool terminated = false;
+  };
+
+  void watch() {
+    juce::Thread::setCurrentThreadName("HachiTune ONNX cancel");
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!stopping) {
+      if (runs.empty()) {
+        wake.wait(lock, [this]() { return stopping || !runs.empty(); });
+        continue;
+      }
+      for (auto &run : runs) {
+        if (!run.terminated && run.flag->load()) {
+          // Only flips a flag that Run polls; safe from any thread
+          run.options->SetTerminate();
+          run.terminated = true;
+        }
+      }
+      wake.wait_for(lock, std::chrono::milliseconds(pollIntervalMs));
+    }
+  }
+
+  std::mutex mutex;
+  std::condition_variable wake;
+  std::vector<Run> runs;
+  bool stopping = false;
+  std::thread thread;
+};
+} // namespace
+
+ScopedRun::ScopedRun(Ort::RunOptions &runOptions,
+                     const std::atomic<bool> *cancelFlag) {
+  if (cancelFlag == nullptr)
+    return;
+  Watcher::get().add(this, runOptions, cancelFlag);
+  registered = true;
+}
+
+ScopedRun::~ScopedRun() {
+  if (registered)
+    Watcher::get().remove(this);
+}
+
+} // namespace OnnxCancellation
+
+#endif // HAVE_ONNXRUNTIME
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "../JuceHeader.h"
+#include <atomic>
+
+#ifdef HAVE_ONNXRUNTIME
+#include <onnxruntime_cxx_api.h>
+
+/**
+ * Turns a raised cancel flag into RunOptions::SetTerminate() on the run
+ * that is in flight.
+ *
+ * Cancel flags are plain atomics that nobody is told about when they flip,
+ * so the model wrappers would only see one between runs. While a ScopedRun
+ * is alive, a shared watcher thread polls its flag every pollIntervalMs and
+ * terminates the run once the flag is up. Session::Run then throws
+ * Ort::Exception, which the wrappers already treat as a failed inference.
+ * The watcher sleeps while no run is registered.
+ */
+namespace OnnxCancellation {
+
+constexpr int pollIntervalMs = 2;
+
+class ScopedRun {
+public:
+  /** Does nothing when cancelFlag is null. runOptions must outlive this. */
+  ScopedRun(Ort::RunOptions &runOptions, const std::atomic<bool> *cancelFlag);
+  ~ScopedRun();
+
+private:
+  bool registered = false;
+
+  JUCE_DECLARE_NON_COPYABLE(ScopedRun)
+};
+
+} // namespace OnnxCancellation
+
+#endif // HAVE_ONNXRUNTIME
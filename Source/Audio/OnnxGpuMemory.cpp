@@ -0,0 +1,167 @@
+#include "OnnxGpuMemory.h"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+std::mutex settingsMutex;
+OnnxGpuMemory::Settings currentSettings;
+
+std::int64_t nowMs() {
+  return static_cast<std::int64_t>(juce::Time::getMillisecondCounterHiRes());
+}
+} // namespace
+
+namespace OnnxGpuMemory {
+
+void setSettings(const Settings &settings) {
+  std::lock_guard<std::mutex> lock(settingsMutex);
+  currentSettings = settings;
+  currentSettings.limitMB = std::max(0, currentSettings.limitMB);
+  currentSettings.shrinkAfterIdleSeconds =
+      std::max(0, currentSettings.shrinkAfterIdleSeconds);
+}
+
+Settings getSettings() {
+  std::lock_guard<std::mutex> lock(settingsMutex);
+  return currentSettings;
+}
+
+juce::String arenaExtendToString(ArenaExtend extend) {
+  return extend == ArenaExtend::NextPowerOfTwo ? "power2" : "same";
+}
+
+ArenaExtend stringToArenaExtend(const juce::String &text) {
+  return text.equalsIgnoreCase("power2") ? ArenaExtend::NextPowerOfTwo
+                                         : ArenaExtend::SameAsRequested;
+}
+
+juce::String describe(const Settings &settings) {
+  return "limit " + juce::String(settings.limitMB) + " extend " +
+         arenaExtendToString(settings.arenaExtend) + " shrink " +
+         juce::String(settings.shrinkAfterIdleSeconds);
+}
+
+#ifdef HAVE_ONNXRUNTIME
+#ifdef USE_CUDA
+void apply(OrtCUDAProviderOptions &options) {
+  const auto settings = getSettings();
+  if (settings.limitMB > 0)
+    options.gpu_mem_limit = static_cast<size_t>(settings.limitMB) << 20;
+  // 0 = kNextPowerOfTwo, 1 = kSameAsRequested
+  options.arena_extend_strategy =
+      settings.arenaExtend == ArenaExtend::NextPowerOfTwo ? 0 : 1;
+}
+#endif
+
+#ifdef USE_TENSORRT
+void apply(OrtTensorRTProviderOptions &options) {
+  const auto settings = getSettings();
+  if (settings.limitMB > 0)
+    options.trt_max_workspace_size =
+        static_cast<size_t>(settings.limitMB) << 20;
+}
+#endif
+
+void requestShrink(Ort::RunOptions &runOptions, int deviceId) {
+  const auto devices = "gpu:" + std::to_string(deviceId);
+  runOptions.AddConfigEntry("memory.enable_memory_arena_shrinkage",
+                            devices.c_str());
+}
+#endif
+
+// Checks every owner about once a second. The thread only runs while an
+// owner is registered, so none is left for a plugin's unload to join.
+class Watcher {
+public:
+  static Watcher &getInstance() {
+    static Watcher watcher;
+    return watcher;
+  }
+
+  ~Watcher() { stopThread(false); }
+
+  void add(IdleShrink *owner) {
+    std::lock_guard<std::mutex> lock(mutex);
+    owners.push_back(owner);
+    if (!thread.joinable())
+      thread = std::thread([this, id = ++generation]() { run(id); });
+  }
+
+  void remove(IdleShrink *owner) {
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      condition.wait(lock, [&]() { return shrinking != owner; });
+      owners.erase(std::remove(owners.begin(), owners.end(), owner),
+                   owners.end());
+    }
+    stopThread(true);
+  }
+
+private:
+  void stopThread(bool onlyIfUnused) {
+    std::thread finished;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (onlyIfUnused && !owners.empty())
+        return;
+      ++generation; // A thread of an older generation returns
+      finished = std::move(thread);
+    }
+    condition.notify_all();
+    if (finished.joinable())
+      finished.join();
+  }
+
+  void run(int id) {
+    juce::Thread::setCurrentThreadName("HachiTune GPU memory");
+    std::unique_lock<std::mutex> lock(mutex);
+    while (id == generation) {
+      condition.wait_for(lock, std::chrono::seconds(1));
+      const int idleSeconds = getSettings().shrinkAfterIdleSeconds;
+      if (id != generation || idleSeconds <= 0)
+        continue;
+
+      const auto now = nowMs();
+      for (size_t i = 0; i < owners.size() && id == generation; ++i) {
+        auto *owner = owners[i];
+        if (!owner->armed.load() ||
+            now - owner->lastUseMs.load() < idleSeconds * 1000)
+          continue;
+        owner->armed.store(false);
+        // The owner cannot go away while marked; others may come and go
+        shrinking = owner;
+        lock.unlock();
+        owner->shrink();
+        lock.lock();
+        shrinking = nullptr;
+        condition.notify_all();
+      }
+    }
+  }
+
+  std::mutex mutex;
+  std::condition_variable condition;
+  std::vector<IdleShrink *> owners;
+  IdleShrink *shrinking = nullptr;
+  std::thread thread;
+  int generation = 0;
+};
+
+IdleShrink::IdleShrink(std::function<void()> shrinkFunction)
+    : shrink(std::move(shrinkFunction)) {
+  Watcher::getInstance().add(this);
+}
+
+IdleShrink::~IdleShrink() { Watcher::getInstance().remove(this); }
+
+void IdleShrink::touch() {
+  lastUseMs.store(nowMs());
+  armed.store(true);
+}
+
+} // namespace OnnxGpuMemory
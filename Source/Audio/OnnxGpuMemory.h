@@ -0,0 +1,86 @@
+#pragma once
+
+#include "../JuceHeader.h"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+
+#ifdef HAVE_ONNXRUNTIME
+#include <onnxruntime_cxx_api.h>
+#endif
+
+/**
+ * Process-wide GPU memory policy for every model session.
+ *
+ * ONNX Runtime's CUDA arena grows to the largest run it has seen and keeps
+ * that memory until the session goes, so one long render can hold most of
+ * the VRAM that the DAW's own GPU plugins and other HachiTune instances
+ * need. Here each CUDA (and TensorRT) session gets a cap, and its arena
+ * grows by what is asked for rather than to the next power of two. A model
+ * wrapper that has gone unused for shrinkAfterIdleSeconds hands the free
+ * part of its arenas back to the driver (IdleShrink).
+ *
+ * DirectML and CoreML allocate through their own runtimes, which take no
+ * limit; only idle shrinking is skipped there too.
+ *
+ * Settings take effect the next time a model is loaded. Sessions made under
+ * different settings are not shared (OnnxSessionRegistry keys on them).
+ */
+namespace OnnxGpuMemory {
+
+enum class ArenaExtend { SameAsRequested, NextPowerOfTwo };
+
+struct Settings {
+  int limitMB = 0; // Per session; 0 = no limit
+  ArenaExtend arenaExtend = ArenaExtend::SameAsRequested;
+  int shrinkAfterIdleSeconds = 30; // 0 = keep the arena
+};
+
+void setSettings(const Settings &settings);
+Settings getSettings();
+
+juce::String arenaExtendToString(ArenaExtend extend);
+ArenaExtend stringToArenaExtend(const juce::String &text);
+
+/** Compact text form, e.g. "limit 2048 extend same shrink 30". */
+juce::String describe(const Settings &settings);
+
+#ifdef HAVE_ONNXRUNTIME
+#ifdef USE_CUDA
+/** Put the cap and extend strategy on CUDA provider options. */
+void apply(OrtCUDAProviderOptions &options);
+#endif
+#ifdef USE_TENSORRT
+/** Cap the TensorRT builder workspace the same way. */
+void apply(OrtTensorRTProviderOptions &options);
+#endif
+
+/** Make a run free the unused part of the device arena as it ends. */
+void requestShrink(Ort::RunOptions &runOptions, int deviceId);
+#endif
+
+/**
+ * Calls shrink once its owner has gone unused for shrinkAfterIdleSeconds,
+ * from a watcher thread shared by every owner, once per idle spell. The
+ * owner calls touch() as each run starts; shrink typically makes one short
+ * run per session with requestShrink().
+ */
+class IdleShrink {
+public:
+  explicit IdleShrink(std::function<void()> shrink);
+  /** Waits for a shrink in progress. */
+  ~IdleShrink();
+
+  void touch();
+
+private:
+  friend class Watcher;
+
+  const std::function<void()> shrink;
+  std::atomic<std::int64_t> lastUseMs{0};
+  std::atomic<bool> armed{false}; // Used since the last shrink
+
+  JUCE_DECLARE_NON_COPYABLE(IdleShrink)
+};
+
+} // namespace OnnxGpuMemory
@@ -0,0 +1,68 @@
+#include "OnnxIoBinding.h"
+#include "OnnxCancellation.h"
+#include "../Utils/Tracing.h"
+
+#ifdef HAVE_ONNXRUNTIME
+
+#include <functional>
+#include <numeric>
+
+namespace {
+Ort::MemoryInfo makeOutputMemory(OnnxIoBinding::OutputMemory type,
+                                 int deviceId) {
+  if (type == OnnxIoBinding::OutputMemory::CudaPinned)
+    return Ort::MemoryInfo("CudaPinned", OrtDeviceAllocator, deviceId,
+                           OrtMemTypeCPUOutput);
+  return Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault);
+}
+} // namespace
+
+OnnxIoBinding::OnnxIoBinding(Ort::Session &sessionIn,
+                             const std::vector<const char *> &inputs,
+                             const std::vector<const char *> &outputs,
+                             OutputMemory outputMemoryType, int deviceId)
+    : session(sessionIn), binding(sessionIn),
+      inputMemory(
+          Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault)),
+      outputMemory(makeOutputMemory(outputMemoryType, deviceId)),
+      inputNames(inputs), outputNames(outputs), inputBuffers(inputs.size()) {
+  // Output bindings persist across runs; ORT allocates on outputMemory.
+  for (const auto *name : outputNames)
+    binding.BindOutput(name, outputMemory);
+}
+
+float *OnnxIoBinding::getInputBuffer(size_t index, size_t numElements) {
+  jassert(index < inputBuffers.size());
+  auto &buffer = inputBuffers[index];
+  if (buffer.size() < numElements)
+    buffer.resize(numElements);
+  return buffer.data();
+}
+
+void OnnxIoBinding::bindInput(size_t index, const std::vector<int64_t> &shape) {
+  jassert(index < inputNames.size());
+  const auto count = static_cast<size_t>(std::accumulate(
+      shape.begin(), shape.end(), int64_t{1}, std::multiplies<int64_t>()));
+  float *data = getInputBuffer(index, count);
+  auto value = Ort::Value::CreateTensor<float>(inputMemory, data, count,
+                                               shape.data(), shape.size());
+  binding.BindInput(inputNames[index], value);
+}
+
+std::vector<Ort::Value>
+OnnxIoBinding::run(const std::atomic<bool> *cancelFlag) {
+  if (cancelFlag == nullptr)
+    return run(Ort::RunOptions{nullptr});
+  Ort::RunOptions runOptions;
+  OnnxCancellation::ScopedRun cancellation(runOptions, cancelFlag);
+  return run(runOptions);
+}
+
+std::vector<Ort::Value> OnnxIoBinding::run(const Ort::RunOptions &runOptions) {
+  TRACE_ZONE("ONNX Run");
+  session.Run(runOptions, binding);
+  binding.SynchronizeOutputs();
+  return binding.GetOutputValues();
+}
+
+#endif // HAVE_ONNXRUNTIME
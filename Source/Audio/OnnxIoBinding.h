@@ -0,0 +1,71 @@
+#pragma once
+
+#include "../JuceHeader.h"
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#ifdef HAVE_ONNXRUNTIME
+#include <onnxruntime_cxx_api.h>
+
+/**
+ * Persistent Ort::IoBinding for one session.
+ *
+ * Each float input has a grow-only host buffer that callers fill in place,
+ * so repeated calls stop allocating input tensors. Outputs stay bound to a
+ * fixed memory location (pinned host memory for CUDA, CPU arena otherwise),
+ * so ORT can reuse its output allocations across runs.
+ *
+ * Not thread-safe; callers serialize access the same way they serialize
+ * Session::Run. Recreate the binding whenever the session is recreated.
+ */
+class OnnxIoBinding {
+public:
+  enum class OutputMemory { Cpu, CudaPinned };
+
+  OnnxIoBinding(Ort::Session &session, const std::vector<const char *> &inputs,
+                const std::vector<const char *> &outputs,
+                OutputMemory outputMemory = OutputMemory::Cpu,
+                int deviceId = 0);
+
+  /**
+   * Host buffer for input `index` with room for at least numElements floats.
+   * The pointer stays valid until a later call asks for more space.
+   */
+  float *getInputBuffer(size_t index, size_t numElements);
+
+  /**
+   * Bind input `index` over its host buffer with the given shape. Fill the
+   * buffer before calling run().
+   */
+  void bindInput(size_t index, const std::vector<int64_t> &shape);
+
+  /**
+   * Run the session with the current bindings. Raising cancelFlag aborts
+   * the run, which then throws Ort::Exception.
+   * @return Output values in output-name order
+   */
+  std::vector<Ort::Value> run(const std::atomic<bool> *cancelFlag = nullptr);
+
+  /**
+   * Same as run(), but with caller-owned run options so another thread can
+   * abort the run through RunOptions::SetTerminate().
+   */
+  std::vector<Ort::Value> run(const Ort::RunOptions &runOptions);
+
+  size_t getNumInputs() const { return inputNames.size(); }
+  size_t getNumOutputs() const { return outputNames.size(); }
+
+private:
+  Ort::Session &session;
+  Ort::IoBinding binding;
+  Ort::MemoryInfo inputMemory;
+  Ort::MemoryInfo outputMemory;
+  std::vector<const char *> inputNames;
+  std::vector<const char *> outputNames;
+  std::vector<std::vector<float>> inputBuffers;
+
+  JUCE_DECLARE_NON_COPYABLE(OnnxIoBinding)
+};
+
+#endif // HAVE_ONNXRUNTIME
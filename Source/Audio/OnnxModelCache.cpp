@@ -0,0 +1,128 @@
+#include "OnnxModelCache.h"
+#include "../Utils/AppLogger.h"
+#include "../Utils/PlatformPaths.h"
+
+#ifdef HAVE_ONNXRUNTIME
+
+#include <string>
+
+namespace {
+std::unique_ptr<Ort::Session>
+openSessionFromPath(Ort::Env &env, const juce::File &file,
+                    const Ort::SessionOptions &options,
+                    OrtPrepackedWeightsContainer *prepackedWeights) {
+#ifdef _WIN32
+  std::wstring path = file.getFullPathName().toWideCharPointer();
+#else
+  std::string path = file.getFullPathName().toStdString();
+#endif
+  if (prepackedWeights != nullptr)
+    return std::make_unique<Ort::Session>(env, path.c_str(), options,
+                                          prepackedWeights);
+  return std::make_unique<Ort::Session>(env, path.c_str(), options);
+}
+
+std::unique_ptr<Ort::Session>
+openSession(Ort::Env &env, const juce::File &file,
+            const Ort::SessionOptions &options,
+            OrtPrepackedWeightsContainer *prepackedWeights) {
+  // Parsed straight from the page cache rather than read into a heap copy
+  // first; the mapping is only needed while the session is built
+  juce::MemoryMappedFile mapped(file, juce::MemoryMappedFile::readOnly, false);
+  if (mapped.getData() == nullptr || mapped.getSize() == 0)
+    return openSessionFromPath(env, file, options, prepackedWeights);
+
+  try {
+    if (prepackedWeights != nullptr)
+      return std::make_unique<Ort::Session>(env, mapped.getData(),
+                                            mapped.getSize(), options,
+                                            prepackedWeights);
+    return std::make_unique<Ort::Session>(env, mapped.getData(),
+                                          mapped.getSize(), options);
+  } catch (const Ort::Exception &e) {
+    // E.g. weights in external files, which are found relative to the path
+    LOG("OnnxModelCache: cannot load " + file.getFileName() +
+        " from memory, opening the file: " + juce::String(e.what()));
+  }
+  return openSessionFromPath(env, file, options, prepackedWeights);
+}
+} // namespace
+
+namespace OnnxModelCache {
+
+bool isCacheable(const juce::String &device) {
+  return device == "CPU" || device.startsWith("CUDA");
+}
+
+juce::File getCachedModelFile(const juce::File &modelPath,
+                              const juce::String &deviceTag) {
+  const juce::String key =
+      modelPath.getFullPathName() + "|" + juce::String(modelPath.getSize()) +
+      "|" +
+      juce::String(modelPath.getLastModificationTime().toMilliseconds()) +
+      "|" + deviceTag + "|" + OrtGetApiBase()->GetVersionString();
+
+  return PlatformPaths::getCacheDirectory()
+      .getChildFile("onnx")
+      .getChildFile(modelPath.getFileNameWithoutExtension() + "-" +
+                    deviceTag + "-" +
+                    juce::String::toHexString(key.hashCode64()) + ".onnx");
+}
+
+std::unique_ptr<Ort::Session>
+createSession(Ort::Env &env, const juce::File &modelPath,
+              const Ort::SessionOptions &options, const juce::String &deviceTag,
+              bool useCache, OrtPrepackedWeightsContainer *prepackedWeights) {
+  if (!useCache)
+    return openSession(env, modelPath, options, prepackedWeights);
+
+  auto cachedFile = getCachedModelFile(modelPath, deviceTag);
+
+  if (cachedFile.existsAsFile()) {
+    try {
+      // Already optimized for this device; don't redo it
+      auto cachedOptions = options.Clone();
+      cachedOptions.SetGraphOptimizationLevel(
+          GraphOptimizationLevel::ORT_DISABLE_ALL);
+      auto session =
+          openSession(env, cachedFile, cachedOptions, prepackedWeights);
+      LOG("OnnxModelCache: using " + cachedFile.getFileName());
+      return session;
+    } catch (const Ort::Exception &e) {
+      LOG("OnnxModelCache: discarding unreadable " + cachedFile.getFileName() +
+          ": " + juce::String(e.what()));
+      cachedFile.deleteFile();
+    }
+  }
+
+  // Optimize from source and save the graph. Write to a temporary name so
+  // an interrupted save never leaves a truncated cache entry.
+  if (!cachedFile.getParentDirectory().createDirectory())
+    return openSession(env, modelPath, options, prepackedWeights);
+
+  auto tempFile = cachedFile.withFileExtension(".tmp");
+  try {
+    auto writeOptions = options.Clone();
+#ifdef _WIN32
+    std::wstring tempPath = tempFile.getFullPathName().toWideCharPointer();
+#else
+    std::string tempPath = tempFile.getFullPathName().toStdString();
+#endif
+    writeOptions.SetOptimizedModelFilePath(tempPath.c_str());
+    auto session =
+        openSession(env, modelPath, writeOptions, prepackedWeights);
+    if (tempFile.moveFileTo(cachedFile))
+      LOG("OnnxModelCache: saved " + cachedFile.getFileName());
+    return session;
+  } catch (const Ort::Exception &e) {
+    LOG("OnnxModelCache: cannot cache " + modelPath.getFileName() + ": " +
+        juce::String(e.what()));
+    tempFile.deleteFile();
+  }
+
+  return openSession(env, modelPath, options, prepackedWeights);
+}
+
+} // namespace OnnxModelCache
+
+#endif // HAVE_ONNXRUNTIME
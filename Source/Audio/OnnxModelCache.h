@@ -0,0 +1,47 @@
+#pragma once
+
+#include "../JuceHeader.h"
+#include <memory>
+
+#ifdef HAVE_ONNXRUNTIME
+#include <onnxruntime_cxx_api.h>
+
+/**
+ * Creates ONNX sessions through an on-disk cache of optimized graphs.
+ *
+ * The first load of a model on a given device runs the full graph
+ * optimization and saves the result in the user cache directory. Later
+ * loads open the saved graph with optimization disabled, which skips that
+ * work on every launch. Entries are keyed on the model path, size and
+ * modification time, the device tag and the ONNX Runtime version, so a
+ * changed model or runtime never picks up a stale graph.
+ *
+ * Only EPs that keep a serializable graph (CPU, CUDA) can be cached;
+ * compiling EPs (DirectML, CoreML, TensorRT) load the source model directly.
+ */
+namespace OnnxModelCache {
+
+/** True if sessions for this device can be served from the cache. */
+bool isCacheable(const juce::String &device);
+
+/** Cache file used for a model on a device ("CPU", "CUDA0", ...). */
+juce::File getCachedModelFile(const juce::File &modelPath,
+                              const juce::String &deviceTag);
+
+/**
+ * Create a session for modelPath, reading or writing the optimized-graph
+ * cache when useCache is set. A cache entry that fails to load is deleted
+ * and the source model is used instead. Model files are memory-mapped and
+ * parsed from the mapping. Sessions given the same prepackedWeights share
+ * their CPU kernels' prepacked weights; the container must outlive them.
+ * @throws Ort::Exception if the source model itself cannot be loaded
+ */
+std::unique_ptr<Ort::Session>
+createSession(Ort::Env &env, const juce::File &modelPath,
+              const Ort::SessionOptions &options, const juce::String &deviceTag,
+              bool useCache,
+              OrtPrepackedWeightsContainer *prepackedWeights = nullptr);
+
+} // namespace OnnxModelCache
+
+#endif // HAVE_ONNXRUNTIME
@@ -0,0 +1,124 @@
+#include "OnnxSessionRegistry.h"
+#include "OnnxGpuMemory.h"
+#include "OnnxModelCache.h"
+#include "../Utils/AppLogger.h"
+
+#ifdef HAVE_ONNXRUNTIME
+
+#include <map>
+#include <mutex>
+
+namespace {
+struct Entry {
+  std::mutex loadMutex; // Held while this key's session is created
+  std::weak_ptr<Ort::Session> session;
+};
+
+std::mutex registryMutex;
+std::map<juce::String, std::shared_ptr<Entry>> entries;
+// CPU sessions of one model file, whatever their threading plan or pool
+// slot, share one copy of the weights their kernels prepack
+std::map<juce::String, std::weak_ptr<Ort::PrepackedWeightsContainer>>
+    prepackedWeights;
+
+juce::String makeModelKey(const juce::File &modelPath) {
+  // A replaced model file must not be served from an old session
+  return modelPath.getFullPathName() + "|" +
+         juce::String(modelPath.getSize()) + "|" +
+         juce::String(modelPath.getLastModificationTime().toMilliseconds());
+}
+
+juce::String makeKey(const juce::File &modelPath, const juce::String &deviceTag,
+                     const juce::String &optionsKey) {
+  auto key = makeModelKey(modelPath) + "|" + deviceTag + "|" + optionsKey;
+  // A device session carries the memory policy it was made under
+  if (deviceTag != "CPU")
+    key += "|" + OnnxGpuMemory::describe(OnnxGpuMemory::getSettings());
+  return key;
+}
+
+// Called with registryMutex held
+std::shared_ptr<Ort::PrepackedWeightsContainer>
+getPrepackedWeights(const juce::File &modelPath) {
+  for (auto it = prepackedWeights.begin(); it != prepackedWeights.end();) {
+    if (it->second.expired())
+      it = prepackedWeights.erase(it);
+    else
+      ++it;
+  }
+
+  auto &slot = prepackedWeights[makeModelKey(modelPath)];
+  auto container = slot.lock();
+  if (!container) {
+    container = std::make_shared<Ort::PrepackedWeightsContainer>();
+    slot = container;
+  }
+  return container;
+}
+} // namespace
+
+namespace OnnxSessionRegistry {
+
+Ort::Env &getEnv() {
+  static Ort::Env env(ORT_LOGGING_LEVEL_WARNING, "HachiTune");
+  return env;
+}
+
+std::shared_ptr<Ort::Session> acquire(const juce::File &modelPath,
+                                      const Ort::SessionOptions &options,
+                                      const juce::String &deviceTag,
+                                      const juce::String &optionsKey) {
+  const auto key = makeKey(modelPath, deviceTag, optionsKey);
+
+  std::shared_ptr<Entry> entry;
+  std::shared_ptr<Ort::PrepackedWeightsContainer> weights;
+  {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    if (deviceTag == "CPU")
+      weights = getPrepackedWeights(modelPath);
+    // Drop keys whose sessions are gone and that nobody is loading
+    for (auto it = entries.begin(); it != entries.end();) {
+      if (it->second->session.expired() && it->second.use_count() == 1)
+        it = entries.erase(it);
+      else
+        ++it;
+    }
+
+    auto &slot = entries[key];
+    if (!slot)
+      slot = std::make_shared<Entry>();
+    entry = slot;
+  }
+
+  std::lock_guard<std::mutex> loadLock(entry->loadMutex);
+  if (auto shared = entry->session.lock()) {
+    LOG("OnnxSessionRegistry: sharing " + modelPath.getFileName() + " (" +
+        deviceTag + ")");
+    return shared;
+  }
+
+  auto created = OnnxModelCache::createSession(
+      getEnv(), modelPath, options, deviceTag,
+      OnnxModelCache::isCacheable(deviceTag), weights.get());
+  // The shared weights stay until the last session using them is gone
+  std::shared_ptr<Ort::Session> session(
+      created.release(), [weights](Ort::Session *released) { delete released; });
+  entry->session = session;
+  LOG("OnnxSessionRegistry: loaded " + modelPath.getFileName() + " (" +
+      deviceTag + "), " + juce::String(getNumLiveSessions()) +
+      " live session(s)");
+  return session;
+}
+
+int getNumLiveSessions() {
+  std::lock_guard<std::mutex> lock(registryMutex);
+  int live = 0;
+  for (const auto &[key, entry] : entries)
+    if (!entry->session.expired())
+      ++live;
+  return live;
+}
+
+} // namespace OnnxSessionRegistry
+
+#endif // HAVE_ONNXRUNTIME
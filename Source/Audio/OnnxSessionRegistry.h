@@ -0,0 +1,51 @@
+#pragma once
+
+#include "../JuceHeader.h"
+#include <memory>
+
+#ifdef HAVE_ONNXRUNTIME
+#include <onnxruntime_cxx_api.h>
+
+/**
+ * Process-wide ONNX Runtime environment and shared model sessions.
+ *
+ * Every model wrapper in the process (in a DAW, every plugin instance) runs
+ * on one Ort::Env. Sessions are reference counted: callers asking for the
+ * same model file, device and options key get the same Ort::Session, so a
+ * model is loaded and held in memory once however many editors use it. The
+ * session is released when its last user lets go. CPU sessions of the
+ * same model file that differ in options still share the weights ONNX
+ * Runtime prepacks for its kernels.
+ *
+ * Device sessions are keyed on the OnnxGpuMemory settings as well, so a
+ * changed cap applies to the next load instead of reusing a session made
+ * under the old one.
+ *
+ * Ort::Session::Run is thread-safe. State tied to one caller, such as I/O
+ * bindings and run options, stays with the caller.
+ */
+namespace OnnxSessionRegistry {
+
+/** The shared environment, created on first use. */
+Ort::Env &getEnv();
+
+/**
+ * Shared session for modelPath. optionsKey must describe everything in
+ * options that changes the session (threading plan, device id, pool slot);
+ * callers with equal model, deviceTag and optionsKey share one session.
+ * New sessions go through OnnxModelCache, so the optimized graph on disk is
+ * reused as well. Loads of the same key wait for each other instead of
+ * loading twice.
+ * @throws Ort::Exception if the model cannot be loaded
+ */
+std::shared_ptr<Ort::Session> acquire(const juce::File &modelPath,
+                                      const Ort::SessionOptions &options,
+                                      const juce::String &deviceTag,
+                                      const juce::String &optionsKey);
+
+/** Number of sessions currently alive, for logging. */
+int getNumLiveSessions();
+
+} // namespace OnnxSessionRegistry
+
+#endif // HAVE_ONNXRUNTIME
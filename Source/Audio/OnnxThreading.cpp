@@ -0,0 +1,182 @@
+#include "OnnxThreading.h"
+#include <algorithm>
+#include <array>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace {
+constexpr size_t numModels = 4;
+
+std::mutex settingsMutex;
+std::array<OnnxThreading::Settings, numModels> modelSettings;
+
+size_t indexOf(OnnxThreading::Model model) {
+  return static_cast<size_t>(model);
+}
+
+bool isAnalysisModel(OnnxThreading::Model model) {
+  return model != OnnxThreading::Model::Vocoder;
+}
+
+int getHardwareThreads() {
+  return std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+}
+} // namespace
+
+namespace OnnxThreading {
+
+void setSettings(Model model, const Settings &settings) {
+  std::lock_guard<std::mutex> lock(settingsMutex);
+  modelSettings[indexOf(model)] = settings;
+}
+
+Settings getSettings(Model model) {
+  std::lock_guard<std::mutex> lock(settingsMutex);
+  return modelSettings[indexOf(model)];
+}
+
+const char *getModelKey(Model model) {
+  switch (model) {
+  case Model::Vocoder:
+    return "vocoder";
+  case Model::RMVPE:
+    return "rmvpe";
+  case Model::FCPE:
+    return "fcpe";
+  case Model::SOME:
+    return "some";
+  }
+  return "unknown";
+}
+
+juce::String spinningToString(Spinning spinning) {
+  switch (spinning) {
+  case Spinning::On:
+    return "on";
+  case Spinning::Off:
+    return "off";
+  case Spinning::Auto:
+    break;
+  }
+  return "auto";
+}
+
+Spinning stringToSpinning(const juce::String &text) {
+  if (text.equalsIgnoreCase("on"))
+    return Spinning::On;
+  if (text.equalsIgnoreCase("off"))
+    return Spinning::Off;
+  return Spinning::Auto;
+}
+
+Plan resolve(Model model, int sessionIndex, int numSessions) {
+  std::array<Settings, numModels> all;
+  {
+    std::lock_guard<std::mutex> lock(settingsMutex);
+    all = modelSettings;
+  }
+
+  const int hardwareThreads = getHardwareThreads();
+  numSessions = std::max(1, numSessions);
+  sessionIndex = std::clamp(sessionIndex, 0, numSessions - 1);
+
+  // Core budget: analysis first, vocoder after it
+  const int analysisCores = std::max(1, hardwareThreads / 2);
+  const int synthesisCores = std::max(1, hardwareThreads - analysisCores);
+  const int autoVocoderThreads = std::max(1, synthesisCores / numSessions);
+
+  auto intraFor = [&](Model m) {
+    const int requested = all[indexOf(m)].intraOpThreads;
+    if (requested > 0)
+      return requested;
+    return isAnalysisModel(m) ? analysisCores : autoVocoderThreads;
+  };
+  auto interFor = [&](Model m) {
+    return std::max(1, all[indexOf(m)].interOpThreads);
+  };
+
+  // Worst case when analysis and synthesis overlap: the largest analysis
+  // model plus every vocoder session
+  int analysisDemand = 0;
+  for (auto m : {Model::RMVPE, Model::FCPE, Model::SOME})
+    analysisDemand = std::max(analysisDemand, intraFor(m) * interFor(m));
+  const int synthesisDemand =
+      intraFor(Model::Vocoder) * interFor(Model::Vocoder) * numSessions;
+  const bool oversubscribed =
+      analysisDemand + synthesisDemand > hardwareThreads;
+
+  const auto &settings = all[indexOf(model)];
+
+  Plan plan;
+  plan.intraOpThreads = intraFor(model);
+  plan.interOpThreads = interFor(model);
+  switch (settings.spinning) {
+  case Spinning::On:
+    plan.allowSpinning = true;
+    break;
+  case Spinning::Off:
+    plan.allowSpinning = false;
+    break;
+  case Spinning::Auto:
+    plan.allowSpinning = !oversubscribed;
+    break;
+  }
+
+  // Pinning only makes sense when the group fits in its own cores
+  if (settings.pinThreads && !oversubscribed) {
+    const int firstCore =
+        isAnalysisModel(model)
+            ? 0
+            : analysisDemand + sessionIndex * plan.intraOpThreads;
+    if (firstCore + plan.intraOpThreads <= hardwareThreads)
+      for (int i = 0; i < plan.intraOpThreads; ++i)
+        plan.cores.push_back(firstCore + i);
+  }
+
+  return plan;
+}
+
+juce::String describe(const Plan &plan) {
+  juce::StringArray cores;
+  for (int core : plan.cores)
+    cores.add(juce::String(core));
+  return "intra " + juce::String(plan.intraOpThreads) + " inter " +
+         juce::String(plan.interOpThreads) + " spin " +
+         juce::String(plan.allowSpinning ? 1 : 0) + " cores " +
+         (cores.isEmpty() ? juce::String("-") : cores.joinIntoString(","));
+}
+
+#ifdef HAVE_ONNXRUNTIME
+Plan apply(Ort::SessionOptions &options, Model model, int sessionIndex,
+           int numSessions) {
+  auto plan = resolve(model, sessionIndex, numSessions);
+
+  options.SetIntraOpNumThreads(plan.intraOpThreads);
+  if (plan.interOpThreads > 1) {
+    options.SetExecutionMode(ORT_PARALLEL);
+    options.SetInterOpNumThreads(plan.interOpThreads);
+  }
+
+  const char *spin = plan.allowSpinning ? "1" : "0";
+  options.AddConfigEntry("session.intra_op.allow_spinning", spin);
+  options.AddConfigEntry("session.inter_op.allow_spinning", spin);
+
+  // One entry per intra-op worker. The calling thread counts as the first
+  // intra-op thread and is not pinned. ORT wants 1-based processor ids.
+  if (plan.cores.size() > 1) {
+    std::string affinities;
+    for (size_t i = 1; i < plan.cores.size(); ++i) {
+      if (!affinities.empty())
+        affinities += ";";
+      affinities += std::to_string(plan.cores[i] + 1);
+    }
+    options.AddConfigEntry("session.intra_op_thread_affinities",
+                           affinities.c_str());
+  }
+
+  return plan;
+}
+#endif
+
+} // namespace OnnxThreading
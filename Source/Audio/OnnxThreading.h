@@ -0,0 +1,71 @@
+#pragma once
+
+#include "../JuceHeader.h"
+#include <vector>
+
+#ifdef HAVE_ONNXRUNTIME
+#include <onnxruntime_cxx_api.h>
+#endif
+
+/**
+ * Process-wide ONNX Runtime threading policy for every model wrapper.
+ *
+ * Each model has its own settings (0 = auto). Automatic values come from a
+ * shared core budget, so analysis models (RMVPE/FCPE/SOME run one after
+ * another) and the vocoder session pool can run concurrently without asking
+ * for more threads than the machine has:
+ *   - analysis gets half the hardware threads,
+ *   - the vocoder gets the rest, split across its sessions.
+ * When explicit values add up to more than the hardware threads, automatic
+ * spinning is turned off so idle workers yield their cores.
+ *
+ * Settings take effect the next time a model is loaded.
+ */
+namespace OnnxThreading {
+
+enum class Model { Vocoder, RMVPE, FCPE, SOME };
+enum class Spinning { Auto, On, Off };
+
+struct Settings {
+  int intraOpThreads = 0; // 0 = auto
+  int interOpThreads = 0; // 0 = auto (sequential execution)
+  Spinning spinning = Spinning::Auto;
+  bool pinThreads = false; // Pin intra-op workers to the model's cores
+};
+
+/** Thread counts and placement resolved for one session. */
+struct Plan {
+  int intraOpThreads = 1;
+  int interOpThreads = 1;
+  bool allowSpinning = true;
+  std::vector<int> cores; // 0-based logical processors, empty = unpinned
+};
+
+void setSettings(Model model, const Settings &settings);
+Settings getSettings(Model model);
+
+/** Stable identifier used in config files ("vocoder", "rmvpe", ...). */
+const char *getModelKey(Model model);
+
+juce::String spinningToString(Spinning spinning);
+Spinning stringToSpinning(const juce::String &text);
+
+/**
+ * Resolve the settings of one session. sessionIndex/numSessions describe
+ * the vocoder pool; analysis models always use a single session.
+ */
+Plan resolve(Model model, int sessionIndex = 0, int numSessions = 1);
+
+/**
+ * Compact text form of a plan, e.g. "intra 4 inter 1 spin 1 cores 0,1,2,3".
+ * Sessions are only shared between callers whose plans match.
+ */
+juce::String describe(const Plan &plan);
+
+#ifdef HAVE_ONNXRUNTIME
+/** Apply resolve() to session options. Call before adding EPs. */
+Plan apply(Ort::SessionOptions &options, Model model, int sessionIndex = 0,
+           int numSessions = 1);
+#endif
+
+} // namespace OnnxThreading
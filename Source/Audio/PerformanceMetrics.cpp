@@ -0,0 +1,306 @@
+#include "PerformanceMetrics.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+uint64_t toMicroseconds(double seconds) {
+  return seconds > 0.0 ? static_cast<uint64_t>(std::llround(seconds * 1.0e6))
+                       : 0;
+}
+
+size_t loadBucket(int permille) {
+  const auto &edges = PerformanceMetrics::loadBucketEdges;
+  return static_cast<size_t>(
+      std::upper_bound(edges.begin(), edges.end(), permille) - edges.begin());
+}
+
+const char *outcomeName(size_t index) {
+  using Outcome = PerformanceMetrics::BlockOutcome;
+  switch (static_cast<Outcome>(index)) {
+  case Outcome::Rendered:
+    return "rendered";
+  case Outcome::Stopped:
+    return "stopped";
+  case Outcome::NoAudio:
+    return "noAudio";
+  case Outcome::NotReady:
+    return "notReady";
+  case Outcome::Capturing:
+    return "capturing";
+  case Outcome::numOutcomes:
+    break;
+  }
+  return "";
+}
+
+const char *sourceName(size_t index) {
+  using Source = PerformanceMetrics::AudioSource;
+  switch (static_cast<Source>(index)) {
+  case Source::Standalone:
+    return "standalone";
+  case Source::Plugin:
+    return "plugin";
+  case Source::AraRenderer:
+    return "araRenderer";
+  case Source::numSources:
+    break;
+  }
+  return "";
+}
+
+const char *modelName(size_t index) {
+  switch (static_cast<OnnxThreading::Model>(index)) {
+  case OnnxThreading::Model::Vocoder:
+    return "vocoder";
+  case OnnxThreading::Model::RMVPE:
+    return "rmvpe";
+  case OnnxThreading::Model::FCPE:
+    return "fcpe";
+  case OnnxThreading::Model::SOME:
+    return "some";
+  }
+  return "";
+}
+
+juce::var countVar(uint64_t count) {
+  return static_cast<juce::int64>(count);
+}
+
+void raiseTo(std::atomic<int> &peak, int value) {
+  int current = peak.load(std::memory_order_relaxed);
+  while (value > current &&
+         !peak.compare_exchange_weak(current, value,
+                                     std::memory_order_relaxed)) {
+  }
+}
+} // namespace
+
+static_assert(static_cast<size_t>(OnnxThreading::Model::SOME) + 1 ==
+                  PerformanceMetrics::numModels,
+              "one slot per OnnxThreading::Model");
+
+PerformanceMetrics &PerformanceMetrics::getInstance() {
+  static PerformanceMetrics instance;
+  return instance;
+}
+
+void PerformanceMetrics::setDevice(Model model, const juce::String &device) {
+  std::lock_guard<std::mutex> lock(deviceMutex);
+  devices[static_cast<size_t>(model)] = device;
+}
+
+void PerformanceMetrics::recordInference(Model model, double audioSeconds,
+                                         double wallSeconds) {
+  auto &counters = models[static_cast<size_t>(model)];
+  counters.runs.fetch_add(1, std::memory_order_relaxed);
+  counters.audioMicroseconds.fetch_add(toMicroseconds(audioSeconds),
+                                       std::memory_order_relaxed);
+  counters.wallMicroseconds.fetch_add(toMicroseconds(wallSeconds),
+                                      std::memory_order_relaxed);
+}
+
+void PerformanceMetrics::recordEditLatency(double milliseconds) {
+  // A reader racing a writer may pick up one stale entry; fine for a display
+  const auto index = edits.fetch_add(1, std::memory_order_relaxed);
+  latencyMs[index % latencyHistory].store(static_cast<float>(milliseconds),
+                                          std::memory_order_relaxed);
+}
+
+void PerformanceMetrics::setQueueDepth(Queue queue, int depth) {
+  auto &counters = queues[static_cast<size_t>(queue)];
+  counters.depth.store(depth, std::memory_order_relaxed);
+  raiseTo(counters.peak, depth);
+}
+
+void PerformanceMetrics::recordCacheLookup(Cache cache, bool hit) {
+  auto &counters = caches[static_cast<size_t>(cache)];
+  (hit ? counters.hits : counters.misses)
+      .fetch_add(1, std::memory_order_relaxed);
+}
+
+void PerformanceMetrics::recordAudioCallback(AudioSource source,
+                                             double seconds,
+                                             double bufferSeconds) {
+  auto &counters = audio[static_cast<size_t>(source)];
+  counters.callbacks.fetch_add(1, std::memory_order_relaxed);
+  if (bufferSeconds <= 0.0)
+    return;
+  if (seconds > bufferSeconds)
+    counters.overruns.fetch_add(1, std::memory_order_relaxed);
+  const auto permille =
+      static_cast<int>(std::lround(seconds / bufferSeconds * 1000.0));
+  counters.loadHistogram[loadBucket(permille)].fetch_add(
+      1, std::memory_order_relaxed);
+  raiseTo(counters.peakLoadPermille, permille);
+}
+
+void PerformanceMetrics::recordBlockOutcome(AudioSource source,
+                                            BlockOutcome outcome) {
+  audio[static_cast<size_t>(source)]
+      .outcomes[static_cast<size_t>(outcome)]
+      .fetch_add(1, std::memory_order_relaxed);
+}
+
+PerformanceMetrics::Snapshot PerformanceMetrics::snapshot() {
+  Snapshot result;
+  result.timeSeconds = juce::Time::getMillisecondCounterHiRes() / 1000.0;
+  result.wallTimeMs = juce::Time::currentTimeMillis();
+
+  {
+    std::lock_guard<std::mutex> lock(deviceMutex);
+    for (size_t i = 0; i < numModels; ++i)
+      result.models[i].device = devices[i];
+  }
+  for (size_t i = 0; i < numModels; ++i) {
+    auto &stats = result.models[i];
+    stats.runs = models[i].runs.load(std::memory_order_relaxed);
+    stats.audioSeconds =
+        models[i].audioMicroseconds.load(std::memory_order_relaxed) / 1.0e6;
+    stats.wallSeconds =
+        models[i].wallMicroseconds.load(std::memory_order_relaxed) / 1.0e6;
+  }
+
+  for (size_t i = 0; i < numQueues; ++i) {
+    const int depth = queues[i].depth.load(std::memory_order_relaxed);
+    result.queues[i].depth = depth;
+    result.queues[i].peak =
+        std::max(depth, queues[i].peak.exchange(depth,
+                                                std::memory_order_relaxed));
+  }
+
+  for (size_t i = 0; i < numCaches; ++i) {
+    result.caches[i].hits = caches[i].hits.load(std::memory_order_relaxed);
+    result.caches[i].misses = caches[i].misses.load(std::memory_order_relaxed);
+  }
+
+  for (size_t i = 0; i < numAudioSources; ++i) {
+    auto &stats = result.audio[i];
+    stats.callbacks = audio[i].callbacks.load(std::memory_order_relaxed);
+    stats.overruns = audio[i].overruns.load(std::memory_order_relaxed);
+    stats.peakLoad =
+        audio[i].peakLoadPermille.exchange(0, std::memory_order_relaxed) /
+        1000.0;
+    for (size_t b = 0; b < numLoadBuckets; ++b)
+      stats.loadHistogram[b] =
+          audio[i].loadHistogram[b].load(std::memory_order_relaxed);
+    for (size_t o = 0; o < numBlockOutcomes; ++o)
+      stats.outcomes[o] = audio[i].outcomes[o].load(std::memory_order_relaxed);
+  }
+
+  result.edits = edits.load(std::memory_order_relaxed);
+  const auto count = std::min<uint64_t>(result.edits, latencyHistory);
+  result.recentLatencyMs.reserve(static_cast<size_t>(count));
+  for (auto i = result.edits - count; i < result.edits; ++i)
+    result.recentLatencyMs.push_back(
+        latencyMs[i % latencyHistory].load(std::memory_order_relaxed));
+  result.scratch = ScratchArena::getStats();
+  return result;
+}
+
+juce::var PerformanceMetrics::toVar(const Snapshot &snapshot) {
+  auto *object = new juce::DynamicObject();
+  object->setProperty("wallTimeMs", snapshot.wallTimeMs);
+  object->setProperty("timeSeconds", snapshot.timeSeconds);
+
+  auto *modelsObject = new juce::DynamicObject();
+  for (size_t i = 0; i < numModels; ++i) {
+    const auto &stats = snapshot.models[i];
+    auto *model = new juce::DynamicObject();
+    model->setProperty("device", stats.device);
+    model->setProperty("runs", countVar(stats.runs));
+    model->setProperty("audioSeconds", stats.audioSeconds);
+    model->setProperty("wallSeconds", stats.wallSeconds);
+    modelsObject->setProperty(modelName(i), model);
+  }
+  object->setProperty("models", modelsObject);
+
+  auto *queuesObject = new juce::DynamicObject();
+  const char *queueNames[numQueues] = {"vocoderRequests", "synthesisApply"};
+  for (size_t i = 0; i < numQueues; ++i) {
+    auto *queue = new juce::DynamicObject();
+    queue->setProperty("depth", snapshot.queues[i].depth);
+    queue->setProperty("peak", snapshot.queues[i].peak);
+    queuesObject->setProperty(queueNames[i], queue);
+  }
+  object->setProperty("queues", queuesObject);
+
+  auto *cachesObject = new juce::DynamicObject();
+  const char *cacheNames[numCaches] = {"synthesis", "analysis"};
+  for (size_t i = 0; i < numCaches; ++i) {
+    auto *cache = new juce::DynamicObject();
+    cache->setProperty("hits", countVar(snapshot.caches[i].hits));
+    cache->setProperty("misses", countVar(snapshot.caches[i].misses));
+    cachesObject->setProperty(cacheNames[i], cache);
+  }
+  object->setProperty("caches", cachesObject);
+
+  auto *audioObject = new juce::DynamicObject();
+  for (size_t i = 0; i < numAudioSources; ++i) {
+    const auto &stats = snapshot.audio[i];
+    auto *source = new juce::DynamicObject();
+    source->setProperty("callbacks", countVar(stats.callbacks));
+    source->setProperty("overruns", countVar(stats.overruns));
+    source->setProperty("peakLoad", stats.peakLoad);
+
+    juce::Array<juce::var> histogram;
+    for (size_t b = 0; b < numLoadBuckets; ++b) {
+      auto *bucket = new juce::DynamicObject();
+      if (b < loadBucketEdges.size())
+        bucket->setProperty("below", loadBucketEdges[b] / 1000.0);
+      bucket->setProperty("count", countVar(stats.loadHistogram[b]));
+      histogram.add(bucket);
+    }
+    source->setProperty("loadHistogram", histogram);
+
+    auto *outcomes = new juce::DynamicObject();
+    for (size_t o = 0; o < numBlockOutcomes; ++o)
+      outcomes->setProperty(outcomeName(o), countVar(stats.outcomes[o]));
+    source->setProperty("outcomes", outcomes);
+    audioObject->setProperty(sourceName(i), source);
+  }
+  object->setProperty("audio", audioObject);
+
+  object->setProperty("edits", countVar(snapshot.edits));
+  juce::Array<juce::var> latencies;
+  for (float ms : snapshot.recentLatencyMs)
+    latencies.add(static_cast<double>(ms));
+  object->setProperty("recentLatencyMs", latencies);
+
+  auto *scratch = new juce::DynamicObject();
+  scratch->setProperty("retainedBytes",
+                       countVar(snapshot.scratch.retainedBytes));
+  scratch->setProperty("highWaterBytes",
+                       countVar(snapshot.scratch.highWaterBytes));
+  scratch->setProperty("scopes", countVar(snapshot.scratch.scopes));
+  scratch->setProperty("blockAllocations",
+                       countVar(snapshot.scratch.blockAllocations));
+  object->setProperty("scratch", scratch);
+  return juce::var(object);
+}
+
+PerformanceMetrics::ScopedInference::ScopedInference(Model inferenceModel,
+                                                     double seconds)
+    : model(inferenceModel), audioSeconds(seconds),
+      startTicks(juce::Time::getHighResolutionTicks()) {}
+
+PerformanceMetrics::ScopedInference::~ScopedInference() {
+  const double wallSeconds = juce::Time::highResolutionTicksToSeconds(
+      juce::Time::getHighResolutionTicks() - startTicks);
+  getInstance().recordInference(model, audioSeconds, wallSeconds);
+}
+
+PerformanceMetrics::ScopedAudioCallback::ScopedAudioCallback(
+    AudioSource callbackSource, int numSamples, double sampleRate,
+    bool enabled)
+    : source(callbackSource),
+      bufferSeconds(sampleRate > 0.0 ? numSamples / sampleRate : 0.0),
+      startTicks(enabled ? juce::Time::getHighResolutionTicks() : 0),
+      active(enabled) {}
+
+PerformanceMetrics::ScopedAudioCallback::~ScopedAudioCallback() {
+  if (!active)
+    return;
+  const double seconds = juce::Time::highResolutionTicksToSeconds(
+      juce::Time::getHighResolutionTicks() - startTicks);
+  getInstance().recordAudioCallback(source, seconds, bufferSeconds);
+}
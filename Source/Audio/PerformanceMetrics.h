@@ -0,0 +1,192 @@
+#pragma once
+
+#include "../JuceHeader.h"
+#include "OnnxThreading.h"
+#include "../Utils/ScratchArena.h"
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+/**
+ * Process-wide counters behind the settings Performance tab.
+ *
+ * Subsystems record as they work: model runs with the audio length they
+ * covered, edit-to-audio latency, queue depths, cache lookups, audio
+ * callback timing against the buffer deadline and what each audio block
+ * ended up playing. Every record call is a handful of relaxed atomic
+ * operations, so the audio thread may use them; only setDevice() locks.
+ *
+ * Counters only ever grow. Readers take a snapshot() now and then and
+ * difference two of them for rates over a window. Queue and load peaks are
+ * the exception: snapshot() reports the peak since the previous snapshot, so
+ * take them from one place only.
+ */
+class PerformanceMetrics {
+public:
+  using Model = OnnxThreading::Model;
+  enum class Queue { VocoderRequests, SynthesisApply, numQueues };
+  enum class Cache { Synthesis, Analysis, numCaches };
+  enum class AudioSource { Standalone, Plugin, AraRenderer, numSources };
+
+  /** What an audio block put out, and why when it wasn't the render. */
+  enum class BlockOutcome {
+    Rendered,    // Corrected or rendered audio
+    Stopped,     // Silence: transport stopped or playback finished
+    NoAudio,     // Silence while playing: nothing loaded or readable
+    NotReady,    // Input passed through: the render isn't ready yet
+    Capturing,   // Input passed through while recording (non-ARA plugin)
+    numOutcomes
+  };
+
+  static constexpr size_t numModels = 4;
+  static constexpr size_t numQueues = static_cast<size_t>(Queue::numQueues);
+  static constexpr size_t numCaches = static_cast<size_t>(Cache::numCaches);
+  static constexpr size_t numAudioSources =
+      static_cast<size_t>(AudioSource::numSources);
+  static constexpr size_t numBlockOutcomes =
+      static_cast<size_t>(BlockOutcome::numOutcomes);
+  // Edit latencies kept for the mean and percentiles
+  static constexpr size_t latencyHistory = 256;
+
+  // Upper edges of the callback load histogram, in permille of the buffer
+  // time; the last bucket holds everything from the final edge up
+  static constexpr std::array<int, 6> loadBucketEdges{250, 500,  750,
+                                                      900, 1000, 1500};
+  static constexpr size_t numLoadBuckets = loadBucketEdges.size() + 1;
+
+  struct ModelStats {
+    uint64_t runs = 0;
+    double audioSeconds = 0.0; // Audio covered by the runs
+    double wallSeconds = 0.0;  // Time they took
+    juce::String device;       // Empty until the model loaded
+  };
+
+  struct QueueStats {
+    int depth = 0;
+    int peak = 0; // Since the previous snapshot
+  };
+
+  struct CacheStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+  };
+
+  struct AudioStats {
+    uint64_t callbacks = 0;
+    uint64_t overruns = 0; // Callbacks that took longer than their buffer
+    double peakLoad = 0.0; // Callback time / buffer time, since the previous
+                           // snapshot
+    std::array<uint64_t, numLoadBuckets> loadHistogram{};
+    std::array<uint64_t, numBlockOutcomes> outcomes{};
+  };
+
+  struct Snapshot {
+    double timeSeconds = 0.0; // Millisecond counter when taken
+    juce::int64 wallTimeMs = 0; // Wall clock, to line up with the logs
+    std::array<ModelStats, numModels> models;
+    std::array<QueueStats, numQueues> queues;
+    std::array<CacheStats, numCaches> caches;
+    std::array<AudioStats, numAudioSources> audio;
+    uint64_t edits = 0;
+    std::vector<float> recentLatencyMs; // Oldest first
+    ScratchArena::Stats scratch;        // Model call temporaries
+  };
+
+  static PerformanceMetrics &getInstance();
+
+  void setDevice(Model model, const juce::String &device);
+  void recordInference(Model model, double audioSeconds, double wallSeconds);
+
+  /** Time from the start of a re-synthesis to its first audio landing. */
+  void recordEditLatency(double milliseconds);
+
+  void setQueueDepth(Queue queue, int depth);
+
+  void recordCacheLookup(Cache cache, bool hit);
+
+  /** One audio callback that took `seconds` to fill `bufferSeconds`. */
+  void recordAudioCallback(AudioSource source, double seconds,
+                           double bufferSeconds);
+
+  void recordBlockOutcome(AudioSource source, BlockOutcome outcome);
+
+  Snapshot snapshot();
+
+  /** A snapshot as JSON, for exporting alongside the logs. */
+  static juce::var toVar(const Snapshot &snapshot);
+
+  /**
+   * Times a scope and records it as one run of model over audioSeconds.
+   * Runs that fail part way still count.
+   */
+  class ScopedInference {
+  public:
+    ScopedInference(Model model, double audioSeconds);
+    ~ScopedInference();
+
+  private:
+    Model model;
+    double audioSeconds;
+    int64_t startTicks;
+
+    JUCE_DECLARE_NON_COPYABLE(ScopedInference)
+  };
+
+  /** Times an audio callback; a disabled one (offline render) is skipped. */
+  class ScopedAudioCallback {
+  public:
+    ScopedAudioCallback(AudioSource source, int numSamples, double sampleRate,
+                        bool enabled = true);
+    ~ScopedAudioCallback();
+
+  private:
+    AudioSource source;
+    double bufferSeconds;
+    int64_t startTicks;
+    bool active;
+
+    JUCE_DECLARE_NON_COPYABLE(ScopedAudioCallback)
+  };
+
+private:
+  PerformanceMetrics() = default;
+
+  struct ModelCounters {
+    std::atomic<uint64_t> runs{0};
+    std::atomic<uint64_t> audioMicroseconds{0};
+    std::atomic<uint64_t> wallMicroseconds{0};
+  };
+
+  struct QueueCounters {
+    std::atomic<int> depth{0};
+    std::atomic<int> peak{0};
+  };
+
+  struct CacheCounters {
+    std::atomic<uint64_t> hits{0};
+    std::atomic<uint64_t> misses{0};
+  };
+
+  struct AudioCounters {
+    std::atomic<uint64_t> callbacks{0};
+    std::atomic<uint64_t> overruns{0};
+    std::atomic<int> peakLoadPermille{0};
+    std::array<std::atomic<uint64_t>, numLoadBuckets> loadHistogram{};
+    std::array<std::atomic<uint64_t>, numBlockOutcomes> outcomes{};
+  };
+
+  std::array<ModelCounters, numModels> models;
+  std::array<QueueCounters, numQueues> queues;
+  std::array<CacheCounters, numCaches> caches;
+  std::array<AudioCounters, numAudioSources> audio;
+
+  std::array<std::atomic<float>, latencyHistory> latencyMs{};
+  std::atomic<uint64_t> edits{0};
+
+  std::mutex deviceMutex;
+  std::array<juce::String, numModels> devices;
+
+  JUCE_DECLARE_NON_COPYABLE(PerformanceMetrics)
+};
@@ -0,0 +1,253 @@
+#include "ProviderBenchmark.h"
+#include "FCPEPitchDetector.h"
+#include "RMVPEPitchDetector.h"
+#include "SOMEDetector.h"
+#include "Vocoder.h"
+#include "../Utils/AppLogger.h"
+#include "../Utils/Constants.h"
+#include "../Utils/MelSpectrogram.h"
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+
+namespace {
+constexpr double benchmarkSeconds = 4.0;
+constexpr int timedRuns = 3;
+
+GPUProvider toProvider(const juce::String &device) {
+  if (device == "CUDA")
+    return GPUProvider::CUDA;
+  if (device == "DirectML")
+    return GPUProvider::DirectML;
+  if (device == "CoreML")
+    return GPUProvider::CoreML;
+  return GPUProvider::CPU;
+}
+
+// Voice-like test signal: a few harmonics on a slow glide with vibrato
+struct TestSignal {
+  std::vector<float> audio;
+  std::vector<float> f0;
+  MelBuffer mel;
+};
+
+TestSignal makeTestSignal() {
+  TestSignal signal;
+  const int numSamples = static_cast<int>(benchmarkSeconds * SAMPLE_RATE);
+  signal.audio.resize(static_cast<size_t>(numSamples));
+
+  const double twoPi = juce::MathConstants<double>::twoPi;
+  double phase = 0.0;
+  for (int i = 0; i < numSamples; ++i) {
+    const double t = static_cast<double>(i) / SAMPLE_RATE;
+    const double freq = 180.0 + 20.0 * t + 3.0 * std::sin(twoPi * 5.5 * t);
+    phase += twoPi * freq / SAMPLE_RATE;
+    double sample = 0.0;
+    for (int h = 1; h <= 6; ++h)
+      sample += std::sin(phase * h) / h;
+    signal.audio[static_cast<size_t>(i)] = static_cast<float>(0.25 * sample);
+  }
+
+  MelSpectrogram melSpec(SAMPLE_RATE, N_FFT, HOP_SIZE, NUM_MELS, FMIN, FMAX);
+  signal.mel = melSpec.compute(signal.audio.data(), numSamples);
+
+  signal.f0.resize(signal.mel.size());
+  for (size_t frame = 0; frame < signal.f0.size(); ++frame) {
+    const double t = static_cast<double>(frame) * HOP_SIZE / SAMPLE_RATE;
+    signal.f0[frame] = static_cast<float>(
+        180.0 + 20.0 * t + 3.0 * std::sin(twoPi * 5.5 * t));
+  }
+  return signal;
+}
+
+// One untimed run (EP init), then the median of timedRuns runs
+template <typename Fn> double timeRealTimeFactor(Fn &&runOnce) {
+  if (!runOnce())
+    return -1.0;
+
+  std::vector<double> seconds;
+  for (int i = 0; i < timedRuns; ++i) {
+    const double start = juce::Time::getMillisecondCounterHiRes();
+    if (!runOnce())
+      return -1.0;
+    seconds.push_back((juce::Time::getMillisecondCounterHiRes() - start) /
+                      1000.0);
+  }
+  std::sort(seconds.begin(), seconds.end());
+  return seconds[seconds.size() / 2] / benchmarkSeconds;
+}
+
+// The caller's instance of model when it is loaded on device/deviceId
+double benchmarkLoaded(OnnxThreading::Model model,
+                       const ProviderBenchmark::LoadedModels &loaded,
+                       const TestSignal &signal) {
+  const auto *audio = signal.audio.data();
+  const int numSamples = static_cast<int>(signal.audio.size());
+
+  switch (model) {
+  case OnnxThreading::Model::Vocoder:
+    if (loaded.vocoder == nullptr || !loaded.vocoder->isLoaded())
+      return -1.0;
+    return timeRealTimeFactor([&]() {
+      return !loaded.vocoder->infer(signal.mel, signal.f0).empty();
+    });
+  case OnnxThreading::Model::RMVPE:
+    if (loaded.rmvpe == nullptr || loaded.pitchDetectorMutex == nullptr)
+      return -1.0;
+    return timeRealTimeFactor([&]() {
+      std::lock_guard<std::mutex> lock(*loaded.pitchDetectorMutex);
+      return loaded.rmvpe->isLoaded() &&
+             !loaded.rmvpe->extractF0(audio, numSamples, SAMPLE_RATE).empty();
+    });
+  case OnnxThreading::Model::FCPE:
+    if (loaded.fcpe == nullptr || loaded.pitchDetectorMutex == nullptr)
+      return -1.0;
+    return timeRealTimeFactor([&]() {
+      std::lock_guard<std::mutex> lock(*loaded.pitchDetectorMutex);
+      return loaded.fcpe->isLoaded() &&
+             !loaded.fcpe->extractF0(audio, numSamples, SAMPLE_RATE).empty();
+    });
+  case OnnxThreading::Model::SOME:
+    if (loaded.some == nullptr || loaded.noteDetectorMutex == nullptr)
+      return -1.0;
+    return timeRealTimeFactor([&]() {
+      std::lock_guard<std::mutex> lock(*loaded.noteDetectorMutex);
+      return loaded.some->isLoaded() &&
+             !loaded.some->detectNotes(audio, numSamples, SAMPLE_RATE).empty();
+    });
+  }
+  return -1.0;
+}
+
+double benchmarkModel(OnnxThreading::Model model,
+                      const ProviderBenchmark::ModelFiles &files,
+                      const juce::String &device, int deviceId,
+                      const TestSignal &signal) {
+  const auto *audio = signal.audio.data();
+  const int numSamples = static_cast<int>(signal.audio.size());
+
+  switch (model) {
+  case OnnxThreading::Model::Vocoder: {
+    if (!Vocoder::isOnnxRuntimeAvailable() || !files.vocoder.existsAsFile())
+      return -1.0;
+    Vocoder vocoder;
+    vocoder.setExecutionDevice(device);
+    vocoder.setExecutionDeviceId(deviceId);
+    if (!vocoder.loadModel(files.vocoder))
+      return -1.0;
+    return timeRealTimeFactor(
+        [&]() { return !vocoder.infer(signal.mel, signal.f0).empty(); });
+  }
+  case OnnxThreading::Model::RMVPE: {
+    if (!files.rmvpe.existsAsFile())
+      return -1.0;
+    RMVPEPitchDetector detector;
+    if (!detector.loadModel(files.rmvpe, toProvider(device), deviceId))
+      return -1.0;
+    return timeRealTimeFactor([&]() {
+      return !detector.extractF0(audio, numSamples, SAMPLE_RATE).empty();
+    });
+  }
+  case OnnxThreading::Model::FCPE: {
+    if (!files.fcpe.existsAsFile())
+      return -1.0;
+    FCPEPitchDetector detector;
+    if (!detector.loadModel(files.fcpe, files.melFilterbank, files.centTable,
+                            toProvider(device), deviceId))
+      return -1.0;
+    return timeRealTimeFactor([&]() {
+      return !detector.extractF0(audio, numSamples, SAMPLE_RATE).empty();
+    });
+  }
+  case OnnxThreading::Model::SOME: {
+    if (!files.some.existsAsFile())
+      return -1.0;
+    SOMEDetector detector;
+    if (!detector.loadModel(files.some, toProvider(device), deviceId))
+      return -1.0;
+    return timeRealTimeFactor([&]() {
+      return !detector.detectNotes(audio, numSamples, SAMPLE_RATE).empty();
+    });
+  }
+  }
+  return -1.0;
+}
+} // namespace
+
+namespace ProviderBenchmark {
+
+std::vector<Result> run(const ModelFiles &files,
+                        const HardwareCapabilities::Snapshot &hardware,
+                        const LoadedModels &loaded,
+                        const ProgressCallback &onProgress,
+                        const std::atomic<bool> &cancelFlag) {
+  const OnnxThreading::Model models[] = {
+      OnnxThreading::Model::Vocoder, OnnxThreading::Model::RMVPE,
+      OnnxThreading::Model::FCPE, OnnxThreading::Model::SOME};
+
+  // Every (device, id) pair to try
+  std::vector<std::pair<juce::String, int>> targets;
+  for (const auto &device : hardware.devices) {
+    const auto &adapters = hardware.getAdapters(device);
+    if (device == "CPU" || adapters.empty()) {
+      targets.emplace_back(device, 0);
+      continue;
+    }
+    for (const auto &adapter : adapters)
+      targets.emplace_back(device, adapter.deviceId);
+  }
+
+  const auto signal = makeTestSignal();
+  const double totalSteps =
+      static_cast<double>(targets.size() * std::size(models));
+  int step = 0;
+
+  std::vector<Result> results;
+  for (const auto &[device, deviceId] : targets) {
+    for (auto model : models) {
+      if (cancelFlag.load())
+        return results;
+
+      const juce::String label = juce::String(OnnxThreading::getModelKey(model)) +
+                                 " on " + device + " " +
+                                 juce::String(deviceId);
+      if (onProgress)
+        onProgress(step++ / totalSteps, "Benchmarking " + label + "...");
+
+      const auto &placement = loaded.placements[static_cast<size_t>(model)];
+      const bool isLoaded = placement.device == device &&
+                            (device == "CPU" || placement.deviceId == deviceId);
+      const double rtf =
+          isLoaded ? benchmarkLoaded(model, loaded, signal)
+                   : benchmarkModel(model, files, device, deviceId, signal);
+      if (rtf < 0.0) {
+        LOG("ProviderBenchmark: " + label + " unavailable");
+        continue;
+      }
+
+      LOG("ProviderBenchmark: " + label + " RTF " + juce::String(rtf, 4));
+      results.push_back({model, device, deviceId, rtf});
+    }
+  }
+
+  if (onProgress)
+    onProgress(1.0, "Benchmark complete");
+  return results;
+}
+
+std::vector<Result> pickFastest(const std::vector<Result> &results) {
+  std::vector<Result> fastest;
+  for (const auto &result : results) {
+    auto it = std::find_if(fastest.begin(), fastest.end(),
+                           [&result](const Result &best) {
+                             return best.model == result.model;
+                           });
+    if (it == fastest.end())
+      fastest.push_back(result);
+    else if (result.realTimeFactor < it->realTimeFactor)
+      *it = result;
+  }
+  return fastest;
+}
+
+} // namespace ProviderBenchmark
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "../JuceHeader.h"
+#include "HardwareCapabilities.h"
+#include "OnnxThreading.h"
+#include <array>
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+class FCPEPitchDetector;
+class RMVPEPitchDetector;
+class SOMEDetector;
+class Vocoder;
+
+/**
+ * Times every candidate execution provider/device on a representative
+ * input for each model and reports the real-time factor (processing time /
+ * audio duration; lower is faster).
+ *
+ * A "GPU" device is often slower than the CPU on integrated graphics, and
+ * the best choice can differ per model, so pickFastest() returns one
+ * choice per model rather than one device for everything.
+ *
+ * run() times the caller's loaded models on the devices they are loaded
+ * on, and loads its own instances, one at a time, only for the other
+ * devices. It blocks for several seconds per device; call it from a
+ * background thread.
+ */
+namespace ProviderBenchmark {
+
+struct Result {
+  OnnxThreading::Model model = OnnxThreading::Model::Vocoder;
+  juce::String device = "CPU";
+  int deviceId = 0;
+  double realTimeFactor = 0.0;
+};
+
+struct ModelFiles {
+  juce::File vocoder;
+  juce::File rmvpe;
+  juce::File fcpe;
+  juce::File melFilterbank;
+  juce::File centTable;
+  juce::File some;
+};
+
+/**
+ * Models the caller already has loaded, each with the device it is on (an
+ * empty device where it is not loaded). A second instance would hold that
+ * device's memory twice. Runs of the detectors take their mutex, as the
+ * caller's own analysis does.
+ */
+struct LoadedModels {
+  struct Placement {
+    juce::String device;
+    int deviceId = 0;
+  };
+
+  Vocoder *vocoder = nullptr;
+  RMVPEPitchDetector *rmvpe = nullptr;
+  FCPEPitchDetector *fcpe = nullptr;
+  SOMEDetector *some = nullptr;
+  std::array<Placement, 4> placements; // By OnnxThreading::Model
+  std::mutex *pitchDetectorMutex = nullptr;
+  std::mutex *noteDetectorMutex = nullptr;
+};
+
+using ProgressCallback = std::function<void(double, const juce::String &)>;
+
+/**
+ * Benchmark each model on each of hardware's devices: GPU providers on every
+ * adapter they enumerate (id 0 where they have none listed), CPU once.
+ * Devices a model fails to load on are skipped.
+ * @return One result per (model, device, id) that ran successfully
+ */
+std::vector<Result> run(const ModelFiles &files,
+                        const HardwareCapabilities::Snapshot &hardware,
+                        const LoadedModels &loaded,
+                        const ProgressCallback &onProgress,
+                        const std::atomic<bool> &cancelFlag);
+
+/** Fastest result for each model that has any. */
+std::vector<Result> pickFastest(const std::vector<Result> &results);
+
+} // namespace ProviderBenchmark
@@ -1,6 +1,20 @@
 #include "RMVPEPitchDetector.h"
+#include "OnnxGpuMemory.h"
+#include "OnnxSessionRegistry.h"
+#include "OnnxThreading.h"
+#include "PerformanceMetrics.h"
+#include "RemoteInference.h"
+#include "../Utils/AppLogger.h"
+#include "../Utils/AudioResampler.h"
+#include "../Utils/SalienceDecoder.h"
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <cmath>
+#include <cstring>
+#include <exception>
+#include <mutex>
+#include <thread>
 
 RMVPEPitchDetector::RMVPEPitchDetector() = default;
 
@@ -10,15 +24,25 @@ bool RMVPEPitchDetector::loadModel(const juce::File &modelPath,
                                    GPUProvider provider, int deviceId) {
 #ifdef HAVE_ONNXRUNTIME
   try {
-    // Initialize ONNX Runtime
-    onnxEnv = std::make_unique<Ort::Env>(ORT_LOGGING_LEVEL_WARNING,
-                                         "RMVPEPitchDetector");
+    // The bindings refer to the session about to be replaced, and earlier
+    // chunk results to its model
+    idleShrink.reset();
+    ioBindings.clear();
+    {
+      std::lock_guard<std::mutex> lock(precomputedMutex);
+      precomputedChunks.clear();
+    }
 
     Ort::SessionOptions sessionOptions;
-    sessionOptions.SetIntraOpNumThreads(1);
+    auto threading = OnnxThreading::apply(sessionOptions,
+                                          OnnxThreading::Model::RMVPE);
+    DBG("RMVPE: " << threading.intraOpThreads << " intra-op thread(s)");
     sessionOptions.SetGraphOptimizationLevel(
         GraphOptimizationLevel::ORT_ENABLE_ALL);
 
+    // Tag of the EP actually in use; keys the optimized-graph cache
+    juce::String deviceTag = "CPU";
+
     // Configure execution provider based on GPU settings
 #if defined(_WIN32) && defined(USE_DIRECTML)
     if (provider == GPUProvider::DirectML) {
@@ -34,6 +58,7 @@ bool RMVPEPitchDetector::loadModel(const juce::File &modelPath,
 
         Ort::ThrowOnError(ortDmlApi->SessionOptionsAppendExecutionProvider_DML(
             sessionOptions, deviceId));
+        deviceTag = "DirectML";
         DBG("RMVPE: DirectML execution provider added");
       } catch (const Ort::Exception &e) {
         DBG("RMVPE: Failed to add DirectML provider, using CPU: " << e.what());
@@ -45,7 +70,9 @@ bool RMVPEPitchDetector::loadModel(const juce::File &modelPath,
       try {
         OrtCUDAProviderOptions cudaOptions;
         cudaOptions.device_id = deviceId;
+        OnnxGpuMemory::apply(cudaOptions);
         sessionOptions.AppendExecutionProvider_CUDA(cudaOptions);
+        deviceTag = "CUDA" + juce::String(deviceId);
         DBG("RMVPE: CUDA execution provider added, device: " << deviceId);
       } catch (const Ort::Exception &e) {
         DBG("RMVPE: Failed to add CUDA provider, using CPU: " << e.what());
@@ -55,6 +82,7 @@ bool RMVPEPitchDetector::loadModel(const juce::File &modelPath,
         if (provider == GPUProvider::CoreML) {
       try {
         sessionOptions.AppendExecutionProvider("CoreML");
+        deviceTag = "CoreML";
         DBG("RMVPE: CoreML execution provider added");
       } catch (const Ort::Exception &e) {
         DBG("RMVPE: Failed to add CoreML provider, using CPU: " << e.what());
@@ -65,15 +93,10 @@ bool RMVPEPitchDetector::loadModel(const juce::File &modelPath,
       }
     }
 
-#ifdef _WIN32
-    std::wstring modelPathW = modelPath.getFullPathName().toWideCharPointer();
-    onnxSession = std::make_unique<Ort::Session>(*onnxEnv, modelPathW.c_str(),
-                                                 sessionOptions);
-#else
-    std::string modelPathStr = modelPath.getFullPathName().toStdString();
-    onnxSession = std::make_unique<Ort::Session>(*onnxEnv, modelPathStr.c_str(),
-                                                 sessionOptions);
-#endif
+    // Every editor (plugin instance) with these settings shares one session
+    onnxSession = OnnxSessionRegistry::acquire(
+        modelPath, sessionOptions, deviceTag,
+        OnnxThreading::describe(threading) + " id " + juce::String(deviceId));
 
     allocator = std::make_unique<Ort::AllocatorWithDefaultOptions>();
 
@@ -101,7 +124,29 @@ bool RMVPEPitchDetector::loadModel(const juce::File &modelPath,
     for (const auto &name : outputNameStrings)
       outputNames.push_back(name.c_str());
 
+    outputMemory = OnnxIoBinding::OutputMemory::Cpu;
+#ifdef USE_CUDA
+    if (provider == GPUProvider::CUDA)
+      outputMemory = OnnxIoBinding::OutputMemory::CudaPinned;
+#endif
+    bindingDeviceId = deviceId;
+    ioBindings.push_back(std::make_unique<OnnxIoBinding>(
+        *onnxSession, inputNames, outputNames, outputMemory, deviceId));
+
+    // GPU providers already fill the device with one chunk; on CPU the
+    // recurrent layers leave most intra-op threads idle, so overlap chunks
+    onGpu = deviceTag != "CPU";
+    maxParallelChunks =
+        onGpu ? 1 : std::clamp(threading.intraOpThreads / 2, 1, 4);
+    DBG("RMVPE: up to " << maxParallelChunks << " chunk(s) in parallel");
+    chunkSizer.reset();
+    if (deviceTag.startsWith("CUDA"))
+      idleShrink = std::make_unique<OnnxGpuMemory::IdleShrink>(
+          [this]() { shrinkArena(); });
+
     loaded = true;
+    PerformanceMetrics::getInstance().setDevice(OnnxThreading::Model::RMVPE,
+                                                deviceTag);
     DBG("RMVPE model loaded successfully");
     return true;
   } catch (const Ort::Exception &e) {
@@ -119,33 +164,50 @@ bool RMVPEPitchDetector::loadModel(const juce::File &modelPath,
 #endif
 }
 
-std::vector<float> RMVPEPitchDetector::resampleTo16k(const float *audio,
-                                                     int numSamples,
-                                                     int srcRate) {
-  if (srcRate == SAMPLE_RATE) {
-    return std::vector<float>(audio, audio + numSamples);
-  }
-
-  // Linear interpolation resampling
-  double ratio = static_cast<double>(SAMPLE_RATE) / srcRate;
-  int outSamples = static_cast<int>(numSamples * ratio);
-
-  std::vector<float> resampled(outSamples);
+void RMVPEPitchDetector::warmUp() {
+  if (!loaded)
+    return;
 
-  for (int i = 0; i < outSamples; ++i) {
-    double srcPos = i / ratio;
-    int srcIdx = static_cast<int>(srcPos);
-    double frac = srcPos - srcIdx;
+  // 0.5 s at the model rate, so no resampling is involved
+  std::vector<float> silence(SAMPLE_RATE / 2, 0.0f);
+  extractF0(silence.data(), static_cast<int>(silence.size()), SAMPLE_RATE);
 
-    if (srcIdx + 1 < numSamples) {
-      resampled[i] = static_cast<float>(audio[srcIdx] * (1.0 - frac) +
-                                        audio[srcIdx + 1] * frac);
-    } else if (srcIdx < numSamples) {
-      resampled[i] = audio[srcIdx];
+#ifdef HAVE_ONNXRUNTIME
+  // The CPU default already keeps the cores busy; on a GPU the best length
+  // depends on its memory and throughput. Two seconds a chunk keeps
+  // cancellation and progress responsive.
+  if (onGpu && !ioBindings.empty()) {
+    const int chosen = chunkSizer.calibrate(
+        [this](int size) {
+          try {
+            const std::vector<float> trial(static_cast<size_t>(size), 0.0f);
+            return !extractF0Chunk(trial.data(), size, DEFAULT_THRESHOLD, 0)
+                        .empty();
+          } catch (const std::exception &e) {
+            DBG("RMVPE: " << size / SAMPLE_RATE
+                          << " s chunk failed: " << e.what());
+            return false;
+          }
+        },
+        2.0);
+    LOG("RMVPE: " + juce::String(chosen / SAMPLE_RATE) + " s chunks");
+
+    // The shorter buckets, which edits and the last chunk of a file land on
+    for (const size_t size :
+         sampleBuckets.upTo(static_cast<size_t>(chosen))) {
+      try {
+        const std::vector<float> trial(size, 0.0f);
+        extractF0Chunk(trial.data(), static_cast<int>(size), DEFAULT_THRESHOLD,
+                       0);
+      } catch (const std::exception &e) {
+        DBG("RMVPE: planning " << static_cast<int>(size) << " samples failed: "
+                               << e.what());
+        break;
+      }
     }
   }
-
-  return resampled;
+#endif
+  DBG("RMVPE: warm-up done");
 }
 
 std::vector<float> RMVPEPitchDetector::decodeF0(const float *hidden,
@@ -153,152 +215,94 @@ std::vector<float> RMVPEPitchDetector::decodeF0(const float *hidden,
                                                 float threshold) {
   // Decode hidden states to F0 values
   // This matches the Python decode function in export.py
-  std::vector<float> f0(numFrames, 0.0f);
-
-  for (int t = 0; t < numFrames; ++t) {
-    const float *frame = hidden + t * N_CLASS;
-
-    // Find max value and index
-    int center = 0;
-    float maxVal = frame[0];
-    for (int i = 1; i < N_CLASS; ++i) {
-      if (frame[i] > maxVal) {
-        maxVal = frame[i];
-        center = i;
-      }
-    }
-
-    // Check threshold (unvoiced detection)
-    if (maxVal < threshold) {
-      f0[t] = 0.0f;
-      continue;
-    }
-
-    // Local weighted average around center (±4 bins)
-    int start = std::max(0, center - 4);
-    int end = std::min(N_CLASS, center + 5);
-
-    float weightedSum = 0.0f;
-    float weightSum = 0.0f;
-
-    for (int i = start; i < end; ++i) {
-      // idx_cents = idx * 20 + RMVPE_CONST
-      float idxCents = i * 20.0f + RMVPE_CONST;
-      weightedSum += frame[i] * idxCents;
-      weightSum += frame[i];
-    }
-
-    if (weightSum > 0.0f) {
-      float cents = weightedSum / weightSum;
-      // f0 = 10 * 2^(cents/1200)
-      f0[t] = 10.0f * std::pow(2.0f, cents / 1200.0f);
-    } else {
-      f0[t] = 0.0f;
-    }
-  }
+  // (idx_cents = idx * 20 + RMVPE_CONST)
+  static const auto binCents = [] {
+    std::array<float, N_CLASS> cents{};
+    for (int i = 0; i < N_CLASS; ++i)
+      cents[i] = i * 20.0f + RMVPE_CONST;
+    return cents;
+  }();
+
+  SalienceDecoder::Layout layout;
+  layout.binCents = binCents.data();
+  layout.numBins = N_CLASS;
+  layout.voicedAtThreshold = true;
 
+  std::vector<float> f0(numFrames, 0.0f);
+  SalienceDecoder::decode(hidden, numFrames, layout, threshold, f0.data());
   return f0;
 }
 
-std::vector<float> RMVPEPitchDetector::extractF0(const float *audio,
-                                                 int numSamples, int sampleRate,
-                                                 float threshold) {
-#ifdef HAVE_ONNXRUNTIME
-  if (!loaded) {
-    DBG("RMVPE model not loaded");
-    return {};
-  }
+std::vector<float>
+RMVPEPitchDetector::extractF0(const float *audio, int numSamples,
+                              int sampleRate, float threshold,
+                              const std::atomic<bool> *cancelFlag) {
+  return extractF0WithProgress(audio, numSamples, sampleRate, threshold,
+                               nullptr, nullptr, cancelFlag);
+}
 
+#ifdef HAVE_ONNXRUNTIME
+void RMVPEPitchDetector::shrinkArena() {
   try {
-    // Step 1: Resample to 16kHz
-    auto audio16k = resampleTo16k(audio, numSamples, sampleRate);
-
-    // Process in chunks to avoid stack overflow for long audio
-    // Max chunk: 30 seconds at 16kHz = 480000 samples
-    constexpr int MAX_CHUNK_SAMPLES = 16000 * 30;
-    constexpr int OVERLAP_SAMPLES = 16000; // 1 second overlap
-
-    if (static_cast<int>(audio16k.size()) <= MAX_CHUNK_SAMPLES) {
-      // Short audio: process directly
-      return extractF0Chunk(audio16k.data(), static_cast<int>(audio16k.size()),
-                            threshold);
-    }
-
-    // Long audio: process in chunks
-    std::vector<float> allF0;
-    int pos = 0;
-    int totalSamples = static_cast<int>(audio16k.size());
-
-    while (pos < totalSamples) {
-      int chunkEnd = std::min(pos + MAX_CHUNK_SAMPLES, totalSamples);
-      int chunkSize = chunkEnd - pos;
-
-      auto chunkF0 =
-          extractF0Chunk(audio16k.data() + pos, chunkSize, threshold);
-
-      if (pos == 0) {
-        // First chunk: use all frames
-        allF0 = std::move(chunkF0);
-      } else {
-        // Subsequent chunks: skip overlap frames
-        int overlapFrames = OVERLAP_SAMPLES / HOP_SIZE;
-        if (static_cast<int>(chunkF0.size()) > overlapFrames) {
-          allF0.insert(allF0.end(), chunkF0.begin() + overlapFrames,
-                       chunkF0.end());
-        }
-      }
-
-      pos += MAX_CHUNK_SAMPLES - OVERLAP_SAMPLES;
-    }
-
-    return allF0;
+    OnnxIoBinding binding(*onnxSession, inputNames, outputNames, outputMemory,
+                          bindingDeviceId);
+    constexpr size_t samples = SAMPLE_RATE / 2;
+    float *waveform = binding.getInputBuffer(0, samples);
+    std::fill(waveform, waveform + samples, 0.0f);
+    *binding.getInputBuffer(1, 1) = DEFAULT_THRESHOLD;
+    binding.bindInput(0, {1, static_cast<int64_t>(samples)});
+    binding.bindInput(1, {1});
+
+    Ort::RunOptions runOptions;
+    OnnxGpuMemory::requestShrink(runOptions, bindingDeviceId);
+    binding.run(runOptions);
+    DBG("RMVPE: released idle GPU memory");
   } catch (const Ort::Exception &e) {
-    DBG("ONNX Runtime error during RMVPE inference: " << e.what());
-    return {};
-  } catch (const std::exception &e) {
-    DBG("Error during RMVPE F0 extraction: " << e.what());
-    return {};
+    DBG("RMVPE: releasing idle GPU memory failed: " << e.what());
   }
-#else
-  DBG("ONNX Runtime not available");
-  return {};
-#endif
 }
 
-std::vector<float> RMVPEPitchDetector::extractF0Chunk(const float *audio16k,
-                                                      int numSamples,
-                                                      float threshold) {
+OnnxIoBinding &RMVPEPitchDetector::getBinding(size_t index) {
+  while (ioBindings.size() <= index)
+    ioBindings.push_back(std::make_unique<OnnxIoBinding>(
+        *onnxSession, inputNames, outputNames, outputMemory, bindingDeviceId));
+  return *ioBindings[index];
+}
+#endif
+
+std::vector<float>
+RMVPEPitchDetector::extractF0Chunk(const float *audio16k, int numSamples,
+                                   float threshold, size_t binding,
+                                   const std::atomic<bool> *cancelFlag) {
 #ifdef HAVE_ONNXRUNTIME
-  // Prepare input tensor [1, n_samples]
-  std::array<int64_t, 2> waveformShape = {1, static_cast<int64_t>(numSamples)};
+  auto &ioBinding = *ioBindings[binding];
+  if (ioBinding.getNumInputs() < 2)
+    return {};
 
-  Ort::MemoryInfo memoryInfo = Ort::MemoryInfo::CreateCpu(
-      OrtAllocatorType::OrtArenaAllocator, OrtMemType::OrtMemTypeDefault);
+  // On a GPU the waveform is padded with silence to a bucket length the
+  // device has planned for, and the frames past numSamples are dropped
+  const size_t runSamples =
+      onGpu ? sampleBuckets.bucketFor(static_cast<size_t>(numSamples))
+            : static_cast<size_t>(numSamples);
 
-  Ort::Value waveformTensor = Ort::Value::CreateTensor<float>(
-      memoryInfo, const_cast<float *>(audio16k), numSamples,
-      waveformShape.data(), waveformShape.size());
+  // Waveform [1, n_samples] and threshold [1] into the bound input buffers
+  float *waveformData = ioBinding.getInputBuffer(0, runSamples);
+  std::copy(audio16k, audio16k + numSamples, waveformData);
+  std::fill(waveformData + numSamples, waveformData + runSamples, 0.0f);
+  *ioBinding.getInputBuffer(1, 1) = threshold;
 
-  // Threshold tensor
-  std::array<int64_t, 1> thresholdShape = {1};
-  std::vector<float> thresholdData = {threshold};
-  Ort::Value thresholdTensor = Ort::Value::CreateTensor<float>(
-      memoryInfo, thresholdData.data(), 1, thresholdShape.data(),
-      thresholdShape.size());
+  ioBinding.bindInput(0, {1, static_cast<int64_t>(runSamples)});
+  ioBinding.bindInput(1, {1});
 
   // Run inference
-  std::vector<Ort::Value> inputTensors;
-  inputTensors.push_back(std::move(waveformTensor));
-  inputTensors.push_back(std::move(thresholdTensor));
-
-  auto outputTensors = onnxSession->Run(
-      Ort::RunOptions{nullptr}, inputNames.data(), inputTensors.data(),
-      inputTensors.size(), outputNames.data(), outputNames.size());
+  auto outputTensors = ioBinding.run(cancelFlag);
 
   // Get output - f0 [1, n_frames]
   float *f0Data = outputTensors[0].GetTensorMutableData<float>();
   auto f0Shape = outputTensors[0].GetTensorTypeAndShapeInfo().GetShape();
   int numFrames = static_cast<int>(f0Shape[1]);
+  if (runSamples > static_cast<size_t>(numSamples))
+    numFrames = std::min(numFrames, numSamples / HOP_SIZE + 1);
 
   return std::vector<float>(f0Data, f0Data + numFrames);
 #else
@@ -308,63 +312,165 @@ std::vector<float> RMVPEPitchDetector::extractF0Chunk(const float *audio16k,
 
 std::vector<float> RMVPEPitchDetector::extractF0WithProgress(
     const float *audio, int numSamples, int sampleRate, float threshold,
-    std::function<void(double)> progressCallback) {
+    std::function<void(double)> progressCallback,
+    F0ChunkCallback chunkCallback, const std::atomic<bool> *cancelFlag) {
 #ifdef HAVE_ONNXRUNTIME
   if (!loaded) {
     DBG("RMVPE model not loaded");
     return {};
   }
 
+  PerformanceMetrics::ScopedInference timing(
+      OnnxThreading::Model::RMVPE,
+      static_cast<double>(numSamples) / sampleRate);
+  if (idleShrink)
+    idleShrink->touch();
+
   try {
     if (progressCallback)
       progressCallback(0.1);
 
-    // Step 1: Resample to 16kHz
-    auto audio16k = resampleTo16k(audio, numSamples, sampleRate);
+    // Step 1: Resample to 16kHz, unless the caller passed 16 kHz audio
+    ScratchArena::Scope scratch;
+    int totalSamples = numSamples;
+    const float *audio16k = AudioResampler::resample(
+        audio, totalSamples, sampleRate, SAMPLE_RATE, scratch);
 
     if (progressCallback)
       progressCallback(0.3);
 
-    // Step 2: Prepare input tensor [1, n_samples]
-    std::array<int64_t, 2> waveformShape = {
-        1, static_cast<int64_t>(audio16k.size())};
-
-    Ort::MemoryInfo memoryInfo = Ort::MemoryInfo::CreateCpu(
-        OrtAllocatorType::OrtArenaAllocator, OrtMemType::OrtMemTypeDefault);
-
-    Ort::Value waveformTensor = Ort::Value::CreateTensor<float>(
-        memoryInfo, audio16k.data(), audio16k.size(), waveformShape.data(),
-        waveformShape.size());
-
-    // Threshold tensor
-    std::array<int64_t, 1> thresholdShape = {1};
-    std::vector<float> thresholdData = {threshold};
-    Ort::Value thresholdTensor = Ort::Value::CreateTensor<float>(
-        memoryInfo, thresholdData.data(), 1, thresholdShape.data(),
-        thresholdShape.size());
-
-    if (progressCallback)
-      progressCallback(0.5);
-
-    // Step 3: Run inference
-    std::vector<Ort::Value> inputTensors;
-    inputTensors.push_back(std::move(waveformTensor));
-    inputTensors.push_back(std::move(thresholdTensor));
+    if (ioBindings.empty())
+      return {};
 
-    auto outputTensors = onnxSession->Run(
-        Ort::RunOptions{nullptr}, inputNames.data(), inputTensors.data(),
-        inputTensors.size(), outputNames.data(), outputNames.size());
+    auto isCancelled = [cancelFlag]() {
+      return cancelFlag != nullptr && cancelFlag->load();
+    };
 
-    if (progressCallback)
-      progressCallback(0.9);
+    // Steps 2-4 at one chunk length; throws when a chunk fails
+    auto inferChunked = [&](const int chunkSamples) {
+      // Step 2: Split into overlapping chunks; a single chunk is the whole
+      // input, so short audio behaves as before
+      constexpr int OVERLAP_SAMPLES = CHUNK_OVERLAP_SAMPLES;
 
-    // Step 4: Get output - f0 [1, n_frames]
-    float *f0Data = outputTensors[0].GetTensorMutableData<float>();
-    auto f0Shape = outputTensors[0].GetTensorTypeAndShapeInfo().GetShape();
-    int numFrames = static_cast<int>(f0Shape[1]);
+      std::vector<int> chunkStarts;
+      for (int pos = 0;; pos += chunkSamples - OVERLAP_SAMPLES) {
+        chunkStarts.push_back(pos);
+        if (pos + chunkSamples >= totalSamples)
+          break;
+      }
+      const size_t numChunks = chunkStarts.size();
+      const auto remote = getRemoteInference();
+      const int parallelChunks = std::max(
+          maxParallelChunks, remote ? remote->getMaxInFlight() : 1);
+      const size_t numWorkers = std::min(
+          numChunks, static_cast<size_t>(std::max(1, parallelChunks)));
+      for (size_t i = 0; i < numWorkers; ++i)
+        getBinding(i);
+
+      // Step 3: Run chunks on a bounded set of workers (the caller is one);
+      // each worker owns one I/O binding
+      constexpr int overlapFrames = OVERLAP_SAMPLES / HOP_SIZE;
+      std::vector<std::vector<float>> chunkF0(numChunks);
+      std::vector<char> chunkReady(numChunks, 0);
+      std::atomic<size_t> nextChunk{0};
+      std::mutex progressMutex;
+      size_t chunksDone = 0;
+      size_t chunksDelivered = 0;
+      int framesDelivered = 0;
+      std::exception_ptr failure;
+
+      // Hand the in-order finished prefix to chunkCallback, trimmed the same
+      // way as the final stitch. Caller holds progressMutex.
+      auto deliverFinishedPrefix = [&]() {
+        while (chunksDelivered < numChunks && chunkReady[chunksDelivered]) {
+          const auto &frames = chunkF0[chunksDelivered];
+          const int skip = chunksDelivered == 0 ? 0 : overlapFrames;
+          if (static_cast<int>(frames.size()) > skip) {
+            const std::vector<float> fresh(frames.begin() + skip, frames.end());
+            chunkCallback(fresh, framesDelivered);
+            framesDelivered += static_cast<int>(fresh.size());
+          }
+          ++chunksDelivered;
+        }
+      };
+
+      auto runWorker = [&](size_t binding) {
+        try {
+          for (size_t c = nextChunk++; c < numChunks; c = nextChunk++) {
+            if (isCancelled())
+              return;
+            const int start = chunkStarts[c];
+            const int size = std::min(chunkSamples, totalSamples - start);
+            std::vector<float> frames;
+            if (!findPrecomputed(hashChunk(audio16k + start, size, threshold),
+                                 frames) &&
+                !extractF0Remote(audio16k + start, size, threshold, cancelFlag,
+                                 frames))
+              frames = extractF0Chunk(audio16k + start, size, threshold,
+                                      binding, cancelFlag);
+
+            std::lock_guard<std::mutex> lock(progressMutex);
+            chunkF0[c] = std::move(frames);
+            chunkReady[c] = 1;
+            ++chunksDone;
+            if (chunkCallback)
+              deliverFinishedPrefix();
+            if (progressCallback)
+              progressCallback(0.3 + 0.65 * static_cast<double>(chunksDone) /
+                                         static_cast<double>(numChunks));
+          }
+        } catch (...) {
+          std::lock_guard<std::mutex> lock(progressMutex);
+          if (!failure)
+            failure = std::current_exception();
+          nextChunk = numChunks; // Stop the other workers early
+        }
+      };
+
+      std::vector<std::thread> workers;
+      for (size_t i = 1; i < numWorkers; ++i)
+        workers.emplace_back(runWorker, i);
+      runWorker(0);
+      for (auto &worker : workers)
+        worker.join();
+
+      if (failure && !isCancelled())
+        std::rethrow_exception(failure);
+
+      // Step 4: Stitch in order; later chunks drop their overlap frames
+      std::vector<float> f0 = std::move(chunkF0[0]);
+      for (size_t c = 1; c < numChunks; ++c) {
+        if (static_cast<int>(chunkF0[c].size()) > overlapFrames)
+          f0.insert(f0.end(), chunkF0[c].begin() + overlapFrames,
+                    chunkF0[c].end());
+      }
+      return f0;
+    };
 
-    // Copy f0 values
-    std::vector<float> f0(f0Data, f0Data + numFrames);
+    // A chunk the device cannot allocate for is retried shorter; shorter
+    // than the input, since the failed run bounds every longer one
+    std::vector<float> f0;
+    for (int chunkSamples = chunkSizer.get();;) {
+      try {
+        f0 = inferChunked(chunkSamples);
+        break;
+      } catch (const std::exception &e) {
+        if (isCancelled() || !ChunkSizer::isOutOfMemory(e.what()))
+          throw;
+        int smaller = chunkSizer.shrink(chunkSamples);
+        while (smaller > 0 && smaller >= totalSamples)
+          smaller = chunkSizer.shrink(smaller);
+        if (smaller <= 0)
+          throw;
+        LOG_WARNING("RMVPE: out of memory at " +
+                    juce::String(chunkSamples / SAMPLE_RATE) +
+                    " s chunks, retrying at " +
+                    juce::String(smaller / SAMPLE_RATE) + " s");
+        chunkSamples = smaller;
+      }
+    }
+    if (isCancelled())
+      return {};
 
     if (progressCallback)
       progressCallback(1.0);
@@ -383,6 +489,106 @@ std::vector<float> RMVPEPitchDetector::extractF0WithProgress(
 #endif
 }
 
+uint64_t RMVPEPitchDetector::hashChunk(const float *audio16k, int numSamples,
+                                       float threshold) {
+  // FNV-1a over the raw sample bits: only an exact match may reuse a result
+  uint64_t hash = 14695981039346656037ull;
+  auto mix = [&hash](uint32_t bits) {
+    for (int i = 0; i < 4; ++i) {
+      hash ^= (bits >> (8 * i)) & 0xffu;
+      hash *= 1099511628211ull;
+    }
+  };
+  uint32_t bits;
+  std::memcpy(&bits, &threshold, sizeof(bits));
+  mix(bits);
+  mix(static_cast<uint32_t>(numSamples));
+  for (int i = 0; i < numSamples; ++i) {
+    std::memcpy(&bits, audio16k + i, sizeof(bits));
+    mix(bits);
+  }
+  return hash;
+}
+
+bool RMVPEPitchDetector::findPrecomputed(uint64_t key,
+                                         std::vector<float> &f0) {
+  std::lock_guard<std::mutex> lock(precomputedMutex);
+  for (const auto &entry : precomputedChunks) {
+    if (entry.first == key) {
+      f0 = entry.second;
+      return true;
+    }
+  }
+  return false;
+}
+
+int RMVPEPitchDetector::precomputeChunks(const float *audio16k, int numSamples,
+                                         float threshold) {
+#ifdef HAVE_ONNXRUNTIME
+  if (!loaded || ioBindings.empty())
+    return 0;
+
+  // Same layout as extractF0WithProgress(); only chunks that are already
+  // complete, so their samples no longer change as the audio grows
+  int inferred = 0;
+  try {
+    const int chunkSamples = chunkSizer.get();
+    for (int pos = 0; pos + chunkSamples <= numSamples;
+         pos += chunkSamples - CHUNK_OVERLAP_SAMPLES) {
+      const uint64_t key = hashChunk(audio16k + pos, chunkSamples, threshold);
+      std::vector<float> frames;
+      if (findPrecomputed(key, frames))
+        continue;
+
+      frames = extractF0Chunk(audio16k + pos, chunkSamples, threshold, 0);
+      if (frames.empty())
+        break;
+      ++inferred;
+
+      std::lock_guard<std::mutex> lock(precomputedMutex);
+      precomputedChunks.emplace_back(key, std::move(frames));
+      if (precomputedChunks.size() > maxPrecomputedChunks)
+        precomputedChunks.pop_front();
+    }
+  } catch (const Ort::Exception &e) {
+    DBG("ONNX Runtime error during RMVPE chunk precompute: " << e.what());
+  }
+  return inferred;
+#else
+  juce::ignoreUnused(audio16k, numSamples, threshold);
+  return 0;
+#endif
+}
+
+void RMVPEPitchDetector::setRemoteInference(
+    std::shared_ptr<RemoteInference> remote) {
+  std::lock_guard<std::mutex> lock(remoteMutex);
+  remoteInference = std::move(remote);
+}
+
+std::shared_ptr<RemoteInference> RMVPEPitchDetector::getRemoteInference() const {
+  std::lock_guard<std::mutex> lock(remoteMutex);
+  return remoteInference;
+}
+
+bool RMVPEPitchDetector::extractF0Remote(const float *audio16k, int numSamples,
+                                         float threshold,
+                                         const std::atomic<bool> *cancelFlag,
+                                         std::vector<float> &f0) {
+  auto remote = getRemoteInference();
+  if (!remote || !remote->isAvailable() ||
+      !remote->extractPitch(audio16k, numSamples, threshold, cancelFlag, f0))
+    return false;
+  // Stitching relies on the local frame count
+  if (static_cast<int>(f0.size()) != numSamples / HOP_SIZE + 1) {
+    LOG_WARNING("RMVPE: remote returned " + juce::String(f0.size()) +
+                " frames for " + juce::String(numSamples) + " samples");
+    f0.clear();
+    return false;
+  }
+  return true;
+}
+
 int RMVPEPitchDetector::getNumFrames(int numSamples, int sampleRate) const {
   // Convert to 16kHz sample count
   int samples16k = static_cast<int>(
@@ -1,9 +1,18 @@
 #pragma once
 
 #include "../JuceHeader.h"
+#include "ChunkSizer.h"
 #include "FCPEPitchDetector.h"  // For GPUProvider enum
+#include "OnnxGpuMemory.h"
+#include "OnnxIoBinding.h"
+#include "ShapeBuckets.h"
+#include <atomic>
+#include <cstdint>
+#include <deque>
 #include <vector>
 #include <memory>
+#include <mutex>
+#include <utility>
 
 #ifdef HAVE_ONNXRUNTIME
 #include <onnxruntime_cxx_api.h>
@@ -12,6 +21,8 @@
 #endif
 #endif
 
+class RemoteInference;
+
 /**
  * RMVPE (Robust Model for Vocal Pitch Estimation) - Deep learning based pitch detector.
  * Uses ONNX Runtime for inference.
@@ -34,6 +45,11 @@ public:
     static constexpr float RMVPE_CONST = 1997.3794084376191f;  // Renamed from CONST to avoid Windows macro conflict
     static constexpr float DEFAULT_THRESHOLD = 0.03f;
 
+    // Long audio is inferred in chunks of getChunkSamples(), by default
+    // this long, overlapping by CHUNK_OVERLAP_SAMPLES (both at 16 kHz)
+    static constexpr int CHUNK_SAMPLES = SAMPLE_RATE * 30;
+    static constexpr int CHUNK_OVERLAP_SAMPLES = SAMPLE_RATE;
+
     RMVPEPitchDetector();
     ~RMVPEPitchDetector();
 
@@ -53,6 +69,16 @@ public:
      */
     bool isLoaded() const { return loaded; }
 
+    /**
+     * Run one short inference on silence so graph initialization and kernel
+     * selection happen now rather than on the first real call. On GPU
+     * providers this also times silent chunks of each candidate length and
+     * keeps the fastest one that fits the device (see getChunkSamples()).
+     * Blocking; call from a background thread, not concurrently with other
+     * calls.
+     */
+    void warmUp();
+
     /**
      * Extract F0 from audio buffer.
      * The audio will be resampled to 16kHz internally.
@@ -61,17 +87,62 @@ public:
      * @param numSamples Number of samples
      * @param sampleRate Original sample rate
      * @param threshold Confidence threshold (default 0.03)
+     * @param cancelFlag Raising it aborts the chunks in flight; the result
+     *        is then empty
      * @return F0 values in Hz (0 for unvoiced frames)
      */
     std::vector<float> extractF0(const float* audio, int numSamples,
-                                 int sampleRate, float threshold = DEFAULT_THRESHOLD);
+                                 int sampleRate, float threshold = DEFAULT_THRESHOLD,
+                                 const std::atomic<bool>* cancelFlag = nullptr);
+
+    /**
+     * Receives newly finished F0 frames [startFrame, startFrame + f0.size())
+     * of the final result. Frames arrive in order and without gaps.
+     */
+    using F0ChunkCallback = std::function<void(const std::vector<float>& f0, int startFrame)>;
 
     /**
      * Extract F0 with progress callback.
+     * Audio longer than one chunk (getChunkSamples()) is split into
+     * overlapping chunks that run in parallel (see getMaxParallelChunks()).
+     * progressCallback is called as each chunk finishes and chunkCallback as
+     * the finished prefix grows, possibly from a worker thread but never from
+     * two threads at once. A chunk the device has no memory for makes the
+     * whole input run again with shorter chunks, so chunkCallback may see
+     * the same frames twice. Raising cancelFlag aborts the chunks in flight
+     * and returns nothing.
      */
     std::vector<float> extractF0WithProgress(const float* audio, int numSamples,
                                              int sampleRate, float threshold,
-                                             std::function<void(double)> progressCallback);
+                                             std::function<void(double)> progressCallback,
+                                             F0ChunkCallback chunkCallback = nullptr,
+                                             const std::atomic<bool>* cancelFlag = nullptr);
+
+    /**
+     * Number of chunks inferred at the same time. Chosen on load: 1 on GPU
+     * providers, otherwise derived from the RMVPE intra-op thread count.
+     * The RNN stage barely uses intra-op threads, so several chunks in
+     * flight keep CPU cores busy on long recordings.
+     */
+    int getMaxParallelChunks() const { return maxParallelChunks; }
+
+    /**
+     * Length of the chunks long audio is split into, in 16 kHz samples.
+     * CHUNK_SAMPLES until warmUp() measures the device; lowered for the rest
+     * of the session whenever a chunk runs out of memory.
+     */
+    int getChunkSamples() const { return chunkSizer.get(); }
+
+    /**
+     * Infer the full chunks of audio16k (a prefix of audio that is still
+     * growing, such as a capture in progress) ahead of time. A later
+     * extractF0WithProgress() whose chunk has exactly the same samples and
+     * threshold reuses the result instead of running the model again.
+     * Returns the number of chunks newly inferred. Not concurrently with
+     * other calls.
+     */
+    int precomputeChunks(const float* audio16k, int numSamples,
+                         float threshold = DEFAULT_THRESHOLD);
 
     /**
      * Get the number of F0 frames that will be produced for given audio length.
@@ -88,26 +159,68 @@ public:
      */
     int getHopSizeForSampleRate(int sampleRate) const;
 
+    /**
+     * Send chunks to an inference server first, running the local model
+     * only when it cannot answer; null runs everything locally. With a
+     * server set, up to its getMaxInFlight() chunks run at once.
+     */
+    void setRemoteInference(std::shared_ptr<RemoteInference> remote);
+
 private:
     bool loaded = false;
 
-    // Resample audio to 16kHz
-    std::vector<float> resampleTo16k(const float* audio, int numSamples, int srcRate);
+    int maxParallelChunks = 1;
+    bool onGpu = false;
+    ChunkSizer chunkSizer{{SAMPLE_RATE * 8, SAMPLE_RATE * 15, CHUNK_SAMPLES, SAMPLE_RATE * 60},
+                          CHUNK_SAMPLES};
+    // Chunk lengths on a GPU, each planned by warmUp(); CPU chunks stay exact
+    const ShapeBuckets sampleBuckets{SAMPLE_RATE / 2, SAMPLE_RATE * 60};
 
     // Process a single chunk of 16kHz audio
-    std::vector<float> extractF0Chunk(const float* audio16k, int numSamples, float threshold);
+    std::vector<float> extractF0Chunk(const float* audio16k, int numSamples, float threshold,
+                                      size_t binding = 0,
+                                      const std::atomic<bool>* cancelFlag = nullptr);
+
+    // extractF0Chunk() on the remote backend; false without one or when it
+    // failed
+    bool extractF0Remote(const float* audio16k, int numSamples, float threshold,
+                         const std::atomic<bool>* cancelFlag, std::vector<float>& f0);
+    std::shared_ptr<RemoteInference> getRemoteInference() const;
+    mutable std::mutex remoteMutex;
+    std::shared_ptr<RemoteInference> remoteInference;
+
+    // Chunk results from precomputeChunks(), keyed by a hash of the chunk's
+    // samples and threshold; oldest dropped past maxPrecomputedChunks
+    static constexpr size_t maxPrecomputedChunks = 64;
+    std::mutex precomputedMutex;
+    std::deque<std::pair<uint64_t, std::vector<float>>> precomputedChunks;
+
+    static uint64_t hashChunk(const float* audio16k, int numSamples, float threshold);
+    bool findPrecomputed(uint64_t key, std::vector<float>& f0);
 
     // Decode hidden states to F0 (matching Python decode function)
     std::vector<float> decodeF0(const float* hidden, int numFrames, float threshold);
 
 #ifdef HAVE_ONNXRUNTIME
-    std::unique_ptr<Ort::Env> onnxEnv;
-    std::unique_ptr<Ort::Session> onnxSession;
+    std::shared_ptr<Ort::Session> onnxSession; // From OnnxSessionRegistry
     std::unique_ptr<Ort::AllocatorWithDefaultOptions> allocator;
+    // One binding per chunk in flight; Session::Run itself is thread-safe.
+    // Bindings past the first are created on demand.
+    std::vector<std::unique_ptr<OnnxIoBinding>> ioBindings;
+    OnnxIoBinding::OutputMemory outputMemory = OnnxIoBinding::OutputMemory::Cpu;
+    int bindingDeviceId = 0;
+
+    OnnxIoBinding& getBinding(size_t index);
 
     std::vector<const char*> inputNames;
     std::vector<const char*> outputNames;
     std::vector<std::string> inputNameStrings;
     std::vector<std::string> outputNameStrings;
+
+    // One silent run on a binding of its own that frees the unused part of
+    // the CUDA arena; idleShrink (null off CUDA) calls it once analysis has
+    // sat idle. Declared last, so it stops before the session goes.
+    void shrinkArena();
+    std::unique_ptr<OnnxGpuMemory::IdleShrink> idleShrink;
 #endif
 };
@@ -1,40 +1,107 @@
 #include "RealtimePitchProcessor.h"
+#include "../Utils/Constants.h"
 #include <algorithm>
-#include <cmath>
-
-RealtimePitchProcessor::RealtimePitchProcessor() = default;
+#include <chrono>
+
+RealtimePitchProcessor::RealtimePitchProcessor() {
+  rateCache = std::make_unique<PlaybackRateCache>(
+      [this](RenderSnapshot::Ptr source, RenderSnapshot::Ptr converted) {
+        const RealtimeCheck::ScopedLock sl(bufferLock);
+        // Drop conversions overtaken by a newer render
+        if (source != latestSource ||
+            converted->getSampleRate() != latestTargetRate)
+          return;
+        DBG("RealtimePitchProcessor: converted render ready, samples="
+            << converted->getNumSamples());
+        setProcessedBuffer(std::move(converted));
+        renderCurrent.store(true);
+        notifyOfflineWaiters();
+      });
+}
 
 RealtimePitchProcessor::~RealtimePitchProcessor() {
-  cancelCompute = true;
-  if (computeThread && computeThread->joinable())
-    computeThread->join();
+  rateCache.reset();
+  liveBuffer.store(nullptr);
+  liveCorrector.store(nullptr);
 }
 
 void RealtimePitchProcessor::setProject(Project *proj) {
+  bool changed = false;
   {
-    const juce::ScopedLock sl(bufferLock);
+    const RealtimeCheck::ScopedLock sl(bufferLock);
+    changed = project != proj;
     project = proj;
   }
+  // Pending ranges belong to the previous project's jobs
+  if (changed) {
+    clearRenderPending();
+    noteChangeSubscription.reset();
+    if (proj != nullptr)
+      noteChangeSubscription = proj->getNoteChanges().subscribe(
+          [this](const std::vector<NoteChange> &changes) {
+            // Pitch and timing edits keep each note's detected F0 at its
+            // source position; only new or removed notes change it
+            for (const auto &change : changes)
+              if (change.type != NoteChange::Type::Changed)
+                lookaheadSourceStale = true;
+          });
+    lookaheadSourceStale = true;
+  }
   invalidate();
 }
 
 void RealtimePitchProcessor::setVocoder(Vocoder *voc) {
   {
-    const juce::ScopedLock sl(bufferLock);
+    const RealtimeCheck::ScopedLock sl(bufferLock);
     vocoder = voc;
   }
   // Don't call invalidate() here - wait for project to be set first
   // invalidate() will be called by setProject() or explicitly
 }
 
-void RealtimePitchProcessor::prepareToPlay(double sr, int) {
+void RealtimePitchProcessor::prepareToPlay(double sr, int samplesPerBlock) {
   sampleRate = sr;
   position.store(0.0);
+
+  const RealtimeCheck::ScopedLock sl(bufferLock);
+  preparedBlockSize = std::max(1, samplesPerBlock);
+  liveCorrector.store(nullptr);
+  corrector.reset();
+  if (lookaheadEnabled) {
+    corrector = std::make_unique<StreamingCorrector>();
+    corrector->prepare(sampleRate, lookaheadChannels, preparedBlockSize);
+    liveCorrector.store(corrector.get());
+  }
+  updateLookaheadCurves();
+}
+
+void RealtimePitchProcessor::setLookaheadEnabled(bool enabled) {
+  const RealtimeCheck::ScopedLock sl(bufferLock);
+  lookaheadEnabled = enabled;
+  if (!enabled) {
+    // Kept until audio stops: a block may still be in it
+    liveCorrector.store(nullptr);
+    return;
+  }
+  if (!corrector) {
+    corrector = std::make_unique<StreamingCorrector>();
+    corrector->prepare(sampleRate, lookaheadChannels, preparedBlockSize);
+  }
+  updateLookaheadCurves();
+  liveCorrector.store(corrector.get());
+}
+
+int RealtimePitchProcessor::getLookaheadLatency() const {
+  const RealtimeCheck::ScopedLock sl(bufferLock);
+  return corrector ? corrector->getLatencySamples()
+                   : StreamingCorrector::latencyFor(sampleRate,
+                                                    preparedBlockSize);
 }
 
 bool RealtimePitchProcessor::processBlock(
     juce::AudioBuffer<float> &input, juce::AudioBuffer<float> &output,
     const juce::AudioPlayHead::PositionInfo *posInfo) {
+  REALTIME_SCOPE("RealtimePitchProcessor::processBlock");
   // Get position from host (don't store - let host control position)
   double pos = 0.0;
   if (posInfo) {
@@ -45,251 +112,295 @@ bool RealtimePitchProcessor::processBlock(
   }
   position.store(pos);
 
-  // Passthrough if not ready
-  if (!ready.load()) {
+  // Odd for as long as this block may read the live buffer; see
+  // setProcessedBuffer()
+  callbackCounter.fetch_add(1);
+  const RenderSnapshot *buffer = liveBuffer.load();
+  const bool used =
+      buffer != nullptr &&
+      copyFromProcessed(buffer, output, static_cast<juce::int64>(pos * sampleRate));
+  callbackCounter.fetch_add(1);
+
+  if (buffer == nullptr)
+    passthroughBlocks.fetch_add(1, std::memory_order_relaxed);
+  if (!used)
     output.makeCopyOf(input);
-    return false;
+  return used;
+}
+
+bool RealtimePitchProcessor::processBlockOffline(
+    juce::AudioBuffer<float> &input, juce::AudioBuffer<float> &output,
+    const juce::AudioPlayHead::PositionInfo *posInfo) {
+  double start = 0.0;
+  if (posInfo) {
+    if (auto time = posInfo->getTimeInSamples())
+      start = static_cast<double>(*time) / sampleRate;
+    else if (auto time = posInfo->getTimeInSeconds())
+      start = *time;
+  }
+  const double end =
+      start + static_cast<double>(input.getNumSamples()) / sampleRate;
+
+  {
+    std::unique_lock<std::mutex> lock(offlineMutex);
+    if (!offlineGaveUp && !isRenderSettled(start, end)) {
+      offlineWaitPosition.store(start);
+      DBG("RealtimePitchProcessor: offline render waiting at " << start);
+      if (!offlineWake.wait_for(
+              lock, std::chrono::milliseconds(offlineWaitTimeoutMs),
+              [&]() { return isRenderSettled(start, end); })) {
+        DBG("RealtimePitchProcessor: offline wait timed out, passing through");
+        offlineGaveUp = true;
+      }
+      offlineWaitPosition.store(-1.0);
+    }
+  }
+  return processBlock(input, output, posInfo);
+}
+
+bool RealtimePitchProcessor::processBlockLookahead(
+    juce::AudioBuffer<float> &input, juce::AudioBuffer<float> &output,
+    const juce::AudioPlayHead::PositionInfo *posInfo) {
+  REALTIME_SCOPE("RealtimePitchProcessor::processBlockLookahead");
+  auto *lookahead = liveCorrector.load();
+  if (lookahead == nullptr)
+    return processBlock(input, output, posInfo);
+
+  juce::int64 posSamples = 0;
+  if (posInfo) {
+    if (auto time = posInfo->getTimeInSamples())
+      posSamples = *time;
+    else if (auto time = posInfo->getTimeInSeconds())
+      posSamples = static_cast<juce::int64>(std::llround(*time * sampleRate));
   }
+  lookahead->process(input, output, posSamples);
 
+  // What this block plays is the timeline one latency earlier
+  const juce::int64 playedStart = posSamples - lookahead->getLatencySamples();
   const int numSamples = output.getNumSamples();
-  const int numChannels = output.getNumChannels();
-  auto posSamples = static_cast<juce::int64>(pos * sampleRate);
+  const double start = static_cast<double>(playedStart) / sampleRate;
+  position.store(std::max(0.0, start));
+  if (playedStart < 0 ||
+      !isRenderSettled(start, start + numSamples / sampleRate))
+    return false;
 
-  // Copy from processed buffer
+  // The render only where it covers the whole block; the corrector's output
+  // stays otherwise
+  callbackCounter.fetch_add(1);
+  const RenderSnapshot *buffer = liveBuffer.load();
+  const bool used = buffer != nullptr &&
+                    buffer->getNumSamples() >= playedStart + numSamples &&
+                    copyFromProcessed(buffer, output, playedStart);
+  callbackCounter.fetch_add(1);
+  return used;
+}
+
+void RealtimePitchProcessor::setRenderPending(double startSeconds,
+                                              double endSeconds) {
   {
-    const juce::ScopedLock sl(bufferLock);
+    std::lock_guard<RealtimeCheck::Mutex> lock(offlineMutex);
+    pendingStart.store(startSeconds);
+    pendingEnd.store(endSeconds);
+  }
+  // The edit is in the project already; correct towards it until it renders
+  if (startSeconds < endSeconds) {
+    const RealtimeCheck::ScopedLock sl(bufferLock);
+    updateLookaheadCurves();
+  }
+  notifyOfflineWaiters();
+}
 
-    if (processedBuffer.getNumSamples() == 0) {
-      output.makeCopyOf(input);
-      return false;
-    }
+void RealtimePitchProcessor::clearRenderPending() {
+  setRenderPending(0.0, 0.0);
+}
 
-    int available =
-        processedBuffer.getNumSamples() - static_cast<int>(posSamples);
-    if (posSamples < 0 || available <= 0) {
-      output.makeCopyOf(input);
-      return false;
-    }
+bool RealtimePitchProcessor::isRenderSettled(double startSeconds,
+                                             double endSeconds) const {
+  const double pendingFrom = pendingStart.load();
+  const double pendingTo = pendingEnd.load();
+  const bool overlapsPending = pendingFrom < pendingTo &&
+                               startSeconds < pendingTo &&
+                               endSeconds > pendingFrom;
+  return !overlapsPending && renderCurrent.load();
+}
 
-    int toCopy = std::min(numSamples, available);
-    int channelsToCopy =
-        std::min(numChannels, processedBuffer.getNumChannels());
+void RealtimePitchProcessor::notifyOfflineWaiters() {
+  {
+    std::lock_guard<RealtimeCheck::Mutex> lock(offlineMutex);
+    offlineGaveUp = false;
+  }
+  offlineWake.notify_all();
+}
 
-    for (int ch = 0; ch < channelsToCopy; ++ch) {
-      output.copyFrom(ch, 0, processedBuffer, ch, static_cast<int>(posSamples),
-                      toCopy);
-      if (toCopy < numSamples)
-        output.clear(ch, toCopy, numSamples - toCopy);
-    }
+bool RealtimePitchProcessor::copyFromProcessed(
+    const RenderSnapshot *buffer, juce::AudioBuffer<float> &output,
+    juce::int64 posSamples) const {
+  const int numSamples = output.getNumSamples();
+  const int numChannels = output.getNumChannels();
+
+  int available = buffer->getNumSamples() - static_cast<int>(posSamples);
+  if (posSamples < 0 || available <= 0)
+    return false;
+
+  int toCopy = std::min(numSamples, available);
+  int channelsToCopy = std::min(numChannels, buffer->getNumChannels());
 
-    for (int ch = channelsToCopy; ch < numChannels; ++ch)
-      output.clear(ch, 0, numSamples);
+  for (int ch = 0; ch < channelsToCopy; ++ch) {
+    buffer->read(ch, static_cast<int>(posSamples), toCopy,
+                 output.getWritePointer(ch));
+    if (toCopy < numSamples)
+      output.clear(ch, toCopy, numSamples - toCopy);
   }
 
+  for (int ch = channelsToCopy; ch < numChannels; ++ch)
+    output.clear(ch, 0, numSamples);
   return true;
 }
 
-void RealtimePitchProcessor::invalidate() {
-  ready = false;
+void RealtimePitchProcessor::setProcessedBuffer(RenderSnapshot::Ptr buffer) {
+  if (buffer && buffer->getNumSamples() == 0)
+    buffer = nullptr;
+
+  auto previous = std::move(processedBuffer);
+  processedBuffer = std::move(buffer);
+  liveBuffer.store(processedBuffer.get());
+  ready = processedBuffer != nullptr;
+
+  const uint64_t count = callbackCounter.load();
+  // Even: no block was running, and any later one sees the new pointer
+  if (previous && previous != processedBuffer && (count & 1) != 0)
+    retiredBuffers.push_back({std::move(previous), count});
+  retiredBuffers.erase(
+      std::remove_if(retiredBuffers.begin(), retiredBuffers.end(),
+                     [count](const RetiredBuffer &retired) {
+                       return retired.callbackCount != count;
+                     }),
+      retiredBuffers.end());
+
+  DBG("RealtimePitchProcessor: passthrough blocks so far: "
+      << static_cast<juce::int64>(passthroughBlocks.load()));
+}
 
+void RealtimePitchProcessor::updateLookaheadCurves() {
+  if (!corrector)
+    return;
+  if (!project || project->getAudioData().basePitch.empty()) {
+    corrector->setCurves(nullptr);
+    return;
+  }
+
+  const auto &audioData = project->getAudioData();
+  auto curves = std::make_shared<StreamingCorrector::Curves>();
+  const int totalFrames = static_cast<int>(audioData.basePitch.size());
+  curves->hopSize = HOP_SIZE;
+  curves->sampleRate = audioData.sampleRate;
+  curves->targetF0.resize(static_cast<size_t>(totalFrames));
+  project->getAdjustedF0ForRange(0, totalFrames, curves->targetF0.data());
+
+  // The input is the recording, whose pitch the notes kept from detection at
+  // their source positions. Rebuilt only when notes came or went; the count
+  // catches segmentation, which fills the notes without posting.
+  const auto &notes = project->getNotes();
+  if (lookaheadSourceStale.exchange(false) ||
+      lookaheadSourceF0.size() != static_cast<size_t>(totalFrames) ||
+      lookaheadSourceNoteCount != notes.size()) {
+    lookaheadSourceF0.assign(static_cast<size_t>(totalFrames), 0.0f);
+    for (const auto &note : notes) {
+      const auto &detected = note.getF0Values();
+      const int start = std::max(0, note.getSrcStartFrame());
+      const int count = std::min({static_cast<int>(detected.size()),
+                                  note.getSrcDurationFrames(),
+                                  totalFrames - start});
+      if (count > 0)
+        std::copy_n(detected.begin(), count,
+                    lookaheadSourceF0.begin() + start);
+    }
+    lookaheadSourceNoteCount = notes.size();
+  }
+  curves->sourceF0 = lookaheadSourceF0;
+  corrector->setCurves(std::move(curves));
+}
+
+void RealtimePitchProcessor::invalidate() {
   DBG("RealtimePitchProcessor::invalidate() called");
 
   Project *proj = nullptr;
-  juce::AudioBuffer<float> waveformSnapshot;
-  int srcSampleRate = 0;
-
   {
-    const juce::ScopedLock sl(bufferLock);
+    const RealtimeCheck::ScopedLock sl(bufferLock);
     proj = project;
-    if (proj) {
-      auto &audioData = proj->getAudioData();
-      waveformSnapshot.makeCopyOf(audioData.waveform);
-      srcSampleRate = audioData.sampleRate;
-    }
+    updateLookaheadCurves();
   }
 
   if (!proj) {
     DBG("  -> Skipped: project is null");
+    const RealtimeCheck::ScopedLock sl(bufferLock);
+    latestSource = nullptr;
+    latestTargetRate = 0;
+    setProcessedBuffer(nullptr);
+    renderCurrent.store(true);
+    notifyOfflineWaiters();
     return;
   }
 
+  // Pointer copy of the shared tiles, not of the samples
+  auto waveformSnapshot = proj->getAudioData().getRenderSnapshot();
+  const int srcSampleRate = waveformSnapshot->getSampleRate();
+
   // Safety check: verify waveform has valid dimensions before accessing
-  const int numSamples = waveformSnapshot.getNumSamples();
-  const int numChannels = waveformSnapshot.getNumChannels();
+  const int numSamples = waveformSnapshot->getNumSamples();
+  const int numChannels = waveformSnapshot->getNumChannels();
 
   if (numSamples <= 0 || numChannels <= 0) {
     DBG("  -> Skipped: waveform is empty or invalid (samples="
         << numSamples << ", channels=" << numChannels << ")");
+    const RealtimeCheck::ScopedLock sl(bufferLock);
+    latestSource = nullptr;
+    latestTargetRate = 0;
+    setProcessedBuffer(nullptr);
+    renderCurrent.store(true);
+    notifyOfflineWaiters();
     return;
   }
 
   // Use the already-synthesized waveform from project (updated by
   // resynthesizeIncremental) This avoids duplicate synthesis and ensures
   // consistency with standalone mode
+  waveformSnapshot = gainStage.apply(
+      std::move(waveformSnapshot),
+      GainLane::fromNotes(proj->getNotes(), proj->getAudioData().getNumFrames(),
+                          HOP_SIZE));
   const int dstSampleRate = static_cast<int>(sampleRate);
 
   DBG("  -> srcSampleRate=" << srcSampleRate
                             << ", dstSampleRate=" << dstSampleRate);
 
+  const RealtimeCheck::ScopedLock sl(bufferLock);
+  if (waveformSnapshot == latestSource && dstSampleRate == latestTargetRate)
+    return;
+  latestTargetRate = dstSampleRate;
+
   if (srcSampleRate == dstSampleRate || srcSampleRate <= 0) {
     // No resampling needed
-    const juce::ScopedLock sl(bufferLock);
-    processedBuffer.makeCopyOf(waveformSnapshot);
-    ready = true;
+    latestSource = waveformSnapshot;
+    setProcessedBuffer(waveformSnapshot);
+    renderCurrent.store(true);
+    notifyOfflineWaiters();
     DBG("  -> Using project waveform directly, samples="
-        << processedBuffer.getNumSamples());
-  } else {
-    // Resample to host sample rate
-    const double ratio = static_cast<double>(srcSampleRate) / dstSampleRate;
-    const int srcSamples = waveformSnapshot.getNumSamples();
-    const int dstSamples = static_cast<int>(srcSamples / ratio);
-    const int numChannels = waveformSnapshot.getNumChannels();
-
-    juce::AudioBuffer<float> resampled(numChannels, dstSamples);
-
-    for (int ch = 0; ch < numChannels; ++ch) {
-      const float *src = waveformSnapshot.getReadPointer(ch);
-      float *dst = resampled.getWritePointer(ch);
-
-      for (int i = 0; i < dstSamples; ++i) {
-        const double srcPos = i * ratio;
-        const int srcIndex = static_cast<int>(srcPos);
-        const double frac = srcPos - srcIndex;
-
-        if (srcIndex + 1 < srcSamples)
-          dst[i] = static_cast<float>(src[srcIndex] * (1.0 - frac) +
-                                      src[srcIndex + 1] * frac);
-        else if (srcIndex < srcSamples)
-          dst[i] = src[srcIndex];
-        else
-          dst[i] = 0.0f;
-      }
-    }
-
-    const juce::ScopedLock sl(bufferLock);
-    processedBuffer = std::move(resampled);
-    ready = true;
-    DBG("  -> Resampled from " << srcSamples << " to " << dstSamples
-                               << " samples");
-  }
-}
-
-void RealtimePitchProcessor::startComputation() {
-  // Cancel previous computation
-  cancelCompute = true;
-  if (computeThread && computeThread->joinable()) {
-    // Don't block - start new thread that waits for old one
-    auto oldThread = std::move(computeThread);
-    cancelCompute = false;
-    computing = true;
-
-    computeThread = std::make_unique<std::thread>(
-        [this, old = std::move(oldThread)]() mutable {
-          if (old && old->joinable())
-            old->join();
-          if (!cancelCompute.load())
-            computeInBackground();
-        });
-  } else {
-    cancelCompute = false;
-    computing = true;
-    computeThread =
-        std::make_unique<std::thread>([this]() { computeInBackground(); });
-  }
-}
-
-void RealtimePitchProcessor::computeInBackground() {
-  DBG("RealtimePitchProcessor::computeInBackground() started");
-
-  Project *proj = nullptr;
-  Vocoder *voc = nullptr;
-  std::vector<std::vector<float>> melSnapshot;
-  std::vector<float> adjustedF0Snapshot;
-  int numChannelsSnapshot = 1;
-  float volumeDbSnapshot = 0.0f;
-
-  {
-    const juce::ScopedLock sl(bufferLock);
-    proj = project;
-    voc = vocoder;
-
-    if (proj) {
-      auto &audioData = proj->getAudioData();
-      melSnapshot = audioData.melSpectrogram;
-      numChannelsSnapshot = std::max(1, audioData.waveform.getNumChannels());
-      volumeDbSnapshot = proj->getVolume();
-      adjustedF0Snapshot = proj->getAdjustedF0();
-    }
-  }
-
-  if (!proj || !voc || !voc->isLoaded()) {
-    DBG("  -> Aborted: project/vocoder not ready");
-    computing = false;
-    return;
-  }
-
-  if (melSnapshot.empty()) {
-    DBG("  -> Aborted: melSpectrogram empty");
-    computing = false;
-    return;
-  }
-
-  DBG("  -> adjustedF0 size=" << adjustedF0Snapshot.size()
-                              << ", melSpec size=" << melSnapshot.size());
-
-  if (adjustedF0Snapshot.empty() ||
-      adjustedF0Snapshot.size() != melSnapshot.size()) {
-    DBG("  -> Aborted: F0 size mismatch");
-    computing = false;
-    return;
-  }
-
-  if (cancelCompute.load()) {
-    DBG("  -> Cancelled before synthesis");
-    computing = false;
-    return;
-  }
-
-  // Synthesize
-  DBG("  -> Starting vocoder synthesis...");
-  std::vector<float> synthesized;
-  try {
-    synthesized = voc->infer(melSnapshot, adjustedF0Snapshot);
-  } catch (...) {
-    DBG("  -> Vocoder exception!");
-    computing = false;
-    return;
-  }
-
-  DBG("  -> Synthesized " << synthesized.size() << " samples");
-
-  if (cancelCompute.load() || synthesized.empty()) {
-    DBG("  -> Cancelled or empty result");
-    computing = false;
+        << processedBuffer->getNumSamples());
     return;
   }
 
-  // Create output buffer
-  int numChannels = numChannelsSnapshot;
-  int numSamples = static_cast<int>(synthesized.size());
-
-  juce::AudioBuffer<float> output(numChannels, numSamples);
-  for (int ch = 0; ch < numChannels; ++ch)
-    for (int i = 0; i < numSamples; ++i)
-      output.setSample(ch, i, synthesized[i]);
-
-  // Apply volume
-  float volumeDb = volumeDbSnapshot;
-  if (volumeDb != 0.0f)
-    output.applyGain(std::pow(10.0f, volumeDb / 20.0f));
-
-  // Update buffer directly (with lock)
-  if (!cancelCompute.load()) {
-    const juce::ScopedLock sl(bufferLock);
-    processedBuffer = std::move(output);
-    ready = true;
-    DBG("  -> Buffer updated, ready=true, samples="
-        << processedBuffer.getNumSamples());
+  // An in-place re-render of the same clip keeps playing the previous
+  // conversion until the new one lands; anything else passes through
+  const bool sameClip =
+      latestSource && latestSource->getSampleRate() == srcSampleRate &&
+      latestSource->getNumSamples() == numSamples &&
+      latestSource->getNumChannels() == numChannels && processedBuffer &&
+      processedBuffer->getSampleRate() == dstSampleRate;
+  if (!sameClip) {
+    setProcessedBuffer(nullptr);
   }
-  computing = false;
+  latestSource = waveformSnapshot;
+  renderCurrent.store(false);
+  rateCache->request(std::move(waveformSnapshot), dstSampleRate);
 }
@@ -2,14 +2,30 @@
 
 #include "../JuceHeader.h"
 #include "../Models/Project.h"
+#include "../Utils/RealtimeCheck.h"
+#include "Engine/GainStage.h"
+#include "Engine/PlaybackRateCache.h"
+#include "Synthesis/StreamingCorrector.h"
 #include "Vocoder.h"
 #include <atomic>
+#include <condition_variable>
+#include <cstdint>
 #include <memory>
-#include <thread>
+#include <mutex>
+#include <vector>
 
 /**
  * Real-time pitch correction processor
- * Pre-computes processed audio in background, provides real-time playback
+ * Plays the project's rendered waveform at the host rate. The render is
+ * shared tile by tile with the project; when the host runs at another rate,
+ * a PlaybackRateCache keeps a converted copy in which only the tiles fed by
+ * changed source tiles are regenerated.
+ *
+ * Offline renders (bounces) go through processBlockOffline(), which waits
+ * for pending analysis or synthesis of the block instead of passing the
+ * input through. In lookahead mode, processBlockLookahead() plays
+ * everything getLookaheadLatency() late and covers renders still pending
+ * with a StreamingCorrector.
  */
 class RealtimePitchProcessor {
 public:
@@ -21,7 +37,7 @@ public:
     void prepareToPlay(double sampleRate, int samplesPerBlock);
 
     /**
-     * Process audio block
+     * Process audio block. Wait-free: never locks or frees memory.
      * @return true if processed audio was used, false if passthrough
      */
     bool processBlock(juce::AudioBuffer<float>& input,
@@ -29,7 +45,51 @@ public:
                       const juce::AudioPlayHead::PositionInfo* positionInfo);
 
     /**
-     * Trigger re-computation (call when project data changes)
+     * Offline render: wait until the render is up to date where this block
+     * plays, then processBlock(). Blocks the calling thread, so only for
+     * hosts rendering non-realtime. After offlineWaitTimeoutMs without the
+     * render settling it stops waiting until the render changes again.
+     */
+    bool processBlockOffline(juce::AudioBuffer<float>& input,
+                             juce::AudioBuffer<float>& output,
+                             const juce::AudioPlayHead::PositionInfo* positionInfo);
+
+    /**
+     * Message thread: the render of [startSeconds, endSeconds) is about to
+     * change (analysis or synthesis started). Offline blocks overlapping it
+     * wait until clearRenderPending(), which the caller makes after the
+     * invalidate() that picks up the result, or when the job failed.
+     */
+    void setRenderPending(double startSeconds, double endSeconds);
+    void clearRenderPending();
+
+    /**
+     * Message thread: turn lookahead mode on or off. The host must be told
+     * the latency (getLookaheadLatency()) while it is on.
+     */
+    void setLookaheadEnabled(bool enabled);
+    bool isLookaheadActive() const { return liveCorrector.load() != nullptr; }
+    /** Latency of lookahead mode at the prepared rate and block size. */
+    int getLookaheadLatency() const;
+
+    /**
+     * Lookahead mode: output the audio for getLookaheadLatency() samples
+     * before this block. Where the render there is settled it plays the
+     * render, elsewhere the input corrected towards the edited pitch.
+     * Wait-free like processBlock().
+     * @return true if the render was used for the whole block
+     */
+    bool processBlockLookahead(juce::AudioBuffer<float>& input,
+                               juce::AudioBuffer<float>& output,
+                               const juce::AudioPlayHead::PositionInfo* positionInfo);
+
+    /** Position an offline render is waiting at, or negative. */
+    double getOfflineWaitPosition() const { return offlineWaitPosition.load(); }
+
+    /**
+     * Pick up the project's current render (call when project data changes),
+     * with the notes' gain lane applied. An in-place re-render keeps the
+     * previous buffer audible until its changed tiles are converted.
      */
     void invalidate();
 
@@ -37,20 +97,77 @@ public:
     double getPosition() const { return position.load(); }
     void setPosition(double positionSeconds) { position.store(positionSeconds); }
 
+    /** Blocks passed through because no render was available to play. */
+    uint64_t getPassthroughBlockCount() const { return passthroughBlocks.load(); }
+
 private:
-    void startComputation();
-    void computeInBackground();
+    bool copyFromProcessed(const RenderSnapshot* buffer, juce::AudioBuffer<float>& output,
+                           juce::int64 posSamples) const;
+    // Caller holds bufferLock
+    void setProcessedBuffer(RenderSnapshot::Ptr buffer);
+    // Whether an offline block at [start, end) seconds can play now
+    bool isRenderSettled(double startSeconds, double endSeconds) const;
+    // Wake processBlockOffline() after the render or pending range changed
+    void notifyOfflineWaiters();
+    // Hand the project's pitch curves to the lookahead corrector, if any.
+    // Caller holds bufferLock.
+    void updateLookaheadCurves();
 
     Project* project = nullptr;
     Vocoder* vocoder = nullptr;
     double sampleRate = 44100.0;
 
-    juce::AudioBuffer<float> processedBuffer;
+    // Shares tiles with the project's render snapshot when no resampling is needed
+    RenderSnapshot::Ptr processedBuffer;
+    GainStage gainStage;  // Message thread (invalidate())
+    // Render the processed buffer is (or will be) made from; conversions of
+    // anything older are dropped
+    RenderSnapshot::Ptr latestSource;
+    int latestTargetRate = 0;
     std::atomic<bool> ready{false};
-    std::atomic<bool> computing{false};
-    std::atomic<bool> cancelCompute{false};
     std::atomic<double> position{0.0};
 
-    juce::CriticalSection bufferLock;
-    std::unique_ptr<std::thread> computeThread;
+    // processBlock reads processedBuffer through this raw pointer and never
+    // takes bufferLock. A replaced buffer is kept in retiredBuffers until the
+    // block that may still be reading it has returned (callbackCounter is
+    // odd while processBlock runs).
+    struct RetiredBuffer {
+        RenderSnapshot::Ptr buffer;
+        uint64_t callbackCount = 0;
+    };
+    std::atomic<const RenderSnapshot*> liveBuffer{nullptr};
+    std::atomic<uint64_t> callbackCounter{0};
+    std::vector<RetiredBuffer> retiredBuffers;
+    std::atomic<uint64_t> passthroughBlocks{0};
+
+    // Offline waits. renderCurrent is false while a conversion of
+    // latestSource is outstanding.
+    static constexpr int offlineWaitTimeoutMs = 60000;
+    std::atomic<bool> renderCurrent{true};
+    std::atomic<double> offlineWaitPosition{-1.0};
+    mutable RealtimeCheck::Mutex offlineMutex;
+    std::condition_variable offlineWake;
+    // Written under offlineMutex; atomic for processBlockLookahead()
+    std::atomic<double> pendingStart{0.0};
+    std::atomic<double> pendingEnd{0.0};
+    bool offlineGaveUp = false;
+
+    // Lookahead mode. The corrector is only replaced while audio is stopped
+    // (prepareToPlay, destruction); turning the mode off just unpublishes it.
+    static constexpr int lookaheadChannels = 2;
+    int preparedBlockSize = 512;
+    bool lookaheadEnabled = false;  // Guarded by bufferLock
+    std::unique_ptr<StreamingCorrector> corrector;
+    std::atomic<StreamingCorrector*> liveCorrector{nullptr};
+    // Source F0 of the lookahead curves, kept between updates (bufferLock);
+    // the project's note changes mark it stale on the message thread
+    std::vector<float> lookaheadSourceF0;
+    size_t lookaheadSourceNoteCount = 0;
+    std::atomic<bool> lookaheadSourceStale{true};
+    NoteChangeFeed::Subscription noteChangeSubscription;
+
+    // Guards the non-audio-thread state: project, buffers, retiredBuffers.
+    // Checked, so a lock from processBlock() shows up in Debug builds
+    RealtimeCheck::CriticalSection bufferLock;
+    std::unique_ptr<PlaybackRateCache> rateCache;  // Last: its worker calls back into this
 };
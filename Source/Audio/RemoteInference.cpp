@@ -0,0 +1,523 @@
+#include "RemoteInference.h"
+#include "../Utils/AppLogger.h"
+#include "../Utils/HalfFloat.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <deque>
+#include <iterator>
+
+namespace {
+template <typename T> void appendValue(std::vector<uint8_t> &out, T value) {
+  uint8_t bytes[sizeof(T)];
+  std::memcpy(bytes, &value, sizeof(T));
+  if (juce::ByteOrder::isBigEndian())
+    std::reverse(bytes, bytes + sizeof(T));
+  out.insert(out.end(), bytes, bytes + sizeof(T));
+}
+
+template <typename T>
+void appendValues(std::vector<uint8_t> &out, const T *values, size_t count) {
+  if (count == 0)
+    return;
+  const size_t offset = out.size();
+  out.resize(offset + count * sizeof(T));
+  std::memcpy(out.data() + offset, values, count * sizeof(T));
+  if (juce::ByteOrder::isBigEndian())
+    for (size_t i = 0; i < count; ++i)
+      std::reverse(out.data() + offset + i * sizeof(T),
+                   out.data() + offset + (i + 1) * sizeof(T));
+}
+
+template <typename T> T readValue(const uint8_t *source) {
+  uint8_t bytes[sizeof(T)];
+  std::memcpy(bytes, source, sizeof(T));
+  if (juce::ByteOrder::isBigEndian())
+    std::reverse(bytes, bytes + sizeof(T));
+  T value;
+  std::memcpy(&value, bytes, sizeof(T));
+  return value;
+}
+
+template <typename T>
+void readValues(const uint8_t *source, T *values, size_t count) {
+  if (count == 0)
+    return;
+  std::memcpy(values, source, count * sizeof(T));
+  if (juce::ByteOrder::isBigEndian())
+    for (size_t i = 0; i < count; ++i)
+      values[i] = readValue<T>(source + i * sizeof(T));
+}
+
+// Room for the header, written by call() once the id is known
+std::vector<uint8_t> startMessage(size_t payloadBytes) {
+  std::vector<uint8_t> message(RemoteProtocol::headerBytes);
+  message.reserve(RemoteProtocol::headerBytes + payloadBytes);
+  return message;
+}
+
+bool isCancelled(const std::atomic<bool> *cancelFlag) {
+  return cancelFlag != nullptr && cancelFlag->load();
+}
+
+bool readFully(juce::StreamingSocket &socket, void *dest, size_t numBytes) {
+  return numBytes == 0 ||
+         socket.read(dest, static_cast<int>(numBytes), true) ==
+             static_cast<int>(numBytes);
+}
+
+bool writeFully(juce::StreamingSocket &socket, const std::vector<uint8_t> &data) {
+  return socket.write(data.data(), static_cast<int>(data.size())) ==
+         static_cast<int>(data.size());
+}
+} // namespace
+
+//==============================================================================
+void RemoteProtocol::writeHeader(uint8_t *dest, const Header &header) {
+  std::vector<uint8_t> bytes;
+  bytes.reserve(headerBytes);
+  appendValue(bytes, header.magic);
+  appendValue(bytes, header.version);
+  appendValue(bytes, static_cast<uint8_t>(header.op));
+  appendValue(bytes, static_cast<uint8_t>(header.status));
+  appendValue(bytes, header.requestId);
+  appendValue(bytes, header.payloadBytes);
+  std::memcpy(dest, bytes.data(), headerBytes);
+}
+
+bool RemoteProtocol::readHeader(const uint8_t *source, uint32_t magic,
+                                Header &header) {
+  header.magic = readValue<uint32_t>(source);
+  header.version = readValue<uint16_t>(source + 4);
+  header.op = static_cast<Op>(source[6]);
+  header.status = static_cast<Status>(source[7]);
+  header.requestId = readValue<uint32_t>(source + 8);
+  header.payloadBytes = readValue<uint32_t>(source + 12);
+  return header.magic == magic && header.version == version &&
+         header.payloadBytes <= maxPayloadBytes;
+}
+
+//==============================================================================
+RemoteInference::RemoteInference(const juce::String &endpoint,
+                                 int maxRequestsInFlight,
+                                 std::function<void()> connectFailed)
+    : maxInFlight(juce::jmax(1, maxRequestsInFlight)),
+      onConnectFailed(std::move(connectFailed)) {
+  const auto trimmed = endpoint.trim();
+  const int colon = trimmed.lastIndexOfChar(':');
+  if (colon > 0 && trimmed.substring(colon + 1).containsOnly("0123456789")) {
+    host = trimmed.substring(0, colon);
+    port = trimmed.substring(colon + 1).getIntValue();
+  } else {
+    host = trimmed;
+  }
+}
+
+RemoteInference::~RemoteInference() {
+  std::shared_ptr<juce::StreamingSocket> connection;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    closing = true;
+    connection = socket;
+  }
+  if (connection)
+    connection->close();
+  if (reader.joinable())
+    reader.join();
+}
+
+bool RemoteInference::isAvailable() const {
+  std::lock_guard<std::mutex> lock(mutex);
+  return socket != nullptr ||
+         juce::Time::getMillisecondCounterHiRes() >= retryAfterMs;
+}
+
+bool RemoteInference::vocode(const MelView &mel, const float *f0,
+                             size_t startFrame, size_t numFrames,
+                             int sampleRate, int hopSize,
+                             const std::atomic<bool> *cancelFlag,
+                             std::vector<float> &audio) {
+  if (numFrames == 0 || startFrame + numFrames > mel.size())
+    return false;
+
+  const size_t numValues = numFrames * static_cast<size_t>(mel.getNumMels());
+  auto message = startMessage(12 + numValues * 2 + numFrames * 4);
+  appendValue(message, static_cast<uint32_t>(numFrames));
+  appendValue(message, static_cast<uint16_t>(mel.getNumMels()));
+  appendValue(message, static_cast<uint16_t>(hopSize));
+  appendValue(message, static_cast<uint32_t>(sampleRate));
+  std::vector<uint16_t> halves(numValues);
+  HalfFloat::fromFloat(mel[startFrame], halves.data(), numValues);
+  appendValues(message, halves.data(), numValues);
+  appendValues(message, f0 + startFrame, numFrames);
+
+  if (!call(RemoteProtocol::Op::Vocode, message, cancelFlag, audio))
+    return false;
+  if (audio.size() != numFrames * static_cast<size_t>(hopSize)) {
+    LOG_WARNING("RemoteInference: " + juce::String(audio.size()) +
+                " samples for " + juce::String(numFrames) + " frames");
+    return false;
+  }
+  return true;
+}
+
+bool RemoteInference::extractPitch(const float *audio16k, int numSamples,
+                                   float threshold,
+                                   const std::atomic<bool> *cancelFlag,
+                                   std::vector<float> &f0) {
+  if (numSamples <= 0)
+    return false;
+
+  auto message = startMessage(8 + static_cast<size_t>(numSamples) * 4);
+  appendValue(message, static_cast<uint32_t>(numSamples));
+  appendValue(message, threshold);
+  appendValues(message, audio16k, static_cast<size_t>(numSamples));
+  return call(RemoteProtocol::Op::Pitch, message, cancelFlag, f0) &&
+         !f0.empty();
+}
+
+bool RemoteInference::call(RemoteProtocol::Op op, std::vector<uint8_t> &message,
+                           const std::atomic<bool> *cancelFlag,
+                           std::vector<float> &values) {
+  if (message.size() - RemoteProtocol::headerBytes >
+      RemoteProtocol::maxPayloadBytes)
+    return false;
+
+  auto request = std::make_shared<Pending>();
+  std::shared_ptr<juce::StreamingSocket> connection;
+  RemoteProtocol::Header header;
+  bool connectFailed = false;
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (numInFlight >= maxInFlight) {
+      if (isCancelled(cancelFlag) || closing)
+        return false;
+      condition.wait_for(lock, std::chrono::milliseconds(5));
+    }
+    if (closing)
+      return false;
+    if (!connectLocked(connectFailed)) {
+      lock.unlock();
+      if (connectFailed && onConnectFailed)
+        onConnectFailed();
+      return false;
+    }
+    header.requestId = nextRequestId++;
+    pending[header.requestId] = request;
+    ++numInFlight;
+    connection = socket;
+  }
+
+  header.magic = RemoteProtocol::requestMagic;
+  header.op = op;
+  header.payloadBytes =
+      static_cast<uint32_t>(message.size() - RemoteProtocol::headerBytes);
+  RemoteProtocol::writeHeader(message.data(), header);
+  bool sent = false;
+  {
+    std::lock_guard<std::mutex> lock(writeMutex);
+    sent = writeFully(*connection, message);
+  }
+  // The reader sees the closed socket and fails every pending request
+  if (!sent)
+    connection->close();
+
+  std::unique_lock<std::mutex> lock(mutex);
+  const double deadline =
+      juce::Time::getMillisecondCounterHiRes() + requestTimeoutMs;
+  while (!request->done && !isCancelled(cancelFlag)) {
+    if (juce::Time::getMillisecondCounterHiRes() > deadline) {
+      LOG_WARNING("RemoteInference: no answer from " + getEndpoint() +
+                  " in " + juce::String(requestTimeoutMs / 1000) + " s");
+      connection->close();
+      break;
+    }
+    condition.wait_for(lock, std::chrono::milliseconds(5));
+  }
+  pending.erase(header.requestId);
+  --numInFlight;
+  condition.notify_all();
+  if (!request->done || !request->ok)
+    return false;
+  values = std::move(request->values);
+  return true;
+}
+
+bool RemoteInference::connectLocked(bool &attemptFailed) {
+  if (socket)
+    return true;
+  if (host.isEmpty() ||
+      juce::Time::getMillisecondCounterHiRes() < retryAfterMs)
+    return false;
+
+  // The last reader cleared socket as its final step under the lock
+  if (reader.joinable())
+    reader.join();
+
+  auto connection = std::make_shared<juce::StreamingSocket>();
+  if (!connection->connect(host, port, connectTimeoutMs)) {
+    attemptFailed = true;
+    backOffLocked("cannot connect");
+    return false;
+  }
+  LOG("RemoteInference: connected to " + getEndpoint());
+  socket = connection;
+  reader = std::thread([this, connection]() { readResponses(connection); });
+  return true;
+}
+
+void RemoteInference::backOffLocked(const juce::String &reason) {
+  backoffMs = backoffMs == 0 ? minBackoffMs
+                             : juce::jmin(backoffMs * 2, maxBackoffMs);
+  retryAfterMs = juce::Time::getMillisecondCounterHiRes() + backoffMs;
+  LOG_WARNING("RemoteInference: " + getEndpoint() + " " + reason +
+              ", inferring locally for " + juce::String(backoffMs / 1000) +
+              " s");
+}
+
+void RemoteInference::readResponses(
+    std::shared_ptr<juce::StreamingSocket> connection) {
+  juce::Thread::setCurrentThreadName("HachiTune remote inference");
+
+  uint8_t headerBytes[RemoteProtocol::headerBytes];
+  std::vector<uint8_t> payload;
+  for (;;) {
+    RemoteProtocol::Header header;
+    if (!readFully(*connection, headerBytes, sizeof(headerBytes)) ||
+        !RemoteProtocol::readHeader(headerBytes, RemoteProtocol::responseMagic,
+                                    header) ||
+        header.payloadBytes % sizeof(float) != 0)
+      break;
+    payload.resize(header.payloadBytes);
+    if (!readFully(*connection, payload.data(), payload.size()))
+      break;
+
+    std::vector<float> values(payload.size() / sizeof(float));
+    readValues(payload.data(), values.data(), values.size());
+
+    std::lock_guard<std::mutex> lock(mutex);
+    const bool ok = header.status == RemoteProtocol::Status::Ok;
+    if (ok)
+      backoffMs = 0;
+    else
+      LOG_WARNING("RemoteInference: request " +
+                  juce::String(header.requestId) + " failed with status " +
+                  juce::String(static_cast<int>(header.status)));
+    // Requests that timed out or were cancelled are no longer pending
+    auto it = pending.find(header.requestId);
+    if (it != pending.end()) {
+      it->second->ok = ok;
+      it->second->values = std::move(values);
+      it->second->done = true;
+    }
+    condition.notify_all();
+  }
+
+  connection->close();
+  std::lock_guard<std::mutex> lock(mutex);
+  socket.reset();
+  for (auto &entry : pending)
+    entry.second->done = true;
+  if (!closing)
+    backOffLocked("disconnected");
+  condition.notify_all();
+}
+
+//==============================================================================
+RemoteInferenceServer::RemoteInferenceServer(Handlers requestHandlers,
+                                             int maxConcurrentRequests)
+    : handlers(std::move(requestHandlers)),
+      maxConcurrent(juce::jmax(1, maxConcurrentRequests)) {}
+
+RemoteInferenceServer::~RemoteInferenceServer() {
+  stop();
+  reapConnections(true);
+}
+
+bool RemoteInferenceServer::run(int port, const juce::String &bindAddress) {
+  {
+    std::lock_guard<std::mutex> lock(connectionsMutex);
+    listener = std::make_unique<juce::StreamingSocket>();
+    if (!listener->createListener(port, bindAddress))
+      return false;
+  }
+  LOG("RemoteInferenceServer: listening on " + bindAddress + ":" +
+      juce::String(port));
+
+  while (!stopping.load()) {
+    std::unique_ptr<juce::StreamingSocket> client(
+        listener->waitForNextConnection());
+    if (client == nullptr)
+      break;
+    reapConnections(false);
+    LOG("RemoteInferenceServer: client " + client->getHostName());
+
+    auto connection = std::make_unique<Connection>();
+    connection->socket = std::move(client);
+    auto *raw = connection.get();
+    std::lock_guard<std::mutex> lock(connectionsMutex);
+    if (stopping.load())
+      break;
+    connections.push_back(std::move(connection));
+    raw->thread = std::thread([this, raw]() {
+      serveConnection(*raw);
+      raw->finished.store(true);
+    });
+  }
+  reapConnections(true);
+  return true;
+}
+
+void RemoteInferenceServer::stop() {
+  stopping.store(true);
+  std::lock_guard<std::mutex> lock(connectionsMutex);
+  if (listener)
+    listener->close();
+  for (auto &connection : connections)
+    connection->socket->close();
+}
+
+int RemoteInferenceServer::getNumConnections() {
+  std::lock_guard<std::mutex> lock(connectionsMutex);
+  return static_cast<int>(std::count_if(
+      connections.begin(), connections.end(),
+      [](const std::unique_ptr<Connection> &connection) {
+        return !connection->finished.load();
+      }));
+}
+
+void RemoteInferenceServer::reapConnections(bool all) {
+  std::vector<std::unique_ptr<Connection>> done;
+  {
+    std::lock_guard<std::mutex> lock(connectionsMutex);
+    auto finished = std::stable_partition(
+        connections.begin(), connections.end(),
+        [all](const std::unique_ptr<Connection> &connection) {
+          return !all && !connection->finished.load();
+        });
+    std::move(finished, connections.end(), std::back_inserter(done));
+    connections.erase(finished, connections.end());
+  }
+  for (auto &connection : done)
+    if (connection->thread.joinable())
+      connection->thread.join();
+}
+
+void RemoteInferenceServer::serveConnection(Connection &connection) {
+  juce::Thread::setCurrentThreadName("HachiTune inference client");
+  auto &socket = *connection.socket;
+
+  struct Request {
+    RemoteProtocol::Header header;
+    std::vector<uint8_t> payload;
+  };
+  std::mutex queueMutex;
+  std::condition_variable queueCondition;
+  std::condition_variable spaceCondition;
+  std::deque<Request> queue;
+  const size_t maxQueued = static_cast<size_t>(maxConcurrent);
+  bool endOfInput = false;
+  std::mutex writeMutex;
+
+  auto answer = [&](const Request &request) {
+    using RemoteProtocol::Status;
+    const auto &payload = request.payload;
+    std::vector<float> values;
+    Status status = Status::Unsupported;
+
+    if (request.header.op == RemoteProtocol::Op::Vocode && handlers.vocode &&
+        payload.size() >= 12) {
+      const size_t frames = readValue<uint32_t>(payload.data());
+      const int mels = readValue<uint16_t>(payload.data() + 4);
+      const int hop = readValue<uint16_t>(payload.data() + 6);
+      const int rate = static_cast<int>(readValue<uint32_t>(payload.data() + 8));
+      const size_t numValues = frames * static_cast<size_t>(mels);
+      status = Status::Failed;
+      if (frames > 0 && mels > 0 &&
+          payload.size() == 12 + numValues * 2 + frames * 4) {
+        std::vector<uint16_t> halves(numValues);
+        readValues(payload.data() + 12, halves.data(), numValues);
+        MelBuffer mel(frames, mels);
+        HalfFloat::toFloat(halves.data(), mel.data(), numValues);
+        std::vector<float> f0(frames);
+        readValues(payload.data() + 12 + numValues * 2, f0.data(), frames);
+        status = handlers.vocode(mel, f0, rate, hop, values);
+      }
+    } else if (request.header.op == RemoteProtocol::Op::Pitch &&
+               handlers.pitch && payload.size() >= 8) {
+      const size_t samples = readValue<uint32_t>(payload.data());
+      const float threshold = readValue<float>(payload.data() + 4);
+      status = Status::Failed;
+      if (samples > 0 && payload.size() == 8 + samples * 4) {
+        std::vector<float> audio(samples);
+        readValues(payload.data() + 8, audio.data(), samples);
+        status = handlers.pitch(audio, threshold, values);
+      }
+    }
+    if (status != Status::Ok)
+      values.clear();
+
+    RemoteProtocol::Header header = request.header;
+    header.magic = RemoteProtocol::responseMagic;
+    header.status = status;
+    header.payloadBytes = static_cast<uint32_t>(values.size() * sizeof(float));
+    auto response = startMessage(header.payloadBytes);
+    RemoteProtocol::writeHeader(response.data(), header);
+    appendValues(response, values.data(), values.size());
+    std::lock_guard<std::mutex> lock(writeMutex);
+    if (!writeFully(socket, response))
+      socket.close();
+  };
+
+  std::vector<std::thread> workers;
+  for (int i = 0; i < maxConcurrent; ++i)
+    workers.emplace_back([&]() {
+      for (;;) {
+        Request request;
+        {
+          std::unique_lock<std::mutex> lock(queueMutex);
+          queueCondition.wait(lock,
+                              [&]() { return endOfInput || !queue.empty(); });
+          if (queue.empty())
+            return;
+          request = std::move(queue.front());
+          queue.pop_front();
+        }
+        spaceCondition.notify_one();
+        answer(request);
+      }
+    });
+
+  uint8_t headerBytes[RemoteProtocol::headerBytes];
+  for (;;) {
+    {
+      // Leave the rest in the socket until the workers catch up
+      std::unique_lock<std::mutex> lock(queueMutex);
+      spaceCondition.wait(lock, [&]() { return queue.size() < maxQueued; });
+    }
+    Request request;
+    if (!readFully(socket, headerBytes, sizeof(headerBytes)) ||
+        !RemoteProtocol::readHeader(headerBytes, RemoteProtocol::requestMagic,
+                                    request.header))
+      break;
+    request.payload.resize(request.header.payloadBytes);
+    if (!readFully(socket, request.payload.data(), request.payload.size()))
+      break;
+    {
+      std::lock_guard<std::mutex> lock(queueMutex);
+      queue.push_back(std::move(request));
+    }
+    queueCondition.notify_one();
+  }
+
+  // Requests already read are still answered if the socket allows
+  {
+    std::lock_guard<std::mutex> lock(queueMutex);
+    endOfInput = true;
+  }
+  queueCondition.notify_all();
+  for (auto &worker : workers)
+    worker.join();
+  socket.close();
+  LOG("RemoteInferenceServer: client disconnected");
+}
@@ -0,0 +1,204 @@
+#pragma once
+
+#include "../JuceHeader.h"
+#include "../Utils/MelBuffer.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Model runs offloaded to a HachiTune inference server (HachiTuneBatch
+ * --serve), so a laptop can render on a machine with a bigger GPU.
+ *
+ * The wire format is little-endian. Every message is a 16-byte header
+ * followed by payloadBytes:
+ *   u32 magic ('HTRQ' request, 'HTRS' response), u16 version, u8 op,
+ *   u8 status (0 in requests), u32 request id, u32 payloadBytes
+ * Vocode request: u32 frames, u16 mels, u16 hop size, u32 sample rate, the
+ * mel as frames x mels binary16 (see HalfFloat), then frames f32 of F0.
+ * Pitch request: u32 samples, f32 threshold, then the 16 kHz f32 samples.
+ * Response payload: f32 values, the audio or the F0 frames.
+ */
+namespace RemoteProtocol {
+enum class Op : uint8_t { Vocode = 1, Pitch = 2 };
+
+enum class Status : uint8_t {
+  Ok = 0,
+  Failed = 1,      // The server's model run failed
+  Unsupported = 2, // No model for this op on the server
+  Mismatch = 3     // The server's vocoder has another sample rate or hop size
+};
+
+constexpr uint32_t requestMagic = 0x51525448;  // "HTRQ"
+constexpr uint32_t responseMagic = 0x53525448; // "HTRS"
+constexpr uint16_t version = 1;
+constexpr int headerBytes = 16;
+constexpr uint32_t maxPayloadBytes = 256u * 1024u * 1024u;
+constexpr int defaultPort = 7427;
+
+struct Header {
+  uint32_t magic = 0;
+  uint16_t version = RemoteProtocol::version;
+  Op op = Op::Vocode;
+  Status status = Status::Ok;
+  uint32_t requestId = 0;
+  uint32_t payloadBytes = 0;
+};
+
+void writeHeader(uint8_t *dest, const Header &header);
+// False when the bytes are not a header with this magic and version
+bool readHeader(const uint8_t *source, uint32_t magic, Header &header);
+} // namespace RemoteProtocol
+
+/**
+ * Client side, owned by the Vocoder and RMVPE (setRemoteInference()) and
+ * tried before their local models.
+ *
+ * One TCP connection carries up to maxInFlight requests at once. Each call
+ * blocks its own thread until its response arrives, so the vocoder's
+ * streaming shards and RMVPE's chunk workers keep several requests in the
+ * pipe; responses are matched by request id and may come back in any
+ * order. A call that fails (no connection, a timeout, an error status)
+ * returns false and the caller runs the model itself. After a connection
+ * fails, calls return false at once for a backoff that doubles up to
+ * maxBackoffMs, so a dead server costs one connect timeout rather than one
+ * per chunk.
+ */
+class RemoteInference {
+public:
+  static constexpr int connectTimeoutMs = 1000;
+  static constexpr int requestTimeoutMs = 30000;
+  static constexpr int minBackoffMs = 2000;
+  static constexpr int maxBackoffMs = 60000;
+
+  /**
+   * endpoint is "host" or "host:port"; no connection is made until used.
+   * onConnectFailed, if set, runs on the calling thread after each failed
+   * connection attempt (not during the backoff that follows), for example
+   * to start the server.
+   */
+  explicit RemoteInference(const juce::String &endpoint, int maxInFlight = 4,
+                           std::function<void()> onConnectFailed = nullptr);
+  ~RemoteInference();
+
+  juce::String getEndpoint() const { return host + ":" + juce::String(port); }
+  int getMaxInFlight() const { return maxInFlight; }
+
+  /** False while backing off from a failed connection. */
+  bool isAvailable() const;
+
+  /**
+   * Synthesize frames [startFrame, startFrame + numFrames) on the server.
+   * @return true with numFrames * hopSize samples in audio
+   */
+  bool vocode(const MelView &mel, const float *f0, size_t startFrame,
+              size_t numFrames, int sampleRate, int hopSize,
+              const std::atomic<bool> *cancelFlag, std::vector<float> &audio);
+
+  /** RMVPE F0 of one chunk of 16 kHz audio on the server. */
+  bool extractPitch(const float *audio16k, int numSamples, float threshold,
+                    const std::atomic<bool> *cancelFlag,
+                    std::vector<float> &f0);
+
+private:
+  struct Pending {
+    bool done = false;
+    bool ok = false;
+    std::vector<float> values;
+  };
+
+  // Send a message whose header is at its start and wait for the answer
+  bool call(RemoteProtocol::Op op, std::vector<uint8_t> &message,
+            const std::atomic<bool> *cancelFlag, std::vector<float> &values);
+  // Caller holds mutex. attemptFailed is set when a connect was tried and
+  // failed, as opposed to skipped during a backoff.
+  bool connectLocked(bool &attemptFailed);
+  void backOffLocked(const juce::String &reason);
+  void readResponses(std::shared_ptr<juce::StreamingSocket> connection);
+
+  juce::String host;
+  int port = RemoteProtocol::defaultPort;
+  const int maxInFlight;
+  const std::function<void()> onConnectFailed;
+
+  mutable std::mutex mutex;
+  std::condition_variable condition;
+  std::shared_ptr<juce::StreamingSocket> socket; // Null while disconnected
+  std::thread reader; // Ends once the connection is gone
+  std::map<uint32_t, std::shared_ptr<Pending>> pending;
+  int numInFlight = 0;
+  uint32_t nextRequestId = 1;
+  int backoffMs = 0;
+  double retryAfterMs = 0.0; // Millisecond counter
+  bool closing = false;
+
+  std::mutex writeMutex; // Keeps each message in one piece on the wire
+
+  JUCE_DECLARE_NON_COPYABLE(RemoteInference)
+};
+
+/**
+ * Server side: answers RemoteInference requests with local models.
+ *
+ * Each connection gets maxConcurrent workers, so requests a client
+ * pipelines run side by side (on as many vocoder sessions as the pool
+ * has) and are answered as each finishes. At most maxConcurrent more
+ * requests wait read ahead; past that the connection is not read until a
+ * worker frees up, so a client cannot pile up payloads.
+ *
+ * There is no authentication: anyone who can connect can run the models.
+ */
+class RemoteInferenceServer {
+public:
+  static constexpr const char *loopbackAddress = "127.0.0.1";
+
+  struct Handlers {
+    std::function<RemoteProtocol::Status(
+        const MelBuffer &mel, const std::vector<float> &f0, int sampleRate,
+        int hopSize, std::vector<float> &audio)>
+        vocode;
+    std::function<RemoteProtocol::Status(const std::vector<float> &audio16k,
+                                         float threshold,
+                                         std::vector<float> &f0)>
+        pitch;
+  };
+
+  RemoteInferenceServer(Handlers handlers, int maxConcurrent);
+  ~RemoteInferenceServer();
+
+  /**
+   * Accept and serve connections on port until stop(), on the interface
+   * with address bindAddress; "0.0.0.0" listens on every interface.
+   * @return false if the port cannot be listened on
+   */
+  bool run(int port, const juce::String &bindAddress = loopbackAddress);
+  void stop();
+
+  /** Clients connected now; safe from any thread. */
+  int getNumConnections();
+
+private:
+  struct Connection {
+    std::unique_ptr<juce::StreamingSocket> socket;
+    std::thread thread;
+    std::atomic<bool> finished{false};
+  };
+
+  void serveConnection(Connection &connection);
+  void reapConnections(bool all);
+
+  const Handlers handlers;
+  const int maxConcurrent;
+  std::atomic<bool> stopping{false};
+  std::mutex connectionsMutex;
+  std::unique_ptr<juce::StreamingSocket> listener;
+  std::vector<std::unique_ptr<Connection>> connections;
+
+  JUCE_DECLARE_NON_COPYABLE(RemoteInferenceServer)
+};
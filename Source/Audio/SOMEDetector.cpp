@@ -1,10 +1,20 @@
 #include "SOMEDetector.h"
+#include "OnnxGpuMemory.h"
+#include "OnnxSessionRegistry.h"
+#include "OnnxThreading.h"
+#include "PerformanceMetrics.h"
+#include "../Utils/AppLogger.h"
+#include "../Utils/AudioResampler.h"
 #include "../Utils/Localization.h"
 #include <algorithm>
 #include <cmath>
+#include <exception>
 #include <iostream>
 #include <juce_core/juce_core.h>
+#include <mutex>
+#include <new>
 #include <numeric>
+#include <thread>
 
 SOMEDetector::SOMEDetector() = default;
 SOMEDetector::~SOMEDetector() = default;
@@ -13,14 +23,19 @@ bool SOMEDetector::loadModel(const juce::File &modelPath, GPUProvider provider,
                              int deviceId) {
 #ifdef HAVE_ONNXRUNTIME
   try {
-    onnxEnv =
-        std::make_unique<Ort::Env>(ORT_LOGGING_LEVEL_WARNING, "SOMEDetector");
+    // The bindings refer to the session about to be replaced
+    ioBindings.clear();
 
     Ort::SessionOptions sessionOptions;
-    sessionOptions.SetIntraOpNumThreads(4);
+    auto threading = OnnxThreading::apply(sessionOptions,
+                                          OnnxThreading::Model::SOME);
+    DBG("SOME: " << threading.intraOpThreads << " intra-op thread(s)");
     sessionOptions.SetGraphOptimizationLevel(
         GraphOptimizationLevel::ORT_ENABLE_ALL);
 
+    // Tag of the EP actually in use; keys the optimized-graph cache
+    juce::String deviceTag = "CPU";
+
     // Add execution provider based on build configuration
 #if defined(_WIN32) && defined(USE_DIRECTML)
     if (provider == GPUProvider::DirectML) {
@@ -38,6 +53,7 @@ bool SOMEDetector::loadModel(const juce::File &modelPath, GPUProvider provider,
         Ort::ThrowOnError(
             ortDmlApi->SessionOptionsAppendExecutionProvider_DML(
                 sessionOptions, deviceId));
+        deviceTag = "DirectML";
         DBG("SOME: DirectML execution provider added");
       } catch (const Ort::Exception &e) {
         DBG("SOME: Failed to add DirectML provider, using CPU");
@@ -49,7 +65,9 @@ bool SOMEDetector::loadModel(const juce::File &modelPath, GPUProvider provider,
       try {
         OrtCUDAProviderOptions cudaOptions{};
         cudaOptions.device_id = deviceId;
+        OnnxGpuMemory::apply(cudaOptions);
         sessionOptions.AppendExecutionProvider_CUDA(cudaOptions);
+        deviceTag = "CUDA" + juce::String(deviceId);
         DBG("SOME: CUDA execution provider added");
       } catch (const Ort::Exception &e) {
         DBG("SOME: Failed to add CUDA provider, using CPU");
@@ -59,6 +77,7 @@ bool SOMEDetector::loadModel(const juce::File &modelPath, GPUProvider provider,
         if (provider == GPUProvider::CoreML) {
       try {
         sessionOptions.AppendExecutionProvider("CoreML");
+        deviceTag = "CoreML";
         DBG("SOME: CoreML execution provider added");
       } catch (const Ort::Exception &e) {
         DBG("SOME: Failed to add CoreML provider, using CPU");
@@ -69,15 +88,9 @@ bool SOMEDetector::loadModel(const juce::File &modelPath, GPUProvider provider,
       }
     }
 
-#ifdef _WIN32
-    std::wstring modelPathW = modelPath.getFullPathName().toWideCharPointer();
-    onnxSession = std::make_unique<Ort::Session>(*onnxEnv, modelPathW.c_str(),
-                                                 sessionOptions);
-#else
-    std::string modelPathStr = modelPath.getFullPathName().toStdString();
-    onnxSession = std::make_unique<Ort::Session>(*onnxEnv, modelPathStr.c_str(),
-                                                 sessionOptions);
-#endif
+    onnxSession = OnnxSessionRegistry::acquire(
+        modelPath, sessionOptions, deviceTag,
+        OnnxThreading::describe(threading) + " id " + juce::String(deviceId));
 
     Ort::AllocatorWithDefaultOptions allocator;
 
@@ -104,7 +117,25 @@ bool SOMEDetector::loadModel(const juce::File &modelPath, GPUProvider provider,
     for (const auto &name : outputNameStrings)
       outputNames.push_back(name.c_str());
 
+    outputMemory = OnnxIoBinding::OutputMemory::Cpu;
+#ifdef USE_CUDA
+    if (provider == GPUProvider::CUDA)
+      outputMemory = OnnxIoBinding::OutputMemory::CudaPinned;
+#endif
+    bindingDeviceId = deviceId;
+    ioBindings.push_back(std::make_unique<OnnxIoBinding>(
+        *onnxSession, inputNames, outputNames, outputMemory, deviceId));
+
+    // Same policy as RMVPE: one slice fills a GPU, while on CPU the
+    // transformer leaves intra-op threads idle between slices
+    maxParallelSlices =
+        deviceTag == "CPU" ? std::clamp(threading.intraOpThreads / 2, 1, 4) : 1;
+    DBG("SOME: up to " << maxParallelSlices << " slice(s) in parallel");
+    sliceSizer.reset();
+
     loaded = true;
+    PerformanceMetrics::getInstance().setDevice(OnnxThreading::Model::SOME,
+                                                deviceTag);
     DBG("SOME model loaded: " << inputNameStrings.size() << " inputs, "
                               << outputNameStrings.size() << " outputs");
     return true;
@@ -118,53 +149,63 @@ bool SOMEDetector::loadModel(const juce::File &modelPath, GPUProvider provider,
 #endif
 }
 
-std::vector<float> SOMEDetector::resampleTo44k(const float *audio,
-                                               int numSamples, int srcRate) {
-  if (srcRate == SAMPLE_RATE)
-    return std::vector<float>(audio, audio + numSamples);
-
-  double ratio = static_cast<double>(SAMPLE_RATE) / srcRate;
-  int outSamples = static_cast<int>(numSamples * ratio);
-  std::vector<float> resampled(outSamples);
-
-  for (int i = 0; i < outSamples; ++i) {
-    double srcPos = i / ratio;
-    int srcIdx = static_cast<int>(srcPos);
-    double frac = srcPos - srcIdx;
-
-    if (srcIdx + 1 < numSamples)
-      resampled[i] = static_cast<float>(audio[srcIdx] * (1.0 - frac) +
-                                        audio[srcIdx + 1] * frac);
-    else if (srcIdx < numSamples)
-      resampled[i] = audio[srcIdx];
-  }
-  return resampled;
-}
-
 // RMS calculation for slicer
-std::vector<double> SOMEDetector::getRms(const std::vector<float> &samples,
-                                         int frameLength, int hopLength) {
-  std::vector<double> output;
-  size_t outputSize = samples.size() / hopLength;
-  output.reserve(outputSize);
+std::vector<double> SOMEDetector::getRms(const float *samples,
+                                         size_t numSamples, int frameLength,
+                                         int hopLength) {
+  const size_t outputSize = numSamples / hopLength;
+  const size_t halfFrame = static_cast<size_t>(frameLength / 2);
+  std::vector<double> output(outputSize);
+
+  // Squares are formed a block at a time with SIMD and summed in double
+  constexpr size_t squaresBlock = 1024;
+  ScratchArena::Scope scratch;
+  float *squares = scratch.allocate<float>(squaresBlock);
+  auto sumOfSquares = [&](size_t begin, size_t end) {
+    double sum = 0.0;
+    while (begin < end) {
+      const size_t count = std::min(end - begin, squaresBlock);
+      juce::FloatVectorOperations::multiply(squares, samples + begin,
+                                            samples + begin,
+                                            static_cast<int>(count));
+      for (size_t k = 0; k < count; ++k)
+        sum += squares[k];
+      begin += count;
+    }
+    return sum;
+  };
 
+  // The window only moves forward, so keep a running sum over
+  // [windowStart, windowEnd) and touch each sample once on entry and once
+  // on exit instead of re-summing frameLength samples per frame
+  size_t windowStart = 0;
+  size_t windowEnd = 0;
+  double sum = 0.0;
   for (size_t i = 0; i < outputSize; ++i) {
-    size_t halfFrame = static_cast<size_t>(frameLength / 2);
-    size_t center = i * hopLength;
-    size_t start = (center < halfFrame) ? 0 : (center - halfFrame);
-    size_t end = std::min(samples.size(), center + halfFrame);
+    const size_t center = i * hopLength;
+    const size_t start = (center < halfFrame) ? 0 : (center - halfFrame);
+    const size_t end = std::min(numSamples, center + halfFrame);
+
+    // Re-sum now and then so rounding in the running sum cannot build up
+    // over long inputs
+    if (start >= windowEnd || i % 1024 == 0) {
+      sum = sumOfSquares(start, end);
+    } else {
+      sum += sumOfSquares(windowEnd, end);
+      sum -= sumOfSquares(windowStart, start);
+    }
+    windowStart = start;
+    windowEnd = end;
 
-    double sum = 0.0;
-    for (size_t j = start; j < end; ++j)
-      sum += samples[j] * samples[j];
-    output.push_back(std::sqrt(sum / frameLength));
+    // Subtraction can leave a tiny negative residue over silence
+    output[i] = std::sqrt(std::max(sum, 0.0) / frameLength);
   }
   return output;
 }
 
 // Audio slicer based on silence detection
 SOMEDetector::MarkerList
-SOMEDetector::sliceAudio(const std::vector<float> &samples) const {
+SOMEDetector::sliceAudio(const float *samples, size_t numSamples) const {
   constexpr float threshold = 0.02f;
   constexpr int hopSize = HOP_SIZE;
   constexpr int winSize = HOP_SIZE * 4;
@@ -173,10 +214,10 @@ SOMEDetector::sliceAudio(const std::vector<float> &samples) const {
   constexpr int maxSilKept = 50;
 
   size_t minFrames = static_cast<size_t>(minLength);
-  if ((samples.size() + hopSize - 1) / hopSize <= minFrames)
-    return {{0, static_cast<int64_t>(samples.size())}};
+  if ((numSamples + hopSize - 1) / hopSize <= minFrames)
+    return {{0, static_cast<int64_t>(numSamples)}};
 
-  auto rmsList = getRms(samples, winSize, hopSize);
+  auto rmsList = getRms(samples, numSamples, winSize, hopSize);
   MarkerList silTags;
   int64_t silenceStart = -1;
   int64_t clipStart = 0;
@@ -234,7 +275,7 @@ SOMEDetector::sliceAudio(const std::vector<float> &samples) const {
   }
 
   if (silTags.empty())
-    return {{0, static_cast<int64_t>(samples.size())}};
+    return {{0, static_cast<int64_t>(numSamples)}};
 
   MarkerList chunks;
   if (silTags[0].first > 0)
@@ -251,42 +292,51 @@ SOMEDetector::sliceAudio(const std::vector<float> &samples) const {
   return chunks;
 }
 
-bool SOMEDetector::inferChunk(const std::vector<float> &chunk,
-                              std::vector<float> &midi, std::vector<bool> &rest,
-                              std::vector<float> &dur) {
+void SOMEDetector::warmUp() {
+  if (!loaded)
+    return;
+
+  // Silence would be sliced away by detectNotes, so run a chunk directly
+  std::vector<float> silence(SAMPLE_RATE / 2, 0.0f);
+  SliceResult result;
+  inferChunk(silence.data(), silence.size(), result);
+  DBG("SOME: warm-up done");
+}
+
+bool SOMEDetector::inferChunk(const float *samples, size_t numSamples,
+                              SliceResult &result, size_t binding,
+                              const std::atomic<bool> *cancelFlag) {
 #ifdef HAVE_ONNXRUNTIME
-  if (!onnxSession)
+  if (!onnxSession || binding >= ioBindings.size())
+    return false;
+  auto &ioBinding = *ioBindings[binding];
+  if (ioBinding.getNumInputs() < 1 || ioBinding.getNumOutputs() < 3)
     return false;
 
   try {
-    std::vector<int64_t> shape = {1, static_cast<int64_t>(chunk.size())};
-    Ort::MemoryInfo memInfo =
-        Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault);
-
-    std::vector<float> chunkCopy = chunk;
-    Ort::Value inputTensor = Ort::Value::CreateTensor<float>(
-        memInfo, chunkCopy.data(), chunkCopy.size(), shape.data(),
-        shape.size());
+    // Straight from the caller's waveform into the bound input buffer
+    std::copy(samples, samples + numSamples,
+              ioBinding.getInputBuffer(0, numSamples));
+    ioBinding.bindInput(0, {1, static_cast<int64_t>(numSamples)});
 
-    std::vector<Ort::Value> inputTensors;
-    inputTensors.push_back(std::move(inputTensor));
-
-    auto outputs = onnxSession->Run(Ort::RunOptions{nullptr}, inputNames.data(),
-                                    inputTensors.data(), inputTensors.size(),
-                                    outputNames.data(), outputNames.size());
+    auto outputs = ioBinding.run(cancelFlag);
 
     float *midiData = outputs[0].GetTensorMutableData<float>();
     bool *restData = outputs[1].GetTensorMutableData<bool>();
     float *durData = outputs[2].GetTensorMutableData<float>();
 
     size_t count = outputs[0].GetTensorTypeAndShapeInfo().GetElementCount();
-    midi.assign(midiData, midiData + count);
-    rest.assign(restData, restData + count);
-    dur.assign(durData, durData + count);
+    result.midi.assign(midiData, midiData + count);
+    result.rest.assign(restData, restData + count);
+    result.dur.assign(durData, durData + count);
 
     return true;
   } catch (const Ort::Exception &e) {
     DBG("SOME chunk inference error: " << e.what());
+    result.outOfMemory = ChunkSizer::isOutOfMemory(e.what());
+    return false;
+  } catch (const std::bad_alloc &) {
+    result.outOfMemory = true;
     return false;
   }
 #else
@@ -294,30 +344,178 @@ bool SOMEDetector::inferChunk(const std::vector<float> &chunk,
 #endif
 }
 
+bool SOMEDetector::inferSplitting(const float *samples, size_t numSamples,
+                                  SliceResult &result, size_t binding,
+                                  const std::atomic<bool> *cancelFlag) {
+  const size_t limit = static_cast<size_t>(sliceSizer.get());
+  if (numSamples <= limit) {
+    if (inferChunk(samples, numSamples, result, binding, cancelFlag))
+      return true;
+    if (!result.outOfMemory || (cancelFlag && cancelFlag->load()))
+      return false;
+    const int smaller = sliceSizer.shrink(static_cast<int>(numSamples));
+    if (smaller <= 0)
+      return false;
+    LOG_WARNING("SOME: out of memory on a " +
+                juce::String(static_cast<double>(numSamples) / SAMPLE_RATE, 1) +
+                " s slice; slices now split past " +
+                juce::String(smaller / SAMPLE_RATE) + " s");
+  }
+
+  // Quietest 20 ms in the middle half, so the cut rarely lands in a note
+  constexpr int frameLength = SAMPLE_RATE / 50;
+  constexpr int hopLength = frameLength / 4;
+  size_t split = numSamples / 2;
+  const auto rms = getRms(samples, numSamples, frameLength, hopLength);
+  if (rms.size() >= 4) {
+    const auto quietest = std::min_element(rms.begin() + rms.size() / 4,
+                                           rms.begin() + 3 * rms.size() / 4);
+    split = static_cast<size_t>(std::distance(rms.begin(), quietest)) *
+            hopLength;
+  }
+
+  SliceResult second;
+  result = {};
+  if (!inferSplitting(samples, split, result, binding, cancelFlag) ||
+      !inferSplitting(samples + split, numSamples - split, second, binding,
+                      cancelFlag))
+    return false;
+
+  // The second half's notes start where the first half's audio ends
+  const double firstSeconds = static_cast<double>(split) / SAMPLE_RATE;
+  const double total =
+      std::accumulate(result.dur.begin(), result.dur.end(), 0.0);
+  const auto gap = static_cast<float>(firstSeconds - total);
+  if (gap > 0.0f) {
+    result.midi.push_back(0.0f);
+    result.rest.push_back(true);
+    result.dur.push_back(gap);
+  } else if (!result.dur.empty()) {
+    result.dur.back() = std::max(0.0f, result.dur.back() + gap);
+  }
+  result.midi.insert(result.midi.end(), second.midi.begin(), second.midi.end());
+  result.rest.insert(result.rest.end(), second.rest.begin(), second.rest.end());
+  result.dur.insert(result.dur.end(), second.dur.begin(), second.dur.end());
+  return true;
+}
+
+void SOMEDetector::inferSlices(const float *waveform, int64_t totalSize,
+                               const MarkerList &slices,
+                               const SliceCallback &onSlice,
+                               const std::atomic<bool> *cancelFlag) {
+#ifdef HAVE_ONNXRUNTIME
+  const size_t numSlices = slices.size();
+  const size_t numWorkers = std::min(
+      numSlices, static_cast<size_t>(std::max(1, maxParallelSlices)));
+  for (size_t i = 0; i < numWorkers; ++i)
+    getBinding(i);
+
+  std::vector<SliceResult> results(numSlices);
+  std::vector<char> sliceReady(numSlices, 0);
+  std::atomic<size_t> nextSlice{0};
+  std::mutex deliveryMutex;
+  size_t slicesDelivered = 0;
+  bool stopped = false;
+  std::exception_ptr failure;
+
+  // Hand the in-order finished prefix to onSlice. Caller holds deliveryMutex.
+  auto deliverFinishedPrefix = [&]() {
+    while (!stopped && slicesDelivered < numSlices &&
+           sliceReady[slicesDelivered]) {
+      if (!onSlice(slices[slicesDelivered], results[slicesDelivered])) {
+        stopped = true;
+        nextSlice = numSlices;
+      }
+      results[slicesDelivered] = {};
+      ++slicesDelivered;
+    }
+  };
+
+  auto runWorker = [&](size_t binding) {
+    try {
+      for (size_t s = nextSlice++; s < numSlices; s = nextSlice++) {
+        if (cancelFlag && cancelFlag->load())
+          return;
+        SliceResult result;
+        const auto [begin, end] = slices[s];
+        if (end > begin && begin < totalSize)
+          result.ok = inferSplitting(
+              waveform + begin,
+              static_cast<size_t>(std::min(end, totalSize) - begin), result,
+              binding, cancelFlag);
+
+        std::lock_guard<std::mutex> lock(deliveryMutex);
+        results[s] = std::move(result);
+        sliceReady[s] = 1;
+        deliverFinishedPrefix();
+      }
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(deliveryMutex);
+      if (!failure)
+        failure = std::current_exception();
+      stopped = true;
+      nextSlice = numSlices; // Stop the other workers early
+    }
+  };
+
+  std::vector<std::thread> workers;
+  for (size_t i = 1; i < numWorkers; ++i)
+    workers.emplace_back(runWorker, i);
+  runWorker(0);
+  for (auto &worker : workers)
+    worker.join();
+
+  if (failure)
+    std::rethrow_exception(failure);
+#else
+  juce::ignoreUnused(waveform, totalSize, slices, onSlice, cancelFlag);
+#endif
+}
+
+#ifdef HAVE_ONNXRUNTIME
+OnnxIoBinding &SOMEDetector::getBinding(size_t index) {
+  while (ioBindings.size() <= index)
+    ioBindings.push_back(std::make_unique<OnnxIoBinding>(
+        *onnxSession, inputNames, outputNames, outputMemory, bindingDeviceId));
+  return *ioBindings[index];
+}
+#endif
+
 std::vector<SOMEDetector::NoteEvent>
-SOMEDetector::detectNotes(const float *audio, int numSamples, int sampleRate) {
-  return detectNotesWithProgress(audio, numSamples, sampleRate, nullptr);
+SOMEDetector::detectNotes(const float *audio, int numSamples, int sampleRate,
+                          const std::atomic<bool> *cancelFlag) {
+  return detectNotesWithProgress(audio, numSamples, sampleRate, nullptr,
+                                 cancelFlag);
 }
 
 std::vector<SOMEDetector::NoteEvent> SOMEDetector::detectNotesWithProgress(
     const float *audio, int numSamples, int sampleRate,
-    std::function<void(double)> progressCallback) {
+    std::function<void(double)> progressCallback,
+    const std::atomic<bool> *cancelFlag) {
 #ifdef HAVE_ONNXRUNTIME
   if (!loaded || !onnxSession) {
     DBG("SOME model not loaded");
     return {};
   }
 
+  PerformanceMetrics::ScopedInference timing(
+      OnnxThreading::Model::SOME,
+      static_cast<double>(numSamples) / sampleRate);
+
   if (progressCallback)
     progressCallback(0.05);
 
-  std::vector<float> waveform = resampleTo44k(audio, numSamples, sampleRate);
-  int64_t totalSize = static_cast<int64_t>(waveform.size());
+  // Project audio is already at 44.1 kHz; only other rates need a copy
+  ScratchArena::Scope scratch;
+  const float *waveform = AudioResampler::resample(audio, numSamples,
+                                                   sampleRate, SAMPLE_RATE,
+                                                   scratch);
+  int64_t totalSize = numSamples;
 
   if (progressCallback)
     progressCallback(0.1);
 
-  MarkerList chunks = sliceAudio(waveform);
+  MarkerList chunks = sliceAudio(waveform, static_cast<size_t>(totalSize));
   DBG("SOME: sliced into " << chunks.size() << " chunks");
 
   if (chunks.empty())
@@ -330,29 +528,24 @@ std::vector<SOMEDetector::NoteEvent> SOMEDetector::detectNotesWithProgress(
 
   std::vector<NoteEvent> allNotes;
   int64_t processedFrames = 0;
+  bool failed = false;
 
-  // Process chunks sequentially (like dataset-tools)
-  for (const auto &[beginFrame, endFrame] : chunks) {
+  // Chunks are inferred in parallel and built in order (like dataset-tools)
+  auto buildChunk = [&](const Marker &chunk, SliceResult &result) {
+    const auto [beginFrame, endFrame] = chunk;
     if (endFrame <= beginFrame || beginFrame >= totalSize)
-      continue;
-
-    int64_t actualEnd = std::min(endFrame, totalSize);
-    std::vector<float> chunkData(waveform.begin() + beginFrame,
-                                 waveform.begin() + actualEnd);
-
-    std::vector<float> noteMidi;
-    std::vector<bool> noteRest;
-    std::vector<float> noteDur;
-
-    if (!inferChunk(chunkData, noteMidi, noteRest, noteDur)) {
-      juce::AlertWindow::showMessageBoxAsync(
-          juce::MessageBoxIconType::WarningIcon, TR("error.some_error"),
-          TR("error.inference_failed"));
-      return {};
+      return true;
+    if (!result.ok) {
+      failed = true;
+      return false;
     }
 
+    const int64_t actualEnd = std::min(endFrame, totalSize);
+    const auto &noteMidi = result.midi;
+    const auto &noteRest = result.rest;
+    const auto &noteDur = result.dur;
     if (noteMidi.empty())
-      continue;
+      return true;
 
     // Debug: log SOME output for diagnosis
     int restCount =
@@ -452,6 +645,17 @@ std::vector<SOMEDetector::NoteEvent> SOMEDetector::detectNotesWithProgress(
     if (progressCallback)
       progressCallback(0.1 + 0.85 * static_cast<double>(processedFrames) /
                                  totalFrames);
+    return true;
+  };
+  inferSlices(waveform, totalSize, chunks, buildChunk, cancelFlag);
+
+  if (cancelFlag && cancelFlag->load())
+    return {};
+  if (failed) {
+    juce::AlertWindow::showMessageBoxAsync(
+        juce::MessageBoxIconType::WarningIcon, TR("error.some_error"),
+        TR("error.inference_failed"));
+    return {};
   }
 
   if (progressCallback)
@@ -468,7 +672,8 @@ std::vector<SOMEDetector::NoteEvent> SOMEDetector::detectNotesWithProgress(
 void SOMEDetector::detectNotesStreaming(
     const float *audio, int numSamples, int sampleRate,
     std::function<void(const std::vector<NoteEvent> &)> noteCallback,
-    std::function<void(double)> progressCallback) {
+    std::function<void(double)> progressCallback,
+    const std::atomic<bool> *cancelFlag) {
 #ifdef HAVE_ONNXRUNTIME
   DBG("=== detectNotesStreaming CALLED: " << numSamples << " samples ===");
 
@@ -477,16 +682,24 @@ void SOMEDetector::detectNotesStreaming(
     return;
   }
 
+  PerformanceMetrics::ScopedInference timing(
+      OnnxThreading::Model::SOME,
+      static_cast<double>(numSamples) / sampleRate);
+
   if (progressCallback)
     progressCallback(0.05);
 
-  std::vector<float> waveform = resampleTo44k(audio, numSamples, sampleRate);
-  int64_t totalSize = static_cast<int64_t>(waveform.size());
+  // Project audio is already at 44.1 kHz; only other rates need a copy
+  ScratchArena::Scope scratch;
+  const float *waveform = AudioResampler::resample(audio, numSamples,
+                                                   sampleRate, SAMPLE_RATE,
+                                                   scratch);
+  int64_t totalSize = numSamples;
 
   if (progressCallback)
     progressCallback(0.1);
 
-  MarkerList chunks = sliceAudio(waveform);
+  MarkerList chunks = sliceAudio(waveform, static_cast<size_t>(totalSize));
   DBG("SOME streaming: sliced into " << chunks.size() << " chunks");
 
   if (chunks.empty())
@@ -499,26 +712,24 @@ void SOMEDetector::detectNotesStreaming(
   int lastEndFrame = 0;
   int64_t processedFrames = 0;
 
-  for (const auto &[beginFrame, endFrame] : chunks) {
+  // Chunks are inferred in parallel; each is built and delivered as soon as
+  // every chunk before it has been
+  auto deliverChunk = [&](const Marker &chunk, SliceResult &result) {
+    const auto [beginFrame, endFrame] = chunk;
     if (endFrame <= beginFrame || beginFrame >= totalSize)
-      continue;
-
-    int64_t actualEnd = std::min(endFrame, totalSize);
-    std::vector<float> chunkData(waveform.begin() + beginFrame,
-                                 waveform.begin() + actualEnd);
-
-    std::vector<float> noteMidi;
-    std::vector<bool> noteRest;
-    std::vector<float> noteDur;
-
-    if (!inferChunk(chunkData, noteMidi, noteRest, noteDur)) {
+      return true;
+    if (!result.ok) {
       DBG("SOME chunk inference failed");
       std::cout << "[SOME] Chunk inference failed" << std::endl;
-      continue;
+      return true;
     }
 
+    const int64_t actualEnd = std::min(endFrame, totalSize);
+    const auto &noteMidi = result.midi;
+    const auto &noteRest = result.rest;
+    const auto &noteDur = result.dur;
     if (noteMidi.empty())
-      continue;
+      return true;
 
     // Debug: log SOME output for diagnosis
     int restCount =
@@ -615,8 +826,12 @@ void SOMEDetector::detectNotesStreaming(
     if (progressCallback)
       progressCallback(0.1 + 0.85 * static_cast<double>(processedFrames) /
                                  totalFrames);
-  }
+    return true;
+  };
+  inferSlices(waveform, totalSize, chunks, deliverChunk, cancelFlag);
 
+  if (cancelFlag && cancelFlag->load())
+    return;
   if (progressCallback)
     progressCallback(1.0);
 #endif
@@ -1,10 +1,16 @@
 #pragma once
 
 #include "../JuceHeader.h"
+#include "ChunkSizer.h"
 #include "FCPEPitchDetector.h"
+#include "OnnxIoBinding.h"
+#include <atomic>
+#include <cstdint>
 #include <vector>
 #include <memory>
 #include <functional>
+#include <limits>
+#include <utility>
 
 #ifdef HAVE_ONNXRUNTIME
 #include <onnxruntime_cxx_api.h>
@@ -34,36 +40,93 @@ public:
                    int deviceId = 0);
     bool isLoaded() const { return loaded; }
 
-    std::vector<NoteEvent> detectNotes(const float* audio, int numSamples, int sampleRate);
+    /**
+     * Run one short inference on silence so graph initialization and kernel
+     * selection happen now rather than on the first real call. Blocking;
+     * call from a background thread, not concurrently with other calls.
+     */
+    void warmUp();
+
+    // Raising cancelFlag aborts the chunk in flight and skips the rest
+    std::vector<NoteEvent> detectNotes(const float* audio, int numSamples, int sampleRate,
+                                       const std::atomic<bool>* cancelFlag = nullptr);
     std::vector<NoteEvent> detectNotesWithProgress(const float* audio, int numSamples,
                                                     int sampleRate,
-                                                    std::function<void(double)> progressCallback);
+                                                    std::function<void(double)> progressCallback,
+                                                    const std::atomic<bool>* cancelFlag = nullptr);
 
-    // Streaming detection - calls noteCallback for each chunk's notes as they're detected
+    // Streaming detection - calls noteCallback for each chunk's notes as they're detected.
+    // Chunks are inferred up to getMaxParallelSlices() at a time; their notes still
+    // arrive in time order, possibly from a worker thread but never from two at once.
     void detectNotesStreaming(const float* audio, int numSamples, int sampleRate,
                               std::function<void(const std::vector<NoteEvent>&)> noteCallback,
-                              std::function<void(double)> progressCallback);
+                              std::function<void(double)> progressCallback,
+                              const std::atomic<bool>* cancelFlag = nullptr);
+
+    /**
+     * Slices inferred at the same time. Chosen on load: 1 on GPU providers,
+     * otherwise derived from the SOME intra-op thread count.
+     */
+    int getMaxParallelSlices() const { return maxParallelSlices; }
+
+    /**
+     * Longest slice sent to the model in one run, in samples. Slices follow
+     * the silences of the audio and are unlimited at first; a slice the
+     * device has no memory for is split at its quietest point and the limit
+     * drops below it for the rest of the session.
+     */
+    int getMaxSliceSamples() const { return sliceSizer.get(); }
 
     int getFrameForSample(int sampleIndex) const { return sampleIndex / HOP_SIZE; }
     int getSampleForFrame(int frameIndex) const { return frameIndex * HOP_SIZE; }
 
 private:
     bool loaded = false;
-
-    std::vector<float> resampleTo44k(const float* audio, int numSamples, int srcRate);
+    int maxParallelSlices = 1;
+    ChunkSizer sliceSizer{{SAMPLE_RATE * 5, SAMPLE_RATE * 10, SAMPLE_RATE * 20, SAMPLE_RATE * 40},
+                          std::numeric_limits<int>::max()};
 
     // Slicer
-    using MarkerList = std::vector<std::pair<int64_t, int64_t>>;
-    MarkerList sliceAudio(const std::vector<float>& samples) const;
-    static std::vector<double> getRms(const std::vector<float>& samples, int frameLength, int hopLength);
+    using Marker = std::pair<int64_t, int64_t>;
+    using MarkerList = std::vector<Marker>;
+    MarkerList sliceAudio(const float* samples, size_t numSamples) const;
+    static std::vector<double> getRms(const float* samples, size_t numSamples, int frameLength, int hopLength);
 
-    // Single chunk inference
-    bool inferChunk(const std::vector<float>& chunk, std::vector<float>& midi,
-                    std::vector<bool>& rest, std::vector<float>& dur);
+    struct SliceResult {
+        bool ok = false;
+        bool outOfMemory = false; // With ok = false
+        std::vector<float> midi;
+        std::vector<bool> rest;
+        std::vector<float> dur;
+    };
+
+    // Single chunk inference on I/O binding `binding`
+    bool inferChunk(const float* samples, size_t numSamples, SliceResult& result,
+                    size_t binding = 0,
+                    const std::atomic<bool>* cancelFlag = nullptr);
+
+    // inferChunk(), but a slice longer than getMaxSliceSamples(), or one that
+    // runs out of memory, is inferred in two halves split at its quietest
+    // point; the first half's durations are fitted to its length
+    bool inferSplitting(const float* samples, size_t numSamples, SliceResult& result,
+                        size_t binding, const std::atomic<bool>* cancelFlag);
+
+    // Infer slices of waveform on up to maxParallelSlices workers (the caller
+    // is one) and pass each result to onSlice in slice order, never from two
+    // threads at once. Returning false from onSlice stops the rest.
+    using SliceCallback = std::function<bool(const Marker& slice, SliceResult& result)>;
+    void inferSlices(const float* waveform, int64_t totalSize, const MarkerList& slices,
+                     const SliceCallback& onSlice, const std::atomic<bool>* cancelFlag);
 
 #ifdef HAVE_ONNXRUNTIME
-    std::unique_ptr<Ort::Env> onnxEnv;
-    std::unique_ptr<Ort::Session> onnxSession;
+    std::shared_ptr<Ort::Session> onnxSession; // From OnnxSessionRegistry
+    // One binding per slice in flight; Session::Run itself is thread-safe.
+    // Bindings past the first are created on demand.
+    std::vector<std::unique_ptr<OnnxIoBinding>> ioBindings;
+    OnnxIoBinding::OutputMemory outputMemory = OnnxIoBinding::OutputMemory::Cpu;
+    int bindingDeviceId = 0;
+
+    OnnxIoBinding& getBinding(size_t index);
 
     std::vector<const char*> inputNames;
     std::vector<const char*> outputNames;
@@ -0,0 +1,36 @@
+#include "SeededNoise.h"
+#include <cmath>
+
+namespace {
+// SplitMix64's finalizer: a full-avalanche mix, so neighbouring positions
+// give unrelated values
+std::uint64_t mix(std::uint64_t x) {
+  x ^= x >> 30;
+  x *= 0xbf58476d1ce4e5b9ull;
+  x ^= x >> 27;
+  x *= 0x94d049bb133111ebull;
+  x ^= x >> 31;
+  return x;
+}
+} // namespace
+
+namespace SeededNoise {
+float at(std::uint64_t seed, std::int64_t position) {
+  const std::uint64_t bits =
+      mix(seed + static_cast<std::uint64_t>(position) * 0x9e3779b97f4a7c15ull);
+
+  // Box-Muller on the two halves, both kept off zero
+  constexpr double scale = 1.0 / 4294967296.0;
+  const double u1 = (static_cast<double>(bits >> 32) + 0.5) * scale;
+  const double u2 = (static_cast<double>(bits & 0xffffffffull) + 0.5) * scale;
+  constexpr double twoPi = 6.283185307179586;
+  return static_cast<float>(std::sqrt(-2.0 * std::log(u1)) *
+                            std::cos(twoPi * u2));
+}
+
+void fill(std::uint64_t seed, std::int64_t firstPosition, float *dest,
+          int count) {
+  for (int i = 0; i < count; ++i)
+    dest[i] = at(seed, firstPosition + i);
+}
+} // namespace SeededNoise
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * Gaussian noise addressed by position: the value at a sample depends only
+ * on the seed and the sample's absolute index, never on how a render was
+ * cut into calls. Feeds the excitation of vocoders that take their noise
+ * as an input (see Vocoder::setDeterministic).
+ */
+namespace SeededNoise {
+// Standard normal value of sample position in the stream of seed
+float at(std::uint64_t seed, std::int64_t position);
+
+// at() for positions [firstPosition, firstPosition + count)
+void fill(std::uint64_t seed, std::int64_t firstPosition, float *dest,
+          int count);
+} // namespace SeededNoise
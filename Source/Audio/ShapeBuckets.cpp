@@ -0,0 +1,27 @@
+#include "ShapeBuckets.h"
+
+#include <algorithm>
+
+ShapeBuckets::ShapeBuckets(size_t smallest, size_t largest) {
+  smallest = std::max<size_t>(smallest, 1);
+  largest = std::max(largest, smallest);
+  for (size_t size = smallest; size < largest; size *= 2) {
+    buckets.push_back(size);
+    if (size + size / 2 < largest && size / 2 > 0)
+      buckets.push_back(size + size / 2);
+  }
+  buckets.push_back(largest);
+}
+
+size_t ShapeBuckets::bucketFor(size_t length) const {
+  const auto found = std::lower_bound(buckets.begin(), buckets.end(), length);
+  if (found != buckets.end())
+    return *found;
+  const size_t step = std::max<size_t>(buckets.back() / 4, 1);
+  return (length + step - 1) / step * step;
+}
+
+std::vector<size_t> ShapeBuckets::upTo(size_t maxLength) const {
+  return {buckets.begin(),
+          std::upper_bound(buckets.begin(), buckets.end(), maxLength)};
+}
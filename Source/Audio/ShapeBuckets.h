@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * The input lengths a model wrapper pads its runs up to on a GPU.
+ *
+ * Every new input length makes CUDA, TensorRT and DirectML plan kernels
+ * and memory again (TensorRT builds a whole engine). Padding each run to
+ * the smallest bucket that holds it keeps the device on a few shapes it
+ * has seen before, warmed once after loading; the wrapper trims the output
+ * back to the exact length. Buckets step by at most 1.5x, so a run longer
+ * than the smallest is at most a third padding. Lengths past the largest bucket go up to a
+ * multiple of a quarter of it.
+ */
+class ShapeBuckets {
+public:
+  /** Buckets of 1, 1.5, 2, 3, 4, 6... times smallest, up to largest. */
+  ShapeBuckets(size_t smallest, size_t largest);
+
+  /** Length a run of length frames or samples is padded to. */
+  size_t bucketFor(size_t length) const;
+
+  /** The buckets up to and including maxLength, ascending. */
+  std::vector<size_t> upTo(size_t maxLength) const;
+
+private:
+  std::vector<size_t> buckets; // Ascending, never empty
+};
@@ -1,22 +1,211 @@
 #include "IncrementalSynthesizer.h"
 #include "../../Utils/Localization.h"
+#include "../../Utils/MelFormantShift.h"
+#include "../../Utils/Tracing.h"
+#include "../PerformanceMetrics.h"
+#include "PsolaPreview.h"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+#include <utility>
+
+namespace {
+constexpr size_t maxQueuedApplyJobs = 4;
+
+// Write a segment's target F0 into a project-length curve at its frames
+template <typename Segment>
+void copyTargetF0(const Segment &segment, std::vector<float> &curve) {
+  const int count = std::min(static_cast<int>(segment.targetF0.size()),
+                             static_cast<int>(curve.size()) - segment.startFrame);
+  if (count > 0)
+    std::copy_n(segment.targetF0.begin(), count,
+                curve.begin() + segment.startFrame);
+}
+
+// Sorted, merged [start, end) frame spans covered by non-rest notes
+std::vector<std::pair<int, int>> buildNoteSpans(const std::vector<Note> &notes) {
+  std::vector<std::pair<int, int>> spans;
+  spans.reserve(notes.size());
+  for (const auto &note : notes)
+    if (!note.isRest() && note.getEndFrame() > note.getStartFrame())
+      spans.emplace_back(note.getStartFrame(), note.getEndFrame());
+  std::sort(spans.begin(), spans.end());
+
+  std::vector<std::pair<int, int>> merged;
+  merged.reserve(spans.size());
+  for (const auto &span : spans) {
+    if (!merged.empty() && span.first <= merged.back().second)
+      merged.back().second = std::max(merged.back().second, span.second);
+    else
+      merged.push_back(span);
+  }
+  return merged;
+}
+
+// Take [start, end) out of sorted, disjoint ranges
+void removeRange(std::vector<std::pair<int, int>> &ranges, int start, int end) {
+  std::vector<std::pair<int, int>> kept;
+  kept.reserve(ranges.size() + 1);
+  for (const auto &range : ranges) {
+    if (range.second <= start || range.first >= end) {
+      kept.push_back(range);
+      continue;
+    }
+    if (range.first < start)
+      kept.emplace_back(range.first, start);
+    if (range.second > end)
+      kept.emplace_back(end, range.second);
+  }
+  ranges = std::move(kept);
+}
+
+// Add [start, end) to sorted, disjoint ranges, merging what it touches
+void addRange(std::vector<std::pair<int, int>> &ranges, int start, int end) {
+  auto it = std::lower_bound(
+      ranges.begin(), ranges.end(), start,
+      [](const std::pair<int, int> &range, int frame) {
+        return range.second < frame;
+      });
+  auto last = it;
+  while (last != ranges.end() && last->first <= end) {
+    start = std::min(start, last->first);
+    end = std::max(end, last->second);
+    ++last;
+  }
+  it = ranges.erase(it, last);
+  ranges.insert(it, {start, end});
+}
+} // namespace
 
 IncrementalSynthesizer::IncrementalSynthesizer() = default;
 
-IncrementalSynthesizer::~IncrementalSynthesizer() { cancel(); }
+IncrementalSynthesizer::~IncrementalSynthesizer() {
+  cancel();
+  {
+    std::lock_guard<std::mutex> lock(applyMutex);
+    stopApplyWorker = true;
+  }
+  applyJobs.wait();
+}
+
+void IncrementalSynthesizer::enqueueApply(uint64_t ownerJobId,
+                                          std::function<void()> job) {
+  bool startDrain = false;
+  {
+    std::lock_guard<std::mutex> lock(applyMutex);
+    // Only the newest job can commit (older ones fail the jobId check) and
+    // prefetches are speculative, so when full those are dropped. The newest
+    // job's batches are kept: its completion waits for every one of them.
+    const uint64_t newest = jobId.load();
+    for (auto it = applyQueue.begin();
+         it != applyQueue.end() && applyQueue.size() >= maxQueuedApplyJobs;) {
+      if (it->ownerJobId != newest || it->ownerJobId == 0)
+        it = applyQueue.erase(it);
+      else
+        ++it;
+    }
+    applyQueue.push_back({ownerJobId, std::move(job)});
+    PerformanceMetrics::getInstance().setQueueDepth(
+        PerformanceMetrics::Queue::SynthesisApply,
+        static_cast<int>(applyQueue.size()));
+    startDrain = !std::exchange(applyDraining, true);
+  }
+  if (startDrain)
+    applyJobs.submit(JobSystem::Priority::Interactive,
+                     [this]() { drainApplyQueue(); });
+}
+
+void IncrementalSynthesizer::drainApplyQueue() {
+  while (true) {
+    std::function<void()> job;
+    {
+      std::lock_guard<std::mutex> lock(applyMutex);
+      if (stopApplyWorker || applyQueue.empty()) {
+        applyDraining = false;
+        return;
+      }
+      job = std::move(applyQueue.front().run);
+      applyQueue.pop_front();
+      PerformanceMetrics::getInstance().setQueueDepth(
+          PerformanceMetrics::Queue::SynthesisApply,
+          static_cast<int>(applyQueue.size()));
+    }
+    job();
+  }
+}
+
+void IncrementalSynthesizer::setProject(Project *p) {
+  if (p != project) {
+    {
+      std::lock_guard<std::mutex> lock(previewRangesMutex);
+      previewRanges.clear();
+    }
+  }
+  project = p;
+}
+
+Vocoder *IncrementalSynthesizer::getEditVocoder() const {
+  auto *preview = previewVocoder.load();
+  if (previewTier.load() && preview != nullptr && preview->isLoaded())
+    return preview;
+  return vocoder;
+}
+
+bool IncrementalSynthesizer::needsRefinement(double idleSeconds) const {
+  if (isBusy.load() || vocoder == nullptr || !vocoder->isLoaded())
+    return false;
+  {
+    std::lock_guard<std::mutex> lock(previewRangesMutex);
+    if (previewRanges.empty())
+      return false;
+  }
+  return juce::Time::highResolutionTicksToSeconds(
+             juce::Time::getHighResolutionTicks() -
+             lastActivityTicks.load()) >= idleSeconds;
+}
+
+std::pair<int, int> IncrementalSynthesizer::getPreviewFrameRange() const {
+  std::lock_guard<std::mutex> lock(previewRangesMutex);
+  if (previewRanges.empty())
+    return {-1, -1};
+  return {previewRanges.front().first, previewRanges.back().second};
+}
+
+void IncrementalSynthesizer::recordRenderer(
+    const std::vector<Segment> &segments, const Vocoder *renderer) {
+  std::lock_guard<std::mutex> lock(previewRangesMutex);
+  for (const auto &segment : segments) {
+    if (renderer != vocoder)
+      addRange(previewRanges, segment.startFrame, segment.endFrame);
+    else
+      removeRange(previewRanges, segment.startFrame, segment.endFrame);
+  }
+}
 
 void IncrementalSynthesizer::cancel() {
   if (cancelFlag)
     cancelFlag->store(true);
 }
 
+void IncrementalSynthesizer::renderReplaced(std::vector<float> f0) {
+  {
+    std::lock_guard<std::mutex> lock(previewRangesMutex);
+    previewRanges.clear();
+  }
+  std::lock_guard<std::mutex> lock(renderedF0Mutex);
+  renderedF0 = std::move(f0);
+  renderedF0Project = project;
+}
+
 std::pair<int, int>
 IncrementalSynthesizer::expandToSilenceBoundaries(int dirtyStart,
                                                   int dirtyEnd) {
   if (!project)
     return {dirtyStart, dirtyEnd};
 
-  auto &voicedMask = project->getAudioData().voicedMask;
+  const auto &voicedMask = project->getAudioData().voicedMask;
   const int totalFrames = static_cast<int>(voicedMask.size());
 
   if (totalFrames == 0)
@@ -24,55 +213,39 @@ IncrementalSynthesizer::expandToSilenceBoundaries(int dirtyStart,
 
   const int minSilenceFrames = 5; // Minimum silence gap to consider as boundary
 
-  // Helper: check if frame is voiced
-  auto isVoiced = [&](int i) {
-    return i >= 0 && i < totalFrames && voicedMask[i];
-  };
-
-  // Expand start backwards to find silence boundary
-  int expandedStart = dirtyStart;
-  int silenceCount = 0;
-  for (int i = dirtyStart - 1; i >= 0; --i) {
-    if (!isVoiced(i)) {
-      silenceCount++;
-      if (silenceCount >= minSilenceFrames) {
-        // Found silence boundary
-        expandedStart = i + silenceCount;
-        break;
-      }
-    } else {
-      silenceCount = 0;
-      expandedStart = i;
+  // Frames outside the mask count as unvoiced. Runs are found a word at a
+  // time rather than frame by frame.
+
+  // Expand start backwards to the nearest silence run of minSilenceFrames
+  int expandedStart = std::min(0, dirtyStart);
+  for (int upper = dirtyStart; upper > 0;) {
+    const int runLast =
+        upper > totalFrames ? upper - 1 : voicedMask.findPrev(upper, false);
+    if (runLast < 0)
+      break;
+    const int voicedBefore =
+        voicedMask.findPrev(std::min(runLast, totalFrames), true);
+    if (runLast - voicedBefore >= minSilenceFrames) {
+      // Found silence boundary
+      expandedStart = runLast + 1;
+      break;
     }
+    upper = voicedBefore;
   }
-  if (expandedStart > dirtyStart)
-    expandedStart = dirtyStart;
-  if (silenceCount < minSilenceFrames && expandedStart > 0) {
-    // Didn't find silence, expand to beginning
-    expandedStart = 0;
-  }
-
-  // Expand end forwards to find silence boundary
-  int expandedEnd = dirtyEnd;
-  silenceCount = 0;
-  for (int i = dirtyEnd; i < totalFrames; ++i) {
-    if (!isVoiced(i)) {
-      silenceCount++;
-      if (silenceCount >= minSilenceFrames) {
-        // Found silence boundary
-        expandedEnd = i - silenceCount + 1;
-        break;
-      }
-    } else {
-      silenceCount = 0;
-      expandedEnd = i + 1;
+
+  // Expand end forwards to the nearest silence run of minSilenceFrames
+  int expandedEnd = std::max(dirtyEnd, totalFrames);
+  for (int lower = std::max(0, dirtyEnd); lower < totalFrames;) {
+    const int runStart = voicedMask.findNext(lower, false);
+    if (runStart >= totalFrames)
+      break;
+    const int runEnd = voicedMask.findNext(runStart, true);
+    if (runEnd - runStart >= minSilenceFrames) {
+      // Found silence boundary
+      expandedEnd = runStart;
+      break;
     }
-  }
-  if (expandedEnd < dirtyEnd)
-    expandedEnd = dirtyEnd;
-  if (silenceCount < minSilenceFrames && expandedEnd < totalFrames) {
-    // Didn't find silence, expand to end
-    expandedEnd = totalFrames;
+    lower = runEnd;
   }
 
   DBG("expandToSilenceBoundaries: [" << dirtyStart << ", " << dirtyEnd
@@ -82,8 +255,239 @@ IncrementalSynthesizer::expandToSilenceBoundaries(int dirtyStart,
   return {expandedStart, expandedEnd};
 }
 
-void IncrementalSynthesizer::synthesizeRegion(ProgressCallback onProgress,
-                                              CompleteCallback onComplete) {
+std::vector<IncrementalSynthesizer::Segment>
+IncrementalSynthesizer::buildSegments(
+    const std::vector<std::pair<int, int>> &dirtyRanges, int totalFrames) {
+  // Windowed mode widens each range by the crossfade length only, so cost
+  // follows the edit size; otherwise expand to silence boundaries (no
+  // crossfade). Clamp, then merge ranges whose expansions now overlap.
+  std::vector<Segment> segments;
+  for (const auto &[dirtyStart, dirtyEnd] : dirtyRanges) {
+    int startFrame = dirtyStart;
+    int endFrame = dirtyEnd;
+    if (windowedResynthesis) {
+      startFrame -= crossfadeFrames;
+      endFrame += crossfadeFrames;
+    } else {
+      std::tie(startFrame, endFrame) =
+          expandToSilenceBoundaries(dirtyStart, dirtyEnd);
+    }
+    startFrame = std::max(0, startFrame);
+    endFrame = std::min(totalFrames, endFrame);
+    if (startFrame >= endFrame)
+      continue;
+
+    const int fadeIn =
+        windowedResynthesis ? std::max(0, dirtyStart - startFrame) : 0;
+    const int fadeOut =
+        windowedResynthesis ? std::max(0, endFrame - dirtyEnd) : 0;
+
+    if (!segments.empty() && startFrame <= segments.back().endFrame) {
+      auto &last = segments.back();
+      if (endFrame >= last.endFrame) {
+        last.endFrame = endFrame;
+        last.fadeOutFrames = fadeOut;
+      }
+      continue;
+    }
+
+    Segment segment;
+    segment.startFrame = startFrame;
+    segment.endFrame = endFrame;
+    segment.fadeInFrames = fadeIn;
+    segment.fadeOutFrames = fadeOut;
+    segments.push_back(segment);
+  }
+
+  for (auto &segment : segments) {
+    segment.paddedStart = std::max(0, segment.startFrame - contextFrames);
+    segment.paddedEnd = std::min(totalFrames, segment.endFrame + contextFrames);
+  }
+  return segments;
+}
+
+bool IncrementalSynthesizer::composeSegmentF0(
+    const std::vector<Segment> &segments, int totalFrames,
+    const BasePitchPatch *patch) {
+  TRACE_ZONE("IncrementalSynthesizer::composeSegmentF0");
+  const auto &audioData = project->getAudioData();
+  if (static_cast<int>(audioData.basePitch.size()) < totalFrames ||
+      audioData.deltaPitch.empty())
+    return false;
+
+  // Only the edited ranges are recomposed; the rest of the buffer is left
+  // stale and never read
+  adjustedF0Buffer.resize(static_cast<size_t>(totalFrames));
+  const int patchStart = patch ? patch->startFrame : 0;
+  const int patchEnd =
+      patch ? patchStart + static_cast<int>(patch->basePitch.size()) : 0;
+  std::vector<float> base;
+  for (const auto &segment : segments) {
+    float *out = adjustedF0Buffer.data() + segment.paddedStart;
+    const int overlapStart = std::max(segment.paddedStart, patchStart);
+    const int overlapEnd = std::min(segment.paddedEnd, patchEnd);
+    if (overlapStart >= overlapEnd) {
+      project->getAdjustedF0ForRange(segment.paddedStart, segment.paddedEnd,
+                                     out);
+      continue;
+    }
+    base.assign(audioData.basePitch.begin() + segment.paddedStart,
+                audioData.basePitch.begin() + segment.paddedEnd);
+    std::copy(patch->basePitch.begin() + (overlapStart - patchStart),
+              patch->basePitch.begin() + (overlapEnd - patchStart),
+              base.begin() + (overlapStart - segment.paddedStart));
+    project->getAdjustedF0ForRange(segment.paddedStart, segment.paddedEnd,
+                                   base.data(), out);
+  }
+  return true;
+}
+
+IncrementalSynthesizer::SynthesisInput
+IncrementalSynthesizer::packSegments(std::vector<Segment> &segments,
+                                     const Vocoder &renderer) {
+  TRACE_ZONE("IncrementalSynthesizer::packSegments");
+  const auto &adjustedF0 = adjustedF0Buffer;
+  const auto &audioData = project->getAudioData();
+
+  // Segments whose exact input was synthesized before (undo/redo, A/B
+  // toggling) come from the cache; only the rest go to the vocoder
+  SynthesisCache::Context cacheContext;
+  cacheContext.globalPitchOffset = project->getGlobalPitchOffset();
+  cacheContext.formantShift = project->getFormantShift();
+  cacheContext.modelPath = renderer.getModelFile().getFullPathName();
+  cacheContext.modelModified =
+      renderer.getModelFile().getLastModificationTime().toMilliseconds();
+  cacheContext.device = renderer.getExecutionDevice();
+  cacheContext.deviceId = renderer.getExecutionDeviceId();
+
+  cacheContext.noiseSeed =
+      renderer.isDeterministic() ? renderer.getNoiseSeed() + 1 : 0;
+
+  SynthesisInput input;
+  input.segmentAudio.resize(segments.size());
+  input.framePositions = std::make_shared<std::vector<int>>();
+  for (size_t i = 0; i < segments.size(); ++i) {
+    auto &segment = segments[i];
+    const auto paddedMel =
+        audioData.melSpectrogram.view(static_cast<size_t>(segment.paddedStart),
+                                      static_cast<size_t>(segment.paddedEnd));
+    segment.cacheKey = SynthesisCache::makeKey(
+        paddedMel, adjustedF0.data() + segment.paddedStart,
+        segment.startFrame - segment.paddedStart,
+        segment.endFrame - segment.startFrame, cacheContext);
+
+    if (getSynthesisCache().lookup(segment.cacheKey, input.segmentAudio[i])) {
+      segment.cached = true;
+      ++input.cachedSegments;
+      continue;
+    }
+
+    segment.packedOffset = input.frames;
+    input.frames += segment.paddedEnd - segment.paddedStart;
+    // The cache key is taken on the unshifted mel plus formantShift
+    MelFormantShift::appendShifted(input.mel, paddedMel,
+                                   cacheContext.formantShift);
+    input.f0.insert(input.f0.end(), adjustedF0.begin() + segment.paddedStart,
+                    adjustedF0.begin() + segment.paddedEnd);
+    for (int frame = segment.paddedStart; frame < segment.paddedEnd; ++frame)
+      input.framePositions->push_back(frame);
+  }
+  return input;
+}
+
+void IncrementalSynthesizer::scatterToCache(
+    const std::vector<Segment> &segments, std::vector<float> &synthesizedAudio,
+    int packedFrames, int hopSize,
+    std::vector<std::vector<float>> &segmentAudio) {
+  TRACE_ZONE("IncrementalSynthesizer::scatterToCache");
+  // Pad or trim so every packed frame maps to exactly hopSize samples
+  const size_t expectedSamples =
+      static_cast<size_t>(packedFrames) * static_cast<size_t>(hopSize);
+  synthesizedAudio.resize(expectedSamples, 0.0f);
+
+  // Scatter packed output back per segment, dropping the context frames,
+  // and remember it for the next time this input comes up
+  for (size_t i = 0; i < segments.size(); ++i) {
+    const auto &segment = segments[i];
+    if (segment.cached)
+      continue;
+    const auto begin =
+        synthesizedAudio.begin() +
+        static_cast<std::ptrdiff_t>(segment.packedOffset + segment.startFrame -
+                                    segment.paddedStart) *
+            hopSize;
+    segmentAudio[i].assign(
+        begin, begin + static_cast<std::ptrdiff_t>(segment.endFrame -
+                                                   segment.startFrame) *
+                           hopSize);
+    getSynthesisCache().insert(segment.cacheKey, segmentAudio[i]);
+  }
+}
+
+void IncrementalSynthesizer::prefetchRegion(
+    const std::vector<std::pair<int, int>> &dirtyRanges,
+    const BasePitchPatch &patch) {
+  TRACE_ZONE("IncrementalSynthesizer::prefetchRegion");
+  // The vocoder synthesizeRegion() will use, so its lookups hit
+  auto *renderer = getEditVocoder();
+  if (!project || !renderer || !renderer->isLoaded() || dirtyRanges.empty())
+    return;
+
+  const auto &audioData = project->getAudioData();
+  const int totalFrames = static_cast<int>(
+      std::min(audioData.melSpectrogram.size(), audioData.f0.size()));
+  if (totalFrames == 0)
+    return;
+
+  auto segments = buildSegments(dirtyRanges, totalFrames);
+  if (segments.empty() ||
+      !composeSegmentF0(segments, totalFrames,
+                        patch.basePitch.empty() ? nullptr : &patch))
+    return;
+
+  // Already cached (e.g. the drag came back to an earlier pitch)
+  SynthesisInput input = packSegments(segments, *renderer);
+  if (input.frames == 0)
+    return;
+
+  DBG("prefetchRegion: " << static_cast<int>(segments.size())
+                         << " segment(s), " << input.frames
+                         << " packed frames");
+
+  // Below interactive work; a newer guess for an overlapping range replaces
+  // this one, but guesses never replace a real edit
+  Vocoder::AsyncOptions asyncOptions;
+  asyncOptions.priority = Vocoder::Priority::PlaybackAhead;
+  asyncOptions.coalesceKey = reinterpret_cast<std::uintptr_t>(this) + 1;
+  asyncOptions.startFrame = segments.front().startFrame;
+  asyncOptions.endFrame = segments.back().endFrame;
+  asyncOptions.framePositions = input.framePositions;
+
+  const int hopSize = renderer->getHopSize();
+  const int packedFrames = input.frames;
+  renderer->inferAsync(
+      input.mel, input.f0,
+      [this, segments, packedFrames, hopSize,
+       segmentAudio = std::move(input.segmentAudio)](
+          std::vector<float> synthesizedAudio) mutable {
+        if (synthesizedAudio.empty())
+          return;
+        enqueueApply(0, [this, segments, packedFrames, hopSize,
+                         segmentAudio = std::move(segmentAudio),
+                      synthesizedAudio =
+                          std::move(synthesizedAudio)]() mutable {
+          scatterToCache(segments, synthesizedAudio, packedFrames, hopSize,
+                         segmentAudio);
+        });
+      },
+      nullptr, asyncOptions);
+}
+
+void IncrementalSynthesizer::synthesizeRegion(
+    ProgressCallback onProgress, CompleteCallback onComplete,
+    SegmentsReadyCallback onSegmentsReady) {
+  TRACE_ZONE("IncrementalSynthesizer::synthesizeRegion");
+  const auto startTicks = juce::Time::getHighResolutionTicks();
   if (!project || !vocoder) {
     if (onComplete)
       onComplete(false);
@@ -97,7 +501,8 @@ void IncrementalSynthesizer::synthesizeRegion(ProgressCallback onProgress,
     return;
   }
 
-  if (!vocoder->isLoaded()) {
+  auto *renderer = getEditVocoder();
+  if (!renderer->isLoaded()) {
     if (onComplete)
       onComplete(false);
     return;
@@ -110,41 +515,113 @@ void IncrementalSynthesizer::synthesizeRegion(ProgressCallback onProgress,
     return;
   }
 
-  auto [dirtyStart, dirtyEnd] = project->getDirtyFrameRange();
-  if (dirtyStart < 0 || dirtyEnd < 0) {
+  auto dirtyRanges = project->getDirtyFrameRanges();
+  if (dirtyRanges.empty()) {
     if (onComplete)
       onComplete(false);
     return;
   }
 
-  // Expand to silence boundaries (no padding, no crossfade)
-  auto [startFrame, endFrame] = expandToSilenceBoundaries(dirtyStart, dirtyEnd);
+  auto progress = std::make_shared<JobProgress>();
+  progress->renderer = renderer;
+  progress->onComplete = std::move(onComplete);
+  progress->onSegmentsReady = std::move(onSegmentsReady);
+  progress->startTicks = startTicks;
+  startJob(dirtyRanges, std::move(progress), onProgress);
+}
 
-  // Clamp to valid range
-  startFrame = std::max(0, startFrame);
-  endFrame =
-      std::min(static_cast<int>(audioData.melSpectrogram.size()), endFrame);
+bool IncrementalSynthesizer::auditionRegion(
+    SegmentsReadyCallback onSegmentsReady) {
+  TRACE_ZONE("IncrementalSynthesizer::auditionRegion");
+  if (!project || !vocoder || isBusy.load() ||
+      (!project->hasDirtyNotes() && !project->hasF0DirtyRange()))
+    return false;
+  const auto &audioData = project->getAudioData();
+  if (audioData.melSpectrogram.empty() || audioData.f0.empty())
+    return false;
+
+  const auto dirtyRanges = project->getDirtyFrameRanges();
+  const int totalFrames = static_cast<int>(
+      std::min(audioData.melSpectrogram.size(), audioData.f0.size()));
+  auto segments = buildSegments(dirtyRanges, totalFrames);
+  if (segments.empty() || !composeSegmentF0(segments, totalFrames))
+    return false;
+  for (auto &segment : segments)
+    segment.targetF0.assign(adjustedF0Buffer.begin() + segment.startFrame,
+                            adjustedF0Buffer.begin() + segment.endFrame);
+  ensureRenderedF0(totalFrames);
+
+  // Supersedes an audition still waiting for the apply worker
+  if (cancelFlag)
+    cancelFlag->store(true);
+  cancelFlag = std::make_shared<std::atomic<bool>>(false);
+  const uint64_t currentJobId = ++jobId;
+
+  auto progress = std::make_shared<JobProgress>();
+  progress->onSegmentsReady = std::move(onSegmentsReady);
+  progress->notes = project->getNoteSnapshot();
+  startPreview(segments, cancelFlag, project, vocoder->getHopSize(),
+               currentJobId, progress);
+  return true;
+}
 
-  if (startFrame >= endFrame) {
-    if (onComplete)
-      onComplete(false);
-    return;
+bool IncrementalSynthesizer::refinePreviewRegions(CompleteCallback onComplete) {
+  TRACE_ZONE("IncrementalSynthesizer::refinePreviewRegions");
+  if (!project || !vocoder || !vocoder->isLoaded() || isBusy.load() ||
+      project->hasDirtyNotes() || project->hasF0DirtyRange())
+    return false;
+  const auto &audioData = project->getAudioData();
+  if (audioData.melSpectrogram.empty() || audioData.f0.empty())
+    return false;
+
+  std::vector<std::pair<int, int>> ranges;
+  {
+    std::lock_guard<std::mutex> lock(previewRangesMutex);
+    ranges = previewRanges;
   }
+  if (ranges.empty())
+    return false;
+
+  DBG("refinePreviewRegions: " << static_cast<int>(ranges.size())
+                               << " range(s)");
+  auto progress = std::make_shared<JobProgress>();
+  progress->renderer = vocoder;
+  progress->refinement = true;
+  progress->onComplete = std::move(onComplete);
+  startJob(ranges, std::move(progress), nullptr);
+  return true;
+}
 
-  // Extract mel spectrogram range
-  std::vector<std::vector<float>> melRange(
-      audioData.melSpectrogram.begin() + startFrame,
-      audioData.melSpectrogram.begin() + endFrame);
+void IncrementalSynthesizer::startJob(
+    const std::vector<std::pair<int, int>> &dirtyRanges,
+    std::shared_ptr<JobProgress> progress, const ProgressCallback &onProgress) {
+  auto &audioData = project->getAudioData();
+  const int totalFrames = static_cast<int>(
+      std::min(audioData.melSpectrogram.size(), audioData.f0.size()));
 
-  // Get adjusted F0 for range
-  std::vector<float> adjustedF0Range =
-      project->getAdjustedF0ForRange(startFrame, endFrame);
+  auto segments = buildSegments(dirtyRanges, totalFrames);
 
-  if (melRange.empty() || adjustedF0Range.empty()) {
-    if (onComplete)
-      onComplete(false);
-    return;
-  }
+  auto fail = [&progress]() {
+    if (progress->onComplete)
+      progress->onComplete(false);
+  };
+  if (segments.empty())
+    return fail();
+
+  // Pack the segments, with context frames on both sides, into one mel/F0
+  // sequence per batch, so all edits cost a single vocoder call (two while
+  // playing). The context absorbs the seams between unrelated segments and
+  // is discarded when scattering back.
+  if (!composeSegmentF0(segments, totalFrames))
+    return fail();
+
+  for (auto &segment : segments)
+    segment.targetF0.assign(adjustedF0Buffer.begin() + segment.startFrame,
+                            adjustedF0Buffer.begin() + segment.endFrame);
+  ensureRenderedF0(totalFrames);
+
+  const int hopSize = progress->renderer->getHopSize();
+  auto batches = scheduleForPlayback(std::move(segments), hopSize);
 
   if (onProgress)
     onProgress(TR("progress.synthesizing"));
@@ -155,150 +632,392 @@ void IncrementalSynthesizer::synthesizeRegion(ProgressCallback onProgress,
   cancelFlag = std::make_shared<std::atomic<bool>>(false);
   uint64_t currentJobId = ++jobId;
 
+  refining = progress->refinement;
   isBusy = true;
+  lastActivityTicks = juce::Time::getHighResolutionTicks();
+
+  progress->batchesLeft = batches.size();
+  // The apply worker reads these instead of the notes the UI keeps editing
+  progress->notes = project->getNoteSnapshot();
+
+  // Submitted in schedule order; at equal priority the vocoder runs them in
+  // that order too
+  for (size_t i = 0; i < batches.size(); ++i)
+    startBatch(std::move(batches[i]), i > 0, cancelFlag, project, hopSize,
+               currentJobId, progress);
+}
+
+std::vector<std::vector<IncrementalSynthesizer::Segment>>
+IncrementalSynthesizer::scheduleForPlayback(std::vector<Segment> segments,
+                                            int hopSize) const {
+  std::vector<std::vector<Segment>> batches;
+  const auto playhead =
+      playheadProvider ? playheadProvider()
+                       : std::optional<SynthesisScheduler::Playhead>();
+  const double framesPerSecond =
+      static_cast<double>(project->getAudioData().sampleRate) / hopSize;
+
+  if (!playhead || segments.size() < 2 || framesPerSecond <= 0.0) {
+    batches.push_back(std::move(segments));
+    return batches;
+  }
+
+  std::vector<std::pair<int, int>> ranges;
+  ranges.reserve(segments.size());
+  for (const auto &segment : segments)
+    ranges.emplace_back(segment.startFrame, segment.endFrame);
+  const auto order =
+      SynthesisScheduler::orderByPlayback(ranges, *playhead, framesPerSecond);
+
+  const int leadFrames =
+      static_cast<int>(std::ceil(playbackLeadSeconds * framesPerSecond));
+  const bool wholeLoop = playhead->looping && playhead->loopFocus;
+  const int loopStartFrame =
+      static_cast<int>(playhead->loopStartSeconds * framesPerSecond);
+  const int loopEndFrame = static_cast<int>(
+      std::ceil(playhead->loopEndSeconds * framesPerSecond));
+  std::vector<Segment> next;
+  std::vector<Segment> rest;
+  for (size_t index : order) {
+    const int distance = SynthesisScheduler::framesUntilHeard(
+        ranges[index].first, ranges[index].second, *playhead,
+        framesPerSecond);
+    const bool reached = distance != SynthesisScheduler::notReached;
+    const bool inLoop = wholeLoop && ranges[index].first < loopEndFrame &&
+                        ranges[index].second > loopStartFrame;
+    if (inLoop || (reached && (next.empty() || distance <= leadFrames)))
+      next.push_back(segments[index]);
+    else
+      rest.push_back(segments[index]);
+  }
 
-  int hopSize = vocoder->getHopSize();
-  int capturedStartFrame = startFrame;
-  int capturedEndFrame = endFrame;
+  if (!next.empty())
+    batches.push_back(std::move(next));
+  if (!rest.empty())
+    batches.push_back(std::move(rest));
+  return batches;
+}
+
+void IncrementalSynthesizer::ensureRenderedF0(int totalFrames) {
+  std::lock_guard<std::mutex> lock(renderedF0Mutex);
+  if (renderedF0Project == project &&
+      static_cast<int>(renderedF0.size()) == totalFrames)
+    return;
+
+  // Nothing synthesized yet: the waveform is the recording, whose pitch the
+  // notes kept from detection at their source positions
+  renderedF0Project = project;
+  renderedF0.assign(static_cast<size_t>(totalFrames), 0.0f);
+  for (const auto &note : project->getNotes()) {
+    const auto &detected = note.getF0Values();
+    const int start = std::max(0, note.getSrcStartFrame());
+    const int count = std::min({static_cast<int>(detected.size()),
+                                note.getSrcDurationFrames(),
+                                totalFrames - start});
+    if (count > 0)
+      std::copy_n(detected.begin(), count, renderedF0.begin() + start);
+  }
+}
 
-  // Capture for lambda
-  auto capturedCancelFlag = cancelFlag;
-  auto capturedProject = project;
+void IncrementalSynthesizer::startPreview(
+    const std::vector<Segment> &segments,
+    const std::shared_ptr<std::atomic<bool>> &capturedCancelFlag,
+    Project *capturedProject, int hopSize, uint64_t currentJobId,
+    const std::shared_ptr<JobProgress> &progress) {
+  std::vector<Segment> previewed;
+  for (const auto &segment : segments)
+    if (!segment.cached)
+      previewed.push_back(segment);
+  if (previewed.empty())
+    return;
 
-  DBG("synthesizeRegion: frames [" << startFrame << ", " << endFrame << "]");
+  enqueueApply(currentJobId, [this, capturedCancelFlag, capturedProject,
+                              previewed = std::move(previewed), hopSize,
+                              currentJobId, progress]() {
+    if (currentJobId != jobId.load() || capturedCancelFlag->load())
+      return;
+
+    auto &audioData = capturedProject->getAudioData();
+    const int sampleRate = audioData.sampleRate;
+    const int totalSamples = audioData.waveform.getNumSamples();
+    if (totalSamples == 0 || audioData.waveform.getNumChannels() == 0)
+      return;
+
+    std::vector<float> sourceF0;
+    {
+      std::lock_guard<std::mutex> lock(renderedF0Mutex);
+      sourceF0 = renderedF0;
+    }
+    auto targetF0 = sourceF0;
+    for (const auto &segment : previewed)
+      copyTargetF0(segment, targetF0);
+
+    // Render every segment before writing any, so each reads the audio as
+    // it was
+    const float *source = audioData.waveform.getReadPointer(0);
+    std::vector<std::vector<float>> previewAudio;
+    previewAudio.reserve(previewed.size());
+    for (const auto &segment : previewed)
+      previewAudio.push_back(PsolaPreview::render(
+          source, totalSamples, segment.startFrame * hopSize,
+          segment.endFrame * hopSize, sourceF0, targetF0, hopSize,
+          sampleRate));
+
+    if (writeSegments(capturedProject, progress->notes, previewed,
+                      previewAudio, hopSize) <= 0)
+      return;
+    // A superseded job's preview stays in the waveform, so the next preview
+    // must start from its pitch
+    recordRenderedF0(previewed);
+    if (progress->onSegmentsReady)
+      juce::MessageManager::callAsync(progress->onSegmentsReady);
+  });
+}
+
+void IncrementalSynthesizer::recordRenderedF0(
+    const std::vector<Segment> &segments) {
+  std::lock_guard<std::mutex> lock(renderedF0Mutex);
+  for (const auto &segment : segments)
+    copyTargetF0(segment, renderedF0);
+}
+
+void IncrementalSynthesizer::startBatch(
+    std::vector<Segment> segments, bool deferred,
+    const std::shared_ptr<std::atomic<bool>> &capturedCancelFlag,
+    Project *capturedProject, int hopSize, uint64_t currentJobId,
+    const std::shared_ptr<JobProgress> &progress) {
+  auto *renderer = progress->renderer;
+  SynthesisInput input = packSegments(segments, *renderer);
+  auto &segmentAudio = input.segmentAudio;
+  const int packedFrames = input.frames;
+
+  DBG("synthesizeRegion: " << static_cast<int>(segments.size())
+                           << " segment(s), " << input.cachedSegments
+                           << " cached, " << packedFrames
+                           << " packed frames" << (deferred ? " (deferred)" : ""));
+
+  if (packedFrames == 0) {
+    // Everything was cached: no vocoder call, just copy samples in
+    enqueueApply(currentJobId,
+                 [this, capturedCancelFlag, capturedProject, segments,
+                  segmentAudio = std::move(segmentAudio), hopSize,
+                  currentJobId, progress]() {
+                   commitBatch(capturedCancelFlag, capturedProject, segments,
+                               segmentAudio, hopSize, currentJobId, progress);
+                 });
+    return;
+  }
+
+  // Queued ahead of the vocoder result, so the apply worker writes it first
+  if (instantPreview && progress->onSegmentsReady)
+    startPreview(segments, capturedCancelFlag, capturedProject, hopSize,
+                 currentJobId, progress);
+
+  // Edits are interactive; a newer request for an overlapping range
+  // replaces this one in the vocoder queue before it reaches ONNX. The
+  // batches of one job use separate keys so they never supersede each other.
+  Vocoder::AsyncOptions asyncOptions;
+  if (progress->refinement)
+    asyncOptions.priority = background ? Vocoder::Priority::Export
+                                       : Vocoder::Priority::PlaybackAhead;
+  else
+    asyncOptions.priority = background ? Vocoder::Priority::PlaybackAhead
+                                       : Vocoder::Priority::Interactive;
+  asyncOptions.coalesceKey =
+      reinterpret_cast<std::uintptr_t>(this) + (deferred ? 2 : 0);
+  asyncOptions.startFrame = segments.front().startFrame;
+  asyncOptions.endFrame = segments.front().endFrame;
+  for (const auto &segment : segments) {
+    asyncOptions.startFrame =
+        std::min(asyncOptions.startFrame, segment.startFrame);
+    asyncOptions.endFrame = std::max(asyncOptions.endFrame, segment.endFrame);
+  }
+  asyncOptions.framePositions = input.framePositions;
 
   // Run vocoder inference asynchronously
-  vocoder->inferAsync(
-      melRange, adjustedF0Range,
-      [this, capturedCancelFlag, capturedProject, capturedStartFrame,
-       capturedEndFrame, hopSize, currentJobId,
-       onComplete](std::vector<float> synthesizedAudio) {
+  renderer->inferAsync(
+      input.mel, input.f0,
+      [this, capturedCancelFlag, capturedProject, segments, packedFrames,
+       hopSize, currentJobId, progress,
+       segmentAudio = std::move(segmentAudio)](
+          std::vector<float> synthesizedAudio) mutable {
         // If this callback is for an older job, ignore it completely.
         // (A newer job is running or has run, and must own completion.)
         if (currentJobId != jobId.load())
           return;
 
-        // Check if cancelled
-        if (capturedCancelFlag->load()) {
-          isBusy = false;
-          if (onComplete)
-            onComplete(false);
-          return;
-        }
-
-        if (synthesizedAudio.empty()) {
-          isBusy = false;
-          if (onComplete)
-            onComplete(false);
-          return;
-        }
-
-        // Apply waveform replacement off the message thread to avoid UI stalls.
+        // Apply waveform replacement on the apply worker to avoid UI stalls.
         // We keep job ordering by checking jobId again before committing.
-        std::thread([this, capturedCancelFlag, capturedProject,
-                     capturedStartFrame, capturedEndFrame, hopSize,
-                     currentJobId, onComplete,
-                     synthesizedAudio = std::move(synthesizedAudio)]() mutable {
-          // If superseded, abort silently
-          if (currentJobId != jobId.load())
-            return;
-
-          if (capturedCancelFlag->load()) {
-            isBusy = false;
-            if (onComplete)
-              juce::MessageManager::callAsync(
-                  [onComplete]() { onComplete(false); });
-            return;
+        enqueueApply(currentJobId, [this, capturedCancelFlag, capturedProject,
+                                    segments, packedFrames, hopSize,
+                                    currentJobId, progress,
+                                    segmentAudio = std::move(segmentAudio),
+                                    synthesizedAudio =
+                                        std::move(synthesizedAudio)]() mutable {
+          if (synthesizedAudio.empty()) {
+            // Failed or cancelled: commitBatch counts it as failed
+            segmentAudio.clear();
+          } else {
+            scatterToCache(segments, synthesizedAudio, packedFrames, hopSize,
+                           segmentAudio);
           }
+          commitBatch(capturedCancelFlag, capturedProject, segments,
+                      segmentAudio, hopSize, currentJobId, progress);
+        });
+      },
+      capturedCancelFlag, asyncOptions);
+}
 
-          auto &audioData = capturedProject->getAudioData();
-          int totalSamples = audioData.waveform.getNumSamples();
-          int numChannels = audioData.waveform.getNumChannels();
-
-          int startSample = capturedStartFrame * hopSize;
-          int expectedSamples =
-              std::max(0, (capturedEndFrame - capturedStartFrame) * hopSize);
-          if (expectedSamples <= 0) {
-            isBusy = false;
-            if (onComplete)
-              juce::MessageManager::callAsync(
-                  [onComplete]() { onComplete(false); });
-            return;
-          }
+int IncrementalSynthesizer::writeSegments(
+    Project *capturedProject,
+    const std::shared_ptr<const std::vector<Note>> &notes,
+    const std::vector<Segment> &segments,
+    const std::vector<std::vector<float>> &segmentAudio, int hopSize) {
+  TRACE_ZONE("IncrementalSynthesizer::writeSegments");
+  auto &audioData = capturedProject->getAudioData();
+  audioData.prepareWaveformWrite();
+  int totalSamples = audioData.waveform.getNumSamples();
+  int numChannels = audioData.waveform.getNumChannels();
+
+  const auto spansHandle = getNoteSpans(notes);
+  const auto &spans = *spansHandle;
+  int replacedSamples = 0;
+  std::vector<std::pair<int, int>> writtenRanges;
+  const float halfPi = juce::MathConstants<float>::halfPi;
+  for (size_t index = 0; index < segments.size(); ++index) {
+    const auto &segment = segments[index];
+    const auto &samples = segmentAudio[index];
+    int startSample = segment.startFrame * hopSize;
+    int samplesToReplace =
+        std::min({static_cast<int>(samples.size()),
+                  (segment.endFrame - segment.startFrame) * hopSize,
+                  totalSamples - startSample});
+    if (samplesToReplace <= 0)
+      continue;
+
+    // Equal-power crossfade over the fade frames at each end; the middle
+    // (and everything in silence-boundary mode) is replaced directly
+    const int fadeInSamples =
+        std::min(segment.fadeInFrames * hopSize, samplesToReplace);
+    const int fadeOutSamples = std::min(segment.fadeOutFrames * hopSize,
+                                        samplesToReplace - fadeInSamples);
+    const int fadeOutStart = samplesToReplace - fadeOutSamples;
+    for (int ch = 0; ch < numChannels; ++ch) {
+      float *dstCh = audioData.waveform.getWritePointer(ch) + startSample;
+      std::copy(samples.data() + fadeInSamples, samples.data() + fadeOutStart,
+                dstCh + fadeInSamples);
+      for (int i = 0; i < fadeInSamples; ++i) {
+        const float t = (static_cast<float>(i) + 0.5f) /
+                        static_cast<float>(fadeInSamples);
+        dstCh[i] = dstCh[i] * std::cos(t * halfPi) +
+                   samples[static_cast<size_t>(i)] * std::sin(t * halfPi);
+      }
+      for (int i = fadeOutStart; i < samplesToReplace; ++i) {
+        const float t = (static_cast<float>(i - fadeOutStart) + 0.5f) /
+                        static_cast<float>(fadeOutSamples);
+        dstCh[i] = samples[static_cast<size_t>(i)] * std::cos(t * halfPi) +
+                   dstCh[i] * std::sin(t * halfPi);
+      }
+    }
+    replacedSamples += samplesToReplace;
+    writtenRanges.emplace_back(startSample, startSample + samplesToReplace);
+
+    // Silence regions outside note boundaries
+    // This ensures that when notes are shrunk, the silence is preserved.
+    // One sweep over the sorted spans finds the gaps inside this segment.
+    auto span = std::lower_bound(
+        spans.begin(), spans.end(), segment.startFrame,
+        [](const std::pair<int, int> &s, int frame) { return s.second <= frame; });
+    int frame = segment.startFrame;
+    while (frame < segment.endFrame) {
+      const int gapEnd = (span == spans.end())
+                             ? segment.endFrame
+                             : std::min(segment.endFrame, span->first);
+      if (frame < gapEnd) {
+        const int sampleStart = frame * hopSize;
+        const int sampleEnd = std::min(gapEnd * hopSize, totalSamples);
+        for (int ch = 0; ch < numChannels && sampleStart < sampleEnd; ++ch) {
+          float *dstCh = audioData.waveform.getWritePointer(ch);
+          std::fill(dstCh + sampleStart, dstCh + sampleEnd, 0.0f);
+        }
+      }
+      if (span == spans.end())
+        break;
+      frame = std::max(frame, span->second);
+      ++span;
+    }
+  }
 
-          if (static_cast<int>(synthesizedAudio.size()) != expectedSamples) {
-            if (static_cast<int>(synthesizedAudio.size()) > expectedSamples) {
-              synthesizedAudio.resize(static_cast<size_t>(expectedSamples));
-            } else {
-              synthesizedAudio.resize(static_cast<size_t>(expectedSamples),
-                                      0.0f);
-            }
-          }
+  if (replacedSamples > 0) {
+    DBG("synthesizeRegion: replaced " << replacedSamples << " samples in "
+                                      << static_cast<int>(segments.size())
+                                      << " segment(s)");
 
-          int samplesToReplace =
-              std::min(expectedSamples, totalSamples - startSample);
-          if (samplesToReplace <= 0) {
-            isBusy = false;
-            if (onComplete)
-              juce::MessageManager::callAsync(
-                  [onComplete]() { onComplete(false); });
-            return;
-          }
+    // Publish the edit to readers: only the touched tiles are re-copied
+    audioData.updateRenderSnapshot(writtenRanges);
+  }
+  return replacedSamples;
+}
 
-          if (samplesToReplace < expectedSamples) {
-            synthesizedAudio.resize(static_cast<size_t>(samplesToReplace));
-          }
+std::shared_ptr<const std::vector<std::pair<int, int>>>
+IncrementalSynthesizer::getNoteSpans(
+    const std::shared_ptr<const std::vector<Note>> &notes) {
+  std::lock_guard<std::mutex> lock(noteSpansMutex);
+  if (noteSpans == nullptr || noteSpansSource != notes) {
+    noteSpans = std::make_shared<const std::vector<std::pair<int, int>>>(
+        buildNoteSpans(*notes));
+    noteSpansSource = notes;
+  }
+  return noteSpans;
+}
 
-          if (samplesToReplace <= 0) {
-            isBusy = false;
-            if (onComplete)
-              juce::MessageManager::callAsync(
-                  [onComplete]() { onComplete(false); });
-            return;
-          }
+void IncrementalSynthesizer::commitBatch(
+    const std::shared_ptr<std::atomic<bool>> &capturedCancelFlag,
+    Project *capturedProject, const std::vector<Segment> &segments,
+    const std::vector<std::vector<float>> &segmentAudio, int hopSize,
+    uint64_t currentJobId, const std::shared_ptr<JobProgress> &progress) {
+  TRACE_ZONE("IncrementalSynthesizer::commitBatch");
+  // If superseded, abort silently
+  if (currentJobId != jobId.load())
+    return;
 
-          // Direct replacement - no crossfade
-          for (int ch = 0; ch < numChannels; ++ch) {
-            float *dstCh = audioData.waveform.getWritePointer(ch);
-            for (int i = 0; i < samplesToReplace; ++i) {
-              dstCh[startSample + i] = synthesizedAudio[static_cast<size_t>(i)];
-            }
-          }
+  if (capturedCancelFlag->load() || segmentAudio.size() != segments.size())
+    progress->failed = true;
+  else {
+    progress->replacedSamples +=
+        writeSegments(capturedProject, progress->notes, segments,
+                      segmentAudio, hopSize);
+    recordRenderedF0(segments);
+    recordRenderer(segments, progress->renderer);
+  }
 
-          // Silence regions outside note boundaries
-          // This ensures that when notes are shrunk, the silence is preserved
-          auto& notes = capturedProject->getNotes();
-          for (int ch = 0; ch < numChannels; ++ch) {
-            float *dstCh = audioData.waveform.getWritePointer(ch);
-            for (int frame = capturedStartFrame; frame < capturedEndFrame; ++frame) {
-              bool inNote = false;
-              for (const auto& note : notes) {
-                if (!note.isRest() && frame >= note.getStartFrame() && frame < note.getEndFrame()) {
-                  inNote = true;
-                  break;
-                }
-              }
-              if (!inNote) {
-                // This frame is not covered by any note - silence it
-                int sampleStart = frame * hopSize;
-                int sampleEnd = std::min(sampleStart + hopSize, totalSamples);
-                for (int i = sampleStart; i < sampleEnd; ++i) {
-                  dstCh[i] = 0.0f;
-                }
-              }
-            }
-          }
+  if (progress->startTicks != 0 && progress->replacedSamples > 0) {
+    const double latencyMs =
+        1000.0 * juce::Time::highResolutionTicksToSeconds(
+                     juce::Time::getHighResolutionTicks() -
+                     progress->startTicks);
+    lastEditLatencyMs = latencyMs;
+    PerformanceMetrics::getInstance().recordEditLatency(latencyMs);
+    progress->startTicks = 0;
+  }
 
-          DBG("synthesizeRegion: replaced " << samplesToReplace
-                                            << " samples at " << startSample);
+  if (--progress->batchesLeft > 0) {
+    // The segments heard next are in; let playback pick them up now
+    if (!progress->failed && progress->replacedSamples > 0 &&
+        progress->onSegmentsReady)
+      juce::MessageManager::callAsync(progress->onSegmentsReady);
+    return;
+  }
 
-          // Clear dirty flags
-          capturedProject->clearAllDirty();
+  const bool success = !progress->failed && progress->replacedSamples > 0;
 
-          isBusy = false;
-          if (onComplete)
-            juce::MessageManager::callAsync(
-                [onComplete]() { onComplete(true); });
-        }).detach();
-      });
+  // Clear dirty flags once every batch is in; a refinement found none
+  if (success && !progress->refinement)
+    capturedProject->clearAllDirty();
+
+  isBusy = false;
+  lastActivityTicks = juce::Time::getHighResolutionTicks();
+  if (auto onComplete = progress->onComplete)
+    juce::MessageManager::callAsync(
+        [onComplete, success]() { onComplete(success); });
 }
@@ -2,44 +2,184 @@
 
 #include "../../JuceHeader.h"
 #include "../../Models/Project.h"
+#include "../../Utils/JobSystem.h"
 #include "../Vocoder.h"
+#include "SynthesisCache.h"
+#include "SynthesisScheduler.h"
 #include <atomic>
+#include <deque>
 #include <functional>
 #include <memory>
-#include <thread>
+#include <mutex>
+#include <optional>
 #include <vector>
 
 /**
  * Handles audio synthesis for edited regions.
  * Uses vocoder to resynthesize dirty (modified) portions of audio.
- * Expands dirty region to nearest silence boundaries for clean cuts.
+ * By default each dirty range is widened by a few frames and crossfaded into
+ * the existing waveform; the legacy mode expands it to the nearest silence
+ * boundaries for clean cuts instead.
  */
 class IncrementalSynthesizer {
 public:
   using ProgressCallback = std::function<void(const juce::String &message)>;
   using CompleteCallback = std::function<void(bool success)>;
+  using SegmentsReadyCallback = std::function<void()>;
+  // Current transport, or nullopt when not playing
+  using PlayheadProvider =
+      std::function<std::optional<SynthesisScheduler::Playhead>()>;
 
   IncrementalSynthesizer();
   ~IncrementalSynthesizer();
 
   void setVocoder(Vocoder *v) { vocoder = v; }
-  void setProject(Project *p) { project = p; }
+  void setProject(Project *p);
 
   /**
-   * Synthesize the dirty region.
-   * - Finds dirty frame range from project
-   * - Expands to nearest silence boundaries
-   * - Synthesizes entire region (no padding, no crossfade)
-   * - Direct replacement of samples
+   * Preview tier: a lighter vocoder (a distilled model or a reduced-precision
+   * session) that renders edits while it is set, loaded and the tier is on.
+   * The ranges it rendered are remembered until refinePreviewRegions() has
+   * re-rendered them with the main vocoder.
+   */
+  void setPreviewVocoder(Vocoder *v) { previewVocoder.store(v); }
+  Vocoder *getPreviewVocoder() const { return previewVocoder.load(); }
+  void setPreviewTier(bool enabled) { previewTier = enabled; }
+  bool isPreviewTier() const { return previewTier.load(); }
+
+  /**
+   * Whether ranges rendered by the preview vocoder are waiting for the main
+   * one and nothing has been synthesized for idleSeconds.
+   */
+  bool needsRefinement(double idleSeconds) const;
+
+  /** Frames [first, second) spanning the preview-quality ranges, or -1s. */
+  std::pair<int, int> getPreviewFrameRange() const;
+
+  /**
+   * Re-render the preview-quality ranges with the main vocoder, below edits
+   * in the vocoder queue. Only starts with no dirty edits and nothing
+   * synthesizing; a later synthesizeRegion() supersedes it. Dirty flags are
+   * left alone. Returns false (onComplete not called) when it did not start.
+   */
+  bool refinePreviewRegions(CompleteCallback onComplete);
+
+  /**
+   * Where playback is, read when synthesizeRegion() starts. While playing,
+   * the segments heard within playbackLeadSeconds go to the vocoder first,
+   * as their own request, and are written into the waveform as soon as they
+   * finish; ranges already passed are synthesized last.
+   */
+  void setPlayheadProvider(PlayheadProvider provider) {
+    playheadProvider = std::move(provider);
+  }
+
+  /**
+   * Windowed resynthesis (default) keeps cost bounded by the edit size:
+   * dirty range plus crossfadeFrames on each side, equal-power crossfaded.
+   * When off, ranges expand to silence boundaries, which on legato material
+   * can mean the whole file.
+   */
+  void setWindowedResynthesis(bool enabled) { windowedResynthesis = enabled; }
+  bool isWindowedResynthesis() const { return windowedResynthesis; }
+
+  /**
+   * Instant preview (default on): while the vocoder renders, the segments
+   * it has to synthesize are pitch-shifted with PSOLA from the audio already
+   * in the waveform and handed to playback through onSegmentsReady; the
+   * vocoder output then replaces them. Needs onSegmentsReady to do anything.
+   */
+  void setInstantPreview(bool enabled) { instantPreview = enabled; }
+  bool isInstantPreview() const { return instantPreview; }
+
+  /**
+   * Background synthesizers (tracks of a session that are not being edited)
+   * queue their edits behind the focused track's in the shared vocoder:
+   * their edits go at playback priority and their refinements last.
+   */
+  void setBackground(bool enabled) { background = enabled; }
+  bool isBackground() const { return background.load(); }
+
+  /**
+   * Look up and store segments in cache, owned by the caller and outliving
+   * this synthesizer, instead of this synthesizer's own; null goes back to
+   * the own cache. Keys depend only on content, so tracks rendering the
+   * same take share their segments. Set before synthesizing.
+   */
+  void setSharedCache(SynthesisCache *cache) { sharedCache = cache; }
+
+  /**
+   * Synthesize the dirty regions.
+   * - Takes the disjoint dirty frame ranges from the project
+   * - Widens each by the crossfade length (or to silence boundaries)
+   * - Reuses cached output for ranges whose input was synthesized before
+   * - Packs the remaining ranges (plus context frames) into one vocoder call
+   * - Crossfades each range into the waveform (direct replacement in
+   *   silence-boundary mode)
+   * When playback is running, the ranges about to be heard are committed
+   * first and onSegmentsReady is called (on the message thread) before
+   * onComplete, so the caller can reload playback early.
    */
   void synthesizeRegion(ProgressCallback onProgress,
-                        CompleteCallback onComplete);
+                        CompleteCallback onComplete,
+                        SegmentsReadyCallback onSegmentsReady = nullptr);
+
+  /**
+   * Audition the dirty regions without the vocoder: the segments
+   * synthesizeRegion() would render are pitch-shifted with PSOLA from the
+   * waveform, as by instant preview, and onSegmentsReady is called on the
+   * message thread once they are written. Dirty flags are left alone, so a
+   * later synthesizeRegion() renders the same ranges properly. Returns
+   * false when nothing is dirty or a synthesis is running.
+   */
+  bool auditionRegion(SegmentsReadyCallback onSegmentsReady);
+
+  // Base pitch (midi) of frames [startFrame, startFrame + basePitch.size())
+  // to use instead of the project's
+  struct BasePitchPatch {
+    int startFrame = 0;
+    std::vector<float> basePitch;
+  };
+
+  /**
+   * Speculatively synthesize the given ranges with the project's current
+   * curves, or with patch's base pitch where it applies, into the segment
+   * cache at low priority, without touching the waveform or the project.
+   * The curves are read before this returns. A later synthesizeRegion()
+   * with the same input then completes from the cache. Newer prefetches
+   * supersede older overlapping ones.
+   */
+  void prefetchRegion(const std::vector<std::pair<int, int>> &dirtyRanges,
+                      const BasePitchPatch &patch = {});
 
   // Cancel ongoing synthesis
   void cancel();
 
+  /**
+   * The project's waveform was replaced by an earlier render (a restored
+   * project version) carrying renderedF0, which PSOLA previews then shift
+   * from. Call after cancel() once the waveform is in; ranges of that render
+   * at preview quality are not known and stay until edited again.
+   */
+  void renderReplaced(std::vector<float> renderedF0);
+
   // Check if synthesis is in progress
   bool isSynthesizing() const { return isBusy.load(); }
+  // The synthesis in progress is a refinePreviewRegions() one, which a new
+  // synthesizeRegion() can simply replace
+  bool isRefining() const { return isBusy.load() && refining.load(); }
+
+  // Milliseconds from the start of the latest synthesizeRegion() to its
+  // first audio landing; 0 before the first
+  double getLastEditLatencyMs() const { return lastEditLatencyMs.load(); }
+
+  // Cached vocoder output, exposed for memory accounting and eviction
+  SynthesisCache &getSynthesisCache() {
+    return sharedCache ? *sharedCache : synthesisCache;
+  }
+  const SynthesisCache &getSynthesisCache() const {
+    return sharedCache ? *sharedCache : synthesisCache;
+  }
 
 private:
   /**
@@ -48,14 +188,180 @@ private:
    */
   std::pair<int, int> expandToSilenceBoundaries(int dirtyStart, int dirtyEnd);
 
+  // One dirty range and where its padded frames sit in the packed input
+  struct Segment {
+    int startFrame = 0;
+    int endFrame = 0;
+    int paddedStart = 0;
+    int paddedEnd = 0;
+    int packedOffset = 0;
+    int fadeInFrames = 0;
+    int fadeOutFrames = 0;
+    uint64_t cacheKey = 0;
+    bool cached = false;
+    std::vector<float> targetF0; // Adjusted F0 over [startFrame, endFrame)
+  };
+
+  // Packed vocoder input for the segments the cache could not serve
+  struct SynthesisInput {
+    MelBuffer mel;
+    std::vector<float> f0;
+    int frames = 0;
+    int cachedSegments = 0;
+    std::vector<std::vector<float>> segmentAudio; // Filled for cache hits
+    // Timeline frame of each packed frame, for the vocoder's seeded noise
+    std::shared_ptr<std::vector<int>> framePositions;
+  };
+
+  std::vector<Segment>
+  buildSegments(const std::vector<std::pair<int, int>> &dirtyRanges,
+                int totalFrames);
+  // Split segments into the ones heard next and the rest, soonest first;
+  // a single batch when not playing
+  std::vector<std::vector<Segment>>
+  scheduleForPlayback(std::vector<Segment> segments, int hopSize) const;
+  // Compose the adjusted F0 of each segment's padded frames into
+  // adjustedF0Buffer, at their project frame positions; patch, if given,
+  // replaces the base pitch where it overlaps
+  bool composeSegmentF0(const std::vector<Segment> &segments, int totalFrames,
+                        const BasePitchPatch *patch = nullptr);
+  SynthesisInput packSegments(std::vector<Segment> &segments,
+                              const Vocoder &renderer);
+  // Split packed vocoder output into per-segment audio and cache it
+  void scatterToCache(const std::vector<Segment> &segments,
+                      std::vector<float> &synthesizedAudio, int packedFrames,
+                      int hopSize,
+                      std::vector<std::vector<float>> &segmentAudio);
+
+  // One synthesizeRegion() call, shared by its batches (apply worker only)
+  struct JobProgress {
+    Vocoder *renderer = nullptr;
+    bool refinement = false; // Re-renders preview ranges; leaves dirty flags
+    size_t batchesLeft = 0;
+    int replacedSamples = 0;
+    bool failed = false;
+    CompleteCallback onComplete;
+    SegmentsReadyCallback onSegmentsReady;
+    // When synthesizeRegion() was called; cleared once the first batch is in
+    int64_t startTicks = 0;
+    // The notes as the job started, which the writes re-silence around
+    std::shared_ptr<const std::vector<Note>> notes;
+  };
+
+  // Queue a PSOLA stand-in for the segments of a batch the vocoder renders
+  void startPreview(const std::vector<Segment> &segments,
+                    const std::shared_ptr<std::atomic<bool>> &capturedCancelFlag,
+                    Project *capturedProject, int hopSize, uint64_t currentJobId,
+                    const std::shared_ptr<JobProgress> &progress);
+
+  // The vocoder edits go to: the preview one when the tier is usable
+  Vocoder *getEditVocoder() const;
+
+  // Build, schedule and start the batches for dirtyRanges; the shared tail
+  // of synthesizeRegion() and refinePreviewRegions()
+  void startJob(const std::vector<std::pair<int, int>> &dirtyRanges,
+                std::shared_ptr<JobProgress> progress,
+                const ProgressCallback &onProgress);
+
+  // Note which ranges now hold preview-quality audio
+  void recordRenderer(const std::vector<Segment> &segments,
+                      const Vocoder *renderer);
+
+  // Reset renderedF0 from the notes' detected F0 when the project changed
+  void ensureRenderedF0(int totalFrames);
+  // Note that the waveform now carries these segments' target F0
+  void recordRenderedF0(const std::vector<Segment> &segments);
+
+  // Send one batch to the vocoder (or straight to the apply worker when the
+  // cache covered it)
+  void startBatch(std::vector<Segment> segments, bool deferred,
+                  const std::shared_ptr<std::atomic<bool>> &capturedCancelFlag,
+                  Project *capturedProject, int hopSize, uint64_t currentJobId,
+                  const std::shared_ptr<JobProgress> &progress);
+
+  // Write each segment's samples into the project waveform and re-silence
+  // frames outside notes. Returns the number of samples replaced.
+  int writeSegments(Project *capturedProject,
+                    const std::shared_ptr<const std::vector<Note>> &notes,
+                    const std::vector<Segment> &segments,
+                    const std::vector<std::vector<float>> &segmentAudio,
+                    int hopSize);
+
+  // Frame spans of a note snapshot, reused while jobs pin the same one
+  std::shared_ptr<const std::vector<std::pair<int, int>>>
+  getNoteSpans(const std::shared_ptr<const std::vector<Note>> &notes);
+
+  // Commit one finished batch; the last one clears dirty flags and reports
+  // completion. Empty segmentAudio marks a failed batch.
+  void commitBatch(
+      const std::shared_ptr<std::atomic<bool>> &capturedCancelFlag,
+      Project *capturedProject, const std::vector<Segment> &segments,
+      const std::vector<std::vector<float>> &segmentAudio, int hopSize,
+      uint64_t currentJobId, const std::shared_ptr<JobProgress> &progress);
+
+  // Frames fed on each side of a segment and discarded afterwards
+  static constexpr int contextFrames = 16;
+
+  // Frames blended into the existing waveform at each end (~93 ms)
+  static constexpr int crossfadeFrames = 8;
+
+  // Segments heard this soon after the playhead are synthesized first
+  static constexpr double playbackLeadSeconds = 4.0;
+
   Vocoder *vocoder = nullptr;
+  std::atomic<Vocoder *> previewVocoder{nullptr}; // Set by model loads
+  std::atomic<bool> previewTier{true};
   Project *project = nullptr;
+  SynthesisCache synthesisCache;
+  SynthesisCache *sharedCache = nullptr;
+  PlayheadProvider playheadProvider;
+  std::atomic<bool> windowedResynthesis{true};
+  std::atomic<bool> instantPreview{true};
+  std::atomic<bool> background{false};
+
+  // F0 the waveform currently carries, per frame: the detected pitch until a
+  // segment is synthesized, then the F0 it was synthesized with. The source
+  // pitch for instant previews.
+  std::mutex renderedF0Mutex;
+  std::vector<float> renderedF0;
+  const Project *renderedF0Project = nullptr;
+
+  // Spans of the non-rest notes in noteSpansSource, for re-silencing
+  std::mutex noteSpansMutex;
+  std::shared_ptr<const std::vector<std::pair<int, int>>> noteSpans;
+  std::shared_ptr<const std::vector<Note>> noteSpansSource;
+
+  // Sorted, disjoint frame ranges of the waveform the preview vocoder wrote
+  mutable std::mutex previewRangesMutex;
+  std::vector<std::pair<int, int>> previewRanges;
+  // When synthesis last started or finished, for needsRefinement()
+  std::atomic<int64_t> lastActivityTicks{0};
+
+  // Project-length F0 scratch; only frames of the current segments are valid
+  std::vector<float> adjustedF0Buffer;
 
   std::shared_ptr<std::atomic<bool>> cancelFlag;
   std::atomic<uint64_t> jobId{0};
   std::atomic<bool> isBusy{false};
+  std::atomic<bool> refining{false};
+  std::atomic<double> lastEditLatencyMs{0.0};
+
+  // Copies finished audio into the waveform, one job at a time on the pool.
+  // ownerJobId is the synthesizeRegion() job the work belongs to, or 0 for
+  // prefetches.
+  void enqueueApply(uint64_t ownerJobId, std::function<void()> job);
+  void drainApplyQueue();
+
+  struct ApplyJob {
+    uint64_t ownerJobId = 0;
+    std::function<void()> run;
+  };
 
-  std::thread applyThread;
+  std::mutex applyMutex;
+  std::deque<ApplyJob> applyQueue;
+  bool applyDraining = false; // A drainApplyQueue() job is queued or running
+  bool stopApplyWorker = false;
+  JobSystem::Group applyJobs; // Last: waited on before the queue goes
 
   JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(IncrementalSynthesizer)
 };
@@ -0,0 +1,235 @@
+#include "LiveMonitor.h"
+#include "../../Utils/AppLogger.h"
+#include "../../Utils/PlatformPaths.h"
+#include "../FCPEPitchDetector.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace {
+constexpr std::array<int, static_cast<size_t>(LiveMonitor::Scale::numScales)>
+    scaleMasks = {
+        0xfff, // Chromatic
+        0xab5, // Major: 0 2 4 5 7 9 11
+        0x5ad, // Natural minor: 0 2 3 5 7 8 10
+};
+
+float hzToMidi(float hz) { return 69.0f + 12.0f * std::log2(hz / 440.0f); }
+float midiToHz(float midi) {
+  return 440.0f * std::pow(2.0f, (midi - 69.0f) / 12.0f);
+}
+} // namespace
+
+LiveMonitor::LiveMonitor() = default;
+
+LiveMonitor::~LiveMonitor() {
+  liveCorrector.store(nullptr);
+  corrector.reset();
+  loadJobs.wait();
+}
+
+StreamingCorrector::Timing LiveMonitor::getTiming() {
+  // 20 + 15 + 10 ms plus a block: about 50 ms at common block sizes. The
+  // history gives FCPE a few frames of onset before each chunk.
+  StreamingCorrector::Timing timing;
+  timing.chunkSeconds = 0.02;
+  timing.contextSeconds = 0.015;
+  timing.workerSlackSeconds = 0.01;
+  timing.historySeconds = 0.08;
+  return timing;
+}
+
+void LiveMonitor::prepare(double sr, int channels, int maxBlockSize) {
+  std::lock_guard<std::mutex> lock(mutex);
+  liveCorrector.store(nullptr);
+  corrector.reset();
+  sampleRate = sr > 0.0 ? sr : 44100.0;
+  numChannels = std::clamp(channels, 1, monitorChannels);
+  preparedBlockSize = std::max(1, maxBlockSize);
+  position = 0;
+  currentNote = -1;
+  decidedUntil = -1;
+  if (enabled) {
+    corrector = std::make_unique<StreamingCorrector>();
+    corrector->prepare(sampleRate, numChannels, preparedBlockSize, getTiming());
+    corrector->setCurveProvider(
+        std::make_shared<const StreamingCorrector::CurveProvider>(
+            [this](const juce::AudioBuffer<float> &audio, int numSamples,
+                   juce::int64 start, int &hop, std::vector<float> &source,
+                   std::vector<float> &target) {
+              return makeCurves(audio, numSamples, start, hop, source,
+                                target);
+            }));
+    liveCorrector.store(corrector.get());
+  }
+}
+
+void LiveMonitor::setEnabled(bool shouldBeEnabled) {
+  std::unique_lock<std::mutex> lock(mutex);
+  enabled = shouldBeEnabled;
+  if (!enabled) {
+    // Kept until audio stops: a block may still be in it
+    liveCorrector.store(nullptr);
+    return;
+  }
+
+  if (!std::exchange(loadStarted, true)) {
+    loadJobs.submit(JobSystem::Priority::Normal, [this]() {
+      const auto models = PlatformPaths::getModelsDirectory();
+      auto loaded = std::make_shared<FCPEPitchDetector>();
+      // CPU: a few frames per call is too little work to pay for a GPU
+      if (!loaded->loadModel(models.getChildFile("fcpe.onnx"),
+                             models.getChildFile("mel_filterbank.bin"),
+                             models.getChildFile("cent_table.bin"))) {
+        LOG_ERROR("LiveMonitor: failed to load the FCPE model");
+        return;
+      }
+      loaded->warmUp();
+      std::atomic_store(&detector, std::move(loaded));
+    });
+  }
+
+  if (corrector) {
+    liveCorrector.store(corrector.get());
+    return;
+  }
+  lock.unlock();
+  // Audio may be running, so the new corrector starts out of its reach
+  prepare(sampleRate, numChannels, preparedBlockSize);
+}
+
+int LiveMonitor::getLatencySamples() const {
+  std::lock_guard<std::mutex> lock(mutex);
+  return corrector ? corrector->getLatencySamples()
+                   : StreamingCorrector::latencyFor(
+                         sampleRate, preparedBlockSize, getTiming());
+}
+
+void LiveMonitor::setScale(int key, Scale scale) {
+  const int index = std::clamp(static_cast<int>(scale), 0,
+                               static_cast<int>(Scale::numScales) - 1);
+  const int mask = scaleMasks[static_cast<size_t>(index)];
+  const int root = ((key % 12) + 12) % 12;
+  scaleMask.store(((mask << root) | (mask >> (12 - root))) & 0xfff);
+}
+
+bool LiveMonitor::process(juce::AudioBuffer<float> &buffer,
+                          const juce::MidiBuffer &midi) {
+  handleMidi(midi);
+  auto *live = liveCorrector.load();
+  if (live == nullptr)
+    return false;
+  // The corrector has read all of the input before it writes any output
+  live->process(buffer, buffer, position);
+  position += buffer.getNumSamples();
+  return true;
+}
+
+void LiveMonitor::handleMidi(const juce::MidiBuffer &midi) {
+  bool changed = false;
+  for (const auto metadata : midi) {
+    const auto message = metadata.getMessage();
+    if (message.isNoteOn()) {
+      pressOrder[static_cast<size_t>(message.getNoteNumber())] = ++pressCount;
+      changed = true;
+    } else if (message.isNoteOff()) {
+      pressOrder[static_cast<size_t>(message.getNoteNumber())] = 0;
+      changed = true;
+    } else if (message.isAllNotesOff() || message.isAllSoundOff()) {
+      pressOrder.fill(0);
+      changed = true;
+    }
+  }
+  if (!changed)
+    return;
+
+  const auto latest = std::max_element(pressOrder.begin(), pressOrder.end());
+  heldNote.store(*latest == 0
+                     ? -1
+                     : static_cast<int>(latest - pressOrder.begin()));
+}
+
+bool LiveMonitor::makeCurves(const juce::AudioBuffer<float> &audio,
+                             int numSamples, juce::int64 timelineStart,
+                             int &hop,
+                             std::vector<float> &sourceF0,
+                             std::vector<float> &targetF0) {
+  const auto tracker = std::atomic_load(&detector);
+  if (!tracker || numSamples <= 0)
+    return false;
+
+  const int channels = std::min(numChannels, audio.getNumChannels());
+  mono.assign(audio.getReadPointer(0), audio.getReadPointer(0) + numSamples);
+  for (int ch = 1; ch < channels; ++ch)
+    juce::FloatVectorOperations::add(mono.data(), audio.getReadPointer(ch),
+                                     numSamples);
+  if (channels > 1)
+    juce::FloatVectorOperations::multiply(
+        mono.data(), 1.0f / static_cast<float>(channels), numSamples);
+
+  const int rate = static_cast<int>(std::lround(sampleRate));
+  sourceF0 = tracker->extractF0(mono.data(), numSamples, rate);
+  hop = tracker->getHopSizeForSampleRate(rate);
+  if (sourceF0.empty() || hop <= 0)
+    return false;
+
+  bool shifted = false;
+  targetF0.resize(sourceF0.size());
+  for (size_t i = 0; i < sourceF0.size(); ++i) {
+    const float source = sourceF0[i];
+    if (source <= 0.0f) {
+      targetF0[i] = 0.0f;
+      continue;
+    }
+    // Frames from before this chunk were decided by the previous ones
+    const auto frameTime =
+        timelineStart + static_cast<juce::int64>(i) * hop;
+    const bool commit = frameTime > decidedUntil;
+    if (commit)
+      decidedUntil = frameTime;
+    const float target =
+        midiToHz(static_cast<float>(targetNote(hzToMidi(source), commit)));
+    targetF0[i] = target;
+    if (std::abs(target - source) > source * 1.0e-3f)
+      shifted = true;
+  }
+  return shifted;
+}
+
+int LiveMonitor::targetNote(float midiPitch, bool commit) {
+  const int held = heldNote.load();
+  int note = held;
+  if (held >= 0) {
+    // The held note in the octave the singer is in
+    note += 12 * static_cast<int>(std::lround(
+                     (midiPitch - static_cast<float>(held)) / 12.0f));
+    if (commit)
+      currentNote = note;
+    return note;
+  }
+
+  const int mask = scaleMask.load();
+  auto inScale = [mask](int candidate) {
+    return ((mask >> (((candidate % 12) + 12) % 12)) & 1) != 0;
+  };
+  if (currentNote >= 0 && inScale(currentNote) &&
+      std::abs(midiPitch - static_cast<float>(currentNote)) <
+          0.5f + noteHysteresis)
+    return currentNote;
+
+  // Nearest note of the scale; ties go down
+  const int nearest = static_cast<int>(std::lround(midiPitch));
+  int best = nearest;
+  float bestDistance = 1.0e9f;
+  for (note = nearest - 6; note <= nearest + 6; ++note) {
+    const float distance = std::abs(midiPitch - static_cast<float>(note));
+    if (inScale(note) && distance < bestDistance) {
+      best = note;
+      bestDistance = distance;
+    }
+  }
+  if (commit)
+    currentNote = best;
+  return best;
+}
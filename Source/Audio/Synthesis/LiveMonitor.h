@@ -0,0 +1,101 @@
+#pragma once
+
+#include "../../JuceHeader.h"
+#include "../../Utils/JobSystem.h"
+#include "StreamingCorrector.h"
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+class FCPEPitchDetector;
+
+/**
+ * Corrected monitoring of live input, for tracking through the plugin.
+ *
+ * The input runs through a StreamingCorrector set up for short chunks, so
+ * the reported latency stays near 50 ms. Its worker tracks each chunk's
+ * pitch with FCPE over a little of the input before it, and moves voiced
+ * frames to a held MIDI note (nearest octave) or, with none held, to the
+ * nearest note of the selected scale. Until the model has loaded, and
+ * wherever the worker falls behind, the input plays delayed but unchanged.
+ */
+class LiveMonitor {
+public:
+  enum class Scale { Chromatic, Major, Minor, numScales };
+
+  LiveMonitor();
+  ~LiveMonitor();
+
+  // Not while process() may run
+  void prepare(double sampleRate, int numChannels, int maxBlockSize);
+
+  /**
+   * Message thread: turn the mode on or off. Turning it on starts loading
+   * the pitch model in the background. The host must be told the latency
+   * (getLatencySamples()) while it is on.
+   */
+  void setEnabled(bool enabled);
+  bool isActive() const { return liveCorrector.load() != nullptr; }
+  int getLatencySamples() const;
+
+  // Any thread. key is the scale's root pitch class, 0 = C.
+  void setScale(int key, Scale scale);
+
+  /**
+   * Audio thread: take note events from midi, then replace buffer with the
+   * input of getLatencySamples() ago, corrected. Wait-free.
+   * @return false (buffer untouched) when the mode is off
+   */
+  bool process(juce::AudioBuffer<float> &buffer, const juce::MidiBuffer &midi);
+
+private:
+  static constexpr int monitorChannels = 2;
+  // A note keeps its frames until the pitch is this much past halfway
+  static constexpr float noteHysteresis = 0.15f;
+
+  static StreamingCorrector::Timing getTiming();
+
+  // Audio thread
+  void handleMidi(const juce::MidiBuffer &midi);
+
+  // Corrector worker: the StreamingCorrector::CurveProvider
+  bool makeCurves(const juce::AudioBuffer<float> &audio, int numSamples,
+                  juce::int64 timelineStart, int &hopSize,
+                  std::vector<float> &sourceF0, std::vector<float> &targetF0);
+  // Corrector worker: the note a voiced frame at midiPitch is moved to.
+  // commit lets the frame move currentNote.
+  int targetNote(float midiPitch, bool commit);
+
+  double sampleRate = 44100.0;
+  int numChannels = monitorChannels;
+  int preparedBlockSize = 512;
+  juce::int64 position = 0; // Audio thread: samples processed
+
+  // Most recent note-on still held, or -1; written by the audio thread
+  std::atomic<int> heldNote{-1};
+  std::array<uint32_t, 128> pressOrder{}; // Audio thread; 0 = released
+  uint32_t pressCount = 0;
+  // Pitch classes of the scale, bit 0 = C
+  std::atomic<int> scaleMask{0xfff};
+
+  // Corrector worker only
+  int currentNote = -1;
+  juce::int64 decidedUntil = -1; // Last frame that moved currentNote
+  std::vector<float> mono;
+
+  std::shared_ptr<FCPEPitchDetector> detector; // Through std::atomic_load/store
+  bool loadStarted = false; // Guarded by mutex
+  JobSystem::Group loadJobs;
+
+  // The corrector is only replaced while audio is stopped (prepare,
+  // destruction); turning the mode off just unpublishes it
+  mutable std::mutex mutex;
+  bool enabled = false; // Guarded by mutex
+  std::unique_ptr<StreamingCorrector> corrector;
+  std::atomic<StreamingCorrector *> liveCorrector{nullptr};
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LiveMonitor)
+};
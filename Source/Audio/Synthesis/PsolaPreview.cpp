@@ -0,0 +1,124 @@
+#include "PsolaPreview.h"
+#include "../../JuceHeader.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+constexpr float minF0 = 50.0f;
+constexpr float maxShiftRatio = 2.0f;
+constexpr double unvoicedGrainSeconds = 0.005;
+
+float f0At(const std::vector<float> &curve, int sample, int hopSize) {
+  const int frame = sample / hopSize;
+  if (frame < 0 || frame >= static_cast<int>(curve.size()))
+    return 0.0f;
+  const float f0 = curve[static_cast<size_t>(frame)];
+  return f0 >= minF0 ? f0 : 0.0f;
+}
+} // namespace
+
+namespace PsolaPreview {
+std::vector<float> render(const float *source, int numSourceSamples,
+                          int startSample, int endSample,
+                          const std::vector<float> &sourceF0,
+                          const std::vector<float> &targetF0, int hopSize,
+                          int sampleRate) {
+  startSample = std::clamp(startSample, 0, numSourceSamples);
+  endSample = std::clamp(endSample, startSample, numSourceSamples);
+  const int length = endSample - startSample;
+  std::vector<float> output(static_cast<size_t>(length), 0.0f);
+  if (length == 0 || hopSize <= 0 || sampleRate <= 0)
+    return output;
+
+  const double unvoicedPeriod = unvoicedGrainSeconds * sampleRate;
+  const int maxPeriod = static_cast<int>(std::ceil(sampleRate / minF0));
+
+  // Period of the source at a sample, and the period it should play at
+  auto periods = [&](int sample, double &sourcePeriod, double &targetPeriod) {
+    const float from = f0At(sourceF0, sample, hopSize);
+    const float to = f0At(targetF0, sample, hopSize);
+    if (from <= 0.0f || to <= 0.0f) {
+      sourcePeriod = targetPeriod = unvoicedPeriod;
+      return;
+    }
+    sourcePeriod = sampleRate / from;
+    const float ratio = std::clamp(to / from, 1.0f / maxShiftRatio, maxShiftRatio);
+    targetPeriod = sourcePeriod / ratio;
+  };
+
+  // Analysis marks, one source period apart, covering the range plus two
+  // periods either side so every output sample gets full grains
+  std::vector<std::pair<double, double>> marks; // (position, period)
+  const int markStart = std::max(0, startSample - maxPeriod);
+  const int markEnd = std::min(numSourceSamples, endSample + 2 * maxPeriod);
+  for (double t = markStart; t < markEnd;) {
+    double sourcePeriod, targetPeriod;
+    periods(static_cast<int>(t), sourcePeriod, targetPeriod);
+
+    // Voiced marks snap to the strongest sample near their expected place,
+    // so grains are centred on the pitch pulses
+    if (sourcePeriod != unvoicedPeriod) {
+      const int reach = static_cast<int>(sourcePeriod / 4.0);
+      const int lo = std::max(0, static_cast<int>(t) - reach);
+      const int hi = std::min(numSourceSamples - 1, static_cast<int>(t) + reach);
+      int peak = static_cast<int>(t);
+      for (int i = lo; i <= hi; ++i)
+        if (std::abs(source[i]) > std::abs(source[peak]))
+          peak = i;
+      if (peak > (marks.empty() ? -1.0 : marks.back().first))
+        t = peak;
+    }
+
+    marks.emplace_back(t, sourcePeriod);
+    t += sourcePeriod;
+  }
+  if (marks.empty())
+    return output;
+
+  std::vector<float> weight(static_cast<size_t>(length), 0.0f);
+  size_t nearest = 0;
+  // Synthesis marks start on an analysis mark, so unshifted stretches copy
+  // straight through
+  for (double u = marks.front().first; u < endSample + maxPeriod;) {
+    double sourcePeriod, targetPeriod;
+    periods(static_cast<int>(u), sourcePeriod, targetPeriod);
+
+    // Timing is unchanged, so the grain comes from the closest source mark
+    while (nearest + 1 < marks.size() &&
+           std::abs(marks[nearest + 1].first - u) <=
+               std::abs(marks[nearest].first - u))
+      ++nearest;
+    const double mark = marks[nearest].first;
+    const int half = std::max(1, static_cast<int>(marks[nearest].second));
+
+    // Hann grain of two periods, centred on the mark, placed at u
+    const int shift = static_cast<int>(std::lround(u - mark));
+    const int grainStart = static_cast<int>(mark) - half;
+    for (int i = 0; i < 2 * half; ++i) {
+      const int from = grainStart + i;
+      const int to = from + shift - startSample;
+      if (from < 0 || from >= numSourceSamples || to < 0 || to >= length)
+        continue;
+      const float w = 0.5f - 0.5f * std::cos(juce::MathConstants<float>::twoPi *
+                                             (static_cast<float>(i) + 0.5f) /
+                                             static_cast<float>(2 * half));
+      output[static_cast<size_t>(to)] += w * source[from];
+      weight[static_cast<size_t>(to)] += w;
+    }
+    // Where the pitch is not moved, step back onto the analysis marks
+    // rather than drifting up to half a period off them
+    u = targetPeriod == sourcePeriod ? mark + marks[nearest].second
+                                     : u + targetPeriod;
+  }
+
+  // Normalise by the summed windows, which vary with the grain spacing
+  for (int i = 0; i < length; ++i) {
+    const float w = weight[static_cast<size_t>(i)];
+    if (w > 1.0e-3f)
+      output[static_cast<size_t>(i)] /= std::max(w, 0.5f);
+    else
+      output[static_cast<size_t>(i)] = source[startSample + i];
+  }
+  return output;
+}
+} // namespace PsolaPreview
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <vector>
+
+/**
+ * Cheap time-domain PSOLA pitch shift, used to audition an edit while the
+ * vocoder is still rendering it.
+ *
+ * Grains two source periods long are cut at marks one source period apart
+ * and overlap-added at the target period, so pitch changes while timing
+ * and (roughly) formants stay put. Frames unvoiced in either curve are
+ * copied through at their own rate. Quality is well below the vocoder's;
+ * the point is that it runs in well under a millisecond per second of audio.
+ */
+namespace PsolaPreview {
+/**
+ * Render samples [startSample, endSample) of source with its pitch moved
+ * from sourceF0 to targetF0 (Hz per frame of hopSize samples, 0 =
+ * unvoiced; both cover the whole source from frame 0). Samples just outside
+ * the range are read too, where they exist.
+ */
+std::vector<float> render(const float *source, int numSourceSamples,
+                          int startSample, int endSample,
+                          const std::vector<float> &sourceF0,
+                          const std::vector<float> &targetF0, int hopSize,
+                          int sampleRate);
+} // namespace PsolaPreview
@@ -0,0 +1,48 @@
+#include "ResynthesisDebounce.h"
+#include <algorithm>
+
+namespace {
+// Weight of each new latency measurement; a few renders settle a change
+constexpr double latencySmoothing = 0.3;
+} // namespace
+
+double ResynthesisDebounce::onEdit(double nowMs, bool gestureEnded) {
+  // A held resynthesis whose time has come has fired
+  if (holding && nowMs >= fireAtMs)
+    holding = false;
+
+  const bool slowEdit = !hasLastEdit || nowMs - lastEditMs >= latencyMs;
+  lastEditMs = nowMs;
+  hasLastEdit = true;
+
+  if (gestureEnded || (slowEdit && !holding)) {
+    holding = false;
+    return 0.0;
+  }
+  if (!holding) {
+    holding = true;
+    burstStartMs = nowMs;
+  }
+
+  fireAtMs = std::min(nowMs + std::min(latencyMs, maxQuietMs),
+                      burstStartMs + maxHoldMs);
+  if (fireAtMs <= nowMs) {
+    holding = false;
+    return 0.0;
+  }
+  return fireAtMs - nowMs;
+}
+
+void ResynthesisDebounce::recordLatency(double measuredMs) {
+  if (measuredMs <= 0.0)
+    return;
+  latencyMs = measured ? latencyMs + latencySmoothing * (measuredMs - latencyMs)
+                       : measuredMs;
+  measured = true;
+}
+
+void ResynthesisDebounce::reset() {
+  latencyMs = initialLatencyMs;
+  measured = false;
+  holding = false;
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+/**
+ * When an edit's resynthesis should start, from how long resyntheses take
+ * on the current device and how fast edits are arriving.
+ *
+ * An edit that comes more than a render's latency after the previous one
+ * fires at once: there is nothing for it to supersede. Edits arriving
+ * faster than that (an undo shortcut held down, a run of nudges) are held
+ * until the burst pauses for that long, capped at maxQuietMs, so a slow
+ * device renders the last edit instead of cancelling one render after
+ * another; a burst still fires maxHoldMs after it began. An edit that ends
+ * a gesture (mouse-up) always fires at once.
+ *
+ * Times are milliseconds on any monotonic clock, passed in by the caller.
+ */
+class ResynthesisDebounce {
+public:
+  // Assumed until the first render on this device is measured
+  static constexpr double initialLatencyMs = 150.0;
+  static constexpr double maxQuietMs = 400.0;
+  static constexpr double maxHoldMs = 1000.0;
+
+  /**
+   * Note an edit at nowMs. Returns how long to wait before starting its
+   * resynthesis, 0 to start now; an edit arriving while one waits
+   * replaces it.
+   */
+  double onEdit(double nowMs, bool gestureEnded);
+
+  /** Start-to-first-audio time of a finished resynthesis. */
+  void recordLatency(double latencyMs);
+
+  /** Forget the measured latency, as after the vocoder device changed. */
+  void reset();
+
+  double getLatencyMs() const { return latencyMs; }
+
+private:
+  double latencyMs = initialLatencyMs;
+  bool measured = false;
+  double lastEditMs = 0.0;
+  bool hasLastEdit = false;
+  double burstStartMs = 0.0; // First held edit of the current burst
+  double fireAtMs = 0.0;     // When the held resynthesis starts
+  bool holding = false;
+};
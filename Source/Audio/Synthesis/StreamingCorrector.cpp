@@ -0,0 +1,317 @@
+#include "StreamingCorrector.h"
+#include "PsolaPreview.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+StreamingCorrector::StreamingCorrector()
+    : worker([this]() { workerLoop(); }) {}
+
+StreamingCorrector::~StreamingCorrector() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopWorker = true;
+  }
+  wakeWorker.notify_all();
+  if (worker.joinable())
+    worker.join();
+}
+
+int StreamingCorrector::latencyFor(double sr, int maxBlockSize) {
+  return latencyFor(sr, maxBlockSize, Timing{});
+}
+
+int StreamingCorrector::latencyFor(double sr, int maxBlockSize,
+                                   const Timing &timing) {
+  if (sr <= 0.0)
+    sr = 44100.0;
+  // A chunk is corrected once its context has arrived; the rest absorbs
+  // block size and worker scheduling
+  return std::max(64, static_cast<int>(std::lround(timing.chunkSeconds * sr))) +
+         static_cast<int>(std::lround(timing.contextSeconds * sr)) +
+         std::max(1, maxBlockSize) +
+         static_cast<int>(std::lround(timing.workerSlackSeconds * sr));
+}
+
+void StreamingCorrector::prepare(double sr, int channels, int maxBlockSize) {
+  prepare(sr, channels, maxBlockSize, Timing{});
+}
+
+void StreamingCorrector::prepare(double sr, int channels, int maxBlockSize,
+                                 const Timing &timing) {
+  std::lock_guard<std::mutex> lock(mutex);
+  sampleRate = sr > 0.0 ? sr : 44100.0;
+  numChannels = std::max(1, channels);
+  maxBlockSize = std::max(1, maxBlockSize);
+  chunkSamples = std::max(
+      64, static_cast<int>(std::lround(timing.chunkSeconds * sampleRate)));
+  contextSamples =
+      static_cast<int>(std::lround(timing.contextSeconds * sampleRate));
+  historySamples = std::max(
+      contextSamples,
+      static_cast<int>(std::lround(timing.historySeconds * sampleRate)));
+  latencySamples = latencyFor(sampleRate, maxBlockSize, timing);
+  ringSize = juce::nextPowerOfTwo(
+      4 * (latencySamples + maxBlockSize + historySamples));
+
+  fifoBuffer.setSize(numChannels, ringSize);
+  sampleFifo.setTotalSize(ringSize);
+  headers.assign(maxHeaders, {});
+  headerFifo.setTotalSize(maxHeaders);
+
+  dryRing.setSize(numChannels, ringSize);
+  dryRing.clear();
+  dryStart = dryEnd = 0;
+  history.setSize(numChannels, ringSize);
+  historyStart = historyEnd = nextChunk = 0;
+  scratch.setSize(numChannels, historySamples + chunkSamples + contextSamples);
+  correctedRing.setSize(numChannels, ringSize);
+  correctedStart.store(0);
+  correctedEnd.store(0);
+  droppedSamples.store(0);
+}
+
+void StreamingCorrector::setCurves(std::shared_ptr<const Curves> newCurves) {
+  std::atomic_store(&curves, std::move(newCurves));
+}
+
+void StreamingCorrector::setCurveProvider(
+    std::shared_ptr<const CurveProvider> provider) {
+  std::atomic_store(&curveProvider, std::move(provider));
+}
+
+void StreamingCorrector::process(const juce::AudioBuffer<float> &input,
+                                 juce::AudioBuffer<float> &output,
+                                 juce::int64 timelinePosition) {
+  const int numSamples = std::min(input.getNumSamples(), output.getNumSamples());
+  if (numSamples <= 0 || ringSize <= 1)
+    return;
+  const int channels = std::min(numChannels, input.getNumChannels());
+
+  // Delayed input, for whatever the worker has no correction of
+  if (timelinePosition != dryEnd)
+    dryStart = dryEnd = timelinePosition;
+  for (int written = 0; written < numSamples;) {
+    const int slot = static_cast<int>((dryEnd + written) % ringSize);
+    const int n = std::min(numSamples - written, ringSize - slot);
+    for (int ch = 0; ch < numChannels; ++ch) {
+      if (ch < channels)
+        dryRing.copyFrom(ch, slot, input, ch, written, n);
+      else
+        dryRing.clear(ch, slot, n);
+    }
+    written += n;
+  }
+  dryEnd += numSamples;
+  dryStart = std::max(dryStart, dryEnd - ringSize);
+
+  // To the worker: samples first, then the header that announces them
+  int start1, size1, start2, size2;
+  if (headerFifo.getFreeSpace() > 0 &&
+      sampleFifo.getFreeSpace() >= numSamples) {
+    sampleFifo.prepareToWrite(numSamples, start1, size1, start2, size2);
+    for (int ch = 0; ch < numChannels; ++ch) {
+      if (ch < channels) {
+        if (size1 > 0)
+          fifoBuffer.copyFrom(ch, start1, input, ch, 0, size1);
+        if (size2 > 0)
+          fifoBuffer.copyFrom(ch, start2, input, ch, size1, size2);
+      } else {
+        fifoBuffer.clear(ch, start1, size1);
+        fifoBuffer.clear(ch, start2, size2);
+      }
+    }
+    sampleFifo.finishedWrite(size1 + size2);
+
+    headerFifo.prepareToWrite(1, start1, size1, start2, size2);
+    headers[static_cast<size_t>(start1)] = {timelinePosition, numSamples};
+    headerFifo.finishedWrite(1);
+  } else {
+    droppedSamples.fetch_add(numSamples);
+  }
+
+  // Output: corrected where there is some, else the delayed input
+  const juce::int64 outStart = timelinePosition - latencySamples;
+  readCounter.fetch_add(1);
+  const juce::int64 fixedStart = correctedStart.load();
+  const juce::int64 fixedEnd = correctedEnd.load();
+  const int outChannels = std::min(output.getNumChannels(), numChannels);
+  for (int done = 0; done < numSamples;) {
+    const juce::int64 pos = outStart + done;
+    const juce::AudioBuffer<float> *ring = nullptr;
+    juce::int64 spanEnd = outStart + numSamples;
+    if (pos >= fixedStart && pos < fixedEnd) {
+      ring = &correctedRing;
+      spanEnd = std::min(spanEnd, fixedEnd);
+    } else {
+      if (fixedStart > pos && fixedStart < fixedEnd)
+        spanEnd = std::min(spanEnd, fixedStart);
+      if (pos >= dryStart && pos < dryEnd) {
+        ring = &dryRing;
+        spanEnd = std::min(spanEnd, dryEnd);
+      } else if (dryStart > pos) {
+        spanEnd = std::min(spanEnd, dryStart);
+      }
+    }
+
+    const int count = static_cast<int>(spanEnd - pos);
+    if (ring == nullptr) {
+      // Before the first delayed sample, as at the start of playback
+      for (int ch = 0; ch < output.getNumChannels(); ++ch)
+        output.clear(ch, done, count);
+    } else {
+      for (int copied = 0; copied < count;) {
+        const int slot = static_cast<int>((pos + copied) % ringSize);
+        const int n = std::min(count - copied, ringSize - slot);
+        for (int ch = 0; ch < outChannels; ++ch)
+          output.copyFrom(ch, done + copied, *ring, ch, slot, n);
+        copied += n;
+      }
+      for (int ch = outChannels; ch < output.getNumChannels(); ++ch)
+        output.clear(ch, done, count);
+    }
+    done += count;
+  }
+  readCounter.fetch_add(1);
+}
+
+void StreamingCorrector::workerLoop() {
+  std::unique_lock<std::mutex> lock(mutex);
+  while (!stopWorker) {
+    consumeInput();
+    // Polled: the audio thread never takes the lock to wake this
+    wakeWorker.wait_for(lock, std::chrono::milliseconds(2));
+  }
+}
+
+void StreamingCorrector::consumeInput() {
+  while (headerFifo.getNumReady() > 0) {
+    int start1, size1, start2, size2;
+    headerFifo.prepareToRead(1, start1, size1, start2, size2);
+    const auto header = headers[static_cast<size_t>(start1)];
+    headerFifo.finishedRead(1);
+
+    // A seek, a loop or a dropped block: start over where this one plays
+    if (header.timelinePosition != historyEnd) {
+      historyStart = historyEnd = nextChunk = header.timelinePosition;
+      correctedStart.store(nextChunk);
+      correctedEnd.store(nextChunk);
+      waitForReaders();
+    }
+
+    sampleFifo.prepareToRead(header.numSamples, start1, size1, start2, size2);
+    auto append = [this](int fifoStart, int count) {
+      for (int written = 0; written < count;) {
+        const int slot = static_cast<int>((historyEnd + written) % ringSize);
+        const int n = std::min(count - written, ringSize - slot);
+        for (int ch = 0; ch < numChannels; ++ch)
+          history.copyFrom(ch, slot, fifoBuffer, ch, fifoStart + written, n);
+        written += n;
+      }
+      historyEnd += count;
+    };
+    append(start1, size1);
+    append(start2, size2);
+    sampleFifo.finishedRead(size1 + size2);
+    historyStart = std::max(historyStart, historyEnd - ringSize);
+
+    while (historyEnd - nextChunk >= chunkSamples + contextSamples) {
+      correctChunk(nextChunk);
+      nextChunk += chunkSamples;
+    }
+  }
+}
+
+void StreamingCorrector::correctChunk(juce::int64 chunkStart) {
+  const juce::int64 chunkEnd = chunkStart + chunkSamples;
+
+  // The slots about to be reused must be ones process() no longer reads
+  const juce::int64 keepFrom =
+      std::max(correctedStart.load(), chunkEnd - ringSize);
+  if (keepFrom > correctedStart.load()) {
+    correctedStart.store(keepFrom);
+    waitForReaders();
+  }
+
+  const juce::int64 localStart =
+      std::max(historyStart, chunkStart - historySamples);
+  const juce::int64 localEnd = std::min(historyEnd, chunkEnd + contextSamples);
+  const int localLength = static_cast<int>(localEnd - localStart);
+  for (int copied = 0; copied < localLength;) {
+    const int slot = static_cast<int>((localStart + copied) % ringSize);
+    const int n = std::min(localLength - copied, ringSize - slot);
+    for (int ch = 0; ch < numChannels; ++ch)
+      scratch.copyFrom(ch, copied, history, ch, slot, n);
+    copied += n;
+  }
+
+  // Curves on this chunk's samples, in frames of hop host samples
+  const auto provider = std::atomic_load(&curveProvider);
+  const auto chunkCurves = provider ? nullptr : std::atomic_load(&curves);
+  std::vector<float> sourceF0, targetF0;
+  int hop = 0;
+  bool edited = false;
+  if (provider) {
+    edited = (*provider)(scratch, localLength, localStart, hop, sourceF0,
+                         targetF0) &&
+             hop > 0;
+  } else if (chunkCurves && chunkCurves->hopSize > 0 && chunkCurves->sampleRate > 0) {
+    const double curveRate = chunkCurves->sampleRate;
+    hop = std::max(1, static_cast<int>(std::lround(chunkCurves->hopSize *
+                                                   sampleRate / curveRate)));
+    const int frames = localLength / hop + 1;
+    sourceF0.resize(static_cast<size_t>(frames));
+    targetF0.resize(static_cast<size_t>(frames));
+    const auto numFrames = static_cast<juce::int64>(
+        std::min(chunkCurves->sourceF0.size(), chunkCurves->targetF0.size()));
+    for (int k = 0; k < frames; ++k) {
+      const double seconds =
+          static_cast<double>(localStart + static_cast<juce::int64>(k) * hop) /
+          sampleRate;
+      const auto frame = static_cast<juce::int64>(
+          std::floor(seconds * curveRate / chunkCurves->hopSize));
+      const bool inRange = frame >= 0 && frame < numFrames;
+      const float source =
+          inRange ? chunkCurves->sourceF0[static_cast<size_t>(frame)] : 0.0f;
+      const float target =
+          inRange ? chunkCurves->targetF0[static_cast<size_t>(frame)] : 0.0f;
+      sourceF0[static_cast<size_t>(k)] = source;
+      targetF0[static_cast<size_t>(k)] = target;
+      if (source > 0.0f && target > 0.0f &&
+          std::abs(target - source) > source * 1.0e-3f)
+        edited = true;
+    }
+  }
+
+  const int offset = static_cast<int>(chunkStart - localStart);
+  for (int ch = 0; ch < numChannels; ++ch) {
+    std::vector<float> shifted;
+    if (edited)
+      shifted = PsolaPreview::render(scratch.getReadPointer(ch), localLength,
+                                     offset, offset + chunkSamples, sourceF0,
+                                     targetF0, hop,
+                                     static_cast<int>(std::lround(sampleRate)));
+    const bool useShifted = static_cast<int>(shifted.size()) >= chunkSamples;
+
+    for (int written = 0; written < chunkSamples;) {
+      const int slot = static_cast<int>((chunkStart + written) % ringSize);
+      const int n = std::min(chunkSamples - written, ringSize - slot);
+      if (useShifted)
+        correctedRing.copyFrom(ch, slot, shifted.data() + written, n);
+      else
+        correctedRing.copyFrom(ch, slot, scratch, ch, offset + written, n);
+      written += n;
+    }
+  }
+  correctedEnd.store(chunkEnd);
+}
+
+void StreamingCorrector::waitForReaders() const {
+  // Even: no process() was copying, and any later one sees the new range
+  const uint64_t count = readCounter.load();
+  if ((count & 1) == 0)
+    return;
+  while (readCounter.load() == count)
+    std::this_thread::yield();
+}
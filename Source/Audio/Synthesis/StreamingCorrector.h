@@ -0,0 +1,140 @@
+#pragma once
+
+#include "../../JuceHeader.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Lookahead pitch correction for playback the vocoder has not rendered.
+ *
+ * The host delays this processor's output by getLatencySamples(). Inside
+ * that window a worker thread moves the incoming audio, in short chunks,
+ * from the recording's pitch to the edited pitch with PSOLA (see
+ * PsolaPreview), so edits are heard on audio without a render, with a
+ * fixed delay the host compensates. The audio thread only copies: input
+ * into a FIFO, corrected audio out of a ring, and the delayed input where
+ * the worker has not caught up or there is nothing to correct.
+ *
+ * Without a project the curves can come from the audio itself: a
+ * CurveProvider sees each chunk with its context and returns both curves
+ * (see LiveMonitor). Timing trades latency for chunk and grain length.
+ */
+class StreamingCorrector {
+public:
+  // Pitch in Hz per frame of hopSize samples at sampleRate, from timeline
+  // position 0; 0 = unvoiced
+  struct Curves {
+    std::vector<float> sourceF0; // Pitch the recording has
+    std::vector<float> targetF0; // Pitch the edits ask for
+    int hopSize = 0;
+    int sampleRate = 0;
+  };
+
+  // Worker thread: fill both curves (frames of hopSize samples from sample
+  // 0) for numSamples of audio that start at timelineStart. False leaves
+  // the chunk uncorrected.
+  using CurveProvider = std::function<bool(
+      const juce::AudioBuffer<float> &audio, int numSamples,
+      juce::int64 timelineStart, int &hopSize, std::vector<float> &sourceF0,
+      std::vector<float> &targetF0)>;
+
+  struct Timing {
+    double chunkSeconds = 0.03;
+    double contextSeconds = 0.03; // PSOLA grains reach this far
+    double workerSlackSeconds = 0.05;
+    // Input before each chunk a CurveProvider is shown; no more latency
+    double historySeconds = 0.0;
+  };
+
+  StreamingCorrector();
+  ~StreamingCorrector();
+
+  // Not while process() may run. Without timing, the lookahead defaults.
+  void prepare(double sampleRate, int numChannels, int maxBlockSize);
+  void prepare(double sampleRate, int numChannels, int maxBlockSize,
+               const Timing &timing);
+  int getLatencySamples() const { return latencySamples; }
+  // What getLatencySamples() will be after prepare() with these
+  static int latencyFor(double sampleRate, int maxBlockSize);
+  static int latencyFor(double sampleRate, int maxBlockSize,
+                        const Timing &timing);
+
+  // Message thread: curves for the chunks corrected from now on
+  void setCurves(std::shared_ptr<const Curves> curves);
+  // Takes precedence over setCurves() while set
+  void setCurveProvider(std::shared_ptr<const CurveProvider> provider);
+
+  // Audio thread: take the block that plays at timelinePosition and write
+  // the audio for timelinePosition - getLatencySamples() to output
+  void process(const juce::AudioBuffer<float> &input,
+               juce::AudioBuffer<float> &output, juce::int64 timelinePosition);
+
+  // Input the FIFO had no room for (worker too slow); played uncorrected
+  int64_t getDroppedSamples() const { return droppedSamples.load(); }
+
+private:
+  struct BlockHeader {
+    juce::int64 timelinePosition = 0;
+    int numSamples = 0;
+  };
+
+  static constexpr int maxHeaders = 256;
+
+  void workerLoop();
+  // Worker, holding mutex
+  void consumeInput();
+  void correctChunk(juce::int64 chunkStart);
+  // Worker: wait until no process() started before now is still copying
+  void waitForReaders() const;
+
+  double sampleRate = 44100.0;
+  int numChannels = 0;
+  int chunkSamples = 0;
+  int contextSamples = 0;
+  int historySamples = 0; // Before a chunk, at least contextSamples
+  int latencySamples = 0;
+  int ringSize = 1;
+
+  // Audio thread to worker
+  juce::AbstractFifo sampleFifo{1};
+  juce::AudioBuffer<float> fifoBuffer;
+  juce::AbstractFifo headerFifo{maxHeaders};
+  std::vector<BlockHeader> headers;
+  std::atomic<int64_t> droppedSamples{0};
+
+  // Audio thread only: the input, delayed; timeline p lives at p % ringSize
+  juce::AudioBuffer<float> dryRing;
+  juce::int64 dryStart = 0;
+  juce::int64 dryEnd = 0;
+
+  // Worker only: the input it has taken, same layout
+  juce::AudioBuffer<float> history;
+  juce::int64 historyStart = 0;
+  juce::int64 historyEnd = 0;
+  juce::int64 nextChunk = 0;
+  juce::AudioBuffer<float> scratch;
+
+  // Written by the worker: corrected [correctedStart, correctedEnd)
+  juce::AudioBuffer<float> correctedRing;
+  std::atomic<juce::int64> correctedStart{0};
+  std::atomic<juce::int64> correctedEnd{0};
+  // Odd while process() copies from correctedRing; see waitForReaders()
+  std::atomic<uint64_t> readCounter{0};
+
+  // Through std::atomic_load/store
+  std::shared_ptr<const Curves> curves;
+  std::shared_ptr<const CurveProvider> curveProvider;
+
+  std::mutex mutex;
+  std::condition_variable wakeWorker;
+  bool stopWorker = false;
+  std::thread worker; // Last: starts in the constructor
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(StreamingCorrector)
+};
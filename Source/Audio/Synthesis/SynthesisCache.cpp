@@ -0,0 +1,274 @@
+#include "SynthesisCache.h"
+#include "../../Utils/AppLogger.h"
+#include "../PerformanceMetrics.h"
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+namespace {
+// FNV-1a over raw bytes; inputs are bit-identical when the edit is undone
+constexpr uint64_t fnvOffset = 14695981039346656037ull;
+constexpr uint64_t fnvPrime = 1099511628211ull;
+
+uint64_t hashBytes(uint64_t hash, const void *data, size_t numBytes) {
+  const auto *bytes = static_cast<const unsigned char *>(data);
+  for (size_t i = 0; i < numBytes; ++i) {
+    hash ^= bytes[i];
+    hash *= fnvPrime;
+  }
+  return hash;
+}
+
+template <typename T> uint64_t hashValue(uint64_t hash, const T &value) {
+  return hashBytes(hash, &value, sizeof(T));
+}
+
+uint64_t hashString(uint64_t hash, const juce::String &text) {
+  const auto utf8 = text.toRawUTF8();
+  return hashBytes(hash, utf8, std::strlen(utf8));
+}
+
+// Raw little-endian samples, like the project container's chunks
+const char *const diskPattern = "*.f32";
+} // namespace
+
+SynthesisCache::SynthesisCache(size_t maxBytesIn) : maxBytes(maxBytesIn) {}
+
+SynthesisCache::~SynthesisCache() { diskJobs.wait(); }
+
+uint64_t SynthesisCache::makeKey(const MelView &paddedMel,
+                                 const float *paddedF0, int trimStart,
+                                 int numFrames, const Context &context) {
+  uint64_t hash = fnvOffset;
+  const auto paddedFrames = paddedMel.size();
+  hash = hashValue(hash, paddedFrames);
+  hash = hashValue(hash, trimStart);
+  hash = hashValue(hash, numFrames);
+  hash = hashBytes(hash, paddedMel.data(),
+                   paddedFrames * static_cast<size_t>(paddedMel.getNumMels()) *
+                       sizeof(float));
+  hash = hashBytes(hash, paddedF0, paddedFrames * sizeof(float));
+  hash = hashValue(hash, context.globalPitchOffset);
+  hash = hashValue(hash, context.formantShift);
+  hash = hashString(hash, context.modelPath);
+  hash = hashValue(hash, context.modelModified);
+  hash = hashString(hash, context.device);
+  hash = hashValue(hash, context.deviceId);
+  hash = hashValue(hash, context.noiseSeed);
+  return hash;
+}
+
+bool SynthesisCache::lookup(uint64_t key, std::vector<float> &out) {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = index.find(key);
+    if (it != index.end()) {
+      PerformanceMetrics::getInstance().recordCacheLookup(
+          PerformanceMetrics::Cache::Synthesis, true);
+      entries.splice(entries.begin(), entries, it->second);
+      out = it->second->samples;
+      return true;
+    }
+  }
+
+  // Synthesized by an earlier session, or evicted from memory since
+  const bool found = readFromDisk(key, out);
+  PerformanceMetrics::getInstance().recordCacheLookup(
+      PerformanceMetrics::Cache::Synthesis, found);
+  if (found) {
+    std::lock_guard<std::mutex> lock(mutex);
+    store(key, out);
+  }
+  return found;
+}
+
+void SynthesisCache::insert(uint64_t key, std::vector<float> samples) {
+  {
+    std::lock_guard<std::mutex> lock(diskMutex);
+    if (maxDiskBytes > 0) {
+      auto copy = std::make_shared<const std::vector<float>>(samples);
+      diskJobs.submit(JobSystem::Priority::Background,
+                      [this, key, copy]() { writeToDisk(key, *copy); });
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(mutex);
+  store(key, std::move(samples));
+}
+
+void SynthesisCache::store(uint64_t key, std::vector<float> samples) {
+  const size_t bytes = samples.size() * sizeof(float);
+  if (bytes > maxBytes)
+    return;
+
+  auto it = index.find(key);
+  if (it != index.end()) {
+    numBytes -= it->second->samples.size() * sizeof(float);
+    entries.erase(it->second);
+    index.erase(it);
+  }
+
+  entries.push_front({key, std::move(samples)});
+  index[key] = entries.begin();
+  numBytes += bytes;
+  evictToLimit();
+}
+
+void SynthesisCache::clear() {
+  std::lock_guard<std::mutex> lock(mutex);
+  entries.clear();
+  index.clear();
+  numBytes = 0;
+}
+
+void SynthesisCache::setMaxBytes(size_t bytes) {
+  std::lock_guard<std::mutex> lock(mutex);
+  maxBytes = bytes;
+  evictToLimit();
+}
+
+size_t SynthesisCache::getNumBytes() const {
+  std::lock_guard<std::mutex> lock(mutex);
+  return numBytes;
+}
+
+void SynthesisCache::trimToBytes(size_t bytes) {
+  std::lock_guard<std::mutex> lock(mutex);
+  evictTo(bytes);
+}
+
+void SynthesisCache::evictTo(size_t limit) {
+  while (numBytes > limit && !entries.empty()) {
+    const auto &oldest = entries.back();
+    numBytes -= oldest.samples.size() * sizeof(float);
+    index.erase(oldest.key);
+    entries.pop_back();
+  }
+}
+
+void SynthesisCache::setDiskCache(const juce::File &directory,
+                                  juce::int64 maxDiskBytesIn) {
+  std::lock_guard<std::mutex> lock(diskMutex);
+  diskDirectory = maxDiskBytesIn > 0 ? directory : juce::File();
+  maxDiskBytes = diskDirectory == juce::File() ? 0 : maxDiskBytesIn;
+  diskBytes = 0;
+  if (maxDiskBytes <= 0)
+    return;
+
+  diskJobs.submit(JobSystem::Priority::Background, [this]() {
+    std::lock_guard<std::mutex> jobLock(diskMutex);
+    if (maxDiskBytes <= 0)
+      return;
+    // Writes interrupted by a crash leave .tmp files behind
+    for (const auto &file : diskDirectory.findChildFiles(
+             juce::File::findFiles, false, "*.tmp"))
+      file.deleteFile();
+    diskBytes = 0;
+    for (const auto &file : diskDirectory.findChildFiles(
+             juce::File::findFiles, false, diskPattern))
+      diskBytes += file.getSize();
+    evictDiskTo(maxDiskBytes);
+  });
+}
+
+juce::int64 SynthesisCache::getDiskBytes() const {
+  std::lock_guard<std::mutex> lock(diskMutex);
+  return diskBytes;
+}
+
+juce::File SynthesisCache::getDiskFile(uint64_t key) const {
+  return diskDirectory.getChildFile(
+      juce::String::toHexString(static_cast<juce::int64>(key)) + ".f32");
+}
+
+bool SynthesisCache::readFromDisk(uint64_t key, std::vector<float> &out) {
+  juce::File file;
+  {
+    std::lock_guard<std::mutex> lock(diskMutex);
+    if (maxDiskBytes <= 0)
+      return false;
+    file = getDiskFile(key);
+  }
+
+  juce::FileInputStream in(file);
+  if (!in.openedOk())
+    return false;
+  const auto numBytes = in.getTotalLength();
+  if (numBytes <= 0 || numBytes % static_cast<juce::int64>(sizeof(float)) != 0 ||
+      numBytes > std::numeric_limits<int>::max())
+    return false;
+
+  std::vector<float> samples(static_cast<size_t>(numBytes) / sizeof(float));
+  if (in.read(samples.data(), static_cast<int>(numBytes)) != numBytes)
+    return false;
+
+  // The modification time orders files for eviction
+  file.setLastModificationTime(juce::Time::getCurrentTime());
+  out = std::move(samples);
+  return true;
+}
+
+void SynthesisCache::writeToDisk(uint64_t key,
+                                 const std::vector<float> &samples) {
+  const auto numBytes = samples.size() * sizeof(float);
+  juce::File file;
+  {
+    std::lock_guard<std::mutex> lock(diskMutex);
+    if (maxDiskBytes <= 0 || static_cast<juce::int64>(numBytes) > maxDiskBytes)
+      return;
+    file = getDiskFile(key);
+  }
+  if (file.existsAsFile() || !file.getParentDirectory().createDirectory())
+    return;
+
+  // A temporary name, so an interrupted write never leaves a short entry
+  const auto tempFile = file.withFileExtension(".tmp");
+  bool written = false;
+  {
+    juce::FileOutputStream out(tempFile);
+    written = out.openedOk() && out.write(samples.data(), numBytes);
+    out.flush();
+    written = written && !out.getStatus().failed();
+  }
+  if (!written || !tempFile.moveFileTo(file)) {
+    LOG_WARNING("SynthesisCache: cannot write " + file.getFileName());
+    tempFile.deleteFile();
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(diskMutex);
+  diskBytes += static_cast<juce::int64>(numBytes);
+  // A little under the limit, so the directory is not scanned every insert
+  if (diskBytes > maxDiskBytes)
+    evictDiskTo(maxDiskBytes - maxDiskBytes / 8);
+}
+
+void SynthesisCache::evictDiskTo(juce::int64 limit) {
+  if (diskBytes <= limit || diskDirectory == juce::File())
+    return;
+
+  struct DiskEntry {
+    juce::File file;
+    juce::int64 lastUsed;
+    juce::int64 size;
+  };
+  std::vector<DiskEntry> files;
+  diskBytes = 0;
+  for (const auto &file : diskDirectory.findChildFiles(juce::File::findFiles,
+                                                       false, diskPattern)) {
+    files.push_back({file, file.getLastModificationTime().toMilliseconds(),
+                     file.getSize()});
+    diskBytes += files.back().size;
+  }
+  std::sort(files.begin(), files.end(),
+            [](const DiskEntry &a, const DiskEntry &b) {
+              return a.lastUsed < b.lastUsed;
+            });
+
+  for (const auto &entry : files) {
+    if (diskBytes <= limit)
+      break;
+    if (entry.file.deleteFile())
+      diskBytes -= entry.size;
+  }
+}
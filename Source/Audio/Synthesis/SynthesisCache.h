@@ -0,0 +1,110 @@
+#pragma once
+
+#include "../../JuceHeader.h"
+#include "../../Utils/JobSystem.h"
+#include "../../Utils/MelBuffer.h"
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Bounded LRU cache of vocoder output, keyed by the content that produced it.
+ *
+ * A key hashes the padded mel/F0 input of one segment together with the
+ * render parameters (formant/global offsets, model file, device), so undoing
+ * an edit or toggling back to an earlier pitch finds the audio it produced
+ * before and skips the vocoder entirely.
+ *
+ * With a disk directory set, inserted audio is also written there in the
+ * background, one file per key, and a lookup that misses in memory reads it
+ * back. The key depends only on content, so a reopened project finds the
+ * segments an earlier session synthesized.
+ *
+ * Thread-safe: lookups happen on the message thread, inserts on the thread
+ * that applies vocoder output.
+ */
+class SynthesisCache {
+public:
+  /** Render parameters that change the output for identical mel/F0. */
+  struct Context {
+    float globalPitchOffset = 0.0f;
+    float formantShift = 0.0f;
+    juce::String modelPath;
+    juce::int64 modelModified = 0; // Disk entries outlive a model replaced in place
+    juce::String device;
+    int deviceId = 0;
+    // Vocoder noise seed plus one when rendering is deterministic, so such
+    // entries are exact; 0 when every render draws fresh noise
+    uint64_t noiseSeed = 0;
+  };
+
+  explicit SynthesisCache(size_t maxBytes = 64 * 1024 * 1024);
+  ~SynthesisCache();
+
+  /**
+   * Key for the samples of frames [trimStart, trimStart + numFrames) within
+   * a padded input. The padding is hashed too: it is the context the vocoder
+   * saw, so it shapes the kept samples.
+   */
+  static uint64_t makeKey(const MelView &paddedMel, const float *paddedF0,
+                          int trimStart, int numFrames,
+                          const Context &context);
+
+  /** Copy cached samples into `out`, from memory or disk. Returns false on
+   * a miss. */
+  bool lookup(uint64_t key, std::vector<float> &out);
+
+  void insert(uint64_t key, std::vector<float> samples);
+
+  // Memory only; the disk tier is kept
+  void clear();
+  void setMaxBytes(size_t bytes);
+  size_t getNumBytes() const;
+
+  /** Evict least recently used entries until at most `bytes` remain. The
+   * limit is unchanged, so the cache can grow back afterwards. */
+  void trimToBytes(size_t bytes);
+
+  /**
+   * Persist entries under `directory`, least recently used files deleted
+   * once they pass maxDiskBytes. An empty directory or a limit of 0 turns
+   * the disk tier off. Existing files are counted in the background.
+   */
+  void setDiskCache(const juce::File &directory, juce::int64 maxDiskBytes);
+  juce::int64 getDiskBytes() const;
+
+private:
+  struct Entry {
+    uint64_t key = 0;
+    std::vector<float> samples;
+  };
+
+  void evictToLimit() { evictTo(maxBytes); }
+  void evictTo(size_t limit);
+  // Memory tier insert; mutex held
+  void store(uint64_t key, std::vector<float> samples);
+
+  juce::File getDiskFile(uint64_t key) const; // diskMutex held
+  bool readFromDisk(uint64_t key, std::vector<float> &out);
+  void writeToDisk(uint64_t key, const std::vector<float> &samples);
+  // Delete the least recently used files until at most limit bytes remain;
+  // diskMutex held
+  void evictDiskTo(juce::int64 limit);
+
+  mutable std::mutex mutex;
+  std::list<Entry> entries; // Most recently used first
+  std::unordered_map<uint64_t, std::list<Entry>::iterator> index;
+  size_t maxBytes;
+  size_t numBytes = 0;
+
+  mutable std::mutex diskMutex;
+  juce::File diskDirectory;
+  juce::int64 maxDiskBytes = 0;
+  juce::int64 diskBytes = 0;
+  JobSystem::Group diskJobs; // Last: waited on before the rest goes
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SynthesisCache)
+};
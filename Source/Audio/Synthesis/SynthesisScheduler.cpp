@@ -0,0 +1,62 @@
+#include "SynthesisScheduler.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace SynthesisScheduler {
+int framesUntilHeard(int startFrame, int endFrame, const Playhead &playhead,
+                     double framesPerSecond) {
+  if (endFrame <= startFrame)
+    return notReached;
+
+  int frame = static_cast<int>(
+      std::floor(playhead.positionSeconds * framesPerSecond));
+  const int loopStart = static_cast<int>(
+      std::floor(playhead.loopStartSeconds * framesPerSecond));
+  const int loopEnd =
+      static_cast<int>(std::ceil(playhead.loopEndSeconds * framesPerSecond));
+
+  if (!playhead.looping || loopEnd <= loopStart) {
+    if (endFrame <= frame)
+      return notReached;
+    return std::max(0, startFrame - frame);
+  }
+
+  if (frame >= loopEnd)
+    frame = loopStart;
+
+  // The rest of this pass, up to the loop end
+  if (startFrame < loopEnd && endFrame > frame)
+    return std::max(0, startFrame - frame);
+
+  // The next pass, from the loop start back round to the playhead
+  const int wrapEnd = std::max(loopStart, std::min(frame, loopEnd));
+  if (startFrame < wrapEnd && endFrame > loopStart)
+    return (loopEnd - frame) + std::max(0, startFrame - loopStart);
+
+  return notReached;
+}
+
+std::vector<size_t>
+orderByPlayback(const std::vector<std::pair<int, int>> &ranges,
+                const Playhead &playhead, double framesPerSecond) {
+  std::vector<std::pair<int, size_t>> keyed;
+  keyed.reserve(ranges.size());
+  for (size_t i = 0; i < ranges.size(); ++i) {
+    const int distance = framesUntilHeard(ranges[i].first, ranges[i].second,
+                                          playhead, framesPerSecond);
+    keyed.emplace_back(distance == notReached
+                           ? std::numeric_limits<int>::max()
+                           : distance,
+                       i);
+  }
+  std::stable_sort(keyed.begin(), keyed.end(),
+                   [](const auto &a, const auto &b) { return a.first < b.first; });
+
+  std::vector<size_t> order;
+  order.reserve(keyed.size());
+  for (const auto &entry : keyed)
+    order.push_back(entry.second);
+  return order;
+}
+} // namespace SynthesisScheduler
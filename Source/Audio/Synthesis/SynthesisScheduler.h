@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+/**
+ * Orders dirty-range synthesis by when playback will reach each range, so
+ * the audio about to be heard is rendered first.
+ *
+ * Distances follow the engine's transport: straight ahead to the end of the
+ * file, or round the loop when looping (a playhead past the loop end jumps
+ * to its start). Ranges playback will not reach without a seek, such as
+ * those already passed, go last.
+ */
+namespace SynthesisScheduler {
+struct Playhead {
+  double positionSeconds = 0.0;
+  bool looping = false;
+  double loopStartSeconds = 0.0;
+  double loopEndSeconds = 0.0;
+  // Loop focus: the whole loop is wanted before anything else
+  bool loopFocus = false;
+};
+
+/** Returned by framesUntilHeard() for a range playback will not reach. */
+constexpr int notReached = -1;
+
+/**
+ * Frames of playback before frame range [startFrame, endFrame) is first
+ * heard: 0 if the playhead is inside it.
+ */
+int framesUntilHeard(int startFrame, int endFrame, const Playhead &playhead,
+                     double framesPerSecond);
+
+/**
+ * Indices of ranges, soonest heard first. Unreached ranges follow in their
+ * original order.
+ */
+std::vector<size_t>
+orderByPlayback(const std::vector<std::pair<int, int>> &ranges,
+                const Playhead &playhead, double framesPerSecond);
+} // namespace SynthesisScheduler
@@ -1,148 +1,71 @@
 #include "Vocoder.h"
+#include "OnnxCancellation.h"
+#include "OnnxGpuMemory.h"
+#include "OnnxSessionRegistry.h"
+#include "OnnxThreading.h"
+#include "PerformanceMetrics.h"
+#include "RemoteInference.h"
+#include "SeededNoise.h"
 #include "../Utils/AppLogger.h"
 #include "../Utils/Constants.h"
 #include "../Utils/PlatformPaths.h"
+#include "../Utils/Tracing.h"
 #include <algorithm>
 #include <chrono>
 #include <cmath>
-#include <iomanip>
 #include <sstream>
 #include <thread>
 
-Vocoder::Vocoder() {
-  // Open log file in platform-appropriate logs directory
-  auto logPath = PlatformPaths::getLogFile("vocoder_" +
-                                           AppLogger::getSessionId() + ".txt");
-  logFile = std::make_unique<std::ofstream>(
-      logPath.getFullPathName().toStdString(), std::ios::app);
+namespace {
+// ORT's error for a run stopped through RunOptions::SetTerminate()
+bool isTerminated(const char *message) {
+  return message != nullptr &&
+         std::string(message).find("terminate flag") != std::string::npos;
+}
+} // namespace
 
-  if (logFile && logFile->is_open()) {
-    auto now = std::chrono::system_clock::now();
-    auto time = std::chrono::system_clock::to_time_t(now);
-    *logFile << "\n========== Vocoder Session Started at " << std::ctime(&time)
-             << " ==========\n";
-    logFile->flush();
-  }
+Vocoder::Vocoder() {
+  log("========== Vocoder Session Started at " +
+      juce::Time::getCurrentTime().toString(true, true).toStdString() +
+      " ==========");
 
 #ifdef HAVE_ONNXRUNTIME
-  // Initialize ONNX Runtime environment
+  // The environment is process-wide; creating it here surfaces a broken
+  // runtime install before the first model load
   try {
-    onnxEnv =
-        std::make_unique<Ort::Env>(ORT_LOGGING_LEVEL_WARNING, "HachiTune");
+    (void)OnnxSessionRegistry::getEnv();
     allocator = std::make_unique<Ort::AllocatorWithDefaultOptions>();
     log("ONNX Runtime initialized successfully");
   } catch (const Ort::Exception &e) {
     log("Failed to initialize ONNX Runtime: " + std::string(e.what()));
   }
 #endif
-
-  // Start async worker thread for inferAsync()
-  asyncWorker = std::thread([this]() {
-    for (;;) {
-      AsyncTask task;
-      {
-        std::unique_lock<std::mutex> lock(asyncMutex);
-        asyncCondition.wait(lock, [this]() {
-          return isShuttingDown.load() || !asyncQueue.empty();
-        });
-
-        if (isShuttingDown.load() && asyncQueue.empty())
-          return;
-
-        task = std::move(asyncQueue.front());
-        asyncQueue.pop_front();
-      }
-
-      // Skip work if shutting down
-      if (isShuttingDown.load()) {
-        if (activeAsyncTasks.fetch_sub(1) == 1) {
-          std::lock_guard<std::mutex> lock(asyncMutex);
-          asyncCondition.notify_all();
-        }
-        continue;
-      }
-
-      // If canceled, still invoke callback (with empty result) so callers can
-      // clear state and potentially schedule a rerun.
-      if (task.cancelFlag && task.cancelFlag->load()) {
-        // Mark task done
-        if (activeAsyncTasks.fetch_sub(1) == 1) {
-          std::lock_guard<std::mutex> lock(asyncMutex);
-          asyncCondition.notify_all();
-        }
-
-        auto cb = std::move(task.callback);
-        juce::MessageManager::callAsync([cb]() mutable {
-          if (cb)
-            cb({});
-        });
-        continue;
-      }
-
-      auto result = infer(task.mel, task.f0);
-
-      // Mark task done
-      if (activeAsyncTasks.fetch_sub(1) == 1) {
-        std::lock_guard<std::mutex> lock(asyncMutex);
-        asyncCondition.notify_all();
-      }
-
-      // If shutting down, skip callback
-      if (isShuttingDown.load())
-        continue;
-
-      // Call callback on message thread
-      auto cb = std::move(task.callback);
-      juce::MessageManager::callAsync([cb, result]() mutable {
-        if (cb)
-          cb(result);
-      });
-    }
-  });
 }
 
 Vocoder::~Vocoder() {
   // Signal shutdown
   isShuttingDown.store(true);
 
-  // Wake worker and join
+  // Abort running requests and wait for the queue drainers
   {
     std::lock_guard<std::mutex> lock(asyncMutex);
-    asyncCondition.notify_all();
+    for (auto &running : inFlightTasks)
+      terminateSlot(running.slot);
   }
-  if (asyncWorker.joinable())
-    asyncWorker.join();
+  asyncJobs.wait();
+  warmUpJob.wait();
 
 #ifdef HAVE_ONNXRUNTIME
-  onnxSession.reset();
-  onnxEnv.reset();
+  idleShrink.reset();
+  sessionPool.clear();
 #endif
-  if (logFile && logFile->is_open()) {
-    log("Vocoder session ended");
-    logFile->close();
-  }
+  log("Vocoder session ended");
 }
 
 void Vocoder::log(const std::string &message) {
-  DBG(message);
-  if (logFile && logFile->is_open()) {
-    auto now = std::chrono::system_clock::now();
-    auto time = std::chrono::system_clock::to_time_t(now);
-    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-                  now.time_since_epoch()) %
-              1000;
-
-    std::tm tm_buf;
-#ifdef _WIN32
-    localtime_s(&tm_buf, &time);
-#else
-    localtime_r(&time, &tm_buf);
-#endif
-
-    *logFile << std::put_time(&tm_buf, "%H:%M:%S") << "." << std::setfill('0')
-             << std::setw(3) << ms.count() << " | " << message << "\n";
-    logFile->flush();
-  }
+  // Queued for the logger thread; callers may hold inferenceMutex
+  AppLogger::log(AppLogger::Channel::Vocoder, AppLogger::Level::Info,
+                 message.data(), message.size());
 }
 
 bool Vocoder::isOnnxRuntimeAvailable() {
@@ -155,7 +78,7 @@ bool Vocoder::isOnnxRuntimeAvailable() {
 
 bool Vocoder::loadModel(const juce::File &modelPath) {
 #ifdef HAVE_ONNXRUNTIME
-  if (!onnxEnv) {
+  if (!allocator) {
     log("ONNX Runtime not initialized");
     return false;
   }
@@ -166,23 +89,35 @@ bool Vocoder::loadModel(const juce::File &modelPath) {
     return false;
   }
 
-  try {
-    // Validate ONNX environment
-    if (!onnxEnv) {
-      log("ONNX Runtime environment is null");
-      return false;
-    }
+  // A warm-up from the previous load must not outlive its sessions
+  warmUpJob.wait();
 
-    // Create session with current settings
-    log("Creating session options...");
-    Ort::SessionOptions sessionOptions = createSessionOptions();
+  // Sessions are about to be replaced: wait for in-flight inference to finish
+  // and keep new requests out until the pool is rebuilt.
+  {
+    std::unique_lock<std::mutex> lock(poolMutex);
+    poolCondition.wait(
+        lock, [this]() { return !poolReloading && !anySessionBusy(); });
+    poolReloading = true;
+  }
+  const auto finishReload = [this]() {
+    std::lock_guard<std::mutex> lock(poolMutex);
+    poolReloading = false;
+    poolCondition.notify_all();
+  };
+
+  try {
+    idleShrink.reset();
+    sessionPool.clear();
+    loaded = false;
+    noiseInputIndex = -1;
 
-    // Create session
 #ifdef _WIN32
     // Safely convert path to wide string
     juce::String pathStr = modelPath.getFullPathName();
     if (pathStr.isEmpty()) {
       log("Model path is empty");
+      finishReload();
       return false;
     }
 
@@ -190,6 +125,7 @@ bool Vocoder::loadModel(const juce::File &modelPath) {
     const wchar_t *pathWChar = pathStr.toWideCharPointer();
     if (pathWChar == nullptr) {
       log("Failed to convert model path to wide string");
+      finishReload();
       return false;
     }
     std::wstring modelPathW(pathWChar);
@@ -198,46 +134,92 @@ bool Vocoder::loadModel(const juce::File &modelPath) {
     // longer)
     if (modelPathW.length() == 0 || modelPathW.length() > 32767) {
       log("Invalid model path length: " + std::to_string(modelPathW.length()));
+      finishReload();
       return false;
     }
 
     log("Loading model from: " + pathStr.toStdString());
     log("Path length: " + std::to_string(modelPathW.length()) + " characters");
-
-    // Create the session - this is where the exception might occur
-    onnxSession = std::make_unique<Ort::Session>(*onnxEnv, modelPathW.c_str(),
-                                                 sessionOptions);
 #else
     std::string modelPathStr = modelPath.getFullPathName().toStdString();
     if (modelPathStr.empty()) {
       log("Model path is empty");
+      finishReload();
       return false;
     }
     log("Loading model from: " + modelPathStr);
-    onnxSession = std::make_unique<Ort::Session>(*onnxEnv, modelPathStr.c_str(),
-                                                 sessionOptions);
 #endif
 
-    // Get input names
-    size_t numInputs = onnxSession->GetInputCount();
+    const auto deviceIds = getPoolDeviceIds();
+    const int numDevices = static_cast<int>(deviceIds.size());
+    // A GPU runs one session's kernels at a time, so a second session on
+    // it would only hold another copy of the weights in device memory
+    const bool cpuPool = executionDevice == "CPU";
+    const int numSessions =
+        cpuPool ? std::max(sessionPoolSize, numDevices) : numDevices;
+    log("Creating " + std::to_string(numSessions) + " vocoder session(s) on " +
+        std::to_string(numDevices) + " device(s)");
+
+    bool gpuPool = false;
+    bool cudaArenas = false; // Arenas ORT can shrink on request
+    for (int slotIndex = 0; slotIndex < numSessions; ++slotIndex) {
+      // Create session with current settings
+      log("Creating session options...");
+      const int slotDevice =
+          deviceIds[static_cast<size_t>(slotIndex % numDevices)];
+      juce::String deviceTag;
+      Ort::SessionOptions sessionOptions = createSessionOptions(
+          slotIndex, numSessions, slotDevice, deviceTag);
+
+      // The first slot optimizes the graph (or reads it from the cache);
+      // the rest open the cached graph. Slots are keyed by index so a pool
+      // keeps its separate sessions, while other vocoders with the same
+      // device and pool layout share them.
+      const auto threadingKey =
+          OnnxThreading::describe(OnnxThreading::resolve(
+              OnnxThreading::Model::Vocoder, slotIndex, numSessions)) +
+          " id " + juce::String(slotDevice) + " slot " +
+          juce::String(slotIndex) + "/" + juce::String(numSessions);
+      auto slot = std::make_unique<SessionSlot>();
+      slot->deviceId = slotDevice;
+      slot->session = OnnxSessionRegistry::acquire(modelPath, sessionOptions,
+                                                   deviceTag, threadingKey);
+      PerformanceMetrics::getInstance().setDevice(
+          OnnxThreading::Model::Vocoder, deviceTag);
+      if (deviceTag != "CPU")
+        gpuPool = true;
+      if (deviceTag.startsWith("CUDA") || deviceTag == "TensorRT")
+        cudaArenas = true;
+      sessionPool.push_back(std::move(slot));
+    }
+
+    // Input/output names are identical across the pool; read them once
+    auto &firstSession = *sessionPool.front()->session;
+
+    size_t numInputs = firstSession.GetInputCount();
     inputNameStrings.clear();
     inputNames.clear();
 
     for (size_t i = 0; i < numInputs; ++i) {
-      auto namePtr = onnxSession->GetInputNameAllocated(i, *allocator);
+      auto namePtr = firstSession.GetInputNameAllocated(i, *allocator);
       inputNameStrings.push_back(namePtr.get());
     }
     for (auto &name : inputNameStrings) {
       inputNames.push_back(name.c_str());
     }
+    // Variants exported for deterministic rendering take the source noise
+    // as an input after mel and F0
+    for (size_t i = 2; i < inputNameStrings.size(); ++i)
+      if (juce::String(inputNameStrings[i]).containsIgnoreCase("noise"))
+        noiseInputIndex = static_cast<int>(i);
 
     // Get output names
-    size_t numOutputs = onnxSession->GetOutputCount();
+    size_t numOutputs = firstSession.GetOutputCount();
     outputNameStrings.clear();
     outputNames.clear();
 
     for (size_t i = 0; i < numOutputs; ++i) {
-      auto namePtr = onnxSession->GetOutputNameAllocated(i, *allocator);
+      auto namePtr = firstSession.GetOutputNameAllocated(i, *allocator);
       outputNameStrings.push_back(namePtr.get());
     }
     for (auto &name : outputNameStrings) {
@@ -249,14 +231,44 @@ bool Vocoder::loadModel(const juce::File &modelPath) {
         std::string(inputNames.size() > 0 ? inputNames[0] : "none"));
     log("  Output names: " +
         std::string(outputNames.size() > 0 ? outputNames[0] : "none"));
+    if (noiseInputIndex >= 0)
+      log("  Noise input: " +
+          inputNameStrings[static_cast<size_t>(noiseInputIndex)]);
 
+    // Persistent I/O binding per session; pinned host outputs speed up
+    // device->host copies on CUDA
+    auto outputMemory = OnnxIoBinding::OutputMemory::Cpu;
+#ifdef USE_CUDA
+    if (executionDevice == "CUDA")
+      outputMemory = OnnxIoBinding::OutputMemory::CudaPinned;
+#endif
+    for (auto &slot : sessionPool)
+      slot->ioBinding = std::make_unique<OnnxIoBinding>(
+          *slot->session, inputNames, outputNames, outputMemory,
+          slot->deviceId);
+
+    numPoolDevices.store(numDevices);
+    numPoolSessions.store(numSessions);
+    padToBuckets.store(gpuPool);
+    chunkSizer.reset();
     modelFile = modelPath;
     loaded = true;
+    finishReload();
+
+    if (cudaArenas)
+      idleShrink = std::make_unique<OnnxGpuMemory::IdleShrink>(
+          [this]() { shrinkArenas(); });
+
+    // Pay EP/kernel initialization now instead of on the first edit
+    warmUpJob = JobSystem::getInstance().submit(
+        JobSystem::Priority::Background, [this]() { warmUpSessions(); });
     return true;
 
   } catch (const Ort::Exception &e) {
     log("Failed to load ONNX model: " + std::string(e.what()));
+    sessionPool.clear();
     loaded = false;
+    finishReload();
     return false;
   }
 #else
@@ -283,65 +295,183 @@ bool Vocoder::loadModel(const juce::File &modelPath) {
 #endif
 }
 
-std::vector<float> Vocoder::infer(const std::vector<std::vector<float>> &mel,
+std::vector<float> Vocoder::infer(const MelView &mel,
                                   const std::vector<float> &f0) {
+  TRACE_ZONE("Vocoder::infer");
   if (!loaded || mel.empty() || f0.empty())
     return {};
 
-  // Lock to ensure thread-safe access to ONNX session
-  std::lock_guard<std::mutex> lock(inferenceMutex);
+  const size_t numFrames = std::min(mel.size(), f0.size());
+  auto audio = inferRemote(mel, f0, 0, numFrames, nullptr);
+  if (!audio.empty())
+    return audio;
+
+  // Take a free session from the pool for the duration of this call
+  SessionLease lease(*this);
+
+  return inferFrames(lease.get(), mel, f0, 0, numFrames);
+}
+
+void Vocoder::setRemoteInference(std::shared_ptr<RemoteInference> remote) {
+  std::lock_guard<std::mutex> lock(remoteMutex);
+  remoteInference = std::move(remote);
+}
+
+std::shared_ptr<RemoteInference> Vocoder::getRemoteInference() const {
+  std::lock_guard<std::mutex> lock(remoteMutex);
+  return remoteInference;
+}
+
+std::vector<float> Vocoder::inferRemote(const MelView &mel,
+                                        const std::vector<float> &f0,
+                                        size_t startFrame, size_t numFrames,
+                                        const std::atomic<bool> *cancelFlag) {
+  // The server draws its own noise, so deterministic renders stay local
+  auto remote = getRemoteInference();
+  if (!remote || isDeterministic() || !remote->isAvailable() ||
+      numFrames == 0 ||
+      startFrame + numFrames > std::min(mel.size(), f0.size()))
+    return {};
+
+  std::vector<float> audio;
+  if (!remote->vocode(mel, f0.data(), startFrame, numFrames, sampleRate,
+                      hopSize, cancelFlag, audio))
+    return {};
+  return audio;
+}
 
-  size_t numFrames = std::min(mel.size(), f0.size());
+std::vector<float>
+Vocoder::inferFrames(SessionSlot *slot, const MelView &mel,
+                     const std::vector<float> &f0, size_t startFrame,
+                     size_t numFrames, const std::atomic<bool> *cancelFlag,
+                     const int *framePositions) {
+  bool outOfMemory = false;
+  auto audio = inferFramesOnce(slot, mel, f0, startFrame, numFrames,
+                               cancelFlag, &outOfMemory, framePositions);
+  if (!outOfMemory)
+    return audio;
+
+  // Halves with context on the inner side, blended over a few frames
+  // around the cut
+  constexpr size_t blendFrames = 8;
+  const size_t hop = static_cast<size_t>(hopSize);
+  const size_t half = numFrames / 2;
+  if (half <= splitContextFrames) {
+    log("Out of memory on " + std::to_string(numFrames) +
+        " frames, using fallback");
+    return generateSineFallback(f0.data() + startFrame, numFrames);
+  }
+  if (chunkSizer.shrink(static_cast<int>(numFrames)) > 0)
+    log("Out of memory on " + std::to_string(numFrames) +
+        " frames; streaming chunks now " +
+        std::to_string(chunkSizer.get()) + " frames");
+
+  const auto first =
+      inferFrames(slot, mel, f0, startFrame, half + splitContextFrames,
+                  cancelFlag, framePositions);
+  if (first.empty())
+    return {};
+  const size_t secondStart = startFrame + half - splitContextFrames;
+  const auto second =
+      inferFrames(slot, mel, f0, secondStart,
+                  startFrame + numFrames - secondStart, cancelFlag,
+                  framePositions);
+  if (second.empty())
+    return {};
+
+  audio.assign(numFrames * hop, 0.0f);
+  const size_t blendStart = (half - blendFrames / 2) * hop;
+  const size_t blendEnd = (half + blendFrames / 2) * hop;
+  const size_t secondOffset = (half - splitContextFrames) * hop;
+  for (size_t i = 0; i < audio.size(); ++i) {
+    const float a = i < first.size() ? first[i] : 0.0f;
+    const size_t j = i - std::min(i, secondOffset);
+    const float b = i >= secondOffset && j < second.size() ? second[j] : 0.0f;
+    if (i < blendStart)
+      audio[i] = a;
+    else if (i >= blendEnd)
+      audio[i] = b;
+    else {
+      const float t = (static_cast<float>(i - blendStart) + 0.5f) /
+                      static_cast<float>(blendEnd - blendStart);
+      audio[i] = a + (b - a) * t;
+    }
+  }
+  return audio;
+}
+
+std::vector<float>
+Vocoder::inferFramesOnce(SessionSlot *slot, const MelView &mel,
+                         const std::vector<float> &f0, size_t startFrame,
+                         size_t numFrames, const std::atomic<bool> *cancelFlag,
+                         bool *outOfMemory, const int *framePositions) {
+  if (numFrames == 0 || startFrame + numFrames > mel.size() ||
+      startFrame + numFrames > f0.size())
+    return {};
 
   log("Starting inference with " + std::to_string(numFrames) + " frames");
 
+  const float *f0Begin = f0.data() + startFrame;
   auto startTotal = std::chrono::high_resolution_clock::now();
 
 #ifdef HAVE_ONNXRUNTIME
-  if (!onnxSession) {
+  if (!slot || !slot->session) {
     log("ONNX session not available, using fallback");
-    return generateSineFallback(f0);
+    return generateSineFallback(f0Begin, numFrames);
   }
+  auto &ioBinding = slot->ioBinding;
 
   try {
     auto startPrep = std::chrono::high_resolution_clock::now();
 
-    // Prepare mel input: [batch=1, num_mels, frames]
-    std::vector<int64_t> melShape = {1, static_cast<int64_t>(numMels),
-                                     static_cast<int64_t>(numFrames)};
-    std::vector<float> melData(numMels * numFrames);
-
-    // Transpose mel from [T, num_mels] to [num_mels, T]
-    for (size_t frame = 0; frame < numFrames; ++frame) {
-      for (int m = 0; m < numMels && m < static_cast<int>(mel[frame].size());
-           ++m) {
-        melData[m * numFrames + frame] = mel[frame][m];
-      }
+    if (!ioBinding || ioBinding->getNumInputs() < 2) {
+      log("ONNX I/O binding not available, using fallback");
+      return generateSineFallback(f0Begin, numFrames);
     }
 
-    // Validate and normalize mel spectrogram values
-    // PC-NSF-HiFiGAN typically expects mel values in log domain, already done
-    // But ensure values are in reasonable range (typically -10 to 5 for log
-    // mel)
-    float melMin = 99999.0f, melMax = -99999.0f;
-    for (float v : melData) {
-      melMin = std::min(melMin, v);
-      melMax = std::max(melMax, v);
-    }
-    log("Mel stats: min=" + std::to_string(melMin) +
-        " max=" + std::to_string(melMax));
+    // On a GPU the run is padded to a bucket length with silence, so the
+    // device reuses the kernels and memory planned for it; the output is
+    // trimmed back to numFrames
+    const size_t runFrames =
+        padToBuckets.load() ? frameBuckets.bucketFor(numFrames) : numFrames;
 
-    // Clamp mel values to reasonable range to avoid extreme values
-    // This prevents potential numerical issues in the model
+    // Prepare mel input: [batch=1, num_mels, frames], written straight into
+    // the persistent bound input buffer
+    std::vector<int64_t> melShape = {1, static_cast<int64_t>(numMels),
+                                     static_cast<int64_t>(runFrames)};
+    float *melData = ioBinding->getInputBuffer(0, numMels * runFrames);
+    std::fill(melData, melData + numMels * runFrames, 0.0f);
+    const float silentMel = std::log(1e-5f);
+    for (int m = 0; m < numMels; ++m)
+      std::fill(melData + m * runFrames + numFrames,
+                melData + (m + 1) * runFrames, silentMel);
+
+    // Transpose mel from [T, num_mels] to [num_mels, T] in a single pass over
+    // the contiguous source, gathering stats and clamping on the way.
+    // PC-NSF-HiFiGAN expects log-domain mel in a reasonable range (typically
+    // -10 to 5); clamping prevents numerical issues in the model.
     const float melMinClamp = -15.0f; // Typical minimum for log mel
     const float melMaxClamp = 5.0f;   // Typical maximum for log mel
-    for (float &v : melData) {
-      v = std::clamp(v, melMinClamp, melMaxClamp);
+    const int srcMels = std::min(numMels, mel.getNumMels());
+    float melMin = 99999.0f, melMax = -99999.0f;
+    for (size_t frame = 0; frame < numFrames; ++frame) {
+      const float *melFrame = mel[startFrame + frame];
+      for (int m = 0; m < srcMels; ++m) {
+        const float v = melFrame[m];
+        melMin = std::min(melMin, v);
+        melMax = std::max(melMax, v);
+        melData[m * runFrames + frame] =
+            std::clamp(v, melMinClamp, melMaxClamp);
+      }
     }
+    log("Mel stats: min=" + std::to_string(melMin) +
+        " max=" + std::to_string(melMax));
 
     // Prepare f0 input: [batch=1, frames]
-    std::vector<int64_t> f0Shape = {1, static_cast<int64_t>(numFrames)};
-    std::vector<float> f0Data(f0.begin(), f0.begin() + numFrames);
+    std::vector<int64_t> f0Shape = {1, static_cast<int64_t>(runFrames)};
+    float *f0Data = ioBinding->getInputBuffer(1, runFrames);
+    std::copy(f0Begin, f0Begin + numFrames, f0Data);
+    std::fill(f0Data + numFrames, f0Data + runFrames, 0.0f);
 
     // Validate and clamp F0 values to reasonable range
     // Typical human voice range: 50 Hz to 1000 Hz
@@ -350,7 +480,8 @@ std::vector<float> Vocoder::infer(const std::vector<std::vector<float>> &mel,
 
     float f0Min = 99999.0f, f0Max = 0.0f, f0Sum = 0.0f;
     int voicedCount = 0;
-    for (float &freq : f0Data) {
+    for (size_t i = 0; i < numFrames; ++i) {
+      float &freq = f0Data[i];
       if (freq > 0.0f) {
         // Clamp to valid range
         freq = std::clamp(freq, f0MinValid, f0MaxValid);
@@ -373,45 +504,67 @@ std::vector<float> Vocoder::infer(const std::vector<std::vector<float>> &mel,
                       .count();
     log("Data preparation took " + std::to_string(prepMs) + " ms");
 
-    // Create memory info
-    auto memoryInfo =
-        Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault);
+    // Source noise: [batch=1, 1, samples], each hop drawn at the absolute
+    // position of its frame so the samples do not depend on the cut
+    std::vector<int64_t> noiseShape = {
+        1, 1, static_cast<int64_t>(runFrames) * hopSize};
+    if (noiseInputIndex >= 0) {
+      const std::uint64_t seed =
+          deterministic.load()
+              ? noiseSeed.load()
+              : static_cast<std::uint64_t>(
+                    juce::Random::getSystemRandom().nextInt64());
+      float *noiseData = ioBinding->getInputBuffer(
+          static_cast<size_t>(noiseInputIndex), runFrames * hopSize);
+      std::int64_t position = 0;
+      for (size_t frame = 0; frame < runFrames; ++frame) {
+        // Padding continues from the last real frame
+        const size_t index = startFrame + frame;
+        if (frame < numFrames)
+          position = framePositions != nullptr
+                         ? framePositions[index]
+                         : static_cast<std::int64_t>(index);
+        else
+          ++position;
+        SeededNoise::fill(seed, position * hopSize, noiseData + frame * hopSize,
+                          hopSize);
+      }
+    }
 
-    // Create input tensors
-    std::vector<Ort::Value> inputTensors;
-    inputTensors.push_back(Ort::Value::CreateTensor<float>(
-        memoryInfo, melData.data(), melData.size(), melShape.data(),
-        melShape.size()));
-    inputTensors.push_back(Ort::Value::CreateTensor<float>(
-        memoryInfo, f0Data.data(), f0Data.size(), f0Shape.data(),
-        f0Shape.size()));
+    // Bind inputs over the filled buffers
+    ioBinding->bindInput(0, melShape);
+    ioBinding->bindInput(1, f0Shape);
+    if (noiseInputIndex >= 0)
+      ioBinding->bindInput(static_cast<size_t>(noiseInputIndex), noiseShape);
 
     // Run inference
     auto startInfer = std::chrono::high_resolution_clock::now();
 
     // Validate session and names before inference
-    if (!onnxSession || inputNames.empty() || outputNames.empty()) {
+    if (inputNames.empty() || outputNames.empty()) {
       log("ONNX session or input/output names invalid before inference");
-      return generateSineFallback(f0);
+      return generateSineFallback(f0Begin, numFrames);
     }
 
     // Validate all name pointers are non-null
     for (const auto *name : inputNames) {
       if (name == nullptr) {
         log("Null pointer found in inputNames");
-        return generateSineFallback(f0);
+        return generateSineFallback(f0Begin, numFrames);
       }
     }
     for (const auto *name : outputNames) {
       if (name == nullptr) {
         log("Null pointer found in outputNames");
-        return generateSineFallback(f0);
+        return generateSineFallback(f0Begin, numFrames);
       }
     }
 
-    auto outputTensors = onnxSession->Run(
-        Ort::RunOptions{nullptr}, inputNames.data(), inputTensors.data(),
-        inputTensors.size(), outputNames.data(), outputNames.size());
+    std::vector<Ort::Value> outputTensors;
+    {
+      OnnxCancellation::ScopedRun cancellation(slot->runOptions, cancelFlag);
+      outputTensors = ioBinding->run(slot->runOptions);
+    }
 
     auto endInfer = std::chrono::high_resolution_clock::now();
     auto inferMs = std::chrono::duration_cast<std::chrono::milliseconds>(
@@ -423,7 +576,7 @@ std::vector<float> Vocoder::infer(const std::vector<std::vector<float>> &mel,
     // Get output
     if (outputTensors.empty()) {
       log("ONNX inference returned no output");
-      return generateSineFallback(f0);
+      return generateSineFallback(f0Begin, numFrames);
     }
 
     // Get output tensor info
@@ -439,7 +592,7 @@ std::vector<float> Vocoder::infer(const std::vector<std::vector<float>> &mel,
     log("Output samples: " + std::to_string(outputSize));
 
     // DIAGNOSTIC: Check if output length matches expected length
-    size_t expectedSamples = numFrames * hopSize;
+    size_t expectedSamples = runFrames * hopSize;
     if (outputSize != expectedSamples) {
       log("WARNING: Output length mismatch! Expected " +
           std::to_string(expectedSamples) + " samples (" +
@@ -451,8 +604,10 @@ std::vector<float> Vocoder::infer(const std::vector<std::vector<float>> &mel,
           " samples");
     }
 
-    // Copy output to vector
+    // Copy output to vector, without the padding
     float *outputData = outputTensor.GetTensorMutableData<float>();
+    if (runFrames > numFrames)
+      outputSize = std::min(outputSize, numFrames * hopSize);
     std::vector<float> waveform(outputData, outputData + outputSize);
 
     // Analyze output statistics before normalization
@@ -480,20 +635,38 @@ std::vector<float> Vocoder::infer(const std::vector<std::vector<float>> &mel,
                        endTotal - startTotal)
                        .count();
     log("Total vocoder inference took " + std::to_string(totalMs) + " ms");
+    PerformanceMetrics::getInstance().recordInference(
+        OnnxThreading::Model::Vocoder,
+        static_cast<double>(waveform.size()) / sampleRate,
+        std::chrono::duration<double>(endTotal - startTotal).count());
 
     return waveform;
 
   } catch (const Ort::Exception &e) {
+    if (cancelFlag != nullptr && cancelFlag->load()) {
+      log("ONNX inference cancelled");
+      return {};
+    }
+    // Terminated by a superseding request: no result, never the fallback
+    if (isTerminated(e.what())) {
+      log("ONNX inference terminated");
+      return {};
+    }
+    if (outOfMemory != nullptr && ChunkSizer::isOutOfMemory(e.what())) {
+      log("ONNX inference ran out of memory: " + std::string(e.what()));
+      *outOfMemory = true;
+      return {};
+    }
     log("ONNX inference failed: " + std::string(e.what()));
-    return generateSineFallback(f0);
+    return generateSineFallback(f0Begin, numFrames);
   }
 #else
-  return generateSineFallback(f0);
+  return generateSineFallback(f0Begin, numFrames);
 #endif
 }
 
 std::vector<float>
-Vocoder::inferWithPitchShift(const std::vector<std::vector<float>> &mel,
+Vocoder::inferWithPitchShift(const MelView &mel,
                              const std::vector<float> &f0,
                              float pitchShiftSemitones) {
   if (pitchShiftSemitones == 0.0f)
@@ -511,10 +684,189 @@ Vocoder::inferWithPitchShift(const std::vector<std::vector<float>> &mel,
   return infer(mel, shiftedF0);
 }
 
-void Vocoder::inferAsync(const std::vector<std::vector<float>> &mel,
+namespace {
+bool rangesOverlap(const Vocoder::AsyncOptions &a,
+                   const Vocoder::AsyncOptions &b) {
+  return a.startFrame < b.endFrame && b.startFrame < a.endFrame;
+}
+
+void finishSuperseded(std::function<void(std::vector<float>)> callback) {
+  juce::MessageManager::callAsync([cb = std::move(callback)]() mutable {
+    if (cb)
+      cb({});
+  });
+}
+} // namespace
+
+void Vocoder::supersedeTasks(const AsyncOptions &options,
+                             std::vector<AsyncTask> &dropped) {
+  if (options.coalesceKey == 0)
+    return;
+
+  auto supersedes = [&options](const AsyncOptions &older) {
+    return older.coalesceKey == options.coalesceKey &&
+           rangesOverlap(older, options);
+  };
+
+  for (auto it = asyncQueue.begin(); it != asyncQueue.end();) {
+    if (supersedes(it->options)) {
+      dropped.push_back(std::move(*it));
+      it = asyncQueue.erase(it);
+    } else {
+      ++it;
+    }
+  }
+
+  for (auto &running : inFlightTasks) {
+    if (!running.superseded && supersedes(running.options)) {
+      running.superseded = true;
+      terminateSlot(running.slot);
+    }
+  }
+}
+
+void Vocoder::terminateSlot(SessionSlot *slot) {
+#ifdef HAVE_ONNXRUNTIME
+  // SetTerminate only flips a flag that Run polls; safe from any thread
+  if (slot)
+    slot->runOptions.SetTerminate();
+#else
+  juce::ignoreUnused(slot);
+#endif
+}
+
+void Vocoder::drainAsyncQueue() {
+  for (;;) {
+    AsyncTask task;
+    {
+      std::lock_guard<std::mutex> lock(asyncMutex);
+      if (asyncQueue.empty()) {
+        --numAsyncDrainers;
+        return;
+      }
+
+      // Highest priority first; FIFO within a priority (queue is in
+      // submission order, so the first best match is the oldest)
+      auto next = std::min_element(
+          asyncQueue.begin(), asyncQueue.end(),
+          [](const AsyncTask &a, const AsyncTask &b) {
+            return a.options.priority < b.options.priority;
+          });
+      task = std::move(*next);
+      asyncQueue.erase(next);
+      PerformanceMetrics::getInstance().setQueueDepth(
+          PerformanceMetrics::Queue::VocoderRequests,
+          static_cast<int>(asyncQueue.size()));
+    }
+
+    // Skip work if shutting down
+    if (isShuttingDown.load()) {
+      activeAsyncTasks.fetch_sub(1);
+      continue;
+    }
+
+    // If canceled, still invoke callback (with empty result) so callers can
+    // clear state and potentially schedule a rerun.
+    if (task.cancelFlag && task.cancelFlag->load()) {
+      // Mark task done
+      activeAsyncTasks.fetch_sub(1);
+
+      finishSuperseded(std::move(task.callback));
+      continue;
+    }
+
+    bool superseded = false;
+    // Caller holds asyncMutex
+    auto findRunning = [this, &task]() {
+      return std::find_if(inFlightTasks.begin(), inFlightTasks.end(),
+                          [&task](const InFlightTask &running) {
+                            return running.sequence == task.sequence;
+                          });
+    };
+    // Caller holds no lock
+    auto finishRunning = [this, &findRunning, &superseded]() {
+      std::lock_guard<std::mutex> lock(asyncMutex);
+      auto it = findRunning();
+      if (it != inFlightTasks.end()) {
+        superseded = it->superseded;
+        inFlightTasks.erase(it);
+      }
+    };
+    const size_t numFrames = std::min(task.mel.size(), task.f0.size());
+    std::vector<float> result;
+    {
+      // Registered before the remote run so supersedeTasks() sees it; with
+      // no slot to terminate yet, superseding it only skips the local run
+      {
+        std::lock_guard<std::mutex> lock(asyncMutex);
+        inFlightTasks.push_back(
+            InFlightTask{task.sequence, task.options, nullptr, false});
+      }
+
+      result = inferRemote(task.mel, task.f0, 0, numFrames,
+                           task.cancelFlag.get());
+      if (result.empty()) {
+        SessionLease lease(*this);
+        bool runLocally = true;
+        {
+          std::lock_guard<std::mutex> lock(asyncMutex);
+          auto it = findRunning();
+          if (it != inFlightTasks.end()) {
+            it->slot = lease.get();
+            runLocally = !it->superseded;
+          }
+        }
+        const auto &positions = task.options.framePositions;
+        if (runLocally)
+          result = inferFrames(
+              lease.get(), task.mel, task.f0, 0, numFrames,
+              task.cancelFlag.get(),
+              positions && positions->size() >= numFrames ? positions->data()
+                                                          : nullptr);
+        // Unregister while the lease still holds the session: once it is
+        // back in the pool, supersedeTasks() must not see it through this
+        // entry and terminate whichever request leased it next
+        finishRunning();
+      } else {
+        finishRunning();
+      }
+    }
+
+    // Mark task done
+    activeAsyncTasks.fetch_sub(1);
+
+    // If shutting down, skip callback
+    if (isShuttingDown.load())
+      continue;
+
+    // Cancelled mid-run: same as cancelled before it started
+    if (task.cancelFlag && task.cancelFlag->load()) {
+      finishSuperseded(std::move(task.callback));
+      continue;
+    }
+
+    // A superseded run was terminated, or finished before the terminate
+    // landed; either way its result is stale
+    if (superseded) {
+      log("Async request " + std::to_string(task.sequence) + " superseded");
+      finishSuperseded(std::move(task.callback));
+      continue;
+    }
+
+    // Call callback on message thread
+    auto cb = std::move(task.callback);
+    juce::MessageManager::callAsync([cb, result]() mutable {
+      if (cb)
+        cb(result);
+    });
+  }
+}
+
+void Vocoder::inferAsync(const MelView &mel,
                          const std::vector<float> &f0,
                          std::function<void(std::vector<float>)> callback,
-                         std::shared_ptr<std::atomic<bool>> cancelFlag) {
+                         std::shared_ptr<std::atomic<bool>> cancelFlag,
+                         const AsyncOptions &options) {
   // Check if shutting down
   if (isShuttingDown.load()) {
     log("inferAsync: Vocoder is shutting down, skipping request");
@@ -524,17 +876,303 @@ void Vocoder::inferAsync(const std::vector<std::vector<float>> &mel,
   // Increment active task count
   activeAsyncTasks.fetch_add(1);
 
+  std::vector<AsyncTask> dropped;
+  bool startDrainer = false;
   {
     std::lock_guard<std::mutex> lock(asyncMutex);
-    asyncQueue.push_back(
-        AsyncTask{mel, f0, std::move(callback), std::move(cancelFlag)});
-    asyncCondition.notify_one();
+
+    // One drainer per pooled session so independent requests run in parallel
+    if (numAsyncDrainers < std::max(1, numPoolSessions.load())) {
+      ++numAsyncDrainers;
+      startDrainer = true;
+    }
+
+    supersedeTasks(options, dropped);
+
+    asyncQueue.push_back(AsyncTask{MelBuffer(mel), f0, std::move(callback),
+                                   std::move(cancelFlag), options,
+                                   ++nextTaskSequence});
+    PerformanceMetrics::getInstance().setQueueDepth(
+        PerformanceMetrics::Queue::VocoderRequests,
+        static_cast<int>(asyncQueue.size()));
+  }
+  if (startDrainer)
+    asyncJobs.submit(JobSystem::Priority::Interactive,
+                     [this]() { drainAsyncQueue(); });
+
+  // Dropped requests never reached a worker; complete them here
+  if (!dropped.empty()) {
+    activeAsyncTasks.fetch_sub(static_cast<int>(dropped.size()));
+    for (auto &task : dropped)
+      finishSuperseded(std::move(task.callback));
   }
 }
 
-std::vector<float> Vocoder::generateSineFallback(const std::vector<float> &f0) {
+bool Vocoder::inferStreaming(const MelView &mel,
+                             const std::vector<float> &f0,
+                             const ChunkCallback &onChunk,
+                             const StreamingOptions &options,
+                             const std::atomic<bool> *cancelFlag) {
+  TRACE_ZONE("Vocoder::inferStreaming");
+  if (!loaded || mel.empty() || f0.empty() || !onChunk)
+    return false;
+
+  const size_t totalFrames = std::min(mel.size(), f0.size());
+  int requestedChunkFrames =
+      options.chunkFrames > 0 ? options.chunkFrames : chunkSizer.get();
+  // Padded to buckets, a chunk's whole input (context and crossfade tail
+  // included) is made the chunk size, which is a bucket, so interior chunks
+  // run unpadded
+  if (options.chunkFrames <= 0 && padToBuckets.load())
+    requestedChunkFrames = std::max(
+        requestedChunkFrames / 2,
+        requestedChunkFrames - 2 * std::max(0, options.contextFrames) -
+            std::max(0, options.crossfadeFrames));
+  const size_t chunkFrames = static_cast<size_t>(requestedChunkFrames);
+  const size_t contextFrames =
+      static_cast<size_t>(std::max(0, options.contextFrames));
+  const size_t crossfadeFrames = static_cast<size_t>(
+      std::clamp(options.crossfadeFrames, 0, requestedChunkFrames / 2));
+  const size_t hop = static_cast<size_t>(hopSize);
+
+  log("Streaming inference: " + std::to_string(totalFrames) +
+      " frames, chunk=" + std::to_string(chunkFrames) +
+      " context=" + std::to_string(contextFrames) +
+      " crossfade=" + std::to_string(crossfadeFrames));
+
+  auto startTotal = std::chrono::high_resolution_clock::now();
+
+  // The islands between skipped ranges, cut into chunks
+  struct Chunk {
+    size_t start, end, islandStart, islandEnd;
+  };
+  std::vector<Chunk> chunks;
+  size_t islandStart = 0;
+  size_t skippedFrames = 0;
+  auto addIsland = [&](size_t from, size_t to) {
+    for (size_t start = from; start < to; start += chunkFrames)
+      chunks.push_back({start, std::min(to, start + chunkFrames), from, to});
+  };
+  for (const auto &skip : options.skipFrames) {
+    const size_t skipStart = std::clamp<size_t>(
+        static_cast<size_t>(std::max(0, skip.first)), islandStart, totalFrames);
+    const size_t skipEnd = std::clamp<size_t>(
+        static_cast<size_t>(std::max(0, skip.second)), islandStart,
+        totalFrames);
+    if (skipStart >= skipEnd)
+      continue;
+    addIsland(islandStart, skipStart);
+    skippedFrames += skipEnd - skipStart;
+    islandStart = skipEnd;
+  }
+  addIsland(islandStart, totalFrames);
+  const size_t numChunks = chunks.size();
+  if (skippedFrames > 0)
+    log("Skipping " + std::to_string(skippedFrames) + " silent frames");
+
+  auto tailEndOf = [&](const Chunk &chunk) {
+    return chunk.end < chunk.islandEnd
+               ? std::min(chunk.islandEnd, chunk.end + crossfadeFrames)
+               : chunk.end;
+  };
+  // Model input of chunk k: its frames plus the crossfade tail, with context
+  // on both sides
+  auto chunkInput = [&](size_t k, size_t &inStart, size_t &inEnd) {
+    const size_t start = chunks[k].start;
+    const size_t tailEnd = tailEndOf(chunks[k]);
+    inStart = start > contextFrames ? start - contextFrames : 0;
+    inEnd = std::min(totalFrames, tailEnd + contextFrames);
+  };
+
+  // Chunks are synthesized on every GPU of the pool, or as many as the
+  // remote backend takes, at once and delivered in order from here. Plain
+  // threads: each holds a pool session or waits on the server, and the
+  // caller may be a job that other jobs must not be run inside of.
+  const auto remote = getRemoteInference();
+  const int parallelChunks =
+      std::max(numPoolDevices.load(), remote ? remote->getMaxInFlight() : 1);
+  const size_t numShards =
+      std::min(numChunks, static_cast<size_t>(std::max(1, parallelChunks)));
+  const size_t window = 2 * numShards;
+  struct ShardResult {
+    std::vector<float> audio;
+    bool done = false;
+  };
+  std::vector<ShardResult> results(numShards > 1 ? window : 0);
+  std::mutex shardMutex;
+  std::condition_variable shardCondition;
+  size_t nextToClaim = 0;
+  size_t nextToDeliver = 0;
+  bool stopShards = false;
+  std::atomic<bool> shardCancel{false};
+  std::vector<std::thread> shardThreads;
+
+  auto stopAndJoin = [&]() {
+    {
+      std::lock_guard<std::mutex> lock(shardMutex);
+      stopShards = true;
+    }
+    shardCancel.store(true);
+    shardCondition.notify_all();
+    for (auto &thread : shardThreads)
+      thread.join();
+    shardThreads.clear();
+  };
+
+  if (numShards > 1) {
+    for (size_t i = 0; i < numShards; ++i) {
+      shardThreads.emplace_back([&]() {
+        juce::Thread::setCurrentThreadName("HachiTune vocoder shard");
+        for (;;) {
+          size_t k = 0;
+          {
+            std::unique_lock<std::mutex> lock(shardMutex);
+            shardCondition.wait(lock, [&]() {
+              return stopShards || nextToClaim >= numChunks ||
+                     nextToClaim < nextToDeliver + window;
+            });
+            if (stopShards || nextToClaim >= numChunks)
+              return;
+            k = nextToClaim++;
+          }
+
+          size_t inStart = 0, inEnd = 0;
+          chunkInput(k, inStart, inEnd);
+          std::vector<float> audio =
+              inferRemote(mel, f0, inStart, inEnd - inStart, &shardCancel);
+          if (audio.empty()) {
+            SessionLease lease(*this);
+            if (loaded)
+              audio = inferFrames(lease.get(), mel, f0, inStart,
+                                  inEnd - inStart, &shardCancel);
+          }
+          {
+            std::lock_guard<std::mutex> lock(shardMutex);
+            results[k % window] = {std::move(audio), true};
+          }
+          shardCondition.notify_all();
+        }
+      });
+    }
+  }
+
+  // Model output of chunk k, once it is ready. Raising cancelFlag reaches
+  // the shards through shardCancel.
+  auto takeChunk = [&](size_t k) -> std::vector<float> {
+    if (numShards <= 1) {
+      size_t inStart = 0, inEnd = 0;
+      chunkInput(k, inStart, inEnd);
+      auto audio =
+          inferRemote(mel, f0, inStart, inEnd - inStart, cancelFlag);
+      if (!audio.empty())
+        return audio;
+      SessionLease lease(*this);
+      if (!loaded)
+        return {};
+      return inferFrames(lease.get(), mel, f0, inStart, inEnd - inStart,
+                         cancelFlag);
+    }
+    std::unique_lock<std::mutex> lock(shardMutex);
+    auto &result = results[k % window];
+    while (!result.done) {
+      if (cancelFlag != nullptr && cancelFlag->load())
+        return {};
+      shardCondition.wait_for(lock, std::chrono::milliseconds(5));
+    }
+    auto audio = std::move(result.audio);
+    result = {};
+    nextToDeliver = k + 1;
+    lock.unlock();
+    shardCondition.notify_all();
+    return audio;
+  };
+
+  // Audio for the frames just past the previous chunk's end, rendered by the
+  // previous call and blended into the start of the next one.
+  std::vector<float> pendingTail;
+  std::vector<float> block;
+
+  // Raised-cosine fade-in gain of sample i of length (gains sum to 1)
+  auto fadeIn = [](size_t i, size_t length) {
+    const float s = std::sin(0.5f * juce::MathConstants<float>::pi *
+                             (static_cast<float>(i) + 0.5f) /
+                             static_cast<float>(length));
+    return s * s;
+  };
+
+  for (size_t k = 0; k < numChunks; ++k) {
+    const auto &chunk = chunks[k];
+    const size_t start = chunk.start;
+    const size_t end = chunk.end;
+    const size_t tailEnd = tailEndOf(chunk);
+    if (start == chunk.islandStart)
+      pendingTail.clear();
+    size_t inStart = 0, inEnd = 0;
+    chunkInput(k, inStart, inEnd);
+
+    const std::vector<float> audio = takeChunk(k);
+    if (cancelFlag != nullptr && cancelFlag->load()) {
+      log("Streaming inference cancelled at frame " + std::to_string(start));
+      stopAndJoin();
+      return false;
+    }
+    if (audio.empty()) {
+      log("Streaming inference failed at frame " + std::to_string(start));
+      stopAndJoin();
+      return false;
+    }
+
+    // Cut the context away; keep [start, tailEnd). Pad if the model returned
+    // fewer samples than expected.
+    const size_t offset = (start - inStart) * hop;
+    block.assign((tailEnd - start) * hop, 0.0f);
+    if (offset < audio.size()) {
+      const size_t available = std::min(block.size(), audio.size() - offset);
+      std::copy(audio.begin() + offset, audio.begin() + offset + available,
+                block.begin());
+    }
+
+    // Crossfade with the previous chunk's tail
+    const size_t fadeLen = std::min(pendingTail.size(), block.size());
+    for (size_t i = 0; i < fadeLen; ++i) {
+      const float gain = fadeIn(i, fadeLen);
+      block[i] = pendingTail[i] * (1.0f - gain) + block[i] * gain;
+    }
+
+    // Fade in and out beside skipped frames. The frames there are quiet, so
+    // whatever fills the gap meets them without a click.
+    const size_t emitSamples = (end - start) * hop;
+    const size_t edgeLen = std::min(crossfadeFrames * hop, emitSamples);
+    if (start == chunk.islandStart && start > 0)
+      for (size_t i = 0; i < edgeLen; ++i)
+        block[i] *= fadeIn(i, edgeLen);
+    if (end == chunk.islandEnd && end < totalFrames)
+      for (size_t i = 0; i < edgeLen; ++i)
+        block[emitSamples - 1 - i] *= fadeIn(i, edgeLen);
+
+    pendingTail.assign(block.begin() + emitSamples, block.end());
+
+    if (!onChunk(block.data(), static_cast<int>(emitSamples),
+                 static_cast<juce::int64>(start * hop))) {
+      log("Streaming inference stopped by caller at frame " +
+          std::to_string(start));
+      stopAndJoin();
+      return false;
+    }
+  }
+  stopAndJoin();
+
+  auto totalMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+                     std::chrono::high_resolution_clock::now() - startTotal)
+                     .count();
+  log("Streaming inference took " + std::to_string(totalMs) + " ms on " +
+      std::to_string(numShards) + " shard(s)");
+  return true;
+}
+
+std::vector<float> Vocoder::generateSineFallback(const float *f0,
+                                                size_t numFrames) {
   // Fallback: Generate simple sine wave based on F0
-  size_t numFrames = f0.size();
   size_t numSamples = numFrames * hopSize;
 
   std::vector<float> waveform(numSamples, 0.0f);
@@ -570,43 +1208,261 @@ void Vocoder::setExecutionDevice(const juce::String &device) {
 }
 
 void Vocoder::setExecutionDeviceId(int deviceId) {
-  if (deviceId < 0)
-    deviceId = 0;
-  if (executionDeviceId != deviceId) {
-    executionDeviceId = deviceId;
-    log("Execution device ID set to: " + std::to_string(deviceId));
+  setExecutionDeviceIds({deviceId});
+}
+
+void Vocoder::setExecutionDeviceIds(std::vector<int> deviceIds) {
+  for (auto &id : deviceIds)
+    id = std::max(0, id);
+  // A device listed twice would only get more sessions; the pool size
+  // already says how many
+  std::vector<int> unique;
+  for (int id : deviceIds)
+    if (std::find(unique.begin(), unique.end(), id) == unique.end())
+      unique.push_back(id);
+  if (unique.empty())
+    unique.push_back(0);
+
+  if (executionDeviceIds != unique) {
+    executionDeviceIds = std::move(unique);
+    juce::StringArray ids;
+    for (int id : executionDeviceIds)
+      ids.add(juce::String(id));
+    log("Execution device IDs set to: " + ids.joinIntoString(",").toStdString());
   }
 }
 
+std::vector<int> Vocoder::getPoolDeviceIds() const {
+  // Device IDs mean nothing to these providers
+  if (executionDevice == "CPU" || executionDevice == "CoreML")
+    return {executionDeviceIds.front()};
+  return executionDeviceIds;
+}
+
 bool Vocoder::reloadModel() {
   if (!modelFile.existsAsFile()) {
     log("Cannot reload: no model file set");
     return false;
   }
 
-  // Lock to prevent reload during inference
-  std::lock_guard<std::mutex> lock(inferenceMutex);
-
+  // loadModel waits for in-flight inference and rebuilds the session pool
   log("Reloading model with new settings...");
+  return loadModel(modelFile);
+}
 
+void Vocoder::setSessionPoolSize(int numSessions) {
+  numSessions = std::clamp(numSessions, 1, 8);
+  if (sessionPoolSize != numSessions) {
+    sessionPoolSize = numSessions;
+    log("Session pool size set to: " + std::to_string(numSessions));
+  }
+}
+
+void Vocoder::warmUpSessions() {
 #ifdef HAVE_ONNXRUNTIME
-  // Release existing session
-  onnxSession.reset();
-  inputNames.clear();
-  outputNames.clear();
-  inputNameStrings.clear();
-  outputNameStrings.clear();
-  loaded = false;
+  // A few frames of silence: enough to initialize every kernel in the graph
+  constexpr size_t warmUpFrames = 16;
+  const MelBuffer silence(warmUpFrames, numMels, std::log(1e-5f));
+  const std::vector<float> f0(warmUpFrames, 0.0f);
+
+  auto start = std::chrono::high_resolution_clock::now();
+  int warmed = 0;
+
+  for (size_t i = 0;; ++i) {
+    if (isShuttingDown.load())
+      return;
+
+    // Only take slots that are idle; real requests always win
+    SessionSlot *slot = nullptr;
+    {
+      std::lock_guard<std::mutex> lock(poolMutex);
+      if (poolReloading || i >= sessionPool.size())
+        break;
+      if (!sessionPool[i]->busy) {
+        slot = sessionPool[i].get();
+        slot->busy = true;
+      }
+    }
+    if (!slot)
+      continue;
+
+    inferFrames(slot, silence, f0, 0, warmUpFrames);
+    releaseSession(slot);
+    ++warmed;
+  }
+
+  auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::high_resolution_clock::now() - start)
+                .count();
+  log("Warm-up of " + std::to_string(warmed) + " session(s) took " +
+      std::to_string(ms) + " ms");
+
+  // CPU keeps the default: throughput there barely depends on length, and
+  // longer calls only delay the first audio
+  if (executionDevice == "CPU" || isShuttingDown.load())
+    return;
+  SessionSlot *slot = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(poolMutex);
+    if (poolReloading || sessionPool.empty() || sessionPool[0]->busy)
+      return;
+    slot = sessionPool[0].get();
+    slot->busy = true;
+  }
+  const int chosen = chunkSizer.calibrate(
+      [&](int frames) {
+        if (isShuttingDown.load())
+          return false;
+        const size_t n = static_cast<size_t>(frames);
+        const MelBuffer quiet(n, numMels, std::log(1e-5f));
+        const std::vector<float> unvoiced(n, 0.0f);
+        bool outOfMemory = false;
+        return !inferFramesOnce(slot, quiet, unvoiced, 0, n, nullptr,
+                                &outOfMemory)
+                    .empty() &&
+               !outOfMemory;
+      },
+      1.0);
+  releaseSession(slot);
+  log("Streaming chunks: " + std::to_string(chosen) + " frames");
+
+  // Plan every bucket a chunk or a short preview can be padded to on each
+  // session now, so no interactive run pays for a new shape
+  if (!padToBuckets.load())
+    return;
+  const auto buckets = frameBuckets.upTo(static_cast<size_t>(chosen));
+  start = std::chrono::high_resolution_clock::now();
+  for (size_t i = 0;; ++i) {
+    if (isShuttingDown.load())
+      return;
+    SessionSlot *idle = nullptr;
+    {
+      std::lock_guard<std::mutex> lock(poolMutex);
+      if (poolReloading || i >= sessionPool.size())
+        break;
+      if (!sessionPool[i]->busy) {
+        idle = sessionPool[i].get();
+        idle->busy = true;
+      }
+    }
+    if (!idle)
+      continue;
+    for (const size_t frames : buckets) {
+      if (isShuttingDown.load())
+        break;
+      const MelBuffer quiet(frames, numMels, std::log(1e-5f));
+      const std::vector<float> unvoiced(frames, 0.0f);
+      bool outOfMemory = false;
+      inferFramesOnce(idle, quiet, unvoiced, 0, frames, nullptr, &outOfMemory);
+      if (outOfMemory)
+        break;
+    }
+    releaseSession(idle);
+  }
+  ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+           std::chrono::high_resolution_clock::now() - start)
+           .count();
+  log("Planning " + std::to_string(buckets.size()) + " shape(s) took " +
+      std::to_string(ms) + " ms");
 #endif
+}
 
-  return loadModel(modelFile);
+void Vocoder::shrinkArenas() {
+#ifdef HAVE_ONNXRUNTIME
+  // A few silent frames per idle session; the arena hands its free chunks
+  // back to the driver as the run ends. Busy sessions are in use again.
+  constexpr size_t shrinkFrames = 16;
+  const MelBuffer silence(shrinkFrames, numMels, std::log(1e-5f));
+  const std::vector<float> f0(shrinkFrames, 0.0f);
+  int shrunk = 0;
+  for (size_t i = 0;; ++i) {
+    SessionSlot *slot = nullptr;
+    {
+      std::lock_guard<std::mutex> lock(poolMutex);
+      if (poolReloading || isShuttingDown.load() || i >= sessionPool.size())
+        break;
+      if (!sessionPool[i]->busy) {
+        slot = sessionPool[i].get();
+        slot->busy = true;
+      }
+    }
+    if (!slot)
+      continue;
+
+    Ort::RunOptions runOptions;
+    OnnxGpuMemory::requestShrink(runOptions, slot->deviceId);
+    std::swap(slot->runOptions, runOptions);
+    inferFramesOnce(slot, silence, f0, 0, shrinkFrames, nullptr, nullptr);
+    std::swap(slot->runOptions, runOptions);
+    releaseSession(slot);
+    ++shrunk;
+  }
+  log("Released idle GPU memory of " + std::to_string(shrunk) +
+      " session(s)");
+#endif
 }
 
+Vocoder::SessionSlot *Vocoder::acquireSession() {
+  std::unique_lock<std::mutex> lock(poolMutex);
 #ifdef HAVE_ONNXRUNTIME
-Ort::SessionOptions Vocoder::createSessionOptions() {
-  Ort::SessionOptions sessionOptions;
+  if (idleShrink)
+    idleShrink->touch();
+  poolCondition.wait(lock, [this]() {
+    if (poolReloading)
+      return false;
+    if (sessionPool.empty())
+      return true;
+    return std::any_of(sessionPool.begin(), sessionPool.end(),
+                       [](const auto &slot) { return !slot->busy; });
+  });
 
-  // Let ONNX Runtime handle threading automatically
+  for (auto &slot : sessionPool) {
+    if (!slot->busy) {
+      slot->busy = true;
+      return slot.get();
+    }
+  }
+#endif
+  return nullptr;
+}
+
+void Vocoder::releaseSession(SessionSlot *slot) {
+  if (!slot)
+    return;
+#ifdef HAVE_ONNXRUNTIME
+  // Re-arm the slot in case its last run was terminated
+  slot->runOptions.UnsetTerminate();
+#endif
+  std::lock_guard<std::mutex> lock(poolMutex);
+  slot->busy = false;
+  poolCondition.notify_all();
+}
+
+bool Vocoder::anySessionBusy() const {
+#ifdef HAVE_ONNXRUNTIME
+  return std::any_of(sessionPool.begin(), sessionPool.end(),
+                     [](const auto &slot) { return slot->busy; });
+#else
+  return false;
+#endif
+}
+
+#ifdef HAVE_ONNXRUNTIME
+Ort::SessionOptions Vocoder::createSessionOptions(int slotIndex,
+                                                 int numSessions, int deviceId,
+                                                 juce::String &deviceTag) {
+  Ort::SessionOptions sessionOptions;
+  deviceTag = "CPU";
+
+  // Thread counts come from the shared budget so pooled sessions and
+  // concurrent analysis do not oversubscribe the CPU
+  auto threading = OnnxThreading::apply(sessionOptions,
+                                        OnnxThreading::Model::Vocoder,
+                                        slotIndex, numSessions);
+  log("Session " + std::to_string(slotIndex) + ": " +
+      std::to_string(threading.intraOpThreads) + " intra-op threads" +
+      (threading.cores.empty() ? "" : ", pinned") +
+      (threading.allowSpinning ? "" : ", no spinning"));
 
   // Enable all optimizations
   sessionOptions.SetGraphOptimizationLevel(
@@ -625,10 +1481,12 @@ Ort::SessionOptions Vocoder::createSessionOptions() {
   if (executionDevice == "CUDA") {
     try {
       OrtCUDAProviderOptions cudaOptions{};
-      cudaOptions.device_id = executionDeviceId;
+      cudaOptions.device_id = deviceId;
+      OnnxGpuMemory::apply(cudaOptions);
       sessionOptions.AppendExecutionProvider_CUDA(cudaOptions);
+      deviceTag = "CUDA" + juce::String(deviceId);
       log("CUDA execution provider added (device " +
-          std::to_string(executionDeviceId) + ")");
+          std::to_string(deviceId) + ")");
     } catch (const Ort::Exception &e) {
       log("Failed to add CUDA provider: " + std::string(e.what()));
       log("Falling back to CPU");
@@ -647,9 +1505,10 @@ Ort::SessionOptions Vocoder::createSessionOptions() {
       sessionOptions.SetExecutionMode(ORT_SEQUENTIAL);
 
       Ort::ThrowOnError(ortDmlApi->SessionOptionsAppendExecutionProvider_DML(
-          sessionOptions, executionDeviceId));
+          sessionOptions, deviceId));
+      deviceTag = "DirectML";
       log("DirectML execution provider added (device " +
-          std::to_string(executionDeviceId) + ")");
+          std::to_string(deviceId) + ")");
     } catch (const Ort::Exception &e) {
       log("Failed to add DirectML provider: " + std::string(e.what()));
       log("Falling back to CPU");
@@ -659,6 +1518,7 @@ Ort::SessionOptions Vocoder::createSessionOptions() {
       if (executionDevice == "CoreML") {
     try {
       sessionOptions.AppendExecutionProvider("CoreML");
+      deviceTag = "CoreML";
       log("CoreML execution provider added");
     } catch (const Ort::Exception &e) {
       log("Failed to add CoreML provider: " + std::string(e.what()));
@@ -669,7 +1529,10 @@ Ort::SessionOptions Vocoder::createSessionOptions() {
   else if (executionDevice == "TensorRT") {
     try {
       OrtTensorRTProviderOptions trtOptions{};
+      trtOptions.device_id = deviceId;
+      OnnxGpuMemory::apply(trtOptions);
       sessionOptions.AppendExecutionProvider_TensorRT(trtOptions);
+      deviceTag = "TensorRT";
       log("TensorRT execution provider added");
     } catch (const Ort::Exception &e) {
       log("Failed to add TensorRT provider: " + std::string(e.what()));
@@ -1,14 +1,20 @@
 #pragma once
 
 #include "../JuceHeader.h"
+#include "../Utils/JobSystem.h"
+#include "../Utils/MelBuffer.h"
+#include "ChunkSizer.h"
+#include "OnnxGpuMemory.h"
+#include "OnnxIoBinding.h"
+#include "ShapeBuckets.h"
 #include <atomic>
 #include <condition_variable>
+#include <cstdint>
 #include <deque>
-#include <fstream>
 #include <functional>
 #include <memory>
 #include <mutex>
-#include <thread>
+#include <utility>
 #include <vector>
 
 #ifdef HAVE_ONNXRUNTIME
@@ -18,6 +24,8 @@
 #endif
 #endif
 
+class RemoteInference;
+
 /**
  * PC-NSF-HiFiGAN Vocoder wrapper using ONNX Runtime.
  * Converts mel spectrogram + F0 to waveform with pitch control.
@@ -46,12 +54,11 @@ public:
 
   /**
    * Synthesize waveform from mel spectrogram and F0.
-   * @param mel Mel spectrogram [T, NUM_MELS] (T frames, each with NUM_MELS
-   * values)
+   * @param mel Mel spectrogram [T, NUM_MELS], frame-major
    * @param f0 F0 values [T] (fundamental frequency per frame)
    * @return Synthesized waveform, or empty vector on failure
    */
-  std::vector<float> infer(const std::vector<std::vector<float>> &mel,
+  std::vector<float> infer(const MelView &mel,
                            const std::vector<float> &f0);
 
   /**
@@ -62,19 +69,99 @@ public:
    * @return Synthesized waveform
    */
   std::vector<float>
-  inferWithPitchShift(const std::vector<std::vector<float>> &mel,
+  inferWithPitchShift(const MelView &mel,
                       const std::vector<float> &f0, float pitchShiftSemitones);
 
+  /**
+   * Scheduling class for async requests. Lower values run first; requests of
+   * equal priority run in submission order.
+   */
+  enum class Priority { Interactive = 0, PlaybackAhead = 1, Export = 2 };
+
+  /**
+   * Scheduling options for inferAsync.
+   * A request with a non-zero coalesceKey supersedes every older request
+   * with the same key whose frame range [startFrame, endFrame) overlaps its
+   * own: queued ones are dropped before reaching ONNX, running ones are
+   * terminated. Superseded callbacks receive an empty result.
+   */
+  struct AsyncOptions {
+    Priority priority = Priority::Interactive;
+    std::uint64_t coalesceKey = 0;
+    int startFrame = 0;
+    int endFrame = 0;
+    // Absolute frame of each input frame, which the seeded noise is taken
+    // at (packed inputs); null when input frame i is frame i
+    std::shared_ptr<const std::vector<int>> framePositions;
+  };
+
   /**
    * Asynchronous inference with callback.
    * @param mel Mel spectrogram
    * @param f0 F0 values
    * @param callback Called with result on completion
+   * @param options Priority and coalescing for this request
    */
-  void inferAsync(const std::vector<std::vector<float>> &mel,
+  void inferAsync(const MelView &mel,
                   const std::vector<float> &f0,
                   std::function<void(std::vector<float>)> callback,
-                  std::shared_ptr<std::atomic<bool>> cancelFlag = nullptr);
+                  std::shared_ptr<std::atomic<bool>> cancelFlag = nullptr,
+                  const AsyncOptions &options = {});
+
+  /**
+   * Chunking parameters for streaming synthesis (all in mel frames).
+   */
+  struct StreamingOptions {
+    int chunkFrames = 0;     // Frames per model call; 0 = getChunkFrames()
+    int contextFrames = 32;  // Extra frames fed on each side, then discarded
+    int crossfadeFrames = 8; // Overlap blended between neighbouring chunks
+    // Frames [start, end) not synthesized, sorted and disjoint (see
+    // SilenceSkipping). Chunks stop at them and the audio beside them fades
+    // over crossfadeFrames; the callback sees the gap as a jump in
+    // startSample.
+    std::vector<std::pair<int, int>> skipFrames;
+  };
+
+  /**
+   * Receives one block of finished audio. startSample is the position of
+   * samples[0] in the full output. Return false to stop streaming.
+   */
+  using ChunkCallback = std::function<bool(
+      const float *samples, int numSamples, juce::int64 startSample)>;
+
+  /**
+   * Synthesize in fixed-size chunks with overlap-add, so peak memory does not
+   * grow with input length. Blocks are delivered in order on the calling
+   * thread. The inference lock is only held per chunk. Raising cancelFlag
+   * aborts the chunk being synthesized. When the pool spans several GPUs
+   * (setExecutionDeviceIds()), that many chunks are synthesized at once,
+   * at most two per GPU ahead of the one being delivered. With a remote
+   * backend (setRemoteInference()) up to its getMaxInFlight() chunks are
+   * requested at once instead, if that is more.
+   * @return true if every chunk was synthesized and delivered
+   */
+  bool inferStreaming(const MelView &mel,
+                      const std::vector<float> &f0,
+                      const ChunkCallback &onChunk,
+                      const StreamingOptions &options = {},
+                      const std::atomic<bool> *cancelFlag = nullptr);
+
+  /**
+   * Deterministic rendering (default on). NSF-HiFiGAN excites its harmonic
+   * source with noise; a model exported with a "noise" input ([1, 1,
+   * frames * hop], standard normal) is fed SeededNoise for it, drawn at
+   * each sample's absolute position, so a render comes out the same
+   * however it is chunked, packed or sharded across GPUs. Off, each call
+   * draws a fresh seed. Models that draw their noise in the graph ignore
+   * this; isDeterministic() then stays false.
+   */
+  void setDeterministic(bool enabled) { deterministic = enabled; }
+  void setNoiseSeed(std::uint64_t seed) { noiseSeed = seed; }
+  std::uint64_t getNoiseSeed() const { return noiseSeed.load(); }
+  bool hasNoiseInput() const { return noiseInputIndex >= 0; }
+  bool isDeterministic() const {
+    return deterministic.load() && hasNoiseInput();
+  }
 
   // Model parameters
   int getSampleRate() const { return sampleRate; }
@@ -86,20 +173,102 @@ public:
   void setExecutionDevice(const juce::String &device);
   juce::String getExecutionDevice() const { return executionDevice; }
   void setExecutionDeviceId(int deviceId);
-  int getExecutionDeviceId() const { return executionDeviceId; }
+  int getExecutionDeviceId() const { return executionDeviceIds.front(); }
+
+  /**
+   * Spread the session pool over several GPUs: slot i runs on
+   * deviceIds[i % n], and the pool holds at least one slot per device.
+   * CPU and CoreML use the first ID only. Takes effect on the next
+   * loadModel()/reloadModel().
+   */
+  void setExecutionDeviceIds(std::vector<int> deviceIds);
+  const std::vector<int> &getExecutionDeviceIds() const {
+    return executionDeviceIds;
+  }
+
+  // Model file of the last successful load
+  juce::File getModelFile() const { return modelFile; }
 
   // Reload model with new settings (call after changing device)
   bool reloadModel();
 
+  /**
+   * Number of independent ONNX sessions kept for parallel inference
+   * (clamped to 1..8). Each session holds its own copy of the model weights.
+   * CPU only: GPU providers keep one session per device. Takes effect on
+   * the next loadModel()/reloadModel().
+   */
+  void setSessionPoolSize(int numSessions);
+  int getSessionPoolSize() const { return sessionPoolSize; }
+
+  /**
+   * Frames per model call in streaming synthesis. 1024 (~12 s) on CPU; on
+   * GPUs the warm-up after each load times silent calls of each candidate
+   * length and keeps the fastest that stays under a second. A call that
+   * runs out of memory is synthesized in halves, and the length drops below
+   * it until the next load.
+   */
+  int getChunkFrames() const { return chunkSizer.get(); }
+
+  /**
+   * Send model runs to an inference server first, running them on the
+   * local sessions only when it cannot answer; null runs everything
+   * locally. Safe to call while requests are running.
+   */
+  void setRemoteInference(std::shared_ptr<RemoteInference> remote);
+
 private:
+  /**
+   * One pooled session with its own I/O binding. A slot is used by a single
+   * inference at a time; busy is guarded by poolMutex.
+   */
+  struct SessionSlot {
+#ifdef HAVE_ONNXRUNTIME
+    std::shared_ptr<Ort::Session> session; // From OnnxSessionRegistry
+    std::unique_ptr<OnnxIoBinding> ioBinding;
+    Ort::RunOptions runOptions; // Terminated to abort a superseded request
+#endif
+    int deviceId = 0;
+    bool busy = false;
+  };
+
+  /** Holds a pool slot for the lifetime of the lease. */
+  class SessionLease {
+  public:
+    explicit SessionLease(Vocoder &owner)
+        : vocoder(owner), slot(owner.acquireSession()) {}
+    ~SessionLease() { vocoder.releaseSession(slot); }
+
+    SessionSlot *get() const { return slot; }
+
+  private:
+    Vocoder &vocoder;
+    SessionSlot *slot;
+
+    JUCE_DECLARE_NON_COPYABLE(SessionLease)
+  };
+
   struct AsyncTask {
-    std::vector<std::vector<float>> mel;
+    MelBuffer mel;
     std::vector<float> f0;
     std::function<void(std::vector<float>)> callback;
     std::shared_ptr<std::atomic<bool>> cancelFlag;
+    AsyncOptions options;
+    std::uint64_t sequence = 0;
+  };
+
+  // A request currently running on a pool slot (guarded by asyncMutex)
+  struct InFlightTask {
+    std::uint64_t sequence = 0;
+    AsyncOptions options;
+    SessionSlot *slot = nullptr;
+    bool superseded = false;
   };
 
   bool loaded = false;
+  std::atomic<bool> deterministic{true};
+  std::atomic<std::uint64_t> noiseSeed{0};
+  int noiseInputIndex = -1; // Input taking the source noise; -1 if none
   int sampleRate = 44100;
   int hopSize = 512;
   int numMels = 128;
@@ -114,26 +283,94 @@ private:
 #endif
 
   juce::File modelFile;
-  std::unique_ptr<std::ofstream> logFile;
-  int executionDeviceId = 0;
+  std::vector<int> executionDeviceIds{0}; // Never empty
+  // Distinct GPUs the loaded pool runs on; 1 on CPU
+  std::atomic<int> numPoolDevices{1};
+  // Sessions in the loaded pool
+  std::atomic<int> numPoolSessions{1};
+
+  // Device IDs the next load spreads the pool over
+  std::vector<int> getPoolDeviceIds() const;
 
   // Thread safety for async operations
   std::atomic<bool> isShuttingDown{false};
   std::atomic<int> activeAsyncTasks{0};
   std::mutex asyncMutex;
-  std::condition_variable asyncCondition;
-  std::thread asyncWorker;
   std::deque<AsyncTask> asyncQueue;
+  int numAsyncDrainers = 0; // drainAsyncQueue() jobs, at most one per session
+  JobSystem::Group asyncJobs;
+  std::vector<InFlightTask> inFlightTasks;
+  std::uint64_t nextTaskSequence = 0;
+
+  // Session pool state. loadModel sets poolReloading and waits until no slot
+  // is busy before replacing the sessions.
+  std::mutex poolMutex;
+  std::condition_variable poolCondition;
+  bool poolReloading = false;
+  int sessionPoolSize = 1;
 
-  // Mutex to protect ONNX session access during inference
-  mutable std::mutex inferenceMutex;
+  // Runs one short inference per idle session after each load, then sizes
+  // chunks on GPUs
+  JobSystem::JobHandle warmUpJob;
+  void warmUpSessions();
+  ChunkSizer chunkSizer{{256, 512, 1024, 2048, 4096}, 1024};
+
+  // Run lengths on a GPU, each warmed after a load; CPU runs stay exact
+  const ShapeBuckets frameBuckets{64, 4096};
+  std::atomic<bool> padToBuckets{false};
 
   void log(const std::string &message);
+  void drainAsyncQueue();
+
+  // Drop queued and terminate running requests that `options` supersedes.
+  // Caller must hold asyncMutex. Dropped tasks are appended to `dropped`.
+  void supersedeTasks(const AsyncOptions &options,
+                      std::vector<AsyncTask> &dropped);
+  void terminateSlot(SessionSlot *slot);
+
+  // Block until a session is free. Returns nullptr when no model is loaded.
+  SessionSlot *acquireSession();
+  void releaseSession(SessionSlot *slot);
+  bool anySessionBusy() const; // Caller must hold poolMutex
+
+  // Frees the unused part of each idle CUDA session's arena; idleShrink
+  // calls it once the pool has sat unused (OnnxGpuMemory). Null off CUDA.
+  void shrinkArenas();
+  std::unique_ptr<OnnxGpuMemory::IdleShrink> idleShrink;
+
+  // Synthesize frames [startFrame, startFrame + numFrames) on the given slot.
+  // Falls back to a sine wave when slot is null. A run that cannot allocate
+  // is split in two halves that overlap by splitContextFrames.
+  // Empty when cancelFlag is raised before or during the run.
+  // framePositions, if given, holds the absolute frame of every input frame
+  std::vector<float> inferFrames(SessionSlot *slot, const MelView &mel,
+                                 const std::vector<float> &f0,
+                                 size_t startFrame, size_t numFrames,
+                                 const std::atomic<bool> *cancelFlag = nullptr,
+                                 const int *framePositions = nullptr);
+  // One model run; on a failed allocation, empty with *outOfMemory set
+  // instead of the sine fallback (when outOfMemory is not null)
+  std::vector<float> inferFramesOnce(SessionSlot *slot, const MelView &mel,
+                                     const std::vector<float> &f0,
+                                     size_t startFrame, size_t numFrames,
+                                     const std::atomic<bool> *cancelFlag,
+                                     bool *outOfMemory,
+                                     const int *framePositions = nullptr);
+  static constexpr size_t splitContextFrames = 32;
+
+  // inferFrames() on the remote backend; empty without one or when it
+  // failed, for the caller to run the frames locally
+  std::vector<float> inferRemote(const MelView &mel,
+                                 const std::vector<float> &f0,
+                                 size_t startFrame, size_t numFrames,
+                                 const std::atomic<bool> *cancelFlag);
+  std::shared_ptr<RemoteInference> getRemoteInference() const;
+  mutable std::mutex remoteMutex;
+  std::shared_ptr<RemoteInference> remoteInference;
 
 #ifdef HAVE_ONNXRUNTIME
-  std::unique_ptr<Ort::Env> onnxEnv;
-  std::unique_ptr<Ort::Session> onnxSession;
   std::unique_ptr<Ort::AllocatorWithDefaultOptions> allocator;
+  std::vector<std::unique_ptr<SessionSlot>> sessionPool;
 
   // Input/output names (cached)
   std::vector<const char *> inputNames;
@@ -141,12 +378,15 @@ private:
   std::vector<std::string> inputNameStrings;
   std::vector<std::string> outputNameStrings;
 
-  // Create session options based on current settings
-  Ort::SessionOptions createSessionOptions();
+  // Create session options for one pool slot based on current settings.
+  // deviceTag receives the EP actually configured (keys the graph cache).
+  Ort::SessionOptions createSessionOptions(int slotIndex, int numSessions,
+                                           int deviceId,
+                                           juce::String &deviceTag);
 #endif
 
   /**
    * Generate simple sine wave fallback when ONNX is not available.
    */
-  std::vector<float> generateSineFallback(const std::vector<float> &f0);
+  std::vector<float> generateSineFallback(const float *f0, size_t numFrames);
 };
@@ -0,0 +1,676 @@
+// BatchMain.cpp - Headless batch analysis and render (HachiTuneBatch)
+//
+// Runs the editor's analysis and synthesis pipeline over audio files or saved
+// projects without any window or message loop:
+//
+//   HachiTuneBatch [options] <file.wav|file.htpx>...
+//
+// Several files are processed at once; they share one EditorController, so
+// the models are loaded once and the jobs take turns on each detector. Each
+// file can be rendered in several variants (key, formant shift, formats) from
+// one analysis, the variants running side by side on the vocoder's sessions.
+//
+//   HachiTuneBatch [options] --serve <port>
+//
+// instead answers RemoteInference clients (editors and other batch runs
+// with a remote endpoint set) with this machine's vocoder and RMVPE.
+
+#include "../JuceHeader.h"
+#include "../Audio/EditorController.h"
+#include "../Audio/IO/MidiExporter.h"
+#include "../Audio/IO/StreamingExporter.h"
+#include "../Audio/InferenceBatcher.h"
+#include "../Audio/OnnxGpuMemory.h"
+#include "../Audio/RemoteInference.h"
+#include "../Models/ProjectSerializer.h"
+#include "../Utils/Constants.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// One render of an input; without a key the project's own offset is kept
+struct RenderVariant {
+  std::optional<float> key; // Global pitch offset in semitones
+  float formant = 0.0f;     // Formant shift in semitones
+  juce::StringArray formats; // Empty: --format
+};
+
+struct BatchInput {
+  juce::File file;
+  std::vector<RenderVariant> variants; // All rendered from one analysis
+};
+
+struct BatchOptions {
+  std::vector<BatchInput> inputs;
+  // Every file named on the command line renders each key at each formant
+  std::vector<std::optional<float>> keys{std::nullopt};
+  std::vector<float> formants{0.0f};
+  juce::File outputDir; // Empty: next to each input
+  juce::File modelsDir; // Empty: PlatformPaths::getModelsDirectory()
+  int jobs = 1;
+  PitchDetectorType detector = PitchDetectorType::RMVPE;
+  juce::String device = "CPU";
+  std::vector<int> deviceIds{0}; // Renders are sharded over all of them
+  ModelPrecision precision = ModelPrecision::Balanced;
+  int gpuMemoryMB = 0; // Per session; 0: no cap
+  bool render = true;
+  // Every format at every rate is encoded from the same render
+  juce::StringArray formats{"wav"};
+  std::vector<int> rates; // Empty: each input's own sample rate
+  int bitsPerSample = 16;
+  double skipSilenceSeconds = 0.5; // 0: render every frame
+  bool saveProject = false;
+  bool exportMidi = false;
+  juce::String remote; // Inference server tried before the local models
+  int servePort = 0;   // Non-zero: run as an inference server instead
+  // Loopback unless asked: the server has no authentication
+  juce::String bindAddress = RemoteInferenceServer::loopbackAddress;
+  int idleExitSeconds = 0;   // Non-zero: stop serving once idle this long
+  int batchWindowMs = 4;     // 0: every request served on its own
+};
+
+struct JobTiming {
+  double loadSeconds = 0.0;
+  double analysisSeconds = 0.0;
+  double renderSeconds = 0.0;
+  double totalSeconds = 0.0;
+};
+
+void printUsage() {
+  std::printf(
+      "Usage: HachiTuneBatch [options] <audio or .htpx files...>\n"
+      "       HachiTuneBatch [options] --queue <jobs.txt>\n"
+      "       HachiTuneBatch [options] --serve <port>\n"
+      "\n"
+      "Analyses each file and renders it through the vocoder. Projects\n"
+      "(.htpx) are re-analysed from their audio and rendered with their\n"
+      "saved edits.\n"
+      "\n"
+      "Options:\n"
+      "  --jobs N            Files processed in parallel (default 1)\n"
+      "  --output DIR        Write results to DIR (default: next to input)\n"
+      "  --models DIR        Model directory (default: next to the app)\n"
+      "  --detector NAME     RMVPE or FCPE (default RMVPE)\n"
+      "  --device NAME       CPU, CUDA, DirectML or CoreML (default CPU)\n"
+      "  --device-id LIST    GPU indices; renders are split across\n"
+      "                      them (default 0)\n"
+      "  --precision NAME    Quality, Balanced or Speed (default Balanced)\n"
+      "  --gpu-memory MB     Cap each CUDA session's memory at MB\n"
+      "  --no-render         Analyse only\n"
+      "  --format LIST       Render formats: wav, flac, aiff (default wav)\n"
+      "  --rate LIST         Render sample rates in Hz (default: the input's)\n"
+      "  --bits N            Render bit depth, 16 or 24 (default 16)\n"
+      "  --skip-silence SEC  Copy silences of SEC or longer from the input\n"
+      "                      instead of rendering them; 0 renders all\n"
+      "                      (default 0.5)\n"
+      "  --keys LIST         Render once per global pitch offset, in\n"
+      "                      semitones (default: the project's own)\n"
+      "  --formants LIST     Render once per formant shift, in semitones\n"
+      "                      (default 0)\n"
+      "  --queue FILE        Read render jobs from FILE, one per line:\n"
+      "                      <file> [key=N] [formant=N] [format=LIST]\n"
+      "                      Jobs on the same file share its analysis\n"
+      "  --save-project      Save <name>.htpx for audio inputs\n"
+      "  --midi              Export notes to <name>.mid\n"
+      "  --remote HOST:PORT  Run models on an inference server first,\n"
+      "                      locally when it cannot answer\n"
+      "  --serve PORT        Be an inference server for editors and\n"
+      "                      batch runs; --jobs requests run at once\n"
+      "  --bind ADDRESS      Serve on this interface (default 127.0.0.1,\n"
+      "                      this machine only); 0.0.0.0 serves every\n"
+      "                      interface, to anyone who can reach it\n"
+      "  --idle-exit SEC     Stop serving after SEC without clients\n"
+      "  --batch-window MS   Run requests arriving within MS of each\n"
+      "                      other as one model call; 0 runs each alone\n"
+      "                      (default 4)\n"
+      "  --help              Show this message\n");
+}
+
+// Comma-separated semitone values; false if any is not a number
+bool parseSemitones(const juce::String &list, std::vector<float> &values) {
+  juce::StringArray tokens;
+  tokens.addTokens(list, ",", "");
+  tokens.removeEmptyStrings();
+  values.clear();
+  for (const auto &token : tokens) {
+    if (!token.trim().containsOnly("+-.0123456789"))
+      return false;
+    values.push_back(token.getFloatValue());
+  }
+  return !values.empty();
+}
+
+// Add a variant, merging it into an earlier input on the same file
+void addVariant(BatchOptions &options, const juce::File &file,
+                const RenderVariant &variant) {
+  for (auto &input : options.inputs)
+    if (input.file == file) {
+      input.variants.push_back(variant);
+      return;
+    }
+  options.inputs.push_back({file, {variant}});
+}
+
+bool readQueueFile(const juce::File &queueFile, BatchOptions &options) {
+  if (!queueFile.existsAsFile()) {
+    std::fprintf(stderr, "Cannot read %s\n",
+                 queueFile.getFullPathName().toRawUTF8());
+    return false;
+  }
+  juce::StringArray lines;
+  queueFile.readLines(lines);
+
+  for (int n = 0; n < lines.size(); ++n) {
+    const auto line = lines[n].upToFirstOccurrenceOf("#", false, false).trim();
+    if (line.isEmpty())
+      continue;
+
+    juce::StringArray tokens;
+    tokens.addTokens(line, " \t", "\"");
+    tokens.removeEmptyStrings();
+    RenderVariant variant;
+    bool valid = true;
+    for (int t = 1; t < tokens.size() && valid; ++t) {
+      const auto name = tokens[t].upToFirstOccurrenceOf("=", false, false);
+      const auto value = tokens[t].fromFirstOccurrenceOf("=", false, false);
+      std::vector<float> number;
+      if (name == "key" && parseSemitones(value, number) &&
+          number.size() == 1) {
+        variant.key = number.front();
+      } else if (name == "formant" && parseSemitones(value, number) &&
+                 number.size() == 1) {
+        variant.formant = number.front();
+      } else if (name == "format" && value.isNotEmpty()) {
+        variant.formats.addTokens(value.toLowerCase(), ",", "");
+        variant.formats.removeEmptyStrings();
+      } else {
+        valid = false;
+      }
+    }
+    if (!valid) {
+      std::fprintf(stderr, "%s:%d: cannot parse \"%s\"\n",
+                   queueFile.getFileName().toRawUTF8(), n + 1,
+                   line.toRawUTF8());
+      return false;
+    }
+    addVariant(options,
+               queueFile.getParentDirectory().getChildFile(
+                   tokens[0].unquoted()),
+               variant);
+  }
+  return true;
+}
+
+bool parseArguments(int argc, char *argv[], BatchOptions &options) {
+  std::vector<juce::File> files;
+  juce::File queueFile;
+  for (int i = 1; i < argc; ++i) {
+    const juce::String arg(juce::CharPointer_UTF8(argv[i]));
+    auto nextValue = [&](juce::String &value) {
+      if (i + 1 >= argc) {
+        std::fprintf(stderr, "Missing value for %s\n", arg.toRawUTF8());
+        return false;
+      }
+      value = juce::String(juce::CharPointer_UTF8(argv[++i]));
+      return true;
+    };
+
+    juce::String value;
+    if (arg == "--help" || arg == "-h") {
+      return false;
+    } else if (arg == "--jobs") {
+      if (!nextValue(value))
+        return false;
+      options.jobs = std::clamp(value.getIntValue(), 1, 64);
+    } else if (arg == "--output") {
+      if (!nextValue(value))
+        return false;
+      options.outputDir = juce::File::getCurrentWorkingDirectory()
+                              .getChildFile(value);
+    } else if (arg == "--models") {
+      if (!nextValue(value))
+        return false;
+      options.modelsDir = juce::File::getCurrentWorkingDirectory()
+                              .getChildFile(value);
+    } else if (arg == "--detector") {
+      if (!nextValue(value))
+        return false;
+      options.detector = stringToPitchDetectorType(value.toUpperCase());
+    } else if (arg == "--device") {
+      if (!nextValue(value))
+        return false;
+      options.device = value;
+    } else if (arg == "--device-id") {
+      if (!nextValue(value))
+        return false;
+      juce::StringArray ids;
+      ids.addTokens(value, ",", "");
+      options.deviceIds.clear();
+      for (const auto &id : ids) {
+        const auto trimmed = id.trim();
+        if (trimmed.isNotEmpty() && trimmed.containsOnly("0123456789"))
+          options.deviceIds.push_back(trimmed.getIntValue());
+      }
+      if (options.deviceIds.empty())
+        return false;
+    } else if (arg == "--precision") {
+      if (!nextValue(value))
+        return false;
+      options.precision = stringToModelPrecision(value);
+    } else if (arg == "--gpu-memory") {
+      if (!nextValue(value))
+        return false;
+      options.gpuMemoryMB = std::max(0, value.getIntValue());
+    } else if (arg == "--no-render") {
+      options.render = false;
+    } else if (arg == "--format") {
+      if (!nextValue(value))
+        return false;
+      options.formats.clear();
+      options.formats.addTokens(value.toLowerCase(), ",", "");
+      options.formats.removeEmptyStrings();
+      if (options.formats.isEmpty())
+        return false;
+    } else if (arg == "--rate") {
+      if (!nextValue(value))
+        return false;
+      juce::StringArray rates;
+      rates.addTokens(value, ",", "");
+      options.rates.clear();
+      for (const auto &rate : rates)
+        if (rate.getIntValue() > 0)
+          options.rates.push_back(rate.getIntValue());
+      if (options.rates.empty())
+        return false;
+    } else if (arg == "--bits") {
+      if (!nextValue(value))
+        return false;
+      options.bitsPerSample = value.getIntValue();
+    } else if (arg == "--skip-silence") {
+      if (!nextValue(value))
+        return false;
+      options.skipSilenceSeconds = std::max(0.0, value.getDoubleValue());
+    } else if (arg == "--keys") {
+      std::vector<float> keys;
+      if (!nextValue(value) || !parseSemitones(value, keys))
+        return false;
+      options.keys.assign(keys.begin(), keys.end());
+    } else if (arg == "--formants") {
+      if (!nextValue(value) || !parseSemitones(value, options.formants))
+        return false;
+    } else if (arg == "--queue") {
+      if (!nextValue(value))
+        return false;
+      queueFile = juce::File::getCurrentWorkingDirectory().getChildFile(value);
+    } else if (arg == "--save-project") {
+      options.saveProject = true;
+    } else if (arg == "--midi") {
+      options.exportMidi = true;
+    } else if (arg == "--remote") {
+      if (!nextValue(value))
+        return false;
+      options.remote = value;
+    } else if (arg == "--serve") {
+      if (!nextValue(value) || value.getIntValue() <= 0)
+        return false;
+      options.servePort = value.getIntValue();
+    } else if (arg == "--bind") {
+      if (!nextValue(value) || value.isEmpty())
+        return false;
+      options.bindAddress = value;
+    } else if (arg == "--idle-exit") {
+      if (!nextValue(value))
+        return false;
+      options.idleExitSeconds = std::max(0, value.getIntValue());
+    } else if (arg == "--batch-window") {
+      if (!nextValue(value))
+        return false;
+      options.batchWindowMs = std::clamp(value.getIntValue(), 0, 100);
+    } else if (arg.startsWith("--")) {
+      std::fprintf(stderr, "Unknown option %s\n", arg.toRawUTF8());
+      return false;
+    } else {
+      files.push_back(
+          juce::File::getCurrentWorkingDirectory().getChildFile(arg));
+    }
+  }
+
+  for (const auto &file : files)
+    for (const auto &key : options.keys)
+      for (float formant : options.formants)
+        addVariant(options, file, {key, formant, {}});
+  if (queueFile != juce::File{} && !readQueueFile(queueFile, options))
+    return false;
+  return !options.inputs.empty() || options.servePort > 0;
+}
+
+double secondsSince(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                       start)
+      .count();
+}
+
+// +2, -1.5: how a semitone value appears in an output name
+juce::String semitoneTag(float semitones) {
+  const auto rounded = std::round(semitones * 100.0f) / 100.0f;
+  auto text = rounded == std::round(rounded)
+                  ? juce::String(static_cast<int>(rounded))
+                  : juce::String(rounded, 2).trimCharactersAtEnd("0");
+  return (rounded >= 0.0f ? "+" : "") + text;
+}
+
+// <name>_render[_key<N>][_formant<N>][_<rate>].<format> for each format and
+// rate of a variant; without --rate, at sourceRate only
+std::vector<StreamingExporter::Target>
+makeRenderTargets(const juce::File &outputDir, const juce::String &baseName,
+                  const RenderVariant &variant, const BatchOptions &options,
+                  int sourceRate) {
+  const auto &formats =
+      variant.formats.isEmpty() ? options.formats : variant.formats;
+  const auto rates =
+      options.rates.empty() ? std::vector<int>{sourceRate} : options.rates;
+  std::vector<StreamingExporter::Target> targets;
+  for (const auto &format : formats)
+    for (int rate : rates) {
+      auto name = baseName + "_render";
+      if (variant.key)
+        name << "_key" << semitoneTag(*variant.key);
+      if (variant.formant != 0.0f)
+        name << "_formant" << semitoneTag(variant.formant);
+      if (options.rates.size() > 1 ||
+          (!options.rates.empty() && rate != SAMPLE_RATE))
+        name << "_" << rate;
+      targets.push_back({outputDir.getChildFile(name + "." + format), rate,
+                         options.bitsPerSample});
+    }
+  return targets;
+}
+
+/**
+ * Analyse one input and render its variants, up to variantThreads at once.
+ * Projects are analysed from their audio file (an analysis cache hit when it
+ * was opened before), then their saved notes and curves replace the fresh
+ * results.
+ */
+bool runJob(EditorController &controller, const BatchInput &batchInput,
+            const BatchOptions &options, int variantThreads,
+            JobTiming &timing, juce::String &error) {
+  const auto &input = batchInput.file;
+  const auto jobStart = std::chrono::steady_clock::now();
+  const bool isProject = input.hasFileExtension("htpx");
+
+  auto audioFile = input;
+  if (isProject) {
+    Project saved;
+    if (!ProjectSerializer::loadFromFile(saved, input)) {
+      error = "cannot read project";
+      return false;
+    }
+    audioFile = saved.getFilePath();
+  }
+
+  auto project = std::make_unique<Project>();
+  project->setFilePath(audioFile);
+  auto &audioData = project->getAudioData();
+  if (!EditorController::readAudioFile(audioFile, audioData.waveform,
+                                       nullptr, nullptr, nullptr,
+                                       &audioData.sessionSampleRate)) {
+    error = "cannot read audio " + audioFile.getFullPathName();
+    return false;
+  }
+  audioData.sampleRate = SAMPLE_RATE;
+  timing.loadSeconds = secondsSince(jobStart);
+
+  const auto analysisStart = std::chrono::steady_clock::now();
+  controller.analyzeAudio(*project, [](double, const juce::String &) {});
+  if (audioData.f0.empty() || audioData.melSpectrogram.empty()) {
+    error = "analysis failed";
+    return false;
+  }
+  if (isProject && !ProjectSerializer::loadFromFile(*project, input)) {
+    error = "cannot apply project edits";
+    return false;
+  }
+  timing.analysisSeconds = secondsSince(analysisStart);
+
+  const auto outputDir =
+      options.outputDir != juce::File{} ? options.outputDir
+                                        : input.getParentDirectory();
+  const auto baseName = input.getFileNameWithoutExtension();
+
+  if (options.render) {
+    const auto renderStart = std::chrono::steady_clock::now();
+    std::vector<EditorController::ExportVariant> variants;
+    for (const auto &variant : batchInput.variants)
+      variants.push_back(
+          {variant.key.value_or(project->getGlobalPitchOffset()),
+           variant.formant,
+           makeRenderTargets(outputDir, baseName, variant, options,
+                             audioData.sessionSampleRate)});
+
+    std::mutex errorMutex;
+    const bool written = controller.exportVariants(
+        *project, variants, variantThreads,
+        [&](size_t index, bool ok, const juce::String &message) {
+          std::lock_guard<std::mutex> lock(errorMutex);
+          if (!ok && error.isEmpty())
+            error = "cannot write " +
+                    variants[index].targets.front().file.getFileName() +
+                    ": " + message.replace("\n", " ");
+        });
+    if (!written)
+      return false;
+    timing.renderSeconds = secondsSince(renderStart);
+  }
+
+  if (options.saveProject && !isProject &&
+      !ProjectSerializer::saveToFile(
+          *project, outputDir.getChildFile(baseName + ".htpx"))) {
+    error = "cannot save project";
+    return false;
+  }
+
+  if (options.exportMidi &&
+      !MidiExporter::exportToFile(project->getNotes(),
+                                  outputDir.getChildFile(baseName + ".mid"))) {
+    error = "cannot write MIDI";
+    return false;
+  }
+
+  timing.totalSeconds = secondsSince(jobStart);
+  return true;
+}
+
+// --serve: one vocoder session per request answered at once; runs until
+// the process is stopped, or has had no client for --idle-exit seconds
+int serve(EditorController &controller, const BatchOptions &options) {
+  using RemoteProtocol::Status;
+  auto *vocoder = controller.getVocoder();
+  vocoder->setSessionPoolSize(options.jobs);
+  controller.reloadInferenceModels(false);
+  if (!controller.waitForModel(OnnxThreading::Model::Vocoder)) {
+    std::fprintf(stderr, "Cannot load vocoder %s\n",
+                 controller.getVocoderModelFile().getFullPathName().toRawUTF8());
+    return 1;
+  }
+
+  // Requests from every connection share one batcher, so previews of
+  // several editors and chunks of several batch runs fill the same calls
+  InferenceBatcher::Options batchOptions;
+  batchOptions.windowMs = options.batchWindowMs;
+  InferenceBatcher batcher(*vocoder, batchOptions);
+
+  RemoteInferenceServer::Handlers handlers;
+  handlers.vocode = [vocoder, &batcher](const MelBuffer &mel,
+                                        const std::vector<float> &f0,
+                                        int sampleRate, int hopSize,
+                                        std::vector<float> &audio) {
+    if (sampleRate != vocoder->getSampleRate() ||
+        hopSize != vocoder->getHopSize() ||
+        mel.getNumMels() != vocoder->getNumMels())
+      return Status::Mismatch;
+    audio = batcher.vocode(mel, f0);
+    return audio.size() == mel.size() * static_cast<size_t>(hopSize)
+               ? Status::Ok
+               : Status::Failed;
+  };
+  handlers.pitch = [&controller](const std::vector<float> &audio16k,
+                                 float threshold, std::vector<float> &f0) {
+    f0 = controller.extractPitchForClient(audio16k, threshold);
+    return f0.empty() ? Status::Unsupported : Status::Ok;
+  };
+
+  RemoteInferenceServer server(std::move(handlers), options.jobs);
+  std::atomic<bool> served{false};
+  std::thread idleWatch;
+  if (options.idleExitSeconds > 0)
+    idleWatch = std::thread([&]() {
+      auto idleSince = std::chrono::steady_clock::now();
+      while (!served.load()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(500));
+        if (server.getNumConnections() > 0)
+          idleSince = std::chrono::steady_clock::now();
+        else if (secondsSince(idleSince) >= options.idleExitSeconds) {
+          std::printf("No clients for %ds, stopping\n",
+                      options.idleExitSeconds);
+          server.stop();
+          return;
+        }
+      }
+    });
+
+  std::printf("Serving on port %d (%s, %d session(s))\n", options.servePort,
+              options.device.toRawUTF8(), vocoder->getSessionPoolSize());
+  std::fflush(stdout);
+  const bool listening = server.run(options.servePort, options.bindAddress);
+  served.store(true);
+  if (idleWatch.joinable())
+    idleWatch.join();
+  if (!listening) {
+    std::fprintf(stderr, "Cannot listen on port %d\n", options.servePort);
+    return 1;
+  }
+  if (batcher.getNumBatches() > 0)
+    std::printf("%zu requests batched into %zu calls\n",
+                batcher.getNumBatchedRequests(), batcher.getNumBatches());
+  return 0;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  BatchOptions options;
+  if (!parseArguments(argc, argv, options)) {
+    printUsage();
+    return 2;
+  }
+
+  // Message manager and format registries without creating any window
+  juce::ScopedJuceInitialiser_GUI juceInit;
+
+  if (options.outputDir != juce::File{} &&
+      !options.outputDir.createDirectory()) {
+    std::fprintf(stderr, "Cannot create %s\n",
+                 options.outputDir.getFullPathName().toRawUTF8());
+    return 1;
+  }
+
+  // Before any model loads; a render node may share its GPUs
+  auto gpuMemory = OnnxGpuMemory::getSettings();
+  gpuMemory.limitMB = options.gpuMemoryMB;
+  OnnxGpuMemory::setSettings(gpuMemory);
+
+  EditorController controller(false);
+  if (options.modelsDir != juce::File{})
+    controller.setModelsDirectory(options.modelsDir);
+  controller.setPitchDetectorType(options.detector);
+  controller.setDeviceConfig(options.device, options.deviceIds.front());
+  controller.setVocoderDeviceIds(options.deviceIds);
+  controller.setModelPrecision(options.precision);
+  // Batch jobs never edit, so no preview vocoder
+  controller.setPreviewTier(false);
+  SilenceSkipping::Options skipping;
+  skipping.enabled = options.skipSilenceSeconds > 0.0;
+  skipping.minSilenceSeconds = options.skipSilenceSeconds;
+  controller.setSilenceSkipping(skipping);
+  if (options.servePort > 0)
+    return serve(controller, options);
+  controller.setRemoteInference(options.remote);
+
+  const int numJobs =
+      std::min(options.jobs, static_cast<int>(options.inputs.size()));
+  const auto setupStart = std::chrono::steady_clock::now();
+
+  // One vocoder session per render in flight, as far as the pool goes; each
+  // job renders its variants on its share of the sessions
+  size_t maxVariants = 1;
+  for (const auto &input : options.inputs)
+    maxVariants = std::max(maxVariants, input.variants.size());
+  controller.getVocoder()->setSessionPoolSize(
+      numJobs * static_cast<int>(std::min<size_t>(maxVariants, 8)));
+  const int variantThreads = std::max(
+      1, controller.getVocoder()->getSessionPoolSize() / numJobs);
+  controller.reloadInferenceModels(false);
+  if (!controller.waitForModel(OnnxThreading::Model::Vocoder)) {
+    std::fprintf(stderr, "Cannot load vocoder %s\n",
+                 controller.getVocoderModelFile().getFullPathName().toRawUTF8());
+    return 1;
+  }
+
+  std::printf("Models ready in %.2fs (%s, %s, %s), %d job(s)\n",
+              secondsSince(setupStart),
+              pitchDetectorTypeToString(options.detector),
+              options.device.toRawUTF8(),
+              modelPrecisionToString(options.precision), numJobs);
+
+  std::mutex printMutex;
+  std::atomic<size_t> nextInput{0};
+  std::atomic<int> numFailed{0};
+  const auto batchStart = std::chrono::steady_clock::now();
+
+  auto worker = [&]() {
+    for (size_t index = nextInput++; index < options.inputs.size();
+         index = nextInput++) {
+      const auto &batchInput = options.inputs[index];
+      const auto &input = batchInput.file;
+      JobTiming timing;
+      juce::String error;
+      const bool ok =
+          runJob(controller, batchInput, options, variantThreads, timing, error);
+
+      std::lock_guard<std::mutex> lock(printMutex);
+      if (ok) {
+        std::printf("%s: load %.2fs, analysis %.2fs, render %.2fs "
+                    "(%d variant(s)), total %.2fs\n",
+                    input.getFileName().toRawUTF8(), timing.loadSeconds,
+                    timing.analysisSeconds, timing.renderSeconds,
+                    static_cast<int>(batchInput.variants.size()),
+                    timing.totalSeconds);
+      } else {
+        ++numFailed;
+        std::fprintf(stderr, "%s: %s\n", input.getFileName().toRawUTF8(),
+                     error.toRawUTF8());
+      }
+      std::fflush(stdout);
+    }
+  };
+
+  std::vector<std::thread> workers;
+  for (int i = 1; i < numJobs; ++i)
+    workers.emplace_back(worker);
+  worker();
+  for (auto &thread : workers)
+    thread.join();
+
+  const int total = static_cast<int>(options.inputs.size());
+  std::printf("%d of %d file(s) done in %.2fs\n", total - numFailed.load(),
+              total, secondsSince(batchStart));
+  return numFailed.load() == 0 ? 0 : 1;
+}
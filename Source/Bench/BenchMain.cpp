@@ -0,0 +1,1144 @@
+// BenchMain.cpp - Micro and macro benchmarks (hachitune_bench)
+//
+// Times the analysis and synthesis building blocks on their own and the
+// whole pipeline end to end, and writes the results as JSON so they can be
+// compared between releases:
+//
+//   hachitune_bench [options]
+//
+// Micro cases need no models. Macro cases load the models next to the app
+// (or from --models) and are skipped when they are missing.
+//
+// With --synthetic S it runs the serializer, curve, undo and synthesis
+// cases on a generated project of S seconds instead (see SyntheticProject),
+// and --write-project saves that project for opening in the app.
+//
+// With --golden DIR it instead checks the pipeline against outputs recorded
+// earlier by --update-golden: mel, the edited pitch curve, analysis F0 and
+// notes, and rendered audio must match within tolerance, and each stage
+// must finish within its time budget. The exit code is 1 on any failure, so
+// CI can run it after a build.
+
+#include "../JuceHeader.h"
+#include "../Audio/EditorController.h"
+#include "../Models/ProjectSerializer.h"
+#include "../Utils/BasePitchCurve.h"
+#include "../Utils/CenteredMelSpectrogram.h"
+#include "../Utils/Constants.h"
+#include "../Utils/CurveResampler.h"
+#include "../Utils/F0Smoother.h"
+#include "../Utils/MelSpectrogram.h"
+#include "../Utils/PitchCurveProcessor.h"
+#include "SyntheticProject.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace {
+
+struct BenchOptions {
+  juce::String filter; // Substring of the case names to run; empty: all
+  double minSeconds = 1.0;
+  int minIterations = 5;
+  juce::File audioFile; // Empty: the built-in reference phrase
+  double referenceSeconds = 20.0;
+  juce::File modelsDir;
+  juce::String device = "CPU";
+  bool runMacro = true;
+  juce::File jsonFile;
+  juce::File goldenDir;   // Non-empty: golden check instead of benchmarks
+  bool updateGolden = false;
+  juce::File budgetsFile; // Empty: budgets.json in goldenDir
+  bool runSynthetic = false; // Cases on a generated project instead
+  SyntheticProject::Options synthetic;
+  juce::File projectFile; // Non-empty: save the generated project there
+};
+
+struct BenchResult {
+  juce::String name;
+  int iterations = 0;
+  double meanMs = 0.0;
+  double medianMs = 0.0;
+  double minMs = 0.0;
+  double stddevMs = 0.0;
+};
+
+void printUsage() {
+  std::printf(
+      "Usage: hachitune_bench [options]\n"
+      "\n"
+      "Runs each case until it has taken --min-time seconds and at least\n"
+      "--min-iterations iterations, then prints mean, median, minimum and\n"
+      "standard deviation per iteration.\n"
+      "\n"
+      "Options:\n"
+      "  --filter TEXT       Only cases whose name contains TEXT\n"
+      "  --min-time S        Seconds per case (default 1)\n"
+      "  --min-iterations N  Iterations per case (default 5)\n"
+      "  --audio FILE        Reference audio (default: a synthetic sung\n"
+      "                      phrase, identical on every run)\n"
+      "  --seconds S         Length of the synthetic phrase (default 20)\n"
+      "  --models DIR        Model directory (default: next to the app)\n"
+      "  --device NAME       Device for the macro cases (default CPU)\n"
+      "  --micro-only        Skip the cases that need models\n"
+      "  --json FILE         Also write the results to FILE\n"
+      "  --golden DIR        Check outputs and timings against DIR instead;\n"
+      "                      --micro-only skips the stages needing models\n"
+      "  --update-golden     Record outputs (and missing budgets) to DIR\n"
+      "  --budgets FILE      Stage time budgets in ms (default\n"
+      "                      DIR/budgets.json)\n"
+      "  --synthetic S       Run the scale cases on a generated project of\n"
+      "                      S seconds instead\n"
+      "  --notes-per-second N  Note density of it (default 2)\n"
+      "  --edits N           Undo steps recorded in it (default 1000)\n"
+      "  --stretched SHARE   Share of notes stretched (default 0.1)\n"
+      "  --vibrato SHARE     Share of notes with vibrato (default 0.25)\n"
+      "  --write-project FILE  Also save it, mel included, to FILE\n"
+      "  --help              Show this message\n");
+}
+
+bool parseArguments(int argc, char *argv[], BenchOptions &options) {
+  for (int i = 1; i < argc; ++i) {
+    const juce::String arg(juce::CharPointer_UTF8(argv[i]));
+    auto nextValue = [&](juce::String &value) {
+      if (i + 1 >= argc) {
+        std::fprintf(stderr, "Missing value for %s\n", arg.toRawUTF8());
+        return false;
+      }
+      value = juce::String(juce::CharPointer_UTF8(argv[++i]));
+      return true;
+    };
+    auto fileFrom = [](const juce::String &path) {
+      return juce::File::getCurrentWorkingDirectory().getChildFile(path);
+    };
+
+    juce::String value;
+    if (arg == "--help" || arg == "-h") {
+      return false;
+    } else if (arg == "--filter") {
+      if (!nextValue(value))
+        return false;
+      options.filter = value;
+    } else if (arg == "--min-time") {
+      if (!nextValue(value))
+        return false;
+      options.minSeconds = std::max(0.0, value.getDoubleValue());
+    } else if (arg == "--min-iterations") {
+      if (!nextValue(value))
+        return false;
+      options.minIterations = std::max(1, value.getIntValue());
+    } else if (arg == "--audio") {
+      if (!nextValue(value))
+        return false;
+      options.audioFile = fileFrom(value);
+    } else if (arg == "--seconds") {
+      if (!nextValue(value))
+        return false;
+      options.referenceSeconds = std::clamp(value.getDoubleValue(), 1.0, 600.0);
+    } else if (arg == "--models") {
+      if (!nextValue(value))
+        return false;
+      options.modelsDir = fileFrom(value);
+    } else if (arg == "--device") {
+      if (!nextValue(value))
+        return false;
+      options.device = value;
+    } else if (arg == "--micro-only") {
+      options.runMacro = false;
+    } else if (arg == "--json") {
+      if (!nextValue(value))
+        return false;
+      options.jsonFile = fileFrom(value);
+    } else if (arg == "--golden") {
+      if (!nextValue(value))
+        return false;
+      options.goldenDir = fileFrom(value);
+    } else if (arg == "--update-golden") {
+      options.updateGolden = true;
+    } else if (arg == "--budgets") {
+      if (!nextValue(value))
+        return false;
+      options.budgetsFile = fileFrom(value);
+    } else if (arg == "--synthetic") {
+      if (!nextValue(value))
+        return false;
+      options.runSynthetic = true;
+      options.synthetic.seconds =
+          std::clamp(value.getDoubleValue(), 1.0, 36000.0);
+    } else if (arg == "--notes-per-second") {
+      if (!nextValue(value))
+        return false;
+      options.synthetic.notesPerSecond =
+          std::clamp(value.getDoubleValue(), 0.1, 10.0);
+    } else if (arg == "--edits") {
+      if (!nextValue(value))
+        return false;
+      options.synthetic.numEdits = std::max(0, value.getIntValue());
+    } else if (arg == "--stretched") {
+      if (!nextValue(value))
+        return false;
+      options.synthetic.stretchedShare =
+          std::clamp(value.getDoubleValue(), 0.0, 1.0);
+    } else if (arg == "--vibrato") {
+      if (!nextValue(value))
+        return false;
+      options.synthetic.vibratoShare =
+          std::clamp(value.getDoubleValue(), 0.0, 1.0);
+    } else if (arg == "--write-project") {
+      if (!nextValue(value))
+        return false;
+      options.projectFile = fileFrom(value);
+    } else {
+      std::fprintf(stderr, "Unknown option %s\n", arg.toRawUTF8());
+      return false;
+    }
+  }
+  if (options.updateGolden && options.goldenDir == juce::File{}) {
+    std::fprintf(stderr, "--update-golden needs --golden DIR\n");
+    return false;
+  }
+  if (options.projectFile != juce::File{} && !options.runSynthetic) {
+    std::fprintf(stderr, "--write-project needs --synthetic S\n");
+    return false;
+  }
+  return true;
+}
+
+/**
+ * Times one case: setup (untimed) runs before every iteration, so a case
+ * can restore the state its body consumes.
+ */
+class Runner {
+public:
+  explicit Runner(const BenchOptions &optionsIn) : options(optionsIn) {}
+
+  void run(const juce::String &name, const std::function<void()> &body,
+           const std::function<void()> &setup = nullptr) {
+    if (options.filter.isNotEmpty() && !name.contains(options.filter))
+      return;
+
+    std::vector<double> samples;
+    double totalSeconds = 0.0;
+    while (totalSeconds < options.minSeconds ||
+           static_cast<int>(samples.size()) < options.minIterations) {
+      if (setup)
+        setup();
+      const auto start = std::chrono::steady_clock::now();
+      body();
+      const double seconds = std::chrono::duration<double>(
+                                 std::chrono::steady_clock::now() - start)
+                                 .count();
+      samples.push_back(seconds * 1000.0);
+      totalSeconds += seconds;
+    }
+
+    BenchResult result;
+    result.name = name;
+    result.iterations = static_cast<int>(samples.size());
+    double sum = 0.0;
+    for (double ms : samples)
+      sum += ms;
+    result.meanMs = sum / samples.size();
+    double squares = 0.0;
+    for (double ms : samples)
+      squares += (ms - result.meanMs) * (ms - result.meanMs);
+    result.stddevMs =
+        samples.size() > 1 ? std::sqrt(squares / (samples.size() - 1)) : 0.0;
+    std::sort(samples.begin(), samples.end());
+    result.minMs = samples.front();
+    const size_t middle = samples.size() / 2;
+    result.medianMs = samples.size() % 2 == 1
+                          ? samples[middle]
+                          : 0.5 * (samples[middle - 1] + samples[middle]);
+
+    std::printf("%-44s %6d %11.3f %11.3f %11.3f %9.3f\n",
+                result.name.toRawUTF8(), result.iterations, result.meanMs,
+                result.medianMs, result.minMs, result.stddevMs);
+    std::fflush(stdout);
+    results.push_back(result);
+  }
+
+  const BenchResult &getLastResult() const { return results.back(); }
+
+  static void printHeader() {
+    std::printf("%-44s %6s %11s %11s %11s %9s\n", "Case", "Iters", "Mean ms",
+                "Median ms", "Min ms", "Stddev");
+  }
+
+  // Laid out like Google Benchmark's JSON; real_time is the mean
+  bool writeJson(const juce::File &file, const juce::String &reference) const {
+    auto *context = new juce::DynamicObject();
+    context->setProperty("date", juce::Time::getCurrentTime().toISO8601(true));
+    context->setProperty("executable",
+                         juce::File::getSpecialLocation(
+                             juce::File::currentExecutableFile)
+                             .getFileName());
+    context->setProperty("version", JUCE_APPLICATION_VERSION_STRING);
+    context->setProperty("num_cpus", juce::SystemStats::getNumCpus());
+    context->setProperty("cpu", juce::SystemStats::getCpuModel());
+    context->setProperty("os", juce::SystemStats::getOperatingSystemName());
+#if JUCE_DEBUG
+    context->setProperty("library_build_type", "debug");
+#else
+    context->setProperty("library_build_type", "release");
+#endif
+    context->setProperty("reference_audio", reference);
+
+    juce::Array<juce::var> benchmarks;
+    for (const auto &result : results) {
+      auto *entry = new juce::DynamicObject();
+      entry->setProperty("name", result.name);
+      entry->setProperty("run_type", "iteration");
+      entry->setProperty("iterations", result.iterations);
+      entry->setProperty("real_time", result.meanMs);
+      entry->setProperty("median_time", result.medianMs);
+      entry->setProperty("min_time", result.minMs);
+      entry->setProperty("stddev_time", result.stddevMs);
+      entry->setProperty("time_unit", "ms");
+      benchmarks.add(juce::var(entry));
+    }
+
+    auto *root = new juce::DynamicObject();
+    root->setProperty("context", juce::var(context));
+    root->setProperty("benchmarks", benchmarks);
+    return file.replaceWithText(juce::JSON::toString(juce::var(root)));
+  }
+
+private:
+  const BenchOptions &options;
+  std::vector<BenchResult> results;
+};
+
+/**
+ * Sung phrase with known pitch: a scale up and down with vibrato, harmonics
+ * falling off by 1/k, and a rest after every eight notes. Deterministic, so
+ * results compare between machines and releases.
+ */
+struct ReferencePhrase {
+  juce::AudioBuffer<float> audio;
+  std::vector<float> f0; // Hz per frame, 0 in the rests
+  std::vector<BasePitchCurve::NoteSegment> notes;
+};
+
+ReferencePhrase makeReferencePhrase(double seconds) {
+  static constexpr float scale[] = {60, 62, 64, 65, 67, 65, 64, 62};
+  constexpr double noteSeconds = 0.45;
+  constexpr double restSeconds = 0.3;
+  constexpr double framesPerSecond =
+      static_cast<double>(SAMPLE_RATE) / HOP_SIZE;
+
+  ReferencePhrase phrase;
+  const int numSamples = static_cast<int>(seconds * SAMPLE_RATE);
+  const int numFrames = numSamples / HOP_SIZE + 1;
+  phrase.f0.assign(static_cast<size_t>(numFrames), 0.0f);
+  for (double t = 0.0;;) {
+    for (float midi : scale) {
+      const int start = static_cast<int>(t * framesPerSecond);
+      const int end = static_cast<int>((t + noteSeconds) * framesPerSecond);
+      if (end > numFrames)
+        break;
+      phrase.notes.push_back({start, end, midi});
+      t += noteSeconds;
+    }
+    t += restSeconds;
+    if (t * framesPerSecond >= numFrames)
+      break;
+  }
+
+  for (const auto &note : phrase.notes)
+    for (int frame = note.startFrame; frame < note.endFrame; ++frame) {
+      const double time = frame / framesPerSecond;
+      const float vibrato = 0.3f * static_cast<float>(std::sin(
+                                       juce::MathConstants<double>::twoPi *
+                                       5.5 * time));
+      phrase.f0[static_cast<size_t>(frame)] =
+          midiToFreq(note.midiNote + vibrato);
+    }
+
+  phrase.audio.setSize(1, numSamples);
+  float *out = phrase.audio.getWritePointer(0);
+  juce::Random noise(0x48616368);
+  double phase = 0.0;
+  for (int i = 0; i < numSamples; ++i) {
+    const float hz = phrase.f0[static_cast<size_t>(i / HOP_SIZE)];
+    float sample = 0.002f * (noise.nextFloat() * 2.0f - 1.0f);
+    if (hz > 0.0f) {
+      phase += juce::MathConstants<double>::twoPi * hz / SAMPLE_RATE;
+      for (int k = 1; k * hz < 0.45f * SAMPLE_RATE && k <= 24; ++k)
+        sample += 0.25f / k * static_cast<float>(std::sin(k * phase));
+    }
+    out[i] = sample;
+  }
+  return phrase;
+}
+
+bool loadReferenceAudio(const BenchOptions &options, ReferencePhrase &phrase) {
+  if (options.audioFile == juce::File{}) {
+    phrase = makeReferencePhrase(options.referenceSeconds);
+    return true;
+  }
+  if (!EditorController::readAudioFile(options.audioFile, phrase.audio,
+                                       nullptr))
+    return false;
+
+  // No known pitch for a file; micro cases use a flat A3 over it
+  const int numFrames = phrase.audio.getNumSamples() / HOP_SIZE + 1;
+  phrase.f0.assign(static_cast<size_t>(numFrames), midiToFreq(57.0f));
+  phrase.notes.clear();
+  for (int start = 0; start + 40 <= numFrames; start += 40)
+    phrase.notes.push_back({start, start + 40, 57.0f});
+  return true;
+}
+
+// Project with the phrase's audio, mel, pitch and notes; no models needed
+std::unique_ptr<Project> makeProject(const ReferencePhrase &phrase) {
+  auto project = std::make_unique<Project>();
+  auto &audioData = project->getAudioData();
+  audioData.waveform = phrase.audio;
+  audioData.sampleRate = SAMPLE_RATE;
+  MelSpectrogram melComputer(SAMPLE_RATE, N_FFT, HOP_SIZE, NUM_MELS, FMIN,
+                             FMAX);
+  audioData.melSpectrogram = melComputer.compute(
+      phrase.audio.getReadPointer(0), phrase.audio.getNumSamples());
+
+  const size_t numFrames = audioData.melSpectrogram.size();
+  audioData.f0 = phrase.f0;
+  audioData.f0.resize(numFrames, 0.0f);
+  audioData.voicedMask.resize(numFrames);
+  for (size_t i = 0; i < numFrames; ++i)
+    audioData.voicedMask[i] = audioData.f0[i] > 0.0f;
+  for (const auto &segment : phrase.notes)
+    project->addNote(Note(segment.startFrame, segment.endFrame,
+                          segment.midiNote));
+  PitchCurveProcessor::rebuildCurvesFromSource(*project, audioData.f0);
+  return project;
+}
+
+void runMicroCases(Runner &runner, const ReferencePhrase &phrase) {
+  const float *samples = phrase.audio.getReadPointer(0);
+  const int numSamples = phrase.audio.getNumSamples();
+  const auto project = makeProject(phrase);
+  const auto &audioData = project->getAudioData();
+  const int numFrames = audioData.getNumFrames();
+
+  MelSpectrogram melComputer(SAMPLE_RATE, N_FFT, HOP_SIZE, NUM_MELS, FMIN,
+                             FMAX);
+  runner.run("MelSpectrogram/compute", [&]() {
+    juce::ignoreUnused(melComputer.compute(samples, numSamples));
+  });
+
+  // A two-second note stretched by 1.5, as a note resize does
+  CenteredMelSpectrogram centeredMel(SAMPLE_RATE, N_FFT, WIN_SIZE, NUM_MELS,
+                                     FMIN, FMAX);
+  const int stretchFrames = std::min(numFrames, 2 * SAMPLE_RATE / HOP_SIZE);
+  std::vector<double> centers(static_cast<size_t>(stretchFrames * 3 / 2));
+  for (size_t i = 0; i < centers.size(); ++i)
+    centers[i] = static_cast<double>(i) * HOP_SIZE / 1.5;
+  runner.run("CenteredMelSpectrogram/computeAtCenters", [&]() {
+    juce::ignoreUnused(
+        centeredMel.computeAtCenters(samples, numSamples, centers));
+  });
+
+  runner.run("F0Smoother/smoothF0", [&]() {
+    juce::ignoreUnused(
+        F0Smoother::smoothF0(audioData.f0, audioData.voicedMask));
+  });
+
+  runner.run("BasePitchCurve/generateForNotes", [&]() {
+    juce::ignoreUnused(
+        BasePitchCurve::generateForNotes(phrase.notes, numFrames));
+  });
+
+  runner.run("CurveResampler/resampleLinear", [&]() {
+    juce::ignoreUnused(
+        CurveResampler::resampleLinear(audioData.f0, numFrames * 3 / 2));
+  });
+  runner.run("CurveResampler/resampleLinear2D", [&]() {
+    juce::ignoreUnused(CurveResampler::resampleLinear2D(
+        audioData.melSpectrogram, numFrames * 3 / 2));
+  });
+
+  runner.run("ProjectSerializer/binaryRoundTrip", [&]() {
+    ProjectSerializer::ChunkCache cache;
+    const auto data = ProjectSerializer::saveToMemory(*project, cache);
+    Project loaded;
+    ProjectSerializer::loadFromMemory(loaded, data.getData(), data.getSize());
+  });
+  runner.run("ProjectSerializer/jsonRoundTrip", [&]() {
+    const auto text =
+        juce::JSON::toString(ProjectSerializer::toJson(*project));
+    Project loaded;
+    ProjectSerializer::fromJson(loaded, juce::JSON::parse(text));
+  });
+}
+
+// Runs the message loop until done is set; synthesis completes through it
+void waitOnMessageLoop(const bool &done) {
+  while (!done)
+    juce::MessageManager::getInstance()->runDispatchLoopUntil(1);
+}
+
+// False when the vocoder or RMVPE is missing
+bool loadModels(EditorController &controller, const BenchOptions &options) {
+  if (options.modelsDir != juce::File{})
+    controller.setModelsDirectory(options.modelsDir);
+  controller.setDeviceConfig(options.device, 0);
+  // Waits for the vocoder and the selected detector (RMVPE)
+  controller.reloadInferenceModels(false);
+  return controller.isModelReady(OnnxThreading::Model::Vocoder) &&
+         controller.isModelReady(OnnxThreading::Model::RMVPE);
+}
+
+// One note in the middle up a semitone and back, every time synthesized
+// afresh
+void runIncrementalOneNote(Runner &runner, EditorController &controller,
+                           Project &project, const juce::String &name) {
+  auto *synth = controller.getIncrementalSynth();
+  synth->setProject(&project);
+  synth->setVocoder(controller.getVocoder());
+  auto &note = project.getNotes()[project.getNotes().size() / 2];
+  const float originalMidi = note.getMidiNote();
+  bool raised = false;
+  runner.run(
+      name,
+      [&]() {
+        bool done = false;
+        synth->synthesizeRegion(nullptr, [&done](bool) { done = true; });
+        waitOnMessageLoop(done);
+      },
+      [&]() {
+        raised = !raised;
+        note.setMidiNote(originalMidi + (raised ? 1.0f : 0.0f));
+        note.markDirty();
+        PitchCurveProcessor::rebuildBaseInRange(project, note.getStartFrame(),
+                                                note.getEndFrame());
+        synth->getSynthesisCache().clear();
+      });
+}
+
+void runMacroCases(Runner &runner, const BenchOptions &options,
+                   const ReferencePhrase &phrase) {
+  EditorController controller(false);
+  if (!loadModels(controller, options)) {
+    std::printf("Models not found; macro cases skipped\n");
+    return;
+  }
+
+  // The analyser itself, so the analysis cache never answers for it
+  std::unique_ptr<Project> project;
+  auto freshProject = [&]() {
+    project = std::make_unique<Project>();
+    project->getAudioData().waveform = phrase.audio;
+    project->getAudioData().sampleRate = SAMPLE_RATE;
+  };
+  runner.run(
+      "Macro/fullAnalysis",
+      [&]() {
+        controller.getAudioAnalyzer()->analyze(*project, nullptr, nullptr);
+      },
+      freshProject);
+
+  freshProject();
+  controller.getAudioAnalyzer()->analyze(*project, nullptr, nullptr);
+  auto &notes = project->getNotes();
+  if (project->getAudioData().f0.empty() || notes.empty()) {
+    std::printf("Analysis found no notes; synthesis cases skipped\n");
+    return;
+  }
+
+  runIncrementalOneNote(runner, controller, *project,
+                        "Macro/incrementalOneNote");
+
+  runner.run("Macro/fullRender", [&]() {
+    juce::AudioBuffer<float> rendered;
+    controller.renderProcessedAudio(*project, rendered);
+  });
+}
+
+//==============================================================================
+// Scale cases on a generated project
+
+int runSyntheticCases(const BenchOptions &options) {
+  const auto description = SyntheticProject::describe(options.synthetic);
+  std::printf("Synthetic project: %s\n", description.toRawUTF8());
+  const auto start = std::chrono::steady_clock::now();
+  auto generated = SyntheticProject::generate(options.synthetic);
+  auto &project = *generated.project;
+  auto &history = *generated.history;
+  std::printf("Generated in %.1fs: %d notes, %d frames\n",
+              std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                            start)
+                  .count(),
+              static_cast<int>(project.getNotes().size()),
+              project.getAudioData().getNumFrames());
+
+  if (options.projectFile != juce::File{}) {
+    if (!ProjectSerializer::saveToFile(project, options.projectFile, true)) {
+      std::fprintf(stderr, "Cannot write %s\n",
+                   options.projectFile.getFullPathName().toRawUTF8());
+      return 1;
+    }
+    std::printf("Project written to %s\n",
+                options.projectFile.getFullPathName().toRawUTF8());
+  }
+
+  Runner runner(options);
+  Runner::printHeader();
+
+  runner.run("Synthetic/ProjectSerializer/binaryRoundTrip", [&]() {
+    ProjectSerializer::ChunkCache cache;
+    const auto data = ProjectSerializer::saveToMemory(project, cache);
+    Project loaded;
+    ProjectSerializer::loadFromMemory(loaded, data.getData(), data.getSize());
+  });
+  // Saved again unchanged: only what changed is re-encoded
+  ProjectSerializer::ChunkCache savedCache;
+  juce::ignoreUnused(ProjectSerializer::saveToMemory(project, savedCache));
+  runner.run("Synthetic/ProjectSerializer/binaryResave", [&]() {
+    juce::ignoreUnused(ProjectSerializer::saveToMemory(project, savedCache));
+  });
+  runner.run("Synthetic/ProjectSerializer/jsonRoundTrip", [&]() {
+    const auto text = juce::JSON::toString(ProjectSerializer::toJson(project));
+    Project loaded;
+    ProjectSerializer::fromJson(loaded, juce::JSON::parse(text));
+  });
+
+  runner.run("Synthetic/PitchCurveProcessor/rebuildBaseFromNotes", [&]() {
+    PitchCurveProcessor::rebuildBaseFromNotes(project);
+  });
+  const auto &middleNote = project.getNotes()[project.getNotes().size() / 2];
+  runner.run("Synthetic/PitchCurveProcessor/rebuildBaseInRange", [&]() {
+    juce::ignoreUnused(PitchCurveProcessor::rebuildBaseInRange(
+        project, middleNote.getStartFrame(), middleNote.getEndFrame()));
+  });
+  runner.run("Synthetic/Project/getAdjustedF0", [&]() {
+    juce::ignoreUnused(project.getAdjustedF0());
+  });
+
+  runner.run("Synthetic/PitchUndoManager/undoRedoAll", [&]() {
+    while (history.canUndo())
+      history.undo();
+    while (history.canRedo())
+      history.redo();
+  });
+
+  if (options.runMacro) {
+    EditorController controller(false);
+    if (loadModels(controller, options))
+      runIncrementalOneNote(runner, controller, project,
+                            "Synthetic/Macro/incrementalOneNote");
+    else
+      std::printf("Models not found; macro cases skipped\n");
+  }
+
+  if (options.jsonFile != juce::File{} &&
+      !runner.writeJson(options.jsonFile,
+                        "synthetic project: " + description)) {
+    std::fprintf(stderr, "Cannot write %s\n",
+                 options.jsonFile.getFullPathName().toRawUTF8());
+    return 1;
+  }
+  return 0;
+}
+
+//==============================================================================
+// Golden-output check
+
+/**
+ * Accuracy limits for --golden. The DSP stages are deterministic and must
+ * match almost exactly; model outputs drift a little between ONNX Runtime
+ * builds and CPUs, so they are held to what a listener would notice.
+ */
+namespace tolerance {
+constexpr float melMaxAbs = 1.0e-3f;      // Log-mel, worst bin
+constexpr float curveMaxCents = 0.1f;     // Edited F0, worst frame
+constexpr double voicingAgreement = 0.97; // Share of frames voiced alike
+constexpr double f0MeanCents = 10.0;      // Frames voiced in both
+constexpr double notesMatched = 0.95;     // Share of golden notes found again
+constexpr float noteSemitones = 0.5f;
+constexpr double renderMelMeanAbs = 0.1; // Log-mel of the rendered audio
+constexpr double renderLevelDb = 0.5;
+} // namespace tolerance
+
+constexpr int goldenVersion = 1;
+
+bool writeFloats(const juce::File &file, const float *data, size_t count) {
+  file.deleteFile();
+  juce::FileOutputStream out(file);
+  if (!out.openedOk())
+    return false;
+  out.writeInt64(static_cast<juce::int64>(count));
+  for (size_t i = 0; i < count; ++i)
+    out.writeFloat(data[i]);
+  out.flush();
+  return !out.getStatus().failed();
+}
+
+bool readFloats(const juce::File &file, std::vector<float> &values) {
+  juce::FileInputStream in(file);
+  if (!in.openedOk())
+    return false;
+  const auto count = in.readInt64();
+  if (count < 0 || count * 4 != in.getNumBytesRemaining())
+    return false;
+  values.resize(static_cast<size_t>(count));
+  for (auto &value : values)
+    value = in.readFloat();
+  return true;
+}
+
+bool writeWav(const juce::File &file, const juce::AudioBuffer<float> &buffer) {
+  juce::WavAudioFormat wavFormat;
+  auto writerOptions = juce::AudioFormatWriterOptions{}
+                           .withSampleRate(SAMPLE_RATE)
+                           .withNumChannels(buffer.getNumChannels())
+                           .withBitsPerSample(24);
+  file.deleteFile();
+  auto fileStream = std::make_unique<juce::FileOutputStream>(file);
+  if (!fileStream->openedOk())
+    return false;
+  std::unique_ptr<juce::OutputStream> outputStream = std::move(fileStream);
+  std::unique_ptr<juce::AudioFormatWriter> writer(
+      wavFormat.createWriterFor(outputStream, writerOptions));
+  return writer != nullptr &&
+         writer->writeFromAudioSampleBuffer(buffer, 0, buffer.getNumSamples());
+}
+
+float centsBetween(float hzA, float hzB) {
+  return 1200.0f * std::abs(std::log2(hzA / hzB));
+}
+
+// A fixed edit for the curve and render stages: one note up a semitone and
+// vibrato on another, so the edit paths are covered as well as the source
+void applyReferenceEdits(Project &project) {
+  auto &notes = project.getNotes();
+  if (notes.size() > 1)
+    notes[1].setMidiNote(notes[1].getMidiNote() + 1.0f);
+  if (notes.size() > 3) {
+    notes[3].setVibratoEnabled(true);
+    notes[3].setVibratoDepthSemitones(0.5f);
+  }
+  PitchCurveProcessor::rebuildBaseFromNotes(project);
+}
+
+/**
+ * Records or checks the stages one by one. In update mode every output is
+ * written to the golden directory; otherwise each is compared with what is
+ * stored there and every mismatch is printed and counted.
+ */
+class GoldenCheck {
+public:
+  GoldenCheck(const BenchOptions &optionsIn, Runner &runnerIn)
+      : options(optionsIn), runner(runnerIn), dir(optionsIn.goldenDir) {}
+
+  bool begin(const juce::String &reference, int numSamples) {
+    const auto manifestFile = dir.getChildFile("manifest.json");
+    if (options.updateGolden) {
+      if (!dir.createDirectory()) {
+        fail("cannot create " + dir.getFullPathName());
+        return false;
+      }
+      auto *root = new juce::DynamicObject();
+      root->setProperty("version", goldenVersion);
+      root->setProperty("reference", reference);
+      root->setProperty("samples", numSamples);
+      root->setProperty("recorded",
+                        juce::Time::getCurrentTime().toISO8601(true));
+      manifest = juce::var(root);
+    } else {
+      manifest = juce::JSON::parse(manifestFile);
+      if (static_cast<int>(manifest["version"]) != goldenVersion) {
+        fail("no golden outputs (version " + juce::String(goldenVersion) +
+             ") in " + dir.getFullPathName());
+        return false;
+      }
+      if (manifest["reference"].toString() != reference ||
+          static_cast<int>(manifest["samples"]) != numSamples) {
+        fail("recorded for " + manifest["reference"].toString() +
+             ", not this reference audio");
+        return false;
+      }
+    }
+
+    budgetsFile = options.budgetsFile != juce::File{}
+                      ? options.budgetsFile
+                      : dir.getChildFile("budgets.json");
+    budgets = juce::JSON::parse(budgetsFile);
+    if (!budgets.isObject())
+      budgets = juce::var(new juce::DynamicObject());
+    return true;
+  }
+
+  // Time body under the runner, then hold its median to the stage budget
+  void timeStage(const juce::String &stage, const std::function<void()> &body,
+                 const std::function<void()> &setup = nullptr) {
+    runner.run("Golden/" + stage, body, setup);
+    const double medianMs = runner.getLastResult().medianMs;
+    auto *object = budgets.getDynamicObject();
+    if (options.updateGolden) {
+      // New stages get room for slower CI machines; edit to tighten
+      if (!object->hasProperty(stage)) {
+        object->setProperty(
+            stage, std::ceil(std::max(3.0 * medianMs, medianMs + 20.0)));
+        budgetsChanged = true;
+      }
+      return;
+    }
+    if (!object->hasProperty(stage))
+      return;
+    const double budgetMs = object->getProperty(stage);
+    if (medianMs > budgetMs)
+      fail(stage + ": median " + juce::String(medianMs, 1) +
+           " ms over its budget of " + juce::String(budgetMs, 1) + " ms");
+  }
+
+  void checkFloats(const juce::String &stage, const juce::String &fileName,
+                   const std::vector<float> &actual,
+                   const std::function<void(const std::vector<float> &)>
+                       &compare) {
+    const auto file = dir.getChildFile(fileName);
+    if (options.updateGolden) {
+      if (!writeFloats(file, actual.data(), actual.size()))
+        fail("cannot write " + file.getFullPathName());
+      return;
+    }
+    std::vector<float> golden;
+    if (!readFloats(file, golden)) {
+      fail(stage + ": cannot read " + file.getFileName());
+      return;
+    }
+    if (golden.size() != actual.size()) {
+      fail(stage + ": " + juce::String(static_cast<int>(actual.size())) +
+           " values, golden has " +
+           juce::String(static_cast<int>(golden.size())));
+      return;
+    }
+    compare(golden);
+  }
+
+  void fail(const juce::String &message) {
+    std::printf("FAIL %s\n", message.toRawUTF8());
+    ++failures;
+  }
+
+  void pass(const juce::String &stage, const juce::String &detail) {
+    if (!options.updateGolden)
+      std::printf("ok   %s: %s\n", stage.toRawUTF8(), detail.toRawUTF8());
+  }
+
+  bool isUpdating() const { return options.updateGolden; }
+  juce::var &getManifest() { return manifest; }
+  const juce::File &getDirectory() const { return dir; }
+
+  int finish() {
+    if (options.updateGolden) {
+      if (!dir.getChildFile("manifest.json")
+               .replaceWithText(juce::JSON::toString(manifest)))
+        fail("cannot write manifest.json");
+      if (budgetsChanged &&
+          !budgetsFile.replaceWithText(juce::JSON::toString(budgets)))
+        fail("cannot write " + budgetsFile.getFullPathName());
+      if (failures == 0)
+        std::printf("Golden outputs written to %s\n",
+                    dir.getFullPathName().toRawUTF8());
+    } else {
+      std::printf("%s: %d failure(s)\n", failures == 0 ? "PASS" : "FAIL",
+                  failures);
+    }
+    return failures == 0 ? 0 : 1;
+  }
+
+private:
+  const BenchOptions &options;
+  Runner &runner;
+  juce::File dir;
+  juce::File budgetsFile;
+  juce::var manifest;
+  juce::var budgets;
+  bool budgetsChanged = false;
+  int failures = 0;
+};
+
+void checkMel(GoldenCheck &check, const ReferencePhrase &phrase) {
+  MelSpectrogram melComputer(SAMPLE_RATE, N_FFT, HOP_SIZE, NUM_MELS, FMIN,
+                             FMAX);
+  MelBuffer mel;
+  check.timeStage("mel", [&]() {
+    mel = melComputer.compute(phrase.audio.getReadPointer(0),
+                              phrase.audio.getNumSamples());
+  });
+
+  const std::vector<float> values(mel.data(),
+                                  mel.data() + mel.size() * NUM_MELS);
+  check.checkFloats(
+      "mel", "mel.f32", values, [&](const std::vector<float> &golden) {
+        float worst = 0.0f;
+        for (size_t i = 0; i < values.size(); ++i)
+          worst = std::max(worst, std::abs(values[i] - golden[i]));
+        const auto detail = "max difference " + juce::String(worst, 6);
+        if (worst > tolerance::melMaxAbs)
+          check.fail("mel: " + detail);
+        else
+          check.pass("mel", detail);
+      });
+}
+
+void checkPitchCurve(GoldenCheck &check, const ReferencePhrase &phrase) {
+  std::unique_ptr<Project> project;
+  std::vector<float> curve;
+  check.timeStage(
+      "pitchCurve",
+      [&]() {
+        applyReferenceEdits(*project);
+        curve = project->getAdjustedF0();
+      },
+      [&]() { project = makeProject(phrase); });
+
+  check.checkFloats(
+      "pitchCurve", "pitch_curve.f32", curve,
+      [&](const std::vector<float> &golden) {
+        float worst = 0.0f;
+        int voicingChanges = 0;
+        for (size_t i = 0; i < curve.size(); ++i) {
+          if ((curve[i] > 0.0f) != (golden[i] > 0.0f))
+            ++voicingChanges;
+          else if (curve[i] > 0.0f)
+            worst = std::max(worst, centsBetween(curve[i], golden[i]));
+        }
+        if (voicingChanges > 0 || worst > tolerance::curveMaxCents)
+          check.fail("pitchCurve: " + juce::String(voicingChanges) +
+                     " voicing change(s), max " + juce::String(worst, 3) +
+                     " cents");
+        else
+          check.pass("pitchCurve",
+                     "max " + juce::String(worst, 3) + " cents");
+      });
+}
+
+void checkNotes(GoldenCheck &check, const std::vector<Note> &notes) {
+  auto &manifest = check.getManifest();
+  if (check.isUpdating()) {
+    juce::Array<juce::var> list;
+    for (const auto &note : notes)
+      list.add(juce::Array<juce::var>{
+          note.getStartFrame(), note.getEndFrame(),
+          static_cast<double>(note.getMidiNote())});
+    manifest.getDynamicObject()->setProperty("notes", list);
+    return;
+  }
+
+  const auto *golden = manifest["notes"].getArray();
+  if (golden == nullptr || golden->isEmpty()) {
+    check.fail("notes: none recorded");
+    return;
+  }
+  // A golden note is found again when a detected note covers its middle at
+  // about the same pitch
+  int matched = 0;
+  for (const auto &entry : *golden) {
+    const int middle =
+        (static_cast<int>(entry[0]) + static_cast<int>(entry[1])) / 2;
+    const float midi = static_cast<float>(entry[2]);
+    for (const auto &note : notes)
+      if (note.getStartFrame() <= middle && middle < note.getEndFrame() &&
+          std::abs(note.getMidiNote() - midi) <= tolerance::noteSemitones) {
+        ++matched;
+        break;
+      }
+  }
+  const double share = static_cast<double>(matched) / golden->size();
+  const auto detail = juce::String(matched) + "/" +
+                      juce::String(golden->size()) + " matched, " +
+                      juce::String(static_cast<int>(notes.size())) +
+                      " detected";
+  const int extra = static_cast<int>(notes.size()) - golden->size();
+  if (share < tolerance::notesMatched ||
+      std::abs(extra) > golden->size() * (1.0 - tolerance::notesMatched) + 1)
+    check.fail("notes: " + detail);
+  else
+    check.pass("notes", detail);
+}
+
+void checkAnalysis(GoldenCheck &check, EditorController &controller,
+                   const ReferencePhrase &phrase) {
+  std::unique_ptr<Project> project;
+  check.timeStage(
+      "analysis",
+      [&]() {
+        controller.getAudioAnalyzer()->analyze(*project, nullptr, nullptr);
+      },
+      [&]() {
+        project = std::make_unique<Project>();
+        project->getAudioData().waveform = phrase.audio;
+        project->getAudioData().sampleRate = SAMPLE_RATE;
+      });
+
+  const auto &f0 = project->getAudioData().f0;
+  check.checkFloats(
+      "f0", "f0.f32", f0, [&](const std::vector<float> &golden) {
+        int agreeing = 0;
+        int bothVoiced = 0;
+        double cents = 0.0;
+        for (size_t i = 0; i < f0.size(); ++i) {
+          const bool voiced = f0[i] > 0.0f;
+          if (voiced == (golden[i] > 0.0f))
+            ++agreeing;
+          if (voiced && golden[i] > 0.0f) {
+            ++bothVoiced;
+            cents += centsBetween(f0[i], golden[i]);
+          }
+        }
+        const double agreement =
+            f0.empty() ? 1.0 : static_cast<double>(agreeing) / f0.size();
+        const double meanCents = bothVoiced > 0 ? cents / bothVoiced : 0.0;
+        const auto detail = juce::String(agreement * 100.0, 1) +
+                            "% voicing agreement, mean " +
+                            juce::String(meanCents, 2) + " cents";
+        if (agreement < tolerance::voicingAgreement ||
+            meanCents > tolerance::f0MeanCents)
+          check.fail("f0: " + detail);
+        else
+          check.pass("f0", detail);
+      });
+
+  checkNotes(check, project->getNotes());
+}
+
+void checkRender(GoldenCheck &check, EditorController &controller,
+                 const ReferencePhrase &phrase) {
+  const auto project = makeProject(phrase);
+  applyReferenceEdits(*project);
+  juce::AudioBuffer<float> rendered;
+  bool ok = false;
+  check.timeStage("render", [&]() {
+    ok = controller.renderProcessedAudio(*project, rendered);
+  });
+  if (!ok) {
+    check.fail("render: synthesis failed");
+    return;
+  }
+
+  const auto file = check.getDirectory().getChildFile("render.wav");
+  if (check.isUpdating()) {
+    if (!writeWav(file, rendered))
+      check.fail("cannot write " + file.getFullPathName());
+    return;
+  }
+
+  juce::AudioBuffer<float> golden;
+  if (!EditorController::readAudioFile(file, golden, nullptr)) {
+    check.fail("render: cannot read " + file.getFileName());
+    return;
+  }
+  if (std::abs(golden.getNumSamples() - rendered.getNumSamples()) > HOP_SIZE) {
+    check.fail("render: " + juce::String(rendered.getNumSamples()) +
+               " samples, golden has " + juce::String(golden.getNumSamples()));
+    return;
+  }
+
+  // Compared as heard: spectral envelope and level, not sample by sample
+  const int numSamples =
+      std::min(golden.getNumSamples(), rendered.getNumSamples());
+  MelSpectrogram melComputer(SAMPLE_RATE, N_FFT, HOP_SIZE, NUM_MELS, FMIN,
+                             FMAX);
+  const auto renderedMel =
+      melComputer.compute(rendered.getReadPointer(0), numSamples);
+  const auto goldenMel =
+      melComputer.compute(golden.getReadPointer(0), numSamples);
+  double melDifference = 0.0;
+  const size_t numValues = renderedMel.size() * NUM_MELS;
+  for (size_t i = 0; i < numValues; ++i)
+    melDifference += std::abs(renderedMel.data()[i] - goldenMel.data()[i]);
+  melDifference /= std::max<size_t>(1, numValues);
+
+  const double renderedRms = rendered.getRMSLevel(0, 0, numSamples);
+  const double goldenRms = golden.getRMSLevel(0, 0, numSamples);
+  const double levelDb =
+      std::abs(juce::Decibels::gainToDecibels(renderedRms, -120.0) -
+               juce::Decibels::gainToDecibels(goldenRms, -120.0));
+
+  const auto detail = "mel difference " + juce::String(melDifference, 4) +
+                      ", level " + juce::String(levelDb, 2) + " dB";
+  if (melDifference > tolerance::renderMelMeanAbs ||
+      levelDb > tolerance::renderLevelDb)
+    check.fail("render: " + detail);
+  else
+    check.pass("render", detail);
+}
+
+int runGoldenCheck(const BenchOptions &benchOptions,
+                   const ReferencePhrase &phrase,
+                   const juce::String &reference) {
+  // Every stage is timed for its budget
+  auto options = benchOptions;
+  options.filter.clear();
+  Runner runner(options);
+  GoldenCheck check(options, runner);
+  if (!check.begin(reference, phrase.audio.getNumSamples()))
+    return check.finish();
+
+  Runner::printHeader();
+  checkMel(check, phrase);
+  checkPitchCurve(check, phrase);
+
+  if (options.runMacro) {
+    EditorController controller(false);
+    if (loadModels(controller, options)) {
+      checkAnalysis(check, controller, phrase);
+      checkRender(check, controller, phrase);
+    } else {
+      check.fail("models not found; pass --micro-only to check without them");
+    }
+  }
+  return check.finish();
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  BenchOptions options;
+  if (!parseArguments(argc, argv, options)) {
+    printUsage();
+    return 2;
+  }
+
+  // Message manager for the synthesis callbacks, without any window
+  juce::ScopedJuceInitialiser_GUI juceInit;
+
+  if (options.runSynthetic)
+    return runSyntheticCases(options);
+
+  ReferencePhrase phrase;
+  if (!loadReferenceAudio(options, phrase)) {
+    std::fprintf(stderr, "Cannot read %s\n",
+                 options.audioFile.getFullPathName().toRawUTF8());
+    return 1;
+  }
+  const juce::String reference =
+      options.audioFile != juce::File{}
+          ? options.audioFile.getFileName()
+          : "synthetic " + juce::String(options.referenceSeconds, 1) + "s";
+  std::printf("Reference audio: %s, %.1fs\n", reference.toRawUTF8(),
+              phrase.audio.getNumSamples() / static_cast<double>(SAMPLE_RATE));
+
+  if (options.goldenDir != juce::File{})
+    return runGoldenCheck(options, phrase, reference);
+
+  Runner runner(options);
+  Runner::printHeader();
+  runMicroCases(runner, phrase);
+  if (options.runMacro)
+    runMacroCases(runner, options, phrase);
+
+  if (options.jsonFile != juce::File{} &&
+      !runner.writeJson(options.jsonFile, reference)) {
+    std::fprintf(stderr, "Cannot write %s\n",
+                 options.jsonFile.getFullPathName().toRawUTF8());
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,286 @@
+#include "SyntheticProject.h"
+#include "../Utils/CenteredMelSpectrogram.h"
+#include "../Utils/Constants.h"
+#include "../Utils/CurveResampler.h"
+#include "../Utils/MelSpectrogram.h"
+#include "../Utils/PitchCurveProcessor.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace SyntheticProject {
+namespace {
+
+constexpr double framesPerSecond = static_cast<double>(SAMPLE_RATE) / HOP_SIZE;
+constexpr int minNoteFrames = 8;
+constexpr int minStretchGapFrames = 4;
+
+// Notes as detected, with their F0, and the F0 of every frame
+struct Line {
+  std::vector<Note> notes;
+  std::vector<float> f0; // Hz, 0 in the rests
+};
+
+// Phrases of 4 to 12 notes moving by up to three semitones, with a breath
+// between phrases; each note drifts a little and has a light vibrato
+Line makeLine(const Options &options, juce::Random &random, int numFrames) {
+  Line line;
+  line.f0.assign(static_cast<size_t>(numFrames), 0.0f);
+  const double slotFrames =
+      framesPerSecond / std::max(0.05, options.notesPerSecond);
+  float midi = 62.0f;
+  double frame = 0.0;
+  int phraseLeft = 0;
+  for (;;) {
+    if (phraseLeft == 0) {
+      phraseLeft = 4 + random.nextInt(9);
+      frame += slotFrames * (0.5 + random.nextDouble());
+    }
+    const int start = static_cast<int>(frame);
+    const int length = std::max(
+        minNoteFrames,
+        static_cast<int>(slotFrames * (0.55 + 0.35 * random.nextDouble())));
+    if (start + length >= numFrames)
+      break;
+
+    midi = std::clamp(midi + static_cast<float>(random.nextInt(7) - 3), 50.0f,
+                      74.0f);
+    const double rateHz = 4.5 + 2.0 * random.nextDouble();
+    const double phase =
+        juce::MathConstants<double>::twoPi * random.nextDouble();
+    const float drift = 0.2f * (random.nextFloat() - 0.5f);
+    std::vector<float> values(static_cast<size_t>(length));
+    for (int i = 0; i < length; ++i) {
+      const double time = i / framesPerSecond;
+      const float vibrato = 0.15f * static_cast<float>(std::sin(
+                                        juce::MathConstants<double>::twoPi *
+                                            rateHz * time +
+                                        phase));
+      const float hz = midiToFreq(midi + vibrato + drift * i / length);
+      values[static_cast<size_t>(i)] = hz;
+      line.f0[static_cast<size_t>(start + i)] = hz;
+    }
+
+    Note note(start, start + length, midi);
+    note.setF0Values(std::move(values));
+    line.notes.push_back(std::move(note));
+    frame += slotFrames;
+    --phraseLeft;
+  }
+  return line;
+}
+
+// The reference phrase's harmonics read from one precomputed period, since
+// summing sines per sample would take minutes for an hour of audio
+juce::AudioBuffer<float> synthesize(const std::vector<float> &f0,
+                                    int numSamples, juce::Random &random) {
+  constexpr int tableSize = 4096;
+  constexpr int numHarmonics = 16;
+  std::vector<float> table(static_cast<size_t>(tableSize) + 1);
+  for (int i = 0; i < tableSize; ++i) {
+    double sample = 0.0;
+    const double angle = juce::MathConstants<double>::twoPi * i / tableSize;
+    for (int k = 1; k <= numHarmonics; ++k)
+      sample += 0.25 / k * std::sin(k * angle);
+    table[static_cast<size_t>(i)] = static_cast<float>(sample);
+  }
+  table[static_cast<size_t>(tableSize)] = table[0];
+
+  juce::AudioBuffer<float> audio(1, numSamples);
+  float *out = audio.getWritePointer(0);
+  const size_t lastFrame = f0.empty() ? 0 : f0.size() - 1;
+  double phase = 0.0; // Cycles
+  for (int i = 0; i < numSamples; ++i) {
+    const float hz =
+        f0.empty() ? 0.0f
+                   : f0[std::min(static_cast<size_t>(i / HOP_SIZE), lastFrame)];
+    float sample = 0.002f * (random.nextFloat() * 2.0f - 1.0f);
+    if (hz > 0.0f) {
+      phase += static_cast<double>(hz) / SAMPLE_RATE;
+      phase -= std::floor(phase);
+      const double position = phase * tableSize;
+      const int index = static_cast<int>(position);
+      const float fraction = static_cast<float>(position - index);
+      sample += table[static_cast<size_t>(index)] +
+                fraction * (table[static_cast<size_t>(index) + 1] -
+                            table[static_cast<size_t>(index)]);
+    }
+    out[i] = sample;
+  }
+  return audio;
+}
+
+// Lengthen notes into the rest after them the way a stretch drag does:
+// curves resampled onto the new span, mel from a centered STFT
+void stretchNotes(Project &project, const Options &options,
+                  juce::Random &random) {
+  auto &audioData = project.getAudioData();
+  auto &notes = project.getNotes();
+  CenteredMelSpectrogram centeredMel(SAMPLE_RATE, N_FFT, WIN_SIZE, NUM_MELS,
+                                     FMIN, FMAX);
+  const int numFrames = audioData.getNumFrames();
+  for (size_t i = 0; i < notes.size(); ++i) {
+    auto &note = notes[i];
+    const int start = note.getStartFrame();
+    const int end = note.getEndFrame();
+    const int limit = i + 1 < notes.size() ? notes[i + 1].getStartFrame()
+                                           : numFrames;
+    const int gap = limit - end;
+    if (gap < minStretchGapFrames ||
+        random.nextDouble() >= options.stretchedShare)
+      continue;
+
+    const int length = end - start;
+    const int added =
+        static_cast<int>(length * (0.2 + 0.4 * random.nextDouble()));
+    const int newLength = length + std::min(gap - 2, added);
+    if (newLength <= length)
+      continue;
+
+    const std::vector<float> delta(
+        audioData.deltaPitch.begin() + start,
+        audioData.deltaPitch.begin() + end);
+    CurveResampler::resampleLinear(delta.data(), length,
+                                   audioData.deltaPitch.data() + start,
+                                   newLength);
+    std::vector<bool> voiced(static_cast<size_t>(length));
+    for (int frame = start; frame < end; ++frame)
+      voiced[static_cast<size_t>(frame - start)] =
+          audioData.voicedMask[static_cast<size_t>(frame)];
+    const auto newVoiced = CurveResampler::resampleNearest(voiced, newLength);
+    for (int frame = 0; frame < newLength; ++frame)
+      audioData.voicedMask[static_cast<size_t>(start + frame)] =
+          newVoiced[static_cast<size_t>(frame)];
+
+    MelBuffer stretched;
+    centeredMel.computeTimeStretched(audioData.waveform.getReadPointer(0),
+                                     audioData.waveform.getNumSamples(), start,
+                                     end, newLength, stretched);
+    if (static_cast<int>(stretched.size()) == newLength)
+      audioData.melSpectrogram.copyFrames(static_cast<size_t>(start),
+                                          stretched);
+    note.setEndFrame(start + newLength);
+  }
+}
+
+void addVibrato(Project &project, const Options &options,
+                juce::Random &random) {
+  for (auto &note : project.getNotes()) {
+    if (random.nextDouble() >= options.vibratoShare)
+      continue;
+    note.setVibratoEnabled(true);
+    note.setVibratoRateHz(5.0f + 1.5f * random.nextFloat());
+    note.setVibratoDepthSemitones(0.2f + 0.6f * random.nextFloat());
+  }
+}
+
+// Every fourth edit moves a whole note by a semitone; the others draw a
+// bump of up to 0.8 semitones over part of one
+void recordEdits(Project &project, PitchUndoManager &history,
+                 const Options &options, juce::Random &random) {
+  auto &audioData = project.getAudioData();
+  auto &notes = project.getNotes();
+  if (notes.empty())
+    return;
+
+  auto *projectPtr = &project;
+  for (int edit = 0; edit < options.numEdits; ++edit) {
+    auto &note = notes[static_cast<size_t>(
+        random.nextInt(static_cast<int>(notes.size())))];
+    const int start = note.getStartFrame();
+    const int end = note.getEndFrame();
+
+    if (edit % 4 == 3) {
+      const float oldOffset = note.getPitchOffset();
+      const float newOffset = oldOffset + (random.nextBool() ? 1.0f : -1.0f);
+      note.setPitchOffset(newOffset);
+      PitchCurveProcessor::rebuildBaseInRange(project, start, end);
+      history.addAction(std::make_unique<PitchOffsetAction>(
+          &project, &note, oldOffset, newOffset));
+      continue;
+    }
+
+    const int length = std::min(end - start, 10 + random.nextInt(50));
+    const int strokeStart =
+        start + random.nextInt(std::max(1, end - start - length));
+    const float bump = 0.8f * (random.nextFloat() * 2.0f - 1.0f);
+    std::vector<F0FrameEdit> edits;
+    edits.reserve(static_cast<size_t>(length));
+    for (int i = 0; i < length; ++i) {
+      const auto frame = static_cast<size_t>(strokeStart + i);
+      const float shape = static_cast<float>(
+          std::sin(juce::MathConstants<double>::pi * (i + 0.5) / length));
+      F0FrameEdit frameEdit;
+      frameEdit.idx = static_cast<int>(frame);
+      frameEdit.oldF0 = audioData.f0[frame];
+      frameEdit.oldDelta = audioData.deltaPitch[frame];
+      frameEdit.oldVoiced = audioData.voicedMask[frame];
+      frameEdit.newDelta = frameEdit.oldDelta + bump * shape;
+      frameEdit.newF0 =
+          midiToFreq(audioData.basePitch[frame] + frameEdit.newDelta);
+      frameEdit.newVoiced = true;
+      audioData.f0[frame] = frameEdit.newF0;
+      audioData.deltaPitch[frame] = frameEdit.newDelta;
+      audioData.voicedMask[frame] = true;
+      edits.push_back(frameEdit);
+    }
+    history.addAction(std::make_unique<F0EditAction>(
+        &audioData.f0, &audioData.deltaPitch, &audioData.voicedMask,
+        std::move(edits), [projectPtr](int minFrame, int maxFrame) {
+          projectPtr->setF0DirtyRange(minFrame, maxFrame);
+        }));
+  }
+}
+
+} // namespace
+
+Generated generate(const Options &options) {
+  juce::Random random(static_cast<juce::int64>(options.seed));
+  const int numSamples = static_cast<int>(
+      std::clamp(options.seconds, 1.0, 36000.0) * SAMPLE_RATE);
+  auto line = makeLine(options, random, numSamples / HOP_SIZE + 1);
+
+  Generated generated;
+  generated.project = std::make_unique<Project>();
+  auto &project = *generated.project;
+  auto &audioData = project.getAudioData();
+  audioData.waveform = synthesize(line.f0, numSamples, random);
+  audioData.sampleRate = SAMPLE_RATE;
+  MelSpectrogram melComputer(SAMPLE_RATE, N_FFT, HOP_SIZE, NUM_MELS, FMIN,
+                             FMAX);
+  audioData.melSpectrogram = melComputer.compute(
+      audioData.waveform.getReadPointer(0), numSamples);
+
+  const size_t numFrames = audioData.melSpectrogram.size();
+  audioData.f0 = std::move(line.f0);
+  audioData.f0.resize(numFrames, 0.0f);
+  audioData.voicedMask = VoicedMask(numFrames);
+  for (size_t i = 0; i < numFrames; ++i)
+    audioData.voicedMask[i] = audioData.f0[i] > 0.0f;
+  // Pushed as analysis does, without a feed event per note
+  project.getNotes() = std::move(line.notes);
+  project.invalidateNoteIndex();
+  PitchCurveProcessor::rebuildCurvesFromSource(project, audioData.f0);
+
+  stretchNotes(project, options, random);
+  addVibrato(project, options, random);
+  PitchCurveProcessor::rebuildBaseFromNotes(project);
+
+  // Unbounded depth and no merging, so each edit stays a step
+  generated.history = std::make_unique<PitchUndoManager>(0);
+  generated.history->setCoalesceWindowMs(0);
+  recordEdits(project, *generated.history, options, random);
+  return generated;
+}
+
+juce::String describe(const Options &options) {
+  return juce::String(options.seconds, 0) + "s, " +
+         juce::String(options.notesPerSecond, 1) + " notes/s, " +
+         juce::String(options.numEdits) + " edits, " +
+         juce::String(juce::roundToInt(options.stretchedShare * 100.0)) +
+         "% stretched, " +
+         juce::String(juce::roundToInt(options.vibratoShare * 100.0)) +
+         "% vibrato";
+}
+
+} // namespace SyntheticProject
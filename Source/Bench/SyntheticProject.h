@@ -0,0 +1,41 @@
+#pragma once
+
+#include "../JuceHeader.h"
+#include "../Models/Project.h"
+#include "../Utils/UndoManager.h"
+#include <cstdint>
+#include <memory>
+
+/**
+ * Large projects made up for scale testing (hachitune_bench --synthetic).
+ *
+ * A sung line of random phrases over the whole length, analysed the way
+ * makeProject() treats the reference phrase, then edited: some notes get
+ * vibrato, some are stretched into the rest after them (mel re-rendered
+ * with CenteredMelSpectrogram, as a stretch drag does), and numEdits pitch
+ * offsets and drawn strokes are applied and recorded in an undo history.
+ * The same options and seed give the same project on every machine.
+ */
+namespace SyntheticProject {
+
+struct Options {
+  double seconds = 600.0;       // Up to ten hours
+  double notesPerSecond = 2.0;
+  int numEdits = 1000;          // Undo steps recorded
+  double stretchedShare = 0.1;  // Of the notes with a rest after them
+  double vibratoShare = 0.25;
+  uint32_t seed = 0x48616368;
+};
+
+struct Generated {
+  std::unique_ptr<Project> project;
+  // Every edit, oldest first
+  std::unique_ptr<PitchUndoManager> history;
+};
+
+Generated generate(const Options &options);
+
+/** e.g. "600s, 2.0 notes/s, 1000 edits, 10% stretched, 25% vibrato". */
+juce::String describe(const Options &options);
+
+} // namespace SyntheticProject
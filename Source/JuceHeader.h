@@ -22,3 +22,7 @@
 #include <juce_graphics/juce_graphics.h>
 #include <juce_gui_basics/juce_gui_basics.h>
 #include <juce_gui_extra/juce_gui_extra.h>
+
+#ifdef HACHITUNE_OPENGL
+#include <juce_opengl/juce_opengl.h>
+#endif
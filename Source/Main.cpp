@@ -2,12 +2,15 @@
 // MainComponent)
 
 #include "JuceHeader.h"
+#include "Audio/HardwareCapabilities.h"
 #include "UI/MainComponent.h"
 #include "UI/StyledComponents.h"
 #include "Utils/AppLogger.h"
 #include "Utils/Constants.h"
+#include "Utils/JobSystem.h"
 #include "Utils/Localization.h"
 #include "Utils/PlatformUtils.h"
+#include "Utils/StartupTimer.h"
 #include "Utils/UI/WindowSizing.h"
 #include "Utils/UI/TimecodeFont.h"
 
@@ -16,80 +19,6 @@
 #pragma comment(lib, "dwmapi.lib")
 #endif
 
-class SplashComponent : public juce::Component, private juce::Timer {
-public:
-  SplashComponent() { startTimerHz(30); }
-
-  void paint(juce::Graphics &g) override {
-    auto bounds = getLocalBounds().toFloat();
-    juce::ColourGradient background(
-        juce::Colour(APP_COLOR_BACKGROUND).brighter(0.12f),
-        bounds.getTopLeft(),
-        juce::Colour(APP_COLOR_BACKGROUND).darker(0.12f),
-        bounds.getBottomRight(),
-        false);
-    g.setGradientFill(background);
-    g.fillAll();
-
-    const auto titleFont = AppFont::getBoldFont(34.0f);
-    const auto subtitleFont = AppFont::getFont(15.0f);
-
-    g.setColour(juce::Colours::white);
-    g.setFont(titleFont);
-    g.drawText("HachiTune", getLocalBounds().reduced(24, 20),
-               juce::Justification::centredTop);
-
-    g.setColour(juce::Colour(APP_COLOR_PRIMARY));
-    g.setFont(subtitleFont);
-    g.drawText(TR("progress.loading"), 0, 150, getWidth(), 24,
-               juce::Justification::centredTop);
-
-    const float dotRadius = 5.0f;
-    const float dotSpacing = 14.0f;
-    const float baseY = 190.0f;
-    const float startX = (getWidth() - dotSpacing * 2.0f) * 0.5f;
-
-    for (int i = 0; i < 3; ++i) {
-      const int phase = (tick / 6 + i) % 3;
-      const float alpha = (phase == 0 ? 1.0f : (phase == 1 ? 0.6f : 0.35f));
-      g.setColour(juce::Colour(APP_COLOR_PRIMARY).withAlpha(alpha));
-      g.fillEllipse(startX + dotSpacing * static_cast<float>(i),
-                    baseY - dotRadius, dotRadius * 2.0f, dotRadius * 2.0f);
-    }
-  }
-
-private:
-  void timerCallback() override {
-    ++tick;
-    repaint();
-  }
-
-  int tick = 0;
-};
-
-class SplashWindow : public juce::DocumentWindow {
-public:
-  SplashWindow()
-      : juce::DocumentWindow("",
-                             juce::Colour(APP_COLOR_BACKGROUND),
-                             juce::DocumentWindow::closeButton,
-                             false) {
-    setUsingNativeTitleBar(false);
-    setTitleBarButtonsRequired(0, false);
-    setResizable(false, false);
-    setAlwaysOnTop(true);
-    setOpaque(true);
-
-    auto *content = new SplashComponent();
-    setContentOwned(content, true);
-    setSize(420, 230);
-    centreWithSize(getWidth(), getHeight());
-    setVisible(true);
-  }
-
-  void closeButtonPressed() override {}
-};
-
 class HachiTuneApplication : public juce::JUCEApplication {
 public:
   HachiTuneApplication() {}
@@ -103,28 +32,33 @@ public:
   void initialise(const juce::String &commandLine) override {
     juce::ignoreUnused(commandLine);
     AppLogger::init();
+    StartupTimer::begin();
+    JobSystem::init();
+    HardwareCapabilities::init(); // GPUs are listed while the window opens
     LOG("========== APP STARTING ==========");
-    LOG("Initializing fonts...");
-    AppFont::initialize();
-    TimecodeFont::initialize();
-    LOG("Loading localization...");
+    // The font file is read on a worker while settings and the language file
+    // are parsed here
+    auto fontData = JobSystem::getInstance().submitWithResult(
+        JobSystem::Priority::Interactive,
+        []() { return TimecodeFont::readFontFile(); });
     Localization::loadFromSettings();
-    LOG("Localization loaded, showing splash...");
-#if JUCE_STANDALONE_APPLICATION
-    splashWindow = std::make_unique<SplashWindow>();
-#endif
-    juce::MessageManager::callAsync([this]() {
-      LOG("Creating MainWindow...");
-      mainWindow = std::make_unique<MainWindow>(getApplicationName());
-      splashWindow = nullptr;
-      LOG("MainWindow created and visible");
-    });
+    StartupTimer::mark("settings and language");
+    AppFont::initialize();
+    TimecodeFont::initialize(fontData.get());
+    StartupTimer::mark("fonts");
+
+    // Models and the audio device start once the window has painted
+    mainWindow = std::make_unique<MainWindow>(getApplicationName());
+    StartupTimer::mark("main window");
   }
 
   void shutdown() override {
     mainWindow = nullptr;
     TimecodeFont::shutdown();
     AppFont::shutdown(); // Release font resources before JUCE shuts down
+    HardwareCapabilities::shutdown();
+    JobSystem::shutdown();
+    AppLogger::shutdown();
   }
 
   void systemRequestedQuit() override { quit(); }
@@ -187,6 +121,7 @@ public:
       LOG("MainWindow: initial size " + juce::String(getWidth()) + "x" +
           juce::String(getHeight()));
       setVisible(true);
+      jobView.setActive(true);
       LOG("MainWindow: setVisible(true) done");
 
 #if JUCE_WINDOWS
@@ -215,15 +150,23 @@ public:
       JUCEApplication::getInstance()->systemRequestedQuit();
     }
 
+    // Our own dialogs take activation without sending the app to the back
+    void activeWindowStatusChanged() override {
+      DocumentWindow::activeWindowStatusChanged();
+      jobView.setActive(!isMinimised() &&
+                        (isActiveWindow() ||
+                         juce::Process::isForegroundProcess()));
+    }
+
   private:
+    // Background jobs wait while the app is in the background or minimised
+    JobSystem::View jobView;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MainWindow)
   };
 
 private:
   std::unique_ptr<MainWindow> mainWindow;
-#if JUCE_STANDALONE_APPLICATION
-  std::unique_ptr<SplashWindow> splashWindow;
-#endif
 };
 
 START_JUCE_APPLICATION(HachiTuneApplication)
@@ -1,5 +1,7 @@
 #include "Note.h"
 #include "../Utils/Constants.h"
+#include "../Utils/PitchConversion.h"
+#include <algorithm>
 
 Note::Note(int startFrame, int endFrame, float midiNote)
     : srcStartFrame(startFrame), srcEndFrame(endFrame),
@@ -7,49 +9,78 @@ Note::Note(int startFrame, int endFrame, float midiNote)
 {
 }
 
-std::vector<float> Note::getAdjustedF0() const
+void Note::getAdjustedF0(std::vector<float>& out) const
 {
-    if (f0Values.empty() || pitchOffset == 0.0f)
-        return f0Values;
+    out.resize(f0Values.size());
+    if (pitchOffset == 0.0f)
+    {
+        std::copy(f0Values.begin(), f0Values.end(), out.begin());
+        return;
+    }
 
     // Convert semitone offset to frequency ratio
     float ratio = std::pow(2.0f, pitchOffset / 12.0f);
 
-    std::vector<float> adjusted;
-    adjusted.reserve(f0Values.size());
+    for (size_t i = 0; i < f0Values.size(); ++i)
+        out[i] = f0Values[i] > 0.0f ? f0Values[i] * ratio : 0.0f;
+}
 
-    for (float f0 : f0Values)
-    {
-        if (f0 > 0.0f)
-            adjusted.push_back(f0 * ratio);
-        else
-            adjusted.push_back(0.0f);
-    }
+void Note::computeF0FromDelta(std::vector<float>& out) const
+{
+    int numFrames = std::max(0, endFrame - startFrame);
+    out.resize(static_cast<size_t>(numFrames));
+
+    // Actual MIDI = base + offset + delta (0 past the delta curve)
+    const float baseMidi = midiNote + pitchOffset;
+    const int numDelta = std::min(numFrames, static_cast<int>(deltaPitch.size()));
+    for (int i = 0; i < numDelta; ++i)
+        out[static_cast<size_t>(i)] = baseMidi + deltaPitch[static_cast<size_t>(i)];
+    std::fill(out.begin() + numDelta, out.end(), baseMidi);
 
-    return adjusted;
+    // Convert to Hz
+    PitchConversion::midiToFreq(out.data(), out.data(), numFrames);
 }
 
-std::vector<float> Note::computeF0FromDelta() const
+bool Note::containsFrame(int frame) const
 {
-    int numFrames = endFrame - startFrame;
-    std::vector<float> result(numFrames, 0.0f);
+    return frame >= startFrame && frame < endFrame;
+}
 
-    for (int i = 0; i < numFrames; ++i)
-    {
-        // Get delta pitch for this frame (or 0 if not available)
-        float delta = (i < static_cast<int>(deltaPitch.size())) ? deltaPitch[i] : 0.0f;
+Note Note::splitOff(int splitFrame)
+{
+    Note second;
+    second.setStartFrame(splitFrame);
+    second.setEndFrame(endFrame);
+    second.setMidiNote(midiNote);
+    second.setLyric(lyric);
+    // Gain carries over; the fade out now ends the second part
+    second.gainDb = gainDb;
+    second.fadeOutFrames = fadeOutFrames;
+    fadeOutFrames = 0;
 
-        // Actual MIDI = base + offset + delta
-        float actualMidi = midiNote + pitchOffset + delta;
+    if (hasClipWaveform())
+    {
+        const int splitSample = std::clamp((splitFrame - startFrame) * HOP_SIZE, 0, clipWaveform.size());
+        second.clipWaveform = clipWaveform.slice(splitSample, clipWaveform.size());
+        clipWaveform = clipWaveform.slice(0, splitSample);
+    }
 
-        // Convert to Hz
-        result[i] = midiToFreq(actualMidi);
+    if (hasClipMel())
+    {
+        const auto splitMelFrame = static_cast<size_t>(
+            std::clamp(splitFrame - startFrame, 0, static_cast<int>(clipMel.size())));
+        second.clipMel = clipMel.slice(splitMelFrame, clipMel.size());
+        clipMel = clipMel.slice(0, splitMelFrame);
     }
 
-    return result;
+    setEndFrame(splitFrame);
+    return second;
 }
 
-bool Note::containsFrame(int frame) const
+size_t Note::getMemoryBytes() const
 {
-    return frame >= startFrame && frame < endFrame;
+    return sizeof(Note)
+         + deltaPitch.capacity() * sizeof(float)
+         + f0Values.capacity() * sizeof(float)
+         + clipWaveform.getOwnedBytes();
 }
@@ -1,8 +1,27 @@
 #pragma once
 
 #include "../JuceHeader.h"
+#include "NoteClip.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
 #include <vector>
 
+// Identity of a note within its project; 0 until Project::addNote() gives
+// it one
+using NoteId = uint32_t;
+
+// Counters shared by the notes of one list (a project's, which joins its
+// notes to them): bumped whenever one of those notes' output timing or
+// adjusted MIDI note changes, including by assigning another note over it
+// (see NoteIndex)
+struct NoteRevisions
+{
+    std::atomic<uint32_t> timing{0};
+    std::atomic<uint32_t> pitch{0};
+};
+
 /**
  * Represents a single note/pitch segment.
  *
@@ -32,6 +51,11 @@ public:
     Note() = default;
     Note(int startFrame, int endFrame, float midiNote);
 
+    // Stable across edits and vector reallocation; copies keep it, so undo
+    // can put a saved copy back in its place
+    NoteId getId() const { return id; }
+    void setId(NoteId newId) { id = newId; }
+
     // Source frame range (position in original waveform, fixed after detection)
     int getSrcStartFrame() const { return srcStartFrame; }
     int getSrcEndFrame() const { return srcEndFrame; }
@@ -42,8 +66,8 @@ public:
     // Destination frame range (position in output timeline, can be changed)
     int getStartFrame() const { return startFrame; }
     int getEndFrame() const { return endFrame; }
-    void setStartFrame(int frame) { startFrame = frame; }
-    void setEndFrame(int frame) { endFrame = frame; }
+    void setStartFrame(int frame) { startFrame = frame; bumpTimingRevision(); }
+    void setEndFrame(int frame) { endFrame = frame; bumpTimingRevision(); }
     int getDurationFrames() const { return endFrame - startFrame; }
 
     // Time stretch ratio (output length / source length)
@@ -60,9 +84,9 @@ public:
 
     // Pitch
     float getMidiNote() const { return midiNote; }
-    void setMidiNote(float note) { midiNote = note; }
+    void setMidiNote(float note) { midiNote = note; bumpPitchRevision(); }
     float getPitchOffset() const { return pitchOffset; }
-    void setPitchOffset(float offset) { pitchOffset = offset; }
+    void setPitchOffset(float offset) { pitchOffset = offset; bumpPitchRevision(); }
     float getAdjustedMidiNote() const { return midiNote + pitchOffset; }
 
     // Delta pitch (per-frame deviation from base pitch in semitones)
@@ -80,22 +104,36 @@ public:
     float getVibratoPhaseRadians() const { return vibratoPhaseRadians; }
     void setVibratoPhaseRadians(float radians) { vibratoPhaseRadians = radians; }
 
+    // Gain after the vocoder (see GainLane): changing these never needs a
+    // resynthesis, so they do not mark the note dirty
+    float getGainDb() const { return gainDb; }
+    void setGainDb(float dB) { gainDb = dB; }
+    int getFadeInFrames() const { return fadeInFrames; }
+    void setFadeInFrames(int frames) { fadeInFrames = std::max(0, frames); }
+    int getFadeOutFrames() const { return fadeOutFrames; }
+    void setFadeOutFrames(int frames) { fadeOutFrames = std::max(0, frames); }
+    bool hasGain() const { return gainDb != 0.0f || fadeInFrames > 0 || fadeOutFrames > 0; }
+
     // F0 values (original detected values)
     const std::vector<float>& getF0Values() const { return f0Values; }
     void setF0Values(std::vector<float> values) { f0Values = std::move(values); }
-    std::vector<float> getAdjustedF0() const;
 
-    // Get F0 values based on current midiNote + deltaPitch
-    std::vector<float> computeF0FromDelta() const;
+    // F0 values with pitchOffset applied, written into out (resized to
+    // getF0Values().size(); reuses its capacity)
+    void getAdjustedF0(std::vector<float>& out) const;
 
-    // Waveform clip (original samples for this note)
-    const std::vector<float>& getClipWaveform() const { return clipWaveform; }
-    void setClipWaveform(std::vector<float> samples) { clipWaveform = std::move(samples); }
+    // F0 values based on current midiNote + deltaPitch, written into out
+    // (resized to getDurationFrames(); reuses its capacity)
+    void computeF0FromDelta(std::vector<float>& out) const;
+
+    // Waveform clip (original samples for this note, shared - see WaveformClip)
+    const WaveformClip& getClipWaveform() const { return clipWaveform; }
+    void setClipWaveform(WaveformClip clip) { clipWaveform = std::move(clip); }
     bool hasClipWaveform() const { return !clipWaveform.empty(); }
 
-    // Mel spectrogram clip (original mel frames for this note)
-    const std::vector<std::vector<float>>& getClipMel() const { return clipMel; }
-    void setClipMel(std::vector<std::vector<float>> mel) { clipMel = std::move(mel); }
+    // Mel spectrogram clip (original mel frames for this note, shared)
+    const MelClip& getClipMel() const { return clipMel; }
+    void setClipMel(MelClip mel) { clipMel = std::move(mel); }
     bool hasClipMel() const { return !clipMel.empty(); }
 
     // Selection
@@ -125,7 +163,56 @@ public:
     // Check if frame is within note
     bool containsFrame(int frame) const;
 
+    // End this note at splitFrame and return the part after it: same pitch
+    // and lyric, no offset, and slices of this note's clips rather than
+    // copies of their samples and frames
+    Note splitOff(int splitFrame);
+
+    // Approximate heap bytes held by this note (curves and owned clip samples;
+    // shared mel buffers are counted by the project)
+    size_t getMemoryBytes() const;
+
+    // Report changes to list's counters from now on; bookkeeping only, so
+    // allowed on a const note
+    void joinRevisions(const std::shared_ptr<NoteRevisions>& list) const
+    {
+        if (revisions.counters != list)
+            revisions.counters = list;
+    }
+
 private:
+    // Copies report to the same list as their source. Assigning over a note
+    // keeps its list and bumps both counters: the slot's timing and pitch
+    // may both have changed.
+    struct RevisionLink
+    {
+        std::shared_ptr<NoteRevisions> counters;
+
+        RevisionLink() = default;
+        RevisionLink(const RevisionLink&) = default;
+        RevisionLink(RevisionLink&& other) noexcept : counters(other.counters) {}
+        RevisionLink& operator=(const RevisionLink&) { bumpAll(); return *this; }
+        RevisionLink& operator=(RevisionLink&&) noexcept { bumpAll(); return *this; }
+
+        void bumpTiming() const
+        {
+            if (counters != nullptr)
+                counters->timing.fetch_add(1, std::memory_order_relaxed);
+        }
+        void bumpPitch() const
+        {
+            if (counters != nullptr)
+                counters->pitch.fetch_add(1, std::memory_order_relaxed);
+        }
+        void bumpAll() const { bumpTiming(); bumpPitch(); }
+    };
+
+    void bumpTimingRevision() const { revisions.bumpTiming(); }
+    void bumpPitchRevision() const { revisions.bumpPitch(); }
+    mutable RevisionLink revisions;
+
+    NoteId id = 0;
+
     // Source position (in original waveform, fixed after detection)
     int srcStartFrame = 0;
     int srcEndFrame = 0;
@@ -144,9 +231,13 @@ private:
     float vibratoDepthSemitones = 0.0f;
     float vibratoPhaseRadians = 0.0f;
 
+    float gainDb = 0.0f;
+    int fadeInFrames = 0;   // Linear ramp up from silence at the start
+    int fadeOutFrames = 0;  // And down to silence at the end
+
     std::vector<float> f0Values;
-    std::vector<float> clipWaveform;
-    std::vector<std::vector<float>> clipMel;  // Mel spectrogram clip [T, numMels]
+    WaveformClip clipWaveform;
+    MelClip clipMel;  // Mel spectrogram clip [T, numMels]
     bool selected = false;
     bool dirty = false;  // For incremental synthesis
     bool rest = false;   // Rest note (silence placeholder)
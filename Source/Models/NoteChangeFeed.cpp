@@ -0,0 +1,100 @@
+#include "NoteChangeFeed.h"
+#include <algorithm>
+
+NoteChangeFeed::Subscription::Subscription(Subscription&& other) noexcept
+    : hub(std::move(other.hub)), token(other.token)
+{
+    other.token = 0;
+}
+
+NoteChangeFeed::Subscription& NoteChangeFeed::Subscription::operator=(Subscription&& other) noexcept
+{
+    if (this != &other)
+    {
+        reset();
+        hub = std::move(other.hub);
+        token = other.token;
+        other.token = 0;
+    }
+    return *this;
+}
+
+void NoteChangeFeed::Subscription::reset()
+{
+    if (auto locked = hub.lock())
+    {
+        auto& entries = locked->entries;
+        entries.erase(std::remove_if(entries.begin(), entries.end(),
+                                     [this](const Hub::Entry& entry) { return entry.token == token; }),
+                      entries.end());
+    }
+    hub.reset();
+    token = 0;
+}
+
+NoteChangeFeed::NoteChangeFeed()
+    : hub(std::make_shared<Hub>())
+{
+}
+
+NoteChangeFeed::NoteChangeFeed(const NoteChangeFeed&)
+    : hub(std::make_shared<Hub>())
+{
+}
+
+NoteChangeFeed::Subscription NoteChangeFeed::subscribe(Callback callback)
+{
+    const uint64_t token = hub->nextToken++;
+    hub->entries.push_back({ token, std::move(callback) });
+    return Subscription(hub, token);
+}
+
+void NoteChangeFeed::post(const NoteChange& change)
+{
+    if (batchDepth > 0)
+    {
+        pending.push_back(change);
+        return;
+    }
+    deliver({ change });
+}
+
+void NoteChangeFeed::endBatch()
+{
+    if (batchDepth == 0 || --batchDepth > 0 || pending.empty())
+        return;
+
+    auto changes = std::move(pending);
+    pending.clear();
+    const bool reset = std::any_of(changes.begin(), changes.end(), [](const NoteChange& change) {
+        return change.type == NoteChange::Type::Reset;
+    });
+    if (reset)
+        changes.assign(1, NoteChange { NoteChange::Type::Reset });
+    deliver(changes);
+}
+
+void NoteChangeFeed::deliver(const std::vector<NoteChange>& changes)
+{
+    if (hub->entries.empty())
+        return;
+
+    // A callback may end its own or another subscription, so each one is
+    // looked up again before it runs
+    auto keepAlive = hub;
+    std::vector<uint64_t> tokens;
+    tokens.reserve(keepAlive->entries.size());
+    for (const auto& entry : keepAlive->entries)
+        tokens.push_back(entry.token);
+
+    for (const uint64_t token : tokens)
+    {
+        auto& entries = keepAlive->entries;
+        auto it = std::find_if(entries.begin(), entries.end(),
+                               [token](const Hub::Entry& entry) { return entry.token == token; });
+        if (it == entries.end())
+            continue;
+        auto callback = it->callback;
+        callback(changes);
+    }
+}
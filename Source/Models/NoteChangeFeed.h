@@ -0,0 +1,116 @@
+#pragma once
+
+#include "Note.h"
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+/**
+ * One edit to a project's notes, in output timeline frames.
+ */
+struct NoteChange
+{
+    enum class Type
+    {
+        Added,
+        Removed,
+        Changed, // Pitch, timing or clips; the range spans old and new position
+        Reset    // Notes replaced wholesale; no id or range
+    };
+
+    Type type = Type::Changed;
+    NoteId id = 0;
+    int startFrame = 0;
+    int endFrame = 0;
+};
+
+/**
+ * Note edits of one project, delivered to the caches derived from the notes
+ * (drawn curves, synthesis spans, lookahead curves) so each can update the
+ * frames that changed instead of starting over.
+ *
+ * Changes posted between beginBatch() and endBatch() are delivered together
+ * when the outermost batch ends, so a multi-note edit or an undo step is one
+ * notification; a batch containing a Reset is delivered as that Reset alone.
+ * Callbacks run on the thread that posted, which for the displayed project
+ * is the message thread.
+ *
+ * A Subscription ends on destruction and may outlive the feed. Copying a
+ * feed (as when a project is copied) starts the copy with no subscribers.
+ */
+class NoteChangeFeed
+{
+    struct Hub;
+
+public:
+    using Callback = std::function<void(const std::vector<NoteChange>&)>;
+
+    class Subscription
+    {
+    public:
+        Subscription() = default;
+        Subscription(Subscription&& other) noexcept;
+        Subscription& operator=(Subscription&& other) noexcept;
+        ~Subscription() { reset(); }
+
+        void reset();
+
+    private:
+        friend class NoteChangeFeed;
+        Subscription(std::weak_ptr<Hub> hub, uint64_t token)
+            : hub(std::move(hub)), token(token) {}
+
+        std::weak_ptr<Hub> hub;
+        uint64_t token = 0;
+    };
+
+    /** Defers delivery until destroyed; a null feed does nothing. */
+    class ScopedBatch
+    {
+    public:
+        explicit ScopedBatch(NoteChangeFeed* feed) : feed(feed)
+        {
+            if (feed)
+                feed->beginBatch();
+        }
+        ~ScopedBatch()
+        {
+            if (feed)
+                feed->endBatch();
+        }
+
+    private:
+        NoteChangeFeed* feed;
+
+        JUCE_DECLARE_NON_COPYABLE(ScopedBatch)
+    };
+
+    NoteChangeFeed();
+    NoteChangeFeed(const NoteChangeFeed&);
+    NoteChangeFeed& operator=(const NoteChangeFeed&) { return *this; }
+
+    [[nodiscard]] Subscription subscribe(Callback callback);
+
+    void post(const NoteChange& change);
+    void beginBatch() { ++batchDepth; }
+    void endBatch();
+
+private:
+    struct Hub
+    {
+        struct Entry
+        {
+            uint64_t token = 0;
+            Callback callback;
+        };
+        std::vector<Entry> entries;
+        uint64_t nextToken = 1;
+    };
+
+    void deliver(const std::vector<NoteChange>& changes);
+
+    std::shared_ptr<Hub> hub;
+    std::vector<NoteChange> pending;
+    int batchDepth = 0;
+};
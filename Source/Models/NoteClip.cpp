@@ -0,0 +1,116 @@
+#include "NoteClip.h"
+#include <algorithm>
+
+WaveformClip::WaveformClip(std::vector<float> samples)
+    : numSamples(static_cast<int>(samples.size()))
+{
+    if (!samples.empty())
+        owned = std::make_shared<const std::vector<float>>(std::move(samples));
+}
+
+WaveformClip::WaveformClip(RenderSnapshot::Ptr source, int startSample, int endSample)
+{
+    if (!source || source->getNumChannels() == 0)
+        return;
+
+    startSample = std::clamp(startSample, 0, source->getNumSamples());
+    endSample = std::clamp(endSample, startSample, source->getNumSamples());
+    if (endSample == startSample)
+        return;
+
+    snapshot = std::move(source);
+    offset = startSample;
+    numSamples = endSample - startSample;
+}
+
+float WaveformClip::getSample(int index) const
+{
+    if (snapshot)
+        return snapshot->getSample(0, offset + index);
+    return (*owned)[static_cast<size_t>(offset + index)];
+}
+
+void WaveformClip::read(int start, int count, float* dest) const
+{
+    start = std::clamp(start, 0, numSamples);
+    count = std::clamp(count, 0, numSamples - start);
+    if (count == 0)
+        return;
+
+    if (snapshot)
+        snapshot->read(0, offset + start, count, dest);
+    else
+        std::copy_n(owned->data() + offset + start, count, dest);
+}
+
+std::vector<float> WaveformClip::toVector() const
+{
+    std::vector<float> samples(static_cast<size_t>(numSamples));
+    read(0, numSamples, samples.data());
+    return samples;
+}
+
+WaveformClip WaveformClip::slice(int start, int end) const
+{
+    start = std::clamp(start, 0, numSamples);
+    end = std::clamp(end, start, numSamples);
+
+    WaveformClip result;
+    if (end == start)
+        return result;
+
+    result.snapshot = snapshot;
+    result.owned = owned;
+    result.offset = offset + start;
+    result.numSamples = end - start;
+    return result;
+}
+
+bool WaveformClip::sharesSamplesWith(const WaveformClip& other) const
+{
+    if (offset != other.offset || numSamples != other.numSamples)
+        return false;
+    if (owned || other.owned)
+        return owned == other.owned;
+    if (snapshot == other.snapshot)
+        return true;
+    if (!snapshot || !other.snapshot
+        || snapshot->getNumTiles() != other.snapshot->getNumTiles())
+        return false;
+
+    const int firstTile = offset / RenderSnapshot::tileSize;
+    const int lastTile = (offset + numSamples - 1) / RenderSnapshot::tileSize;
+    for (int t = firstTile; t <= lastTile; ++t)
+        if (!snapshot->sharesTile(*other.snapshot, t))
+            return false;
+    return true;
+}
+
+MelClip::MelClip(std::shared_ptr<const HalfMelBuffer> sourceBuffer, size_t startFrame, size_t endFrame)
+{
+    if (!sourceBuffer)
+        return;
+
+    startFrame = std::min(startFrame, sourceBuffer->size());
+    endFrame = std::clamp(endFrame, startFrame, sourceBuffer->size());
+    if (endFrame == startFrame)
+        return;
+
+    source = std::move(sourceBuffer);
+    offset = startFrame;
+    numFrames = endFrame - startFrame;
+}
+
+MelBuffer MelClip::decode() const
+{
+    if (!source)
+        return {};
+    return source->decode(offset, offset + numFrames);
+}
+
+MelClip MelClip::slice(size_t start, size_t end) const
+{
+    start = std::min(start, numFrames);
+    end = std::clamp(end, start, numFrames);
+    return MelClip(source, offset + start, offset + end);
+}
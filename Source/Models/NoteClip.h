@@ -0,0 +1,89 @@
+#pragma once
+
+#include "../Utils/MelBuffer.h"
+#include "../Utils/RenderSnapshot.h"
+#include <memory>
+#include <vector>
+
+/**
+ * Mono sample range of a note, held by reference rather than by copy.
+ *
+ * A clip either views channel 0 of a RenderSnapshot (the project audio it
+ * was cut from) or owns samples that no longer exist anywhere else, e.g.
+ * after a time stretch. Both are shared between copies of the note (undo
+ * actions, project copies), and slicing never copies samples. Snapshot
+ * tiles are immutable, so a view keeps showing the original audio after
+ * the project waveform is resynthesized; only the tiles edits replaced stay
+ * alive on its behalf.
+ */
+class WaveformClip
+{
+public:
+    WaveformClip() = default;
+
+    /** Owned samples, for clips that diverged from the source audio. */
+    explicit WaveformClip(std::vector<float> samples);
+
+    /** View of source channel 0 over [startSample, endSample), clamped. */
+    WaveformClip(RenderSnapshot::Ptr source, int startSample, int endSample);
+
+    int size() const { return numSamples; }
+    bool empty() const { return numSamples == 0; }
+
+    float getSample(int index) const;
+    void read(int start, int count, float* dest) const;
+    std::vector<float> toVector() const;
+
+    /** Sub-range [start, end) sharing this clip's storage. */
+    WaveformClip slice(int start, int end) const;
+
+    /**
+     * True when both hold the same samples without comparing them: the same
+     * owned storage, or views of the same range whose snapshot tiles are
+     * shared. A resynthesis that left the range alone keeps a view current.
+     */
+    bool sharesSamplesWith(const WaveformClip& other) const;
+
+    /** Owned storage, or null for snapshot views; identifies owned clips. */
+    const void* getOwnedStorage() const { return owned.get(); }
+    /** First sample within the storage or snapshot. */
+    int getOffset() const { return offset; }
+
+    /** Bytes of owned samples; snapshot views own nothing. */
+    size_t getOwnedBytes() const { return owned ? owned->capacity() * sizeof(float) : 0; }
+
+private:
+    RenderSnapshot::Ptr snapshot;
+    std::shared_ptr<const std::vector<float>> owned;
+    int offset = 0;
+    int numSamples = 0;
+};
+
+/**
+ * Mel frame range of a note over a shared, immutable half-float mel buffer.
+ * Copies and slices share the buffer; decode() returns float32 frames.
+ */
+class MelClip
+{
+public:
+    MelClip() = default;
+
+    /** View of source frames [startFrame, endFrame), clamped. */
+    MelClip(std::shared_ptr<const HalfMelBuffer> source, size_t startFrame, size_t endFrame);
+
+    size_t size() const { return numFrames; }
+    bool empty() const { return numFrames == 0; }
+    MelBuffer decode() const;
+
+    MelClip slice(size_t start, size_t end) const;
+
+    /** The shared buffer, so memory accounting can count each once. */
+    const HalfMelBuffer* getSource() const { return source.get(); }
+    /** First frame within the source. */
+    size_t getOffset() const { return offset; }
+
+private:
+    std::shared_ptr<const HalfMelBuffer> source;
+    size_t offset = 0;
+    size_t numFrames = 0;
+};
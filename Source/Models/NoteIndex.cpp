@@ -0,0 +1,127 @@
+#include "NoteIndex.h"
+#include <algorithm>
+#include <cmath>
+
+void NoteIndex::IntervalList::sort()
+{
+    std::sort(entries.begin(), entries.end(),
+              [](const Entry& a, const Entry& b)
+              {
+                  if (a.startFrame != b.startFrame)
+                      return a.startFrame < b.startFrame;
+                  return a.noteIndex < b.noteIndex;
+              });
+    summarise();
+}
+
+void NoteIndex::IntervalList::summarise()
+{
+    maxEndFrame.resize(entries.size());
+    int runningMax = 0;
+    for (size_t i = 0; i < entries.size(); ++i)
+    {
+        runningMax = (i == 0) ? entries[i].endFrame : std::max(runningMax, entries[i].endFrame);
+        maxEndFrame[i] = runningMax;
+    }
+}
+
+template <typename Visit>
+void NoteIndex::IntervalList::forEachOverlapping(int startFrame, int endFrame, Visit&& visit) const
+{
+    // Every candidate starts before endFrame; walk back until nothing earlier
+    // can still reach past startFrame
+    auto upper = std::lower_bound(entries.begin(), entries.end(), endFrame,
+                                  [](const Entry& entry, int frame) { return entry.startFrame < frame; });
+
+    for (auto i = static_cast<int>(upper - entries.begin()) - 1; i >= 0; --i)
+    {
+        if (maxEndFrame[static_cast<size_t>(i)] <= startFrame)
+            break;
+        const auto& entry = entries[static_cast<size_t>(i)];
+        if (entry.endFrame > startFrame)
+            visit(entry);
+    }
+}
+
+void NoteIndex::rebuild(const std::vector<Note>& notes, const NoteRevisions& revisions)
+{
+    timeList.entries.clear();
+    timeList.entries.reserve(notes.size());
+    for (size_t i = 0; i < notes.size(); ++i)
+        timeList.entries.push_back({notes[i].getStartFrame(), notes[i].getEndFrame(), static_cast<int>(i)});
+    timeList.sort();
+
+    valid = true;
+    pitchValid = false;
+    builtData = notes.data();
+    builtSize = notes.size();
+    builtRevision = revisions.timing.load(std::memory_order_relaxed);
+}
+
+bool NoteIndex::isValidFor(const std::vector<Note>& notes, const NoteRevisions& revisions) const
+{
+    return valid && builtData == notes.data() && builtSize == notes.size()
+        && builtRevision == revisions.timing.load(std::memory_order_relaxed);
+}
+
+void NoteIndex::rebuildPitch(const std::vector<Note>& notes, const NoteRevisions& revisions)
+{
+    pitchLists.assign(numPitchBuckets, {});
+    for (const auto& entry : timeList.entries)
+    {
+        const float midi = notes[static_cast<size_t>(entry.noteIndex)].getAdjustedMidiNote();
+        const int bucket = std::clamp(static_cast<int>(std::floor(midi)), 0, numPitchBuckets - 1);
+        auto pitched = entry;
+        pitched.midi = midi;
+        pitchLists[static_cast<size_t>(bucket)].entries.push_back(pitched);
+    }
+    // Taken from the time list in order, so already sorted
+    for (auto& list : pitchLists)
+        list.summarise();
+
+    pitchValid = true;
+    builtPitchRevision = revisions.pitch.load(std::memory_order_relaxed);
+}
+
+bool NoteIndex::isPitchValidFor(const std::vector<Note>& notes, const NoteRevisions& revisions) const
+{
+    return isValidFor(notes, revisions) && pitchValid
+        && builtPitchRevision == revisions.pitch.load(std::memory_order_relaxed);
+}
+
+std::vector<int> NoteIndex::query(int startFrame, int endFrame) const
+{
+    std::vector<int> result;
+    if (startFrame >= endFrame)
+        return result;
+
+    timeList.forEachOverlapping(startFrame, endFrame,
+                                [&result](const Entry& entry) { result.push_back(entry.noteIndex); });
+
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+std::vector<int> NoteIndex::query(int startFrame, int endFrame, float minMidi, float maxMidi) const
+{
+    std::vector<int> result;
+    if (startFrame >= endFrame || minMidi > maxMidi || pitchLists.empty())
+        return result;
+
+    // Pitches outside 0..127 are kept in the end buckets
+    const int firstBucket = std::clamp(static_cast<int>(std::floor(minMidi)), 0, numPitchBuckets - 1);
+    const int lastBucket = std::clamp(static_cast<int>(std::floor(maxMidi)), 0, numPitchBuckets - 1);
+    for (int bucket = firstBucket; bucket <= lastBucket; ++bucket)
+    {
+        pitchLists[static_cast<size_t>(bucket)].forEachOverlapping(
+            startFrame, endFrame,
+            [&](const Entry& entry)
+            {
+                if (entry.midi >= minMidi && entry.midi <= maxMidi)
+                    result.push_back(entry.noteIndex);
+            });
+    }
+
+    std::sort(result.begin(), result.end());
+    return result;
+}
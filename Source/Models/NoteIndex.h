@@ -0,0 +1,81 @@
+#pragma once
+
+#include "Note.h"
+#include <cstdint>
+#include <vector>
+
+/**
+ * Sorted interval index over a project's notes.
+ *
+ * Entries are ordered by start frame with a running maximum of end frames,
+ * so range and point queries cost O(log n + k) for the (usual) case of
+ * non-overlapping notes instead of a scan over every note.
+ *
+ * The index refers to notes by position in the vector it was built from and
+ * records that vector's storage, size and timing revision (NoteRevisions,
+ * which the caller joins the notes to); once any of those change it reports
+ * itself stale and must be rebuilt.
+ *
+ * Time x pitch queries (box selection, hit tests) go through a second set of
+ * the same interval lists, one per semitone of adjusted MIDI note. It is
+ * built on first use and rebuilt after the pitch revision changes, so
+ * pitch drags do not invalidate the time index the views draw from.
+ */
+class NoteIndex
+{
+public:
+    void rebuild(const std::vector<Note>& notes, const NoteRevisions& revisions);
+    void invalidate() { valid = false; pitchValid = false; }
+    bool isValidFor(const std::vector<Note>& notes, const NoteRevisions& revisions) const;
+
+    // Only on an index valid for notes
+    void rebuildPitch(const std::vector<Note>& notes, const NoteRevisions& revisions);
+    bool isPitchValidFor(const std::vector<Note>& notes, const NoteRevisions& revisions) const;
+
+    /**
+     * Positions of notes overlapping [startFrame, endFrame), ascending
+     * (i.e. in vector order).
+     */
+    std::vector<int> query(int startFrame, int endFrame) const;
+
+    /**
+     * Positions of notes overlapping [startFrame, endFrame) whose adjusted
+     * MIDI note is within [minMidi, maxMidi], ascending. Needs the pitch
+     * lists (see rebuildPitch()).
+     */
+    std::vector<int> query(int startFrame, int endFrame, float minMidi, float maxMidi) const;
+
+private:
+    struct Entry
+    {
+        int startFrame = 0;
+        int endFrame = 0;
+        int noteIndex = 0;
+        float midi = 0.0f; // Pitch lists only
+    };
+
+    // Entries sorted by startFrame, with maxEndFrame[i] the largest end of
+    // entries[0..i]
+    struct IntervalList
+    {
+        std::vector<Entry> entries;
+        std::vector<int> maxEndFrame;
+
+        void sort(); // Then summarise()
+        void summarise();
+        template <typename Visit>
+        void forEachOverlapping(int startFrame, int endFrame, Visit&& visit) const;
+    };
+
+    static constexpr int numPitchBuckets = 128; // Semitones 0..127
+
+    IntervalList timeList;
+    std::vector<IntervalList> pitchLists; // By floor(adjusted MIDI note)
+
+    bool valid = false;
+    const Note* builtData = nullptr;
+    size_t builtSize = 0;
+    uint32_t builtRevision = 0;
+    bool pitchValid = false;
+    uint32_t builtPitchRevision = 0;
+};
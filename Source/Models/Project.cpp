@@ -1,36 +1,312 @@
 #include "Project.h"
 #include "../Utils/Constants.h"
-#include "../Utils/PitchCurveProcessor.h"
+#include "../Utils/PitchConversion.h"
+#include "../Utils/Tracing.h"
 #include <algorithm>
 #include <cmath>
+#include <unordered_set>
 
 namespace
 {
     constexpr float twoPi = 6.2831853071795864769f;
 }
 
+AudioData::AudioData(const AudioData& other)
+    : sampleRate(other.sampleRate), sessionSampleRate(other.sessionSampleRate),
+      melSpectrogram(other.melSpectrogram), f0(other.f0),
+      baseF0(other.baseF0), basePitch(other.basePitch), deltaPitch(other.deltaPitch),
+      voicedMask(other.voicedMask), renderSnapshot(std::atomic_load(&other.renderSnapshot)),
+      curveSnapshot(other.curveSnapshot)
+{
+    // AudioBuffer's own copy would refer to a paged waveform's mapping
+    if (other.isWaveformShared())
+        shareWaveform(other.waveformBlock);
+    else
+        waveform.makeCopyOf(other.waveform);
+}
+
+AudioData& AudioData::operator=(const AudioData& other)
+{
+    if (this == &other)
+        return *this;
+
+    if (other.isWaveformShared())
+    {
+        shareWaveform(other.waveformBlock);
+    }
+    else
+    {
+        // A paged destination of the same shape is written in place; a
+        // shared one never is
+        if (isWaveformShared())
+            waveform = juce::AudioBuffer<float>();
+        waveformBlock.reset();
+        waveform.makeCopyOf(other.waveform, /*avoidReallocating=*/true);
+        if (!isWaveformPaged())
+            waveformPages.reset();
+    }
+    sampleRate = other.sampleRate;
+    sessionSampleRate = other.sessionSampleRate;
+    melSpectrogram = other.melSpectrogram;
+    f0 = other.f0;
+    baseF0 = other.baseF0;
+    basePitch = other.basePitch;
+    deltaPitch = other.deltaPitch;
+    voicedMask = other.voicedMask;
+    std::atomic_store(&renderSnapshot, std::atomic_load(&other.renderSnapshot));
+    curveSnapshot = other.curveSnapshot;
+    return *this;
+}
+
+void AudioData::setSourceAudio(const juce::AudioBuffer<float>& source, int sourceSampleRate)
+{
+    setSourceAudio(juce::AudioBuffer<float>(source), sourceSampleRate);
+}
+
+void AudioData::setSourceAudio(juce::AudioBuffer<float>&& source, int sourceSampleRate)
+{
+    sampleRate = sourceSampleRate;
+    if (source.getNumChannels() == 0)
+    {
+        source.setSize(1, source.getNumSamples());
+        source.clear();
+    }
+    if (source.getNumSamples() == 0)
+    {
+        waveform = juce::AudioBuffer<float>(1, 0);
+        waveformPages.reset();
+        waveformBlock.reset();
+        std::atomic_store(&renderSnapshot, RenderSnapshot::Ptr());
+        return;
+    }
+
+    // Both read the one block: the waveform its channel 0, the snapshot
+    // every channel
+    auto block = std::make_shared<const juce::AudioBuffer<float>>(std::move(source));
+    shareWaveform(block);
+    std::atomic_store(&renderSnapshot, RenderSnapshot::sharing(std::move(block), sampleRate));
+}
+
+void AudioData::shareWaveform(std::shared_ptr<const juce::AudioBuffer<float>> block)
+{
+    auto* samples = const_cast<float*>(block->getReadPointer(0));
+    waveform.setDataToReferTo(&samples, 1, block->getNumSamples());
+    waveformPages.reset();
+    waveformBlock = std::move(block);
+}
+
+bool AudioData::isWaveformShared() const
+{
+    // As with paging, a resize gives the buffer memory of its own again
+    return waveformBlock && waveform.getNumChannels() > 0 && waveform.getNumSamples() > 0
+        && waveform.getReadPointer(0) == waveformBlock->getReadPointer(0);
+}
+
+void AudioData::prepareWaveformWrite()
+{
+    if (!isWaveformShared())
+        return;
+
+    juce::AudioBuffer<float> own;
+    own.makeCopyOf(waveform);
+    waveform = std::move(own);
+    waveformBlock.reset();
+}
+
+RenderSnapshot::Ptr AudioData::getRenderSnapshot() const
+{
+    // A snapshot may have more channels than the waveform: the recording's
+    // layout, with the edited ranges fanned out
+    auto snapshot = std::atomic_load(&renderSnapshot);
+    if (snapshot && snapshot->getNumSamples() == waveform.getNumSamples()
+        && snapshot->getNumChannels() >= waveform.getNumChannels()
+        && snapshot->getSampleRate() == sampleRate)
+        return snapshot;
+
+    // First use, or the waveform was replaced wholesale
+    snapshot = RenderSnapshot::fromBuffer(waveform, sampleRate);
+    std::atomic_store(&renderSnapshot, snapshot);
+    return snapshot;
+}
+
+void AudioData::updateRenderSnapshot(const std::vector<std::pair<int, int>>& sampleRanges)
+{
+    auto snapshot = std::atomic_load(&renderSnapshot);
+    if (!snapshot || snapshot->getSampleRate() != sampleRate)
+        return; // Built lazily from the current waveform on next read
+
+    std::atomic_store(&renderSnapshot, snapshot->withRanges(waveform, sampleRanges));
+}
+
+void AudioData::restoreRender(RenderSnapshot::Ptr snapshot)
+{
+    if (!snapshot)
+        return;
+
+    const int numSamples = snapshot->getNumSamples();
+    sampleRate = snapshot->getSampleRate();
+    auto block = snapshot->getSharedBuffer();
+    if (block && numSamples > 0)
+    {
+        // Unedited since it was made: nothing to copy
+        shareWaveform(std::move(block));
+    }
+    else
+    {
+        // A paged waveform of the same length is written in place; a
+        // shared one never is
+        if (isWaveformShared())
+            waveform = juce::AudioBuffer<float>();
+        waveformBlock.reset();
+        if (waveform.getNumChannels() != 1 || waveform.getNumSamples() != numSamples)
+        {
+            waveform.setSize(1, numSamples, false, false, true);
+            waveformPages.reset();
+        }
+        if (numSamples > 0)
+            snapshot->read(0, 0, numSamples, waveform.getWritePointer(0));
+    }
+    std::atomic_store(&renderSnapshot, std::move(snapshot));
+}
+
+CurveSnapshot::Ptr AudioData::getCurveSnapshot() const
+{
+    curveSnapshot = CurveSnapshot::update(curveSnapshot, f0, voicedMask, melSpectrogram.view());
+    return curveSnapshot;
+}
+
+size_t AudioData::getSnapshotMemoryBytes(const RenderSnapshot& snapshot) const
+{
+    // Tiles shared with the waveform are counted once, as waveform memory
+    const size_t shared = isWaveformShared() ? snapshot.getSharedBytes() : 0;
+    return snapshot.getNumBytes() - snapshot.getPagedBytes() - shared;
+}
+
+size_t AudioData::getRenderSnapshotBytes() const
+{
+    auto snapshot = std::atomic_load(&renderSnapshot);
+    const size_t curveBytes = curveSnapshot ? curveSnapshot->getNumBytes() : 0;
+    return curveBytes + (snapshot ? getSnapshotMemoryBytes(*snapshot) : 0);
+}
+
+size_t AudioData::pageRenderSnapshot()
+{
+    auto snapshot = std::atomic_load(&renderSnapshot);
+    if (!snapshot)
+        return 0;
+    auto paged = snapshot->paged();
+    if (!paged)
+        return 0;
+
+    // Readers holding the old snapshot keep its memory tiles until they let go
+    const size_t freed = getSnapshotMemoryBytes(*snapshot) - getSnapshotMemoryBytes(*paged);
+    std::atomic_store(&renderSnapshot, std::move(paged));
+    return freed;
+}
+
+size_t AudioData::pageWaveform()
+{
+    const int numChannels = waveform.getNumChannels();
+    const int numSamples = waveform.getNumSamples();
+    if (numChannels <= 0 || numSamples <= 0 || isWaveformPaged())
+        return 0;
+
+    const size_t bytes = static_cast<size_t>(numChannels) * static_cast<size_t>(numSamples) * sizeof(float);
+    // Shared samples stay in memory while a render snapshot refers to them
+    const bool freesMemory = !isWaveformShared() || waveformBlock.use_count() == 1;
+    auto pages = ScratchMapping::create(bytes);
+    if (!pages)
+        return 0;
+
+    auto* next = static_cast<float*>(pages->getData());
+    std::vector<float*> channels(static_cast<size_t>(numChannels));
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        channels[static_cast<size_t>(ch)] = next;
+        std::copy_n(waveform.getReadPointer(ch), numSamples, next);
+        next += numSamples;
+    }
+    waveform.setDataToReferTo(channels.data(), numChannels, numSamples);
+    waveformPages = std::move(pages);
+    waveformBlock.reset();
+    return freesMemory ? bytes : 0;
+}
+
+size_t AudioData::pageMel()
+{
+    const size_t bytes = melSpectrogram.getNumBytes();
+    return melSpectrogram.pageOut() ? bytes : 0;
+}
+
+bool AudioData::isWaveformPaged() const
+{
+    // A resize gives the buffer memory of its own again
+    return waveformPages && waveform.getNumChannels() > 0 && waveform.getNumSamples() > 0
+        && waveformPages->contains(waveform.getReadPointer(0));
+}
+
+size_t AudioData::getPagedBytes() const
+{
+    size_t bytes = melSpectrogram.getPagedBytes();
+    if (isWaveformPaged())
+        bytes += static_cast<size_t>(waveform.getNumChannels())
+               * static_cast<size_t>(waveform.getNumSamples()) * sizeof(float);
+    if (auto snapshot = std::atomic_load(&renderSnapshot))
+        bytes += snapshot->getPagedBytes();
+    return bytes;
+}
+
 Project::Project()
 {
 }
 
-Note* Project::getNoteAtFrame(int frame)
+void Project::joinNoteRevisions() const
 {
-    for (auto& note : notes)
+    for (const auto& note : notes)
+        note.joinRevisions(noteRevisions);
+}
+
+const NoteIndex& Project::getNoteIndex() const
+{
+    if (!noteIndex.isValidFor(notes, *noteRevisions))
     {
-        if (note.containsFrame(frame))
-            return &note;
+        joinNoteRevisions();
+        noteIndex.rebuild(notes, *noteRevisions);
     }
-    return nullptr;
+    return noteIndex;
+}
+
+Note* Project::getNoteAtFrame(int frame)
+{
+    const auto hits = getNoteIndex().query(frame, frame + 1);
+    return hits.empty() ? nullptr : &notes[static_cast<size_t>(hits.front())];
 }
 
 std::vector<Note*> Project::getNotesInRange(int startFrame, int endFrame)
 {
     std::vector<Note*> result;
-    for (auto& note : notes)
-    {
-        if (note.getStartFrame() < endFrame && note.getEndFrame() > startFrame)
-            result.push_back(&note);
-    }
+    for (int index : getNoteIndex().query(startFrame, endFrame))
+        result.push_back(&notes[static_cast<size_t>(index)]);
+    return result;
+}
+
+std::vector<const Note*> Project::getNotesInRange(int startFrame, int endFrame) const
+{
+    std::vector<const Note*> result;
+    for (int index : getNoteIndex().query(startFrame, endFrame))
+        result.push_back(&notes[static_cast<size_t>(index)]);
+    return result;
+}
+
+std::vector<Note*> Project::getNotesInRect(int startFrame, int endFrame, float minMidi, float maxMidi)
+{
+    getNoteIndex();
+    if (!noteIndex.isPitchValidFor(notes, *noteRevisions))
+        noteIndex.rebuildPitch(notes, *noteRevisions);
+
+    std::vector<Note*> result;
+    for (int index : noteIndex.query(startFrame, endFrame, minMidi, maxMidi))
+        result.push_back(&notes[static_cast<size_t>(index)]);
     return result;
 }
 
@@ -45,19 +321,178 @@ std::vector<Note*> Project::getSelectedNotes()
     return result;
 }
 
+NoteId Project::addNote(Note note)
+{
+    NoteId id = note.getId();
+    if (id == 0 || findNote(id) != nullptr)
+        id = nextNoteId++;
+    else
+        nextNoteId = std::max(nextNoteId, id + 1);
+    note.setId(id);
+
+    const NoteChange change { NoteChange::Type::Added, id, note.getStartFrame(), note.getEndFrame() };
+    notes.push_back(std::move(note));
+    notePositions[id] = notes.size() - 1;
+    noteIndex.invalidate();
+    postNoteChange(change);
+    return id;
+}
+
+void Project::clearNotes()
+{
+    notes.clear();
+    notePositions.clear();
+    noteIndex.invalidate();
+    postNoteChange({ NoteChange::Type::Reset });
+}
+
+void Project::invalidateNoteIndex()
+{
+    noteIndex.invalidate();
+    assignNoteIds();
+    postNoteChange({ NoteChange::Type::Reset });
+}
+
+void Project::assignNoteIds()
+{
+    for (const auto& note : notes)
+        nextNoteId = std::max(nextNoteId, note.getId() + 1);
+
+    std::unordered_set<NoteId> seen;
+    seen.reserve(notes.size());
+    for (auto& note : notes)
+    {
+        if (note.getId() == 0 || !seen.insert(note.getId()).second)
+        {
+            note.setId(nextNoteId++);
+            seen.insert(note.getId());
+        }
+    }
+    rebuildNotePositions();
+}
+
+void Project::rebuildNotePositions() const
+{
+    notePositions.clear();
+    notePositions.reserve(notes.size());
+    for (size_t i = 0; i < notes.size(); ++i)
+        notePositions.emplace(notes[i].getId(), i);
+}
+
+NoteId Project::getNoteId(Note& note)
+{
+    if (note.getId() == 0)
+    {
+        for (const auto& other : notes)
+            nextNoteId = std::max(nextNoteId, other.getId() + 1);
+        note.setId(nextNoteId++);
+        notePositions.clear();
+    }
+    return note.getId();
+}
+
+const Note* Project::findNote(NoteId id) const
+{
+    if (id == 0)
+        return nullptr;
+
+    auto lookup = [this, id]() -> const Note* {
+        auto it = notePositions.find(id);
+        if (it == notePositions.end() || it->second >= notes.size()
+            || notes[it->second].getId() != id)
+            return nullptr;
+        return &notes[it->second];
+    };
+
+    if (const auto* note = lookup())
+        return note;
+    rebuildNotePositions();
+    return lookup();
+}
+
+Note* Project::findNote(NoteId id)
+{
+    return const_cast<Note*>(static_cast<const Project&>(*this).findNote(id));
+}
+
+bool Project::removeNote(NoteId id)
+{
+    const auto* note = findNote(id);
+    if (!note)
+        return false;
+
+    const NoteChange change { NoteChange::Type::Removed, id, note->getStartFrame(), note->getEndFrame() };
+    notes.erase(notes.begin() + (note - notes.data()));
+    notePositions.clear();
+    noteIndex.invalidate();
+    postNoteChange(change);
+    return true;
+}
+
 bool Project::removeNoteByStartFrame(int startFrame)
 {
     for (auto it = notes.begin(); it != notes.end(); ++it)
     {
         if (it->getStartFrame() == startFrame)
         {
+            const NoteChange change { NoteChange::Type::Removed, it->getId(), it->getStartFrame(), it->getEndFrame() };
             notes.erase(it);
+            notePositions.clear();
+            noteIndex.invalidate();
+            postNoteChange(change);
             return true;
         }
     }
     return false;
 }
 
+void Project::noteChanged(const Note& note)
+{
+    noteChanged(note, note.getStartFrame(), note.getEndFrame());
+}
+
+void Project::noteChanged(const Note& note, int oldStartFrame, int oldEndFrame)
+{
+    postNoteChange({ NoteChange::Type::Changed, note.getId(),
+                       std::min(oldStartFrame, note.getStartFrame()),
+                       std::max(oldEndFrame, note.getEndFrame()) });
+}
+
+void Project::postNoteChange(const NoteChange& change)
+{
+    noteSnapshotStale = true;
+    noteChanges.post(change);
+}
+
+std::shared_ptr<const std::vector<Note>> Project::getNoteSnapshot() const
+{
+    const uint32_t timingRevision = noteRevisions->timing.load(std::memory_order_relaxed);
+    const uint32_t pitchRevision = noteRevisions->pitch.load(std::memory_order_relaxed);
+    if (noteSnapshot != nullptr && !noteSnapshotStale
+        && noteSnapshotTimingRevision == timingRevision
+        && noteSnapshotPitchRevision == pitchRevision
+        && noteSnapshot->size() == notes.size())
+        return noteSnapshot;
+
+    joinNoteRevisions();
+    noteSnapshot = std::make_shared<const std::vector<Note>>(notes);
+    noteSnapshotStale = false;
+    noteSnapshotTimingRevision = timingRevision;
+    noteSnapshotPitchRevision = pitchRevision;
+    return noteSnapshot;
+}
+
+ProjectSnapshot Project::getSnapshot() const
+{
+    ProjectSnapshot snapshot;
+    snapshot.audio = audioData.getRenderSnapshot();
+    snapshot.curves = audioData.getCurveSnapshot();
+    snapshot.notes = getNoteSnapshot();
+    snapshot.globalPitchOffset = globalPitchOffset;
+    snapshot.formantShift = formantShift;
+    return snapshot;
+}
+
 void Project::deselectAllNotes()
 {
     for (auto& note : notes)
@@ -89,9 +524,8 @@ void Project::clearAllDirty()
 {
     for (auto& note : notes)
         note.clearDirty();
-    // Also clear F0 dirty range
-    f0DirtyStart = -1;
-    f0DirtyEnd = -1;
+    // Also clear F0 dirty ranges
+    f0DirtyRanges.clear();
 }
 
 bool Project::hasDirtyNotes() const
@@ -106,94 +540,81 @@ bool Project::hasDirtyNotes() const
 
 void Project::setF0DirtyRange(int startFrame, int endFrame)
 {
-    if (f0DirtyStart < 0 || startFrame < f0DirtyStart)
-        f0DirtyStart = startFrame;
-    if (f0DirtyEnd < 0 || endFrame > f0DirtyEnd)
-        f0DirtyEnd = endFrame;
+    if (endFrame < startFrame)
+        std::swap(startFrame, endFrame);
+    addDirtyRange(f0DirtyRanges, startFrame, endFrame);
+    curveChanges.post({ NoteChange::Type::Changed, 0, startFrame, endFrame });
 }
 
 void Project::clearF0DirtyRange()
 {
-    f0DirtyStart = -1;
-    f0DirtyEnd = -1;
+    f0DirtyRanges.clear();
 }
 
 bool Project::hasF0DirtyRange() const
 {
-    return f0DirtyStart >= 0 && f0DirtyEnd >= 0;
+    return !f0DirtyRanges.empty();
 }
 
 std::pair<int, int> Project::getF0DirtyRange() const
 {
-    return {f0DirtyStart, f0DirtyEnd};
+    if (f0DirtyRanges.empty())
+        return {-1, -1};
+    return {f0DirtyRanges.front().first, f0DirtyRanges.back().second};
 }
 
-std::pair<int, int> Project::getDirtyFrameRange() const
+std::vector<std::pair<int, int>> Project::getDirtyFrameRanges() const
 {
-    int minStart = -1;
-    int maxEnd = -1;
-    
-    // Check dirty notes
+    auto ranges = f0DirtyRanges;
     for (const auto& note : notes)
     {
         if (note.isDirty())
-        {
-            if (minStart < 0 || note.getStartFrame() < minStart)
-                minStart = note.getStartFrame();
-            if (maxEnd < 0 || note.getEndFrame() > maxEnd)
-                maxEnd = note.getEndFrame();
-        }
+            addDirtyRange(ranges, note.getStartFrame(), note.getEndFrame());
     }
-    
-    // Also include F0 dirty range from Draw mode edits
-    if (f0DirtyStart >= 0)
-    {
-        if (minStart < 0 || f0DirtyStart < minStart)
-            minStart = f0DirtyStart;
-    }
-    if (f0DirtyEnd >= 0)
-    {
-        if (maxEnd < 0 || f0DirtyEnd > maxEnd)
-            maxEnd = f0DirtyEnd;
-    }
-    
-    return {minStart, maxEnd};
+    return ranges;
 }
 
-std::vector<float> Project::getAdjustedF0() const
+std::vector<std::pair<int, int>> Project::getDirtyFrameRangesWith(int startFrame, int endFrame) const
 {
-    if (audioData.basePitch.empty() || audioData.deltaPitch.empty())
-        return {};
+    auto ranges = getDirtyFrameRanges();
+    if (startFrame < endFrame)
+        addDirtyRange(ranges, startFrame, endFrame);
+    return ranges;
+}
+
+std::pair<int, int> Project::getDirtyFrameRange() const
+{
+    auto ranges = getDirtyFrameRanges();
+    if (ranges.empty())
+        return {-1, -1};
+    return {ranges.front().first, ranges.back().second};
+}
 
-    // Compose base + delta with UV applied and global offset
-    std::vector<float> adjustedF0 = PitchCurveProcessor::composeF0(*this,
-                                                                   /*applyUvMask=*/true,
-                                                                   globalPitchOffset);
+void Project::addDirtyRange(std::vector<std::pair<int, int>>& ranges, int startFrame, int endFrame)
+{
+    // Keep ranges sorted and disjoint; touching ranges are merged
+    auto it = std::lower_bound(ranges.begin(), ranges.end(), startFrame,
+                               [](const std::pair<int, int>& range, int frame) { return range.second < frame; });
 
-    // Apply vibrato per note on top of composed curve
-    for (const auto& note : notes)
+    auto last = it;
+    while (last != ranges.end() && last->first <= endFrame)
     {
-        const bool hasVibrato = note.isVibratoEnabled() &&
-                                note.getVibratoDepthSemitones() > 0.0001f &&
-                                note.getVibratoRateHz() > 0.0001f;
-        if (!hasVibrato)
-            continue;
-
-        const int start = std::max(0, note.getStartFrame());
-        const int end = std::min(note.getEndFrame(), static_cast<int>(adjustedF0.size()));
+        startFrame = std::min(startFrame, last->first);
+        endFrame = std::max(endFrame, last->second);
+        ++last;
+    }
 
-        for (int i = start; i < end; ++i)
-        {
-            if (i < static_cast<int>(audioData.voicedMask.size()) && !audioData.voicedMask[i])
-                continue;
+    it = ranges.erase(it, last);
+    ranges.insert(it, {startFrame, endFrame});
+}
 
-            float vib = note.getVibratoDepthSemitones() *
-                        std::sin(twoPi * note.getVibratoRateHz() * framesToSeconds(i - start) +
-                                 note.getVibratoPhaseRadians());
-            adjustedF0[static_cast<size_t>(i)] *= std::pow(2.0f, vib / 12.0f);
-        }
-    }
+std::vector<float> Project::getAdjustedF0() const
+{
+    if (audioData.basePitch.empty() || audioData.deltaPitch.empty())
+        return {};
 
+    std::vector<float> adjustedF0(audioData.basePitch.size());
+    getAdjustedF0ForRange(0, static_cast<int>(adjustedF0.size()), adjustedF0.data());
     return adjustedF0;
 }
 
@@ -209,24 +630,41 @@ std::vector<float> Project::getAdjustedF0ForRange(int startFrame, int endFrame)
     if (startFrame >= endFrame)
         return {};
 
-    const int rangeSize = endFrame - startFrame;
-    std::vector<float> adjustedF0(static_cast<size_t>(rangeSize), 0.0f);
+    std::vector<float> adjustedF0(static_cast<size_t>(endFrame - startFrame));
+    getAdjustedF0ForRange(startFrame, endFrame, adjustedF0.data());
+    return adjustedF0;
+}
 
-    for (int i = 0; i < rangeSize; ++i)
-    {
-        const int globalIdx = startFrame + i;
-        const float base = audioData.basePitch[static_cast<size_t>(globalIdx)];
-        const float delta = (globalIdx < static_cast<int>(audioData.deltaPitch.size()))
-                                ? audioData.deltaPitch[static_cast<size_t>(globalIdx)]
-                                : 0.0f;
-        float midi = base + delta + globalPitchOffset;
-        float freq = midiToFreq(midi);
-        if (globalIdx < static_cast<int>(audioData.voicedMask.size()) && !audioData.voicedMask[globalIdx])
-            freq = 0.0f;
-        adjustedF0[static_cast<size_t>(i)] = freq;
-    }
+void Project::getAdjustedF0ForRange(int startFrame, int endFrame, float* out) const
+{
+    getAdjustedF0ForRange(startFrame, endFrame, audioData.basePitch.data() + startFrame, out);
+}
 
-    // Apply vibrato for overlapping notes
+void Project::getAdjustedF0ForRange(int startFrame, int endFrame, const float* basePitch,
+                                    float* out) const
+{
+    TRACE_ZONE("Project::getAdjustedF0ForRange");
+    // Frames past the delta curve have no delta; frames past the mask count
+    // as voiced. Splitting the loops there keeps them free of branches.
+    const int deltaEnd = std::clamp(static_cast<int>(audioData.deltaPitch.size()), startFrame, endFrame);
+    const int maskEnd = std::clamp(static_cast<int>(audioData.voicedMask.size()), startFrame, endFrame);
+    const float* base = basePitch - startFrame;
+    const float* delta = audioData.deltaPitch.data();
+
+    for (int i = startFrame; i < deltaEnd; ++i)
+        out[i - startFrame] = base[i] + delta[i] + globalPitchOffset;
+    for (int i = deltaEnd; i < endFrame; ++i)
+        out[i - startFrame] = base[i] + globalPitchOffset;
+    PitchConversion::midiToFreq(out, out, endFrame - startFrame);
+
+    // Unvoiced frames are zeroed by multiplying with the mask bit
+    for (int i = startFrame; i < maskEnd; ++i)
+        out[i - startFrame] *= static_cast<float>(audioData.voicedMask[static_cast<size_t>(i)]);
+
+    // Vibrato for overlapping notes. The sine advances by rotating a phasor
+    // one frame at a time rather than calling sin() per frame, and unvoiced
+    // frames are 0 Hz already, so they are scaled along with the rest.
+    constexpr double secondsPerFrame = static_cast<double>(HOP_SIZE) / SAMPLE_RATE;
     for (const auto& note : notes)
     {
         const bool hasVibrato = note.isVibratoEnabled() &&
@@ -237,20 +675,26 @@ std::vector<float> Project::getAdjustedF0ForRange(int startFrame, int endFrame)
 
         const int overlapStart = std::max(note.getStartFrame(), startFrame);
         const int overlapEnd = std::min(note.getEndFrame(), endFrame);
-        for (int frame = overlapStart; frame < overlapEnd; ++frame)
+        if (overlapStart >= overlapEnd)
+            continue;
+
+        const double step = twoPi * note.getVibratoRateHz() * secondsPerFrame;
+        const double phase = step * (overlapStart - note.getStartFrame()) + note.getVibratoPhaseRadians();
+        const double cosStep = std::cos(step);
+        const double sinStep = std::sin(step);
+        double sinPhase = std::sin(phase);
+        double cosPhase = std::cos(phase);
+        const float depthOctaves = note.getVibratoDepthSemitones() / 12.0f;
+
+        float* noteOut = out + (overlapStart - startFrame);
+        for (int i = 0; i < overlapEnd - overlapStart; ++i)
         {
-            const int localIdx = frame - startFrame;
-            if (frame < static_cast<int>(audioData.voicedMask.size()) && !audioData.voicedMask[frame])
-                continue;
-
-            float vib = note.getVibratoDepthSemitones() *
-                        std::sin(twoPi * note.getVibratoRateHz() * framesToSeconds(frame - note.getStartFrame()) +
-                                 note.getVibratoPhaseRadians());
-            adjustedF0[static_cast<size_t>(localIdx)] *= std::pow(2.0f, vib / 12.0f);
+            noteOut[i] *= std::exp2(depthOctaves * static_cast<float>(sinPhase));
+            const double nextSin = sinPhase * cosStep + cosPhase * sinStep;
+            cosPhase = cosPhase * cosStep - sinPhase * sinStep;
+            sinPhase = nextSin;
         }
     }
-
-    return adjustedF0;
 }
 
 void Project::setLoopRange(double startSeconds, double endSeconds)
@@ -282,3 +726,30 @@ void Project::clearLoopRange()
 {
     loopRange = {};
 }
+
+ProjectMemoryReport Project::getMemoryReport() const
+{
+    auto floatBytes = [](const std::vector<float>& v) { return v.capacity() * sizeof(float); };
+
+    ProjectMemoryReport report;
+    if (!audioData.isWaveformPaged())
+        report.waveformBytes = static_cast<size_t>(audioData.waveform.getNumChannels())
+                             * static_cast<size_t>(audioData.waveform.getNumSamples()) * sizeof(float);
+    report.pagedBytes = audioData.getPagedBytes();
+    report.snapshotBytes = audioData.getRenderSnapshotBytes();
+    report.melBytes = audioData.melSpectrogram.getNumBytes();
+    report.pitchCurveBytes = floatBytes(audioData.f0) + floatBytes(audioData.baseF0)
+                           + floatBytes(audioData.basePitch) + floatBytes(audioData.deltaPitch)
+                           + audioData.voicedMask.getNumBytes();
+
+    // Note mel clips share one buffer per analysis pass; count each once
+    std::unordered_set<const HalfMelBuffer*> melSources;
+    for (const auto& note : notes)
+    {
+        report.noteBytes += note.getMemoryBytes();
+        const auto* source = note.getClipMel().getSource();
+        if (source && melSources.insert(source).second)
+            report.melBytes += source->getNumBytes();
+    }
+    return report;
+}
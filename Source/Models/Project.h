@@ -2,24 +2,45 @@
 
 #include "../JuceHeader.h"
 #include "Note.h"
+#include "NoteChangeFeed.h"
+#include "NoteIndex.h"
+#include "../Utils/CurveSnapshot.h"
+#include "../Utils/MelBuffer.h"
+#include "../Utils/RenderSnapshot.h"
+#include "../Utils/ScratchMapping.h"
+#include "../Utils/VoicedMask.h"
 #include <vector>
 #include <memory>
+#include <unordered_map>
+#include <utility>
 
 /**
  * Container for audio data and extracted features.
  */
 struct AudioData
 {
-    juce::AudioBuffer<float> waveform;
-    int sampleRate = 44100;
+    AudioData() = default;
+    // Copies hold the waveform and mel in memory even when these are paged,
+    // so writing to a copy never touches this one's scratch mapping; a
+    // shared waveform stays shared
+    AudioData(const AudioData& other);
+    AudioData& operator=(const AudioData& other);
+    AudioData(AudioData&&) = default;
+    AudioData& operator=(AudioData&&) = default;
+
+    juce::AudioBuffer<float> waveform;  // Channel 0 of the source; see setSourceAudio()
+    int sampleRate = 44100;             // Model rate the waveform is stored at
+    // Rate of the imported material, which exports default to; the render
+    // is converted back to it once, on the way out
+    int sessionSampleRate = 44100;
     
     // Extracted features
-    std::vector<std::vector<float>> melSpectrogram;  // [T, NUM_MELS]
+    MelBuffer melSpectrogram;                         // [T, NUM_MELS]
     std::vector<float> f0;                            // [T] (composed: base + delta, dense)
     std::vector<float> baseF0;                        // [T] (cached base pitch in Hz)
     std::vector<float> basePitch;                     // [T] base pitch in MIDI (dense)
     std::vector<float> deltaPitch;                    // [T] delta pitch in MIDI (dense)
-    std::vector<bool> voicedMask;                     // [T] uv mask (true = voiced)
+    VoicedMask voicedMask;                            // [T] uv mask (true = voiced)
     
     float getDuration() const
     {
@@ -31,6 +52,83 @@ struct AudioData
     {
         return static_cast<int>(melSpectrogram.size());
     }
+
+    /**
+     * Replace the audio with a recording of any channel count. The waveform
+     * becomes its channel 0, which analysis and synthesis work on, and the
+     * render snapshot starts out with every channel. Ranges published
+     * later are stored once and played on all channels; the rest keeps
+     * playing as recorded.
+     *
+     * The waveform and the render snapshot share the source's samples
+     * until the first edit; the rvalue overload takes them without a copy.
+     */
+    void setSourceAudio(const juce::AudioBuffer<float>& source, int sourceSampleRate);
+    void setSourceAudio(juce::AudioBuffer<float>&& source, int sourceSampleRate);
+
+    /**
+     * Immutable tiled copy of waveform for readers on other threads, with
+     * the channel layout of the source audio. Built on first use; call
+     * prepareWaveformWrite() before writing samples in place and
+     * updateRenderSnapshot() after, so only the touched tiles are re-copied.
+     */
+    RenderSnapshot::Ptr getRenderSnapshot() const;
+    void updateRenderSnapshot(const std::vector<std::pair<int, int>>& sampleRanges);
+
+    /**
+     * Give the waveform memory of its own if it still refers to samples
+     * shared with render snapshots, which must never change. Copies the
+     * waveform once; a no-op afterwards.
+     */
+    void prepareWaveformWrite();
+
+    /**
+     * Put back a render taken from getRenderSnapshot() earlier: the waveform
+     * becomes its channel 0 and readers get the snapshot itself again, its
+     * tiles shared rather than re-copied. An unedited render shares its
+     * samples with the waveform again.
+     */
+    void restoreRender(RenderSnapshot::Ptr snapshot);
+
+    /**
+     * Immutable chunked copy of f0, voicedMask and melSpectrogram for
+     * renders on other threads. Re-copies only the chunks that changed
+     * since the last call, and returns the same snapshot when none did;
+     * call on the thread that edits the curves.
+     */
+    CurveSnapshot::Ptr getCurveSnapshot() const;
+
+    // Bytes held by the current snapshots in memory, 0 if none has been
+    // built yet; getPagedBytes() counts the render snapshot's paged tiles
+    size_t getRenderSnapshotBytes() const;
+
+    /**
+     * Out-of-core mode for very long recordings: move the render snapshot
+     * tiles, the waveform or the mel spectrogram to scratch file mappings
+     * (see ScratchMapping) and free their memory. Message thread, and not
+     * while synthesis or analysis may be using the project. Each returns
+     * the bytes freed, 0 if already paged or no mapping could be made.
+     * Edits work unchanged; resizing the waveform or mel brings it back
+     * into memory.
+     */
+    size_t pageRenderSnapshot();
+    size_t pageWaveform();
+    size_t pageMel();
+
+    bool isWaveformPaged() const;
+    bool isWaveformShared() const;
+    size_t getPagedBytes() const;
+
+private:
+    // Let the waveform refer to channel 0 of an immutable buffer
+    void shareWaveform(std::shared_ptr<const juce::AudioBuffer<float>> block);
+    // Snapshot bytes in memory that the waveform does not account for
+    size_t getSnapshotMemoryBytes(const RenderSnapshot& snapshot) const;
+
+    mutable RenderSnapshot::Ptr renderSnapshot;
+    mutable CurveSnapshot::Ptr curveSnapshot;
+    std::shared_ptr<ScratchMapping> waveformPages;
+    std::shared_ptr<const juce::AudioBuffer<float>> waveformBlock;
 };
 
 /**
@@ -45,6 +143,44 @@ struct LoopRange
     bool isValid() const { return enabled && endSeconds > startSeconds; }
 };
 
+/**
+ * Approximate bytes held by a project, by category.
+ * Project::getMemoryReport() fills what the project owns; the owner of the
+ * undo history and synthesis caches adds those.
+ */
+struct ProjectMemoryReport
+{
+    size_t waveformBytes = 0;    // Waveform buffer
+    size_t snapshotBytes = 0;    // Render and curve snapshots handed to other threads
+    size_t melBytes = 0;         // Mel spectrogram and shared note mel buffers
+    size_t pitchCurveBytes = 0;  // F0, base/delta pitch and voiced mask
+    size_t noteBytes = 0;        // Notes with their curves and owned clips
+    size_t undoBytes = 0;        // Undo/redo history
+    size_t cacheBytes = 0;       // Synthesis caches
+    size_t pagedBytes = 0;       // Paged to scratch files; not in the total
+
+    size_t getTotalBytes() const
+    {
+        return waveformBytes + snapshotBytes + melBytes + pitchCurveBytes
+             + noteBytes + undoBytes + cacheBytes;
+    }
+};
+
+/**
+ * One consistent version of everything a render reads from a project.
+ * Every part is immutable and shared with the live project where it is
+ * unchanged, so taking one costs pointer copies and the chunks edited
+ * since the last one; workers keep it for as long as they need.
+ */
+struct ProjectSnapshot
+{
+    RenderSnapshot::Ptr audio;
+    CurveSnapshot::Ptr curves;
+    std::shared_ptr<const std::vector<Note>> notes;
+    float globalPitchOffset = 0.0f;
+    float formantShift = 0.0f;
+};
+
 /**
  * Project data container.
  */
@@ -69,11 +205,51 @@ public:
     // Notes
     std::vector<Note>& getNotes() { return notes; }
     const std::vector<Note>& getNotes() const { return notes; }
-    void addNote(Note note) { notes.push_back(std::move(note)); }
-    void clearNotes() { notes.clear(); }
+    // Keeps the note's id if it has one not in use here (a note restored by
+    // undo), otherwise gives it a new one; posts Added. Returns the id.
+    NoteId addNote(Note note);
+    void clearNotes();
+
+    // Call after replacing notes wholesale through getNotes() (e.g. assigning
+    // a copied vector); adds, removals and timing setters are tracked already.
+    // Gives notes without a unique id one and posts Reset.
+    void invalidateNoteIndex();
+
+    // The note's id, giving it one first if it was pushed through getNotes()
+    // without (as analysis does)
+    NoteId getNoteId(Note& note);
+
+    Note* findNote(NoteId id);
+    const Note* findNote(NoteId id) const;
+    bool removeNote(NoteId id);
+
+    // Edits to the notes, for caches derived from them
+    NoteChangeFeed& getNoteChanges() { return noteChanges; }
+
+    // Frame ranges whose pitch curves were rewritten, one Changed (id 0)
+    // per setF0DirtyRange() call; batches like the note feed
+    NoteChangeFeed& getCurveChanges() { return curveChanges; }
+
+    // Immutable copy of the notes for workers; rebuilt only after the notes
+    // change, so pinning an unchanged one is a pointer copy. Note clips are
+    // shared, not copied. Call on the thread that edits the notes.
+    std::shared_ptr<const std::vector<Note>> getNoteSnapshot() const;
+
+    // Audio, curves and notes pinned together, for renders and exports
+    ProjectSnapshot getSnapshot() const;
 
+    // Post a Changed for a note edited through its setters; give the frames
+    // it covered before when its timing changed
+    void noteChanged(const Note& note);
+    void noteChanged(const Note& note, int oldStartFrame, int oldEndFrame);
+
+    // Interval-indexed lookups, O(log n + k); results are in vector order
     Note* getNoteAtFrame(int frame);
     std::vector<Note*> getNotesInRange(int startFrame, int endFrame);
+    std::vector<const Note*> getNotesInRange(int startFrame, int endFrame) const;
+    // Also by adjusted MIDI note in [minMidi, maxMidi]; O(log n + k) per
+    // semitone spanned, for box selection and hit tests
+    std::vector<Note*> getNotesInRect(int startFrame, int endFrame, float minMidi, float maxMidi);
     std::vector<Note*> getSelectedNotes();
     bool removeNoteByStartFrame(int startFrame);
     std::vector<Note*> getDirtyNotes();
@@ -96,10 +272,25 @@ public:
     
     // Get adjusted F0 for a specific frame range
     std::vector<float> getAdjustedF0ForRange(int startFrame, int endFrame) const;
+
+    // Write adjusted F0 for frames [startFrame, endFrame) to out, which holds
+    // endFrame - startFrame values. The range must lie within basePitch.
+    void getAdjustedF0ForRange(int startFrame, int endFrame, float* out) const;
+
+    // The same with basePitch[i - startFrame] in place of the project's base
+    // pitch, as for a preview of curves not written yet
+    void getAdjustedF0ForRange(int startFrame, int endFrame, const float* basePitch,
+                               float* out) const;
     
     // Get frame range that needs resynthesis (based on dirty notes)
     // Returns {-1, -1} if no dirty notes
     std::pair<int, int> getDirtyFrameRange() const;
+
+    // Disjoint, sorted [start, end) ranges covering dirty notes and F0 edits
+    std::vector<std::pair<int, int>> getDirtyFrameRanges() const;
+
+    // Dirty ranges as they would be after setF0DirtyRange(startFrame, endFrame)
+    std::vector<std::pair<int, int>> getDirtyFrameRangesWith(int startFrame, int endFrame) const;
     
     // Check if any notes are dirty
     bool hasDirtyNotes() const;
@@ -108,7 +299,7 @@ public:
     void setF0DirtyRange(int startFrame, int endFrame);
     void clearF0DirtyRange();
     bool hasF0DirtyRange() const;
-    std::pair<int, int> getF0DirtyRange() const;
+    std::pair<int, int> getF0DirtyRange() const;  // Bounding span of all F0 edits
     
     // Modified state
     bool isModified() const { return modified; }
@@ -120,6 +311,9 @@ public:
     void setLoopEnabled(bool enabled);
     void clearLoopRange();
 
+    // Memory held by audio, features and notes (undo/cache fields left 0)
+    ProjectMemoryReport getMemoryReport() const;
+
 private:
     juce::String name = "Untitled";
     juce::File filePath;
@@ -127,14 +321,40 @@ private:
     
     AudioData audioData;
     std::vector<Note> notes;
+    mutable NoteIndex noteIndex; // Rebuilt lazily when stale
+    // Bumped by changes to notes joined to them (see joinNoteRevisions())
+    std::shared_ptr<NoteRevisions> noteRevisions = std::make_shared<NoteRevisions>();
+
+    const NoteIndex& getNoteIndex() const;
+    // Before capturing the revisions: notes added since report to them too
+    void joinNoteRevisions() const;
+
+    // Position in notes by id; entries are checked on use and the map is
+    // rebuilt when one is out of date
+    mutable std::unordered_map<NoteId, size_t> notePositions;
+    NoteId nextNoteId = 1;
+    NoteChangeFeed noteChanges;
+    NoteChangeFeed curveChanges;
+
+    // Notes pinned by getNoteSnapshot(); stale after any posted change, and
+    // after setters that moved or repitched notes without posting
+    mutable std::shared_ptr<const std::vector<Note>> noteSnapshot;
+    mutable bool noteSnapshotStale = true;
+    mutable uint32_t noteSnapshotTimingRevision = 0;
+    mutable uint32_t noteSnapshotPitchRevision = 0;
+
+    void postNoteChange(const NoteChange& change);
+    void assignNoteIds();
+    void rebuildNotePositions() const;
     
     float globalPitchOffset = 0.0f;
     float formantShift = 0.0f;
     float volume = 0.0f;  // dB
     
-    // F0 direct edit dirty range
-    int f0DirtyStart = -1;
-    int f0DirtyEnd = -1;
+    // F0 direct edit dirty ranges (sorted, disjoint)
+    std::vector<std::pair<int, int>> f0DirtyRanges;
+
+    static void addDirtyRange(std::vector<std::pair<int, int>>& ranges, int startFrame, int endFrame);
     
     bool modified = false;
 
@@ -0,0 +1,331 @@
+#include "ProjectJournal.h"
+#include "ProjectSerializer.h"
+#include <cstring>
+
+namespace {
+    constexpr char journalMagic[4] = { 'H', 'T', 'J', 'L' };
+    constexpr int journalVersion = 1;
+
+    // Unchanged frames shorter than this between two edits join one patch
+    constexpr int patchMergeGap = 16;
+
+    enum CurveId : juce::uint8 { curveF0, curveBasePitch, curveDeltaPitch, curveVoiced };
+
+    struct Patch {
+        CurveId curve;
+        int newSize;
+        int start;
+        int count;
+    };
+
+    juce::uint32 checksum(const void* data, size_t numBytes) {
+        // FNV-1a; catches records torn by a crash
+        const auto* bytes = static_cast<const juce::uint8*>(data);
+        juce::uint32 hash = 2166136261u;
+        for (size_t i = 0; i < numBytes; ++i) {
+            hash ^= bytes[i];
+            hash *= 16777619u;
+        }
+        return hash;
+    }
+
+    // Changed [start, end) ranges of after relative to before, plus growth
+    template <typename Equal>
+    std::vector<std::pair<int, int>> changedRanges(int beforeSize, int afterSize, Equal equal) {
+        std::vector<std::pair<int, int>> ranges;
+        const int common = std::min(beforeSize, afterSize);
+        for (int i = 0; i < common; ++i) {
+            if (equal(i))
+                continue;
+            if (!ranges.empty() && i - ranges.back().second < patchMergeGap)
+                ranges.back().second = i + 1;
+            else
+                ranges.push_back({ i, i + 1 });
+        }
+        if (afterSize > beforeSize)
+            ranges.push_back({ beforeSize, afterSize });
+        else if (afterSize < beforeSize && ranges.empty())
+            ranges.push_back({ afterSize, afterSize }); // Shrink only
+        return ranges;
+    }
+
+    void diffCurve(CurveId curve, const std::vector<float>& before, const std::vector<float>& after,
+                   std::vector<Patch>& patches) {
+        const auto ranges = changedRanges(static_cast<int>(before.size()), static_cast<int>(after.size()),
+            [&](int i) { return std::memcmp(&before[static_cast<size_t>(i)], &after[static_cast<size_t>(i)], sizeof(float)) == 0; });
+        for (const auto& [start, end] : ranges)
+            patches.push_back({ curve, static_cast<int>(after.size()), start, end - start });
+    }
+
+    std::vector<float>* curveOf(AudioData& audioData, CurveId curve) {
+        switch (curve) {
+            case curveF0: return &audioData.f0;
+            case curveBasePitch: return &audioData.basePitch;
+            case curveDeltaPitch: return &audioData.deltaPitch;
+            default: return nullptr;
+        }
+    }
+
+    bool matchesBase(juce::InputStream& in, const juce::File& projectFile) {
+        const auto size = in.readInt64();
+        const auto modified = in.readInt64();
+        return size == projectFile.getSize()
+            && modified == projectFile.getLastModificationTime().toMilliseconds();
+    }
+
+    // Tie the journal to this exact save
+    void writeHeader(juce::OutputStream& out, const juce::File& projectFile) {
+        out.write(journalMagic, sizeof(journalMagic));
+        out.writeInt(journalVersion);
+        out.writeInt64(projectFile.getSize());
+        out.writeInt64(projectFile.getLastModificationTime().toMilliseconds());
+    }
+
+    // False for a journal of another save, or of another format
+    bool readHeader(juce::InputStream& in, const juce::File& projectFile) {
+        char magic[sizeof(journalMagic)] = {};
+        return in.read(magic, sizeof(magic)) == static_cast<int>(sizeof(magic))
+            && std::memcmp(magic, journalMagic, sizeof(magic)) == 0
+            && in.readInt() == journalVersion
+            && matchesBase(in, projectFile);
+    }
+
+    // The next complete record, or false at the end or a torn record
+    bool readRecord(juce::InputStream& in, int sequence, juce::MemoryBlock& block) {
+        if (in.isExhausted())
+            return false;
+        const int size = in.readInt();
+        const auto expected = static_cast<juce::uint32>(in.readInt());
+        if (size <= 0 || size > in.getNumBytesRemaining())
+            return false;
+        if (in.readIntoMemoryBlock(block, size) != static_cast<size_t>(size)
+            || checksum(block.getData(), block.getSize()) != expected)
+            return false;
+        return juce::MemoryInputStream(block, false).readInt() == sequence;
+    }
+
+    bool writeRecord(juce::OutputStream& out, const juce::MemoryOutputStream& payload) {
+        out.writeInt(static_cast<int>(payload.getDataSize()));
+        out.writeInt(static_cast<int>(checksum(payload.getData(), payload.getDataSize())));
+        return out.write(payload.getData(), payload.getDataSize());
+    }
+}
+
+juce::File ProjectJournal::getJournalFileFor(const juce::File& projectFile) {
+    return projectFile.getSiblingFile(projectFile.getFileName() + ".journal");
+}
+
+ProjectJournal::State ProjectJournal::captureState(const Project& project) {
+    const auto& audioData = project.getAudioData();
+    State state;
+    state.header = juce::JSON::toString(ProjectSerializer::headerToJson(project), true);
+    state.f0 = audioData.f0;
+    state.basePitch = audioData.basePitch;
+    state.deltaPitch = audioData.deltaPitch;
+    state.voicedMask = audioData.voicedMask;
+    return state;
+}
+
+bool ProjectJournal::begin(const Project& base, const juce::File& projectFile) {
+    discard();
+
+    const auto file = getJournalFileFor(projectFile);
+    juce::FileOutputStream out(file);
+    if (!out.openedOk())
+        return false;
+    out.setPosition(0);
+    out.truncate();
+    writeHeader(out, projectFile);
+    out.flush();
+    if (out.getStatus().failed())
+        return false;
+
+    journalFile = file;
+    last = captureState(base);
+    nextSequence = 0;
+    return true;
+}
+
+bool ProjectJournal::resume(const Project& current, const juce::File& projectFile) {
+    const auto file = getJournalFileFor(projectFile);
+    if (isActive() && projectFile != juce::File{} && file == journalFile)
+        return true;
+
+    // The journal of the project left behind goes as on a clean close
+    discard();
+    if (projectFile == juce::File{} || !projectFile.existsAsFile())
+        return false;
+
+    // A journal replay left in place: current holds its end state
+    {
+        juce::FileInputStream in(file);
+        if (in.openedOk() && readHeader(in, projectFile)) {
+            int records = 0;
+            juce::MemoryBlock block;
+            while (readRecord(in, records, block))
+                ++records;
+            journalFile = file;
+            last = captureState(current);
+            nextSequence = records;
+            return true;
+        }
+    }
+
+    // Otherwise current may hold edits since the save, journaled against it
+    Project saved;
+    if (!ProjectSerializer::loadFromFile(saved, projectFile) || !begin(saved, projectFile))
+        return false;
+    return append(current);
+}
+
+bool ProjectJournal::encodeRecord(int sequence, const State& before, const State& after,
+                                  juce::MemoryOutputStream& payload) {
+    std::vector<Patch> patches;
+    diffCurve(curveF0, before.f0, after.f0, patches);
+    diffCurve(curveBasePitch, before.basePitch, after.basePitch, patches);
+    diffCurve(curveDeltaPitch, before.deltaPitch, after.deltaPitch, patches);
+    for (const auto& [start, end] : changedRanges(static_cast<int>(before.voicedMask.size()),
+                                                  static_cast<int>(after.voicedMask.size()),
+             [&](int i) { return before.voicedMask[static_cast<size_t>(i)] == after.voicedMask[static_cast<size_t>(i)]; }))
+        patches.push_back({ curveVoiced, static_cast<int>(after.voicedMask.size()), start, end - start });
+
+    const bool headerChanged = after.header != before.header;
+    if (patches.empty() && !headerChanged)
+        return false;
+
+    payload.writeInt(sequence);
+    payload.writeBool(headerChanged);
+    if (headerChanged)
+        payload.writeString(after.header);
+
+    payload.writeInt(static_cast<int>(patches.size()));
+    for (const auto& patch : patches) {
+        payload.writeByte(static_cast<char>(patch.curve));
+        payload.writeInt(patch.newSize);
+        payload.writeInt(patch.start);
+        payload.writeInt(patch.count);
+        if (patch.curve == curveVoiced) {
+            for (int i = patch.start; i < patch.start + patch.count; ++i)
+                payload.writeBool(after.voicedMask[static_cast<size_t>(i)]);
+        } else {
+            const auto& values = patch.curve == curveF0 ? after.f0
+                               : patch.curve == curveBasePitch ? after.basePitch
+                               : after.deltaPitch;
+            payload.write(values.data() + patch.start, static_cast<size_t>(patch.count) * sizeof(float));
+        }
+    }
+    return true;
+}
+
+bool ProjectJournal::append(const Project& current) {
+    if (!isActive())
+        return false;
+
+    auto state = captureState(current);
+    juce::MemoryOutputStream payload;
+    if (!encodeRecord(nextSequence, last, state, payload))
+        return true;
+
+    juce::FileOutputStream out(journalFile);
+    if (!out.openedOk())
+        return false;
+    writeRecord(out, payload);
+    out.flush();
+    if (out.getStatus().failed())
+        return false;
+
+    last = std::move(state);
+    ++nextSequence;
+    return true;
+}
+
+bool ProjectJournal::rewrite(const juce::File& projectFile, const State& base, const State& current) {
+    // Written aside and swapped in, so a crash here keeps the old journal
+    const auto file = getJournalFileFor(projectFile);
+    juce::TemporaryFile temp(file);
+    {
+        juce::FileOutputStream out(temp.getFile());
+        if (!out.openedOk())
+            return false;
+        writeHeader(out, projectFile);
+        juce::MemoryOutputStream payload;
+        if (encodeRecord(0, base, current, payload))
+            writeRecord(out, payload);
+        out.flush();
+        if (out.getStatus().failed())
+            return false;
+    }
+    return temp.overwriteTargetFileWithTemporary();
+}
+
+void ProjectJournal::discard() {
+    if (isActive())
+        journalFile.deleteFile();
+    journalFile = juce::File{};
+    last = {};
+    nextSequence = 0;
+}
+
+int ProjectJournal::replay(Project& project, const juce::File& projectFile) {
+    const auto file = getJournalFileFor(projectFile);
+    if (!file.existsAsFile())
+        return 0;
+
+    const auto saved = captureState(project);
+    auto& audioData = project.getAudioData();
+    int applied = 0;
+    {
+        juce::FileInputStream in(file);
+        if (!in.openedOk())
+            return 0;
+        if (!readHeader(in, projectFile)) {
+            // Stale journal from an older save
+            file.deleteFile();
+            return 0;
+        }
+
+        juce::MemoryBlock block;
+        bool intact = true;
+        while (intact && readRecord(in, applied, block)) {
+            juce::MemoryInputStream record(block, false);
+            record.readInt(); // Sequence, checked by readRecord()
+
+            const bool hasHeader = record.readBool();
+            const auto header = hasHeader ? juce::JSON::parse(record.readString()) : juce::var();
+
+            const int numPatches = record.readInt();
+            for (int p = 0; p < numPatches && intact; ++p) {
+                const auto curve = static_cast<CurveId>(record.readByte());
+                const int newSize = record.readInt();
+                const int start = record.readInt();
+                const int count = record.readInt();
+                if (newSize < 0 || start < 0 || count < 0 || start + count > newSize) {
+                    intact = false;
+                } else if (curve == curveVoiced) {
+                    audioData.voicedMask.resize(static_cast<size_t>(newSize));
+                    for (int i = start; i < start + count; ++i)
+                        audioData.voicedMask.set(static_cast<size_t>(i), record.readBool());
+                } else if (auto* values = curveOf(audioData, curve)) {
+                    values->resize(static_cast<size_t>(newSize));
+                    record.read(values->data() + start, count * static_cast<int>(sizeof(float)));
+                } else {
+                    intact = false;
+                }
+            }
+            if (!intact)
+                break;
+
+            // Arrays are in place, so fromJson only restores metadata and notes
+            if (header.isObject())
+                ProjectSerializer::fromJson(project, header);
+            ++applied;
+        }
+    }
+
+    // One record of the recovered state, without any torn tail, so the
+    // journal can be continued from it (see resume())
+    if (applied > 0)
+        project.setModified(true);
+    rewrite(projectFile, saved, captureState(project));
+    return applied;
+}
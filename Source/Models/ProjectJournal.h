@@ -0,0 +1,85 @@
+#pragma once
+
+#include "../JuceHeader.h"
+#include "Project.h"
+#include <vector>
+
+/**
+ * Append-only autosave journal next to a saved project file.
+ *
+ * After a full save, each edit appends one record holding only what changed
+ * since the previous record: the project header (metadata and notes) when
+ * it differs, plus the changed frame ranges of the dense pitch curves.
+ * After a crash, loading the project replays the records on top of the last
+ * full save and compacts them into one record, which journaling then
+ * continues from. A full save starts a new journal; closing cleanly deletes
+ * it.
+ *
+ * Records carry a length and checksum, so a record torn by a crash is
+ * detected and replay stops at the last complete one.
+ *
+ * Not thread-safe; ProjectSaver drives it from its worker thread.
+ */
+class ProjectJournal {
+public:
+    ProjectJournal() = default;
+
+    static juce::File getJournalFileFor(const juce::File& projectFile);
+
+    /**
+     * Start a new journal for projectFile, which was just saved from base.
+     */
+    bool begin(const Project& base, const juce::File& projectFile);
+
+    /**
+     * Journal current, last saved to projectFile, from here on: continue
+     * that file's journal, or start one from the saved file when there is
+     * none. Stops journaling when projectFile is not set (never saved).
+     */
+    bool resume(const Project& current, const juce::File& projectFile);
+
+    /**
+     * Append the changes from the last journaled state to current. Does
+     * nothing before begin() or when nothing changed.
+     */
+    bool append(const Project& current);
+
+    /**
+     * Stop journaling and delete the journal file.
+     */
+    void discard();
+
+    bool isActive() const { return journalFile != juce::File{}; }
+
+    /**
+     * Replay the journal of projectFile onto project, which must hold that
+     * file's saved state, then rewrite the journal as a single record of the
+     * result (deleting it if stale). Returns the number of records applied.
+     */
+    static int replay(Project& project, const juce::File& projectFile);
+
+private:
+    // Last journaled state, diffed against on append
+    struct State {
+        juce::String header;
+        std::vector<float> f0;
+        std::vector<float> basePitch;
+        std::vector<float> deltaPitch;
+        VoicedMask voicedMask;
+    };
+
+    static State captureState(const Project& project);
+
+    // Record the changes from before to after as record sequence; false
+    // when nothing changed
+    static bool encodeRecord(int sequence, const State& before, const State& after,
+                             juce::MemoryOutputStream& payload);
+
+    // Journal header plus, if anything changed, one record from base to
+    // current, replacing the journal of projectFile
+    static bool rewrite(const juce::File& projectFile, const State& base, const State& current);
+
+    juce::File journalFile;
+    State last;
+    int nextSequence = 0;
+};
@@ -0,0 +1,114 @@
+#include "ProjectSaver.h"
+#include "ProjectSerializer.h"
+
+ProjectSaver::ProjectSaver()
+    : worker([this]() { workerLoop(); }) {}
+
+ProjectSaver::~ProjectSaver() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopWorker = true;
+    }
+    condition.notify_all();
+    if (worker.joinable())
+        worker.join();
+
+    journal.discard();
+}
+
+std::shared_ptr<const Project> ProjectSaver::makeSnapshot(const Project& project) {
+    auto snapshot = std::make_shared<Project>();
+    snapshot->setName(project.getName());
+    snapshot->setFilePath(project.getFilePath());
+    snapshot->setProjectFilePath(project.getProjectFilePath());
+    snapshot->setGlobalPitchOffset(project.getGlobalPitchOffset());
+    snapshot->setFormantShift(project.getFormantShift());
+    snapshot->setVolume(project.getVolume());
+
+    const auto& loopRange = project.getLoopRange();
+    snapshot->setLoopRange(loopRange.startSeconds, loopRange.endSeconds);
+    snapshot->setLoopEnabled(loopRange.enabled);
+
+    snapshot->getNotes() = project.getNotes();
+    snapshot->invalidateNoteIndex();
+
+    const auto& source = project.getAudioData();
+    auto& audioData = snapshot->getAudioData();
+    audioData.sampleRate = source.sampleRate;
+    audioData.sessionSampleRate = source.sessionSampleRate;
+    audioData.f0 = source.f0;
+    audioData.basePitch = source.basePitch;
+    audioData.deltaPitch = source.deltaPitch;
+    audioData.voicedMask = source.voicedMask;
+    return snapshot;
+}
+
+void ProjectSaver::saveAsync(const Project& project, const juce::File& file, SaveCallback onComplete) {
+    auto snapshot = makeSnapshot(project);
+    enqueue([this, snapshot, file, onComplete]() {
+        const bool ok = ProjectSerializer::saveToFile(*snapshot, file);
+        if (ok)
+            journal.begin(*snapshot, file);
+
+        if (onComplete)
+            juce::MessageManager::callAsync([onComplete, file, ok]() { onComplete(file, ok); });
+    });
+}
+
+void ProjectSaver::journalAsync(const Project& project) {
+    if (project.getProjectFilePath() == juce::File{})
+        return;
+
+    auto snapshot = makeSnapshot(project);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        const bool queued = pendingJournalSnapshot != nullptr;
+        pendingJournalSnapshot = std::move(snapshot);
+        if (queued)
+            return;
+    }
+
+    enqueue([this]() {
+        std::shared_ptr<const Project> latest;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            latest = std::move(pendingJournalSnapshot);
+        }
+        if (latest && latest->getProjectFilePath() != juce::File{})
+            journal.append(*latest);
+    });
+}
+
+void ProjectSaver::resumeJournalAsync(const Project& project) {
+    auto snapshot = makeSnapshot(project);
+    {
+        // A coalesced journal request still queued belongs to the old project
+        std::lock_guard<std::mutex> lock(mutex);
+        pendingJournalSnapshot = nullptr;
+    }
+    enqueue([this, snapshot]() { journal.resume(*snapshot, snapshot->getProjectFilePath()); });
+}
+
+void ProjectSaver::enqueue(std::function<void()> job) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        queue.push_back(std::move(job));
+    }
+    condition.notify_one();
+}
+
+void ProjectSaver::workerLoop() {
+    while (true) {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            condition.wait(lock, [this]() { return stopWorker || !queue.empty(); });
+            // Drain queued saves before stopping
+            if (queue.empty())
+                return;
+            job = std::move(queue.front());
+            queue.pop_front();
+        }
+        job();
+    }
+}
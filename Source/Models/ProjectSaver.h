@@ -0,0 +1,68 @@
+#pragma once
+
+#include "../JuceHeader.h"
+#include "Project.h"
+#include "ProjectJournal.h"
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+/**
+ * Saves projects and appends autosave journal records on a worker thread.
+ *
+ * Each request first takes a snapshot of the project on the calling
+ * (message) thread: metadata, notes and pitch curves, but not the waveform
+ * or mel spectrogram, which the file does not store. Serialization and disk
+ * writes then happen on the worker, so the UI does not wait for them.
+ *
+ * Journal requests coalesce: while one is queued, newer edits replace its
+ * snapshot instead of queueing another.
+ */
+class ProjectSaver {
+public:
+    using SaveCallback = std::function<void(const juce::File& file, bool success)>;
+
+    ProjectSaver();
+
+    /** Finishes queued work; deletes the journal (a clean close). */
+    ~ProjectSaver();
+
+    /**
+     * Save project to file in the background, then start a new journal for
+     * it. onComplete is called on the message thread.
+     */
+    void saveAsync(const Project& project, const juce::File& file, SaveCallback onComplete = nullptr);
+
+    /**
+     * Journal the project's current state against the last save. Ignored
+     * until the project has been saved once.
+     */
+    void journalAsync(const Project& project);
+
+    /**
+     * Journal project, just loaded or newly being edited, from here on
+     * instead of the previous one, whose journal is deleted. See
+     * ProjectJournal::resume().
+     */
+    void resumeJournalAsync(const Project& project);
+
+private:
+    static std::shared_ptr<const Project> makeSnapshot(const Project& project);
+
+    void enqueue(std::function<void()> job);
+    void workerLoop();
+
+    ProjectJournal journal;  // Worker thread only
+
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::deque<std::function<void()>> queue;
+    std::shared_ptr<const Project> pendingJournalSnapshot;
+    bool stopWorker = false;
+    std::thread worker;  // Last: starts in the constructor
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ProjectSaver)
+};
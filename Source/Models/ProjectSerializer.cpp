@@ -1,14 +1,179 @@
 #include "ProjectSerializer.h"
+#include "ProjectJournal.h"
+#include "../Utils/AppLogger.h"
 #include "../Utils/PitchCurveProcessor.h"
+#include <cstring>
 
-bool ProjectSerializer::saveToFile(const Project& project, const juce::File& file) {
-    auto json = toJson(project);
-    auto jsonString = juce::JSON::toString(json, true); // Pretty print
+namespace {
+    constexpr char binaryMagic[4] = { 'H', 'T', 'P', 'X' };
+    constexpr size_t binaryHeaderSize = 16;  // Magic, version, JSON length
+    constexpr size_t chunkAlignment = 64;
 
-    return file.replaceWithText(jsonString);
+    size_t alignUp(size_t value) {
+        return (value + chunkAlignment - 1) & ~(chunkAlignment - 1);
+    }
+
+    // One raw array in the data section
+    struct BinaryChunk {
+        const char* name;
+        const char* type;  // "f32" or "bits"
+        const void* data;
+        size_t numBytes;
+        size_t count;      // Elements (frames for "bits")
+        int mels;          // Mel bins per frame, 0 for curves
+    };
+
+    BinaryChunk floatChunk(const char* name, const std::vector<float>& values) {
+        return { name, "f32", values.data(), values.size() * sizeof(float), values.size(), 0 };
+    }
+
+    // FNV-1a; an unchanged array hashes the same, so its compressed bytes are reused
+    uint64_t hashBytes(const void* data, size_t numBytes) {
+        const auto* bytes = static_cast<const uint8_t*>(data);
+        uint64_t hash = 1469598103934665603ull;
+        for (size_t i = 0; i < numBytes; ++i)
+            hash = (hash ^ bytes[i]) * 1099511628211ull;
+        return hash ^ numBytes;
+    }
+
+    const juce::MemoryBlock& encodeChunk(ProjectSerializer::ChunkCache& cache, const BinaryChunk& chunk) {
+        auto& entry = cache.entries[chunk.name];
+        const auto hash = hashBytes(chunk.data, chunk.numBytes);
+        if (entry.hash == hash && entry.rawBytes == chunk.numBytes && entry.encoded.getSize() > 0)
+            return entry.encoded;
+
+        entry.hash = hash;
+        entry.rawBytes = chunk.numBytes;
+        entry.encoded.reset();
+        juce::MemoryOutputStream encoded(entry.encoded, false);
+        {
+            juce::GZIPCompressorOutputStream zip(encoded);
+            zip.write(chunk.data, chunk.numBytes);
+        }
+        return entry.encoded;
+    }
+
+    bool decodeChunk(const void* data, size_t numBytes, juce::MemoryBlock& decoded) {
+        juce::MemoryInputStream source(data, numBytes, false);
+        juce::GZIPDecompressorInputStream unzip(&source, false,
+                                                juce::GZIPDecompressorInputStream::zlibFormat);
+        const auto expected = static_cast<int>(decoded.getSize());
+        return unzip.read(decoded.getData(), expected) == expected;
+    }
+}
+
+bool ProjectSerializer::saveToFile(const Project& project, const juce::File& file, bool includeMel) {
+    juce::TemporaryFile temp(file);
+    {
+        juce::FileOutputStream out(temp.getFile());
+        if (!out.openedOk() || !writeBinary(project, out, includeMel, nullptr))
+            return false;
+        out.flush();
+        if (out.getStatus().failed())
+            return false;
+    }
+
+    return temp.overwriteTargetFileWithTemporary();
+}
+
+juce::MemoryBlock ProjectSerializer::saveToMemory(const Project& project, ChunkCache& cache) {
+    juce::MemoryBlock block;
+    juce::MemoryOutputStream out(block, false);
+    if (!writeBinary(project, out, false, &cache))
+        return {};
+    out.flush();
+    block.setSize(static_cast<size_t>(out.getPosition()));
+    return block;
+}
+
+bool ProjectSerializer::writeBinary(const Project& project, juce::OutputStream& out,
+                                    bool includeMel, ChunkCache* cache) {
+    // Chunks are written raw, so the file is little-endian on every platform we build
+    jassert(juce::ByteOrder::isLittleEndian());
+
+    const auto& audioData = project.getAudioData();
+    std::vector<BinaryChunk> chunks;
+    chunks.push_back(floatChunk("f0", audioData.f0));
+    chunks.push_back(floatChunk("basePitch", audioData.basePitch));
+    chunks.push_back(floatChunk("deltaPitch", audioData.deltaPitch));
+    chunks.push_back({ "voicedMask", "bits", audioData.voicedMask.getWords(),
+                       audioData.voicedMask.getNumWords() * sizeof(uint64_t),
+                       audioData.voicedMask.size(), 0 });
+    if (includeMel && !audioData.melSpectrogram.empty()) {
+        const auto& mel = audioData.melSpectrogram;
+        chunks.push_back({ "mel", "f32", mel.data(), mel.getNumBytes(),
+                           mel.size() * static_cast<size_t>(mel.getNumMels()), mel.getNumMels() });
+    }
+
+    // Compressed chunks are stored in place of the raw arrays
+    if (cache != nullptr) {
+        for (auto& chunk : chunks) {
+            const auto& encoded = encodeChunk(*cache, chunk);
+            chunk.data = encoded.getData();
+            chunk.numBytes = encoded.getSize();
+        }
+    }
+
+    // Offsets are relative to the data start, which follows the header
+    auto header = headerToJson(project);
+    auto* chunkTable = new juce::DynamicObject();
+    std::vector<size_t> offsets;
+    size_t dataSize = 0;
+    for (const auto& chunk : chunks) {
+        offsets.push_back(dataSize);
+        auto* entry = new juce::DynamicObject();
+        entry->setProperty("type", chunk.type);
+        entry->setProperty("offset", static_cast<juce::int64>(dataSize));
+        entry->setProperty("count", static_cast<juce::int64>(chunk.count));
+        if (chunk.mels > 0)
+            entry->setProperty("mels", chunk.mels);
+        if (cache != nullptr) {
+            entry->setProperty("encoding", "zlib");
+            entry->setProperty("bytes", static_cast<juce::int64>(chunk.numBytes));
+        }
+        chunkTable->setProperty(chunk.name, juce::var(entry));
+        dataSize = alignUp(dataSize + chunk.numBytes);
+    }
+    header.getDynamicObject()->setProperty("chunks", juce::var(chunkTable));
+
+    const auto headerText = juce::JSON::toString(header, true);
+    const auto headerBytes = headerText.getNumBytesAsUTF8();
+    const size_t dataStart = alignUp(binaryHeaderSize + headerBytes);
+    const auto streamStart = static_cast<size_t>(out.getPosition());
+
+    out.write(binaryMagic, sizeof(binaryMagic));
+    out.writeInt(BINARY_VERSION);
+    out.writeInt64(static_cast<juce::int64>(headerBytes));
+    out.write(headerText.toRawUTF8(), headerBytes);
+
+    auto padTo = [&out, streamStart](size_t position) {
+        const auto current = static_cast<size_t>(out.getPosition()) - streamStart;
+        if (position > current)
+            out.writeRepeatedByte(0, position - current);
+    };
+
+    for (size_t i = 0; i < chunks.size(); ++i) {
+        padTo(dataStart + offsets[i]);
+        if (chunks[i].numBytes > 0)
+            out.write(chunks[i].data, chunks[i].numBytes);
+    }
+
+    return true;
 }
 
 bool ProjectSerializer::loadFromFile(Project& project, const juce::File& file) {
+    if (isBinaryProjectFile(file)) {
+        if (!loadBinaryFile(project, file))
+            return false;
+
+        // Recover edits made after the last save of a session that crashed
+        const int replayed = ProjectJournal::replay(project, file);
+        if (replayed > 0)
+            LOG("Recovered " + juce::String(replayed) + " journaled edits for " + file.getFileName());
+        return true;
+    }
+
+    // Legacy JSON project
     auto jsonString = file.loadFileAsString();
     if (jsonString.isEmpty())
         return false;
@@ -20,7 +185,125 @@ bool ProjectSerializer::loadFromFile(Project& project, const juce::File& file) {
     return fromJson(project, json);
 }
 
+bool ProjectSerializer::isBinaryProjectFile(const juce::File& file) {
+    juce::FileInputStream in(file);
+    char magic[sizeof(binaryMagic)] = {};
+    return in.openedOk()
+        && in.read(magic, sizeof(magic)) == static_cast<int>(sizeof(magic))
+        && std::memcmp(magic, binaryMagic, sizeof(magic)) == 0;
+}
+
+bool ProjectSerializer::loadBinaryFile(Project& project, const juce::File& file) {
+    juce::MemoryMappedFile mapped(file, juce::MemoryMappedFile::readOnly);
+    return loadFromMemory(project, mapped.getData(), mapped.getSize());
+}
+
+bool ProjectSerializer::isBinaryProjectData(const void* data, size_t numBytes) {
+    return data != nullptr && numBytes >= sizeof(binaryMagic)
+        && std::memcmp(data, binaryMagic, sizeof(binaryMagic)) == 0;
+}
+
+bool ProjectSerializer::loadFromMemory(Project& project, const void* containerData, size_t containerSize) {
+    const auto* base = static_cast<const char*>(containerData);
+    if (containerSize < binaryHeaderSize || !isBinaryProjectData(containerData, containerSize))
+        return false;
+
+    const auto version = static_cast<int>(juce::ByteOrder::littleEndianInt(base + 4));
+    if (version < 1 || version > BINARY_VERSION)
+        return false;
+
+    const auto headerBytes = static_cast<size_t>(juce::ByteOrder::littleEndianInt64(base + 8));
+    if (headerBytes > containerSize - binaryHeaderSize)
+        return false;
+
+    auto header = juce::JSON::parse(juce::String::fromUTF8(base + binaryHeaderSize,
+                                                           static_cast<int>(headerBytes)));
+    if (!header.isObject())
+        return false;
+
+    // Locate a chunk inside the data; nullptr if absent, mistyped or
+    // truncated. Compressed chunks are decoded into decodedChunks.
+    const size_t dataStart = alignUp(binaryHeaderSize + headerBytes);
+    const auto chunkTable = header.getProperty("chunks", juce::var());
+    std::vector<juce::MemoryBlock> decodedChunks;
+    decodedChunks.reserve(8);
+    auto findChunk = [&](const char* name, const char* type, size_t elementBits,
+                         size_t& count) -> const void* {
+        const auto entry = chunkTable.getProperty(name, juce::var());
+        if (!entry.isObject() || entry.getProperty("type", "").toString() != type)
+            return nullptr;
+
+        // Offsets and sizes come from the data: bound each by division
+        // before multiplying, so no product can wrap, even with a 32-bit size_t
+        const auto offset = static_cast<uint64_t>(static_cast<juce::int64>(entry.getProperty("offset", 0)));
+        const auto rawCount = static_cast<uint64_t>(static_cast<juce::int64>(entry.getProperty("count", 0)));
+        const bool compressed = entry.getProperty("encoding", "").toString() == "zlib";
+        if (dataStart > containerSize || offset > containerSize - dataStart)
+            return nullptr;
+        const uint64_t available = containerSize - dataStart - offset;
+
+        // Decoded chunks are capped before allocating; raw ones must fit the file
+        const uint64_t maxBytes = compressed ? uint64_t { 1 } << 31 : available;
+        if (rawCount / 8 > maxBytes / elementBits)
+            return nullptr;
+        const uint64_t numBytes = elementBits == 1 ? (rawCount + 63) / 64 * sizeof(uint64_t)
+                                                   : rawCount * elementBits / 8;
+        const uint64_t storedBytes = compressed
+            ? static_cast<uint64_t>(static_cast<juce::int64>(entry.getProperty("bytes", 0)))
+            : numBytes;
+        if (numBytes > maxBytes || storedBytes > available)
+            return nullptr;
+        count = static_cast<size_t>(rawCount);
+        if (!compressed)
+            return base + dataStart + offset;
+
+        if (decodedChunks.size() == decodedChunks.capacity())
+            return nullptr;
+        juce::MemoryBlock decoded(static_cast<size_t>(numBytes));
+        if (!decodeChunk(base + dataStart + offset, static_cast<size_t>(storedBytes), decoded))
+            return nullptr;
+        decodedChunks.push_back(std::move(decoded));
+        return decodedChunks.back().getData();
+    };
+
+    auto readFloats = [&](const char* name) {
+        size_t count = 0;
+        const auto* data = static_cast<const float*>(findChunk(name, "f32", 32, count));
+        return data ? std::vector<float>(data, data + count) : std::vector<float>();
+    };
+
+    auto& audioData = project.getAudioData();
+    audioData.f0 = readFloats("f0");
+    audioData.baseF0 = audioData.f0; // Initialize baseF0 from loaded f0
+    audioData.basePitch = readFloats("basePitch");
+    audioData.deltaPitch = readFloats("deltaPitch");
+
+    size_t numFrames = 0;
+    if (const auto* words = static_cast<const uint64_t*>(findChunk("voicedMask", "bits", 1, numFrames)))
+        audioData.voicedMask.assignWords(words, numFrames);
+    else
+        audioData.voicedMask.clear();
+
+    size_t melCount = 0;
+    if (const auto* mel = static_cast<const float*>(findChunk("mel", "f32", 32, melCount))) {
+        const int mels = chunkTable.getProperty("mel", juce::var()).getProperty("mels", 0);
+        if (mels > 0 && melCount % static_cast<size_t>(mels) == 0) {
+            audioData.melSpectrogram.reset(melCount / static_cast<size_t>(mels), mels);
+            std::memcpy(audioData.melSpectrogram.data(), mel, melCount * sizeof(float));
+        }
+    }
+
+    // Metadata and notes; pitch arrays are already in place
+    return fromJson(project, header);
+}
+
 juce::var ProjectSerializer::toJson(const Project& project) {
+    auto json = headerToJson(project);
+    json.getDynamicObject()->setProperty("pitchData", pitchDataToJson(project.getAudioData()));
+    return json;
+}
+
+juce::var ProjectSerializer::headerToJson(const Project& project) {
     auto* obj = new juce::DynamicObject();
 
     // Metadata
@@ -30,6 +313,7 @@ juce::var ProjectSerializer::toJson(const Project& project) {
 
     // Audio settings
     obj->setProperty("sampleRate", project.getAudioData().sampleRate);
+    obj->setProperty("sessionSampleRate", project.getAudioData().sessionSampleRate);
 
     // Global parameters
     obj->setProperty("globalPitchOffset", project.getGlobalPitchOffset());
@@ -51,9 +335,6 @@ juce::var ProjectSerializer::toJson(const Project& project) {
     }
     obj->setProperty("notes", notesArray);
 
-    // Pitch data
-    obj->setProperty("pitchData", pitchDataToJson(project.getAudioData()));
-
     return juce::var(obj);
 }
 
@@ -68,6 +349,7 @@ bool ProjectSerializer::fromJson(Project& project, const juce::var& json) {
     // Audio settings
     auto& audioData = project.getAudioData();
     audioData.sampleRate = json.getProperty("sampleRate", 44100);
+    audioData.sessionSampleRate = json.getProperty("sessionSampleRate", audioData.sessionSampleRate);
 
     // Global parameters
     project.setGlobalPitchOffset(static_cast<float>(json.getProperty("globalPitchOffset", 0.0)));
@@ -127,6 +409,14 @@ juce::var ProjectSerializer::noteToJson(const Note& note) {
     vibrato->setProperty("phaseRadians", note.getVibratoPhaseRadians());
     obj->setProperty("vibrato", juce::var(vibrato));
 
+    if (note.hasGain()) {
+        auto* gain = new juce::DynamicObject();
+        gain->setProperty("dB", note.getGainDb());
+        gain->setProperty("fadeInFrames", note.getFadeInFrames());
+        gain->setProperty("fadeOutFrames", note.getFadeOutFrames());
+        obj->setProperty("gain", juce::var(gain));
+    }
+
     // Lyric/Phoneme
     if (note.hasLyric())
         obj->setProperty("lyric", note.getLyric());
@@ -155,6 +445,13 @@ bool ProjectSerializer::noteFromJson(Note& note, const juce::var& json) {
         note.setVibratoPhaseRadians(static_cast<float>(vibratoVar.getProperty("phaseRadians", 0.0)));
     }
 
+    auto gainVar = json.getProperty("gain", juce::var());
+    if (gainVar.isObject()) {
+        note.setGainDb(static_cast<float>(gainVar.getProperty("dB", 0.0)));
+        note.setFadeInFrames(gainVar.getProperty("fadeInFrames", 0));
+        note.setFadeOutFrames(gainVar.getProperty("fadeOutFrames", 0));
+    }
+
     // Lyric/Phoneme
     auto lyric = json.getProperty("lyric", juce::var());
     if (!lyric.isVoid())
@@ -174,7 +471,7 @@ juce::var ProjectSerializer::pitchDataToJson(const AudioData& audioData) {
     obj->setProperty("f0", floatArrayToString(audioData.f0, 2));
     obj->setProperty("basePitch", floatArrayToString(audioData.basePitch, 4));
     obj->setProperty("deltaPitch", floatArrayToString(audioData.deltaPitch, 4));
-    obj->setProperty("voicedMask", boolArrayToString(audioData.voicedMask));
+    obj->setProperty("voicedMask", boolArrayToString(audioData.voicedMask.toVector()));
 
     return juce::var(obj);
 }
@@ -187,7 +484,7 @@ bool ProjectSerializer::pitchDataFromJson(AudioData& audioData, const juce::var&
     audioData.baseF0 = audioData.f0; // Initialize baseF0 from loaded f0
     audioData.basePitch = stringToFloatArray(json.getProperty("basePitch", "").toString());
     audioData.deltaPitch = stringToFloatArray(json.getProperty("deltaPitch", "").toString());
-    audioData.voicedMask = stringToBoolArray(json.getProperty("voicedMask", "").toString());
+    audioData.voicedMask = VoicedMask(stringToBoolArray(json.getProperty("voicedMask", "").toString()));
 
     return true;
 }
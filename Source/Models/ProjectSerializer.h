@@ -2,6 +2,8 @@
 
 #include "../JuceHeader.h"
 #include "Project.h"
+#include <cstdint>
+#include <map>
 
 /**
  * Handles Project serialization to/from JSON format.
@@ -10,21 +12,72 @@
  * - Decoupled from Project class (Project doesn't know about serialization details)
  * - Uses JUCE's built-in JSON support (no external dependencies)
  * - Stateless utility class
+ *
+ * Project files use a binary container:
+ *   [0, 16)   magic "HTPX", uint32 BINARY_VERSION, uint64 header length
+ *   [16, ...) UTF-8 JSON header: metadata, notes and a chunk table
+ *   then      raw chunks, each aligned to 64 bytes from the data start
+ * Dense curves are stored as little-endian float32 and the voiced mask as
+ * packed uint64 words, so loading maps the file and copies each chunk in one
+ * pass instead of parsing text. The mel spectrogram can be cached as well.
+ * Files without the magic are read as legacy JSON projects.
+ *
+ * Plugin state uses the same container in memory, with each chunk
+ * zlib-compressed (chunk table "encoding": "zlib", "bytes": stored size).
  */
 class ProjectSerializer {
 public:
     static constexpr int FORMAT_VERSION = 1;
+    static constexpr int BINARY_VERSION = 1;
 
     /**
-     * Save project to JSON file.
+     * Save project to a binary project file. With includeMel the analysed
+     * mel spectrogram is stored too.
      */
-    static bool saveToFile(const Project& project, const juce::File& file);
+    static bool saveToFile(const Project& project, const juce::File& file,
+                           bool includeMel = false);
 
     /**
-     * Load project from JSON file.
+     * Load project from a binary or legacy JSON project file. Edits
+     * journaled after the file was last saved (see ProjectJournal) are
+     * replayed on top, and the journal compacted to continue from them.
      */
     static bool loadFromFile(Project& project, const juce::File& file);
 
+    /**
+     * True if file starts with the binary container magic.
+     */
+    static bool isBinaryProjectFile(const juce::File& file);
+
+    /**
+     * Compressed chunks of earlier saveToMemory() calls, reused while the
+     * array they encode hashes the same. One per project; not thread-safe.
+     */
+    struct ChunkCache {
+        struct Entry {
+            uint64_t hash = 0;
+            size_t rawBytes = 0;
+            juce::MemoryBlock encoded;
+        };
+        std::map<juce::String, Entry> entries;
+    };
+
+    /**
+     * Project as a compressed binary container, e.g. for plugin state. Only
+     * arrays that changed since the last call with the same cache are
+     * compressed again; the header (metadata and notes) is always rebuilt.
+     */
+    static juce::MemoryBlock saveToMemory(const Project& project, ChunkCache& cache);
+
+    /**
+     * Load from saveToMemory() data, or from a file's container bytes.
+     * Pitch data is restored as saved, so no analysis is needed.
+     */
+    static bool loadFromMemory(Project& project, const void* data, size_t numBytes);
+
+    /** True if data starts with the binary container magic. */
+    static bool isBinaryProjectData(const void* data, size_t numBytes);
+
     /**
      * Convert project to JSON object.
      */
@@ -35,7 +88,18 @@ public:
      */
     static bool fromJson(Project& project, const juce::var& json);
 
+    /**
+     * Metadata and notes only (no dense pitch arrays); fromJson() accepts it
+     * and leaves the project's arrays as they are.
+     */
+    static juce::var headerToJson(const Project& project);
+
 private:
+    // Binary container; with a cache every chunk is compressed through it
+    static bool writeBinary(const Project& project, juce::OutputStream& out,
+                            bool includeMel, ChunkCache* cache);
+    static bool loadBinaryFile(Project& project, const juce::File& file);
+
     // Note serialization
     static juce::var noteToJson(const Note& note);
     static bool noteFromJson(Note& note, const juce::var& json);
@@ -0,0 +1,119 @@
+#include "ProjectVersions.h"
+#include <algorithm>
+
+namespace {
+    using Chunk = std::shared_ptr<const std::vector<float>>;
+
+    constexpr size_t chunkFrames = static_cast<size_t>(CurveSnapshot::chunkFrames);
+
+    // Cut values into chunks, reusing each chunk of previous that holds the same frames
+    std::vector<Chunk> chunkUp(const std::vector<float>& values, const std::vector<Chunk>* previous)
+    {
+        std::vector<Chunk> chunks;
+        chunks.reserve((values.size() + chunkFrames - 1) / chunkFrames);
+        for (size_t start = 0; start < values.size(); start += chunkFrames)
+        {
+            const size_t count = std::min(chunkFrames, values.size() - start);
+            const auto first = values.begin() + static_cast<std::ptrdiff_t>(start);
+            const size_t index = start / chunkFrames;
+            if (previous && index < previous->size())
+            {
+                const auto& old = (*previous)[index];
+                if (old->size() == count && std::equal(first, first + static_cast<std::ptrdiff_t>(count), old->begin()))
+                {
+                    chunks.push_back(old);
+                    continue;
+                }
+            }
+            chunks.push_back(std::make_shared<const std::vector<float>>(first, first + static_cast<std::ptrdiff_t>(count)));
+        }
+        return chunks;
+    }
+
+    void join(const std::vector<Chunk>& chunks, std::vector<float>& dest)
+    {
+        dest.clear();
+        for (const auto& chunk : chunks)
+            dest.insert(dest.end(), chunk->begin(), chunk->end());
+    }
+} // namespace
+
+void ProjectVersions::save(const juce::String& name, const Project& project)
+{
+    auto existing = std::find_if(versions.begin(), versions.end(),
+                                 [&name](const Version& version) { return version.name == name; });
+    // Chunks are shared with the version this one most likely resembles
+    const Version* previous = existing != versions.end() ? &*existing
+                            : versions.empty()           ? nullptr
+                                                         : &versions.back();
+
+    const auto& audioData = project.getAudioData();
+    Version version;
+    version.name = name;
+    version.snapshot = project.getSnapshot();
+    version.basePitch = chunkUp(audioData.basePitch, previous ? &previous->basePitch : nullptr);
+    version.deltaPitch = chunkUp(audioData.deltaPitch, previous ? &previous->deltaPitch : nullptr);
+    version.baseF0 = chunkUp(audioData.baseF0, previous ? &previous->baseF0 : nullptr);
+    version.dirtyRanges = project.getDirtyFrameRanges();
+
+    if (existing != versions.end())
+        *existing = std::move(version);
+    else
+        versions.push_back(std::move(version));
+}
+
+bool ProjectVersions::restore(const juce::String& name, Project& project) const
+{
+    const auto* version = find(name);
+    if (!version || !version->snapshot.curves || !version->snapshot.notes)
+        return false;
+
+    const auto& snapshot = version->snapshot;
+    auto& audioData = project.getAudioData();
+    snapshot.curves->copyF0(audioData.f0);
+    snapshot.curves->copyVoicedMask(audioData.voicedMask);
+    snapshot.curves->copyMel(audioData.melSpectrogram);
+    join(version->basePitch, audioData.basePitch);
+    join(version->deltaPitch, audioData.deltaPitch);
+    join(version->baseF0, audioData.baseF0);
+    audioData.restoreRender(snapshot.audio);
+
+    project.getNotes() = *snapshot.notes;
+    project.setGlobalPitchOffset(snapshot.globalPitchOffset);
+    project.setFormantShift(snapshot.formantShift);
+
+    // The notes' own flags may be older than the snapshot; the saved ranges
+    // are what the render was missing
+    project.clearAllDirty();
+    project.invalidateNoteIndex();
+    for (const auto& [start, end] : version->dirtyRanges)
+        project.setF0DirtyRange(start, end);
+    project.setModified(true);
+    return true;
+}
+
+bool ProjectVersions::remove(const juce::String& name)
+{
+    const auto found = std::find_if(versions.begin(), versions.end(),
+                                    [&name](const Version& version) { return version.name == name; });
+    if (found == versions.end())
+        return false;
+    versions.erase(found);
+    return true;
+}
+
+juce::StringArray ProjectVersions::getNames() const
+{
+    juce::StringArray names;
+    for (const auto& version : versions)
+        names.add(version.name);
+    return names;
+}
+
+const ProjectVersions::Version* ProjectVersions::find(const juce::String& name) const
+{
+    for (const auto& version : versions)
+        if (version.name == name)
+            return &version;
+    return nullptr;
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "../JuceHeader.h"
+#include "Project.h"
+#include <memory>
+#include <utility>
+#include <vector>
+
+/**
+ * Named in-memory versions of one project, for A/B comparison of takes.
+ *
+ * A version pins the project's snapshot (render tiles, curve chunks and
+ * the note vector, whose clips are shared) and keeps the base and delta
+ * pitch curves cut into chunks, reusing the chunks of the version saved
+ * before where they are unchanged. The live project shares tiles and
+ * chunks with every version until it edits them, so a version costs what
+ * was edited since, not a copy of the project. Restoring puts the
+ * version's render back as it was, ready to play without synthesis; its
+ * pending edits are marked dirty again.
+ *
+ * Message thread only.
+ */
+class ProjectVersions {
+public:
+    ProjectVersions() = default;
+
+    /** Keep project as it is now under name, replacing a version of that name. */
+    void save(const juce::String& name, const Project& project);
+
+    /**
+     * Write the version back into project: notes, curves, render and global
+     * settings. Returns false when there is no version of that name. Cancel
+     * synthesis on the project first; its undo history no longer applies.
+     */
+    bool restore(const juce::String& name, Project& project) const;
+
+    bool remove(const juce::String& name);
+    void clear() { versions.clear(); }
+
+    bool contains(const juce::String& name) const { return find(name) != nullptr; }
+    int size() const { return static_cast<int>(versions.size()); }
+
+    /** Names in the order first saved. */
+    juce::StringArray getNames() const;
+
+private:
+    using Chunk = std::shared_ptr<const std::vector<float>>;
+
+    struct Version {
+        juce::String name;
+        ProjectSnapshot snapshot;
+        std::vector<Chunk> basePitch;
+        std::vector<Chunk> deltaPitch;
+        std::vector<Chunk> baseF0;
+        std::vector<std::pair<int, int>> dirtyRanges; // Edits not rendered yet
+    };
+
+    const Version* find(const juce::String& name) const;
+
+    std::vector<Version> versions;
+};
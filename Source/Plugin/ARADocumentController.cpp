@@ -2,8 +2,11 @@
 
 #if JucePlugin_Enable_ARA
 
+#include "../Audio/PerformanceMetrics.h"
 #include "../UI/IMainView.h"
+#include "../Utils/RealtimeCheck.h"
 
+#include <algorithm>
 #include <limits>
 
 //==============================================================================
@@ -26,22 +29,26 @@ void HachiTunePlaybackRenderer::prepareToPlay(
   numChannels = numChannelsIn;
   tempBuffer =
       std::make_unique<juce::AudioBuffer<float>>(numChannels, maxBlockSize);
+  inputBuffer.setSize(numChannels, maxBlockSize);
 
   bool useBuffered = (alwaysNonRealtime == AlwaysNonRealtime::no);
   juce::ignoreUnused(useBuffered);
 
-  // Create readers for all playback regions
+  // Prefetch every source a playback region plays
+  std::vector<juce::ARAAudioSource *> sources;
   for (auto *region : getPlaybackRegions()) {
     auto *source = region->getAudioModification()->getAudioSource();
-    if (readers.find(source) == readers.end())
-      readers.emplace(source,
-                      std::make_unique<juce::ARAAudioSourceReader>(source));
+    if (std::find(sources.begin(), sources.end(), source) == sources.end())
+      sources.push_back(source);
   }
+  prefetcher.prepare(sources, numChannels,
+                     static_cast<int>(sampleRate * prefetchSeconds));
 }
 
 void HachiTunePlaybackRenderer::releaseResources() {
-  readers.clear();
+  prefetcher.release();
   tempBuffer.reset();
+  inputBuffer.setSize(0, 0);
 }
 
 bool HachiTunePlaybackRenderer::readFromARARegions(
@@ -70,21 +77,17 @@ bool HachiTunePlaybackRenderer::readFromARARegions(
     if (renderRange.isEmpty())
       continue;
 
-    // Get reader
     auto *source = region->getAudioModification()->getAudioSource();
-    auto it = readers.find(const_cast<juce::ARAAudioSource *>(source));
-    if (it == readers.end())
-      continue;
 
     int samplesToRead = static_cast<int>(renderRange.getLength());
     int bufferOffset =
         static_cast<int>(renderRange.getStart() - blockRange.getStart());
     auto sourceStart = renderRange.getStart() + modOffset;
 
+    // Audio not prefetched yet (just after a seek) plays as silence
     auto &readBuffer = didRender ? *tempBuffer : buffer;
-    if (!it->second->read(&readBuffer, bufferOffset, samplesToRead, sourceStart,
-                          true, true))
-      continue;
+    prefetcher.read(source, sourceStart, readBuffer, bufferOffset,
+                    samplesToRead);
 
     if (didRender) {
       // Mix with existing
@@ -108,10 +111,20 @@ bool HachiTunePlaybackRenderer::readFromARARegions(
 bool HachiTunePlaybackRenderer::processBlock(
     juce::AudioBuffer<float> &buffer, juce::AudioProcessor::Realtime realtime,
     const juce::AudioPlayHead::PositionInfo &posInfo) noexcept {
+  using Outcome = PerformanceMetrics::BlockOutcome;
   auto timeInSamples = posInfo.getTimeInSamples().orFallback(0);
   bool isPlaying = posInfo.getIsPlaying();
   int numSamples = buffer.getNumSamples();
   const bool shouldSyncUi = (realtime == juce::AudioProcessor::Realtime::yes);
+  // An offline render may wait for the render; a realtime one must not
+  REALTIME_SCOPE_IF("HachiTunePlaybackRenderer::processBlock", shouldSyncUi);
+  PerformanceMetrics::ScopedAudioCallback timing(
+      PerformanceMetrics::AudioSource::AraRenderer, numSamples, sampleRate,
+      shouldSyncUi);
+  auto recordOutcome = [](Outcome outcome) {
+    PerformanceMetrics::getInstance().recordBlockOutcome(
+        PerformanceMetrics::AudioSource::AraRenderer, outcome);
+  };
 
   // Get document controller for accessing MainComponent
   auto *docCtrl = getDocController();
@@ -120,51 +133,35 @@ bool HachiTunePlaybackRenderer::processBlock(
   if (shouldSyncUi && docCtrl && docCtrl->getMainComponent()) {
     if (isPlaying) {
       double timeInSeconds = static_cast<double>(timeInSamples) / sampleRate;
-      auto state = hostUiSyncState;
-      state->latestSeconds.store(timeInSeconds);
-
-      if (!state->posPending.exchange(true)) {
-        juce::Component::SafePointer<juce::Component> safeMain(
-            docCtrl->getMainComponent()->getComponent());
-        juce::MessageManager::callAsync([safeMain, state]() {
-          state->posPending.store(false);
-          if (auto *view = dynamic_cast<IMainView *>(safeMain.getComponent()))
-            view->updatePlaybackPosition(state->latestSeconds.load());
-        });
-      }
+      docCtrl->getHostPlaybackState().publish({timeInSeconds, true});
     } else {
-      auto state = hostUiSyncState;
-      if (!state->stoppedPending.exchange(true)) {
-        juce::Component::SafePointer<juce::Component> safeMain(
-            docCtrl->getMainComponent()->getComponent());
-        juce::MessageManager::callAsync([safeMain, state]() {
-          state->stoppedPending.store(false);
-          if (auto *view = dynamic_cast<IMainView *>(safeMain.getComponent()))
-            view->notifyHostStopped();
-        });
-      }
+      docCtrl->getHostPlaybackState().publish({0.0, false});
     }
   }
 
   if (!isPlaying) {
     buffer.clear();
+    recordOutcome(Outcome::Stopped);
     return true;
   }
 
-  // Read from ARA regions
-  juce::AudioBuffer<float> inputBuffer(buffer.getNumChannels(), numSamples);
+  // Read from ARA regions; sized in prepareToPlay, so this never allocates
+  inputBuffer.setSize(buffer.getNumChannels(), numSamples, false, false, true);
   bool didRender = readFromARARegions(inputBuffer, timeInSamples, numSamples);
 
   if (!didRender) {
     buffer.clear();
+    recordOutcome(Outcome::NoAudio);
     return true;
   }
 
   // Get processor from document controller (dynamic lookup)
   auto *realtimeProcessor = docCtrl ? docCtrl->getRealtimeProcessor() : nullptr;
 
-  // Apply pitch correction if processor available and ready
-  if (realtimeProcessor && realtimeProcessor->isReady()) {
+  // Apply pitch correction if processor available and ready; an offline
+  // render waits for it instead
+  const bool offline = realtime == juce::AudioProcessor::Realtime::no;
+  if (realtimeProcessor && (offline || realtimeProcessor->isReady())) {
     // Map host timeline position to audio-modification sample time.
     // ARAAudioSourceReader reads in audio-modification sample coordinates,
     // so the realtime processor must use the same time base.
@@ -190,24 +187,22 @@ bool HachiTunePlaybackRenderer::processBlock(
       adjustedPosInfo.setTimeInSeconds(
           *t + (static_cast<double>(modOffsetSamples) / sampleRate));
 
-    if (realtimeProcessor->processBlock(inputBuffer, buffer,
-                                        &adjustedPosInfo)) {
+    const bool used =
+        offline ? realtimeProcessor->processBlockOffline(inputBuffer, buffer,
+                                                         &adjustedPosInfo)
+                : realtimeProcessor->processBlock(inputBuffer, buffer,
+                                                  &adjustedPosInfo);
+    if (used) {
+      recordOutcome(Outcome::Rendered);
       return true;
-    } else {
-      DBG("ARA processBlock: realtimeProcessor->processBlock returned false "
-          "(passthrough)");
-    }
-  } else {
-    // Log why we're not using the processor
-    if (!realtimeProcessor) {
-      DBG("ARA processBlock: realtimeProcessor is null");
-    } else if (!realtimeProcessor->isReady()) {
-      DBG("ARA processBlock: realtimeProcessor not ready");
     }
   }
 
-  // Fallback: copy input to output
-  buffer.makeCopyOf(inputBuffer);
+  // Fallback: copy input to output. Counted rather than logged, since this
+  // runs on the audio thread for every block until the render is ready
+  recordOutcome(Outcome::NotReady);
+  for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+    buffer.copyFrom(ch, 0, inputBuffer, ch, 0, numSamples);
   return true;
 }
 
@@ -216,93 +211,252 @@ bool HachiTunePlaybackRenderer::processBlock(
 //==============================================================================
 
 HachiTuneDocumentController::~HachiTuneDocumentController() {
-  stopAnalysisThread();
-  if (analysisThread.joinable())
-    analysisThread.join();
-  if (analysisJoinerThread.joinable())
-    analysisJoinerThread.join();
+  analysisState->controllerAlive = false;
+  cancelAnalysis();
+  analysisJobs.wait();
 }
 
-void HachiTuneDocumentController::stopAnalysisThread() {
+// The read being replaced sees the new job id or the cancel flag and returns
+// on its own; nothing waits for it here
+void HachiTuneDocumentController::cancelAnalysis() {
   if (analysisState)
     analysisState->cancel.store(true);
-  if (analysisThread.joinable()) {
-    if (analysisJoinerThread.joinable())
-      analysisJoinerThread.join();
-    auto old = std::move(analysisThread);
-    analysisJoinerThread = std::thread([t = std::move(old)]() mutable {
-      if (t.joinable())
-        t.join();
-    });
+}
+
+juce::String
+HachiTuneDocumentController::getSourceId(const juce::ARAAudioSource *source) {
+  return juce::String::fromUTF8(source->getPersistentID().c_str());
+}
+
+int HachiTuneDocumentController::getRank(
+    const juce::ARAAudioSource *source) const {
+  if (source == currentAudioSource)
+    return static_cast<int>(Priority::Selected) + 1;
+  auto it = sourceStates.find(getSourceId(source));
+  return static_cast<int>(it != sourceStates.end() ? it->second.priority
+                                                   : Priority::Normal);
+}
+
+void HachiTuneDocumentController::setMainComponent(IMainView *mc) {
+  if (mc == mainComponent)
+    return;
+
+  saveShownEdits();
+  mainComponent = mc;
+  shownAudioSource = nullptr;
+
+  if (mainComponent == nullptr) {
+    // Its pending results are dropped with it: run that source again later
+    analysisState->jobId.fetch_add(1);
+    if (analysingSource) {
+      analysisQueue.insert(analysisQueue.begin(), analysingSource);
+      analysingSource = nullptr;
+    }
+    return;
   }
+
+  if (currentAudioSource == nullptr && !audioSources.empty())
+    currentAudioSource = audioSources.front();
+  if (currentAudioSource)
+    showAudioSource(currentAudioSource);
+  else
+    startNextAnalysis();
 }
 
-void HachiTuneDocumentController::processAudioSource(
+void HachiTuneDocumentController::showAudioSource(
     juce::ARAAudioSource *source) {
-  if (!mainComponent || !source)
+  if (!source)
     return;
+  saveShownEdits();
+  currentAudioSource = source;
+  enqueueAnalysis(source);
+  if (mainComponent)
+    mainComponent->setStatusMessage("ARA Mode - Analyzing...");
+  startNextAnalysis();
+}
 
-  stopAnalysisThread();
-  if (!analysisState)
-    analysisState = std::make_shared<AnalysisState>();
-  analysisState->cancel.store(false);
-  const auto jobId = analysisState->jobId.fetch_add(1) + 1;
-
-  auto numSamples = static_cast<int>(source->getSampleCount());
-  auto numChannels = source->getChannelCount();
-  auto sourceSampleRate = source->getSampleRate();
+void HachiTuneDocumentController::saveShownEdits() {
+  if (!shownAudioSource || !mainComponent ||
+      !mainComponent->hasAnalyzedProject())
+    return;
+  auto json = mainComponent->serializeProjectJson();
+  if (json.isNotEmpty())
+    sourceStates[getSourceId(shownAudioSource)].projectJson = json;
+}
 
-  if (numSamples <= 0 || numChannels <= 0 || sourceSampleRate <= 0)
+void HachiTuneDocumentController::enqueueAnalysis(
+    juce::ARAAudioSource *source) {
+  if (source == analysingSource ||
+      std::find(analysisQueue.begin(), analysisQueue.end(), source) !=
+          analysisQueue.end())
     return;
 
-  juce::Component::SafePointer<juce::Component> safeMain(
-      mainComponent->getComponent());
-  auto *sourcePtr = source;
-  auto state = analysisState;
-  analysisThread = std::thread([safeMain, sourcePtr, state, jobId, numSamples,
-                                numChannels, sourceSampleRate]() mutable {
-    auto *view = dynamic_cast<IMainView *>(safeMain.getComponent());
-    if (!view)
-      return;
-    if (!state)
-      return;
-    if (state->cancel.load() || state->jobId.load() != jobId)
+  if (analysisQueue.size() >= kMaxQueuedSources) {
+    // Full: drop the newest of the lowest ranked, unless the newcomer ranks
+    // lower still; a dropped source is queued again once selected or shown
+    auto lowest = analysisQueue.rbegin();
+    for (auto it = analysisQueue.rbegin(); it != analysisQueue.rend(); ++it)
+      if (getRank(*it) < getRank(*lowest))
+        lowest = it;
+    if (getRank(*lowest) >= getRank(source))
       return;
+    analysisQueue.erase(std::next(lowest).base());
+  }
+  analysisQueue.push_back(source);
+}
 
-    juce::ARAAudioSourceReader reader(sourcePtr);
-    juce::AudioBuffer<float> buffer(numChannels, numSamples);
-    if (!reader.read(&buffer, 0, numSamples, 0, true, true))
-      return;
+void HachiTuneDocumentController::startNextAnalysis() {
+  while (!analysingSource && mainComponent && !analysisQueue.empty()) {
+    // Highest rank first, oldest first among equals
+    auto next = analysisQueue.begin();
+    for (auto it = analysisQueue.begin(); it != analysisQueue.end(); ++it)
+      if (getRank(*it) > getRank(*next))
+        next = it;
+    auto *source = *next;
+    analysisQueue.erase(next);
+
+    auto numSamples = static_cast<int>(source->getSampleCount());
+    auto numChannels = source->getChannelCount();
+    auto sourceSampleRate = source->getSampleRate();
+    if (numSamples <= 0 || numChannels <= 0 || sourceSampleRate <= 0)
+      continue;
 
-    if (state->cancel.load() || state->jobId.load() != jobId)
-      return;
+    cancelAnalysis();
+    analysisState->cancel.store(false);
+    const auto jobId = analysisState->jobId.fetch_add(1) + 1;
+    analysingSource = source;
 
-    juce::MessageManager::callAsync([safeMain, buffer = std::move(buffer),
-                                     sourceSampleRate, state, jobId]() mutable {
-      if (safeMain == nullptr)
-        return;
-      auto *view = dynamic_cast<IMainView *>(safeMain.getComponent());
-      if (!view)
-        return;
-      if (!state)
+    auto state = analysisState;
+    auto readSource = [this, source, state, jobId, numSamples, numChannels,
+                       sourceSampleRate]() {
+      if (state->cancel.load() || state->jobId.load() != jobId)
         return;
-      if (state->jobId.load() != jobId)
+
+      juce::ARAAudioSourceReader reader(source);
+      auto buffer =
+          std::make_shared<juce::AudioBuffer<float>>(numChannels, numSamples);
+      if (!reader.read(buffer.get(), 0, numSamples, 0, true, true))
+        buffer.reset();
+
+      if (state->cancel.load() || state->jobId.load() != jobId)
         return;
-      view->setStatusMessage("ARA Mode - Analyzing...");
-      view->setHostAudio(buffer, sourceSampleRate);
-    });
-  });
+
+      juce::MessageManager::callAsync([this, source, state, jobId, buffer,
+                                       sourceSampleRate]() {
+        if (!state->controllerAlive || state->jobId.load() != jobId)
+          return;
+        if (!buffer) {
+          analysingSource = nullptr;
+          startNextAnalysis();
+          return;
+        }
+
+        auto onComplete = [this, source, state, jobId, buffer,
+                           sourceSampleRate](const juce::String &entry) {
+          if (state->controllerAlive && state->jobId.load() == jobId)
+            finishAnalysis(source, entry, *buffer, sourceSampleRate);
+        };
+        if (!mainComponent || !mainComponent->analyzeHostAudioInBackground(
+                                  *buffer, sourceSampleRate, onComplete)) {
+          // No editor to analyse with: wait for the next one
+          analysisQueue.insert(analysisQueue.begin(), source);
+          analysingSource = nullptr;
+        }
+      });
+    };
+    analysisJobs.submit(JobSystem::Priority::Background,
+                        std::move(readSource));
+  }
+}
+
+void HachiTuneDocumentController::finishAnalysis(
+    juce::ARAAudioSource *source, const juce::String &cacheEntry,
+    const juce::AudioBuffer<float> &buffer, double sourceSampleRate) {
+  analysingSource = nullptr;
+  auto &state = sourceStates[getSourceId(source)];
+  if (cacheEntry.isNotEmpty())
+    state.cacheEntry = cacheEntry;
+
+  // The analysis is cached by now, so showing the source is a cache hit
+  if (source == currentAudioSource && mainComponent) {
+    saveShownEdits();
+    shownAudioSource = source;
+    mainComponent->setHostAudio(buffer, sourceSampleRate, state.projectJson);
+  }
+  startNextAnalysis();
 }
 
 void HachiTuneDocumentController::didAddAudioSourceToDocument(
     juce::ARADocument *, juce::ARAAudioSource *audioSource) {
-  currentAudioSource = audioSource;
-  processAudioSource(audioSource);
+  audioSources.push_back(audioSource);
+  sourceStates[getSourceId(audioSource)];
+  if (currentAudioSource == nullptr) {
+    showAudioSource(audioSource);
+    return;
+  }
+  enqueueAnalysis(audioSource);
+  startNextAnalysis();
+}
+
+void HachiTuneDocumentController::willRemoveAudioSourceFromDocument(
+    juce::ARADocument *, juce::ARAAudioSource *audioSource) {
+  audioSources.erase(
+      std::remove(audioSources.begin(), audioSources.end(), audioSource),
+      audioSources.end());
+  analysisQueue.erase(
+      std::remove(analysisQueue.begin(), analysisQueue.end(), audioSource),
+      analysisQueue.end());
+
+  if (analysingSource == audioSource) {
+    cancelAnalysis();
+    analysisState->jobId.fetch_add(1);
+    analysingSource = nullptr;
+  }
+  if (shownAudioSource == audioSource) {
+    saveShownEdits();
+    shownAudioSource = nullptr;
+  }
+  if (currentAudioSource == audioSource)
+    currentAudioSource = nullptr;
+  startNextAnalysis();
+}
+
+void HachiTuneDocumentController::selectAudioSources(
+    const std::vector<juce::ARAAudioSource *> &sources) {
+  for (auto &entry : sourceStates)
+    if (entry.second.priority == Priority::Selected)
+      entry.second.priority = Priority::Normal;
+  for (auto *source : sources) {
+    sourceStates[getSourceId(source)].priority = Priority::Selected;
+    enqueueAnalysis(source);
+  }
+
+  if (!sources.empty() && sources.front() != currentAudioSource)
+    showAudioSource(sources.front());
+  else
+    startNextAnalysis();
+}
+
+void HachiTuneDocumentController::setHiddenAudioSources(
+    const std::vector<juce::ARAAudioSource *> &sources) {
+  for (auto &entry : sourceStates)
+    if (entry.second.priority == Priority::Hidden)
+      entry.second.priority = Priority::Normal;
+  for (auto *source : sources) {
+    auto &state = sourceStates[getSourceId(source)];
+    if (state.priority != Priority::Selected)
+      state.priority = Priority::Hidden;
+  }
 }
 
 void HachiTuneDocumentController::reanalyze() {
-  if (currentAudioSource)
-    processAudioSource(currentAudioSource);
+  if (!currentAudioSource)
+    return;
+  // Starts over from the analysis, without the source's edits
+  sourceStates[getSourceId(currentAudioSource)].projectJson = {};
+  if (shownAudioSource == currentAudioSource)
+    shownAudioSource = nullptr;
+  showAudioSource(currentAudioSource);
 }
 
 juce::ARAPlaybackRenderer *
@@ -313,42 +467,112 @@ HachiTuneDocumentController::doCreatePlaybackRenderer() noexcept {
 
 bool HachiTuneDocumentController::doRestoreObjectsFromStream(
     juce::ARAInputStream &input,
-    const juce::ARARestoreObjectsFilter *) noexcept {
-  auto dataSize = input.readInt64();
-  if (dataSize <= 0)
+    const juce::ARARestoreObjectsFilter *filter) noexcept {
+  auto header = input.readInt64();
+  if (header == 0)
     return true;
 
-  juce::MemoryBlock data;
-  data.setSize(static_cast<size_t>(dataSize));
-  input.read(data.getData(), static_cast<int>(dataSize));
+  if (header > 0) {
+    // Sessions from before per-source state: edits of the shown source
+    juce::MemoryBlock data;
+    data.setSize(static_cast<size_t>(header));
+    input.read(data.getData(), static_cast<int>(header));
+
+    if (mainComponent) {
+      juce::String jsonString(
+          juce::CharPointer_UTF8(static_cast<const char *>(data.getData())),
+          data.getSize());
+      mainComponent->restoreProjectJson(jsonString);
+    }
+    return !input.failed();
+  }
+
+  if (header != kArchiveFormatTag)
+    return false;
+
+  const auto count = input.readInt();
+  if (count < 0 || count > (1 << 20))
+    return false;
+
+  bool restoredCurrent = false;
+  for (int i = 0; i < count && !input.failed(); ++i) {
+    auto id = input.readString();
+    SourceState state;
+    state.projectJson = input.readString();
+    state.cacheEntry = input.readString();
+
+    const auto entrySize = input.readInt64();
+    if (entrySize < 0 || entrySize > std::numeric_limits<int>::max())
+      return false;
+    juce::MemoryBlock entry;
+    if (entrySize > 0) {
+      entry.setSize(static_cast<size_t>(entrySize));
+      if (input.read(entry.getData(), static_cast<int>(entrySize)) !=
+          static_cast<int>(entrySize))
+        return false;
+    }
+
+    if (filter) {
+      auto *source =
+          filter->getAudioSourceToRestoreStateWithID<juce::ARAAudioSource>(
+              id.toRawUTF8());
+      if (source == nullptr)
+        continue;
+      id = getSourceId(source);
+    }
+    restoredCurrent = restoredCurrent ||
+                      (currentAudioSource && id == getSourceId(currentAudioSource));
+
+    // Analysis of the source's audio: showing it needs no inference
+    if (state.cacheEntry.isNotEmpty() && entry.getSize() > 0)
+      analysisCache.importEntry(state.cacheEntry, entry);
 
-  if (mainComponent) {
-    juce::String jsonString(
-        juce::CharPointer_UTF8(static_cast<const char *>(data.getData())),
-        data.getSize());
-    mainComponent->restoreProjectJson(jsonString);
+    auto &existing = sourceStates[id];
+    state.priority = existing.priority;
+    existing = std::move(state);
   }
+  if (input.failed())
+    return false;
 
-  return !input.failed();
+  if (restoredCurrent && currentAudioSource) {
+    if (shownAudioSource == currentAudioSource)
+      shownAudioSource = nullptr;
+    showAudioSource(currentAudioSource);
+  }
+  return true;
 }
 
 bool HachiTuneDocumentController::doStoreObjectsToStream(
     juce::ARAOutputStream &output,
-    const juce::ARAStoreObjectsFilter *) noexcept {
-  if (!mainComponent) {
-    output.writeInt64(0);
-    return true;
-  }
+    const juce::ARAStoreObjectsFilter *filter) noexcept {
+  saveShownEdits();
 
-  auto jsonString = mainComponent->serializeProjectJson();
-  if (jsonString.isEmpty()) {
-    output.writeInt64(0);
-    return true;
+  std::vector<juce::String> ids;
+  if (filter) {
+    for (auto *source : filter->getAudioSourcesToStore<juce::ARAAudioSource>())
+      ids.push_back(getSourceId(source));
+  } else {
+    for (auto *source : audioSources)
+      ids.push_back(getSourceId(source));
   }
 
-  output.writeInt64(static_cast<juce::int64>(jsonString.getNumBytesAsUTF8()));
-  return output.write(jsonString.toRawUTF8(),
-                      static_cast<int>(jsonString.getNumBytesAsUTF8()));
+  output.writeInt64(kArchiveFormatTag);
+  output.writeInt(static_cast<int>(ids.size()));
+  for (const auto &id : ids) {
+    const auto &state = sourceStates[id];
+    output.writeString(id);
+    output.writeString(state.projectJson);
+    output.writeString(state.cacheEntry);
+
+    auto entry = state.cacheEntry.isNotEmpty()
+                     ? analysisCache.exportEntry(state.cacheEntry)
+                     : juce::MemoryBlock();
+    output.writeInt64(static_cast<juce::int64>(entry.getSize()));
+    if (entry.getSize() > 0 &&
+        !output.write(entry.getData(), entry.getSize()))
+      return false;
+  }
+  return true;
 }
 
 #endif // JucePlugin_Enable_ARA
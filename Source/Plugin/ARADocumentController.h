@@ -1,11 +1,16 @@
 #pragma once
 
+#include "../Audio/Analysis/AnalysisCache.h"
 #include "../Audio/RealtimePitchProcessor.h"
 #include "../JuceHeader.h"
+#include "../Utils/JobSystem.h"
+#include "ARASourcePrefetcher.h"
+#include "HostPlaybackState.h"
 
 #include <atomic>
 #include <cstdint>
-#include <thread>
+#include <map>
+#include <vector>
 
 #if JucePlugin_Enable_ARA
 
@@ -28,29 +33,35 @@ public:
       juce::AudioBuffer<float> &buffer, juce::AudioProcessor::Realtime realtime,
       const juce::AudioPlayHead::PositionInfo &positionInfo) noexcept override;
 
-private:
-  struct HostUiSyncState {
-    std::atomic<double> latestSeconds{0.0};
-    std::atomic<bool> posPending{false};
-    std::atomic<bool> stoppedPending{false};
-  };
+  // Window kept ahead of playback per source, from the host's performance
+  // profile; takes effect on the next prepareToPlay()
+  void setPrefetchSeconds(int seconds) { prefetchSeconds = juce::jmax(1, seconds); }
 
+private:
   bool readFromARARegions(juce::AudioBuffer<float> &buffer,
                           juce::int64 timeInSamples, int numSamples);
   HachiTuneDocumentController *getDocController() const;
 
-  std::map<juce::ARAAudioSource *, std::unique_ptr<juce::ARAAudioSourceReader>>
-      readers;
+  // Sources are read ahead on a worker; processBlock only copies, into
+  // buffers sized in prepareToPlay
+  ARASourcePrefetcher prefetcher;
+  juce::AudioBuffer<float> inputBuffer;
   std::unique_ptr<juce::AudioBuffer<float>> tempBuffer;
-  std::shared_ptr<HostUiSyncState> hostUiSyncState =
-      std::make_shared<HostUiSyncState>();
   double sampleRate = 44100.0;
   int numChannels = 2;
+  int prefetchSeconds = 30;
 };
 
 /**
  * ARA Document Controller
- * Manages ARA document lifecycle and audio source analysis
+ * Manages ARA document lifecycle and audio source analysis.
+ *
+ * Every audio source has its own state: its edits and the analysis cache
+ * entry of its audio. The editor shows one source at a time. The others
+ * wait in a bounded queue, shown and selected sources first, and are
+ * analysed one by one in the background into the shared analysis cache,
+ * so switching to them later is a cache hit. Both parts of the state are
+ * stored in the host session.
  */
 class HachiTuneDocumentController
     : public juce::ARADocumentControllerSpecialisation {
@@ -62,11 +73,27 @@ public:
 
   void didAddAudioSourceToDocument(juce::ARADocument *doc,
                                    juce::ARAAudioSource *audioSource) override;
+  void willRemoveAudioSourceFromDocument(
+      juce::ARADocument *doc, juce::ARAAudioSource *audioSource) override;
   void reanalyze();
 
-  void setMainComponent(IMainView *mc) { mainComponent = mc; }
+  // Host selection: these sources are analysed first, the first one shown
+  void selectAudioSources(const std::vector<juce::ARAAudioSource *> &sources);
+  // Host view: sources of hidden region sequences are analysed last
+  void setHiddenAudioSources(
+      const std::vector<juce::ARAAudioSource *> &sources);
+
+  // Attaching a view shows the current source and resumes the queue
+  void setMainComponent(IMainView *mc);
   IMainView *getMainComponent() const { return mainComponent; }
 
+  // Host position published by the playback renderers; if two renderers
+  // publish at once, one update is dropped
+  HostPlaybackState &getHostPlaybackState() { return *hostPlaybackState; }
+  std::shared_ptr<const HostPlaybackState> getSharedHostPlaybackState() const {
+    return hostPlaybackState;
+  }
+
   void setRealtimeProcessor(RealtimePitchProcessor *processor) {
     realtimeProcessor = processor;
   }
@@ -84,23 +111,58 @@ protected:
       const juce::ARAStoreObjectsFilter *filter) noexcept override;
 
 private:
-  void processAudioSource(juce::ARAAudioSource *source);
+  enum class Priority { Hidden, Normal, Selected };
 
-  void stopAnalysisThread();
+  struct SourceState {
+    juce::String projectJson; // Edits, as IMainView::serializeProjectJson()
+    juce::String cacheEntry;  // AnalysisCache entry name once analysed
+    Priority priority = Priority::Normal;
+  };
+
+  static juce::String getSourceId(const juce::ARAAudioSource *source);
+  // Queue order: the current source, then selected, normal and hidden ones
+  int getRank(const juce::ARAAudioSource *source) const;
+
+  // Make source the one the editor shows, once it is analysed
+  void showAudioSource(juce::ARAAudioSource *source);
+  // Keep the edits of the shown source before it is replaced or stored
+  void saveShownEdits();
+  void enqueueAnalysis(juce::ARAAudioSource *source);
+  void startNextAnalysis();
+  void finishAnalysis(juce::ARAAudioSource *source,
+                      const juce::String &cacheEntry,
+                      const juce::AudioBuffer<float> &buffer,
+                      double sourceSampleRate);
+
+  void cancelAnalysis();
 
   struct AnalysisState {
     std::atomic<std::uint64_t> jobId{0};
     std::atomic<bool> cancel{false};
+    bool controllerAlive = true; // Message thread
   };
 
   IMainView *mainComponent = nullptr;
-  juce::ARAAudioSource *currentAudioSource = nullptr;
+  std::shared_ptr<HostPlaybackState> hostPlaybackState =
+      std::make_shared<HostPlaybackState>();
+  juce::ARAAudioSource *currentAudioSource = nullptr; // To be shown
+  juce::ARAAudioSource *shownAudioSource = nullptr;   // In the editor
   RealtimePitchProcessor *realtimeProcessor = nullptr;
 
+  // Message thread only
+  std::map<juce::String, SourceState> sourceStates; // By persistent ID
+  std::vector<juce::ARAAudioSource *> audioSources;  // Document order
+  std::vector<juce::ARAAudioSource *> analysisQueue; // Oldest first
+  juce::ARAAudioSource *analysingSource = nullptr;
+  AnalysisCache analysisCache; // Same directory as the editors' caches
+
+  static constexpr size_t kMaxQueuedSources = 64;
+  // Leads the session data; negative, so older builds restore nothing
+  static constexpr juce::int64 kArchiveFormatTag = -2;
+
   std::shared_ptr<AnalysisState> analysisState =
       std::make_shared<AnalysisState>();
-  std::thread analysisThread;
-  std::thread analysisJoinerThread;
+  JobSystem::Group analysisJobs; // Source reads
 };
 
 #endif // JucePlugin_Enable_ARA
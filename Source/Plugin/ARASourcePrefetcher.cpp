@@ -0,0 +1,172 @@
+#include "ARASourcePrefetcher.h"
+
+#if JucePlugin_Enable_ARA
+
+#include <algorithm>
+#include <chrono>
+
+ARASourcePrefetcher::ARASourcePrefetcher()
+    : worker([this]() { workerLoop(); }) {}
+
+ARASourcePrefetcher::~ARASourcePrefetcher() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopWorker = true;
+  }
+  wakeWorker.notify_all();
+  if (worker.joinable())
+    worker.join();
+}
+
+void ARASourcePrefetcher::prepare(
+    const std::vector<juce::ARAAudioSource *> &audioSources, int numChannels,
+    int windowSamples) {
+  std::lock_guard<std::mutex> lock(mutex);
+  sources.clear();
+  for (auto *audioSource : audioSources) {
+    auto entry = std::make_unique<Source>();
+    entry->source = audioSource;
+    entry->reader = std::make_unique<juce::ARAAudioSourceReader>(audioSource);
+    entry->length = audioSource->getSampleCount();
+    // Short sources fit whole, so loops over them never leave the window
+    const int size = static_cast<int>(std::clamp<juce::int64>(
+        entry->length, 1, std::max(1, windowSamples)));
+    entry->ring.setSize(std::max(1, numChannels), size);
+    entry->ring.clear();
+    sources.push_back(std::move(entry));
+  }
+  scratch.setSize(std::max(1, numChannels), readBlockSamples);
+  missedSamples.store(0);
+  wakeWorker.notify_all();
+}
+
+void ARASourcePrefetcher::release() {
+  std::lock_guard<std::mutex> lock(mutex);
+  sources.clear();
+}
+
+bool ARASourcePrefetcher::read(const juce::ARAAudioSource *source,
+                               juce::int64 sourceStart,
+                               juce::AudioBuffer<float> &dest, int destStart,
+                               int count) {
+  // Linear: a renderer plays a handful of sources
+  Source *entry = nullptr;
+  for (auto &candidate : sources)
+    if (candidate->source == source)
+      entry = candidate.get();
+  if (count <= 0)
+    return true;
+  if (entry == nullptr) {
+    for (int ch = 0; ch < dest.getNumChannels(); ++ch)
+      dest.clear(ch, destStart, count);
+    missedSamples.fetch_add(count);
+    return false;
+  }
+
+  entry->playPosition.store(sourceStart);
+
+  readCounter.fetch_add(1);
+  const juce::int64 start = std::max(sourceStart, entry->validStart.load());
+  const juce::int64 end =
+      std::min(sourceStart + count, entry->validEnd.load());
+
+  const int channels =
+      std::min(dest.getNumChannels(), entry->ring.getNumChannels());
+  const int ringSize = entry->ring.getNumSamples();
+  for (juce::int64 pos = start; pos < end;) {
+    const int slot = static_cast<int>(pos % ringSize);
+    const int n =
+        static_cast<int>(std::min<juce::int64>(end - pos, ringSize - slot));
+    const int offset = destStart + static_cast<int>(pos - sourceStart);
+    for (int ch = 0; ch < channels; ++ch)
+      dest.copyFrom(ch, offset, entry->ring, ch, slot, n);
+    pos += n;
+  }
+  readCounter.fetch_add(1);
+
+  // Not prefetched yet: silence rather than a disk read on this thread
+  const int before = static_cast<int>(
+      std::clamp<juce::int64>(start - sourceStart, 0, count));
+  const int after = static_cast<int>(
+      std::clamp<juce::int64>(sourceStart + count - std::max(start, end), 0,
+                              count - before));
+  for (int ch = 0; ch < dest.getNumChannels(); ++ch) {
+    if (before > 0)
+      dest.clear(ch, destStart, before);
+    if (after > 0)
+      dest.clear(ch, destStart + count - after, after);
+    if (ch >= channels && before + after < count)
+      dest.clear(ch, destStart + before, count - before - after);
+  }
+  if (before + after > 0)
+    missedSamples.fetch_add(before + after);
+  return before + after == 0;
+}
+
+void ARASourcePrefetcher::workerLoop() {
+  std::unique_lock<std::mutex> lock(mutex);
+  while (!stopWorker) {
+    bool filled = false;
+    for (auto &source : sources)
+      filled = fillNext(*source) || filled;
+    if (!filled)
+      wakeWorker.wait_for(lock, std::chrono::milliseconds(5));
+  }
+}
+
+bool ARASourcePrefetcher::fillNext(Source &source) {
+  const juce::int64 ringSize = source.ring.getNumSamples();
+  const juce::int64 target =
+      std::clamp<juce::int64>(source.playPosition.load(), 0, source.length);
+  juce::int64 validStart = source.validStart.load();
+  juce::int64 validEnd = source.validEnd.load();
+
+  // Playback jumped outside the window: start a new one where it reads now
+  if (target < validStart || target > validEnd) {
+    source.validStart.store(target);
+    source.validEnd.store(target);
+    validStart = validEnd = target;
+    waitForReaders();
+  }
+
+  // Stay at most one ring ahead of playback, so the oldest slot reused is
+  // never one playback still needs
+  const int count = static_cast<int>(std::min<juce::int64>(
+      {static_cast<juce::int64>(readBlockSamples), source.length - validEnd,
+       target + ringSize - validEnd}));
+  if (count <= 0)
+    return false;
+
+  // The disk read: the audio thread keeps copying the current window
+  if (!source.reader->read(&scratch, 0, count, validEnd, true, true))
+    return false;
+
+  const juce::int64 newStart =
+      std::max(validStart, validEnd + count - ringSize);
+  if (newStart > validStart) {
+    source.validStart.store(newStart);
+    waitForReaders();
+  }
+
+  const int channels = source.ring.getNumChannels();
+  for (int written = 0; written < count;) {
+    const int slot = static_cast<int>((validEnd + written) % ringSize);
+    const int n = std::min(count - written, static_cast<int>(ringSize - slot));
+    for (int ch = 0; ch < channels; ++ch)
+      source.ring.copyFrom(ch, slot, scratch, ch, written, n);
+    written += n;
+  }
+  source.validEnd.store(validEnd + count);
+  return true;
+}
+
+void ARASourcePrefetcher::waitForReaders() const {
+  // Even: no read() was copying, and any later one sees the new window
+  const uint64_t count = readCounter.load();
+  if ((count & 1) == 0)
+    return;
+  while (readCounter.load() == count)
+    std::this_thread::yield();
+}
+
+#endif // JucePlugin_Enable_ARA
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "../JuceHeader.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#if JucePlugin_Enable_ARA
+
+/**
+ * Read-ahead copies of ARA audio sources for the playback renderer.
+ *
+ * Host ARA readers may block on disk, so the audio thread never calls them.
+ * A worker thread keeps a window of each source, starting where playback
+ * last read it, in a preallocated ring; the audio thread only copies out of
+ * the ring. Audio outside the window (just after a seek) reads as silence
+ * until the worker has caught up.
+ */
+class ARASourcePrefetcher {
+public:
+  ARASourcePrefetcher();
+  ~ARASourcePrefetcher();
+
+  // Message thread, not while read() may run: cache these sources, each in a
+  // window of up to windowSamples
+  void prepare(const std::vector<juce::ARAAudioSource *> &sources,
+               int numChannels, int windowSamples);
+  void release();
+
+  // Audio thread: count samples of source from sourceStart into dest at
+  // destStart. Samples not prefetched yet (all of them, for a source not
+  // passed to prepare()) are cleared; returns false if there were any.
+  bool read(const juce::ARAAudioSource *source, juce::int64 sourceStart,
+            juce::AudioBuffer<float> &dest, int destStart, int count);
+
+  // Samples read() had to clear because they were not prefetched yet
+  int64_t getMissedSamples() const { return missedSamples.load(); }
+
+private:
+  static constexpr int readBlockSamples = 1 << 14;
+
+  struct Source {
+    const juce::ARAAudioSource *source = nullptr;
+    std::unique_ptr<juce::ARAAudioSourceReader> reader; // Worker only
+    juce::AudioBuffer<float> ring; // Position p lives at p % ring size
+    juce::int64 length = 0;
+
+    // [validStart, validEnd) is in the ring; written by the worker
+    std::atomic<juce::int64> validStart{0};
+    std::atomic<juce::int64> validEnd{0};
+    // Where the audio thread last read; the window follows it
+    std::atomic<juce::int64> playPosition{0};
+  };
+
+  void workerLoop();
+  // Worker, holding mutex: extend one source's window by a block; false if
+  // it had nothing to do
+  bool fillNext(Source &source);
+  // Worker: wait until no read() started before now is still copying
+  void waitForReaders() const;
+
+  std::vector<std::unique_ptr<Source>> sources;
+  juce::AudioBuffer<float> scratch; // Worker only
+
+  // Odd while read() copies from a ring; see waitForReaders()
+  std::atomic<uint64_t> readCounter{0};
+  std::atomic<int64_t> missedSamples{0};
+
+  std::mutex mutex;
+  std::condition_variable wakeWorker;
+  bool stopWorker = false;
+  std::thread worker; // Last: starts in the constructor
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ARASourcePrefetcher)
+};
+
+#endif // JucePlugin_Enable_ARA
@@ -0,0 +1,259 @@
+#include "CaptureSpool.h"
+
+#include <algorithm>
+#include <chrono>
+
+CaptureSpool::CaptureSpool() : worker([this]() { writerLoop(); }) {}
+
+CaptureSpool::~CaptureSpool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopWriter = true;
+  }
+  wakeWriter.notify_all();
+  if (worker.joinable())
+    worker.join();
+  clearStorage();
+}
+
+void CaptureSpool::prepare(int channels, int fifoSamples) {
+  std::lock_guard<std::mutex> lock(mutex);
+  numChannels = std::max(0, channels);
+  fifoSamples = std::max(2, fifoSamples);
+  fifoBuffer.setSize(numChannels, fifoSamples);
+  fifo.setTotalSize(fifoSamples);
+  fifo.reset();
+  fillChunk.setSize(numChannels, chunkSamples);
+  clearStorage();
+
+  pushedPosition = 0;
+  takeStartPosition.store(0);
+  consumedPosition = 0;
+  storedTakeStart = 0;
+  discardRequested.store(false);
+}
+
+void CaptureSpool::beginTake() { takeStartPosition.store(pushedPosition); }
+
+int CaptureSpool::push(const juce::AudioBuffer<float> &input, int numSamples) {
+  if (numChannels == 0 || numSamples <= 0)
+    return 0;
+
+  int start1, size1, start2, size2;
+  fifo.prepareToWrite(numSamples, start1, size1, start2, size2);
+
+  const int channels = std::min(numChannels, input.getNumChannels());
+  for (int ch = 0; ch < numChannels; ++ch) {
+    if (ch < channels) {
+      if (size1 > 0)
+        fifoBuffer.copyFrom(ch, start1, input, ch, 0, size1);
+      if (size2 > 0)
+        fifoBuffer.copyFrom(ch, start2, input, ch, size1, size2);
+    } else {
+      fifoBuffer.clear(ch, start1, size1);
+      fifoBuffer.clear(ch, start2, size2);
+    }
+  }
+
+  const int written = size1 + size2;
+  fifo.finishedWrite(written);
+  pushedPosition += written;
+  if (written < numSamples)
+    droppedSamples.fetch_add(numSamples - written);
+  return written;
+}
+
+void CaptureSpool::writerLoop() {
+  std::unique_lock<std::mutex> lock(mutex);
+  while (!stopWriter) {
+    drain();
+    drained.notify_all();
+    wakeWriter.wait_for(lock, std::chrono::milliseconds(10));
+  }
+}
+
+void CaptureSpool::drain() {
+  if (discardRequested.exchange(false)) {
+    // Drop what is buffered too; the current take counts as stored, empty
+    const int ready = fifo.getNumReady();
+    fifo.finishedRead(ready);
+    consumedPosition += ready;
+    clearStorage();
+    storedTakeStart = takeStartPosition.load();
+  }
+
+  while (true) {
+    // Ready count first: samples of a new take are only visible after its
+    // start position is
+    int ready = fifo.getNumReady();
+    const int64_t takeStart = takeStartPosition.load();
+
+    if (storedTakeStart != takeStart && consumedPosition >= takeStart) {
+      clearStorage();
+      storedTakeStart = takeStart;
+    }
+    if (ready <= 0)
+      break;
+
+    // Samples before the newest take's start belong to an abandoned take
+    const bool skipping = storedTakeStart != takeStart;
+    if (skipping)
+      ready = static_cast<int>(
+          std::min<int64_t>(ready, takeStart - consumedPosition));
+
+    int start1, size1, start2, size2;
+    fifo.prepareToRead(ready, start1, size1, start2, size2);
+    if (!skipping) {
+      append(start1, size1);
+      append(start2, size2);
+    }
+    fifo.finishedRead(size1 + size2);
+    consumedPosition += size1 + size2;
+  }
+}
+
+void CaptureSpool::append(int fifoStart, int count) {
+  while (count > 0) {
+    const int n = std::min(count, chunkSamples - fillCount);
+    for (int ch = 0; ch < numChannels; ++ch)
+      fillChunk.copyFrom(ch, fillCount, fifoBuffer, ch, fifoStart, n);
+    fillCount += n;
+    fifoStart += n;
+    count -= n;
+    storedSamples += n;
+    if (fillCount == chunkSamples)
+      finishChunk();
+  }
+}
+
+void CaptureSpool::finishChunk() {
+  fillCount = 0;
+  const size_t chunkBytes = sizeof(float) * static_cast<size_t>(chunkSamples) *
+                            static_cast<size_t>(numChannels);
+
+  // Chunks stay in order: a memory prefix, then everything past the budget
+  // on disk
+  const bool fitsInMemory =
+      spilledChunks == 0 &&
+      (memoryChunks.size() + 1) * chunkBytes <= memoryBudgetBytes;
+  if (!fitsInMemory && spillFile == juce::File()) {
+    spillFile = juce::File::getSpecialLocation(juce::File::tempDirectory)
+                    .getNonexistentChildFile("HachiTuneCapture", ".raw");
+    spillStream = spillFile.createOutputStream();
+    if (spillStream == nullptr || spillStream->failedToOpen()) {
+      DBG("CaptureSpool: cannot open spill file, keeping capture in memory");
+      spillStream.reset();
+    }
+  }
+
+  if (fitsInMemory || (!spillStream && spilledChunks == 0)) {
+    memoryChunks.push_back(
+        std::make_unique<juce::AudioBuffer<float>>(fillChunk));
+    return;
+  }
+
+  bool written = spillStream != nullptr;
+  for (int ch = 0; ch < numChannels && written; ++ch)
+    written = spillStream->write(fillChunk.getReadPointer(ch),
+                                 sizeof(float) * chunkSamples);
+  if (written) {
+    ++spilledChunks;
+    return;
+  }
+
+  // Disk full or gone: later chunks have nowhere to go either
+  DBG("CaptureSpool: spill write failed, dropping capture audio");
+  spillStream.reset();
+  storedSamples -= chunkSamples;
+  droppedSamples.fetch_add(chunkSamples);
+}
+
+void CaptureSpool::clearStorage() {
+  memoryChunks.clear();
+  fillCount = 0;
+  storedSamples = 0;
+  spilledChunks = 0;
+  spillStream.reset();
+  if (spillFile != juce::File()) {
+    spillFile.deleteFile();
+    spillFile = juce::File();
+  }
+}
+
+void CaptureSpool::readChunk(int chunkIndex, int chunkOffset,
+                             juce::AudioBuffer<float> &out, int outStart,
+                             int count) {
+  if (chunkIndex < static_cast<int>(memoryChunks.size())) {
+    const auto &chunk = *memoryChunks[static_cast<size_t>(chunkIndex)];
+    for (int ch = 0; ch < numChannels; ++ch)
+      out.copyFrom(ch, outStart, chunk, ch, chunkOffset, count);
+    return;
+  }
+
+  const int64_t chunkBytes = static_cast<int64_t>(sizeof(float)) *
+                             chunkSamples * numChannels;
+  const int64_t chunkPosition =
+      (chunkIndex - static_cast<int64_t>(memoryChunks.size())) * chunkBytes;
+  juce::FileInputStream in(spillFile);
+  for (int ch = 0; ch < numChannels; ++ch) {
+    float *dest = out.getWritePointer(ch, outStart);
+    const int bytes = static_cast<int>(sizeof(float)) * count;
+    const int64_t offset =
+        chunkPosition + static_cast<int64_t>(sizeof(float)) *
+                            (static_cast<int64_t>(ch) * chunkSamples + chunkOffset);
+    if (!in.openedOk() || !in.setPosition(offset) ||
+        in.read(dest, bytes) != bytes)
+      juce::FloatVectorOperations::clear(dest, count);
+  }
+}
+
+void CaptureSpool::copyStored(int64_t start, juce::AudioBuffer<float> &out) {
+  if (spillStream)
+    spillStream->flush();
+
+  const int length = out.getNumSamples();
+  const int fullChunks =
+      static_cast<int>(memoryChunks.size()) + spilledChunks;
+  for (int written = 0; written < length;) {
+    const int64_t position = start + written;
+    const int chunkIndex = static_cast<int>(position / chunkSamples);
+    const int chunkOffset = static_cast<int>(position % chunkSamples);
+    const int count = std::min(chunkSamples - chunkOffset, length - written);
+    if (chunkIndex < fullChunks) {
+      readChunk(chunkIndex, chunkOffset, out, written, count);
+    } else {
+      for (int ch = 0; ch < numChannels; ++ch)
+        out.copyFrom(ch, written, fillChunk, ch, chunkOffset, count);
+    }
+    written += count;
+  }
+}
+
+juce::AudioBuffer<float> CaptureSpool::readTake(int numSamples) {
+  std::unique_lock<std::mutex> lock(mutex);
+  const int64_t takeStart = takeStartPosition.load();
+  wakeWriter.notify_one();
+  drained.wait_for(lock, std::chrono::seconds(5), [&]() {
+    return storedTakeStart == takeStart && storedSamples >= numSamples;
+  });
+
+  const int length =
+      storedTakeStart == takeStart
+          ? static_cast<int>(std::min<int64_t>(numSamples, storedSamples))
+          : 0;
+  juce::AudioBuffer<float> out(numChannels, std::max(0, length));
+  copyStored(0, out);
+  return out;
+}
+
+juce::AudioBuffer<float> CaptureSpool::readStored(int startSample,
+                                                  int numSamples) {
+  std::lock_guard<std::mutex> lock(mutex);
+  int length = 0;
+  if (storedTakeStart == takeStartPosition.load() && startSample >= 0)
+    length = static_cast<int>(std::clamp<int64_t>(
+        storedSamples - startSample, 0, std::max(0, numSamples)));
+  juce::AudioBuffer<float> out(numChannels, length);
+  copyStored(startSample, out);
+  return out;
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include "../JuceHeader.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Growable storage for a host capture, fed from the audio thread.
+ *
+ * The audio thread only copies into a preallocated single-producer FIFO.
+ * A writer thread drains it into fixed-size chunks, kept in memory up to a
+ * budget and appended to a temporary file past it, so a take is limited by
+ * disk space rather than by a buffer sized up front.
+ */
+class CaptureSpool {
+public:
+  CaptureSpool();
+  ~CaptureSpool();
+
+  // Size the FIFO and drop any stored take. Not while push() may run.
+  void prepare(int numChannels, int fifoSamples);
+  int getNumChannels() const { return numChannels; }
+
+  // Audio thread: the next pushed sample starts a new take
+  void beginTake();
+  // Audio thread: append to the current take; returns the samples taken,
+  // fewer than numSamples if the writer fell behind
+  int push(const juce::AudioBuffer<float> &input, int numSamples);
+
+  // Message thread: the first numSamples of the current take, once the
+  // writer has stored them
+  juce::AudioBuffer<float> readTake(int numSamples);
+  // Message thread: up to numSamples of the current take from startSample
+  // on, as far as the writer has stored it; never waits
+  juce::AudioBuffer<float> readStored(int startSample, int numSamples);
+
+  // Free the stored take; the writer does it, so this never blocks
+  void discard() { discardRequested.store(true); }
+
+  // Samples lost because the FIFO was full
+  int64_t getDroppedSamples() const { return droppedSamples.load(); }
+
+private:
+  static constexpr int chunkSamples = 1 << 16;
+  static constexpr size_t memoryBudgetBytes = size_t{256} << 20;
+
+  void writerLoop();
+  // The rest hold mutex
+  void drain();
+  void append(int fifoStart, int count);
+  void finishChunk();
+  void clearStorage();
+  void readChunk(int chunkIndex, int chunkOffset, juce::AudioBuffer<float> &out,
+                 int outStart, int count);
+  // Samples [start, start + out.getNumSamples()) of the stored take
+  void copyStored(int64_t start, juce::AudioBuffer<float> &out);
+
+  int numChannels = 0;
+
+  // Written by the audio thread, read by the writer
+  juce::AbstractFifo fifo{1};
+  juce::AudioBuffer<float> fifoBuffer;
+  int64_t pushedPosition = 0; // Audio thread only
+  std::atomic<int64_t> takeStartPosition{0};
+  std::atomic<int64_t> droppedSamples{0};
+  std::atomic<bool> discardRequested{false};
+
+  // Writer state: the stored take is memoryChunks, then spilledChunks in
+  // spillFile, then the first fillCount samples of fillChunk
+  int64_t consumedPosition = 0;
+  int64_t storedTakeStart = -1;
+  int64_t storedSamples = 0;
+  std::vector<std::unique_ptr<juce::AudioBuffer<float>>> memoryChunks;
+  juce::AudioBuffer<float> fillChunk;
+  int fillCount = 0;
+  int spilledChunks = 0;
+  juce::File spillFile;
+  std::unique_ptr<juce::FileOutputStream> spillStream;
+
+  std::mutex mutex;
+  std::condition_variable wakeWriter;
+  std::condition_variable drained;
+  bool stopWriter = false;
+  std::thread worker; // Last: starts in the constructor
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(CaptureSpool)
+};
@@ -78,11 +78,29 @@ HostCompatibility::HostType HostCompatibility::detectHostType(juce::AudioProcess
     // AAX is Pro Tools
 #if JucePlugin_Build_AAX
     return HostType::ProTools;
-#endif
-
-    // For VST3/AU, we can't reliably detect the host from wrapper type alone
-    // Return Unknown and let ARA detection handle it
+#else
+    // Nuendo before Cubase: both are Steinberg hosts of one code base
+    const juce::PluginHostType host;
+    if (host.isStudioOne())
+        return HostType::StudioOne;
+    if (host.isNuendo())
+        return HostType::Nuendo;
+    if (host.isCubase())
+        return HostType::Cubase;
+    if (host.isLogic())
+        return HostType::LogicPro;
+    if (host.isProTools())
+        return HostType::ProTools;
+    if (host.isReaper())
+        return HostType::Reaper;
+    if (host.isFruityLoops())
+        return HostType::FLStudio;
+    if (host.isAbletonLive())
+        return HostType::AbletonLive;
+    if (host.isBitwigStudio())
+        return HostType::Bitwig;
     return HostType::Unknown;
+#endif
 }
 
 HostCompatibility::HostInfo HostCompatibility::detectHost(juce::AudioProcessor* processor) {
@@ -113,3 +131,42 @@ HostCompatibility::HostInfo HostCompatibility::detectHost(juce::AudioProcessor*
 juce::String HostCompatibility::getRecommendedMode(const HostInfo& info) {
     return info.supportsARA ? "ARA Mode (Recommended)" : "Non-ARA Mode (Auto-capture)";
 }
+
+HostCompatibility::PerformanceProfile HostCompatibility::createProfile(const juce::String& name) {
+    PerformanceProfile profile;
+    profile.name = name;
+
+    if (name == "conservative") {
+        profile.prefetchSeconds = 15;
+        // Blocks can be tiny and irregular (FL Studio), so a stop counted
+        // in blocks alone could end a take within a millisecond
+        profile.captureStopSeconds = 0.25;
+        profile.displayFrameRate = 30;
+        profile.lowPriorityRenders = true;
+    } else if (name == "aggressive") {
+        profile.prefetchSeconds = 60;
+        profile.holdBackgroundOffline = false;
+    } else {
+        profile.name = "balanced";
+    }
+    return profile;
+}
+
+HostCompatibility::PerformanceProfile HostCompatibility::getPerformanceProfile(const HostInfo& info,
+                                                                               const juce::String& choice) {
+    if (choice == "conservative" || choice == "balanced" || choice == "aggressive")
+        return createProfile(choice);
+
+    switch (info.type) {
+        case HostType::FLStudio:
+            return createProfile("conservative");
+
+        case HostType::StudioOne:
+            // ARA sources are read ahead off the audio thread, so a longer
+            // window costs memory, not audio-thread time
+            return createProfile(info.supportsARA ? "aggressive" : "balanced");
+
+        default:
+            return createProfile("balanced");
+    }
+}
@@ -29,11 +29,30 @@ public:
         juce::String notes;
     };
 
+    /**
+     * How much work the plugin takes on in a host, applied by the processor
+     * when playback is prepared. Profiles are named "conservative",
+     * "balanced" and "aggressive"; by default the host picks one.
+     */
+    struct PerformanceProfile {
+        juce::String name;
+        int prefetchSeconds = 30;          // ARA read-ahead window per source
+        double captureStopSeconds = 0.035; // Host stopped this long ends a capture take
+        bool holdBackgroundOffline = true; // Background jobs wait out offline renders
+        int displayFrameRate = 0;          // UI frames per second; 0 = every refresh
+        bool lowPriorityRenders = false;   // Analysis and renders at background OS priority
+    };
+
     static HostInfo detectHost(juce::AudioProcessor* processor);
     static bool hostSupportsARA(const HostInfo& info) { return info.supportsARA; }
     static juce::String getRecommendedMode(const HostInfo& info);
 
+    // choice is a profile name, or "auto" (or anything else) for the host's own
+    static PerformanceProfile getPerformanceProfile(const HostInfo& info,
+                                                    const juce::String& choice = "auto");
+
 private:
     static HostType detectHostType(juce::AudioProcessor* processor);
     static HostInfo createHostInfo(HostType type);
+    static PerformanceProfile createProfile(const juce::String& name);
 };
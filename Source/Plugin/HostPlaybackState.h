@@ -0,0 +1,15 @@
+#pragma once
+
+#include "../Utils/PublishedState.h"
+#include <memory>
+
+/**
+ * Host transport as seen by the plugin's audio thread. The audio thread
+ * publishes it every block; the editor polls it once per display frame.
+ */
+struct HostPlaybackStatus {
+  double timeSeconds = 0.0;
+  bool playing = false;
+};
+
+using HostPlaybackState = PublishedState<HostPlaybackStatus>;
@@ -1,34 +1,33 @@
 #include "NonAraCaptureController.h"
+#include "../Utils/RealtimeCheck.h"
 
 #include <algorithm>
 #include <cmath>
+#include <limits>
 
-void NonAraCaptureController::prepare(double sampleRate, int numChannels,
-                                      int maxCaptureSeconds) {
-  juce::ignoreUnused(sampleRate);
-
-  const int maxSamples = static_cast<int>(sampleRate * maxCaptureSeconds);
-
-  {
-    const juce::SpinLock::ScopedLockType lock(bufferLock);
-    captureBuffer.setSize(numChannels, maxSamples);
-    captureBuffer.clear();
-    capturePosition = 0;
-    finalLength = 0;
-    stopDebounceBlocks = 0;
-  }
+void NonAraCaptureController::prepare(double newSampleRate, int numChannels) {
+  sampleRate = newSampleRate;
+  spool.prepare(numChannels, static_cast<int>(sampleRate * kFifoSeconds));
+  capturePosition = 0;
+  finalLength.store(0);
+  stopDebounceBlocks = 0;
+  stoppedSamples = 0;
+  setStopDebounceSeconds(stopDebounceSeconds);
 
   analysisPending.store(false);
   shouldFinalizeFlag.store(false);
   state.store(State::WaitingForAudio);
 }
 
+void NonAraCaptureController::setStopDebounceSeconds(double seconds) {
+  stopDebounceSeconds = std::max(0.0, seconds);
+  stopDebounceSamples.store(
+      static_cast<int>(std::ceil(stopDebounceSeconds * sampleRate)));
+}
+
 void NonAraCaptureController::resetToWaiting() {
-  const juce::SpinLock::ScopedLockType lock(bufferLock);
-  captureBuffer.clear();
-  capturePosition = 0;
-  finalLength = 0;
-  stopDebounceBlocks = 0;
+  // The spool drops the old take when the next one begins
+  finalLength.store(0);
   analysisPending.store(false);
   shouldFinalizeFlag.store(false);
   state.store(State::WaitingForAudio);
@@ -36,6 +35,7 @@ void NonAraCaptureController::resetToWaiting() {
 
 void NonAraCaptureController::processBlock(
     const juce::AudioBuffer<float> &input, bool hostIsPlaying) {
+  REALTIME_SCOPE("NonAraCaptureController::processBlock");
   if (analysisPending.load())
     return;
 
@@ -51,9 +51,12 @@ void NonAraCaptureController::processBlock(
     }
 
     if (maxLevel > audioThreshold) {
-      const juce::SpinLock::ScopedLockType lock(bufferLock);
+      spool.beginTake();
       capturePosition = 0;
+      capturedSamples.store(0);
+      takeNumber.fetch_add(1);
       stopDebounceBlocks = 0;
+      stoppedSamples = 0;
       state.store(State::Capturing);
       shouldFinalizeFlag.store(false);
       return;
@@ -67,25 +70,24 @@ void NonAraCaptureController::processBlock(
 
   if (hostIsPlaying) {
     stopDebounceBlocks = 0;
+    stoppedSamples = 0;
 
-    const juce::SpinLock::ScopedLockType lock(bufferLock);
-    int spaceLeft = captureBuffer.getNumSamples() - capturePosition;
-    int toCopy = std::min(input.getNumSamples(), spaceLeft);
-
-    if (toCopy > 0) {
-      int channelsToCopy =
-          std::min(input.getNumChannels(), captureBuffer.getNumChannels());
-      for (int ch = 0; ch < channelsToCopy; ++ch)
-        captureBuffer.copyFrom(ch, capturePosition, input, ch, 0, toCopy);
-      capturePosition += toCopy;
-    }
+    // Sample counts are ints downstream
+    const int spaceLeft = std::numeric_limits<int>::max() - capturePosition;
+    const int toCopy = std::min(input.getNumSamples(), spaceLeft);
+    if (toCopy > 0)
+      capturePosition += spool.push(input, toCopy);
+    capturedSamples.store(capturePosition);
 
-    if (capturePosition >= captureBuffer.getNumSamples()) {
+    if (toCopy < input.getNumSamples())
       shouldFinalizeFlag.store(true);
-    }
   } else {
     ++stopDebounceBlocks;
-    if (stopDebounceBlocks >= kStopDebounceBlocks)
+    stoppedSamples = static_cast<int>(std::min<juce::int64>(
+        static_cast<juce::int64>(stoppedSamples) + input.getNumSamples(),
+        std::numeric_limits<int>::max()));
+    if (stopDebounceBlocks >= kStopDebounceBlocks &&
+        stoppedSamples >= stopDebounceSamples.load())
       shouldFinalizeFlag.store(true);
   }
 }
@@ -97,62 +99,46 @@ bool NonAraCaptureController::finalizeCapture(double hostSampleRate,
 
   const int minSamples = static_cast<int>(hostSampleRate * minCaptureSeconds);
 
-  int captured = 0;
-  int channels = 0;
-  {
-    const juce::SpinLock::ScopedLockType lock(bufferLock);
-    captured = capturePosition;
-    channels = captureBuffer.getNumChannels();
-  }
-
-  if (captured < minSamples) {
+  if (capturePosition < minSamples) {
     resetToWaiting();
     return false;
   }
 
-  {
-    const juce::SpinLock::ScopedLockType lock(bufferLock);
-    finalLength = capturePosition;
-  }
-
+  finalLength.store(capturePosition);
   analysisPending.store(true);
   shouldFinalizeFlag.store(false);
   state.store(State::Complete);
 
-  out.numChannels = channels;
-  out.numSamples = finalLength;
+  out.numChannels = spool.getNumChannels();
+  out.numSamples = capturePosition;
   out.sampleRate = hostSampleRate;
   return true;
 }
 
 juce::AudioBuffer<float>
-NonAraCaptureController::copyCapturedAudio(int numSamples) const {
-  juce::AudioBuffer<float> trimmed;
-
-  const juce::SpinLock::ScopedLockType lock(bufferLock);
-  int length = std::min(numSamples, captureBuffer.getNumSamples());
-  trimmed.setSize(captureBuffer.getNumChannels(), length);
-  for (int ch = 0; ch < captureBuffer.getNumChannels(); ++ch)
-    trimmed.copyFrom(ch, 0, captureBuffer, ch, 0, length);
+NonAraCaptureController::copyCapturedAudio(int numSamples) {
+  auto captured =
+      spool.readTake(std::min(numSamples, finalLength.load()));
+  if (spool.getDroppedSamples() > 0)
+    DBG("NonAraCaptureController: capture dropped "
+        << static_cast<juce::int64>(spool.getDroppedSamples()) << " samples");
+  return captured;
+}
 
-  return trimmed;
+juce::AudioBuffer<float>
+NonAraCaptureController::copyCaptureSoFar(int startSample, int numSamples) {
+  return spool.readStored(startSample, numSamples);
 }
 
 void NonAraCaptureController::onAnalysisDispatched() {
   analysisPending.store(false);
   shouldFinalizeFlag.store(false);
-  stopDebounceBlocks = 0;
   state.store(State::WaitingForAudio);
 }
 
 void NonAraCaptureController::stop() {
-  {
-    const juce::SpinLock::ScopedLockType lock(bufferLock);
-    captureBuffer.clear();
-    capturePosition = 0;
-    finalLength = 0;
-    stopDebounceBlocks = 0;
-  }
+  spool.discard();
+  finalLength.store(0);
   analysisPending.store(false);
   shouldFinalizeFlag.store(false);
   state.store(State::Idle);
@@ -1,7 +1,9 @@
 #pragma once
 
 #include "../JuceHeader.h"
+#include "CaptureSpool.h"
 #include <atomic>
+#include <cstdint>
 
 class NonAraCaptureController {
 public:
@@ -13,7 +15,7 @@ public:
     double sampleRate = 44100.0;
   };
 
-  void prepare(double sampleRate, int numChannels, int maxCaptureSeconds);
+  void prepare(double sampleRate, int numChannels);
 
   // Called from audio thread
   void resetToWaiting();
@@ -27,8 +29,16 @@ public:
   // Called from audio thread
   bool finalizeCapture(double hostSampleRate, FinalizeResult &out);
 
-  // Called from message thread
-  juce::AudioBuffer<float> copyCapturedAudio(int numSamples) const;
+  // Called from message thread; waits for the spool writer to store the take
+  juce::AudioBuffer<float> copyCapturedAudio(int numSamples);
+
+  // Called from message thread while capturing: what the spool has stored of
+  // the current take from startSample on, without waiting for the rest
+  juce::AudioBuffer<float> copyCaptureSoFar(int startSample, int numSamples);
+
+  // Samples captured in the current take, and which take that is
+  int getCapturedSamples() const { return capturedSamples.load(); }
+  uint32_t getTakeNumber() const { return takeNumber.load(); }
 
   // Called from message thread after the captured audio has been copied out and
   // dispatched for analysis.
@@ -42,22 +52,35 @@ public:
 
   void setAudioThreshold(float t) { audioThreshold = t; }
   void setMinCaptureSeconds(double seconds) { minCaptureSeconds = seconds; }
+  // Message thread: how long the host must stay stopped before a take ends,
+  // on top of kStopDebounceBlocks blocks (see HostCompatibility's profiles)
+  void setStopDebounceSeconds(double seconds);
 
 private:
   std::atomic<State> state{State::Idle};
 
-  mutable juce::SpinLock bufferLock;
+  // The audio thread only pushes into the spool's FIFO; a writer thread
+  // moves the take into memory or a temp file, so takes have no fixed cap
+  CaptureSpool spool;
 
-  juce::AudioBuffer<float> captureBuffer;
+  // Audio thread only
   int capturePosition = 0;
   int stopDebounceBlocks = 0;
-  int finalLength = 0;
+  int stoppedSamples = 0;
 
+  std::atomic<int> capturedSamples{0};
+  std::atomic<uint32_t> takeNumber{0};
+  std::atomic<int> finalLength{0};
   std::atomic<bool> analysisPending{false};
   std::atomic<bool> shouldFinalizeFlag{false};
 
   float audioThreshold = 0.001f;
   double minCaptureSeconds = 0.5;
+  double sampleRate = 44100.0;
+  double stopDebounceSeconds = 0.0;
+  std::atomic<int> stopDebounceSamples{0};
 
   static constexpr int kStopDebounceBlocks = 3;
+  // Audio the writer may fall behind by before samples are dropped
+  static constexpr int kFifoSeconds = 4;
 };
@@ -1,6 +1,8 @@
 #include "PluginEditor.h"
 #include "HostCompatibility.h"
 
+#include <algorithm>
+
 #if JucePlugin_Enable_ARA
 #include "ARADocumentController.h"
 #endif
@@ -8,141 +10,94 @@
 HachiTuneAudioProcessorEditor::HachiTuneAudioProcessorEditor(
     HachiTuneAudioProcessor &p)
     : AudioProcessorEditor(&p), audioProcessor(p),
-      mainView(createMainView(false))
+      mainView(&p.getOrCreateMainView())
 #if JucePlugin_Enable_ARA
       ,
       AudioProcessorEditorARAExtension(&p)
 #endif
 {
-  // Initialize UI resources
-  initializeUiResources();
-
   // Enable keyboard focus for the editor
   setWantsKeyboardFocus(true);
 
-  addAndMakeVisible(*mainView->getComponent());
-  audioProcessor.setMainComponent(mainView.get());
-
 #if JucePlugin_Enable_ARA
   setupARAMode();
 #else
-  setupNonARAMode();
+  audioProcessor.attachEditorMode(nullptr);
 #endif
 
-  setupCallbacks();
-
-  auto size = getDefaultMainViewSize(this);
+  // A reopened editor comes back at the size it was closed at
+  auto *view = mainView->getComponent();
+  const auto size = view->getWidth() > 0 && view->getHeight() > 0
+                        ? juce::Point<int>(view->getWidth(), view->getHeight())
+                        : getDefaultMainViewSize(this);
+  addAndMakeVisible(*view);
   setSize(size.x, size.y);
   setResizable(true, true);
 
   // Grab keyboard focus on mainComponent when editor is shown
-  mainView->getComponent()->grabKeyboardFocus();
+  view->grabKeyboardFocus();
+  audioProcessor.setEditorShowing(true);
 }
 
 HachiTuneAudioProcessorEditor::~HachiTuneAudioProcessorEditor() {
-  audioProcessor.setMainComponent(nullptr);
-  shutdownUiResources();
+  audioProcessor.setEditorShowing(false);
+#if JucePlugin_Enable_ARA
+  if (araDocController) {
+    if (auto *editorView = getARAEditorView())
+      editorView->removeListener(this);
+  }
+#endif
+  // The view and the engine behind it stay with the processor
+  removeChildComponent(mainView->getComponent());
 }
 
 void HachiTuneAudioProcessorEditor::setupARAMode() {
 #if JucePlugin_Enable_ARA
-  mainView->setARAMode(true);
-
   auto *editorView = getARAEditorView();
-  if (!editorView) {
-    setupNonARAMode();
-    return;
-  }
-
-  auto *docController = editorView->getDocumentController();
-  if (!docController) {
-    setupNonARAMode();
+  auto *docController =
+      editorView ? editorView->getDocumentController() : nullptr;
+  auto *pitchDocController =
+      docController
+          ? juce::ARADocumentControllerSpecialisation::
+                getSpecialisedDocumentController<HachiTuneDocumentController>(
+                    docController)
+          : nullptr;
+
+  // Without one the view falls back to non-ARA capture
+  audioProcessor.attachEditorMode(pitchDocController);
+  if (!pitchDocController)
     return;
-  }
 
-  auto *pitchDocController = juce::ARADocumentControllerSpecialisation::
-      getSpecialisedDocumentController<HachiTuneDocumentController>(
-          docController);
-
-  if (!pitchDocController) {
-    setupNonARAMode();
-    return;
-  }
-
-  // Connect ARA controller to UI
-  pitchDocController->setMainComponent(mainView.get());
-  pitchDocController->setRealtimeProcessor(
-      &audioProcessor.getRealtimeProcessor());
-
-  // Setup re-analyze callback
-  mainView->setOnReanalyzeRequested([pitchDocController]() {
-    pitchDocController->reanalyze();
-  });
-
-  mainView->setOnRequestHostPlayState([this](bool shouldPlay) {
-    audioProcessor.requestHostPlayState(shouldPlay);
-  });
-
-  mainView->setOnRequestHostStop([this]() {
-    audioProcessor.requestHostStop();
-  });
-
-  mainView->setOnRequestHostSeek([this](double timeInSeconds) {
-    audioProcessor.requestHostSeek(timeInSeconds);
-  });
-
-  // Check for existing audio sources
-  auto *juceDocument = docController->getDocument();
-  if (juceDocument) {
-    auto &audioSources = juceDocument->getAudioSources<juce::ARAAudioSource>();
-
-    if (!audioSources.empty()) {
-      // Process first audio source
-      auto *source = audioSources.front();
-      if (source && source->getSampleCount() > 0) {
-        juce::ARAAudioSourceReader reader(source);
-        int numSamples = static_cast<int>(source->getSampleCount());
-        int numChannels = source->getChannelCount();
-        double sampleRate = source->getSampleRate();
-
-        juce::AudioBuffer<float> buffer(numChannels, numSamples);
-        if (reader.read(&buffer, 0, numSamples, 0, true, true)) {
-          mainView->setHostAudio(buffer, sampleRate);
-          return;
-        }
-      }
-    }
-  }
+  // Host selection and hidden tracks order the analysis queue
+  araDocController = pitchDocController;
+  editorView->addListener(this);
 #endif
 }
 
-void HachiTuneAudioProcessorEditor::setupNonARAMode() {
-  mainView->setARAMode(false);
-
-  // Setup host transport control callbacks for non-ARA mode
-  mainView->setOnRequestHostPlayState([this](bool shouldPlay) {
-    audioProcessor.requestHostPlayState(shouldPlay);
-  });
-
-  mainView->setOnRequestHostStop([this]() {
-    audioProcessor.requestHostStop();
-  });
-
-  mainView->setOnRequestHostSeek([this](double timeInSeconds) {
-    audioProcessor.requestHostSeek(timeInSeconds);
-  });
+#if JucePlugin_Enable_ARA
+void HachiTuneAudioProcessorEditor::onNewSelection(
+    const juce::ARAViewSelection &viewSelection) {
+  std::vector<juce::ARAAudioSource *> sources;
+  for (auto *region :
+       viewSelection.getPlaybackRegions<juce::ARAPlaybackRegion>()) {
+    auto *source = region->getAudioModification()->getAudioSource();
+    if (std::find(sources.begin(), sources.end(), source) == sources.end())
+      sources.push_back(source);
+  }
+  if (araDocController && !sources.empty())
+    araDocController->selectAudioSources(sources);
 }
 
-void HachiTuneAudioProcessorEditor::setupCallbacks() {
-  // When project data changes (analysis complete or synthesis complete)
-  mainView->setOnProjectDataChanged([this]() {
-    mainView->bindRealtimeProcessor(audioProcessor.getRealtimeProcessor());
-    audioProcessor.getRealtimeProcessor().invalidate();
-  });
-
-  // onPitchEditFinished is handled by onProjectDataChanged (called after async
-  // synthesis completes) No need for separate callback here
+void HachiTuneAudioProcessorEditor::onHideRegionSequences(
+    const std::vector<juce::ARARegionSequence *> &regionSequences) {
+  std::vector<juce::ARAAudioSource *> sources;
+  for (auto *sequence : regionSequences)
+    for (auto *region : sequence->getPlaybackRegions<juce::ARAPlaybackRegion>())
+      sources.push_back(region->getAudioModification()->getAudioSource());
+  if (araDocController)
+    araDocController->setHiddenAudioSources(sources);
 }
+#endif
 
 void HachiTuneAudioProcessorEditor::paint(juce::Graphics &) {
   // MainComponent handles all painting
@@ -153,6 +108,8 @@ void HachiTuneAudioProcessorEditor::resized() {
 }
 
 void HachiTuneAudioProcessorEditor::visibilityChanged() {
+  // Hosts that hide rather than close the editor window
+  audioProcessor.setEditorShowing(isVisible());
   if (isVisible())
     mainView->getComponent()->grabKeyboardFocus();
 }
@@ -3,12 +3,16 @@
 #include "../JuceHeader.h"
 #include "../UI/IMainView.h"
 #include "../UI/MainViewFactory.h"
-#include <memory>
 #include "PluginProcessor.h"
 
+#if JucePlugin_Enable_ARA
+class HachiTuneDocumentController;
+#endif
+
 class HachiTuneAudioProcessorEditor : public juce::AudioProcessorEditor
 #if JucePlugin_Enable_ARA
     , public juce::AudioProcessorEditorARAExtension
+    , private juce::ARAEditorView::Listener
 #endif
 {
 public:
@@ -26,11 +30,18 @@ public:
 
 private:
     void setupARAMode();
-    void setupNonARAMode();
-    void setupCallbacks();
+
+#if JucePlugin_Enable_ARA
+    // ARAEditorView::Listener
+    void onNewSelection(const juce::ARAViewSelection& viewSelection) override;
+    void onHideRegionSequences(
+        const std::vector<juce::ARARegionSequence*>& regionSequences) override;
+
+    HachiTuneDocumentController* araDocController = nullptr;
+#endif
 
     HachiTuneAudioProcessor& audioProcessor;
-    std::unique_ptr<IMainView> mainView;
+    IMainView* mainView = nullptr; // Owned by the processor; outlives the editor
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(HachiTuneAudioProcessorEditor)
 };
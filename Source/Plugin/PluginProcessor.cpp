@@ -1,8 +1,32 @@
 #include "PluginProcessor.h"
+#include "../Audio/HardwareCapabilities.h"
+#include "../Audio/PerformanceMetrics.h"
+#include "../Audio/RMVPEPitchDetector.h"
 #include "../UI/IMainView.h"
+#include "../UI/Main/SettingsManager.h"
+#include "../UI/MainViewFactory.h"
+#include "../Utils/AppLogger.h"
+#include "../Utils/JobSystem.h"
 #include "../Utils/Localization.h"
+#include "../Utils/RealtimeCheck.h"
 #include "PluginEditor.h"
 
+#if JucePlugin_Enable_ARA
+#include "ARADocumentController.h"
+#endif
+
+namespace {
+// Appended to the project state: magic, version, flags
+constexpr juce::uint32 pluginStateMagic = 0x6c705448; // "HTpl"
+constexpr int pluginStateVersion = 1;
+constexpr size_t pluginStateTrailerSize = 12;
+constexpr int lookaheadFlag = 1;
+constexpr int liveFlag = 2;
+// Live key and scale, four bits each, above the flags
+constexpr int liveKeyShift = 8;
+constexpr int liveScaleShift = 12;
+} // namespace
+
 HachiTuneAudioProcessor::HachiTuneAudioProcessor()
 #ifndef JucePlugin_PreferredChannelConfigurations
     : AudioProcessor(
@@ -11,9 +35,58 @@ HachiTuneAudioProcessor::HachiTuneAudioProcessor()
               .withOutput("Output", juce::AudioChannelSet::stereo(), true))
 #endif
 {
+  // Starts the log writer here rather than on a first message from the
+  // audio thread, and stops it before the plugin can be unloaded. The job
+  // workers and the GPU enumeration likewise.
+  AppLogger::init();
+  JobSystem::init();
+  HardwareCapabilities::init();
+
+  // Not automatable: every change moves the latency the host compensates
+  lookaheadParam = new juce::AudioParameterBool(
+      juce::ParameterID{"lookahead", 1}, "Lookahead", false,
+      juce::AudioParameterBoolAttributes().withAutomatable(false));
+  addParameter(lookaheadParam);
+  lookaheadParam->addListener(this);
+
+  // Live monitoring; the mode moves the latency, key and scale don't
+  liveParam = new juce::AudioParameterBool(
+      juce::ParameterID{"live", 1}, "Live Monitoring", false,
+      juce::AudioParameterBoolAttributes().withAutomatable(false));
+  addParameter(liveParam);
+  liveParam->addListener(this);
+  liveKeyParam = new juce::AudioParameterChoice(
+      juce::ParameterID{"liveKey", 1}, "Live Key",
+      juce::StringArray{"C", "C#", "D", "D#", "E", "F", "F#", "G", "G#", "A",
+                        "A#", "B"},
+      0);
+  addParameter(liveKeyParam);
+  liveScaleParam = new juce::AudioParameterChoice(
+      juce::ParameterID{"liveScale", 1}, "Live Scale",
+      juce::StringArray{"Chromatic", "Major", "Minor"}, 0);
+  addParameter(liveScaleParam);
 }
 
-HachiTuneAudioProcessor::~HachiTuneAudioProcessor() = default;
+HachiTuneAudioProcessor::~HachiTuneAudioProcessor() {
+  hostPollTimer.stopTimer();
+  lookaheadParam->removeListener(this);
+  liveParam->removeListener(this);
+  cancelPendingUpdate();
+  if (mainComponent) {
+#if JucePlugin_Enable_ARA
+    if (araDocController &&
+        araDocController->getMainComponent() == mainComponent.get())
+      araDocController->setMainComponent(nullptr);
+#endif
+    realtimeProcessor.setProject(nullptr);
+    realtimeProcessor.setVocoder(nullptr);
+    mainComponent.reset();
+    shutdownUiResources();
+  }
+  HardwareCapabilities::shutdown();
+  JobSystem::shutdown();
+  AppLogger::shutdown();
+}
 
 const juce::String HachiTuneAudioProcessor::getName() const {
   return JucePlugin_Name;
@@ -46,7 +119,17 @@ bool HachiTuneAudioProcessor::isMidiEffect() const {
 void HachiTuneAudioProcessor::prepareToPlay(double sampleRate,
                                             int samplesPerBlock) {
   hostSampleRate = sampleRate;
+  applyPerformanceProfile();
+  realtimeProcessor.setLookaheadEnabled(lookaheadParam->get());
   realtimeProcessor.prepareToPlay(sampleRate, samplesPerBlock);
+  liveMonitor.prepare(sampleRate, getMainBusNumOutputChannels(),
+                      samplesPerBlock);
+  liveMonitor.setEnabled(liveParam->get());
+  updateLatency();
+  outputBufferChannels =
+      juce::jmax(getTotalNumInputChannels(), getTotalNumOutputChannels());
+  outputBufferSamples = samplesPerBlock;
+  outputBuffer.setSize(outputBufferChannels, outputBufferSamples);
 
 #if JucePlugin_Enable_ARA
   prepareToPlayForARA(sampleRate, samplesPerBlock,
@@ -54,11 +137,30 @@ void HachiTuneAudioProcessor::prepareToPlay(double sampleRate,
 #endif
 
   // Non-ARA capture controller
-  captureController->prepare(sampleRate, getMainBusNumOutputChannels(),
-                             MAX_CAPTURE_SECONDS);
+  captureController->prepare(sampleRate, getMainBusNumOutputChannels());
   lastCaptureUiState = captureController->getState();
 }
 
+void HachiTuneAudioProcessor::parameterValueChanged(int, float) {
+  triggerAsyncUpdate();
+}
+
+void HachiTuneAudioProcessor::handleAsyncUpdate() {
+  realtimeProcessor.setLookaheadEnabled(lookaheadParam->get());
+  liveMonitor.setEnabled(liveParam->get());
+  updateLatency();
+}
+
+void HachiTuneAudioProcessor::updateLatency() {
+  // Live monitoring takes over the whole non-ARA path while it is on
+  if (liveMonitor.isActive())
+    setLatencySamples(liveMonitor.getLatencySamples());
+  else if (realtimeProcessor.isLookaheadActive())
+    setLatencySamples(realtimeProcessor.getLookaheadLatency());
+  else
+    setLatencySamples(0);
+}
+
 void HachiTuneAudioProcessor::releaseResources() {
 #if JucePlugin_Enable_ARA
   releaseResourcesForARA();
@@ -95,6 +197,22 @@ HostCompatibility::HostInfo HachiTuneAudioProcessor::getHostInfo() const {
       const_cast<HachiTuneAudioProcessor *>(this));
 }
 
+void HachiTuneAudioProcessor::applyPerformanceProfile() {
+  performanceProfile = HostCompatibility::getPerformanceProfile(
+      getHostInfo(), SettingsManager::readHostProfile());
+  captureController->setStopDebounceSeconds(
+      performanceProfile.captureStopSeconds);
+  holdBackgroundOffline = performanceProfile.holdBackgroundOffline;
+  JobSystem::getInstance().setNormalJobsInBackground(
+      performanceProfile.lowPriorityRenders);
+  if (mainComponent)
+    mainComponent->setDisplayFrameRate(performanceProfile.displayFrameRate);
+#if JucePlugin_Enable_ARA
+  if (auto *renderer = getPlaybackRenderer<HachiTunePlaybackRenderer>())
+    renderer->setPrefetchSeconds(performanceProfile.prefetchSeconds);
+#endif
+}
+
 juce::String HachiTuneAudioProcessor::getHostStatusMessage() const {
   auto hostInfo = getHostInfo();
   bool araActive = isARAModeActive();
@@ -111,8 +229,11 @@ juce::String HachiTuneAudioProcessor::getHostStatusMessage() const {
 
 void HachiTuneAudioProcessor::processBlock(juce::AudioBuffer<float> &buffer,
                                            juce::MidiBuffer &midiMessages) {
-  juce::ignoreUnused(midiMessages);
+  REALTIME_SCOPE_IF("HachiTuneAudioProcessor::processBlock", !isNonRealtime());
   juce::ScopedNoDenormals noDenormals;
+  PerformanceMetrics::ScopedAudioCallback timing(
+      PerformanceMetrics::AudioSource::Plugin, buffer.getNumSamples(),
+      hostSampleRate, !isNonRealtime());
 
   // Process transport control requests and update sync state
   transportController.processBlock(getPlayHead(), hostSampleRate);
@@ -123,6 +244,17 @@ void HachiTuneAudioProcessor::processBlock(juce::AudioBuffer<float> &buffer,
     return;
 #endif
 
+  // Live monitoring: the input, corrected, whatever the transport does
+  liveMonitor.setScale(
+      liveKeyParam->getIndex(),
+      static_cast<LiveMonitor::Scale>(liveScaleParam->getIndex()));
+  if (liveMonitor.process(buffer, midiMessages)) {
+    PerformanceMetrics::getInstance().recordBlockOutcome(
+        PerformanceMetrics::AudioSource::Plugin,
+        PerformanceMetrics::BlockOutcome::Rendered);
+    return;
+  }
+
   // Non-ARA mode
   juce::AudioPlayHead::PositionInfo posInfo;
   if (auto *playHead = getPlayHead()) {
@@ -137,9 +269,14 @@ void HachiTuneAudioProcessor::processBlock(juce::AudioBuffer<float> &buffer,
 void HachiTuneAudioProcessor::processNonARAMode(
     juce::AudioBuffer<float> &buffer,
     const juce::AudioPlayHead::PositionInfo &posInfo, bool isRealtime) {
+  using Outcome = PerformanceMetrics::BlockOutcome;
   const int numSamples = buffer.getNumSamples();
   const int numChannels = buffer.getNumChannels();
   const bool hostIsPlaying = posInfo.getIsPlaying();
+  auto recordOutcome = [](Outcome outcome) {
+    PerformanceMetrics::getInstance().recordBlockOutcome(
+        PerformanceMetrics::AudioSource::Plugin, outcome);
+  };
 
   // Check if we have analyzed project ready for real-time processing
   bool hasProject =
@@ -156,32 +293,10 @@ void HachiTuneAudioProcessor::processNonARAMode(
       else if (auto time = posInfo.getTimeInSeconds())
         timeInSeconds = *time;
 
-      auto state = hostUiSyncState;
-      state->latestSeconds.store(timeInSeconds);
-
-      // Never touch UI on the audio thread: coalesce to a single async update
-      if (!state->posPending.exchange(true)) {
-        juce::Component::SafePointer<juce::Component> safeMain(
-            mainComponent->getComponent());
-        juce::MessageManager::callAsync([safeMain, state]() {
-          state->posPending.store(false);
-          if (auto *view =
-                  dynamic_cast<IMainView *>(safeMain.getComponent()))
-            view->updatePlaybackPosition(state->latestSeconds.load());
-        });
-      }
+      // Never touch UI on the audio thread: the editor polls this
+      hostPlaybackState->publish({timeInSeconds, true});
     } else if (!hostIsPlaying && hasProject) {
-      auto state = hostUiSyncState;
-      if (!state->stoppedPending.exchange(true)) {
-        juce::Component::SafePointer<juce::Component> safeMain(
-            mainComponent->getComponent());
-        juce::MessageManager::callAsync([safeMain, state]() {
-          state->stoppedPending.store(false);
-          if (auto *view =
-                  dynamic_cast<IMainView *>(safeMain.getComponent()))
-            view->notifyHostStopped();
-        });
-      }
+      hostPlaybackState->publish({0.0, false});
     }
   }
 
@@ -197,9 +312,9 @@ void HachiTuneAudioProcessor::processNonARAMode(
         juce::Component::SafePointer<juce::Component> safeMain(
             mainComponent->getComponent());
         auto controller = captureController;
-        juce::MessageManager::callAsync([safeMain, controller,
-                                         samples = result.numSamples,
-                                         sr = result.sampleRate]() mutable {
+        RealtimeCheck::callAsync([safeMain, controller,
+                                  samples = result.numSamples,
+                                  sr = result.sampleRate]() mutable {
           auto *view = dynamic_cast<IMainView *>(safeMain.getComponent());
           if (!view)
             return;
@@ -214,21 +329,51 @@ void HachiTuneAudioProcessor::processNonARAMode(
     }
 
     buffer.clear();
+    recordOutcome(Outcome::Stopped);
+    return;
+  }
+
+  // Sized in prepareToPlay(); this only shrinks or grows into its capacity,
+  // unless a host sends a bigger block than it announced. That is reported
+  // here too, as malloc() is not seen in every plugin (see RealtimeCheck.h)
+  if (numChannels > outputBufferChannels || numSamples > outputBufferSamples) {
+#ifdef HACHITUNE_REALTIME_CHECKS
+    RealtimeCheck::report(RealtimeCheck::Violation::Allocation);
+#endif
+    outputBufferChannels = juce::jmax(outputBufferChannels, numChannels);
+    outputBufferSamples = juce::jmax(outputBufferSamples, numSamples);
+  }
+  outputBuffer.setSize(numChannels, numSamples, false, false, true);
+
+  // Lookahead: the reported latency holds whether or not there is a render
+  const bool lookahead = realtimeProcessor.isLookaheadActive();
+  if (hasProject && lookahead) {
+    realtimeProcessor.processBlockLookahead(buffer, outputBuffer, &posInfo);
+    for (int ch = 0; ch < numChannels; ++ch)
+      buffer.copyFrom(ch, 0, outputBuffer, ch, 0, numSamples);
+    recordOutcome(Outcome::Rendered);
     return;
   }
 
-  if (hasProject && realtimeProcessor.isReady()) {
+  // An offline render waits for the render instead of passing through
+  if (hasProject && (!isRealtime || realtimeProcessor.isReady())) {
     // Real-time pitch correction mode
-    juce::AudioBuffer<float> outputBuffer(numChannels, numSamples);
-    if (realtimeProcessor.processBlock(buffer, outputBuffer, &posInfo)) {
+    const bool used =
+        isRealtime
+            ? realtimeProcessor.processBlock(buffer, outputBuffer, &posInfo)
+            : realtimeProcessor.processBlockOffline(buffer, outputBuffer,
+                                                    &posInfo);
+    if (used) {
       for (int ch = 0; ch < numChannels; ++ch)
         buffer.copyFrom(ch, 0, outputBuffer, ch, 0, numSamples);
     }
+    recordOutcome(used ? Outcome::Rendered : Outcome::NotReady);
     return;
   }
 
-  // Capture mode
+  // Capture mode; with a project this is a render still on its way
   captureController->processBlock(buffer, hostIsPlaying);
+  recordOutcome(hasProject ? Outcome::NotReady : Outcome::Capturing);
 
   // UI: transition into recording
   auto currentState = captureController->getState();
@@ -237,7 +382,7 @@ void HachiTuneAudioProcessor::processNonARAMode(
         mainComponent) {
       juce::Component::SafePointer<juce::Component> safeMain(
           mainComponent->getComponent());
-      juce::MessageManager::callAsync([safeMain]() {
+      RealtimeCheck::callAsync([safeMain]() {
         if (auto *view = dynamic_cast<IMainView *>(safeMain.getComponent()))
           view->setStatusMessage(TR("progress.recording"));
       });
@@ -252,9 +397,9 @@ void HachiTuneAudioProcessor::processNonARAMode(
       juce::Component::SafePointer<juce::Component> safeMain(
           mainComponent->getComponent());
       auto controller = captureController;
-      juce::MessageManager::callAsync([safeMain, controller,
-                                       samples = result.numSamples,
-                                       sr = result.sampleRate]() mutable {
+      RealtimeCheck::callAsync([safeMain, controller,
+                                samples = result.numSamples,
+                                sr = result.sampleRate]() mutable {
         auto *view = dynamic_cast<IMainView *>(safeMain.getComponent());
         if (!view)
           return;
@@ -268,7 +413,50 @@ void HachiTuneAudioProcessor::processNonARAMode(
     }
   }
 
-  // Passthrough during capture
+  // Passthrough during capture, delayed like the rest in lookahead mode
+  if (lookahead) {
+    realtimeProcessor.processBlockLookahead(buffer, outputBuffer, &posInfo);
+    for (int ch = 0; ch < numChannels; ++ch)
+      buffer.copyFrom(ch, 0, outputBuffer, ch, 0, numSamples);
+  }
+}
+
+void HachiTuneAudioProcessor::updateCapturePreAnalysis() {
+  if (!mainComponent || !isCapturing())
+    return;
+
+  const uint32_t take = captureController->getTakeNumber();
+  if (take != preanalysisTake) {
+    preanalysisTake = take;
+    preanalysisAudio.clear();
+    preanalysisSubmitted = 0;
+  }
+
+  // Nothing new to infer until another pitch chunk has been captured
+  const int chunkStride = static_cast<int>(
+      hostSampleRate *
+      (RMVPEPitchDetector::CHUNK_SAMPLES -
+       RMVPEPitchDetector::CHUNK_OVERLAP_SAMPLES) /
+      RMVPEPitchDetector::SAMPLE_RATE);
+  if (captureController->getCapturedSamples() <
+      preanalysisSubmitted + chunkStride)
+    return;
+
+  const int held = static_cast<int>(preanalysisAudio.size());
+  const auto fresh = captureController->copyCaptureSoFar(
+      held, captureController->getCapturedSamples() - held);
+  if (fresh.getNumChannels() > 0 && fresh.getNumSamples() > 0)
+    preanalysisAudio.insert(preanalysisAudio.end(), fresh.getReadPointer(0),
+                            fresh.getReadPointer(0) + fresh.getNumSamples());
+  if (static_cast<int>(preanalysisAudio.size()) <
+      preanalysisSubmitted + chunkStride)
+    return;
+
+  float *channels[] = {preanalysisAudio.data()};
+  const juce::AudioBuffer<float> prefix(
+      channels, 1, static_cast<int>(preanalysisAudio.size()));
+  if (mainComponent->preanalyzeHostAudio(prefix, hostSampleRate))
+    preanalysisSubmitted = prefix.getNumSamples();
 }
 
 void HachiTuneAudioProcessor::startCapture() {
@@ -277,18 +465,93 @@ void HachiTuneAudioProcessor::startCapture() {
 
 void HachiTuneAudioProcessor::stopCapture() { captureController->stop(); }
 
-void HachiTuneAudioProcessor::setMainComponent(IMainView *mc) {
-  mainComponent = mc;
-  if (mc) {
-    mc->bindRealtimeProcessor(realtimeProcessor);
-    if (pendingStateJson.isNotEmpty() &&
-        mc->restoreProjectJson(pendingStateJson)) {
-      pendingStateJson.clear();
-    }
-  } else {
-    realtimeProcessor.setProject(nullptr);
-    realtimeProcessor.setVocoder(nullptr);
+IMainView &HachiTuneAudioProcessor::getOrCreateMainView() {
+  if (mainComponent)
+    return *mainComponent;
+
+  initializeUiResources();
+  mainComponent = createMainView(false);
+  mainComponent->bindRealtimeProcessor(realtimeProcessor);
+  mainComponent->setDisplayFrameRate(performanceProfile.displayFrameRate);
+  if (pendingState.getSize() > 0 &&
+      mainComponent->restoreProjectState(pendingState.getData(),
+                                         pendingState.getSize()))
+    pendingState.reset();
+
+  // Analysis or synthesis finished: the realtime path reads the new render
+  mainComponent->setOnProjectDataChanged([this]() {
+    mainComponent->bindRealtimeProcessor(realtimeProcessor);
+    realtimeProcessor.invalidate();
+  });
+  mainComponent->setOnRequestHostPlayState(
+      [this](bool shouldPlay) { requestHostPlayState(shouldPlay); });
+  mainComponent->setOnRequestHostStop([this]() { requestHostStop(); });
+  mainComponent->setOnRequestHostSeek(
+      [this](double timeInSeconds) { requestHostSeek(timeInSeconds); });
+  return *mainComponent;
+}
+
+void HachiTuneAudioProcessor::attachEditorMode(
+    HachiTuneDocumentController *araController) {
+  auto &view = getOrCreateMainView();
+  view.setARAMode(araController != nullptr);
+#if JucePlugin_Enable_ARA
+  if (araController) {
+    // Nothing to do when it shows this view already, as on a reopen
+    araController->setMainComponent(&view);
+    araController->setRealtimeProcessor(&realtimeProcessor);
+    view.setOnReanalyzeRequested(
+        [araController]() { araController->reanalyze(); });
+    araDocController = araController;
+    pollHostPlayback(araController->getSharedHostPlaybackState());
+    return;
   }
+#endif
+  pollHostPlayback(hostPlaybackState);
+}
+
+void HachiTuneAudioProcessor::pollHostPlayback(
+    std::shared_ptr<const HostPlaybackState> state) {
+  // The audio thread only publishes. Version 0 forwards the current status
+  // first: the host may have stopped or moved since the last switch.
+  hostPoll = [this, state = std::move(state),
+              lastVersion = uint64_t{0}]() mutable {
+    transportController.dispatchPendingCallbacks();
+    updateCapturePreAnalysis();
+
+    HostPlaybackStatus status;
+    if (!state->readIfChanged(status, lastVersion))
+      return;
+    if (status.playing)
+      mainComponent->updatePlaybackPosition(status.timeSeconds);
+    else
+      mainComponent->notifyHostStopped();
+  };
+  // A host that hides the editor may still deliver its display frames; the
+  // timer has the poll then
+  mainComponent->setOnDisplayFrame([this]() {
+    if (!hostPollTimer.isTimerRunning())
+      hostPoll();
+  });
+}
+
+void HachiTuneAudioProcessor::setEditorShowing(bool showing) {
+  jobView.setActive(showing);
+  // A closed or hidden editor's view gets no display frames, yet capture
+  // and renders go on and the host transport keeps moving
+  if (showing || !hostPoll)
+    hostPollTimer.stopTimer();
+  else if (!hostPollTimer.isTimerRunning())
+    hostPollTimer.startTimerHz(hostPollHz);
+}
+
+void HachiTuneAudioProcessor::setNonRealtime(bool isNonRealtime) noexcept {
+  juce::AudioProcessor::setNonRealtime(isNonRealtime);
+  std::lock_guard<std::mutex> lock(offlinePauseMutex);
+  if (isNonRealtime && !offlinePause && holdBackgroundOffline.load())
+    offlinePause.emplace();
+  else if (!isNonRealtime)
+    offlinePause.reset();
 }
 
 juce::AudioProcessorEditor *HachiTuneAudioProcessor::createEditor() {
@@ -296,27 +559,54 @@ juce::AudioProcessorEditor *HachiTuneAudioProcessor::createEditor() {
 }
 
 void HachiTuneAudioProcessor::getStateInformation(juce::MemoryBlock &destData) {
-  juce::String jsonString;
+  // Binary project container; only curves changed since the last call are
+  // compressed again
   if (mainComponent) {
-    jsonString = mainComponent->serializeProjectJson();
-  } else if (pendingStateJson.isNotEmpty()) {
-    jsonString = pendingStateJson;
+    auto state = mainComponent->serializeProjectState();
+    destData.append(state.getData(), state.getSize());
+  } else if (pendingState.getSize() > 0) {
+    destData.append(pendingState.getData(), pendingState.getSize());
   }
-  if (jsonString.isNotEmpty())
-    destData.append(jsonString.toRawUTF8(), jsonString.getNumBytesAsUTF8());
+
+  // Plugin settings after the project, so the project part stays a plain
+  // container
+  juce::MemoryOutputStream trailer(destData, true);
+  trailer.writeInt(static_cast<int>(pluginStateMagic));
+  trailer.writeInt(pluginStateVersion);
+  trailer.writeInt((lookaheadParam->get() ? lookaheadFlag : 0) |
+                   (liveParam->get() ? liveFlag : 0) |
+                   (liveKeyParam->getIndex() << liveKeyShift) |
+                   (liveScaleParam->getIndex() << liveScaleShift));
 }
 
 void HachiTuneAudioProcessor::setStateInformation(const void *data,
                                                   int sizeInBytes) {
-  juce::String jsonString(
-      juce::CharPointer_UTF8(static_cast<const char *>(data)),
-      static_cast<size_t>(sizeInBytes));
-
-  if (mainComponent && mainComponent->restoreProjectJson(jsonString)) {
+  if (sizeInBytes <= 0)
     return;
+  auto numBytes = static_cast<size_t>(sizeInBytes);
+
+  // States saved before there were plugin settings end with the project
+  if (numBytes >= pluginStateTrailerSize) {
+    juce::MemoryInputStream trailer(static_cast<const char *>(data) + numBytes -
+                                        pluginStateTrailerSize,
+                                    pluginStateTrailerSize, false);
+    if (static_cast<juce::uint32>(trailer.readInt()) == pluginStateMagic &&
+        trailer.readInt() >= 1) {
+      const int flags = trailer.readInt();
+      *lookaheadParam = (flags & lookaheadFlag) != 0;
+      *liveParam = (flags & liveFlag) != 0;
+      *liveKeyParam = (flags >> liveKeyShift) & 0xf;
+      *liveScaleParam = (flags >> liveScaleShift) & 0xf;
+      numBytes -= pluginStateTrailerSize;
+    }
   }
+  if (numBytes == 0)
+    return;
+
+  if (mainComponent && mainComponent->restoreProjectState(data, numBytes))
+    return;
 
-  pendingStateJson = jsonString;
+  pendingState.replaceAll(data, numBytes);
 }
 
 juce::AudioProcessor *JUCE_CALLTYPE createPluginFilter() {
@@ -2,13 +2,22 @@
 
 #include "../Audio/Engine/PluginTransportController.h"
 #include "../Audio/RealtimePitchProcessor.h"
+#include "../Audio/Synthesis/LiveMonitor.h"
 #include "../JuceHeader.h"
+#include "../Utils/JobSystem.h"
 #include "HostCompatibility.h"
+#include "HostPlaybackState.h"
 #include "NonAraCaptureController.h"
 #include <atomic>
+#include <cstdint>
+#include <functional>
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
 
 class IMainView;
+class HachiTuneDocumentController;
 
 /**
  * HachiTune Audio Processor
@@ -17,12 +26,21 @@ class IMainView;
  * 1. ARA Mode: Direct audio access via ARA protocol (Studio One, Cubase, Logic,
  * etc.)
  * 2. Non-ARA Mode: Auto-capture and process (FL Studio, Ableton, etc.)
+ *
+ * The "lookahead" parameter (non-ARA) reports a fixed latency and corrects
+ * audio not rendered yet inside it; see RealtimePitchProcessor. The "live"
+ * parameter instead corrects the input as it arrives, towards held MIDI
+ * notes or the "liveKey"/"liveScale" scale, for monitoring while tracking;
+ * see LiveMonitor.
  */
 class HachiTuneAudioProcessor : public juce::AudioProcessor
 #if JucePlugin_Enable_ARA
     ,
                                 public juce::AudioProcessorARAExtension
 #endif
+    ,
+                                private juce::AudioProcessorParameter::Listener,
+                                private juce::AsyncUpdater
 {
 public:
   HachiTuneAudioProcessor();
@@ -59,10 +77,28 @@ public:
   bool isARAModeActive() const;
   HostCompatibility::HostInfo getHostInfo() const;
   juce::String getHostStatusMessage() const;
+  // Applied when playback is prepared; see HostCompatibility
+  const HostCompatibility::PerformanceProfile &getPerformanceProfile() const {
+    return performanceProfile;
+  }
 
-  // Editor connection
-  void setMainComponent(IMainView *mc);
-  IMainView *getMainComponent() const { return mainComponent; }
+  // Editor connection. The main view holds the engine (project, models,
+  // caches, synthesis); it is built when an editor first asks for it and
+  // kept until the processor goes, so closing the editor keeps the warm
+  // state and the renders in flight, and reopening only re-attaches it.
+  // Message thread.
+  IMainView &getOrCreateMainView();
+  IMainView *getMainComponent() const { return mainComponent.get(); }
+  // How an opening editor's view reaches the host: through an ARA document
+  // controller, or the non-ARA capture path when null
+  void attachEditorMode(HachiTuneDocumentController *araController);
+  // Message thread: background jobs are held while no instance's editor
+  // is showing (see JobSystem::View), and the host poll moves from the
+  // view's display frames to a processor timer
+  void setEditorShowing(bool showing);
+
+  // Offline renders also hold background jobs
+  void setNonRealtime(bool isNonRealtime) noexcept override;
 
   // ========== Host Transport Control ==========
 
@@ -72,6 +108,11 @@ public:
    */
   PluginTransportController& getTransportController() { return transportController; }
 
+  /** Host position published by processBlock() (non-ARA mode). */
+  std::shared_ptr<const HostPlaybackState> getHostPlaybackState() const {
+    return hostPlaybackState;
+  }
+
   /**
    * Request host to start/stop playback.
    * @param shouldPlay true to start, false to pause
@@ -120,13 +161,25 @@ public:
     return captureController && captureController->getState() ==
                                     NonAraCaptureController::State::Capturing;
   }
+  // Message thread, once per display frame: hand the take captured so far
+  // to the editor for early pitch analysis, one pitch chunk at a time
+  void updateCapturePreAnalysis();
 
 private:
-  struct HostUiSyncState {
-    std::atomic<double> latestSeconds{0.0};
-    std::atomic<bool> posPending{false};
-    std::atomic<bool> stoppedPending{false};
-  };
+  // AudioProcessorParameter::Listener: any thread
+  void parameterValueChanged(int parameterIndex, float newValue) override;
+  void parameterGestureChanged(int, bool) override {}
+  // Message thread: apply the lookahead and live parameters and report
+  // their latency
+  void handleAsyncUpdate() override;
+  void updateLatency();
+  // Message thread: pick the profile for the host (or the one chosen in
+  // the settings) and hand its values to the parts they tune
+  void applyPerformanceProfile();
+  // Forward host transport, capture pre-analysis, and host position and
+  // stop to the main view: once per display frame while an editor shows
+  // it, from hostPollTimer while none does
+  void pollHostPlayback(std::shared_ptr<const HostPlaybackState> state);
 
   void processNonARAMode(juce::AudioBuffer<float> &buffer,
                          const juce::AudioPlayHead::PositionInfo &posInfo,
@@ -134,19 +187,57 @@ private:
 
   PluginTransportController transportController;
   RealtimePitchProcessor realtimeProcessor;
-  IMainView *mainComponent = nullptr;
-  std::shared_ptr<HostUiSyncState> hostUiSyncState =
-      std::make_shared<HostUiSyncState>();
+  // Audio thread: what realtimeProcessor renders into before it is copied
+  // back to the host buffer
+  juce::AudioBuffer<float> outputBuffer;
+  int outputBufferChannels = 0; // Its capacity
+  int outputBufferSamples = 0;
+  std::unique_ptr<IMainView> mainComponent;
+  HachiTuneDocumentController *araDocController = nullptr; // Showing mainComponent
+  std::shared_ptr<HostPlaybackState> hostPlaybackState =
+      std::make_shared<HostPlaybackState>();
   double hostSampleRate = 44100.0;
+  // Owned by the processor
+  juce::AudioParameterBool *lookaheadParam = nullptr;
+  juce::AudioParameterBool *liveParam = nullptr;
+  juce::AudioParameterChoice *liveKeyParam = nullptr;
+  juce::AudioParameterChoice *liveScaleParam = nullptr;
+  LiveMonitor liveMonitor;
 
-  juce::String pendingStateJson;
+  // setStateInformation() data that arrived before the main view existed
+  juce::MemoryBlock pendingState;
 
   // Non-ARA capture (Stage 2A): decoupled controller
   std::shared_ptr<NonAraCaptureController> captureController =
       std::make_shared<NonAraCaptureController>();
   NonAraCaptureController::State lastCaptureUiState =
       NonAraCaptureController::State::Idle;
-  static constexpr int MAX_CAPTURE_SECONDS = 300; // 5 minutes max
+
+  HostCompatibility::PerformanceProfile performanceProfile;
+  std::atomic<bool> holdBackgroundOffline{true}; // Read by setNonRealtime()
+
+  JobSystem::View jobView;
+  std::mutex offlinePauseMutex;
+  std::optional<JobSystem::Pause> offlinePause; // Guarded by offlinePauseMutex
+
+  // The poll pollHostPlayback() set up; message thread
+  std::function<void()> hostPoll;
+  class HostPollTimer : public juce::Timer {
+  public:
+    explicit HostPollTimer(HachiTuneAudioProcessor &owner)
+        : processor(owner) {}
+    void timerCallback() override { processor.hostPoll(); }
+
+  private:
+    HachiTuneAudioProcessor &processor;
+  };
+  HostPollTimer hostPollTimer{*this};
+  static constexpr int hostPollHz = 30; // No display to keep pace with
+
+  // Message thread only: channel 0 of the take being pre-analysed
+  std::vector<float> preanalysisAudio;
+  uint32_t preanalysisTake = 0;
+  int preanalysisSubmitted = 0;
 
   JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(HachiTuneAudioProcessor)
 };
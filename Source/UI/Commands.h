@@ -18,25 +18,43 @@ namespace CommandIDs
         exportAudio         = 0x2003,
         exportMidi          = 0x2004,
         quit                = 0x2005,
+        exportAudioRange    = 0x2006,
         
         // Edit Menu Commands (0x2010-0x201F)
         undo                = 0x2010,
         redo                = 0x2011,
         selectAll           = 0x2012,
+        speculativeSynthesis = 0x2013,
+        redetectPitchInRange = 0x2014,
+        resegmentRange      = 0x2015,
+        resetPitchInRange   = 0x2016,
+        saveVersion         = 0x2017,
+        switchVersion       = 0x2018,
         
         // View Menu Commands (0x2020-0x202F)
         showDeltaPitch      = 0x2020,
         showBasePitch       = 0x2021,
         showSettings        = 0x2022,
+        showSpectrogram     = 0x2023,
         
         // Transport Commands (0x2030-0x203F)
         playPause           = 0x2030,
         stop                = 0x2031,
         goToStart           = 0x2032,
         goToEnd             = 0x2033,
+        loopFocus           = 0x2034,
+        compareOriginal     = 0x2035,
         
         // Edit Mode Commands (0x2040-0x204F)
         toggleDrawMode      = 0x2040,
-        exitDrawMode        = 0x2041
+        exitDrawMode        = 0x2041,
+
+        // Track Menu Commands (0x2050-0x205F)
+        newTrack            = 0x2050,
+        removeTrack         = 0x2051,
+        nextTrack           = 0x2052,
+        muteTrack           = 0x2053,
+        raiseTrackGain      = 0x2054,
+        lowerTrackGain      = 0x2055
     };
 }
@@ -18,6 +18,10 @@ public:
   virtual void bindRealtimeProcessor(RealtimePitchProcessor &processor) = 0;
   virtual juce::String serializeProjectJson() const = 0;
   virtual bool restoreProjectJson(const juce::String &json) = 0;
+  // Plugin state: the project as a compact binary container; restore also
+  // takes serializeProjectJson() text from older sessions
+  virtual juce::MemoryBlock serializeProjectState() = 0;
+  virtual bool restoreProjectState(const void *data, size_t numBytes) = 0;
   virtual void setStatusMessage(const juce::String &message) = 0;
   virtual void setARAMode(bool enabled) = 0;
   virtual void setOnReanalyzeRequested(std::function<void()> callback) = 0;
@@ -28,9 +32,26 @@ public:
   virtual void setOnRequestHostStop(std::function<void()> callback) = 0;
   virtual void setOnRequestHostSeek(
       std::function<void(double)> callback) = 0;
+  // Called on the message thread once per display frame
+  virtual void setOnDisplayFrame(std::function<void()> callback) = 0;
+  // At most this many display frames a second; 0 for every refresh
+  virtual void setDisplayFrameRate(int framesPerSecond) = 0;
 
+  // projectJson (serializeProjectJson() of earlier edits to this audio) is
+  // applied once the audio is analysed
   virtual void setHostAudio(const juce::AudioBuffer<float> &buffer,
-                            double sampleRate) = 0;
+                            double sampleRate,
+                            const juce::String &projectJson = {}) = 0;
+  // Analyse audio that is not shown, so showing it later is quick;
+  // onComplete gets the analysis cache entry name (empty on failure). False
+  // if it cannot run now.
+  virtual bool analyzeHostAudioInBackground(
+      const juce::AudioBuffer<float> &buffer, double sampleRate,
+      std::function<void(const juce::String &)> onComplete) = 0;
+  // Non-ARA capture so far, analysed early where it can be; false if the
+  // prefix was not taken (try again later with more audio)
+  virtual bool preanalyzeHostAudio(const juce::AudioBuffer<float> &prefix,
+                                   double sampleRate) = 0;
   virtual void updatePlaybackPosition(double timeSeconds) = 0;
   virtual void notifyHostStopped() = 0;
 };
@@ -5,7 +5,8 @@ MenuHandler::MenuHandler() = default;
 juce::StringArray MenuHandler::getMenuBarNames() {
     if (pluginMode)
         return {TR("menu.edit"), TR("menu.view"), TR("menu.settings")};
-    return {TR("menu.file"), TR("menu.edit"), TR("menu.view"), TR("menu.settings")};
+    return {TR("menu.file"), TR("menu.edit"), TR("menu.track"), TR("menu.view"),
+            TR("menu.settings")};
 }
 
 juce::PopupMenu MenuHandler::getMenuForIndex(int menuIndex, const juce::String& /*menuName*/) {
@@ -19,12 +20,24 @@ juce::PopupMenu MenuHandler::getMenuForIndex(int menuIndex, const juce::String&
                 menu.addCommandItem(commandManager, CommandIDs::redo);
                 menu.addSeparator();
                 menu.addCommandItem(commandManager, CommandIDs::selectAll);
+                menu.addSeparator();
+                menu.addCommandItem(commandManager, CommandIDs::redetectPitchInRange);
+                menu.addCommandItem(commandManager, CommandIDs::resegmentRange);
+                menu.addCommandItem(commandManager, CommandIDs::resetPitchInRange);
+                menu.addSeparator();
+                menu.addCommandItem(commandManager, CommandIDs::saveVersion);
+                menu.addCommandItem(commandManager, CommandIDs::switchVersion);
+                menu.addSeparator();
+                menu.addCommandItem(commandManager, CommandIDs::speculativeSynthesis);
+                menu.addCommandItem(commandManager, CommandIDs::loopFocus);
+                menu.addCommandItem(commandManager, CommandIDs::compareOriginal);
             }
         } else if (menuIndex == 1) {
             // View menu
             if (commandManager) {
                 menu.addCommandItem(commandManager, CommandIDs::showDeltaPitch);
                 menu.addCommandItem(commandManager, CommandIDs::showBasePitch);
+                menu.addCommandItem(commandManager, CommandIDs::showSpectrogram);
             }
         } else if (menuIndex == 2) {
             // Settings menu
@@ -40,6 +53,7 @@ juce::PopupMenu MenuHandler::getMenuForIndex(int menuIndex, const juce::String&
                 menu.addCommandItem(commandManager, CommandIDs::saveProject);
                 menu.addSeparator();
                 menu.addCommandItem(commandManager, CommandIDs::exportAudio);
+                menu.addCommandItem(commandManager, CommandIDs::exportAudioRange);
                 menu.addCommandItem(commandManager, CommandIDs::exportMidi);
                 menu.addSeparator();
                 menu.addCommandItem(commandManager, CommandIDs::quit);
@@ -51,14 +65,41 @@ juce::PopupMenu MenuHandler::getMenuForIndex(int menuIndex, const juce::String&
                 menu.addCommandItem(commandManager, CommandIDs::redo);
                 menu.addSeparator();
                 menu.addCommandItem(commandManager, CommandIDs::selectAll);
+                menu.addSeparator();
+                menu.addCommandItem(commandManager, CommandIDs::redetectPitchInRange);
+                menu.addCommandItem(commandManager, CommandIDs::resegmentRange);
+                menu.addCommandItem(commandManager, CommandIDs::resetPitchInRange);
+                menu.addSeparator();
+                menu.addCommandItem(commandManager, CommandIDs::saveVersion);
+                menu.addCommandItem(commandManager, CommandIDs::switchVersion);
+                menu.addSeparator();
+                menu.addCommandItem(commandManager, CommandIDs::speculativeSynthesis);
+                menu.addCommandItem(commandManager, CommandIDs::loopFocus);
+                menu.addCommandItem(commandManager, CommandIDs::compareOriginal);
             }
         } else if (menuIndex == 2) {
+            // Track menu
+            if (commandManager) {
+                menu.addCommandItem(commandManager, CommandIDs::newTrack);
+                menu.addCommandItem(commandManager, CommandIDs::removeTrack);
+                menu.addSeparator();
+                menu.addCommandItem(commandManager, CommandIDs::nextTrack);
+                menu.addCommandItem(commandManager, CommandIDs::muteTrack);
+                menu.addCommandItem(commandManager, CommandIDs::raiseTrackGain);
+                menu.addCommandItem(commandManager, CommandIDs::lowerTrackGain);
+            }
+            if (trackListProvider) {
+                menu.addSeparator();
+                trackListProvider(menu);
+            }
+        } else if (menuIndex == 3) {
             // View menu
             if (commandManager) {
                 menu.addCommandItem(commandManager, CommandIDs::showDeltaPitch);
                 menu.addCommandItem(commandManager, CommandIDs::showBasePitch);
+                menu.addCommandItem(commandManager, CommandIDs::showSpectrogram);
             }
-        } else if (menuIndex == 3) {
+        } else if (menuIndex == 4) {
             // Settings menu
             if (commandManager) {
                 menu.addCommandItem(commandManager, CommandIDs::showSettings);
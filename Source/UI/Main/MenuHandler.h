@@ -17,6 +17,11 @@ public:
     void setPluginMode(bool isPlugin) { pluginMode = isPlugin; }
     void setUndoManager(PitchUndoManager* mgr) { undoManager = mgr; }
     void setCommandManager(juce::ApplicationCommandManager* mgr) { commandManager = mgr; }
+    // Appends the session's tracks to the Track menu, each focusing its own
+    void setTrackListProvider(std::function<void(juce::PopupMenu&)> provider)
+    {
+        trackListProvider = std::move(provider);
+    }
 
     // MenuBarModel interface
     juce::StringArray getMenuBarNames() override;
@@ -27,6 +32,7 @@ private:
     bool pluginMode = false;
     PitchUndoManager* undoManager = nullptr;
     juce::ApplicationCommandManager* commandManager = nullptr;
+    std::function<void(juce::PopupMenu&)> trackListProvider;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MenuHandler)
 };
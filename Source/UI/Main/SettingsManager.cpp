@@ -1,6 +1,12 @@
 #include "SettingsManager.h"
 #include "../../Utils/AppLogger.h"
 
+namespace {
+constexpr OnnxThreading::Model threadingModels[] = {
+    OnnxThreading::Model::Vocoder, OnnxThreading::Model::RMVPE,
+    OnnxThreading::Model::FCPE, OnnxThreading::Model::SOME};
+} // namespace
+
 SettingsManager::SettingsManager() {
   loadSettings();
   loadConfig();
@@ -17,6 +23,14 @@ juce::File SettingsManager::getConfigFile() {
   return PlatformPaths::getConfigFile("config.json");
 }
 
+juce::String SettingsManager::readHostProfile() {
+  auto config = juce::JSON::parse(getConfigFile().loadFileAsString());
+  if (auto *configObj = config.getDynamicObject())
+    if (configObj->hasProperty("hostProfile"))
+      return configObj->getProperty("hostProfile").toString();
+  return "auto";
+}
+
 void SettingsManager::loadSettings() {
   auto configFile = getConfigFile();
   if (configFile.existsAsFile())
@@ -47,8 +61,9 @@ void SettingsManager::applySettings() {
   loadConfig();
 
   if (vocoder) {
-    vocoder->setExecutionDevice(device);
-    vocoder->setExecutionDeviceId(gpuDeviceId);
+    vocoder->setExecutionDevice(getDeviceFor(OnnxThreading::Model::Vocoder));
+    vocoder->setExecutionDeviceId(
+        getGPUDeviceIdFor(OnnxThreading::Model::Vocoder));
     if (vocoder->isLoaded())
       vocoder->reloadModel();
   }
@@ -79,12 +94,74 @@ void SettingsManager::loadConfig() {
           pitchDetectorType = stringToPitchDetectorType(pitchDetectorStr);
         }
 
+        if (auto *benchmark =
+                configObj->getProperty("providerBenchmark").getArray()) {
+          benchmarkPicks.clear();
+          for (const auto &entry : *benchmark) {
+            ProviderBenchmark::Result pick;
+            bool known = false;
+            for (auto model : threadingModels) {
+              if (entry["model"].toString() ==
+                  OnnxThreading::getModelKey(model)) {
+                pick.model = model;
+                known = true;
+              }
+            }
+            if (!known)
+              continue;
+            pick.device = entry["device"].toString();
+            pick.deviceId = static_cast<int>(entry["deviceId"]);
+            pick.realTimeFactor = static_cast<double>(entry["rtf"]);
+            benchmarkPicks.push_back(pick);
+          }
+        }
+        if (configObj->hasProperty("useBenchmarkedDevices"))
+          useBenchmarkedDevices =
+              static_cast<bool>(configObj->getProperty("useBenchmarkedDevices"));
+
+        if (configObj->hasProperty("modelPrecision"))
+          modelPrecision = stringToModelPrecision(
+              configObj->getProperty("modelPrecision").toString());
+
         if (configObj->hasProperty("gpuDeviceId"))
           gpuDeviceId = static_cast<int>(configObj->getProperty("gpuDeviceId"));
 
         if (configObj->hasProperty("language"))
           language = configObj->getProperty("language").toString();
 
+        if (auto *threadingObj =
+                configObj->getProperty("onnxThreading").getDynamicObject()) {
+          for (auto model : threadingModels) {
+            auto *entry = threadingObj->getProperty(
+                OnnxThreading::getModelKey(model)).getDynamicObject();
+            if (entry == nullptr)
+              continue;
+
+            auto &settings = modelThreading[static_cast<size_t>(model)];
+            settings.intraOpThreads =
+                static_cast<int>(entry->getProperty("intraOpThreads"));
+            settings.interOpThreads =
+                static_cast<int>(entry->getProperty("interOpThreads"));
+            settings.spinning = OnnxThreading::stringToSpinning(
+                entry->getProperty("spinning").toString());
+            settings.pinThreads =
+                static_cast<bool>(entry->getProperty("pinThreads"));
+          }
+        }
+
+        if (auto *memoryObj =
+                configObj->getProperty("gpuMemory").getDynamicObject()) {
+          if (memoryObj->hasProperty("limitMB"))
+            gpuMemory.limitMB =
+                static_cast<int>(memoryObj->getProperty("limitMB"));
+          if (memoryObj->hasProperty("arenaExtend"))
+            gpuMemory.arenaExtend = OnnxGpuMemory::stringToArenaExtend(
+                memoryObj->getProperty("arenaExtend").toString());
+          if (memoryObj->hasProperty("shrinkAfterIdleSeconds"))
+            gpuMemory.shrinkAfterIdleSeconds = static_cast<int>(
+                memoryObj->getProperty("shrinkAfterIdleSeconds"));
+        }
+
         auto lastFile = configObj->getProperty("lastFile").toString();
         if (lastFile.isNotEmpty())
           lastFilePath = juce::File(lastFile);
@@ -100,9 +177,68 @@ void SettingsManager::loadConfig() {
         if (configObj->hasProperty("showBasePitch"))
           showBasePitch =
               static_cast<bool>(configObj->getProperty("showBasePitch"));
+        if (configObj->hasProperty("showSpectrogram"))
+          showSpectrogram =
+              static_cast<bool>(configObj->getProperty("showSpectrogram"));
+        if (configObj->hasProperty("speculativeSynthesis"))
+          speculativeSynthesis = static_cast<bool>(
+              configObj->getProperty("speculativeSynthesis"));
+        if (configObj->hasProperty("loopFocus"))
+          loopFocus = static_cast<bool>(configObj->getProperty("loopFocus"));
+        if (configObj->hasProperty("memoryBudgetMB"))
+          memoryBudgetMB = juce::jmax(
+              0, static_cast<int>(configObj->getProperty("memoryBudgetMB")));
+        if (configObj->hasProperty("previewTier"))
+          previewTier =
+              static_cast<bool>(configObj->getProperty("previewTier"));
+        if (configObj->hasProperty("renderCacheMB"))
+          renderCacheMB = juce::jmax(
+              0, static_cast<int>(configObj->getProperty("renderCacheMB")));
+        if (configObj->hasProperty("gpuRendering"))
+          gpuRendering =
+              static_cast<bool>(configObj->getProperty("gpuRendering"));
+        if (configObj->hasProperty("showPaintStats"))
+          showPaintStats =
+              static_cast<bool>(configObj->getProperty("showPaintStats"));
+        if (configObj->hasProperty("remoteInference"))
+          remoteInference =
+              configObj->getProperty("remoteInference").toString().trim();
+        if (configObj->hasProperty("sharedInferenceHost"))
+          sharedInferenceHost =
+              static_cast<bool>(configObj->getProperty("sharedInferenceHost"));
+        if (configObj->hasProperty("hostProfile"))
+          hostProfile = configObj->getProperty("hostProfile").toString();
       }
     }
   }
+
+  applyThreadingSettings();
+  OnnxGpuMemory::setSettings(gpuMemory);
+}
+
+juce::String SettingsManager::getDeviceFor(OnnxThreading::Model model) const {
+  if (isUsingBenchmarkedDevices())
+    for (const auto &pick : benchmarkPicks)
+      if (pick.model == model)
+        return pick.device;
+  return device;
+}
+
+int SettingsManager::getGPUDeviceIdFor(OnnxThreading::Model model) const {
+  if (isUsingBenchmarkedDevices())
+    for (const auto &pick : benchmarkPicks)
+      if (pick.model == model)
+        return pick.deviceId;
+  return gpuDeviceId;
+}
+
+void SettingsManager::applyThreadingSettings() {
+  for (auto model : threadingModels) {
+    auto settings = modelThreading[static_cast<size_t>(model)];
+    if (settings.intraOpThreads <= 0 && threads > 0)
+      settings.intraOpThreads = threads;
+    OnnxThreading::setSettings(model, settings);
+  }
 }
 
 void SettingsManager::saveConfig() {
@@ -114,9 +250,44 @@ void SettingsManager::saveConfig() {
   config->setProperty("threads", threads);
   config->setProperty("pitchDetector",
                       pitchDetectorTypeToString(pitchDetectorType));
+  juce::Array<juce::var> benchmark;
+  for (const auto &pick : benchmarkPicks) {
+    juce::DynamicObject::Ptr entry = new juce::DynamicObject();
+    entry->setProperty("model", OnnxThreading::getModelKey(pick.model));
+    entry->setProperty("device", pick.device);
+    entry->setProperty("deviceId", pick.deviceId);
+    entry->setProperty("rtf", pick.realTimeFactor);
+    benchmark.add(juce::var(entry.get()));
+  }
+  config->setProperty("providerBenchmark", benchmark);
+  config->setProperty("useBenchmarkedDevices", useBenchmarkedDevices);
+  config->setProperty("modelPrecision",
+                      modelPrecisionToString(modelPrecision));
   config->setProperty("gpuDeviceId", gpuDeviceId);
   config->setProperty("language", language);
 
+  juce::DynamicObject::Ptr threadingObj = new juce::DynamicObject();
+  for (auto model : threadingModels) {
+    const auto &settings = modelThreading[static_cast<size_t>(model)];
+    juce::DynamicObject::Ptr entry = new juce::DynamicObject();
+    entry->setProperty("intraOpThreads", settings.intraOpThreads);
+    entry->setProperty("interOpThreads", settings.interOpThreads);
+    entry->setProperty("spinning",
+                       OnnxThreading::spinningToString(settings.spinning));
+    entry->setProperty("pinThreads", settings.pinThreads);
+    threadingObj->setProperty(OnnxThreading::getModelKey(model),
+                              juce::var(entry.get()));
+  }
+  config->setProperty("onnxThreading", juce::var(threadingObj.get()));
+
+  juce::DynamicObject::Ptr memoryObj = new juce::DynamicObject();
+  memoryObj->setProperty("limitMB", gpuMemory.limitMB);
+  memoryObj->setProperty("arenaExtend", OnnxGpuMemory::arenaExtendToString(
+                                            gpuMemory.arenaExtend));
+  memoryObj->setProperty("shrinkAfterIdleSeconds",
+                         gpuMemory.shrinkAfterIdleSeconds);
+  config->setProperty("gpuMemory", juce::var(memoryObj.get()));
+
   if (lastFilePath.existsAsFile())
     config->setProperty("lastFile", lastFilePath.getFullPathName());
 
@@ -124,6 +295,17 @@ void SettingsManager::saveConfig() {
   config->setProperty("windowHeight", windowHeight);
   config->setProperty("showDeltaPitch", showDeltaPitch);
   config->setProperty("showBasePitch", showBasePitch);
+  config->setProperty("showSpectrogram", showSpectrogram);
+  config->setProperty("speculativeSynthesis", speculativeSynthesis);
+  config->setProperty("loopFocus", loopFocus);
+  config->setProperty("memoryBudgetMB", memoryBudgetMB);
+  config->setProperty("renderCacheMB", renderCacheMB);
+  config->setProperty("previewTier", previewTier);
+  config->setProperty("gpuRendering", gpuRendering);
+  config->setProperty("showPaintStats", showPaintStats);
+  config->setProperty("remoteInference", remoteInference);
+  config->setProperty("sharedInferenceHost", sharedInferenceHost);
+  config->setProperty("hostProfile", hostProfile);
 
   juce::String jsonText = juce::JSON::toString(juce::var(config.get()));
   configFile.replaceWithText(jsonText);
@@ -1,10 +1,16 @@
 #pragma once
 
+#include "../../Audio/ModelPrecision.h"
+#include "../../Audio/OnnxGpuMemory.h"
+#include "../../Audio/OnnxThreading.h"
 #include "../../Audio/PitchDetectorType.h"
+#include "../../Audio/ProviderBenchmark.h"
 #include "../../Audio/Vocoder.h"
 #include "../../JuceHeader.h"
 #include "../../Utils/PlatformPaths.h"
+#include <array>
 #include <functional>
+#include <vector>
 
 /**
  * Manages application settings and configuration persistence.
@@ -19,16 +25,63 @@ public:
   void loadSettings();
   void applySettings();
   juce::String getDevice() const { return device; }
-  void setDevice(const juce::String &d) { device = d; }
+  void setDevice(const juce::String &d) {
+    // Picking a device by hand overrides the benchmark choices
+    if (d != device)
+      useBenchmarkedDevices = false;
+    device = d;
+  }
   int getThreads() const { return threads; }
   void setThreads(int t) { threads = t; }
   PitchDetectorType getPitchDetectorType() const { return pitchDetectorType; }
   void setPitchDetectorType(PitchDetectorType t) { pitchDetectorType = t; }
+  ModelPrecision getModelPrecision() const { return modelPrecision; }
+  void setModelPrecision(ModelPrecision p) { modelPrecision = p; }
   int getGPUDeviceId() const { return gpuDeviceId; }
-  void setGPUDeviceId(int id) { gpuDeviceId = id; }
+  void setGPUDeviceId(int id) {
+    if (id != gpuDeviceId)
+      useBenchmarkedDevices = false;
+    gpuDeviceId = id;
+  }
+
+  // Execution provider benchmark (fastest device per model)
+  bool hasProviderBenchmark() const { return !benchmarkPicks.empty(); }
+  const std::vector<ProviderBenchmark::Result> &getProviderBenchmark() const {
+    return benchmarkPicks;
+  }
+  void setProviderBenchmark(std::vector<ProviderBenchmark::Result> picks) {
+    benchmarkPicks = std::move(picks);
+    useBenchmarkedDevices = true;
+  }
+  bool isUsingBenchmarkedDevices() const {
+    return useBenchmarkedDevices && hasProviderBenchmark();
+  }
+
+  // Device for one model: its benchmark pick if enabled, else the global one
+  juce::String getDeviceFor(OnnxThreading::Model model) const;
+  int getGPUDeviceIdFor(OnnxThreading::Model model) const;
   juce::String getLanguage() const { return language; }
   void setLanguage(const juce::String &lang) { language = lang; }
 
+  // Per-model ONNX threading (applied on the next model load)
+  OnnxThreading::Settings
+  getModelThreading(OnnxThreading::Model model) const {
+    return modelThreading[static_cast<size_t>(model)];
+  }
+  void setModelThreading(OnnxThreading::Model model,
+                         const OnnxThreading::Settings &settings) {
+    modelThreading[static_cast<size_t>(model)] = settings;
+    applyThreadingSettings();
+  }
+
+  // GPU memory cap, arena growth and idle release (applied on the next
+  // model load)
+  OnnxGpuMemory::Settings getGpuMemory() const { return gpuMemory; }
+  void setGpuMemory(const OnnxGpuMemory::Settings &settings) {
+    gpuMemory = settings;
+    OnnxGpuMemory::setSettings(gpuMemory);
+  }
+
   // Config (config.json - window state, last file)
   void loadConfig();
   void saveConfig();
@@ -44,8 +97,60 @@ public:
   // View settings
   void setShowDeltaPitch(bool show) { showDeltaPitch = show; }
   void setShowBasePitch(bool show) { showBasePitch = show; }
+  void setShowSpectrogram(bool show) { showSpectrogram = show; }
   bool getShowDeltaPitch() const { return showDeltaPitch; }
   bool getShowBasePitch() const { return showBasePitch; }
+  bool getShowSpectrogram() const { return showSpectrogram; }
+
+  // Pre-synthesize the hovered pitch while dragging notes (off by default)
+  void setSpeculativeSynthesis(bool enabled) { speculativeSynthesis = enabled; }
+  bool getSpeculativeSynthesis() const { return speculativeSynthesis; }
+
+  // Render the loop first and switch renders only at loop wraps (off by
+  // default)
+  void setLoopFocus(bool enabled) { loopFocus = enabled; }
+  bool getLoopFocus() const { return loopFocus; }
+
+  // Draw the piano roll through OpenGL (off by default)
+  void setGpuRendering(bool enabled) { gpuRendering = enabled; }
+  bool getGpuRendering() const { return gpuRendering; }
+
+  // Piano roll paint-cost overlay, for diagnosing slow redraws (off by
+  // default)
+  void setShowPaintStats(bool show) { showPaintStats = show; }
+  bool getShowPaintStats() const { return showPaintStats; }
+
+  // Render edits with a lighter vocoder, re-rendered with the full one when
+  // editing pauses (on by default)
+  void setPreviewTier(bool enabled) { previewTier = enabled; }
+  bool getPreviewTier() const { return previewTier; }
+
+  // Memory budget in MB for evictable data (caches, undo history); 0 = none
+  void setMemoryBudgetMB(int megabytes) { memoryBudgetMB = juce::jmax(0, megabytes); }
+  int getMemoryBudgetMB() const { return memoryBudgetMB; }
+
+  // Disk space in MB for synthesized audio kept across sessions; 0 = off
+  void setRenderCacheMB(int megabytes) { renderCacheMB = juce::jmax(0, megabytes); }
+  int getRenderCacheMB() const { return renderCacheMB; }
+
+  // Inference server ("host:port") tried before the local models; empty =
+  // none (see RemoteInference)
+  void setRemoteInference(const juce::String &endpoint) {
+    remoteInference = endpoint.trim();
+  }
+  juce::String getRemoteInference() const { return remoteInference; }
+
+  // Plugin only: run models in the helper process all instances share
+  // (see InferenceHost); a remote endpoint takes precedence
+  void setSharedInferenceHost(bool enabled) { sharedInferenceHost = enabled; }
+  bool getSharedInferenceHost() const { return sharedInferenceHost; }
+
+  // Plugin only: performance profile, "auto" to pick by host, or
+  // "conservative", "balanced" or "aggressive" (see HostCompatibility)
+  void setHostProfile(const juce::String &profile) { hostProfile = profile; }
+  juce::String getHostProfile() const { return hostProfile; }
+  // The saved hostProfile, for a plugin instance without a view yet
+  static juce::String readHostProfile();
 
   // Callbacks
   std::function<void()> onSettingsChanged;
@@ -54,14 +159,23 @@ private:
   static juce::File getSettingsFile();
   static juce::File getConfigFile();
 
+  // Push modelThreading (with the legacy "threads" value as the default
+  // intra-op count) to OnnxThreading
+  void applyThreadingSettings();
+
   Vocoder *vocoder = nullptr;
 
   // Settings
   juce::String device = "CPU";
   int threads = 0;
   PitchDetectorType pitchDetectorType = PitchDetectorType::RMVPE;
+  ModelPrecision modelPrecision = ModelPrecision::Balanced;
+  std::vector<ProviderBenchmark::Result> benchmarkPicks;
+  bool useBenchmarkedDevices = false;
   int gpuDeviceId = 0;
   juce::String language = "auto";
+  std::array<OnnxThreading::Settings, 4> modelThreading{};
+  OnnxGpuMemory::Settings gpuMemory;
 
   // Config
   juce::File lastFilePath;
@@ -69,6 +183,17 @@ private:
   int windowHeight = 800;
   bool showDeltaPitch = true;
   bool showBasePitch = false;
+  bool showSpectrogram = false;
+  bool speculativeSynthesis = false;
+  bool loopFocus = false;
+  int memoryBudgetMB = 0;
+  int renderCacheMB = 2048;
+  bool previewTier = true;
+  bool gpuRendering = false;
+  bool showPaintStats = false;
+  juce::String remoteInference;
+  bool sharedInferenceHost = false;
+  juce::String hostProfile = "auto";
 
   JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SettingsManager)
 };
@@ -1,4 +1,5 @@
 #include "MainComponent.h"
+#include "../Audio/InferenceHost.h"
 #include "../Audio/RealtimePitchProcessor.h"
 #include "../Audio/IO/MidiExporter.h"
 #include "../Models/ProjectSerializer.h"
@@ -6,11 +7,17 @@
 #include "../Utils/Constants.h"
 #include "../Utils/UI/Theme.h"
 #include "../Utils/Localization.h"
+#include "../Utils/PitchCurveProcessor.h"
 #include "../Utils/PlatformPaths.h"
+#include "../Utils/StartupTimer.h"
+#include "../Utils/Tracing.h"
 #include "../Utils/UI/WindowSizing.h"
 #include <atomic>
 #include <climits>
+#include <cmath>
+#include <limits>
 #include <iostream>
+#include <utility>
 
 MainComponent::MainComponent(bool enableAudioDevice)
     : enableAudioDeviceFlag(enableAudioDevice), pianoRollView(pianoRoll) {
@@ -21,45 +28,65 @@ MainComponent::MainComponent(bool enableAudioDevice)
   LOG("MainComponent: creating core components...");
   // Initialize components
   editorController = std::make_unique<EditorController>(enableAudioDeviceFlag);
-  undoManager = std::make_unique<PitchUndoManager>(100);
+  // Unlimited depth; steps past the resident budget live in a scratch file
+  undoManager = std::make_unique<PitchUndoManager>(0);
+  undoManager->enableSpilling(size_t(32) * 1024 * 1024);
   commandManager = std::make_unique<juce::ApplicationCommandManager>();
+  undoManager->onBatchFinished = [this]() {
+    if (std::exchange(pitchEditPendingForBatch, false))
+      handlePitchEditFinished();
+  };
   undoManager->onHistoryChanged = [this]() {
     if (commandManager)
       commandManager->commandStatusChanged();
+    enforceMemoryBudget();
+    // Record the edit in the autosave journal of a saved project
+    if (projectSaver)
+      if (auto *project = getProject())
+        projectSaver->journalAsync(*project);
   };
 
   // Initialize new modular components
   fileManager = std::make_unique<AudioFileManager>();
   menuHandler = std::make_unique<MenuHandler>();
   settingsManager = std::make_unique<SettingsManager>();
-
-  LOG("MainComponent: loading ONNX models...");
-  editorController->setPitchDetectorType(
-      settingsManager->getPitchDetectorType());
-  editorController->setDeviceConfig(settingsManager->getDevice(),
-                                    settingsManager->getGPUDeviceId());
-  editorController->reloadInferenceModels(false);
+  projectSaver = std::make_unique<ProjectSaver>();
 
   LOG("MainComponent: wiring up components...");
   menuHandler->setUndoManager(undoManager.get());
   menuHandler->setCommandManager(commandManager.get());
   menuHandler->setPluginMode(isPluginMode());
+  menuHandler->setTrackListProvider(
+      [this](juce::PopupMenu &menu) { addTrackItems(menu); });
   settingsManager->setVocoder(editorController->getVocoder());
 
   // Load vocoder settings
   settingsManager->applySettings();
 
-  LOG("MainComponent: initializing audio device...");
-  // Initialize audio (standalone app only)
+  editorController->setPitchDetectorType(
+      settingsManager->getPitchDetectorType());
+  editorController->setPreviewTier(settingsManager->getPreviewTier());
+  applyInferenceConfig();
+
+  // Synthesized segments outlive the session, so reopened edits play at once
+  if (auto *synth = editorController->getIncrementalSynth())
+    synth->getSynthesisCache().setDiskCache(
+        PlatformPaths::getCacheDirectory().getChildFile("synthesis"),
+        static_cast<juce::int64>(settingsManager->getRenderCacheMB()) * 1024 *
+            1024);
+
   if (auto *audioEngine = editorController->getAudioEngine())
-    audioEngine->initializeAudio();
-  LOG("MainComponent: audio initialized");
+    audioEngine->setLoopFocus(settingsManager->getLoopFocus());
 
   LOG("MainComponent: setting up callbacks...");
 
   // Initialize view state from settings
   pianoRoll.setShowDeltaPitch(settingsManager->getShowDeltaPitch());
+  pianoRoll.setSpeculativeSynthesis(settingsManager->getSpeculativeSynthesis());
   pianoRoll.setShowBasePitch(settingsManager->getShowBasePitch());
+  pianoRoll.setShowSpectrogram(settingsManager->getShowSpectrogram());
+  pianoRoll.setGpuRendering(settingsManager->getGpuRendering());
+  pianoRoll.setShowPaintStats(settingsManager->getShowPaintStats());
 
   // Add child components - macOS uses native menu, others use in-app menu bar
 #if JUCE_MAC
@@ -134,11 +161,19 @@ MainComponent::MainComponent(bool enableAudioDevice)
   pianoRoll.onNoteSelected = [this](Note *note) { onNoteSelected(note); };
   pianoRoll.onPitchEdited = [this]() { onPitchEdited(); };
   pianoRoll.onPitchEditFinished = [this]() {
-    resynthesizeIncremental();
-    // Melodyne-style: trigger real-time processor update in plugin mode
-    notifyProjectDataChanged();
-    if (isPluginMode() && onPitchEditFinished)
-      onPitchEditFinished();
+    // Steps of a transaction or group undo share one resynthesis; their
+    // dirty ranges accumulate in the project until the batch ends
+    if (undoManager && undoManager->isBatching()) {
+      pitchEditPendingForBatch = true;
+      return;
+    }
+    handlePitchEditFinished(true);
+  };
+  pianoRoll.onSpeculativeSynthesis = [this](int startFrame, int endFrame) {
+    auto *project = getProject();
+    if (project && editorController && !analysisPreview)
+      editorController->prefetchIncrementalSynthesis(*project, startFrame,
+                                                     endFrame);
   };
   pianoRoll.onZoomChanged = [this](float pps) {
     onZoomChanged(pps);
@@ -160,12 +195,20 @@ MainComponent::MainComponent(bool enableAudioDevice)
   // Setup parameter panel callbacks
   parameterPanel.onParameterChanged = [this]() { onPitchEdited(); };
   parameterPanel.onParameterEditFinished = [this]() {
-    resynthesizeIncremental();
+    resynthesizeIncremental(true);
     // Melodyne-style: trigger real-time processor update in plugin mode
     notifyProjectDataChanged();
     if (isPluginMode() && onPitchEditFinished)
       onPitchEditFinished();
   };
+  parameterPanel.onNoteGainChanged = [this]() {
+    // Gain is applied to the existing render, so nothing is resynthesized
+    if (isPluginMode())
+      notifyProjectDataChanged();
+    else if (editorController)
+      editorController->publishPlayback();
+    pianoRoll.repaint();
+  };
   parameterPanel.onGlobalPitchChanged = [this]() {
     pianoRoll.repaint(); // Update display
   };
@@ -175,7 +218,20 @@ MainComponent::MainComponent(bool enableAudioDevice)
                                 : nullptr)
       audioEngine->setVolumeDb(dB);
   };
+  parameterPanel.onScalePreview =
+      [this](const ScaleCorrection::Settings &settings) {
+        previewScaleCorrection(settings);
+      };
+  parameterPanel.onScalePreviewCancelled = [this]() { cancelScalePreview(); };
+  parameterPanel.onScaleApply =
+      [this](const ScaleCorrection::Settings &settings) {
+        applyScaleCorrection(settings);
+      };
+  parameterPanel.onVibratoScaleChanged = [this](float scale) {
+    scaleVibrato(scale);
+  };
   parameterPanel.setProject(getProject());
+  vibratoIndex.setProject(getProject());
 
   // Sync toolbar toggle with panel visibility
   toolbar.setParametersVisible(workspace.isPanelVisible("parameters"));
@@ -220,23 +276,115 @@ MainComponent::MainComponent(bool enableAudioDevice)
   addKeyListener(commandManager->getKeyMappings());
   setWantsKeyboardFocus(true);
 
-  // Load config
-  if (enableAudioDeviceFlag)
-    settingsManager->loadConfig();
+  updateTimer();
+  displayFrameAttachment = std::make_unique<juce::VBlankAttachment>(
+      this, [this]() { displayFrameCallback(); });
 
-  LOG("MainComponent: starting timer...");
-  // Start timer for UI updates
-  startTimerHz(30);
+  // Started by the first paint; the delay covers a window that starts
+  // minimised or an editor the host never shows
+  juce::Component::SafePointer<MainComponent> safeThis(this);
+  juce::Timer::callAfterDelay(500, [safeThis]() {
+    if (safeThis)
+      safeThis->finishStartup();
+  });
   LOG("MainComponent: constructor complete");
 }
 
+void MainComponent::finishStartup() {
+  if (std::exchange(startupFinished, true))
+    return;
+
+  // Models load side by side in the background; opening a file only waits
+  // for the ones its analysis needs
+  LOG("MainComponent: loading ONNX models in the background...");
+  editorController->reloadInferenceModels(true);
+
+  // Opening the device can take a while on some drivers, so the window is
+  // up first (standalone app only)
+  if (auto *audioEngine = editorController->getAudioEngine()) {
+    audioEngine->initializeAudio();
+    StartupTimer::mark("audio device");
+  }
+}
+
 void MainComponent::reloadInferenceModels(bool async) {
   if (!settingsManager || !editorController)
     return;
 
+  applyInferenceConfig();
+  editorController->reloadInferenceModels(async);
+  // The device may have changed; measure its latency afresh
+  resynthesisDebounce.reset();
+}
+
+void MainComponent::applyInferenceConfig() {
   editorController->setDeviceConfig(settingsManager->getDevice(),
                                     settingsManager->getGPUDeviceId());
-  editorController->reloadInferenceModels(async);
+  editorController->setModelPrecision(settingsManager->getModelPrecision());
+  for (auto model : {OnnxThreading::Model::Vocoder, OnnxThreading::Model::RMVPE,
+                     OnnxThreading::Model::FCPE, OnnxThreading::Model::SOME})
+    editorController->setModelDevice(model, settingsManager->getDeviceFor(model),
+                                     settingsManager->getGPUDeviceIdFor(model));
+
+  if (settingsManager->getRemoteInference().isNotEmpty() || !isPluginMode() ||
+      !settingsManager->getSharedInferenceHost()) {
+    editorController->setRemoteInference(settingsManager->getRemoteInference());
+    return;
+  }
+
+  // The helper gets the configured device; this instance's own models are
+  // only its fallback, so they stay on the CPU and out of the GPU driver
+  InferenceHost::Config hostConfig;
+  hostConfig.device = settingsManager->getDeviceFor(OnnxThreading::Model::Vocoder);
+  hostConfig.deviceId =
+      settingsManager->getGPUDeviceIdFor(OnnxThreading::Model::Vocoder);
+  hostConfig.precision = settingsManager->getModelPrecision();
+  hostConfig.modelsDir = PlatformPaths::getModelsDirectory();
+  if (auto remote = InferenceHost::connect(hostConfig)) {
+    editorController->setRemoteInference(std::move(remote));
+    editorController->setDeviceConfig("CPU", 0);
+    for (auto model : {OnnxThreading::Model::Vocoder, OnnxThreading::Model::RMVPE,
+                       OnnxThreading::Model::FCPE, OnnxThreading::Model::SOME})
+      editorController->setModelDevice(model, "CPU", 0);
+  } else {
+    editorController->setRemoteInference(juce::String());
+  }
+}
+
+void MainComponent::runProviderBenchmark() {
+  if (!settingsManager || !editorController || isInferenceBusy())
+    return;
+
+  // Only on request (the settings dialog): it keeps the models busy for
+  // a while and loads the ones not yet loaded on each device
+  LOG("MainComponent: benchmarking execution providers...");
+  setStatusMessage(TR("settings.benchmark_running"));
+
+  juce::Component::SafePointer<MainComponent> safeThis(this);
+  editorController->runProviderBenchmarkAsync(
+      [safeThis](double, const juce::String &message) {
+        if (safeThis)
+          safeThis->setStatusMessage(message);
+      },
+      [safeThis](const std::vector<ProviderBenchmark::Result> &results) {
+        if (!safeThis)
+          return;
+        auto picks = ProviderBenchmark::pickFastest(results);
+        if (picks.empty()) {
+          safeThis->setStatusMessage({});
+          return;
+        }
+        for (const auto &pick : picks)
+          LOG(juce::String("Benchmark: ") +
+              OnnxThreading::getModelKey(pick.model) + " -> " +
+              pick.device + " (id " + juce::String(pick.deviceId) +
+              "), RTF " + juce::String(pick.realTimeFactor, 3));
+        safeThis->settingsManager->setProviderBenchmark(std::move(picks));
+        safeThis->settingsManager->saveConfig();
+        safeThis->settingsManager->applySettings();
+        safeThis->reloadInferenceModels(true);
+        safeThis->setStatusMessage({});
+      });
 }
 
 bool MainComponent::isInferenceBusy() const {
@@ -260,6 +408,7 @@ MainComponent::~MainComponent() {
 #endif
   removeKeyListener(commandManager->getKeyMappings());
   stopTimer();
+  displayFrameAttachment.reset();
 
 
   if (auto *audioEngine = editorController->getAudioEngine()) {
@@ -280,6 +429,14 @@ juce::Point<int> MainComponent::getSavedWindowSize() const {
 
 void MainComponent::paint(juce::Graphics &g) {
   g.fillAll(APP_COLOR_BACKGROUND);
+
+  if (!startupFinished) {
+    juce::Component::SafePointer<MainComponent> safeThis(this);
+    juce::MessageManager::callAsync([safeThis]() {
+      if (safeThis)
+        safeThis->finishStartup();
+    });
+  }
 }
 
 void MainComponent::resized() {
@@ -315,8 +472,23 @@ void MainComponent::mouseDoubleClick(const juce::MouseEvent &e) {
   juce::ignoreUnused(e);
 }
 
-void MainComponent::timerCallback() {
-  // Handle throttled cursor updates (30Hz max)
+void MainComponent::displayFrameCallback() {
+  // Skips refreshes arriving well before the next frame is due; the slack
+  // keeps vsync jitter from halving the rate
+  if (displayFrameRate > 0) {
+    const double now = juce::Time::getMillisecondCounterHiRes();
+    if (now - lastDisplayFrameMs < 0.8 * 1000.0 / displayFrameRate)
+      return;
+    lastDisplayFrameMs = now;
+  }
+
+  // Playback and host state are polled here, once per display frame, rather
+  // than posted by the audio thread
+  if (auto *audioEngine = editorController->getAudioEngine())
+    audioEngine->dispatchPendingCallbacks();
+  if (onDisplayFrame)
+    onDisplayFrame();
+
   if (hasPendingCursorUpdate.load()) {
     double position = pendingCursorTime.load();
     hasPendingCursorUpdate.store(false);
@@ -340,7 +512,9 @@ void MainComponent::timerCallback() {
       }
     }
   }
+}
 
+void MainComponent::timerCallback() {
   if (isLoadingAudio.load()) {
     const auto progress = static_cast<float>(loadingProgress.load());
     toolbar.setProgress(progress);
@@ -363,6 +537,25 @@ void MainComponent::timerCallback() {
     toolbar.hideProgress();
     lastLoadingMessage.clear();
   }
+
+  refinePreviewRender();
+  updateTimer();
+}
+
+void MainComponent::updateTimer() {
+  int intervalMs = 0;
+  if (isLoadingAudio.load()) {
+    intervalMs = 1000 / 30;
+  } else if (editorController) {
+    const auto *synth = editorController->getIncrementalSynth();
+    if (synth && synth->getPreviewFrameRange().first >= 0)
+      intervalMs = 250;
+  }
+
+  if (intervalMs == 0)
+    stopTimer();
+  else if (getTimerInterval() != intervalMs)
+    startTimer(intervalMs);
 }
 
 bool MainComponent::keyPressed(const juce::KeyPress &key,
@@ -415,14 +608,7 @@ void MainComponent::saveProject() {
     if (file.getFileExtension().isEmpty())
       file = file.withFileExtension("htpx");
 
-    toolbar.showProgress(TR("progress.saving"));
-    toolbar.setProgress(-1.0f);
-
-    const bool ok = ProjectSerializer::saveToFile(*project, file);
-    if (ok)
-      project->setProjectFilePath(file);
-
-    toolbar.hideProgress();
+    saveProjectTo(file);
     return;
 #else
     fileChooser = std::make_unique<juce::FileChooser>(
@@ -448,32 +634,39 @@ void MainComponent::saveProject() {
       if (file.getFileExtension().isEmpty())
         file = file.withFileExtension("htpx");
 
-      safeThis->toolbar.showProgress(TR("progress.saving"));
-      safeThis->toolbar.setProgress(-1.0f);
-
-      auto *project = safeThis ? safeThis->getProject() : nullptr;
-      if (!project) {
-        safeThis->toolbar.hideProgress();
-        return;
-      }
-      const bool ok = ProjectSerializer::saveToFile(*project, file);
-      if (ok)
-        project->setProjectFilePath(file);
-
-      safeThis->toolbar.hideProgress();
+      safeThis->saveProjectTo(file);
     });
 
     return;
 #endif
   }
 
+  saveProjectTo(target);
+}
+
+void MainComponent::saveProjectTo(const juce::File &file) {
+  auto *project = getProject();
+  if (!project || !projectSaver)
+    return;
+
   toolbar.showProgress(TR("progress.saving"));
   toolbar.setProgress(-1.0f);
 
-  const bool ok = ProjectSerializer::saveToFile(*project, target);
-  juce::ignoreUnused(ok);
-
-  toolbar.hideProgress();
+  // Serialized and written on the saver's thread from a snapshot
+  juce::Component::SafePointer<MainComponent> safeThis(this);
+  projectSaver->saveAsync(
+      *project, file, [safeThis, project](const juce::File &saved, bool ok) {
+        if (safeThis == nullptr)
+          return;
+        safeThis->toolbar.hideProgress();
+        if (!ok) {
+          LOG("Failed to save project: " + saved.getFullPathName());
+          return;
+        }
+        // The project may have been replaced while saving
+        if (safeThis->getProject() == project)
+          project->setProjectFilePath(saved);
+      });
 }
 
 void MainComponent::openFile() {
@@ -515,6 +708,7 @@ void MainComponent::loadAudioFile(const juce::File &file) {
     return;
 
   isLoadingAudio = true;
+  updateTimer();
   loadingProgress = 0.0;
   {
     const juce::ScopedLock sl(loadingMessageLock);
@@ -538,22 +732,41 @@ void MainComponent::loadAudioFile(const juce::File &file) {
         const juce::ScopedLock sl(safeThis->loadingMessageLock);
         safeThis->loadingMessage = msg;
       },
-      [safeThis](const juce::AudioBuffer<float> &original) {
+      [safeThis, file](const juce::AudioBuffer<float> &original) {
         if (safeThis == nullptr)
           return;
 
         // Clear undo history before replacing project to avoid dangling pointers
+        safeThis->dropScalePreview();
         if (safeThis->undoManager)
           safeThis->undoManager->clear();
+        safeThis->versions.clear();
+        safeThis->currentVersion = {};
 
         auto *project = safeThis->getProject();
-        if (!project)
+        if (!project) {
+          safeThis->endAnalysisPreview();
           return;
+        }
+
+        // The file names the track it was opened into
+        safeThis->editorController->setTrackName(
+            safeThis->editorController->getFocusedTrack(),
+            file.getFileNameWithoutExtension());
+        // A new project: the previous one's journal goes
+        if (safeThis->projectSaver)
+          safeThis->projectSaver->resumeJournalAsync(*project);
+        const bool editedInPreview = safeThis->carryOverPreviewEdits(*project);
 
         // Update UI
         safeThis->pianoRoll.setProject(project);
+        safeThis->pianoRoll.setPreviewMode(false);
+        safeThis->analysisPreview.reset();
+        safeThis->analysisPreviewF0 = {};
+        safeThis->analysisPreviewNotes = {};
         safeThis->pianoRollView.setProject(project);
         safeThis->parameterPanel.setProject(project);
+        safeThis->vibratoIndex.setProject(project);
         safeThis->toolbar.setTotalTime(project->getAudioData().getDuration());
         safeThis->toolbar.setLoopEnabled(project->getLoopRange().enabled);
 
@@ -565,7 +778,7 @@ void MainComponent::loadAudioFile(const juce::File &file) {
                                        ? safeThis->editorController->getAudioEngine()
                                        : nullptr) {
           try {
-            engine->loadWaveform(audioData.waveform, audioData.sampleRate);
+            safeThis->editorController->publishPlayback(false);
             const auto &loopRange = project->getLoopRange();
             if (loopRange.enabled)
               engine->setLoopRange(loopRange.startSeconds,
@@ -599,8 +812,8 @@ void MainComponent::loadAudioFile(const juce::File &file) {
                                 ? safeThis->editorController->getVocoder()
                                 : nullptr;
             vocoder && !vocoder->isLoaded()) {
-          auto modelPath = PlatformPaths::getModelsDirectory().getChildFile(
-              "pc_nsf_hifigan.onnx");
+          auto modelPath =
+              safeThis->editorController->getVocoderModelFile();
           if (modelPath.existsAsFile()) {
             if (!vocoder->loadModel(modelPath)) {
               juce::AlertWindow::showMessageBoxAsync(
@@ -623,16 +836,237 @@ void MainComponent::loadAudioFile(const juce::File &file) {
         safeThis->repaint();
         safeThis->isLoadingAudio = false;
 
-        if (safeThis->isPluginMode())
+        if (editedInPreview)
+          safeThis->handlePitchEditFinished(true);
+        else if (safeThis->isPluginMode())
           safeThis->notifyProjectDataChanged();
       },
       [safeThis]() {
         if (safeThis == nullptr)
           return;
+        safeThis->endAnalysisPreview();
         safeThis->isLoadingAudio = false;
+      },
+      [safeThis](EditorController::AnalysisPreview preview) {
+        juce::MessageManager::callAsync(
+            [safeThis, preview = std::move(preview)]() mutable {
+              if (safeThis != nullptr)
+                safeThis->applyAnalysisPreview(std::move(preview));
+            });
+      },
+      [safeThis](const std::vector<Note> &provisional,
+                 std::vector<Note> refined) {
+        if (safeThis != nullptr)
+          safeThis->applyRefinedNotes(provisional, std::move(refined));
       });
 }
 
+void MainComponent::applyRefinedNotes(const std::vector<Note> &provisional,
+                                      std::vector<Note> refined) {
+  auto *project = getProject();
+  if (!project)
+    return;
+
+  // Provisional notes still as analysis left them give way to SOME's
+  int startFrame = INT_MAX;
+  int endFrame = 0;
+  auto extendRange = [&](const Note &note) {
+    startFrame = std::min(startFrame, note.getStartFrame());
+    endFrame = std::max(endFrame, note.getEndFrame());
+  };
+  for (const auto &original : provisional) {
+    const auto *note = project->findNote(original.getId());
+    if (note == nullptr || note->getStartFrame() != original.getStartFrame() ||
+        note->getEndFrame() != original.getEndFrame() ||
+        note->getMidiNote() != original.getMidiNote() ||
+        note->getPitchOffset() != original.getPitchOffset() ||
+        note->getLyric() != original.getLyric())
+      continue;
+    extendRange(*note);
+    project->removeNote(original.getId());
+  }
+
+  // Those overlapping a note the user edited or drew are dropped
+  std::vector<Note> accepted;
+  for (auto &note : refined) {
+    bool overlapsKept = false;
+    for (const auto *kept :
+         project->getNotesInRange(note.getStartFrame(), note.getEndFrame()))
+      overlapsKept = overlapsKept || !kept->isRest();
+    if (!overlapsKept)
+      accepted.push_back(std::move(note));
+  }
+  for (auto &note : accepted) {
+    extendRange(note);
+    project->addNote(std::move(note));
+  }
+
+  auto &audioData = project->getAudioData();
+  endFrame = std::min(endFrame, static_cast<int>(audioData.f0.size()));
+  if (endFrame <= startFrame)
+    return;
+
+  // Not an edit to undo or save. Delta absorbs the new base pitch, so the
+  // composed pitch and with it the audio stay as they are.
+  const std::vector<float> sourcePitch(audioData.f0.begin() + startFrame,
+                                       audioData.f0.begin() + endFrame);
+  const auto rebuilt =
+      PitchCurveProcessor::rebuildCurvesInRange(*project, sourcePitch, startFrame);
+  pianoRoll.invalidateBasePitchCache(rebuilt.first, rebuilt.second);
+  pianoRoll.repaint();
+  notifyProjectDataChanged();
+}
+
+void MainComponent::applyAnalysisPreview(
+    EditorController::AnalysisPreview preview) {
+  if (!isLoadingAudio.load())
+    return;
+
+  if (preview.waveform) {
+    // First preview of this import: an empty project over the new audio
+    analysisPreview = std::make_unique<Project>();
+    auto &audioData = analysisPreview->getAudioData();
+    audioData.setSourceAudio(std::move(*preview.waveform), preview.sampleRate);
+    analysisPreviewF0.assign(static_cast<size_t>(preview.totalFrames), 0.0f);
+    analysisPreviewNotes.clear();
+    audioData.voicedMask.resize(analysisPreviewF0.size());
+    PitchCurveProcessor::rebuildCurvesFromSource(*analysisPreview,
+                                                 analysisPreviewF0);
+
+    pianoRoll.setProject(analysisPreview.get());
+    pianoRoll.setPreviewMode(true);
+    return;
+  }
+  if (!analysisPreview)
+    return;
+
+  auto &audioData = analysisPreview->getAudioData();
+  const int numFrames = static_cast<int>(analysisPreviewF0.size());
+  const int start = juce::jlimit(0, numFrames, preview.startFrame);
+  const int end = juce::jlimit(start, numFrames, preview.endFrame);
+  std::copy(preview.f0.begin(), preview.f0.begin() + (end - start),
+            analysisPreviewF0.begin() + start);
+
+  const bool firstNotes =
+      analysisPreview->getNotes().empty() && !preview.notes.empty();
+  for (auto &note : preview.notes) {
+    note.clearDirty();
+    const NoteId id = analysisPreview->addNote(std::move(note));
+    analysisPreviewNotes.push_back(*analysisPreview->findNote(id));
+  }
+
+  // Only the chunk's frames and the base pitch around its notes change;
+  // curves the user edited elsewhere stay as they are
+  for (int i = start; i < end; ++i)
+    audioData.voicedMask.set(static_cast<size_t>(i),
+                             analysisPreviewF0[static_cast<size_t>(i)] > 0.0f);
+  const std::vector<float> chunkPitch(analysisPreviewF0.begin() + start,
+                                      analysisPreviewF0.begin() + end);
+  const auto rebuilt = PitchCurveProcessor::rebuildCurvesInRange(
+      *analysisPreview, chunkPitch, start);
+  pianoRoll.invalidateBasePitchCache(rebuilt.first, rebuilt.second);
+
+  if (firstNotes) {
+    float minMidi = 127.0f, maxMidi = 0.0f;
+    for (const auto &note : analysisPreview->getNotes()) {
+      minMidi = std::min(minMidi, note.getMidiNote());
+      maxMidi = std::max(maxMidi, note.getMidiNote());
+    }
+    pianoRoll.centerOnPitchRange(minMidi - 2.0f, maxMidi + 2.0f);
+  }
+  pianoRoll.repaint();
+}
+
+void MainComponent::endAnalysisPreview() {
+  if (!analysisPreview)
+    return;
+  pianoRoll.setPreviewMode(false);
+  pianoRoll.setProject(getProject());
+  analysisPreview.reset();
+  analysisPreviewF0 = {};
+  analysisPreviewNotes = {};
+}
+
+bool MainComponent::carryOverPreviewEdits(Project &project) {
+  if (!analysisPreview)
+    return false;
+
+  // Frames the user touched: curve edits and dirty notes, plus where notes
+  // were moved from, drawn or deleted
+  auto ranges = analysisPreview->getDirtyFrameRanges();
+  auto addRange = [&ranges](const Note &note) {
+    ranges.push_back({note.getStartFrame(), note.getEndFrame()});
+  };
+  const auto &previewNotes = analysisPreview->getNotes();
+  for (const auto &note : previewNotes) {
+    const auto original = std::find_if(
+        analysisPreviewNotes.begin(), analysisPreviewNotes.end(),
+        [&note](const Note &delivered) { return delivered.getId() == note.getId(); });
+    if (original == analysisPreviewNotes.end()) {
+      addRange(note);
+    } else if (original->getStartFrame() != note.getStartFrame() ||
+               original->getEndFrame() != note.getEndFrame() ||
+               original->getMidiNote() != note.getMidiNote() ||
+               original->getPitchOffset() != note.getPitchOffset() ||
+               original->getLyric() != note.getLyric()) {
+      addRange(*original);
+      addRange(note);
+    }
+  }
+  for (const auto &original : analysisPreviewNotes)
+    if (analysisPreview->findNote(original.getId()) == nullptr)
+      addRange(original);
+  if (ranges.empty())
+    return false;
+
+  std::sort(ranges.begin(), ranges.end());
+  std::vector<std::pair<int, int>> merged;
+  for (const auto &range : ranges) {
+    if (!merged.empty() && range.first <= merged.back().second)
+      merged.back().second = std::max(merged.back().second, range.second);
+    else
+      merged.push_back(range);
+  }
+
+  // The analysed notes there make way for the preview's
+  for (const auto &[startFrame, endFrame] : merged) {
+    std::vector<NoteId> replaced;
+    for (const auto *note : project.getNotesInRange(startFrame, endFrame))
+      replaced.push_back(note->getId());
+    for (NoteId id : replaced)
+      project.removeNote(id);
+    for (const auto *note : analysisPreview->getNotesInRange(startFrame, endFrame)) {
+      Note copy = *note;
+      copy.setId(0);
+      copy.setSelected(false);
+      project.addNote(std::move(copy));
+    }
+  }
+
+  // And the edited pitch, rebuilt over the project's notes
+  auto &target = project.getAudioData();
+  const auto &source = analysisPreview->getAudioData();
+  const int numFrames = static_cast<int>(
+      std::min({target.f0.size(), source.f0.size(), target.voicedMask.size(),
+                source.voicedMask.size()}));
+  for (const auto &[first, last] : merged) {
+    const int startFrame = std::clamp(first, 0, numFrames);
+    const int endFrame = std::clamp(last, startFrame, numFrames);
+    if (endFrame <= startFrame)
+      continue;
+    for (int i = startFrame; i < endFrame; ++i)
+      target.voicedMask.set(static_cast<size_t>(i),
+                            source.voicedMask[static_cast<size_t>(i)]);
+    const std::vector<float> pitch(source.f0.begin() + startFrame,
+                                   source.f0.begin() + endFrame);
+    PitchCurveProcessor::rebuildCurvesInRange(project, pitch, startFrame);
+    project.setF0DirtyRange(startFrame, endFrame);
+  }
+  LOG("MainComponent: carried " + juce::String(static_cast<int>(merged.size())) +
+      " range(s) edited during analysis over");
+  return true;
+}
+
 void MainComponent::analyzeAudio() {
   auto *project = getProject();
   if (!project || !editorController)
@@ -663,12 +1097,12 @@ void MainComponent::analyzeAudio(
   }
 }
 
-void MainComponent::exportFile() {
+void MainComponent::exportFile(bool selectionOnly) {
   if (!juce::MessageManager::getInstance()->isThisTheMessageThread()) {
     juce::Component::SafePointer<MainComponent> safeThis(this);
-    juce::MessageManager::callAsync([safeThis]() {
+    juce::MessageManager::callAsync([safeThis, selectionOnly]() {
       if (safeThis != nullptr)
-        safeThis->exportFile();
+        safeThis->exportFile(selectionOnly);
     });
     return;
   }
@@ -677,13 +1111,19 @@ void MainComponent::exportFile() {
   if (!project)
     return;
 
-  // Prevent re-triggering while dialog is open
-  if (fileChooser != nullptr)
+  const auto frameRange =
+      selectionOnly ? getReanalysisRange() : std::pair<int, int>{0, 0};
+  if (selectionOnly && frameRange.second <= frameRange.first)
+    return;
+
+  // Prevent re-triggering while dialog is open or an export runs
+  if (fileChooser != nullptr ||
+      (editorController && editorController->isExporting()))
     return;
 
 #if JUCE_WINDOWS && JUCE_MODAL_LOOPS_PERMITTED
-  juce::FileChooser chooser(TR("dialog.save_audio"), juce::File{}, "*.wav",
-                            true, false, this);
+  juce::FileChooser chooser(TR("dialog.save_audio"), juce::File{},
+                            "*.wav;*.flac;*.aiff", true, false, this);
   if (!chooser.browseForFileToSave(true))
     return;
 
@@ -694,97 +1134,17 @@ void MainComponent::exportFile() {
   if (file.getFileExtension().isEmpty())
     file = file.withFileExtension("wav");
 
-    auto &audioData = project->getAudioData();
-
-  // Show progress
-  toolbar.showProgress(TR("progress.exporting_audio"));
-  toolbar.setProgress(0.0f);
-
-  // Delete existing file if it exists (to ensure clean replacement)
-  if (file.existsAsFile()) {
-    if (!file.deleteFile()) {
-      toolbar.hideProgress();
-      StyledMessageBox::show(
-          this, TR("dialog.export_failed"),
-          TR("dialog.failed_delete") + "\n" + file.getFullPathName(),
-          StyledMessageBox::WarningIcon);
-      return;
-    }
-  }
-
-  toolbar.setProgress(0.3f);
-
-  // Create output stream
-  auto fileStream = std::make_unique<juce::FileOutputStream>(file);
-
-  if (!fileStream->openedOk()) {
-    toolbar.hideProgress();
-    StyledMessageBox::show(
-        this, TR("dialog.export_failed"),
-        TR("dialog.failed_open") + "\n" + file.getFullPathName(),
-        StyledMessageBox::WarningIcon);
-    return;
-  }
-  std::unique_ptr<juce::OutputStream> outputStream = std::move(fileStream);
-
-  toolbar.setProgress(0.5f);
-
-  // Create writer
-  juce::WavAudioFormat wavFormat;
-  auto writerOptions = juce::AudioFormatWriterOptions{}
-                           .withSampleRate(SAMPLE_RATE)
-                           .withNumChannels(1)
-                           .withBitsPerSample(16);
-  std::unique_ptr<juce::AudioFormatWriter> writer(
-      wavFormat.createWriterFor(outputStream, writerOptions));
-
-  if (writer == nullptr) {
-    toolbar.hideProgress();
-    StyledMessageBox::show(
-        this, TR("dialog.export_failed"),
-        TR("dialog.failed_create_writer") + "\n" + file.getFullPathName(),
-        StyledMessageBox::WarningIcon);
-    return;
-  }
-
-  toolbar.setProgress(0.7f);
-
-  // Write audio data
-  bool writeSuccess = writer->writeFromAudioSampleBuffer(
-      audioData.waveform, 0, audioData.waveform.getNumSamples());
-
-  toolbar.setProgress(0.9f);
-
-  // Explicitly flush and close writer (destructor will also do this, but
-  // explicit is better)
-  writer->flush();
-  writer.reset(); // Explicitly release writer and underlying stream
-
-  toolbar.setProgress(1.0f);
-
-  if (writeSuccess) {
-    toolbar.hideProgress();
-    StyledMessageBox::show(
-        this, TR("dialog.export_complete"),
-        TR("dialog.audio_exported") + "\n" + file.getFullPathName(),
-        StyledMessageBox::InfoIcon);
-  } else {
-    toolbar.hideProgress();
-    StyledMessageBox::show(
-        this, TR("dialog.export_failed"),
-        TR("dialog.failed_write") + "\n" + file.getFullPathName(),
-        StyledMessageBox::WarningIcon);
-  }
+  exportAudioTo(file, frameRange);
 #else
-  fileChooser = std::make_unique<juce::FileChooser>(TR("dialog.save_audio"),
-                                                    juce::File{}, "*.wav");
+  fileChooser = std::make_unique<juce::FileChooser>(
+      TR("dialog.save_audio"), juce::File{}, "*.wav;*.flac;*.aiff");
 
   auto chooserFlags = juce::FileBrowserComponent::saveMode |
                       juce::FileBrowserComponent::canSelectFiles |
                       juce::FileBrowserComponent::warnAboutOverwriting;
 
   juce::Component::SafePointer<MainComponent> safeThis(this);
-  fileChooser->launchAsync(chooserFlags, [safeThis](
+  fileChooser->launchAsync(chooserFlags, [safeThis, frameRange](
                                              const juce::FileChooser &fc) {
     if (safeThis == nullptr)
       return;
@@ -799,92 +1159,56 @@ void MainComponent::exportFile() {
     if (file.getFileExtension().isEmpty())
       file = file.withFileExtension("wav");
 
-    auto *project = safeThis ? safeThis->getProject() : nullptr;
-    if (!project)
-      return;
-    auto &audioData = project->getAudioData();
-
-    // Show progress
-    safeThis->toolbar.showProgress(TR("progress.exporting_audio"));
-    safeThis->toolbar.setProgress(0.0f);
-
-    // Delete existing file if it exists (to ensure clean replacement)
-    if (file.existsAsFile()) {
-      if (!file.deleteFile()) {
-        safeThis->toolbar.hideProgress();
-        StyledMessageBox::show(
-            safeThis.getComponent(), TR("dialog.export_failed"),
-            TR("dialog.failed_delete") + "\n" + file.getFullPathName(),
-            StyledMessageBox::WarningIcon);
-        return;
-      }
-    }
-
-    safeThis->toolbar.setProgress(0.3f);
-
-    // Create output stream
-    auto fileStream = std::make_unique<juce::FileOutputStream>(file);
-
-    if (!fileStream->openedOk()) {
-      safeThis->toolbar.hideProgress();
-      StyledMessageBox::show(
-          safeThis.getComponent(), TR("dialog.export_failed"),
-          TR("dialog.failed_open") + "\n" + file.getFullPathName(),
-          StyledMessageBox::WarningIcon);
-      return;
-    }
-    std::unique_ptr<juce::OutputStream> outputStream = std::move(fileStream);
-
-    safeThis->toolbar.setProgress(0.5f);
-
-    // Create writer
-    juce::WavAudioFormat wavFormat;
-    auto writerOptions = juce::AudioFormatWriterOptions{}
-                             .withSampleRate(SAMPLE_RATE)
-                             .withNumChannels(1)
-                             .withBitsPerSample(16);
-    std::unique_ptr<juce::AudioFormatWriter> writer(
-        wavFormat.createWriterFor(outputStream, writerOptions));
-
-    if (writer == nullptr) {
-      safeThis->toolbar.hideProgress();
-      StyledMessageBox::show(
-          safeThis.getComponent(), TR("dialog.export_failed"),
-          TR("dialog.failed_create_writer") + "\n" + file.getFullPathName(),
-          StyledMessageBox::WarningIcon);
-      return;
-    }
-
-    safeThis->toolbar.setProgress(0.7f);
-
-    // Write audio data
-    bool writeSuccess = writer->writeFromAudioSampleBuffer(
-        audioData.waveform, 0, audioData.waveform.getNumSamples());
+    safeThis->exportAudioTo(file, frameRange);
+  });
+#endif
+}
 
-    safeThis->toolbar.setProgress(0.9f);
+void MainComponent::exportAudioTo(const juce::File &file,
+                                  std::pair<int, int> frameRange) {
+  auto *project = getProject();
+  if (!project || !editorController)
+    return;
 
-    // Explicitly flush and close writer (destructor will also do this, but
-    // explicit is better)
-    writer->flush();
-    writer.reset(); // Explicitly release writer and underlying stream
+  if (!StreamingExporter::isSupportedFile(file)) {
+    StyledMessageBox::show(
+        this, TR("dialog.export_failed"),
+        TR("dialog.failed_create_writer") + "\n" + file.getFullPathName(),
+        StyledMessageBox::WarningIcon);
+    return;
+  }
 
-    safeThis->toolbar.setProgress(1.0f);
+  toolbar.showProgress(TR("progress.exporting_audio"));
+  toolbar.setProgress(0.0f);
 
-    if (writeSuccess) {
-      safeThis->toolbar.hideProgress();
-      StyledMessageBox::show(
-          safeThis.getComponent(), TR("dialog.export_complete"),
-          TR("dialog.audio_exported") + "\n" + file.getFullPathName(),
-          StyledMessageBox::InfoIcon);
-    } else {
-      safeThis->toolbar.hideProgress();
-      StyledMessageBox::show(
-          safeThis.getComponent(), TR("dialog.export_failed"),
-          TR("dialog.failed_write") + "\n" + file.getFullPathName(),
-          StyledMessageBox::WarningIcon);
-    }
-  });
-#endif
+  // Rendered again from the analysis and edits and written as the vocoder
+  // goes, at the rate the audio came in at; an existing file is only
+  // replaced once the export succeeds. A range export vocodes just that
+  // range, reusing blocks an earlier one rendered.
+  juce::Component::SafePointer<MainComponent> safeThis(this);
+  editorController->exportProcessedAudioAsync(
+      *project,
+      {StreamingExporter::Target{file,
+                                 project->getAudioData().sessionSampleRate}},
+      [safeThis](double progress) {
+        if (safeThis != nullptr)
+          safeThis->toolbar.setProgress(static_cast<float>(progress));
+      },
+      [safeThis, file](bool ok, const juce::String &error) {
+        if (safeThis == nullptr)
+          return;
+        safeThis->toolbar.hideProgress();
+        if (ok)
+          StyledMessageBox::show(
+              safeThis.getComponent(), TR("dialog.export_complete"),
+              TR("dialog.audio_exported") + "\n" + file.getFullPathName(),
+              StyledMessageBox::InfoIcon);
+        else if (error.isNotEmpty())
+          StyledMessageBox::show(safeThis.getComponent(),
+                                 TR("dialog.export_failed"), error,
+                                 StyledMessageBox::WarningIcon);
+      },
+      frameRange);
 }
 
 void MainComponent::exportMidiFile() {
@@ -1144,22 +1468,98 @@ void MainComponent::seek(double time) {
   }
 }
 
-void MainComponent::resynthesizeIncremental() {
-  DBG("resynthesizeIncremental() called");
+void MainComponent::handlePitchEditFinished(bool gestureEnded) {
+  // Edits to a project still being analysed have no audio to render yet;
+  // carryOverPreviewEdits() hands them on when it is done
+  if (analysisPreview)
+    return;
+  resynthesizeIncremental(gestureEnded);
+  // Melodyne-style: trigger real-time processor update in plugin mode
+  notifyProjectDataChanged();
+  if (isPluginMode() && onPitchEditFinished)
+    onPitchEditFinished();
+}
 
+void MainComponent::refinePreviewRender() {
+  // Long enough that a run of quick edits stays on the preview model
+  constexpr double idleSeconds = 1.5;
   auto *project = getProject();
-  if (!project || !editorController) {
-    DBG("  Skipped: no project or controller");
+  auto *synth =
+      editorController ? editorController->getIncrementalSynth() : nullptr;
+  if (!project || !synth || editorController->isRendering() ||
+      project->hasDirtyNotes() || project->hasF0DirtyRange() ||
+      !synth->needsRefinement(idleSeconds))
     return;
-  }
 
-  toolbar.showProgress(TR("progress.synthesizing"));
-  toolbar.setProgress(-1.0f);
-  toolbar.setEnabled(false);
+  // Offline bounces wait for the full-quality audio
+  const auto [start, end] = synth->getPreviewFrameRange();
+  if (isPluginMode() && start >= 0)
+    setRenderPending(static_cast<double>(start) * HOP_SIZE / SAMPLE_RATE - 1.0,
+                     static_cast<double>(end) * HOP_SIZE / SAMPLE_RATE + 1.0);
 
   juce::Component::SafePointer<MainComponent> safeThis(this);
-  editorController->resynthesizeIncrementalAsync(
-      *project,
+  const bool started = editorController->refinePreviewRenderAsync(
+      *project, idleSeconds, [safeThis](bool success) {
+        if (safeThis == nullptr)
+          return;
+        if (success && safeThis->isPluginMode())
+          safeThis->notifyProjectDataChanged();
+        safeThis->clearRenderPending();
+      });
+  if (!started && isPluginMode())
+    clearRenderPending();
+}
+
+void MainComponent::resynthesizeIncremental(bool gestureEnded) {
+  DBG("resynthesizeIncremental() called");
+
+  auto *project = getProject();
+  if (!project || !editorController) {
+    DBG("  Skipped: no project or controller");
+    return;
+  }
+
+  // Crossfades and vocoder context reach a little past the dirty frames;
+  // silence-boundary mode may reach anywhere. Set before any hold, so host
+  // renders already wait for it.
+  if (isPluginMode()) {
+    auto [dirtyStart, dirtyEnd] = project->getDirtyFrameRange();
+    auto *synth = editorController->getIncrementalSynth();
+    if (synth && !synth->isWindowedResynthesis())
+      setRenderPending(0.0, std::numeric_limits<double>::max());
+    else if (dirtyStart >= 0 && dirtyEnd > dirtyStart)
+      setRenderPending(
+          static_cast<double>(dirtyStart) * HOP_SIZE / SAMPLE_RATE - 1.0,
+          static_cast<double>(dirtyEnd) * HOP_SIZE / SAMPLE_RATE + 1.0);
+  }
+
+  const double delayMs = resynthesisDebounce.onEdit(
+      juce::Time::getMillisecondCounterHiRes(), gestureEnded);
+  const int generation = ++resynthesisGeneration;
+  if (delayMs <= 0.0)
+    return startIncrementalResynthesis();
+
+  // The dirty ranges keep accumulating in the project until it fires
+  juce::Component::SafePointer<MainComponent> safeThis(this);
+  juce::Timer::callAfterDelay(
+      static_cast<int>(std::ceil(delayMs)), [safeThis, generation]() {
+        if (safeThis && safeThis->resynthesisGeneration == generation)
+          safeThis->startIncrementalResynthesis();
+      });
+}
+
+void MainComponent::startIncrementalResynthesis() {
+  auto *project = getProject();
+  if (!project || !editorController)
+    return;
+
+  toolbar.showProgress(TR("progress.synthesizing"));
+  toolbar.setProgress(-1.0f);
+  toolbar.setEnabled(false);
+
+  juce::Component::SafePointer<MainComponent> safeThis(this);
+  editorController->resynthesizeIncrementalAsync(
+      *project,
       [safeThis](const juce::String &message) {
         if (safeThis == nullptr)
           return;
@@ -1174,21 +1574,368 @@ void MainComponent::resynthesizeIncremental() {
 
         if (!success) {
           DBG("resynthesizeIncremental: Synthesis failed or was cancelled");
+          safeThis->clearRenderPending();
           return;
         }
 
+        if (auto *synth = safeThis->editorController->getIncrementalSynth())
+          safeThis->resynthesisDebounce.recordLatency(
+              synth->getLastEditLatencyMs());
         safeThis->pianoRoll.repaint();
         if (safeThis->isPluginMode())
           safeThis->notifyProjectDataChanged();
+        safeThis->clearRenderPending();
+        safeThis->enforceMemoryBudget();
+        // Preview-model audio now waits for refinement
+        safeThis->updateTimer();
       },
       pendingIncrementalResynth,
       isPluginMode());
 }
 
+ProjectMemoryReport MainComponent::getMemoryReport() const {
+  ProjectMemoryReport report;
+  if (auto *project = getProject())
+    report = project->getMemoryReport();
+  if (undoManager)
+    report.undoBytes = undoManager->getMemoryBytes();
+  if (editorController)
+    if (auto *synth = editorController->getIncrementalSynth())
+      report.cacheBytes = synth->getSynthesisCache().getNumBytes();
+  return report;
+}
+
+void MainComponent::enforceMemoryBudget() {
+  const int budgetMB =
+      settingsManager ? settingsManager->getMemoryBudgetMB() : 0;
+  if (budgetMB <= 0 || isEnforcingMemoryBudget)
+    return;
+
+  const auto budget = static_cast<size_t>(budgetMB) * 1024 * 1024;
+  auto report = getMemoryReport();
+  if (report.getTotalBytes() <= budget)
+    return;
+
+  isEnforcingMemoryBudget = true;
+  auto excess = [&]() { return report.getTotalBytes() - budget; };
+
+  // Cached vocoder output only saves time; drop the least recently used
+  if (report.cacheBytes > 0 && editorController) {
+    if (auto *synth = editorController->getIncrementalSynth()) {
+      auto &cache = synth->getSynthesisCache();
+      cache.trimToBytes(
+          report.cacheBytes > excess() ? report.cacheBytes - excess() : 0);
+      report.cacheBytes = cache.getNumBytes();
+    }
+  }
+
+  // Then history: redo steps, then undo steps oldest first
+  if (report.getTotalBytes() > budget && report.undoBytes > 0 && undoManager) {
+    undoManager->trimToBytes(
+        report.undoBytes > excess() ? report.undoBytes - excess() : 0);
+    report.undoBytes = undoManager->getMemoryBytes();
+  }
+
+  // Then out-of-core: page the largest project buffers to scratch files,
+  // only while nothing on another thread may be reading them
+  auto *project = getProject();
+  const bool idle = editorController && !editorController->isInferenceBusy() &&
+                    !editorController->isLoading() &&
+                    !editorController->isRendering() &&
+                    !editorController->isExporting();
+  if (report.getTotalBytes() > budget && project && idle) {
+    auto &audioData = project->getAudioData();
+    if (report.snapshotBytes > 0)
+      report.snapshotBytes -= audioData.pageRenderSnapshot();
+    if (report.getTotalBytes() > budget && report.waveformBytes > 0)
+      report.waveformBytes -= audioData.pageWaveform();
+    if (report.getTotalBytes() > budget)
+      report.melBytes -= audioData.pageMel();
+    report.pagedBytes = audioData.getPagedBytes();
+  }
+
+  isEnforcingMemoryBudget = false;
+
+  if (report.getTotalBytes() > budget)
+    LOG("Memory budget " + juce::String(budgetMB) +
+        " MB exceeded by project data (" +
+        juce::File::descriptionOfSizeInBytes(
+            static_cast<juce::int64>(report.getTotalBytes())) +
+        ")");
+}
+
 void MainComponent::onNoteSelected(Note *note) {
   parameterPanel.setSelectedNote(note);
 }
 
+void MainComponent::previewScaleCorrection(
+    const ScaleCorrection::Settings &settings) {
+  auto *project = getProject();
+  if (!project || !undoManager || !editorController)
+    return;
+
+  // New settings replace the correction being previewed; the notes it
+  // moved stay dirty, so the audition puts them back too
+  pitchEditPendingForBatch = false;
+  if (scalePreviewActive)
+    undoManager->cancelTransaction();
+  undoManager->beginTransaction("Correct to Scale");
+  scalePreviewActive = true;
+  correctToScale(settings);
+  editorController->auditionIncrementalAsync(*project, isPluginMode());
+}
+
+void MainComponent::applyScaleCorrection(
+    const ScaleCorrection::Settings &settings) {
+  if (!getProject() || !undoManager)
+    return;
+
+  pitchEditPendingForBatch = false;
+  if (!scalePreviewActive) {
+    undoManager->beginTransaction("Correct to Scale");
+    correctToScale(settings);
+  }
+  scalePreviewActive = false;
+  undoManager->commitTransaction();
+  handlePitchEditFinished(true);
+}
+
+void MainComponent::cancelScalePreview() {
+  if (!scalePreviewActive || !undoManager)
+    return;
+
+  scalePreviewActive = false;
+  pitchEditPendingForBatch = false;
+  undoManager->cancelTransaction();
+  pianoRoll.repaint();
+  handlePitchEditFinished(true);
+}
+
+void MainComponent::dropScalePreview() {
+  if (!std::exchange(scalePreviewActive, false))
+    return;
+  parameterPanel.endScalePreview();
+  pitchEditPendingForBatch = false;
+  if (undoManager)
+    undoManager->commitTransaction();
+}
+
+void MainComponent::correctToScale(const ScaleCorrection::Settings &settings) {
+  auto *project = getProject();
+  auto plan = ScaleCorrection::plan(*project, settings);
+  if (plan.empty())
+    return;
+
+  // The piano roll redraws the rebuilt spans from the note changes
+  const auto notes = ScaleCorrection::apply(*project, plan, true);
+  NoteBulkEdit::rebuildAroundNotes(*project, notes);
+  undoManager->addAction(std::make_unique<ScaleCorrectionAction>(
+      project, std::move(plan),
+      [this](const std::vector<Note *> &) { onPitchEdited(); }));
+  onPitchEdited();
+}
+
+void MainComponent::scaleVibrato(float scale) {
+  auto *project = getProject();
+  if (!project || !undoManager)
+    return;
+
+  // As with undo, a scale preview in progress is discarded first
+  if (scalePreviewActive) {
+    parameterPanel.endScalePreview();
+    cancelScalePreview();
+  }
+
+  // Only the notes edited since the last scaling are estimated again
+  vibratoIndex.update();
+  auto changes = vibratoIndex.planScale(scale);
+  if (changes.empty())
+    return;
+
+  VibratoIndex::apply(*project, changes, true);
+  undoManager->addAction(std::make_unique<VibratoScaleAction>(
+      project, std::move(changes),
+      [this](const std::vector<Note *> &) { onPitchEdited(); }));
+  onPitchEdited();
+  handlePitchEditFinished(true);
+}
+
+void MainComponent::saveVersion() {
+  auto *project = getProject();
+  if (!project)
+    return;
+
+  // Branches are named A, B, C... in the order they are made; the state
+  // before the first branch is kept as A
+  auto nextName = [this]() {
+    juce::String name;
+    for (int i = versions.size(); name.isEmpty() || versions.contains(name); ++i)
+      name = i < 26 ? juce::String::charToString(
+                          static_cast<juce::juce_wchar>('A' + i))
+                    : juce::String(i + 1);
+    return name;
+  };
+  if (versions.size() == 0)
+    versions.save(nextName(), *project);
+  const auto name = nextName();
+  versions.save(name, *project);
+  currentVersion = name;
+  if (commandManager)
+    commandManager->commandStatusChanged();
+}
+
+void MainComponent::switchVersion() {
+  auto *project = getProject();
+  auto *synth =
+      editorController ? editorController->getIncrementalSynth() : nullptr;
+  const auto names = versions.getNames();
+  if (!project || !synth || names.size() < 2)
+    return;
+
+  pianoRoll.cancelDrawing();
+  dropScalePreview();
+
+  // A synthesis in flight would land on the other branch's render; its
+  // ranges stay dirty in the branch being left
+  synth->cancel();
+  versions.save(currentVersion, *project);
+  const int next = (names.indexOf(currentVersion) + 1) % names.size();
+  currentVersion = names[next];
+  if (!versions.restore(currentVersion, *project))
+    return;
+  synth->renderReplaced(project->getAdjustedF0());
+
+  // The history edited the other branch's notes and curves
+  if (undoManager)
+    undoManager->clear();
+
+  pianoRoll.invalidateSpectrogram();
+  pianoRoll.repaint();
+  parameterPanel.setProject(project);
+  editorController->publishPlayback(true);
+  if (project->hasF0DirtyRange())
+    resynthesizeIncremental(true);
+  else
+    notifyProjectDataChanged();
+  if (commandManager)
+    commandManager->commandStatusChanged();
+}
+
+juce::String MainComponent::getTrackDisplayName(int index) const {
+  const auto &name = editorController->getTrack(index).name;
+  return name.isNotEmpty() ? name
+                           : TR("track.untitled") + " " + juce::String(index + 1);
+}
+
+void MainComponent::leaveFocusedTrack() {
+  pianoRoll.cancelDrawing();
+  dropScalePreview();
+  if (undoManager)
+    undoManager->clear();
+  versions.clear();
+  currentVersion = {};
+}
+
+void MainComponent::showTrack(int index) {
+  if (!editorController || index < 0 || index >= editorController->getNumTracks())
+    return;
+  if (index != editorController->getFocusedTrack())
+    leaveFocusedTrack();
+  editorController->focusTrack(index);
+
+  auto *project = getProject();
+  if (project && projectSaver)
+    projectSaver->resumeJournalAsync(*project);
+  pianoRoll.setProject(project);
+  pianoRollView.setProject(project);
+  parameterPanel.setProject(project);
+  vibratoIndex.setProject(project);
+  pianoRoll.invalidateSpectrogram();
+  pianoRoll.repaint();
+  if (project) {
+    toolbar.setTotalTime(project->getAudioData().getDuration());
+    toolbar.setLoopEnabled(project->getLoopRange().enabled);
+  }
+  if (commandManager)
+    commandManager->commandStatusChanged();
+}
+
+void MainComponent::newTrack() {
+  if (!editorController || isPluginMode() || isLoadingAudio.load())
+    return;
+  // Empty until a file is opened into it
+  showTrack(editorController->addTrack(nullptr, {}));
+}
+
+void MainComponent::removeFocusedTrack() {
+  if (!editorController || isLoadingAudio.load() ||
+      editorController->getNumTracks() < 2)
+    return;
+
+  const int index = editorController->getFocusedTrack();
+  auto remove = [this, index]() {
+    if (index != editorController->getFocusedTrack() ||
+        editorController->getNumTracks() < 2)
+      return;
+    // The history and versions point into the project going away
+    leaveFocusedTrack();
+    editorController->removeTrack(index);
+    showTrack(editorController->getFocusedTrack());
+  };
+
+  auto *project = getProject();
+  if (!project || !project->isModified()) {
+    remove();
+    return;
+  }
+  juce::Component::SafePointer<MainComponent> safeThis(this);
+  juce::AlertWindow::showOkCancelBox(
+      juce::AlertWindow::QuestionIcon, TR("command.remove_track"),
+      TR("dialog.remove_track_unsaved").replace("{name}", getTrackDisplayName(index)),
+      {}, {}, this,
+      juce::ModalCallbackFunction::create([safeThis, remove](int result) {
+        if (safeThis != nullptr && result != 0)
+          remove();
+      }));
+}
+
+void MainComponent::changeTrackGain(float decibels) {
+  if (!editorController || isPluginMode())
+    return;
+  const int index = editorController->getFocusedTrack();
+  const float gain = editorController->getTrack(index).gain;
+  // From silence a raise starts at -24 dB
+  const float level =
+      gain > 0.0f ? juce::Decibels::gainToDecibels(gain) + decibels : -24.0f;
+  editorController->setTrackGain(
+      index, level <= -60.0f ? 0.0f
+                             : juce::Decibels::decibelsToGain(std::min(level, 12.0f)));
+  if (commandManager)
+    commandManager->commandStatusChanged();
+}
+
+void MainComponent::addTrackItems(juce::PopupMenu &menu) {
+  if (!editorController || isPluginMode())
+    return;
+  juce::Component::SafePointer<MainComponent> safeThis(this);
+  for (int i = 0; i < editorController->getNumTracks(); ++i) {
+    const auto &track = editorController->getTrack(i);
+    auto text = getTrackDisplayName(i);
+    if (track.muted)
+      text << " (" << TR("track.muted") << ")";
+    else if (std::abs(track.gain - 1.0f) > 1.0e-3f)
+      text << " (" << (track.gain > 0.0f
+                           ? juce::String(juce::Decibels::gainToDecibels(track.gain), 1) + " dB"
+                           : juce::String("-inf dB"))
+           << ")";
+    menu.addItem(text, !isLoadingAudio.load(), i == editorController->getFocusedTrack(),
+                 [safeThis, i]() {
+                   if (safeThis != nullptr)
+                     safeThis->showTrack(i);
+                 });
+  }
+}
+
 void MainComponent::onPitchEdited() {
   pianoRoll.repaint();
   parameterPanel.updateFromNote();
@@ -1217,9 +1964,18 @@ void MainComponent::undo() {
   // Cancel any in-progress drawing first
   pianoRoll.cancelDrawing();
 
+  // Undo while previewing discards the preview
+  if (scalePreviewActive) {
+    parameterPanel.endScalePreview();
+    cancelScalePreview();
+    return;
+  }
+
   if (undoManager && undoManager->canUndo()) {
     undoManager->undo();
-    pianoRoll.invalidateBasePitchCache(); // Refresh cache after note split etc.
+    // The piano roll follows the restored notes through the project's note
+    // changes; mel frames restored by a stretch undo are not notes
+    pianoRoll.invalidateSpectrogram();
     pianoRoll.repaint();
 
     if (getProject()) {
@@ -1236,9 +1992,16 @@ void MainComponent::undo() {
 }
 
 void MainComponent::redo() {
+  if (scalePreviewActive) {
+    parameterPanel.endScalePreview();
+    cancelScalePreview();
+  }
+
   if (undoManager && undoManager->canRedo()) {
     undoManager->redo();
-    pianoRoll.invalidateBasePitchCache(); // Refresh cache after note split etc.
+    // The piano roll follows the restored notes through the project's note
+    // changes; mel frames restored by a stretch undo are not notes
+    pianoRoll.invalidateSpectrogram();
     pianoRoll.repaint();
 
     if (getProject()) {
@@ -1293,6 +2056,119 @@ void MainComponent::segmentIntoNotes(Project &targetProject) {
   }
 }
 
+std::pair<int, int> MainComponent::getReanalysisRange() {
+  auto *project = getProject();
+  if (!project)
+    return {0, 0};
+
+  int startFrame = INT_MAX;
+  int endFrame = INT_MIN;
+  for (const auto *note : project->getSelectedNotes()) {
+    startFrame = std::min(startFrame, note->getStartFrame());
+    endFrame = std::max(endFrame, note->getEndFrame());
+  }
+  if (startFrame < endFrame)
+    return {startFrame, endFrame};
+
+  const auto &loop = project->getLoopRange();
+  if (loop.enabled && loop.endSeconds > loop.startSeconds)
+    return {secondsToFrames(static_cast<float>(loop.startSeconds)),
+            secondsToFrames(static_cast<float>(loop.endSeconds))};
+  return {0, 0};
+}
+
+void MainComponent::reanalyzeRange(bool redetectPitch, bool resegment) {
+  const auto range = getReanalysisRange();
+  if (!editorController || range.second <= range.first)
+    return;
+
+  juce::Component::SafePointer<MainComponent> safeThis(this);
+  const bool started = editorController->analyzeRangeAsync(
+      range.first, range.second, redetectPitch, resegment,
+      [safeThis](EditorController::RangeAnalysis result) {
+        if (safeThis != nullptr)
+          safeThis->applyRangeAnalysis(std::move(result));
+      });
+  if (!started)
+    return;
+
+  toolbar.showProgress(TR("progress.reanalyzing_range"));
+  toolbar.setProgress(-1.0f);
+  if (commandManager)
+    commandManager->commandStatusChanged();
+}
+
+void MainComponent::applyRangeAnalysis(EditorController::RangeAnalysis result) {
+  toolbar.hideProgress();
+  if (commandManager)
+    commandManager->commandStatusChanged();
+
+  auto *project = getProject();
+  if (!project || (!result.hasPitch && !result.hasNotes)) {
+    juce::AlertWindow::showMessageBoxAsync(
+        juce::AlertWindow::WarningIcon, TR("dialog.reanalyze_failed"),
+        TR("dialog.reanalyze_failed_msg"));
+    return;
+  }
+
+  const int startFrame = result.startFrame;
+  const int endFrame = result.endFrame;
+  auto &audioData = project->getAudioData();
+  const auto curveRange =
+      PitchCurveProcessor::getCurveRebuildRange(*project, startFrame, endFrame);
+  auto oldCurves =
+      CurveRangeState::capture(audioData, curveRange.first, curveRange.second);
+
+  std::vector<Note> oldNotes;
+  if (result.hasNotes) {
+    for (const auto *note : project->getNotesInRange(startFrame, endFrame))
+      if (!note->isRest())
+        oldNotes.push_back(*note);
+    for (const auto &note : oldNotes)
+      project->removeNoteByStartFrame(note.getStartFrame());
+    for (const auto &note : result.notes)
+      project->addNote(note);
+  }
+
+  std::vector<float> sourcePitch;
+  if (result.hasPitch) {
+    const int voicedEnd =
+        std::min(endFrame, static_cast<int>(audioData.voicedMask.size()));
+    for (int i = startFrame; i < voicedEnd; ++i)
+      audioData.voicedMask[static_cast<size_t>(i)] =
+          result.voicedMask[static_cast<size_t>(i - startFrame)];
+    sourcePitch = std::move(result.f0);
+  } else {
+    sourcePitch.assign(audioData.f0.begin() + startFrame,
+                       audioData.f0.begin() + endFrame);
+  }
+
+  const auto rebuilt =
+      PitchCurveProcessor::rebuildCurvesInRange(*project, sourcePitch, startFrame);
+
+  // A full rebuild (no notes to anchor the range) is not worth an undo step
+  if (undoManager && rebuilt == curveRange) {
+    auto newCurves =
+        CurveRangeState::capture(audioData, curveRange.first, curveRange.second);
+    undoManager->addAction(std::make_unique<RangeReanalysisAction>(
+        project, curveRange.first, curveRange.second, std::move(oldNotes),
+        result.notes, std::move(oldCurves), std::move(newCurves),
+        [this](int minFrame, int maxFrame) {
+          if (auto *current = getProject())
+            current->setF0DirtyRange(minFrame, maxFrame);
+        }));
+  }
+
+  project->setF0DirtyRange(rebuilt.first, rebuilt.second);
+  project->setModified(true);
+  pianoRoll.invalidateBasePitchCache(rebuilt.first, rebuilt.second);
+  pianoRoll.repaint();
+  resynthesizeIncremental();
+  notifyProjectDataChanged();
+  if (commandManager)
+    commandManager->commandStatusChanged();
+}
+
 void MainComponent::showSettings() {
   if (!settingsOverlay) {
     // Pass AudioDeviceManager only in standalone mode
@@ -1317,6 +2193,32 @@ void MainComponent::showSettings() {
     settingsOverlay->getSettingsComponent()->canChangeDevice = [this]() {
       return !isInferenceBusy();
     };
+    settingsOverlay->getSettingsComponent()->onRunProviderBenchmark =
+        [this]() { runProviderBenchmark(); };
+    settingsOverlay->getSettingsComponent()->getMemoryReport = [this]() {
+      return getMemoryReport();
+    };
+    settingsOverlay->getSettingsComponent()->onMemoryBudgetChanged =
+        [this]() { enforceMemoryBudget(); };
+    settingsOverlay->getSettingsComponent()->onRenderingChanged = [this]() {
+      pianoRoll.setGpuRendering(settingsManager->getGpuRendering());
+    };
+    settingsOverlay->getSettingsComponent()->onPaintStatsChanged = [this]() {
+      pianoRoll.setShowPaintStats(settingsManager->getShowPaintStats());
+    };
+    settingsOverlay->getSettingsComponent()->onLogPaintStats = [this]() {
+      pianoRoll.logPaintStats();
+      // Tracing builds also save every zone recorded so far next to the log
+      if (Tracing::isEnabled()) {
+        auto traceFile = PlatformPaths::getLogFile(
+            "trace_" + AppLogger::getSessionId() + "_" +
+            juce::Time::getCurrentTime().formatted("%H%M%S") + ".json");
+        if (Tracing::writeChromeTrace(traceFile))
+          LOG("Trace written to " + traceFile.getFullPathName());
+        else
+          LOG("Failed to write trace to " + traceFile.getFullPathName());
+      }
+    };
     settingsOverlay->getSettingsComponent()->onPitchDetectorChanged =
         [this](PitchDetectorType type) {
           if (editorController)
@@ -1324,6 +2226,7 @@ void MainComponent::showSettings() {
         };
   }
 
+  settingsOverlay->getSettingsComponent()->updateMemoryUsage();
   settingsOverlay->setBounds(getLocalBounds());
   settingsOverlay->setVisible(true);
   settingsOverlay->toFront(true);
@@ -1350,8 +2253,33 @@ void MainComponent::filesDropped(const juce::StringArray &files, int /*x*/,
     loadAudioFile(audioFile);
 }
 
+bool MainComponent::preanalyzeHostAudio(const juce::AudioBuffer<float> &prefix,
+                                        double sampleRate) {
+  if (!isPluginMode() || !editorController)
+    return false;
+  return editorController->preanalyzeHostAudio(prefix, sampleRate);
+}
+
+bool MainComponent::analyzeHostAudioInBackground(
+    const juce::AudioBuffer<float> &buffer, double sampleRate,
+    std::function<void(const juce::String &)> onComplete) {
+  if (!isPluginMode() || !editorController)
+    return false;
+
+  // Dropped if this view closes first; the ARA controller requeues then
+  juce::Component::SafePointer<MainComponent> safeThis(this);
+  editorController->analyzeHostAudioInBackground(
+      buffer, sampleRate,
+      [safeThis, onComplete = std::move(onComplete)](const juce::String &entry) {
+        if (safeThis != nullptr && onComplete)
+          onComplete(entry);
+      });
+  return true;
+}
+
 void MainComponent::setHostAudio(const juce::AudioBuffer<float> &buffer,
-                                 double sampleRate) {
+                                 double sampleRate,
+                                 const juce::String &projectJson) {
   if (!isPluginMode())
     return;
 
@@ -1362,6 +2290,7 @@ void MainComponent::setHostAudio(const juce::AudioBuffer<float> &buffer,
 
   // Show analyzing progress
   toolbar.showProgress(TR("progress.analyzing"));
+  setRenderPending(0.0, std::numeric_limits<double>::max());
 
   juce::Component::SafePointer<MainComponent> safeThis(this);
   editorController->setHostAudioAsync(
@@ -1374,20 +2303,28 @@ void MainComponent::setHostAudio(const juce::AudioBuffer<float> &buffer,
             safeThis->toolbar.showProgress(msg);
         });
       },
-      [safeThis](const juce::AudioBuffer<float> &original) {
+      [safeThis, projectJson](const juce::AudioBuffer<float> &original) {
         if (safeThis == nullptr)
           return;
 
+        safeThis->dropScalePreview();
         if (safeThis->undoManager)
           safeThis->undoManager->clear();
+        safeThis->versions.clear();
+        safeThis->currentVersion = {};
 
         auto *project = safeThis->getProject();
-        if (!project)
+        if (!project) {
+          safeThis->clearRenderPending();
           return;
+        }
+        if (projectJson.isNotEmpty())
+          safeThis->restoreProjectJson(projectJson);
 
         safeThis->pianoRoll.setProject(project);
         safeThis->pianoRollView.setProject(project);
         safeThis->parameterPanel.setProject(project);
+        safeThis->vibratoIndex.setProject(project);
         safeThis->toolbar.setTotalTime(project->getAudioData().getDuration());
 
         safeThis->originalWaveform.makeCopyOf(original);
@@ -1413,8 +2350,8 @@ void MainComponent::setHostAudio(const juce::AudioBuffer<float> &buffer,
                             ? safeThis->editorController->getVocoder()
                             : nullptr;
         if (vocoder && !vocoder->isLoaded()) {
-          auto modelPath = PlatformPaths::getModelsDirectory().getChildFile(
-              "pc_nsf_hifigan.onnx");
+          auto modelPath =
+              safeThis->editorController->getVocoderModelFile();
           if (modelPath.existsAsFile()) {
             if (!vocoder->loadModel(modelPath)) {
               juce::AlertWindow::showMessageBoxAsync(
@@ -1423,6 +2360,7 @@ void MainComponent::setHostAudio(const juce::AudioBuffer<float> &buffer,
                       modelPath.getFullPathName() +
                       "\n\nPlease check your model installation and try again.");
               safeThis->toolbar.hideProgress();
+              safeThis->clearRenderPending();
               return;
             }
           } else {
@@ -1432,6 +2370,7 @@ void MainComponent::setHostAudio(const juce::AudioBuffer<float> &buffer,
                     modelPath.getFullPathName() +
                     "\n\nPlease install the required model files and try again.");
             safeThis->toolbar.hideProgress();
+            safeThis->clearRenderPending();
             return;
           }
         }
@@ -1439,6 +2378,7 @@ void MainComponent::setHostAudio(const juce::AudioBuffer<float> &buffer,
         safeThis->repaint();
 
         safeThis->notifyProjectDataChanged();
+        safeThis->clearRenderPending();
 
         safeThis->toolbar.hideProgress();
       });
@@ -1479,6 +2419,20 @@ void MainComponent::bindRealtimeProcessor(RealtimePitchProcessor &processor) {
   processor.setProject(getProject());
   processor.setVocoder(editorController ? editorController->getVocoder()
                                         : nullptr);
+  if (boundProcessor != &processor && editorController)
+    editorController->setOfflineRenderFocus(
+        [&processor]() { return processor.getOfflineWaitPosition(); });
+  boundProcessor = &processor;
+}
+
+void MainComponent::setRenderPending(double startSeconds, double endSeconds) {
+  if (boundProcessor)
+    boundProcessor->setRenderPending(startSeconds, endSeconds);
+}
+
+void MainComponent::clearRenderPending() {
+  if (boundProcessor)
+    boundProcessor->clearRenderPending();
 }
 
 juce::String MainComponent::serializeProjectJson() const {
@@ -1502,6 +2456,23 @@ bool MainComponent::restoreProjectJson(const juce::String &jsonString) {
   return false;
 }
 
+juce::MemoryBlock MainComponent::serializeProjectState() {
+  if (auto *project = getProject())
+    return ProjectSerializer::saveToMemory(*project, stateChunkCache);
+  return {};
+}
+
+bool MainComponent::restoreProjectState(const void *data, size_t numBytes) {
+  if (numBytes == 0)
+    return false;
+  if (!ProjectSerializer::isBinaryProjectData(data, numBytes))
+    return restoreProjectJson(juce::String::fromUTF8(
+        static_cast<const char *>(data), static_cast<int>(numBytes)));
+  if (auto *project = getProject())
+    return ProjectSerializer::loadFromMemory(*project, data, numBytes);
+  return false;
+}
+
 void MainComponent::notifyHostStopped() {
   if (!isPluginMode())
     return;
@@ -1574,6 +2545,7 @@ void MainComponent::getAllCommands(juce::Array<juce::CommandID>& commands) {
         CommandIDs::openFile,
         CommandIDs::saveProject,
         CommandIDs::exportAudio,
+        CommandIDs::exportAudioRange,
         CommandIDs::exportMidi,
         CommandIDs::quit,
         
@@ -1581,21 +2553,38 @@ void MainComponent::getAllCommands(juce::Array<juce::CommandID>& commands) {
         CommandIDs::undo,
         CommandIDs::redo,
         CommandIDs::selectAll,
+        CommandIDs::speculativeSynthesis,
+        CommandIDs::redetectPitchInRange,
+        CommandIDs::resegmentRange,
+        CommandIDs::resetPitchInRange,
+        CommandIDs::saveVersion,
+        CommandIDs::switchVersion,
         
         // View commands
         CommandIDs::showSettings,
         CommandIDs::showDeltaPitch,
         CommandIDs::showBasePitch,
+        CommandIDs::showSpectrogram,
         
         // Transport commands
         CommandIDs::playPause,
         CommandIDs::stop,
         CommandIDs::goToStart,
         CommandIDs::goToEnd,
+        CommandIDs::loopFocus,
+        CommandIDs::compareOriginal,
         
         // Edit mode commands
         CommandIDs::toggleDrawMode,
-        CommandIDs::exitDrawMode
+        CommandIDs::exitDrawMode,
+
+        // Track commands
+        CommandIDs::newTrack,
+        CommandIDs::removeTrack,
+        CommandIDs::nextTrack,
+        CommandIDs::muteTrack,
+        CommandIDs::raiseTrackGain,
+        CommandIDs::lowerTrackGain
     };
     
     commands.addArray(commandArray, sizeof(commandArray) / sizeof(commandArray[0]));
@@ -1628,6 +2617,16 @@ void MainComponent::getCommandInfo(juce::CommandID commandID,
             result.addDefaultKeypress('e', primaryModifier);
             result.setActive(project != nullptr);
             break;
+
+        case CommandIDs::exportAudioRange:
+        {
+            result.setInfo(TR("command.export_audio_range"), TR("command.export_audio_range.desp"),
+                           "File", 0);
+            result.addDefaultKeypress('e', primaryModifier | juce::ModifierKeys::shiftModifier);
+            const auto range = getReanalysisRange();
+            result.setActive(range.second > range.first);
+            break;
+        }
             
         case CommandIDs::exportMidi:
             result.setInfo(TR("command.export_midi"), TR("command.export_midi.desp"), "File", 0);
@@ -1663,6 +2662,52 @@ void MainComponent::getCommandInfo(juce::CommandID commandID,
             result.setActive(project != nullptr);
             break;
             
+        case CommandIDs::speculativeSynthesis:
+            result.setInfo(TR("command.speculative_synthesis"), TR("command.speculative_synthesis.desp"), "Edit", 0);
+            result.setTicked(settingsManager->getSpeculativeSynthesis());
+            break;
+            
+        case CommandIDs::redetectPitchInRange:
+        case CommandIDs::resegmentRange:
+        {
+            const bool pitch = commandID == CommandIDs::redetectPitchInRange;
+            result.setInfo(TR(pitch ? "command.redetect_pitch_range" : "command.resegment_range"),
+                           TR(pitch ? "command.redetect_pitch_range.desp" : "command.resegment_range.desp"),
+                           "Edit", 0);
+            const auto range = getReanalysisRange();
+            result.setActive(editorController != nullptr && range.second > range.first
+                             && !editorController->isLoading()
+                             && !editorController->isAnalyzingRange());
+            break;
+        }
+
+        case CommandIDs::resetPitchInRange:
+        {
+            result.setInfo(TR("command.reset_pitch_range"), TR("command.reset_pitch_range.desp"),
+                           "Edit", 0);
+            const auto range = getReanalysisRange();
+            result.setActive(range.second > range.first);
+            break;
+        }
+
+        case CommandIDs::saveVersion:
+            result.setInfo(TR("command.save_version"), TR("command.save_version.desp"), "Edit", 0);
+            result.setActive(project != nullptr);
+            break;
+
+        case CommandIDs::switchVersion:
+        {
+            const auto names = versions.getNames();
+            juce::String name = TR("command.switch_version");
+            if (names.size() > 1)
+                name << " (" << currentVersion << " > "
+                     << names[(names.indexOf(currentVersion) + 1) % names.size()] << ")";
+            result.setInfo(name, TR("command.switch_version.desp"), "Edit", 0);
+            result.addDefaultKeypress('b', primaryModifier);
+            result.setActive(project != nullptr && names.size() > 1);
+            break;
+        }
+            
         // View commands
         case CommandIDs::showSettings:
             result.setInfo(TR("command.settings"), TR("command.settings.desp"), "View", 0);
@@ -1681,6 +2726,12 @@ void MainComponent::getCommandInfo(juce::CommandID commandID,
             result.setTicked(settingsManager->getShowBasePitch());
             break;
             
+        case CommandIDs::showSpectrogram:
+            result.setInfo(TR("command.show_spectrogram"), TR("command.show_spectrogram.desp"), "View", 0);
+            result.addDefaultKeypress('m', primaryModifier | juce::ModifierKeys::shiftModifier);
+            result.setTicked(settingsManager->getShowSpectrogram());
+            break;
+            
         // Transport commands
         case CommandIDs::playPause:
             result.setInfo(TR("command.play_pause"), TR("command.play_pause.desp"), "Transport", 0);
@@ -1706,6 +2757,22 @@ void MainComponent::getCommandInfo(juce::CommandID commandID,
             result.setActive(project != nullptr);
             break;
             
+        case CommandIDs::loopFocus:
+            result.setInfo(TR("command.loop_focus"), TR("command.loop_focus.desp"), "Transport", 0);
+            result.setTicked(settingsManager->getLoopFocus());
+            break;
+
+        case CommandIDs::compareOriginal:
+        {
+            auto *audioEngine = editorController ? editorController->getAudioEngine() : nullptr;
+            result.setInfo(TR("command.compare_original"), TR("command.compare_original.desp"),
+                           "Transport", 0);
+            result.addDefaultKeypress('o', juce::ModifierKeys::noModifiers);
+            result.setActive(audioEngine != nullptr && project != nullptr);
+            result.setTicked(audioEngine != nullptr && audioEngine->isPlayingOriginal());
+            break;
+        }
+            
         // Edit mode commands
         case CommandIDs::toggleDrawMode:
             result.setInfo(TR("command.toggle_draw"), TR("command.toggle_draw.desp"), "Edit Mode", 0);
@@ -1719,7 +2786,53 @@ void MainComponent::getCommandInfo(juce::CommandID commandID,
             result.addDefaultKeypress(juce::KeyPress::escapeKey, juce::ModifierKeys::noModifiers);
             result.setActive(pianoRoll.getEditMode() == EditMode::Draw);
             break;
-            
+
+        // Track commands
+        case CommandIDs::newTrack:
+        case CommandIDs::removeTrack:
+        case CommandIDs::nextTrack:
+        case CommandIDs::muteTrack:
+        case CommandIDs::raiseTrackGain:
+        case CommandIDs::lowerTrackGain:
+        {
+            // Standalone only; focus stays put while a file loads into it
+            const bool hasTracks = editorController != nullptr && !isPluginMode();
+            const bool canSwitch = hasTracks && !isLoadingAudio.load();
+            const int numTracks = hasTracks ? editorController->getNumTracks() : 0;
+            const int focused = hasTracks ? editorController->getFocusedTrack() : 0;
+            const auto *track = hasTracks ? &editorController->getTrack(focused) : nullptr;
+
+            if (commandID == CommandIDs::newTrack) {
+                result.setInfo(TR("command.new_track"), TR("command.new_track.desp"), "Track", 0);
+                result.addDefaultKeypress('t', primaryModifier | juce::ModifierKeys::shiftModifier);
+                result.setActive(canSwitch);
+            } else if (commandID == CommandIDs::removeTrack) {
+                result.setInfo(TR("command.remove_track"), TR("command.remove_track.desp"),
+                               "Track", 0);
+                result.setActive(canSwitch && numTracks > 1);
+            } else if (commandID == CommandIDs::nextTrack) {
+                juce::String name = TR("command.next_track");
+                if (numTracks > 1)
+                    name << " (" << getTrackDisplayName((focused + 1) % numTracks) << ")";
+                result.setInfo(name, TR("command.next_track.desp"), "Track", 0);
+                result.addDefaultKeypress(juce::KeyPress::tabKey, primaryModifier);
+                result.setActive(canSwitch && numTracks > 1);
+            } else if (commandID == CommandIDs::muteTrack) {
+                result.setInfo(TR("command.mute_track"), TR("command.mute_track.desp"), "Track", 0);
+                result.setActive(hasTracks);
+                result.setTicked(track != nullptr && track->muted);
+            } else if (commandID == CommandIDs::raiseTrackGain) {
+                result.setInfo(TR("command.raise_track_gain"),
+                               TR("command.raise_track_gain.desp"), "Track", 0);
+                result.setActive(hasTracks);
+            } else {
+                result.setInfo(TR("command.lower_track_gain"),
+                               TR("command.lower_track_gain.desp"), "Track", 0);
+                result.setActive(track != nullptr && track->gain > 0.0f);
+            }
+            break;
+        }
+
         default:
             break;
     }
@@ -1739,6 +2852,10 @@ bool MainComponent::perform(const ApplicationCommandTarget::InvocationInfo& info
         case CommandIDs::exportAudio:
             exportFile();
             return true;
+
+        case CommandIDs::exportAudioRange:
+            exportFile(true);
+            return true;
             
         case CommandIDs::exportMidi:
             exportMidiFile();
@@ -1764,6 +2881,39 @@ bool MainComponent::perform(const ApplicationCommandTarget::InvocationInfo& info
             }
             return true;
             
+        case CommandIDs::speculativeSynthesis:
+        {
+            bool newState = !settingsManager->getSpeculativeSynthesis();
+            pianoRoll.setSpeculativeSynthesis(newState);
+            settingsManager->setSpeculativeSynthesis(newState);
+            settingsManager->saveConfig();
+            commandManager->commandStatusChanged();
+            return true;
+        }
+            
+        case CommandIDs::redetectPitchInRange:
+            reanalyzeRange(/*redetectPitch=*/true, /*resegment=*/false);
+            return true;
+            
+        case CommandIDs::resegmentRange:
+            reanalyzeRange(/*redetectPitch=*/false, /*resegment=*/true);
+            return true;
+
+        case CommandIDs::resetPitchInRange:
+        {
+            const auto range = getReanalysisRange();
+            pianoRoll.resetPitchToOriginal(range.first, range.second);
+            return true;
+        }
+
+        case CommandIDs::saveVersion:
+            saveVersion();
+            return true;
+
+        case CommandIDs::switchVersion:
+            switchVersion();
+            return true;
+            
         // View commands
         case CommandIDs::showSettings:
             showSettings();
@@ -1789,6 +2939,16 @@ bool MainComponent::perform(const ApplicationCommandTarget::InvocationInfo& info
             return true;
         }
         
+        case CommandIDs::showSpectrogram:
+        {
+            bool newState = !settingsManager->getShowSpectrogram();
+            pianoRoll.setShowSpectrogram(newState);
+            settingsManager->setShowSpectrogram(newState);
+            settingsManager->saveConfig();
+            commandManager->commandStatusChanged();
+            return true;
+        }
+        
         // Transport commands
         case CommandIDs::playPause:
             if (isPlaying)
@@ -1811,6 +2971,24 @@ bool MainComponent::perform(const ApplicationCommandTarget::InvocationInfo& info
             }
             return true;
             
+        case CommandIDs::loopFocus:
+        {
+            bool newState = !settingsManager->getLoopFocus();
+            if (auto *audioEngine = editorController ? editorController->getAudioEngine() : nullptr)
+                audioEngine->setLoopFocus(newState);
+            settingsManager->setLoopFocus(newState);
+            settingsManager->saveConfig();
+            commandManager->commandStatusChanged();
+            return true;
+        }
+
+        case CommandIDs::compareOriginal:
+            if (auto *audioEngine = editorController ? editorController->getAudioEngine() : nullptr) {
+                audioEngine->setPlayingOriginal(!audioEngine->isPlayingOriginal());
+                commandManager->commandStatusChanged();
+            }
+            return true;
+            
         // Edit mode commands
         case CommandIDs::toggleDrawMode:
             if (pianoRoll.getEditMode() == EditMode::Draw)
@@ -1824,6 +3002,39 @@ bool MainComponent::perform(const ApplicationCommandTarget::InvocationInfo& info
                 setEditMode(EditMode::Select);
             }
             return true;
+
+        // Track commands
+        case CommandIDs::newTrack:
+            newTrack();
+            return true;
+
+        case CommandIDs::removeTrack:
+            removeFocusedTrack();
+            return true;
+
+        case CommandIDs::nextTrack:
+            if (editorController && !isLoadingAudio.load())
+                showTrack((editorController->getFocusedTrack() + 1)
+                          % editorController->getNumTracks());
+            return true;
+
+        case CommandIDs::muteTrack:
+        {
+            if (!editorController || isPluginMode())
+                return true;
+            const int index = editorController->getFocusedTrack();
+            editorController->setTrackMuted(index, !editorController->getTrack(index).muted);
+            commandManager->commandStatusChanged();
+            return true;
+        }
+
+        case CommandIDs::raiseTrackGain:
+            changeTrackGain(1.0f);
+            return true;
+
+        case CommandIDs::lowerTrackGain:
+            changeTrackGain(-1.0f);
+            return true;
             
         default:
             return false;
@@ -3,8 +3,12 @@
 #include "../Audio/EditorController.h"
 #include "IMainView.h"
 #include "../Audio/IO/AudioFileManager.h"
+#include "../Audio/Synthesis/ResynthesisDebounce.h"
 #include "../JuceHeader.h"
 #include "../Models/Project.h"
+#include "../Models/ProjectSaver.h"
+#include "../Models/ProjectSerializer.h"
+#include "../Models/ProjectVersions.h"
 #include "../Utils/UndoManager.h"
 #include "CustomMenuBarLookAndFeel.h"
 #include "CustomTitleBar.h"
@@ -36,6 +40,7 @@ public:
   void resized() override;
 
   void timerCallback() override;
+  void displayFrameCallback();
 
   // KeyListener
   bool keyPressed(const juce::KeyPress &key,
@@ -69,6 +74,8 @@ public:
   void bindRealtimeProcessor(RealtimePitchProcessor &processor) override;
   juce::String serializeProjectJson() const override;
   bool restoreProjectJson(const juce::String &json) override;
+  juce::MemoryBlock serializeProjectState() override;
+  bool restoreProjectState(const void *data, size_t numBytes) override;
   void setStatusMessage(const juce::String &message) override {
     toolbar.setStatusMessage(message);
   }
@@ -93,14 +100,25 @@ public:
       std::function<void(double)> callback) override {
     onRequestHostSeek = std::move(callback);
   }
+  void setOnDisplayFrame(std::function<void()> callback) override {
+    onDisplayFrame = std::move(callback);
+  }
+  void setDisplayFrameRate(int framesPerSecond) override {
+    displayFrameRate = juce::jmax(0, framesPerSecond);
+  }
   juce::Point<int> getSavedWindowSize() const;
 
   // Check if ARA mode is active (for UI display)
   bool isARAModeActive() const;
 
   // Plugin mode - host audio handling
-  void setHostAudio(const juce::AudioBuffer<float> &buffer,
-                    double sampleRate) override;
+  void setHostAudio(const juce::AudioBuffer<float> &buffer, double sampleRate,
+                    const juce::String &projectJson = {}) override;
+  bool analyzeHostAudioInBackground(
+      const juce::AudioBuffer<float> &buffer, double sampleRate,
+      std::function<void(const juce::String &)> onComplete) override;
+  bool preanalyzeHostAudio(const juce::AudioBuffer<float> &prefix,
+                           double sampleRate) override;
   void renderProcessedAudio();
 
   // Plugin mode callbacks
@@ -117,21 +135,75 @@ public:
   std::function<void()> onRequestHostStop;
   std::function<void(double timeInSeconds)> onRequestHostSeek;
 
+  // Plugin mode - polls host state on every display frame
+  std::function<void()> onDisplayFrame;
+
   // Plugin mode - update playback position from host
   void updatePlaybackPosition(double timeSeconds) override;
   void notifyHostStopped() override; // Called when host stops playback
 
 private:
   void openFile();
-  void exportFile();
+  // selectionOnly: just the selected notes or loop range; see
+  // getReanalysisRange()
+  void exportFile(bool selectionOnly = false);
+  void exportAudioTo(const juce::File &file,
+                     std::pair<int, int> frameRange = {0, 0});
   void exportMidiFile();
   void play();
   void pause();
   void stop();
   void seek(double time);
-  void resynthesizeIncremental(); // Incremental synthesis on edit
+  // Resynthesize and notify after an edit; gestureEnded for a mouse-up
+  void handlePitchEditFinished(bool gestureEnded = false);
+  // Incremental synthesis on edit, now or once a burst of edits pauses
+  // (see ResynthesisDebounce)
+  void resynthesizeIncremental(bool gestureEnded = false);
+  void startIncrementalResynthesis();
+  // Full-model re-render of preview-tier edits, once editing pauses
+  void refinePreviewRender();
+  // Run the timer only while something needs polling: 30 Hz for load
+  // progress, 4 Hz while preview audio awaits refinement
+  void updateTimer();
+  // Offline host renders of [start, end) seconds wait while set
+  void setRenderPending(double startSeconds, double endSeconds);
+  void clearRenderPending();
   void showSettings();
 
+  // Project data plus undo history and synthesis cache sizes
+  ProjectMemoryReport getMemoryReport() const;
+  // Trim evictable memory to the configured budget: the synthesis cache
+  // first (rebuilt on demand), then redo history, then the oldest undo steps
+  void enforceMemoryBudget();
+
+  // Scale correction (ParameterPanel): a preview is an open undo
+  // transaction holding the correction, auditioned without the vocoder;
+  // apply commits it as one step and one resynthesis, cancel rolls it back
+  void previewScaleCorrection(const ScaleCorrection::Settings &settings);
+  void applyScaleCorrection(const ScaleCorrection::Settings &settings);
+  void cancelScalePreview();
+  // Forget the preview without touching the project, before the history
+  // it belongs to is cleared
+  void dropScalePreview();
+  void correctToScale(const ScaleCorrection::Settings &settings);
+  // Give every note with vibrato scale times its sung depth, as one step
+  void scaleVibrato(float scale);
+  // A/B versions: saveVersion() branches the project under the next
+  // letter; switchVersion() keeps the current branch's edits under its name
+  // and restores the next one, render and all
+  void saveVersion();
+  void switchVersion();
+  // Tracks of the standalone session: the window edits the focused one
+  // while every unmuted track plays in the mix. Undo history and versions
+  // belong to a project, so they start over on the track shown.
+  void newTrack();
+  void removeFocusedTrack();
+  void showTrack(int index);
+  void leaveFocusedTrack();
+  void addTrackItems(juce::PopupMenu &menu);
+  void changeTrackGain(float decibels);
+  juce::String getTrackDisplayName(int index) const;
+
   void onNoteSelected(Note *note);
   void onPitchEdited();
   void onZoomChanged(float pixelsPerSecond);
@@ -139,10 +211,23 @@ private:
                        int endFrame); // Re-infer UV regions using FCPE
   void notifyProjectDataChanged();
 
+  // Starts the models and opens the audio device once the window is up
+  void finishStartup();
   void reloadInferenceModels(bool async = false);
+  void applyInferenceConfig();
+  void runProviderBenchmark();
   bool isInferenceBusy() const;
 
   void loadAudioFile(const juce::File &file);
+  // Show partial analysis results in the piano roll while loading
+  void applyAnalysisPreview(EditorController::AnalysisPreview preview);
+  void endAnalysisPreview();
+  // Move edits made on the preview into the analysed project; true if any
+  bool carryOverPreviewEdits(Project &project);
+  // Swap the F0-based notes an import opened with for SOME's, keeping the
+  // notes edited or added since
+  void applyRefinedNotes(const std::vector<Note> &provisional,
+                         std::vector<Note> refined);
   void analyzeAudio();
   void analyzeAudio(
       Project &targetProject,
@@ -150,8 +235,14 @@ private:
       std::function<void()> onComplete = nullptr);
   void segmentIntoNotes();
   void segmentIntoNotes(Project &targetProject);
+  // Frames the re-analysis commands act on: the selected notes, else the
+  // enabled loop range; an empty range when there is neither
+  std::pair<int, int> getReanalysisRange();
+  void reanalyzeRange(bool redetectPitch, bool resegment);
+  void applyRangeAnalysis(EditorController::RangeAnalysis result);
 
   void saveProject();
+  void saveProjectTo(const juce::File &file); // Background save
 
   void undo();
   void redo();
@@ -165,6 +256,7 @@ private:
   std::unique_ptr<AudioFileManager> fileManager;
   std::unique_ptr<MenuHandler> menuHandler;
   std::unique_ptr<SettingsManager> settingsManager;
+  std::unique_ptr<ProjectSaver> projectSaver; // Saves and autosave journal
 
   const bool enableAudioDeviceFlag;
 
@@ -188,6 +280,12 @@ private:
 
   // Sync flag to prevent infinite loops
   bool isSyncingZoom = false;
+  bool isEnforcingMemoryBudget = false;
+  bool pitchEditPendingForBatch = false;
+  bool scalePreviewActive = false;
+  VibratoIndex vibratoIndex; // Sung vibrato of the displayed project's notes
+  ProjectVersions versions;  // Of the focused project; cleared on load
+  juce::String currentVersion;
 
   // Async load state
   std::atomic<bool> isLoadingAudio{false};
@@ -196,14 +294,29 @@ private:
   juce::String loadingMessage;
   juce::String lastLoadingMessage;
 
+  // Project shown, and editable, while an import is still being analysed
+  std::unique_ptr<Project> analysisPreview;
+  std::vector<float> analysisPreviewF0; // Detected F0, before curve rebuild
+  // Its notes as analysis delivered them, telling the user's edits apart
+  std::vector<Note> analysisPreviewNotes;
+
   // Async render state (plugin mode) is managed by EditorController
+  RealtimePitchProcessor *boundProcessor = nullptr; // Plugin mode
+  // Compressed curves of the last plugin state, reused while unchanged
+  ProjectSerializer::ChunkCache stateChunkCache;
   // Incremental synthesis coalescing
   std::atomic<bool> pendingIncrementalResynth{false};
+  ResynthesisDebounce resynthesisDebounce;
+  int resynthesisGeneration = 0; // Bumped to drop a held resynthesis
 
-  // Cursor update throttling
+  // Cursor updates, applied once per display frame
   std::atomic<double> pendingCursorTime{0.0};
   std::atomic<bool> hasPendingCursorUpdate{false};
+  std::unique_ptr<juce::VBlankAttachment> displayFrameAttachment;
+  int displayFrameRate = 0; // 0 = every refresh
+  double lastDisplayFrameMs = 0.0;
   juce::int64 lastCursorUpdateTime = 0;
+  bool startupFinished = false;
 
 #if JUCE_MAC
   juce::ComponentDragger dragger;
@@ -1,6 +1,8 @@
 #include "MainViewFactory.h"
 #include "MainComponent.h"
+#include "../Audio/HardwareCapabilities.h"
 #include "../Utils/AppLogger.h"
+#include "../Utils/JobSystem.h"
 #include "../Utils/UI/TimecodeFont.h"
 #include "../Utils/UI/WindowSizing.h"
 #include "StyledComponents.h"
@@ -11,6 +13,8 @@ std::unique_ptr<IMainView> createMainView(bool enableAudioDevice) {
 
 void initializeUiResources() {
   AppLogger::init();
+  JobSystem::init();
+  HardwareCapabilities::init();
   AppFont::initialize();
   TimecodeFont::initialize();
 }
@@ -18,6 +22,9 @@ void initializeUiResources() {
 void shutdownUiResources() {
   TimecodeFont::shutdown();
   AppFont::shutdown();
+  HardwareCapabilities::shutdown();
+  JobSystem::shutdown();
+  AppLogger::shutdown();
 }
 
 juce::Point<int> getDefaultMainViewSize(juce::Component *component) {
@@ -12,6 +12,13 @@ ParameterPanel::ParameterPanel()
 
     // Setup sliders
     setupSlider(pitchOffsetSlider, pitchOffsetLabel, TR("param.pitch_offset"), -24.0, 24.0, 0.0);
+    setupSlider(noteGainSlider, noteGainLabel, TR("param.note_gain"), -36.0, 12.0, 0.0);
+    setupSlider(fadeInSlider, fadeInLabel, TR("param.fade_in"), 0.0, 1000.0, 0.0);
+    setupSlider(fadeOutSlider, fadeOutLabel, TR("param.fade_out"), 0.0, 1000.0, 0.0);
+    for (auto* slider : { &noteGainSlider, &fadeInSlider, &fadeOutSlider })
+        slider->setDoubleClickReturnValue(true, 0.0);
+    fadeInSlider.setNumDecimalPlacesToDisplay(0);
+    fadeOutSlider.setNumDecimalPlacesToDisplay(0);
 
     // Volume knob setup
     addAndMakeVisible(volumeKnob);
@@ -29,15 +36,55 @@ ParameterPanel::ParameterPanel()
 
     setupSlider(formantShiftSlider, formantShiftLabel, TR("param.formant_shift"), -12.0, 12.0, 0.0);
     setupSlider(globalPitchSlider, globalPitchLabel, TR("param.global_pitch"), -24.0, 24.0, 0.0);
+    setupSlider(vibratoScaleSlider, vibratoScaleLabel, TR("param.vibrato_scale"), 0.0, 200.0, 100.0);
+    vibratoScaleSlider.setNumDecimalPlacesToDisplay(0);
+
+    // Scale correction
+    static const char* keyNames[] = { "C", "C#", "D", "D#", "E", "F",
+                                      "F#", "G", "G#", "A", "A#", "B" };
+    for (int key = 0; key < 12; ++key)
+        scaleKeyCombo.addItem(keyNames[key], key + 1);
+    scaleKeyCombo.setSelectedId(1, juce::dontSendNotification);
+
+    static const char* modeKeys[] = { "param.scale_chromatic", "param.scale_major",
+                                      "param.scale_natural_minor", "param.scale_harmonic_minor",
+                                      "param.scale_major_pentatonic", "param.scale_minor_pentatonic" };
+    for (int mode = 0; mode < static_cast<int>(ScaleCorrection::Mode::numModes); ++mode)
+        scaleModeCombo.addItem(TR(modeKeys[mode]), mode + 1);
+    scaleModeCombo.setSelectedId(static_cast<int>(ScaleCorrection::Mode::Major) + 1,
+                                 juce::dontSendNotification);
+
+    for (auto* combo : { &scaleKeyCombo, &scaleModeCombo })
+    {
+        addAndMakeVisible(combo);
+        combo->addListener(this);
+    }
+
+    setupSlider(scaleRetuneSlider, scaleRetuneLabel, TR("param.scale_retune"), 0.0, 400.0, 50.0);
+    setupSlider(scaleHumanizeSlider, scaleHumanizeLabel, TR("param.scale_humanize"), 0.0, 100.0, 0.0);
+    scaleRetuneSlider.setNumDecimalPlacesToDisplay(0);
+    scaleHumanizeSlider.setNumDecimalPlacesToDisplay(0);
+
+    scalePreviewButton.setButtonText(TR("param.scale_preview"));
+    scaleApplyButton.setButtonText(TR("param.scale_apply"));
+    scaleApplyButton.setColour(juce::TextButton::buttonColourId, APP_COLOR_PRIMARY);
+    scaleApplyButton.setColour(juce::TextButton::textColourOffId, juce::Colours::white);
+    for (auto* button : std::initializer_list<juce::Button*> { &scalePreviewButton, &scaleApplyButton })
+    {
+        addAndMakeVisible(button);
+        button->addListener(this);
+    }
 
     // Section labels
     pitchSectionLabel.setText(TR("param.pitch"), juce::dontSendNotification);
+    levelSectionLabel.setText(TR("param.note_level"), juce::dontSendNotification);
     volumeSectionLabel.setText(TR("param.volume"), juce::dontSendNotification);
     formantSectionLabel.setText(TR("param.formant"), juce::dontSendNotification);
     globalSectionLabel.setText(TR("param.global"), juce::dontSendNotification);
+    scaleSectionLabel.setText(TR("param.scale"), juce::dontSendNotification);
 
-    for (auto* label : { &pitchSectionLabel, &volumeSectionLabel,
-                         &formantSectionLabel, &globalSectionLabel })
+    for (auto* label : { &pitchSectionLabel, &levelSectionLabel, &volumeSectionLabel,
+                         &formantSectionLabel, &globalSectionLabel, &scaleSectionLabel })
     {
         addAndMakeVisible(label);
         label->setColour(juce::Label::textColourId, APP_COLOR_PRIMARY);
@@ -45,10 +92,12 @@ ParameterPanel::ParameterPanel()
             juce::Font(juce::FontOptions(14.0f, juce::Font::bold)));
     }
 
-    // Formant slider disabled (not implemented yet)
+    // Enabled once a project is set
     formantShiftSlider.setEnabled(false);
-    // Global pitch slider is now enabled!
-    globalPitchSlider.setEnabled(true);
+    globalPitchSlider.setEnabled(false);
+    vibratoScaleSlider.setEnabled(false);
+    scalePreviewButton.setEnabled(false);
+    scaleApplyButton.setEnabled(false);
 }
 
 ParameterPanel::~ParameterPanel()
@@ -106,9 +155,11 @@ void ParameterPanel::paint(juce::Graphics& g)
 
     drawCard(noteCardBounds);
     drawCard(pitchCardBounds);
+    drawCard(levelCardBounds);
     drawCard(volumeCardBounds);
     drawCard(formantCardBounds);
     drawCard(globalCardBounds);
+    drawCard(scaleCardBounds);
 }
 
 void ParameterPanel::resized()
@@ -131,6 +182,19 @@ void ParameterPanel::resized()
     pitchOffsetSlider.setBounds(pitchArea.removeFromTop(26));
     bounds.removeFromTop(cardGap);
 
+    // Note level card
+    levelCardBounds = bounds.removeFromTop(176);
+    auto levelArea = levelCardBounds.reduced(10);
+    levelSectionLabel.setBounds(levelArea.removeFromTop(18));
+    levelArea.removeFromTop(6);
+    noteGainLabel.setBounds(levelArea.removeFromTop(18));
+    noteGainSlider.setBounds(levelArea.removeFromTop(26));
+    fadeInLabel.setBounds(levelArea.removeFromTop(18));
+    fadeInSlider.setBounds(levelArea.removeFromTop(26));
+    fadeOutLabel.setBounds(levelArea.removeFromTop(18));
+    fadeOutSlider.setBounds(levelArea.removeFromTop(26));
+    bounds.removeFromTop(cardGap);
+
     // Volume card
     volumeCardBounds = bounds.removeFromTop(112);
     auto volumeArea = volumeCardBounds.reduced(10);
@@ -154,12 +218,34 @@ void ParameterPanel::resized()
     bounds.removeFromTop(cardGap);
 
     // Global card
-    globalCardBounds = bounds.removeFromTop(92);
+    globalCardBounds = bounds.removeFromTop(136);
     auto globalArea = globalCardBounds.reduced(10);
     globalSectionLabel.setBounds(globalArea.removeFromTop(18));
     globalArea.removeFromTop(6);
     globalPitchLabel.setBounds(globalArea.removeFromTop(18));
     globalPitchSlider.setBounds(globalArea.removeFromTop(26));
+    vibratoScaleLabel.setBounds(globalArea.removeFromTop(18));
+    vibratoScaleSlider.setBounds(globalArea.removeFromTop(26));
+    bounds.removeFromTop(cardGap);
+
+    // Scale correction card
+    scaleCardBounds = bounds.removeFromTop(196);
+    auto scaleArea = scaleCardBounds.reduced(10);
+    scaleSectionLabel.setBounds(scaleArea.removeFromTop(18));
+    scaleArea.removeFromTop(6);
+    auto comboRow = scaleArea.removeFromTop(24);
+    scaleKeyCombo.setBounds(comboRow.removeFromLeft(64));
+    comboRow.removeFromLeft(6);
+    scaleModeCombo.setBounds(comboRow);
+    scaleArea.removeFromTop(4);
+    scaleRetuneLabel.setBounds(scaleArea.removeFromTop(18));
+    scaleRetuneSlider.setBounds(scaleArea.removeFromTop(26));
+    scaleHumanizeLabel.setBounds(scaleArea.removeFromTop(18));
+    scaleHumanizeSlider.setBounds(scaleArea.removeFromTop(26));
+    scaleArea.removeFromTop(6);
+    auto buttonRow = scaleArea.removeFromTop(26);
+    scaleApplyButton.setBounds(buttonRow.removeFromRight(80));
+    scalePreviewButton.setBounds(buttonRow);
 }
 
 void ParameterPanel::sliderValueChanged(juce::Slider* slider)
@@ -174,6 +260,20 @@ void ParameterPanel::sliderValueChanged(juce::Slider* slider)
         if (onParameterChanged)
             onParameterChanged();
     }
+    else if ((slider == &noteGainSlider || slider == &fadeInSlider || slider == &fadeOutSlider)
+             && selectedNote)
+    {
+        // Post-vocoder lane: the note stays clean
+        constexpr double framesPerMs = SAMPLE_RATE / (1000.0 * HOP_SIZE);
+        selectedNote->setGainDb(static_cast<float>(noteGainSlider.getValue()));
+        selectedNote->setFadeInFrames(juce::roundToInt(fadeInSlider.getValue() * framesPerMs));
+        selectedNote->setFadeOutFrames(juce::roundToInt(fadeOutSlider.getValue() * framesPerMs));
+        if (project)
+            project->setModified(true);
+
+        if (onNoteGainChanged)
+            onNoteGainChanged();
+    }
     else if (slider == &globalPitchSlider && project)
     {
         project->setGlobalPitchOffset(static_cast<float>(slider->getValue()));
@@ -185,6 +285,14 @@ void ParameterPanel::sliderValueChanged(juce::Slider* slider)
         if (onGlobalPitchChanged)
             onGlobalPitchChanged();
     }
+    else if (slider == &formantShiftSlider && project)
+    {
+        // The mel is warped when fed to the vocoder, so only resynthesis is
+        // needed, never re-analysis
+        project->setFormantShift(static_cast<float>(slider->getValue()));
+        for (auto& note : project->getNotes())
+            note.markDirty();
+    }
     else if (slider == &volumeKnob)
     {
         // Update display
@@ -199,15 +307,30 @@ void ParameterPanel::sliderValueChanged(juce::Slider* slider)
 
 void ParameterPanel::sliderDragEnded(juce::Slider* slider)
 {
+    if ((slider == &scaleRetuneSlider || slider == &scaleHumanizeSlider)
+        && scalePreviewButton.getToggleState())
+    {
+        if (onScalePreview)
+            onScalePreview(getScaleSettings());
+        return;
+    }
+
+    if (slider == &vibratoScaleSlider && project)
+    {
+        if (onVibratoScaleChanged)
+            onVibratoScaleChanged(static_cast<float>(slider->getValue() / 100.0));
+        return;
+    }
+
     if (slider == &pitchOffsetSlider && selectedNote)
     {
         // Trigger incremental synthesis when slider drag ends
         if (onParameterEditFinished)
             onParameterEditFinished();
     }
-    else if (slider == &globalPitchSlider && project)
+    else if ((slider == &globalPitchSlider || slider == &formantShiftSlider) && project)
     {
-        // Global pitch changed, need full resynthesis
+        // Global pitch or formant changed, need full resynthesis
         if (onParameterEditFinished)
             onParameterEditFinished();
     }
@@ -215,13 +338,54 @@ void ParameterPanel::sliderDragEnded(juce::Slider* slider)
 
 void ParameterPanel::buttonClicked(juce::Button* button)
 {
-    juce::ignoreUnused(button);
+    if (button == &scalePreviewButton)
+    {
+        if (scalePreviewButton.getToggleState())
+        {
+            if (onScalePreview)
+                onScalePreview(getScaleSettings());
+        }
+        else if (onScalePreviewCancelled)
+        {
+            onScalePreviewCancelled();
+        }
+    }
+    else if (button == &scaleApplyButton)
+    {
+        scalePreviewButton.setToggleState(false, juce::dontSendNotification);
+        if (onScaleApply)
+            onScaleApply(getScaleSettings());
+    }
+}
+
+void ParameterPanel::comboBoxChanged(juce::ComboBox* comboBox)
+{
+    juce::ignoreUnused(comboBox);
+    if (scalePreviewButton.getToggleState() && onScalePreview)
+        onScalePreview(getScaleSettings());
+}
+
+ScaleCorrection::Settings ParameterPanel::getScaleSettings() const
+{
+    ScaleCorrection::Settings settings;
+    settings.key = std::max(0, scaleKeyCombo.getSelectedId() - 1);
+    settings.mode = static_cast<ScaleCorrection::Mode>(std::max(0, scaleModeCombo.getSelectedId() - 1));
+    settings.retuneMs = static_cast<float>(scaleRetuneSlider.getValue());
+    settings.humanize = static_cast<float>(scaleHumanizeSlider.getValue() / 100.0);
+    return settings;
+}
+
+void ParameterPanel::endScalePreview()
+{
+    scalePreviewButton.setToggleState(false, juce::dontSendNotification);
 }
 
 void ParameterPanel::setProject(Project* proj)
 {
     project = proj;
+    pitchStatistics.setProject(proj);
     updateGlobalSliders();
+    updateFromNote();
 }
 
 void ParameterPanel::setSelectedNote(Note* note)
@@ -233,28 +397,62 @@ void ParameterPanel::setSelectedNote(Note* note)
 void ParameterPanel::updateFromNote()
 {
     isUpdating = true;
+    static const char* noteNames[] = { "C", "C#", "D", "D#", "E", "F",
+                                       "F#", "G", "G#", "A", "A#", "B" };
+
+    // Only the frames edited since the last call are counted again
+    pitchStatistics.update();
+    juce::String scaleTitle = TR("param.scale");
+    if (project && pitchStatistics.getNumVoicedFrames() > 0)
+    {
+        const auto& estimate = pitchStatistics.getKeyEstimate();
+        scaleTitle << " (" << noteNames[estimate.key]
+                   << (estimate.mode == ScaleCorrection::Mode::NaturalMinor ? "m" : "") << ")";
+    }
+    scaleSectionLabel.setText(scaleTitle, juce::dontSendNotification);
 
     if (selectedNote)
     {
         float midi = selectedNote->getAdjustedMidiNote();
         int octave = static_cast<int>(midi / 12) - 1;
         int noteIndex = static_cast<int>(midi) % 12;
-        static const char* noteNames[] = { "C", "C#", "D", "D#", "E", "F",
-                                           "F#", "G", "G#", "A", "A#", "B" };
 
         juce::String noteInfo = juce::String(noteNames[noteIndex]) +
                                 juce::String(octave) +
                                 " (" + juce::String(midi, 1) + ")";
+        // How far the sung pitch sits from the note, and how much it wanders
+        if (project)
+        {
+            const auto stats = pitchStatistics.getNoteStats(project->getNoteId(*selectedNote));
+            if (stats.frames > 0)
+            {
+                const int mean = juce::roundToInt(stats.meanCents);
+                noteInfo << "  " << (mean > 0 ? "+" : "") << mean << " ct, sd "
+                         << juce::roundToInt(std::sqrt(stats.varianceCents)) << " ct";
+            }
+        }
         noteInfoLabel.setText(noteInfo, juce::dontSendNotification);
 
         pitchOffsetSlider.setValue(selectedNote->getPitchOffset());
         pitchOffsetSlider.setEnabled(true);
+
+        constexpr double msPerFrame = 1000.0 * HOP_SIZE / SAMPLE_RATE;
+        noteGainSlider.setValue(selectedNote->getGainDb());
+        fadeInSlider.setValue(selectedNote->getFadeInFrames() * msPerFrame);
+        fadeOutSlider.setValue(selectedNote->getFadeOutFrames() * msPerFrame);
+        for (auto* slider : { &noteGainSlider, &fadeInSlider, &fadeOutSlider })
+            slider->setEnabled(true);
     }
     else
     {
         noteInfoLabel.setText(TR("param.no_selection"), juce::dontSendNotification);
         pitchOffsetSlider.setValue(0.0);
         pitchOffsetSlider.setEnabled(false);
+        for (auto* slider : { &noteGainSlider, &fadeInSlider, &fadeOutSlider })
+        {
+            slider->setValue(0.0);
+            slider->setEnabled(false);
+        }
     }
 
     isUpdating = false;
@@ -268,11 +466,23 @@ void ParameterPanel::updateGlobalSliders()
     {
         globalPitchSlider.setValue(project->getGlobalPitchOffset());
         globalPitchSlider.setEnabled(true);
+        vibratoScaleSlider.setValue(100.0);
+        vibratoScaleSlider.setEnabled(true);
+        formantShiftSlider.setValue(project->getFormantShift());
+        formantShiftSlider.setEnabled(true);
+        scalePreviewButton.setEnabled(true);
+        scaleApplyButton.setEnabled(true);
     }
     else
     {
         globalPitchSlider.setValue(0.0);
         globalPitchSlider.setEnabled(false);
+        vibratoScaleSlider.setValue(100.0);
+        vibratoScaleSlider.setEnabled(false);
+        formantShiftSlider.setValue(0.0);
+        formantShiftSlider.setEnabled(false);
+        scalePreviewButton.setEnabled(false);
+        scaleApplyButton.setEnabled(false);
     }
 
     isUpdating = false;
@@ -4,13 +4,17 @@
 #include "../Models/Note.h"
 #include "../Models/Project.h"
 #include "../Utils/Constants.h"
+#include "../Utils/PitchStatistics.h"
+#include "../Utils/ScaleCorrection.h"
 #include "../Utils/UI/Theme.h"
+#include "StyledComponents.h"
 
 class DarkLookAndFeel;  // Forward declaration
 
 class ParameterPanel : public juce::Component,
                        public juce::Slider::Listener,
-                       public juce::Button::Listener
+                       public juce::Button::Listener,
+                       public juce::ComboBox::Listener
 {
 public:
     ParameterPanel();
@@ -22,18 +26,33 @@ public:
     void sliderValueChanged(juce::Slider* slider) override;
     void sliderDragEnded(juce::Slider* slider) override;
     void buttonClicked(juce::Button* button) override;
+    void comboBoxChanged(juce::ComboBox* comboBox) override;
 
     void setProject(Project* proj);
     void setSelectedNote(Note* note);
     void updateFromNote();
     void updateGlobalSliders();
 
-    int getPreferredHeight() const { return 500; }
+    ScaleCorrection::Settings getScaleSettings() const;
+    // Turn the preview toggle off without calling onScalePreviewCancelled
+    void endScalePreview();
+
+    int getPreferredHeight() const { return 940; }
 
     std::function<void()> onParameterChanged;
     std::function<void()> onParameterEditFinished;  // Called when slider drag ends
     std::function<void()> onGlobalPitchChanged;
+    // The selected note's gain or fades changed; applied without resynthesis
+    std::function<void()> onNoteGainChanged;
     std::function<void(float)> onVolumeChanged;  // Called with volume in dB
+    // Vibrato of the whole take as a share of the sung depth, when a drag ends
+    std::function<void(float)> onVibratoScaleChanged;
+
+    // Scale correction: previewed while the toggle is on, again whenever the
+    // settings change, and applied (previewed or not) by the apply button
+    std::function<void(const ScaleCorrection::Settings&)> onScalePreview;
+    std::function<void()> onScalePreviewCancelled;
+    std::function<void(const ScaleCorrection::Settings&)> onScaleApply;
     
 private:
     void setupSlider(juce::Slider& slider, juce::Label& label,
@@ -41,6 +60,7 @@ private:
 
     Project* project = nullptr;
     Note* selectedNote = nullptr;
+    PitchStatistics pitchStatistics;  // Accuracy of the selected note, detected key
     bool isUpdating = false;  // Prevent feedback loops
 
     // Note info
@@ -53,6 +73,16 @@ private:
     juce::Label pitchOffsetLabel { {}, "Offset (semitones):" };
     juce::Rectangle<int> pitchCardBounds;
 
+    // Note level: gain after the vocoder (see GainLane)
+    juce::Label levelSectionLabel { {}, "Note Level" };
+    juce::Slider noteGainSlider;
+    juce::Label noteGainLabel { {}, "Gain (dB):" };
+    juce::Slider fadeInSlider;
+    juce::Label fadeInLabel { {}, "Fade In (ms):" };
+    juce::Slider fadeOutSlider;
+    juce::Label fadeOutLabel { {}, "Fade Out (ms):" };
+    juce::Rectangle<int> levelCardBounds;
+
     // Volume control (using rotary knob style)
     juce::Label volumeSectionLabel { {}, "Volume" };
     juce::Slider volumeKnob;
@@ -68,7 +98,21 @@ private:
     juce::Label globalSectionLabel { {}, "Global Settings" };
     juce::Slider globalPitchSlider;
     juce::Label globalPitchLabel { {}, "Global Pitch:" };
+    juce::Slider vibratoScaleSlider;
+    juce::Label vibratoScaleLabel { {}, "Vibrato (%):" };
     juce::Rectangle<int> globalCardBounds;
-    
+
+    // Scale correction
+    juce::Label scaleSectionLabel { {}, "Scale Correction" };
+    StyledComboBox scaleKeyCombo;
+    StyledComboBox scaleModeCombo;
+    juce::Slider scaleRetuneSlider;
+    juce::Label scaleRetuneLabel { {}, "Retune Speed (ms):" };
+    juce::Slider scaleHumanizeSlider;
+    juce::Label scaleHumanizeLabel { {}, "Humanize (%):" };
+    StyledToggleButton scalePreviewButton;
+    juce::TextButton scaleApplyButton;
+    juce::Rectangle<int> scaleCardBounds;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ParameterPanel)
 };
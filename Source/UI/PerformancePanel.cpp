@@ -0,0 +1,278 @@
+#include "PerformancePanel.h"
+#include "../Utils/AppLogger.h"
+#include "../Utils/Localization.h"
+#include "../Utils/UI/Theme.h"
+#include "StyledComponents.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+using Metrics = PerformanceMetrics;
+
+const char *modelName(size_t index) {
+  switch (static_cast<Metrics::Model>(index)) {
+  case Metrics::Model::Vocoder:
+    return "Vocoder";
+  case Metrics::Model::RMVPE:
+    return "RMVPE";
+  case Metrics::Model::FCPE:
+    return "FCPE";
+  case Metrics::Model::SOME:
+    return "SOME";
+  }
+  return "";
+}
+
+juce::String formatMs(double ms) {
+  return juce::String(ms, ms < 100.0 ? 1 : 0) + " ms";
+}
+
+juce::String outcomeLabel(size_t index) {
+  switch (static_cast<Metrics::BlockOutcome>(index)) {
+  case Metrics::BlockOutcome::Rendered:
+    return TR("settings.perf_rendered");
+  case Metrics::BlockOutcome::Stopped:
+    return TR("settings.perf_stopped");
+  case Metrics::BlockOutcome::NoAudio:
+    return TR("settings.perf_no_audio");
+  case Metrics::BlockOutcome::NotReady:
+    return TR("settings.perf_not_ready");
+  case Metrics::BlockOutcome::Capturing:
+    return TR("settings.perf_capturing");
+  case Metrics::BlockOutcome::numOutcomes:
+    break;
+  }
+  return {};
+}
+
+juce::String bucketLabel(size_t index) {
+  const auto &edges = Metrics::loadBucketEdges;
+  if (index < edges.size())
+    return "<" + juce::String(edges[index] / 10) + "%";
+  return ">=" + juce::String(edges.back() / 10) + "%";
+}
+
+juce::String formatHitRate(uint64_t hits, uint64_t misses) {
+  const auto lookups = hits + misses;
+  if (lookups == 0)
+    return "-";
+  return juce::String(juce::roundToInt(100.0 * hits / lookups)) + "% " +
+         TR("settings.perf_hits") + " (" +
+         juce::String(static_cast<juce::int64>(hits)) + "/" +
+         juce::String(static_cast<juce::int64>(lookups)) + ")";
+}
+} // namespace
+
+PerformancePanel::PerformancePanel(juce::AudioDeviceManager *audioDeviceManager)
+    : deviceManager(audioDeviceManager) {
+  setInterceptsMouseClicks(false, false);
+}
+
+PerformancePanel::~PerformancePanel() { stopTimer(); }
+
+void PerformancePanel::visibilityChanged() {
+  if (isVisible()) {
+    refresh();
+    startTimer(1000);
+  } else {
+    stopTimer();
+  }
+}
+
+void PerformancePanel::timerCallback() { refresh(); }
+
+void PerformancePanel::refresh() {
+  history.push_back(Metrics::getInstance().snapshot());
+  while (history.size() > static_cast<size_t>(windowSeconds) + 1)
+    history.pop_front();
+
+  const auto &first = history.front();
+  const auto &last = history.back();
+  rows.clear();
+
+  rows.push_back({TR("settings.perf_models"), TR("settings.perf_window"),
+                  true});
+  for (size_t i = 0; i < Metrics::numModels; ++i) {
+    const auto &now = last.models[i];
+    const auto &then = first.models[i];
+    const bool isVocoder =
+        static_cast<Metrics::Model>(i) == Metrics::Model::Vocoder;
+
+    // Rates over the window when the model ran in it, else since launch
+    auto runs = now.runs - then.runs;
+    auto audio = now.audioSeconds - then.audioSeconds;
+    auto wall = now.wallSeconds - then.wallSeconds;
+    if (runs == 0) {
+      runs = now.runs;
+      audio = now.audioSeconds;
+      wall = now.wallSeconds;
+    }
+
+    juce::String value =
+        now.device.isEmpty() ? TR("settings.perf_not_loaded") : now.device;
+    if (runs == 0 || audio <= 0.0 || wall <= 0.0)
+      value << "  " << TR("settings.perf_idle");
+    else if (isVocoder)
+      value << "  " << TR("settings.perf_rtf") << " "
+            << juce::String(wall / audio, 3);
+    else
+      value << "  " << juce::String(audio / wall, 1)
+            << TR("settings.perf_speed");
+    if (runs > 0)
+      value << "  (" << juce::String(static_cast<juce::int64>(runs)) << " "
+            << TR("settings.perf_runs") << ")";
+    rows.push_back({modelName(i), value});
+  }
+
+  rows.push_back({TR("settings.perf_synthesis"), {}, true});
+  {
+    auto latencies = last.recentLatencyMs;
+    juce::String value = "-";
+    if (!latencies.empty()) {
+      double sum = 0.0;
+      for (float ms : latencies)
+        sum += ms;
+      std::sort(latencies.begin(), latencies.end());
+      const auto p95 = latencies[static_cast<size_t>(
+          std::ceil(0.95 * static_cast<double>(latencies.size())) - 1.0)];
+      value = TR("settings.perf_mean") + " " +
+              formatMs(sum / static_cast<double>(latencies.size())) +
+              "  p95 " + formatMs(p95) + "  (" +
+              juce::String(static_cast<int>(latencies.size())) + ")";
+    }
+    rows.push_back({TR("settings.perf_latency"), value});
+  }
+
+  auto queueRow = [&](const juce::String &label, Metrics::Queue queue) {
+    const auto index = static_cast<size_t>(queue);
+    int peak = 0;
+    for (const auto &snapshot : history)
+      peak = std::max(peak, snapshot.queues[index].peak);
+    rows.push_back({label, juce::String(last.queues[index].depth) + "  " +
+                               TR("settings.perf_peak") + " " +
+                               juce::String(peak)});
+  };
+  queueRow(TR("settings.perf_vocoder_queue"), Metrics::Queue::VocoderRequests);
+  queueRow(TR("settings.perf_apply_queue"), Metrics::Queue::SynthesisApply);
+
+  rows.push_back({TR("settings.perf_caches"), {}, true});
+  auto cacheRow = [&](const juce::String &label, Metrics::Cache cache) {
+    const auto index = static_cast<size_t>(cache);
+    rows.push_back(
+        {label, formatHitRate(last.caches[index].hits,
+                              last.caches[index].misses)});
+  };
+  cacheRow(TR("settings.perf_synthesis_cache"), Metrics::Cache::Synthesis);
+  cacheRow(TR("settings.perf_analysis_cache"), Metrics::Cache::Analysis);
+  {
+    // What the model wrappers' per-thread arenas hold, and whether they still
+    // allocate: a steady count means inference runs off retained memory
+    const auto &scratch = last.scratch;
+    auto bytes = [](size_t numBytes) {
+      return juce::File::descriptionOfSizeInBytes(
+          static_cast<juce::int64>(numBytes));
+    };
+    rows.push_back(
+        {TR("settings.perf_scratch"),
+         bytes(scratch.retainedBytes) + "  " + TR("settings.perf_peak") + " " +
+             bytes(scratch.highWaterBytes) + "  (" +
+             juce::String(static_cast<juce::int64>(scratch.blockAllocations)) +
+             " " + TR("settings.perf_allocations") + ")"});
+  }
+
+  rows.push_back({TR("settings.perf_audio"), {}, true});
+  auto audioRow = [&](const juce::String &label, Metrics::AudioSource source,
+                      int deviceXRuns) {
+    const auto index = static_cast<size_t>(source);
+    const auto &now = last.audio[index];
+    if (now.callbacks == 0)
+      return;
+    double peakLoad = 0.0;
+    for (const auto &snapshot : history)
+      peakLoad = std::max(peakLoad, snapshot.audio[index].peakLoad);
+    juce::String value =
+        juce::String(static_cast<juce::int64>(
+            now.overruns - first.audio[index].overruns)) +
+        " " + TR("settings.perf_overruns") + " (" +
+        juce::String(static_cast<juce::int64>(now.overruns)) + ")  " +
+        TR("settings.perf_load") + " " +
+        juce::String(juce::roundToInt(peakLoad * 100.0)) + "%";
+    if (deviceXRuns >= 0)
+      value << "  " << TR("settings.perf_xruns") << " " << deviceXRuns;
+    rows.push_back({label, value});
+
+    // Callback load against the deadline, then what the blocks played; both
+    // over the window and only the buckets that saw any
+    juce::String histogram;
+    for (size_t b = 0; b < Metrics::numLoadBuckets; ++b)
+      if (const auto count = now.loadHistogram[b] -
+                             first.audio[index].loadHistogram[b])
+        histogram << bucketLabel(b) << " "
+                  << juce::String(static_cast<juce::int64>(count)) << "  ";
+    rows.push_back({{}, histogram.isEmpty() ? "-" : histogram.trimEnd()});
+
+    juce::String outcomes;
+    for (size_t o = 0; o < Metrics::numBlockOutcomes; ++o)
+      if (const auto count =
+              now.outcomes[o] - first.audio[index].outcomes[o])
+        outcomes << outcomeLabel(o) << " "
+                 << juce::String(static_cast<juce::int64>(count)) << "  ";
+    if (outcomes.isNotEmpty())
+      rows.push_back({{}, outcomes.trimEnd()});
+  };
+  int deviceXRuns = -1;
+  if (deviceManager != nullptr)
+    if (auto *device = deviceManager->getCurrentAudioDevice())
+      deviceXRuns = device->getXRunCount();
+  audioRow(TR("settings.perf_standalone"), Metrics::AudioSource::Standalone,
+           deviceXRuns);
+  audioRow(TR("settings.perf_plugin"), Metrics::AudioSource::Plugin, -1);
+  audioRow(TR("settings.perf_ara"), Metrics::AudioSource::AraRenderer, -1);
+  if (rows.back().isHeader)
+    rows.push_back({TR("settings.perf_callbacks"), "-"});
+
+  repaint();
+}
+
+bool PerformancePanel::exportTo(const juce::File &file) const {
+  juce::Array<juce::var> snapshots;
+  for (const auto &snapshot : history)
+    snapshots.add(Metrics::toVar(snapshot));
+
+  auto *object = new juce::DynamicObject();
+  object->setProperty("session", AppLogger::getSessionId());
+  object->setProperty("snapshots", snapshots);
+  return file.replaceWithText(juce::JSON::toString(juce::var(object)));
+}
+
+void PerformancePanel::paint(juce::Graphics &g) {
+  const int rowHeight = 24;
+  const int headerHeight = 30;
+  const int labelWidth = 150;
+  auto area = getLocalBounds();
+
+  for (const auto &row : rows) {
+    if (row.isHeader) {
+      auto header = area.removeFromTop(headerHeight).withTrimmedTop(6);
+      g.setFont(AppFont::getBoldFont(15.0f));
+      g.setColour(APP_COLOR_TEXT_MUTED);
+      g.drawText(row.label, header, juce::Justification::centredLeft);
+      if (row.value.isNotEmpty()) {
+        g.setFont(AppFont::getFont(13.0f));
+        g.drawText(row.value, header, juce::Justification::centredRight);
+      }
+      g.setColour(APP_COLOR_BORDER_SUBTLE);
+      g.drawHorizontalLine(header.getBottom(), (float)header.getX(),
+                           (float)header.getRight());
+      continue;
+    }
+
+    auto line = area.removeFromTop(rowHeight);
+    g.setFont(AppFont::getFont(14.0f));
+    g.setColour(APP_COLOR_TEXT_MUTED);
+    g.drawText(row.label, line.removeFromLeft(labelWidth),
+               juce::Justification::centredLeft);
+    g.setColour(APP_COLOR_TEXT_PRIMARY);
+    g.drawFittedText(row.value, line, juce::Justification::centredLeft, 1);
+  }
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "../Audio/PerformanceMetrics.h"
+#include "../JuceHeader.h"
+#include <deque>
+#include <vector>
+
+/**
+ * Live view of PerformanceMetrics for the settings Performance tab.
+ *
+ * Samples the registry once a second while showing and reports rates over
+ * the last windowSeconds: vocoder real-time factor and analysis throughput
+ * per model, edit-to-audio latency, queue depths, cache hit rates, and for
+ * each audio callback source its overruns, a load histogram against the
+ * buffer deadline and what the blocks played. The device xrun count comes
+ * from deviceManager, when there is one (standalone only).
+ */
+class PerformancePanel : public juce::Component, private juce::Timer {
+public:
+  static constexpr int windowSeconds = 30;
+
+  explicit PerformancePanel(
+      juce::AudioDeviceManager *audioDeviceManager = nullptr);
+  ~PerformancePanel() override;
+
+  void paint(juce::Graphics &g) override;
+  void visibilityChanged() override;
+
+  /** Writes the snapshots in the window, oldest first, as JSON. */
+  bool exportTo(const juce::File &file) const;
+
+private:
+  struct Row {
+    juce::String label;
+    juce::String value;
+    bool isHeader = false;
+  };
+
+  void timerCallback() override;
+  void refresh();
+
+  juce::AudioDeviceManager *deviceManager = nullptr;
+  std::deque<PerformanceMetrics::Snapshot> history; // Oldest first
+  std::vector<Row> rows;
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PerformancePanel)
+};
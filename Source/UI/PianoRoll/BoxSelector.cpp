@@ -30,8 +30,16 @@ std::vector<Note*> BoxSelector::getNotesInRect(Project* project, CoordinateMappe
         return result;
 
     auto rect = getSelectionRect();
+    const float pixelsPerSecond = mapper->getPixelsPerSecond();
+    const int startFrame = secondsToFrames(rect.getX() / pixelsPerSecond);
+    const int endFrame = secondsToFrames(rect.getRight() / pixelsPerSecond);
 
-    for (auto& note : project->getNotes()) {
+    // A note's row spans one semitone below its pitch; slack for rounding
+    const float minMidi = mapper->yToMidi(rect.getBottom()) - 0.01f;
+    const float maxMidi = mapper->yToMidi(rect.getY()) + 1.01f;
+
+    for (auto* notePtr : project->getNotesInRect(startFrame - 1, endFrame + 2, minMidi, maxMidi)) {
+        auto& note = *notePtr;
         if (note.isRest())
             continue;
 
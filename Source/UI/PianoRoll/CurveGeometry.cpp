@@ -0,0 +1,91 @@
+#include "CurveGeometry.h"
+#include "../../Utils/Constants.h"
+#include "../../Utils/PitchConversion.h"
+#include <algorithm>
+
+void CurveGeometry::composePitch(const AudioData &audioData, int startFrame,
+                                 int endFrame, float offset) {
+  firstFrame = startFrame;
+  numPoints = std::max(0, endFrame - startFrame);
+  if (midi.size() < static_cast<size_t>(numPoints))
+    midi.resize(static_cast<size_t>(numPoints));
+  if (numPoints == 0)
+    return;
+
+  // Base pitch where it is known, the detected pitch past its end
+  const int baseEnd = std::clamp(
+      static_cast<int>(audioData.basePitch.size()), startFrame, endFrame);
+  const int numBase = baseEnd - startFrame;
+  if (numBase > 0)
+    juce::FloatVectorOperations::add(midi.data(),
+                                     audioData.basePitch.data() + startFrame,
+                                     offset, numBase);
+  if (numBase < numPoints) {
+    float *rest = midi.data() + numBase;
+    PitchConversion::freqToMidi(audioData.f0.data() + baseEnd, rest,
+                                numPoints - numBase);
+    // Unvoiced frames stay at 0 rather than taking the offset
+    for (int i = 0; i < numPoints - numBase; ++i)
+      rest[i] = rest[i] > 0.0f ? rest[i] + offset : 0.0f;
+  }
+
+  const int deltaEnd = std::clamp(
+      static_cast<int>(audioData.deltaPitch.size()), startFrame, endFrame);
+  if (deltaEnd > startFrame)
+    juce::FloatVectorOperations::add(midi.data(),
+                                     audioData.deltaPitch.data() + startFrame,
+                                     deltaEnd - startFrame);
+}
+
+void CurveGeometry::loadMidi(const float *values, int startFrame, int count) {
+  firstFrame = startFrame;
+  numPoints = std::max(0, count);
+  if (midi.size() < static_cast<size_t>(numPoints))
+    midi.resize(static_cast<size_t>(numPoints));
+  if (numPoints > 0)
+    juce::FloatVectorOperations::copy(midi.data(), values, numPoints);
+}
+
+void CurveGeometry::mapToView(float pixelsPerSecond, float pixelsPerSemitone) {
+  if (xs.size() < static_cast<size_t>(numPoints)) {
+    xs.resize(static_cast<size_t>(numPoints));
+    ys.resize(static_cast<size_t>(numPoints));
+  }
+  if (numPoints == 0)
+    return;
+
+  // CoordinateMapper::timeToX(framesToSeconds(frame)) and midiToY(note)
+  // plus half a row, as one multiply-add per point
+  const float pixelsPerFrame = pixelsPerSecond * static_cast<float>(HOP_SIZE) /
+                               static_cast<float>(SAMPLE_RATE);
+  float *x = xs.data();
+  for (int i = 0; i < numPoints; ++i)
+    x[i] = static_cast<float>(firstFrame + i) * pixelsPerFrame;
+
+  juce::FloatVectorOperations::multiply(ys.data(), midi.data(),
+                                        -pixelsPerSemitone, numPoints);
+  juce::FloatVectorOperations::add(
+      ys.data(), (static_cast<float>(MAX_MIDI_NOTE) + 0.5f) * pixelsPerSemitone,
+      numPoints);
+}
+
+void CurveGeometry::appendTo(CurvePathBuilder &builder,
+                             const std::function<void()> &onGap) const {
+  int i = 0;
+  while (i < numPoints) {
+    // One run of drawn points, then one gap
+    int runEnd = i;
+    while (runEnd < numPoints && midi[static_cast<size_t>(runEnd)] > 0.0f)
+      ++runEnd;
+    builder.addPoints(xs.data() + i, ys.data() + i, runEnd - i);
+
+    int gapEnd = runEnd;
+    while (gapEnd < numPoints && !(midi[static_cast<size_t>(gapEnd)] > 0.0f))
+      ++gapEnd;
+    if (onGap && gapEnd > runEnd && builder.hasPoints()) {
+      builder.breakPath();
+      onGap();
+    }
+    i = gapEnd;
+  }
+}
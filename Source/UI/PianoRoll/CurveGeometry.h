@@ -0,0 +1,53 @@
+#pragma once
+
+#include "../../JuceHeader.h"
+#include "../../Models/Project.h"
+#include "CurvePathBuilder.h"
+#include <functional>
+#include <vector>
+
+/**
+ * Reusable buffers for turning a run of per-frame pitch values into stroke
+ * vertices.
+ *
+ * The curve is composed and mapped to view coordinates a whole run at a
+ * time with vector operations and the batch conversions of PitchConversion,
+ * then handed to CurvePathBuilder in one call, instead of converting each
+ * frame through CoordinateMapper while building the path. The buffers only
+ * grow, so a renderer keeping one instance draws without allocating once it
+ * has seen its longest run.
+ */
+class CurveGeometry {
+public:
+  /**
+   * Load the drawn pitch of frames [startFrame, endFrame), in MIDI notes:
+   * the base pitch (or the F0 where there is none) plus offset, plus the
+   * delta pitch. The range must lie within the F0 curve.
+   */
+  void composePitch(const AudioData &audioData, int startFrame, int endFrame,
+                    float offset);
+
+  /** Load count values of a curve already in MIDI notes, from startFrame. */
+  void loadMidi(const float *midi, int startFrame, int count);
+
+  /**
+   * Map the loaded values to world coordinates: frames to x at
+   * pixelsPerSecond, notes to the centre of their row at pixelsPerSemitone.
+   */
+  void mapToView(float pixelsPerSecond, float pixelsPerSemitone);
+
+  /**
+   * Add the mapped points with a positive value to builder. With onGap,
+   * each run of non-positive values after points breaks the path and calls
+   * onGap first; without, such runs are simply left out.
+   */
+  void appendTo(CurvePathBuilder &builder,
+                const std::function<void()> &onGap = nullptr) const;
+
+private:
+  std::vector<float> midi;
+  std::vector<float> xs;
+  std::vector<float> ys;
+  int firstFrame = 0;
+  int numPoints = 0;
+};
@@ -0,0 +1,64 @@
+#include "CurvePathBuilder.h"
+
+#include <algorithm>
+#include <cmath>
+
+void CurvePathBuilder::add(float x, float y) {
+  const int col = static_cast<int>(std::floor(x));
+  if (columnOpen && col != column)
+    finish();
+
+  const Point point{x, y};
+  if (!columnOpen) {
+    first = last = top = bottom = point;
+    column = col;
+    columnOpen = true;
+    return;
+  }
+  last = point;
+  if (y < top.y)
+    top = point;
+  if (y > bottom.y)
+    bottom = point;
+}
+
+void CurvePathBuilder::addPoints(const float *x, const float *y, int count) {
+  if (count <= 0)
+    return;
+  // Up to four vertices per column, three path values each
+  const float columns = std::floor(x[count - 1]) - std::floor(x[0]) + 1.0f;
+  path.preallocateSpace(
+      12 * static_cast<int>(std::min(columns, static_cast<float>(count))));
+  for (int i = 0; i < count; ++i)
+    add(x[i], y[i]);
+}
+
+void CurvePathBuilder::breakPath() {
+  finish();
+  started = false;
+}
+
+void CurvePathBuilder::finish() {
+  if (!columnOpen)
+    return;
+  columnOpen = false;
+
+  emit(first);
+  const Point &earlier = top.x <= bottom.x ? top : bottom;
+  const Point &later = top.x <= bottom.x ? bottom : top;
+  emit(earlier);
+  emit(later);
+  emit(last);
+}
+
+void CurvePathBuilder::emit(const Point &point) {
+  if (!started) {
+    path.startNewSubPath(point.x, point.y);
+    started = true;
+  } else if (point.x == emitted.x && point.y == emitted.y) {
+    return;
+  } else {
+    path.lineTo(point.x, point.y);
+  }
+  emitted = point;
+}
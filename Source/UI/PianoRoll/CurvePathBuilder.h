@@ -0,0 +1,45 @@
+#pragma once
+
+#include "../../JuceHeader.h"
+
+/**
+ * Appends a polyline to a juce::Path with at most four vertices per pixel
+ * column: where the curve enters the column, its highest and lowest points
+ * in the order they occur, and where it leaves.
+ *
+ * Pitch curves have one point per F0 frame, so at wide zoom hundreds of
+ * frames share a column; this keeps the stroked path bounded by the view
+ * width while drawing the same envelope. Points must come in increasing x.
+ */
+class CurvePathBuilder {
+public:
+  explicit CurvePathBuilder(juce::Path &target) : path(target) {}
+  ~CurvePathBuilder() { finish(); }
+
+  void add(float x, float y);
+  // count points at once, reserving the path's space for them up front
+  void addPoints(const float *x, const float *y, int count);
+  // Flush the open column; the next point starts a new sub-path
+  void breakPath();
+  // Flush the open column
+  void finish();
+
+  bool hasPoints() const { return started || columnOpen; }
+
+private:
+  struct Point {
+    float x = 0.0f;
+    float y = 0.0f;
+  };
+
+  void emit(const Point &point);
+
+  juce::Path &path;
+  bool started = false;    // The current sub-path has a vertex
+  bool columnOpen = false; // first..last below hold unflushed points
+  int column = 0;
+  Point first, last, top, bottom;
+  Point emitted;
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(CurvePathBuilder)
+};
@@ -9,7 +9,11 @@ Note* NoteSplitter::findNoteAt(float x, float y) {
     float pixelsPerSecond = coordMapper->getPixelsPerSecond();
     float pixelsPerSemitone = coordMapper->getPixelsPerSemitone();
 
-    for (auto& note : project->getNotes()) {
+    const int frame = secondsToFrames(x / pixelsPerSecond);
+    const float midiAtY = coordMapper->yToMidi(y);
+    // Slack for rounding; the exact test is below
+    for (auto* notePtr : project->getNotesInRect(frame - 1, frame + 2, midiAtY - 0.01f, midiAtY + 1.01f)) {
+        auto& note = *notePtr;
         if (note.isRest())
             continue;
 
@@ -37,86 +41,36 @@ bool NoteSplitter::splitNoteAtFrame(Note* note, int splitFrame) {
     if (splitFrame <= startFrame + 5 || splitFrame >= endFrame - 5)
         return false;
 
-    // Store original note data for undo
-    Note originalNote = *note;
-
-    // Ensure clip waveform exists before splitting
+    // Ensure clip waveform exists before splitting; a view of the source,
+    // so both parts share its samples
     if (!note->hasClipWaveform()) {
         auto& audioData = project->getAudioData();
         if (audioData.waveform.getNumSamples() > 0) {
-            int startSample = startFrame * HOP_SIZE;
-            int endSample = endFrame * HOP_SIZE;
-            startSample = std::max(0, std::min(startSample, audioData.waveform.getNumSamples()));
-            endSample = std::max(startSample, std::min(endSample, audioData.waveform.getNumSamples()));
-            std::vector<float> clip;
-            clip.reserve(static_cast<size_t>(endSample - startSample));
-            const float* src = audioData.waveform.getReadPointer(0);
-            for (int i = startSample; i < endSample; ++i)
-                clip.push_back(src[i]);
-            note->setClipWaveform(std::move(clip));
+            note->setClipWaveform(WaveformClip(audioData.getRenderSnapshot(),
+                                               startFrame * HOP_SIZE, endFrame * HOP_SIZE));
         }
     }
 
-    // Ensure clip mel exists before splitting
-    if (!note->hasClipMel()) {
-        auto& audioData = project->getAudioData();
-        if (!audioData.melSpectrogram.empty()) {
-            int melSize = static_cast<int>(audioData.melSpectrogram.size());
-            int melStart = std::max(0, std::min(startFrame, melSize));
-            int melEnd = std::max(melStart, std::min(endFrame, melSize));
-            if (melEnd > melStart) {
-                std::vector<std::vector<float>> melClip(
-                    audioData.melSpectrogram.begin() + melStart,
-                    audioData.melSpectrogram.begin() + melEnd);
-                note->setClipMel(std::move(melClip));
-            }
-        }
-    }
+    // Undo finds the parts again by id and puts these clips back
+    const NoteId firstId = project->getNoteId(*note);
+    const auto originalClip = note->getClipWaveform();
+    const auto originalMel = note->getClipMel();
 
-    // Create the second note (right part)
-    Note secondNote;
-    secondNote.setStartFrame(splitFrame);
-    secondNote.setEndFrame(endFrame);
-    secondNote.setMidiNote(note->getMidiNote());
-    secondNote.setLyric(note->getLyric());
-    secondNote.setPitchOffset(0.0f);
-
-    // Split clip waveform if available
-    if (note->hasClipWaveform()) {
-        const auto& clip = note->getClipWaveform();
-        int splitOffset = (splitFrame - startFrame) * HOP_SIZE;
-        splitOffset = std::max(0, std::min(splitOffset, static_cast<int>(clip.size())));
-        std::vector<float> leftClip(clip.begin(), clip.begin() + splitOffset);
-        std::vector<float> rightClip(clip.begin() + splitOffset, clip.end());
-        note->setClipWaveform(std::move(leftClip));
-        secondNote.setClipWaveform(std::move(rightClip));
-    }
+    Note secondNote = note->splitOff(splitFrame);
 
-    // Split clip mel if available
-    if (note->hasClipMel()) {
-        const auto& mel = note->getClipMel();
-        int splitOffset = splitFrame - startFrame;
-        splitOffset = std::max(0, std::min(splitOffset, static_cast<int>(mel.size())));
-        std::vector<std::vector<float>> leftMel(mel.begin(), mel.begin() + splitOffset);
-        std::vector<std::vector<float>> rightMel(mel.begin() + splitOffset, mel.end());
-        note->setClipMel(std::move(leftMel));
-        secondNote.setClipMel(std::move(rightMel));
+    // Add the second note to project; the undo step restores it under this id
+    NoteId secondId = 0;
+    {
+        NoteChangeFeed::ScopedBatch batch(&project->getNoteChanges());
+        project->noteChanged(*note, startFrame, endFrame);
+        secondId = project->addNote(std::move(secondNote)); // May move *note
     }
 
-    // Modify the first note (left part)
-    note->setEndFrame(splitFrame);
-
-    // Save first note BEFORE addNote (addNote may invalidate note pointer due to vector reallocation)
-    Note firstNote = *note;
-
-    // Add the second note to project
-    project->addNote(secondNote);
-
     // Create undo action - don't pass callback to avoid lifetime issues
     // UI refresh is handled by UndoManager's onUndoRedo callback
     if (undoManager) {
         auto action = std::make_unique<NoteSplitAction>(
-            project, originalNote, firstNote, secondNote, nullptr);
+            project, firstId, secondId, splitFrame, endFrame, originalClip, originalMel, nullptr);
         undoManager->addAction(std::move(action));
     }
 
@@ -0,0 +1,270 @@
+#include "NoteThumbnailCache.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace {
+// Catmull-Rom spline: smooth interpolation between p1 and p2
+float catmullRom(float t, float p0, float p1, float p2, float p3) {
+  const float t2 = t * t;
+  const float t3 = t2 * t;
+  return 0.5f * ((2.0f * p1) + (-p0 + p2) * t +
+                 (2.0f * p0 - 5.0f * p1 + 4.0f * p2 - p3) * t2 +
+                 (-p0 + 3.0f * p1 - 3.0f * p2 + p3) * t3);
+}
+} // namespace
+
+NoteThumbnailCache::NoteThumbnailCache()
+    : worker([this]() { workerLoop(); }) {}
+
+NoteThumbnailCache::~NoteThumbnailCache() {
+  alive->store(false);
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopWorker = true;
+    jobs.clear();
+  }
+  wakeWorker.notify_all();
+  if (worker.joinable())
+    worker.join();
+}
+
+void NoteThumbnailCache::clear() {
+  thumbnails.clear();
+  requested.clear();
+  ++generation;
+  std::lock_guard<std::mutex> lock(mutex);
+  jobs.clear();
+}
+
+bool NoteThumbnailCache::makeJob(const WaveformClip &clip,
+                                 const juce::Rectangle<float> &bounds,
+                                 juce::Colour colour, float scale,
+                                 Job &job) const {
+  if (clip.empty() || bounds.getWidth() < 1.0f || bounds.getHeight() < 1.0f)
+    return false;
+
+  const int bucket = static_cast<int>(
+      std::lround(std::log2(bounds.getWidth()) * bucketsPerOctave));
+  const int width = static_cast<int>(
+      std::ceil(std::exp2(static_cast<double>(bucket) / bucketsPerOctave)));
+  const int height = std::max(1, juce::roundToInt(bounds.getHeight()));
+  if (static_cast<float>(width + 2 * padding) * scale > maxImageWidth)
+    return false;
+
+  const Key key{clip.getOwnedStorage(), clip.getOffset(), clip.size(),
+                bucket,                 height,           colour.getARGB(),
+                juce::roundToInt(scale * 100.0f)};
+  job = {key, clip, generation, width, height, scale, colour};
+  return true;
+}
+
+bool NoteThumbnailCache::draw(juce::Graphics &g, const WaveformClip &clip,
+                              const juce::Rectangle<float> &bounds,
+                              juce::Colour colour) {
+  lastScale = g.getInternalContext().getPhysicalPixelScaleFactor();
+  Job job;
+  if (!makeJob(clip, bounds, colour, lastScale, job))
+    return false;
+
+  auto it = thumbnails.find(job.key);
+  const bool current =
+      it != thumbnails.end() && it->second.clip.sharesSamplesWith(clip);
+  if (!current && requested.insert(job.key).second) {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      jobs.push_back(job);
+      while (jobs.size() > maxQueued) {
+        requested.erase(jobs.front().key);
+        jobs.pop_front();
+      }
+    }
+    wakeWorker.notify_one();
+  }
+  if (it == thumbnails.end())
+    return false;
+
+  // Scaled from the bucket to the exact size; a stale image stands in for
+  // its replacement
+  it->second.lastDrawn = ++drawCounter;
+  const float scale = job.scale;
+  const float scaleX = bounds.getWidth() / static_cast<float>(job.width);
+  const float scaleY = bounds.getHeight() / static_cast<float>(job.height);
+  g.drawImageTransformed(
+      it->second.image,
+      juce::AffineTransform::scale(scaleX / scale, scaleY / scale)
+          .translated(bounds.getX() - padding * scaleX,
+                      bounds.getCentreY() - 2.0f * bounds.getHeight()),
+      false);
+  return true;
+}
+
+void NoteThumbnailCache::prefetch(const WaveformClip &clip,
+                                  const juce::Rectangle<float> &bounds,
+                                  juce::Colour colour) {
+  Job job;
+  if (!makeJob(clip, bounds, colour, lastScale, job))
+    return;
+  auto it = thumbnails.find(job.key);
+  if ((it != thumbnails.end() && it->second.clip.sharesSamplesWith(clip)) ||
+      !requested.insert(job.key).second)
+    return;
+
+  // The worker takes the newest first, so these wait for the visible notes
+  // and are the first dropped when the queue is full
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    jobs.push_front(job);
+    while (jobs.size() > maxQueued) {
+      requested.erase(jobs.front().key);
+      jobs.pop_front();
+    }
+  }
+  wakeWorker.notify_one();
+}
+
+void NoteThumbnailCache::drawWaveform(juce::Graphics &g,
+                                      const WaveformClip &clip,
+                                      const juce::Rectangle<float> &bounds,
+                                      juce::Colour colour) {
+  const float x = bounds.getX();
+  const float y = bounds.getY();
+  const float w = bounds.getWidth();
+  const float h = bounds.getHeight();
+  const int numNoteSamples = clip.size();
+  if (numNoteSamples <= 0 || w <= 0.0f)
+    return;
+
+  const int samplesPerPixel = std::max(1, static_cast<int>(numNoteSamples / w));
+  const float centerY = y + h * 0.5f;
+  const float halfHeight = h * 1.5f;
+
+  // Up to about a thousand peaks for smooth curves
+  const auto samples = clip.toVector();
+  std::vector<float> waveValues;
+  const float step = std::max(0.5f, w / 1024.0f);
+  for (float px = 0; px <= w; px += step) {
+    const int sampleIdx = static_cast<int>((px / w) * numNoteSamples);
+    const int sampleEnd = std::min(sampleIdx + samplesPerPixel, numNoteSamples);
+    float maxVal = 0.0f;
+    for (int i = sampleIdx; i < sampleEnd; ++i)
+      maxVal = std::max(maxVal, std::abs(samples[static_cast<size_t>(i)]));
+    waveValues.push_back(maxVal);
+  }
+
+  // 3-point smoothing against aliasing
+  if (waveValues.size() > 2) {
+    std::vector<float> smoothed(waveValues.size());
+    smoothed[0] = waveValues[0];
+    for (size_t i = 1; i + 1 < waveValues.size(); ++i)
+      smoothed[i] = (waveValues[i - 1] * 0.25f + waveValues[i] * 0.5f +
+                     waveValues[i + 1] * 0.25f);
+    smoothed[waveValues.size() - 1] = waveValues[waveValues.size() - 1];
+    waveValues = std::move(smoothed);
+  }
+
+  const size_t numPoints = waveValues.size();
+  if (numPoints < 2) {
+    g.setColour(colour.withAlpha(0.85f));
+    g.fillRoundedRectangle(x, y, std::max(w, 4.0f), h, 2.0f);
+    return;
+  }
+
+  // Top half of the envelope, 4 spline points between each pair of peaks;
+  // the bottom half mirrors it
+  constexpr int curveSegments = 4;
+  std::vector<juce::Point<float>> envelope;
+  envelope.reserve((numPoints - 1) * curveSegments + 1);
+  envelope.push_back({x, waveValues[0] * halfHeight});
+  for (size_t i = 0; i + 1 < numPoints; ++i) {
+    const float px1 =
+        (static_cast<float>(i) / static_cast<float>(numPoints - 1)) * w;
+    const float px2 =
+        (static_cast<float>(i + 1) / static_cast<float>(numPoints - 1)) * w;
+    const float val0 = waveValues[i > 0 ? i - 1 : i];
+    const float val1 = waveValues[i];
+    const float val2 = waveValues[i + 1];
+    const float val3 = waveValues[i + 2 < numPoints ? i + 2 : i + 1];
+    for (int seg = 1; seg <= curveSegments; ++seg) {
+      const float t = static_cast<float>(seg) / curveSegments;
+      envelope.push_back({x + px1 + (px2 - px1) * t,
+                          catmullRom(t, val0, val1, val2, val3) * halfHeight});
+    }
+  }
+
+  juce::Path body;
+  body.startNewSubPath(envelope.front().x, centerY - envelope.front().y);
+  for (size_t i = 1; i < envelope.size(); ++i)
+    body.lineTo(envelope[i].x, centerY - envelope[i].y);
+  for (auto point = envelope.rbegin(); point != envelope.rend(); ++point)
+    body.lineTo(point->x, centerY + point->y);
+  body.closeSubPath();
+
+  g.setColour(colour.withAlpha(0.85f));
+  g.fillPath(body);
+  g.setColour(colour.brighter(0.2f));
+  g.strokePath(body, juce::PathStrokeType(1.2f, juce::PathStrokeType::curved,
+                                          juce::PathStrokeType::rounded));
+}
+
+juce::Image NoteThumbnailCache::renderThumbnail(const Job &job) {
+  // Software image: rendered off the message thread. The wave reaches 1.5
+  // note heights from the centre, so the image is 4 heights tall
+  juce::Image image(
+      juce::Image::ARGB,
+      std::max(1, juce::roundToInt((job.width + 2 * padding) * job.scale)),
+      std::max(1, juce::roundToInt(job.height * 4 * job.scale)), true,
+      juce::SoftwareImageType());
+  juce::Graphics g(image);
+  g.addTransform(juce::AffineTransform::scale(job.scale));
+  drawWaveform(g, job.clip,
+               {static_cast<float>(padding), job.height * 1.5f,
+                static_cast<float>(job.width), static_cast<float>(job.height)},
+               job.colour);
+  return image;
+}
+
+void NoteThumbnailCache::workerLoop() {
+  std::unique_lock<std::mutex> lock(mutex);
+  while (!stopWorker) {
+    if (jobs.empty()) {
+      wakeWorker.wait(lock);
+      continue;
+    }
+
+    // Newest first: the notes of the latest paint
+    Job job = std::move(jobs.back());
+    jobs.pop_back();
+    lock.unlock();
+
+    auto image = renderThumbnail(job);
+    juce::MessageManager::callAsync(
+        [this, token = alive, job = std::move(job),
+         image = std::move(image)]() {
+          if (!token->load() || job.generation != generation)
+            return;
+          requested.erase(job.key);
+          auto &thumbnail = thumbnails[job.key];
+          thumbnail.clip = job.clip;
+          thumbnail.image = image;
+          thumbnail.lastDrawn = drawCounter;
+          evictIfNeeded();
+          if (onThumbnailReady)
+            onThumbnailReady();
+        });
+
+    lock.lock();
+  }
+}
+
+void NoteThumbnailCache::evictIfNeeded() {
+  while (thumbnails.size() > maxThumbnails) {
+    auto oldest = std::min_element(
+        thumbnails.begin(), thumbnails.end(),
+        [](const auto &a, const auto &b) {
+          return a.second.lastDrawn < b.second.lastDrawn;
+        });
+    thumbnails.erase(oldest);
+  }
+}
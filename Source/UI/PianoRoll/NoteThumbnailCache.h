@@ -0,0 +1,113 @@
+#pragma once
+
+#include "../../JuceHeader.h"
+#include "../../Models/NoteClip.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <tuple>
+
+/**
+ * Waveform bodies of the piano roll's notes, as one image per note.
+ *
+ * Thumbnails are keyed by the note's sample range, a width bucket, the note
+ * height and colour, and rendered on a worker thread, so painting a note
+ * blits its image scaled to the exact width. Each keeps the WaveformClip it
+ * was drawn from: resynthesis or a stretch gives the note different samples,
+ * which the clip comparison catches, and the stale image keeps showing until
+ * its replacement is ready. Notes without any image yet are drawn directly.
+ *
+ * Message thread only, apart from the worker.
+ */
+class NoteThumbnailCache {
+public:
+  NoteThumbnailCache();
+  ~NoteThumbnailCache();
+
+  // Called on the message thread when a requested thumbnail has been rendered
+  std::function<void()> onThumbnailReady;
+
+  void clear();
+
+  // Draw clip as the body of a note occupying bounds; false when no image
+  // exists for it yet (one is queued) or the note is too wide to cache
+  bool draw(juce::Graphics &g, const WaveformClip &clip,
+            const juce::Rectangle<float> &bounds, juce::Colour colour);
+
+  // Queue clip's image for a note a scroll or zoom is about to show at
+  // bounds, behind the visible notes' and at the last draw()'s scale
+  void prefetch(const WaveformClip &clip, const juce::Rectangle<float> &bounds,
+                juce::Colour colour);
+
+  // The note body itself: clip's peaks as a smoothed, mirrored envelope
+  // extending 1.5 note heights either side of the centre line
+  static void drawWaveform(juce::Graphics &g, const WaveformClip &clip,
+                           const juce::Rectangle<float> &bounds,
+                           juce::Colour colour);
+
+private:
+  // At most this many thumbnails are kept, least recently drawn dropped first
+  static constexpr size_t maxThumbnails = 160;
+  // Queued jobs beyond this drop the oldest requests
+  static constexpr size_t maxQueued = 64;
+  // Bucket widths are 2^(k / bucketsPerOctave) pixels
+  static constexpr int bucketsPerOctave = 8;
+  // Wider images, in physical pixels, are not worth caching
+  static constexpr int maxImageWidth = 2048;
+  // Logical pixels either side for the outline stroke
+  static constexpr int padding = 2;
+
+  // Owned storage (null for views), offset, length, width bucket, height,
+  // colour, physical scale in hundredths
+  using Key = std::tuple<const void *, int, int, int, int, uint32_t, int>;
+
+  struct Thumbnail {
+    WaveformClip clip; // What image shows; held so storage is not reused
+    juce::Image image;
+    uint64_t lastDrawn = 0;
+  };
+
+  struct Job {
+    Key key;
+    WaveformClip clip;
+    uint64_t generation = 0;
+    int width = 0;  // Logical bucket width
+    int height = 0; // Logical note height
+    float scale = 1.0f;
+    juce::Colour colour;
+  };
+
+  // The job that renders clip at bounds; false when it is too small or
+  // too wide to cache
+  bool makeJob(const WaveformClip &clip, const juce::Rectangle<float> &bounds,
+               juce::Colour colour, float scale, Job &job) const;
+  static juce::Image renderThumbnail(const Job &job);
+
+  void workerLoop();
+  void evictIfNeeded();
+
+  std::map<Key, Thumbnail> thumbnails;
+  std::set<Key> requested; // Queued or being rendered
+  uint64_t generation = 1; // Bumped by clear() to drop late deliveries
+  uint64_t drawCounter = 0;
+  float lastScale = 1.0f; // Physical pixel scale of the last draw()
+
+  // Guarded by mutex: newest request at the back, prefetches at the front
+  std::deque<Job> jobs;
+  std::mutex mutex;
+  std::condition_variable wakeWorker;
+  bool stopWorker = false;
+  // Cleared on destruction so finished thumbnails are not delivered after it
+  std::shared_ptr<std::atomic<bool>> alive =
+      std::make_shared<std::atomic<bool>>(true);
+  std::thread worker; // Last: starts in the constructor
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(NoteThumbnailCache)
+};
@@ -1,6 +1,7 @@
 #include "OverviewPanel.h"
 #include <algorithm>
 #include <cmath>
+#include <cstring>
 
 namespace {
 juce::Colour getPitchColour(float midi) {
@@ -16,8 +17,50 @@ float f0ToMidi(float f0) {
     return 0.0f;
   return 69.0f + 12.0f * std::log2(f0 / 440.0f);
 }
+
+// FNV-1a, eight bytes at a time
+struct Fingerprint {
+  uint64_t value = 14695981039346656037ull;
+
+  void addBytes(const void *data, size_t numBytes) {
+    const auto *bytes = static_cast<const uint8_t *>(data);
+    size_t i = 0;
+    for (; i + sizeof(uint64_t) <= numBytes; i += sizeof(uint64_t)) {
+      uint64_t word;
+      std::memcpy(&word, bytes + i, sizeof(word));
+      mix(word);
+    }
+    for (; i < numBytes; ++i)
+      mix(bytes[i]);
+  }
+  template <typename T> void add(const T &v) { addBytes(&v, sizeof(v)); }
+  template <typename T> void addArray(const T *data, size_t count) {
+    add(count);
+    addBytes(data, count * sizeof(T));
+  }
+
+private:
+  void mix(uint64_t word) { value = (value ^ word) * 1099511628211ull; }
+};
 } // namespace
 
+OverviewPanel::OverviewPanel() : worker([this]() { workerLoop(); }) {
+  peaks->addChangeListener(this);
+}
+
+OverviewPanel::~OverviewPanel() {
+  peaks->removeChangeListener(this);
+  alive->store(false);
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopWorker = true;
+    pendingJob.reset();
+  }
+  wakeWorker.notify_all();
+  if (worker.joinable())
+    worker.join();
+}
+
 void OverviewPanel::paint(juce::Graphics &g) {
   auto content = getContentBounds();
   const float cornerRadius = 6.0f;
@@ -34,179 +77,33 @@ void OverviewPanel::paint(juce::Graphics &g) {
     return;
 
   const auto &audioData = project->getAudioData();
-  const int numSamples = audioData.waveform.getNumSamples();
-  if (numSamples <= 0 || audioData.sampleRate <= 0)
+  if (audioData.waveform.getNumSamples() <= 0 || audioData.sampleRate <= 0)
     return;
 
-  const float *samples = audioData.waveform.getReadPointer(0);
   const int width = static_cast<int>(content.getWidth());
   const int height = static_cast<int>(content.getHeight());
 
   if (width <= 0 || height <= 0)
     return;
 
-  const double totalTime = static_cast<double>(numSamples) / audioData.sampleRate;
-
-  const float centerY = content.getY() + content.getHeight() * 0.5f;
-  const float amplitude = content.getHeight() * 0.58f;
-
-  g.setColour(APP_COLOR_WAVEFORM.brighter(0.2f).withAlpha(0.9f));
-  for (int px = 0; px < width; ++px) {
-    const double t0 = static_cast<double>(px) / width;
-    const double t1 = static_cast<double>(px + 1) / width;
-    int startSample = static_cast<int>(t0 * numSamples);
-    int endSample = static_cast<int>(t1 * numSamples);
-
-    startSample = juce::jlimit(0, numSamples - 1, startSample);
-    endSample = juce::jlimit(startSample + 1, numSamples, endSample);
-
-    float maxVal = 0.0f;
-    for (int i = startSample; i < endSample; ++i) {
-      maxVal = std::max(maxVal, std::abs(samples[i]));
+  const float scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+  const uint64_t fingerprint = fingerprintContent(width, height, scale);
+  if (fingerprint != requestedFingerprint) {
+    requestedFingerprint = fingerprint;
+    auto job = std::make_unique<ContentJob>(
+        makeContentJob(fingerprint, width, height, scale));
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      pendingJob = std::move(job);
     }
-    maxVal = std::sqrt(maxVal);
-
-    float x = content.getX() + static_cast<float>(px);
-    float y1 = centerY - maxVal * amplitude;
-    float y2 = centerY + maxVal * amplitude;
-    g.drawLine(x, y1, x, y2);
+    wakeWorker.notify_one();
   }
 
-  if (totalTime > 0.0) {
-    const float pitchRange =
-        static_cast<float>(MAX_MIDI_NOTE - MIN_MIDI_NOTE + 1);
-    if (pitchRange > 0.0f) {
-      const float noteHeight =
-          juce::jlimit(1.0f, 4.0f, content.getHeight() / pitchRange);
-      const float thickness =
-          juce::jlimit(1.0f, 3.0f, noteHeight);
-
-      for (const auto &note : project->getNotes()) {
-        if (note.isRest())
-          continue;
-
-        const double startTime =
-            static_cast<double>(note.getStartFrame()) * HOP_SIZE / SAMPLE_RATE;
-        const double endTime =
-            static_cast<double>(note.getEndFrame()) * HOP_SIZE / SAMPLE_RATE;
-
-        if (endTime <= startTime)
-          continue;
-
-        float midi = note.getAdjustedMidiNote();
-        if (midi < MIN_MIDI_NOTE - 1 || midi > MAX_MIDI_NOTE + 1)
-          continue;
-
-        const auto baseColour =
-            note.isSelected() ? APP_COLOR_NOTE_SELECTED : getPitchColour(midi);
-        g.setColour(baseColour.withAlpha(0.18f));
-
-        const auto &delta = note.getDeltaPitch();
-        if (delta.size() > 1) {
-          juce::Path path;
-          const double duration = endTime - startTime;
-          for (size_t i = 0; i < delta.size(); ++i) {
-            const float t =
-                static_cast<float>(i) /
-                static_cast<float>(std::max<size_t>(1, delta.size() - 1));
-            const double time = startTime + duration * t;
-            const float x = content.getX() +
-                            static_cast<float>((time / totalTime) *
-                                               content.getWidth());
-            const float pitch = midi + delta[i];
-            const float y = content.getY() +
-                            (MAX_MIDI_NOTE - pitch) / pitchRange *
-                                content.getHeight();
-            if (i == 0)
-              path.startNewSubPath(x, y);
-            else
-              path.lineTo(x, y);
-          }
-          g.strokePath(path,
-                       juce::PathStrokeType(thickness * 2.6f,
-                                            juce::PathStrokeType::curved,
-                                            juce::PathStrokeType::rounded));
-          g.setColour(baseColour.withAlpha(0.75f));
-          g.strokePath(path,
-                       juce::PathStrokeType(thickness,
-                                            juce::PathStrokeType::curved,
-                                            juce::PathStrokeType::rounded));
-        } else {
-          const float x1 = content.getX() +
-                           static_cast<float>((startTime / totalTime) *
-                                              content.getWidth());
-          const float x2 = content.getX() +
-                           static_cast<float>((endTime / totalTime) *
-                                              content.getWidth());
-          const float y = content.getY() +
-                          (MAX_MIDI_NOTE - midi) / pitchRange *
-                              content.getHeight();
-          g.setColour(baseColour.withAlpha(0.18f));
-          g.drawLine(x1, y, x2, y, thickness * 2.6f);
-          g.setColour(baseColour.withAlpha(0.75f));
-          g.drawLine(x1, y, x2, y, thickness);
-        }
-      }
-
-      const auto &f0 = audioData.f0;
-      if (!f0.empty()) {
-        const auto &voiced = audioData.voicedMask;
-        const int widthPx = static_cast<int>(content.getWidth());
-        juce::Path f0Path;
-        bool hasSegment = false;
-
-        for (int px = 0; px < widthPx; ++px) {
-          const double t0 = (static_cast<double>(px) / widthPx) * totalTime;
-          const double t1 =
-              (static_cast<double>(px + 1) / widthPx) * totalTime;
-          const int startFrame =
-              juce::jlimit(0, static_cast<int>(f0.size()) - 1,
-                           static_cast<int>(t0 * SAMPLE_RATE / HOP_SIZE));
-          const int endFrame =
-              juce::jlimit(startFrame + 1, static_cast<int>(f0.size()),
-                           static_cast<int>(t1 * SAMPLE_RATE / HOP_SIZE));
-
-          float midi = 0.0f;
-          bool found = false;
-          for (int i = startFrame; i < endFrame; ++i) {
-            if (i < 0 || i >= static_cast<int>(f0.size()))
-              continue;
-            if (!voiced.empty() &&
-                (i >= static_cast<int>(voiced.size()) || !voiced[i]))
-              continue;
-            if (f0[static_cast<size_t>(i)] <= 0.0f)
-              continue;
-            midi = f0ToMidi(f0[static_cast<size_t>(i)]);
-            found = true;
-            break;
-          }
-
-          if (!found) {
-            hasSegment = false;
-            continue;
-          }
-
-          const float x = content.getX() + static_cast<float>(px);
-          const float y = content.getY() +
-                          (MAX_MIDI_NOTE - midi) / pitchRange *
-                              content.getHeight();
-          if (!hasSegment) {
-            f0Path.startNewSubPath(x, y);
-            hasSegment = true;
-          } else {
-            f0Path.lineTo(x, y);
-          }
-        }
-
-        g.setColour(APP_COLOR_PITCH_CURVE.withAlpha(0.2f));
-        g.strokePath(
-            f0Path,
-            juce::PathStrokeType(thickness * 1.4f,
-                                 juce::PathStrokeType::curved,
-                                 juce::PathStrokeType::rounded));
-      }
-    }
-  }
+  if (contentImage.isValid())
+    g.drawImage(contentImage,
+                content.withSize(static_cast<float>(width),
+                                 static_cast<float>(height)),
+                juce::RectanglePlacement::stretchToFit);
 
   auto viewport = computeViewport();
   if (!viewport.valid)
@@ -371,6 +268,275 @@ void OverviewPanel::mouseExit(const juce::MouseEvent &) {
   updateCursor(DragMode::None);
 }
 
+uint64_t OverviewPanel::fingerprintContent(int width, int height,
+                                           float scale) const {
+  const auto &audioData = project->getAudioData();
+  Fingerprint hash;
+  hash.add(width);
+  hash.add(height);
+  hash.add(scale);
+  hash.add(audioData.getRenderSnapshot().get());
+  hash.add(peaks->get(audioData.getRenderSnapshot()).get());
+  hash.add(audioData.sampleRate);
+  hash.addArray(audioData.f0.data(), audioData.f0.size());
+  hash.addArray(audioData.voicedMask.getWords(),
+                audioData.voicedMask.getNumWords());
+  for (const auto &note : project->getNotes()) {
+    if (note.isRest())
+      continue;
+    hash.add(note.getStartFrame());
+    hash.add(note.getEndFrame());
+    hash.add(note.getAdjustedMidiNote());
+    hash.add(note.isSelected());
+    const auto &delta = note.getDeltaPitch();
+    hash.addArray(delta.data(), delta.size());
+  }
+  // 0 means nothing requested
+  return std::max<uint64_t>(1, hash.value);
+}
+
+OverviewPanel::ContentJob
+OverviewPanel::makeContentJob(uint64_t fingerprint, int width, int height,
+                              float scale) const {
+  const auto &audioData = project->getAudioData();
+  ContentJob job;
+  job.fingerprint = fingerprint;
+  job.width = width;
+  job.height = height;
+  job.scale = scale;
+  job.totalTime = static_cast<double>(audioData.waveform.getNumSamples()) /
+                  audioData.sampleRate;
+  job.snapshot = audioData.getRenderSnapshot();
+  job.pyramid = peaks->get(job.snapshot);
+
+  for (const auto &note : project->getNotes()) {
+    if (note.isRest())
+      continue;
+    MinimapNote summary;
+    summary.startTime =
+        static_cast<double>(note.getStartFrame()) * HOP_SIZE / SAMPLE_RATE;
+    summary.endTime =
+        static_cast<double>(note.getEndFrame()) * HOP_SIZE / SAMPLE_RATE;
+    summary.midi = note.getAdjustedMidiNote();
+    summary.selected = note.isSelected();
+    summary.deltaPitch = note.getDeltaPitch();
+    job.notes.push_back(std::move(summary));
+  }
+
+  // First voiced frame under each column
+  const auto &f0 = audioData.f0;
+  if (!f0.empty() && job.totalTime > 0.0) {
+    const auto &voiced = audioData.voicedMask;
+    job.f0Columns.assign(static_cast<size_t>(width), 0.0f);
+    for (int px = 0; px < width; ++px) {
+      const double t0 = (static_cast<double>(px) / width) * job.totalTime;
+      const double t1 = (static_cast<double>(px + 1) / width) * job.totalTime;
+      const int startFrame =
+          juce::jlimit(0, static_cast<int>(f0.size()) - 1,
+                       static_cast<int>(t0 * SAMPLE_RATE / HOP_SIZE));
+      const int endFrame =
+          juce::jlimit(startFrame + 1, static_cast<int>(f0.size()),
+                       static_cast<int>(t1 * SAMPLE_RATE / HOP_SIZE));
+
+      for (int i = startFrame; i < endFrame; ++i) {
+        if (!voiced.empty() &&
+            (i >= static_cast<int>(voiced.size()) || !voiced[i]))
+          continue;
+        if (f0[static_cast<size_t>(i)] <= 0.0f)
+          continue;
+        job.f0Columns[static_cast<size_t>(px)] =
+            f0ToMidi(f0[static_cast<size_t>(i)]);
+        break;
+      }
+    }
+  }
+  return job;
+}
+
+juce::Image OverviewPanel::renderContent(const ContentJob &job) {
+  // Software image: rendered off the message thread
+  juce::Image image(juce::Image::ARGB,
+                    std::max(1, juce::roundToInt(job.width * job.scale)),
+                    std::max(1, juce::roundToInt(job.height * job.scale)),
+                    true, juce::SoftwareImageType());
+  juce::Graphics g(image);
+  g.addTransform(juce::AffineTransform::scale(job.scale));
+
+  const juce::Rectangle<float> content(0.0f, 0.0f,
+                                       static_cast<float>(job.width),
+                                       static_cast<float>(job.height));
+  const int width = job.width;
+  const double totalTime = job.totalTime;
+  const int numSamples = job.snapshot ? job.snapshot->getNumSamples() : 0;
+
+  const float centerY = content.getY() + content.getHeight() * 0.5f;
+  const float amplitude = content.getHeight() * 0.58f;
+
+  g.setColour(APP_COLOR_WAVEFORM.brighter(0.2f).withAlpha(0.9f));
+  std::vector<PeakPyramid::Peak> columns(static_cast<size_t>(width));
+  const double samplesPerColumn = static_cast<double>(numSamples) / width;
+  if (job.pyramid) {
+    job.pyramid->getPeaks(0.0, samplesPerColumn, width, columns.data());
+  } else if (numSamples > 0 && job.snapshot->getNumChannels() > 0) {
+    // Until the first pyramid is built
+    std::vector<float> scratch;
+    for (int px = 0; px < width; ++px) {
+      const int startSample = juce::jlimit(
+          0, numSamples - 1, static_cast<int>(px * samplesPerColumn));
+      const int endSample =
+          juce::jlimit(startSample + 1, numSamples,
+                       static_cast<int>((px + 1) * samplesPerColumn));
+      scratch.resize(static_cast<size_t>(endSample - startSample));
+      job.snapshot->read(0, startSample, endSample - startSample,
+                         scratch.data());
+      auto range = juce::FloatVectorOperations::findMinAndMax(
+          scratch.data(), static_cast<int>(scratch.size()));
+      columns[static_cast<size_t>(px)] = {range.getStart(), range.getEnd(),
+                                          0.0f};
+    }
+  }
+
+  for (int px = 0; px < width; ++px) {
+    const float maxVal =
+        std::sqrt(columns[static_cast<size_t>(px)].getMagnitude());
+    float x = content.getX() + static_cast<float>(px);
+    float y1 = centerY - maxVal * amplitude;
+    float y2 = centerY + maxVal * amplitude;
+    g.drawLine(x, y1, x, y2);
+  }
+
+  if (totalTime > 0.0) {
+    const float pitchRange =
+        static_cast<float>(MAX_MIDI_NOTE - MIN_MIDI_NOTE + 1);
+    if (pitchRange > 0.0f) {
+      const float noteHeight =
+          juce::jlimit(1.0f, 4.0f, content.getHeight() / pitchRange);
+      const float thickness =
+          juce::jlimit(1.0f, 3.0f, noteHeight);
+
+      for (const auto &note : job.notes) {
+        const double startTime = note.startTime;
+        const double endTime = note.endTime;
+
+        if (endTime <= startTime)
+          continue;
+
+        float midi = note.midi;
+        if (midi < MIN_MIDI_NOTE - 1 || midi > MAX_MIDI_NOTE + 1)
+          continue;
+
+        const auto baseColour =
+            note.selected ? APP_COLOR_NOTE_SELECTED : getPitchColour(midi);
+        g.setColour(baseColour.withAlpha(0.18f));
+
+        const auto &delta = note.deltaPitch;
+        if (delta.size() > 1) {
+          juce::Path path;
+          const double duration = endTime - startTime;
+          for (size_t i = 0; i < delta.size(); ++i) {
+            const float t =
+                static_cast<float>(i) /
+                static_cast<float>(std::max<size_t>(1, delta.size() - 1));
+            const double time = startTime + duration * t;
+            const float x = content.getX() +
+                            static_cast<float>((time / totalTime) *
+                                               content.getWidth());
+            const float pitch = midi + delta[i];
+            const float y = content.getY() +
+                            (MAX_MIDI_NOTE - pitch) / pitchRange *
+                                content.getHeight();
+            if (i == 0)
+              path.startNewSubPath(x, y);
+            else
+              path.lineTo(x, y);
+          }
+          g.strokePath(path,
+                       juce::PathStrokeType(thickness * 2.6f,
+                                            juce::PathStrokeType::curved,
+                                            juce::PathStrokeType::rounded));
+          g.setColour(baseColour.withAlpha(0.75f));
+          g.strokePath(path,
+                       juce::PathStrokeType(thickness,
+                                            juce::PathStrokeType::curved,
+                                            juce::PathStrokeType::rounded));
+        } else {
+          const float x1 = content.getX() +
+                           static_cast<float>((startTime / totalTime) *
+                                              content.getWidth());
+          const float x2 = content.getX() +
+                           static_cast<float>((endTime / totalTime) *
+                                              content.getWidth());
+          const float y = content.getY() +
+                          (MAX_MIDI_NOTE - midi) / pitchRange *
+                              content.getHeight();
+          g.setColour(baseColour.withAlpha(0.18f));
+          g.drawLine(x1, y, x2, y, thickness * 2.6f);
+          g.setColour(baseColour.withAlpha(0.75f));
+          g.drawLine(x1, y, x2, y, thickness);
+        }
+      }
+
+      if (!job.f0Columns.empty()) {
+        juce::Path f0Path;
+        bool hasSegment = false;
+
+        for (int px = 0; px < width; ++px) {
+          const float midi = job.f0Columns[static_cast<size_t>(px)];
+          if (midi <= 0.0f) {
+            hasSegment = false;
+            continue;
+          }
+
+          const float x = content.getX() + static_cast<float>(px);
+          const float y = content.getY() +
+                          (MAX_MIDI_NOTE - midi) / pitchRange *
+                              content.getHeight();
+          if (!hasSegment) {
+            f0Path.startNewSubPath(x, y);
+            hasSegment = true;
+          } else {
+            f0Path.lineTo(x, y);
+          }
+        }
+
+        g.setColour(APP_COLOR_PITCH_CURVE.withAlpha(0.2f));
+        g.strokePath(
+            f0Path,
+            juce::PathStrokeType(thickness * 1.4f,
+                                 juce::PathStrokeType::curved,
+                                 juce::PathStrokeType::rounded));
+      }
+    }
+  }
+  return image;
+}
+
+void OverviewPanel::workerLoop() {
+  std::unique_lock<std::mutex> lock(mutex);
+  while (!stopWorker) {
+    if (!pendingJob) {
+      wakeWorker.wait(lock);
+      continue;
+    }
+
+    auto job = std::move(pendingJob);
+    lock.unlock();
+
+    auto image = renderContent(*job);
+    juce::MessageManager::callAsync(
+        [this, token = alive, fingerprint = job->fingerprint,
+         image = std::move(image)]() {
+          // Superseded images are dropped; the newest is on its way
+          if (!token->load() || fingerprint != requestedFingerprint)
+            return;
+          contentImage = image;
+          repaint();
+        });
+
+    lock.lock();
+  }
+}
+
 OverviewPanel::ViewportInfo OverviewPanel::computeViewport() const {
   auto state = getViewState ? getViewState() : ViewState{};
   ViewportInfo info;
@@ -3,11 +3,29 @@
 #include "../../JuceHeader.h"
 #include "../../Models/Project.h"
 #include "../../Utils/Constants.h"
+#include "../../Utils/PeakPyramid.h"
 #include "../../Utils/UI/Theme.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
 
-class OverviewPanel : public juce::Component {
+/**
+ * Whole-song minimap of the waveform, notes and pitch, with the piano roll's
+ * visible range as a draggable, resizable rectangle on top.
+ *
+ * The summary is rendered into an image on a worker thread and only redone
+ * when a fingerprint of what it shows changes, so the scroll and zoom
+ * repaints that move the rectangle just blit it. The previous image keeps
+ * showing, stretched if the panel was resized, until the new one is ready.
+ */
+class OverviewPanel : public juce::Component, private juce::ChangeListener {
 public:
-  OverviewPanel() = default;
+  OverviewPanel();
+  ~OverviewPanel() override;
   struct ViewState {
     double totalTime = 0.0;
     double scrollX = 0.0;
@@ -17,6 +35,8 @@ public:
 
   void setProject(Project *proj) {
     project = proj;
+    contentImage = {};
+    requestedFingerprint = 0;
     repaint();
   }
   void setDrawBackground(bool shouldDraw) {
@@ -48,10 +68,41 @@ private:
     juce::Rectangle<float> rect;
   };
 
+  struct MinimapNote {
+    double startTime = 0.0;
+    double endTime = 0.0;
+    float midi = 0.0f;
+    bool selected = false;
+    std::vector<float> deltaPitch;
+  };
+
+  // Everything renderContent() needs, copied off the project
+  struct ContentJob {
+    uint64_t fingerprint = 0;
+    int width = 0; // Logical content size
+    int height = 0;
+    float scale = 1.0f;
+    double totalTime = 0.0;
+    RenderSnapshot::Ptr snapshot;
+    PeakPyramid::Ptr pyramid; // Possibly of an earlier render, or null
+    std::vector<MinimapNote> notes;
+    std::vector<float> f0Columns; // MIDI per column, 0 where unvoiced
+  };
+
+  // Hash of the project data the summary shows, at this size and scale
+  uint64_t fingerprintContent(int width, int height, float scale) const;
+  ContentJob makeContentJob(uint64_t fingerprint, int width, int height,
+                            float scale) const;
+  // Worker: the summary at the job's size, origin at the content's corner
+  static juce::Image renderContent(const ContentJob &job);
+  void workerLoop();
+
   ViewportInfo computeViewport() const;
   double timeForX(float x, const juce::Rectangle<float> &content) const;
   juce::Rectangle<float> getContentBounds() const;
   void updateCursor(DragMode mode);
+  // Repaints once the pyramid of the current render is built
+  void changeListenerCallback(juce::ChangeBroadcaster *) override { repaint(); }
 
   Project *project = nullptr;
   bool drawBackground = true;
@@ -61,6 +112,21 @@ private:
   double dragStartEndTime = 0.0;
   double dragStartVisibleTime = 0.0;
 
+  juce::SharedResourcePointer<PeakPyramidService> peaks;
+
+  juce::Image contentImage;
+  uint64_t requestedFingerprint = 0; // Of the newest job; 0 for none
+
+  // Guarded by mutex: the newest request not started yet
+  std::unique_ptr<ContentJob> pendingJob;
+  std::mutex mutex;
+  std::condition_variable wakeWorker;
+  bool stopWorker = false;
+  // Cleared on destruction so a finished image is not delivered after it
+  std::shared_ptr<std::atomic<bool>> alive =
+      std::make_shared<std::atomic<bool>>(true);
+  std::thread worker; // Last: starts in the constructor
+
   static constexpr int padding = 6;
   static constexpr float handleHitWidth = 6.0f;
   static constexpr float minViewportPixels = 12.0f;
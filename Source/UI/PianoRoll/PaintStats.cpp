@@ -0,0 +1,158 @@
+#include "PaintStats.h"
+#include "../../Utils/UI/Theme.h"
+
+#include <algorithm>
+
+namespace {
+const char *const layerNames[PaintStats::numLayers] = {
+    "Waveform", "Spectrogram", "Grid", "Notes",
+    "Curves",   "Timeline",    "Keys", "Overlays"};
+
+double ticksToMs(int64_t ticks) {
+  return juce::Time::highResolutionTicksToSeconds(ticks) * 1000.0;
+}
+} // namespace
+
+const char *PaintStats::getLayerName(Layer layer) {
+  return layerNames[layer];
+}
+
+PaintStats::~PaintStats() {
+  alive->store(false);
+  stopTimer();
+}
+
+void PaintStats::setEnabled(bool shouldBeEnabled) {
+  if (shouldBeEnabled == enabled)
+    return;
+  enabled = shouldBeEnabled;
+  if (!enabled) {
+    stopTimer();
+    return;
+  }
+
+  fullPaints = overlayPaints = 0;
+  layerSumMs.fill(0.0);
+  layerMaxMs.fill(0.0);
+  layerPaints.fill(0);
+  totalSumMs = totalMaxMs = 0.0;
+  basePitchAtStart = basePitchCache;
+  waveformTilesAtStart = waveformTileCache;
+  startTimer(1000);
+}
+
+void PaintStats::beginPaint(bool fullPaint) {
+  if (!enabled)
+    return;
+  paintIsFull = fullPaint;
+  paintStart = juce::Time::getHighResolutionTicks();
+  layerTicks.fill(0);
+}
+
+void PaintStats::endPaint() {
+  if (!enabled)
+    return;
+  const double totalMs =
+      ticksToMs(juce::Time::getHighResolutionTicks() - paintStart);
+  totalSumMs += totalMs;
+  totalMaxMs = std::max(totalMaxMs, totalMs);
+  ++(paintIsFull ? fullPaints : overlayPaints);
+
+  for (int layer = 0; layer < numLayers; ++layer) {
+    if (layerTicks[layer] == 0)
+      continue;
+    const double ms = ticksToMs(layerTicks[layer]);
+    layerSumMs[layer] += ms;
+    layerMaxMs[layer] = std::max(layerMaxMs[layer], ms);
+    ++layerPaints[layer];
+  }
+}
+
+juce::String PaintStats::formatHitRate(const CacheCounters &now,
+                                       const CacheCounters &before) {
+  const uint64_t hits = now.hits - before.hits;
+  const uint64_t lookups = hits + (now.misses - before.misses);
+  if (lookups == 0)
+    return "idle";
+  return juce::String(100.0 * static_cast<double>(hits) / lookups, 1) +
+         "% of " + juce::String(static_cast<juce::int64>(lookups));
+}
+
+void PaintStats::timerCallback() {
+  const int paints = fullPaints + overlayPaints;
+  lastFullPaints = fullPaints;
+  lastOverlayPaints = overlayPaints;
+  for (int layer = 0; layer < numLayers; ++layer) {
+    lastLayers[layer].averageMs =
+        layerPaints[layer] > 0 ? layerSumMs[layer] / layerPaints[layer] : 0.0;
+    lastLayers[layer].maxMs = layerMaxMs[layer];
+  }
+  lastTotal.averageMs = paints > 0 ? totalSumMs / paints : 0.0;
+  lastTotal.maxMs = totalMaxMs;
+  lastWaveformHitRate = formatHitRate(waveformTileCache, waveformTilesAtStart);
+  lastBasePitchHitRate = formatHitRate(basePitchCache, basePitchAtStart);
+
+  fullPaints = overlayPaints = 0;
+  layerSumMs.fill(0.0);
+  layerMaxMs.fill(0.0);
+  layerPaints.fill(0);
+  totalSumMs = totalMaxMs = 0.0;
+  basePitchAtStart = basePitchCache;
+  waveformTilesAtStart = waveformTileCache;
+
+  // Queued behind whatever is pending now
+  const double posted = juce::Time::getMillisecondCounterHiRes();
+  juce::MessageManager::callAsync([this, token = alive, posted]() {
+    if (token->load())
+      queueLatencyMs = juce::Time::getMillisecondCounterHiRes() - posted;
+  });
+
+  if (onUpdated)
+    onUpdated();
+}
+
+juce::StringArray PaintStats::getReport() const {
+  auto formatMs = [](double ms) {
+    return juce::String(ms, 2).paddedLeft(' ', 8);
+  };
+
+  juce::StringArray lines;
+  lines.add("Paints/s: " + juce::String(lastFullPaints) + " full, " +
+            juce::String(lastOverlayPaints) + " overlay");
+  lines.add(juce::String("Layer").paddedRight(' ', 12) + "  avg ms  max ms");
+  for (int layer = 0; layer < numLayers; ++layer)
+    lines.add(juce::String(layerNames[layer]).paddedRight(' ', 12) +
+              formatMs(lastLayers[layer].averageMs) +
+              formatMs(lastLayers[layer].maxMs));
+  lines.add(juce::String("Total").paddedRight(' ', 12) +
+            formatMs(lastTotal.averageMs) + formatMs(lastTotal.maxMs));
+  lines.add("Waveform tiles: " + lastWaveformHitRate);
+  lines.add("Base pitch cache: " + lastBasePitchHitRate);
+  lines.add("Message queue latency: " + juce::String(queueLatencyMs, 1) +
+            " ms");
+  return lines;
+}
+
+juce::Rectangle<int>
+PaintStats::getOverlayBounds(const juce::Rectangle<int> &area) const {
+  // numLayers rows, their header and total, and four more lines
+  const int numLines = numLayers + 6;
+  return {area.getRight() - overlayWidth - margin, area.getY() + margin,
+          overlayWidth, numLines * lineHeight + 2 * margin};
+}
+
+void PaintStats::draw(juce::Graphics &g,
+                      const juce::Rectangle<int> &area) const {
+  const auto lines = getReport();
+  const auto box = getOverlayBounds(area);
+
+  g.setColour(APP_COLOR_OVERLAY_SHADOW.withAlpha(0.75f));
+  g.fillRoundedRectangle(box.toFloat(), 4.0f);
+  g.setColour(APP_COLOR_TEXT_PRIMARY);
+  g.setFont(juce::Font(juce::FontOptions(
+      juce::Font::getDefaultMonospacedFontName(), 11.0f, juce::Font::plain)));
+  auto text = box.reduced(margin);
+  for (const auto &line : lines)
+    g.drawText(line, text.removeFromTop(lineHeight),
+               juce::Justification::centredLeft, false);
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+#include "../../JuceHeader.h"
+#include "../../Utils/Tracing.h"
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+/**
+ * Paint-cost counters for the piano roll, shown as a debug overlay and
+ * written to the log for support reports.
+ *
+ * Each second it summarises the paints in it: how many rebuilt the layers
+ * and how many only moved an overlay, the average and worst time of every
+ * layer, and the hit rates of the waveform tile and base pitch caches. JUCE
+ * does not expose the message queue, so its depth is sampled as latency: how
+ * long a message posted once a second waits before it runs.
+ *
+ * Message thread only. Disabled, time() only calls its function.
+ */
+class PaintStats : private juce::Timer {
+public:
+  enum Layer {
+    Waveform,
+    Spectrogram,
+    Grid,
+    Notes,
+    Curves,
+    Timeline,
+    Keys,
+    Overlays,
+    numLayers
+  };
+
+  struct CacheCounters {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+  };
+
+  PaintStats() = default;
+  ~PaintStats() override;
+
+  // Called each second with a new summary, e.g. to repaint the overlay
+  std::function<void()> onUpdated;
+
+  static const char *getLayerName(Layer layer);
+
+  void setEnabled(bool shouldBeEnabled);
+  bool isEnabled() const { return enabled; }
+
+  void beginPaint(bool fullPaint);
+  void endPaint();
+  // Also a trace zone when tracing is built in
+  template <typename Fn> void time(Layer layer, Fn &&draw) {
+    TRACE_ZONE(getLayerName(layer));
+    if (!enabled) {
+      draw();
+      return;
+    }
+    const auto start = juce::Time::getHighResolutionTicks();
+    draw();
+    layerTicks[layer] += juce::Time::getHighResolutionTicks() - start;
+  }
+
+  // Running totals; the summary takes the change over each second
+  CacheCounters basePitchCache;
+  void setWaveformTileCounters(const CacheCounters &counters) {
+    waveformTileCache = counters;
+  }
+
+  // The last second's summary, one line per entry
+  juce::StringArray getReport() const;
+  // In the top-right corner of area, over whatever is drawn there
+  juce::Rectangle<int> getOverlayBounds(const juce::Rectangle<int> &area) const;
+  void draw(juce::Graphics &g, const juce::Rectangle<int> &area) const;
+
+private:
+  struct LayerSummary {
+    double averageMs = 0.0;
+    double maxMs = 0.0;
+  };
+
+  void timerCallback() override;
+
+  static constexpr int lineHeight = 14;
+  static constexpr int overlayWidth = 240;
+  static constexpr int margin = 8;
+
+  static juce::String formatHitRate(const CacheCounters &now,
+                                    const CacheCounters &before);
+
+  bool enabled = false;
+
+  // The paint in progress
+  bool paintIsFull = false;
+  int64_t paintStart = 0;
+  std::array<int64_t, numLayers> layerTicks{};
+
+  // The second in progress
+  int fullPaints = 0;
+  int overlayPaints = 0;
+  std::array<double, numLayers> layerSumMs{};
+  std::array<double, numLayers> layerMaxMs{};
+  std::array<int, numLayers> layerPaints{};
+  double totalSumMs = 0.0;
+  double totalMaxMs = 0.0;
+  CacheCounters waveformTileCache;
+  CacheCounters basePitchAtStart;
+  CacheCounters waveformTilesAtStart;
+
+  // The last complete second
+  int lastFullPaints = 0;
+  int lastOverlayPaints = 0;
+  std::array<LayerSummary, numLayers> lastLayers{};
+  LayerSummary lastTotal;
+  juce::String lastWaveformHitRate;
+  juce::String lastBasePitchHitRate;
+  double queueLatencyMs = 0.0;
+
+  // Cleared on destruction so a latency probe still queued is ignored
+  std::shared_ptr<std::atomic<bool>> alive =
+      std::make_shared<std::atomic<bool>>(true);
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PaintStats)
+};
@@ -1,14 +1,11 @@
 #include "PianoRollRenderer.h"
+#include "CurvePathBuilder.h"
 #include "../../Utils/UI/TimecodeFont.h"
 
 PianoRollRenderer::PianoRollRenderer() = default;
 
 void PianoRollRenderer::invalidateWaveformCache() {
-  waveformCache = juce::Image(); // Release image memory
-  cachedScrollX = -1.0;
-  cachedPixelsPerSecond = -1.0f;
-  cachedWidth = 0;
-  cachedHeight = 0;
+  waveformTiles.clear(); // Release tile memory
 }
 
 void PianoRollRenderer::invalidateBasePitchCache() {
@@ -29,92 +26,25 @@ float PianoRollRenderer::catmullRom(float t, float p0, float p1, float p2,
 
 void PianoRollRenderer::drawBackgroundWaveform(
     juce::Graphics &g, const juce::Rectangle<int> &area) {
-  if (!project || !coordMapper)
+  if (!coordMapper)
     return;
+  drawBackgroundWaveform(g, area, coordMapper->getScrollX(),
+                         coordMapper->getPixelsPerSecond());
+}
 
-  const auto &audioData = project->getAudioData();
-  if (audioData.waveform.getNumSamples() == 0)
+void PianoRollRenderer::drawBackgroundWaveform(
+    juce::Graphics &g, const juce::Rectangle<int> &area, double scrollX,
+    float pixelsPerSecond) {
+  if (!project)
     return;
 
-  double scrollX = coordMapper->getScrollX();
-  float pixelsPerSecond = coordMapper->getPixelsPerSecond();
-
-  // Check cache validity
-  bool cacheValid =
-      waveformCache.isValid() && std::abs(cachedScrollX - scrollX) < 1.0 &&
-      std::abs(cachedPixelsPerSecond - pixelsPerSecond) < 0.01f &&
-      cachedWidth == area.getWidth() && cachedHeight == area.getHeight();
-
-  if (cacheValid) {
-    g.drawImageAt(waveformCache, area.getX(), area.getY());
+  const auto &audioData = project->getAudioData();
+  if (audioData.waveform.getNumSamples() == 0)
     return;
-  }
-
-  // Render to cache
-  waveformCache =
-      juce::Image(juce::Image::ARGB, area.getWidth(), area.getHeight(), true);
-  juce::Graphics cacheGraphics(waveformCache);
 
-  const float *samples = audioData.waveform.getReadPointer(0);
-  int numSamples = audioData.waveform.getNumSamples();
-
-  float visibleHeight = static_cast<float>(area.getHeight());
-  float centerY = visibleHeight * 0.5f;
-  float waveformHeight = visibleHeight * 0.8f;
-
-  juce::Path waveformPath;
-  int visibleWidth = area.getWidth();
-
-  waveformPath.startNewSubPath(0.0f, centerY);
-
-  // Top half
-  for (int px = 0; px < visibleWidth; ++px) {
-    double time = (scrollX + px) / pixelsPerSecond;
-    int startSample = static_cast<int>(time * SAMPLE_RATE);
-    int endSample =
-        static_cast<int>((time + 1.0 / pixelsPerSecond) * SAMPLE_RATE);
-
-    startSample = std::max(0, std::min(startSample, numSamples - 1));
-    endSample = std::max(startSample + 1, std::min(endSample, numSamples));
-
-    float maxVal = 0.0f;
-    for (int i = startSample; i < endSample; ++i)
-      maxVal = std::max(maxVal, std::abs(samples[i]));
-
-    float y = centerY - maxVal * waveformHeight * 0.5f;
-    waveformPath.lineTo(static_cast<float>(px), y);
-  }
-
-  // Bottom half (reverse)
-  for (int px = visibleWidth - 1; px >= 0; --px) {
-    double time = (scrollX + px) / pixelsPerSecond;
-    int startSample = static_cast<int>(time * SAMPLE_RATE);
-    int endSample =
-        static_cast<int>((time + 1.0 / pixelsPerSecond) * SAMPLE_RATE);
-
-    startSample = std::max(0, std::min(startSample, numSamples - 1));
-    endSample = std::max(startSample + 1, std::min(endSample, numSamples));
-
-    float maxVal = 0.0f;
-    for (int i = startSample; i < endSample; ++i)
-      maxVal = std::max(maxVal, std::abs(samples[i]));
-
-    float y = centerY + maxVal * waveformHeight * 0.5f;
-    waveformPath.lineTo(static_cast<float>(px), y);
-  }
-
-  waveformPath.closeSubPath();
-
-  cacheGraphics.setColour(APP_COLOR_WAVEFORM);
-  cacheGraphics.fillPath(waveformPath);
-
-  // Update cache metadata
-  cachedScrollX = scrollX;
-  cachedPixelsPerSecond = pixelsPerSecond;
-  cachedWidth = area.getWidth();
-  cachedHeight = area.getHeight();
-
-  g.drawImageAt(waveformCache, area.getX(), area.getY());
+  // Tiles rendered from a render the new one shares samples with are kept
+  waveformTiles.setSnapshot(audioData.getRenderSnapshot());
+  waveformTiles.draw(g, area, scrollX, pixelsPerSecond, APP_COLOR_WAVEFORM);
 }
 
 void PianoRollRenderer::drawGrid(juce::Graphics &g, int width, int height) {
@@ -201,7 +131,7 @@ void PianoRollRenderer::drawTimeline(juce::Graphics &g, int width) {
   float duration = project ? project->getAudioData().getDuration() : 60.0f;
   double scrollX = coordMapper->getScrollX();
 
-  g.setFont(TimecodeFont::getBoldFont(12.0f));
+  const auto labelFont = TimecodeFont::getBoldFont(12.0f);
 
   for (float time = 0.0f; time <= duration + secondsPerTick;
        time += secondsPerTick) {
@@ -233,10 +163,12 @@ void PianoRollRenderer::drawTimeline(juce::Graphics &g, int width) {
       else
         label = juce::String::formatted("%ds", seconds);
 
-  g.setColour(APP_COLOR_TEXT_MUTED);
-      g.drawText(label, static_cast<int>(x) + 3, 2, 50,
-                 CoordinateMapper::timelineHeight - 4,
-                 juce::Justification::centredLeft, false);
+      g.setColour(APP_COLOR_TEXT_MUTED);
+      glyphs.draw(g, label, labelFont,
+                  juce::Rectangle<float>(
+                      std::floor(x) + 3.0f, 2.0f, 50.0f,
+                      static_cast<float>(CoordinateMapper::timelineHeight - 4)),
+                  juce::Justification::centredLeft);
     }
   }
 }
@@ -251,8 +183,20 @@ void PianoRollRenderer::drawNotes(juce::Graphics &g, double visibleStartTime,
                              ? audioData.waveform.getReadPointer(0)
                              : nullptr;
   int totalSamples = audioData.waveform.getNumSamples();
-
-  for (auto &note : project->getNotes()) {
+  // Only the current render's: notes show their edits as soon as rendered
+  const auto snapshot =
+      totalSamples > 0 ? audioData.getRenderSnapshot() : nullptr;
+  auto pyramid = snapshot ? peaks->get(snapshot) : nullptr;
+  if (pyramid && pyramid->getSource() != snapshot)
+    pyramid = nullptr;
+
+  // One frame of slack either side covers the inclusive time test below
+  const auto visibleNotes = project->getNotesInRange(
+      secondsToFrames(static_cast<float>(visibleStartTime)) - 1,
+      secondsToFrames(static_cast<float>(visibleEndTime)) + 2);
+
+  for (auto *notePtr : visibleNotes) {
+    auto &note = *notePtr;
     if (note.isRest())
       continue;
 
@@ -278,7 +222,7 @@ void PianoRollRenderer::drawNotes(juce::Graphics &g, double visibleStartTime,
 
     if (samples && totalSamples > 0 && w > 2.0f) {
       drawNoteWaveform(g, note, x, y, w, h, samples, totalSamples,
-                       audioData.sampleRate);
+                       audioData.sampleRate, pyramid.get());
     } else {
       g.setColour(noteColor.withAlpha(0.85f));
       g.fillRoundedRectangle(x, y, std::max(w, 4.0f), h, 2.0f);
@@ -289,7 +233,8 @@ void PianoRollRenderer::drawNotes(juce::Graphics &g, double visibleStartTime,
 void PianoRollRenderer::drawNoteWaveform(juce::Graphics &g, const Note &note,
                                          float x, float y, float w, float h,
                                          const float *samples, int totalSamples,
-                                         int sampleRate) {
+                                         int sampleRate,
+                                         const PeakPyramid *pyramid) {
   juce::Colour noteColor = note.isSelected() ? APP_COLOR_NOTE_SELECTED
                                              : APP_COLOR_NOTE_NORMAL;
 
@@ -314,8 +259,12 @@ void PianoRollRenderer::drawNoteWaveform(juce::Graphics &g, const Note &note,
     int sampleEnd = std::min(sampleIdx + samplesPerPixel, endSample);
 
     float maxVal = 0.0f;
-    for (int i = sampleIdx; i < sampleEnd; ++i)
-      maxVal = std::max(maxVal, std::abs(samples[i]));
+    if (pyramid) {
+      maxVal = pyramid->getPeak(sampleIdx, sampleEnd).getMagnitude();
+    } else {
+      for (int i = sampleIdx; i < sampleEnd; ++i)
+        maxVal = std::max(maxVal, std::abs(samples[i]));
+    }
 
     waveValues.push_back(maxVal);
   }
@@ -411,51 +360,28 @@ void PianoRollRenderer::drawPitchCurves(juce::Graphics &g,
 
   g.setColour(APP_COLOR_PITCH_CURVE);
 
+  const int numFrames = static_cast<int>(audioData.f0.size());
   for (const auto &note : project->getNotes()) {
     if (note.isRest())
       continue;
 
-    juce::Path path;
-    bool pathStarted = false;
-
-    int startFrame = note.getStartFrame();
-    int endFrame =
-        std::min(note.getEndFrame(), static_cast<int>(audioData.f0.size()));
-
-    for (int i = startFrame; i < endFrame; ++i) {
-      float baseMidi =
-          (i < static_cast<int>(audioData.basePitch.size()))
-              ? audioData.basePitch[static_cast<size_t>(i)] +
-                    note.getPitchOffset()
-              : ((i < static_cast<int>(audioData.f0.size()) &&
-                  audioData.f0[static_cast<size_t>(i)] > 0.0f)
-                     ? freqToMidi(audioData.f0[static_cast<size_t>(i)]) +
-                           note.getPitchOffset()
-                     : 0.0f);
-
-      float deltaMidi = (i < static_cast<int>(audioData.deltaPitch.size()))
-                            ? audioData.deltaPitch[static_cast<size_t>(i)]
-                            : 0.0f;
-
-      float finalMidi = baseMidi + deltaMidi + globalPitchOffset;
-
-      if (finalMidi > 0.0f) {
-        float x = framesToSeconds(i) * coordMapper->getPixelsPerSecond();
-        float y = coordMapper->midiToY(finalMidi) +
-                  coordMapper->getPixelsPerSemitone() * 0.5f;
-
-        if (!pathStarted) {
-          path.startNewSubPath(x, y);
-          pathStarted = true;
-        } else {
-          path.lineTo(x, y);
-        }
-      }
-    }
+    const int startFrame = note.getStartFrame();
+    const int endFrame = std::min(note.getEndFrame(), numFrames);
+    if (startFrame >= endFrame)
+      continue;
+
+    curveGeometry.composePitch(audioData, startFrame, endFrame,
+                               note.getPitchOffset() + globalPitchOffset);
+    curveGeometry.mapToView(coordMapper->getPixelsPerSecond(),
+                            coordMapper->getPixelsPerSemitone());
 
-    if (pathStarted) {
-      g.strokePath(path, juce::PathStrokeType(2.0f));
+    curvePath.clear();
+    {
+      CurvePathBuilder builder(curvePath);
+      curveGeometry.appendTo(builder);
     }
+    if (!curvePath.isEmpty())
+      g.strokePath(curvePath, juce::PathStrokeType(2.0f));
   }
 }
 
@@ -486,6 +412,7 @@ void PianoRollRenderer::drawPianoKeys(juce::Graphics &g, int height) {
 
   static const char *noteNames[] = {"C",  "C#", "D",  "D#", "E",  "F",
                                     "F#", "G",  "G#", "A",  "A#", "B"};
+  const auto keyFont = g.getCurrentFont().withHeight(13.0f);
 
   double scrollY = coordMapper->getScrollY();
   float pixelsPerSemitone = coordMapper->getPixelsPerSemitone();
@@ -514,10 +441,11 @@ void PianoRollRenderer::drawPianoKeys(juce::Graphics &g, int height) {
 
     g.setColour(isBlack ? APP_COLOR_PIANO_TEXT_DIM
                         : APP_COLOR_PIANO_TEXT);
-    g.setFont(13.0f);
-    g.drawText(noteName, CoordinateMapper::pianoKeysWidth - 36,
-               static_cast<int>(y), 32, static_cast<int>(pixelsPerSemitone),
-               juce::Justification::centred);
+    glyphs.draw(g, noteName, keyFont,
+                juce::Rectangle<float>(
+                    static_cast<float>(CoordinateMapper::pianoKeysWidth - 36),
+                    std::floor(y), 32.0f, std::floor(pixelsPerSemitone)),
+                juce::Justification::centred);
   }
 }
 
@@ -4,8 +4,13 @@
 #include "../../Models/Project.h"
 #include "../../Utils/BasePitchCurve.h"
 #include "../../Utils/Constants.h"
+#include "../../Utils/PeakPyramid.h"
+#include "../../Utils/UI/GlyphCache.h"
 #include "../../Utils/UI/Theme.h"
 #include "CoordinateMapper.h"
+#include "CurveGeometry.h"
+#include "WaveformTileCache.h"
+#include <functional>
 #include <vector>
 
 /**
@@ -18,6 +23,14 @@ public:
   ~PianoRollRenderer() = default;
 
   void setCoordinateMapper(CoordinateMapper *mapper) { coordMapper = mapper; }
+  const WaveformTileCache &getWaveformTiles() const { return waveformTiles; }
+  // Repaint when a background waveform tile has finished rendering
+  void setWaveformTileCallback(std::function<void()> callback) {
+    waveformTiles.onTileReady = std::move(callback);
+  }
+  void setViewMotion(const ViewMotion &motion) {
+    waveformTiles.setMotion(motion);
+  }
   void setProject(Project *proj) {
     project = proj;
     // Clear caches when project changes to free memory
@@ -28,6 +41,10 @@ public:
   // Main drawing methods
   void drawBackgroundWaveform(juce::Graphics &g,
                               const juce::Rectangle<int> &area);
+  // With the caller's scroll and zoom rather than the mapper's
+  void drawBackgroundWaveform(juce::Graphics &g,
+                              const juce::Rectangle<int> &area, double scrollX,
+                              float pixelsPerSecond);
   void drawGrid(juce::Graphics &g, int width, int height);
   void drawTimeline(juce::Graphics &g, int width);
   void drawNotes(juce::Graphics &g, double visibleStartTime,
@@ -48,20 +65,25 @@ private:
   // Helper for Catmull-Rom spline interpolation
   static float catmullRom(float t, float p0, float p1, float p2, float p3);
 
-  // Draw note waveform with smooth curves
+  // Draw note waveform with smooth curves; peaks from pyramid when non-null
   void drawNoteWaveform(juce::Graphics &g, const Note &note, float x, float y,
                         float w, float h, const float *samples,
-                        int totalSamples, int sampleRate);
+                        int totalSamples, int sampleRate,
+                        const PeakPyramid *pyramid);
 
   CoordinateMapper *coordMapper = nullptr;
   Project *project = nullptr;
 
-  // Waveform cache
-  juce::Image waveformCache;
-  double cachedScrollX = -1.0;
-  float cachedPixelsPerSecond = -1.0f;
-  int cachedWidth = 0;
-  int cachedHeight = 0;
+  // Background waveform, tiled
+  WaveformTileCache waveformTiles;
+  juce::SharedResourcePointer<PeakPyramidService> peaks;
+
+  // Timeline labels and key names, shaped once
+  GlyphCache glyphs;
+
+  // Pitch curve vertices and path, reused note to note
+  CurveGeometry curveGeometry;
+  juce::Path curvePath;
 
   // Base pitch cache
   std::vector<float> cachedBasePitch;
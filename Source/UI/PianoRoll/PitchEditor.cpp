@@ -1,4 +1,5 @@
 #include "PitchEditor.h"
+#include "../../Utils/NoteBulkEdit.h"
 #include <algorithm>
 #include <cmath>
 #include <limits>
@@ -9,7 +10,9 @@ Note *PitchEditor::findNoteAt(float x, float y) {
   if (!project || !coordMapper)
     return nullptr;
 
-  for (auto &note : project->getNotes()) {
+  const int frame = secondsToFrames(x / coordMapper->getPixelsPerSecond());
+  for (auto *notePtr : project->getNotesInRange(frame - 1, frame + 2)) {
+    auto &note = *notePtr;
     if (note.isRest())
       continue;
 
@@ -102,10 +105,11 @@ void PitchEditor::endNoteDrag() {
     draggedNote->setPitchOffset(0.0f);
 
     // Find adjacent notes to expand dirty range
-    const auto &notes = project->getNotes();
     int expandedStart = startFrame;
     int expandedEnd = endFrame;
-    for (const auto &note : notes) {
+    for (const auto *notePtr :
+         project->getNotesInRange(startFrame - 30, endFrame + 30)) {
+      const auto &note = *notePtr;
       if (&note == draggedNote)
         continue;
       if (note.getEndFrame() > startFrame - 30 &&
@@ -118,12 +122,13 @@ void PitchEditor::endNoteDrag() {
       }
     }
 
-    // Rebuild pitch curves
-    PitchCurveProcessor::rebuildBaseFromNotes(*project);
-    PitchCurveProcessor::composeF0InPlace(*project, false);
+    // Rebuild pitch curves around the dragged notes
+    const auto rebuilt = PitchCurveProcessor::rebuildBaseInRange(
+        *project, expandedStart, expandedEnd);
 
     if (onBasePitchCacheInvalidated)
-      onBasePitchCacheInvalidated();
+      onBasePitchCacheInvalidated(rebuilt.first, rebuilt.second);
+    project->noteChanged(*draggedNote);
 
     // Mark dirty range
     int smoothStart = std::max(0, expandedStart - 60);
@@ -144,27 +149,12 @@ void PitchEditor::endNoteDrag() {
         f0Edits.push_back(edit);
       }
 
-      int capturedExpandedStart = expandedStart;
-      int capturedExpandedEnd = expandedEnd;
-      int capturedF0Size = f0Size;
+      // The piano roll rebuilds the curves around the note when the step
+      // is undone or redone; it resynthesizes by F0 dirty range
       auto action = std::make_unique<NotePitchDragAction>(
-          draggedNote, &audioData.f0, originalMidiNote,
+          project, draggedNote, &audioData.f0, originalMidiNote,
           originalMidiNote + newOffset, std::move(f0Edits),
-          [this, capturedExpandedStart, capturedExpandedEnd,
-           capturedF0Size](Note *n) {
-            if (project) {
-              PitchCurveProcessor::rebuildBaseFromNotes(*project);
-              PitchCurveProcessor::composeF0InPlace(*project, false);
-              if (onBasePitchCacheInvalidated)
-                onBasePitchCacheInvalidated();
-              int smoothStart = std::max(0, capturedExpandedStart - 60);
-              int smoothEnd =
-                  std::min(capturedF0Size, capturedExpandedEnd + 60);
-              project->setF0DirtyRange(smoothStart, smoothEnd);
-              if (n)
-                n->clearDirty();
-            }
-          });
+          [](Note *n) { n->clearDirty(); });
       undoManager->addAction(std::move(action));
     }
 
@@ -188,10 +178,8 @@ void PitchEditor::endNoteDrag() {
 
 void PitchEditor::startDrawing(float x, float y) {
   isDrawing = true;
-  drawingEdits.clear();
-  drawingEditIndexByFrame.clear();
-  drawCurves.clear();
-  activeDrawCurve = nullptr;
+  drawingStroke.begin(
+      project ? static_cast<int>(project->getAudioData().f0.size()) : 0);
   lastDrawFrame = -1;
   lastDrawValueCents = 0;
 
@@ -219,28 +207,20 @@ void PitchEditor::continueDrawing(float x, float y) {
 }
 
 void PitchEditor::endDrawing() {
-  if (drawingEdits.empty()) {
+  if (drawingStroke.empty()) {
     isDrawing = false;
     return;
   }
 
-  // Calculate dirty frame range
-  int minFrame = std::numeric_limits<int>::max();
-  int maxFrame = std::numeric_limits<int>::min();
-  for (const auto &e : drawingEdits) {
-    minFrame = std::min(minFrame, e.idx);
-    maxFrame = std::max(maxFrame, e.idx);
-  }
+  // Dirty frame range
+  const int minFrame = drawingStroke.getMinFrame();
+  const int maxFrame = drawingStroke.getMaxFrame();
 
   // Clear deltaPitch for notes in edited range
-  if (project && minFrame <= maxFrame) {
-    auto &notes = project->getNotes();
-    for (auto &note : notes) {
-      if (note.getEndFrame() > minFrame && note.getStartFrame() < maxFrame) {
-        if (note.hasDeltaPitch()) {
-          note.setDeltaPitch(std::vector<float>());
-        }
-      }
+  if (project) {
+    for (auto *note : project->getNotesInRange(minFrame, maxFrame)) {
+      if (note->hasDeltaPitch())
+        note->setDeltaPitch(std::vector<float>());
     }
     project->setF0DirtyRange(minFrame, maxFrame);
   }
@@ -250,7 +230,7 @@ void PitchEditor::endDrawing() {
     auto &audioData = project->getAudioData();
     auto action = std::make_unique<F0EditAction>(
         &audioData.f0, &audioData.deltaPitch, &audioData.voicedMask,
-        drawingEdits, [this](int minFrame, int maxFrame) {
+        drawingStroke.getEdits(), [this](int minFrame, int maxFrame) {
           if (project) {
             project->setF0DirtyRange(minFrame, maxFrame);
             if (onPitchEditFinished)
@@ -260,12 +240,9 @@ void PitchEditor::endDrawing() {
     undoManager->addAction(std::move(action));
   }
 
-  drawingEdits.clear();
-  drawingEditIndexByFrame.clear();
+  drawingStroke.clear();
   lastDrawFrame = -1;
   lastDrawValueCents = 0;
-  activeDrawCurve = nullptr;
-  drawCurves.clear();
 
   isDrawing = false;
 
@@ -289,132 +266,63 @@ void PitchEditor::applyPitchPoint(int frameIndex, int midiCents) {
   if (frameIndex < 0 || frameIndex >= f0Size)
     return;
 
+  bool touchedNewFrame = false;
   auto applyFrame = [&](int idx, int cents) {
     if (idx < 0 || idx >= f0Size)
       return;
 
     const float newFreq = midiToFreq(static_cast<float>(cents) / 100.0f);
-    const float oldF0 = audioData.f0[idx];
-    const float oldDelta = (idx < static_cast<int>(audioData.deltaPitch.size()))
-                               ? audioData.deltaPitch[idx]
-                               : 0.0f;
     const bool oldVoiced = (idx < static_cast<int>(audioData.voicedMask.size()))
                                ? audioData.voicedMask[idx]
                                : false;
+    const float baseMidi = audioData.basePitch[static_cast<size_t>(idx)];
+    const float newDelta = static_cast<float>(cents) / 100.0f - baseMidi;
 
-    float baseMidi = (idx < static_cast<int>(audioData.basePitch.size()))
-                         ? audioData.basePitch[static_cast<size_t>(idx)]
-                         : 0.0f;
-    float newMidi = static_cast<float>(cents) / 100.0f;
-    float newDelta = newMidi - baseMidi;
-
-    auto it = drawingEditIndexByFrame.find(idx);
-    if (it == drawingEditIndexByFrame.end()) {
-      drawingEditIndexByFrame.emplace(idx, drawingEdits.size());
-      drawingEdits.push_back(F0FrameEdit{idx, oldF0, newFreq, oldDelta,
-                                         newDelta, oldVoiced, true});
-
-      // Clear deltaPitch for notes containing this frame
-      auto &notes = project->getNotes();
-      for (auto &note : notes) {
-        if (note.getStartFrame() <= idx && note.getEndFrame() > idx &&
-            note.hasDeltaPitch()) {
-          note.setDeltaPitch(std::vector<float>());
-          break;
-        }
-      }
-    } else {
-      auto &e = drawingEdits[it->second];
-      e.newF0 = newFreq;
-      e.newDelta = newDelta;
-      e.newVoiced = true;
-    }
+    touchedNewFrame = touchedNewFrame || !drawingStroke.contains(idx);
+    drawingStroke.record(F0FrameEdit{
+        idx, audioData.f0[static_cast<size_t>(idx)], newFreq,
+        audioData.deltaPitch[static_cast<size_t>(idx)], newDelta, oldVoiced,
+        true});
 
-    audioData.f0[idx] = newFreq;
-    if (idx < static_cast<int>(audioData.deltaPitch.size())) {
-      audioData.deltaPitch[static_cast<size_t>(idx)] = newDelta;
-    }
+    audioData.f0[static_cast<size_t>(idx)] = newFreq;
+    audioData.deltaPitch[static_cast<size_t>(idx)] = newDelta;
     if (idx < static_cast<int>(audioData.voicedMask.size()))
       audioData.voicedMask[idx] = true;
   };
 
-  // Only start a new curve if there's no active curve (first point of drawing)
-  if (!activeDrawCurve) {
-    startNewPitchCurve(frameIndex, midiCents);
-    applyFrame(frameIndex, midiCents);
-    return;
-  }
-
-  // Helper to append/prepend value to the active curve
-  auto appendValue = [&](int idx, int cents) {
-    if (!activeDrawCurve)
-      return;
-
-    const int curveStart = activeDrawCurve->localStart();
-    auto &vals = activeDrawCurve->mutableValues();
-
-    // Handle backward drawing: prepend values if idx < curveStart
-    if (idx < curveStart) {
-      const int prependCount = curveStart - idx;
-      std::vector<int> newVals(static_cast<size_t>(prependCount), cents);
-      newVals.insert(newVals.end(), vals.begin(), vals.end());
-      activeDrawCurve->setValues(std::move(newVals));
-      activeDrawCurve->setLocalStart(idx);
-      return;
-    }
-
-    const int offset = idx - curveStart;
-    if (offset < static_cast<int>(vals.size())) {
-      vals[static_cast<std::size_t>(offset)] = cents;
-      return;
-    }
-
-    while (static_cast<int>(vals.size()) < offset) {
-      int fill = vals.empty() ? cents : vals.back();
-      vals.push_back(fill);
-    }
-    vals.push_back(cents);
-  };
-
-  if (lastDrawFrame < 0) {
-    appendValue(frameIndex, midiCents);
+  // Frames between the previous point and this one are interpolated
+  int segmentStart = frameIndex;
+  int segmentEnd = frameIndex;
+  if (lastDrawFrame < 0 || lastDrawFrame == frameIndex) {
     applyFrame(frameIndex, midiCents);
   } else {
-    int start = lastDrawFrame;
-    int end = frameIndex;
-    int startVal = lastDrawValueCents;
-    int endVal = midiCents;
-
-    if (start == end) {
-      appendValue(frameIndex, midiCents);
-      applyFrame(frameIndex, midiCents);
-    } else {
-      int step = (end > start) ? 1 : -1;
-      int length = std::abs(end - start);
-      for (int i = 0; i <= length; ++i) {
-        int idx = start + i * step;
-        float t = length == 0
-                      ? 0.0f
-                      : static_cast<float>(i) / static_cast<float>(length);
-        float v = juce::jmap(t, 0.0f, 1.0f, static_cast<float>(startVal),
-                             static_cast<float>(endVal));
-        int cents = static_cast<int>(std::round(v));
-        appendValue(idx, cents);
-        applyFrame(idx, cents);
-      }
+    const int start = lastDrawFrame;
+    const int step = (frameIndex > start) ? 1 : -1;
+    const int length = std::abs(frameIndex - start);
+    for (int i = 0; i <= length; ++i) {
+      const float t = static_cast<float>(i) / static_cast<float>(length);
+      const float v =
+          juce::jmap(t, 0.0f, 1.0f, static_cast<float>(lastDrawValueCents),
+                     static_cast<float>(midiCents));
+      applyFrame(start + i * step, static_cast<int>(std::round(v)));
     }
+    segmentStart = std::min(start, frameIndex);
+    segmentEnd = std::max(start, frameIndex);
   }
 
   lastDrawFrame = frameIndex;
   lastDrawValueCents = midiCents;
-}
 
-void PitchEditor::startNewPitchCurve(int frameIndex, int midiCents) {
-  drawCurves.push_back(std::make_unique<DrawCurve>(frameIndex, 1));
-  activeDrawCurve = drawCurves.back().get();
-  activeDrawCurve->appendValue(midiCents);
-  lastDrawFrame = frameIndex;
-  lastDrawValueCents = midiCents;
+  // Notes under newly drawn frames drop their deltaPitch
+  if (touchedNewFrame) {
+    for (auto *note : project->getNotesInRange(segmentStart, segmentEnd + 1)) {
+      if (note->hasDeltaPitch())
+        note->setDeltaPitch(std::vector<float>());
+    }
+  }
+
+  // Streamed as the stroke grows rather than only on release
+  project->setF0DirtyRange(segmentStart, segmentEnd + 1);
 }
 
 void PitchEditor::snapNoteToSemitone(Note *note) {
@@ -426,13 +334,14 @@ void PitchEditor::snapNoteToSemitone(Note *note) {
 
   if (std::abs(snappedOffset - currentOffset) > 0.001f) {
     if (undoManager) {
-      auto action = std::make_unique<PitchOffsetAction>(note, currentOffset,
-                                                        snappedOffset);
+      auto action = std::make_unique<PitchOffsetAction>(
+          project, note, currentOffset, snappedOffset);
       undoManager->addAction(std::move(action));
     }
 
     note->setPitchOffset(snappedOffset);
     note->markDirty();
+    project->noteChanged(*note);
 
     if (onPitchEdited)
       onPitchEdited();
@@ -515,42 +424,25 @@ void PitchEditor::endMultiNoteDrag() {
     auto &audioData = project->getAudioData();
     int f0Size = static_cast<int>(audioData.f0.size());
 
-    int expandedStart = std::numeric_limits<int>::max();
-    int expandedEnd = std::numeric_limits<int>::min();
-
     // Bake pitchOffset into midiNote for all notes
     for (size_t i = 0; i < draggedNotes.size(); ++i) {
       auto *note = draggedNotes[i];
       note->setMidiNote(originalMidiNotes[i] + newOffset);
       note->setPitchOffset(0.0f);
-
-      expandedStart = std::min(expandedStart, note->getStartFrame());
-      expandedEnd = std::max(expandedEnd, note->getEndFrame());
     }
 
-    // Find adjacent notes to expand dirty range
-    const auto &allNotes = project->getNotes();
-    for (const auto &note : allNotes) {
-      if (note.getEndFrame() > expandedStart - 30 &&
-          note.getEndFrame() <= expandedStart)
-        expandedStart = std::min(expandedStart, note.getStartFrame());
-      if (note.getStartFrame() < expandedEnd + 30 &&
-          note.getStartFrame() >= expandedEnd)
-        expandedEnd = std::max(expandedEnd, note.getEndFrame());
+    // Rebuild pitch curves around each group of dragged notes, rather than
+    // across everything between the first and the last one
+    for (const auto &[start, end] :
+         NoteBulkEdit::rebuildAroundNotes(*project, draggedNotes))
+      if (onBasePitchCacheInvalidated)
+        onBasePitchCacheInvalidated(start, end);
+    {
+      NoteChangeFeed::ScopedBatch batch(&project->getNoteChanges());
+      for (const auto *note : draggedNotes)
+        project->noteChanged(*note);
     }
 
-    // Rebuild pitch curves
-    PitchCurveProcessor::rebuildBaseFromNotes(*project);
-    PitchCurveProcessor::composeF0InPlace(*project, false);
-
-    if (onBasePitchCacheInvalidated)
-      onBasePitchCacheInvalidated();
-
-    // Mark dirty range
-    int smoothStart = std::max(0, expandedStart - 60);
-    int smoothEnd = std::min(f0Size, expandedEnd + 60);
-    project->setF0DirtyRange(smoothStart, smoothEnd);
-
     // Create undo action for multi-note drag
     if (undoManager) {
       std::vector<F0FrameEdit> f0Edits;
@@ -571,29 +463,10 @@ void PitchEditor::endMultiNoteDrag() {
         }
       }
 
-      int capturedExpandedStart = expandedStart;
-      int capturedExpandedEnd = expandedEnd;
-      int capturedF0Size = f0Size;
-      std::vector<Note *> capturedNotes = draggedNotes;
-      std::vector<float> capturedOriginalMidi = originalMidiNotes;
-      float capturedNewOffset = newOffset;
-
+      // Curves are rebuilt by the piano roll when the step is replayed
       auto action = std::make_unique<MultiNotePitchDragAction>(
-          capturedNotes, &audioData.f0, capturedOriginalMidi, capturedNewOffset,
-          std::move(f0Edits),
-          [this, capturedExpandedStart, capturedExpandedEnd,
-           capturedF0Size](const std::vector<Note *> &) {
-            if (project) {
-              PitchCurveProcessor::rebuildBaseFromNotes(*project);
-              PitchCurveProcessor::composeF0InPlace(*project, false);
-              if (onBasePitchCacheInvalidated)
-                onBasePitchCacheInvalidated();
-              int smoothStart = std::max(0, capturedExpandedStart - 60);
-              int smoothEnd =
-                  std::min(capturedF0Size, capturedExpandedEnd + 60);
-              project->setF0DirtyRange(smoothStart, smoothEnd);
-            }
-          });
+          project, draggedNotes, &audioData.f0, originalMidiNotes, newOffset,
+          std::move(f0Edits));
       undoManager->addAction(std::move(action));
     }
 
@@ -634,8 +507,18 @@ void PitchEditor::prepareDragBasePreview() {
   if (selectedNotes.empty())
     return;
 
+  int selectionStart = selectedNotes.front()->getStartFrame();
+  int selectionEnd = selectedNotes.front()->getEndFrame();
+  for (const auto *note : selectedNotes) {
+    selectionStart = std::min(selectionStart, note->getStartFrame());
+    selectionEnd = std::max(selectionEnd, note->getEndFrame());
+  }
+
+  // Only the dragged notes' neighbourhood is read, and only its window of
+  // the curves copied below
   auto range = computeBasePitchPreviewRange(
-      project->getNotes(), static_cast<int>(audioData.basePitch.size()),
+      *project, selectionStart, selectionEnd,
+      static_cast<int>(audioData.basePitch.size()),
       [&selectedNotes](const Note &note) {
         return std::find(selectedNotes.begin(), selectedNotes.end(), &note) !=
                selectedNotes.end();
@@ -3,13 +3,11 @@
 #include "../../JuceHeader.h"
 #include "../../Models/Project.h"
 #include "../../Utils/UndoManager.h"
-#include "../../Utils/UI/DrawCurve.h"
+#include "../../Utils/F0StrokeBuffer.h"
 #include "../../Utils/BasePitchPreview.h"
 #include "../../Utils/PitchCurveProcessor.h"
 #include "CoordinateMapper.h"
-#include <deque>
 #include <memory>
-#include <unordered_map>
 #include <functional>
 
 /**
@@ -52,11 +50,11 @@ public:
     std::function<void(Note*)> onNoteSelected;
     std::function<void()> onPitchEdited;
     std::function<void()> onPitchEditFinished;
-    std::function<void()> onBasePitchCacheInvalidated;
+    // With the frame range whose base pitch was rebuilt
+    std::function<void(int, int)> onBasePitchCacheInvalidated;
 
 private:
     void applyPitchPoint(int frameIndex, int midiCents);
-    void startNewPitchCurve(int frameIndex, int midiCents);
     void prepareDragBasePreview();
     void applyDragBasePreview(float pitchOffsetSemitones);
     void restoreDragBasePreview();
@@ -89,12 +87,9 @@ private:
 
     // Draw state
     bool isDrawing = false;
-    std::vector<F0FrameEdit> drawingEdits;
-    std::unordered_map<int, size_t> drawingEditIndexByFrame;
+    F0StrokeBuffer drawingStroke;
     int lastDrawFrame = -1;
     int lastDrawValueCents = 0;
-    DrawCurve* activeDrawCurve = nullptr;
-    std::deque<std::unique_ptr<DrawCurve>> drawCurves;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PitchEditor)
 };
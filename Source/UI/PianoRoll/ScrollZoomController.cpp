@@ -266,3 +266,32 @@ void ScrollZoomController::updateScrollBars(int visibleWidth, int visibleHeight)
     verticalScrollBar.setRangeLimits(0, totalHeight);
     verticalScrollBar.setCurrentRange(coordMapper->getScrollY(), visibleHeight);
 }
+
+void ScrollZoomController::trackView(double scrollX, float pixelsPerSecond) {
+    if (pixelsPerSecond <= 0.0f)
+        return;
+
+    // Paints further apart than this are separate gestures
+    constexpr double maxGapSeconds = 0.25;
+    // Share of each measurement in the estimate; wheels move in bursts
+    constexpr double smoothing = 0.5;
+
+    const double now = juce::Time::getMillisecondCounterHiRes();
+    const double elapsed = (now - lastTrackMs) / 1000.0;
+    if (lastTrackMs > 0.0 && elapsed < 0.001)
+        return;
+
+    const double viewStart = scrollX / pixelsPerSecond;
+    const double viewOctaves = std::log2(static_cast<double>(pixelsPerSecond));
+    if (lastTrackMs > 0.0 && elapsed < maxGapSeconds) {
+        motion.scrollSecondsPerSecond +=
+            smoothing * ((viewStart - lastViewStart) / elapsed - motion.scrollSecondsPerSecond);
+        motion.zoomOctavesPerSecond +=
+            smoothing * ((viewOctaves - lastViewOctaves) / elapsed - motion.zoomOctavesPerSecond);
+    } else {
+        motion = {};
+    }
+    lastTrackMs = now;
+    lastViewStart = viewStart;
+    lastViewOctaves = viewOctaves;
+}
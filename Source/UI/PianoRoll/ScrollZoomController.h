@@ -3,6 +3,7 @@
 #include "../../JuceHeader.h"
 #include "../../Models/Project.h"
 #include "CoordinateMapper.h"
+#include "ViewMotion.h"
 #include <functional>
 
 /**
@@ -34,6 +35,11 @@ public:
     // Update scrollbar ranges
     void updateScrollBars(int visibleWidth, int visibleHeight);
 
+    // Measure scroll and zoom speed from the view each paint shows, whatever
+    // moved it (wheel, scrollbar, playback follow, overview)
+    void trackView(double scrollX, float pixelsPerSecond);
+    const ViewMotion& getMotion() const { return motion; }
+
     // Access scrollbars for layout
     juce::ScrollBar& getHorizontalScrollBar() { return horizontalScrollBar; }
     juce::ScrollBar& getVerticalScrollBar() { return verticalScrollBar; }
@@ -50,5 +56,10 @@ private:
     juce::ScrollBar horizontalScrollBar{false};
     juce::ScrollBar verticalScrollBar{true};
 
+    ViewMotion motion;
+    double lastTrackMs = 0.0;
+    double lastViewStart = 0.0;   // Audio seconds at the left edge
+    double lastViewOctaves = 0.0; // log2 of pixels per second
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ScrollZoomController)
 };
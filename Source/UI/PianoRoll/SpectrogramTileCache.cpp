@@ -0,0 +1,354 @@
+#include "SpectrogramTileCache.h"
+#include "../../Utils/Constants.h"
+#include "../../Utils/MelFilterbank.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+
+namespace {
+constexpr double framesPerSecond = static_cast<double>(SAMPLE_RATE) / HOP_SIZE;
+constexpr int numRows =
+    (MAX_MIDI_NOTE - MIN_MIDI_NOTE + 1) * SpectrogramTileCache::rowsPerSemitone;
+
+// Log mel mapped onto the colour map: the vocoder's silence, ln(1e-5), and
+// below is transparent
+constexpr float floorLogMel = -10.0f;
+constexpr float peakLogMel = 1.5f;
+
+// Premultiplied, rising in both brightness and opacity
+const std::array<juce::PixelARGB, 256> &colourMap() {
+  static const auto map = []() {
+    juce::ColourGradient gradient(juce::Colour(0x00281448), 0.0f, 0.0f,
+                                  juce::Colour(0xe0ffd878), 1.0f, 0.0f, false);
+    gradient.addColour(0.35, juce::Colour(0x705a2a8c));
+    gradient.addColour(0.7, juce::Colour(0xb0d04c5c));
+    std::array<juce::PixelARGB, 256> colours;
+    for (size_t i = 0; i < colours.size(); ++i)
+      colours[i] = gradient
+                       .getColourAtPosition(static_cast<double>(i) /
+                                            (colours.size() - 1))
+                       .getPixelARGB();
+    return colours;
+  }();
+  return map;
+}
+} // namespace
+
+SpectrogramTileCache::SpectrogramTileCache()
+    : worker([this]() { workerLoop(); }) {}
+
+SpectrogramTileCache::~SpectrogramTileCache() {
+  alive->store(false);
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopWorker = true;
+    jobs.clear();
+  }
+  wakeWorker.notify_all();
+  if (worker.joinable())
+    worker.join();
+}
+
+void SpectrogramTileCache::clear() {
+  tiles.clear();
+  chunks.clear();
+  sourceData = nullptr;
+  sourceFrames = 0;
+  sourceMels = 0;
+  ++generation;
+  std::lock_guard<std::mutex> lock(mutex);
+  jobs.clear();
+}
+
+void SpectrogramTileCache::invalidate(int startFrame, int endFrame) {
+  const int numChunks = static_cast<int>(chunks.size());
+  const int first = std::max(0, startFrame / chunkFrames);
+  const int last =
+      std::min(numChunks - 1, (std::max(endFrame, 1) - 1) / chunkFrames);
+  for (int c = first; c <= last; ++c)
+    chunks[static_cast<size_t>(c)].reset();
+}
+
+void SpectrogramTileCache::setSource(const MelBuffer &mel) {
+  if (mel.data() == sourceData && mel.size() == sourceFrames &&
+      mel.getNumMels() == sourceMels)
+    return;
+  sourceData = mel.data();
+  sourceFrames = mel.size();
+  sourceMels = mel.getNumMels();
+  chunks.assign((sourceFrames + chunkFrames - 1) / chunkFrames, nullptr);
+}
+
+std::vector<SpectrogramTileCache::Chunk>
+SpectrogramTileCache::chunksFor(const MelBuffer &mel, int firstFrame,
+                                int lastFrame) {
+  std::vector<Chunk> covering;
+  for (int c = firstFrame / chunkFrames; c <= (lastFrame - 1) / chunkFrames;
+       ++c) {
+    auto &chunk = chunks[static_cast<size_t>(c)];
+    if (!chunk)
+      chunk = std::make_shared<const MelBuffer>(
+          mel.view(static_cast<size_t>(c) * chunkFrames,
+                   static_cast<size_t>(c + 1) * chunkFrames));
+    covering.push_back(chunk);
+  }
+  return covering;
+}
+
+bool SpectrogramTileCache::isCurrent(int firstChunk,
+                                     const std::vector<Chunk> &rendered) const {
+  if (rendered.empty() ||
+      static_cast<size_t>(firstChunk) + rendered.size() > chunks.size())
+    return false;
+  for (size_t i = 0; i < rendered.size(); ++i)
+    if (chunks[static_cast<size_t>(firstChunk) + i] != rendered[i])
+      return false;
+  return true;
+}
+
+int SpectrogramTileCache::bucketFor(float pixelsPerSecond) {
+  return static_cast<int>(std::lround(
+      std::log2(std::max(pixelsPerSecond, 1.0e-3f)) * bucketsPerOctave));
+}
+
+double SpectrogramTileCache::bucketPixelsPerSecond(int bucket) {
+  return std::exp2(static_cast<double>(bucket) / bucketsPerOctave);
+}
+
+std::pair<int, int> SpectrogramTileCache::frameRange(int bucket, int64_t index,
+                                                     int numFrames) {
+  const double framesPerPixel = framesPerSecond / bucketPixelsPerSecond(bucket);
+  const double first =
+      std::floor(static_cast<double>(index) * tileWidth * framesPerPixel);
+  const double last =
+      std::ceil(static_cast<double>(index + 1) * tileWidth * framesPerPixel);
+  return {static_cast<int>(std::clamp(first, 0.0, static_cast<double>(numFrames))),
+          static_cast<int>(std::clamp(last, 0.0, static_cast<double>(numFrames)))};
+}
+
+void SpectrogramTileCache::draw(juce::Graphics &g, const MelBuffer &mel,
+                                double scrollX, int width,
+                                float pixelsPerSecond,
+                                float pixelsPerSemitone) {
+  if (mel.empty() || mel.getNumMels() < 2 || width <= 0 ||
+      pixelsPerSecond <= 0.0f || pixelsPerSemitone <= 0.0f)
+    return;
+
+  setSource(mel);
+  const int numFrames = static_cast<int>(mel.size());
+  const int bucket = bucketFor(pixelsPerSecond);
+  const double bucketRate = bucketPixelsPerSecond(bucket);
+  // Screen pixels per tile pixel
+  const double scale = pixelsPerSecond / bucketRate;
+  const double tileScreenWidth = tileWidth * scale;
+  const float rowHeight = pixelsPerSemitone / rowsPerSemitone;
+  const auto lastTileIndex = static_cast<int64_t>(
+      numFrames / framesPerSecond * bucketRate / tileWidth);
+
+  const auto firstVisible =
+      static_cast<int64_t>(std::floor(scrollX / tileScreenWidth));
+  const auto lastVisible =
+      static_cast<int64_t>(std::floor((scrollX + width) / tileScreenWidth));
+
+  ++drawCounter;
+  std::vector<Job> wanted;
+  for (int64_t index = std::max<int64_t>(0, firstVisible - 1);
+       index <= std::min(lastTileIndex, lastVisible + 1); ++index) {
+    const auto [firstFrame, lastFrame] = frameRange(bucket, index, numFrames);
+    if (firstFrame >= lastFrame)
+      continue;
+
+    const TileKey key{bucket, index};
+    auto covering = chunksFor(mel, firstFrame, lastFrame);
+    auto it = tiles.find(key);
+    if (it == tiles.end() || it->second.chunks != covering)
+      wanted.push_back({key, std::move(covering), firstFrame / chunkFrames,
+                        numFrames, generation});
+    if (it == tiles.end() || !it->second.image.isValid() ||
+        index < firstVisible || index > lastVisible)
+      continue;
+
+    // Stale tiles too: the previous mel until this one's is ready
+    it->second.lastDrawn = drawCounter;
+    g.drawImageTransformed(
+        it->second.image,
+        juce::AffineTransform::scale(static_cast<float>(scale), rowHeight)
+            .translated(static_cast<float>(index * tileScreenWidth), 0.0f),
+        false);
+  }
+
+  // Then, behind them, the tiles a scroll reveals next and the view at the
+  // bucket a zoom is heading for
+  auto prefetch = [&](int prefetchBucket, double startSeconds,
+                      double endSeconds) {
+    const double rate = bucketPixelsPerSecond(prefetchBucket);
+    const auto first = static_cast<int64_t>(
+        std::floor(std::max(0.0, startSeconds) * rate / tileWidth));
+    const auto last = static_cast<int64_t>(std::floor(
+        std::min(numFrames / framesPerSecond, endSeconds) * rate / tileWidth));
+    for (int64_t index = first; index <= last; ++index) {
+      const auto [firstFrame, lastFrame] =
+          frameRange(prefetchBucket, index, numFrames);
+      const TileKey key{prefetchBucket, index};
+      if (firstFrame >= lastFrame ||
+          std::any_of(wanted.begin(), wanted.end(),
+                      [&key](const Job &job) { return job.key == key; }))
+        continue;
+      auto covering = chunksFor(mel, firstFrame, lastFrame);
+      auto it = tiles.find(key);
+      if (it == tiles.end() || it->second.chunks != covering)
+        wanted.push_back({key, std::move(covering), firstFrame / chunkFrames,
+                          numFrames, generation});
+    }
+  };
+  const double visibleStart = scrollX / pixelsPerSecond;
+  const double visibleEnd = (scrollX + width) / pixelsPerSecond;
+  const auto [aheadStart, aheadEnd] =
+      motion.getScrollAhead(visibleStart, visibleEnd);
+  if (aheadEnd > aheadStart)
+    prefetch(bucket, aheadStart, aheadEnd);
+  if (motion.isZooming()) {
+    int nextBucket = bucketFor(
+        static_cast<float>(motion.getZoomAhead(pixelsPerSecond)));
+    if (nextBucket == bucket)
+      nextBucket += motion.zoomOctavesPerSecond > 0.0 ? 1 : -1;
+    // Zooming out shows more either side of the current view
+    const double spread =
+        std::max(0.0, pixelsPerSecond / bucketPixelsPerSecond(nextBucket) - 1.0) *
+        (visibleEnd - visibleStart) * 0.5;
+    prefetch(nextBucket, visibleStart - spread, visibleEnd + spread);
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    // Skip the tile being rendered; it arrives anyway
+    wanted.erase(std::remove_if(wanted.begin(), wanted.end(),
+                                [this](const Job &job) {
+                                  return job.key == inFlight;
+                                }),
+                 wanted.end());
+    jobs = std::move(wanted);
+  }
+  wakeWorker.notify_all();
+  evictIfNeeded();
+}
+
+void SpectrogramTileCache::evictIfNeeded() {
+  while (tiles.size() > maxTiles) {
+    auto oldest = std::min_element(
+        tiles.begin(), tiles.end(), [](const auto &a, const auto &b) {
+          return a.second.lastDrawn < b.second.lastDrawn;
+        });
+    tiles.erase(oldest);
+  }
+}
+
+juce::Image SpectrogramTileCache::renderTile(const Job &job) {
+  const int numMels = job.chunks.front()->getNumMels();
+  const double framesPerPixel =
+      framesPerSecond / bucketPixelsPerSecond(job.key.first);
+
+  // Each row's pitch as a position between two mel bands; -1 outside them
+  std::array<int, numRows> rowBand;
+  std::array<float, numRows> rowFraction;
+  for (int row = 0; row < numRows; ++row) {
+    const float pitch = MAX_MIDI_NOTE + 0.5f -
+                        (row + 0.5f) / static_cast<float>(rowsPerSemitone);
+    const float band = MelFilterbank::bandForFrequency(midiToFreq(pitch),
+                                                       numMels, FMIN, FMAX);
+    if (band < 0.0f || band > numMels - 1) {
+      rowBand[static_cast<size_t>(row)] = -1;
+      continue;
+    }
+    const int lower = std::min(static_cast<int>(band), numMels - 2);
+    rowBand[static_cast<size_t>(row)] = lower;
+    rowFraction[static_cast<size_t>(row)] = band - lower;
+  }
+
+  // Software image: rendered off the message thread
+  juce::Image image(juce::Image::ARGB, tileWidth, numRows, true,
+                    juce::SoftwareImageType());
+  juce::Image::BitmapData pixels(image, juce::Image::BitmapData::writeOnly);
+  const auto &colours = colourMap();
+
+  std::vector<float> column(static_cast<size_t>(numMels));
+  for (int px = 0; px < tileWidth; ++px) {
+    const double x = static_cast<double>(job.key.second) * tileWidth + px;
+    const int startFrame = static_cast<int>(x * framesPerPixel);
+    if (startFrame >= job.numFrames)
+      break;
+    const int endFrame =
+        std::max(startFrame + 1, std::min(static_cast<int>((x + 1.0) *
+                                                           framesPerPixel),
+                                          job.numFrames));
+
+    // The loudest of the frames under the column, band by band
+    std::fill(column.begin(), column.end(),
+              -std::numeric_limits<float>::infinity());
+    for (int frame = startFrame; frame < endFrame; ++frame) {
+      const auto &chunk =
+          *job.chunks[static_cast<size_t>(frame / chunkFrames -
+                                          job.firstChunk)];
+      const float *values = chunk[static_cast<size_t>(frame % chunkFrames)];
+      for (int m = 0; m < numMels; ++m)
+        column[static_cast<size_t>(m)] =
+            std::max(column[static_cast<size_t>(m)], values[m]);
+    }
+
+    for (int row = 0; row < numRows; ++row) {
+      const int band = rowBand[static_cast<size_t>(row)];
+      if (band < 0)
+        continue;
+      const float t = rowFraction[static_cast<size_t>(row)];
+      const float value = column[static_cast<size_t>(band)] * (1.0f - t) +
+                          column[static_cast<size_t>(band + 1)] * t;
+      const float level =
+          (value - floorLogMel) / (peakLogMel - floorLogMel);
+      if (!(level > 0.0f))
+        continue;
+      const auto index = static_cast<size_t>(
+          std::min(level, 1.0f) * static_cast<float>(colours.size() - 1));
+      *reinterpret_cast<juce::PixelARGB *>(pixels.getPixelPointer(px, row)) =
+          colours[index];
+    }
+  }
+  return image;
+}
+
+void SpectrogramTileCache::workerLoop() {
+  std::unique_lock<std::mutex> lock(mutex);
+  while (!stopWorker) {
+    if (jobs.empty()) {
+      wakeWorker.wait(lock);
+      continue;
+    }
+
+    Job job = std::move(jobs.front());
+    jobs.erase(jobs.begin());
+    inFlight = job.key;
+    lock.unlock();
+
+    auto image = renderTile(job);
+    juce::MessageManager::callAsync(
+        [this, token = alive, job = std::move(job),
+         image = std::move(image)]() {
+          if (!token->load() || job.generation != generation)
+            return;
+          // An edit since may have superseded it; still better than an
+          // empty tile
+          auto &tile = tiles[job.key];
+          if (tile.image.isValid() && !isCurrent(job.firstChunk, job.chunks))
+            return;
+          tile.image = image;
+          tile.chunks = job.chunks;
+          tile.lastDrawn = drawCounter;
+          if (onTileReady)
+            onTileReady();
+        });
+
+    lock.lock();
+    inFlight = {0, -1};
+  }
+}
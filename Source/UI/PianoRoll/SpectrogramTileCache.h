@@ -0,0 +1,119 @@
+#pragma once
+
+#include "../../JuceHeader.h"
+#include "../../Utils/MelBuffer.h"
+#include "ViewMotion.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/**
+ * Mel spectrogram behind the piano roll's notes, as fixed-width image tiles.
+ *
+ * The project's mel is edited in place, so the worker never reads it: the
+ * cache copies it into immutable chunks of chunkFrames frames as tiles need
+ * them, and invalidate() drops the chunks an edit touched. Tile rows are
+ * laid out in pitch, rowsPerSemitone to a semitone from MAX_MIDI_NOTE down,
+ * so vertical zoom only scales them; horizontally they are keyed by zoom
+ * bucket like WaveformTileCache, each column the loudest of the frames under
+ * it. A tile is current while the chunks it was rendered from are, and a
+ * stale one keeps showing until its replacement is ready.
+ *
+ * Message thread only, apart from the worker.
+ */
+class SpectrogramTileCache {
+public:
+  static constexpr int tileWidth = 256;
+  static constexpr int rowsPerSemitone = 4;
+  static constexpr int chunkFrames = 1024;
+
+  SpectrogramTileCache();
+  ~SpectrogramTileCache();
+
+  // Called on the message thread when a requested tile has been rendered
+  std::function<void()> onTileReady;
+
+  void clear();
+  // Mel frames [startFrame, endFrame) were overwritten
+  void invalidate(int startFrame, int endFrame);
+
+  // After the visible tiles, draw() queues what this motion reveals next
+  void setMotion(const ViewMotion &newMotion) { motion = newMotion; }
+
+  // Draw mel in world coordinates: x = seconds * pixelsPerSecond, y = 0 at
+  // the top of MAX_MIDI_NOTE's row. Only world x scrollX..scrollX + width
+  // is requested
+  void draw(juce::Graphics &g, const MelBuffer &mel, double scrollX,
+            int width, float pixelsPerSecond, float pixelsPerSemitone);
+
+private:
+  // At most this many tiles are kept, least recently drawn dropped first
+  static constexpr size_t maxTiles = 48;
+  // Bucket pixel rates are 2^(k / bucketsPerOctave)
+  static constexpr int bucketsPerOctave = 4;
+
+  using TileKey = std::pair<int, int64_t>; // Zoom bucket, tile index
+  using Chunk = std::shared_ptr<const MelBuffer>;
+
+  struct Tile {
+    juce::Image image;
+    std::vector<Chunk> chunks; // Rendered from; held so the check is exact
+    uint64_t lastDrawn = 0;
+  };
+
+  struct Job {
+    TileKey key;
+    std::vector<Chunk> chunks; // From chunk firstChunk on
+    int firstChunk = 0;
+    int numFrames = 0;
+    uint64_t generation = 0;
+  };
+
+  static int bucketFor(float pixelsPerSecond);
+  static double bucketPixelsPerSecond(int bucket);
+  // Mel frames [first, last) under tile index at a bucket's rate
+  static std::pair<int, int> frameRange(int bucket, int64_t index,
+                                        int numFrames);
+  // Worker: the tile's columns, colour-mapped
+  static juce::Image renderTile(const Job &job);
+
+  // Drop every chunk when mel is not the buffer they were copied from
+  void setSource(const MelBuffer &mel);
+  // Chunks covering [firstFrame, lastFrame), copied from mel where missing
+  std::vector<Chunk> chunksFor(const MelBuffer &mel, int firstFrame,
+                               int lastFrame);
+  bool isCurrent(int firstChunk, const std::vector<Chunk> &rendered) const;
+
+  void workerLoop();
+  void evictIfNeeded();
+
+  const float *sourceData = nullptr;
+  size_t sourceFrames = 0;
+  int sourceMels = 0;
+  std::vector<Chunk> chunks; // Null until needed or after invalidate()
+  std::map<TileKey, Tile> tiles;
+  uint64_t generation = 1; // Bumped by clear() to drop late deliveries
+  uint64_t drawCounter = 0;
+  ViewMotion motion;
+
+  // Guarded by mutex: jobs not started yet, replaced by every draw(), and
+  // the one the worker is rendering
+  std::vector<Job> jobs;
+  TileKey inFlight{0, -1};
+  std::mutex mutex;
+  std::condition_variable wakeWorker;
+  bool stopWorker = false;
+  // Cleared on destruction so finished tiles are not delivered after it
+  std::shared_ptr<std::atomic<bool>> alive =
+      std::make_shared<std::atomic<bool>>(true);
+  std::thread worker; // Last: starts in the constructor
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SpectrogramTileCache)
+};
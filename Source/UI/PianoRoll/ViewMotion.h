@@ -0,0 +1,44 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+/**
+ * How fast the piano roll's view is scrolling and zooming horizontally, as
+ * measured by ScrollZoomController, so the tile caches can render what the
+ * motion reveals next before it is on screen.
+ */
+struct ViewMotion {
+  // Wall-clock time the caches render ahead of the motion
+  static constexpr double lookaheadSeconds = 0.3;
+
+  double scrollSecondsPerSecond = 0.0; // Audio time; positive to the right
+  double zoomOctavesPerSecond = 0.0;   // Of pixels per second; positive in
+
+  bool isScrolling() const { return std::abs(scrollSecondsPerSecond) > 1.0e-3; }
+  bool isZooming() const { return std::abs(zoomOctavesPerSecond) > 1.0e-3; }
+
+  // Audio seconds the scroll reveals within lookaheadSeconds beside the
+  // visible [visibleStart, visibleEnd), at most one view wide; empty when
+  // not scrolling
+  std::pair<double, double> getScrollAhead(double visibleStart,
+                                           double visibleEnd) const {
+    const double reach =
+        std::min(visibleEnd - visibleStart,
+                 std::abs(scrollSecondsPerSecond) * lookaheadSeconds);
+    if (!isScrolling() || reach <= 0.0)
+      return {visibleEnd, visibleEnd};
+    if (scrollSecondsPerSecond > 0.0)
+      return {visibleEnd, visibleEnd + reach};
+    return {visibleStart - reach, visibleStart};
+  }
+
+  // Pixels per second the zoom reaches within lookaheadSeconds, at most an
+  // octave away
+  double getZoomAhead(double pixelsPerSecond) const {
+    return pixelsPerSecond *
+           std::exp2(std::clamp(zoomOctavesPerSecond * lookaheadSeconds,
+                                -1.0, 1.0));
+  }
+};
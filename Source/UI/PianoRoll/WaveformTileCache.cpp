@@ -0,0 +1,287 @@
+#include "WaveformTileCache.h"
+
+#include <algorithm>
+#include <cmath>
+
+WaveformTileCache::WaveformTileCache()
+    : worker([this]() { workerLoop(); }) {}
+
+WaveformTileCache::~WaveformTileCache() {
+  alive->store(false);
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopWorker = true;
+    jobs.clear();
+  }
+  wakeWorker.notify_all();
+  if (worker.joinable())
+    worker.join();
+}
+
+void WaveformTileCache::setSnapshot(RenderSnapshot::Ptr newSnapshot) {
+  if (newSnapshot == snapshot)
+    return;
+
+  // Tiles drawn only from sample tiles the new render shares stay current
+  const auto previous = std::move(snapshot);
+  const uint64_t previousGeneration = snapshotGeneration++;
+  snapshot = std::move(newSnapshot);
+  const bool sameShape =
+      previous && snapshot &&
+      previous->getNumSamples() == snapshot->getNumSamples() &&
+      previous->getSampleRate() == snapshot->getSampleRate() &&
+      previous->getNumTiles() == snapshot->getNumTiles();
+  for (auto &[key, tile] : tiles) {
+    if (!sameShape || tile.generation != previousGeneration)
+      continue;
+    const double bucketRate = bucketPixelsPerSecond(key.first);
+    const double samplesPerPixel = snapshot->getSampleRate() / bucketRate;
+    const auto first = static_cast<int64_t>(
+        std::floor(static_cast<double>(key.second) * tileWidth *
+                   samplesPerPixel));
+    const auto last = static_cast<int64_t>(
+        std::ceil(static_cast<double>(key.second + 1) * tileWidth *
+                  samplesPerPixel));
+    const int firstTile = static_cast<int>(
+        std::clamp<int64_t>(first / RenderSnapshot::tileSize, 0,
+                            snapshot->getNumTiles() - 1));
+    const int lastTile = static_cast<int>(
+        std::clamp<int64_t>(last / RenderSnapshot::tileSize, 0,
+                            snapshot->getNumTiles() - 1));
+    bool shared = true;
+    for (int t = firstTile; t <= lastTile && shared; ++t)
+      shared = snapshot->sharesTile(*previous, t);
+    if (shared)
+      tile.generation = snapshotGeneration;
+  }
+}
+
+void WaveformTileCache::clear() {
+  tiles.clear();
+  snapshot = nullptr;
+  ++snapshotGeneration;
+  std::lock_guard<std::mutex> lock(mutex);
+  jobs.clear();
+}
+
+int WaveformTileCache::bucketFor(float pixelsPerSecond) {
+  return static_cast<int>(std::lround(
+      std::log2(std::max(pixelsPerSecond, 1.0e-3f)) * bucketsPerOctave));
+}
+
+double WaveformTileCache::bucketPixelsPerSecond(int bucket) {
+  return std::exp2(static_cast<double>(bucket) / bucketsPerOctave);
+}
+
+void WaveformTileCache::draw(juce::Graphics &g,
+                             const juce::Rectangle<int> &area, double scrollX,
+                             float pixelsPerSecond, juce::Colour colour) {
+  if (!snapshot || snapshot->getNumSamples() == 0 ||
+      snapshot->getNumChannels() == 0 || area.isEmpty() ||
+      pixelsPerSecond <= 0.0f)
+    return;
+
+  if (area.getHeight() != tileHeight || colour != tileColour) {
+    tiles.clear();
+    tileHeight = area.getHeight();
+    tileColour = colour;
+  }
+
+  const int bucket = bucketFor(pixelsPerSecond);
+  const double bucketRate = bucketPixelsPerSecond(bucket);
+  // Screen pixels per tile pixel
+  const double scale = pixelsPerSecond / bucketRate;
+  const double tileScreenWidth = tileWidth * scale;
+  const auto lastTileIndex = static_cast<int64_t>(
+      static_cast<double>(snapshot->getNumSamples()) /
+      snapshot->getSampleRate() * bucketRate / tileWidth);
+
+  const auto firstVisible = static_cast<int64_t>(
+      std::floor(scrollX / tileScreenWidth));
+  const auto lastVisible = static_cast<int64_t>(
+      std::floor((scrollX + area.getWidth()) / tileScreenWidth));
+
+  auto pyramid = pyramids->get(snapshot);
+  if (pyramid && pyramid->getSource() != snapshot)
+    pyramid = nullptr;
+
+  ++drawCounter;
+  std::vector<Job> wanted;
+  for (int64_t index = std::max<int64_t>(0, firstVisible - 1);
+       index <= std::min(lastTileIndex, lastVisible + 1); ++index) {
+    const TileKey key{bucket, index};
+    auto it = tiles.find(key);
+    const bool current =
+        it != tiles.end() && it->second.generation == snapshotGeneration;
+    if (!current)
+      wanted.push_back(
+          {key, snapshot, pyramid, snapshotGeneration, tileHeight, tileColour});
+    if (index >= firstVisible && index <= lastVisible)
+      ++(current ? hits : misses);
+    if (it == tiles.end() || !it->second.image.isValid() ||
+        index < firstVisible || index > lastVisible)
+      continue;
+
+    // Stale tiles too: the previous render until this one's is ready
+    it->second.lastDrawn = drawCounter;
+    const double x = index * tileScreenWidth - scrollX + area.getX();
+    g.drawImageTransformed(
+        it->second.image,
+        juce::AffineTransform::scale(static_cast<float>(scale), 1.0f)
+            .translated(static_cast<float>(x),
+                        static_cast<float>(area.getY())),
+        false);
+  }
+
+  // Then, behind them, the tiles a scroll reveals next and the view at the
+  // bucket a zoom is heading for
+  const double duration =
+      static_cast<double>(snapshot->getNumSamples()) / snapshot->getSampleRate();
+  auto prefetch = [&](int prefetchBucket, double startSeconds,
+                      double endSeconds) {
+    const double rate = bucketPixelsPerSecond(prefetchBucket);
+    const auto first = static_cast<int64_t>(
+        std::floor(std::max(0.0, startSeconds) * rate / tileWidth));
+    const auto last = static_cast<int64_t>(
+        std::floor(std::min(duration, endSeconds) * rate / tileWidth));
+    for (int64_t index = first; index <= last; ++index) {
+      const TileKey key{prefetchBucket, index};
+      auto it = tiles.find(key);
+      if ((it == tiles.end() || it->second.generation != snapshotGeneration) &&
+          std::none_of(wanted.begin(), wanted.end(),
+                       [&key](const Job &job) { return job.key == key; }))
+        wanted.push_back(
+            {key, snapshot, pyramid, snapshotGeneration, tileHeight, tileColour});
+    }
+  };
+  const double visibleStart = scrollX / pixelsPerSecond;
+  const double visibleEnd = (scrollX + area.getWidth()) / pixelsPerSecond;
+  const auto [aheadStart, aheadEnd] =
+      motion.getScrollAhead(visibleStart, visibleEnd);
+  if (aheadEnd > aheadStart)
+    prefetch(bucket, aheadStart, aheadEnd);
+  if (motion.isZooming()) {
+    int nextBucket = bucketFor(
+        static_cast<float>(motion.getZoomAhead(pixelsPerSecond)));
+    if (nextBucket == bucket)
+      nextBucket += motion.zoomOctavesPerSecond > 0.0 ? 1 : -1;
+    // Zooming out shows more either side of the current view
+    const double spread =
+        std::max(0.0, pixelsPerSecond / bucketPixelsPerSecond(nextBucket) - 1.0) *
+        (visibleEnd - visibleStart) * 0.5;
+    prefetch(nextBucket, visibleStart - spread, visibleEnd + spread);
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    // Skip the tile being rendered; it arrives anyway
+    wanted.erase(std::remove_if(wanted.begin(), wanted.end(),
+                                [this](const Job &job) {
+                                  return job.key == inFlight;
+                                }),
+                 wanted.end());
+    jobs = std::move(wanted);
+  }
+  wakeWorker.notify_all();
+  evictIfNeeded();
+}
+
+void WaveformTileCache::evictIfNeeded() {
+  while (tiles.size() > maxTiles) {
+    auto oldest = std::min_element(
+        tiles.begin(), tiles.end(), [](const auto &a, const auto &b) {
+          return a.second.lastDrawn < b.second.lastDrawn;
+        });
+    tiles.erase(oldest);
+  }
+}
+
+juce::Image WaveformTileCache::renderTile(const Job &job) {
+  const auto &source = *job.snapshot;
+  const double bucketRate = bucketPixelsPerSecond(job.key.first);
+  const double samplesPerPixel = source.getSampleRate() / bucketRate;
+  const int numSamples = source.getNumSamples();
+
+  // Software image: rendered off the message thread
+  juce::Image image(juce::Image::ARGB, tileWidth, job.height, true,
+                    juce::SoftwareImageType());
+  juce::Graphics g(image);
+
+  const float height = static_cast<float>(job.height);
+  const float centerY = height * 0.5f;
+  const float waveformHeight = height * 0.8f;
+
+  std::vector<float> peaks(tileWidth, 0.0f);
+  std::vector<float> scratch;
+  for (int px = 0; px < tileWidth; ++px) {
+    const double x = static_cast<double>(job.key.second) * tileWidth + px;
+    int startSample = static_cast<int>(x * samplesPerPixel);
+    int endSample = static_cast<int>((x + 1.0) * samplesPerPixel);
+    if (startSample >= numSamples)
+      break;
+    endSample = std::max(startSample + 1, std::min(endSample, numSamples));
+
+    if (job.pyramid) {
+      peaks[static_cast<size_t>(px)] =
+          job.pyramid->getPeak(startSample, endSample).getMagnitude();
+      continue;
+    }
+    scratch.resize(static_cast<size_t>(endSample - startSample));
+    source.read(0, startSample, endSample - startSample, scratch.data());
+    float maxVal = 0.0f;
+    for (float sample : scratch)
+      maxVal = std::max(maxVal, std::abs(sample));
+    peaks[static_cast<size_t>(px)] = maxVal;
+  }
+
+  juce::Path path;
+  path.startNewSubPath(0.0f, centerY);
+  for (int px = 0; px < tileWidth; ++px)
+    path.lineTo(static_cast<float>(px),
+                centerY - peaks[static_cast<size_t>(px)] * waveformHeight * 0.5f);
+  for (int px = tileWidth - 1; px >= 0; --px)
+    path.lineTo(static_cast<float>(px),
+                centerY + peaks[static_cast<size_t>(px)] * waveformHeight * 0.5f);
+  path.closeSubPath();
+
+  g.setColour(job.colour);
+  g.fillPath(path);
+  return image;
+}
+
+void WaveformTileCache::workerLoop() {
+  std::unique_lock<std::mutex> lock(mutex);
+  while (!stopWorker) {
+    if (jobs.empty()) {
+      wakeWorker.wait(lock);
+      continue;
+    }
+
+    Job job = std::move(jobs.front());
+    jobs.erase(jobs.begin());
+    inFlight = job.key;
+    lock.unlock();
+
+    auto image = renderTile(job);
+    juce::MessageManager::callAsync(
+        [this, token = alive, job = std::move(job),
+         image = std::move(image)]() {
+          if (!token->load() || job.height != tileHeight ||
+              job.colour != tileColour)
+            return;
+          // A later setSnapshot() may have superseded it; still better than
+          // an empty tile
+          auto &tile = tiles[job.key];
+          if (tile.image.isValid() && job.generation != snapshotGeneration)
+            return;
+          tile.image = image;
+          tile.generation = job.generation;
+          tile.lastDrawn = drawCounter;
+          if (onTileReady)
+            onTileReady();
+        });
+
+    lock.lock();
+    inFlight = {0, -1};
+  }
+}
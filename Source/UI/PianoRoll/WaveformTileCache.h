@@ -0,0 +1,108 @@
+#pragma once
+
+#include "../../JuceHeader.h"
+#include "../../Utils/PeakPyramid.h"
+#include "../../Utils/RenderSnapshot.h"
+#include "ViewMotion.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/**
+ * Background waveform of the piano roll, as fixed-width image tiles.
+ *
+ * Tiles are keyed by zoom bucket and tile index and rendered on a worker
+ * thread from an immutable RenderSnapshot, so scrolling only blits the tiles
+ * in view at a sub-pixel offset, and zooming within a bucket scales them.
+ * A new render keeps the tiles whose samples it shares with the previous
+ * one; the others keep showing until their replacement is ready.
+ *
+ * Message thread only, apart from the worker.
+ */
+class WaveformTileCache {
+public:
+  static constexpr int tileWidth = 256;
+
+  WaveformTileCache();
+  ~WaveformTileCache();
+
+  // Called on the message thread when a requested tile has been rendered
+  std::function<void()> onTileReady;
+
+  void setSnapshot(RenderSnapshot::Ptr snapshot);
+  void clear();
+
+  // After the visible tiles, draw() queues what this motion reveals next
+  void setMotion(const ViewMotion &newMotion) { motion = newMotion; }
+
+  // Draw area's waveform with its left edge at world x scrollX
+  void draw(juce::Graphics &g, const juce::Rectangle<int> &area,
+            double scrollX, float pixelsPerSecond, juce::Colour colour);
+
+  // Running totals of visible tiles drawn current, and missing or stale
+  uint64_t getHits() const { return hits; }
+  uint64_t getMisses() const { return misses; }
+
+private:
+  // At most this many tiles are kept, least recently drawn dropped first
+  static constexpr size_t maxTiles = 48;
+  // Bucket pixel rates are 2^(k / bucketsPerOctave)
+  static constexpr int bucketsPerOctave = 16;
+
+  using TileKey = std::pair<int, int64_t>; // Zoom bucket, tile index
+
+  struct Tile {
+    juce::Image image;
+    uint64_t generation = 0; // Current if == snapshotGeneration
+    uint64_t lastDrawn = 0;
+  };
+
+  struct Job {
+    TileKey key;
+    RenderSnapshot::Ptr snapshot;
+    PeakPyramid::Ptr pyramid; // Of snapshot, or null to scan its samples
+    uint64_t generation = 0;
+    int height = 0;
+    juce::Colour colour;
+  };
+
+  static int bucketFor(float pixelsPerSecond);
+  static double bucketPixelsPerSecond(int bucket);
+  // Worker: the tile's peaks filled as one path
+  static juce::Image renderTile(const Job &job);
+
+  void workerLoop();
+  void evictIfNeeded();
+
+  RenderSnapshot::Ptr snapshot;
+  uint64_t snapshotGeneration = 1;
+  ViewMotion motion;
+  std::map<TileKey, Tile> tiles;
+  int tileHeight = 0;
+  juce::Colour tileColour;
+  uint64_t drawCounter = 0;
+  uint64_t hits = 0;
+  uint64_t misses = 0;
+  juce::SharedResourcePointer<PeakPyramidService> pyramids;
+
+  // Guarded by mutex: jobs not started yet, replaced by every draw(), and
+  // the one the worker is rendering
+  std::vector<Job> jobs;
+  TileKey inFlight{0, -1};
+  std::mutex mutex;
+  std::condition_variable wakeWorker;
+  bool stopWorker = false;
+  // Cleared on destruction so finished tiles are not delivered after it
+  std::shared_ptr<std::atomic<bool>> alive =
+      std::make_shared<std::atomic<bool>>(true);
+  std::thread worker; // Last: starts in the constructor
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(WaveformTileCache)
+};
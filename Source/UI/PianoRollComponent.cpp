@@ -1,14 +1,19 @@
 #include "PianoRollComponent.h"
+#include "../Utils/AppLogger.h"
 #include "../Utils/BasePitchCurve.h"
 #include "../Utils/CenteredMelSpectrogram.h"
 #include "../Utils/CurveResampler.h"
+#include "../Utils/NoteBulkEdit.h"
+#include "PianoRoll/CurvePathBuilder.h"
 #include "../Utils/Constants.h"
 #include "../Utils/UI/TimecodeFont.h"
 #include "../Utils/UI/Theme.h"
 #include "../Utils/PitchCurveProcessor.h"
+#include "../Utils/Tracing.h"
 #include <algorithm>
 #include <cmath>
 #include <limits>
+#include <utility>
 
 PianoRollComponent::PianoRollComponent() {
   // Initialize modular components
@@ -23,6 +28,10 @@ PianoRollComponent::PianoRollComponent() {
 
   // Wire up components
   renderer->setCoordinateMapper(coordMapper.get());
+  renderer->setWaveformTileCallback([this]() { repaint(); });
+  noteThumbnails.onThumbnailReady = [this]() { repaint(); };
+  spectrogramTiles.onTileReady = [this]() { repaint(); };
+  paintStats.onUpdated = [this]() { repaint(getPaintStatsArea()); };
   scrollZoomController->setCoordinateMapper(coordMapper.get());
   pitchEditor->setCoordinateMapper(coordMapper.get());
   noteSplitter->setCoordinateMapper(coordMapper.get());
@@ -52,8 +61,9 @@ PianoRollComponent::PianoRollComponent() {
     if (onPitchEditFinished)
       onPitchEditFinished();
   };
-  pitchEditor->onBasePitchCacheInvalidated = [this]() {
-    invalidateBasePitchCache();
+  pitchEditor->onBasePitchCacheInvalidated = [this](int startFrame,
+                                                    int endFrame) {
+    invalidateBasePitchCache(startFrame, endFrame);
   };
 
   // Setup noteSplitter callbacks
@@ -96,10 +106,30 @@ PianoRollComponent::PianoRollComponent() {
 }
 
 PianoRollComponent::~PianoRollComponent() {
+  setGpuRendering(false);
   horizontalScrollBar.removeListener(this);
   verticalScrollBar.removeListener(this);
 }
 
+void PianoRollComponent::setGpuRendering(bool enabled) {
+#ifdef HACHITUNE_OPENGL
+  if (enabled == gpuRendering)
+    return;
+  gpuRendering = enabled;
+  if (enabled) {
+    // Repaints stay on demand: only invalidated frames are drawn
+    openGLContext.setContinuousRepainting(false);
+    openGLContext.attachTo(*this);
+  } else {
+    openGLContext.detach();
+  }
+  layerCache = {};
+  repaint();
+#else
+  juce::ignoreUnused(enabled);
+#endif
+}
+
 int PianoRollComponent::getVisibleContentWidth() const {
   return std::max(0, getWidth() - pianoKeysWidth - 14);
 }
@@ -109,12 +139,83 @@ int PianoRollComponent::getVisibleContentHeight() const {
 }
 
 void PianoRollComponent::paint(juce::Graphics &g) {
+  TRACE_ZONE("PianoRollComponent::paint");
+  // Every content change repaints the whole component, so a full paint
+  // rebuilds the layers and a partial one is only an overlay moving
+  const bool fullPaint = g.getClipBounds().contains(getLocalBounds());
+  paintStats.beginPaint(fullPaint);
+
   // Apply rounded corner clipping
   const float cornerRadius = 8.0f;
   juce::Path clipPath;
   clipPath.addRoundedRectangle(getLocalBounds().toFloat(), cornerRadius);
   g.reduceClipRegion(clipPath);
 
+  if (gpuRendering) {
+    // The GPU draws the layers faster than an image of them would upload
+    paintLayers(g);
+  } else {
+    const float scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+    const int cacheWidth = juce::roundToInt(getWidth() * scale);
+    const int cacheHeight = juce::roundToInt(getHeight() * scale);
+    if (cacheWidth <= 0 || cacheHeight <= 0)
+      return;
+    if (fullPaint || layerCacheScale != scale ||
+        layerCache.getWidth() != cacheWidth ||
+        layerCache.getHeight() != cacheHeight) {
+      if (layerCache.getWidth() != cacheWidth ||
+          layerCache.getHeight() != cacheHeight)
+        layerCache = juce::Image(juce::Image::ARGB, cacheWidth, cacheHeight,
+                                 false);
+      layerCacheScale = scale;
+      juce::Graphics layers(layerCache);
+      layers.addTransform(juce::AffineTransform::scale(scale));
+      paintLayers(layers);
+    }
+    g.drawImageTransformed(layerCache,
+                           juce::AffineTransform::scale(1.0f / scale));
+  }
+
+  constexpr int scrollBarSize = 8;
+  auto mainArea = getLocalBounds()
+                      .withTrimmedLeft(pianoKeysWidth)
+                      .withTrimmedTop(headerHeight)
+                      .withTrimmedBottom(scrollBarSize)
+                      .withTrimmedRight(scrollBarSize);
+  paintStats.time(PaintStats::Overlays, [&] {
+    {
+      juce::Graphics::ScopedSaveState saveState(g);
+      g.reduceClipRegion(mainArea);
+      g.setOrigin(pianoKeysWidth - static_cast<int>(scrollX),
+                  headerHeight - static_cast<int>(scrollY));
+      drawSplitGuide(g);
+      drawSelectionRect(g);
+    }
+
+    {
+      // Under the piano keys, as when it was drawn before them
+      juce::Graphics::ScopedSaveState saveState(g);
+      g.excludeClipRegion(juce::Rectangle<int>(0, headerHeight, pianoKeysWidth,
+                                               getHeight() - headerHeight));
+      drawPlayhead(g);
+    }
+  });
+
+  if (paintStats.isEnabled()) {
+    const auto &tiles = renderer->getWaveformTiles();
+    paintStats.setWaveformTileCounters({tiles.getHits(), tiles.getMisses()});
+    paintStats.endPaint();
+    paintStats.draw(g, mainArea);
+  }
+}
+
+void PianoRollComponent::paintLayers(juce::Graphics &g) {
+  // The caches render ahead of the view's motion
+  scrollZoomController->trackView(scrollX, pixelsPerSecond);
+  const auto &motion = scrollZoomController->getMotion();
+  renderer->setViewMotion(motion);
+  spectrogramTiles.setMotion(motion);
+
   // Background (solid to keep grid clean)
   g.fillAll(APP_COLOR_BACKGROUND);
 
@@ -132,7 +233,8 @@ void PianoRollComponent::paint(juce::Graphics &g) {
   {
     juce::Graphics::ScopedSaveState saveState(g);
     g.reduceClipRegion(mainArea);
-    drawBackgroundWaveform(g, mainArea);
+    paintStats.time(PaintStats::Waveform,
+                    [&] { drawBackgroundWaveform(g, mainArea); });
   }
 
   // Draw scrolled content (grid, notes, pitch curves)
@@ -142,45 +244,51 @@ void PianoRollComponent::paint(juce::Graphics &g) {
     g.setOrigin(pianoKeysWidth - static_cast<int>(scrollX),
                 headerHeight - static_cast<int>(scrollY));
 
-    drawGrid(g);
-    drawLoopOverlay(g);
-    drawNotes(g);
-    drawStretchGuides(g);
-    drawPitchCurves(g);
-    drawSelectionRect(g);
+    paintStats.time(PaintStats::Spectrogram, [&] { drawSpectrogram(g); });
+    paintStats.time(PaintStats::Grid, [&] { drawGrid(g); });
+    paintStats.time(PaintStats::Notes, [&] {
+      drawLoopOverlay(g);
+      drawNotes(g);
+      drawStretchGuides(g);
+    });
+    paintStats.time(PaintStats::Curves, [&] { drawPitchCurves(g); });
   }
 
   // Draw timeline (above grid, scrolls horizontally)
-  drawTimeline(g);
-  drawLoopTimeline(g);
+  paintStats.time(PaintStats::Timeline, [&] {
+    drawTimeline(g);
+    drawLoopTimeline(g);
+  });
 
-  // Draw unified cursor line (spans from timeline through grid)
-  {
-    float x = static_cast<float>(pianoKeysWidth) + timeToX(cursorTime) -
-              static_cast<float>(scrollX);
-    float cursorTop = 0.0f;
-    float cursorBottom =
-        static_cast<float>(getHeight() - scrollBarSize); // Exclude scrollbar
+  // Draw piano keys
+  paintStats.time(PaintStats::Keys, [&] { drawPianoKeys(g); });
+}
 
-    // Only draw if cursor is in visible area
-    if (x >= pianoKeysWidth && x < getWidth() - scrollBarSize) {
-      g.setColour(APP_COLOR_PRIMARY);
-      g.fillRect(x - 0.5f, cursorTop, 1.0f, cursorBottom);
+void PianoRollComponent::drawPlayhead(juce::Graphics &g) {
+  constexpr int scrollBarSize = 8;
 
-      // Draw triangle playhead indicator at top of timeline
-      constexpr float triangleWidth = 10.0f;
-      constexpr float triangleHeight = 8.0f;
-      juce::Path triangle;
-      triangle.addTriangle(x - triangleWidth * 0.5f, 0.0f, // Top-left
-                           x + triangleWidth * 0.5f, 0.0f, // Top-right
-                           x, triangleHeight // Bottom-center (pointing down)
-      );
-      g.fillPath(triangle);
-    }
+  // Draw unified cursor line (spans from timeline through grid)
+  float x = static_cast<float>(pianoKeysWidth) + timeToX(cursorTime) -
+            static_cast<float>(scrollX);
+  float cursorTop = 0.0f;
+  float cursorBottom =
+      static_cast<float>(getHeight() - scrollBarSize); // Exclude scrollbar
+
+  // Only draw if cursor is in visible area
+  if (x >= pianoKeysWidth && x < getWidth() - scrollBarSize) {
+    g.setColour(APP_COLOR_PRIMARY);
+    g.fillRect(x - 0.5f, cursorTop, 1.0f, cursorBottom);
+
+    // Draw triangle playhead indicator at top of timeline
+    constexpr float triangleWidth = 10.0f;
+    constexpr float triangleHeight = 8.0f;
+    juce::Path triangle;
+    triangle.addTriangle(x - triangleWidth * 0.5f, 0.0f, // Top-left
+                         x + triangleWidth * 0.5f, 0.0f, // Top-right
+                         x, triangleHeight // Bottom-center (pointing down)
+    );
+    g.fillPath(triangle);
   }
-
-  // Draw piano keys
-  drawPianoKeys(g);
 }
 
 void PianoRollComponent::resized() {
@@ -200,92 +308,44 @@ void PianoRollComponent::resized() {
 
 void PianoRollComponent::drawBackgroundWaveform(
     juce::Graphics &g, const juce::Rectangle<int> &visibleArea) {
-  if (!project)
-    return;
-
-  const auto &audioData = project->getAudioData();
-  if (audioData.waveform.getNumSamples() == 0)
-    return;
-
-  // Check if we can use cached waveform
-  bool cacheValid = waveformCache.isValid() &&
-                    std::abs(cachedScrollX - scrollX) < 1.0 &&
-                    std::abs(cachedPixelsPerSecond - pixelsPerSecond) < 0.01f &&
-                    cachedWidth == visibleArea.getWidth() &&
-                    cachedHeight == visibleArea.getHeight();
-
-  if (cacheValid) {
-    g.drawImageAt(waveformCache, visibleArea.getX(), visibleArea.getY());
-    return;
-  }
-
-  // Render waveform to cache
-  waveformCache = juce::Image(juce::Image::ARGB, visibleArea.getWidth(),
-                              visibleArea.getHeight(), true);
-  juce::Graphics cacheGraphics(waveformCache);
-
-  const float *samples = audioData.waveform.getReadPointer(0);
-  int numSamples = audioData.waveform.getNumSamples();
-
-  // Draw waveform filling the visible area height
-  float visibleHeight = static_cast<float>(visibleArea.getHeight());
-  float centerY = visibleHeight * 0.5f;
-  float waveformHeight = visibleHeight * 0.8f;
-
-  juce::Path waveformPath;
-  int visibleWidth = visibleArea.getWidth();
-
-  waveformPath.startNewSubPath(0.0f, centerY);
-
-  // Draw only the visible portion
-  for (int px = 0; px < visibleWidth; ++px) {
-    double time = (scrollX + px) / pixelsPerSecond;
-    int startSample = static_cast<int>(time * SAMPLE_RATE);
-    int endSample =
-        static_cast<int>((time + 1.0 / pixelsPerSecond) * SAMPLE_RATE);
-
-    startSample = std::max(0, std::min(startSample, numSamples - 1));
-    endSample = std::max(startSample + 1, std::min(endSample, numSamples));
-
-    float maxVal = 0.0f;
-    for (int i = startSample; i < endSample; ++i)
-      maxVal = std::max(maxVal, std::abs(samples[i]));
-
-    float y = centerY - maxVal * waveformHeight * 0.5f;
-    waveformPath.lineTo(static_cast<float>(px), y);
-  }
-
-  // Bottom half (reverse)
-  for (int px = visibleWidth - 1; px >= 0; --px) {
-    double time = (scrollX + px) / pixelsPerSecond;
-    int startSample = static_cast<int>(time * SAMPLE_RATE);
-    int endSample =
-        static_cast<int>((time + 1.0 / pixelsPerSecond) * SAMPLE_RATE);
-
-    startSample = std::max(0, std::min(startSample, numSamples - 1));
-    endSample = std::max(startSample + 1, std::min(endSample, numSamples));
-
-    float maxVal = 0.0f;
-    for (int i = startSample; i < endSample; ++i)
-      maxVal = std::max(maxVal, std::abs(samples[i]));
+  // Tiled and rendered off the message thread; see WaveformTileCache
+  renderer->drawBackgroundWaveform(g, visibleArea, scrollX, pixelsPerSecond);
+}
 
-    float y = centerY + maxVal * waveformHeight * 0.5f;
-    waveformPath.lineTo(static_cast<float>(px), y);
-  }
+void PianoRollComponent::setShowSpectrogram(bool show) {
+  showSpectrogram = show;
+  if (!show)
+    spectrogramTiles.clear();
+  repaint();
+}
 
-  waveformPath.closeSubPath();
+void PianoRollComponent::setShowPaintStats(bool show) {
+  paintStats.setEnabled(show);
+  repaint(getPaintStatsArea());
+}
 
-  cacheGraphics.setColour(APP_COLOR_WAVEFORM);
-  cacheGraphics.fillPath(waveformPath);
+void PianoRollComponent::logPaintStats() const {
+  LOG("Piano roll paint stats:\n  " +
+      paintStats.getReport().joinIntoString("\n  "));
+}
 
-  // Update cache metadata
-  cachedScrollX = scrollX;
-  cachedPixelsPerSecond = pixelsPerSecond;
-  cachedWidth = visibleArea.getWidth();
-  cachedHeight = visibleArea.getHeight();
+juce::Rectangle<int> PianoRollComponent::getPaintStatsArea() const {
+  constexpr int scrollBarSize = 8;
+  return paintStats.getOverlayBounds(getLocalBounds()
+                                         .withTrimmedLeft(pianoKeysWidth)
+                                         .withTrimmedTop(headerHeight)
+                                         .withTrimmedBottom(scrollBarSize)
+                                         .withTrimmedRight(scrollBarSize));
+}
 
-  // Draw cached image
-  g.drawImageAt(waveformCache, visibleArea.getX(), visibleArea.getY());
+void PianoRollComponent::drawSpectrogram(juce::Graphics &g) {
+  if (!showSpectrogram || !project)
+    return;
+  // Tiled and rendered off the message thread; see SpectrogramTileCache
+  constexpr int scrollBarSize = 8;
+  spectrogramTiles.draw(g, project->getAudioData().melSpectrogram, scrollX,
+                        getWidth() - pianoKeysWidth - scrollBarSize,
+                        pixelsPerSecond, pixelsPerSemitone);
 }
 
 void PianoRollComponent::drawGrid(juce::Graphics &g) {
@@ -402,7 +462,7 @@ void PianoRollComponent::drawTimeline(juce::Graphics &g) {
   float duration = project ? project->getAudioData().getDuration() : 60.0f;
 
   // Draw ticks and labels
-  g.setFont(TimecodeFont::getBoldFont(12.0f));
+  const auto labelFont = TimecodeFont::getBoldFont(12.0f);
 
   for (float time = 0.0f; time <= duration + secondsPerTick;
        time += secondsPerTick) {
@@ -436,8 +496,10 @@ void PianoRollComponent::drawTimeline(juce::Graphics &g) {
         label = juce::String::formatted("%ds", seconds);
 
       g.setColour(APP_COLOR_TEXT_MUTED);
-      g.drawText(label, static_cast<int>(x) + 3, 2, 50, timelineHeight - 4,
-                 juce::Justification::centredLeft, false);
+      glyphs.draw(g, label, labelFont,
+                  juce::Rectangle<float>(std::floor(x) + 3.0f, 2.0f, 50.0f,
+                                         static_cast<float>(timelineHeight - 4)),
+                  juce::Justification::centredLeft);
     }
   }
 }
@@ -527,28 +589,23 @@ void PianoRollComponent::drawNotes(juce::Graphics &g) {
     return;
 
   const auto &audioData = project->getAudioData();
-  const float *globalSamples = audioData.waveform.getNumSamples() > 0
-                                   ? audioData.waveform.getReadPointer(0)
-                                   : nullptr;
-  int globalTotalSamples = audioData.waveform.getNumSamples();
+  const int totalSamples = audioData.waveform.getNumSamples();
+  const auto snapshot =
+      totalSamples > 0 ? audioData.getRenderSnapshot() : nullptr;
 
   // Calculate visible time range for culling
   double visibleStartTime = scrollX / pixelsPerSecond;
   double visibleEndTime = (scrollX + getWidth()) / pixelsPerSecond;
 
-  for (auto &note : project->getNotes()) {
-    // Skip rest notes (they have no pitch)
-    if (note.isRest())
-      continue;
-
-    // Viewport culling: skip notes outside visible area
-    double noteStartTime = framesToSeconds(note.getStartFrame());
-    double noteEndTime = framesToSeconds(note.getEndFrame());
-    if (noteEndTime < visibleStartTime || noteStartTime > visibleEndTime)
-      continue;
+  // One frame of slack either side covers the inclusive time test below
+  const auto visibleNotes = project->getNotesInRange(
+      secondsToFrames(static_cast<float>(visibleStartTime)) - 1,
+      secondsToFrames(static_cast<float>(visibleEndTime)) + 2);
 
-    float x = static_cast<float>(noteStartTime * pixelsPerSecond);
-    float w = framesToSeconds(note.getDurationFrames()) * pixelsPerSecond;
+  // Note body at a horizontal zoom, in world coordinates
+  auto boundsAt = [this](const Note &note, float pps) {
+    float x = static_cast<float>(framesToSeconds(note.getStartFrame()) * pps);
+    float w = framesToSeconds(note.getDurationFrames()) * pps;
     float h = pixelsPerSemitone;
 
     // Position at grid cell center for MIDI note, then offset by pitch
@@ -557,229 +614,62 @@ void PianoRollComponent::drawNotes(juce::Graphics &g) {
         midiToY(note.getMidiNote()) + pixelsPerSemitone * 0.5f;
     float pitchOffsetPixels = -note.getPitchOffset() * pixelsPerSemitone;
     float y = baseGridCenterY + pitchOffsetPixels - h * 0.5f;
+    return juce::Rectangle<float>(x, y, w, h);
+  };
 
-    // Note color based on pitch
-    juce::Colour noteColor = note.isSelected()
-                                 ? APP_COLOR_NOTE_SELECTED
-                                 : APP_COLOR_NOTE_NORMAL;
-
-    const float *samples = globalSamples;
-    int totalSamples = globalTotalSamples;
-    int startSample = 0;
-    int endSample = 0;
-    const auto &clipWaveform = note.getClipWaveform();
-    if (!clipWaveform.empty()) {
-      samples = clipWaveform.data();
-      totalSamples = static_cast<int>(clipWaveform.size());
-      startSample = 0;
-      endSample = totalSamples;
-    } else if (samples && totalSamples > 0) {
-      startSample = static_cast<int>(framesToSeconds(note.getStartFrame()) *
-                                     audioData.sampleRate);
-      endSample = static_cast<int>(framesToSeconds(note.getEndFrame()) *
-                                   audioData.sampleRate);
+  // The note's own clip, else its range of the current render
+  auto clipOf = [&](const Note &note) {
+    WaveformClip clip = note.getClipWaveform();
+    if (clip.empty() && snapshot) {
+      int startSample = static_cast<int>(
+          framesToSeconds(note.getStartFrame()) * audioData.sampleRate);
+      int endSample = static_cast<int>(framesToSeconds(note.getEndFrame()) *
+                                       audioData.sampleRate);
       startSample = std::max(0, std::min(startSample, totalSamples - 1));
-      endSample = std::max(startSample + 1,
-                           std::min(endSample, totalSamples));
+      endSample = std::max(startSample + 1, std::min(endSample, totalSamples));
+      clip = WaveformClip(snapshot, startSample, endSample);
     }
+    return clip;
+  };
 
-    if (samples && totalSamples > 0 && w > 2.0f &&
-        endSample > startSample) {
-      // Draw waveform slice inside note
-      int numNoteSamples = endSample - startSample;
-      int samplesPerPixel = std::max(1, static_cast<int>(numNoteSamples / w));
-
-      float centerY = y + h * 0.5f;
-      float waveHeight = h * 3.0f;
-
-      // Build waveform data with increased resolution for smoother curves
-      std::vector<float> waveValues;
-      // Increase point density for smoother curves (up to 800 points)
-      float step = std::max(0.5f, w / 1024.0f);
-
-      for (float px = 0; px <= w; px += step) {
-        int sampleIdx =
-            startSample + static_cast<int>((px / w) * numNoteSamples);
-        int sampleEnd = std::min(sampleIdx + samplesPerPixel, endSample);
-
-        float maxVal = 0.0f;
-        for (int i = sampleIdx; i < sampleEnd; ++i)
-          maxVal = std::max(maxVal, std::abs(samples[i]));
-
-        waveValues.push_back(maxVal);
-      }
-
-      // Apply smoothing filter to reduce aliasing artifacts
-      if (waveValues.size() > 2) {
-        std::vector<float> smoothed(waveValues.size());
-        smoothed[0] = waveValues[0];
-        for (size_t i = 1; i + 1 < waveValues.size(); ++i) {
-          // Simple 3-point moving average for gentle smoothing
-          smoothed[i] = (waveValues[i - 1] * 0.25f + waveValues[i] * 0.5f +
-                         waveValues[i + 1] * 0.25f);
-        }
-        smoothed[waveValues.size() - 1] = waveValues[waveValues.size() - 1];
-        waveValues = std::move(smoothed);
-      }
-
-      size_t numPoints = waveValues.size();
-      if (numPoints < 2) {
-        // Fallback for very short notes
-        g.setColour(noteColor.withAlpha(0.85f));
-        g.fillRoundedRectangle(x, y, std::max(w, 4.0f), h, 2.0f);
-      } else {
-        // Helper function for Catmull-Rom spline interpolation
-        auto catmullRom = [](float t, float p0, float p1, float p2,
-                             float p3) -> float {
-          // Catmull-Rom spline: smooth interpolation between p1 and p2
-          float t2 = t * t;
-          float t3 = t2 * t;
-          return 0.5f * ((2.0f * p1) + (-p0 + p2) * t +
-                         (2.0f * p0 - 5.0f * p1 + 4.0f * p2 - p3) * t2 +
-                         (-p0 + 3.0f * p1 - 3.0f * p2 + p3) * t3);
-        };
-
-        // Draw filled waveform using smooth curves
-        g.setColour(noteColor.withAlpha(0.85f));
-        juce::Path waveformPath;
-
-        // Build top curve with Catmull-Rom spline
-        waveformPath.startNewSubPath(x, centerY -
-                                            waveValues[0] * waveHeight * 0.5f);
-
-        // Use cubic curves for smooth interpolation
-        const int curveSegments = 4; // Interpolate 4 points between each pair
-        for (size_t i = 0; i + 1 < numPoints; ++i) {
-          float px1 =
-              (static_cast<float>(i) / static_cast<float>(numPoints - 1)) * w;
-          float px2 =
-              (static_cast<float>(i + 1) / static_cast<float>(numPoints - 1)) *
-              w;
-
-          // Get control points for spline
-          size_t idx0 = (i > 0) ? i - 1 : i;
-          size_t idx1 = i;
-          size_t idx2 = i + 1;
-          size_t idx3 = (i + 2 < numPoints) ? i + 2 : i + 1;
-
-          float val0 = waveValues[idx0];
-          float val1 = waveValues[idx1];
-          float val2 = waveValues[idx2];
-          float val3 = waveValues[idx3];
-
-          // Draw smooth curve segment
-          for (int seg = 1; seg <= curveSegments; ++seg) {
-            float t =
-                static_cast<float>(seg) / static_cast<float>(curveSegments);
-            float px = px1 + (px2 - px1) * t;
-            float val = catmullRom(t, val0, val1, val2, val3);
-            float yPos = centerY - val * waveHeight * 0.5f;
-            waveformPath.lineTo(x + px, yPos);
-          }
-        }
+  auto colourOf = [](const Note &note) {
+    return note.isSelected() ? APP_COLOR_NOTE_SELECTED : APP_COLOR_NOTE_NORMAL;
+  };
 
-        // Build bottom curve (mirror of top)
-        waveformPath.lineTo(x + w, centerY + waveValues[numPoints - 1] *
-                                                 waveHeight * 0.5f);
-
-        for (int i = static_cast<int>(numPoints) - 2; i >= 0; --i) {
-          float px1 =
-              (static_cast<float>(i + 1) / static_cast<float>(numPoints - 1)) *
-              w;
-          float px2 =
-              (static_cast<float>(i) / static_cast<float>(numPoints - 1)) * w;
-
-          size_t idx0 = (i + 2 < numPoints) ? i + 2 : i + 1;
-          size_t idx1 = i + 1;
-          size_t idx2 = i;
-          size_t idx3 = (i > 0) ? i - 1 : i;
-
-          float val0 = waveValues[idx0];
-          float val1 = waveValues[idx1];
-          float val2 = waveValues[idx2];
-          float val3 = waveValues[idx3];
-
-          for (int seg = 1; seg <= curveSegments; ++seg) {
-            float t =
-                static_cast<float>(seg) / static_cast<float>(curveSegments);
-            float px = px1 + (px2 - px1) * t;
-            float val = catmullRom(t, val0, val1, val2, val3);
-            float yPos = centerY + val * waveHeight * 0.5f;
-            waveformPath.lineTo(x + px, yPos);
-          }
-        }
+  const auto &motion = scrollZoomController->getMotion();
+  const float zoomAhead =
+      motion.isZooming()
+          ? static_cast<float>(motion.getZoomAhead(pixelsPerSecond))
+          : pixelsPerSecond;
 
-        waveformPath.closeSubPath();
-        g.fillPath(waveformPath);
-
-        // Draw smooth outline with anti-aliasing
-        juce::Path outline;
-        outline.startNewSubPath(x, centerY - waveValues[0] * waveHeight * 0.5f);
-
-        // Top curve
-        for (size_t i = 0; i + 1 < numPoints; ++i) {
-          float px1 =
-              (static_cast<float>(i) / static_cast<float>(numPoints - 1)) * w;
-          float px2 =
-              (static_cast<float>(i + 1) / static_cast<float>(numPoints - 1)) *
-              w;
-
-          size_t idx0 = (i > 0) ? i - 1 : i;
-          size_t idx1 = i;
-          size_t idx2 = i + 1;
-          size_t idx3 = (i + 2 < numPoints) ? i + 2 : i + 1;
-
-          float val0 = waveValues[idx0];
-          float val1 = waveValues[idx1];
-          float val2 = waveValues[idx2];
-          float val3 = waveValues[idx3];
-
-          for (int seg = 1; seg <= curveSegments; ++seg) {
-            float t =
-                static_cast<float>(seg) / static_cast<float>(curveSegments);
-            float px = px1 + (px2 - px1) * t;
-            float val = catmullRom(t, val0, val1, val2, val3);
-            float yPos = centerY - val * waveHeight * 0.5f;
-            outline.lineTo(x + px, yPos);
-          }
-        }
+  for (auto *notePtr : visibleNotes) {
+    auto &note = *notePtr;
+    // Skip rest notes (they have no pitch)
+    if (note.isRest())
+      continue;
 
-        // Bottom curve
-        for (int i = static_cast<int>(numPoints) - 2; i >= 0; --i) {
-          float px1 =
-              (static_cast<float>(i + 1) / static_cast<float>(numPoints - 1)) *
-              w;
-          float px2 =
-              (static_cast<float>(i) / static_cast<float>(numPoints - 1)) * w;
-
-          size_t idx0 = (i + 2 < numPoints) ? i + 2 : i + 1;
-          size_t idx1 = i + 1;
-          size_t idx2 = i;
-          size_t idx3 = (i > 0) ? i - 1 : i;
-
-          float val0 = waveValues[idx0];
-          float val1 = waveValues[idx1];
-          float val2 = waveValues[idx2];
-          float val3 = waveValues[idx3];
-
-          for (int seg = 1; seg <= curveSegments; ++seg) {
-            float t =
-                static_cast<float>(seg) / static_cast<float>(curveSegments);
-            float px = px1 + (px2 - px1) * t;
-            float val = catmullRom(t, val0, val1, val2, val3);
-            float yPos = centerY + val * waveHeight * 0.5f;
-            outline.lineTo(x + px, yPos);
-          }
-        }
+    // Viewport culling: skip notes outside visible area
+    double noteStartTime = framesToSeconds(note.getStartFrame());
+    double noteEndTime = framesToSeconds(note.getEndFrame());
+    if (noteEndTime < visibleStartTime || noteStartTime > visibleEndTime)
+      continue;
 
-        outline.closeSubPath();
-        g.setColour(noteColor.brighter(0.2f));
-        // Use slightly thicker stroke with anti-aliasing for smoother
-        // appearance
-        g.strokePath(outline,
-                     juce::PathStrokeType(1.2f, juce::PathStrokeType::curved,
-                                          juce::PathStrokeType::rounded));
-      }
+    const auto bounds = boundsAt(note, pixelsPerSecond);
+    const float x = bounds.getX();
+    const float y = bounds.getY();
+    const float w = bounds.getWidth();
+    const float h = bounds.getHeight();
+    const juce::Colour noteColor = colourOf(note);
+    const WaveformClip clip = clipOf(note);
+
+    // The width a zoom is heading for
+    if (zoomAhead != pixelsPerSecond && !clip.empty())
+      noteThumbnails.prefetch(clip, boundsAt(note, zoomAhead), noteColor);
+
+    if (!clip.empty() && w > 2.0f) {
+      // Cached off the message thread; drawn directly until the image exists
+      if (!noteThumbnails.draw(g, clip, bounds, noteColor))
+        NoteThumbnailCache::drawWaveform(g, clip, bounds, noteColor);
     } else {
       // Fallback: simple rectangle for very short notes
       g.setColour(noteColor.withAlpha(0.85f));
@@ -787,6 +677,25 @@ void PianoRollComponent::drawNotes(juce::Graphics &g) {
     }
   }
 
+  // Notes the scroll reveals next
+  const auto [aheadStart, aheadEnd] =
+      motion.getScrollAhead(visibleStartTime, visibleEndTime);
+  if (aheadEnd <= aheadStart)
+    return;
+  for (auto *notePtr :
+       project->getNotesInRange(
+           secondsToFrames(static_cast<float>(aheadStart)),
+           secondsToFrames(static_cast<float>(aheadEnd)) + 1)) {
+    if (notePtr->isRest())
+      continue;
+    const WaveformClip clip = clipOf(*notePtr);
+    if (!clip.empty())
+      noteThumbnails.prefetch(clip, boundsAt(*notePtr, pixelsPerSecond),
+                              colourOf(*notePtr));
+  }
+}
+
+void PianoRollComponent::drawSplitGuide(juce::Graphics &g) {
   // Draw split guide line when in split mode and hovering over a note
   if (editMode == EditMode::Split && splitGuideNote && splitGuideX >= 0) {
     float noteStartTime = framesToSeconds(splitGuideNote->getStartFrame());
@@ -811,6 +720,29 @@ void PianoRollComponent::drawNotes(juce::Graphics &g) {
   }
 }
 
+juce::Rectangle<int> PianoRollComponent::getSelectionRectArea() const {
+  if (!boxSelector || !boxSelector->isSelecting())
+    return {};
+  return boxSelector->getSelectionRect()
+      .translated(static_cast<float>(pianoKeysWidth - static_cast<int>(scrollX)),
+                  static_cast<float>(headerHeight - static_cast<int>(scrollY)))
+      .expanded(2.0f)
+      .getSmallestIntegerContainer();
+}
+
+juce::Rectangle<int> PianoRollComponent::getSplitGuideArea() const {
+  if (!splitGuideNote || splitGuideX < 0)
+    return {};
+  const float x = splitGuideX + static_cast<float>(pianoKeysWidth) -
+                  static_cast<float>(static_cast<int>(scrollX));
+  const float y = midiToY(splitGuideNote->getAdjustedMidiNote()) +
+                  static_cast<float>(headerHeight) -
+                  static_cast<float>(static_cast<int>(scrollY));
+  return juce::Rectangle<float>(x - 2.0f, y - 2.0f, 4.0f,
+                                pixelsPerSemitone + 4.0f)
+      .getSmallestIntegerContainer();
+}
+
 void PianoRollComponent::drawStretchGuides(juce::Graphics &g) {
   if (!project || editMode != EditMode::Stretch)
     return;
@@ -860,7 +792,16 @@ void PianoRollComponent::drawPitchCurves(juce::Graphics &g) {
         (isDragging || pitchEditor->isDraggingMultiNotes());
     const auto &draggedNotes = pitchEditor->getDraggedNotes();
 
-    for (const auto &note : project->getNotes()) {
+    // Only notes overlapping the visible time range
+    const int visibleStartFrame =
+        secondsToFrames(static_cast<float>(scrollX / pixelsPerSecond));
+    const int visibleEndFrame = secondsToFrames(
+        static_cast<float>((scrollX + getWidth()) / pixelsPerSecond));
+    const auto visibleNotes = project->getNotesInRange(visibleStartFrame - 1,
+                                                       visibleEndFrame + 2);
+
+    for (const auto *notePtr : visibleNotes) {
+      const auto &note = *notePtr;
       if (note.isRest())
         continue;
 
@@ -871,48 +812,27 @@ void PianoRollComponent::drawPitchCurves(juce::Graphics &g) {
                draggedNotes.end());
       const bool applyNoteOffset = !(useLiveBasePreview && isDraggedNote);
 
-      juce::Path path;
-      bool pathStarted = false;
-
-      int startFrame = note.getStartFrame();
-      int endFrame =
-          std::min(note.getEndFrame(), static_cast<int>(audioData.f0.size()));
-
-      for (int i = startFrame; i < endFrame; ++i) {
-        // Base pitch: during drag, add pitchOffset to simulate the new base
-        // pitch This gives real-time preview of how the curve will look after
-        // drag completes
-        float baseMidi =
-            (i < static_cast<int>(audioData.basePitch.size()))
-                ? audioData.basePitch[static_cast<size_t>(i)]
-                : ((i < static_cast<int>(audioData.f0.size()) &&
-                    audioData.f0[static_cast<size_t>(i)] > 0.0f)
-                       ? freqToMidi(audioData.f0[static_cast<size_t>(i)])
-                       : 0.0f);
-        if (applyNoteOffset)
-          baseMidi += note.getPitchOffset();
-        float deltaMidi = (i < static_cast<int>(audioData.deltaPitch.size()))
-                              ? audioData.deltaPitch[static_cast<size_t>(i)]
-                              : 0.0f;
-        // Final = base (with drag offset) + delta + global offset only
-        float finalMidi = baseMidi + deltaMidi + globalOffset;
-
-        if (finalMidi > 0.0f) {
-          float x = framesToSeconds(i) * pixelsPerSecond;
-          float y = midiToY(finalMidi) + pixelsPerSemitone * 0.5f;
-
-          if (!pathStarted) {
-            path.startNewSubPath(x, y);
-            pathStarted = true;
-          } else {
-            path.lineTo(x, y);
-          }
-        }
-      }
+      // Frames just past either edge keep the stroke continuous there
+      int startFrame = std::max(note.getStartFrame(), visibleStartFrame - 1);
+      int endFrame = std::min({note.getEndFrame(),
+                               static_cast<int>(audioData.f0.size()),
+                               visibleEndFrame + 2});
+      if (startFrame >= endFrame)
+        continue;
 
-      if (pathStarted) {
-        g.strokePath(path, juce::PathStrokeType(2.0f));
+      // A dragged note's base pitch is rebuilt live, offset included
+      curveGeometry.composePitch(
+          audioData, startFrame, endFrame,
+          (applyNoteOffset ? note.getPitchOffset() : 0.0f) + globalOffset);
+      curveGeometry.mapToView(pixelsPerSecond, pixelsPerSemitone);
+
+      curvePath.clear();
+      {
+        CurvePathBuilder builder(curvePath);
+        curveGeometry.appendTo(builder);
       }
+      if (!curvePath.isEmpty())
+        g.strokePath(curvePath, juce::PathStrokeType(2.0f));
     }
   }
 
@@ -942,45 +862,29 @@ void PianoRollComponent::drawPitchCurves(juce::Graphics &g) {
       // Draw base pitch curve with dashed line
       g.setColour(
           APP_COLOR_SECONDARY.withAlpha(0.6f));
-      juce::Path basePath;
-      bool basePathStarted = false;
-
-      for (int i = visStartFrame; i < visEndFrame; ++i) {
-        if (i >= 0 && i < static_cast<int>(basePitchCurve.size())) {
-          float baseMidi = basePitchCurve[static_cast<size_t>(i)];
-          if (baseMidi > 0.0f) {
-            float x = framesToSeconds(i) * pixelsPerSecond;
-            float y = midiToY(baseMidi) +
-                      pixelsPerSemitone * 0.5f; // Center in grid cell
-
-            if (!basePathStarted) {
-              basePath.startNewSubPath(x, y);
-              basePathStarted = true;
-            } else {
-              basePath.lineTo(x, y);
-            }
-          } else if (basePathStarted) {
-            // Break path at unvoiced regions - draw current segment before
-            // breaking
-            juce::Path dashedPath;
-            juce::PathStrokeType stroke(1.5f);
-            const float dashLengths[] = {4.0f, 4.0f}; // 4px dash, 4px gap
-            stroke.createDashedStroke(dashedPath, basePath, dashLengths, 2);
-            g.strokePath(dashedPath, juce::PathStrokeType(1.5f));
-            basePath.clear();
-            basePathStarted = false;
-          }
-        }
-      }
-
-      if (basePathStarted) {
-        // Use dashed stroke for base pitch curve
+      // 4px dash, 4px gap
+      auto strokeDashed = [&g](const juce::Path &path) {
         juce::Path dashedPath;
         juce::PathStrokeType stroke(1.5f);
-        const float dashLengths[] = {4.0f, 4.0f}; // 4px dash, 4px gap
-        stroke.createDashedStroke(dashedPath, basePath, dashLengths, 2);
+        const float dashLengths[] = {4.0f, 4.0f};
+        stroke.createDashedStroke(dashedPath, path, dashLengths, 2);
         g.strokePath(dashedPath, juce::PathStrokeType(1.5f));
+      };
+
+      curvePath.clear();
+      if (visStartFrame < visEndFrame) {
+        curveGeometry.loadMidi(basePitchCurve.data() + visStartFrame,
+                               visStartFrame, visEndFrame - visStartFrame);
+        curveGeometry.mapToView(pixelsPerSecond, pixelsPerSemitone);
+        CurvePathBuilder baseBuilder(curvePath);
+        // Unvoiced regions break the curve; each piece is stroked on its own
+        curveGeometry.appendTo(baseBuilder, [&]() {
+          strokeDashed(curvePath);
+          curvePath.clear();
+        });
       }
+      if (!curvePath.isEmpty())
+        strokeDashed(curvePath);
     }
   }
 }
@@ -1006,6 +910,7 @@ void PianoRollComponent::drawPianoKeys(juce::Graphics &g) {
 
   static const char *noteNames[] = {"C",  "C#", "D",  "D#", "E",  "F",
                                     "F#", "G",  "G#", "A",  "A#", "B"};
+  const auto keyFont = g.getCurrentFont().withHeight(13.0f);
 
   // Draw each key
   // Use truncated scrollY to match grid origin (which uses
@@ -1037,10 +942,11 @@ void PianoRollComponent::drawPianoKeys(juce::Graphics &g) {
     // Use dimmer color for black keys
     g.setColour(isBlack ? APP_COLOR_PIANO_TEXT_DIM
                         : APP_COLOR_PIANO_TEXT);
-    g.setFont(13.0f);
-    g.drawText(noteName, pianoKeysWidth - 36, static_cast<int>(y), 32,
-               static_cast<int>(pixelsPerSemitone),
-               juce::Justification::centred);
+    glyphs.draw(g, noteName, keyFont,
+                juce::Rectangle<float>(
+                    static_cast<float>(pianoKeysWidth - 36),
+                    std::floor(y), 32.0f, std::floor(pixelsPerSemitone)),
+                juce::Justification::centred);
   }
 }
 
@@ -1166,10 +1072,8 @@ void PianoRollComponent::mouseDown(const juce::MouseEvent &e) {
   if (editMode == EditMode::Draw) {
     // Start drawing
     isDrawing = true;
-    drawingEdits.clear();
-    drawingEditIndexByFrame.clear();
-    drawCurves.clear();
-    activeDrawCurve = nullptr;
+    drawingStroke.begin(
+        project ? static_cast<int>(project->getAudioData().f0.size()) : 0);
     lastDrawFrame = -1;
     lastDrawValueCents = 0;
 
@@ -1229,6 +1133,9 @@ void PianoRollComponent::mouseDown(const juce::MouseEvent &e) {
       isDragging = true;
       draggedNote = note;
       dragStartY = adjustedY;
+      lastSpeculativeOffset = 0.0f;
+      lastDragSampleOffset = 0.0f;
+      lastDragSampleTime = juce::Time::getMillisecondCounterHiRes();
       originalPitchOffset = note->getPitchOffset();
       originalMidiNote = note->getMidiNote();
 
@@ -1340,9 +1247,11 @@ void PianoRollComponent::mouseDrag(const juce::MouseEvent &e) {
 
   // Handle box selection
   if (boxSelector->isSelecting()) {
+    const auto previousArea = getSelectionRectArea();
     boxSelector->updateSelection(adjustedX, adjustedY);
     if (shouldRepaint) {
-      repaint();
+      // An overlay: the notes under it do not change until mouseUp
+      repaint(previousArea.getUnion(getSelectionRectArea()));
       lastDragRepaintTime = now;
     }
     return;
@@ -1366,6 +1275,8 @@ void PianoRollComponent::mouseDrag(const juce::MouseEvent &e) {
     draggedNote->setPitchOffset(deltaSemitones);
     draggedNote->markDirty();
     applyDragBasePreview(deltaSemitones);
+    if (speculativeSynthesis)
+      updateSpeculativeSynthesis(deltaSemitones);
 
     if (shouldRepaint) {
       repaint();
@@ -1453,29 +1364,16 @@ void PianoRollComponent::mouseUp(const juce::MouseEvent &e) {
 
       // Find adjacent notes to expand dirty range (basePitch smoothing affects
       // neighbors)
-      const auto &notes = project->getNotes();
-      int expandedStart = startFrame;
-      int expandedEnd = endFrame;
-      for (const auto &note : notes) {
-        if (&note == draggedNote)
-          continue;
-        // If note is adjacent (within smoothing window ~20 frames), include it
-        if (note.getEndFrame() > startFrame - 30 &&
-            note.getEndFrame() <= startFrame) {
-          expandedStart = std::min(expandedStart, note.getStartFrame());
-        }
-        if (note.getStartFrame() < endFrame + 30 &&
-            note.getStartFrame() >= endFrame) {
-          expandedEnd = std::max(expandedEnd, note.getEndFrame());
-        }
-      }
+      const auto [expandedStart, expandedEnd] =
+          getDragExpandedRange(*draggedNote);
 
-      // Rebuild base pitch curve and F0 with final note position
-      PitchCurveProcessor::rebuildBaseFromNotes(*project);
-      PitchCurveProcessor::composeF0InPlace(*project, /*applyUvMask=*/false);
+      // Rebuild base pitch curve and F0 around the dragged note
+      const auto rebuilt = PitchCurveProcessor::rebuildBaseInRange(
+          *project, expandedStart, expandedEnd);
 
-      // Invalidate base pitch cache so it gets regenerated on next paint
-      invalidateBasePitchCache();
+      // Patch the drawn base pitch over what was rebuilt
+      invalidateBasePitchCache(rebuilt.first, rebuilt.second);
+      project->noteChanged(*draggedNote);
 
       // Mark dirty range for synthesis (use expanded range)
       int smoothStart = std::max(0, expandedStart - 60);
@@ -1495,33 +1393,16 @@ void PianoRollComponent::mouseUp(const juce::MouseEvent &e) {
           edit.newF0 = audioData.f0[static_cast<size_t>(i)];
           f0Edits.push_back(edit);
         }
-        // Capture frame range for undo callback
-        int capturedExpandedStart = expandedStart;
-        int capturedExpandedEnd = expandedEnd;
-        int capturedF0Size = f0Size;
+        // Replaying the step rebuilds the curves around the note from its
+        // change notification (see handleNoteChanges)
         auto action = std::make_unique<NotePitchDragAction>(
-            draggedNote, &audioData.f0, originalMidiNote,
+            project, draggedNote, &audioData.f0, originalMidiNote,
             originalMidiNote + newOffset, std::move(f0Edits),
-            [this, capturedExpandedStart, capturedExpandedEnd,
-             capturedF0Size](Note *n) {
-              if (project) {
-                PitchCurveProcessor::rebuildBaseFromNotes(*project);
-                PitchCurveProcessor::composeF0InPlace(*project,
-                                                      /*applyUvMask=*/false);
-                // Invalidate base pitch cache
-                invalidateBasePitchCache();
-                // Set dirty range for synthesis (use expanded range)
-                int smoothStart = std::max(0, capturedExpandedStart - 60);
-                int smoothEnd =
-                    std::min(capturedF0Size, capturedExpandedEnd + 60);
-                project->setF0DirtyRange(smoothStart, smoothEnd);
-                // Clear note's dirty flag since we're using F0 dirty range
-                // instead This prevents getDirtyFrameRange() from expanding the
-                // range unnecessarily
-                if (n) {
-                  n->clearDirty();
-                }
-              }
+            [](Note *n) {
+              // Clear note's dirty flag since we're using F0 dirty range
+              // instead This prevents getDirtyFrameRange() from expanding the
+              // range unnecessarily
+              n->clearDirty();
             });
         undoManager->addAction(std::move(action));
       }
@@ -1541,6 +1422,7 @@ void PianoRollComponent::mouseUp(const juce::MouseEvent &e) {
 
   isDragging = false;
   draggedNote = nullptr;
+  ++speculativeGeneration;
   dragPreviewStartFrame = -1;
   dragPreviewEndFrame = -1;
   dragPreviewWeights.clear();
@@ -1581,16 +1463,19 @@ void PianoRollComponent::mouseMove(const juce::MouseEvent &e) {
       float adjustedX = e.x - pianoKeysWidth + static_cast<float>(scrollX);
       int boundaryIndex =
           findStretchBoundaryIndex(adjustedX, stretchHandleHitPadding);
-      hoveredStretchBoundaryIndex = boundaryIndex;
+      if (boundaryIndex != hoveredStretchBoundaryIndex) {
+        hoveredStretchBoundaryIndex = boundaryIndex;
+        repaint();
+      }
       if (boundaryIndex >= 0) {
         setMouseCursor(juce::MouseCursor::LeftRightResizeCursor);
       } else {
         setMouseCursor(juce::MouseCursor::NormalCursor);
       }
-    } else {
+    } else if (hoveredStretchBoundaryIndex >= 0) {
       hoveredStretchBoundaryIndex = -1;
+      repaint();
     }
-    repaint();
   }
 
   // Split mode guide line
@@ -1599,6 +1484,7 @@ void PianoRollComponent::mouseMove(const juce::MouseEvent &e) {
     float adjustedY = e.y - headerHeight + static_cast<float>(scrollY);
 
     Note *note = noteSplitter->findNoteAt(adjustedX, adjustedY);
+    const auto previousArea = getSplitGuideArea();
     if (note) {
       splitGuideX = adjustedX;
       splitGuideNote = note;
@@ -1606,12 +1492,13 @@ void PianoRollComponent::mouseMove(const juce::MouseEvent &e) {
       splitGuideX = -1.0f;
       splitGuideNote = nullptr;
     }
-    repaint();
+    repaint(previousArea.getUnion(getSplitGuideArea()));
   } else if (splitGuideX >= 0) {
     // Clear guide when leaving split mode
+    const auto previousArea = getSplitGuideArea();
     splitGuideX = -1.0f;
     splitGuideNote = nullptr;
-    repaint();
+    repaint(previousArea);
   }
 }
 
@@ -1630,9 +1517,9 @@ void PianoRollComponent::mouseDoubleClick(const juce::MouseEvent &e) {
   Note *note = findNoteAt(adjustedX, adjustedY);
 
   if (note) {
-    auto rebuildAndNotify = [this]() {
-      PitchCurveProcessor::rebuildBaseFromNotes(*project);
-      PitchCurveProcessor::composeF0InPlace(*project, false);
+    // Undoing or redoing a snap rebuilds the curves from its note changes
+    // (see handleNoteChanges), so the steps are only told to notify
+    auto notifyEdited = [this]() {
       if (onPitchEdited)
         onPitchEdited();
       if (onPitchEditFinished)
@@ -1643,51 +1530,22 @@ void PianoRollComponent::mouseDoubleClick(const juce::MouseEvent &e) {
     if (note->isSelected()) {
       auto selectedNotes = project->getSelectedNotes();
       if (selectedNotes.size() > 1) {
-        std::vector<Note *> notesToSnap;
-        std::vector<float> oldMidis;
-        std::vector<float> oldOffsets;
-        std::vector<float> newMidis;
-
-        notesToSnap.reserve(selectedNotes.size());
-        oldMidis.reserve(selectedNotes.size());
-        oldOffsets.reserve(selectedNotes.size());
-        newMidis.reserve(selectedNotes.size());
-
-        for (auto *selected : selectedNotes) {
-          if (!selected || selected->isRest())
-            continue;
-
-          float oldMidi = selected->getMidiNote();
-          float oldOffset = selected->getPitchOffset();
-          float adjustedMidi = oldMidi + oldOffset;
-          float snappedMidi = std::round(adjustedMidi);
-
-          if (std::abs(snappedMidi - adjustedMidi) <= 0.001f)
-            continue;
-
-          notesToSnap.push_back(selected);
-          oldMidis.push_back(oldMidi);
-          oldOffsets.push_back(oldOffset);
-          newMidis.push_back(snappedMidi);
-        }
-
-        if (!notesToSnap.empty()) {
-          if (undoManager) {
-            auto action = std::make_unique<MultiNoteSnapToSemitoneAction>(
-                notesToSnap, oldMidis, oldOffsets, newMidis,
-                [this, rebuildAndNotify](const std::vector<Note *> &) {
-                  rebuildAndNotify();
-                });
-            undoManager->addAction(std::move(action));
-          }
-
-          for (size_t i = 0; i < notesToSnap.size(); ++i) {
-            notesToSnap[i]->setMidiNote(newMidis[i]);
-            notesToSnap[i]->setPitchOffset(0.0f);
-            notesToSnap[i]->markDirty();
-          }
-
-          rebuildAndNotify();
+        auto changes = NoteBulkEdit::planSnapToSemitone(*project, selectedNotes);
+        if (!changes.empty()) {
+          // Only the curves around the snapped notes are rebuilt
+          const auto snappedNotes =
+              NoteBulkEdit::applyPitchChanges(*project, changes, true);
+          for (const auto &[start, end] :
+               NoteBulkEdit::rebuildAroundNotes(*project, snappedNotes))
+            invalidateBasePitchCache(start, end);
+          if (undoManager)
+            undoManager->addAction(
+                std::make_unique<MultiNoteSnapToSemitoneAction>(
+                    project, std::move(changes),
+                    [notifyEdited](const std::vector<Note *> &) {
+                      notifyEdited();
+                    }));
+          notifyEdited();
         }
         return;
       }
@@ -1702,15 +1560,19 @@ void PianoRollComponent::mouseDoubleClick(const juce::MouseEvent &e) {
     if (std::abs(snappedMidi - adjustedMidi) > 0.001f) {
       if (undoManager) {
         auto action = std::make_unique<NoteSnapToSemitoneAction>(
-            note, oldMidi, oldOffset, snappedMidi,
-            [this, rebuildAndNotify](Note *n) { rebuildAndNotify(); });
+            project, note, oldMidi, oldOffset, snappedMidi,
+            [notifyEdited](Note *) { notifyEdited(); });
         undoManager->addAction(std::move(action));
       }
 
       note->setMidiNote(snappedMidi);
       note->setPitchOffset(0.0f);
       note->markDirty();
-      rebuildAndNotify();
+      for (const auto &[start, end] :
+           NoteBulkEdit::rebuildAroundNotes(*project, {note}))
+        invalidateBasePitchCache(start, end);
+      project->noteChanged(*note);
+      notifyEdited();
     }
   }
 }
@@ -1913,6 +1775,12 @@ void PianoRollComponent::scrollBarMoved(juce::ScrollBar *scrollBar,
 }
 
 void PianoRollComponent::setProject(Project *proj) {
+  noteChangeSubscription.reset();
+  if (proj)
+    noteChangeSubscription = proj->getNoteChanges().subscribe(
+        [this](const std::vector<NoteChange> &changes) {
+          handleNoteChanges(changes);
+        });
   project = proj;
 
   // Update modular components
@@ -1923,11 +1791,10 @@ void PianoRollComponent::setProject(Project *proj) {
 
   // Clear all caches when project changes to free memory
   invalidateBasePitchCache();
-  waveformCache = juce::Image(); // Clear waveform cache
-  cachedScrollX = -1.0;
-  cachedPixelsPerSecond = -1.0f;
-  cachedWidth = 0;
-  cachedHeight = 0;
+  noteThumbnails.clear();
+  spectrogramTiles.clear();
+  if (centeredMelComputer)
+    centeredMelComputer->clearFrameCache(); // Also releases the old audio
 
   updateScrollBars();
   repaint();
@@ -2254,22 +2121,15 @@ void PianoRollComponent::startStretchDrag(const StretchBoundary &boundary) {
 
   stretchDrag.currentBoundary = stretchDrag.originalBoundary;
 
-  // Ensure all notes have clip waveforms
+  // Ensure all notes have clip waveforms (views, no sample copies)
   if (audioData.waveform.getNumSamples() > 0) {
-    const float *src = audioData.waveform.getReadPointer(0);
-    const int totalSamples = audioData.waveform.getNumSamples();
+    const auto snapshot = audioData.getRenderSnapshot();
     for (auto &note : project->getNotes()) {
       if (note.hasClipWaveform())
         continue;
-      int startSample = note.getStartFrame() * HOP_SIZE;
-      int endSample = note.getEndFrame() * HOP_SIZE;
-      startSample = std::max(0, std::min(startSample, totalSamples));
-      endSample = std::max(startSample, std::min(endSample, totalSamples));
-      std::vector<float> clip;
-      clip.reserve(static_cast<size_t>(endSample - startSample));
-      for (int i = startSample; i < endSample; ++i)
-        clip.push_back(src[i]);
-      note.setClipWaveform(std::move(clip));
+      note.setClipWaveform(WaveformClip(snapshot,
+                                        note.getStartFrame() * HOP_SIZE,
+                                        note.getEndFrame() * HOP_SIZE));
     }
   }
 
@@ -2312,12 +2172,12 @@ void PianoRollComponent::startStretchDrag(const StretchBoundary &boundary) {
       stretchDrag.leftDelta.assign(
           audioData.deltaPitch.begin() + leftStart,
           audioData.deltaPitch.begin() + leftEnd);
-      stretchDrag.leftVoiced.assign(
-          audioData.voicedMask.begin() + leftStart,
-          audioData.voicedMask.begin() + leftEnd);
+      stretchDrag.leftVoiced = audioData.voicedMask.slice(leftStart, leftEnd);
     }
-    if (boundary.left->hasClipWaveform())
+    if (boundary.left->hasClipWaveform()) {
       stretchDrag.originalLeftClip = boundary.left->getClipWaveform();
+      stretchDrag.originalLeftSamples = stretchDrag.originalLeftClip.toVector();
+    }
   }
 
   // Save right note data if exists
@@ -2328,30 +2188,31 @@ void PianoRollComponent::startStretchDrag(const StretchBoundary &boundary) {
       stretchDrag.rightDelta.assign(
           audioData.deltaPitch.begin() + rightStart,
           audioData.deltaPitch.begin() + rightEnd);
-      stretchDrag.rightVoiced.assign(
-          audioData.voicedMask.begin() + rightStart,
-          audioData.voicedMask.begin() + rightEnd);
+      stretchDrag.rightVoiced =
+          audioData.voicedMask.slice(rightStart, rightEnd);
     }
-    if (boundary.right->hasClipWaveform())
+    if (boundary.right->hasClipWaveform()) {
       stretchDrag.originalRightClip = boundary.right->getClipWaveform();
+      stretchDrag.originalRightSamples =
+          stretchDrag.originalRightClip.toVector();
+    }
   }
 
   // Save full range data for undo
   stretchDrag.originalDeltaRangeFull.assign(
       audioData.deltaPitch.begin() + stretchDrag.rangeStartFull,
       audioData.deltaPitch.begin() + stretchDrag.rangeEndFull);
-  stretchDrag.originalVoicedRangeFull.assign(
-      audioData.voicedMask.begin() + stretchDrag.rangeStartFull,
-      audioData.voicedMask.begin() + stretchDrag.rangeEndFull);
+  stretchDrag.originalVoicedRangeFull = audioData.voicedMask.slice(
+      stretchDrag.rangeStartFull, stretchDrag.rangeEndFull);
 
   if (!audioData.melSpectrogram.empty() &&
       stretchDrag.rangeStartFull <
           static_cast<int>(audioData.melSpectrogram.size())) {
     int melEnd = std::min(stretchDrag.rangeEndFull,
                           static_cast<int>(audioData.melSpectrogram.size()));
-    stretchDrag.originalMelRangeFull.assign(
-        audioData.melSpectrogram.begin() + stretchDrag.rangeStartFull,
-        audioData.melSpectrogram.begin() + melEnd);
+    stretchDrag.originalMelRangeFull = MelBuffer(audioData.melSpectrogram.view(
+        static_cast<size_t>(stretchDrag.rangeStartFull),
+        static_cast<size_t>(melEnd)));
   }
 }
 
@@ -2419,31 +2280,35 @@ void PianoRollComponent::updateStretchDrag(int targetFrame) {
       audioData.melSpectrogram.size() >=
           static_cast<size_t>(stretchDrag.rangeStartFull +
                               stretchDrag.originalMelRangeFull.size())) {
-    for (size_t i = 0; i < stretchDrag.originalMelRangeFull.size(); ++i)
-      audioData.melSpectrogram[static_cast<size_t>(stretchDrag.rangeStartFull) +
-                               i] = stretchDrag.originalMelRangeFull[i];
+    audioData.melSpectrogram.copyFrames(
+        static_cast<size_t>(stretchDrag.rangeStartFull),
+        stretchDrag.originalMelRangeFull);
+    spectrogramTiles.invalidate(
+        stretchDrag.rangeStartFull,
+        stretchDrag.rangeStartFull +
+            static_cast<int>(stretchDrag.originalMelRangeFull.size()));
   }
 
   // Update left note if exists
   if (stretchDrag.boundary.left && newLeftLength > 0 && !stretchDrag.leftDelta.empty()) {
     const int leftStart = stretchDrag.originalLeftStart;
-    auto newLeftDelta =
-        CurveResampler::resampleLinear(stretchDrag.leftDelta, newLeftLength);
+    CurveResampler::resampleLinear(
+        stretchDrag.leftDelta.data(),
+        static_cast<int>(stretchDrag.leftDelta.size()),
+        audioData.deltaPitch.data() + leftStart, newLeftLength);
     auto newLeftVoiced =
         CurveResampler::resampleNearest(stretchDrag.leftVoiced, newLeftLength);
 
-    for (int i = 0; i < newLeftLength; ++i) {
-      audioData.deltaPitch[static_cast<size_t>(leftStart + i)] =
-          newLeftDelta[static_cast<size_t>(i)];
+    for (int i = 0; i < newLeftLength; ++i)
       audioData.voicedMask[static_cast<size_t>(leftStart + i)] =
           newLeftVoiced[static_cast<size_t>(i)];
-    }
 
     if (!stretchDrag.originalLeftClip.empty()) {
       const int newLeftSamples = std::max(0, newLeftLength * HOP_SIZE);
-      auto newLeftClip =
-          CurveResampler::resampleLinear(stretchDrag.originalLeftClip, newLeftSamples);
-      stretchDrag.boundary.left->setClipWaveform(std::move(newLeftClip));
+      auto newLeftClip = CurveResampler::resampleLinear(
+          stretchDrag.originalLeftSamples, newLeftSamples);
+      stretchDrag.boundary.left->setClipWaveform(
+          WaveformClip(std::move(newLeftClip)));
     }
 
     stretchDrag.boundary.left->setEndFrame(targetFrame);
@@ -2452,23 +2317,23 @@ void PianoRollComponent::updateStretchDrag(int targetFrame) {
 
   // Update right note if exists
   if (stretchDrag.boundary.right && newRightLength > 0 && !stretchDrag.rightDelta.empty()) {
-    auto newRightDelta =
-        CurveResampler::resampleLinear(stretchDrag.rightDelta, newRightLength);
+    CurveResampler::resampleLinear(
+        stretchDrag.rightDelta.data(),
+        static_cast<int>(stretchDrag.rightDelta.size()),
+        audioData.deltaPitch.data() + targetFrame, newRightLength);
     auto newRightVoiced =
         CurveResampler::resampleNearest(stretchDrag.rightVoiced, newRightLength);
 
-    for (int i = 0; i < newRightLength; ++i) {
-      audioData.deltaPitch[static_cast<size_t>(targetFrame + i)] =
-          newRightDelta[static_cast<size_t>(i)];
+    for (int i = 0; i < newRightLength; ++i)
       audioData.voicedMask[static_cast<size_t>(targetFrame + i)] =
           newRightVoiced[static_cast<size_t>(i)];
-    }
 
     if (!stretchDrag.originalRightClip.empty()) {
       const int newRightSamples = std::max(0, newRightLength * HOP_SIZE);
-      auto newRightClip =
-          CurveResampler::resampleLinear(stretchDrag.originalRightClip, newRightSamples);
-      stretchDrag.boundary.right->setClipWaveform(std::move(newRightClip));
+      auto newRightClip = CurveResampler::resampleLinear(
+          stretchDrag.originalRightSamples, newRightSamples);
+      stretchDrag.boundary.right->setClipWaveform(
+          WaveformClip(std::move(newRightClip)));
     }
 
     stretchDrag.boundary.right->setStartFrame(targetFrame);
@@ -2495,33 +2360,33 @@ void PianoRollComponent::updateStretchDrag(int targetFrame) {
     rangeStart = std::clamp(rangeStart, 0, melSize);
     rangeEnd = std::clamp(rangeEnd, 0, melSize);
 
-    std::vector<std::vector<float>> newMel;
+    MelBuffer newMel;
     if (rangeEnd > rangeStart) {
       // Use fast nearest neighbor resampling for drag preview
-      std::vector<std::vector<float>> newLeftMel;
+      MelBuffer newLeftMel;
       if (stretchDrag.boundary.left && newLeftLength > 0) {
         const int leftOffset = stretchDrag.originalLeftStart - stretchDrag.rangeStartFull;
         if (leftOffset >= 0 &&
             leftOffset + (stretchDrag.originalLeftEnd - stretchDrag.originalLeftStart) <=
                 static_cast<int>(stretchDrag.originalMelRangeFull.size())) {
-          std::vector<std::vector<float>> leftMel(
-              stretchDrag.originalMelRangeFull.begin() + leftOffset,
-              stretchDrag.originalMelRangeFull.begin() + leftOffset +
-                  (stretchDrag.originalLeftEnd - stretchDrag.originalLeftStart));
+          auto leftMel = stretchDrag.originalMelRangeFull.view(
+              static_cast<size_t>(leftOffset),
+              static_cast<size_t>(leftOffset + (stretchDrag.originalLeftEnd -
+                                                stretchDrag.originalLeftStart)));
           newLeftMel = CurveResampler::resampleNearest2D(leftMel, newLeftLength);
         }
       }
 
-      std::vector<std::vector<float>> newRightMel;
+      MelBuffer newRightMel;
       if (stretchDrag.boundary.right && newRightLength > 0) {
         const int rightOffset = stretchDrag.originalRightStart - stretchDrag.rangeStartFull;
         if (rightOffset >= 0 &&
             rightOffset + (stretchDrag.originalRightEnd - stretchDrag.originalRightStart) <=
                 static_cast<int>(stretchDrag.originalMelRangeFull.size())) {
-          std::vector<std::vector<float>> rightMel(
-              stretchDrag.originalMelRangeFull.begin() + rightOffset,
-              stretchDrag.originalMelRangeFull.begin() + rightOffset +
-                  (stretchDrag.originalRightEnd - stretchDrag.originalRightStart));
+          auto rightMel = stretchDrag.originalMelRangeFull.view(
+              static_cast<size_t>(rightOffset),
+              static_cast<size_t>(rightOffset + (stretchDrag.originalRightEnd -
+                                                 stretchDrag.originalRightStart)));
           newRightMel = CurveResampler::resampleNearest2D(rightMel, newRightLength);
         }
       }
@@ -2529,8 +2394,8 @@ void PianoRollComponent::updateStretchDrag(int targetFrame) {
       // Combine mel spectrograms
       if (stretchDrag.boundary.left && stretchDrag.boundary.right) {
         newMel.reserve(static_cast<size_t>(newLeftLength + newRightLength));
-        newMel.insert(newMel.end(), newLeftMel.begin(), newLeftMel.end());
-        newMel.insert(newMel.end(), newRightMel.begin(), newRightMel.end());
+        newMel.append(newLeftMel);
+        newMel.append(newRightMel);
       } else if (stretchDrag.boundary.left) {
         newMel = std::move(newLeftMel);
       } else {
@@ -2540,16 +2405,16 @@ void PianoRollComponent::updateStretchDrag(int targetFrame) {
 
     if (!newMel.empty() &&
         static_cast<int>(newMel.size()) == (rangeEnd - rangeStart)) {
-      for (int i = rangeStart; i < rangeEnd; ++i)
-        audioData.melSpectrogram[static_cast<size_t>(i)] =
-            newMel[static_cast<size_t>(i - rangeStart)];
+      audioData.melSpectrogram.copyFrames(static_cast<size_t>(rangeStart),
+                                          newMel);
+      spectrogramTiles.invalidate(rangeStart, rangeEnd);
       previewRangeStart = rangeStart;
       previewRangeEnd = rangeEnd;
     }
   }
 
-  PitchCurveProcessor::rebuildBaseFromNotes(*project);
-  PitchCurveProcessor::composeF0InPlace(*project, /*applyUvMask=*/false);
+  PitchCurveProcessor::rebuildBaseInRange(*project, stretchDrag.rangeStartFull,
+                                          stretchDrag.rangeEndFull);
   invalidateBasePitchCache();
 
   if (onPitchEdited)
@@ -2564,6 +2429,40 @@ void PianoRollComponent::updateStretchDrag(int targetFrame) {
   }
 }
 
+void PianoRollComponent::appendStretchedNoteMel(
+    MelBuffer &dest, int originalStart, int originalEnd, int newLength,
+    const RenderSnapshot::Ptr &source) {
+  auto &audioData = project->getAudioData();
+  const int offset = originalStart - stretchDrag.rangeStartFull;
+  const int originalLength = originalEnd - originalStart;
+  MelView originalMel;
+  if (offset >= 0 && originalLength > 0 &&
+      offset + originalLength <=
+          static_cast<int>(stretchDrag.originalMelRangeFull.size()))
+    originalMel = stretchDrag.originalMelRangeFull.view(
+        static_cast<size_t>(offset),
+        static_cast<size_t>(offset + originalLength));
+
+  // A note whose length did not change keeps its frames; only a changed
+  // stretch ratio needs a new centered STFT
+  if (newLength == originalLength && !originalMel.empty()) {
+    dest.append(originalMel);
+    return;
+  }
+
+  // Use CenteredMelSpectrogram for high-quality time stretching
+  // Key: use GLOBAL waveform, not clipWaveform
+  MelBuffer stretched;
+  centeredMelComputer->computeTimeStretched(
+      audioData.waveform.getReadPointer(0), audioData.waveform.getNumSamples(),
+      originalStart, originalEnd, newLength, stretched, source);
+
+  // Fallback to nearest neighbor if centered mel computation failed
+  if (stretched.empty())
+    stretched = CurveResampler::resampleNearest2D(originalMel, newLength);
+  dest.append(stretched);
+}
+
 void PianoRollComponent::finishStretchDrag() {
   if (!stretchDrag.active || !project) {
     stretchDrag = {};
@@ -2590,10 +2489,9 @@ void PianoRollComponent::finishStretchDrag() {
   std::vector<float> newDelta(
       audioData.deltaPitch.begin() + rangeStart,
       audioData.deltaPitch.begin() + rangeEnd);
-  std::vector<bool> newVoiced(
-      audioData.voicedMask.begin() + rangeStart,
-      audioData.voicedMask.begin() + rangeEnd);
-  std::vector<std::vector<float>> newMel;
+  std::vector<bool> newVoiced =
+      audioData.voicedMask.slice(rangeStart, rangeEnd);
+  MelBuffer newMel;
   if (!audioData.melSpectrogram.empty() &&
       rangeEnd <= static_cast<int>(audioData.melSpectrogram.size()) &&
       audioData.waveform.getNumSamples() > 0 && centeredMelComputer) {
@@ -2605,78 +2503,24 @@ void PianoRollComponent::finishStretchDrag() {
         ? (stretchDrag.originalRightEnd - currentBoundary)
         : 0;
 
-    // Use CenteredMelSpectrogram for high-quality time stretching
-    // Key: use GLOBAL waveform, not clipWaveform
-    const float* globalAudio = audioData.waveform.getReadPointer(0);
-    const int numSamples = audioData.waveform.getNumSamples();
-
-    std::vector<std::vector<float>> newLeftMel;
-    std::vector<std::vector<float>> newRightMel;
-
-    if (leftLen > 0) {
-      centeredMelComputer->computeTimeStretched(
-          globalAudio,
-          numSamples,
-          stretchDrag.originalLeftStart,
-          stretchDrag.originalLeftEnd,
-          leftLen,
-          newLeftMel);
-    }
-
-    if (rightLen > 0) {
-      centeredMelComputer->computeTimeStretched(
-          globalAudio,
-          numSamples,
-          stretchDrag.originalRightStart,
-          stretchDrag.originalRightEnd,
-          rightLen,
-          newRightMel);
-    }
-
-    // Fallback to nearest neighbor if centered mel computation failed
-    if (newLeftMel.empty() && leftLen > 0) {
-      const int leftOffset =
-          stretchDrag.originalLeftStart - stretchDrag.rangeStartFull;
-      std::vector<std::vector<float>> leftMel;
-      if (leftOffset >= 0 &&
-          leftOffset +
-                  (stretchDrag.originalLeftEnd -
-                   stretchDrag.originalLeftStart) <=
-              static_cast<int>(stretchDrag.originalMelRangeFull.size())) {
-        leftMel.assign(
-            stretchDrag.originalMelRangeFull.begin() + leftOffset,
-            stretchDrag.originalMelRangeFull.begin() + leftOffset +
-                (stretchDrag.originalLeftEnd - stretchDrag.originalLeftStart));
-      }
-      newLeftMel = CurveResampler::resampleNearest2D(leftMel, leftLen);
-    }
-
-    if (newRightMel.empty() && rightLen > 0) {
-      const int rightOffset =
-          stretchDrag.originalRightStart - stretchDrag.rangeStartFull;
-      std::vector<std::vector<float>> rightMel;
-      if (rightOffset >= 0 &&
-          rightOffset +
-                  (stretchDrag.originalRightEnd -
-                   stretchDrag.originalRightStart) <=
-              static_cast<int>(stretchDrag.originalMelRangeFull.size())) {
-        rightMel.assign(
-            stretchDrag.originalMelRangeFull.begin() + rightOffset,
-            stretchDrag.originalMelRangeFull.begin() + rightOffset +
-                (stretchDrag.originalRightEnd - stretchDrag.originalRightStart));
-      }
-      newRightMel = CurveResampler::resampleNearest2D(rightMel, rightLen);
-    }
+    // Lets repeated stretches of these notes reuse cached frames
+    const auto sourceSnapshot = audioData.getRenderSnapshot();
 
     newMel.reserve(static_cast<size_t>(leftLen + rightLen));
-    newMel.insert(newMel.end(), newLeftMel.begin(), newLeftMel.end());
-    newMel.insert(newMel.end(), newRightMel.begin(), newRightMel.end());
+    if (leftLen > 0)
+      appendStretchedNoteMel(newMel, stretchDrag.originalLeftStart,
+                             stretchDrag.originalLeftEnd, leftLen,
+                             sourceSnapshot);
+    if (rightLen > 0)
+      appendStretchedNoteMel(newMel, stretchDrag.originalRightStart,
+                             stretchDrag.originalRightEnd, rightLen,
+                             sourceSnapshot);
 
     if (!newMel.empty() &&
         static_cast<int>(newMel.size()) == (rangeEnd - rangeStart)) {
-      for (int i = rangeStart; i < rangeEnd; ++i)
-        audioData.melSpectrogram[static_cast<size_t>(i)] =
-            newMel[static_cast<size_t>(i - rangeStart)];
+      audioData.melSpectrogram.copyFrames(static_cast<size_t>(rangeStart),
+                                          newMel);
+      spectrogramTiles.invalidate(rangeStart, rangeEnd);
     } else {
       newMel.clear();
     }
@@ -2684,10 +2528,10 @@ void PianoRollComponent::finishStretchDrag() {
 
   int newLeftStart = stretchDrag.boundary.left ? stretchDrag.boundary.left->getStartFrame() : 0;
   int newLeftEnd = stretchDrag.boundary.left ? stretchDrag.boundary.left->getEndFrame() : 0;
-  std::vector<float> newLeftClip;
+  WaveformClip newLeftClip;
   if (stretchDrag.boundary.left)
     newLeftClip = stretchDrag.boundary.left->getClipWaveform();
-  std::vector<float> newRightClip;
+  WaveformClip newRightClip;
   if (stretchDrag.boundary.right)
     newRightClip = stretchDrag.boundary.right->getClipWaveform();
 
@@ -2696,7 +2540,7 @@ void PianoRollComponent::finishStretchDrag() {
     int capturedRangeEnd = rangeEnd;
     std::vector<float> oldDelta;
     std::vector<bool> oldVoiced;
-    std::vector<std::vector<float>> oldMel;
+    MelBuffer oldMel;
     if (!stretchDrag.originalDeltaRangeFull.empty() &&
         !stretchDrag.originalVoicedRangeFull.empty()) {
       int offset = rangeStart - stretchDrag.rangeStartFull;
@@ -2718,13 +2562,13 @@ void PianoRollComponent::finishStretchDrag() {
       if (offset >= 0 &&
           offset + count <=
               static_cast<int>(stretchDrag.originalMelRangeFull.size())) {
-        oldMel.assign(stretchDrag.originalMelRangeFull.begin() + offset,
-                      stretchDrag.originalMelRangeFull.begin() + offset + count);
+        oldMel = MelBuffer(stretchDrag.originalMelRangeFull.view(
+            static_cast<size_t>(offset), static_cast<size_t>(offset + count)));
       }
     }
 
     auto action = std::make_unique<NoteTimingStretchAction>(
-        stretchDrag.boundary.left,
+        project, stretchDrag.boundary.left,
         stretchDrag.boundary.right,
         &audioData.deltaPitch, &audioData.voicedMask, &audioData.melSpectrogram,
         capturedRangeStart, capturedRangeEnd, stretchDrag.originalLeftStart,
@@ -2736,22 +2580,31 @@ void PianoRollComponent::finishStretchDrag() {
         std::move(oldDelta), std::move(newDelta),
         std::move(oldVoiced), std::move(newVoiced),
         std::move(oldMel), std::move(newMel),
+        // Curves around the retimed notes are rebuilt from the note
+        // changes; the restored delta and mel need resynthesis as well
         [this](int startFrame, int endFrame) {
           if (!project)
             return;
-          PitchCurveProcessor::rebuildBaseFromNotes(*project);
-          PitchCurveProcessor::composeF0InPlace(*project,
-                                                /*applyUvMask=*/false);
-          invalidateBasePitchCache();
           const int f0Size =
               static_cast<int>(project->getAudioData().f0.size());
-          int smoothStart = std::max(0, startFrame - 60);
-          int smoothEnd = std::min(f0Size, endFrame + 60);
-          project->setF0DirtyRange(smoothStart, smoothEnd);
+          project->setF0DirtyRange(std::max(0, startFrame - 60),
+                                   std::min(f0Size, endFrame + 60));
         });
     undoManager->addAction(std::move(action));
   }
 
+  {
+    NoteChangeFeed::ScopedBatch batch(&project->getNoteChanges());
+    if (stretchDrag.boundary.left)
+      project->noteChanged(*stretchDrag.boundary.left,
+                           stretchDrag.originalLeftStart,
+                           stretchDrag.originalLeftEnd);
+    if (stretchDrag.boundary.right)
+      project->noteChanged(*stretchDrag.boundary.right,
+                           stretchDrag.originalRightStart,
+                           stretchDrag.originalRightEnd);
+  }
+
   // Silence waveform regions outside the current note boundaries
   // This ensures that when a note is shrunk, the previously synthesized audio is cleared
   if (audioData.waveform.getNumSamples() > 0) {
@@ -2778,6 +2631,7 @@ void PianoRollComponent::finishStretchDrag() {
     const int rangeStartSample = stretchDrag.rangeStartFull * HOP_SIZE;
     const int rangeEndSample = stretchDrag.rangeEndFull * HOP_SIZE;
 
+    audioData.prepareWaveformWrite();
     for (int ch = 0; ch < numChannels; ++ch) {
       float* dst = audioData.waveform.getWritePointer(ch);
 
@@ -2798,6 +2652,7 @@ void PianoRollComponent::finishStretchDrag() {
         }
       }
     }
+    audioData.updateRenderSnapshot({{rangeStartSample, rangeEndSample}});
   }
 
   const int f0Size = static_cast<int>(audioData.f0.size());
@@ -2844,9 +2699,11 @@ void PianoRollComponent::cancelStretchDrag() {
       rangeStart < rangeEnd &&
       audioData.melSpectrogram.size() >=
           static_cast<size_t>(rangeStart + stretchDrag.originalMelRangeFull.size())) {
-    for (size_t i = 0; i < stretchDrag.originalMelRangeFull.size(); ++i)
-      audioData.melSpectrogram[static_cast<size_t>(rangeStart) + i] =
-          stretchDrag.originalMelRangeFull[i];
+    audioData.melSpectrogram.copyFrames(static_cast<size_t>(rangeStart),
+                                        stretchDrag.originalMelRangeFull);
+    spectrogramTiles.invalidate(
+        rangeStart,
+        rangeStart + static_cast<int>(stretchDrag.originalMelRangeFull.size()));
   }
 
   // Note: waveform is not modified during drag, so no need to restore it here
@@ -2867,8 +2724,8 @@ void PianoRollComponent::cancelStretchDrag() {
       stretchDrag.boundary.right->setClipWaveform(stretchDrag.originalRightClip);
   }
 
-  PitchCurveProcessor::rebuildBaseFromNotes(*project);
-  PitchCurveProcessor::composeF0InPlace(*project, /*applyUvMask=*/false);
+  PitchCurveProcessor::rebuildBaseInRange(*project, stretchDrag.rangeStartFull,
+                                          stretchDrag.rangeEndFull);
   invalidateBasePitchCache();
 
   if (onPitchEdited)
@@ -2881,7 +2738,12 @@ Note *PianoRollComponent::findNoteAt(float x, float y) {
   if (!project)
     return nullptr;
 
-  for (auto &note : project->getNotes()) {
+  const int frame = secondsToFrames(x / pixelsPerSecond);
+  const float midiAtY = yToMidi(y);
+  // Slack for rounding; the exact test is below
+  for (auto *notePtr : project->getNotesInRect(
+           frame - 1, frame + 2, midiAtY - 0.01f, midiAtY + 1.01f)) {
+    auto &note = *notePtr;
     // Skip rest notes
     if (note.isRest())
       continue;
@@ -2913,6 +2775,60 @@ void PianoRollComponent::updateScrollBars() {
     verticalScrollBar.setRangeLimits(0, totalHeight);
     verticalScrollBar.setCurrentRange(scrollY, visibleHeight);
   }
+
+  // Every zoom change ends up here
+  if (onViewScaleChanged)
+    onViewScaleChanged();
+}
+
+void PianoRollComponent::invalidateBasePitchCache(int startFrame,
+                                                  int endFrame) {
+  // Anything the rebuild did not cover, or a cache of another curve length,
+  // regenerates in full
+  const auto *basePitch = project ? &project->getAudioData().basePitch : nullptr;
+  if (!basePitch || endFrame <= startFrame || cacheInvalidated ||
+      cachedBasePitch.empty() || cachedBasePitch.size() != basePitch->size()) {
+    invalidateBasePitchCache();
+    return;
+  }
+
+  const int size = static_cast<int>(cachedBasePitch.size());
+  startFrame = std::clamp(startFrame, 0, size);
+  endFrame = std::clamp(endFrame, startFrame, size);
+  std::copy(basePitch->begin() + startFrame, basePitch->begin() + endFrame,
+            cachedBasePitch.begin() + startFrame);
+}
+
+void PianoRollComponent::handleNoteChanges(
+    const std::vector<NoteChange> &changes) {
+  if (!project)
+    return;
+
+  std::vector<std::pair<int, int>> ranges;
+  for (const auto &change : changes) {
+    if (change.type == NoteChange::Type::Reset) {
+      invalidateBasePitchCache();
+      repaint();
+      return;
+    }
+    if (change.endFrame > change.startFrame)
+      ranges.emplace_back(change.startFrame, change.endFrame);
+  }
+  if (ranges.empty())
+    return;
+
+  if (undoManager && undoManager->isReplaying()) {
+    // An undone or redone step only puts its notes back; the curves around
+    // them are rebuilt here, once per step
+    for (const auto &span : NoteBulkEdit::rebuildAroundRanges(*project, ranges))
+      pendingBasePitchRanges.push_back(span);
+  } else {
+    // Edits rebuild the curves where they are made
+    for (const auto &[start, end] : ranges)
+      pendingBasePitchRanges.push_back(
+          PitchCurveProcessor::getCurveRebuildRange(*project, start, end));
+  }
+  repaint();
 }
 
 void PianoRollComponent::updateBasePitchCacheIfNeeded() {
@@ -2935,12 +2851,27 @@ void PianoRollComponent::updateBasePitchCacheIfNeeded() {
     }
   }
 
-  // Invalidate cache if notes changed or total frames changed or explicitly
-  // invalidated For performance, we only check note count and total frames A
-  // more precise check would compare note positions/pitches, but that's
-  // expensive
-  if (cacheInvalidated || cachedNoteCount != currentNoteCount ||
-      cachedTotalFrames != totalFrames || cachedBasePitch.empty()) {
+  // Invalidate cache if total frames changed or explicitly invalidated.
+  // Reported note changes are patched in below; a note count that changed
+  // without any report means the notes were edited behind the feed's back
+  const bool stale = cacheInvalidated || cachedTotalFrames != totalFrames ||
+                     cachedBasePitch.empty() ||
+                     (cachedNoteCount != currentNoteCount &&
+                      pendingBasePitchRanges.empty());
+  ++(stale ? paintStats.basePitchCache.misses
+           : paintStats.basePitchCache.hits);
+  if (!stale && !pendingBasePitchRanges.empty()) {
+    const auto ranges = std::exchange(pendingBasePitchRanges, {});
+    for (const auto &[start, end] : ranges)
+      invalidateBasePitchCache(start, end);
+    if (!cacheInvalidated)
+      cachedNoteCount = currentNoteCount;
+    else
+      updateBasePitchCacheIfNeeded(); // The project's curve changed length
+    return;
+  }
+  if (stale) {
+    pendingBasePitchRanges.clear();
     // Only regenerate if we have notes and frames
     if (currentNoteCount > 0 && totalFrames > 0) {
       // Collect all notes
@@ -2985,7 +2916,8 @@ void PianoRollComponent::prepareDragBasePreview() {
     return;
 
   auto range = computeBasePitchPreviewRange(
-      project->getNotes(), static_cast<int>(audioData.basePitch.size()),
+      *project, draggedNote->getStartFrame(), draggedNote->getEndFrame(),
+      static_cast<int>(audioData.basePitch.size()),
       [this](const Note &note) { return &note == draggedNote; });
 
   if (range.startFrame < 0 || range.endFrame <= range.startFrame ||
@@ -3052,6 +2984,85 @@ void PianoRollComponent::applyDragBasePreview(float pitchOffsetSemitones) {
   }
 }
 
+std::pair<int, int>
+PianoRollComponent::getDragExpandedRange(const Note &dragged) const {
+  const int startFrame = dragged.getStartFrame();
+  const int endFrame = dragged.getEndFrame();
+  int expandedStart = startFrame;
+  int expandedEnd = endFrame;
+  if (!project)
+    return {expandedStart, expandedEnd};
+
+  for (const auto *notePtr :
+       project->getNotesInRange(startFrame - 30, endFrame + 30)) {
+    const auto &note = *notePtr;
+    if (&note == &dragged)
+      continue;
+    // If note is adjacent (within smoothing window ~20 frames), include it
+    if (note.getEndFrame() > startFrame - 30 &&
+        note.getEndFrame() <= startFrame) {
+      expandedStart = std::min(expandedStart, note.getStartFrame());
+    }
+    if (note.getStartFrame() < endFrame + 30 &&
+        note.getStartFrame() >= endFrame) {
+      expandedEnd = std::max(expandedEnd, note.getEndFrame());
+    }
+  }
+  return {expandedStart, expandedEnd};
+}
+
+void PianoRollComponent::updateSpeculativeSynthesis(
+    float pitchOffsetSemitones) {
+  // Pitch speed below which the user is homing in on a target
+  constexpr float maxSemitonesPerSecond = 4.0f;
+  // Gap between guesses while dragging slowly
+  constexpr double minIntervalMs = 100.0;
+  // Rest time after which the current pitch is guessed regardless of speed
+  constexpr int settleMs = 120;
+
+  const double now = juce::Time::getMillisecondCounterHiRes();
+  const double elapsed = (now - lastDragSampleTime) / 1000.0;
+  const float velocity =
+      elapsed > 0.0
+          ? static_cast<float>(
+                std::abs(pitchOffsetSemitones - lastDragSampleOffset) /
+                elapsed)
+          : 0.0f;
+  lastDragSampleTime = now;
+  lastDragSampleOffset = pitchOffsetSemitones;
+
+  if (velocity < maxSemitonesPerSecond &&
+      now - lastSpeculativeTime >= minIntervalMs)
+    startSpeculativeSynthesis();
+
+  // Fast drags get no guesses until the pointer rests
+  const int generation = ++speculativeGeneration;
+  juce::Component::SafePointer<PianoRollComponent> safeThis(this);
+  juce::Timer::callAfterDelay(settleMs, [safeThis, generation]() {
+    if (safeThis && safeThis->speculativeGeneration == generation)
+      safeThis->startSpeculativeSynthesis();
+  });
+}
+
+void PianoRollComponent::startSpeculativeSynthesis() {
+  if (!isDragging || !draggedNote || !project || !onSpeculativeSynthesis ||
+      previewMode)
+    return;
+
+  // Same no-change threshold as mouseUp; skip pitches already requested
+  const float offset = draggedNote->getPitchOffset();
+  if (std::abs(offset) < 0.001f || offset == lastSpeculativeOffset)
+    return;
+  lastSpeculativeOffset = offset;
+  lastSpeculativeTime = juce::Time::getMillisecondCounterHiRes();
+
+  // Must match the range mouseUp marks dirty, or the result won't be reused
+  const auto [expandedStart, expandedEnd] = getDragExpandedRange(*draggedNote);
+  const int f0Size = static_cast<int>(project->getAudioData().f0.size());
+  onSpeculativeSynthesis(std::max(0, expandedStart - 60),
+                         std::min(f0Size, expandedEnd + 60));
+}
+
 void PianoRollComponent::restoreDragBasePreview() {
   if (!project || dragPreviewStartFrame < 0 ||
       dragPreviewEndFrame <= dragPreviewStartFrame ||
@@ -3127,44 +3138,32 @@ void PianoRollComponent::applyPitchDrawing(float x, float y) {
 }
 
 void PianoRollComponent::commitPitchDrawing() {
-  if (drawingEdits.empty())
+  if (drawingStroke.empty())
     return;
 
-  // Calculate the dirty frame range from the changes
-  int minFrame = std::numeric_limits<int>::max();
-  int maxFrame = std::numeric_limits<int>::min();
-  for (const auto &e : drawingEdits) {
-    minFrame = std::min(minFrame, e.idx);
-    maxFrame = std::max(maxFrame, e.idx);
-  }
+  // The dirty frame range of the changes
+  const int minFrame = drawingStroke.getMinFrame();
+  const int maxFrame = drawingStroke.getMaxFrame();
 
   // Clear deltaPitch for notes in the edited range so they use the drawn F0
   // values
-  if (project && minFrame <= maxFrame) {
-    auto &notes = project->getNotes();
-    for (auto &note : notes) {
-      // Check if note overlaps with edited range
-      if (note.getEndFrame() > minFrame && note.getStartFrame() < maxFrame) {
-        // Clear deltaPitch so the note will use audioData.f0 instead of
-        // computed values
-        if (note.hasDeltaPitch()) {
-          note.setDeltaPitch(std::vector<float>());
-        }
-      }
+  if (project) {
+    for (auto *note : project->getNotesInRange(minFrame, maxFrame)) {
+      if (note->hasDeltaPitch())
+        note->setDeltaPitch(std::vector<float>());
     }
   }
 
   // Set F0 dirty range in project for incremental synthesis
-  if (project && minFrame <= maxFrame) {
+  if (project)
     project->setF0DirtyRange(minFrame, maxFrame);
-  }
 
   // Create undo action
   if (undoManager && project) {
     auto &audioData = project->getAudioData();
     auto action = std::make_unique<F0EditAction>(
         &audioData.f0, &audioData.deltaPitch, &audioData.voicedMask,
-        drawingEdits, [this](int minFrame, int maxFrame) {
+        drawingStroke.getEdits(), [this](int minFrame, int maxFrame) {
           // Callback to trigger resynthesis after undo/redo
           if (project) {
             project->setF0DirtyRange(minFrame, maxFrame);
@@ -3175,12 +3174,10 @@ void PianoRollComponent::commitPitchDrawing() {
     undoManager->addAction(std::move(action));
   }
 
-  drawingEdits.clear();
-  drawingEditIndexByFrame.clear();
+  drawingStroke.clear();
   lastDrawFrame = -1;
   lastDrawValueCents = 0;
-  activeDrawCurve = nullptr;
-  drawCurves.clear();
+  ++speculativeGeneration;
 
   // Trigger synthesis
   if (onPitchEditFinished)
@@ -3192,31 +3189,98 @@ void PianoRollComponent::cancelDrawing() {
     return;
 
   // Restore original F0 values from drawing edits
-  if (project && !drawingEdits.empty()) {
+  if (project && !drawingStroke.empty()) {
     auto &audioData = project->getAudioData();
-    for (const auto &e : drawingEdits) {
-      if (e.idx >= 0 && e.idx < static_cast<int>(audioData.f0.size())) {
-        audioData.f0[e.idx] = e.oldF0;
-      }
-      if (e.idx >= 0 && e.idx < static_cast<int>(audioData.deltaPitch.size())) {
-        audioData.deltaPitch[e.idx] = e.oldDelta;
-      }
-      if (e.idx >= 0 && e.idx < static_cast<int>(audioData.voicedMask.size())) {
+    drawingStroke.forEachEdit([&audioData](const F0FrameEdit &e) {
+      if (e.idx < static_cast<int>(audioData.f0.size()))
+        audioData.f0[static_cast<size_t>(e.idx)] = e.oldF0;
+      if (e.idx < static_cast<int>(audioData.deltaPitch.size()))
+        audioData.deltaPitch[static_cast<size_t>(e.idx)] = e.oldDelta;
+      if (e.idx < static_cast<int>(audioData.voicedMask.size()))
         audioData.voicedMask[e.idx] = e.oldVoiced;
-      }
-    }
+    });
   }
 
   // Clear drawing state
   isDrawing = false;
-  drawingEdits.clear();
-  drawingEditIndexByFrame.clear();
+  drawingStroke.clear();
   lastDrawFrame = -1;
   lastDrawValueCents = 0;
-  activeDrawCurve = nullptr;
-  drawCurves.clear();
+  ++speculativeGeneration;
+
+  repaint();
+}
+
+bool PianoRollComponent::resetPitchToOriginal(int startFrame, int endFrame) {
+  if (!project || isDrawing)
+    return false;
+
+  auto &audioData = project->getAudioData();
+  const int totalFrames = static_cast<int>(audioData.f0.size());
+  startFrame = std::max(0, startFrame);
+  endFrame = std::min(endFrame, totalFrames);
+  if (endFrame <= startFrame ||
+      audioData.deltaPitch.size() < audioData.f0.size() ||
+      audioData.basePitch.size() < audioData.f0.size())
+    return false;
+
+  std::vector<float> original(static_cast<size_t>(endFrame - startFrame));
+  PitchCurveProcessor::getOriginalPitchInRange(*project, startFrame, endFrame,
+                                               original.data());
+
+  // Frames outside the notes have no detected pitch to go back to and
+  // keep what they have
+  std::vector<F0FrameEdit> edits;
+  for (int i = startFrame; i < endFrame; ++i) {
+    const float hz = original[static_cast<size_t>(i - startFrame)];
+    if (hz <= 0.0f)
+      continue;
+    const auto idx = static_cast<size_t>(i);
+    const float newDelta = freqToMidi(hz) - audioData.basePitch[idx];
+    const bool oldVoiced = i < static_cast<int>(audioData.voicedMask.size())
+                               ? audioData.voicedMask[idx]
+                               : false;
+    if (std::abs(newDelta - audioData.deltaPitch[idx]) < 1.0e-4f && oldVoiced)
+      continue;
+    edits.push_back(F0FrameEdit{i, audioData.f0[idx], hz,
+                                audioData.deltaPitch[idx], newDelta, oldVoiced,
+                                true});
+  }
+  if (edits.empty())
+    return false;
+
+  const int minFrame = edits.front().idx;
+  const int maxFrame = edits.back().idx + 1;
+  for (const auto &e : edits) {
+    audioData.f0[static_cast<size_t>(e.idx)] = e.newF0;
+    audioData.deltaPitch[static_cast<size_t>(e.idx)] = e.newDelta;
+    if (e.idx < static_cast<int>(audioData.voicedMask.size()))
+      audioData.voicedMask[e.idx] = true;
+  }
+
+  // As after a drawn stroke, the notes follow the dense curve again
+  for (auto *note : project->getNotesInRange(minFrame, maxFrame)) {
+    if (note->hasDeltaPitch())
+      note->setDeltaPitch(std::vector<float>());
+  }
+  project->setF0DirtyRange(minFrame, maxFrame);
+
+  if (undoManager) {
+    undoManager->addAction(std::make_unique<F0EditAction>(
+        &audioData.f0, &audioData.deltaPitch, &audioData.voicedMask,
+        std::move(edits), [this](int changedStart, int changedEnd) {
+          if (project) {
+            project->setF0DirtyRange(changedStart, changedEnd);
+            if (onPitchEditFinished)
+              onPitchEditFinished();
+          }
+        }));
+  }
 
+  if (onPitchEditFinished)
+    onPitchEditFinished();
   repaint();
+  return true;
 }
 
 void PianoRollComponent::applyPitchPoint(int frameIndex, int midiCents) {
@@ -3235,180 +3299,83 @@ void PianoRollComponent::applyPitchPoint(int frameIndex, int midiCents) {
   if (frameIndex < 0 || frameIndex >= f0Size)
     return;
 
-  // Only start a new curve if there's no active curve (first point of drawing)
-  if (!activeDrawCurve) {
-    startNewPitchCurve(frameIndex, midiCents);
-    // First point of the new curve: apply and exit
-    auto applyFrameFirst = [&](int idx, int cents) {
-      const float newFreq = midiToFreq(static_cast<float>(cents) / 100.0f);
-      const float oldF0 = audioData.f0[idx];
-      const float oldDelta =
-          (idx < static_cast<int>(audioData.deltaPitch.size()))
-              ? audioData.deltaPitch[idx]
-              : 0.0f;
-      const bool oldVoiced =
-          (idx < static_cast<int>(audioData.voicedMask.size()))
-              ? audioData.voicedMask[idx]
-              : false;
-
-      float baseMidi = (idx < static_cast<int>(audioData.basePitch.size()))
-                           ? audioData.basePitch[static_cast<size_t>(idx)]
-                           : 0.0f;
-      float newMidi = static_cast<float>(cents) / 100.0f;
-      float newDelta = newMidi - baseMidi;
-
-      auto it = drawingEditIndexByFrame.find(idx);
-      if (it == drawingEditIndexByFrame.end()) {
-        drawingEditIndexByFrame.emplace(idx, drawingEdits.size());
-        drawingEdits.push_back(F0FrameEdit{idx, oldF0, newFreq, oldDelta,
-                                           newDelta, oldVoiced, true});
-        // Clear deltaPitch for any note containing this frame so changes are
-        // visible immediately
-        auto &notes = project->getNotes();
-        for (auto &note : notes) {
-          if (note.getStartFrame() <= idx && note.getEndFrame() > idx &&
-              note.hasDeltaPitch()) {
-            note.setDeltaPitch(std::vector<float>());
-            break;
-          }
-        }
-      } else {
-        auto &e = drawingEdits[it->second];
-        e.newF0 = newFreq;
-        e.newDelta = newDelta;
-        e.newVoiced = true;
-      }
-
-      audioData.f0[idx] = newFreq;
-      if (idx < static_cast<int>(audioData.deltaPitch.size())) {
-        audioData.deltaPitch[static_cast<size_t>(idx)] = newDelta;
-      }
-      if (idx < static_cast<int>(audioData.voicedMask.size()))
-        audioData.voicedMask[idx] = true;
-    };
-    applyFrameFirst(frameIndex, midiCents);
-    return;
-  }
-
+  bool touchedNewFrame = false;
   auto applyFrame = [&](int idx, int cents) {
     if (idx < 0 || idx >= f0Size)
       return;
 
     const float newFreq = midiToFreq(static_cast<float>(cents) / 100.0f);
-    const float oldF0 = audioData.f0[idx];
-    const float oldDelta = (idx < static_cast<int>(audioData.deltaPitch.size()))
-                               ? audioData.deltaPitch[idx]
-                               : 0.0f;
     const bool oldVoiced = (idx < static_cast<int>(audioData.voicedMask.size()))
                                ? audioData.voicedMask[idx]
                                : false;
+    const float baseMidi = audioData.basePitch[static_cast<size_t>(idx)];
+    const float newDelta = static_cast<float>(cents) / 100.0f - baseMidi;
 
-    float baseMidi = (idx < static_cast<int>(audioData.basePitch.size()))
-                         ? audioData.basePitch[static_cast<size_t>(idx)]
-                         : 0.0f;
-    float newMidi = static_cast<float>(cents) / 100.0f;
-    float newDelta = newMidi - baseMidi;
-
-    auto it = drawingEditIndexByFrame.find(idx);
-    if (it == drawingEditIndexByFrame.end()) {
-      drawingEditIndexByFrame.emplace(idx, drawingEdits.size());
-      drawingEdits.push_back(F0FrameEdit{idx, oldF0, newFreq, oldDelta,
-                                         newDelta, oldVoiced, true});
-
-      // Clear deltaPitch for any note containing this frame so changes are
-      // visible immediately
-      auto &notes = project->getNotes();
-      for (auto &note : notes) {
-        if (note.getStartFrame() <= idx && note.getEndFrame() > idx &&
-            note.hasDeltaPitch()) {
-          note.setDeltaPitch(std::vector<float>());
-          break;
-        }
-      }
-    } else {
-      auto &e = drawingEdits[it->second];
-      e.newF0 = newFreq;
-      e.newDelta = newDelta;
-      e.newVoiced = true;
-    }
+    touchedNewFrame = touchedNewFrame || !drawingStroke.contains(idx);
+    drawingStroke.record(F0FrameEdit{
+        idx, audioData.f0[static_cast<size_t>(idx)], newFreq,
+        audioData.deltaPitch[static_cast<size_t>(idx)], newDelta, oldVoiced,
+        true});
 
-    audioData.f0[idx] = newFreq;
-    if (idx < static_cast<int>(audioData.deltaPitch.size())) {
-      audioData.deltaPitch[static_cast<size_t>(idx)] = newDelta;
-    }
+    audioData.f0[static_cast<size_t>(idx)] = newFreq;
+    audioData.deltaPitch[static_cast<size_t>(idx)] = newDelta;
     if (idx < static_cast<int>(audioData.voicedMask.size()))
       audioData.voicedMask[idx] = true;
   };
 
-  auto appendValue = [&](int idx, int cents) {
-    if (!activeDrawCurve)
-      return;
-
-    const int curveStart = activeDrawCurve->localStart();
-    auto &vals = activeDrawCurve->mutableValues();
-
-    // Handle backward drawing: prepend values if idx < curveStart
-    if (idx < curveStart) {
-      const int prependCount = curveStart - idx;
-      std::vector<int> newVals(static_cast<size_t>(prependCount), cents);
-      newVals.insert(newVals.end(), vals.begin(), vals.end());
-      activeDrawCurve->setValues(std::move(newVals));
-      activeDrawCurve->setLocalStart(idx);
-      return;
-    }
-
-    const int offset = idx - curveStart;
-    if (offset < static_cast<int>(vals.size())) {
-      vals[static_cast<std::size_t>(offset)] = cents;
-      return;
-    }
-
-    while (static_cast<int>(vals.size()) < offset) {
-      int fill = vals.empty() ? cents : vals.back();
-      vals.push_back(fill);
-    }
-    vals.push_back(cents);
-  };
-
-  if (lastDrawFrame < 0) {
-    appendValue(frameIndex, midiCents);
+  // Frames between the previous point and this one are interpolated
+  int segmentStart = frameIndex;
+  int segmentEnd = frameIndex;
+  if (lastDrawFrame < 0 || lastDrawFrame == frameIndex) {
     applyFrame(frameIndex, midiCents);
   } else {
-    int start = lastDrawFrame;
-    int end = frameIndex;
-    int startVal = lastDrawValueCents;
-    int endVal = midiCents;
-
-    if (start == end) {
-      appendValue(frameIndex, midiCents);
-      applyFrame(frameIndex, midiCents);
-    } else {
-      int step = (end > start) ? 1 : -1;
-      int length = std::abs(end - start);
-      for (int i = 0; i <= length; ++i) {
-        int idx = start + i * step;
-        float t = length == 0
-                      ? 0.0f
-                      : static_cast<float>(i) / static_cast<float>(length);
-        float v = juce::jmap(t, 0.0f, 1.0f, static_cast<float>(startVal),
-                             static_cast<float>(endVal));
-        int cents = static_cast<int>(std::round(v));
-        appendValue(idx, cents);
-        applyFrame(idx, cents);
-      }
+    const int start = lastDrawFrame;
+    const int step = (frameIndex > start) ? 1 : -1;
+    const int length = std::abs(frameIndex - start);
+    for (int i = 0; i <= length; ++i) {
+      const float t = static_cast<float>(i) / static_cast<float>(length);
+      const float v =
+          juce::jmap(t, 0.0f, 1.0f, static_cast<float>(lastDrawValueCents),
+                     static_cast<float>(midiCents));
+      applyFrame(start + i * step, static_cast<int>(std::round(v)));
     }
+    segmentStart = std::min(start, frameIndex);
+    segmentEnd = std::max(start, frameIndex);
   }
 
   lastDrawFrame = frameIndex;
   lastDrawValueCents = midiCents;
+
+  // Notes under newly drawn frames drop their deltaPitch so the change shows
+  // immediately
+  if (touchedNewFrame) {
+    for (auto *note : project->getNotesInRange(segmentStart, segmentEnd + 1)) {
+      if (note->hasDeltaPitch())
+        note->setDeltaPitch(std::vector<float>());
+    }
+  }
+
+  // Streamed as the stroke grows rather than only on release
+  project->setF0DirtyRange(segmentStart, segmentEnd + 1);
+  if (speculativeSynthesis)
+    scheduleStrokePrefetch();
 }
 
-void PianoRollComponent::startNewPitchCurve(int frameIndex, int midiCents) {
-  drawCurves.push_back(std::make_unique<DrawCurve>(frameIndex, 1));
-  activeDrawCurve = drawCurves.back().get();
-  activeDrawCurve->appendValue(midiCents);
-  lastDrawFrame = frameIndex;
-  lastDrawValueCents = midiCents;
+void PianoRollComponent::scheduleStrokePrefetch() {
+  // Rest time after which the stroke so far is synthesized ahead of release
+  constexpr int settleMs = 120;
+
+  const int generation = ++speculativeGeneration;
+  juce::Component::SafePointer<PianoRollComponent> safeThis(this);
+  juce::Timer::callAfterDelay(settleMs, [safeThis, generation]() {
+    if (!safeThis || safeThis->speculativeGeneration != generation ||
+        !safeThis->isDrawing || safeThis->drawingStroke.empty() ||
+        !safeThis->onSpeculativeSynthesis || safeThis->previewMode)
+      return;
+    // The range commitPitchDrawing() marks dirty
+    safeThis->onSpeculativeSynthesis(safeThis->drawingStroke.getMinFrame(),
+                                     safeThis->drawingStroke.getMaxFrame());
+  });
 }
 
 void PianoRollComponent::drawSelectionRect(juce::Graphics &g) {
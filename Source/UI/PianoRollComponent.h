@@ -3,21 +3,25 @@
 #include "../JuceHeader.h"
 #include "../Models/Project.h"
 #include "../Utils/Constants.h"
-#include "../Utils/UI/DrawCurve.h"
 #include "../Utils/BasePitchPreview.h"
+#include "../Utils/F0StrokeBuffer.h"
 #include "../Utils/UndoManager.h"
+#include "../Utils/UI/GlyphCache.h"
 #include "Commands.h"
 #include "../Utils/CenteredMelSpectrogram.h"
 #include "PianoRoll/BoxSelector.h"
 #include "PianoRoll/CoordinateMapper.h"
+#include "PianoRoll/CurveGeometry.h"
 #include "PianoRoll/NoteSplitter.h"
+#include "PianoRoll/NoteThumbnailCache.h"
+#include "PianoRoll/PaintStats.h"
 #include "PianoRoll/PianoRollRenderer.h"
 #include "PianoRoll/PitchEditor.h"
 #include "PianoRoll/ScrollZoomController.h"
+#include "PianoRoll/SpectrogramTileCache.h"
 
-#include <deque>
+#include <limits>
 #include <memory>
-#include <unordered_map>
 
 class PitchUndoManager;
 
@@ -99,6 +103,11 @@ public:
   // drawing)
   void cancelDrawing();
 
+  // Put the detected pitch back over the notes in [startFrame, endFrame),
+  // dropping the curve drawn there while keeping note moves, as one undo
+  // step. Returns false when nothing differed.
+  bool resetPitchToOriginal(int startFrame, int endFrame);
+
   // View settings
   void setShowDeltaPitch(bool show) {
     showDeltaPitch = show;
@@ -108,8 +117,35 @@ public:
     showBasePitch = show;
     repaint();
   }
+  // Off also frees the spectrogram tiles
+  void setShowSpectrogram(bool show);
   bool getShowDeltaPitch() const { return showDeltaPitch; }
   bool getShowBasePitch() const { return showBasePitch; }
+  bool getShowSpectrogram() const { return showSpectrogram; }
+  // The mel spectrogram changed outside the piano roll (undo, redo)
+  void invalidateSpectrogram() {
+    spectrogramTiles.invalidate(0, std::numeric_limits<int>::max());
+    repaint();
+  }
+
+  // Debug overlay of per-layer paint times and cache hit rates
+  void setShowPaintStats(bool show);
+  bool getShowPaintStats() const { return paintStats.isEnabled(); }
+  // The overlay's last summary, written to the log for support reports
+  void logPaintStats() const;
+
+  // Opt-in: pre-render the hovered pitch while a note drag slows or rests
+  void setSpeculativeSynthesis(bool enabled) { speculativeSynthesis = enabled; }
+
+  // Rasterise through an attached OpenGL context instead of the software
+  // renderer; stays off when built without HACHITUNE_OPENGL
+  void setGpuRendering(bool enabled);
+  bool isGpuRendering() const { return gpuRendering; }
+
+  // Show a project that is still being analysed: it can be edited, but
+  // there is no audio for it to synthesize yet
+  void setPreviewMode(bool enabled) { previewMode = enabled; }
+  bool isPreviewMode() const { return previewMode; }
 
   // Callbacks
   std::function<void(Note *)> onNoteSelected;
@@ -117,15 +153,21 @@ public:
   std::function<void()> onPitchEditFinished; // Called when dragging ends
   std::function<void(double)> onSeek;
   std::function<void(float)> onZoomChanged;
+  // Either zoom may have changed, from any source; no arguments, so
+  // listeners read the current values
+  std::function<void()> onViewScaleChanged;
   std::function<void(double)> onScrollChanged;
   std::function<void(const LoopRange &)> onLoopRangeChanged;
   std::function<void(int, int)>
       onReinterpolateUV; // Called to re-infer UV regions (startFrame, endFrame)
+  std::function<void(int, int)>
+      onSpeculativeSynthesis; // F0 dirty range a release right now would set
 
 private:
   void drawBackgroundWaveform(juce::Graphics &g,
                               const juce::Rectangle<int> &visibleArea);
   void drawGrid(juce::Graphics &g);
+  void drawSpectrogram(juce::Graphics &g);
   void drawTimeline(juce::Graphics &g);
   void drawLoopTimeline(juce::Graphics &g);
   void drawNotes(juce::Graphics &g);
@@ -136,6 +178,14 @@ private:
   void drawSelectionRect(juce::Graphics &g); // Box selection rectangle
   void drawLoopOverlay(juce::Graphics &g);
   void drawStretchGuides(juce::Graphics &g);
+  void drawSplitGuide(juce::Graphics &g);
+  // Everything but the overlays below, into layerCache
+  void paintLayers(juce::Graphics &g);
+  void drawPlayhead(juce::Graphics &g);
+  // Component-space bounds of an overlay, for repainting just that
+  juce::Rectangle<int> getSelectionRectArea() const;
+  juce::Rectangle<int> getSplitGuideArea() const;
+  juce::Rectangle<int> getPaintStatsArea() const;
 
   float midiToY(float midiNote) const;
   float yToMidi(float y) const;
@@ -145,11 +195,18 @@ private:
   Note *findNoteAt(float x, float y);
   void updateScrollBars();
   void updateBasePitchCacheIfNeeded();
+  // The project's notes changed: patch the drawn base pitch over the frames
+  // touched, after rebuilding the curves there if a step is being replayed
+  void handleNoteChanges(const std::vector<NoteChange> &changes);
   void reapplyBasePitchForNote(
       Note *note); // Recalculate F0 from base pitch + delta after undo/redo
   void prepareDragBasePreview();
   void applyDragBasePreview(float pitchOffsetSemitones);
   void restoreDragBasePreview();
+  // Note range plus adjacent notes whose base pitch a drag release rebuilds
+  std::pair<int, int> getDragExpandedRange(const Note &note) const;
+  void updateSpeculativeSynthesis(float pitchOffsetSemitones);
+  void startSpeculativeSynthesis();
   struct StretchBoundary {
     Note *left = nullptr;
     Note *right = nullptr;
@@ -176,9 +233,11 @@ private:
     std::vector<float> rightDelta;
     std::vector<bool> leftVoiced;
     std::vector<bool> rightVoiced;
-    std::vector<float> originalLeftClip;
-    std::vector<float> originalRightClip;
-    std::vector<std::vector<float>> originalMelRangeFull;
+    WaveformClip originalLeftClip;
+    WaveformClip originalRightClip;
+    std::vector<float> originalLeftSamples;  // Resampling input, read once
+    std::vector<float> originalRightSamples;
+    MelBuffer originalMelRangeFull;
     std::vector<float> originalDeltaRangeFull;
     std::vector<bool> originalVoicedRangeFull;
   };
@@ -188,15 +247,22 @@ private:
   void startStretchDrag(const StretchBoundary &boundary);
   void updateStretchDrag(int targetFrame);
   void finishStretchDrag();
+  // Append the mel of a note stretched from [originalStart, originalEnd) to
+  // newLength frames, as of the drag's start
+  void appendStretchedNoteMel(MelBuffer &dest, int originalStart,
+                              int originalEnd, int newLength,
+                              const RenderSnapshot::Ptr &source);
   void cancelStretchDrag();
 
   // Pitch drawing helpers
   void applyPitchDrawing(float x, float y);
   void commitPitchDrawing();
   void applyPitchPoint(int frameIndex, int midiCents);
-  void startNewPitchCurve(int frameIndex, int midiCents);
+  // Speculative synthesis of the stroke so far once the pointer rests
+  void scheduleStrokePrefetch();
 
   Project *project = nullptr;
+  NoteChangeFeed::Subscription noteChangeSubscription;
   PitchUndoManager *undoManager = nullptr;
 
   // New modular components
@@ -226,6 +292,7 @@ private:
   // View settings
   bool showDeltaPitch = true;
   bool showBasePitch = false;
+  bool showSpectrogram = false;
 
   // Dragging state
   bool isDragging = false;
@@ -244,14 +311,20 @@ private:
   std::vector<float> dragBasePitchSnapshot;
   std::vector<float> dragF0Snapshot;
 
+  // Speculative synthesis during single-note drags
+  bool speculativeSynthesis = false;
+  bool previewMode = false;
+  float lastSpeculativeOffset = 0.0f;
+  double lastSpeculativeTime = 0.0;
+  float lastDragSampleOffset = 0.0f;
+  double lastDragSampleTime = 0.0;
+  int speculativeGeneration = 0;
+
   // Pitch drawing state
   bool isDrawing = false;
-  std::vector<F0FrameEdit> drawingEdits; // unique edits per frame
-  std::unordered_map<int, size_t> drawingEditIndexByFrame;
+  F0StrokeBuffer drawingStroke; // unique edits per frame
   int lastDrawFrame = -1;
   int lastDrawValueCents = 0;
-  DrawCurve *activeDrawCurve = nullptr;
-  std::deque<std::unique_ptr<DrawCurve>> drawCurves;
 
   // Split mode guide line
   float splitGuideX =
@@ -286,12 +359,9 @@ private:
   juce::ScrollBar horizontalScrollBar{false};
   juce::ScrollBar verticalScrollBar{true};
 
-  // Waveform cache for performance
-  juce::Image waveformCache;
-  double cachedScrollX = -1.0;
-  float cachedPixelsPerSecond = -1.0f;
-  int cachedWidth = 0;
-  int cachedHeight = 0;
+  // Pitch and base pitch curve vertices and path, reused across paints
+  CurveGeometry curveGeometry;
+  juce::Path curvePath;
 
   // Base pitch curve cache for performance
   // Only recalculates when notes change, not on every repaint
@@ -299,20 +369,49 @@ private:
   size_t cachedNoteCount = 0;
   int cachedTotalFrames = 0;
   bool cacheInvalidated = true; // Start invalidated, force first calculation
+  // Frames to copy from the project's base pitch on the next paint, by which
+  // time whoever changed the notes has rebuilt the curves there
+  std::vector<std::pair<int, int>> pendingBasePitchRanges;
 
 public:
   void invalidateBasePitchCache() {
     cacheInvalidated = true;
     cachedNoteCount = 0;
+    pendingBasePitchRanges.clear();
     cachedBasePitch.clear();
     cachedBasePitch.shrink_to_fit(); // Release memory
   }
+  // Only [startFrame, endFrame) changed, and the project's base pitch there
+  // is already rebuilt: copied into a valid cache in place
+  void invalidateBasePitchCache(int startFrame, int endFrame);
 
 private:
   // Optional: disable base pitch rendering for performance testing
   static constexpr bool ENABLE_BASE_PITCH_DEBUG =
       true; // Set to false to disable
 
+  // The static layers as last painted in full, at the display's physical
+  // scale. Partial repaints (playhead, selection rectangle, split guide)
+  // blit it and draw their overlay on top; see paint()
+  juce::Image layerCache;
+  float layerCacheScale = 0.0f;
+
+  // Note waveform bodies; drawn into the layers, so a finished thumbnail
+  // repaints in full
+  NoteThumbnailCache noteThumbnails;
+  // Mel behind the grid lines; stretches overwrite mel in place, so each
+  // copyFrames() is followed by invalidate() over its frames
+  SpectrogramTileCache spectrogramTiles;
+  // Timeline labels and key names, shaped once
+  GlyphCache glyphs;
+  PaintStats paintStats;
+
+  // GPU path: everything is drawn each paint, as geometry and textures
+  bool gpuRendering = false;
+#ifdef HACHITUNE_OPENGL
+  juce::OpenGLContext openGLContext;
+#endif
+
   // Mouse drag throttling
   juce::int64 lastDragRepaintTime = 0;
   static constexpr juce::int64 minDragRepaintInterval = 16; // ~60fps max
@@ -94,7 +94,12 @@ PianoRollWorkspaceView::PianoRollWorkspaceView(PianoRollComponent &piano)
   addAndMakeVisible(zoomYSlider);
 
   updateOverviewVisibility();
-  startTimerHz(10);
+  pianoRoll.onViewScaleChanged = [this]() { syncZoomSliders(); };
+}
+
+PianoRollWorkspaceView::~PianoRollWorkspaceView()
+{
+  pianoRoll.onViewScaleChanged = nullptr;
 }
 
 void PianoRollWorkspaceView::paint(juce::Graphics &g)
@@ -177,7 +182,7 @@ void PianoRollWorkspaceView::updateOverviewVisibility()
   overviewPanel.setVisible(overviewVisible);
 }
 
-void PianoRollWorkspaceView::timerCallback()
+void PianoRollWorkspaceView::syncZoomSliders()
 {
   const float pps = pianoRoll.getPixelsPerSecond();
   if (std::abs(zoomXSlider.getValue() - pps) > 0.05)
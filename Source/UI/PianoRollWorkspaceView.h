@@ -6,13 +6,13 @@
 #include "PianoRoll/OverviewPanel.h"
 #include "Workspace/RoundedCard.h"
 
-class PianoRollWorkspaceView : public juce::Component, private juce::Timer {
+class PianoRollWorkspaceView : public juce::Component {
 public:
   explicit PianoRollWorkspaceView(PianoRollComponent &pianoRoll);
+  ~PianoRollWorkspaceView() override;
 
   void paint(juce::Graphics &g) override;
   void resized() override;
-  void timerCallback() override;
 
   void setProject(Project *project);
   void refreshOverview();
@@ -20,6 +20,8 @@ public:
 
 private:
   void updateOverviewVisibility();
+  // Follow the piano roll's zoom on the sliders
+  void syncZoomSliders();
 
   PianoRollComponent &pianoRoll;
   OverviewPanel overviewPanel;
@@ -1,49 +1,15 @@
 #include "SettingsComponent.h"
+#include "../Audio/HardwareCapabilities.h"
+#include "../Utils/AppLogger.h"
 #include "../Utils/Constants.h"
+#include "../Utils/PlatformPaths.h"
 #include "../Utils/UI/Theme.h"
 #include "../Utils/Localization.h"
-
-#ifdef HAVE_ONNXRUNTIME
-#include <onnxruntime_cxx_api.h>
-#endif
-
-#ifdef _WIN32
-#include <dxgi1_2.h>
-#include <windows.h>
-#endif
+#include <iterator>
 
 namespace {
-#ifdef _WIN32
-juce::StringArray getDxgiAdapterNames() {
-  juce::StringArray names;
-  IDXGIFactory1 *factory = nullptr;
-  if (FAILED(CreateDXGIFactory1(__uuidof(IDXGIFactory1),
-                                reinterpret_cast<void **>(&factory))) ||
-      factory == nullptr) {
-    return names;
-  }
-
-  for (UINT i = 0;; ++i) {
-    IDXGIAdapter1 *adapter = nullptr;
-    const auto hr = factory->EnumAdapters1(i, &adapter);
-    if (hr == DXGI_ERROR_NOT_FOUND)
-      break;
-    if (FAILED(hr) || adapter == nullptr)
-      continue;
-
-    DXGI_ADAPTER_DESC1 desc{};
-    if (SUCCEEDED(adapter->GetDesc1(&desc))) {
-      if ((desc.Flags & DXGI_ADAPTER_FLAG_SOFTWARE) == 0) {
-        names.add(juce::String(desc.Description));
-      }
-    }
-    adapter->Release();
-  }
-
-  factory->Release();
-  return names;
-}
-#endif
+// Memory budget choices in MB; the first entry (0) means unlimited
+constexpr int memoryBudgetChoicesMB[] = {0, 512, 1024, 2048, 4096};
 } // namespace
 
 //==============================================================================
@@ -53,7 +19,8 @@ juce::StringArray getDxgiAdapterNames() {
 SettingsComponent::SettingsComponent(
     SettingsManager *settingsMgr, juce::AudioDeviceManager *audioDeviceManager)
     : deviceManager(audioDeviceManager),
-      pluginMode(audioDeviceManager == nullptr), settingsManager(settingsMgr) {
+      pluginMode(audioDeviceManager == nullptr), settingsManager(settingsMgr),
+      performancePanel(audioDeviceManager) {
   // Allow transparent corners for rounded window styling
   setOpaque(false);
 
@@ -86,6 +53,33 @@ SettingsComponent::SettingsComponent(
   audioTabButton.onClick = [this]() { setActiveTab(SettingsTab::Audio); };
   addAndMakeVisible(audioTabButton);
 
+  performanceTabButton.setButtonText(TR("settings.performance"));
+  configureTabButton(performanceTabButton);
+  performanceTabButton.onClick = [this]() {
+    setActiveTab(SettingsTab::Performance);
+  };
+  addAndMakeVisible(performanceTabButton);
+
+  addChildComponent(performancePanel);
+
+  performanceExportButton.setButtonText(TR("settings.perf_export"));
+  performanceExportButton.setLookAndFeel(&settingsLookAndFeel);
+  performanceExportButton.setMouseCursor(
+      juce::MouseCursor::PointingHandCursor);
+  performanceExportButton.onClick = [this]() {
+    auto file = PlatformPaths::getLogFile(
+        "performance_" + AppLogger::getSessionId() + "_" +
+        juce::Time::getCurrentTime().formatted("%H%M%S") + ".json");
+    if (performancePanel.exportTo(file)) {
+      LOG("Performance snapshot written to " + file.getFullPathName());
+      file.revealToUser();
+    } else {
+      LOG_WARNING("Failed to write performance snapshot to " +
+                  file.getFullPathName());
+    }
+  };
+  addChildComponent(performanceExportButton);
+
   // General section label
   generalSectionLabel.setText(TR("settings.general"),
                               juce::dontSendNotification);
@@ -144,6 +138,85 @@ SettingsComponent::SettingsComponent(
   pitchDetectorComboBox.setLookAndFeel(&settingsLookAndFeel);
   addAndMakeVisible(pitchDetectorComboBox);
 
+  // Provider benchmark (re-run after hardware or driver changes)
+  benchmarkLabel.setText(TR("settings.benchmark"), juce::dontSendNotification);
+  configureRowLabel(benchmarkLabel);
+  addAndMakeVisible(benchmarkLabel);
+
+  benchmarkButton.setButtonText(TR("settings.run_benchmark"));
+  benchmarkButton.setLookAndFeel(&settingsLookAndFeel);
+  benchmarkButton.setMouseCursor(juce::MouseCursor::PointingHandCursor);
+  benchmarkButton.onClick = [this]() {
+    if (onRunProviderBenchmark)
+      onRunProviderBenchmark();
+  };
+  addAndMakeVisible(benchmarkButton);
+
+  // Memory budget (caches and undo history are trimmed to stay under it)
+  memoryBudgetLabel.setText(TR("settings.memory_budget"),
+                            juce::dontSendNotification);
+  configureRowLabel(memoryBudgetLabel);
+  addAndMakeVisible(memoryBudgetLabel);
+
+  memoryBudgetComboBox.addItem(TR("settings.memory_unlimited"), 1);
+  for (int i = 1; i < static_cast<int>(std::size(memoryBudgetChoicesMB)); ++i)
+    memoryBudgetComboBox.addItem(
+        juce::String(memoryBudgetChoicesMB[i]) + " MB", i + 1);
+  memoryBudgetComboBox.setSelectedId(1, juce::dontSendNotification);
+  memoryBudgetComboBox.addListener(this);
+  memoryBudgetComboBox.setLookAndFeel(&settingsLookAndFeel);
+  addAndMakeVisible(memoryBudgetComboBox);
+
+  // Piano roll renderer; the GPU entry only exists in OpenGL builds
+  renderingLabel.setText(TR("settings.renderer"), juce::dontSendNotification);
+  configureRowLabel(renderingLabel);
+  addAndMakeVisible(renderingLabel);
+
+  renderingComboBox.addItem(TR("settings.renderer_software"), 1);
+#ifdef HACHITUNE_OPENGL
+  renderingComboBox.addItem(TR("settings.renderer_gpu"), 2);
+#endif
+  renderingComboBox.setSelectedId(1, juce::dontSendNotification);
+  renderingComboBox.addListener(this);
+  renderingComboBox.setLookAndFeel(&settingsLookAndFeel);
+  addAndMakeVisible(renderingComboBox);
+
+  // Paint-cost overlay on the piano roll, and a copy of it for the log
+  paintStatsLabel.setText(TR("settings.paint_stats"),
+                          juce::dontSendNotification);
+  configureRowLabel(paintStatsLabel);
+  addAndMakeVisible(paintStatsLabel);
+
+  paintStatsComboBox.addItem(TR("settings.paint_stats_off"), 1);
+  paintStatsComboBox.addItem(TR("settings.paint_stats_overlay"), 2);
+  paintStatsComboBox.setSelectedId(1, juce::dontSendNotification);
+  paintStatsComboBox.addListener(this);
+  paintStatsComboBox.setLookAndFeel(&settingsLookAndFeel);
+  addAndMakeVisible(paintStatsComboBox);
+
+  paintStatsLogButton.setButtonText(TR("settings.paint_stats_log"));
+  paintStatsLogButton.setLookAndFeel(&settingsLookAndFeel);
+  paintStatsLogButton.setMouseCursor(juce::MouseCursor::PointingHandCursor);
+  paintStatsLogButton.onClick = [this]() {
+    if (onLogPaintStats)
+      onLogPaintStats();
+  };
+  addAndMakeVisible(paintStatsLogButton);
+
+  memoryUsageLabel.setText(TR("settings.memory_usage"),
+                           juce::dontSendNotification);
+  configureRowLabel(memoryUsageLabel);
+  addAndMakeVisible(memoryUsageLabel);
+
+  configureRowLabel(memoryUsageValueLabel);
+  memoryUsageValueLabel.setJustificationType(juce::Justification::centredRight);
+  addAndMakeVisible(memoryUsageValueLabel);
+
+  memoryDetailLabel.setColour(juce::Label::textColourId, APP_COLOR_TEXT_MUTED);
+  memoryDetailLabel.setFont(AppFont::getFont(13.0f));
+  memoryDetailLabel.setJustificationType(juce::Justification::topLeft);
+  addAndMakeVisible(memoryDetailLabel);
+
   // Info label
   infoLabel.setColour(juce::Label::textColourId, APP_COLOR_TEXT_MUTED);
   infoLabel.setFont(AppFont::getFont(13.0f));
@@ -209,8 +282,11 @@ SettingsComponent::SettingsComponent(
     addAndMakeVisible(outputChannelsComboBox);
 
     updateAudioDeviceTypes();
-    startTimer(2000);
   }
+  // Hot-plugged GPUs come in through the capabilities service and audio
+  // devices through the device manager; the timer only refreshes memory
+  HardwareCapabilities::getInstance().addChangeListener(this);
+  startTimer(2000);
 
   // Load saved settings
   loadSettings();
@@ -221,21 +297,29 @@ SettingsComponent::SettingsComponent(
 
   // Set size based on mode
   if (pluginMode)
-    setSize(720, 420);
+    setSize(720, 580);
   else
-    setSize(820, 620);
+    setSize(820, 740);
 }
 
 SettingsComponent::~SettingsComponent() {
   stopTimer();
+  HardwareCapabilities::getInstance().removeChangeListener(this);
   if (!pluginMode && deviceManager != nullptr)
     deviceManager->removeChangeListener(this);
   generalTabButton.setLookAndFeel(nullptr);
   audioTabButton.setLookAndFeel(nullptr);
+  performanceTabButton.setLookAndFeel(nullptr);
   languageComboBox.setLookAndFeel(nullptr);
   deviceComboBox.setLookAndFeel(nullptr);
   gpuDeviceComboBox.setLookAndFeel(nullptr);
   pitchDetectorComboBox.setLookAndFeel(nullptr);
+  benchmarkButton.setLookAndFeel(nullptr);
+  memoryBudgetComboBox.setLookAndFeel(nullptr);
+  renderingComboBox.setLookAndFeel(nullptr);
+  paintStatsComboBox.setLookAndFeel(nullptr);
+  paintStatsLogButton.setLookAndFeel(nullptr);
+  performanceExportButton.setLookAndFeel(nullptr);
   audioDeviceTypeComboBox.setLookAndFeel(nullptr);
   audioOutputComboBox.setLookAndFeel(nullptr);
   sampleRateComboBox.setLookAndFeel(nullptr);
@@ -247,11 +331,35 @@ void SettingsComponent::changeListenerCallback(
     juce::ChangeBroadcaster *source) {
   if (source == deviceManager)
     updateAudioOutputDevices(true);
+  else if (source == &HardwareCapabilities::getInstance() &&
+           shouldShowGpuDeviceList())
+    updateGPUDeviceList(currentDevice);
 }
 
-void SettingsComponent::timerCallback() {
-  if (!pluginMode && deviceManager != nullptr)
-    updateAudioOutputDevices(false);
+void SettingsComponent::timerCallback() { updateMemoryUsage(); }
+
+void SettingsComponent::updateMemoryUsage() {
+  if (!getMemoryReport)
+    return;
+
+  const auto report = getMemoryReport();
+  auto size = [](size_t bytes) {
+    return juce::File::descriptionOfSizeInBytes(static_cast<juce::int64>(bytes));
+  };
+  memoryUsageValueLabel.setText(size(report.getTotalBytes()),
+                                juce::dontSendNotification);
+  memoryDetailLabel.setText(
+      TR("settings.memory_waveform") + " " +
+          size(report.waveformBytes + report.snapshotBytes) + "  " +
+          TR("settings.memory_mel") + " " + size(report.melBytes) + "  " +
+          TR("settings.memory_pitch") + " " + size(report.pitchCurveBytes) +
+          "\n" + TR("settings.memory_notes") + " " + size(report.noteBytes) +
+          "  " + TR("settings.memory_undo") + " " + size(report.undoBytes) +
+          "  " + TR("settings.memory_cache") + " " + size(report.cacheBytes) +
+          (report.pagedBytes > 0 ? "  " + TR("settings.memory_paged") + " " +
+                                       size(report.pagedBytes)
+                                 : juce::String()),
+      juce::dontSendNotification);
 }
 
 void SettingsComponent::paint(juce::Graphics &g) {
@@ -305,8 +413,12 @@ void SettingsComponent::resized() {
   auto tabArea = sidebarBounds.reduced(10, 10);
   const int tabHeight = 32;
   generalTabButton.setBounds(tabArea.removeFromTop(tabHeight));
+  if (audioTabButton.isVisible()) {
+    tabArea.removeFromTop(6);
+    audioTabButton.setBounds(tabArea.removeFromTop(tabHeight));
+  }
   tabArea.removeFromTop(6);
-  audioTabButton.setBounds(tabArea.removeFromTop(tabHeight));
+  performanceTabButton.setBounds(tabArea.removeFromTop(tabHeight));
 
   bounds.removeFromLeft(10);
 
@@ -344,6 +456,19 @@ void SettingsComponent::resized() {
     }
 
     layoutRow(pitchDetectorLabel, pitchDetectorComboBox);
+    layoutRow(benchmarkLabel, benchmarkButton);
+    layoutRow(renderingLabel, renderingComboBox);
+    layoutRow(paintStatsLabel, paintStatsComboBox);
+    {
+      auto controls = paintStatsComboBox.getBounds();
+      paintStatsLogButton.setBounds(controls.removeFromRight(64));
+      controls.removeFromRight(6);
+      paintStatsComboBox.setBounds(controls);
+    }
+    layoutRow(memoryBudgetLabel, memoryBudgetComboBox);
+    layoutRow(memoryUsageLabel, memoryUsageValueLabel);
+    memoryDetailLabel.setBounds(content.removeFromTop(36));
+    content.removeFromTop(rowGap);
 
     infoLabel.setBounds(content.removeFromTop(56));
     content.removeFromTop(12);
@@ -361,6 +486,13 @@ void SettingsComponent::resized() {
     layoutRow(bufferSizeLabel, bufferSizeComboBox);
     layoutRow(outputChannelsLabel, outputChannelsComboBox);
   }
+
+  if (activeTab == SettingsTab::Performance) {
+    auto exportRow = content.removeFromBottom(rowHeight);
+    performanceExportButton.setBounds(
+        exportRow.removeFromRight(96).reduced(0, 2));
+    performancePanel.setBounds(content);
+  }
 }
 
 void SettingsComponent::comboBoxChanged(juce::ComboBox *comboBox) {
@@ -456,6 +588,32 @@ void SettingsComponent::comboBoxChanged(juce::ComboBox *comboBox) {
 
     if (onPitchDetectorChanged)
       onPitchDetectorChanged(pitchDetectorType);
+  } else if (comboBox == &memoryBudgetComboBox) {
+    const int index = memoryBudgetComboBox.getSelectedId() - 1;
+    if (index >= 0 &&
+        index < static_cast<int>(std::size(memoryBudgetChoicesMB)) &&
+        settingsManager) {
+      settingsManager->setMemoryBudgetMB(memoryBudgetChoicesMB[index]);
+      settingsManager->saveConfig();
+    }
+    if (onMemoryBudgetChanged)
+      onMemoryBudgetChanged();
+    updateMemoryUsage();
+  } else if (comboBox == &renderingComboBox) {
+    if (settingsManager) {
+      settingsManager->setGpuRendering(renderingComboBox.getSelectedId() == 2);
+      settingsManager->saveConfig();
+    }
+    if (onRenderingChanged)
+      onRenderingChanged();
+  } else if (comboBox == &paintStatsComboBox) {
+    if (settingsManager) {
+      settingsManager->setShowPaintStats(paintStatsComboBox.getSelectedId() ==
+                                         2);
+      settingsManager->saveConfig();
+    }
+    if (onPaintStatsChanged)
+      onPaintStatsChanged();
   } else if (comboBox == &audioDeviceTypeComboBox) {
     int idx = audioDeviceTypeComboBox.getSelectedId() - 1;
     if (idx >= 0 && idx < audioDeviceTypeOrder.size()) {
@@ -506,6 +664,7 @@ void SettingsComponent::updateTabButtonStyles() {
 
   applyStyle(generalTabButton, activeTab == SettingsTab::General);
   applyStyle(audioTabButton, activeTab == SettingsTab::Audio);
+  applyStyle(performanceTabButton, activeTab == SettingsTab::Performance);
 }
 
 void SettingsComponent::updateTabVisibility() {
@@ -524,6 +683,18 @@ void SettingsComponent::updateTabVisibility() {
   gpuDeviceComboBox.setVisible(showGeneral && showGpuDeviceList);
   pitchDetectorLabel.setVisible(showGeneral);
   pitchDetectorComboBox.setVisible(showGeneral);
+  benchmarkLabel.setVisible(showGeneral);
+  benchmarkButton.setVisible(showGeneral);
+  renderingLabel.setVisible(showGeneral);
+  renderingComboBox.setVisible(showGeneral);
+  paintStatsLabel.setVisible(showGeneral);
+  paintStatsComboBox.setVisible(showGeneral);
+  paintStatsLogButton.setVisible(showGeneral);
+  memoryBudgetLabel.setVisible(showGeneral);
+  memoryBudgetComboBox.setVisible(showGeneral);
+  memoryUsageLabel.setVisible(showGeneral);
+  memoryUsageValueLabel.setVisible(showGeneral);
+  memoryDetailLabel.setVisible(showGeneral);
   infoLabel.setVisible(showGeneral);
 
   audioSectionLabel.setVisible(showAudio);
@@ -538,16 +709,20 @@ void SettingsComponent::updateTabVisibility() {
   outputChannelsLabel.setVisible(showAudio);
   outputChannelsComboBox.setVisible(showAudio);
 
+  performancePanel.setVisible(activeTab == SettingsTab::Performance);
+  performanceExportButton.setVisible(activeTab == SettingsTab::Performance);
+
   audioTabButton.setVisible(!pluginMode && deviceManager != nullptr);
 
-  if (pluginMode || deviceManager == nullptr)
+  if ((pluginMode || deviceManager == nullptr) &&
+      activeTab == SettingsTab::Audio)
     setActiveTab(SettingsTab::General);
 }
 
 void SettingsComponent::updateDeviceList() {
   deviceComboBox.clear();
 
-  auto devices = getAvailableDevices();
+  const auto devices = HardwareCapabilities::getInstance().get()->devices;
   int selectedIndex = 0;
 
   // Auto-select based on compile-time flags (first run only)
@@ -600,94 +775,27 @@ void SettingsComponent::updateGPUDeviceList(const juce::String &deviceType) {
   }
 
 #ifdef HAVE_ONNXRUNTIME
-  if (deviceType == "CUDA") {
-#ifdef USE_CUDA
-    int deviceCount = 0;
-    bool devicesDetected = false;
-    juce::StringArray cudaDeviceNames;
-
-    // Try to load CUDA runtime library to get actual device count and names
-#ifdef _WIN32
-    const char *cudaDllNames[] = {
-        "cudart64_12.dll", // CUDA 12.x
-        "cudart64_11.dll", // CUDA 11.x
-        "cudart64_10.dll", // CUDA 10.x
-        "cudart64.dll"     // Generic
-    };
-
-    HMODULE cudaLib = nullptr;
-    for (const char *dllName : cudaDllNames) {
-      cudaLib = LoadLibraryA(dllName);
-      if (cudaLib) {
-        DBG("Loaded CUDA runtime: " + juce::String(dllName));
-        break;
-      }
-    }
-
-    if (cudaLib) {
-      typedef int (*cudaGetDeviceCountFunc)(int *);
-      typedef int (*cudaGetDevicePropertiesFunc)(void *, int);
-
-      auto cudaGetDeviceCount =
-          (cudaGetDeviceCountFunc)GetProcAddress(cudaLib, "cudaGetDeviceCount");
-
-      if (cudaGetDeviceCount) {
-        int result = cudaGetDeviceCount(&deviceCount);
-        if (result == 0 && deviceCount > 0) {
-          DBG("CUDA device count: " + juce::String(deviceCount));
-
-          // Try to get device properties for names
-          auto cudaGetDeviceProperties =
-              (cudaGetDevicePropertiesFunc)GetProcAddress(
-                  cudaLib, "cudaGetDeviceProperties");
-
-          for (int deviceId = 0; deviceId < deviceCount; ++deviceId) {
-            juce::String deviceName = "GPU " + juce::String(deviceId);
-
-            // Try to get device name from properties
-            if (cudaGetDeviceProperties) {
-              // Allocate full cudaDeviceProp structure (it's large, ~1KB)
-              // We can't use the actual struct without CUDA headers, so
-              // allocate enough space
-              char propBuffer[2048]; // Large enough for cudaDeviceProp
-              memset(propBuffer, 0, sizeof(propBuffer));
-
-              if (cudaGetDeviceProperties(propBuffer, deviceId) == 0) {
-                // Device name is at the start of the structure
-                char *name = propBuffer;
-                if (name[0] != '\0') {
-                  deviceName = juce::String(name);
-                  DBG("CUDA device " + juce::String(deviceId) + ": " +
-                      deviceName);
-                }
-              }
-            }
-
-            cudaDeviceNames.add(deviceName + " (CUDA)");
-          }
-          devicesDetected = true;
-        } else {
-          DBG("cudaGetDeviceCount failed or returned 0 devices");
+  const auto hardware = HardwareCapabilities::getInstance().get();
+  auto addAdapters =
+      [this](const std::vector<HardwareCapabilities::Adapter> &adapters,
+             const juce::String &api) {
+        for (const auto &adapter : adapters) {
+          auto label = adapter.name + " (" + api;
+          if (adapter.memoryBytes > 0)
+            label << ", "
+                  << juce::File::descriptionOfSizeInBytes(adapter.memoryBytes);
+          gpuDeviceComboBox.addItem(label + ")", adapter.deviceId + 1);
         }
-      }
-      FreeLibrary(cudaLib);
-    } else {
-      DBG("Failed to load CUDA runtime library");
-    }
-#endif
+      };
+  juce::ignoreUnused(hardware, addAdapters);
 
-    if (devicesDetected && cudaDeviceNames.size() > 0) {
-      for (int i = 0; i < cudaDeviceNames.size(); ++i)
-        gpuDeviceComboBox.addItem(cudaDeviceNames[i], i + 1);
-    } else {
-#ifdef _WIN32
-      auto dxgiNames = getDxgiAdapterNames();
-      if (dxgiNames.size() > 0) {
-        for (int i = 0; i < dxgiNames.size(); ++i)
-          gpuDeviceComboBox.addItem(dxgiNames[i] + " (DXGI)", i + 1);
-      }
-#endif
-    }
+  if (deviceType == "CUDA") {
+#ifdef USE_CUDA
+    // DXGI names stand in when the CUDA driver cannot be asked
+    if (!hardware->cudaDevices.empty())
+      addAdapters(hardware->cudaDevices, "CUDA");
+    else
+      addAdapters(hardware->dxgiAdapters, "DXGI");
 
     // If no devices detected, add default
     if (gpuDeviceComboBox.getNumItems() == 0) {
@@ -702,16 +810,8 @@ void SettingsComponent::updateGPUDeviceList(const juce::String &deviceType) {
 #endif
   } else if (deviceType == "DirectML") {
 #ifdef USE_DIRECTML
-    bool addedFromDxgi = false;
-#ifdef _WIN32
-    auto dxgiNames = getDxgiAdapterNames();
-    if (dxgiNames.size() > 0) {
-      for (int i = 0; i < dxgiNames.size(); ++i)
-        gpuDeviceComboBox.addItem(dxgiNames[i] + " (DirectML)", i + 1);
-      addedFromDxgi = true;
-    }
-#endif
-    if (!addedFromDxgi) {
+    addAdapters(hardware->dxgiAdapters, "DirectML");
+    if (gpuDeviceComboBox.getNumItems() == 0) {
       // DirectML fallback: provide a small default list
       for (int deviceId = 0; deviceId < 4; ++deviceId) {
         gpuDeviceComboBox.addItem(
@@ -740,95 +840,6 @@ void SettingsComponent::updateGPUDeviceList(const juce::String &deviceType) {
 #endif
 }
 
-juce::StringArray SettingsComponent::getAvailableDevices() {
-  juce::StringArray devices;
-
-  // CPU is always available
-  devices.add("CPU");
-
-#ifdef HAVE_ONNXRUNTIME
-  try {
-    // Get providers that are compiled into the ONNX Runtime library
-    auto availableProviders = Ort::GetAvailableProviders();
-
-    // Check which providers are available
-    bool hasCuda = false, hasDml = false, hasCoreML = false,
-         hasTensorRT = false;
-
-    DBG("=== ONNX Runtime Provider Detection ===");
-    DBG("Total providers found: " + juce::String(availableProviders.size()));
-    DBG("Available ONNX Runtime providers:");
-    for (const auto &provider : availableProviders) {
-      juce::String providerStr(provider);
-      DBG("  - " + providerStr);
-
-      if (providerStr == "CUDAExecutionProvider")
-        hasCuda = true;
-      else if (providerStr == "DmlExecutionProvider")
-        hasDml = true;
-      else if (providerStr == "CoreMLExecutionProvider")
-        hasCoreML = true;
-      else if (providerStr == "TensorrtExecutionProvider")
-        hasTensorRT = true;
-    }
-
-    // Add available GPU providers based on compile-time flags
-    // DML and CUDA are mutually exclusive
-#ifdef USE_DIRECTML
-    if (hasDml) {
-      devices.add("DirectML");
-      DBG("DirectML provider: ENABLED");
-    }
-#elif defined(USE_CUDA)
-    if (hasCuda) {
-      devices.add("CUDA");
-      DBG("CUDA provider: ENABLED");
-    }
-#else
-    // No GPU compiled in, but show available providers for information
-    if (hasCuda) {
-      devices.add("CUDA");
-      DBG("CUDA provider: AVAILABLE (not compiled in)");
-    }
-    if (hasDml) {
-      devices.add("DirectML");
-      DBG("DirectML provider: AVAILABLE (not compiled in)");
-    }
-#endif
-    if (hasCoreML) {
-      devices.add("CoreML");
-      DBG("CoreML provider: ENABLED");
-    }
-    if (hasTensorRT) {
-      devices.add("TensorRT");
-      DBG("TensorRT provider: ENABLED");
-    }
-
-    // If no GPU providers found, show info about how to enable them
-    if (!hasCuda && !hasDml && !hasCoreML && !hasTensorRT) {
-      DBG("WARNING: No GPU execution providers available in this ONNX Runtime "
-          "build.");
-      DBG("This appears to be a CPU-only build of ONNX Runtime.");
-      DBG("To enable GPU acceleration:");
-      DBG("  - Windows DirectML: Use onnxruntime-directml package");
-      DBG("  - NVIDIA CUDA: Use onnxruntime-gpu package (requires CUDA "
-          "toolkit)");
-    }
-  } catch (const std::exception &e) {
-    DBG("ERROR: Failed to get ONNX Runtime providers: " +
-        juce::String(e.what()));
-    DBG("Falling back to CPU-only mode.");
-  }
-#else
-  DBG("WARNING: HAVE_ONNXRUNTIME not defined - only CPU available");
-  DBG("To enable GPU support, ensure ONNX Runtime is properly configured in "
-      "CMakeLists.txt");
-#endif
-
-  DBG("Final device list: " + devices.joinIntoString(", "));
-  return devices;
-}
-
 void SettingsComponent::loadSettings() {
   const auto &langs = Localization::getInstance().getAvailableLanguages();
 
@@ -880,6 +891,28 @@ void SettingsComponent::loadSettings() {
   else if (pitchDetectorType == PitchDetectorType::FCPE)
     pitchDetectorComboBox.setSelectedId(2, juce::dontSendNotification);
 
+  // Memory budget: pick the largest choice not above the saved value
+  if (settingsManager) {
+    const int budgetMB = settingsManager->getMemoryBudgetMB();
+    int budgetId = 1;
+    for (int i = 1; i < static_cast<int>(std::size(memoryBudgetChoicesMB)); ++i)
+      if (budgetMB > 0 && memoryBudgetChoicesMB[i] <= budgetMB)
+        budgetId = i + 1;
+    if (budgetMB > 0 && budgetId == 1)
+      budgetId = 2;
+    memoryBudgetComboBox.setSelectedId(budgetId, juce::dontSendNotification);
+  }
+
+#ifdef HACHITUNE_OPENGL
+  if (settingsManager)
+    renderingComboBox.setSelectedId(settingsManager->getGpuRendering() ? 2 : 1,
+                                    juce::dontSendNotification);
+#endif
+  if (settingsManager)
+    paintStatsComboBox.setSelectedId(
+        settingsManager->getShowPaintStats() ? 2 : 1,
+        juce::dontSendNotification);
+
   hasLoadedSettings = true;
   lastConfirmedDevice = currentDevice;
   lastConfirmedGpuDeviceId = gpuDeviceId;
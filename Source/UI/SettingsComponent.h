@@ -2,8 +2,10 @@
 
 #include "../Audio/PitchDetectorType.h"
 #include "../JuceHeader.h"
+#include "../Models/Project.h"
 #include "../Utils/Constants.h"
 #include "Main/SettingsManager.h"
+#include "PerformancePanel.h"
 #include "StyledComponents.h"
 #include <functional>
 
@@ -47,14 +49,21 @@ public:
   std::function<void()> onLanguageChanged;
   std::function<void(PitchDetectorType)> onPitchDetectorChanged;
   std::function<bool()> canChangeDevice;
+  std::function<void()> onRunProviderBenchmark;
+  // Current memory usage, shown on the General tab and refreshed by the timer
+  std::function<ProjectMemoryReport()> getMemoryReport;
+  std::function<void()> onMemoryBudgetChanged;
+  std::function<void()> onRenderingChanged;
+  std::function<void()> onPaintStatsChanged;
+  std::function<void()> onLogPaintStats;
+
+  // Refresh the memory usage row now rather than on the next timer tick
+  void updateMemoryUsage();
 
   // Load/save settings
   void loadSettings();
   void saveSettings();
 
-  // Get available execution providers
-  static juce::StringArray getAvailableDevices();
-
 private:
   class SettingsLookAndFeel : public DarkLookAndFeel {
   public:
@@ -73,7 +82,7 @@ private:
     juce::Font getPopupMenuFont() override { return AppFont::getFont(15.0f); }
   };
 
-  enum class SettingsTab { General, Audio };
+  enum class SettingsTab { General, Audio, Performance };
 
   void updateDeviceList();
   void updateGPUDeviceList(const juce::String &deviceType);
@@ -106,6 +115,22 @@ private:
   juce::Label pitchDetectorLabel;
   StyledComboBox pitchDetectorComboBox;
 
+  juce::Label benchmarkLabel;
+  juce::TextButton benchmarkButton;
+
+  juce::Label memoryBudgetLabel;
+  StyledComboBox memoryBudgetComboBox;
+  juce::Label memoryUsageLabel;
+  juce::Label memoryUsageValueLabel;
+  juce::Label memoryDetailLabel;
+
+  juce::Label renderingLabel;
+  StyledComboBox renderingComboBox;
+
+  juce::Label paintStatsLabel;
+  StyledComboBox paintStatsComboBox;
+  juce::TextButton paintStatsLogButton;
+
   juce::Label infoLabel;
 
   // Audio device settings (standalone mode only)
@@ -122,6 +147,10 @@ private:
   juce::Label outputChannelsLabel;
   StyledComboBox outputChannelsComboBox;
 
+  // Live model, cache and audio thread statistics
+  PerformancePanel performancePanel;
+  juce::TextButton performanceExportButton;
+
   juce::StringArray cachedOutputDevices;
   juce::String cachedOutputDeviceName;
   juce::String cachedDeviceTypeName;
@@ -135,6 +164,7 @@ private:
   SettingsTab activeTab = SettingsTab::General;
   juce::TextButton generalTabButton;
   juce::TextButton audioTabButton;
+  juce::TextButton performanceTabButton;
   juce::Rectangle<int> cardBounds;
   juce::Rectangle<int> sidebarBounds;
   juce::Array<int> separatorYs;
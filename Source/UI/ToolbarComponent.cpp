@@ -8,33 +8,35 @@
 
 ToolbarComponent::ToolbarComponent()
 {
-    // Load SVG icons with white tint
-    auto playIcon = SvgUtils::loadSvg(BinaryData::playline_svg, BinaryData::playline_svgSize, juce::Colours::white);
-    auto pauseIcon = SvgUtils::loadSvg(BinaryData::pauseline_svg, BinaryData::pauseline_svgSize, juce::Colours::white);
-    auto stopIcon = SvgUtils::loadSvg(BinaryData::stopline_svg, BinaryData::stopline_svgSize, juce::Colours::white);
-    auto startIcon = SvgUtils::loadSvg(BinaryData::movestartline_svg, BinaryData::movestartline_svgSize, juce::Colours::white);
-    auto endIcon = SvgUtils::loadSvg(BinaryData::moveendline_svg, BinaryData::moveendline_svgSize, juce::Colours::white);
-    auto cursorIcon = SvgUtils::loadSvg(BinaryData::cursor_24_filled_svg, BinaryData::cursor_24_filled_svgSize, juce::Colours::white);
-    auto stretchIcon = SvgUtils::loadSvg(BinaryData::stretch_24_filled_svg, BinaryData::stretch_24_filled_svgSize, juce::Colours::white);
-    auto pitchEditIcon = SvgUtils::loadSvg(BinaryData::pitch_edit_24_filled_svg, BinaryData::pitch_edit_24_filled_svgSize, juce::Colours::white);
-    auto scissorsIcon = SvgUtils::loadSvg(BinaryData::scissors_24_filled_svg, BinaryData::scissors_24_filled_svgSize, juce::Colours::white);
-    auto followIcon = SvgUtils::loadSvg(BinaryData::follow24filled_svg, BinaryData::follow24filled_svgSize, juce::Colours::white);
-    auto loopIcon = SvgUtils::loadSvg(BinaryData::loop24filled_svg, BinaryData::loop24filled_svgSize, juce::Colours::white);
+    // Icons are tinted white when IconCache rasterizes them
+    std::shared_ptr<const juce::Drawable> stopIcon = SvgUtils::loadSvg(BinaryData::stopline_svg, BinaryData::stopline_svgSize);
+    std::shared_ptr<const juce::Drawable> startIcon = SvgUtils::loadSvg(BinaryData::movestartline_svg, BinaryData::movestartline_svgSize);
+    std::shared_ptr<const juce::Drawable> endIcon = SvgUtils::loadSvg(BinaryData::moveendline_svg, BinaryData::moveendline_svgSize);
+    std::shared_ptr<const juce::Drawable> cursorIcon = SvgUtils::loadSvg(BinaryData::cursor_24_filled_svg, BinaryData::cursor_24_filled_svgSize);
+    std::shared_ptr<const juce::Drawable> stretchIcon = SvgUtils::loadSvg(BinaryData::stretch_24_filled_svg, BinaryData::stretch_24_filled_svgSize);
+    std::shared_ptr<const juce::Drawable> pitchEditIcon = SvgUtils::loadSvg(BinaryData::pitch_edit_24_filled_svg, BinaryData::pitch_edit_24_filled_svgSize);
+    std::shared_ptr<const juce::Drawable> scissorsIcon = SvgUtils::loadSvg(BinaryData::scissors_24_filled_svg, BinaryData::scissors_24_filled_svgSize);
+    std::shared_ptr<const juce::Drawable> followIcon = SvgUtils::loadSvg(BinaryData::follow24filled_svg, BinaryData::follow24filled_svgSize);
+    std::shared_ptr<const juce::Drawable> loopIcon = SvgUtils::loadSvg(BinaryData::loop24filled_svg, BinaryData::loop24filled_svgSize);
     const juce::String parametersIconSvg =
         R"(<svg viewBox="0 0 24 24" fill="currentColor" xmlns="http://www.w3.org/2000/svg"><rect x="3" y="2" width="2" height="20" rx="1"/><circle cx="4" cy="9" r="3"/><rect x="11" y="2" width="2" height="20" rx="1"/><circle cx="12" cy="15" r="3"/><rect x="19" y="2" width="2" height="20" rx="1"/><circle cx="20" cy="6" r="3"/></svg>)";
-    auto parametersIcon = SvgUtils::createDrawableFromSvg(parametersIconSvg, juce::Colours::white);
-
-    playButton.setImages(playIcon.get());
-    stopButton.setImages(stopIcon.get());
-    goToStartButton.setImages(startIcon.get());
-    goToEndButton.setImages(endIcon.get());
-    selectModeButton.setImages(cursorIcon.get());
-    stretchModeButton.setImages(stretchIcon.get());
-    drawModeButton.setImages(pitchEditIcon.get());
-    splitModeButton.setImages(scissorsIcon.get());
-    followButton.setImages(followIcon.get());
-    loopButton.setImages(loopIcon.get());
-    parametersButton.setImages(parametersIcon.get());
+    std::shared_ptr<const juce::Drawable> parametersIcon = SvgUtils::createDrawableFromSvg(parametersIconSvg);
+
+    // Stored for setPlaying()
+    playDrawable = SvgUtils::loadSvg(BinaryData::playline_svg, BinaryData::playline_svgSize);
+    pauseDrawable = SvgUtils::loadSvg(BinaryData::pauseline_svg, BinaryData::pauseline_svgSize);
+
+    playButton.setIcon("play", playDrawable);
+    stopButton.setIcon("stop", stopIcon);
+    goToStartButton.setIcon("moveStart", startIcon);
+    goToEndButton.setIcon("moveEnd", endIcon);
+    selectModeButton.setIcon("cursor", cursorIcon);
+    stretchModeButton.setIcon("stretch", stretchIcon);
+    drawModeButton.setIcon("pitchEdit", pitchEditIcon);
+    splitModeButton.setIcon("scissors", scissorsIcon);
+    followButton.setIcon("follow", followIcon);
+    loopButton.setIcon("loop", loopIcon);
+    parametersButton.setIcon("parameters", parametersIcon);
 
     // Set edge indent for icon padding (makes icons smaller within button bounds)
     goToStartButton.setEdgeIndent(4);
@@ -49,10 +51,6 @@ ToolbarComponent::ToolbarComponent()
     loopButton.setEdgeIndent(6);
     parametersButton.setEdgeIndent(6);
 
-    // Store pause icon for later use
-    pauseDrawable = std::move(pauseIcon);
-    playDrawable = SvgUtils::loadSvg(BinaryData::playline_svg, BinaryData::playline_svgSize, juce::Colours::white);
-
     // Configure buttons
     addAndMakeVisible(goToStartButton);
     addAndMakeVisible(playButton);
@@ -365,7 +363,7 @@ void ToolbarComponent::sliderValueChanged(juce::Slider* slider)
 void ToolbarComponent::setPlaying(bool playing)
 {
     isPlaying = playing;
-    playButton.setImages(playing ? pauseDrawable.get() : playDrawable.get());
+    playButton.setIcon(playing ? "pause" : "play", playing ? pauseDrawable : playDrawable);
 }
 
 void ToolbarComponent::setCurrentTime(double time)
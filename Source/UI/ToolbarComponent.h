@@ -2,21 +2,52 @@
 
 #include "../JuceHeader.h"
 #include "../Utils/Constants.h"
+#include "../Utils/UI/IconCache.h"
 #include "../Utils/UI/Theme.h"
 
 // Forward declaration - EditMode is defined in PianoRollComponent.h
 enum class EditMode;
 
+// Button showing an SVG icon, fitted within its bounds less the edge indent,
+// drawn from the shared IconCache
+class IconButton : public juce::Button
+{
+public:
+    IconButton(const juce::String& name) : juce::Button(name) {}
+
+    void setIcon(const juce::String& id, std::shared_ptr<const juce::Drawable> drawable)
+    {
+        iconId = id;
+        icon = std::move(drawable);
+        repaint();
+    }
+
+    void setEdgeIndent(int indent) { edgeIndent = indent; repaint(); }
+
+    void paintButton(juce::Graphics& g, bool, bool) override
+    {
+        if (icon != nullptr)
+            icons->draw(g, iconId, *icon, getLocalBounds().reduced(edgeIndent).toFloat(),
+                        juce::Colours::white, isEnabled() ? 1.0f : 0.4f);
+    }
+
+private:
+    juce::String iconId;
+    std::shared_ptr<const juce::Drawable> icon;
+    int edgeIndent = 3;
+    juce::SharedResourcePointer<IconCache> icons;
+};
+
 // Tool button with hover and active states
-class ToolButton : public juce::DrawableButton
+class ToolButton : public IconButton
 {
 public:
-    ToolButton(const juce::String& name) : juce::DrawableButton(name, juce::DrawableButton::ImageFitted) {}
+    ToolButton(const juce::String& name) : IconButton(name) {}
 
     void setActive(bool active) { isActive = active; repaint(); }
     bool getActive() const { return isActive; }
 
-    void paint(juce::Graphics& g) override
+    void paintButton(juce::Graphics& g, bool isMouseOverButton, bool isButtonDown) override
     {
         auto bounds = getLocalBounds().toFloat().reduced(2.0f);
 
@@ -32,7 +63,7 @@ public:
             g.setColour(APP_COLOR_PRIMARY_GLOW.withAlpha(0.35f));
             g.drawRoundedRectangle(bounds.expanded(1.5f), 6.0f, 1.5f);
         }
-        else if (isMouseOver())
+        else if (isMouseOverButton)
         {
             g.setColour(APP_COLOR_SURFACE_RAISED);
             g.fillRoundedRectangle(bounds, 5.0f);
@@ -42,7 +73,7 @@ public:
             g.setColour(juce::Colours::transparentBlack);
             g.fillRoundedRectangle(bounds, 5.0f);
         }
-        juce::DrawableButton::paint(g);
+        IconButton::paintButton(g, isMouseOverButton, isButtonDown);
     }
 
 private:
@@ -107,12 +138,12 @@ private:
     void updateTimeDisplay();
     juce::String formatTime(double seconds);
 
-    juce::DrawableButton playButton { "Play", juce::DrawableButton::ImageFitted };
-    juce::DrawableButton stopButton { "Stop", juce::DrawableButton::ImageFitted };
-    juce::DrawableButton goToStartButton { "Start", juce::DrawableButton::ImageFitted };
-    juce::DrawableButton goToEndButton { "End", juce::DrawableButton::ImageFitted };
-    std::unique_ptr<juce::Drawable> playDrawable;
-    std::unique_ptr<juce::Drawable> pauseDrawable;
+    IconButton playButton { "Play" };
+    IconButton stopButton { "Stop" };
+    IconButton goToStartButton { "Start" };
+    IconButton goToEndButton { "End" };
+    std::shared_ptr<const juce::Drawable> playDrawable;
+    std::shared_ptr<const juce::Drawable> pauseDrawable;
 
     // Plugin mode buttons
     juce::TextButton reanalyzeButton { "Re-analyze" };
@@ -8,10 +8,12 @@ WaveformComponent::WaveformComponent()
     horizontalScrollBar.setColour(juce::ScrollBar::thumbColourId, APP_COLOR_PRIMARY.withAlpha(0.8f));
     horizontalScrollBar.setColour(juce::ScrollBar::trackColourId, juce::Colours::transparentBlack);
     horizontalScrollBar.addListener(this);
+    peaks->addChangeListener(this);
 }
 
 WaveformComponent::~WaveformComponent()
 {
+    peaks->removeChangeListener(this);
     horizontalScrollBar.removeListener(this);
 }
 
@@ -45,45 +47,46 @@ void WaveformComponent::drawWaveform(juce::Graphics& g)
     float centerY = static_cast<float>(bounds.getCentreY());
     float amplitude = bounds.getHeight() * 0.4f;
     
-    const float* samples = audioData.waveform.getReadPointer(0);
-    int numSamples = audioData.waveform.getNumSamples();
+    const int numSamples = audioData.waveform.getNumSamples();
+    const int width = bounds.getWidth();
+    if (width <= 0) return;
     
-    // Calculate visible range
-    double startTime = xToTime(static_cast<float>(scrollX));
-    double endTime = xToTime(static_cast<float>(scrollX + bounds.getWidth()));
-    
-    int startSample = juce::jmax(0, static_cast<int>(startTime * SAMPLE_RATE));
-    int endSample = juce::jmin(numSamples - 1, static_cast<int>(endTime * SAMPLE_RATE));
-    
-    if (startSample >= endSample) return;
-    
-    // Samples per pixel
-    juce::ignoreUnused(startSample, endSample);
+    // One column per pixel, from the peak pyramid when it is ready
+    const double firstSample = xToTime(static_cast<float>(scrollX)) * SAMPLE_RATE;
+    const double samplesPerColumn = SAMPLE_RATE / pixelsPerSecond;
+    columns.resize(static_cast<size_t>(width));
+    if (auto pyramid = peaks->get(audioData.getRenderSnapshot()))
+    {
+        pyramid->getPeaks(firstSample, samplesPerColumn, width, columns.data());
+    }
+    else
+    {
+        const float* samples = audioData.waveform.getReadPointer(0);
+        for (int x = 0; x < width; ++x)
+        {
+            int sampleStart = static_cast<int>(firstSample + x * samplesPerColumn);
+            int sampleEnd = static_cast<int>(firstSample + (x + 1) * samplesPerColumn);
+            sampleStart = juce::jmax(0, sampleStart);
+            sampleEnd = juce::jmin(numSamples, juce::jmax(sampleStart + 1, sampleEnd));
+            
+            if (sampleStart >= numSamples)
+            {
+                columns[static_cast<size_t>(x)] = {};
+                continue;
+            }
+            auto range = juce::FloatVectorOperations::findMinAndMax(samples + sampleStart,
+                                                                    sampleEnd - sampleStart);
+            columns[static_cast<size_t>(x)] = { range.getStart(), range.getEnd(), 0.0f };
+        }
+    }
     
     g.setColour(APP_COLOR_WAVEFORM);
     
-    for (int x = 0; x < bounds.getWidth(); ++x)
+    for (int x = 0; x < width; ++x)
     {
-        double time = xToTime(static_cast<float>(scrollX + x));
-        int sampleStart = static_cast<int>(time * SAMPLE_RATE);
-        int sampleEnd = static_cast<int>((time + 1.0 / pixelsPerSecond) * SAMPLE_RATE);
-        
-        sampleStart = juce::jmax(0, sampleStart);
-        sampleEnd = juce::jmin(numSamples - 1, sampleEnd);
-        
-        if (sampleStart >= numSamples || sampleEnd < 0) continue;
-        
-        // Find min/max in this range
-        float minVal = 0.0f, maxVal = 0.0f;
-        for (int i = sampleStart; i <= sampleEnd; ++i)
-        {
-            float s = samples[i];
-            if (s < minVal) minVal = s;
-            if (s > maxVal) maxVal = s;
-        }
-        
-        float yMin = centerY - maxVal * amplitude;
-        float yMax = centerY - minVal * amplitude;
+        const auto& column = columns[static_cast<size_t>(x)];
+        float yMin = centerY - juce::jmax(0.0f, column.max) * amplitude;
+        float yMax = centerY - juce::jmin(0.0f, column.min) * amplitude;
         
         g.drawVerticalLine(x, yMin, yMax);
     }
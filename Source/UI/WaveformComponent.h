@@ -3,9 +3,11 @@
 #include "../JuceHeader.h"
 #include "../Models/Project.h"
 #include "../Utils/Constants.h"
+#include "../Utils/PeakPyramid.h"
 
 class WaveformComponent : public juce::Component,
-                          public juce::ScrollBar::Listener
+                          public juce::ScrollBar::Listener,
+                          private juce::ChangeListener
 {
 public:
     WaveformComponent();
@@ -36,7 +38,7 @@ private:
     void drawWaveform(juce::Graphics& g);
     void drawCursor(juce::Graphics& g);
     void updateScrollBar();
-    void rebuildWaveformCache();
+    void changeListenerCallback(juce::ChangeBroadcaster*) override { repaint(); }
     
     float timeToX(double time) const;
     double xToTime(float x) const;
@@ -47,9 +49,9 @@ private:
     float pixelsPerSecond = 100.0f;
     double cursorTime = 0.0;
     
-    // Waveform cache
-    juce::AudioBuffer<float> waveformCache;
-    int cacheResolution = 512;  // Samples per pixel at base zoom
+    // Shared with the other waveform views; repaints when one is built
+    juce::SharedResourcePointer<PeakPyramidService> peaks;
+    std::vector<PeakPyramid::Peak> columns;
     
     juce::ScrollBar horizontalScrollBar { false };
     
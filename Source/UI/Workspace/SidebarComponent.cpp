@@ -24,11 +24,9 @@ void SidebarButton::paint(juce::Graphics& g)
     // Icon
     if (iconDrawable != nullptr)
     {
-        auto iconBounds = bounds.reduced(8);
-        iconDrawable->setTransformToFit(iconBounds, juce::RectanglePlacement::centred);
-
         // Keep icon white in all states
-        iconDrawable->draw(g, active || hovered ? 1.0f : 0.7f);
+        icons->draw(g, buttonId, *iconDrawable, bounds.reduced(8), juce::Colours::white,
+                    active || hovered ? 1.0f : 0.7f);
     }
 }
 
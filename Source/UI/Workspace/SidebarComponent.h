@@ -2,6 +2,7 @@
 
 #include "../../JuceHeader.h"
 #include "../../Utils/Constants.h"
+#include "../../Utils/UI/IconCache.h"
 #include "../../Utils/UI/Theme.h"
 
 class SidebarComponent;
@@ -35,6 +36,7 @@ private:
     juce::String buttonId;
     juce::String tooltipText;
     std::unique_ptr<juce::Drawable> iconDrawable;
+    juce::SharedResourcePointer<IconCache> icons;
     bool active = false;
     bool hovered = false;
 
@@ -0,0 +1,265 @@
+#include "AppLogger.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace {
+constexpr size_t numSlots = 512; // Power of two
+constexpr size_t slotTextBytes = 1000;
+constexpr int numChannels = static_cast<int>(AppLogger::Channel::numChannels);
+constexpr auto idleFlushInterval = std::chrono::milliseconds(50);
+
+struct Slot {
+  // Vyukov's bounded queue: slot i is free for the producer at position p
+  // when sequence == p, and holds a message for the consumer when it is
+  // p + 1
+  std::atomic<uint64_t> sequence{0};
+  juce::int64 timeMs = 0;
+  AppLogger::Level level = AppLogger::Level::Info;
+  AppLogger::Channel channel = AppLogger::Channel::App;
+  size_t numBytes = 0;
+  char text[slotTextBytes];
+};
+
+const char *fileNamePrefix(AppLogger::Channel channel) {
+  return channel == AppLogger::Channel::Vocoder ? "vocoder_" : "debug_";
+}
+
+const char *fileNameSuffix(AppLogger::Channel channel) {
+  return channel == AppLogger::Channel::Vocoder ? ".txt" : ".log";
+}
+
+const char *levelPrefix(AppLogger::Level level) {
+  switch (level) {
+  case AppLogger::Level::Debug:
+    return "DEBUG: ";
+  case AppLogger::Level::Warning:
+    return "WARNING: ";
+  case AppLogger::Level::Error:
+    return "ERROR: ";
+  case AppLogger::Level::Info:
+    break;
+  }
+  return "";
+}
+
+class AsyncLog {
+public:
+  AsyncLog() {
+    for (size_t i = 0; i < numSlots; ++i)
+      slots[i].sequence.store(i, std::memory_order_relaxed);
+    start();
+  }
+
+  ~AsyncLog() { stop(); }
+
+  static AsyncLog &get() {
+    static AsyncLog instance;
+    return instance;
+  }
+
+  void push(AppLogger::Channel channel, AppLogger::Level level,
+            const char *text, size_t numBytes) {
+    if (static_cast<int>(level) < minimumLevel.load(std::memory_order_relaxed))
+      return;
+
+    const auto now = juce::Time::currentTimeMillis();
+    if (level < AppLogger::Level::Warning && !withinRate(now)) {
+      dropped.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+
+    uint64_t position = enqueuePosition.load(std::memory_order_relaxed);
+    Slot *slot = nullptr;
+    for (;;) {
+      slot = &slots[position & (numSlots - 1)];
+      const auto sequence = slot->sequence.load(std::memory_order_acquire);
+      const auto difference =
+          static_cast<int64_t>(sequence) - static_cast<int64_t>(position);
+      if (difference == 0) {
+        if (enqueuePosition.compare_exchange_weak(position, position + 1,
+                                                  std::memory_order_relaxed))
+          break;
+      } else if (difference < 0) {
+        // Full: the writer is behind
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+      } else {
+        position = enqueuePosition.load(std::memory_order_relaxed);
+      }
+    }
+
+    slot->timeMs = now;
+    slot->level = level;
+    slot->channel = channel;
+    slot->numBytes = std::min(numBytes, slotTextBytes);
+    std::memcpy(slot->text, text, slot->numBytes);
+    slot->sequence.store(position + 1, std::memory_order_release);
+  }
+
+  void setMinimumLevel(AppLogger::Level level) {
+    minimumLevel.store(static_cast<int>(level), std::memory_order_relaxed);
+  }
+
+  void addUser() {
+    std::lock_guard<std::mutex> lock(lifecycleMutex);
+    ++numUsers;
+    start();
+  }
+
+  void removeUser() {
+    std::lock_guard<std::mutex> lock(lifecycleMutex);
+    if (numUsers > 0 && --numUsers == 0)
+      stop();
+  }
+
+  // Writes out everything queued; callable from any thread
+  void drain() {
+    std::lock_guard<std::mutex> lock(writerMutex);
+    drainLocked();
+  }
+
+  void deleteFile(AppLogger::Channel channel) {
+    std::lock_guard<std::mutex> lock(writerMutex);
+    drainLocked();
+    const auto index = static_cast<size_t>(channel);
+    streams[index].reset();
+    AppLogger::getLogFile(channel).deleteFile();
+  }
+
+private:
+  bool withinRate(juce::int64 nowMs) {
+    const auto second = nowMs / 1000;
+    auto window = rateWindow.load(std::memory_order_relaxed);
+    if (window != second &&
+        rateWindow.compare_exchange_strong(window, second,
+                                           std::memory_order_relaxed))
+      rateCount.store(0, std::memory_order_relaxed);
+    return rateCount.fetch_add(1, std::memory_order_relaxed) <
+           AppLogger::maxMessagesPerSecond;
+  }
+
+  // Caller holds lifecycleMutex, or is the constructor or destructor
+  void start() {
+    if (writer.joinable())
+      return;
+    stopWriter.store(false);
+    writer = std::thread([this]() {
+      juce::Thread::setCurrentThreadName("HachiTune Logger");
+      while (!stopWriter.load()) {
+        drain();
+        std::this_thread::sleep_for(idleFlushInterval);
+      }
+    });
+  }
+
+  void stop() {
+    if (writer.joinable()) {
+      stopWriter.store(true);
+      writer.join();
+    }
+    drain();
+  }
+
+  // Single consumer: caller holds writerMutex
+  void drainLocked() {
+    std::array<juce::String, numChannels> pending;
+    for (;;) {
+      Slot &slot = slots[dequeuePosition & (numSlots - 1)];
+      if (slot.sequence.load(std::memory_order_acquire) != dequeuePosition + 1)
+        break;
+
+      const auto message =
+          juce::String::fromUTF8(slot.text, static_cast<int>(slot.numBytes));
+      const auto level = slot.level;
+      const auto channel = slot.channel;
+      const juce::Time time(slot.timeMs);
+      slot.sequence.store(dequeuePosition + numSlots,
+                          std::memory_order_release);
+      ++dequeuePosition;
+
+      DBG(message);
+      pending[static_cast<size_t>(channel)]
+          << formatTime(channel, time) << levelPrefix(level) << message
+          << "\n";
+    }
+
+    if (const auto lost = dropped.exchange(0, std::memory_order_relaxed))
+      pending[static_cast<size_t>(AppLogger::Channel::App)]
+          << formatTime(AppLogger::Channel::App, juce::Time::getCurrentTime())
+          << "WARNING: " << juce::String(static_cast<juce::int64>(lost))
+          << " log message(s) dropped\n";
+
+    for (size_t i = 0; i < pending.size(); ++i) {
+      if (pending[i].isEmpty())
+        continue;
+      auto &stream = streams[i];
+      if (stream == nullptr) {
+        stream = std::make_unique<juce::FileOutputStream>(
+            AppLogger::getLogFile(static_cast<AppLogger::Channel>(i)));
+        if (!stream->openedOk()) {
+          stream.reset();
+          continue;
+        }
+      }
+      stream->writeText(pending[i], false, false, nullptr);
+      stream->flush();
+    }
+  }
+
+  static juce::String formatTime(AppLogger::Channel channel,
+                                 const juce::Time &time) {
+    if (channel == AppLogger::Channel::Vocoder)
+      return time.formatted("%H:%M:%S.") +
+             juce::String(time.getMilliseconds()).paddedLeft('0', 3) + " | ";
+    return "[" + time.toString(true, true, true, true) + "] ";
+  }
+
+  std::array<Slot, numSlots> slots;
+  std::atomic<uint64_t> enqueuePosition{0};
+  uint64_t dequeuePosition = 0; // Guarded by writerMutex
+  std::atomic<uint64_t> dropped{0};
+  std::atomic<int> minimumLevel{static_cast<int>(AppLogger::Level::Debug)};
+  std::atomic<juce::int64> rateWindow{0};
+  std::atomic<int> rateCount{0};
+
+  std::mutex writerMutex;
+  std::array<std::unique_ptr<juce::FileOutputStream>, numChannels> streams;
+
+  std::mutex lifecycleMutex;
+  int numUsers = 0;
+  std::atomic<bool> stopWriter{false};
+  std::thread writer;
+};
+} // namespace
+
+void AppLogger::init() {
+  (void)getSessionId();
+  AsyncLog::get().addUser();
+}
+
+void AppLogger::shutdown() { AsyncLog::get().removeUser(); }
+
+void AppLogger::log(Channel channel, Level level, const char *text,
+                    size_t numBytes) {
+  AsyncLog::get().push(channel, level, text, numBytes);
+}
+
+void AppLogger::setMinimumLevel(Level level) {
+  AsyncLog::get().setMinimumLevel(level);
+}
+
+void AppLogger::flush() { AsyncLog::get().drain(); }
+
+void AppLogger::clear() { AsyncLog::get().deleteFile(Channel::App); }
+
+juce::File AppLogger::getLogFile(Channel channel) {
+  return PlatformPaths::getLogFile(fileNamePrefix(channel) + getSessionId() +
+                                   fileNameSuffix(channel));
+}
@@ -2,34 +2,54 @@
 
 #include "../JuceHeader.h"
 #include "PlatformPaths.h"
+#include <cstddef>
 
 /**
- * Simple file logger for debugging.
- * Logs to %APPDATA%/HachiTune/debug.log
+ * Asynchronous file logger for debugging.
+ * Logs to the platform logs directory (see PlatformPaths), one file per
+ * channel and session.
+ *
+ * log() only copies the message into a lock-free ring; a background thread
+ * formats the timestamps and writes the files, so callers never wait on
+ * disk. The char* overload neither locks nor allocates and is safe from the
+ * audio thread. Debug and info messages beyond maxMessagesPerSecond are
+ * dropped, as are messages arriving while the ring is full; the log notes
+ * how many were lost. Messages longer than a ring slot are truncated.
+ *
+ * The writer starts on first use. init() and shutdown() bracket a user that
+ * must not outlive it, such as a plugin instance; it stops when the last
+ * one shuts down, and later messages wait for flush() or process exit.
  */
 class AppLogger {
 public:
-  static void init() {
-    (void)getSessionId();
-    (void)getLogFile();
-  }
+  enum class Level { Debug, Info, Warning, Error };
+  enum class Channel { App, Vocoder, numChannels };
 
-  static void log(const juce::String &message) {
-    auto logFile = getLogFile();
-    auto timestamp =
-        juce::Time::getCurrentTime().toString(true, true, true, true);
-    logFile.appendText("[" + timestamp + "] " + message + "\n");
-    DBG(message);
-  }
+  static constexpr int maxMessagesPerSecond = 500;
 
-  static void clear() {
-    auto logFile = getLogFile();
-    logFile.deleteFile();
-  }
+  static void init();
+  static void shutdown();
 
-  static juce::File getLogFile() {
-    return PlatformPaths::getLogFile("debug_" + getSessionId() + ".log");
+  static void log(const juce::String &message) { log(Level::Info, message); }
+  static void log(Level level, const juce::String &message) {
+    log(Channel::App, level, message);
+  }
+  static void log(Channel channel, Level level, const juce::String &message) {
+    log(channel, level, message.toRawUTF8(), message.getNumBytesAsUTF8());
   }
+  static void log(Channel channel, Level level, const char *text,
+                  size_t numBytes);
+
+  // Messages below level are discarded; Debug by default
+  static void setMinimumLevel(Level level);
+
+  // Write everything logged so far before returning
+  static void flush();
+
+  static void clear();
+
+  static juce::File getLogFile() { return getLogFile(Channel::App); }
+  static juce::File getLogFile(Channel channel);
 
   static juce::String getSessionId() {
     static const juce::String sessionId =
@@ -39,3 +59,6 @@ public:
 };
 
 #define LOG(msg) AppLogger::log(msg)
+#define LOG_DEBUG(msg) AppLogger::log(AppLogger::Level::Debug, msg)
+#define LOG_WARNING(msg) AppLogger::log(AppLogger::Level::Warning, msg)
+#define LOG_ERROR(msg) AppLogger::log(AppLogger::Level::Error, msg)
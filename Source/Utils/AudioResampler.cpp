@@ -0,0 +1,228 @@
+#include "AudioResampler.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <numeric>
+#include <utility>
+
+namespace
+{
+    // Kernel zero crossings on each side, and passband edge as a fraction
+    // of the lower Nyquist frequency
+    constexpr int zeroCrossings = 16;
+    constexpr double passband = 0.95;
+    constexpr double kaiserBeta = 8.6;
+
+    constexpr double pi = 3.14159265358979323846;
+
+    // Modified Bessel function of the first kind, order 0
+    double besselI0(double x)
+    {
+        double sum = 1.0;
+        double term = 1.0;
+        const double halfX = x * 0.5;
+        for (int k = 1; k < 64; ++k)
+        {
+            term *= (halfX / k) * (halfX / k);
+            sum += term;
+            if (term < sum * 1e-12)
+                break;
+        }
+        return sum;
+    }
+
+    double sinc(double x)
+    {
+        if (std::abs(x) < 1e-9)
+            return 1.0;
+        return std::sin(pi * x) / (pi * x);
+    }
+}
+
+AudioResampler::Ptr AudioResampler::get(int srcRate, int dstRate)
+{
+    const int divisor = std::gcd(srcRate, dstRate);
+    const auto key = std::make_pair(dstRate / divisor, srcRate / divisor);
+
+    static std::mutex mutex;
+    static std::map<std::pair<int, int>, Ptr> cache;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& entry = cache[key];
+    if (!entry)
+        entry = Ptr(new AudioResampler(key.first, key.second));
+    return entry;
+}
+
+std::vector<float> AudioResampler::resample(const float* audio, int numSamples,
+                                            int srcRate, int dstRate)
+{
+    if (numSamples <= 0)
+        return {};
+    if (srcRate == dstRate)
+        return std::vector<float>(audio, audio + numSamples);
+
+    auto resampler = get(srcRate, dstRate);
+    std::vector<float> out(static_cast<size_t>(resampler->getOutputLength(numSamples)));
+    resampler->process(audio, numSamples, out.data());
+    return out;
+}
+
+const float* AudioResampler::resample(const float* audio, int& numSamples, int srcRate, int dstRate,
+                                      ScratchArena::Scope& scratch)
+{
+    if (numSamples <= 0 || srcRate == dstRate)
+        return audio;
+
+    auto resampler = get(srcRate, dstRate);
+    const int numOut = resampler->getOutputLength(numSamples);
+    float* out = scratch.allocate<float>(static_cast<size_t>(numOut));
+    resampler->process(audio, numSamples, out);
+    numSamples = numOut;
+    return out;
+}
+
+AudioResampler::AudioResampler(int upIn, int downIn)
+    : up(upIn), down(downIn)
+{
+    // Cutoff relative to the input Nyquist frequency; below it when
+    // downsampling so the output does not alias
+    const double cutoff = passband * std::min(1.0, static_cast<double>(up) / down);
+    const double halfWidth = zeroCrossings / cutoff;
+    halfTaps = static_cast<int>(std::ceil(halfWidth));
+
+    const int taps = 2 * halfTaps;
+    const double windowNorm = besselI0(kaiserBeta);
+    kernel.resize(static_cast<size_t>(up) * taps);
+
+    for (int phase = 0; phase < up; ++phase)
+    {
+        // Output position lies this far past the input sample it rounds down to
+        const double frac = static_cast<double>(phase) / up;
+        float* row = kernel.data() + static_cast<size_t>(phase) * taps;
+
+        double sum = 0.0;
+        for (int j = 0; j < taps; ++j)
+        {
+            const double x = (j - halfTaps + 1) - frac;
+            const double r = x / halfWidth;
+            double weight = 0.0;
+            if (std::abs(r) < 1.0)
+                weight = cutoff * sinc(cutoff * x)
+                         * besselI0(kaiserBeta * std::sqrt(1.0 - r * r)) / windowNorm;
+            row[j] = static_cast<float>(weight);
+            sum += weight;
+        }
+
+        // Unity gain at DC for every phase
+        if (sum != 0.0)
+            for (int j = 0; j < taps; ++j)
+                row[j] = static_cast<float>(row[j] / sum);
+    }
+}
+
+int AudioResampler::getOutputLength(int numSamples) const
+{
+    if (numSamples <= 0)
+        return 0;
+    return static_cast<int>(static_cast<int64_t>(numSamples) * up / down);
+}
+
+void AudioResampler::process(const float* audio, int numSamples, float* out) const
+{
+    processRange(audio, 0, numSamples, 0, getOutputLength(numSamples), out);
+}
+
+void AudioResampler::processRange(const float* audio, int64_t audioStart,
+                                  int numSamples, int64_t firstOut, int numOut,
+                                  float* out) const
+{
+    const int taps = 2 * halfTaps;
+
+    for (int i = 0; i < numOut; ++i)
+    {
+        const int64_t position = (firstOut + i) * down;
+        const int64_t base = position / up;
+        const int phase = static_cast<int>(position % up);
+        const float* row = kernel.data() + static_cast<size_t>(phase) * taps;
+        const int64_t first = base - halfTaps + 1 - audioStart;
+
+        float acc = 0.0f;
+        if (first >= 0 && first + taps <= numSamples)
+        {
+            const float* in = audio + first;
+            for (int j = 0; j < taps; ++j)
+                acc += in[j] * row[j];
+        }
+        else
+        {
+            // Near the edges; samples outside the input count as silence
+            const int jStart = static_cast<int>(std::max<int64_t>(0, -first));
+            const int jEnd = static_cast<int>(std::min<int64_t>(taps, numSamples - first));
+            for (int j = jStart; j < jEnd; ++j)
+                acc += audio[first + j] * row[j];
+        }
+        out[i] = acc;
+    }
+}
+
+AudioResampler::Stream::Stream(int srcRate, int dstRate)
+{
+    if (srcRate != dstRate)
+        resampler = get(srcRate, dstRate);
+}
+
+void AudioResampler::Stream::push(const float* audio, int numSamples,
+                                  std::vector<float>& out)
+{
+    if (numSamples <= 0)
+        return;
+    if (!resampler)
+    {
+        out.insert(out.end(), audio, audio + numSamples);
+        return;
+    }
+
+    window.insert(window.end(), audio, audio + numSamples);
+    numIn += numSamples;
+
+    // Output n reads input up to floor(n * down / up) + halfTaps
+    const auto& r = *resampler;
+    const int64_t lastBase = numIn - r.halfTaps - 1;
+    if (lastBase >= 0)
+        produce(((lastBase + 1) * r.up + r.down - 1) / r.down, out);
+}
+
+void AudioResampler::Stream::finish(std::vector<float>& out)
+{
+    if (!resampler)
+        return;
+    produce(numIn * resampler->up / resampler->down, out);
+    window.clear();
+}
+
+void AudioResampler::Stream::produce(int64_t numOut, std::vector<float>& out)
+{
+    const auto& r = *resampler;
+    if (numOut > numProduced)
+    {
+        const auto count = static_cast<int>(numOut - numProduced);
+        const auto offset = out.size();
+        out.resize(offset + static_cast<size_t>(count));
+        r.processRange(window.data(), windowStart, static_cast<int>(window.size()),
+                       numProduced, count, out.data() + offset);
+        numProduced = numOut;
+    }
+
+    // Drop input that no later output reaches
+    const int64_t keepFrom = numProduced * r.down / r.up - r.halfTaps + 1;
+    if (keepFrom > windowStart)
+    {
+        const auto drop = static_cast<size_t>(
+            std::min<int64_t>(keepFrom - windowStart, static_cast<int64_t>(window.size())));
+        window.erase(window.begin(), window.begin() + static_cast<std::ptrdiff_t>(drop));
+        windowStart += static_cast<int64_t>(drop);
+    }
+}
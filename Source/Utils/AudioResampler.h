@@ -0,0 +1,82 @@
+#pragma once
+
+#include "ScratchArena.h"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/**
+ * Polyphase windowed-sinc resampler between two integer sample rates.
+ *
+ * The rate ratio is reduced to up/down; each of the up phases keeps its own
+ * Kaiser-windowed sinc kernel, low-passed below the lower of the two
+ * Nyquist frequencies. Resamplers are immutable; get() builds each rate pair
+ * once and hands out shared copies, like MelFilterbank.
+ */
+class AudioResampler
+{
+public:
+    using Ptr = std::shared_ptr<const AudioResampler>;
+
+    /** Shared resampler from srcRate to dstRate (both > 0). Thread-safe. */
+    static Ptr get(int srcRate, int dstRate);
+
+    /**
+     * Resample numSamples mono samples from srcRate to dstRate. Returns a
+     * plain copy when the rates match.
+     */
+    static std::vector<float> resample(const float* audio, int numSamples,
+                                       int srcRate, int dstRate);
+
+    /**
+     * The same into scratch memory, for temporaries of a model call. Returns
+     * audio itself when the rates match; numSamples becomes the output length.
+     */
+    static const float* resample(const float* audio, int& numSamples, int srcRate, int dstRate,
+                                 ScratchArena::Scope& scratch);
+
+    /** Output length for numSamples input samples (rounded down). */
+    int getOutputLength(int numSamples) const;
+
+    /** Write getOutputLength(numSamples) samples to out. */
+    void process(const float* audio, int numSamples, float* out) const;
+
+    /**
+     * Resamples one signal handed over in pieces, keeping only the input
+     * the next outputs still need. The concatenated output matches
+     * resample() over the whole signal exactly.
+     */
+    class Stream
+    {
+    public:
+        Stream(int srcRate, int dstRate);
+
+        /** Queue input and append every output it completes to out. */
+        void push(const float* audio, int numSamples, std::vector<float>& out);
+
+        /** Append the remaining outputs, with silence past the end. */
+        void finish(std::vector<float>& out);
+
+    private:
+        void produce(int64_t numOut, std::vector<float>& out);
+
+        Ptr resampler;  // Null when the rates match
+        std::vector<float> window;  // Input from windowStart on
+        int64_t windowStart = 0;
+        int64_t numIn = 0;
+        int64_t numProduced = 0;
+    };
+
+private:
+    AudioResampler(int up, int down);
+
+    // Outputs [firstOut, firstOut + numOut) from the input window
+    // [audioStart, audioStart + numSamples); the rest counts as silence
+    void processRange(const float* audio, int64_t audioStart, int numSamples,
+                      int64_t firstOut, int numOut, float* out) const;
+
+    int up = 1;
+    int down = 1;
+    int halfTaps = 0;  // Input samples on each side of an output position
+    std::vector<float> kernel;  // [up][2 * halfTaps], each phase sums to 1
+};
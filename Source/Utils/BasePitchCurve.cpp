@@ -1,4 +1,5 @@
 #include "BasePitchCurve.h"
+#include "CurveConvolution.h"
 #include <algorithm>
 #include <cmath>
 
@@ -77,8 +78,12 @@ BasePitchCurve::generateForNotes(const std::vector<NoteSegment> &notes,
       1;
 
   // Create initial step function values at 1ms resolution
-  // This matches ds-editor-lite's BasePitchCurve::Convolve algorithm
-  std::vector<double> initValues(totalMs, 0.0);
+  // This matches ds-editor-lite's BasePitchCurve::Convolve algorithm.
+  // The edge values are repeated over the kernel's reach on both sides.
+  constexpr int halfKernel = KERNEL_SIZE / 2;
+  std::vector<double> padded(static_cast<size_t>(totalMs + KERNEL_SIZE - 1),
+                             0.0);
+  double *initValues = padded.data() + halfKernel;
 
   // Convert note segments from frames to seconds for step function
   struct NoteInSeconds {
@@ -113,19 +118,33 @@ BasePitchCurve::generateForNotes(const std::vector<NoteSegment> &notes,
       noteIndex++;
     }
   }
-
-  // Apply cosine kernel convolution
-  auto kernel = createCosineKernel();
-  std::vector<double> smoothedMs(totalMs, 0.0);
-
-  for (int i = 0; i < totalMs; ++i) {
-    for (int j = 0; j < KERNEL_SIZE; ++j) {
-      int srcIdx = std::max(0, std::min(i - KERNEL_SIZE / 2 + j, totalMs - 1));
-      smoothedMs[i] += initValues[srcIdx] * kernel[j];
-    }
+  std::fill(padded.begin(), padded.begin() + halfKernel, initValues[0]);
+  std::fill(padded.begin() + halfKernel + totalMs, padded.end(),
+            initValues[totalMs - 1]);
+
+  // Apply cosine kernel convolution. Resampling reads only the two
+  // milliseconds around each frame (~12 ms apart), so a short kernel is
+  // evaluated just there; a long one is convolved densely through the FFT.
+  const auto &kernel = getCosineKernel();
+  const bool dense = CurveConvolution::usesFft(KERNEL_SIZE, totalMs);
+  std::vector<double> smoothedMs;
+  if (dense) {
+    smoothedMs.resize(static_cast<size_t>(totalMs));
+    CurveConvolution::correlate(padded.data(), totalMs, kernel,
+                                smoothedMs.data());
   }
+  auto smoothedAt = [&](int ms) {
+    if (dense)
+      return smoothedMs[static_cast<size_t>(ms)];
+    const double *window = padded.data() + ms;
+    double sum = 0.0;
+    for (int j = 0; j < KERNEL_SIZE; ++j)
+      sum += window[j] * kernel[static_cast<size_t>(j)];
+    return sum;
+  };
 
   // Resample back to frame resolution
+  const double tail = smoothedAt(totalMs - 1);
   std::vector<float> result(totalFrames);
   for (int frame = 0; frame < totalFrames; ++frame) {
     double ms = frame * msPerFrame;
@@ -133,12 +152,12 @@ BasePitchCurve::generateForNotes(const std::vector<NoteSegment> &notes,
     double frac = ms - msIdx;
 
     if (msIdx + 1 < totalMs)
-      result[frame] = static_cast<float>(smoothedMs[msIdx] * (1.0 - frac) +
-                                         smoothedMs[msIdx + 1] * frac);
+      result[frame] = static_cast<float>(smoothedAt(msIdx) * (1.0 - frac) +
+                                         smoothedAt(msIdx + 1) * frac);
     else if (msIdx < totalMs)
-      result[frame] = static_cast<float>(smoothedMs[msIdx]);
+      result[frame] = static_cast<float>(smoothedAt(msIdx));
     else
-      result[frame] = static_cast<float>(smoothedMs.back());
+      result[frame] = static_cast<float>(tail);
   }
 
   return result;
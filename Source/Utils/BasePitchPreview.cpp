@@ -25,26 +25,11 @@ int clampMsIndex(int idx, int minIdx, int maxIdx) {
     return maxIdx;
   return idx;
 }
-} // namespace
 
-BasePitchPreviewRange computeBasePitchPreviewRange(
-    const std::vector<Note> &notes, int totalFrames,
-    const std::function<bool(const Note &)> &isSelected) {
+BasePitchPreviewRange computeFromSegments(std::vector<PreviewNote> segments,
+                                          int totalFrames) {
   BasePitchPreviewRange result;
-  if (notes.empty() || totalFrames <= 0)
-    return result;
-
-  std::vector<PreviewNote> segments;
-  segments.reserve(notes.size());
-  for (const auto &note : notes) {
-    if (note.isRest())
-      continue;
-    segments.push_back(
-        {note.getStartFrame(), note.getEndFrame(), note.getMidiNote(),
-         isSelected ? isSelected(note) : false});
-  }
-
-  if (segments.empty())
+  if (segments.empty() || totalFrames <= 0)
     return result;
 
   std::sort(segments.begin(), segments.end(),
@@ -188,3 +173,65 @@ BasePitchPreviewRange computeBasePitchPreviewRange(
 
   return result;
 }
+} // namespace
+
+BasePitchPreviewRange computeBasePitchPreviewRange(
+    const std::vector<Note> &notes, int totalFrames,
+    const std::function<bool(const Note &)> &isSelected) {
+  std::vector<PreviewNote> segments;
+  segments.reserve(notes.size());
+  for (const auto &note : notes) {
+    if (note.isRest())
+      continue;
+    segments.push_back(
+        {note.getStartFrame(), note.getEndFrame(), note.getMidiNote(),
+         isSelected ? isSelected(note) : false});
+  }
+  return computeFromSegments(std::move(segments), totalFrames);
+}
+
+BasePitchPreviewRange computeBasePitchPreviewRange(
+    const Project &project, int selectionStart, int selectionEnd,
+    int totalFrames, const std::function<bool(const Note &)> &isSelected) {
+  if (selectionEnd <= selectionStart || totalFrames <= 0)
+    return {};
+
+  // Selected regions end at the midpoints to their unselected neighbours,
+  // and the kernel reaches past them; on the right the neighbour must also
+  // outlast the kernel, as the last note's end clamps the smoothing buffer
+  const double msPerFrame =
+      1000.0 * static_cast<double>(HOP_SIZE) / static_cast<double>(SAMPLE_RATE);
+  const int padFrames = static_cast<int>(
+      std::ceil(2.0 * BasePitchCurve::kernelSize() / msPerFrame)) + 1;
+
+  std::vector<const Note *> nearby;
+  int span = std::max(padFrames, selectionEnd - selectionStart);
+  for (;;) {
+    const int from = std::max(0, selectionStart - span);
+    const int to = std::min(totalFrames, selectionEnd + span);
+    nearby = project.getNotesInRange(from, to);
+
+    bool leftFound = from == 0;
+    bool rightFound = to == totalFrames;
+    for (const auto *note : nearby) {
+      if (note->isRest() || isSelected(*note))
+        continue;
+      leftFound = leftFound || note->getEndFrame() <= selectionStart;
+      rightFound = rightFound || (note->getStartFrame() >= selectionEnd &&
+                                  note->getEndFrame() >= selectionEnd + padFrames);
+    }
+    if (leftFound && rightFound)
+      break;
+    span *= 2;
+  }
+
+  std::vector<PreviewNote> segments;
+  segments.reserve(nearby.size());
+  for (const auto *note : nearby) {
+    if (note->isRest())
+      continue;
+    segments.push_back({note->getStartFrame(), note->getEndFrame(),
+                        note->getMidiNote(), isSelected(*note)});
+  }
+  return computeFromSegments(std::move(segments), totalFrames);
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "../Models/Note.h"
+#include "../Models/Project.h"
 #include <functional>
 #include <vector>
 
@@ -13,3 +14,10 @@ struct BasePitchPreviewRange {
 BasePitchPreviewRange computeBasePitchPreviewRange(
     const std::vector<Note> &notes, int totalFrames,
     const std::function<bool(const Note &)> &isSelected);
+
+// The same range from only the notes near the selection, which must lie
+// within [selectionStart, selectionEnd): costs the selection's length rather
+// than the project's
+BasePitchPreviewRange computeBasePitchPreviewRange(
+    const Project &project, int selectionStart, int selectionEnd,
+    int totalFrames, const std::function<bool(const Note &)> &isSelected);
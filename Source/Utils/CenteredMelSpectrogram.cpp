@@ -1,5 +1,8 @@
 #include "CenteredMelSpectrogram.h"
 #include "Constants.h"
+#include "DspKernels.h"
+#include "JobSystem.h"
+#include <atomic>
 #include <cmath>
 #include <algorithm>
 #include <numeric>
@@ -8,10 +11,11 @@ CenteredMelSpectrogram::CenteredMelSpectrogram(int sampleRate, int nFft, int win
                                                int numMels, float fMin, float fMax)
     : sampleRate(sampleRate), nFft(nFft), winSize(winSize),
       numMels(numMels), fMin(fMin), fMax(fMax),
-      fft(static_cast<int>(std::log2(nFft)))
+      fft(static_cast<int>(std::log2(nFft))),
+      scratch(static_cast<size_t>(nFft) * 2)
 {
     createWindow();
-    createMelFilterbank();
+    melFilterbank = MelFilterbank::get(sampleRate, nFft, numMels, fMin, fMax);
 }
 
 void CenteredMelSpectrogram::createWindow()
@@ -24,170 +28,289 @@ void CenteredMelSpectrogram::createWindow()
     }
 }
 
-void CenteredMelSpectrogram::createMelFilterbank()
+namespace
 {
-    // Slaney-style mel scale (matches librosa default with htk=False)
-    const float f_min_mel = 0.0f;
-    const float f_sp = 200.0f / 3.0f;  // ~66.67 Hz per mel below 1000 Hz
-    const float min_log_hz = 1000.0f;
-    const float min_log_mel = (min_log_hz - f_min_mel) / f_sp;  // = 15.0
-    const float logstep = std::log(6.4f) / 27.0f;  // ~0.0687
-
-    auto hzToMel = [=](float hz) -> float {
-        if (hz < min_log_hz)
-            return (hz - f_min_mel) / f_sp;
-        else
-            return min_log_mel + std::log(hz / min_log_hz) / logstep;
-    };
-
-    auto melToHz = [=](float mel) -> float {
-        if (mel < min_log_mel)
-            return f_min_mel + f_sp * mel;
-        else
-            return min_log_hz * std::exp(logstep * (mel - min_log_mel));
-    };
+    // Frames per block, and so per pool job; neighbouring windows overlap,
+    // so a block reads little audio beyond its first window
+    constexpr size_t framesPerBlock = 32;
+
+    // Window the frame starting at firstSample, reflecting about the ends
+    // of the audio (matches librosa/torch)
+    void windowReflected(const float* audio, int numSamples, int firstSample,
+                         const float* hann, float* out, int windowLength)
+    {
+        for (int j = 0; j < windowLength; ++j)
+        {
+            int srcIdx = firstSample + j;
 
-    float melMin = hzToMel(fMin);
-    float melMax = hzToMel(fMax);
+            float sample = 0.0f;
+            if (srcIdx < 0)
+            {
+                // Left boundary: reflect
+                int reflectIdx = std::min(-srcIdx - 1, numSamples - 1);
+                reflectIdx = std::max(0, reflectIdx);
+                sample = audio[reflectIdx];
+            }
+            else if (srcIdx >= numSamples)
+            {
+                // Right boundary: reflect
+                int reflectIdx = numSamples - 1 - (srcIdx - numSamples);
+                reflectIdx = std::max(0, reflectIdx);
+                sample = audio[reflectIdx];
+            }
+            else
+            {
+                sample = audio[srcIdx];
+            }
 
-    std::vector<float> melPoints(numMels + 2);
-    for (int i = 0; i <= numMels + 1; ++i)
-    {
-        melPoints[i] = melMin + (melMax - melMin) * i / (numMels + 1);
+            out[j] = sample * hann[j];
+        }
     }
+} // namespace
+
+template <typename FftSize, typename WindowSize, typename MelCount>
+void CenteredMelSpectrogram::computeBlock(const float* audio, int numSamples,
+                                          const PendingFrame* frames, size_t count,
+                                          const juce::dsp::FFT& transform, float* scratch,
+                                          FftSize frameSize, WindowSize windowSize,
+                                          MelCount melCount) const
+{
+    const int size = static_cast<int>(frameSize);
+    const int windowLength = static_cast<int>(windowSize);
+    const int halfWindow = windowLength / 2;
+    const float* hann = window.data();
+
+    // Sorted by center, so the frames needing no padding form one run
+    const PendingFrame* end = frames + count;
+    const PendingFrame* interiorBegin = std::partition_point(
+        frames, end, [&](const PendingFrame& frame) { return frame.center - halfWindow < 0; });
+    const PendingFrame* interiorEnd = std::partition_point(
+        interiorBegin, end, [&](const PendingFrame& frame) {
+            return frame.center - halfWindow + windowLength <= numSamples;
+        });
+
+    auto computeRange = [&](const PendingFrame* first, const PendingFrame* last, bool interior) {
+        for (const PendingFrame* frame = first; frame != last; ++frame)
+        {
+            const int firstSample = frame->center - halfWindow;
+            if (interior)
+                juce::FloatVectorOperations::multiply(scratch, audio + firstSample, hann,
+                                                      windowLength);
+            else
+                windowReflected(audio, numSamples, firstSample, hann, scratch, windowLength);
+            juce::FloatVectorOperations::clear(scratch + windowLength, 2 * size - windowLength);
+
+            // Perform FFT; only bins 0..nFft/2 are used
+            transform.performRealOnlyForwardTransform(scratch, true);
+            DspKernels::magnitudeInPlace(scratch, DspKernels::numBinsFor(frameSize), 1e-9f);
+
+            melFilterbank->apply(scratch, frame->melOut);
+
+            // Log scale (natural log for vocoder compatibility)
+            // Use clamp value matching Python: 1e-9
+            DspKernels::logInPlace(frame->melOut, melCount, 1e-9f);
+        }
+    };
+    computeRange(frames, interiorBegin, false);
+    computeRange(interiorBegin, interiorEnd, true);
+    computeRange(interiorEnd, end, false);
+}
 
-    std::vector<float> hzPoints(numMels + 2);
-    for (int i = 0; i <= numMels + 1; ++i)
+void CenteredMelSpectrogram::computeBlock(const float* audio, int numSamples,
+                                          const PendingFrame* frames, size_t count,
+                                          const juce::dsp::FFT& transform, float* scratch) const
+{
+    // The shipped geometry runs with constant loop counts
+    if (nFft == N_FFT && winSize == WIN_SIZE && numMels == NUM_MELS)
     {
-        hzPoints[i] = melToHz(melPoints[i]);
+        computeBlock(audio, numSamples, frames, count, transform, scratch,
+                     DspKernels::Fixed<N_FFT>(), DspKernels::Fixed<WIN_SIZE>(),
+                     DspKernels::Fixed<NUM_MELS>());
+        return;
     }
+    computeBlock(audio, numSamples, frames, count, transform, scratch, nFft, winSize, numMels);
+}
 
-    int numBins = nFft / 2 + 1;
+void CenteredMelSpectrogram::computeFrames(const float* audio, int numSamples,
+                                           const std::vector<PendingFrame>& frames)
+{
+    const size_t numBlocks = (frames.size() + framesPerBlock - 1) / framesPerBlock;
+    auto runBlock = [&](size_t block, const juce::dsp::FFT& transform, float* blockScratch) {
+        const size_t first = block * framesPerBlock;
+        computeBlock(audio, numSamples, frames.data() + first,
+                     std::min(framesPerBlock, frames.size() - first), transform, blockScratch);
+    };
 
-    melFilterbank.resize(numMels);
-    for (int m = 0; m < numMels; ++m)
+    const int numHelpers = std::min(JobSystem::getInstance().getNumWorkers(),
+                                    static_cast<int>(numBlocks) - 1);
+    if (numHelpers <= 0)
     {
-        melFilterbank[m].resize(numBins, 0.0f);
-
-        float fLow = hzPoints[m];
-        float fCenter = hzPoints[m + 1];
-        float fHigh = hzPoints[m + 2];
-
-        // Slaney normalization
-        float enorm = 2.0f / (fHigh - fLow);
+        for (size_t block = 0; block < numBlocks; ++block)
+            runBlock(block, fft, scratch.data());
+        return;
+    }
 
-        for (int k = 0; k < numBins; ++k)
-        {
-            float freq = static_cast<float>(k) * sampleRate / nFft;
+    // Whichever thread is free takes the next block, this one included, so
+    // a request still finishes while the workers are busy elsewhere
+    std::atomic<size_t> nextBlock{0};
+    auto drain = [&](const juce::dsp::FFT& transform, float* blockScratch) {
+        for (size_t block = nextBlock++; block < numBlocks; block = nextBlock++)
+            runBlock(block, transform, blockScratch);
+    };
 
-            if (freq >= fLow && freq < fCenter)
-            {
-                melFilterbank[m][k] = enorm * (freq - fLow) / (fCenter - fLow);
-            }
-            else if (freq >= fCenter && freq <= fHigh)
-            {
-                melFilterbank[m][k] = enorm * (fHigh - freq) / (fHigh - fCenter);
-            }
-        }
+    JobSystem::Group helpers;
+    for (int i = 0; i < numHelpers; ++i)
+    {
+        helpers.submit(JobSystem::Priority::Interactive, [&]() {
+            if (nextBlock.load() >= numBlocks)
+                return;
+            // FFT engines may keep a work buffer (IPP's does), so each
+            // thread transforms with its own
+            const juce::dsp::FFT transform(static_cast<int>(std::log2(nFft)));
+            std::vector<float> ownScratch(static_cast<size_t>(nFft) * 2);
+            drain(transform, ownScratch.data());
+        });
     }
+    drain(fft, scratch.data());
+    helpers.wait();
 }
 
-std::vector<float> CenteredMelSpectrogram::computeFrameAtCenter(
-    const float* audio, int numSamples, double center)
+MelBuffer CenteredMelSpectrogram::computeAtCenters(
+    const float* audio, int numSamples, const std::vector<double>& centers,
+    const RenderSnapshot::Ptr& source)
 {
-    // Compute single STFT frame centered at given position
-    // Uses reflect padding for boundary handling (matches librosa/torch)
+    if (numSamples == 0 || centers.empty())
+        return {};
 
-    const int halfWin = winSize / 2;
-    std::vector<float> frame(nFft * 2, 0.0f);  // Complex FFT buffer
+    const bool useCache = source && source->getNumSamples() == numSamples;
+    if (useCache)
+        syncFrameCache(source);
 
-    for (int j = 0; j < winSize; ++j)
-    {
-        // Calculate source index relative to center
-        int srcIdx = static_cast<int>(std::round(center)) - halfWin + j;
+    MelBuffer result(centers.size(), numMels);
+    const size_t rowSize = static_cast<size_t>(numMels);
 
-        float sample = 0.0f;
-        if (srcIdx < 0)
-        {
-            // Left boundary: reflect
-            int reflectIdx = std::min(-srcIdx - 1, numSamples - 1);
-            reflectIdx = std::max(0, reflectIdx);
-            sample = audio[reflectIdx];
-        }
-        else if (srcIdx >= numSamples)
-        {
-            // Right boundary: reflect
-            int reflectIdx = numSamples - 1 - (srcIdx - numSamples);
-            reflectIdx = std::max(0, reflectIdx);
-            sample = audio[reflectIdx];
-        }
-        else
+    // Frames are computed at the whole sample nearest their center, so a
+    // cache hit or a repeated center gives exactly the same row
+    std::vector<PendingFrame> pending;
+    pending.reserve(centers.size());
+    for (size_t i = 0; i < centers.size(); ++i)
+    {
+        const int centerSample = static_cast<int>(std::round(centers[i]));
+        if (useCache)
         {
-            sample = audio[srcIdx];
+            if (auto it = frameCacheIndex.find(centerSample); it != frameCacheIndex.end())
+            {
+                const float* cached = frameCacheRows.data() + it->second * rowSize;
+                std::copy(cached, cached + rowSize, result[i]);
+                continue;
+            }
         }
-
-        frame[j] = sample * window[j];
+        pending.push_back({ centerSample, result[i] });
     }
-
-    // Perform FFT
-    fft.performRealOnlyForwardTransform(frame.data());
-
-    // Compute magnitude spectrum
-    int numBins = nFft / 2 + 1;
-    std::vector<float> magnitude(numBins);
-    for (int k = 0; k < numBins; ++k)
+    if (pending.empty())
+        return result;
+
+    // Sorted into neighbours; each repeat is copied from the first frame at
+    // its center once that is computed
+    std::sort(pending.begin(), pending.end(),
+              [](const PendingFrame& a, const PendingFrame& b) { return a.center < b.center; });
+    std::vector<std::pair<float*, const float*>> repeats;
+    size_t numUnique = 0;
+    for (const auto& frame : pending)
     {
-        float real = frame[k * 2];
-        float imag = frame[k * 2 + 1];
-        magnitude[k] = std::sqrt(real * real + imag * imag + 1e-9f);
+        if (numUnique > 0 && pending[numUnique - 1].center == frame.center)
+            repeats.emplace_back(frame.melOut, pending[numUnique - 1].melOut);
+        else
+            pending[numUnique++] = frame;
     }
+    pending.resize(numUnique);
 
-    return magnitude;
-}
-
-std::vector<float> CenteredMelSpectrogram::applyMelFilterbank(const std::vector<float>& magnitude)
-{
-    std::vector<float> mel(numMels);
-    int numBins = nFft / 2 + 1;
+    computeFrames(audio, numSamples, pending);
+    for (const auto& [row, computed] : repeats)
+        std::copy(computed, computed + rowSize, row);
 
-    for (int m = 0; m < numMels; ++m)
+    if (!useCache)
+        return result;
+    for (const auto& frame : pending)
     {
-        float sum = 0.0f;
-        for (int k = 0; k < numBins; ++k)
+        if (frameCacheIndex.size() >= maxCachedFrames)
         {
-            sum += magnitude[k] * melFilterbank[m][k];
+            frameCacheIndex.clear();
+            frameCacheRows.clear();
         }
-        // Log scale (natural log for vocoder compatibility)
-        // Use clamp value matching Python: 1e-9
-        mel[m] = std::log(std::max(sum, 1e-9f));
+        frameCacheIndex.emplace(frame.center, frameCacheIndex.size());
+        frameCacheRows.insert(frameCacheRows.end(), frame.melOut, frame.melOut + rowSize);
     }
 
-    return mel;
+    return result;
 }
 
-std::vector<std::vector<float>> CenteredMelSpectrogram::computeAtCenters(
-    const float* audio, int numSamples, const std::vector<double>& centers)
+void CenteredMelSpectrogram::clearFrameCache()
 {
-    if (numSamples == 0 || centers.empty())
-        return {};
+    frameCacheIndex.clear();
+    frameCacheRows.clear();
+    frameCacheSource.reset();
+}
 
-    std::vector<std::vector<float>> result;
-    result.reserve(centers.size());
+void CenteredMelSpectrogram::syncFrameCache(const RenderSnapshot::Ptr& source)
+{
+    if (source == frameCacheSource)
+        return;
+    if (!frameCacheSource || frameCacheSource->getNumSamples() != source->getNumSamples()
+        || frameCacheSource->getNumTiles() != source->getNumTiles())
+    {
+        clearFrameCache();
+        frameCacheSource = source;
+        return;
+    }
 
-    for (double center : centers)
+    // Tiles edited since the cached rows were computed
+    std::vector<char> changed(static_cast<size_t>(source->getNumTiles()), 0);
+    bool anyChanged = false;
+    for (int t = 0; t < source->getNumTiles(); ++t)
     {
-        auto magnitude = computeFrameAtCenter(audio, numSamples, center);
-        auto mel = applyMelFilterbank(magnitude);
-        result.push_back(std::move(mel));
+        if (!source->sharesTile(*frameCacheSource, t))
+        {
+            changed[static_cast<size_t>(t)] = 1;
+            anyChanged = true;
+        }
     }
+    frameCacheSource = source;
+    if (!anyChanged)
+        return;
 
-    return result;
+    // Keep rows whose whole window (reflection included) lies in unchanged
+    // tiles
+    const int halfWin = winSize / 2;
+    const int lastSample = source->getNumSamples() - 1;
+    const size_t rowSize = static_cast<size_t>(numMels);
+    std::vector<float> keptRows;
+    keptRows.reserve(frameCacheRows.size());
+    for (auto it = frameCacheIndex.begin(); it != frameCacheIndex.end();)
+    {
+        const int first = std::clamp(it->first - halfWin, 0, lastSample) / RenderSnapshot::tileSize;
+        const int last = std::clamp(it->first - halfWin + winSize - 1, 0, lastSample) / RenderSnapshot::tileSize;
+        bool valid = true;
+        for (int t = first; t <= last && valid; ++t)
+            valid = !changed[static_cast<size_t>(t)];
+
+        if (!valid)
+        {
+            it = frameCacheIndex.erase(it);
+            continue;
+        }
+        const auto row = frameCacheRows.begin() + static_cast<std::ptrdiff_t>(it->second * rowSize);
+        it->second = keptRows.size() / rowSize;
+        keptRows.insert(keptRows.end(), row, row + static_cast<std::ptrdiff_t>(rowSize));
+        ++it;
+    }
+    frameCacheRows = std::move(keptRows);
 }
 
 void CenteredMelSpectrogram::computeTimeStretched(
     const float* globalAudio, int numSamples,
     int startFrame, int endFrame, int newLength,
-    std::vector<std::vector<float>>& stretchedMel)
+    MelBuffer& stretchedMel, const RenderSnapshot::Ptr& source)
 {
     // This function computes time-stretched mel spectrogram using centered STFT
     // Key insight from Python implementation:
@@ -234,10 +357,10 @@ void CenteredMelSpectrogram::computeTimeStretched(
     }
 
     // Compute mel spectrogram at new center positions using the GLOBAL waveform
-    stretchedMel = computeAtCenters(globalAudio, numSamples, newCenters);
+    stretchedMel = computeAtCenters(globalAudio, numSamples, newCenters, source);
 }
 
-std::vector<std::vector<float>> CenteredMelSpectrogram::computeWithSpeedCurve(
+MelBuffer CenteredMelSpectrogram::computeWithSpeedCurve(
     const float* audio, int numSamples,
     int startSample, int endSample,
     const std::vector<float>& speeds, int hopSize)
@@ -286,13 +409,15 @@ std::vector<std::vector<float>> CenteredMelSpectrogram::computeWithSpeedCurve(
     // For each output frame, find the corresponding position in original audio
     std::vector<double> centers(numOutputFrames);
 
+    // Frame times increase, so each search starts where the last one ended
+    auto it = tNew.begin();
     for (int i = 0; i < numOutputFrames; ++i)
     {
         // New mel frame time (with offset)
         double newMelTime = i * hopSize + timeOffset;
 
         // Binary search to find position in tNew
-        auto it = std::lower_bound(tNew.begin(), tNew.end(), newMelTime);
+        it = std::lower_bound(it, tNew.end(), newMelTime);
         int idx = static_cast<int>(std::distance(tNew.begin(), it));
 
         double origSample;
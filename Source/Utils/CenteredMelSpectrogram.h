@@ -1,6 +1,10 @@
 #pragma once
 
 #include "../JuceHeader.h"
+#include "MelBuffer.h"
+#include "MelFilterbank.h"
+#include "RenderSnapshot.h"
+#include <unordered_map>
 #include <vector>
 
 /**
@@ -22,6 +26,18 @@
  * 2. Inverse map: new time -> original time
  * 3. Use centered STFT at non-uniform positions in original audio
  * 4. Result is time-stretched mel spectrogram without phase artifacts
+ *
+ * Frames are computed at whole-sample centers. When the caller passes the
+ * render snapshot of the audio, each result row is cached by its center
+ * sample, so stretching the same note again (or to a neighbouring ratio)
+ * reuses every frame whose center it shares with earlier calls. Rows whose
+ * window overlaps a tile that changed since the last call are dropped.
+ *
+ * The frames left to compute are sorted by center and split into blocks of
+ * neighbours, whose windows overlap in cache. Long requests spread the
+ * blocks over JobSystem workers, each with its own FFT and scratch; the
+ * calling thread takes blocks too. Rows do not depend on the thread that
+ * computed them.
  */
 class CenteredMelSpectrogram
 {
@@ -35,10 +51,12 @@ public:
      * @param audio Audio samples (GLOBAL waveform)
      * @param numSamples Number of samples
      * @param centers Center positions (in samples) for each frame
+     * @param source Snapshot of audio; enables the frame cache
      * @return Mel spectrogram [T, numMels] in log scale
      */
-    std::vector<std::vector<float>> computeAtCenters(const float* audio, int numSamples,
-                                                      const std::vector<double>& centers);
+    MelBuffer computeAtCenters(const float* audio, int numSamples,
+                               const std::vector<double>& centers,
+                               const RenderSnapshot::Ptr& source = nullptr);
 
     /**
      * Compute time-stretched mel spectrogram for a note region.
@@ -50,10 +68,12 @@ public:
      * @param endFrame End frame of the note in original mel
      * @param newLength Target length in frames after stretching
      * @param stretchedMel Output: stretched mel spectrogram [newLength, numMels]
+     * @param source Snapshot of globalAudio; enables the frame cache
      */
     void computeTimeStretched(const float* globalAudio, int numSamples,
                               int startFrame, int endFrame, int newLength,
-                              std::vector<std::vector<float>>& stretchedMel);
+                              MelBuffer& stretchedMel,
+                              const RenderSnapshot::Ptr& source = nullptr);
 
     /**
      * Compute time-stretched mel spectrogram with non-uniform speed.
@@ -65,29 +85,46 @@ public:
      * @param hopSize Hop size for output frames
      * @return Mel spectrogram [T_new, numMels] in log scale
      */
-    std::vector<std::vector<float>> computeWithSpeedCurve(
+    MelBuffer computeWithSpeedCurve(
         const float* audio, int numSamples,
         int startSample, int endSample,
         const std::vector<float>& speeds, int hopSize);
 
+    /** Drop all cached frames. */
+    void clearFrameCache();
+
     int getNumMels() const { return numMels; }
     int getNFft() const { return nFft; }
     int getWinSize() const { return winSize; }
 
 private:
-    void createMelFilterbank();
     void createWindow();
 
-    /**
-     * Compute single STFT frame centered at given position.
-     * Uses reflect padding for boundary handling.
-     */
-    std::vector<float> computeFrameAtCenter(const float* audio, int numSamples, double center);
+    // A frame to compute: its whole-sample center and where its row goes
+    struct PendingFrame
+    {
+        int center;
+        float* melOut;
+    };
+
+    /** Mel rows, log scaled, of frames (sorted by center), on the pool. */
+    void computeFrames(const float* audio, int numSamples,
+                       const std::vector<PendingFrame>& frames);
 
     /**
-     * Apply mel filterbank and log compression to magnitude spectrum.
+     * Mel rows of count sorted frames through transform and scratch
+     * (2 * nFft floats). Frames whose window lies inside the audio are
+     * read straight from it; the rest use reflect padding.
      */
-    std::vector<float> applyMelFilterbank(const std::vector<float>& magnitude);
+    void computeBlock(const float* audio, int numSamples, const PendingFrame* frames,
+                      size_t count, const juce::dsp::FFT& transform, float* scratch) const;
+
+    // FftSize, WindowSize and MelCount are int, or DspKernels::Fixed for
+    // the geometry of Constants.h
+    template <typename FftSize, typename WindowSize, typename MelCount>
+    void computeBlock(const float* audio, int numSamples, const PendingFrame* frames,
+                      size_t count, const juce::dsp::FFT& transform, float* scratch,
+                      FftSize frameSize, WindowSize windowSize, MelCount melCount) const;
 
     int sampleRate;
     int nFft;
@@ -97,7 +134,18 @@ private:
     float fMax;
 
     std::vector<float> window;  // Hann window
-    std::vector<std::vector<float>> melFilterbank;
+    MelFilterbank::Ptr melFilterbank;
+
+    juce::dsp::FFT fft;          // The calling thread's; workers make their own
+    std::vector<float> scratch;  // Likewise
+
+    // Drop cached rows that source invalidates, then adopt it
+    void syncFrameCache(const RenderSnapshot::Ptr& source);
 
-    juce::dsp::FFT fft;
+    // Cached mel rows keyed by center sample; rows live in frameCacheRows.
+    // frameCacheSource keeps the tiles they were computed from alive.
+    static constexpr size_t maxCachedFrames = 16384;  // 8 MB at 128 mels
+    std::unordered_map<int, size_t> frameCacheIndex;
+    std::vector<float> frameCacheRows;
+    RenderSnapshot::Ptr frameCacheSource;
 };
@@ -0,0 +1,90 @@
+#include "CurveConvolution.h"
+#include "../JuceHeader.h"
+#include <algorithm>
+#include <numeric>
+
+namespace
+{
+    void correlateDirect(const double* input, int numOutputs,
+                         const std::vector<double>& kernel, double* out)
+    {
+        const int kernelSize = static_cast<int>(kernel.size());
+        for (int i = 0; i < numOutputs; ++i)
+        {
+            const double* window = input + i;
+            double sum = 0.0;
+            for (int j = 0; j < kernelSize; ++j)
+                sum += window[j] * kernel[static_cast<size_t>(j)];
+            out[i] = sum;
+        }
+    }
+
+    // Overlap-save with blocks of 4x the kernel (rounded up to a power of
+    // two); each block yields blockSize - kernelSize + 1 outputs
+    void correlateFft(const double* input, int numOutputs,
+                      const std::vector<double>& kernel, double* out)
+    {
+        const int kernelSize = static_cast<int>(kernel.size());
+        const int numInputs = numOutputs + kernelSize - 1;
+
+        int order = 1;
+        while ((1 << order) < 4 * kernelSize)
+            ++order;
+        const int blockSize = 1 << order;
+        const int step = blockSize - kernelSize + 1;
+        juce::dsp::FFT fft(order);
+
+        // Correlation is convolution with the reversed kernel
+        std::vector<float> kernelSpectrum(static_cast<size_t>(2 * blockSize), 0.0f);
+        for (int j = 0; j < kernelSize; ++j)
+            kernelSpectrum[static_cast<size_t>(j)] =
+                static_cast<float>(kernel[static_cast<size_t>(kernelSize - 1 - j)]);
+        fft.performRealOnlyForwardTransform(kernelSpectrum.data(), true);
+
+        // Curves sit far from zero (pitch in semitones), so remove an offset
+        // before going to float; the kernel's gain puts it back
+        const double offset = input[0];
+        const double restored = offset * std::accumulate(kernel.begin(), kernel.end(), 0.0);
+
+        std::vector<float> block(static_cast<size_t>(2 * blockSize));
+        for (int start = 0; start < numOutputs; start += step)
+        {
+            const int available = std::min(blockSize, numInputs - start);
+            std::fill(block.begin(), block.end(), 0.0f);
+            for (int i = 0; i < available; ++i)
+                block[static_cast<size_t>(i)] = static_cast<float>(input[start + i] - offset);
+
+            fft.performRealOnlyForwardTransform(block.data(), true);
+            for (int bin = 0; bin <= blockSize / 2; ++bin)
+            {
+                const float re = block[static_cast<size_t>(2 * bin)];
+                const float im = block[static_cast<size_t>(2 * bin + 1)];
+                const float kRe = kernelSpectrum[static_cast<size_t>(2 * bin)];
+                const float kIm = kernelSpectrum[static_cast<size_t>(2 * bin + 1)];
+                block[static_cast<size_t>(2 * bin)] = re * kRe - im * kIm;
+                block[static_cast<size_t>(2 * bin + 1)] = re * kIm + im * kRe;
+            }
+            fft.performRealOnlyInverseTransform(block.data());
+
+            // The first kernelSize - 1 samples hold the circular wrap-around
+            const int count = std::min(step, numOutputs - start);
+            for (int i = 0; i < count; ++i)
+                out[start + i] = static_cast<double>(block[static_cast<size_t>(kernelSize - 1 + i)]) + restored;
+        }
+    }
+} // namespace
+
+namespace CurveConvolution
+{
+    void correlate(const double* input, int numOutputs,
+                   const std::vector<double>& kernel, double* out)
+    {
+        if (numOutputs <= 0 || kernel.empty())
+            return;
+
+        if (usesFft(static_cast<int>(kernel.size()), numOutputs))
+            correlateFft(input, numOutputs, kernel, out);
+        else
+            correlateDirect(input, numOutputs, kernel, out);
+    }
+} // namespace CurveConvolution
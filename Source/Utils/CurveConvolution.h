@@ -0,0 +1,32 @@
+#pragma once
+
+#include <vector>
+
+/**
+ * Smoothing-kernel convolution for dense curves.
+ *
+ * Short kernels are applied by direct summation. From fftMinKernelSize taps
+ * the work moves to FFT overlap-save blocks (juce::dsp::FFT), which costs
+ * O(log n) per output instead of O(kernel size). The FFT runs in single
+ * precision on the input minus its first value, so it matches the direct
+ * path to about 1e-6 of the curve's range.
+ */
+namespace CurveConvolution
+{
+    /** Kernel length from which correlate() uses the FFT path. */
+    constexpr int fftMinKernelSize = 128;
+
+    /** Whether correlate() takes the FFT path for these sizes. */
+    inline bool usesFft(int kernelSize, int numOutputs)
+    {
+        return kernelSize >= fftMinKernelSize && numOutputs >= kernelSize;
+    }
+
+    /**
+     * out[i] = sum over j of input[i + j] * kernel[j], for i in
+     * [0, numOutputs). input holds numOutputs + kernel.size() - 1 values, so
+     * callers pad the edges the way their filter needs.
+     */
+    void correlate(const double* input, int numOutputs,
+                   const std::vector<double>& kernel, double* out);
+} // namespace CurveConvolution
@@ -8,28 +8,38 @@ namespace CurveResampler {
                                     int targetLength) {
     if (targetLength <= 0)
       return {};
-    if (points.empty())
-      return std::vector<float>(static_cast<size_t>(targetLength), 0.0f);
-    if (targetLength == 1)
-      return {points.front()};
-    if (points.size() == 1)
-      return std::vector<float>(static_cast<size_t>(targetLength), points.front());
+    std::vector<float> out(static_cast<size_t>(targetLength));
+    resampleLinear(points.data(), static_cast<int>(points.size()), out.data(),
+                   targetLength);
+    return out;
+  }
 
-    const float tMax = static_cast<float>(points.size() - 1);
-    std::vector<float> out(static_cast<size_t>(targetLength), 0.0f);
+  void resampleLinear(const float* points, int numPoints, float* out,
+                      int targetLength) {
+    if (targetLength <= 0)
+      return;
+    if (numPoints <= 0) {
+      std::fill(out, out + targetLength, 0.0f);
+      return;
+    }
+    if (targetLength == 1 || numPoints == 1) {
+      std::fill(out, out + targetLength, points[0]);
+      return;
+    }
+
+    // Positions are never negative, so truncation is floor; the clamps and
+    // the lerp compile to selects and fused arithmetic with no branches
+    const int last = numPoints - 1;
+    const float tMax = static_cast<float>(last);
+    const float denom = static_cast<float>(targetLength - 1);
     for (int i = 0; i < targetLength; ++i) {
-      const float t = tMax * static_cast<float>(i) /
-                      static_cast<float>(targetLength - 1);
-      const int idx0 = std::clamp(static_cast<int>(std::floor(t)), 0,
-                                  static_cast<int>(points.size() - 1));
-      const int idx1 =
-          std::min(idx0 + 1, static_cast<int>(points.size() - 1));
+      const float t = tMax * static_cast<float>(i) / denom;
+      const int idx0 = std::min(static_cast<int>(t), last);
+      const int idx1 = std::min(idx0 + 1, last);
       const float frac = t - static_cast<float>(idx0);
-      const float v0 = points[static_cast<size_t>(idx0)];
-      const float v1 = points[static_cast<size_t>(idx1)];
-      out[static_cast<size_t>(i)] = v0 + (v1 - v0) * frac;
+      const float v0 = points[idx0];
+      out[i] = v0 + (points[idx1] - v0) * frac;
     }
-    return out;
   }
 
   std::vector<bool> resampleNearest(const std::vector<bool>& points,
@@ -56,26 +66,18 @@ namespace CurveResampler {
     return out;
   }
 
-  std::vector<std::vector<float>> resampleLinear2D(
-      const std::vector<std::vector<float>>& points,
-      int targetLength) {
-    if (targetLength <= 0)
+  MelBuffer resampleLinear2D(const MelView& points, int targetLength) {
+    if (targetLength <= 0 || points.empty())
       return {};
-    if (points.empty()) {
-      return std::vector<std::vector<float>>(static_cast<size_t>(targetLength));
-    }
-    const size_t numChannels = points.front().size();
-    if (points.size() == 1) {
-      return std::vector<std::vector<float>>(
-          static_cast<size_t>(targetLength), points.front());
+    const int numChannels = points.getNumMels();
+    MelBuffer out(static_cast<size_t>(targetLength), numChannels);
+    if (points.size() == 1 || targetLength == 1) {
+      for (int i = 0; i < targetLength; ++i)
+        out.copyFrames(static_cast<size_t>(i), points.slice(0, 1));
+      return out;
     }
-    if (targetLength == 1)
-      return {points.front()};
 
     const float tMax = static_cast<float>(points.size() - 1);
-    std::vector<std::vector<float>> out(
-        static_cast<size_t>(targetLength),
-        std::vector<float>(numChannels, 0.0f));
     for (int i = 0; i < targetLength; ++i) {
       const float t = tMax * static_cast<float>(i) /
                       static_cast<float>(targetLength - 1);
@@ -84,47 +86,35 @@ namespace CurveResampler {
       const int idx1 =
           std::min(idx0 + 1, static_cast<int>(points.size() - 1));
       const float frac = t - static_cast<float>(idx0);
-      const auto &p0 = points[static_cast<size_t>(idx0)];
-      const auto &p1 = points[static_cast<size_t>(idx1)];
-      for (size_t ch = 0; ch < numChannels; ++ch) {
-        const float v0 = ch < p0.size() ? p0[ch] : 0.0f;
-        const float v1 = ch < p1.size() ? p1[ch] : 0.0f;
-        out[static_cast<size_t>(i)][ch] = v0 + (v1 - v0) * frac;
-      }
+      const float *p0 = points[static_cast<size_t>(idx0)];
+      const float *p1 = points[static_cast<size_t>(idx1)];
+      float *dst = out[static_cast<size_t>(i)];
+      for (int ch = 0; ch < numChannels; ++ch)
+        dst[ch] = p0[ch] + (p1[ch] - p0[ch]) * frac;
     }
     return out;
   }
 
-  std::vector<std::vector<float>> resampleNearest2D(
-      const std::vector<std::vector<float>>& points,
-      int targetLength) {
-    if (targetLength <= 0)
+  MelBuffer resampleNearest2D(const MelView& points, int targetLength) {
+    if (targetLength <= 0 || points.empty())
       return {};
-    if (points.empty()) {
-      return std::vector<std::vector<float>>(static_cast<size_t>(targetLength));
+    MelBuffer out(static_cast<size_t>(targetLength), points.getNumMels());
+    if (points.size() == 1 || targetLength == 1) {
+      for (int i = 0; i < targetLength; ++i)
+        out.copyFrames(static_cast<size_t>(i), points.slice(0, 1));
+      return out;
     }
-    const size_t numChannels = points.front().size();
-    if (points.size() == 1) {
-      return std::vector<std::vector<float>>(
-          static_cast<size_t>(targetLength), points.front());
-    }
-    if (targetLength == 1)
-      return {points.front()};
 
     const float tMax = static_cast<float>(points.size() - 1);
-    std::vector<std::vector<float>> out(
-        static_cast<size_t>(targetLength),
-        std::vector<float>(numChannels, 0.0f));
     for (int i = 0; i < targetLength; ++i) {
       const float t = tMax * static_cast<float>(i) /
                       static_cast<float>(targetLength - 1);
       const int idx =
           std::clamp(static_cast<int>(std::round(t)), 0,
                      static_cast<int>(points.size() - 1));
-      const auto &src = points[static_cast<size_t>(idx)];
-      for (size_t ch = 0; ch < numChannels; ++ch)
-        out[static_cast<size_t>(i)][ch] =
-            ch < src.size() ? src[ch] : 0.0f;
+      out.copyFrames(static_cast<size_t>(i),
+                     points.slice(static_cast<size_t>(idx),
+                                  static_cast<size_t>(idx) + 1));
     }
     return out;
   }
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "MelBuffer.h"
 #include <vector>
 
 namespace CurveResampler {
@@ -9,17 +10,18 @@ namespace CurveResampler {
   std::vector<float> resampleLinear(const std::vector<float>& points,
                                     int targetLength);
 
+  // Same as above, writing targetLength values to out. numPoints may be 0
+  // (zeros); out must not overlap points.
+  void resampleLinear(const float* points, int numPoints, float* out,
+                      int targetLength);
+
   // Resample a boolean mask to a target length using nearest-neighbor mapping.
   std::vector<bool> resampleNearest(const std::vector<bool>& points,
                                     int targetLength);
 
   // Resample a 2D curve [T, C] to a target length using linear interpolation.
-  std::vector<std::vector<float>> resampleLinear2D(
-      const std::vector<std::vector<float>>& points,
-      int targetLength);
+  MelBuffer resampleLinear2D(const MelView& points, int targetLength);
 
   // Resample a 2D curve [T, C] to a target length using nearest-neighbor.
-  std::vector<std::vector<float>> resampleNearest2D(
-      const std::vector<std::vector<float>>& points,
-      int targetLength);
+  MelBuffer resampleNearest2D(const MelView& points, int targetLength);
 } // namespace CurveResampler
@@ -0,0 +1,103 @@
+#include "CurveSnapshot.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+template <typename T>
+using Chunks = std::vector<std::shared_ptr<const std::vector<T>>>;
+
+// Cut count values into chunks of chunkSize, taking each chunk from
+// previous when it holds the same values. Returns true if every chunk was
+// shared and the chunk count is unchanged.
+template <typename T>
+bool chunkUp(const Chunks<T> &previous, const T *values, size_t count,
+             size_t chunkSize, Chunks<T> &chunks) {
+  const size_t numChunks = (count + chunkSize - 1) / chunkSize;
+  chunks.clear();
+  chunks.reserve(numChunks);
+  bool allShared = numChunks == previous.size();
+  for (size_t i = 0; i < numChunks; ++i) {
+    const T *start = values + i * chunkSize;
+    const size_t length = std::min(chunkSize, count - i * chunkSize);
+    if (i < previous.size() && previous[i]->size() == length &&
+        std::memcmp(previous[i]->data(), start, length * sizeof(T)) == 0) {
+      chunks.push_back(previous[i]);
+      continue;
+    }
+    chunks.push_back(
+        std::make_shared<const std::vector<T>>(start, start + length));
+    allShared = false;
+  }
+  return allShared;
+}
+
+template <typename T>
+void concatenate(const Chunks<T> &chunks, T *dest) {
+  for (const auto &chunk : chunks)
+    dest = std::copy(chunk->begin(), chunk->end(), dest);
+}
+
+template <typename T> size_t bytesOf(const Chunks<T> &chunks) {
+  size_t bytes = 0;
+  for (const auto &chunk : chunks)
+    bytes += chunk->size() * sizeof(T);
+  return bytes;
+}
+} // namespace
+
+CurveSnapshot::Ptr CurveSnapshot::update(const Ptr &previous,
+                                         const std::vector<float> &f0,
+                                         const VoicedMask &voicedMask,
+                                         const MelView &mel) {
+  static const CurveSnapshot empty;
+  const auto &base =
+      previous && previous->numMels == mel.getNumMels() ? *previous : empty;
+
+  std::shared_ptr<CurveSnapshot> snapshot(new CurveSnapshot());
+  snapshot->numF0Frames = f0.size();
+  snapshot->numVoicedFrames = voicedMask.size();
+  snapshot->numMelFrames = mel.size();
+  snapshot->numMels = mel.getNumMels();
+
+  const size_t melChunkValues =
+      static_cast<size_t>(chunkFrames) * static_cast<size_t>(mel.getNumMels());
+  bool unchanged =
+      chunkUp(base.f0Chunks, f0.data(), f0.size(),
+              static_cast<size_t>(chunkFrames), snapshot->f0Chunks);
+  unchanged &= chunkUp(base.voicedChunks, voicedMask.getWords(),
+                       voicedMask.getNumWords(),
+                       static_cast<size_t>(chunkFrames / 64),
+                       snapshot->voicedChunks);
+  unchanged &=
+      chunkUp(base.melChunks, mel.data(),
+              mel.size() * static_cast<size_t>(mel.getNumMels()),
+              melChunkValues, snapshot->melChunks);
+
+  // Equal word counts can still differ in the frame count of the last word
+  if (unchanged && &base == previous.get() &&
+      previous->numVoicedFrames == snapshot->numVoicedFrames &&
+      previous->numF0Frames == snapshot->numF0Frames &&
+      previous->numMelFrames == snapshot->numMelFrames)
+    return previous;
+  return snapshot;
+}
+
+size_t CurveSnapshot::getNumBytes() const {
+  return bytesOf(f0Chunks) + bytesOf(voicedChunks) + bytesOf(melChunks);
+}
+
+void CurveSnapshot::copyF0(std::vector<float> &dest) const {
+  dest.resize(numF0Frames);
+  concatenate(f0Chunks, dest.data());
+}
+
+void CurveSnapshot::copyVoicedMask(VoicedMask &dest) const {
+  std::vector<uint64_t> words((numVoicedFrames + 63) / 64);
+  concatenate(voicedChunks, words.data());
+  dest.assignWords(words.data(), numVoicedFrames);
+}
+
+void CurveSnapshot::copyMel(MelBuffer &dest) const {
+  dest.reset(numMelFrames, numMels);
+  concatenate(melChunks, dest.data());
+}
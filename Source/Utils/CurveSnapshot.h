@@ -0,0 +1,65 @@
+#pragma once
+
+#include "MelBuffer.h"
+#include "VoicedMask.h"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/**
+ * Immutable, chunked copy of a project's per-frame synthesis inputs: the
+ * F0 curve, the voiced mask and the mel spectrogram.
+ *
+ * The frame counterpart of RenderSnapshot. Each curve is cut into chunks
+ * of chunkFrames frames held by shared pointers, and update() re-copies
+ * only the chunks whose frames differ from the previous snapshot, so a
+ * render or export can pin a consistent version of the curves while the
+ * editor keeps drawing, and a pitch edit costs one F0 chunk rather than a
+ * copy of the mel spectrogram.
+ *
+ * Snapshots never change after creation; any thread may read one it holds.
+ */
+class CurveSnapshot {
+public:
+  using Ptr = std::shared_ptr<const CurveSnapshot>;
+
+  // 1024 frames per chunk (~12 s at hop 512, 44.1 kHz); a multiple of the
+  // voiced mask's 64 frames per word
+  static constexpr int chunkFrames = 1024;
+
+  /**
+   * Snapshot of the curves sharing every chunk that is unchanged since
+   * previous (null to copy everything). Returns previous itself when
+   * nothing changed. Compares the curves against previous, so call it on
+   * the thread that writes them.
+   */
+  static Ptr update(const Ptr &previous, const std::vector<float> &f0,
+                    const VoicedMask &voicedMask, const MelView &mel);
+
+  size_t getNumF0Frames() const { return numF0Frames; }
+  size_t getNumVoicedFrames() const { return numVoicedFrames; }
+  size_t getNumMelFrames() const { return numMelFrames; }
+  int getNumMels() const { return numMels; }
+
+  /** Bytes held by this snapshot's chunks (shared chunks included). */
+  size_t getNumBytes() const;
+
+  /** Contiguous copies of the curves, for the vocoder and exporters. */
+  void copyF0(std::vector<float> &dest) const;
+  void copyVoicedMask(VoicedMask &dest) const;
+  void copyMel(MelBuffer &dest) const;
+
+private:
+  CurveSnapshot() = default;
+
+  template <typename T>
+  using Chunks = std::vector<std::shared_ptr<const std::vector<T>>>;
+
+  Chunks<float> f0Chunks;
+  Chunks<uint64_t> voicedChunks; // Packed as VoicedMask words
+  Chunks<float> melChunks;       // Frame-major, numMels values per frame
+  size_t numF0Frames = 0;
+  size_t numVoicedFrames = 0;
+  size_t numMelFrames = 0;
+  int numMels = NUM_MELS;
+};
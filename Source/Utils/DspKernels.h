@@ -0,0 +1,71 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <type_traits>
+
+/**
+ * Inner loops of the mel and salience code, written once over a count type.
+ *
+ * Given a plain int count a kernel is the generic loop. Given Fixed<N> the
+ * trip count is a compile-time constant, so the compiler unrolls and
+ * vectorizes it without a remainder loop. Callers send the geometries of
+ * the shipped models (N_FFT, NUM_MELS in Constants.h, RMVPE's N_CLASS) to
+ * Fixed and everything else to int, so both paths compute the same values.
+ */
+namespace DspKernels
+{
+    template <int N>
+    using Fixed = std::integral_constant<int, N>;
+
+    /** Bins of an nFft-point real FFT, still a constant for a Fixed size. */
+    inline int numBinsFor(int nFft) { return nFft / 2 + 1; }
+
+    template <int N>
+    Fixed<N / 2 + 1> numBinsFor(Fixed<N>) { return {}; }
+
+    /** Bins in a window reaching halfWidth either side of its centre. */
+    inline int windowWidthFor(int halfWidth) { return 2 * halfWidth + 1; }
+
+    template <int N>
+    Fixed<2 * N + 1> windowWidthFor(Fixed<N>) { return {}; }
+
+    /**
+     * JUCE's interleaved real-FFT output to numBins magnitudes in place. Bin
+     * k reads 2k and 2k + 1, so writing k never clobbers an unread bin.
+     */
+    template <typename Count>
+    inline void magnitudeInPlace(float* spectrum, Count numBins, float epsilon)
+    {
+        for (int k = 0; k < static_cast<int>(numBins); ++k)
+        {
+            const float real = spectrum[k * 2];
+            const float imag = spectrum[k * 2 + 1];
+            spectrum[k] = std::sqrt(real * real + imag * imag + epsilon);
+        }
+    }
+
+    /** values[i] = log(max(values[i], floor)). */
+    template <typename Count>
+    inline void logInPlace(float* values, Count count, float floor)
+    {
+        for (int i = 0; i < static_cast<int>(count); ++i)
+            values[i] = std::log(std::max(values[i], floor));
+    }
+
+    /** Sums of cents[i] * weights[i] and of weights[i] over count bins. */
+    template <typename Count>
+    inline void weightedSums(const float* cents, const float* weights, Count count,
+                             float& weightedSum, float& weightSum)
+    {
+        float weighted = 0.0f;
+        float total = 0.0f;
+        for (int i = 0; i < static_cast<int>(count); ++i)
+        {
+            weighted += cents[i] * weights[i];
+            total += weights[i];
+        }
+        weightedSum = weighted;
+        weightSum = total;
+    }
+} // namespace DspKernels
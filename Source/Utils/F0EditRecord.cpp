@@ -0,0 +1,302 @@
+#include "F0EditRecord.h"
+#include "../JuceHeader.h"
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+    inline uint32_t floatToBits(float value)
+    {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        return bits;
+    }
+
+    inline float bitsToFloat(uint32_t bits)
+    {
+        float value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    // Appends values as XOR-with-previous varints; leaves the stream empty
+    // when every value is +0.0 so unused curves cost nothing
+    template <typename Getter>
+    void encodeCurve(const std::vector<F0FrameEdit>& edits, Getter get, std::vector<uint8_t>& stream)
+    {
+        stream.clear();
+        bool allZero = true;
+        for (const auto& e : edits)
+            allZero = allZero && floatToBits(get(e)) == 0;
+        if (allZero)
+            return;
+
+        stream.reserve(edits.size() * 3);
+        uint32_t previous = 0;
+        for (const auto& e : edits)
+        {
+            const uint32_t bits = floatToBits(get(e));
+            uint32_t x = bits ^ previous;
+            previous = bits;
+            while (x >= 0x80u)
+            {
+                stream.push_back(static_cast<uint8_t>(x | 0x80u));
+                x >>= 7;
+            }
+            stream.push_back(static_cast<uint8_t>(x));
+        }
+        stream.shrink_to_fit();
+    }
+} // namespace
+
+F0EditRecord::F0EditRecord(std::vector<F0FrameEdit> edits)
+{
+    edits.erase(std::remove_if(edits.begin(), edits.end(),
+                               [](const F0FrameEdit& e) { return e.idx < 0; }),
+                edits.end());
+    std::stable_sort(edits.begin(), edits.end(),
+                     [](const F0FrameEdit& a, const F0FrameEdit& b) { return a.idx < b.idx; });
+
+    // Collapse repeated frames: first old values, last new values
+    size_t unique = 0;
+    for (size_t i = 0; i < edits.size(); ++i)
+    {
+        if (unique > 0 && edits[unique - 1].idx == edits[i].idx)
+        {
+            auto& kept = edits[unique - 1];
+            kept.newF0 = edits[i].newF0;
+            kept.newDelta = edits[i].newDelta;
+            kept.newVoiced = edits[i].newVoiced;
+        }
+        else
+        {
+            edits[unique++] = edits[i];
+        }
+    }
+    edits.resize(unique);
+    if (edits.empty())
+        return;
+
+    numFrames = static_cast<int>(edits.size());
+    for (const auto& e : edits)
+    {
+        if (!runs.empty() && runs.back().start + runs.back().length == e.idx)
+            ++runs.back().length;
+        else
+            runs.push_back({e.idx, 1});
+    }
+    runs.shrink_to_fit();
+
+    encodeCurve(edits, [](const F0FrameEdit& e) { return e.oldF0; }, curves[oldF0Curve]);
+    encodeCurve(edits, [](const F0FrameEdit& e) { return e.newF0; }, curves[newF0Curve]);
+    encodeCurve(edits, [](const F0FrameEdit& e) { return e.oldDelta; }, curves[oldDeltaCurve]);
+    encodeCurve(edits, [](const F0FrameEdit& e) { return e.newDelta; }, curves[newDeltaCurve]);
+
+    oldVoiced.assign(edits.size(), false);
+    newVoiced.assign(edits.size(), false);
+    for (size_t i = 0; i < edits.size(); ++i)
+    {
+        if (edits[i].oldVoiced)
+            oldVoiced.set(i, true);
+        if (edits[i].newVoiced)
+            newVoiced.set(i, true);
+    }
+}
+
+void F0EditRecord::decodeCurve(Curve curve, float* out) const
+{
+    const auto& stream = curves[curve];
+    if (stream.empty())
+    {
+        std::fill(out, out + numFrames, 0.0f);
+        return;
+    }
+
+    const uint8_t* p = stream.data();
+    uint32_t previous = 0;
+    for (int i = 0; i < numFrames; ++i)
+    {
+        uint32_t x = 0;
+        int shift = 0;
+        uint8_t byte;
+        do
+        {
+            byte = *p++;
+            x |= static_cast<uint32_t>(byte & 0x7fu) << shift;
+            shift += 7;
+        } while (byte & 0x80u);
+        previous ^= x;
+        out[i] = bitsToFloat(previous);
+    }
+}
+
+bool F0EditRecord::apply(bool useNewValues, std::vector<float>& f0, std::vector<float>* deltaPitch,
+                         VoicedMask* voicedMask, int& minFrame, int& maxFrame) const
+{
+    minFrame = 0;
+    maxFrame = -1;
+    if (runs.empty())
+        return false;
+
+    std::vector<float> values(static_cast<size_t>(numFrames));
+    const VoicedMask& voiced = useNewValues ? newVoiced : oldVoiced;
+
+    // Each run is clipped once per array, then written as a block
+    auto writeRuns = [this](size_t size, auto&& write) {
+        int offset = 0;
+        for (const auto& run : runs)
+        {
+            const int count = std::clamp(static_cast<int>(size) - run.start, 0, run.length);
+            if (count > 0)
+                write(run.start, offset, count);
+            offset += run.length;
+        }
+    };
+
+    decodeCurve(useNewValues ? newF0Curve : oldF0Curve, values.data());
+    writeRuns(f0.size(), [&](int start, int offset, int count) {
+        std::copy_n(values.data() + offset, count, f0.data() + start);
+        if (maxFrame < minFrame)
+            minFrame = start;
+        maxFrame = start + count - 1;
+    });
+
+    if (deltaPitch)
+    {
+        decodeCurve(useNewValues ? newDeltaCurve : oldDeltaCurve, values.data());
+        writeRuns(deltaPitch->size(), [&](int start, int offset, int count) {
+            std::copy_n(values.data() + offset, count, deltaPitch->data() + start);
+        });
+    }
+
+    if (voicedMask)
+    {
+        writeRuns(voicedMask->size(), [&](int start, int offset, int count) {
+            for (int i = 0; i < count; ++i)
+                voicedMask->set(static_cast<size_t>(start + i), voiced.test(static_cast<size_t>(offset + i)));
+        });
+    }
+
+    return minFrame <= maxFrame;
+}
+
+std::vector<F0FrameEdit> F0EditRecord::decode() const
+{
+    std::vector<F0FrameEdit> edits(static_cast<size_t>(numFrames));
+    if (edits.empty())
+        return edits;
+
+    size_t i = 0;
+    for (const auto& run : runs)
+        for (int k = 0; k < run.length; ++k, ++i)
+        {
+            edits[i].idx = run.start + k;
+            edits[i].oldVoiced = oldVoiced.test(i);
+            edits[i].newVoiced = newVoiced.test(i);
+        }
+
+    std::vector<float> values(edits.size());
+    auto unpack = [&](Curve curve, float F0FrameEdit::*field) {
+        decodeCurve(curve, values.data());
+        for (size_t j = 0; j < edits.size(); ++j)
+            edits[j].*field = values[j];
+    };
+    unpack(oldF0Curve, &F0FrameEdit::oldF0);
+    unpack(newF0Curve, &F0FrameEdit::newF0);
+    unpack(oldDeltaCurve, &F0FrameEdit::oldDelta);
+    unpack(newDeltaCurve, &F0FrameEdit::newDelta);
+    return edits;
+}
+
+void F0EditRecord::append(const F0EditRecord& later)
+{
+    if (later.empty())
+        return;
+    if (empty())
+    {
+        *this = later;
+        return;
+    }
+
+    // Both lists are sorted, so the constructor's first-old/last-new rule
+    // does the merge once they are concatenated in order
+    auto edits = decode();
+    auto laterEdits = later.decode();
+    edits.insert(edits.end(), laterEdits.begin(), laterEdits.end());
+    *this = F0EditRecord(std::move(edits));
+}
+
+size_t F0EditRecord::getMemoryBytes() const
+{
+    size_t total = runs.capacity() * sizeof(Run) + oldVoiced.getNumBytes() + newVoiced.getNumBytes();
+    for (const auto& stream : curves)
+        total += stream.capacity();
+    return total;
+}
+
+void F0EditRecord::write(juce::OutputStream& out) const
+{
+    out.writeInt(numFrames);
+    out.writeInt(static_cast<int>(runs.size()));
+    for (const auto& run : runs)
+    {
+        out.writeInt(run.start);
+        out.writeInt(run.length);
+    }
+    for (const auto& stream : curves)
+    {
+        out.writeInt(static_cast<int>(stream.size()));
+        out.write(stream.data(), stream.size());
+    }
+    for (const auto* mask : { &oldVoiced, &newVoiced })
+    {
+        out.writeInt64(static_cast<juce::int64>(mask->size()));
+        out.write(mask->getWords(), mask->getNumWords() * sizeof(uint64_t));
+    }
+}
+
+bool F0EditRecord::read(juce::InputStream& in)
+{
+    F0EditRecord record;
+    record.numFrames = in.readInt();
+    const int numRuns = in.readInt();
+    if (record.numFrames < 0 || numRuns < 0 || numRuns > record.numFrames)
+        return false;
+
+    record.runs.resize(static_cast<size_t>(numRuns));
+    int covered = 0;
+    for (auto& run : record.runs)
+    {
+        run.start = in.readInt();
+        run.length = in.readInt();
+        if (run.length <= 0 || run.length > record.numFrames - covered)
+            return false;
+        covered += run.length;
+    }
+    if (covered != record.numFrames)
+        return false;
+    // Five bytes per value at most
+    for (auto& stream : record.curves)
+    {
+        const int size = in.readInt();
+        if (size < 0 || size > record.numFrames * 5)
+            return false;
+        stream.resize(static_cast<size_t>(size));
+        if (in.read(stream.data(), size) != size)
+            return false;
+    }
+    for (auto* mask : { &record.oldVoiced, &record.newVoiced })
+    {
+        const auto size = in.readInt64();
+        if (size < 0 || size > record.numFrames)
+            return false;
+        std::vector<uint64_t> words((static_cast<size_t>(size) + 63) / 64);
+        const auto bytes = static_cast<int>(words.size() * sizeof(uint64_t));
+        if (in.read(words.data(), bytes) != bytes)
+            return false;
+        mask->assignWords(words.data(), static_cast<size_t>(size));
+    }
+
+    *this = std::move(record);
+    return true;
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "VoicedMask.h"
+#include <cstdint>
+#include <vector>
+
+namespace juce
+{
+    class InputStream;
+    class OutputStream;
+} // namespace juce
+
+/**
+ * One frame of a hand-drawn F0 edit, before and after.
+ */
+struct F0FrameEdit
+{
+    int idx = -1;
+    float oldF0 = 0.0f;
+    float newF0 = 0.0f;
+    float oldDelta = 0.0f;
+    float newDelta = 0.0f;
+    bool oldVoiced = false;
+    bool newVoiced = false;
+};
+
+/**
+ * Compact, lossless store of per-frame F0 edits for undo history.
+ *
+ * Edited frames are grouped into runs of consecutive indices, so no index is
+ * kept per frame. Each curve (old/new F0, old/new delta) is a byte stream of
+ * the XOR between a frame's float bits and the previous frame's, written as
+ * a varint: repeated values cost one byte and neighbouring values on a
+ * smooth curve two or three. A curve that is zero throughout is not stored.
+ * Voiced flags are bit-packed.
+ */
+class F0EditRecord
+{
+public:
+    F0EditRecord() = default;
+
+    /**
+     * Encode edits given in any order. Negative indices are dropped; if a
+     * frame appears twice, its first old values and last new values are kept.
+     */
+    explicit F0EditRecord(std::vector<F0FrameEdit> edits);
+
+    bool empty() const { return runs.empty(); }
+    int getNumFrames() const { return numFrames; }
+
+    /** First and last edited frame; only meaningful when !empty(). */
+    int getFirstFrame() const { return runs.front().start; }
+    int getLastFrame() const { return runs.back().start + runs.back().length - 1; }
+
+    /**
+     * Write the old (undo) or new (redo) values. Runs are clipped to each
+     * array's size; deltaPitch and voicedMask may be null. On return
+     * minFrame/maxFrame hold the written F0 span, and the result is false if
+     * no F0 frame was written.
+     */
+    bool apply(bool useNewValues, std::vector<float>& f0, std::vector<float>* deltaPitch,
+               VoicedMask* voicedMask, int& minFrame, int& maxFrame) const;
+
+    /** Frame-by-frame copy of the record, sorted by index. */
+    std::vector<F0FrameEdit> decode() const;
+
+    /**
+     * Fold in a record made right after this one: frames in both keep this
+     * record's old values and take later's new values.
+     */
+    void append(const F0EditRecord& later);
+
+    size_t getMemoryBytes() const;
+
+    /** The encoded record as it is held, for undo history spilled to disk. */
+    void write(juce::OutputStream& out) const;
+    /** Replace this record with one write() produced; false if malformed. */
+    bool read(juce::InputStream& in);
+
+private:
+    struct Run
+    {
+        int start = 0;
+        int length = 0;
+    };
+
+    enum Curve { oldF0Curve, newF0Curve, oldDeltaCurve, newDeltaCurve, numCurves };
+
+    void decodeCurve(Curve curve, float* out) const;
+
+    std::vector<Run> runs;
+    std::vector<uint8_t> curves[numCurves];
+    VoicedMask oldVoiced;
+    VoicedMask newVoiced;
+    int numFrames = 0;
+};
@@ -1,7 +1,107 @@
 #include "F0Smoother.h"
 #include <algorithm>
+#include <array>
 #include <cmath>
 
+namespace
+{
+    // Voiced values of a sliding window, kept sorted. Each insert or erase
+    // finds its slot by binary search and shifts at most the window size.
+    class SortedWindow
+    {
+    public:
+        explicit SortedWindow(int capacity)
+        {
+            values.reserve(static_cast<size_t>(capacity));
+        }
+        
+        // Unvoiced (non-positive) values are ignored, as in the median itself
+        void insert(float value)
+        {
+            if (value > 0.0f)
+                values.insert(std::upper_bound(values.begin(), values.end(), value), value);
+        }
+        
+        void erase(float value)
+        {
+            if (value <= 0.0f)
+                return;
+            auto it = std::lower_bound(values.begin(), values.end(), value);
+            if (it != values.end() && *it == value)
+                values.erase(it);
+        }
+        
+        bool empty() const { return values.empty(); }
+        
+        // Even counts average the two middle values
+        float median() const
+        {
+            const size_t mid = values.size() / 2;
+            if (values.size() % 2 == 0)
+                return (values[mid - 1] + values[mid]) / 2.0f;
+            return values[mid];
+        }
+        
+    private:
+        std::vector<float> values;
+    };
+    
+    // Interpolation only writes unvoiced gap frames and only reads voiced
+    // ones, so it can work on f0 directly
+    void interpolateGaps(std::vector<float>& f0, const VoicedMask& voicedMask, int maxGapFrames)
+    {
+        const int numFrames = static_cast<int>(f0.size());
+        
+        // Walk unvoiced gaps run by run; a gap running to the end has no next
+        // voiced frame and is left as-is
+        int gapStart = voicedMask.findNext(0, false);
+        while (gapStart < numFrames)
+        {
+            const int gapEnd = voicedMask.findNext(gapStart, true);
+            if (gapEnd >= numFrames)
+                break;
+            
+            const int gapSize = gapEnd - gapStart;
+            if (gapSize <= maxGapFrames && gapStart > 0)
+            {
+                // Find previous and next voiced frames with a valid pitch
+                float f0Prev = 0.0f;
+                float f0Next = 0.0f;
+                
+                for (int j = voicedMask.findPrev(gapStart, true); j >= 0; j = voicedMask.findPrev(j, true))
+                {
+                    if (f0[static_cast<size_t>(j)] > 0.0f)
+                    {
+                        f0Prev = f0[static_cast<size_t>(j)];
+                        break;
+                    }
+                }
+                
+                for (int j = gapEnd; j < numFrames; j = voicedMask.findNext(j + 1, true))
+                {
+                    if (f0[static_cast<size_t>(j)] > 0.0f)
+                    {
+                        f0Next = f0[static_cast<size_t>(j)];
+                        break;
+                    }
+                }
+                
+                // Linear interpolation if both ends are available
+                if (f0Prev > 0.0f && f0Next > 0.0f)
+                {
+                    for (int j = gapStart; j < gapEnd; ++j)
+                    {
+                        float t = static_cast<float>(j - gapStart) / gapSize;
+                        f0[static_cast<size_t>(j)] = f0Prev * (1.0f - t) + f0Next * t;
+                    }
+                }
+            }
+            
+            gapStart = voicedMask.findNext(gapEnd, false);
+        }
+    }
+}
+
 std::vector<float> F0Smoother::medianFilter(const std::vector<float>& f0, int windowSize)
 {
     if (f0.empty() || windowSize < 1)
@@ -11,52 +111,34 @@ std::vector<float> F0Smoother::medianFilter(const std::vector<float>& f0, int wi
     if (windowSize % 2 == 0)
         windowSize += 1;
     
-    int halfWindow = windowSize / 2;
+    const int halfWindow = windowSize / 2;
+    const int numFrames = static_cast<int>(f0.size());
     std::vector<float> smoothed(f0.size());
     
-    for (size_t i = 0; i < f0.size(); ++i)
+    // Slide the window one frame at a time instead of re-sorting it
+    SortedWindow window(windowSize);
+    for (int j = 0; j < std::min(halfWindow, numFrames); ++j)
+        window.insert(f0[static_cast<size_t>(j)]);
+    
+    for (int i = 0; i < numFrames; ++i)
     {
-        int start = static_cast<int>(i) - halfWindow;
-        int end = static_cast<int>(i) + halfWindow;
-        
-        // Collect valid F0 values in window (only voiced)
-        std::vector<float> windowValues;
-        windowValues.reserve(windowSize);
-        
-        for (int j = start; j <= end; ++j)
-        {
-            if (j >= 0 && j < static_cast<int>(f0.size()) && f0[j] > 0.0f)
-            {
-                windowValues.push_back(f0[j]);
-            }
-        }
+        const int entering = i + halfWindow;
+        if (entering < numFrames)
+            window.insert(f0[static_cast<size_t>(entering)]);
+        const int leaving = i - halfWindow - 1;
+        if (leaving >= 0)
+            window.erase(f0[static_cast<size_t>(leaving)]);
         
-        if (!windowValues.empty())
-        {
-            // Sort and get median
-            std::sort(windowValues.begin(), windowValues.end());
-            size_t mid = windowValues.size() / 2;
-            if (windowValues.size() % 2 == 0)
-            {
-                smoothed[i] = (windowValues[mid - 1] + windowValues[mid]) / 2.0f;
-            }
-            else
-            {
-                smoothed[i] = windowValues[mid];
-            }
-        }
-        else
-        {
-            // No voiced frames in window, keep original (or 0)
-            smoothed[i] = f0[i];
-        }
+        // No voiced frames in window, keep original (or 0)
+        smoothed[static_cast<size_t>(i)] = window.empty() ? f0[static_cast<size_t>(i)]
+                                                          : window.median();
     }
     
     return smoothed;
 }
 
 std::vector<float> F0Smoother::smoothTransitions(const std::vector<float>& f0,
-                                                  const std::vector<bool>& voicedMask,
+                                                  const VoicedMask& voicedMask,
                                                   int windowSize)
 {
     if (f0.empty() || f0.size() != voicedMask.size())
@@ -107,72 +189,14 @@ std::vector<float> F0Smoother::smoothTransitions(const std::vector<float>& f0,
 }
 
 std::vector<float> F0Smoother::interpolateUnvoiced(const std::vector<float>& f0,
-                                                     const std::vector<bool>& voicedMask,
+                                                     const VoicedMask& voicedMask,
                                                      int maxGapFrames)
 {
     if (f0.empty() || f0.size() != voicedMask.size())
         return f0;
     
     std::vector<float> interpolated = f0;
-    
-    // Find unvoiced gaps and interpolate small ones
-    size_t gapStart = 0;
-    bool inGap = false;
-    
-    for (size_t i = 0; i < f0.size(); ++i)
-    {
-        if (!voicedMask[i] && !inGap)
-        {
-            // Start of gap
-            gapStart = i;
-            inGap = true;
-        }
-        else if (voicedMask[i] && inGap)
-        {
-            // End of gap
-            size_t gapEnd = i;
-            size_t gapSize = gapEnd - gapStart;
-            
-            if (gapSize <= static_cast<size_t>(maxGapFrames) && gapStart > 0)
-            {
-                // Find previous and next voiced frames
-                float f0Prev = 0.0f;
-                float f0Next = 0.0f;
-                
-                // Find previous voiced frame
-                for (int j = static_cast<int>(gapStart) - 1; j >= 0; --j)
-                {
-                    if (voicedMask[j] && f0[j] > 0.0f)
-                    {
-                        f0Prev = f0[j];
-                        break;
-                    }
-                }
-                
-                // Find next voiced frame
-                for (size_t j = gapEnd; j < f0.size(); ++j)
-                {
-                    if (voicedMask[j] && f0[j] > 0.0f)
-                    {
-                        f0Next = f0[j];
-                        break;
-                    }
-                }
-                
-                // Linear interpolation if both ends are available
-                if (f0Prev > 0.0f && f0Next > 0.0f)
-                {
-                    for (size_t j = gapStart; j < gapEnd; ++j)
-                    {
-                        float t = static_cast<float>(j - gapStart) / gapSize;
-                        interpolated[j] = f0Prev * (1.0f - t) + f0Next * t;
-                    }
-                }
-            }
-            
-            inGap = false;
-        }
-    }
+    interpolateGaps(interpolated, voicedMask, maxGapFrames);
     
     return interpolated;
 }
@@ -211,56 +235,111 @@ std::vector<float> F0Smoother::removeOutliers(const std::vector<float>& f0,
 }
 
 std::vector<float> F0Smoother::smoothF0(const std::vector<float>& f0,
-                                         const std::vector<bool>& voicedMask)
+                                         const VoicedMask& voicedMask)
 {
     if (f0.empty())
         return f0;
     
-    // Step 1: Remove outliers
-    std::vector<float> step1 = removeOutliers(f0, 1.5f);
-    
-    // Step 2: Median filter
-    std::vector<float> step2 = medianFilter(step1, 5);
-    
-    // Step 3: Smooth transitions
-    std::vector<float> step3 = smoothTransitions(step2, voicedMask, 3);
-    
-    // Step 4: Interpolate small unvoiced gaps
-    std::vector<float> step4 = interpolateUnvoiced(step3, voicedMask, 5);
-    
-    return step4;
+    std::vector<float> smoothed = f0;
+    smoothF0InPlace(smoothed, voicedMask);
+    return smoothed;
 }
 
-float F0Smoother::getMedian(const std::vector<float>& values, int start, int end)
+void F0Smoother::smoothF0InPlace(std::vector<float>& f0, const VoicedMask& voicedMask)
 {
-    if (start < 0) start = 0;
-    if (end >= static_cast<int>(values.size())) end = static_cast<int>(values.size()) - 1;
-    if (start > end) return 0.0f;
+    if (f0.empty())
+        return;
+    
+    // Same stages and parameters as the separate filters:
+    // removeOutliers(1.5), medianFilter(5), smoothTransitions(3)
+    constexpr float maxJumpRatio = 1.5f;
+    constexpr int medianHalf = 2;
+    constexpr int transitionHalf = 1;
+    constexpr int medianSize = 2 * medianHalf + 1;
+    constexpr int transitionSize = 2 * transitionHalf + 1;
+    
+    const int numFrames = static_cast<int>(f0.size());
+    const bool hasMask = voicedMask.size() == f0.size();
+    
+    std::array<float, transitionSize> weights{};
+    for (int j = -transitionHalf; j <= transitionHalf; ++j)
+        weights[static_cast<size_t>(j + transitionHalf)] =
+            std::exp(-0.5f * (j * j) / (transitionHalf * transitionHalf + 1.0f));
     
-    std::vector<float> window;
-    window.reserve(end - start + 1);
+    // Stage outputs for the last few frames, indexed by frame modulo size
+    std::array<float, medianSize> cleaned{};
+    std::array<float, transitionSize> median{};
+    SortedWindow window(medianSize);
+    float prevOriginal = 0.0f;
     
-    for (int i = start; i <= end; ++i)
+    // Frame k is cleaned at step k, median-filtered at step k + medianHalf
+    // and written back at step k + medianHalf + transitionHalf, after every
+    // stage that reads its original value has run
+    const int numSteps = numFrames + medianHalf + transitionHalf;
+    for (int step = 0; step < numSteps; ++step)
     {
-        if (values[i] > 0.0f)
+        const int leaving = step - medianSize;
+        if (leaving >= 0)
+            window.erase(cleaned[static_cast<size_t>(leaving % medianSize)]);
+        
+        // Outlier removal, comparing against the uncleaned previous frame
+        if (step < numFrames)
         {
-            window.push_back(values[i]);
+            const float current = f0[static_cast<size_t>(step)];
+            float value = current;
+            if (current > 0.0f && prevOriginal > 0.0f)
+            {
+                const float ratio = current / prevOriginal;
+                if (ratio > maxJumpRatio || ratio < 1.0f / maxJumpRatio)
+                {
+                    const float next = step + 1 < numFrames ? f0[static_cast<size_t>(step + 1)] : 0.0f;
+                    value = next > 0.0f ? (prevOriginal + next) / 2.0f : prevOriginal;
+                }
+            }
+            prevOriginal = current;
+            cleaned[static_cast<size_t>(step % medianSize)] = value;
+            window.insert(value);
+        }
+        
+        // Median of the cleaned window centred on frame step - medianHalf
+        const int medianFrame = step - medianHalf;
+        if (medianFrame >= 0 && medianFrame < numFrames)
+            median[static_cast<size_t>(medianFrame % transitionSize)] =
+                window.empty() ? cleaned[static_cast<size_t>(medianFrame % medianSize)]
+                               : window.median();
+        
+        // Weighted average of voiced median values around the output frame
+        const int frame = medianFrame - transitionHalf;
+        if (frame < 0 || frame >= numFrames)
+            continue;
+        
+        const float centre = median[static_cast<size_t>(frame % transitionSize)];
+        float result = centre;
+        if (hasMask && voicedMask[static_cast<size_t>(frame)] && centre > 0.0f)
+        {
+            float sum = 0.0f;
+            float weightSum = 0.0f;
+            for (int j = -transitionHalf; j <= transitionHalf; ++j)
+            {
+                const int idx = frame + j;
+                if (idx < 0 || idx >= numFrames || !voicedMask[static_cast<size_t>(idx)])
+                    continue;
+                const float value = median[static_cast<size_t>(idx % transitionSize)];
+                if (value > 0.0f)
+                {
+                    const float weight = weights[static_cast<size_t>(j + transitionHalf)];
+                    sum += value * weight;
+                    weightSum += weight;
+                }
+            }
+            if (weightSum > 0.0f)
+                result = sum / weightSum;
         }
+        f0[static_cast<size_t>(frame)] = result;
     }
     
-    if (window.empty())
-        return 0.0f;
-    
-    std::sort(window.begin(), window.end());
-    size_t mid = window.size() / 2;
-    if (window.size() % 2 == 0)
-    {
-        return (window[mid - 1] + window[mid]) / 2.0f;
-    }
-    else
-    {
-        return window[mid];
-    }
+    if (hasMask)
+        interpolateGaps(f0, voicedMask, 5);
 }
 
 bool F0Smoother::isReasonableJump(float f0Prev, float f0Curr, float maxRatio)
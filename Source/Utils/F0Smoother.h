@@ -1,6 +1,7 @@
 #pragma once
 
 #include "../JuceHeader.h"
+#include "VoicedMask.h"
 #include <vector>
 
 /**
@@ -11,7 +12,8 @@ class F0Smoother
 {
 public:
     /**
-     * Apply median filter to F0 values to reduce jitter.
+     * Apply median filter to F0 values to reduce jitter. Only voiced
+     * (positive) values count towards each window's median.
      * @param f0 Input F0 values
      * @param windowSize Median filter window size (should be odd, e.g., 5, 7, 9)
      * @return Smoothed F0 values
@@ -26,7 +28,7 @@ public:
      * @return Smoothed F0 values
      */
     static std::vector<float> smoothTransitions(const std::vector<float>& f0,
-                                                 const std::vector<bool>& voicedMask,
+                                                 const VoicedMask& voicedMask,
                                                  int windowSize = 3);
     
     /**
@@ -38,7 +40,7 @@ public:
      * @return Interpolated F0 values
      */
     static std::vector<float> interpolateUnvoiced(const std::vector<float>& f0,
-                                                    const std::vector<bool>& voicedMask,
+                                                    const VoicedMask& voicedMask,
                                                     int maxGapFrames = 5);
     
     /**
@@ -57,14 +59,19 @@ public:
      * @return Fully smoothed F0 values
      */
     static std::vector<float> smoothF0(const std::vector<float>& f0,
-                                        const std::vector<bool>& voicedMask);
+                                        const VoicedMask& voicedMask);
     
-private:
     /**
-     * Helper: Get median value from a window of F0 values.
+     * smoothF0() applied to f0 in place, without intermediate copies.
+     * Outlier removal, median filter and transition smoothing run fused in a
+     * single pass that keeps only a few frames of state; gap interpolation
+     * takes a second pass.
+     * @param f0 F0 values, replaced with the smoothed result
+     * @param voicedMask Voiced/unvoiced mask
      */
-    static float getMedian(const std::vector<float>& values, int start, int end);
+    static void smoothF0InPlace(std::vector<float>& f0, const VoicedMask& voicedMask);
     
+private:
     /**
      * Helper: Check if F0 jump is reasonable.
      */
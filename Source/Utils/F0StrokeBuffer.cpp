@@ -0,0 +1,46 @@
+#include "F0StrokeBuffer.h"
+#include <algorithm>
+
+void F0StrokeBuffer::begin(int numFrames)
+{
+    clear();
+    if (static_cast<int>(edits.size()) != numFrames)
+        edits.assign(static_cast<size_t>(std::max(0, numFrames)), F0FrameEdit{});
+}
+
+void F0StrokeBuffer::record(const F0FrameEdit& edit)
+{
+    if (edit.idx < 0 || edit.idx >= static_cast<int>(edits.size()))
+        return;
+
+    auto& slot = edits[static_cast<size_t>(edit.idx)];
+    if (slot.idx < 0)
+    {
+        slot = edit;
+        minFrame = std::min(minFrame, edit.idx);
+        maxFrame = std::max(maxFrame, edit.idx);
+        return;
+    }
+    slot.newF0 = edit.newF0;
+    slot.newDelta = edit.newDelta;
+    slot.newVoiced = edit.newVoiced;
+}
+
+std::vector<F0FrameEdit> F0StrokeBuffer::getEdits() const
+{
+    std::vector<F0FrameEdit> result;
+    if (empty())
+        return result;
+
+    result.reserve(static_cast<size_t>(maxFrame - minFrame + 1));
+    forEachEdit([&result](const F0FrameEdit& edit) { result.push_back(edit); });
+    return result;
+}
+
+void F0StrokeBuffer::clear()
+{
+    for (int frame = minFrame; frame <= maxFrame; ++frame)
+        edits[static_cast<size_t>(frame)].idx = -1;
+    minFrame = INT_MAX;
+    maxFrame = INT_MIN;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "F0EditRecord.h"
+#include <climits>
+#include <vector>
+
+/**
+ * Per-frame edits of the hand-drawn stroke in progress, in a dense buffer
+ * indexed by frame.
+ *
+ * The buffer is sized to the curve once and reused by later strokes, so
+ * recording a frame never allocates; finishing a stroke resets only the span
+ * it touched.
+ */
+class F0StrokeBuffer
+{
+public:
+    /** Start a stroke over curves of numFrames frames. */
+    void begin(int numFrames);
+
+    /** Whether frame is recorded in this stroke; frame must be in range. */
+    bool contains(int frame) const { return edits[static_cast<size_t>(frame)].idx >= 0; }
+
+    /**
+     * Record edit.idx's new values. The first record of a frame also keeps
+     * its old values; later ones only replace the new values.
+     */
+    void record(const F0FrameEdit& edit);
+
+    bool empty() const { return minFrame > maxFrame; }
+    /** First and last recorded frame; only meaningful when !empty(). */
+    int getMinFrame() const { return minFrame; }
+    int getMaxFrame() const { return maxFrame; }
+
+    /** The recorded edits in frame order, for the undo record. */
+    std::vector<F0FrameEdit> getEdits() const;
+
+    template <typename Fn>
+    void forEachEdit(Fn&& fn) const
+    {
+        for (int frame = minFrame; frame <= maxFrame; ++frame)
+            if (edits[static_cast<size_t>(frame)].idx >= 0)
+                fn(edits[static_cast<size_t>(frame)]);
+    }
+
+    /** End the stroke, resetting the frames it touched. */
+    void clear();
+
+private:
+    std::vector<F0FrameEdit> edits; // idx < 0 where the stroke has not been
+    int minFrame = INT_MAX;
+    int maxFrame = INT_MIN;
+};
@@ -0,0 +1,90 @@
+#include "GainLane.h"
+#include <algorithm>
+
+GainLane::Ptr GainLane::fromNotes(const std::vector<Note>& notes, int numFrames, int hopSize)
+{
+    if (numFrames <= 0 || hopSize <= 0
+        || std::none_of(notes.begin(), notes.end(), [](const Note& note) { return note.hasGain(); }))
+        return nullptr;
+
+    std::shared_ptr<GainLane> lane(new GainLane());
+    lane->hopSize = hopSize;
+    lane->gains.assign(static_cast<size_t>(numFrames), 1.0f);
+    for (const auto& note : notes)
+    {
+        if (!note.hasGain())
+            continue;
+        const int start = std::max(0, note.getStartFrame());
+        const int end = std::min(numFrames, note.getEndFrame());
+        const float gain = juce::Decibels::decibelsToGain(note.getGainDb(), -100.0f);
+        const int fadeIn = note.getFadeInFrames();
+        const int fadeOut = note.getFadeOutFrames();
+        for (int frame = start; frame < end; ++frame)
+        {
+            // Fades are relative to the whole note, even where it is clipped
+            float fade = 1.0f;
+            if (fadeIn > 0)
+                fade = std::min(fade, static_cast<float>(frame - note.getStartFrame()) / fadeIn);
+            if (fadeOut > 0)
+                fade = std::min(fade, static_cast<float>(note.getEndFrame() - 1 - frame) / fadeOut);
+            lane->gains[static_cast<size_t>(frame)] *= gain * std::max(0.0f, fade);
+        }
+    }
+    return lane;
+}
+
+float GainLane::getGainAt(juce::int64 index) const
+{
+    const juce::int64 frame = index / hopSize;
+    const float position = static_cast<float>(index - frame * hopSize) / hopSize;
+    const float from = frameGain(frame);
+    return from + (frameGain(frame + 1) - from) * position;
+}
+
+void GainLane::apply(float* samples, int numSamples, juce::int64 start) const
+{
+    int done = 0;
+    while (done < numSamples)
+    {
+        const juce::int64 index = start + done;
+        const juce::int64 frame = index / hopSize;
+        const int offset = static_cast<int>(index - frame * hopSize);
+        const int count = std::min(numSamples - done, hopSize - offset);
+        const float from = frameGain(frame);
+        const float to = frameGain(frame + 1);
+        float* out = samples + done;
+        if (from == to)
+        {
+            // Flat stretches (most of a lane) take the vector path
+            if (from != 1.0f)
+                juce::FloatVectorOperations::multiply(out, from, count);
+        }
+        else
+        {
+            const float step = (to - from) / hopSize;
+            const float first = from + step * offset;
+            for (int i = 0; i < count; ++i)
+                out[i] *= first + step * i;
+        }
+        done += count;
+    }
+}
+
+bool GainLane::differ(const GainLane* a, const GainLane* b, juce::int64 start, juce::int64 end)
+{
+    if (a == b || start >= end)
+        return false;
+    const int hop = a != nullptr ? a->hopSize : b->hopSize;
+    if (a != nullptr && b != nullptr && a->hopSize != b->hopSize)
+        return true;
+    // A sample's gain comes from its own frame and the next one
+    const juce::int64 lastFrame = (end - 1) / hop + 1;
+    for (juce::int64 frame = start / hop; frame <= lastFrame; ++frame)
+    {
+        const float gainA = a != nullptr ? a->frameGain(frame) : 1.0f;
+        const float gainB = b != nullptr ? b->frameGain(frame) : 1.0f;
+        if (gainA != gainB)
+            return true;
+    }
+    return false;
+}
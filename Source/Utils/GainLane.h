@@ -0,0 +1,51 @@
+#pragma once
+
+#include "../JuceHeader.h"
+#include "../Models/Note.h"
+#include <memory>
+#include <vector>
+
+/**
+ * Per-frame gain applied to a render after the vocoder: each note's gain
+ * and fades, unity between notes.
+ *
+ * Loudness changes do not touch the vocoder's input, so they never go
+ * through dirty notes and resynthesis. Playback (GainStage) and export
+ * multiply the rendered samples by the lane instead, which costs a
+ * multiply per sample. Between frame starts the gain ramps linearly, so a
+ * step from one note to the next lasts one hop rather than clicking.
+ *
+ * Immutable once built; any thread may read one it holds.
+ */
+class GainLane
+{
+public:
+    using Ptr = std::shared_ptr<const GainLane>;
+
+    /** The notes' lane over numFrames frames of hopSize samples; null when every frame is at unity. */
+    static Ptr fromNotes(const std::vector<Note>& notes, int numFrames, int hopSize);
+
+    /** Multiply samples, the render's samples from start on, by the lane. */
+    void apply(float* samples, int numSamples, juce::int64 start) const;
+
+    /** Gain of sample index of the render. */
+    float getGainAt(juce::int64 index) const;
+
+    /**
+     * True when a and b give some sample of [start, end) a different gain;
+     * a null lane is unity throughout.
+     */
+    static bool differ(const GainLane* a, const GainLane* b, juce::int64 start, juce::int64 end);
+
+private:
+    GainLane() = default;
+
+    // Linear gain at frame frame's first sample; unity past the end
+    float frameGain(juce::int64 frame) const
+    {
+        return frame < static_cast<juce::int64>(gains.size()) ? gains[static_cast<size_t>(frame)] : 1.0f;
+    }
+
+    std::vector<float> gains;
+    int hopSize = 512;
+};
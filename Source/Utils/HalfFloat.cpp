@@ -0,0 +1,109 @@
+#include "HalfFloat.h"
+#include <cstring>
+
+#if defined(__F16C__)
+#include <immintrin.h>
+#endif
+
+namespace
+{
+    uint32_t bitsOf(float value)
+    {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        return bits;
+    }
+
+    float floatOf(uint32_t bits)
+    {
+        float value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+} // namespace
+
+namespace HalfFloat
+{
+    uint16_t fromFloat(float value)
+    {
+        // After F. Giesen's float_to_half_fast3_rtne
+        constexpr uint32_t floatInfinity = 255u << 23;
+        constexpr uint32_t halfOverflow = (127u + 16u) << 23;
+        constexpr uint32_t smallestNormal = 113u << 23;
+        constexpr uint32_t denormMagic = ((127u - 15u) + (23u - 10u) + 1u) << 23;
+
+        uint32_t bits = bitsOf(value);
+        const uint32_t sign = bits & 0x80000000u;
+        bits ^= sign;
+
+        uint32_t half;
+        if (bits >= halfOverflow)
+        {
+            half = bits > floatInfinity ? 0x7e00u : 0x7c00u; // NaN stays NaN
+        }
+        else if (bits < smallestNormal)
+        {
+            // Subnormal or zero: the float adder does the rounding
+            half = bitsOf(floatOf(bits) + floatOf(denormMagic)) - denormMagic;
+        }
+        else
+        {
+            const uint32_t mantissaOdd = (bits >> 13) & 1u;
+            bits += ((15u - 127u) << 23) + 0xfffu + mantissaOdd;
+            half = bits >> 13;
+        }
+        return static_cast<uint16_t>(half | (sign >> 16));
+    }
+
+    float toFloat(uint16_t half)
+    {
+        constexpr uint32_t shiftedExponent = 0x7c00u << 13;
+        constexpr uint32_t magic = 113u << 23;
+
+        uint32_t bits = (static_cast<uint32_t>(half) & 0x7fffu) << 13;
+        const uint32_t exponent = bits & shiftedExponent;
+        bits += (127u - 15u) << 23;
+        if (exponent == shiftedExponent)
+            bits += (128u - 16u) << 23; // Infinity or NaN
+        else if (exponent == 0)
+            bits = bitsOf(floatOf(bits + (1u << 23)) - floatOf(magic)); // Subnormal
+        return floatOf(bits | ((static_cast<uint32_t>(half) & 0x8000u) << 16));
+    }
+
+    void fromFloat(const float* source, uint16_t* dest, size_t count)
+    {
+        size_t i = 0;
+#if defined(__F16C__)
+        for (; i + 8 <= count; i += 8)
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i),
+                             _mm256_cvtps_ph(_mm256_loadu_ps(source + i), _MM_FROUND_TO_NEAREST_INT));
+#elif defined(__ARM_FP16_FORMAT_IEEE)
+        for (; i < count; ++i)
+        {
+            const __fp16 half = static_cast<__fp16>(source[i]);
+            std::memcpy(dest + i, &half, sizeof(half));
+        }
+#endif
+        for (; i < count; ++i)
+            dest[i] = fromFloat(source[i]);
+    }
+
+    void toFloat(const uint16_t* source, float* dest, size_t count)
+    {
+        size_t i = 0;
+#if defined(__F16C__)
+        for (; i + 8 <= count; i += 8)
+            _mm256_storeu_ps(dest + i, _mm256_cvtph_ps(
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i))));
+#elif defined(__ARM_FP16_FORMAT_IEEE)
+        for (; i < count; ++i)
+        {
+            __fp16 half;
+            std::memcpy(&half, source + i, sizeof(half));
+            dest[i] = static_cast<float>(half);
+        }
+#endif
+        for (; i < count; ++i)
+            dest[i] = toFloat(source[i]);
+    }
+} // namespace HalfFloat
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * IEEE 754 binary16 conversion for compact storage of float data.
+ *
+ * Half floats keep 11 significant bits (about 0.05% relative error) over
+ * ±65504, enough for log-mel values and pitch in Hz. The array versions
+ * use the CPU's conversion instructions where the build enables them (F16C
+ * on x86, the fp16 storage type on ARM) and a bit-exact portable loop
+ * elsewhere; all round to nearest even.
+ */
+namespace HalfFloat
+{
+    uint16_t fromFloat(float value);
+    float toFloat(uint16_t half);
+
+    void fromFloat(const float* source, uint16_t* dest, size_t count);
+    void toFloat(const uint16_t* source, float* dest, size_t count);
+} // namespace HalfFloat
@@ -0,0 +1,447 @@
+#include "JobSystem.h"
+#include "AppLogger.h"
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <iterator>
+#include <optional>
+#include <utility>
+
+#if JUCE_WINDOWS
+#include <windows.h>
+#elif JUCE_MAC || JUCE_IOS
+#include <pthread.h>
+#endif
+
+namespace {
+// Index of the pool worker running on this thread, or -1
+thread_local int currentWorker = -1;
+// Whether setCurrentThreadBackground(true) is in effect on this thread
+thread_local bool threadInBackground = false;
+
+// How long a helping waiter sleeps when there is nothing to run
+constexpr auto helpInterval = std::chrono::milliseconds(1);
+} // namespace
+
+template <typename Predicate>
+void JobSystem::helpUntil(std::mutex &mutex,
+                          std::condition_variable &condition,
+                          const Scope &scope, Predicate isFinished) {
+  auto &system = getInstance();
+  system.beginWait();
+  const struct EndWait {
+    JobSystem &system;
+    ~EndWait() { system.endWait(); }
+  } endWait{system};
+
+  if (!isWorkerThread()) {
+    std::unique_lock<std::mutex> lock(mutex);
+    condition.wait(lock, isFinished);
+    return;
+  }
+  // On a worker, run the awaited jobs meanwhile: they may be queued behind
+  // every busy worker
+  for (;;) {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (isFinished())
+        return;
+    }
+    if (system.runOne(static_cast<size_t>(currentWorker), scope))
+      continue;
+    std::unique_lock<std::mutex> lock(mutex);
+    condition.wait_for(lock, helpInterval, isFinished);
+  }
+}
+
+struct JobSystem::JobHandle::State {
+  std::mutex mutex;
+  std::condition_variable finished;
+  bool done = false;
+  std::exception_ptr error; // Set before done
+};
+
+JobSystem::CancellationToken::CancellationToken()
+    : flag(std::make_shared<std::atomic<bool>>(false)) {}
+
+bool JobSystem::JobHandle::isDone() const {
+  if (!state)
+    return true;
+  std::lock_guard<std::mutex> lock(state->mutex);
+  return state->done;
+}
+
+void JobSystem::JobHandle::wait() const {
+  if (state)
+    helpUntil(state->mutex, state->finished, {state.get(), nullptr},
+              [this]() { return state->done; });
+}
+
+void JobSystem::JobHandle::rethrowIfFailed() const {
+  if (!state)
+    return;
+  std::exception_ptr error;
+  {
+    std::lock_guard<std::mutex> lock(state->mutex);
+    error = state->error;
+  }
+  if (error)
+    std::rethrow_exception(error);
+}
+
+bool JobSystem::JobHandle::waitFor(int milliseconds) const {
+  if (!state)
+    return true;
+  auto &system = getInstance();
+  system.beginWait();
+  const struct EndWait {
+    JobSystem &system;
+    ~EndWait() { system.endWait(); }
+  } endWait{system};
+
+  const auto deadline = std::chrono::steady_clock::now() +
+                        std::chrono::milliseconds(milliseconds);
+  while (!isDone()) {
+    if (std::chrono::steady_clock::now() >= deadline)
+      return false;
+    if (isWorkerThread() && system.runOne(static_cast<size_t>(currentWorker),
+                                          {state.get(), nullptr}))
+      continue;
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->finished.wait_until(
+        lock, std::min(deadline, std::chrono::steady_clock::now() + helpInterval),
+        [this]() { return state->done; });
+  }
+  return true;
+}
+
+JobSystem::JobHandle JobSystem::Group::submit(Priority priority, Job job,
+                                              CancellationToken token,
+                                              Continuation onMessageThread) {
+  outstanding->count.fetch_add(1);
+  return getInstance().enqueue(priority, {priority, std::move(job),
+                                          std::move(token),
+                                          std::move(onMessageThread), nullptr,
+                                          outstanding});
+}
+
+void JobSystem::Group::wait() {
+  auto &counter = *outstanding;
+  helpUntil(counter.mutex, counter.idle, {nullptr, &counter},
+            [&counter]() { return counter.count.load() == 0; });
+}
+
+void JobSystem::Serial::submit(Job job) {
+  bool startDrain = false;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    pending.push_back(std::move(job));
+    startDrain = !std::exchange(draining, true);
+  }
+  if (startDrain)
+    group.submit(priority, [this]() { drain(); });
+}
+
+void JobSystem::Serial::drain() {
+  for (;;) {
+    Job job;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (pending.empty()) {
+        draining = false;
+        return;
+      }
+      job = std::move(pending.front());
+      pending.pop_front();
+    }
+    // One failing job must not stall the ones queued behind it
+    try {
+      job();
+    } catch (const std::exception &e) {
+      LOG_ERROR("Serial job failed: " + juce::String(e.what()));
+    } catch (...) {
+      LOG_ERROR("Serial job failed");
+    }
+  }
+}
+
+JobSystem &JobSystem::getInstance() {
+  static JobSystem instance;
+  return instance;
+}
+
+JobSystem::JobSystem()
+    : numWorkers(std::max(4, static_cast<int>(std::thread::hardware_concurrency()))) {}
+
+JobSystem::~JobSystem() {
+  std::lock_guard<std::mutex> lock(lifecycleMutex);
+  stop();
+}
+
+void JobSystem::init() {
+  auto &system = getInstance();
+  std::lock_guard<std::mutex> lock(system.lifecycleMutex);
+  ++system.numUsers;
+}
+
+void JobSystem::shutdown() {
+  auto &system = getInstance();
+  std::lock_guard<std::mutex> lock(system.lifecycleMutex);
+  if (system.numUsers > 0 && --system.numUsers == 0)
+    system.stop();
+}
+
+bool JobSystem::isWorkerThread() { return currentWorker >= 0; }
+
+JobSystem::Pause::Pause() {
+  auto &system = getInstance();
+  std::lock_guard<std::mutex> lock(system.sleepMutex);
+  ++system.numPauses;
+  system.updateHold();
+}
+
+JobSystem::Pause::~Pause() {
+  auto &system = getInstance();
+  std::lock_guard<std::mutex> lock(system.sleepMutex);
+  --system.numPauses;
+  system.updateHold();
+}
+
+JobSystem::View::View() {
+  auto &system = getInstance();
+  std::lock_guard<std::mutex> lock(system.sleepMutex);
+  ++system.numViews;
+  system.updateHold();
+}
+
+JobSystem::View::~View() {
+  auto &system = getInstance();
+  std::lock_guard<std::mutex> lock(system.sleepMutex);
+  --system.numViews;
+  if (active)
+    --system.numActiveViews;
+  system.updateHold();
+}
+
+void JobSystem::View::setActive(bool isActive) {
+  if (active == isActive)
+    return;
+  active = isActive;
+  auto &system = getInstance();
+  std::lock_guard<std::mutex> lock(system.sleepMutex);
+  system.numActiveViews += active ? 1 : -1;
+  system.updateHold();
+}
+
+void JobSystem::updateHold() {
+  // Stopping drains every queue, held or not
+  const bool hold = !stopping && (numPauses > 0 ||
+                                  (numViews > 0 && numActiveViews == 0));
+  if (holdRequested.exchange(hold) && !hold)
+    wake.notify_all();
+}
+
+bool JobSystem::hasRunnableJobs() const {
+  const int runnable =
+      queued.load() - (isBackgroundHeld() ? queuedBackground.load() : 0);
+  return runnable > 0;
+}
+
+void JobSystem::beginWait() {
+  if (waiters.fetch_add(1) == 0 && holdRequested.load()) {
+    std::lock_guard<std::mutex> lock(sleepMutex);
+    wake.notify_all();
+  }
+}
+
+void JobSystem::endWait() { waiters.fetch_sub(1); }
+
+void JobSystem::setCurrentThreadBackground(bool background) {
+  threadInBackground = background;
+#if JUCE_WINDOWS
+  SetThreadPriority(GetCurrentThread(), background
+                                            ? THREAD_PRIORITY_BELOW_NORMAL
+                                            : THREAD_PRIORITY_NORMAL);
+#elif JUCE_MAC || JUCE_IOS
+  pthread_set_qos_class_self_np(
+      background ? QOS_CLASS_UTILITY : QOS_CLASS_USER_INITIATED, 0);
+#endif
+}
+
+JobSystem::JobHandle JobSystem::submit(Priority priority, Job job,
+                                       CancellationToken token,
+                                       Continuation onMessageThread) {
+  return enqueue(priority, {priority, std::move(job), std::move(token),
+                            std::move(onMessageThread), nullptr, nullptr});
+}
+
+JobSystem::JobHandle JobSystem::enqueue(Priority priority, Task task) {
+  task.state = std::make_shared<JobHandle::State>();
+  JobHandle handle(task.state);
+  const auto p = static_cast<size_t>(priority);
+
+  if (isWorkerThread()) {
+    // The pool is running while any of its jobs is
+    auto &worker = *workers[static_cast<size_t>(currentWorker)];
+    std::lock_guard<std::mutex> lock(worker.mutex);
+    worker.queues[p].push_back(std::move(task));
+    if (priority == Priority::Background)
+      queuedBackground.fetch_add(1);
+    queued.fetch_add(1);
+  } else {
+    std::lock_guard<std::mutex> lifecycle(lifecycleMutex);
+    if (!running.load())
+      start();
+    std::lock_guard<std::mutex> lock(sharedMutex);
+    shared[p].push_back(std::move(task));
+    if (priority == Priority::Background)
+      queuedBackground.fetch_add(1);
+    queued.fetch_add(1);
+  }
+
+  // Held jobs wake nobody; the hold lifting wakes every worker
+  if (priority == Priority::Background && isBackgroundHeld())
+    return handle;
+  { std::lock_guard<std::mutex> lock(sleepMutex); }
+  wake.notify_one();
+  return handle;
+}
+
+// Caller holds lifecycleMutex
+void JobSystem::start() {
+  {
+    std::lock_guard<std::mutex> lock(sleepMutex);
+    stopping = false;
+    updateHold();
+  }
+  // Every worker exists before any thread looks for work to steal
+  for (int i = 0; i < numWorkers; ++i)
+    workers.push_back(std::make_unique<Worker>());
+  for (size_t i = 0; i < workers.size(); ++i)
+    workers[i]->thread = std::thread([this, i]() { workerLoop(i); });
+  running = true;
+}
+
+// Caller holds lifecycleMutex
+void JobSystem::stop() {
+  if (!running.load())
+    return;
+  {
+    std::lock_guard<std::mutex> lock(sleepMutex);
+    stopping = true;
+    updateHold();
+  }
+  wake.notify_all();
+  // Workers leave once nothing is queued; outside submissions wait on
+  // lifecycleMutex, and a running job's submissions keep its worker going
+  for (auto &worker : workers)
+    if (worker->thread.joinable())
+      worker->thread.join();
+  workers.clear();
+  running = false;
+}
+
+void JobSystem::workerLoop(size_t index) {
+  currentWorker = static_cast<int>(index);
+  juce::Thread::setCurrentThreadName("HachiTune Job " +
+                                     juce::String(static_cast<int>(index)));
+  for (;;) {
+    if (runOne(index))
+      continue;
+    std::unique_lock<std::mutex> lock(sleepMutex);
+    wake.wait(lock, [this]() { return stopping || hasRunnableJobs(); });
+    if (stopping && queued.load() == 0)
+      return;
+  }
+}
+
+bool JobSystem::runOne(size_t self, const Scope &scope) {
+  auto take = [&scope](std::mutex &mutex, std::deque<Task> &queue,
+                       bool newest) -> std::optional<Task> {
+    auto inScope = [&scope](const Task &task) { return scope.contains(task); };
+    std::lock_guard<std::mutex> lock(mutex);
+    if (newest) {
+      const auto it = std::find_if(queue.rbegin(), queue.rend(), inScope);
+      if (it == queue.rend())
+        return std::nullopt;
+      std::optional<Task> task(std::move(*it));
+      queue.erase(std::next(it).base());
+      return task;
+    }
+    const auto it = std::find_if(queue.begin(), queue.end(), inScope);
+    if (it == queue.end())
+      return std::nullopt;
+    std::optional<Task> task(std::move(*it));
+    queue.erase(it);
+    return task;
+  };
+
+  const size_t numQueues = workers.size();
+  constexpr auto background = static_cast<size_t>(Priority::Background);
+  for (size_t p = 0; p < shared.size(); ++p) {
+    if (p == background && isBackgroundHeld())
+      break;
+    std::optional<Task> task;
+    if (self < numQueues)
+      task = take(workers[self]->mutex, workers[self]->queues[p], false);
+    if (!task)
+      task = take(sharedMutex, shared[p], false);
+    // Steal the newest job of another worker; its owner works oldest first
+    for (size_t i = 1; !task && i < numQueues; ++i) {
+      auto &victim = *workers[(self + i) % numQueues];
+      task = take(victim.mutex, victim.queues[p], true);
+    }
+
+    if (task) {
+      if (p == background)
+        queuedBackground.fetch_sub(1);
+      queued.fetch_sub(1);
+      run(*task);
+      return true;
+    }
+  }
+  return false;
+}
+
+void JobSystem::run(Task &task) {
+  std::exception_ptr error;
+  if (!task.token.isCancelled()) {
+    // Jobs run while another waits restore the waiting job's class after
+    const bool background =
+        task.priority == Priority::Background ||
+        (task.priority == Priority::Normal && normalJobsInBackground.load());
+    const bool wasBackground = threadInBackground;
+    if (background != wasBackground)
+      setCurrentThreadBackground(background);
+    // A throwing job must not take the worker down; whoever waits on its
+    // result gets the exception instead of its continuation running
+    try {
+      task.job();
+    } catch (const std::exception &e) {
+      error = std::current_exception();
+      LOG_ERROR("Job failed: " + juce::String(e.what()));
+    } catch (...) {
+      error = std::current_exception();
+      LOG_ERROR("Job failed");
+    }
+    if (background != wasBackground)
+      setCurrentThreadBackground(wasBackground);
+    if (!error && task.onMessageThread && !task.token.isCancelled())
+      juce::MessageManager::callAsync(std::move(task.onMessageThread));
+  }
+  // Let go of captures before anyone waiting sees the job finish
+  task.job = nullptr;
+  task.onMessageThread = nullptr;
+
+  {
+    std::lock_guard<std::mutex> lock(task.state->mutex);
+    task.state->error = std::move(error);
+    task.state->done = true;
+  }
+  task.state->finished.notify_all();
+
+  if (task.group && task.group->count.fetch_sub(1) == 1) {
+    { std::lock_guard<std::mutex> lock(task.group->mutex); }
+    task.group->idle.notify_all();
+  }
+}
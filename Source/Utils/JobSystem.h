@@ -0,0 +1,340 @@
+#pragma once
+
+#include "../JuceHeader.h"
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Process-wide work-stealing thread pool that background work runs on.
+ *
+ * Each worker keeps a deque per priority class. Jobs submitted from a worker
+ * go to its own deques and other threads' jobs to a shared queue. An idle
+ * worker picks the most urgent job it can find: its own first, then the
+ * shared queue, then stolen from another worker. The worker count is fixed,
+ * so however many subsystems are busy the process runs at most
+ * getNumWorkers() background jobs at once.
+ *
+ * Jobs may block (model inference, file I/O). Waiting on a JobHandle or
+ * Group from a worker runs the job, or the group's jobs, meanwhile if they
+ * are still queued, so a job may wait for jobs it submitted. It never runs
+ * unrelated jobs, which could take locks the waiter holds. Don't wait while
+ * holding a lock the awaited jobs could take.
+ *
+ * An exception escaping a job is caught and logged; a job submitted with
+ * submitWithResult() rethrows it from Future::get().
+ *
+ * Workers start on first use. init() and shutdown() bracket a user that must
+ * not outlive them, such as a plugin instance, as with AppLogger; they stop
+ * once the last user shuts down and queued jobs have run.
+ *
+ * Background jobs run at a lower OS priority, and are held in their queues
+ * while a Pause exists or while every registered View is inactive (see
+ * View). A thread waiting on a job or group lets them run, since the job it
+ * waits for may be one of them.
+ */
+class JobSystem {
+public:
+  enum class Priority {
+    Interactive, // Results the user is waiting on right now (edit previews)
+    Normal,      // Loads, analysis and renders of what is shown
+    Background,  // Speculative or hidden work
+    numPriorities
+  };
+
+  using Job = std::function<void()>;
+  using Continuation = std::function<void()>;
+
+  /**
+   * Shared cancellation flag. Jobs poll it; a job whose token is cancelled
+   * before it starts is skipped along with its continuation. Copies share
+   * the flag.
+   */
+  class CancellationToken {
+  public:
+    CancellationToken();
+
+    void cancel() const { flag->store(true); }
+    bool isCancelled() const { return flag->load(); }
+
+    // For APIs that take a plain cancel flag
+    const std::atomic<bool> *get() const { return flag.get(); }
+
+  private:
+    std::shared_ptr<std::atomic<bool>> flag;
+  };
+
+  /** Done-state of one submitted job. Default-constructed handles are done. */
+  class JobHandle {
+  public:
+    JobHandle() = default;
+
+    bool isDone() const;
+    void wait() const;
+
+    /** Wait up to milliseconds; true once the job has finished. */
+    bool waitFor(int milliseconds) const;
+
+    /** Rethrow what escaped the finished job, if anything did. */
+    void rethrowIfFailed() const;
+
+  private:
+    friend class JobSystem;
+    struct State;
+    explicit JobHandle(std::shared_ptr<State> jobState)
+        : state(std::move(jobState)) {}
+
+    std::shared_ptr<State> state;
+  };
+
+  /** Result of a job submitted with submitWithResult(). */
+  template <typename Result> class Future {
+  public:
+    bool isDone() const { return job.isDone(); }
+    bool waitFor(int milliseconds) const { return job.waitFor(milliseconds); }
+
+    /**
+     * Wait for the job and take its result; call once. Rethrows an
+     * exception the job threw.
+     */
+    Result get() {
+      job.wait();
+      job.rethrowIfFailed();
+      return std::move(*value);
+    }
+
+  private:
+    friend class JobSystem;
+    JobHandle job;
+    std::shared_ptr<Result> value = std::make_shared<Result>();
+  };
+
+  /**
+   * Jobs of one owner. wait() (and the destructor) returns once every job
+   * submitted through the group has finished, which is what an owner needs
+   * before the state its jobs use goes away.
+   */
+  class Group {
+  public:
+    Group() = default;
+    ~Group() { wait(); }
+
+    JobHandle submit(Priority priority, Job job, CancellationToken token = {},
+                     Continuation onMessageThread = nullptr);
+    void wait();
+    bool isIdle() const { return outstanding->count.load() == 0; }
+
+  private:
+    friend class JobSystem;
+    struct Counter {
+      std::atomic<int> count{0};
+      std::mutex mutex;
+      std::condition_variable idle;
+    };
+    std::shared_ptr<Counter> outstanding = std::make_shared<Counter>();
+
+    JUCE_DECLARE_NON_COPYABLE(Group)
+  };
+
+  /**
+   * Jobs that run one at a time in submission order, on the pool. Stands in
+   * for a dedicated worker thread without holding one while idle.
+   */
+  class Serial {
+  public:
+    explicit Serial(Priority jobPriority = Priority::Normal)
+        : priority(jobPriority) {}
+    ~Serial() { wait(); }
+
+    void submit(Job job);
+    void wait() { group.wait(); }
+    bool isIdle() const { return group.isIdle(); }
+
+  private:
+    void drain();
+
+    const Priority priority;
+    std::mutex mutex;
+    std::deque<Job> pending;
+    bool draining = false;
+    Group group;
+
+    JUCE_DECLARE_NON_COPYABLE(Serial)
+  };
+
+  /**
+   * Holds Background jobs for as long as it exists, e.g. while the host
+   * renders offline. Jobs already running finish.
+   */
+  class Pause {
+  public:
+    Pause();
+    ~Pause();
+
+    JUCE_DECLARE_NON_COPYABLE(Pause)
+  };
+
+  /**
+   * A UI whose activity gates Background jobs: while any View exists and
+   * none is active (shown, with its application in front), they are held.
+   * Processes without a UI, such as the batch renderer, register none and
+   * are never held this way. Starts inactive.
+   */
+  class View {
+  public:
+    View();
+    ~View();
+
+    void setActive(bool isActive);
+    bool isActive() const { return active; }
+
+  private:
+    bool active = false;
+
+    JUCE_DECLARE_NON_COPYABLE(View)
+  };
+
+  static JobSystem &getInstance();
+
+  static void init();
+  static void shutdown();
+
+  /**
+   * Queue job. When it finishes without its token being cancelled,
+   * onMessageThread (if any) is posted to the message thread.
+   */
+  JobHandle submit(Priority priority, Job job, CancellationToken token = {},
+                   Continuation onMessageThread = nullptr);
+
+  /** Queue work that returns a value, such as one stage of an analysis. */
+  template <typename Work>
+  auto submitWithResult(Priority priority, Work work)
+      -> Future<decltype(work())> {
+    Future<decltype(work())> future;
+    future.job = submit(priority, [value = future.value, work]() mutable {
+      *value = work();
+    });
+    return future;
+  }
+
+  int getNumWorkers() const { return numWorkers; }
+  static bool isWorkerThread();
+
+  /** Whether queued Background jobs are being held right now. */
+  bool isBackgroundHeld() const {
+    return holdRequested.load() && waiters.load() == 0;
+  }
+
+  /**
+   * Move the calling thread to the OS class for background work (below
+   * normal on Windows, utility QoS on Apple platforms) or back. Workers do
+   * this around each Background job; dedicated threads doing hidden work
+   * can call it once. Elsewhere a no-op: an unprivileged Linux thread that
+   * raised its nice value cannot lower it again.
+   */
+  static void setCurrentThreadBackground(bool background);
+
+  /**
+   * Run Normal jobs in the background OS class too, leaving the normal
+   * class to Interactive ones; for hosts whose audio thread loses out to
+   * busy workers. Process-wide, off by default.
+   */
+  void setNormalJobsInBackground(bool enabled) {
+    normalJobsInBackground = enabled;
+  }
+
+  ~JobSystem();
+
+private:
+  JobSystem();
+
+  struct Task {
+    Priority priority = Priority::Normal;
+    Job job;
+    CancellationToken token;
+    Continuation onMessageThread;
+    std::shared_ptr<JobHandle::State> state;
+    std::shared_ptr<Group::Counter> group;
+  };
+  using Queues =
+      std::array<std::deque<Task>, static_cast<size_t>(Priority::numPriorities)>;
+
+  // Jobs a waiting worker may run meanwhile: the job it waits on, or the
+  // jobs of its group. Empty: any job, for a worker looking for work.
+  struct Scope {
+    const JobHandle::State *job = nullptr;
+    const Group::Counter *group = nullptr;
+
+    bool contains(const Task &task) const {
+      if (job == nullptr && group == nullptr)
+        return true;
+      return task.state.get() == job ||
+             (group != nullptr && task.group.get() == group);
+    }
+  };
+
+  struct Worker {
+    std::mutex mutex;
+    Queues queues;
+    std::thread thread;
+  };
+
+  JobHandle enqueue(Priority priority, Task task);
+  void start();
+  void stop();
+  void workerLoop(size_t index);
+
+  // Take the most urgent job in scope visible from worker `self` and run
+  // it. False when none is queued.
+  bool runOne(size_t self, const Scope &scope = {});
+  static void run(Task &task);
+
+  // Block until isFinished(), checked under mutex; workers run the queued
+  // jobs in scope meanwhile
+  template <typename Predicate>
+  static void helpUntil(std::mutex &mutex, std::condition_variable &condition,
+                        const Scope &scope, Predicate isFinished);
+
+  // A thread starts or stops waiting on a job; held jobs run while any waits
+  void beginWait();
+  void endWait();
+
+  // Recompute holdRequested and wake workers when it drops. Caller holds
+  // sleepMutex.
+  void updateHold();
+  // Jobs a worker could take now. Caller holds sleepMutex.
+  bool hasRunnableJobs() const;
+
+  const int numWorkers;
+  std::vector<std::unique_ptr<Worker>> workers;
+
+  std::mutex sharedMutex;
+  Queues shared;
+
+  std::atomic<int> queued{0};
+  std::atomic<int> queuedBackground{0};
+  std::mutex sleepMutex;
+  std::condition_variable wake;
+  bool stopping = false; // Guarded by sleepMutex
+
+  // Background hold state; counts guarded by sleepMutex
+  int numPauses = 0;
+  int numViews = 0;
+  int numActiveViews = 0;
+  std::atomic<bool> holdRequested{false};
+  std::atomic<bool> normalJobsInBackground{false};
+  std::atomic<int> waiters{0};
+
+  std::mutex lifecycleMutex;
+  std::atomic<bool> running{false};
+  int numUsers = 0;
+
+  JUCE_DECLARE_NON_COPYABLE(JobSystem)
+};
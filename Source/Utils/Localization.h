@@ -18,10 +18,10 @@ public:
   };
 
   void setLanguage(const juce::String &langCode) {
-    if (languages.count(langCode)) {
-      currentLang = langCode;
+    if (langCode == currentLang && !strings.empty())
+      return;
+    if (findLanguageFile(langCode).existsAsFile())
       loadLanguageFile(langCode);
-    }
   }
 
   juce::String getLanguage() const { return currentLang; }
@@ -33,7 +33,10 @@ public:
     return key;
   }
 
-  const std::vector<LangInfo> &getAvailableLanguages() const {
+  // Parses every language file for its name, so only the settings page asks
+  const std::vector<LangInfo> &getAvailableLanguages() {
+    if (!scanned)
+      scanAvailableLanguages();
     return availableLanguages;
   }
 
@@ -92,6 +95,7 @@ public:
   }
 
   void scanAvailableLanguages() {
+    scanned = true;
     availableLanguages.clear();
     std::vector<juce::String> knownCodes = {"en", "zh", "zh-TW", "ja"};
 
@@ -109,17 +113,13 @@ public:
         }
 
         availableLanguages.push_back({code, nativeName});
-        languages[code] = nativeName;
       }
     }
   }
 
 private:
-  Localization() {
-    scanAvailableLanguages();
-    if (!availableLanguages.empty())
-      loadLanguageFile(availableLanguages[0].code);
-  }
+  // English until a language is chosen; the rest are scanned on demand
+  Localization() { loadLanguageFile("en"); }
 
   void loadLanguageFile(const juce::String &langCode) {
     strings.clear();
@@ -169,8 +169,8 @@ private:
 
   juce::String currentLang = "en";
   std::map<juce::String, juce::String> strings;
-  std::map<juce::String, juce::String> languages;
   std::vector<LangInfo> availableLanguages;
+  bool scanned = false;
 
   JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(Localization)
 };
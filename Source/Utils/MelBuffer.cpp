@@ -0,0 +1,46 @@
+#include "MelBuffer.h"
+#include "HalfFloat.h"
+#include "ScratchMapping.h"
+
+bool MelBuffer::pageOut()
+{
+    if (pagedValues != nullptr || values.empty())
+        return false;
+
+    auto mapping = ScratchMapping::create(values.size() * sizeof(float));
+    if (mapping == nullptr)
+        return false;
+
+    auto* target = static_cast<float*>(mapping->getData());
+    std::copy(values.begin(), values.end(), target);
+    std::vector<float>().swap(values);
+    pages = std::move(mapping);
+    pagedValues = target;
+    return true;
+}
+
+void MelBuffer::pageIn()
+{
+    if (pagedValues == nullptr)
+        return;
+
+    values.assign(pagedValues, pagedValues + frames * static_cast<size_t>(mels));
+    dropPages();
+}
+
+HalfMelBuffer::HalfMelBuffer(const MelView& source)
+    : values(source.size() * static_cast<size_t>(source.getNumMels())),
+      frames(source.size()), mels(source.getNumMels())
+{
+    HalfFloat::fromFloat(source.data(), values.data(), values.size());
+}
+
+MelBuffer HalfMelBuffer::decode(size_t start, size_t end) const
+{
+    start = std::min(start, frames);
+    end = std::clamp(end, start, frames);
+    MelBuffer result(end - start, mels);
+    HalfFloat::toFloat(values.data() + start * static_cast<size_t>(mels), result.data(),
+                       (end - start) * static_cast<size_t>(mels));
+    return result;
+}
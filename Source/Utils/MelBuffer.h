@@ -0,0 +1,211 @@
+#pragma once
+
+#include "Constants.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+class ScratchMapping;
+
+/**
+ * Read-only view over a contiguous, frame-major mel range [frames, numMels].
+ * Does not own its data; it stays valid while the source buffer is alive and
+ * not resized.
+ */
+class MelView
+{
+public:
+    MelView() = default;
+    MelView(const float* data, size_t numFrames, int numMels)
+        : ptr(data), frames(numFrames), mels(numMels) {}
+
+    size_t size() const { return frames; }
+    bool empty() const { return frames == 0; }
+    int getNumMels() const { return mels; }
+    const float* data() const { return ptr; }
+
+    // Pointer to the numMels values of one frame
+    const float* operator[](size_t frame) const { return ptr + frame * static_cast<size_t>(mels); }
+
+    // Sub-range [start, end), clamped to this view
+    MelView slice(size_t start, size_t end) const
+    {
+        start = std::min(start, frames);
+        end = std::clamp(end, start, frames);
+        return MelView(ptr + start * static_cast<size_t>(mels), end - start, mels);
+    }
+
+private:
+    const float* ptr = nullptr;
+    size_t frames = 0;
+    int mels = NUM_MELS;
+};
+
+/**
+ * Owning mel spectrogram stored as one contiguous frame-major block.
+ * Indexing a frame returns a pointer, so mel[t][m] works as with nested
+ * vectors, but there is no per-frame allocation.
+ *
+ * pageOut() moves the frames to a scratch file mapping for very long
+ * recordings. A paged buffer reads and writes in place; changing its size
+ * brings it back into memory first, and copies are always in memory.
+ */
+class MelBuffer
+{
+public:
+    MelBuffer() = default;
+    MelBuffer(size_t numFrames, int numMels, float fill = 0.0f)
+        : values(numFrames * static_cast<size_t>(numMels), fill),
+          frames(numFrames), mels(numMels) {}
+    explicit MelBuffer(const MelView& source)
+        : values(source.data(), source.data() + source.size() * static_cast<size_t>(source.getNumMels())),
+          frames(source.size()), mels(source.getNumMels()) {}
+
+    MelBuffer(const MelBuffer& other) : MelBuffer(other.view()) {}
+    MelBuffer(MelBuffer&& other) noexcept
+        : values(std::move(other.values)), pages(std::move(other.pages)),
+          pagedValues(std::exchange(other.pagedValues, nullptr)),
+          frames(std::exchange(other.frames, 0)), mels(other.mels) {}
+    MelBuffer& operator=(const MelBuffer& other)
+    {
+        if (this != &other)
+            *this = MelBuffer(other);
+        return *this;
+    }
+    MelBuffer& operator=(MelBuffer&& other) noexcept
+    {
+        values = std::move(other.values);
+        pages = std::move(other.pages);
+        pagedValues = std::exchange(other.pagedValues, nullptr);
+        frames = std::exchange(other.frames, 0);
+        mels = other.mels;
+        return *this;
+    }
+
+    size_t size() const { return frames; }
+    bool empty() const { return frames == 0; }
+    int getNumMels() const { return mels; }
+    // Bytes in memory; a paged buffer holds none
+    size_t getNumBytes() const { return values.size() * sizeof(float); }
+    size_t getPagedBytes() const { return pagedValues ? frames * static_cast<size_t>(mels) * sizeof(float) : 0; }
+    bool isPaged() const { return pagedValues != nullptr; }
+
+    float* data() { return pagedValues ? pagedValues : values.data(); }
+    const float* data() const { return pagedValues ? pagedValues : values.data(); }
+
+    float* operator[](size_t frame) { return data() + frame * static_cast<size_t>(mels); }
+    const float* operator[](size_t frame) const { return data() + frame * static_cast<size_t>(mels); }
+
+    MelView view() const { return MelView(data(), frames, mels); }
+    MelView view(size_t start, size_t end) const { return view().slice(start, end); }
+    operator MelView() const { return view(); }
+
+    /** Discard contents and reshape to [numFrames, numMels]. */
+    void reset(size_t numFrames, int numMels, float fill = 0.0f)
+    {
+        dropPages();
+        mels = numMels;
+        frames = numFrames;
+        values.assign(numFrames * static_cast<size_t>(numMels), fill);
+    }
+
+    /** Change the frame count, keeping existing frames. */
+    void resize(size_t numFrames, float fill = 0.0f)
+    {
+        pageIn();
+        frames = numFrames;
+        values.resize(numFrames * static_cast<size_t>(mels), fill);
+    }
+
+    void reserve(size_t numFrames)
+    {
+        pageIn();
+        values.reserve(numFrames * static_cast<size_t>(mels));
+    }
+
+    void clear()
+    {
+        dropPages();
+        values.clear();
+        frames = 0;
+    }
+
+    /** Append frames; an empty buffer adopts the source's mel count. */
+    void append(const MelView& source)
+    {
+        if (source.empty())
+            return;
+        if (frames == 0)
+            mels = source.getNumMels();
+        if (source.getNumMels() != mels)
+            return;
+        pageIn();
+        values.insert(values.end(), source.data(),
+                      source.data() + source.size() * static_cast<size_t>(mels));
+        frames += source.size();
+    }
+
+    /**
+     * Overwrite frames starting at dstFrame with the source frames.
+     * Frames that would fall past the end are dropped.
+     */
+    void copyFrames(size_t dstFrame, const MelView& source)
+    {
+        if (source.getNumMels() != mels || dstFrame >= frames)
+            return;
+        const size_t count = std::min(source.size(), frames - dstFrame);
+        std::copy(source.data(), source.data() + count * static_cast<size_t>(mels),
+                  data() + dstFrame * static_cast<size_t>(mels));
+    }
+
+    /**
+     * Move the frames to a scratch file mapping and free the memory. Not
+     * while another thread reads the buffer. Returns false if already paged,
+     * empty, or no mapping could be made.
+     */
+    bool pageOut();
+
+    /** Copy paged frames back into memory; does nothing if not paged. */
+    void pageIn();
+
+private:
+    void dropPages()
+    {
+        pages.reset();
+        pagedValues = nullptr;
+    }
+
+    std::vector<float> values;
+    std::shared_ptr<ScratchMapping> pages;
+    float* pagedValues = nullptr; // Into pages, when paged
+    size_t frames = 0;
+    int mels = NUM_MELS;
+};
+
+/**
+ * Immutable mel frames stored as half floats, for copies that are kept but
+ * rarely read (the originals held by note clips). Half the bytes of a
+ * MelBuffer; decode() converts back to float32 for the code that reads it.
+ */
+class HalfMelBuffer
+{
+public:
+    HalfMelBuffer() = default;
+    explicit HalfMelBuffer(const MelView& source);
+
+    size_t size() const { return frames; }
+    bool empty() const { return frames == 0; }
+    int getNumMels() const { return mels; }
+    size_t getNumBytes() const { return values.size() * sizeof(uint16_t); }
+
+    /** Frames [start, end), clamped, as float32. */
+    MelBuffer decode(size_t start, size_t end) const;
+
+private:
+    std::vector<uint16_t> values;
+    size_t frames = 0;
+    int mels = NUM_MELS;
+};
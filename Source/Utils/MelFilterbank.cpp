@@ -0,0 +1,145 @@
+#include "MelFilterbank.h"
+#include <cmath>
+#include <map>
+#include <mutex>
+#include <tuple>
+
+namespace
+{
+    // Slaney-style mel scale (matches librosa default with htk=False):
+    // linear below 1000 Hz, logarithmic above
+    constexpr float slaneyHzPerMel = 200.0f / 3.0f;
+    constexpr float slaneyMinLogHz = 1000.0f;
+    constexpr float slaneyMinLogMel = slaneyMinLogHz / slaneyHzPerMel;  // = 15.0
+
+    float slaneyLogStep() { return std::log(6.4f) / 27.0f; }
+
+    float hzToMel(float hz, MelFilterbank::Scale scale)
+    {
+        if (scale == MelFilterbank::Scale::Htk)
+            return 2595.0f * std::log10(1.0f + hz / 700.0f);
+        if (hz < slaneyMinLogHz)
+            return hz / slaneyHzPerMel;
+        return slaneyMinLogMel + std::log(hz / slaneyMinLogHz) / slaneyLogStep();
+    }
+
+    float melToHz(float mel, MelFilterbank::Scale scale)
+    {
+        if (scale == MelFilterbank::Scale::Htk)
+            return 700.0f * (std::pow(10.0f, mel / 2595.0f) - 1.0f);
+        if (mel < slaneyMinLogMel)
+            return slaneyHzPerMel * mel;
+        return slaneyMinLogHz * std::exp(slaneyLogStep() * (mel - slaneyMinLogMel));
+    }
+
+    using Key = std::tuple<int, int, int, float, float, int>;
+}
+
+MelFilterbank::Ptr MelFilterbank::get(int sampleRate, int nFft, int numMels,
+                                      float fMin, float fMax, Scale scale)
+{
+    static std::mutex cacheMutex;
+    static std::map<Key, Ptr> cache;
+
+    const Key key { sampleRate, nFft, numMels, fMin, fMax, static_cast<int>(scale) };
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    if (auto it = cache.find(key); it != cache.end())
+        return it->second;
+
+    // Mel points (numMels + 2 for the triangle edges), converted to Hz
+    const float melMin = hzToMel(fMin, scale);
+    const float melMax = hzToMel(fMax, scale);
+    std::vector<float> hzPoints(static_cast<size_t>(numMels) + 2);
+    for (int i = 0; i <= numMels + 1; ++i)
+        hzPoints[static_cast<size_t>(i)] = melToHz(melMin + (melMax - melMin) * i / (numMels + 1), scale);
+
+    std::shared_ptr<MelFilterbank> filterbank(new MelFilterbank());
+    filterbank->numBins = nFft / 2 + 1;
+
+    std::vector<float> row(static_cast<size_t>(filterbank->numBins));
+    for (int m = 0; m < numMels; ++m)
+    {
+        const float fLow = hzPoints[static_cast<size_t>(m)];
+        const float fCenter = hzPoints[static_cast<size_t>(m) + 1];
+        const float fHigh = hzPoints[static_cast<size_t>(m) + 2];
+
+        // Slaney normalization: divide by the width of the mel band
+        const float enorm = 2.0f / (fHigh - fLow);
+
+        for (int k = 0; k < filterbank->numBins; ++k)
+        {
+            const float freq = static_cast<float>(k) * sampleRate / nFft;
+            float weight = 0.0f;
+            if (freq >= fLow && freq < fCenter)
+                weight = enorm * (freq - fLow) / (fCenter - fLow);    // Rising edge
+            else if (freq >= fCenter && freq <= fHigh)
+                weight = enorm * (fHigh - freq) / (fHigh - fCenter);  // Falling edge
+            row[static_cast<size_t>(k)] = weight;
+        }
+        filterbank->addBand(row.data());
+    }
+
+    cache.emplace(key, filterbank);
+    return filterbank;
+}
+
+MelFilterbank::Ptr MelFilterbank::fromDense(const float* weights, int numMels, int numBins)
+{
+    std::shared_ptr<MelFilterbank> filterbank(new MelFilterbank());
+    filterbank->numBins = numBins;
+    for (int m = 0; m < numMels; ++m)
+        filterbank->addBand(weights + static_cast<size_t>(m) * static_cast<size_t>(numBins));
+    return filterbank;
+}
+
+float MelFilterbank::bandForFrequency(float hz, int numMels, float fMin, float fMax,
+                                      Scale scale)
+{
+    // Centre of band m is mel point m + 1 of the numMels + 2 in get()
+    const float melMin = hzToMel(fMin, scale);
+    const float melMax = hzToMel(fMax, scale);
+    const float step = (melMax - melMin) / static_cast<float>(numMels + 1);
+    return (hzToMel(hz, scale) - melMin) / step - 1.0f;
+}
+
+float MelFilterbank::frequencyForBand(float band, int numMels, float fMin, float fMax,
+                                      Scale scale)
+{
+    const float melMin = hzToMel(fMin, scale);
+    const float melMax = hzToMel(fMax, scale);
+    const float step = (melMax - melMin) / static_cast<float>(numMels + 1);
+    return melToHz(melMin + (band + 1.0f) * step, scale);
+}
+
+void MelFilterbank::addBand(const float* row)
+{
+    int first = 0;
+    while (first < numBins && row[first] == 0.0f)
+        ++first;
+    int last = numBins;
+    while (last > first && row[last - 1] == 0.0f)
+        --last;
+
+    Band band;
+    band.firstBin = first;
+    band.numBins = last - first;
+    band.offset = weights.size();
+    weights.insert(weights.end(), row + first, row + last);
+    bands.push_back(band);
+}
+
+void MelFilterbank::apply(const float* magnitude, float* out) const
+{
+    // Skipped bins have exactly zero weight, so sums match the dense product
+    for (size_t m = 0; m < bands.size(); ++m)
+    {
+        const auto& band = bands[m];
+        const float* w = weights.data() + band.offset;
+        const float* mag = magnitude + band.firstBin;
+
+        float sum = 0.0f;
+        for (int k = 0; k < band.numBins; ++k)
+            sum += mag[k] * w[k];
+        out[m] = sum;
+    }
+}
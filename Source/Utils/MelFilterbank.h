@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+/**
+ * Sparse triangular mel filterbank.
+ *
+ * Each band keeps only the bins between its first and last nonzero weight,
+ * so applying it costs a few dozen multiply-adds per band instead of one per
+ * FFT bin. Filterbanks are immutable; get() builds each distinct parameter
+ * set once and hands out shared copies, so every mel producer using the
+ * same settings shares one table.
+ */
+class MelFilterbank
+{
+public:
+    enum class Scale { Slaney, Htk };
+
+    using Ptr = std::shared_ptr<const MelFilterbank>;
+
+    /**
+     * Shared filterbank with Slaney area normalization (librosa's norm="slaney")
+     * over numMels bands for an nFft-point FFT. Thread-safe.
+     */
+    static Ptr get(int sampleRate, int nFft, int numMels, float fMin, float fMax,
+                   Scale scale = Scale::Slaney);
+
+    /**
+     * Sparse copy of a dense row-major [numMels][numBins] matrix, for
+     * filterbanks loaded from file. Not cached.
+     */
+    static Ptr fromDense(const float* weights, int numMels, int numBins);
+
+    /**
+     * Position of hz among the band centres of the filterbank get() builds:
+     * m at the peak of band m, fractional between two peaks. Below 0 or past
+     * numMels - 1 near and beyond fMin and fMax.
+     */
+    static float bandForFrequency(float hz, int numMels, float fMin, float fMax,
+                                  Scale scale = Scale::Slaney);
+
+    /** Inverse of bandForFrequency(): the frequency at fractional band. */
+    static float frequencyForBand(float band, int numMels, float fMin, float fMax,
+                                  Scale scale = Scale::Slaney);
+
+    int getNumMels() const { return static_cast<int>(bands.size()); }
+    int getNumBins() const { return numBins; }
+
+    /**
+     * out[m] = sum over k of magnitude[k] * weight[m][k], for all bands.
+     * magnitude holds getNumBins() values; out holds getNumMels().
+     */
+    void apply(const float* magnitude, float* out) const;
+
+private:
+    struct Band
+    {
+        int firstBin = 0;
+        int numBins = 0;
+        size_t offset = 0;  // Into weights
+    };
+
+    MelFilterbank() = default;
+
+    // Append one dense row, trimmed to its nonzero span
+    void addBand(const float* row);
+
+    std::vector<Band> bands;
+    std::vector<float> weights;
+    int numBins = 0;
+};
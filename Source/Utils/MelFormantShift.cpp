@@ -0,0 +1,90 @@
+#include "MelFormantShift.h"
+#include "MelFilterbank.h"
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <mutex>
+#include <utility>
+
+namespace MelFormantShift
+{
+    Warp::Warp(float semitones, int numMelsIn)
+        : numMels(numMelsIn),
+          lower(static_cast<size_t>(std::max(numMelsIn, 0))),
+          fraction(static_cast<size_t>(std::max(numMelsIn, 0)))
+    {
+        // Band m of the output reads the input at frequency centre_m / ratio
+        const float ratio = std::pow(2.0f, semitones / 12.0f);
+        for (int m = 0; m < numMels; ++m)
+        {
+            const float centre = MelFilterbank::frequencyForBand(static_cast<float>(m), numMels,
+                                                                 FMIN, FMAX);
+            const float source = std::clamp(
+                MelFilterbank::bandForFrequency(centre / ratio, numMels, FMIN, FMAX), 0.0f,
+                static_cast<float>(numMels - 1));
+            const int band = std::min(static_cast<int>(source), numMels - 2);
+            lower[static_cast<size_t>(m)] = std::max(band, 0);
+            fraction[static_cast<size_t>(m)] = source - static_cast<float>(std::max(band, 0));
+        }
+    }
+
+    std::shared_ptr<const Warp> Warp::get(float semitones, int numMels)
+    {
+        // Slider drags visit many values; a handful of entries covers the
+        // ones in use, so the cache is simply emptied when it fills up
+        constexpr size_t maxCached = 64;
+        static std::mutex mutex;
+        static std::map<std::pair<int, float>, std::shared_ptr<const Warp>> cache;
+
+        std::lock_guard<std::mutex> lock(mutex);
+        const auto key = std::make_pair(numMels, semitones);
+        if (auto found = cache.find(key); found != cache.end())
+            return found->second;
+        if (cache.size() >= maxCached)
+            cache.clear();
+
+        auto warp = std::make_shared<const Warp>(semitones, numMels);
+        cache.emplace(key, warp);
+        return warp;
+    }
+
+    void Warp::apply(const float* in, float* out, size_t numFrames) const
+    {
+        for (size_t t = 0; t < numFrames; ++t)
+        {
+            for (int m = 0; m < numMels; ++m)
+            {
+                const int band = lower[static_cast<size_t>(m)];
+                const float w = fraction[static_cast<size_t>(m)];
+                const float next = in[std::min(band + 1, numMels - 1)];
+                out[m] = in[band] + w * (next - in[band]);
+            }
+            in += numMels;
+            out += numMels;
+        }
+    }
+
+    MelBuffer apply(const MelView& mel, float semitones)
+    {
+        if (semitones == 0.0f || mel.empty())
+            return MelBuffer(mel);
+
+        MelBuffer shifted(mel.size(), mel.getNumMels());
+        Warp::get(semitones, mel.getNumMels())->apply(mel.data(), shifted.data(), mel.size());
+        return shifted;
+    }
+
+    void appendShifted(MelBuffer& dest, const MelView& mel, float semitones)
+    {
+        if (semitones == 0.0f || mel.empty())
+            return dest.append(mel);
+        if (dest.empty())
+            dest.reset(0, mel.getNumMels());
+        if (mel.getNumMels() != dest.getNumMels())
+            return;
+
+        const size_t start = dest.size();
+        dest.resize(start + mel.size());
+        Warp::get(semitones, mel.getNumMels())->apply(mel.data(), dest[start], mel.size());
+    }
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "MelBuffer.h"
+#include <memory>
+#include <vector>
+
+/**
+ * Formant shift on a log-mel spectrogram.
+ *
+ * Every frame is resampled along frequency by 2^(semitones / 12), so the
+ * spectral envelope moves up or down while the pitch, which the vocoder
+ * takes from F0, stays put. Band positions follow the Slaney mel scale the
+ * analysis uses; bands that would read past either end of the spectrum
+ * repeat the edge band.
+ */
+namespace MelFormantShift
+{
+    /**
+     * The shift as a sparse band-to-band matrix: output band m blends input
+     * bands lower[m] and lower[m] + 1. It depends only on the shift and the
+     * band count, so synthesis warps mel slices on the fly through a shared
+     * instance per value rather than keeping shifted spectrograms.
+     */
+    class Warp
+    {
+    public:
+        Warp(float semitones, int numMels);
+
+        /** Cached warp for this shift and band count. */
+        static std::shared_ptr<const Warp> get(float semitones, int numMels = NUM_MELS);
+
+        int getNumMels() const { return numMels; }
+
+        /** Warp numFrames frame-major frames; in and out must not overlap. */
+        void apply(const float* in, float* out, size_t numFrames) const;
+
+    private:
+        int numMels;
+        std::vector<int> lower;
+        std::vector<float> fraction;
+    };
+
+    MelBuffer apply(const MelView& mel, float semitones);
+
+    /** Append mel to dest shifted by semitones, as MelBuffer::append would. */
+    void appendShifted(MelBuffer& dest, const MelView& mel, float semitones);
+}
@@ -1,12 +1,23 @@
 #include "MelSpectrogram.h"
+#include "Constants.h"
+#include "DspKernels.h"
+#include "Tracing.h"
 #include <cmath>
 #include <algorithm>
+#include <thread>
+
+namespace
+{
+    // Below this many frames per worker, threads cost more than they save
+    constexpr int minFramesPerThread = 256;
+    constexpr int maxThreads = 8;
+}
 
 MelSpectrogram::MelSpectrogram(int sampleRate, int nFft, int hopSize,
                                int numMels, float fMin, float fMax)
     : sampleRate(sampleRate), nFft(nFft), hopSize(hopSize),
       numMels(numMels), fMin(fMin), fMax(fMax),
-      fft(static_cast<int>(std::log2(nFft)))
+      fftOrder(static_cast<int>(std::log2(nFft)))
 {
     // Create Hann window (periodic, matches librosa default)
     window.resize(nFft);
@@ -15,94 +26,13 @@ MelSpectrogram::MelSpectrogram(int sampleRate, int nFft, int hopSize,
         window[i] = 0.5f * (1.0f - std::cos(2.0f * juce::MathConstants<float>::pi * i / nFft));
     }
     
-    createMelFilterbank();
+    melFilterbank = MelFilterbank::get(sampleRate, nFft, numMels, fMin, fMax);
 }
 
-void MelSpectrogram::createMelFilterbank()
+MelBuffer MelSpectrogram::compute(const float* audio, int numSamples)
 {
-    // Slaney-style mel scale (matches librosa default with htk=False)
-    // This is a piecewise linear (below 1000Hz) / log (above 1000Hz) scale
-    const float f_min_mel = 0.0f;
-    const float f_sp = 200.0f / 3.0f;  // ~66.67 Hz per mel below 1000 Hz
-    const float min_log_hz = 1000.0f;
-    const float min_log_mel = (min_log_hz - f_min_mel) / f_sp;  // = 15.0
-    const float logstep = std::log(6.4f) / 27.0f;  // ~0.0687
-    
-    // Convert Hz to Mel (Slaney formula - NOT HTK!)
-    auto hzToMel = [=](float hz) -> float {
-        if (hz < min_log_hz)
-            return (hz - f_min_mel) / f_sp;
-        else
-            return min_log_mel + std::log(hz / min_log_hz) / logstep;
-    };
-    
-    // Convert Mel to Hz (Slaney formula - NOT HTK!)
-    auto melToHz = [=](float mel) -> float {
-        if (mel < min_log_mel)
-            return f_min_mel + f_sp * mel;
-        else
-            return min_log_hz * std::exp(logstep * (mel - min_log_mel));
-    };
-    
-    float melMin = hzToMel(fMin);
-    float melMax = hzToMel(fMax);
-    
-    // Create mel points (numMels + 2 points for the triangular filters)
-    std::vector<float> melPoints(numMels + 2);
-    for (int i = 0; i <= numMels + 1; ++i)
-    {
-        melPoints[i] = melMin + (melMax - melMin) * i / (numMels + 1);
-    }
-    
-    // Convert to Hz
-    std::vector<float> hzPoints(numMels + 2);
-    for (int i = 0; i <= numMels + 1; ++i)
-    {
-        hzPoints[i] = melToHz(melPoints[i]);
-    }
-    
-    // Convert to FFT bins
-    int numBins = nFft / 2 + 1;
-    std::vector<float> binPoints(numMels + 2);
-    for (int i = 0; i <= numMels + 1; ++i)
-    {
-        // Use continuous (fractional) bin numbers like librosa
-        binPoints[i] = (nFft + 1) * hzPoints[i] / sampleRate;
-    }
+    TRACE_ZONE("MelSpectrogram::compute");
     
-    // Create filterbank with Slaney normalization (area normalization)
-    melFilterbank.resize(numMels);
-    for (int m = 0; m < numMels; ++m)
-    {
-        melFilterbank[m].resize(numBins, 0.0f);
-        
-        float fLow = hzPoints[m];
-        float fCenter = hzPoints[m + 1];
-        float fHigh = hzPoints[m + 2];
-        
-        // Slaney normalization: divide by the width of the mel band
-        float enorm = 2.0f / (fHigh - fLow);
-        
-        for (int k = 0; k < numBins; ++k)
-        {
-            float freq = static_cast<float>(k) * sampleRate / nFft;
-            
-            if (freq >= fLow && freq < fCenter)
-            {
-                // Rising edge
-                melFilterbank[m][k] = enorm * (freq - fLow) / (fCenter - fLow);
-            }
-            else if (freq >= fCenter && freq <= fHigh)
-            {
-                // Falling edge
-                melFilterbank[m][k] = enorm * (fHigh - freq) / (fHigh - fCenter);
-            }
-        }
-    }
-}
-
-std::vector<std::vector<float>> MelSpectrogram::compute(const float* audio, int numSamples)
-{
     // Add center padding for better frame alignment (matches librosa default)
     // This ensures the first frame is centered at hopSize/2
     int padLeft = nFft / 2;
@@ -116,68 +46,102 @@ std::vector<std::vector<float>> MelSpectrogram::compute(const float* audio, int
         numFrames = 1;
     }
     
-    std::vector<std::vector<float>> mel(numFrames);
-    int numBins = nFft / 2 + 1;
+    MelBuffer mel(static_cast<size_t>(numFrames), numMels);
+    if (numSamples <= 0)
+        return mel;
     
-    std::vector<float> frame(nFft * 2, 0.0f);  // Complex FFT buffer
+    const int hardwareThreads = static_cast<int>(std::thread::hardware_concurrency());
+    const int numThreads = std::clamp(std::min(hardwareThreads, numFrames / minFramesPerThread),
+                                      1, maxThreads);
+    const int framesPerThread = (numFrames + numThreads - 1) / numThreads;
     
-    for (int i = 0; i < numFrames; ++i)
+    // Every worker owns its FFT and scratch; they only share read-only state
+    // and write disjoint rows of mel
+    auto runBlock = [&](int block)
+    {
+        const int firstFrame = block * framesPerThread;
+        const int endFrame = std::min(numFrames, firstFrame + framesPerThread);
+        if (firstFrame >= endFrame)
+            return;
+        
+        juce::dsp::FFT fft(fftOrder);
+        std::vector<float> scratch(static_cast<size_t>(nFft) * 2);
+        if (nFft == N_FFT && numMels == NUM_MELS)
+            computeFrames(audio, numSamples, firstFrame, endFrame, fft, scratch.data(), mel,
+                          DspKernels::Fixed<N_FFT>(), DspKernels::Fixed<NUM_MELS>());
+        else
+            computeFrames(audio, numSamples, firstFrame, endFrame, fft, scratch.data(), mel,
+                          nFft, numMels);
+    };
+    
+    std::vector<std::thread> workers;
+    workers.reserve(static_cast<size_t>(numThreads - 1));
+    for (int block = 1; block < numThreads; ++block)
+        workers.emplace_back(runBlock, block);
+    runBlock(0);
+    for (auto& worker : workers)
+        worker.join();
+    
+    return mel;
+}
+
+template <typename FftSize, typename MelCount>
+void MelSpectrogram::computeFrames(const float* audio, int numSamples, int firstFrame, int endFrame,
+                                   juce::dsp::FFT& fft, float* scratch, MelBuffer& mel,
+                                   FftSize frameSize, MelCount melCount) const
+{
+    const int size = static_cast<int>(frameSize);
+    const int padLeft = size / 2;
+    const float* hann = window.data();
+    
+    for (int i = firstFrame; i < endFrame; ++i)
     {
         // Calculate sample position in original audio (accounting for padding)
         int centerSample = i * hopSize;
         int startSample = centerSample - padLeft;
         
-        // Copy and window with proper boundary handling
-        std::fill(frame.begin(), frame.end(), 0.0f);
-        for (int j = 0; j < nFft; ++j)
+        // Copy and window; interior frames are one vectorized multiply
+        if (startSample >= 0 && startSample + size <= numSamples)
         {
-            int srcIdx = startSample + j;
-            
-            if (srcIdx < 0)
-            {
-                // Left padding: reflect
-                frame[j] = audio[std::min(-srcIdx - 1, numSamples - 1)] * window[j];
-            }
-            else if (srcIdx >= numSamples)
-            {
-                // Right padding: reflect
-                int reflectIdx = numSamples - 1 - (srcIdx - numSamples);
-                frame[j] = audio[std::max(0, reflectIdx)] * window[j];
-            }
-            else
+            juce::FloatVectorOperations::multiply(scratch, audio + startSample, hann, size);
+        }
+        else
+        {
+            for (int j = 0; j < size; ++j)
             {
-                // Normal case
-                frame[j] = audio[srcIdx] * window[j];
+                int srcIdx = startSample + j;
+                
+                if (srcIdx < 0)
+                {
+                    // Left padding: reflect
+                    scratch[j] = audio[std::min(-srcIdx - 1, numSamples - 1)] * hann[j];
+                }
+                else if (srcIdx >= numSamples)
+                {
+                    // Right padding: reflect
+                    int reflectIdx = numSamples - 1 - (srcIdx - numSamples);
+                    scratch[j] = audio[std::max(0, reflectIdx)] * hann[j];
+                }
+                else
+                {
+                    scratch[j] = audio[srcIdx] * hann[j];
+                }
             }
         }
+        juce::FloatVectorOperations::clear(scratch + size, size);
         
-        // Perform FFT
-        fft.performRealOnlyForwardTransform(frame.data());
+        // Perform FFT; output is interleaved (re, im) for bins 0..nFft/2
+        fft.performRealOnlyForwardTransform(scratch, true);
         
-        // Compute magnitude spectrum with small epsilon to avoid log(0)
-        std::vector<float> mag(numBins);
-        for (int k = 0; k < numBins; ++k)
-        {
-            float real = frame[k * 2];
-            float imag = frame[k * 2 + 1];
-            mag[k] = std::sqrt(real * real + imag * imag + 1e-9f);
-        }
+        // Magnitude spectrum in place; small epsilon avoids log(0)
+        DspKernels::magnitudeInPlace(scratch, DspKernels::numBinsFor(frameSize), 1e-9f);
         
         // Apply mel filterbank
-        mel[i].resize(numMels);
-        for (int m = 0; m < numMels; ++m)
-        {
-            float sum = 0.0f;
-            for (int k = 0; k < numBins; ++k)
-            {
-                sum += mag[k] * melFilterbank[m][k];
-            }
-            
-            // Log scale (natural log for vocoder compatibility)
-            // Use slightly larger epsilon to match common vocoder implementations
-            mel[i][m] = std::log(std::max(sum, 1e-10f));
-        }
+        float* melFrame = mel[static_cast<size_t>(i)];
+        melFilterbank->apply(scratch, melFrame);
+        
+        // Log scale (natural log for vocoder compatibility)
+        // Use slightly larger epsilon to match common vocoder implementations
+        DspKernels::logInPlace(melFrame, melCount, 1e-10f);
     }
-    
-    return mel;
 }
@@ -1,10 +1,17 @@
 #pragma once
 
 #include "../JuceHeader.h"
+#include "MelBuffer.h"
+#include "MelFilterbank.h"
 #include <vector>
 
 /**
  * Mel spectrogram computation.
+ *
+ * Frames are split into contiguous blocks on worker threads, each with its
+ * own FFT and scratch buffers, and written straight into the MelBuffer.
+ * The sparse filterbank is shared with every producer using the same
+ * settings (see MelFilterbank).
  */
 class MelSpectrogram
 {
@@ -19,12 +26,16 @@ public:
      * @param numSamples Number of samples
      * @return Mel spectrogram [T, numMels] in log scale
      */
-    std::vector<std::vector<float>> compute(const float* audio, int numSamples);
+    MelBuffer compute(const float* audio, int numSamples);
     
 private:
-    void createMelFilterbank();
-    void applyWindow(std::vector<float>& frame);
-    std::vector<float> computeFFT(const std::vector<float>& frame);
+    // Compute frames [firstFrame, endFrame) into mel using fft and the
+    // caller's scratch buffer (2 * nFft floats). FftSize and MelCount are int,
+    // or DspKernels::Fixed for the geometry of Constants.h
+    template <typename FftSize, typename MelCount>
+    void computeFrames(const float* audio, int numSamples, int firstFrame, int endFrame,
+                       juce::dsp::FFT& fft, float* scratch, MelBuffer& mel,
+                       FftSize frameSize, MelCount melCount) const;
     
     int sampleRate;
     int nFft;
@@ -32,9 +43,8 @@ private:
     int numMels;
     float fMin;
     float fMax;
+    int fftOrder;
     
     std::vector<float> window;  // Hann window
-    std::vector<std::vector<float>> melFilterbank;
-    
-    juce::dsp::FFT fft;
+    MelFilterbank::Ptr melFilterbank;
 };
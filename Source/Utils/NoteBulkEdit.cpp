@@ -0,0 +1,101 @@
+#include "NoteBulkEdit.h"
+#include "PitchCurveProcessor.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    // Sorted, disjoint cover of spans
+    std::vector<std::pair<int, int>> mergeSpans(std::vector<std::pair<int, int>> spans)
+    {
+        std::sort(spans.begin(), spans.end());
+
+        std::vector<std::pair<int, int>> ranges;
+        for (const auto& span : spans)
+        {
+            if (!ranges.empty() && span.first <= ranges.back().second)
+                ranges.back().second = std::max(ranges.back().second, span.second);
+            else
+                ranges.push_back(span);
+        }
+        return ranges;
+    }
+} // namespace
+
+namespace NoteBulkEdit
+{
+    std::vector<PitchChange> planSnapToSemitone(Project& project, const std::vector<Note*>& notes)
+    {
+        std::vector<PitchChange> changes;
+        changes.reserve(notes.size());
+        for (auto* note : notes)
+        {
+            if (!note || note->isRest())
+                continue;
+            const float adjustedMidi = note->getMidiNote() + note->getPitchOffset();
+            const float snappedMidi = std::round(adjustedMidi);
+            if (std::abs(snappedMidi - adjustedMidi) <= 0.001f)
+                continue;
+            changes.push_back({ project.getNoteId(*note), note->getMidiNote(), note->getPitchOffset(), snappedMidi });
+        }
+        return changes;
+    }
+
+    std::vector<Note*> applyPitchChanges(Project& project, const std::vector<PitchChange>& changes,
+                                         bool useNewPitch)
+    {
+        std::vector<Note*> notes;
+        notes.reserve(changes.size());
+        NoteChangeFeed::ScopedBatch batch(&project.getNoteChanges());
+        for (const auto& change : changes)
+        {
+            auto* note = project.findNote(change.noteId);
+            if (!note)
+                continue;
+            note->setMidiNote(useNewPitch ? change.newMidi : change.oldMidi);
+            note->setPitchOffset(useNewPitch ? 0.0f : change.oldOffset);
+            note->markDirty();
+            project.noteChanged(*note);
+            notes.push_back(note);
+        }
+        return notes;
+    }
+
+    std::vector<std::pair<int, int>> getNoteRanges(const std::vector<Note*>& notes)
+    {
+        std::vector<std::pair<int, int>> spans;
+        spans.reserve(notes.size());
+        for (const auto* note : notes)
+        {
+            if (note && note->getEndFrame() > note->getStartFrame())
+                spans.emplace_back(note->getStartFrame(), note->getEndFrame());
+        }
+        return mergeSpans(std::move(spans));
+    }
+
+    std::vector<std::pair<int, int>> rebuildAroundNotes(Project& project,
+                                                        const std::vector<Note*>& notes,
+                                                        int dirtyPadFrames)
+    {
+        return rebuildAroundRanges(project, getNoteRanges(notes), dirtyPadFrames);
+    }
+
+    std::vector<std::pair<int, int>> rebuildAroundRanges(Project& project,
+                                                         std::vector<std::pair<int, int>> ranges,
+                                                         int dirtyPadFrames)
+    {
+        ranges.erase(std::remove_if(ranges.begin(), ranges.end(),
+                                    [](const auto& range) { return range.second <= range.first; }),
+                     ranges.end());
+        ranges = mergeSpans(std::move(ranges));
+        if (ranges.empty())
+            return {};
+
+        const auto rebuilt = PitchCurveProcessor::rebuildBaseInRanges(project, ranges);
+        const int f0Size = static_cast<int>(project.getAudioData().f0.size());
+        for (const auto& [startFrame, endFrame] : rebuilt)
+            project.setF0DirtyRange(std::max(0, startFrame - dirtyPadFrames),
+                                    std::min(f0Size, endFrame + dirtyPadFrames));
+        return rebuilt;
+    }
+} // namespace NoteBulkEdit
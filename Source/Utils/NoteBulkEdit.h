@@ -0,0 +1,52 @@
+#pragma once
+
+#include "../Models/Project.h"
+#include <utility>
+#include <vector>
+
+/**
+ * Pitch edits over many notes at once (snap a whole selection, drag it).
+ *
+ * Changes are planned in one pass over the notes, applied in another, and
+ * the curves are then rebuilt once over the merged frame ranges of every
+ * changed note instead of per note or over the selection's bounding span.
+ */
+namespace NoteBulkEdit
+{
+    /** One note's pitch before and after an edit; applied with a zero offset. */
+    struct PitchChange
+    {
+        NoteId noteId = 0;
+        float oldMidi = 0.0f;
+        float oldOffset = 0.0f;
+        float newMidi = 0.0f;
+    };
+
+    /** Non-rest notes whose adjusted pitch is off the semitone grid, rounded onto it. */
+    std::vector<PitchChange> planSnapToSemitone(Project& project, const std::vector<Note*>& notes);
+
+    /**
+     * Give each note its new pitch (or its old one), mark it dirty and post
+     * the changes as one batch. Returns the notes found.
+     */
+    std::vector<Note*> applyPitchChanges(Project& project, const std::vector<PitchChange>& changes,
+                                         bool useNewPitch);
+
+    /** Frames of the notes as sorted, disjoint [start, end) ranges. */
+    std::vector<std::pair<int, int>> getNoteRanges(const std::vector<Note*>& notes);
+
+    /**
+     * After the notes changed pitch: rebuild the curves around them with one
+     * PitchCurveProcessor::rebuildBaseInRanges() call and mark each rebuilt
+     * span dirty for synthesis, widened by dirtyPadFrames. Returns the
+     * rebuilt spans, for invalidating caches drawn from the base pitch.
+     */
+    std::vector<std::pair<int, int>> rebuildAroundNotes(Project& project,
+                                                        const std::vector<Note*>& notes,
+                                                        int dirtyPadFrames = 60);
+
+    /** rebuildAroundNotes() for frame ranges, in any order and overlapping. */
+    std::vector<std::pair<int, int>> rebuildAroundRanges(Project& project,
+                                                         std::vector<std::pair<int, int>> ranges,
+                                                         int dirtyPadFrames = 60);
+} // namespace NoteBulkEdit
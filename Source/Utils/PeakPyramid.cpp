@@ -0,0 +1,275 @@
+#include "PeakPyramid.h"
+#include "JobSystem.h"
+#include <algorithm>
+#include <cmath>
+
+size_t PeakPyramid::levelOffset(int level) {
+  size_t offset = 0;
+  for (int j = 0; j < level; ++j)
+    offset += static_cast<size_t>(RenderSnapshot::tileSize /
+                                  (minDecimation << j));
+  return offset;
+}
+
+PeakPyramid::Peak PeakPyramid::merge(const Peak &a, const Peak &b) {
+  return {std::min(a.min, b.min), std::max(a.max, b.max),
+          std::sqrt((a.rms * a.rms + b.rms * b.rms) * 0.5f)};
+}
+
+PeakPyramid::TileSummary
+PeakPyramid::summariseTile(const RenderSnapshot &snapshot, int tileIndex) {
+  const int start = tileIndex * RenderSnapshot::tileSize;
+  const int length =
+      std::min(RenderSnapshot::tileSize, snapshot.getNumSamples() - start);
+  std::vector<float> samples(static_cast<size_t>(std::max(0, length)));
+  if (length > 0)
+    snapshot.read(0, start, length, samples.data());
+
+  auto summary = std::make_shared<std::vector<Peak>>(levelOffset(numTileLevels));
+  auto &bins = *summary;
+
+  // Level 0 from the samples; a short last tile leaves its tail bins empty
+  const int firstBins = RenderSnapshot::tileSize / minDecimation;
+  for (int bin = 0; bin < firstBins; ++bin) {
+    const int from = bin * minDecimation;
+    const int to = std::min(length, from + minDecimation);
+    if (from >= to)
+      break;
+    Peak peak{samples[static_cast<size_t>(from)],
+              samples[static_cast<size_t>(from)], 0.0f};
+    double sumSquares = 0.0;
+    for (int i = from; i < to; ++i) {
+      const float s = samples[static_cast<size_t>(i)];
+      peak.min = std::min(peak.min, s);
+      peak.max = std::max(peak.max, s);
+      sumSquares += static_cast<double>(s) * s;
+    }
+    peak.rms = static_cast<float>(std::sqrt(sumSquares / (to - from)));
+    bins[static_cast<size_t>(bin)] = peak;
+  }
+
+  // Each further level pairs up the one below
+  for (int level = 1; level < numTileLevels; ++level) {
+    const size_t below = levelOffset(level - 1);
+    const size_t here = levelOffset(level);
+    const size_t count = static_cast<size_t>(RenderSnapshot::tileSize /
+                                             (minDecimation << level));
+    for (size_t i = 0; i < count; ++i)
+      bins[here + i] = merge(bins[below + 2 * i], bins[below + 2 * i + 1]);
+  }
+  return summary;
+}
+
+PeakPyramid::Ptr PeakPyramid::build(RenderSnapshot::Ptr snapshot,
+                                    const PeakPyramid *previous) {
+  if (!snapshot || snapshot->getNumChannels() == 0)
+    return nullptr;
+
+  std::shared_ptr<PeakPyramid> pyramid(new PeakPyramid());
+  const int numTiles = snapshot->getNumTiles();
+  const bool canReuse =
+      previous && previous->source->getNumSamples() == snapshot->getNumSamples() &&
+      previous->source->getNumTiles() == numTiles;
+
+  pyramid->tileSummaries.reserve(static_cast<size_t>(numTiles));
+  for (int t = 0; t < numTiles; ++t) {
+    if (canReuse && snapshot->sharesTile(*previous->source, t))
+      pyramid->tileSummaries.push_back(
+          previous->tileSummaries[static_cast<size_t>(t)]);
+    else
+      pyramid->tileSummaries.push_back(summariseTile(*snapshot, t));
+  }
+
+  // Above one bin per tile: pairs of tiles, up to the whole file
+  std::vector<Peak> level;
+  level.reserve(static_cast<size_t>(numTiles));
+  const size_t tileTotal = levelOffset(numTileLevels - 1);
+  for (const auto &summary : pyramid->tileSummaries)
+    level.push_back((*summary)[tileTotal]);
+  while (level.size() > 1) {
+    std::vector<Peak> next((level.size() + 1) / 2);
+    for (size_t i = 0; i < next.size(); ++i)
+      next[i] = 2 * i + 1 < level.size() ? merge(level[2 * i], level[2 * i + 1])
+                                         : level[2 * i];
+    pyramid->topLevels.push_back(next);
+    level = std::move(next);
+  }
+
+  pyramid->source = std::move(snapshot);
+  return pyramid;
+}
+
+PeakPyramid::Peak PeakPyramid::getBin(int level, int64_t index) const {
+  if (index < 0)
+    return {};
+  if (level < numTileLevels) {
+    const int64_t binsPerTile =
+        RenderSnapshot::tileSize / (minDecimation << level);
+    const auto tile = static_cast<size_t>(index / binsPerTile);
+    if (tile >= tileSummaries.size())
+      return {};
+    return (*tileSummaries[tile])[levelOffset(level) +
+                                  static_cast<size_t>(index % binsPerTile)];
+  }
+  const auto &top = topLevels[static_cast<size_t>(level - numTileLevels)];
+  return static_cast<size_t>(index) < top.size()
+             ? top[static_cast<size_t>(index)]
+             : Peak{};
+}
+
+PeakPyramid::Peak PeakPyramid::scanSamples(int64_t startSample,
+                                           int64_t endSample) const {
+  const int count = static_cast<int>(endSample - startSample);
+  float buffer[2 * minDecimation];
+  source->read(0, static_cast<int>(startSample), count, buffer);
+  Peak peak{buffer[0], buffer[0], 0.0f};
+  double sumSquares = 0.0;
+  for (int i = 0; i < count; ++i) {
+    peak.min = std::min(peak.min, buffer[i]);
+    peak.max = std::max(peak.max, buffer[i]);
+    sumSquares += static_cast<double>(buffer[i]) * buffer[i];
+  }
+  peak.rms = static_cast<float>(std::sqrt(sumSquares / count));
+  return peak;
+}
+
+PeakPyramid::Peak PeakPyramid::getPeak(int64_t startSample,
+                                       int64_t endSample) const {
+  startSample = std::max<int64_t>(0, startSample);
+  endSample = std::min<int64_t>(source->getNumSamples(), endSample);
+  const int64_t length = endSample - startSample;
+  if (length <= 0)
+    return {};
+  if (length < 2 * minDecimation)
+    return scanSamples(startSample, endSample);
+
+  // Exact cover: raw samples up to the first and from the last level 0 bin
+  // boundary, then from each level the odd bin at either end, so only the
+  // requested samples are summarised
+  Peak peak;
+  double sumSquares = 0.0;
+  bool any = false;
+  auto add = [&](const Peak &part, int64_t count) {
+    peak.min = any ? std::min(peak.min, part.min) : part.min;
+    peak.max = any ? std::max(peak.max, part.max) : part.max;
+    sumSquares += static_cast<double>(part.rms) * part.rms * count;
+    any = true;
+  };
+
+  int64_t lo = (startSample + minDecimation - 1) / minDecimation * minDecimation;
+  int64_t hi = endSample / minDecimation * minDecimation;
+  if (lo > startSample)
+    add(scanSamples(startSample, lo), lo - startSample);
+  if (endSample > hi)
+    add(scanSamples(hi, endSample), endSample - hi);
+
+  const int numLevels = numTileLevels + static_cast<int>(topLevels.size());
+  for (int level = 0; level < numLevels && lo < hi; ++level) {
+    const int64_t decimation = static_cast<int64_t>(minDecimation) << level;
+    if (level == numLevels - 1) {
+      for (; lo < hi; lo += decimation)
+        add(getBin(level, lo / decimation), std::min(decimation, hi - lo));
+      break;
+    }
+    if ((lo / decimation) % 2 != 0) {
+      add(getBin(level, lo / decimation), decimation);
+      lo += decimation;
+    }
+    if (lo < hi && (hi / decimation) % 2 != 0) {
+      hi -= decimation;
+      add(getBin(level, hi / decimation),
+          std::min(decimation, endSample - hi));
+    }
+  }
+
+  peak.rms = static_cast<float>(std::sqrt(sumSquares / length));
+  return peak;
+}
+
+void PeakPyramid::getPeaks(double startSample, double samplesPerColumn,
+                           int numColumns, Peak *out) const {
+  for (int i = 0; i < numColumns; ++i) {
+    const auto from =
+        static_cast<int64_t>(std::floor(startSample + i * samplesPerColumn));
+    const auto to = std::max(
+        from + 1, static_cast<int64_t>(
+                      std::floor(startSample + (i + 1) * samplesPerColumn)));
+    out[i] = getPeak(from, to);
+  }
+}
+
+PeakPyramidService::PeakPyramidService()
+    : worker([this]() { workerLoop(); }) {}
+
+PeakPyramidService::~PeakPyramidService() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopWorker = true;
+  }
+  wakeWorker.notify_all();
+  if (worker.joinable())
+    worker.join();
+}
+
+PeakPyramid::Ptr PeakPyramidService::get(const RenderSnapshot::Ptr &snapshot) {
+  if (!snapshot || snapshot->getNumSamples() == 0)
+    return nullptr;
+
+  std::lock_guard<std::mutex> lock(mutex);
+  for (auto &pyramid : finished)
+    pyramids.insert(pyramids.begin(), std::move(pyramid));
+  finished.clear();
+  if (pyramids.size() > maxPyramids)
+    pyramids.resize(maxPyramids);
+
+  PeakPyramid::Ptr earlier;
+  for (const auto &pyramid : pyramids) {
+    const auto &source = *pyramid->getSource();
+    if (pyramid->getSource() == snapshot)
+      return pyramid;
+    // Same audio, an earlier render of it: some tile is still shared
+    if (!earlier && source.getNumSamples() == snapshot->getNumSamples() &&
+        source.getNumTiles() == snapshot->getNumTiles()) {
+      for (int t = 0; t < snapshot->getNumTiles(); ++t) {
+        if (snapshot->sharesTile(source, t)) {
+          earlier = pyramid;
+          break;
+        }
+      }
+    }
+  }
+
+  if (pendingSnapshot != snapshot) {
+    pendingSnapshot = snapshot;
+    pendingPrevious = earlier;
+    wakeWorker.notify_all();
+  }
+  return earlier;
+}
+
+void PeakPyramidService::workerLoop() {
+  // Peaks only redraw the waveform; playback and edits come first
+  JobSystem::setCurrentThreadBackground(true);
+  std::unique_lock<std::mutex> lock(mutex);
+  while (!stopWorker) {
+    if (!pendingSnapshot) {
+      wakeWorker.wait(lock);
+      continue;
+    }
+    auto snapshot = pendingSnapshot;
+    auto previous = pendingPrevious;
+    lock.unlock();
+
+    auto pyramid = PeakPyramid::build(snapshot, previous.get());
+
+    lock.lock();
+    if (pyramid)
+      finished.push_back(std::move(pyramid));
+    // Unless get() asked for a newer render meanwhile
+    if (pendingSnapshot == snapshot)
+      pendingSnapshot = nullptr;
+    lock.unlock();
+    sendChangeMessage();
+    lock.lock();
+  }
+}
@@ -0,0 +1,120 @@
+#pragma once
+
+#include "../JuceHeader.h"
+#include "RenderSnapshot.h"
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Min/max/RMS summary of a rendered waveform (channel 0) at power-of-two
+ * decimations, from minDecimation samples per bin up to the whole file.
+ *
+ * Summaries are kept per RenderSnapshot tile, so a pyramid for an edited
+ * render reuses the summaries of every tile it shares with the previous
+ * one and only rescans the resynthesized tiles. A column of any width is
+ * answered from a handful of bins, so views draw in O(pixels) whatever the
+ * zoom. Immutable once built; any thread may read one it holds.
+ */
+class PeakPyramid {
+public:
+  using Ptr = std::shared_ptr<const PeakPyramid>;
+
+  struct Peak {
+    float min = 0.0f;
+    float max = 0.0f;
+    float rms = 0.0f;
+
+    float getMagnitude() const { return std::max(max, -min); }
+  };
+
+  static constexpr int minDecimation = 64;
+
+  /**
+   * Summarise snapshot. Tiles it shares with previous's source are taken
+   * from previous instead of being scanned again.
+   */
+  static Ptr build(RenderSnapshot::Ptr snapshot, const PeakPyramid *previous);
+
+  const RenderSnapshot::Ptr &getSource() const { return source; }
+  int getNumSamples() const { return source->getNumSamples(); }
+  int getSampleRate() const { return source->getSampleRate(); }
+
+  /** Peak of samples [startSample, endSample), clamped to the file. */
+  Peak getPeak(int64_t startSample, int64_t endSample) const;
+
+  /**
+   * One peak per column: column i covers samplesPerColumn samples from
+   * startSample + i * samplesPerColumn. Columns outside the file are 0.
+   */
+  void getPeaks(double startSample, double samplesPerColumn, int numColumns,
+                Peak *out) const;
+
+private:
+  PeakPyramid() = default;
+
+  // Decimations minDecimation..tileSize within each tile, one bin per
+  // tileSize / decimation, levels one after another
+  static constexpr int numTileLevels = 11; // 2^6 .. 2^16
+  static_assert(minDecimation << (numTileLevels - 1) ==
+                    RenderSnapshot::tileSize,
+                "tile levels must end at one bin per snapshot tile");
+
+  using TileSummary = std::shared_ptr<const std::vector<Peak>>;
+
+  static TileSummary summariseTile(const RenderSnapshot &snapshot,
+                                   int tileIndex);
+  static size_t levelOffset(int level);
+  static Peak merge(const Peak &a, const Peak &b);
+
+  // Bin index of level (0 = minDecimation); levels past the tile ones come
+  // from topLevels
+  Peak getBin(int level, int64_t index) const;
+  Peak scanSamples(int64_t startSample, int64_t endSample) const;
+
+  RenderSnapshot::Ptr source;
+  std::vector<TileSummary> tileSummaries;
+  // topLevels[k]: decimation tileSize * 2^(k + 1)
+  std::vector<std::vector<Peak>> topLevels;
+};
+
+/**
+ * Builds PeakPyramids on a worker thread and shares them between views.
+ *
+ * Hold one through juce::SharedResourcePointer so every view uses the same
+ * pyramids. A change message is sent whenever a pyramid is ready.
+ */
+class PeakPyramidService : public juce::ChangeBroadcaster {
+public:
+  PeakPyramidService();
+  ~PeakPyramidService() override;
+
+  /**
+   * Message thread: the pyramid of snapshot if built, else the newest one
+   * for an earlier render of the same audio (check getSource()), else null.
+   * Anything but the exact one schedules a build.
+   */
+  PeakPyramid::Ptr get(const RenderSnapshot::Ptr &snapshot);
+
+private:
+  static constexpr size_t maxPyramids = 4;
+
+  void workerLoop();
+
+  // Message thread only
+  std::vector<PeakPyramid::Ptr> pyramids; // Newest first
+
+  std::mutex mutex;
+  std::condition_variable wakeWorker;
+  RenderSnapshot::Ptr pendingSnapshot;    // Guarded by mutex
+  PeakPyramid::Ptr pendingPrevious;       // Guarded by mutex
+  std::vector<PeakPyramid::Ptr> finished; // Guarded by mutex
+  bool stopWorker = false;
+  std::thread worker; // Last: starts in the constructor
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PeakPyramidService)
+};
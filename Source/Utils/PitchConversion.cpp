@@ -0,0 +1,94 @@
+#include "PitchConversion.h"
+#include "Constants.h"
+#include <cstdint>
+#include <cstring>
+
+namespace
+{
+    constexpr float log2A4 = 8.78135971352466f;  // log2(FREQ_A4)
+
+    inline float bitsToFloat(uint32_t bits)
+    {
+        float value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    inline uint32_t floatToBits(float value)
+    {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        return bits;
+    }
+
+    // 2^x as 2^n * 2^f with n = round(x), |f| <= 0.5; degree 6 Taylor
+    // polynomial for 2^f, relative error about 2e-8. Valid for |x| < 126.
+    // Rounding goes through a positive offset so truncation acts as floor
+    // without a compare; the callers' pitches are far inside the range.
+    inline float fastExp2(float x)
+    {
+        const int n = static_cast<int>(x + 126.5f) - 126;
+        const float f = x - static_cast<float>(n);
+
+        const float p = 1.0f + f * (0.693147181f + f * (0.240226507f + f * (0.0555041087f
+                        + f * (0.00961812911f + f * (0.00133335581f + f * 0.000154035304f)))));
+        return p * bitsToFloat(static_cast<uint32_t>(n + 127) << 23);
+    }
+
+    // log2(x) = e + log2(m) with the mantissa m folded into
+    // [sqrt(1/2), sqrt(2)); log2(m) from the atanh series in
+    // t = (m - 1) / (m + 1), |t| < 0.172. The fold is decided on the integer
+    // mantissa bits so the loop stays free of branches.
+    inline float fastLog2(float x)
+    {
+        constexpr uint32_t mantissaMask = 0x007fffffu;
+        constexpr uint32_t sqrtTwoMantissa = 0x003504f3u;
+
+        const uint32_t bits = floatToBits(x);
+        const uint32_t mantissa = bits & mantissaMask;
+        const uint32_t fold = mantissa > sqrtTwoMantissa ? 1u : 0u;
+        const int e = static_cast<int>((bits >> 23) & 0xffu) - 127 + static_cast<int>(fold);
+        const float m = bitsToFloat(mantissa | (0x3f800000u - (fold << 23)));
+
+        const float t = (m - 1.0f) / (m + 1.0f);
+        const float t2 = t * t;
+        const float series = t * (2.88539008f + t2 * (0.961796694f + t2 * (0.577078016f
+                             + t2 * (0.412198583f + t2 * 0.320598898f))));
+        return static_cast<float>(e) + series;
+    }
+} // namespace
+
+namespace PitchConversion
+{
+    void exp2(const float* in, float* out, int count)
+    {
+        for (int i = 0; i < count; ++i)
+            out[i] = fastExp2(in[i]);
+    }
+
+    void log2(const float* in, float* out, int count)
+    {
+        for (int i = 0; i < count; ++i)
+            out[i] = fastLog2(in[i]);
+    }
+
+    void midiToFreq(const float* midi, float* freq, int count)
+    {
+        constexpr float octavesPerSemitone = 1.0f / 12.0f;
+        for (int i = 0; i < count; ++i)
+            freq[i] = FREQ_A4 * fastExp2((midi[i] - MIDI_A4) * octavesPerSemitone);
+    }
+
+    void freqToMidi(const float* freq, float* midi, int count)
+    {
+        for (int i = 0; i < count; ++i)
+        {
+            // Positive floats are exactly the positive signed bit patterns;
+            // other inputs give a finite value that is masked to 0
+            const int32_t bits = static_cast<int32_t>(floatToBits(freq[i]));
+            const float semitones = 12.0f * (fastLog2(freq[i]) - log2A4) + MIDI_A4;
+            const uint32_t keep = bits > 0 ? 0xffffffffu : 0u;
+            midi[i] = bitsToFloat(floatToBits(semitones) & keep);
+        }
+    }
+} // namespace PitchConversion
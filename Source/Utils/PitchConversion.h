@@ -0,0 +1,25 @@
+#pragma once
+
+/**
+ * Batch Hz/MIDI conversion for whole curves.
+ *
+ * midiToFreq() and freqToMidi() in Constants.h call std::pow/std::log2 per
+ * frame. These versions use polynomial exp2/log2 approximations (relative
+ * error below 1e-6, a few thousandths of a cent) written as plain
+ * branch-free loops, so the compiler vectorizes them. Every function accepts
+ * in == out for in-place conversion.
+ */
+namespace PitchConversion
+{
+    /** out[i] = 2^in[i] for |in[i]| < 126. */
+    void exp2(const float* in, float* out, int count);
+
+    /** out[i] = log2(in[i]) for positive, finite in[i]. */
+    void log2(const float* in, float* out, int count);
+
+    /** midiToFreq() over count values. */
+    void midiToFreq(const float* midi, float* freq, int count);
+
+    /** freqToMidi() over count values; non-positive frequencies give 0. */
+    void freqToMidi(const float* freq, float* midi, int count);
+} // namespace PitchConversion
@@ -1,23 +1,15 @@
 #include "PitchCurveProcessor.h"
 #include "BasePitchCurve.h"
 #include "../Utils/Constants.h"
+#include "PitchConversion.h"
+#include "Tracing.h"
 #include <algorithm>
 #include <cmath>
+#include <cstdint>
+#include <limits>
 
 namespace
 {
-    inline float safeMidiToFreq(float midi)
-    {
-        return midiToFreq(midi);
-    }
-
-    inline float safeFreqToMidi(float freq)
-    {
-        if (freq <= 0.0f)
-            return 0.0f;
-        return freqToMidi(freq);
-    }
-
     void ensureSizes(AudioData& audioData, int totalFrames)
     {
         if (totalFrames <= 0)
@@ -52,12 +44,44 @@ namespace
                   [](const auto& a, const auto& b) { return a.startFrame < b.startFrame; });
         return segments;
     }
+
+    // Frames the base pitch smoothing reaches past a note boundary
+    int smoothingPadFrames()
+    {
+        return static_cast<int>(std::ceil(BasePitchCurve::smoothWindowSec() * SAMPLE_RATE / HOP_SIZE));
+    }
+
+    // Base pitch for frames [genStart, genEnd). The step function inside the
+    // span depends on the notes overlapping it plus the nearest one beyond
+    // each side; segments must be sorted by start frame. Segments before
+    // firstSegment must all end by genStart.
+    std::vector<float> generateLocalBase(const std::vector<BasePitchCurve::NoteSegment>& segments,
+                                         int genStart, int genEnd, size_t firstSegment = 0)
+    {
+        std::vector<BasePitchCurve::NoteSegment> nearby;
+        for (size_t i = firstSegment; i < segments.size(); ++i)
+        {
+            const auto& seg = segments[i];
+            if (seg.endFrame <= genStart)
+            {
+                if (i + 1 < segments.size() && segments[i + 1].endFrame <= genStart)
+                    continue;
+            }
+            else if (seg.startFrame >= genEnd)
+            {
+                if (!nearby.empty() && nearby.back().startFrame >= genEnd)
+                    break;
+            }
+            nearby.push_back({ seg.startFrame - genStart, seg.endFrame - genStart, seg.midiNote });
+        }
+        return BasePitchCurve::generateForNotes(nearby, genEnd - genStart);
+    }
 } // namespace
 
 namespace PitchCurveProcessor
 {
     std::vector<float> interpolateWithUvMask(const std::vector<float>& pitchHz,
-                                             const std::vector<bool>& uvMask)
+                                             const VoicedMask& uvMask)
     {
         if (pitchHz.empty())
             return {};
@@ -67,11 +91,13 @@ namespace PitchCurveProcessor
         if (uvMask.empty())
             return dense;
 
+        // Only voiced frames are visited; unvoiced runs are skipped a word at a time
+        const int maskSize = std::min(n, static_cast<int>(uvMask.size()));
         int nextVoiced = -1;
         auto findNext = [&](int idx) -> int {
-            for (int i = idx; i < n; ++i)
+            for (int i = uvMask.findNext(idx, true); i < maskSize; i = uvMask.findNext(i + 1, true))
             {
-                if (uvMask[i] && pitchHz[i] > 0.0f)
+                if (pitchHz[static_cast<size_t>(i)] > 0.0f)
                     return i;
             }
             return -1;
@@ -129,6 +155,7 @@ namespace PitchCurveProcessor
     void rebuildCurvesFromSource(Project& project,
                                  const std::vector<float>& sourcePitchHz)
     {
+        TRACE_ZONE("PitchCurveProcessor::rebuildCurvesFromSource");
         auto& audioData = project.getAudioData();
         const int totalFrames = static_cast<int>(sourcePitchHz.size());
         ensureSizes(audioData, totalFrames);
@@ -143,29 +170,147 @@ namespace PitchCurveProcessor
         {
             // Fallback: derive base from source pitch directly
             audioData.basePitch.assign(static_cast<size_t>(totalFrames), 0.0f);
-            for (int i = 0; i < totalFrames; ++i)
-                audioData.basePitch[static_cast<size_t>(i)] = safeFreqToMidi(sourcePitchHz[i]);
+            PitchConversion::freqToMidi(sourcePitchHz.data(), audioData.basePitch.data(), totalFrames);
         }
 
         // Dense delta: midi(source) - base
         audioData.deltaPitch.assign(static_cast<size_t>(totalFrames), 0.0f);
+        PitchConversion::freqToMidi(sourcePitchHz.data(), audioData.deltaPitch.data(), totalFrames);
         for (int i = 0; i < totalFrames; ++i)
-        {
-            const float base = audioData.basePitch[static_cast<size_t>(i)];
-            const float midi = safeFreqToMidi(sourcePitchHz[i]);
-            audioData.deltaPitch[static_cast<size_t>(i)] = midi - base;
-        }
+            audioData.deltaPitch[static_cast<size_t>(i)] -= audioData.basePitch[static_cast<size_t>(i)];
 
         // Cache base F0 (Hz) for backwards compatibility
         audioData.baseF0.resize(static_cast<size_t>(totalFrames));
-        for (int i = 0; i < totalFrames; ++i)
-            audioData.baseF0[static_cast<size_t>(i)] = safeMidiToFreq(audioData.basePitch[static_cast<size_t>(i)]);
+        PitchConversion::midiToFreq(audioData.basePitch.data(), audioData.baseF0.data(), totalFrames);
 
         composeF0InPlace(project, /*applyUvMask=*/false);
     }
 
+    std::pair<int, int> getCurveRebuildRange(const Project& project,
+                                             int startFrame, int endFrame)
+    {
+        const int totalFrames = static_cast<int>(project.getAudioData().basePitch.size());
+        int first = 0;
+        int last = totalFrames;
+        for (const auto& note : project.getNotes())
+        {
+            if (note.isRest())
+                continue;
+            if (note.getEndFrame() <= startFrame)
+                first = std::max(first, note.getStartFrame());
+            else if (note.getStartFrame() >= endFrame)
+                last = std::min(last, note.getEndFrame());
+        }
+
+        const int pad = smoothingPadFrames();
+        return { std::max(0, first - pad), std::min(totalFrames, last + pad) };
+    }
+
+    void getOriginalPitchInRange(const Project& project, int startFrame, int endFrame,
+                                 float* out)
+    {
+        if (endFrame <= startFrame)
+            return;
+        std::fill(out, out + (endFrame - startFrame), 0.0f);
+
+        for (const auto& note : project.getNotes())
+        {
+            const auto& detected = note.getF0Values();
+            const int duration = note.getDurationFrames();
+            const int first = std::max(startFrame, note.getStartFrame());
+            const int last = std::min(endFrame, note.getEndFrame());
+            if (note.isRest() || detected.empty() || duration <= 0 || first >= last)
+                continue;
+
+            // The detected note pitch is the mean of its voiced frames, as
+            // segmentation computed it
+            double midiSum = 0.0;
+            int voiced = 0;
+            for (const float hz : detected)
+            {
+                if (hz > 0.0f)
+                {
+                    midiSum += freqToMidi(hz);
+                    ++voiced;
+                }
+            }
+            if (voiced == 0)
+                continue;
+            const float shift = note.getAdjustedMidiNote() - static_cast<float>(midiSum / voiced);
+            const float ratio = std::pow(2.0f, shift / 12.0f);
+
+            const int sourceLength = static_cast<int>(detected.size());
+            for (int i = first; i < last; ++i)
+            {
+                const int source = std::min(sourceLength - 1,
+                                            static_cast<int>(static_cast<int64_t>(i - note.getStartFrame())
+                                                             * sourceLength / duration));
+                out[i - startFrame] = detected[static_cast<size_t>(source)] * ratio;
+            }
+        }
+    }
+
+    std::pair<int, int> rebuildCurvesInRange(Project& project,
+                                             const std::vector<float>& sourcePitchHz,
+                                             int startFrame)
+    {
+        TRACE_ZONE("PitchCurveProcessor::rebuildCurvesInRange");
+        auto& audioData = project.getAudioData();
+        const int totalFrames = static_cast<int>(audioData.basePitch.size());
+        const int endFrame = startFrame + static_cast<int>(sourcePitchHz.size());
+        auto segments = collectNoteSegments(project.getNotes());
+
+        if (totalFrames == 0 || startFrame < 0 || endFrame > totalFrames
+            || audioData.deltaPitch.size() != static_cast<size_t>(totalFrames)
+            || audioData.f0.size() != static_cast<size_t>(totalFrames)
+            || segments.empty())
+        {
+            // No curves (or no notes) to patch: rebuild everything
+            auto source = audioData.f0;
+            source.resize(static_cast<size_t>(std::max(static_cast<int>(source.size()), endFrame)), 0.0f);
+            std::copy(sourcePitchHz.begin(), sourcePitchHz.end(),
+                      source.begin() + std::max(0, startFrame));
+            rebuildCurvesFromSource(project, source);
+            return { 0, static_cast<int>(source.size()) };
+        }
+
+        const auto range = getCurveRebuildRange(project, startFrame, endFrame);
+
+        // Generate past the range so its edges see the same smoothing
+        const int pad = smoothingPadFrames();
+        const int genStart = std::max(0, range.first - pad);
+        const int genEnd = std::min(totalFrames, range.second + pad);
+        const auto localBase = generateLocalBase(segments, genStart, genEnd);
+        if (localBase.size() != static_cast<size_t>(genEnd - genStart))
+            return { 0, 0 };
+
+        // Target pitch: the source inside the edit, the composed curve around it
+        const int count = range.second - range.first;
+        std::vector<float> midi(static_cast<size_t>(count));
+        for (int i = range.first; i < range.second; ++i)
+            midi[static_cast<size_t>(i - range.first)] =
+                audioData.basePitch[static_cast<size_t>(i)] + audioData.deltaPitch[static_cast<size_t>(i)];
+        const int sourceStart = std::max(startFrame, range.first);
+        const int sourceEnd = std::min(endFrame, range.second);
+        if (sourceEnd > sourceStart)
+            PitchConversion::freqToMidi(sourcePitchHz.data() + (sourceStart - startFrame),
+                                        midi.data() + (sourceStart - range.first),
+                                        sourceEnd - sourceStart);
+
+        audioData.baseF0.resize(static_cast<size_t>(totalFrames), 0.0f);
+        float* base = audioData.basePitch.data() + range.first;
+        float* delta = audioData.deltaPitch.data() + range.first;
+        std::copy_n(localBase.begin() + (range.first - genStart), count, base);
+        for (int i = 0; i < count; ++i)
+            delta[i] = midi[static_cast<size_t>(i)] - base[i];
+        PitchConversion::midiToFreq(base, audioData.baseF0.data() + range.first, count);
+        PitchConversion::midiToFreq(midi.data(), audioData.f0.data() + range.first, count);
+        return range;
+    }
+
     void rebuildBaseFromNotes(Project& project)
     {
+        TRACE_ZONE("PitchCurveProcessor::rebuildBaseFromNotes");
         auto& audioData = project.getAudioData();
         const int totalFrames = audioData.getNumFrames();
         ensureSizes(audioData, totalFrames);
@@ -186,32 +331,175 @@ namespace PitchCurveProcessor
 
         // Update cached baseF0
         audioData.baseF0.resize(static_cast<size_t>(totalFrames));
-        for (int i = 0; i < totalFrames; ++i)
-            audioData.baseF0[static_cast<size_t>(i)] = safeMidiToFreq(audioData.basePitch[static_cast<size_t>(i)]);
+        PitchConversion::midiToFreq(audioData.basePitch.data(), audioData.baseF0.data(), totalFrames);
 
         composeF0InPlace(project, /*applyUvMask=*/false);
     }
 
+    bool canRebuildInRange(const Project& project)
+    {
+        const auto& audioData = project.getAudioData();
+        const auto totalFrames = static_cast<size_t>(std::max(0, audioData.getNumFrames()));
+        if (totalFrames == 0
+            || audioData.basePitch.size() != totalFrames
+            || audioData.deltaPitch.size() != totalFrames
+            || audioData.f0.size() != totalFrames)
+            return false;
+
+        const auto& notes = project.getNotes();
+        return std::any_of(notes.begin(), notes.end(),
+                           [](const Note& note) { return !note.isRest(); });
+    }
+
+    std::pair<int, int> rebuildBaseInRange(Project& project,
+                                           int startFrame, int endFrame)
+    {
+        const auto rebuilt = rebuildBaseInRanges(project, { { startFrame, endFrame } });
+        return rebuilt.empty() ? std::pair<int, int> { 0, 0 } : rebuilt.front();
+    }
+
+    std::vector<std::pair<int, int>> rebuildBaseInRanges(Project& project,
+                                                         const std::vector<std::pair<int, int>>& ranges)
+    {
+        TRACE_ZONE("PitchCurveProcessor::rebuildBaseInRanges");
+        auto& audioData = project.getAudioData();
+        const int totalFrames = audioData.getNumFrames();
+        if (ranges.empty())
+            return {};
+        if (!canRebuildInRange(project))
+        {
+            rebuildBaseFromNotes(project);
+            return { { 0, std::max(0, totalFrames) } };
+        }
+        const auto segments = collectNoteSegments(project.getNotes());
+        const size_t numSegments = segments.size();
+
+        // Tables that answer getCurveRebuildRange() and the generateLocalBase()
+        // start in O(log n) per range, so many ranges cost one note pass
+        std::vector<int> suffixMinEnd(numSegments);
+        std::vector<int> prefixMaxEnd(numSegments);
+        for (size_t i = numSegments; i-- > 0;)
+            suffixMinEnd[i] = std::min(segments[i].endFrame,
+                                       i + 1 < numSegments ? suffixMinEnd[i + 1] : segments[i].endFrame);
+        for (size_t i = 0; i < numSegments; ++i)
+            prefixMaxEnd[i] = std::max(segments[i].endFrame, i > 0 ? prefixMaxEnd[i - 1] : segments[i].endFrame);
+        std::vector<std::pair<int, int>> byEnd;  // (end, start)
+        byEnd.reserve(numSegments);
+        for (const auto& seg : segments)
+            byEnd.emplace_back(seg.endFrame, seg.startFrame);
+        std::sort(byEnd.begin(), byEnd.end());
+        std::vector<int> prefixMaxStart(numSegments);
+        for (size_t i = 0; i < numSegments; ++i)
+            prefixMaxStart[i] = std::max(byEnd[i].second, i > 0 ? prefixMaxStart[i - 1] : byEnd[i].second);
+
+        // getCurveRebuildRange() of each range, merged where they touch
+        const int pad = smoothingPadFrames();
+        const int curveFrames = static_cast<int>(audioData.basePitch.size());
+        std::vector<std::pair<int, int>> spans;
+        spans.reserve(ranges.size());
+        for (const auto& [startFrame, endFrame] : ranges)
+        {
+            int first = 0;
+            const auto endedBefore = std::upper_bound(byEnd.begin(), byEnd.end(),
+                                                      std::make_pair(startFrame, std::numeric_limits<int>::max()));
+            if (endedBefore != byEnd.begin())
+                first = prefixMaxStart[static_cast<size_t>(endedBefore - byEnd.begin()) - 1];
+
+            int last = curveFrames;
+            const auto startsAfter = std::lower_bound(segments.begin(), segments.end(), endFrame,
+                                                      [](const auto& seg, int frame) { return seg.startFrame < frame; });
+            if (startsAfter != segments.end())
+                last = std::min(last, suffixMinEnd[static_cast<size_t>(startsAfter - segments.begin())]);
+
+            spans.emplace_back(std::max(0, first - pad), std::min(curveFrames, last + pad));
+        }
+        std::sort(spans.begin(), spans.end());
+        std::vector<std::pair<int, int>> merged;
+        for (const auto& span : spans)
+        {
+            if (!merged.empty() && span.first <= merged.back().second)
+                merged.back().second = std::max(merged.back().second, span.second);
+            else
+                merged.push_back(span);
+        }
+
+        std::vector<std::pair<int, int>> rebuilt;
+        rebuilt.reserve(merged.size());
+        audioData.baseF0.resize(static_cast<size_t>(totalFrames), 0.0f);
+        for (const auto& range : merged)
+        {
+            const int genStart = std::max(0, range.first - pad);
+            const int genEnd = std::min(totalFrames, range.second + pad);
+            const size_t firstSegment = static_cast<size_t>(
+                std::upper_bound(prefixMaxEnd.begin(), prefixMaxEnd.end(), genStart) - prefixMaxEnd.begin());
+            const auto localBase = generateLocalBase(segments, genStart, genEnd,
+                                                     firstSegment > 0 ? firstSegment - 1 : 0);
+            if (localBase.size() != static_cast<size_t>(genEnd - genStart))
+                continue;
+
+            // Same composition as composeF0InPlace(project, false), range only
+            const int count = range.second - range.first;
+            float* base = audioData.basePitch.data() + range.first;
+            const float* delta = audioData.deltaPitch.data() + range.first;
+            float* f0 = audioData.f0.data() + range.first;
+            std::copy_n(localBase.begin() + (range.first - genStart), count, base);
+            for (int i = 0; i < count; ++i)
+                f0[i] = base[i] + delta[i];
+
+            PitchConversion::midiToFreq(base, audioData.baseF0.data() + range.first, count);
+            PitchConversion::midiToFreq(f0, f0, count);
+            rebuilt.push_back(range);
+        }
+        return rebuilt;
+    }
+
+    std::vector<float> computeBaseInRange(const Project& project, int startFrame, int endFrame,
+                                          std::pair<int, int>& span)
+    {
+        span = { 0, 0 };
+        if (!canRebuildInRange(project))
+            return {};
+
+        // As rebuildBaseInRanges() does for a single range
+        const int totalFrames = project.getAudioData().getNumFrames();
+        const auto range = getCurveRebuildRange(project, startFrame, endFrame);
+        const int pad = smoothingPadFrames();
+        const int genStart = std::max(0, range.first - pad);
+        const int genEnd = std::min(totalFrames, range.second + pad);
+        const auto localBase = generateLocalBase(collectNoteSegments(project.getNotes()),
+                                                 genStart, genEnd);
+        if (range.second <= range.first || localBase.size() != static_cast<size_t>(genEnd - genStart))
+            return {};
+
+        span = range;
+        return std::vector<float>(localBase.begin() + (range.first - genStart),
+                                  localBase.begin() + (range.second - genStart));
+    }
+
     std::vector<float> composeF0(const Project& project,
                                  bool applyUvMask,
                                  float globalPitchOffset)
     {
+        TRACE_ZONE("PitchCurveProcessor::composeF0");
         const auto& audioData = project.getAudioData();
         const int totalFrames = static_cast<int>(audioData.basePitch.size());
         std::vector<float> result(static_cast<size_t>(totalFrames), 0.0f);
 
-        for (int i = 0; i < totalFrames; ++i)
+        const float* base = audioData.basePitch.data();
+        const float* delta = audioData.deltaPitch.data();
+        const int deltaEnd = std::min(totalFrames, static_cast<int>(audioData.deltaPitch.size()));
+        for (int i = 0; i < deltaEnd; ++i)
+            result[static_cast<size_t>(i)] = base[i] + delta[i] + globalPitchOffset;
+        for (int i = deltaEnd; i < totalFrames; ++i)
+            result[static_cast<size_t>(i)] = base[i] + globalPitchOffset;
+        PitchConversion::midiToFreq(result.data(), result.data(), totalFrames);
+
+        // Frames past the mask count as voiced
+        if (applyUvMask)
         {
-            bool isVoiced = (i < static_cast<int>(audioData.voicedMask.size())) ? audioData.voicedMask[i] : true;
-            if (applyUvMask && !isVoiced)
-                continue;
-
-            const float base = audioData.basePitch[static_cast<size_t>(i)];
-            const float delta = (i < static_cast<int>(audioData.deltaPitch.size()))
-                                    ? audioData.deltaPitch[static_cast<size_t>(i)]
-                                    : 0.0f;
-            const float midi = base + delta + globalPitchOffset;
-            result[static_cast<size_t>(i)] = safeMidiToFreq(midi);
+            const int maskEnd = std::min(totalFrames, static_cast<int>(audioData.voicedMask.size()));
+            for (int i = 0; i < maskEnd; ++i)
+                result[static_cast<size_t>(i)] *= static_cast<float>(audioData.voicedMask[static_cast<size_t>(i)]);
         }
 
         return result;
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "../Models/Project.h"
+#include <utility>
 #include <vector>
 
 namespace PitchCurveProcessor
@@ -10,7 +11,7 @@ namespace PitchCurveProcessor
      * Returns a dense pitch (Hz) array with the same length as the input.
      */
     std::vector<float> interpolateWithUvMask(const std::vector<float>& pitchHz,
-                                             const std::vector<bool>& uvMask);
+                                             const VoicedMask& uvMask);
 
     /**
      * Rebuild base pitch (midi) from current notes and keep existing delta.
@@ -19,6 +20,40 @@ namespace PitchCurveProcessor
      */
     void rebuildBaseFromNotes(Project& project);
 
+    /**
+     * True when the curves are aligned to the project frames and there are
+     * notes, so rebuildBaseInRange() patches only its range.
+     */
+    bool canRebuildInRange(const Project& project);
+
+    /**
+     * Range version of rebuildBaseFromNotes after the notes within frames
+     * [startFrame, endFrame) changed pitch, or moved inside that span.
+     * Base pitch is regenerated over getCurveRebuildRange() only; delta is
+     * kept and basePitch, baseF0 and f0 are patched there. Falls back to a
+     * full rebuild when the curves are not aligned to the project.
+     * Returns the rewritten [start, end) frames.
+     */
+    std::pair<int, int> rebuildBaseInRange(Project& project,
+                                           int startFrame, int endFrame);
+
+    /**
+     * rebuildBaseInRange() for many changed ranges at once, as after a bulk
+     * note edit. Notes are collected once and the rebuild spans of touching
+     * ranges are merged, so each frame is regenerated at most once. Returns
+     * the rewritten spans, sorted and disjoint.
+     */
+    std::vector<std::pair<int, int>> rebuildBaseInRanges(Project& project,
+                                                         const std::vector<std::pair<int, int>>& ranges);
+
+    /**
+     * The base pitch (midi) rebuildBaseInRange() would write for the same
+     * change, leaving the project untouched. Sets span to the frames it
+     * covers; empty when canRebuildInRange() is false.
+     */
+    std::vector<float> computeBaseInRange(const Project& project, int startFrame, int endFrame,
+                                          std::pair<int, int>& span);
+
     /**
      * Rebuild base and delta from a source pitch (Hz). This is used after
      * detection/segmentation or when we need to recompute delta from edited
@@ -27,6 +62,35 @@ namespace PitchCurveProcessor
     void rebuildCurvesFromSource(Project& project,
                                  const std::vector<float>& sourcePitchHz);
 
+    /**
+     * Frames whose curves rebuildCurvesInRange() rewrites for a change to
+     * [startFrame, endFrame): from the last note ending before the range to
+     * the first note starting after it, padded by the smoothing window.
+     */
+    std::pair<int, int> getCurveRebuildRange(const Project& project,
+                                             int startFrame, int endFrame);
+
+    /**
+     * Detected pitch (Hz) of frames [startFrame, endFrame) as the notes carry
+     * it now: each note's F0 values, stretched onto its output span and moved
+     * by as much as the note was moved from its detected pitch. Frames without
+     * a non-rest note, or unvoiced when detected, are 0. Writes
+     * endFrame - startFrame values to out.
+     */
+    void getOriginalPitchInRange(const Project& project, int startFrame, int endFrame,
+                                 float* out);
+
+    /**
+     * Range version of rebuildCurvesFromSource after the notes and uv mask
+     * of frames [startFrame, startFrame + sourcePitchHz.size()) changed.
+     * Base pitch is regenerated over getCurveRebuildRange() from the notes
+     * around it; delta follows sourcePitchHz inside the range and keeps the
+     * composed pitch outside it. Returns the rewritten [start, end) frames.
+     */
+    std::pair<int, int> rebuildCurvesInRange(Project& project,
+                                             const std::vector<float>& sourcePitchHz,
+                                             int startFrame);
+
     /**
      * Compose f0 (Hz) from base + delta + optional global offset.
      * When applyUvMask is true, frames marked unvoiced are forced to 0 for
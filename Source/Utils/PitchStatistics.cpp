@@ -0,0 +1,251 @@
+#include "PitchStatistics.h"
+#include "Constants.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    // Krumhansl-Kessler key profiles, tonic first
+    constexpr float majorProfile[12] = { 6.35f, 2.23f, 3.48f, 2.33f, 4.38f, 4.09f,
+                                         2.52f, 5.19f, 2.39f, 3.66f, 2.29f, 2.88f };
+    constexpr float minorProfile[12] = { 6.33f, 2.68f, 3.52f, 5.38f, 2.60f, 3.53f,
+                                         2.54f, 4.75f, 3.98f, 2.69f, 3.34f, 3.17f };
+
+    // Pearson correlation of chroma, rotated to tonic key, with profile
+    float correlate(const double* chroma, const float* profile, int key)
+    {
+        double meanChroma = 0.0, meanProfile = 0.0;
+        for (int i = 0; i < 12; ++i)
+        {
+            meanChroma += chroma[i];
+            meanProfile += profile[i];
+        }
+        meanChroma /= 12.0;
+        meanProfile /= 12.0;
+
+        double covariance = 0.0, chromaVariance = 0.0, profileVariance = 0.0;
+        for (int i = 0; i < 12; ++i)
+        {
+            const double c = chroma[(i + key) % 12] - meanChroma;
+            const double p = profile[i] - meanProfile;
+            covariance += c * p;
+            chromaVariance += c * c;
+            profileVariance += p * p;
+        }
+        const double denominator = std::sqrt(chromaVariance * profileVariance);
+        return denominator > 0.0 ? static_cast<float>(covariance / denominator) : 0.0f;
+    }
+} // namespace
+
+void PitchStatistics::Sums::add(double frame, double cents, int sign)
+{
+    count += sign;
+    t += sign * frame;
+    tt += sign * frame * frame;
+    x += sign * cents;
+    xx += sign * cents * cents;
+    tx += sign * frame * cents;
+}
+
+void PitchStatistics::setProject(Project* newProject)
+{
+    noteSubscription.reset();
+    curveSubscription.reset();
+    project = newProject;
+    needsFullCount = true;
+    dirtyRanges.clear();
+    if (!project)
+        return;
+
+    noteSubscription = project->getNoteChanges().subscribe([this](const std::vector<NoteChange>& changes) {
+        for (const auto& change : changes)
+        {
+            if (change.type == NoteChange::Type::Reset)
+                needsFullCount = true;
+            else
+                markDirty(change.startFrame, change.endFrame);
+        }
+    });
+    curveSubscription = project->getCurveChanges().subscribe([this](const std::vector<NoteChange>& changes) {
+        for (const auto& change : changes)
+            markDirty(change.startFrame, change.endFrame);
+    });
+}
+
+void PitchStatistics::markDirty(int startFrame, int endFrame)
+{
+    if (needsFullCount || endFrame <= startFrame)
+        return;
+
+    // Merge with every range it overlaps or touches
+    auto first = std::lower_bound(dirtyRanges.begin(), dirtyRanges.end(), startFrame,
+                                  [](const std::pair<int, int>& range, int frame) { return range.second < frame; });
+    auto last = first;
+    while (last != dirtyRanges.end() && last->first <= endFrame)
+    {
+        startFrame = std::min(startFrame, last->first);
+        endFrame = std::max(endFrame, last->second);
+        ++last;
+    }
+    first = dirtyRanges.erase(first, last);
+    dirtyRanges.insert(first, { startFrame, endFrame });
+}
+
+void PitchStatistics::update()
+{
+    if (!project)
+        return;
+
+    const int numFrames = static_cast<int>(project->getAudioData().basePitch.size());
+    if (numFrames != static_cast<int>(countedMidi.size()))
+        needsFullCount = true;
+
+    if (needsFullCount)
+    {
+        countedMidi.assign(static_cast<size_t>(numFrames), -1.0f);
+        countedCents.assign(static_cast<size_t>(numFrames), 0.0f);
+        countedNote.assign(static_cast<size_t>(numFrames), 0);
+        histogram.fill(0);
+        voicedFrames = 0;
+        noteSums.clear();
+        histogramChanged = true;
+        dirtyRanges.assign(1, { 0, numFrames });
+        needsFullCount = false;
+    }
+
+    for (const auto& [start, end] : dirtyRanges)
+        recount(std::max(0, start), std::min(end, numFrames));
+    dirtyRanges.clear();
+
+    if (std::exchange(histogramChanged, false))
+        estimateKey();
+}
+
+void PitchStatistics::uncount(int frame)
+{
+    const auto i = static_cast<size_t>(frame);
+    if (countedMidi[i] < 0.0f)
+        return;
+
+    const int bin = std::clamp(static_cast<int>(countedMidi[i] * binsPerSemitone), 0, numBins - 1);
+    --histogram[static_cast<size_t>(bin)];
+    --voicedFrames;
+    histogramChanged = true;
+    if (countedNote[i] != 0)
+    {
+        const auto sums = noteSums.find(countedNote[i]);
+        if (sums != noteSums.end())
+        {
+            sums->second.add(frame, countedCents[i], -1);
+            // Starting a note over avoids carrying rounding into its next counts
+            if (sums->second.count <= 0)
+                noteSums.erase(sums);
+        }
+    }
+    countedMidi[i] = -1.0f;
+    countedNote[i] = 0;
+}
+
+void PitchStatistics::recount(int startFrame, int endFrame)
+{
+    if (startFrame >= endFrame)
+        return;
+
+    for (int frame = startFrame; frame < endFrame; ++frame)
+        uncount(frame);
+
+    // Owner and target pitch of each frame; overlaps go to the later note
+    const auto count = static_cast<size_t>(endFrame - startFrame);
+    std::vector<NoteId> owners(count, 0);
+    std::vector<float> targets(count, 0.0f);
+    for (auto* note : project->getNotesInRange(startFrame, endFrame))
+    {
+        if (note->isRest())
+            continue;
+        const NoteId id = project->getNoteId(*note);
+        const int from = std::max(note->getStartFrame(), startFrame);
+        const int to = std::min(note->getEndFrame(), endFrame);
+        for (int frame = from; frame < to; ++frame)
+        {
+            owners[static_cast<size_t>(frame - startFrame)] = id;
+            targets[static_cast<size_t>(frame - startFrame)] = note->getAdjustedMidiNote();
+        }
+    }
+
+    const auto& audioData = project->getAudioData();
+    const auto& base = audioData.basePitch;
+    const auto& delta = audioData.deltaPitch;
+    const auto& voiced = audioData.voicedMask;
+    for (int frame = startFrame; frame < endFrame; ++frame)
+    {
+        const auto i = static_cast<size_t>(frame);
+        if (i < voiced.size() && !voiced[i])
+            continue;
+        const float midi = base[i] + (i < delta.size() ? delta[i] : 0.0f);
+        if (!(midi > 0.0f))
+            continue;
+
+        countedMidi[i] = midi;
+        const int bin = std::clamp(static_cast<int>(midi * binsPerSemitone), 0, numBins - 1);
+        ++histogram[static_cast<size_t>(bin)];
+        ++voicedFrames;
+        histogramChanged = true;
+
+        const NoteId owner = owners[i - static_cast<size_t>(startFrame)];
+        if (owner == 0)
+            continue;
+        const float cents = 100.0f * (midi - targets[i - static_cast<size_t>(startFrame)]);
+        countedNote[i] = owner;
+        countedCents[i] = cents;
+        noteSums[owner].add(frame, cents, 1);
+    }
+}
+
+PitchStatistics::NoteStats PitchStatistics::getNoteStats(NoteId id) const
+{
+    NoteStats stats;
+    const auto found = noteSums.find(id);
+    if (found == noteSums.end() || found->second.count <= 0)
+        return stats;
+
+    const auto& sums = found->second;
+    const double n = sums.count;
+    const double mean = sums.x / n;
+    stats.frames = sums.count;
+    stats.meanCents = static_cast<float>(mean);
+    stats.varianceCents = static_cast<float>(std::max(0.0, sums.xx / n - mean * mean));
+
+    const double spread = n * sums.tt - sums.t * sums.t;
+    if (sums.count > 1 && spread > 0.0)
+    {
+        const double centsPerFrame = (n * sums.tx - sums.t * sums.x) / spread;
+        stats.driftCentsPerSecond = static_cast<float>(centsPerFrame * SAMPLE_RATE / HOP_SIZE);
+    }
+    return stats;
+}
+
+void PitchStatistics::estimateKey()
+{
+    // Fold the bins into pitch classes by their nearest semitone
+    double chroma[12] = {};
+    for (int bin = 0; bin < numBins; ++bin)
+    {
+        const int semitone = (bin + binsPerSemitone / 2) / binsPerSemitone;
+        chroma[semitone % 12] += histogram[static_cast<size_t>(bin)];
+    }
+
+    keyEstimate = {};
+    if (voicedFrames == 0)
+        return;
+
+    keyEstimate.confidence = -1.0f;
+    for (int key = 0; key < 12; ++key)
+    {
+        for (const auto mode : { ScaleCorrection::Mode::Major, ScaleCorrection::Mode::NaturalMinor })
+        {
+            const float score = correlate(chroma, mode == ScaleCorrection::Mode::Major ? majorProfile : minorProfile, key);
+            if (score > keyEstimate.confidence)
+                keyEstimate = { key, mode, score };
+        }
+    }
+}
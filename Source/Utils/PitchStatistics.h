@@ -0,0 +1,95 @@
+#pragma once
+
+#include "../Models/NoteChangeFeed.h"
+#include "../Models/Project.h"
+#include "ScaleCorrection.h"
+#include <array>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/**
+ * Running statistics of the sung pitch of a project: a histogram of the
+ * voiced frames, the accuracy of every note and an estimate of the key.
+ *
+ * The pitch of a frame is basePitch + deltaPitch, so the global offset and
+ * vibrato do not count. Note and curve changes only mark their frames;
+ * update() takes the counts of those frames out and puts the new ones in,
+ * so an edit costs the frames it touched and every query is O(1). The key
+ * is re-estimated from the histogram when it changed, which costs the bins,
+ * not the frames.
+ *
+ * Message thread only, like the project's change feeds.
+ */
+class PitchStatistics
+{
+public:
+    static constexpr int binsPerSemitone = 10;   // 10 cents per bin
+    static constexpr int numBins = 128 * binsPerSemitone;
+
+    struct NoteStats
+    {
+        int frames = 0;                   // Voiced frames inside the note
+        float meanCents = 0.0f;           // Sung pitch against the note's pitch
+        float varianceCents = 0.0f;       // In cents squared
+        float driftCentsPerSecond = 0.0f; // Slope of a line through the frames
+    };
+
+    struct KeyEstimate
+    {
+        int key = 0;                                 // Pitch class of the tonic, 0 = C
+        ScaleCorrection::Mode mode = ScaleCorrection::Mode::Major; // Major or NaturalMinor
+        float confidence = 0.0f;                     // Correlation with the key profile, -1 to 1
+    };
+
+    PitchStatistics() = default;
+
+    /** Follow project's edits (null to stop); counted in full on the next update(). */
+    void setProject(Project* project);
+
+    /** Count the frames edited since the last update. */
+    void update();
+
+    /** Voiced frames per bin; bin b holds pitches in [b, b + 1) / binsPerSemitone. */
+    const std::array<int, numBins>& getHistogram() const { return histogram; }
+    int getNumVoicedFrames() const { return voicedFrames; }
+
+    /** Statistics of a non-rest note; frames is 0 if none of it is voiced. */
+    NoteStats getNoteStats(NoteId id) const;
+
+    /** The major or minor key whose profile best matches the histogram. */
+    const KeyEstimate& getKeyEstimate() const { return keyEstimate; }
+
+private:
+    // Sums over a note's counted frames of t (frame), x (cents) and products
+    struct Sums
+    {
+        int count = 0;
+        double t = 0.0, tt = 0.0, x = 0.0, xx = 0.0, tx = 0.0;
+
+        void add(double frame, double cents, int sign);
+    };
+
+    void markDirty(int startFrame, int endFrame);
+    void recount(int startFrame, int endFrame);
+    void uncount(int frame);
+    void estimateKey();
+
+    Project* project = nullptr;
+    NoteChangeFeed::Subscription noteSubscription;
+    NoteChangeFeed::Subscription curveSubscription;
+
+    bool needsFullCount = true;
+    std::vector<std::pair<int, int>> dirtyRanges; // Sorted, disjoint
+
+    // What each frame contributes now, so its count can be taken out again
+    std::vector<float> countedMidi; // Negative when the frame is not counted
+    std::vector<float> countedCents;
+    std::vector<NoteId> countedNote; // 0 outside non-rest notes
+
+    std::array<int, numBins> histogram {};
+    int voicedFrames = 0;
+    std::unordered_map<NoteId, Sums> noteSums;
+    bool histogramChanged = true;
+    KeyEstimate keyEstimate;
+};
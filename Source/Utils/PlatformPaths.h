@@ -9,16 +9,19 @@
  *   - Models: App.app/Contents/Resources/models/
  *   - Logs: ~/Library/Logs/HachiTune/
  *   - Config: ~/Library/Application Support/HachiTune/
+ *   - Cache: ~/Library/Caches/HachiTune/
  *
  * Windows:
  *   - Models: <exe_dir>/models/
  *   - Logs: %APPDATA%/HachiTune/Logs/
  *   - Config: %APPDATA%/HachiTune/
+ *   - Cache: %APPDATA%/HachiTune/Cache/
  *
  * Linux:
  *   - Models: <exe_dir>/models/
  *   - Logs: ~/.config/HachiTune/logs/
  *   - Config: ~/.config/HachiTune/
+ *   - Cache: ~/.cache/HachiTune/
  */
 namespace PlatformPaths
 {
@@ -60,6 +63,23 @@ namespace PlatformPaths
                    .getChildFile("HachiTune");
     }
 
+    inline juce::File getCacheDirectory()
+    {
+    #if JUCE_MAC
+        // macOS: ~/Library/Caches/HachiTune/
+        return juce::File::getSpecialLocation(juce::File::userHomeDirectory)
+                   .getChildFile("Library/Caches/HachiTune");
+    #elif JUCE_WINDOWS
+        // Windows: %APPDATA%/HachiTune/Cache/
+        return juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory)
+                   .getChildFile("HachiTune/Cache");
+    #else
+        // Linux: ~/.cache/HachiTune/
+        return juce::File::getSpecialLocation(juce::File::userHomeDirectory)
+                   .getChildFile(".cache/HachiTune");
+    #endif
+    }
+
     inline juce::File getLogFile(const juce::String& name)
     {
         auto logsDir = getLogsDirectory();
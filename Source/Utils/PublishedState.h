@@ -0,0 +1,121 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+/**
+ * Latest-value mailbox from the audio thread to the message thread.
+ *
+ * A sequence lock over a small trivially copyable struct: publish() never
+ * blocks, allocates or posts a message, and the UI polls with
+ * readIfChanged() at display rate instead of receiving one callAsync per
+ * audio block. Intermediate values are overwritten, never queued.
+ *
+ * The state is stored as atomic words, so a torn read is detected (and
+ * retried) rather than being a data race. If two threads publish at the
+ * same time, the one that loses is dropped; the next publish carries the
+ * newer value anyway.
+ */
+template <typename State>
+class PublishedState
+{
+public:
+    static_assert(std::is_trivially_copyable<State>::value,
+                  "PublishedState needs a trivially copyable state");
+
+    PublishedState()
+    {
+        store(State{});
+    }
+
+    explicit PublishedState(const State& initial)
+    {
+        store(initial);
+    }
+
+    /**
+     * Make state the latest value. Wait-free; returns false if another
+     * publish was in progress and this value was dropped.
+     */
+    bool publish(const State& state)
+    {
+        uint64_t seq = sequence.load(std::memory_order_relaxed);
+        if ((seq & 1) != 0 ||
+            !sequence.compare_exchange_strong(seq, seq + 1, std::memory_order_relaxed))
+            return false;
+        std::atomic_thread_fence(std::memory_order_release);
+
+        store(state);
+        sequence.store(seq + 2, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Copy the latest value into out if it was published after the version
+     * in lastSeenVersion (0 reads the current value), and update
+     * lastSeenVersion. Returns false when nothing new is available, or when a
+     * publish kept overlapping the read; the next poll picks it up.
+     */
+    bool readIfChanged(State& out, uint64_t& lastSeenVersion) const
+    {
+        for (int attempt = 0; attempt < maxReadAttempts; ++attempt)
+        {
+            const uint64_t before = sequence.load(std::memory_order_acquire);
+            if ((before & 1) != 0)
+                continue;
+            if (before / 2 + 1 == lastSeenVersion)
+                return false;
+
+            uint64_t buffer[numWords];
+            for (size_t i = 0; i < numWords; ++i)
+                buffer[i] = words[i].load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+
+            if (sequence.load(std::memory_order_relaxed) == before)
+            {
+                std::memcpy(&out, buffer, sizeof(State));
+                lastSeenVersion = before / 2 + 1;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * Version of the latest complete publish, in the numbering readIfChanged()
+     * uses; start a reader from here to skip the values already published.
+     */
+    uint64_t getVersion() const
+    {
+        return sequence.load(std::memory_order_acquire) / 2 + 1;
+    }
+
+    /** The latest value, whether or not it was seen before. */
+    State read() const
+    {
+        State state{};
+        uint64_t version = 0;
+        while (!readIfChanged(state, version))
+        {
+        }
+        return state;
+    }
+
+private:
+    static constexpr size_t numWords = (sizeof(State) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+    static constexpr int maxReadAttempts = 8;
+
+    void store(const State& state)
+    {
+        uint64_t buffer[numWords] = {};
+        std::memcpy(buffer, &state, sizeof(State));
+        for (size_t i = 0; i < numWords; ++i)
+            words[i].store(buffer[i], std::memory_order_relaxed);
+    }
+
+    // Even while stable; odd while a publish is writing the words
+    std::atomic<uint64_t> sequence{0};
+    std::atomic<uint64_t> words[numWords];
+};
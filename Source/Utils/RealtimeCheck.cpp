@@ -0,0 +1,343 @@
+#include "RealtimeCheck.h"
+
+#ifdef HACHITUNE_REALTIME_CHECKS
+
+#include "AppLogger.h"
+#include <array>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#if JUCE_WINDOWS
+#include <windows.h>
+#else
+#include <execinfo.h>
+#endif
+
+#if JUCE_MAC
+#include <mach/mach.h>
+#include <malloc/malloc.h>
+#endif
+
+#if defined(__GLIBC__)
+extern "C" {
+void *__libc_malloc(std::size_t size);
+void *__libc_calloc(std::size_t count, std::size_t size);
+void *__libc_realloc(void *memory, std::size_t size);
+void __libc_free(void *memory);
+}
+// Dynamic TLS may allocate on first use, from inside malloc()
+#define REALTIME_CHECK_TLS_ __attribute__((tls_model("initial-exec")))
+#else
+#define REALTIME_CHECK_TLS_
+#endif
+
+namespace {
+// Constant-initialised, so usable from operator new and malloc() on any
+// thread
+thread_local const char *currentScope REALTIME_CHECK_TLS_ = nullptr;
+thread_local int suspendDepth REALTIME_CHECK_TLS_ = 0;
+
+std::atomic<uint64_t> numViolations{0};
+std::atomic<bool> breakOnViolation{false};
+// Set once malloc() and free() are seen to report for themselves (see
+// below); until then operator new and delete do
+std::atomic<bool> mallocReports{false};
+
+// Sites reported so far; once full, new sites are counted but not logged
+constexpr size_t numSiteSlots = 1024;
+constexpr size_t maxProbes = 16;
+std::array<std::atomic<uint64_t>, numSiteSlots> reportedSites{};
+
+const char *violationName(RealtimeCheck::Violation violation) {
+  switch (violation) {
+  case RealtimeCheck::Violation::Allocation:
+    return "allocation";
+  case RealtimeCheck::Violation::Deallocation:
+    return "deallocation";
+  case RealtimeCheck::Violation::Lock:
+    return "lock";
+  case RealtimeCheck::Violation::MessagePost:
+    return "message post";
+  }
+  return "violation";
+}
+
+// Identifies a site by the innermost frames of its stack, since the direct
+// caller of operator new is mostly the same few std::allocator functions
+uint64_t hashStack() {
+  constexpr int maxFrames = 12;
+  void *frames[maxFrames];
+#if JUCE_WINDOWS
+  const int numFrames = RtlCaptureStackBackTrace(0, maxFrames, frames, nullptr);
+#else
+  const int numFrames = backtrace(frames, maxFrames);
+#endif
+  uint64_t hash = 14695981039346656037ull;
+  for (int i = 0; i < numFrames; ++i) {
+    hash ^= static_cast<uint64_t>(reinterpret_cast<uintptr_t>(frames[i]));
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+// True the first time violation is seen from this stack in scope
+bool claimSite(RealtimeCheck::Violation violation, const char *scope) {
+  uint64_t key = hashStack();
+  key ^= static_cast<uint64_t>(reinterpret_cast<uintptr_t>(scope)) * 31u;
+  key = key * 4 + static_cast<uint64_t>(violation);
+  key = key * 0x9e3779b97f4a7c15ull | 1u; // Never the empty slot
+  for (size_t probe = 0; probe < maxProbes; ++probe) {
+    auto &slot = reportedSites[(key + probe) % numSiteSlots];
+    uint64_t expected = 0;
+    if (slot.compare_exchange_strong(expected, key))
+      return true;
+    if (expected == key)
+      return false;
+  }
+  return false;
+}
+
+struct Suspend {
+  Suspend() { ++suspendDepth; }
+  ~Suspend() { --suspendDepth; }
+};
+} // namespace
+
+namespace RealtimeCheck {
+bool isEnabled() { return true; }
+
+uint64_t getNumViolations() { return numViolations.load(); }
+
+void setBreakOnViolation(bool shouldBreak) { breakOnViolation = shouldBreak; }
+
+void report(Violation violation) {
+  const char *scope = currentScope;
+  if (scope == nullptr || suspendDepth > 0)
+    return;
+  numViolations.fetch_add(1, std::memory_order_relaxed);
+  // The first backtrace() may load the unwinder, which allocates
+  const Suspend suspend;
+  if (!claimSite(violation, scope))
+    return;
+
+  // Slow, and allocates, but only once per site
+  const auto message = juce::String("Real-time violation: ") +
+                       violationName(violation) + " in " + scope + "\n" +
+                       juce::SystemStats::getStackBacktrace();
+  DBG(message);
+  AppLogger::log(AppLogger::Level::Warning, message);
+  if (breakOnViolation.load())
+    jassertfalse;
+}
+
+bool callAsync(std::function<void()> callback) {
+  report(Violation::MessagePost);
+  // The message's own allocation is part of the same post
+  const Suspend suspend;
+  return juce::MessageManager::callAsync(std::move(callback));
+}
+
+Scope::Scope(const char *scopeName, bool enabled) : previous(currentScope) {
+  if (enabled)
+    currentScope = scopeName;
+}
+
+Scope::~Scope() { currentScope = previous; }
+
+Allowed::Allowed(const char *) { ++suspendDepth; }
+
+Allowed::~Allowed() { --suspendDepth; }
+
+void Mutex::lock() {
+  report(Violation::Lock);
+  std::mutex::lock();
+}
+
+void CriticalSection::enter() const noexcept {
+  report(Violation::Lock);
+  juce::CriticalSection::enter();
+}
+} // namespace RealtimeCheck
+
+// The C allocation functions, which juce::HeapBlock (so AudioBuffer) and C
+// libraries such as ONNX Runtime call directly. aligned_alloc() and
+// posix_memalign() are left alone. Windows has no such hook
+#if defined(__GLIBC__)
+// glibc keeps its own under other names, so these replace it wherever the
+// executable's symbols bind first: everywhere in the app, but not in a
+// plugin, whose host has bound malloc() already
+extern "C" {
+void *malloc(std::size_t size) noexcept {
+  // Reached at all, so this is the process's malloc()
+  if (!mallocReports.load(std::memory_order_relaxed))
+    mallocReports.store(true, std::memory_order_relaxed);
+  RealtimeCheck::report(RealtimeCheck::Violation::Allocation);
+  return __libc_malloc(size);
+}
+
+void *calloc(std::size_t count, std::size_t size) noexcept {
+  RealtimeCheck::report(RealtimeCheck::Violation::Allocation);
+  return __libc_calloc(count, size);
+}
+
+void *realloc(void *memory, std::size_t size) noexcept {
+  // realloc(p, 0) may free p; either way the heap is touched
+  RealtimeCheck::report(memory != nullptr && size == 0
+                            ? RealtimeCheck::Violation::Deallocation
+                            : RealtimeCheck::Violation::Allocation);
+  return __libc_realloc(memory, size);
+}
+
+void free(void *memory) noexcept {
+  if (memory != nullptr)
+    RealtimeCheck::report(RealtimeCheck::Violation::Deallocation);
+  __libc_free(memory);
+}
+}
+#elif JUCE_MAC
+// dyld interposing skips the image that asks for it, which JUCE is part of,
+// so the default zone's functions are swapped instead; this reaches every
+// image in the process, a plugin's included
+namespace {
+struct ZoneFunctions {
+  void *(*malloc)(malloc_zone_t *, std::size_t);
+  void *(*calloc)(malloc_zone_t *, std::size_t, std::size_t);
+  void *(*realloc)(malloc_zone_t *, void *, std::size_t);
+  void (*free)(malloc_zone_t *, void *);
+};
+ZoneFunctions originalZone{};
+
+void *zoneMalloc(malloc_zone_t *zone, std::size_t size) {
+  RealtimeCheck::report(RealtimeCheck::Violation::Allocation);
+  return originalZone.malloc(zone, size);
+}
+
+void *zoneCalloc(malloc_zone_t *zone, std::size_t count, std::size_t size) {
+  RealtimeCheck::report(RealtimeCheck::Violation::Allocation);
+  return originalZone.calloc(zone, count, size);
+}
+
+void *zoneRealloc(malloc_zone_t *zone, void *memory, std::size_t size) {
+  RealtimeCheck::report(memory != nullptr && size == 0
+                            ? RealtimeCheck::Violation::Deallocation
+                            : RealtimeCheck::Violation::Allocation);
+  return originalZone.realloc(zone, memory, size);
+}
+
+void zoneFree(malloc_zone_t *zone, void *memory) {
+  if (memory != nullptr)
+    RealtimeCheck::report(RealtimeCheck::Violation::Deallocation);
+  originalZone.free(zone, memory);
+}
+
+bool hookDefaultZone() {
+  malloc_zone_t *zone = malloc_default_zone();
+  const auto address = reinterpret_cast<vm_address_t>(zone);
+  // From version 8 the zone is mapped read-only
+  const bool readOnly = zone->version >= 8;
+  if (readOnly && vm_protect(mach_task_self(), address, sizeof(*zone), 0,
+                             VM_PROT_READ | VM_PROT_WRITE) != KERN_SUCCESS)
+    return false;
+  originalZone = {zone->malloc, zone->calloc, zone->realloc, zone->free};
+  zone->malloc = zoneMalloc;
+  zone->calloc = zoneCalloc;
+  zone->realloc = zoneRealloc;
+  zone->free = zoneFree;
+  if (readOnly)
+    vm_protect(mach_task_self(), address, sizeof(*zone), 0, VM_PROT_READ);
+  mallocReports = true;
+  return true;
+}
+
+[[maybe_unused]] const bool defaultZoneHooked = hookDefaultZone();
+} // namespace
+#endif
+
+// Replacements for the global allocation functions, reporting from scopes
+// unless malloc() and free() already do. The array and nothrow forms
+// forward to these in the standard libraries; the aligned ones are replaced
+// too, as they allocate on their own.
+namespace {
+void *allocate(std::size_t size) {
+  if (!mallocReports.load(std::memory_order_relaxed))
+    RealtimeCheck::report(RealtimeCheck::Violation::Allocation);
+  return std::malloc(size > 0 ? size : 1);
+}
+
+void *allocateAligned(std::size_t size, std::align_val_t alignment) {
+  RealtimeCheck::report(RealtimeCheck::Violation::Allocation);
+  const auto align = static_cast<std::size_t>(alignment);
+  size = size > 0 ? (size + align - 1) / align * align : align;
+#if JUCE_WINDOWS
+  return _aligned_malloc(size, align);
+#else
+  return std::aligned_alloc(align, size);
+#endif
+}
+
+void deallocate(void *memory) {
+  if (memory == nullptr)
+    return;
+  if (!mallocReports.load(std::memory_order_relaxed))
+    RealtimeCheck::report(RealtimeCheck::Violation::Deallocation);
+  std::free(memory);
+}
+
+void deallocateAligned(void *memory) {
+  if (memory == nullptr)
+    return;
+#if JUCE_WINDOWS
+  RealtimeCheck::report(RealtimeCheck::Violation::Deallocation);
+  _aligned_free(memory);
+#else
+  if (!mallocReports.load(std::memory_order_relaxed))
+    RealtimeCheck::report(RealtimeCheck::Violation::Deallocation);
+  std::free(memory);
+#endif
+}
+} // namespace
+
+void *operator new(std::size_t size) {
+  if (void *memory = allocate(size))
+    return memory;
+  throw std::bad_alloc();
+}
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept {
+  return allocate(size);
+}
+
+void *operator new(std::size_t size, std::align_val_t alignment) {
+  if (void *memory = allocateAligned(size, alignment))
+    return memory;
+  throw std::bad_alloc();
+}
+
+void operator delete(void *memory) noexcept { deallocate(memory); }
+
+void operator delete(void *memory, std::size_t) noexcept { deallocate(memory); }
+
+void operator delete(void *memory, std::align_val_t) noexcept {
+  deallocateAligned(memory);
+}
+
+void operator delete(void *memory, std::size_t, std::align_val_t) noexcept {
+  deallocateAligned(memory);
+}
+
+#else
+
+namespace RealtimeCheck {
+bool isEnabled() { return false; }
+
+uint64_t getNumViolations() { return 0; }
+
+void setBreakOnViolation(bool) {}
+
+bool callAsync(std::function<void()> callback) {
+  return juce::MessageManager::callAsync(std::move(callback));
+}
+} // namespace RealtimeCheck
+
+#endif
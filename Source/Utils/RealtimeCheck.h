@@ -0,0 +1,101 @@
+#pragma once
+
+#include "../JuceHeader.h"
+#include <cstdint>
+#include <functional>
+#include <mutex>
+
+/**
+ * Debug guard for the code the audio callbacks run.
+ *
+ * REALTIME_SCOPE marks a callback, or the part of one that must not block.
+ * While a scope is open on a thread, each operator new or delete, each
+ * malloc(), calloc(), realloc() or free() (glibc and macOS; this is where
+ * a juce::AudioBuffer allocates), each lock() of a
+ * RealtimeCheck::Mutex or CriticalSection and each
+ * RealtimeCheck::callAsync() on that thread is a violation. The first one
+ * from each call stack and scope is logged as a warning with a stack trace
+ * (see AppLogger), and every one is counted; setBreakOnViolation() also
+ * stops in the debugger at each new site. REALTIME_ALLOWED lets a known
+ * violation through until it is fixed, so the exceptions can be grepped.
+ *
+ * Only built with the ENABLE_REALTIME_CHECKS CMake option in a Debug build;
+ * otherwise the macros expand to nothing, Mutex and CriticalSection are
+ * std::mutex and juce::CriticalSection, and callAsync() just posts. Not seen:
+ * malloc() and friends on Windows and in a Linux plugin (the host binds
+ * them first), so a JUCE buffer growing there goes unnoticed;
+ * aligned_alloc() and posix_memalign(); locks of other types; and
+ * a Mutex locked through std::mutex& (a condition variable's unique_lock).
+ */
+namespace RealtimeCheck {
+enum class Violation { Allocation, Deallocation, Lock, MessagePost };
+
+bool isEnabled();
+
+// Violations so far, repeats included; 0 when not built in
+uint64_t getNumViolations();
+
+void setBreakOnViolation(bool shouldBreak);
+
+// juce::MessageManager::callAsync, a violation inside a scope
+bool callAsync(std::function<void()> callback);
+
+#ifdef HACHITUNE_REALTIME_CHECKS
+// Counts, and for a new site logs, a violation if this thread is in a scope
+void report(Violation violation);
+
+class Scope {
+public:
+  // A disabled scope leaves an enclosing one open (or none)
+  explicit Scope(const char *scopeName, bool enabled = true);
+  ~Scope();
+
+private:
+  const char *previous;
+
+  JUCE_DECLARE_NON_COPYABLE(Scope)
+};
+
+class Allowed {
+public:
+  explicit Allowed(const char *reason);
+  ~Allowed();
+
+  JUCE_DECLARE_NON_COPYABLE(Allowed)
+};
+
+class Mutex : public std::mutex {
+public:
+  Mutex() = default;
+  void lock();
+};
+
+class CriticalSection : public juce::CriticalSection {
+public:
+  CriticalSection() = default;
+  void enter() const noexcept;
+};
+#else
+using Mutex = std::mutex;
+using CriticalSection = juce::CriticalSection;
+#endif
+
+using ScopedLock = juce::GenericScopedLock<CriticalSection>;
+} // namespace RealtimeCheck
+
+#ifdef HACHITUNE_REALTIME_CHECKS
+#define REALTIME_CHECK_JOIN_(a, b) a##b
+#define REALTIME_CHECK_VAR_(prefix, line) REALTIME_CHECK_JOIN_(prefix, line)
+#define REALTIME_SCOPE(name)                                                   \
+  ::RealtimeCheck::Scope REALTIME_CHECK_VAR_(realtimeScope_, __LINE__)(name)
+#define REALTIME_SCOPE_IF(name, condition)                                     \
+  ::RealtimeCheck::Scope REALTIME_CHECK_VAR_(realtimeScope_, __LINE__)(        \
+      name, condition)
+#define REALTIME_ALLOWED(reason)                                               \
+  ::RealtimeCheck::Allowed REALTIME_CHECK_VAR_(realtimeAllowed_, __LINE__)(    \
+      reason)
+#else
+#define REALTIME_SCOPE(name) ((void)0)
+#define REALTIME_SCOPE_IF(name, condition) ((void)(condition))
+#define REALTIME_ALLOWED(reason) ((void)0)
+#endif
@@ -0,0 +1,340 @@
+#include "RenderSnapshot.h"
+#include "ScratchMapping.h"
+#include <algorithm>
+#include <climits>
+
+namespace {
+using Ranges = std::vector<std::pair<int, int>>;
+
+// Add the [start, end) ranges, clamped to [0, limit), to a sorted disjoint
+// set, joining any that overlap or touch
+void addRanges(Ranges &ranges, const Ranges &added, int limit) {
+  for (auto [start, end] : added) {
+    start = std::max(0, start);
+    end = std::min(limit, end);
+    if (start < end)
+      ranges.emplace_back(start, end);
+  }
+  std::sort(ranges.begin(), ranges.end());
+
+  Ranges merged;
+  for (const auto &range : ranges) {
+    if (!merged.empty() && range.first <= merged.back().second)
+      merged.back().second = std::max(merged.back().second, range.second);
+    else
+      merged.push_back(range);
+  }
+  ranges.swap(merged);
+}
+
+// Touching ranges are joined, so one range covers all of [start, end) or
+// none does
+bool coversAll(const Ranges &ranges, int start, int end) {
+  auto it = std::upper_bound(ranges.begin(), ranges.end(),
+                             std::make_pair(start, INT_MAX));
+  if (it == ranges.begin())
+    return false;
+  --it;
+  return it->first <= start && it->second >= end;
+}
+} // namespace
+
+RenderSnapshot::Tile
+RenderSnapshot::makeTile(const juce::AudioBuffer<float> &source,
+                         int tileIndex) {
+  const int start = tileIndex * tileSize;
+  const int length = std::min(tileSize, source.getNumSamples() - start);
+  auto tile = std::make_shared<juce::AudioBuffer<float>>(
+      source.getNumChannels(), length);
+  for (int ch = 0; ch < source.getNumChannels(); ++ch)
+    tile->copyFrom(ch, 0, source, ch, start, length);
+  return tile;
+}
+
+RenderSnapshot::Ptr
+RenderSnapshot::fromBuffer(const juce::AudioBuffer<float> &buffer,
+                           int sampleRate) {
+  std::shared_ptr<RenderSnapshot> snapshot(new RenderSnapshot());
+  snapshot->numChannels = buffer.getNumChannels();
+  snapshot->numSamples = buffer.getNumSamples();
+  snapshot->sampleRate = sampleRate;
+
+  const int numTiles = (snapshot->numSamples + tileSize - 1) / tileSize;
+  snapshot->tiles.reserve(static_cast<size_t>(numTiles));
+  for (int i = 0; i < numTiles; ++i)
+    snapshot->tiles.push_back(makeTile(buffer, i));
+  snapshot->pagedTiles.assign(snapshot->tiles.size(), false);
+  snapshot->sharedTiles.assign(snapshot->tiles.size(), false);
+  return snapshot;
+}
+
+RenderSnapshot::Ptr RenderSnapshot::sharing(
+    std::shared_ptr<const juce::AudioBuffer<float>> buffer, int sampleRate) {
+  std::shared_ptr<RenderSnapshot> snapshot(new RenderSnapshot());
+  snapshot->numChannels = buffer->getNumChannels();
+  snapshot->numSamples = buffer->getNumSamples();
+  snapshot->sampleRate = sampleRate;
+  snapshot->sharedBuffer = buffer;
+
+  // Like a paged tile, each tile refers into the buffer and owns a share of
+  // it through the aliasing shared_ptr
+  struct SharedTile {
+    std::shared_ptr<const juce::AudioBuffer<float>> source;
+    juce::AudioBuffer<float> samples;
+  };
+
+  const int numTiles = (snapshot->numSamples + tileSize - 1) / tileSize;
+  std::vector<float *> channels(static_cast<size_t>(snapshot->numChannels));
+  snapshot->tiles.reserve(static_cast<size_t>(numTiles));
+  for (int i = 0; i < numTiles; ++i) {
+    const int start = i * tileSize;
+    const int length = std::min(tileSize, snapshot->numSamples - start);
+    for (int ch = 0; ch < snapshot->numChannels; ++ch)
+      channels[static_cast<size_t>(ch)] =
+          const_cast<float *>(buffer->getReadPointer(ch, start));
+    auto tile = std::make_shared<SharedTile>();
+    tile->source = buffer;
+    tile->samples.setDataToReferTo(channels.data(), snapshot->numChannels,
+                                   length);
+    snapshot->tiles.push_back(Tile(tile, &tile->samples));
+  }
+  snapshot->pagedTiles.assign(snapshot->tiles.size(), false);
+  snapshot->sharedTiles.assign(snapshot->tiles.size(), true);
+  return snapshot;
+}
+
+RenderSnapshot::Ptr RenderSnapshot::withRanges(
+    const juce::AudioBuffer<float> &source,
+    const std::vector<std::pair<int, int>> &sampleRanges) const {
+  if (source.getNumChannels() == 0 || source.getNumChannels() > numChannels ||
+      source.getNumSamples() != numSamples)
+    return fromBuffer(source, sampleRate);
+
+  std::shared_ptr<RenderSnapshot> snapshot(new RenderSnapshot(*this));
+  const bool fanOut = source.getNumChannels() < numChannels;
+  if (fanOut)
+    addRanges(snapshot->fannedOut, sampleRanges, numSamples);
+  for (const int i : tilesInRanges(sampleRanges)) {
+    snapshot->tiles[static_cast<size_t>(i)] =
+        fanOut ? snapshot->fanOutTile(source, i, sampleRanges)
+               : makeTile(source, i);
+    snapshot->pagedTiles[static_cast<size_t>(i)] = false;
+    snapshot->sharedTiles[static_cast<size_t>(i)] = false;
+  }
+  return snapshot;
+}
+
+RenderSnapshot::Tile
+RenderSnapshot::fanOutTile(const juce::AudioBuffer<float> &source,
+                           int tileIndex, const Ranges &sampleRanges) const {
+  const int start = tileIndex * tileSize;
+  const int length = std::min(tileSize, numSamples - start);
+  if (coversAll(fannedOut, start, start + length))
+    return makeTile(source, tileIndex);
+
+  // Part of the tile still plays as recorded: keep every channel and write
+  // the source over the new ranges
+  const auto &previous = *tiles[static_cast<size_t>(tileIndex)];
+  const int sourceChannels = source.getNumChannels();
+  auto tile = std::make_shared<juce::AudioBuffer<float>>(numChannels, length);
+  for (int ch = 0; ch < numChannels; ++ch)
+    tile->copyFrom(ch, 0, previous,
+                   std::min(ch, previous.getNumChannels() - 1), 0, length);
+  for (const auto &[rangeStart, rangeEnd] : sampleRanges) {
+    const int from = std::max(rangeStart, start);
+    const int to = std::min(rangeEnd, start + length);
+    if (from >= to)
+      continue;
+    for (int ch = 0; ch < numChannels; ++ch)
+      tile->copyFrom(ch, from - start, source,
+                     std::min(ch, sourceChannels - 1), from, to - from);
+  }
+  return tile;
+}
+
+RenderSnapshot::Tile
+RenderSnapshot::generateTile(int tileIndex,
+                             const TileGenerator &generator) const {
+  const int start = tileIndex * tileSize;
+  const int length = std::min(tileSize, numSamples - start);
+  auto tile = std::make_shared<juce::AudioBuffer<float>>(numChannels, length);
+  generator(start, *tile);
+  return tile;
+}
+
+RenderSnapshot::Ptr RenderSnapshot::generate(int numChannels, int numSamples,
+                                             int sampleRate,
+                                             const TileGenerator &generator) {
+  std::shared_ptr<RenderSnapshot> snapshot(new RenderSnapshot());
+  snapshot->numChannels = numChannels;
+  snapshot->numSamples = std::max(0, numSamples);
+  snapshot->sampleRate = sampleRate;
+
+  const int numTiles = (snapshot->numSamples + tileSize - 1) / tileSize;
+  snapshot->tiles.reserve(static_cast<size_t>(numTiles));
+  for (int i = 0; i < numTiles; ++i)
+    snapshot->tiles.push_back(snapshot->generateTile(i, generator));
+  snapshot->pagedTiles.assign(snapshot->tiles.size(), false);
+  snapshot->sharedTiles.assign(snapshot->tiles.size(), false);
+  return snapshot;
+}
+
+RenderSnapshot::Ptr RenderSnapshot::withGeneratedRanges(
+    const std::vector<std::pair<int, int>> &sampleRanges,
+    const TileGenerator &generator) const {
+  std::shared_ptr<RenderSnapshot> snapshot(new RenderSnapshot(*this));
+  for (const int i : tilesInRanges(sampleRanges)) {
+    snapshot->tiles[static_cast<size_t>(i)] = generateTile(i, generator);
+    snapshot->pagedTiles[static_cast<size_t>(i)] = false;
+    snapshot->sharedTiles[static_cast<size_t>(i)] = false;
+  }
+  return snapshot;
+}
+
+RenderSnapshot::Ptr RenderSnapshot::paged() const {
+  size_t totalValues = 0;
+  for (size_t i = 0; i < tiles.size(); ++i)
+    if (!pagedTiles[i])
+      totalValues += static_cast<size_t>(tiles[i]->getNumChannels()) *
+                     static_cast<size_t>(tiles[i]->getNumSamples());
+  if (totalValues == 0 || numChannels <= 0)
+    return nullptr;
+
+  auto mapping = ScratchMapping::create(totalValues * sizeof(float));
+  if (mapping == nullptr)
+    return nullptr;
+
+  // Each paged tile is a buffer referring into the mapping, and owns a
+  // share of it through the aliasing shared_ptr
+  struct PagedTile {
+    std::shared_ptr<ScratchMapping> pages;
+    juce::AudioBuffer<float> samples;
+  };
+
+  std::shared_ptr<RenderSnapshot> snapshot(new RenderSnapshot(*this));
+  auto *next = static_cast<float *>(mapping->getData());
+  std::vector<float *> channels(static_cast<size_t>(numChannels));
+  for (size_t i = 0; i < tiles.size(); ++i) {
+    if (pagedTiles[i])
+      continue;
+    const auto &source = *tiles[i];
+    const int length = source.getNumSamples();
+    const int tileChannels = source.getNumChannels();
+    for (int ch = 0; ch < tileChannels; ++ch) {
+      channels[static_cast<size_t>(ch)] = next;
+      std::copy_n(source.getReadPointer(ch), length, next);
+      next += length;
+    }
+    auto tile = std::make_shared<PagedTile>();
+    tile->pages = mapping;
+    tile->samples.setDataToReferTo(channels.data(), tileChannels, length);
+    snapshot->tiles[i] = Tile(tile, &tile->samples);
+    snapshot->pagedTiles[i] = true;
+    snapshot->sharedTiles[i] = false;
+  }
+  return snapshot;
+}
+
+size_t RenderSnapshot::getNumBytes() const {
+  size_t bytes = 0;
+  for (const auto &tile : tiles)
+    bytes += static_cast<size_t>(tile->getNumChannels()) *
+             static_cast<size_t>(tile->getNumSamples()) * sizeof(float);
+  return bytes;
+}
+
+size_t RenderSnapshot::getPagedBytes() const {
+  size_t bytes = 0;
+  for (size_t i = 0; i < tiles.size(); ++i)
+    if (pagedTiles[i])
+      bytes += static_cast<size_t>(tiles[i]->getNumChannels()) *
+               static_cast<size_t>(tiles[i]->getNumSamples()) * sizeof(float);
+  return bytes;
+}
+
+size_t RenderSnapshot::getSharedBytes() const {
+  size_t bytes = 0;
+  for (size_t i = 0; i < tiles.size(); ++i)
+    if (sharedTiles[i])
+      bytes += static_cast<size_t>(tiles[i]->getNumChannels()) *
+               static_cast<size_t>(tiles[i]->getNumSamples()) * sizeof(float);
+  return bytes;
+}
+
+std::shared_ptr<const juce::AudioBuffer<float>>
+RenderSnapshot::getSharedBuffer() const {
+  if (std::find(sharedTiles.begin(), sharedTiles.end(), false) !=
+      sharedTiles.end())
+    return nullptr;
+  return sharedBuffer.lock();
+}
+
+bool RenderSnapshot::isSingleChannel(int start, int count) const {
+  if (numChannels <= 1)
+    return true;
+  const int first = std::max(0, start);
+  const int end = std::min(numSamples, start + std::max(0, count));
+  if (first >= end)
+    return true; // Reads outside the snapshot are silence on every channel
+
+  for (int t = first / tileSize; t <= (end - 1) / tileSize; ++t)
+    if (tiles[static_cast<size_t>(t)]->getNumChannels() > 1)
+      return false;
+  return true;
+}
+
+std::vector<int> RenderSnapshot::tilesInRanges(
+    const std::vector<std::pair<int, int>> &sampleRanges) const {
+  const int numTiles = static_cast<int>(tiles.size());
+  std::vector<bool> touched(tiles.size(), false);
+  for (const auto &[rangeStart, rangeEnd] : sampleRanges) {
+    const int start = std::max(0, rangeStart);
+    const int end = std::min(numSamples, rangeEnd);
+    if (start >= end)
+      continue;
+
+    const int lastTile = std::min(numTiles - 1, (end - 1) / tileSize);
+    for (int i = start / tileSize; i <= lastTile; ++i)
+      touched[static_cast<size_t>(i)] = true;
+  }
+
+  std::vector<int> indices;
+  for (int i = 0; i < numTiles; ++i)
+    if (touched[static_cast<size_t>(i)])
+      indices.push_back(i);
+  return indices;
+}
+
+void RenderSnapshot::read(int channel, int start, int count,
+                          float *dest) const {
+  if (channel < 0 || channel >= numChannels || count <= 0)
+    return;
+
+  // Zero-fill anything outside the snapshot
+  if (start < 0) {
+    const int leading = std::min(count, -start);
+    std::fill(dest, dest + leading, 0.0f);
+    dest += leading;
+    count -= leading;
+    start = 0;
+  }
+  const int available = std::max(0, std::min(count, numSamples - start));
+  std::fill(dest + available, dest + count, 0.0f);
+
+  int done = 0;
+  while (done < available) {
+    const int sample = start + done;
+    const auto &tile = tiles[static_cast<size_t>(sample / tileSize)];
+    const int offset = sample % tileSize;
+    const int chunk = std::min(available - done, tileSize - offset);
+    const int tileChannel = std::min(channel, tile->getNumChannels() - 1);
+    std::copy_n(tile->getReadPointer(tileChannel, offset), chunk, dest + done);
+    done += chunk;
+  }
+}
+
+void RenderSnapshot::copyTo(juce::AudioBuffer<float> &dest) const {
+  dest.setSize(numChannels, numSamples, false, false, true);
+  for (int ch = 0; ch < numChannels; ++ch)
+    read(ch, 0, numSamples, dest.getWritePointer(ch));
+}
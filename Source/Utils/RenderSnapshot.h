@@ -0,0 +1,172 @@
+#pragma once
+
+#include "../JuceHeader.h"
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+/**
+ * Immutable, tiled copy of a rendered waveform.
+ *
+ * Samples live in fixed-size tiles held by shared pointers. Publishing an
+ * edit with withRanges() copies only the tiles the edit touched and shares
+ * every other tile with the previous snapshot, so handing readers (playback,
+ * plugin, export) a consistent view costs a few KB of pointers rather than a
+ * copy of the whole buffer.
+ *
+ * A tile may hold fewer channels than the snapshot: a mono tile is read
+ * back on every channel. withRanges() from a mono source (the project
+ * waveform of a stereo recording) stores what it writes once; a tile keeps
+ * its own channels only while part of it still plays as recorded.
+ *
+ * A snapshot made with sharing() holds no copy at all: its tiles refer to
+ * an immutable buffer the project waveform refers to as well.
+ *
+ * Snapshots never change after creation; any thread may read one it holds.
+ */
+class RenderSnapshot {
+public:
+  using Ptr = std::shared_ptr<const RenderSnapshot>;
+
+  // 64K samples per channel per tile (~1.5 s at 44.1 kHz)
+  static constexpr int tileSize = 1 << 16;
+
+  /** Tile up a full copy of buffer. */
+  static Ptr fromBuffer(const juce::AudioBuffer<float> &buffer,
+                        int sampleRate);
+
+  /**
+   * Snapshot whose tiles refer to buffer's samples instead of copying them,
+   * keeping buffer alive. Nothing may write to buffer afterwards: it is
+   * shared with every snapshot derived from this one.
+   */
+  static Ptr sharing(std::shared_ptr<const juce::AudioBuffer<float>> buffer,
+                     int sampleRate);
+
+  /**
+   * Snapshot of source that re-copies only the tiles overlapping the given
+   * [start, end) sample ranges and shares the rest with this one. A source
+   * with fewer channels replaces just those ranges, fanned out to every
+   * channel. Falls back to fromBuffer() if source no longer matches this
+   * snapshot's length or has more channels.
+   */
+  Ptr withRanges(const juce::AudioBuffer<float> &source,
+                 const std::vector<std::pair<int, int>> &sampleRanges) const;
+
+  /**
+   * Fills one tile: tile is sized to the tile's length and covers samples
+   * [start, start + tile.getNumSamples()).
+   */
+  using TileGenerator =
+      std::function<void(int start, juce::AudioBuffer<float> &tile)>;
+
+  /** Snapshot whose every tile is produced by generator. */
+  static Ptr generate(int numChannels, int numSamples, int sampleRate,
+                      const TileGenerator &generator);
+
+  /**
+   * Snapshot of the same shape that regenerates only the tiles overlapping
+   * the given [start, end) sample ranges and shares the rest with this one.
+   */
+  Ptr withGeneratedRanges(const std::vector<std::pair<int, int>> &sampleRanges,
+                          const TileGenerator &generator) const;
+
+  /**
+   * Snapshot with the same samples whose in-memory tiles are moved to one
+   * scratch file mapping (see ScratchMapping), for recordings too long to
+   * keep twice in RAM. Readers see no difference. Null if the mapping could
+   * not be made or every tile is paged already.
+   */
+  Ptr paged() const;
+
+  int getNumChannels() const { return numChannels; }
+  int getNumSamples() const { return numSamples; }
+  int getSampleRate() const { return sampleRate; }
+
+  /** Sample bytes held by this snapshot's tiles (shared tiles included). */
+  size_t getNumBytes() const;
+
+  /** The part of getNumBytes() in paged tiles. */
+  size_t getPagedBytes() const;
+
+  /** The part of getNumBytes() in tiles referring to a sharing() buffer. */
+  size_t getSharedBytes() const;
+
+  /**
+   * The buffer passed to sharing() if every tile still refers to it, so it
+   * holds exactly this snapshot's samples; null otherwise.
+   */
+  std::shared_ptr<const juce::AudioBuffer<float>> getSharedBuffer() const;
+
+  int getNumTiles() const { return static_cast<int>(tiles.size()); }
+
+  /**
+   * True if tile tileIndex is the same (unedited) tile in both snapshots;
+   * both must have more than tileIndex tiles.
+   */
+  bool sharesTile(const RenderSnapshot &other, int tileIndex) const {
+    return tiles[static_cast<size_t>(tileIndex)] ==
+           other.tiles[static_cast<size_t>(tileIndex)];
+  }
+
+  /**
+   * True if every tile overlapping [start, start + count) holds a single
+   * channel, so all channels read the same samples there.
+   */
+  bool isSingleChannel(int start, int count) const;
+
+  /** One sample; index must be within [0, getNumSamples()). */
+  float getSample(int channel, int index) const {
+    const auto &tile = *tiles[static_cast<size_t>(index / tileSize)];
+    return tile.getSample(std::min(channel, tile.getNumChannels() - 1),
+                          index % tileSize);
+  }
+
+  /** Copy count samples of one channel starting at start into dest. */
+  void read(int channel, int start, int count, float *dest) const;
+
+  /**
+   * Samples [start, start + count) of one channel read in place, or null if
+   * they do not lie within a single tile.
+   */
+  const float *getContiguous(int channel, int start, int count) const {
+    if (channel < 0 || channel >= numChannels || start < 0 || count <= 0 ||
+        start + count > numSamples ||
+        start / tileSize != (start + count - 1) / tileSize)
+      return nullptr;
+    const auto &tile = *tiles[static_cast<size_t>(start / tileSize)];
+    return tile.getReadPointer(std::min(channel, tile.getNumChannels() - 1),
+                               start % tileSize);
+  }
+
+  /** Copy the whole snapshot into a contiguous buffer. */
+  void copyTo(juce::AudioBuffer<float> &dest) const;
+
+private:
+  RenderSnapshot() = default;
+
+  using Tile = std::shared_ptr<const juce::AudioBuffer<float>>;
+
+  static Tile makeTile(const juce::AudioBuffer<float> &source, int tileIndex);
+  Tile generateTile(int tileIndex, const TileGenerator &generator) const;
+
+  // Tiles overlapping the ranges, once each, in ascending order
+  std::vector<int>
+  tilesInRanges(const std::vector<std::pair<int, int>> &sampleRanges) const;
+
+  // Tile tileIndex rebuilt from a narrower source: all channels where the
+  // source was written, this snapshot's samples elsewhere
+  Tile fanOutTile(const juce::AudioBuffer<float> &source, int tileIndex,
+                  const std::vector<std::pair<int, int>> &sampleRanges) const;
+
+  std::vector<Tile> tiles;
+  std::vector<bool> pagedTiles; // Per tile: held in a scratch mapping
+  std::vector<bool> sharedTiles; // Per tile: refers to sharedBuffer
+  std::weak_ptr<const juce::AudioBuffer<float>> sharedBuffer;
+  // Ranges written from a narrower source, sorted and disjoint
+  std::vector<std::pair<int, int>> fannedOut;
+  int numChannels = 0;
+  int numSamples = 0;
+  int sampleRate = 44100;
+};
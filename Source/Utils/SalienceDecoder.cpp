@@ -0,0 +1,68 @@
+#include "SalienceDecoder.h"
+#include "../JuceHeader.h"
+#include "DspKernels.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    // RMVPE's and FCPE's salience: 360 bins of 20 cents, windows of 4 bins
+    // either side, which get constant loop counts
+    constexpr int shippedNumBins = 360;
+    constexpr int shippedHalfWidth = 4;
+
+    template <typename BinCount, typename HalfWidth>
+    void decodeFrames(const float* salience, int numFrames, const SalienceDecoder::Layout& layout,
+                      float threshold, float* f0Hz, BinCount binCount, HalfWidth halfWidthCount)
+    {
+        const int numBins = static_cast<int>(binCount);
+        const int halfWidth = static_cast<int>(halfWidthCount);
+        for (int t = 0; t < numFrames; ++t)
+        {
+            const float* frame = salience + static_cast<size_t>(t) * static_cast<size_t>(numBins);
+
+            const float peak = juce::FloatVectorOperations::findMaximum(frame, numBins);
+            const bool voiced = layout.voicedAtThreshold ? peak >= threshold : peak > threshold;
+            if (!voiced)
+            {
+                f0Hz[t] = 0.0f;
+                continue;
+            }
+
+            const int center = std::min(numBins - 1,
+                                        static_cast<int>(std::find(frame, frame + numBins, peak) - frame));
+            const int start = std::max(0, center - halfWidth);
+            const int end = std::min(numBins, center + halfWidth + 1);
+
+            // Full windows have a constant width; only peaks near the edges don't
+            float weightedSum = 0.0f;
+            float weightSum = 0.0f;
+            if (end - start == 2 * halfWidth + 1)
+                DspKernels::weightedSums(layout.binCents + start, frame + start,
+                                         DspKernels::windowWidthFor(halfWidthCount),
+                                         weightedSum, weightSum);
+            else
+                DspKernels::weightedSums(layout.binCents + start, frame + start, end - start,
+                                         weightedSum, weightSum);
+
+            // f0 = 10 * 2^(cents / 1200)
+            f0Hz[t] = weightSum > layout.minWeightSum
+                          ? 10.0f * std::pow(2.0f, weightedSum / weightSum / 1200.0f)
+                          : 0.0f;
+        }
+    }
+}
+
+namespace SalienceDecoder
+{
+    void decode(const float* salience, int numFrames, const Layout& layout,
+                float threshold, float* f0Hz)
+    {
+        if (layout.numBins == shippedNumBins && layout.halfWidth == shippedHalfWidth)
+            decodeFrames(salience, numFrames, layout, threshold, f0Hz,
+                         DspKernels::Fixed<shippedNumBins>(), DspKernels::Fixed<shippedHalfWidth>());
+        else
+            decodeFrames(salience, numFrames, layout, threshold, f0Hz,
+                         layout.numBins, layout.halfWidth);
+    }
+} // namespace SalienceDecoder
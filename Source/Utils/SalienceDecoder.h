@@ -0,0 +1,30 @@
+#pragma once
+
+/**
+ * Local-average decoding of pitch salience, shared by the F0 detectors.
+ *
+ * The salience is numFrames contiguous rows of numBins values, bin i standing
+ * for binCents[i], as the models write it. A frame is voiced when its peak
+ * passes the threshold; its pitch is then the salience-weighted mean of the
+ * cents within halfWidth bins of the peak.
+ *
+ * Rows are read in place. The peak comes from FloatVectorOperations'
+ * vectorized findMaximum, its bin from a scan that stops at the first match
+ * (the bin a strict greater-than scan picks), and unvoiced frames are settled
+ * before any of the window is touched.
+ */
+namespace SalienceDecoder
+{
+    struct Layout
+    {
+        const float* binCents = nullptr;  // numBins entries
+        int numBins = 0;
+        int halfWidth = 4;
+        bool voicedAtThreshold = false;   // Whether a peak equal to the threshold is voiced
+        float minWeightSum = 0.0f;        // Windows summing to no more than this are unvoiced
+    };
+
+    /** Decode into f0Hz[numFrames], 0 for unvoiced frames. */
+    void decode(const float* salience, int numFrames, const Layout& layout,
+                float threshold, float* f0Hz);
+} // namespace SalienceDecoder
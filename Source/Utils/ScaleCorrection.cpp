@@ -0,0 +1,132 @@
+#include "ScaleCorrection.h"
+#include "Constants.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace
+{
+    // Bit n set when the scale holds the pitch class n semitones above the tonic
+    int scaleMask(ScaleCorrection::Mode mode)
+    {
+        auto maskOf = [](std::initializer_list<int> degrees)
+        {
+            int mask = 0;
+            for (int degree : degrees)
+                mask |= 1 << degree;
+            return mask;
+        };
+
+        using Mode = ScaleCorrection::Mode;
+        switch (mode)
+        {
+            case Mode::Major:           return maskOf({ 0, 2, 4, 5, 7, 9, 11 });
+            case Mode::NaturalMinor:    return maskOf({ 0, 2, 3, 5, 7, 8, 10 });
+            case Mode::HarmonicMinor:   return maskOf({ 0, 2, 3, 5, 7, 8, 11 });
+            case Mode::MajorPentatonic: return maskOf({ 0, 2, 4, 7, 9 });
+            case Mode::MinorPentatonic: return maskOf({ 0, 3, 5, 7, 10 });
+            case Mode::Chromatic:
+            case Mode::numModes:        break;
+        }
+        return 0xfff;
+    }
+} // namespace
+
+namespace ScaleCorrection
+{
+    float snapToScale(float midi, const Settings& settings)
+    {
+        const int mask = scaleMask(settings.mode);
+        const int key = ((settings.key % 12) + 12) % 12;
+        const int below = static_cast<int>(std::floor(midi));
+
+        // Every scale has a degree within six semitones; ascending, so the
+        // first of two equally near candidates is the lower
+        float best = midi;
+        float bestDistance = std::numeric_limits<float>::max();
+        for (int candidate = below - 6; candidate <= below + 7; ++candidate)
+        {
+            const int pitchClass = ((candidate - key) % 12 + 12) % 12;
+            const float distance = std::abs(static_cast<float>(candidate) - midi);
+            if ((mask >> pitchClass & 1) != 0 && distance < bestDistance)
+            {
+                best = static_cast<float>(candidate);
+                bestDistance = distance;
+            }
+        }
+        return best;
+    }
+
+    Plan plan(Project& project, const Settings& settings)
+    {
+        Plan result;
+        auto& notes = project.getNotes();
+        const auto& audioData = project.getAudioData();
+        const auto& delta = audioData.deltaPitch;
+        const auto& f0 = audioData.f0;
+        const int numFrames = static_cast<int>(std::min(delta.size(), f0.size()));
+
+        int longestNote = 0;
+        for (const auto& note : notes)
+            if (!note.isRest())
+                longestNote = std::max(longestNote, note.getEndFrame() - note.getStartFrame());
+
+        // Share of the drift left i frames into a note, shared by every note
+        const float humanize = std::clamp(settings.humanize, 0.0f, 1.0f);
+        const float frameMs = 1000.0f * static_cast<float>(HOP_SIZE) / static_cast<float>(SAMPLE_RATE);
+        std::vector<float> keep(static_cast<size_t>(std::max(0, longestNote)));
+        for (size_t i = 0; i < keep.size(); ++i)
+        {
+            const float decay = settings.retuneMs > 0.0f
+                ? std::exp(-static_cast<float>(i) * frameMs / settings.retuneMs)
+                : 0.0f;
+            keep[i] = humanize + (1.0f - humanize) * decay;
+        }
+
+        std::vector<F0FrameEdit> deltaEdits;
+        std::vector<float> corrected(keep.size());
+        for (auto& note : notes)
+        {
+            if (note.isRest())
+                continue;
+
+            const int start = std::clamp(note.getStartFrame(), 0, numFrames);
+            const int count = std::clamp(note.getEndFrame(), start, numFrames) - start;
+            bool driftChanged = false;
+            if (count > 0)
+            {
+                juce::FloatVectorOperations::multiply(corrected.data(), delta.data() + start, keep.data(), count);
+                for (int i = 0; i < count; ++i)
+                {
+                    const int frame = start + i;
+                    if (corrected[static_cast<size_t>(i)] == delta[static_cast<size_t>(frame)])
+                        continue;
+                    // F0 is recomposed from the curves once the notes are
+                    // rebuilt; the record only has to leave it as it was
+                    const float frameF0 = f0[static_cast<size_t>(frame)];
+                    deltaEdits.push_back({ frame, frameF0, frameF0, delta[static_cast<size_t>(frame)],
+                                           corrected[static_cast<size_t>(i)], false, false });
+                    driftChanged = true;
+                }
+            }
+
+            const float adjustedMidi = note.getMidiNote() + note.getPitchOffset();
+            const float targetMidi = snapToScale(adjustedMidi, settings);
+            if (driftChanged || std::abs(targetMidi - adjustedMidi) > 0.001f)
+                result.pitchChanges.push_back({ project.getNoteId(note), note.getMidiNote(),
+                                                note.getPitchOffset(), targetMidi });
+        }
+
+        result.deltaEdits = F0EditRecord(std::move(deltaEdits));
+        return result;
+    }
+
+    std::vector<Note*> apply(Project& project, const Plan& plan, bool useNew)
+    {
+        auto& audioData = project.getAudioData();
+        int minFrame = 0;
+        int maxFrame = -1;
+        plan.deltaEdits.apply(useNew, audioData.f0, &audioData.deltaPitch, nullptr, minFrame, maxFrame);
+        return NoteBulkEdit::applyPitchChanges(project, plan.pitchChanges, useNew);
+    }
+} // namespace ScaleCorrection
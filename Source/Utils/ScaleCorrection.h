@@ -0,0 +1,63 @@
+#pragma once
+
+#include "../Models/Project.h"
+#include "F0EditRecord.h"
+#include "NoteBulkEdit.h"
+#include <utility>
+#include <vector>
+
+/**
+ * Corrects a whole take to a key in one pass.
+ *
+ * Every note is moved to the nearest pitch of the scale, and the drift
+ * around it in deltaPitch is pulled towards the note: it is kept at the
+ * onset and decays with the retune time, so slow settings leave scoops and
+ * fast ones flatten the note at once. Humanize keeps that share of the
+ * drift throughout. The correction is planned without touching the
+ * project, so it can be applied, auditioned and undone as one step.
+ */
+namespace ScaleCorrection
+{
+    enum class Mode
+    {
+        Chromatic,
+        Major,
+        NaturalMinor,
+        HarmonicMinor,
+        MajorPentatonic,
+        MinorPentatonic,
+        numModes
+    };
+
+    struct Settings
+    {
+        int key = 0;                 // Pitch class of the tonic, 0 = C
+        Mode mode = Mode::Major;
+        float retuneMs = 50.0f;      // Time constant of the drift decay; 0 flattens at once
+        float humanize = 0.0f;       // Share of the drift kept, 0 to 1
+    };
+
+    /** Nearest pitch of the settings' scale to midi; halfway goes down. */
+    float snapToScale(float midi, const Settings& settings);
+
+    struct Plan
+    {
+        // Notes whose pitch moves; also every note whose drift changes, so
+        // reapplying the changes reports each corrected note
+        std::vector<NoteBulkEdit::PitchChange> pitchChanges;
+        // deltaPitch before and after, for the frames inside the notes
+        F0EditRecord deltaEdits;
+
+        bool empty() const { return pitchChanges.empty(); }
+    };
+
+    /** The correction of the project's non-rest notes; the project is not changed. */
+    Plan plan(Project& project, const Settings& settings);
+
+    /**
+     * Write the new (or old) drift and pitches of the plan and post the
+     * note changes as one batch. Returns the notes found; the curves around
+     * them still need rebuilding (see NoteBulkEdit::rebuildAroundNotes).
+     */
+    std::vector<Note*> apply(Project& project, const Plan& plan, bool useNew);
+} // namespace ScaleCorrection
@@ -0,0 +1,127 @@
+#include "ScratchArena.h"
+#include <algorithm>
+#include <atomic>
+#include <new>
+
+namespace
+{
+    std::atomic<size_t> retainedBytes { 0 };
+    std::atomic<size_t> highWaterBytes { 0 };
+    std::atomic<uint64_t> scopeCount { 0 };
+    std::atomic<uint64_t> blockAllocations { 0 };
+
+    size_t alignUp(size_t numBytes)
+    {
+        return (numBytes + ScratchArena::alignment - 1) & ~(ScratchArena::alignment - 1);
+    }
+} // namespace
+
+ScratchArena::Stats ScratchArena::getStats()
+{
+    Stats stats;
+    stats.retainedBytes = retainedBytes.load(std::memory_order_relaxed);
+    stats.highWaterBytes = highWaterBytes.load(std::memory_order_relaxed);
+    stats.scopes = scopeCount.load(std::memory_order_relaxed);
+    stats.blockAllocations = blockAllocations.load(std::memory_order_relaxed);
+    return stats;
+}
+
+ScratchArena::Scope::Scope()
+    : arena(forThisThread()), block(arena.current), offset(arena.used), bytesBefore(arena.bytesBefore)
+{
+    ++arena.depth;
+}
+
+ScratchArena::Scope::~Scope()
+{
+    arena.current = block;
+    arena.used = offset;
+    arena.bytesBefore = bytesBefore;
+    if (--arena.depth == 0)
+        arena.endOutermostScope();
+}
+
+void* ScratchArena::Scope::allocateBytes(size_t numBytes)
+{
+    return arena.allocate(numBytes);
+}
+
+void ScratchArena::BlockDeleter::operator()(std::byte* data) const
+{
+    ::operator delete[](data, std::align_val_t(alignment));
+}
+
+ScratchArena::~ScratchArena()
+{
+    retainedBytes.fetch_sub(retained, std::memory_order_relaxed);
+}
+
+ScratchArena& ScratchArena::forThisThread()
+{
+    thread_local ScratchArena arena;
+    return arena;
+}
+
+void* ScratchArena::allocate(size_t numBytes)
+{
+    numBytes = alignUp(std::max<size_t>(numBytes, 1));
+
+    // Move on to the next block, or add one, when the current one is full;
+    // the rest of a full block stays unused until the scope ends
+    while (blocks.empty() || used + numBytes > blocks[current].size)
+    {
+        if (!blocks.empty())
+        {
+            bytesBefore += blocks[current].size;
+            ++current;
+            used = 0;
+        }
+        if (current == blocks.size())
+            addBlock(std::max({ numBytes, minBlockBytes, blocks.empty() ? size_t(0) : blocks.back().size * 2 }));
+    }
+
+    void* result = blocks[current].data.get() + used;
+    used += numBytes;
+    scopePeak = std::max(scopePeak, bytesBefore + used);
+    return result;
+}
+
+void ScratchArena::addBlock(size_t numBytes)
+{
+    Block block;
+    block.data.reset(static_cast<std::byte*>(::operator new[](numBytes, std::align_val_t(alignment))));
+    block.size = numBytes;
+    blocks.push_back(std::move(block));
+    retained += numBytes;
+    retainedBytes.fetch_add(numBytes, std::memory_order_relaxed);
+    blockAllocations.fetch_add(1, std::memory_order_relaxed);
+}
+
+void ScratchArena::endOutermostScope()
+{
+    scopeCount.fetch_add(1, std::memory_order_relaxed);
+    size_t previous = highWaterBytes.load(std::memory_order_relaxed);
+    while (scopePeak > previous
+           && !highWaterBytes.compare_exchange_weak(previous, scopePeak, std::memory_order_relaxed))
+    {
+    }
+
+    // Merge chained blocks into one that fits the peak, or let go of an
+    // arena that grew past the retention limit
+    const bool chained = blocks.size() > 1;
+    const bool oversized = retained > maxRetainedBytes;
+    if (chained || oversized)
+    {
+        const size_t peak = scopePeak;
+        retainedBytes.fetch_sub(retained, std::memory_order_relaxed);
+        blocks.clear();
+        retained = 0;
+        if (peak <= maxRetainedBytes)
+            addBlock(std::max(alignUp(peak), minBlockBytes));
+    }
+
+    current = 0;
+    used = 0;
+    bytesBefore = 0;
+    scopePeak = 0;
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+/**
+ * Per-thread bump allocator for the temporaries of one model call.
+ *
+ * A model wrapper opens a Scope around an inference and takes its resampled
+ * audio, feature frames and input tensors from it. Allocating is a pointer
+ * bump and the whole scope is released at once when it ends; the thread
+ * keeps the memory, so repeating a call of the same size does not touch
+ * the heap. Nested scopes (a helper called during an inference) release
+ * only what they took.
+ *
+ * A scope that outgrows the thread's block chains another one. When the
+ * outermost scope ends the blocks are merged into one of the peak size, so
+ * the next call fits in a single block. A thread keeps at most
+ * maxRetainedBytes between calls, so one very long analysis does not pin
+ * its peak on every worker.
+ *
+ * Memory is 64-byte aligned and not initialized, and only trivially
+ * destructible types can be allocated. Only the thread that opened a scope
+ * allocates from it; other threads may read its memory until it ends.
+ */
+class ScratchArena
+{
+public:
+    static constexpr size_t alignment = 64;
+    static constexpr size_t minBlockBytes = size_t(256) << 10;
+    static constexpr size_t maxRetainedBytes = size_t(64) << 20;
+
+    /** Process-wide counters, for the performance panel. */
+    struct Stats
+    {
+        size_t retainedBytes = 0;      // Held by all threads' arenas now
+        size_t highWaterBytes = 0;     // Peak use of one outermost scope
+        uint64_t scopes = 0;           // Outermost scopes finished
+        uint64_t blockAllocations = 0; // Heap allocations made by arenas
+    };
+
+    static Stats getStats();
+
+    class Scope
+    {
+    public:
+        Scope();
+        ~Scope();
+
+        /** Room for count values of T, uninitialized. */
+        template <typename T>
+        T* allocate(size_t count)
+        {
+            static_assert(std::is_trivially_destructible_v<T>, "ScratchArena does not run destructors");
+            static_assert(alignof(T) <= alignment, "ScratchArena alignment is too small for T");
+            return static_cast<T*>(allocateBytes(count * sizeof(T)));
+        }
+
+        /** Room for count values of T, set to value. */
+        template <typename T>
+        T* allocate(size_t count, T value)
+        {
+            T* values = allocate<T>(count);
+            std::fill(values, values + count, value);
+            return values;
+        }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        void* allocateBytes(size_t numBytes);
+
+        ScratchArena& arena;
+        size_t block;
+        size_t offset;
+        size_t bytesBefore;
+    };
+
+    ~ScratchArena();
+
+private:
+    struct BlockDeleter
+    {
+        void operator()(std::byte* data) const;
+    };
+
+    struct Block
+    {
+        std::unique_ptr<std::byte[], BlockDeleter> data;
+        size_t size = 0;
+    };
+
+    ScratchArena() = default;
+    static ScratchArena& forThisThread();
+
+    void* allocate(size_t numBytes);
+    void addBlock(size_t numBytes);
+    void endOutermostScope();
+
+    std::vector<Block> blocks;
+    size_t current = 0;     // Block being bumped
+    size_t used = 0;        // Bytes used in the current block
+    size_t bytesBefore = 0; // Sizes of the blocks before current
+    size_t scopePeak = 0;   // Most bytes in use during the outermost scope
+    size_t retained = 0;    // Sum of block sizes
+    int depth = 0;
+};
@@ -0,0 +1,47 @@
+#include "ScratchMapping.h"
+#include "AppLogger.h"
+
+ScratchMapping::~ScratchMapping() {
+  mapping.reset();
+  if (file != juce::File())
+    file.deleteFile();
+}
+
+std::shared_ptr<ScratchMapping> ScratchMapping::create(size_t numBytes) {
+  if (numBytes == 0)
+    return nullptr;
+
+  std::shared_ptr<ScratchMapping> result(new ScratchMapping());
+  result->file = juce::File::getSpecialLocation(juce::File::tempDirectory)
+                     .getNonexistentChildFile("HachiTuneScratch", ".raw");
+
+  // Extend the file to its full size; the OS allocates its blocks lazily
+  {
+    juce::FileOutputStream stream(result->file);
+    if (stream.failedToOpen() ||
+        !stream.setPosition(static_cast<juce::int64>(numBytes) - 1) ||
+        !stream.writeByte(0)) {
+      LOG("ScratchMapping: cannot create " + result->file.getFullPathName());
+      return nullptr;
+    }
+  }
+
+  result->mapping = std::make_unique<juce::MemoryMappedFile>(
+      result->file, juce::MemoryMappedFile::readWrite);
+  if (result->mapping->getData() == nullptr ||
+      result->mapping->getSize() < numBytes) {
+    LOG("ScratchMapping: cannot map " +
+        juce::File::descriptionOfSizeInBytes(
+            static_cast<juce::int64>(numBytes)));
+    return nullptr;
+  }
+  result->data = result->mapping->getData();
+  result->size = numBytes;
+
+#if !JUCE_WINDOWS
+  // The mapping keeps the file's blocks until it is unmapped
+  if (result->file.deleteFile())
+    result->file = juce::File();
+#endif
+  return result;
+}
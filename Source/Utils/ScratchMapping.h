@@ -0,0 +1,44 @@
+#pragma once
+
+#include "../JuceHeader.h"
+#include <cstddef>
+#include <memory>
+
+/**
+ * A read-write memory map of a temporary scratch file.
+ *
+ * Large project buffers moved here are paged by the OS: untouched pages
+ * leave RAM under memory pressure and are read back from disk on access,
+ * so a long recording needs disk space rather than resident memory. The
+ * file is removed when the mapping goes away; on POSIX systems it is
+ * unlinked as soon as it is mapped, so a crash leaves nothing behind.
+ *
+ * Owners share a mapping through shared_ptr and keep it alive as long as
+ * anything points into it.
+ */
+class ScratchMapping {
+public:
+  ~ScratchMapping();
+
+  /** A zero-filled mapping of numBytes, or null if it cannot be made. */
+  static std::shared_ptr<ScratchMapping> create(size_t numBytes);
+
+  void *getData() const { return data; }
+  size_t getSize() const { return size; }
+
+  bool contains(const void *pointer) const {
+    const auto *byte = static_cast<const char *>(pointer);
+    const auto *begin = static_cast<const char *>(data);
+    return byte >= begin && byte < begin + size;
+  }
+
+private:
+  ScratchMapping() = default;
+
+  juce::File file;
+  std::unique_ptr<juce::MemoryMappedFile> mapping;
+  void *data = nullptr;
+  size_t size = 0;
+
+  JUCE_DECLARE_NON_COPYABLE(ScratchMapping)
+};
@@ -0,0 +1,72 @@
+#include "SilenceSkipping.h"
+#include <algorithm>
+#include <cmath>
+
+namespace SilenceSkipping
+{
+    std::vector<std::pair<int, int>> findSpans(const MelView& mel, const VoicedMask& voicedMask,
+                                               const Options& options)
+    {
+        std::vector<std::pair<int, int>> spans;
+        const int numFrames = static_cast<int>(mel.size());
+        if (!options.enabled || numFrames == 0)
+            return spans;
+
+        // Loudest band per frame; the mel is natural-log magnitude
+        std::vector<float> peaks(static_cast<size_t>(numFrames));
+        for (int frame = 0; frame < numFrames; ++frame)
+        {
+            const float* bands = mel[static_cast<size_t>(frame)];
+            peaks[static_cast<size_t>(frame)] = *std::max_element(bands, bands + mel.getNumMels());
+        }
+        const float loudest = *std::max_element(peaks.begin(), peaks.end());
+        const float threshold = loudest + options.thresholdDb * std::log(10.0f) / 20.0f;
+
+        const int minFrames = std::max(
+            2 * options.marginFrames + 1,
+            static_cast<int>(std::ceil(options.minSilenceSeconds * SAMPLE_RATE / HOP_SIZE)));
+        const int maskFrames = static_cast<int>(voicedMask.size());
+
+        int frame = 0;
+        while (frame < numFrames)
+        {
+            // Next unvoiced frame, then the end of its quiet run
+            int start = frame;
+            if (start < maskFrames)
+                start = voicedMask.findNext(start, false);
+            if (start >= numFrames)
+                break;
+            while (start < numFrames && peaks[static_cast<size_t>(start)] >= threshold)
+                ++start;
+            int end = start;
+            while (end < numFrames && peaks[static_cast<size_t>(end)] < threshold
+                   && (end >= maskFrames || !voicedMask[static_cast<size_t>(end)]))
+                ++end;
+
+            if (end - start >= minFrames)
+            {
+                // The take's own edges need no fade room
+                const int spanStart = start == 0 ? 0 : start + options.marginFrames;
+                const int spanEnd = end == numFrames ? end : end - options.marginFrames;
+                if (spanStart < spanEnd)
+                    spans.emplace_back(spanStart, spanEnd);
+            }
+            frame = std::max(end, start + 1);
+        }
+        return spans;
+    }
+
+    void fillGap(const Options& options, const RenderSnapshot* original, int sampleRate,
+                 juce::int64 start, int count, float* dest)
+    {
+        std::fill(dest, dest + count, 0.0f);
+        if (options.fill != Fill::Original || original == nullptr
+            || original->getSampleRate() != sampleRate || original->getNumChannels() == 0)
+            return;
+
+        const juce::int64 available = original->getNumSamples();
+        const juce::int64 end = std::min(start + count, available);
+        if (start < end)
+            original->read(0, static_cast<int>(start), static_cast<int>(end - start), dest);
+    }
+}
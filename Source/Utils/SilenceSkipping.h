@@ -0,0 +1,45 @@
+#pragma once
+
+#include "../JuceHeader.h"
+#include "Constants.h"
+#include "MelBuffer.h"
+#include "RenderSnapshot.h"
+#include "VoicedMask.h"
+#include <utility>
+#include <vector>
+
+/**
+ * Finds the long quiet stretches of a take that full renders can skip.
+ *
+ * A frame is quiet when it is unvoiced and its loudest mel band sits
+ * thresholdDb or more below the loudest frame of the take, so unvoiced
+ * consonants still get synthesized. Runs of at least minSilenceSeconds,
+ * less marginFrames at each end, are handed to Vocoder::inferStreaming()
+ * as frames to skip; the margins keep the vocoder's fades and context on
+ * quiet audio. The skipped samples are then filled from the original
+ * audio or left silent.
+ */
+namespace SilenceSkipping
+{
+    enum class Fill { Original, Mute };
+
+    struct Options
+    {
+        bool enabled = true;
+        double minSilenceSeconds = 0.5;
+        float thresholdDb = -50.0f;
+        int marginFrames = 16;
+        Fill fill = Fill::Original;
+    };
+
+    /** Sorted, disjoint frame ranges [start, end) to skip; empty when disabled. */
+    std::vector<std::pair<int, int>> findSpans(const MelView& mel, const VoicedMask& voicedMask,
+                                               const Options& options);
+
+    /**
+     * Write the fill for output samples [start, start + count) to dest: the
+     * original audio where it exists at sampleRate, silence elsewhere.
+     */
+    void fillGap(const Options& options, const RenderSnapshot* original, int sampleRate,
+                 juce::int64 start, int count, float* dest);
+}
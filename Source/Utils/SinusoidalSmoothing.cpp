@@ -1,4 +1,5 @@
 #include "SinusoidalSmoothing.h"
+#include "CurveConvolution.h"
 #include <algorithm>
 #include <cmath>
 
@@ -66,19 +67,9 @@ std::vector<double> SinusoidalSmoothing::forward(const std::vector<double>& x) c
         padded_x.push_back(x.back());
     }
 
-    std::vector<double> output;
-    output.reserve(L);
-
-    // Apply convolution
-    for (int i = 0; i < L; ++i)
-    {
-        double conv_sum = 0.0;
-        for (int j = 0; j < K; ++j)
-        {
-            conv_sum += padded_x[i + j] * kernel[j];
-        }
-        output.push_back(conv_sum);
-    }
+    // Apply convolution (FFT overlap-save for long kernels)
+    std::vector<double> output(L);
+    CurveConvolution::correlate(padded_x.data(), L, kernel, output.data());
 
     return output;
 }
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "../JuceHeader.h"
+#include "AppLogger.h"
+
+/**
+ * Phase timings of app startup, written to the log.
+ *
+ * begin() starts the clock as the app starts. Each mark() on the message
+ * thread logs the time since the previous mark and since begin(), so the
+ * log spells out the critical path to an interactive window; work that
+ * finishes in the background logs sinceBegin() itself.
+ */
+class StartupTimer {
+public:
+  static void begin() { getStart() = getLast() = now(); }
+
+  static void mark(const juce::String &phase) {
+    const double time = now();
+    LOG("Startup: " + phase + " took " +
+        juce::String(time - getLast(), 1) + " ms (" +
+        juce::String(time - getStart(), 1) + " ms since launch)");
+    getLast() = time;
+  }
+
+  static double sinceBegin() { return now() - getStart(); }
+
+private:
+  static double now() { return juce::Time::getMillisecondCounterHiRes(); }
+
+  static double &getStart() {
+    static double start = now();
+    return start;
+  }
+
+  static double &getLast() {
+    static double last = now();
+    return last;
+  }
+};
@@ -0,0 +1,170 @@
+#include "Tracing.h"
+
+#ifdef HACHITUNE_TRACING
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace {
+struct Event {
+  const char *name;
+  int64_t start;
+  int64_t end;
+};
+
+struct ThreadBuffer {
+  static constexpr uint64_t capacity = 32768;
+
+  std::array<Event, capacity> events;
+  // Only the owning thread writes; an event is published by bumping this
+  std::atomic<uint64_t> written{0};
+  std::atomic<bool> retired{false};
+  int threadId = 0;
+  juce::String threadName;
+};
+
+struct Registry {
+  std::mutex mutex;
+  std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+  int nextThreadId = 1;
+  const int64_t epoch = juce::Time::getHighResolutionTicks();
+};
+
+// Buffers of exited threads are kept for the export, up to this many
+constexpr size_t maxRetiredBuffers = 16;
+
+Registry &registry() {
+  static Registry instance;
+  return instance;
+}
+
+juce::String currentThreadName() {
+  if (juce::MessageManager::existsAndIsCurrentThread())
+    return "Message thread";
+  if (auto *thread = juce::Thread::getCurrentThread())
+    return thread->getThreadName();
+  return {};
+}
+
+// One per thread, registered on its first zone and retired when it exits
+struct ThreadHandle {
+  ThreadHandle() : buffer(std::make_shared<ThreadBuffer>()) {
+    auto &reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    buffer->threadId = reg.nextThreadId++;
+    buffer->threadName = currentThreadName();
+    if (buffer->threadName.isEmpty())
+      buffer->threadName = "Thread " + juce::String(buffer->threadId);
+
+    auto numRetired = static_cast<size_t>(
+        std::count_if(reg.buffers.begin(), reg.buffers.end(),
+                      [](const auto &b) { return b->retired.load(); }));
+    for (auto it = reg.buffers.begin();
+         numRetired > maxRetiredBuffers && it != reg.buffers.end();) {
+      if ((*it)->retired.load()) {
+        it = reg.buffers.erase(it);
+        --numRetired;
+      } else {
+        ++it;
+      }
+    }
+    reg.buffers.push_back(buffer);
+  }
+
+  ~ThreadHandle() { buffer->retired.store(true); }
+
+  std::shared_ptr<ThreadBuffer> buffer;
+};
+
+ThreadBuffer &currentBuffer() {
+  thread_local ThreadHandle handle;
+  return *handle.buffer;
+}
+
+juce::String quoted(const juce::String &text) {
+  return juce::JSON::toString(juce::var(text));
+}
+} // namespace
+
+Tracing::Zone::Zone(const char *zoneName)
+    : name(zoneName), start(juce::Time::getHighResolutionTicks()) {}
+
+Tracing::Zone::~Zone() {
+  auto &buffer = currentBuffer();
+  const auto index = buffer.written.load(std::memory_order_relaxed);
+  buffer.events[index % ThreadBuffer::capacity] = {
+      name, start, juce::Time::getHighResolutionTicks()};
+  buffer.written.store(index + 1, std::memory_order_release);
+}
+
+bool Tracing::isEnabled() { return true; }
+
+bool Tracing::writeChromeTrace(const juce::File &file) {
+  auto &reg = registry();
+  std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+  {
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    buffers = reg.buffers;
+  }
+
+  const double ticksPerMicrosecond =
+      static_cast<double>(juce::Time::getHighResolutionTicksPerSecond()) /
+      1.0e6;
+  auto microseconds = [&](int64_t ticks) {
+    return juce::String(static_cast<double>(ticks) / ticksPerMicrosecond, 3);
+  };
+
+  juce::MemoryOutputStream json;
+  json << "{\"traceEvents\":[";
+  bool firstEvent = true;
+  auto beginEvent = [&]() {
+    json << (firstEvent ? "\n" : ",\n");
+    firstEvent = false;
+  };
+
+  std::vector<Event> events;
+  for (const auto &buffer : buffers) {
+    const juce::String tid(buffer->threadId);
+    beginEvent();
+    json << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << tid
+         << ",\"args\":{\"name\":" << quoted(buffer->threadName) << "}}";
+
+    const auto end = buffer->written.load(std::memory_order_acquire);
+    const auto begin =
+        end > ThreadBuffer::capacity ? end - ThreadBuffer::capacity : 0;
+    events.clear();
+    for (auto i = begin; i < end; ++i)
+      events.push_back(buffer->events[i % ThreadBuffer::capacity]);
+
+    // The thread keeps recording; skip whatever it overwrote meanwhile
+    const auto after = buffer->written.load(std::memory_order_acquire);
+    const auto intact =
+        after > ThreadBuffer::capacity ? after - ThreadBuffer::capacity : 0;
+    const auto skip = static_cast<size_t>(
+        std::min<uint64_t>(intact > begin ? intact - begin : 0, events.size()));
+
+    for (size_t i = skip; i < events.size(); ++i) {
+      const auto &event = events[i];
+      beginEvent();
+      json << "{\"name\":" << quoted(event.name)
+           << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << tid
+           << ",\"ts\":" << microseconds(event.start - reg.epoch)
+           << ",\"dur\":" << microseconds(event.end - event.start) << "}";
+    }
+  }
+  json << "\n],\"displayTimeUnit\":\"ms\"}\n";
+
+  return file.replaceWithData(json.getData(), json.getDataSize());
+}
+
+#else
+
+bool Tracing::isEnabled() { return false; }
+
+bool Tracing::writeChromeTrace(const juce::File &) { return false; }
+
+#endif // HACHITUNE_TRACING
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "../JuceHeader.h"
+#include <cstdint>
+
+/**
+ * Scoped-zone profiler for following an edit through analysis, synthesis
+ * and painting, exported as Chrome trace JSON (chrome://tracing or
+ * ui.perfetto.dev).
+ *
+ * Only built with the ENABLE_TRACING CMake option; otherwise TRACE_ZONE
+ * expands to nothing and writeChromeTrace() writes no file. Each thread
+ * records into its own ring buffer, so a zone costs two clock reads and a
+ * store; the newest zones win once a buffer is full. Zone names must be
+ * string literals, as only the pointer is kept.
+ */
+namespace Tracing {
+bool isEnabled();
+
+// Every thread's zones so far; false when tracing is not built in or the
+// file cannot be written
+bool writeChromeTrace(const juce::File &file);
+
+#ifdef HACHITUNE_TRACING
+class Zone {
+public:
+  explicit Zone(const char *zoneName);
+  ~Zone();
+
+private:
+  const char *name;
+  int64_t start;
+
+  JUCE_DECLARE_NON_COPYABLE(Zone)
+};
+#endif
+} // namespace Tracing
+
+#ifdef HACHITUNE_TRACING
+#define TRACE_ZONE_JOIN_(a, b) a##b
+#define TRACE_ZONE_VAR_(line) TRACE_ZONE_JOIN_(traceZone_, line)
+#define TRACE_ZONE(name) ::Tracing::Zone TRACE_ZONE_VAR_(__LINE__)(name)
+#else
+#define TRACE_ZONE(name) ((void)0)
+#endif
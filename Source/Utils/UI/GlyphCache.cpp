@@ -0,0 +1,59 @@
+#include "GlyphCache.h"
+#include <algorithm>
+#include <vector>
+
+void GlyphCache::draw(juce::Graphics& g, const juce::String& text, const juce::Font& font,
+                      juce::Rectangle<float> area, juce::Justification justification)
+{
+    if (text.isEmpty() || area.isEmpty())
+        return;
+
+    const Key key { text, font.getTypefaceName(), juce::roundToInt(font.getHeight() * 100.0f),
+                    juce::roundToInt(font.getHorizontalScale() * 100.0f), font.getStyleFlags() };
+
+    auto it = arrangements.find(key);
+    if (it == arrangements.end())
+    {
+        evictIfNeeded();
+        Arrangement arrangement;
+        arrangement.glyphs.addLineOfText(font, text, 0.0f, 0.0f);
+        arrangement.width = arrangement.glyphs.getBoundingBox(0, -1, true).getRight();
+        arrangement.ascent = font.getAscent();
+        arrangement.height = font.getHeight();
+        it = arrangements.emplace(key, std::move(arrangement)).first;
+    }
+
+    auto& arrangement = it->second;
+    arrangement.lastDrawn = ++drawCounter;
+
+    // Same placement as drawText: the line's box justified within area
+    const auto box = justification.appliedToRectangle(
+        juce::Rectangle<float>(arrangement.width, arrangement.height), area);
+
+    juce::Graphics::ScopedSaveState state(g);
+    g.reduceClipRegion(area.getSmallestIntegerContainer());
+    arrangement.glyphs.draw(g, juce::AffineTransform::translation(box.getX(), box.getY() + arrangement.ascent));
+}
+
+void GlyphCache::evictIfNeeded()
+{
+    if (arrangements.size() < maxArrangements)
+        return;
+
+    // Drop the older half in one go so eviction stays rare
+    std::vector<uint64_t> ages;
+    ages.reserve(arrangements.size());
+    for (const auto& entry : arrangements)
+        ages.push_back(entry.second.lastDrawn);
+    auto middle = ages.begin() + static_cast<std::ptrdiff_t>(ages.size() / 2);
+    std::nth_element(ages.begin(), middle, ages.end());
+    const uint64_t cutoff = *middle;
+
+    for (auto it = arrangements.begin(); it != arrangements.end();)
+    {
+        if (it->second.lastDrawn < cutoff)
+            it = arrangements.erase(it);
+        else
+            ++it;
+    }
+}
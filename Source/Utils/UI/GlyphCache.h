@@ -0,0 +1,48 @@
+#pragma once
+
+#include "../../JuceHeader.h"
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <tuple>
+
+/**
+ * Shaped text for the short strings a view draws on every repaint: timeline
+ * labels, piano key names, titles.
+ *
+ * Graphics::drawText lays its string out again each call. Here each string
+ * is shaped once per font into a GlyphArrangement at the origin, and drawing
+ * only translates it into place, in the current colour. Text is placed on a
+ * single line and clipped by the caller's bounds, never ellipsised.
+ *
+ * Message thread only.
+ */
+class GlyphCache
+{
+public:
+    void draw(juce::Graphics& g, const juce::String& text, const juce::Font& font,
+              juce::Rectangle<float> area, juce::Justification justification);
+
+    void clear() { arrangements.clear(); }
+
+private:
+    // At most this many strings are kept, least recently drawn dropped first
+    static constexpr size_t maxArrangements = 512;
+
+    // Text, typeface, height and horizontal scale in hundredths, style flags
+    using Key = std::tuple<juce::String, juce::String, int, int, int>;
+
+    struct Arrangement
+    {
+        juce::GlyphArrangement glyphs; // Baseline at y = 0
+        float width = 0.0f;
+        float ascent = 0.0f;
+        float height = 0.0f;
+        uint64_t lastDrawn = 0;
+    };
+
+    void evictIfNeeded();
+
+    std::map<Key, Arrangement> arrangements;
+    uint64_t drawCounter = 0;
+};
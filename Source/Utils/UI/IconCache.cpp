@@ -0,0 +1,50 @@
+#include "IconCache.h"
+#include "SvgUtils.h"
+#include <algorithm>
+
+void IconCache::draw(juce::Graphics& g, const juce::String& id, const juce::Drawable& drawable,
+                     juce::Rectangle<float> area, juce::Colour tint, float opacity)
+{
+    const int width = juce::roundToInt(area.getWidth());
+    const int height = juce::roundToInt(area.getHeight());
+    if (width <= 0 || height <= 0 || opacity <= 0.0f)
+        return;
+
+    const float scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+    const Key key { id, width, height, tint.getARGB(), juce::roundToInt(scale * 100.0f) };
+
+    auto it = images.find(key);
+    if (it == images.end())
+    {
+        if (images.size() >= maxImages)
+            images.clear();
+
+        const int imageWidth = std::max(1, juce::roundToInt(static_cast<float>(width) * scale));
+        const int imageHeight = std::max(1, juce::roundToInt(static_cast<float>(height) * scale));
+        juce::Image image(juce::Image::ARGB, imageWidth, imageHeight, true);
+        {
+            auto tinted = drawable.createCopy();
+            SvgUtils::tintDrawable(tinted.get(), tint);
+            juce::Graphics imageGraphics(image);
+            tinted->drawWithin(imageGraphics,
+                               juce::Rectangle<float>(0.0f, 0.0f,
+                                                      static_cast<float>(imageWidth),
+                                                      static_cast<float>(imageHeight)),
+                               juce::RectanglePlacement::centred, 1.0f);
+        }
+        it = images.emplace(key, std::move(image)).first;
+    }
+
+    // Centred on area so rounding its size moves the icon by half a pixel at most
+    const float x = area.getCentreX() - static_cast<float>(width) * 0.5f;
+    const float y = area.getCentreY() - static_cast<float>(height) * 0.5f;
+    const auto& image = it->second;
+
+    juce::Graphics::ScopedSaveState state(g);
+    g.setOpacity(opacity);
+    g.drawImageTransformed(image,
+                           juce::AffineTransform::scale(static_cast<float>(width) / static_cast<float>(image.getWidth()),
+                                                        static_cast<float>(height) / static_cast<float>(image.getHeight()))
+                               .translated(x, y),
+                           false);
+}
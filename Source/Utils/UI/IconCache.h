@@ -0,0 +1,42 @@
+#pragma once
+
+#include "../../JuceHeader.h"
+#include <cstddef>
+#include <map>
+#include <tuple>
+
+/**
+ * Rasterized SVG icons for the toolbar and sidebar chrome.
+ *
+ * An icon is drawn into an image once per size, tint and physical pixel
+ * scale, so a repaint blits pixels instead of filling the drawable's paths
+ * again. The scale comes from the Graphics context, which already folds in
+ * the display's DPI and any host or desktop scaling; moving a window to a
+ * display with another DPI therefore renders new images rather than
+ * stretching the old ones.
+ *
+ * Hold one through juce::SharedResourcePointer so every button shares the
+ * images. Message thread only.
+ */
+class IconCache
+{
+public:
+    /**
+     * Draw drawable fitted and centred in area, tinted, at opacity.
+     * id names the icon: the same id must always be given the same drawable.
+     */
+    void draw(juce::Graphics& g, const juce::String& id, const juce::Drawable& drawable,
+              juce::Rectangle<float> area, juce::Colour tint, float opacity = 1.0f);
+
+    void clear() { images.clear(); }
+
+private:
+    // More images than the chrome ever shows at once: a stale DPI or size
+    // is all that can fill it, so it is simply emptied
+    static constexpr size_t maxImages = 256;
+
+    // Icon, logical width and height, tint, physical scale in hundredths
+    using Key = std::tuple<juce::String, int, int, juce::uint32, int>;
+
+    std::map<Key, juce::Image> images;
+};
@@ -12,6 +12,16 @@ class TimecodeFont
 {
 public:
     static void initialize()
+    {
+        initialize(getInstance().initialized ? juce::MemoryBlock() : readFontFile());
+    }
+
+    /**
+     * Initialize from font data read beforehand, e.g. by readFontFile() on
+     * a worker while the app does other startup work; empty data falls back
+     * to the system font.
+     */
+    static void initialize(const juce::MemoryBlock& fontData)
     {
         auto& instance = getInstance();
         ++instance.refCount;
@@ -21,6 +31,17 @@ public:
 
         instance.initialized = true;
 
+        if (fontData.isEmpty())
+            return;
+
+        instance.customTypeface = juce::Typeface::createSystemTypefaceFor(
+            fontData.getData(), fontData.getSize());
+        instance.fontLoaded = instance.customTypeface != nullptr;
+    }
+
+    /** The bundled font file's contents, or empty if not found; any thread. */
+    static juce::MemoryBlock readFontFile()
+    {
         juce::File appDir = juce::File::getSpecialLocation(juce::File::currentExecutableFile).getParentDirectory();
         juce::StringArray fontPaths = {
             appDir.getChildFile("Resources/fonts/Sarasa-UI-Music-Regular.ttf").getFullPathName(),
@@ -37,19 +58,14 @@ public:
             if (fontFile.existsAsFile())
             {
                 juce::MemoryBlock fontData;
-                if (fontFile.loadFileAsData(fontData))
+                if (fontFile.loadFileAsData(fontData) && !fontData.isEmpty())
                 {
-                    instance.customTypeface = juce::Typeface::createSystemTypefaceFor(
-                        fontData.getData(), fontData.getSize());
-                    if (instance.customTypeface != nullptr)
-                    {
-                        instance.fontLoaded = true;
-                        DBG("Loaded timecode font: " + path);
-                        break;
-                    }
+                    DBG("Loaded timecode font: " + path);
+                    return fontData;
                 }
             }
         }
+        return {};
     }
 
     static void shutdown()
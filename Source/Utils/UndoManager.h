@@ -3,10 +3,17 @@
 #include "../JuceHeader.h"
 #include "../Models/Note.h"
 #include "../Models/Project.h"
+#include "AppLogger.h"
+#include "F0EditRecord.h"
+#include "NoteBulkEdit.h"
+#include "ScaleCorrection.h"
+#include "UndoSpillFile.h"
+#include "VibratoAnalysis.h"
 #include <vector>
 #include <memory>
 #include <functional>
 #include <limits>
+#include <unordered_map>
 
 /**
  * Base class for undoable actions.
@@ -18,6 +25,110 @@ public:
     virtual void undo() = 0;
     virtual void redo() = 0;
     virtual juce::String getName() const = 0;
+
+    /** Approximate bytes held by this action, for memory accounting. */
+    virtual size_t getMemoryBytes() const { return 0; }
+
+    /**
+     * Absorb an action recorded right after this one, so both undo as a
+     * single step. Returns false (the default) to keep them separate.
+     */
+    virtual bool mergeWith(const UndoableAction&) { return false; }
+
+    /**
+     * Write the bulky state of an old step (its curves) to out and release
+     * it, so PitchUndoManager can keep the step on disk; readBack() restores
+     * it before the step is replayed. Returns false, the default, when there
+     * is nothing worth moving; out is then ignored.
+     */
+    virtual bool spill(juce::OutputStream&) { return false; }
+    /** Restore what spill() wrote; false if it cannot be read. */
+    virtual bool readBack(juce::InputStream&) { return true; }
+
+protected:
+    template <typename T>
+    static size_t bytesOf(const std::vector<T>& v) { return v.capacity() * sizeof(T); }
+    static size_t bytesOf(const std::vector<bool>& v) { return v.capacity() / 8; }
+
+    // Spill helpers: each writes a value whole and readValue() reads it back
+    static void writeValue(juce::OutputStream& out, const std::vector<float>& values)
+    {
+        out.writeInt(static_cast<int>(values.size()));
+        out.write(values.data(), values.size() * sizeof(float));
+    }
+    static bool readValue(juce::InputStream& in, std::vector<float>& values)
+    {
+        const int size = in.readInt();
+        if (size < 0 || size > in.getNumBytesRemaining() / static_cast<int>(sizeof(float)))
+            return false;
+        values.resize(static_cast<size_t>(size));
+        const auto bytes = static_cast<int>(values.size() * sizeof(float));
+        return in.read(values.data(), bytes) == bytes;
+    }
+    static void writeValue(juce::OutputStream& out, const std::vector<bool>& flags)
+    {
+        out.writeInt(static_cast<int>(flags.size()));
+        for (size_t i = 0; i < flags.size(); i += 8)
+        {
+            int byte = 0;
+            for (size_t bit = 0; bit < 8 && i + bit < flags.size(); ++bit)
+                byte |= flags[i + bit] ? 1 << bit : 0;
+            out.writeByte(static_cast<char>(byte));
+        }
+    }
+    static bool readValue(juce::InputStream& in, std::vector<bool>& flags)
+    {
+        const int size = in.readInt();
+        if (size < 0 || (size + 7) / 8 > in.getNumBytesRemaining())
+            return false;
+        flags.assign(static_cast<size_t>(size), false);
+        for (int i = 0; i < size; i += 8)
+        {
+            const int byte = static_cast<juce::uint8>(in.readByte());
+            for (int bit = 0; bit < 8 && i + bit < size; ++bit)
+                flags[static_cast<size_t>(i + bit)] = (byte >> bit & 1) != 0;
+        }
+        return true;
+    }
+    static void writeValue(juce::OutputStream& out, const MelBuffer& mel)
+    {
+        out.writeInt(static_cast<int>(mel.size()));
+        out.writeInt(mel.getNumMels());
+        out.write(mel.data(), mel.size() * static_cast<size_t>(mel.getNumMels()) * sizeof(float));
+    }
+    static bool readValue(juce::InputStream& in, MelBuffer& mel)
+    {
+        const int frames = in.readInt();
+        const int mels = in.readInt();
+        if (frames < 0 || mels <= 0
+            || static_cast<juce::int64>(frames) * mels * static_cast<juce::int64>(sizeof(float))
+                   > in.getNumBytesRemaining())
+            return false;
+        mel = MelBuffer(static_cast<size_t>(frames), mels);
+        const auto bytes = static_cast<int>(mel.size() * static_cast<size_t>(mels) * sizeof(float));
+        return in.read(mel.data(), bytes) == bytes;
+    }
+    static void writeValue(juce::OutputStream& out, const F0EditRecord& record) { record.write(out); }
+    static bool readValue(juce::InputStream& in, F0EditRecord& record) { return record.read(in); }
+    template <typename T>
+    static void release(T& value) { value = T(); }
+
+    // Actions hold notes by id: pointers into Project::getNotes() do not
+    // survive the vector growing, or a note being removed and put back
+    static NoteId idOf(Project* project, Note* note)
+    {
+        return project && note ? project->getNoteId(*note) : 0;
+    }
+    static std::vector<NoteId> idsOf(Project* project, const std::vector<Note*>& notes)
+    {
+        std::vector<NoteId> ids;
+        ids.reserve(notes.size());
+        for (auto* note : notes)
+            ids.push_back(idOf(project, note));
+        return ids;
+    }
+    static Note* findNote(Project* project, NoteId id) { return project ? project->findNote(id) : nullptr; }
+    static NoteChangeFeed* feedOf(Project* project) { return project ? &project->getNoteChanges() : nullptr; }
 };
 
 /**
@@ -26,92 +137,88 @@ public:
 class PitchOffsetAction : public UndoableAction
 {
 public:
-    PitchOffsetAction(Note* note, float oldOffset, float newOffset)
-        : note(note), oldOffset(oldOffset), newOffset(newOffset) {}
+    PitchOffsetAction(Project* project, Note* note, float oldOffset, float newOffset)
+        : project(project), noteId(idOf(project, note)), oldOffset(oldOffset), newOffset(newOffset) {}
     
-    void undo() override { if (note) note->setPitchOffset(oldOffset); }
-    void redo() override { if (note) note->setPitchOffset(newOffset); }
+    void undo() override { apply(oldOffset); }
+    void redo() override { apply(newOffset); }
     juce::String getName() const override { return "Change Pitch Offset"; }
     
 private:
-    Note* note;
+    void apply(float offset)
+    {
+        if (auto* note = findNote(project, noteId)) {
+            note->setPitchOffset(offset);
+            project->noteChanged(*note);
+        }
+    }
+
+    Project* project;
+    NoteId noteId;
     float oldOffset;
     float newOffset;
 };
 
 /**
  * Action for changing multiple F0 values (hand-drawing).
+ *
+ * Consecutive strokes that overlap are coalesced into one action by
+ * mergeWith(), so redrawing a passage several times leaves a single step.
  */
-struct F0FrameEdit
-{
-    int idx = -1;
-    float oldF0 = 0.0f;
-    float newF0 = 0.0f;
-    float oldDelta = 0.0f;
-    float newDelta = 0.0f;
-    bool oldVoiced = false;
-    bool newVoiced = false;
-};
-
 class F0EditAction : public UndoableAction
 {
 public:
     F0EditAction(std::vector<float>* f0Array,
                  std::vector<float>* deltaPitchArray,
-                 std::vector<bool>* voicedMask,
+                 VoicedMask* voicedMask,
                  std::vector<F0FrameEdit> edits,
                  std::function<void(int, int)> onF0Changed = nullptr)
         : f0Array(f0Array), deltaPitchArray(deltaPitchArray), voicedMask(voicedMask), edits(std::move(edits)), onF0Changed(onF0Changed) {}
 
-    void undo() override
+    void undo() override { apply(false); }
+    void redo() override { apply(true); }
+
+    bool mergeWith(const UndoableAction& next) override
     {
-        if (!f0Array) return;
-        int minIdx = std::numeric_limits<int>::max();
-        int maxIdx = std::numeric_limits<int>::min();
-        for (const auto& e : edits)
-        {
-            if (e.idx >= 0 && e.idx < static_cast<int>(f0Array->size())) {
-                (*f0Array)[e.idx] = e.oldF0;
-                minIdx = std::min(minIdx, e.idx);
-                maxIdx = std::max(maxIdx, e.idx);
-            }
-            if (deltaPitchArray && e.idx >= 0 && e.idx < static_cast<int>(deltaPitchArray->size()))
-                (*deltaPitchArray)[e.idx] = e.oldDelta;
-            if (voicedMask && e.idx >= 0 && e.idx < static_cast<int>(voicedMask->size()))
-                (*voicedMask)[e.idx] = e.oldVoiced;
-        }
-        if (onF0Changed && minIdx <= maxIdx)
-            onF0Changed(minIdx, maxIdx);
+        const auto* other = dynamic_cast<const F0EditAction*>(&next);
+        if (!other || other->f0Array != f0Array || other->deltaPitchArray != deltaPitchArray
+            || other->voicedMask != voicedMask || edits.empty() || other->edits.empty())
+            return false;
+
+        // Only strokes over the same stretch of curve
+        if (other->edits.getFirstFrame() > edits.getLastFrame() + 1
+            || other->edits.getLastFrame() + 1 < edits.getFirstFrame())
+            return false;
+
+        edits.append(other->edits);
+        return true;
     }
 
-    void redo() override
+    juce::String getName() const override { return "Edit Pitch Curve"; }
+    size_t getMemoryBytes() const override { return edits.getMemoryBytes(); }
+
+    bool spill(juce::OutputStream& out) override
+    {
+        writeValue(out, edits);
+        release(edits);
+        return true;
+    }
+    bool readBack(juce::InputStream& in) override { return readValue(in, edits); }
+
+private:
+    void apply(bool useNewValues)
     {
         if (!f0Array) return;
-        int minIdx = std::numeric_limits<int>::max();
-        int maxIdx = std::numeric_limits<int>::min();
-        for (const auto& e : edits)
-        {
-            if (e.idx >= 0 && e.idx < static_cast<int>(f0Array->size())) {
-                (*f0Array)[e.idx] = e.newF0;
-                minIdx = std::min(minIdx, e.idx);
-                maxIdx = std::max(maxIdx, e.idx);
-            }
-            if (deltaPitchArray && e.idx >= 0 && e.idx < static_cast<int>(deltaPitchArray->size()))
-                (*deltaPitchArray)[e.idx] = e.newDelta;
-            if (voicedMask && e.idx >= 0 && e.idx < static_cast<int>(voicedMask->size()))
-                (*voicedMask)[e.idx] = e.newVoiced;
-        }
-        if (onF0Changed && minIdx <= maxIdx)
+        int minIdx = 0;
+        int maxIdx = -1;
+        if (edits.apply(useNewValues, *f0Array, deltaPitchArray, voicedMask, minIdx, maxIdx) && onF0Changed)
             onF0Changed(minIdx, maxIdx);
     }
 
-    juce::String getName() const override { return "Edit Pitch Curve"; }
-
-private:
     std::vector<float>* f0Array;
     std::vector<float>* deltaPitchArray;
-    std::vector<bool>* voicedMask;
-    std::vector<F0FrameEdit> edits;
+    VoicedMask* voicedMask;
+    F0EditRecord edits;
     std::function<void(int, int)> onF0Changed;  // Callback with (minFrame, maxFrame) to trigger resynthesis
 };
 
@@ -121,57 +228,53 @@ private:
 class NotePitchDragAction : public UndoableAction
 {
 public:
-    NotePitchDragAction(Note* note, std::vector<float>* f0Array,
+    NotePitchDragAction(Project* project, Note* note, std::vector<float>* f0Array,
                         float oldMidi, float newMidi,
                         std::vector<F0FrameEdit> f0Edits,
                         std::function<void(Note*)> onNoteChanged = nullptr)
-        : note(note), f0Array(f0Array), oldMidi(oldMidi), newMidi(newMidi),
+        : project(project), noteId(idOf(project, note)), f0Array(f0Array), oldMidi(oldMidi), newMidi(newMidi),
           f0Edits(std::move(f0Edits)), onNoteChanged(onNoteChanged) {}
 
-    void undo() override
+    void undo() override { apply(false); }
+    void redo() override { apply(true); }
+
+    juce::String getName() const override { return "Drag Note Pitch"; }
+    size_t getMemoryBytes() const override { return f0Edits.getMemoryBytes(); }
+
+    bool spill(juce::OutputStream& out) override
     {
-        if (note) {
-            note->setMidiNote(oldMidi);
-            note->markDirty();
-        }
-        if (f0Array) {
-            for (const auto& e : f0Edits) {
-                if (e.idx >= 0 && e.idx < static_cast<int>(f0Array->size()))
-                    (*f0Array)[e.idx] = e.oldF0;
-            }
-        }
-        // Notify that note changed, so base pitch can be recalculated
-        if (onNoteChanged && note) {
-            onNoteChanged(note);
-        }
+        writeValue(out, f0Edits);
+        release(f0Edits);
+        return true;
     }
+    bool readBack(juce::InputStream& in) override { return readValue(in, f0Edits); }
 
-    void redo() override
+private:
+    void apply(bool useNewValues)
     {
+        auto* note = findNote(project, noteId);
         if (note) {
-            note->setMidiNote(newMidi);
+            note->setMidiNote(useNewValues ? newMidi : oldMidi);
             note->markDirty();
         }
         if (f0Array) {
-            for (const auto& e : f0Edits) {
-                if (e.idx >= 0 && e.idx < static_cast<int>(f0Array->size()))
-                    (*f0Array)[e.idx] = e.newF0;
-            }
+            int minIdx, maxIdx;
+            f0Edits.apply(useNewValues, *f0Array, nullptr, nullptr, minIdx, maxIdx);
         }
-        // Notify that note changed, so base pitch can be recalculated
-        if (onNoteChanged && note) {
-            onNoteChanged(note);
+        if (note) {
+            // Subscribers rebuild the base pitch around it
+            project->noteChanged(*note);
+            if (onNoteChanged)
+                onNoteChanged(note);
         }
     }
 
-    juce::String getName() const override { return "Drag Note Pitch"; }
-
-private:
-    Note* note;
+    Project* project;
+    NoteId noteId;
     std::vector<float>* f0Array;
     float oldMidi;
     float newMidi;
-    std::vector<F0FrameEdit> f0Edits;
+    F0EditRecord f0Edits;
     std::function<void(Note*)> onNoteChanged;  // Callback when note MIDI changes
 };
 
@@ -181,57 +284,56 @@ private:
 class MultiNotePitchDragAction : public UndoableAction
 {
 public:
-    MultiNotePitchDragAction(std::vector<Note*> notes, std::vector<float>* f0Array,
+    MultiNotePitchDragAction(Project* project, const std::vector<Note*>& notes, std::vector<float>* f0Array,
                              std::vector<float> oldMidis, float pitchDelta,
                              std::vector<F0FrameEdit> f0Edits,
                              std::function<void(const std::vector<Note*>&)> onNotesChanged = nullptr)
-        : notes(std::move(notes)), f0Array(f0Array), oldMidis(std::move(oldMidis)),
+        : project(project), noteIds(idsOf(project, notes)), f0Array(f0Array), oldMidis(std::move(oldMidis)),
           pitchDelta(pitchDelta), f0Edits(std::move(f0Edits)), onNotesChanged(onNotesChanged) {}
 
-    void undo() override
+    void undo() override { apply(0.0f, false); }
+    void redo() override { apply(pitchDelta, true); }
+
+    juce::String getName() const override { return "Drag Multiple Notes"; }
+    size_t getMemoryBytes() const override { return bytesOf(noteIds) + bytesOf(oldMidis) + f0Edits.getMemoryBytes(); }
+
+    bool spill(juce::OutputStream& out) override
     {
-        for (size_t i = 0; i < notes.size() && i < oldMidis.size(); ++i) {
-            if (notes[i]) {
-                notes[i]->setMidiNote(oldMidis[i]);
-                notes[i]->markDirty();
-            }
-        }
-        if (f0Array) {
-            for (const auto& e : f0Edits) {
-                if (e.idx >= 0 && e.idx < static_cast<int>(f0Array->size()))
-                    (*f0Array)[e.idx] = e.oldF0;
-            }
-        }
-        if (onNotesChanged)
-            onNotesChanged(notes);
+        writeValue(out, f0Edits);
+        release(f0Edits);
+        return true;
     }
+    bool readBack(juce::InputStream& in) override { return readValue(in, f0Edits); }
 
-    void redo() override
+private:
+    void apply(float delta, bool useNewValues)
     {
-        for (size_t i = 0; i < notes.size() && i < oldMidis.size(); ++i) {
-            if (notes[i]) {
-                notes[i]->setMidiNote(oldMidis[i] + pitchDelta);
-                notes[i]->markDirty();
+        std::vector<Note*> notes;
+        {
+            NoteChangeFeed::ScopedBatch batch(feedOf(project));
+            for (size_t i = 0; i < noteIds.size() && i < oldMidis.size(); ++i) {
+                if (auto* note = findNote(project, noteIds[i])) {
+                    note->setMidiNote(oldMidis[i] + delta);
+                    note->markDirty();
+                    project->noteChanged(*note);
+                    notes.push_back(note);
+                }
             }
-        }
-        if (f0Array) {
-            for (const auto& e : f0Edits) {
-                if (e.idx >= 0 && e.idx < static_cast<int>(f0Array->size()))
-                    (*f0Array)[e.idx] = e.newF0;
+            if (f0Array) {
+                int minIdx, maxIdx;
+                f0Edits.apply(useNewValues, *f0Array, nullptr, nullptr, minIdx, maxIdx);
             }
         }
         if (onNotesChanged)
             onNotesChanged(notes);
     }
 
-    juce::String getName() const override { return "Drag Multiple Notes"; }
-
-private:
-    std::vector<Note*> notes;
+    Project* project;
+    std::vector<NoteId> noteIds;
     std::vector<float>* f0Array;
     std::vector<float> oldMidis;
     float pitchDelta;
-    std::vector<F0FrameEdit> f0Edits;
+    F0EditRecord f0Edits;
     std::function<void(const std::vector<Note*>&)> onNotesChanged;
 };
 
@@ -242,39 +344,34 @@ private:
 class NoteSnapToSemitoneAction : public UndoableAction
 {
 public:
-    NoteSnapToSemitoneAction(Note* note,
+    NoteSnapToSemitoneAction(Project* project, Note* note,
                              float oldMidi, float oldOffset,
                              float newMidi,
                              std::function<void(Note*)> onNoteChanged = nullptr)
-        : note(note), oldMidi(oldMidi), oldOffset(oldOffset),
+        : project(project), noteId(idOf(project, note)), oldMidi(oldMidi), oldOffset(oldOffset),
           newMidi(newMidi), onNoteChanged(onNoteChanged) {}
 
-    void undo() override
-    {
-        if (note) {
-            note->setMidiNote(oldMidi);
-            note->setPitchOffset(oldOffset);
-            note->markDirty();
-        }
-        if (onNoteChanged && note)
-            onNoteChanged(note);
-    }
+    void undo() override { apply(oldMidi, oldOffset); }
+    void redo() override { apply(newMidi, 0.0f); }
 
-    void redo() override
+    juce::String getName() const override { return "Snap to Semitone"; }
+
+private:
+    void apply(float midi, float offset)
     {
-        if (note) {
-            note->setMidiNote(newMidi);
-            note->setPitchOffset(0.0f);
-            note->markDirty();
-        }
-        if (onNoteChanged && note)
+        auto* note = findNote(project, noteId);
+        if (!note)
+            return;
+        note->setMidiNote(midi);
+        note->setPitchOffset(offset);
+        note->markDirty();
+        project->noteChanged(*note);
+        if (onNoteChanged)
             onNoteChanged(note);
     }
 
-    juce::String getName() const override { return "Snap to Semitone"; }
-
-private:
-    Note* note;
+    Project* project;
+    NoteId noteId;
     float oldMidi;
     float oldOffset;
     float newMidi;
@@ -287,76 +384,133 @@ private:
 class MultiNoteSnapToSemitoneAction : public UndoableAction
 {
 public:
-    MultiNoteSnapToSemitoneAction(const std::vector<Note*>& notes,
-                                  std::vector<float> oldMidis,
-                                  std::vector<float> oldOffsets,
-                                  std::vector<float> newMidis,
+    MultiNoteSnapToSemitoneAction(Project* project, std::vector<NoteBulkEdit::PitchChange> changes,
                                   std::function<void(const std::vector<Note*>&)> onNotesChanged = nullptr)
-        : notes(notes),
-          oldMidis(std::move(oldMidis)),
-          oldOffsets(std::move(oldOffsets)),
-          newMidis(std::move(newMidis)),
-          onNotesChanged(onNotesChanged) {}
+        : project(project), changes(std::move(changes)), onNotesChanged(onNotesChanged) {}
 
-    void undo() override
+    void undo() override { apply(false); }
+    void redo() override { apply(true); }
+
+    juce::String getName() const override { return "Snap Notes to Semitone"; }
+    size_t getMemoryBytes() const override { return bytesOf(changes); }
+
+private:
+    void apply(bool useNewPitch)
     {
-        for (size_t i = 0; i < notes.size(); ++i) {
-            auto* note = notes[i];
-            if (!note)
-                continue;
-            note->setMidiNote(oldMidis[i]);
-            note->setPitchOffset(oldOffsets[i]);
-            note->markDirty();
-        }
+        if (!project) return;
+        const auto notes = NoteBulkEdit::applyPitchChanges(*project, changes, useNewPitch);
         if (onNotesChanged)
             onNotesChanged(notes);
     }
 
-    void redo() override
+    Project* project;
+    std::vector<NoteBulkEdit::PitchChange> changes;
+    std::function<void(const std::vector<Note*>&)> onNotesChanged;
+};
+
+/**
+ * Action for correcting a take to a key (see ScaleCorrection): the notes'
+ * pitches and the drift inside them. Undo and redo only restore both; the
+ * curves are rebuilt from the reported note changes.
+ */
+class ScaleCorrectionAction : public UndoableAction
+{
+public:
+    ScaleCorrectionAction(Project* project, ScaleCorrection::Plan plan,
+                          std::function<void(const std::vector<Note*>&)> onNotesChanged = nullptr)
+        : project(project), plan(std::move(plan)), onNotesChanged(onNotesChanged) {}
+
+    void undo() override { apply(false); }
+    void redo() override { apply(true); }
+
+    juce::String getName() const override { return "Correct to Scale"; }
+    size_t getMemoryBytes() const override
     {
-        for (size_t i = 0; i < notes.size(); ++i) {
-            auto* note = notes[i];
-            if (!note)
-                continue;
-            note->setMidiNote(newMidis[i]);
-            note->setPitchOffset(0.0f);
-            note->markDirty();
-        }
+        return bytesOf(plan.pitchChanges) + plan.deltaEdits.getMemoryBytes();
+    }
+
+    // The drift of every note; the pitch changes are a few bytes per note
+    bool spill(juce::OutputStream& out) override
+    {
+        writeValue(out, plan.deltaEdits);
+        release(plan.deltaEdits);
+        return true;
+    }
+    bool readBack(juce::InputStream& in) override { return readValue(in, plan.deltaEdits); }
+
+private:
+    void apply(bool useNew)
+    {
+        if (!project) return;
+        const auto notes = ScaleCorrection::apply(*project, plan, useNew);
         if (onNotesChanged)
             onNotesChanged(notes);
     }
 
-    juce::String getName() const override { return "Snap Notes to Semitone"; }
+    Project* project;
+    ScaleCorrection::Plan plan;
+    std::function<void(const std::vector<Note*>&)> onNotesChanged;
+};
+
+/**
+ * Action for scaling the vibrato of a take (see VibratoIndex::planScale()):
+ * each changed note's added vibrato before and after.
+ */
+class VibratoScaleAction : public UndoableAction
+{
+public:
+    VibratoScaleAction(Project* project, std::vector<VibratoAnalysis::Change> changes,
+                       std::function<void(const std::vector<Note*>&)> onNotesChanged = nullptr)
+        : project(project), changes(std::move(changes)), onNotesChanged(onNotesChanged) {}
+
+    void undo() override { apply(false); }
+    void redo() override { apply(true); }
+
+    juce::String getName() const override { return "Scale Vibrato"; }
+    size_t getMemoryBytes() const override { return bytesOf(changes); }
 
 private:
-    std::vector<Note*> notes;
-    std::vector<float> oldMidis;
-    std::vector<float> oldOffsets;
-    std::vector<float> newMidis;
+    void apply(bool useNew)
+    {
+        if (!project) return;
+        const auto notes = VibratoIndex::apply(*project, changes, useNew);
+        if (onNotesChanged)
+            onNotesChanged(notes);
+    }
+
+    Project* project;
+    std::vector<VibratoAnalysis::Change> changes;
     std::function<void(const std::vector<Note*>&)> onNotesChanged;
 };
 
 /**
- * Action for splitting a note into two.
+ * Action for splitting a note in two. Only the ids, the frames and the
+ * original clips (views the parts slice) are kept; redo splits the first
+ * part again with Note::splitOff().
  */
 class NoteSplitAction : public UndoableAction
 {
 public:
-    NoteSplitAction(Project* proj, const Note& original, const Note& firstPart, const Note& secondPart,
+    // After the split: firstId kept the original's id, secondId is the part
+    // added after splitFrame
+    NoteSplitAction(Project* proj, NoteId firstId, NoteId secondId, int splitFrame, int originalEnd,
+                    WaveformClip originalClip, MelClip originalMel,
                     std::function<void()> onChanged = nullptr)
-        : project(proj), originalNote(original), firstNote(firstPart), secondNote(secondPart),
-          onChanged(onChanged) {}
+        : project(proj), firstId(firstId), secondId(secondId), splitFrame(splitFrame),
+          originalEnd(originalEnd), originalClip(std::move(originalClip)),
+          originalMel(std::move(originalMel)), onChanged(onChanged) {}
 
     void undo() override
     {
         if (!project) return;
-        // Remove the second note and restore original
-        project->removeNoteByStartFrame(secondNote.getStartFrame());
-        // Find and restore the first note to original state
-        for (auto& note : project->getNotes()) {
-            if (note.getStartFrame() == firstNote.getStartFrame()) {
-                note = originalNote;
-                break;
+        {
+            NoteChangeFeed::ScopedBatch batch(feedOf(project));
+            project->removeNote(secondId);
+            if (auto* note = findNote(project, firstId)) {
+                note->setEndFrame(originalEnd);
+                note->setClipWaveform(originalClip);
+                note->setClipMel(originalMel);
+                project->noteChanged(*note, note->getStartFrame(), splitFrame);
             }
         }
         if (onChanged) onChanged();
@@ -365,14 +519,15 @@ public:
     void redo() override
     {
         if (!project) return;
-        // Split again: modify first note and add second
-        for (auto& note : project->getNotes()) {
-            if (note.getStartFrame() == originalNote.getStartFrame()) {
-                note = firstNote;
-                break;
+        {
+            NoteChangeFeed::ScopedBatch batch(feedOf(project));
+            if (auto* note = findNote(project, firstId)) {
+                Note second = note->splitOff(splitFrame);
+                second.setId(secondId);
+                project->noteChanged(*note, note->getStartFrame(), originalEnd);
+                project->addNote(std::move(second));
             }
         }
-        project->addNote(secondNote);
         if (onChanged) onChanged();
     }
 
@@ -380,9 +535,12 @@ public:
 
 private:
     Project* project;
-    Note originalNote;
-    Note firstNote;
-    Note secondNote;
+    NoteId firstId;
+    NoteId secondId;
+    int splitFrame;
+    int originalEnd;
+    WaveformClip originalClip;
+    MelClip originalMel;
     std::function<void()> onChanged;
 };
 
@@ -392,29 +550,30 @@ private:
 class NoteTimingStretchAction : public UndoableAction
 {
 public:
-    NoteTimingStretchAction(Note* leftNote,
+    NoteTimingStretchAction(Project* project,
+                            Note* leftNote,
                             Note* rightNote,
                             std::vector<float>* deltaPitchArray,
-                            std::vector<bool>* voicedMaskArray,
-                            std::vector<std::vector<float>>* melSpectrogram,
+                            VoicedMask* voicedMaskArray,
+                            MelBuffer* melSpectrogram,
                             int rangeStart,
                             int rangeEnd,
                             int oldLeftStart, int oldLeftEnd,
                             int oldRightStart, int oldRightEnd,
                             int newLeftStart, int newLeftEnd,
                             int newRightStart, int newRightEnd,
-                            std::vector<float> oldLeftClip,
-                            std::vector<float> newLeftClip,
-                            std::vector<float> oldRightClip,
-                            std::vector<float> newRightClip,
+                            WaveformClip oldLeftClip,
+                            WaveformClip newLeftClip,
+                            WaveformClip oldRightClip,
+                            WaveformClip newRightClip,
                             std::vector<float> oldDelta,
                             std::vector<float> newDelta,
                             std::vector<bool> oldVoiced,
                             std::vector<bool> newVoiced,
-                            std::vector<std::vector<float>> oldMel,
-                            std::vector<std::vector<float>> newMel,
+                            MelBuffer oldMel,
+                            MelBuffer newMel,
                             std::function<void(int, int)> onRangeChanged = nullptr)
-        : left(leftNote), right(rightNote),
+        : project(project), leftId(idOf(project, leftNote)), rightId(idOf(project, rightNote)),
           deltaPitchArray(deltaPitchArray), voicedMaskArray(voicedMaskArray),
           melSpectrogram(melSpectrogram),
           rangeStart(rangeStart), rangeEnd(rangeEnd),
@@ -445,27 +604,51 @@ public:
 
     juce::String getName() const override { return "Stretch Note Timing"; }
 
+    size_t getMemoryBytes() const override
+    {
+        return oldLeftClip.getOwnedBytes() + newLeftClip.getOwnedBytes()
+             + oldRightClip.getOwnedBytes() + newRightClip.getOwnedBytes()
+             + bytesOf(oldDelta) + bytesOf(newDelta)
+             + bytesOf(oldVoiced) + bytesOf(newVoiced)
+             + oldMel.getNumBytes() + newMel.getNumBytes();
+    }
+
+    // The clips mostly view the rendered audio, so only the curves move
+    bool spill(juce::OutputStream& out) override
+    {
+        writeValue(out, oldDelta);
+        writeValue(out, newDelta);
+        writeValue(out, oldVoiced);
+        writeValue(out, newVoiced);
+        writeValue(out, oldMel);
+        writeValue(out, newMel);
+        release(oldDelta);
+        release(newDelta);
+        release(oldVoiced);
+        release(newVoiced);
+        release(oldMel);
+        release(newMel);
+        return true;
+    }
+    bool readBack(juce::InputStream& in) override
+    {
+        return readValue(in, oldDelta) && readValue(in, newDelta)
+            && readValue(in, oldVoiced) && readValue(in, newVoiced)
+            && readValue(in, oldMel) && readValue(in, newMel);
+    }
+
 private:
     void applyState(int leftStart, int leftEnd,
                     int rightStart, int rightEnd,
-                    const std::vector<float>& leftClip,
-                    const std::vector<float>& rightClip,
+                    const WaveformClip& leftClip,
+                    const WaveformClip& rightClip,
                     const std::vector<float>& delta,
                     const std::vector<bool>& voiced,
-                    const std::vector<std::vector<float>>& mel)
+                    const MelBuffer& mel)
     {
-        if (left) {
-            left->setStartFrame(leftStart);
-            left->setEndFrame(leftEnd);
-            left->markDirty();
-            left->setClipWaveform(leftClip);
-        }
-        if (right) {
-            right->setStartFrame(rightStart);
-            right->setEndFrame(rightEnd);
-            right->markDirty();
-            right->setClipWaveform(rightClip);
-        }
+        NoteChangeFeed::ScopedBatch batch(feedOf(project));
+        retime(findNote(project, leftId), leftStart, leftEnd, leftClip);
+        retime(findNote(project, rightId), rightStart, rightEnd, rightClip);
 
         if (deltaPitchArray && rangeEnd > rangeStart &&
             delta.size() == static_cast<size_t>(rangeEnd - rangeStart)) {
@@ -487,22 +670,33 @@ private:
 
         if (melSpectrogram && rangeEnd > rangeStart &&
             mel.size() == static_cast<size_t>(rangeEnd - rangeStart)) {
-            if (melSpectrogram->size() >= static_cast<size_t>(rangeEnd)) {
-                for (int i = rangeStart; i < rangeEnd; ++i)
-                    (*melSpectrogram)[static_cast<size_t>(i)] =
-                        mel[static_cast<size_t>(i - rangeStart)];
-            }
+            if (melSpectrogram->size() >= static_cast<size_t>(rangeEnd))
+                melSpectrogram->copyFrames(static_cast<size_t>(rangeStart), mel);
         }
 
         if (onRangeChanged && rangeEnd > rangeStart)
             onRangeChanged(rangeStart, rangeEnd);
     }
 
-    Note* left = nullptr;
-    Note* right = nullptr;
+    void retime(Note* note, int startFrame, int endFrame, const WaveformClip& clip)
+    {
+        if (!note)
+            return;
+        const int previousStart = note->getStartFrame();
+        const int previousEnd = note->getEndFrame();
+        note->setStartFrame(startFrame);
+        note->setEndFrame(endFrame);
+        note->markDirty();
+        note->setClipWaveform(clip);
+        project->noteChanged(*note, previousStart, previousEnd);
+    }
+
+    Project* project = nullptr;
+    NoteId leftId = 0;
+    NoteId rightId = 0;
     std::vector<float>* deltaPitchArray = nullptr;
-    std::vector<bool>* voicedMaskArray = nullptr;
-    std::vector<std::vector<float>>* melSpectrogram = nullptr;
+    VoicedMask* voicedMaskArray = nullptr;
+    MelBuffer* melSpectrogram = nullptr;
     int rangeStart = 0;
     int rangeEnd = 0;
     int oldLeftStart = 0;
@@ -513,16 +707,16 @@ private:
     int newLeftEnd = 0;
     int newRightStart = 0;
     int newRightEnd = 0;
-    std::vector<float> oldLeftClip;
-    std::vector<float> newLeftClip;
-    std::vector<float> oldRightClip;
-    std::vector<float> newRightClip;
+    WaveformClip oldLeftClip;
+    WaveformClip newLeftClip;
+    WaveformClip oldRightClip;
+    WaveformClip newRightClip;
     std::vector<float> oldDelta;
     std::vector<float> newDelta;
     std::vector<bool> oldVoiced;
     std::vector<bool> newVoiced;
-    std::vector<std::vector<float>> oldMel;
-    std::vector<std::vector<float>> newMel;
+    MelBuffer oldMel;
+    MelBuffer newMel;
     std::function<void(int, int)> onRangeChanged;
 };
 
@@ -532,12 +726,13 @@ private:
 class NoteTimingRippleAction : public UndoableAction
 {
 public:
-    NoteTimingRippleAction(Note* leftNote,
+    NoteTimingRippleAction(Project* project,
+                           Note* leftNote,
                            Note* rightNote,
-                           std::vector<Note*> rippleNotes,
+                           const std::vector<Note*>& rippleNotes,
                            std::vector<float>* deltaPitchArray,
-                           std::vector<bool>* voicedMaskArray,
-                           std::vector<std::vector<float>>* melSpectrogram,
+                           VoicedMask* voicedMaskArray,
+                           MelBuffer* melSpectrogram,
                            int rangeStart,
                            int rangeEnd,
                            int oldLeftStart, int oldLeftEnd,
@@ -546,18 +741,18 @@ public:
                            std::vector<int> oldNoteEnds,
                            std::vector<int> newNoteStarts,
                            std::vector<int> newNoteEnds,
-                           std::vector<float> oldLeftClip,
-                           std::vector<float> newLeftClip,
-                           std::vector<float> oldRightClip,
-                           std::vector<float> newRightClip,
+                           WaveformClip oldLeftClip,
+                           WaveformClip newLeftClip,
+                           WaveformClip oldRightClip,
+                           WaveformClip newRightClip,
                            std::vector<float> oldDelta,
                            std::vector<float> newDelta,
                            std::vector<bool> oldVoiced,
                            std::vector<bool> newVoiced,
-                           std::vector<std::vector<float>> oldMel,
-                           std::vector<std::vector<float>> newMel,
+                           MelBuffer oldMel,
+                           MelBuffer newMel,
                            std::function<void(int, int)> onRangeChanged = nullptr)
-        : left(leftNote), right(rightNote), rippleNotes(std::move(rippleNotes)),
+        : project(project), leftId(idOf(project, leftNote)), rightId(idOf(project, rightNote)), rippleIds(idsOf(project, rippleNotes)),
           deltaPitchArray(deltaPitchArray), voicedMaskArray(voicedMaskArray),
           melSpectrogram(melSpectrogram),
           rangeStart(rangeStart), rangeEnd(rangeEnd),
@@ -587,30 +782,73 @@ public:
 
     juce::String getName() const override { return "Ripple Stretch Timing"; }
 
+    size_t getMemoryBytes() const override {
+        return bytesOf(rippleIds)
+             + bytesOf(oldNoteStarts) + bytesOf(oldNoteEnds)
+             + bytesOf(newNoteStarts) + bytesOf(newNoteEnds)
+             + oldLeftClip.getOwnedBytes() + newLeftClip.getOwnedBytes()
+             + oldRightClip.getOwnedBytes() + newRightClip.getOwnedBytes()
+             + bytesOf(oldDelta) + bytesOf(newDelta)
+             + bytesOf(oldVoiced) + bytesOf(newVoiced)
+             + oldMel.getNumBytes() + newMel.getNumBytes();
+    }
+
+    bool spill(juce::OutputStream& out) override
+    {
+        writeValue(out, oldDelta);
+        writeValue(out, newDelta);
+        writeValue(out, oldVoiced);
+        writeValue(out, newVoiced);
+        writeValue(out, oldMel);
+        writeValue(out, newMel);
+        release(oldDelta);
+        release(newDelta);
+        release(oldVoiced);
+        release(newVoiced);
+        release(oldMel);
+        release(newMel);
+        return true;
+    }
+    bool readBack(juce::InputStream& in) override
+    {
+        return readValue(in, oldDelta) && readValue(in, newDelta)
+            && readValue(in, oldVoiced) && readValue(in, newVoiced)
+            && readValue(in, oldMel) && readValue(in, newMel);
+    }
+
 private:
     void applyState(int leftStart, int leftEnd,
                     const std::vector<int>& noteStarts,
                     const std::vector<int>& noteEnds,
-                    const std::vector<float>& leftClip,
-                    const std::vector<float>& rightClip,
+                    const WaveformClip& leftClip,
+                    const WaveformClip& rightClip,
                     const std::vector<float>& delta,
                     const std::vector<bool>& voiced,
-                    const std::vector<std::vector<float>>& mel)
+                    const MelBuffer& mel)
     {
-        if (left) {
+        NoteChangeFeed::ScopedBatch batch(feedOf(project));
+        if (auto* left = findNote(project, leftId)) {
+            const int previousStart = left->getStartFrame();
+            const int previousEnd = left->getEndFrame();
             left->setStartFrame(leftStart);
             left->setEndFrame(leftEnd);
             left->markDirty();
             left->setClipWaveform(leftClip);
+            project->noteChanged(*left, previousStart, previousEnd);
         }
-        if (right)
+        if (auto* right = findNote(project, rightId)) {
             right->setClipWaveform(rightClip);
+            project->noteChanged(*right);
+        }
 
-        for (size_t i = 0; i < rippleNotes.size() && i < noteStarts.size() && i < noteEnds.size(); ++i) {
-            if (rippleNotes[i]) {
-                rippleNotes[i]->setStartFrame(noteStarts[i]);
-                rippleNotes[i]->setEndFrame(noteEnds[i]);
-                rippleNotes[i]->markDirty();
+        for (size_t i = 0; i < rippleIds.size() && i < noteStarts.size() && i < noteEnds.size(); ++i) {
+            if (auto* note = findNote(project, rippleIds[i])) {
+                const int previousStart = note->getStartFrame();
+                const int previousEnd = note->getEndFrame();
+                note->setStartFrame(noteStarts[i]);
+                note->setEndFrame(noteEnds[i]);
+                note->markDirty();
+                project->noteChanged(*note, previousStart, previousEnd);
             }
         }
 
@@ -634,23 +872,21 @@ private:
 
         if (melSpectrogram && rangeEnd > rangeStart &&
             mel.size() == static_cast<size_t>(rangeEnd - rangeStart)) {
-            if (melSpectrogram->size() >= static_cast<size_t>(rangeEnd)) {
-                for (int i = rangeStart; i < rangeEnd; ++i)
-                    (*melSpectrogram)[static_cast<size_t>(i)] =
-                        mel[static_cast<size_t>(i - rangeStart)];
-            }
+            if (melSpectrogram->size() >= static_cast<size_t>(rangeEnd))
+                melSpectrogram->copyFrames(static_cast<size_t>(rangeStart), mel);
         }
 
         if (onRangeChanged && rangeEnd > rangeStart)
             onRangeChanged(rangeStart, rangeEnd);
     }
 
-    Note* left = nullptr;
-    Note* right = nullptr;
-    std::vector<Note*> rippleNotes;
+    Project* project = nullptr;
+    NoteId leftId = 0;
+    NoteId rightId = 0;
+    std::vector<NoteId> rippleIds;
     std::vector<float>* deltaPitchArray = nullptr;
-    std::vector<bool>* voicedMaskArray = nullptr;
-    std::vector<std::vector<float>>* melSpectrogram = nullptr;
+    VoicedMask* voicedMaskArray = nullptr;
+    MelBuffer* melSpectrogram = nullptr;
     int rangeStart = 0;
     int rangeEnd = 0;
     int oldLeftStart = 0;
@@ -661,44 +897,416 @@ private:
     std::vector<int> oldNoteEnds;
     std::vector<int> newNoteStarts;
     std::vector<int> newNoteEnds;
-    std::vector<float> oldLeftClip;
-    std::vector<float> newLeftClip;
-    std::vector<float> oldRightClip;
-    std::vector<float> newRightClip;
+    WaveformClip oldLeftClip;
+    WaveformClip newLeftClip;
+    WaveformClip oldRightClip;
+    WaveformClip newRightClip;
     std::vector<float> oldDelta;
     std::vector<float> newDelta;
     std::vector<bool> oldVoiced;
     std::vector<bool> newVoiced;
-    std::vector<std::vector<float>> oldMel;
-    std::vector<std::vector<float>> newMel;
+    MelBuffer oldMel;
+    MelBuffer newMel;
     std::function<void(int, int)> onRangeChanged;
 };
 
+/**
+ * Curves over a frame range, captured before and after an edit that
+ * rewrites them wholesale.
+ */
+struct CurveRangeState
+{
+    std::vector<float> basePitch;
+    std::vector<float> deltaPitch;
+    std::vector<float> baseF0;
+    std::vector<float> f0;
+    std::vector<bool> voiced;
+
+    static CurveRangeState capture(const AudioData& audioData, int startFrame, int endFrame)
+    {
+        CurveRangeState state;
+        auto slice = [startFrame, endFrame](const std::vector<float>& values) {
+            const auto end = std::min(static_cast<size_t>(endFrame), values.size());
+            const auto start = std::min(static_cast<size_t>(startFrame), end);
+            return std::vector<float>(values.begin() + static_cast<std::ptrdiff_t>(start),
+                                      values.begin() + static_cast<std::ptrdiff_t>(end));
+        };
+        state.basePitch = slice(audioData.basePitch);
+        state.deltaPitch = slice(audioData.deltaPitch);
+        state.baseF0 = slice(audioData.baseF0);
+        state.f0 = slice(audioData.f0);
+        for (int i = startFrame; i < endFrame && i < static_cast<int>(audioData.voicedMask.size()); ++i)
+            state.voiced.push_back(audioData.voicedMask[static_cast<size_t>(i)]);
+        return state;
+    }
+
+    void restore(AudioData& audioData, int startFrame) const
+    {
+        auto put = [startFrame](std::vector<float>& values, const std::vector<float>& slice) {
+            for (size_t i = 0; i < slice.size() && startFrame + i < values.size(); ++i)
+                values[startFrame + i] = slice[i];
+        };
+        put(audioData.basePitch, basePitch);
+        put(audioData.deltaPitch, deltaPitch);
+        put(audioData.baseF0, baseF0);
+        put(audioData.f0, f0);
+        for (size_t i = 0; i < voiced.size() && startFrame + i < audioData.voicedMask.size(); ++i)
+            audioData.voicedMask[startFrame + i] = voiced[i];
+    }
+
+    size_t getMemoryBytes() const
+    {
+        return (basePitch.capacity() + deltaPitch.capacity() + baseF0.capacity() + f0.capacity())
+                   * sizeof(float)
+               + voiced.capacity() / 8;
+    }
+};
+
+/**
+ * Action for re-analysing a frame range: swaps the notes detected there and
+ * the curves the splice rewrote.
+ */
+class RangeReanalysisAction : public UndoableAction
+{
+public:
+    RangeReanalysisAction(Project* proj, int rangeStart, int rangeEnd,
+                          std::vector<Note> oldNotes, std::vector<Note> newNotes,
+                          CurveRangeState oldCurves, CurveRangeState newCurves,
+                          std::function<void(int, int)> onRangeChanged = nullptr)
+        : project(proj), rangeStart(rangeStart), rangeEnd(rangeEnd),
+          oldNotes(std::move(oldNotes)), newNotes(std::move(newNotes)),
+          oldCurves(std::move(oldCurves)), newCurves(std::move(newCurves)),
+          onRangeChanged(std::move(onRangeChanged)) {}
+
+    void undo() override { apply(newNotes, oldNotes, oldCurves); }
+    void redo() override { apply(oldNotes, newNotes, newCurves); }
+
+    juce::String getName() const override { return "Re-analyze Range"; }
+
+    size_t getMemoryBytes() const override
+    {
+        size_t total = oldCurves.getMemoryBytes() + newCurves.getMemoryBytes();
+        for (const auto& note : oldNotes)
+            total += note.getMemoryBytes();
+        for (const auto& note : newNotes)
+            total += note.getMemoryBytes();
+        return total;
+    }
+
+    // Curves only; notes keep their clips, which mostly view the render
+    bool spill(juce::OutputStream& out) override
+    {
+        for (auto* curves : { &oldCurves, &newCurves })
+        {
+            writeValue(out, curves->basePitch);
+            writeValue(out, curves->deltaPitch);
+            writeValue(out, curves->baseF0);
+            writeValue(out, curves->f0);
+            writeValue(out, curves->voiced);
+            release(*curves);
+        }
+        return true;
+    }
+    bool readBack(juce::InputStream& in) override
+    {
+        for (auto* curves : { &oldCurves, &newCurves })
+            if (!readValue(in, curves->basePitch) || !readValue(in, curves->deltaPitch)
+                || !readValue(in, curves->baseF0) || !readValue(in, curves->f0)
+                || !readValue(in, curves->voiced))
+                return false;
+        return true;
+    }
+
+private:
+    void apply(const std::vector<Note>& removed, const std::vector<Note>& added,
+               const CurveRangeState& curves)
+    {
+        if (!project) return;
+        {
+            NoteChangeFeed::ScopedBatch batch(feedOf(project));
+            for (const auto& note : removed)
+                project->removeNoteByStartFrame(note.getStartFrame());
+            for (const auto& note : added)
+                project->addNote(note);
+        }
+        curves.restore(project->getAudioData(), rangeStart);
+        if (onRangeChanged && rangeEnd > rangeStart)
+            onRangeChanged(rangeStart, rangeEnd);
+    }
+
+    Project* project;
+    int rangeStart;
+    int rangeEnd;
+    std::vector<Note> oldNotes;
+    std::vector<Note> newNotes;
+    CurveRangeState oldCurves;
+    CurveRangeState newCurves;
+    std::function<void(int, int)> onRangeChanged;
+};
+
+/**
+ * Several actions recorded as one undo step (see
+ * PitchUndoManager::beginTransaction). Undo runs the children newest-first,
+ * redo oldest-first.
+ */
+class UndoGroupAction : public UndoableAction
+{
+public:
+    explicit UndoGroupAction(juce::String name) : name(std::move(name)) {}
+
+    void add(std::unique_ptr<UndoableAction> action)
+    {
+        if (!actions.empty() && actions.back()->mergeWith(*action))
+            return;
+        actions.push_back(std::move(action));
+    }
+
+    bool empty() const { return actions.empty(); }
+
+    void undo() override
+    {
+        for (auto it = actions.rbegin(); it != actions.rend(); ++it)
+            (*it)->undo();
+    }
+
+    void redo() override
+    {
+        for (auto& action : actions)
+            action->redo();
+    }
+
+    juce::String getName() const override
+    {
+        if (name.isNotEmpty() || actions.empty())
+            return name;
+        return actions.front()->getName();
+    }
+
+    size_t getMemoryBytes() const override
+    {
+        size_t total = bytesOf(actions);
+        for (const auto& action : actions)
+            total += action->getMemoryBytes();
+        return total;
+    }
+
+    // Each child's part is prefixed by whether it spilled and its length
+    bool spill(juce::OutputStream& out) override
+    {
+        bool spilled = false;
+        for (auto& action : actions)
+        {
+            juce::MemoryOutputStream part;
+            const bool moved = action->spill(part);
+            out.writeBool(moved);
+            if (moved)
+            {
+                out.writeInt64(static_cast<juce::int64>(part.getDataSize()));
+                out.write(part.getData(), part.getDataSize());
+            }
+            spilled = spilled || moved;
+        }
+        return spilled;
+    }
+    bool readBack(juce::InputStream& in) override
+    {
+        for (auto& action : actions)
+        {
+            if (!in.readBool())
+                continue;
+            const auto size = in.readInt64();
+            juce::MemoryBlock part;
+            if (size < 0 || size > in.getNumBytesRemaining()
+                || in.readIntoMemoryBlock(part, static_cast<ssize_t>(size)) != static_cast<size_t>(size))
+                return false;
+            juce::MemoryInputStream partIn(part, false);
+            if (!action->readBack(partIn))
+                return false;
+        }
+        return true;
+    }
+
+private:
+    juce::String name;
+    std::vector<std::unique_ptr<UndoableAction>> actions;
+};
+
 /**
  * Simple undo manager for the pitch editor.
+ *
+ * History is capped by step count and by a memory budget; past the budget
+ * the oldest steps are dropped as new ones arrive. An action added within
+ * the coalescing window of the previous one may be merged into it (see
+ * UndoableAction::mergeWith).
+ *
+ * Multi-step operations go between beginTransaction() and
+ * commitTransaction() to become one step. While a transaction is open, and
+ * while any step is undone or redone, isBatching() is true: listeners should
+ * hold expensive work such as resynthesis (the project's F0 dirty ranges
+ * keep accumulating meanwhile) and run it once from onBatchFinished.
  */
 class PitchUndoManager
 {
 public:
-    PitchUndoManager(size_t maxHistory = 100) : maxHistory(maxHistory) {}
+    static constexpr size_t defaultMemoryBudget = size_t(256) * 1024 * 1024;
+    static constexpr juce::uint32 defaultCoalesceWindowMs = 1000;
+
+    PitchUndoManager(size_t maxHistory = 100, size_t memoryBudget = defaultMemoryBudget)
+        : maxHistory(maxHistory), memoryBudget(memoryBudget) {}
     
     void addAction(std::unique_ptr<UndoableAction> action)
     {
+        if (transaction)
+        {
+            transaction->add(std::move(action));
+            return;
+        }
+
         // Clear redo stack when new action is added
         redoStack.clear();
         redoStack.shrink_to_fit();  // Release memory
 
-        undoStack.push_back(std::move(action));
+        const auto now = juce::Time::getMillisecondCounter();
+        const bool merged = canCoalesce && coalesceWindowMs > 0 && !undoStack.empty()
+                            && now - lastAddTimeMs <= coalesceWindowMs
+                            && undoStack.back()->mergeWith(*action);
+        if (!merged)
+            undoStack.push_back(std::move(action));
+        lastAddTimeMs = now;
+        canCoalesce = true;
 
         // Limit history size
-        while (undoStack.size() > maxHistory)
-        {
-            undoStack.erase(undoStack.begin());
-        }
+        if (maxHistory > 0 && undoStack.size() > maxHistory)
+            eraseOldest(undoStack.size() - maxHistory);
+        if (spillFile)
+            spillUntil(residentBytes);
+        if (memoryBudget > 0)
+            dropOldestUntil(memoryBudget);
 
         if (onHistoryChanged)
             onHistoryChanged();
     }
+
+    /** Bytes of history kept before the oldest steps go; 0 for no limit. */
+    void setMemoryBudget(size_t maxBytes)
+    {
+        memoryBudget = maxBytes;
+        if (memoryBudget > 0)
+            trimToBytes(memoryBudget);
+    }
+    size_t getMemoryBudget() const { return memoryBudget; }
+
+    /**
+     * Move undo steps to a scratch file, oldest first, while the history
+     * holds more than residentBytes; each is read back when it is undone.
+     * The most recent few steps always stay in memory. With a maxHistory of
+     * 0 the depth is then bounded by the disk alone, and the memory budget
+     * only drops steps that cannot be spilled.
+     */
+    void enableSpilling(size_t maxResidentBytes)
+    {
+        residentBytes = maxResidentBytes;
+        if (!spillFile)
+            spillFile = std::make_unique<UndoSpillFile>();
+        spillUntil(residentBytes);
+    }
+
+    /** Bytes of history currently kept in the scratch file. */
+    juce::int64 getSpilledBytes() const { return spillFile ? spillFile->getLiveBytes() : 0; }
+
+    /** Longest gap between two actions that may still be merged; 0 disables. */
+    void setCoalesceWindowMs(juce::uint32 ms) { coalesceWindowMs = ms; }
+
+    /**
+     * Start collecting actions into one undo step. Transactions nest; only
+     * the outermost commit records the step.
+     */
+    void beginTransaction(const juce::String& name = {})
+    {
+        if (transactionDepth++ == 0)
+        {
+            transaction = std::make_unique<UndoGroupAction>(name);
+            ++batchDepth;
+        }
+    }
+
+    /** Close the innermost transaction; the outermost one records its step. */
+    void commitTransaction()
+    {
+        if (transactionDepth == 0 || --transactionDepth > 0)
+            return;
+
+        auto group = std::move(transaction);
+        if (!group->empty())
+        {
+            // The group is complete; never fold a later stroke into it
+            addAction(std::move(group));
+            canCoalesce = false;
+        }
+        endBatch();
+    }
+
+    /** Undo everything recorded since the outermost beginTransaction(). */
+    void cancelTransaction()
+    {
+        if (transactionDepth == 0)
+            return;
+
+        transactionDepth = 0;
+        auto group = std::move(transaction);
+        ++replayDepth;
+        group->undo();
+        --replayDepth;
+        endBatch();
+    }
+
+    bool isInTransaction() const { return transactionDepth > 0; }
+
+    /** True while a transaction is open or a step is being undone/redone. */
+    bool isBatching() const { return batchDepth > 0; }
+
+    /**
+     * True while recorded steps are being undone or redone (or a transaction
+     * cancelled). Steps only restore their notes and report the changes;
+     * whoever derives curves from the notes rebuilds them meanwhile.
+     */
+    bool isReplaying() const { return replayDepth > 0; }
+
+    /**
+     * Commits on destruction unless cancel() or commit() was called, so an
+     * early return still records the steps taken so far.
+     */
+    class ScopedTransaction
+    {
+    public:
+        ScopedTransaction(PitchUndoManager* manager, const juce::String& name = {})
+            : manager(manager)
+        {
+            if (manager)
+                manager->beginTransaction(name);
+        }
+
+        ~ScopedTransaction() { commit(); }
+
+        void commit()
+        {
+            if (manager)
+                manager->commitTransaction();
+            manager = nullptr;
+        }
+
+        void cancel()
+        {
+            if (manager)
+                manager->cancelTransaction();
+            manager = nullptr;
+        }
+
+    private:
+        PitchUndoManager* manager;
+
+        JUCE_DECLARE_NON_COPYABLE(ScopedTransaction)
+    };
     
     bool canUndo() const { return !undoStack.empty(); }
     bool canRedo() const { return !redoStack.empty(); }
@@ -707,14 +1315,29 @@ public:
     {
         if (undoStack.empty()) return;
         
+        if (!pageIn(*undoStack.back()))
+        {
+            // Without this step the older ones cannot be replayed either
+            LOG_WARNING("Undo history could not be read back from disk; dropping it");
+            eraseOldest(undoStack.size());
+            if (onHistoryChanged)
+                onHistoryChanged();
+            return;
+        }
+
         auto action = std::move(undoStack.back());
         undoStack.pop_back();
         
+        ++batchDepth;
+        ++replayDepth;
         action->undo();
+        --replayDepth;
         redoStack.push_back(std::move(action));
+        canCoalesce = false;
         
         if (onHistoryChanged)
             onHistoryChanged();
+        endBatch();
     }
     
     void redo()
@@ -724,19 +1347,26 @@ public:
         auto action = std::move(redoStack.back());
         redoStack.pop_back();
         
+        ++batchDepth;
+        ++replayDepth;
         action->redo();
+        --replayDepth;
         undoStack.push_back(std::move(action));
+        canCoalesce = false;
         
         if (onHistoryChanged)
             onHistoryChanged();
+        endBatch();
     }
     
     void clear()
     {
+        eraseOldest(undoStack.size());
         undoStack.clear();
         undoStack.shrink_to_fit();  // Release memory
         redoStack.clear();
         redoStack.shrink_to_fit();  // Release memory
+        canCoalesce = false;
 
         if (onHistoryChanged)
             onHistoryChanged();
@@ -752,10 +1382,150 @@ public:
         return redoStack.empty() ? "" : redoStack.back()->getName();
     }
     
+    /** Approximate bytes held by the undo and redo stacks together. */
+    size_t getMemoryBytes() const
+    {
+        size_t total = 0;
+        for (const auto& action : undoStack)
+            total += action->getMemoryBytes();
+        for (const auto& action : redoStack)
+            total += action->getMemoryBytes();
+        return total;
+    }
+
+    /**
+     * Compact history until it holds at most maxBytes in memory: old undo
+     * steps are spilled to disk if spilling is enabled, then redo steps are
+     * dropped furthest first, then undo steps oldest-first, each only as far
+     * as needed. The most recent undo step is kept so the last edit can
+     * always be reverted. Returns the bytes released.
+     */
+    size_t trimToBytes(size_t maxBytes)
+    {
+        const size_t spilled = spillFile ? spillUntil(maxBytes) : 0;
+        const size_t released = spilled + dropOldestUntil(maxBytes);
+        if (released > 0 && onHistoryChanged)
+            onHistoryChanged();
+        return released;
+    }
+    
     std::function<void()> onHistoryChanged;
+
+    /** Called when the outermost batch ends (see isBatching()). */
+    std::function<void()> onBatchFinished;
     
 private:
+    void endBatch()
+    {
+        if (--batchDepth == 0 && onBatchFinished)
+            onBatchFinished();
+    }
+
+    size_t dropOldestUntil(size_t maxBytes)
+    {
+        const size_t before = getMemoryBytes();
+        size_t total = before;
+        if (total <= maxBytes)
+            return 0;
+
+        // Redo steps furthest from the current state first: the next redo
+        // is the one most likely to be wanted
+        size_t droppedRedo = 0;
+        while (total > maxBytes && droppedRedo < redoStack.size())
+            total -= redoStack[droppedRedo++]->getMemoryBytes();
+        if (droppedRedo > 0)
+        {
+            redoStack.erase(redoStack.begin(), redoStack.begin() + static_cast<std::ptrdiff_t>(droppedRedo));
+            if (redoStack.empty())
+                redoStack.shrink_to_fit();  // Release memory
+        }
+
+        size_t dropped = 0;
+        while (total > maxBytes && undoStack.size() - dropped > 1)
+            total -= undoStack[dropped++]->getMemoryBytes();
+        eraseOldest(dropped);
+        return before - total;
+    }
+
+    // Spill undo steps oldest-first, short of the last few, until at most
+    // maxBytes stay resident. Returns the bytes moved out of memory.
+    size_t spillUntil(size_t maxBytes)
+    {
+        const size_t before = getMemoryBytes();
+        size_t total = before;
+        const size_t kept = std::min(undoStack.size(), residentSteps);
+        for (size_t i = 0; i + kept < undoStack.size() && total > maxBytes; ++i)
+        {
+            auto& action = *undoStack[i];
+            if (spilledSteps.count(&action) > 0)
+                continue;
+
+            const size_t bytes = action.getMemoryBytes();
+            juce::MemoryOutputStream data;
+            if (!action.spill(data))
+                continue;
+
+            UndoSpillFile::Block block;
+            if (!spillFile->write(data.getData(), data.getDataSize(), block))
+            {
+                // Disk full or gone: keep this step and the rest in memory
+                juce::MemoryInputStream restore(data.getData(), data.getDataSize(), false);
+                action.readBack(restore);
+                break;
+            }
+            spilledSteps[&action] = block;
+            total = total - bytes + action.getMemoryBytes();
+        }
+        return before - total;
+    }
+
+    // Read a spilled step back into memory; false if its state is lost
+    bool pageIn(UndoableAction& action)
+    {
+        const auto it = spilledSteps.find(&action);
+        if (it == spilledSteps.end())
+            return true;
+
+        juce::MemoryBlock data;
+        bool restored = spillFile->read(it->second, data);
+        if (restored)
+        {
+            juce::MemoryInputStream in(data, false);
+            restored = action.readBack(in);
+        }
+        spillFile->release(it->second);
+        spilledSteps.erase(it);
+        return restored;
+    }
+
+    // Erase the count oldest undo steps along with their spilled state
+    void eraseOldest(size_t count)
+    {
+        const auto end = undoStack.begin() + static_cast<std::ptrdiff_t>(count);
+        for (auto it = undoStack.begin(); it != end; ++it)
+        {
+            const auto spilled = spilledSteps.find(it->get());
+            if (spilled == spilledSteps.end())
+                continue;
+            spillFile->release(spilled->second);
+            spilledSteps.erase(spilled);
+        }
+        undoStack.erase(undoStack.begin(), end);
+    }
+
     std::vector<std::unique_ptr<UndoableAction>> undoStack;
     std::vector<std::unique_ptr<UndoableAction>> redoStack;
-    size_t maxHistory;
+    size_t maxHistory;  // 0 for no limit
+    size_t memoryBudget;
+    static constexpr size_t residentSteps = 8;  // Never spilled, so recent undos stay instant
+    size_t residentBytes = 0;
+    std::unique_ptr<UndoSpillFile> spillFile;
+    std::unordered_map<const UndoableAction*, UndoSpillFile::Block> spilledSteps;
+    juce::uint32 coalesceWindowMs = defaultCoalesceWindowMs;
+    juce::uint32 lastAddTimeMs = 0;
+    bool canCoalesce = false;  // Cleared by undo/redo/clear so only fresh edits merge
+    std::unique_ptr<UndoGroupAction> transaction;
+    int transactionDepth = 0;
+    int batchDepth = 0;
+    int replayDepth = 0;
 };
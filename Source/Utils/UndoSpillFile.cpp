@@ -0,0 +1,71 @@
+#include "UndoSpillFile.h"
+#include "AppLogger.h"
+
+UndoSpillFile::UndoSpillFile()
+    : file(juce::File::getSpecialLocation(juce::File::tempDirectory)
+               .getNonexistentChildFile("HachiTuneUndo", ".bin"))
+{
+}
+
+UndoSpillFile::~UndoSpillFile()
+{
+    in.reset();
+    out.reset();
+    file.deleteFile();
+}
+
+bool UndoSpillFile::write(const void* data, size_t size, Block& block)
+{
+    if (!out)
+    {
+        out = std::make_unique<juce::FileOutputStream>(file);
+        if (out->failedToOpen())
+        {
+            LOG("UndoSpillFile: cannot create " + file.getFullPathName());
+            out.reset();
+            return false;
+        }
+        out->setPosition(0);
+        out->truncate();
+    }
+
+    block.offset = out->getPosition();
+    block.size = static_cast<juce::int64>(size);
+    if (!out->write(data, size))
+    {
+        out->setPosition(block.offset);
+        return false;
+    }
+    // Readers open the file separately and must see every block
+    out->flush();
+    liveBytes += block.size;
+    ++liveBlocks;
+    return true;
+}
+
+bool UndoSpillFile::read(const Block& block, juce::MemoryBlock& dest)
+{
+    if (!in)
+        in = std::make_unique<juce::FileInputStream>(file);
+    if (in->failedToOpen() || !in->setPosition(block.offset))
+    {
+        in.reset();
+        return false;
+    }
+    dest.setSize(static_cast<size_t>(block.size));
+    return in->read(dest.getData(), static_cast<int>(block.size)) == static_cast<int>(block.size);
+}
+
+void UndoSpillFile::release(const Block& block)
+{
+    liveBytes -= block.size;
+    if (--liveBlocks > 0 || !out)
+        return;
+
+    // Nothing refers to the file any more; start it over
+    liveBytes = 0;
+    liveBlocks = 0;
+    in.reset();
+    out->setPosition(0);
+    out->truncate();
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "../JuceHeader.h"
+
+/**
+ * Temporary file holding the spilled state of old undo steps (see
+ * UndoableAction::spill()).
+ *
+ * Blocks are appended and read back by the position write() returned.
+ * Space is not reused block by block: once every block written has been
+ * released, the file is emptied and writing starts again at its beginning.
+ * The file is deleted with the object. Message thread only, like the undo
+ * manager that owns it.
+ */
+class UndoSpillFile
+{
+public:
+    struct Block
+    {
+        juce::int64 offset = 0;
+        juce::int64 size = 0;
+    };
+
+    UndoSpillFile();
+    ~UndoSpillFile();
+
+    /** Append size bytes; false if the file cannot be written. */
+    bool write(const void* data, size_t size, Block& block);
+
+    /** Read a block back into dest; false on a short read. */
+    bool read(const Block& block, juce::MemoryBlock& dest);
+
+    /** The step that owns block no longer needs it. */
+    void release(const Block& block);
+
+    /** Bytes of blocks written and not yet released. */
+    juce::int64 getLiveBytes() const { return liveBytes; }
+
+private:
+    juce::File file;
+    std::unique_ptr<juce::FileOutputStream> out;
+    std::unique_ptr<juce::FileInputStream> in;
+    juce::int64 liveBytes = 0;
+    int liveBlocks = 0;
+
+    JUCE_DECLARE_NON_COPYABLE(UndoSpillFile)
+};
@@ -0,0 +1,307 @@
+#include "VibratoAnalysis.h"
+#include "Constants.h"
+#include "JobSystem.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    constexpr double framesPerSecond = static_cast<double>(SAMPLE_RATE) / HOP_SIZE;
+    constexpr double minRateHz = 3.0;
+    constexpr double maxRateHz = 9.0;
+    constexpr int edgeFrames = 6;             // ~70 ms of onset and release left out
+    constexpr double minCorrelation = 0.3;    // Weaker periodicity is not vibrato
+    constexpr double minDepthSemitones = 0.03;
+    constexpr size_t segmentsPerJob = 32;
+
+    constexpr double pi = 3.14159265358979323846;
+} // namespace
+
+namespace VibratoAnalysis
+{
+    Estimate estimate(const float* deltaPitch, int count)
+    {
+        const int minLag = static_cast<int>(std::floor(framesPerSecond / maxRateHz));
+        const int n = count - 2 * edgeFrames;
+        const int maxLag = std::min(static_cast<int>(std::ceil(framesPerSecond / minRateHz)), n / 2);
+        // Two periods at least, and a neighbour on each side of every lag tried
+        if (n <= 0 || maxLag < 2 * minLag)
+            return {};
+
+        // Residual of a least-squares line through the frames kept
+        const float* x = deltaPitch + edgeFrames;
+        const double meanT = (n - 1) / 2.0;
+        double meanX = 0.0;
+        for (int i = 0; i < n; ++i)
+            meanX += x[i];
+        meanX /= n;
+        double stx = 0.0, stt = 0.0;
+        for (int i = 0; i < n; ++i)
+        {
+            stx += (i - meanT) * (x[i] - meanX);
+            stt += (i - meanT) * (i - meanT);
+        }
+        const double slope = stt > 0.0 ? stx / stt : 0.0;
+        std::vector<double> r(static_cast<size_t>(n));
+        for (int i = 0; i < n; ++i)
+            r[static_cast<size_t>(i)] = x[i] - meanX - slope * (i - meanT);
+
+        // Normalised autocorrelation over the lags of 3 to 9 Hz and one either side
+        std::vector<double> correlation(static_cast<size_t>(maxLag + 2), 0.0);
+        for (int lag = minLag - 1; lag <= maxLag + 1 && lag < n; ++lag)
+        {
+            double sum = 0.0, energyA = 0.0, energyB = 0.0;
+            for (int i = 0; i + lag < n; ++i)
+            {
+                sum += r[static_cast<size_t>(i)] * r[static_cast<size_t>(i + lag)];
+                energyA += r[static_cast<size_t>(i)] * r[static_cast<size_t>(i)];
+                energyB += r[static_cast<size_t>(i + lag)] * r[static_cast<size_t>(i + lag)];
+            }
+            const double energy = std::sqrt(energyA * energyB);
+            correlation[static_cast<size_t>(lag)] = energy > 0.0 ? sum / energy : 0.0;
+        }
+
+        // The shortest lag peaking nearly as high as the highest peak, so a
+        // multiple of the period is not taken for it
+        auto isPeak = [&correlation](int lag) {
+            const double value = correlation[static_cast<size_t>(lag)];
+            return value >= minCorrelation && value >= correlation[static_cast<size_t>(lag - 1)]
+                && value > correlation[static_cast<size_t>(lag + 1)];
+        };
+        const int lastLag = std::min(maxLag, n - 2);
+        double highest = 0.0;
+        for (int lag = minLag; lag <= lastLag; ++lag)
+            if (isPeak(lag))
+                highest = std::max(highest, correlation[static_cast<size_t>(lag)]);
+        int bestLag = 0;
+        for (int lag = minLag; lag <= lastLag && bestLag == 0; ++lag)
+            if (isPeak(lag) && correlation[static_cast<size_t>(lag)] >= 0.85 * highest)
+                bestLag = lag;
+        if (bestLag == 0)
+            return {};
+
+        // Parabola through the peak and its neighbours for a fractional lag
+        const double before = correlation[static_cast<size_t>(bestLag - 1)];
+        const double peak = correlation[static_cast<size_t>(bestLag)];
+        const double after = correlation[static_cast<size_t>(bestLag + 1)];
+        const double curvature = before - 2.0 * peak + after;
+        const double lag = bestLag + (curvature < 0.0 ? 0.5 * (before - after) / curvature : 0.0);
+
+        // Least-squares sine at that rate, timed from the note's start
+        const double omega = 2.0 * pi / lag;
+        double ss = 0.0, sc = 0.0, cc = 0.0, rs = 0.0, rc = 0.0;
+        for (int i = 0; i < n; ++i)
+        {
+            const double phase = omega * (i + edgeFrames);
+            const double s = std::sin(phase);
+            const double c = std::cos(phase);
+            ss += s * s;
+            sc += s * c;
+            cc += c * c;
+            rs += r[static_cast<size_t>(i)] * s;
+            rc += r[static_cast<size_t>(i)] * c;
+        }
+        const double determinant = ss * cc - sc * sc;
+        if (determinant <= 0.0)
+            return {};
+        const double a = (rs * cc - rc * sc) / determinant; // a sin + b cos = depth sin(phase + phi)
+        const double b = (rc * ss - rs * sc) / determinant;
+        const double depth = std::sqrt(a * a + b * b);
+        if (depth < minDepthSemitones)
+            return {};
+
+        Estimate result;
+        result.rateHz = static_cast<float>(framesPerSecond / lag);
+        result.depthSemitones = static_cast<float>(depth);
+        result.phaseRadians = static_cast<float>(std::atan2(b, a));
+        return result;
+    }
+
+    std::vector<Estimate> estimateSegments(const std::vector<float>& deltaPitch,
+                                           const std::vector<std::pair<int, int>>& segments)
+    {
+        std::vector<Estimate> results(segments.size());
+        auto estimateRange = [&](size_t first, size_t last) {
+            for (size_t i = first; i < last; ++i)
+            {
+                const int start = std::clamp(segments[i].first, 0, static_cast<int>(deltaPitch.size()));
+                const int end = std::clamp(segments[i].second, start, static_cast<int>(deltaPitch.size()));
+                results[i] = estimate(deltaPitch.data() + start, end - start);
+            }
+        };
+
+        if (segments.size() <= segmentsPerJob)
+        {
+            estimateRange(0, segments.size());
+            return results;
+        }
+
+        // Each job writes its own slots; the curve stays untouched until all finish
+        JobSystem::Group jobs;
+        for (size_t first = 0; first < segments.size(); first += segmentsPerJob)
+        {
+            const size_t last = std::min(first + segmentsPerJob, segments.size());
+            jobs.submit(JobSystem::Priority::Interactive, [&estimateRange, first, last]() {
+                estimateRange(first, last);
+            });
+        }
+        jobs.wait();
+        return results;
+    }
+
+    Parameters Parameters::of(const Note& note)
+    {
+        return { note.isVibratoEnabled(), note.getVibratoRateHz(), note.getVibratoDepthSemitones(),
+                 note.getVibratoPhaseRadians() };
+    }
+
+    void Parameters::applyTo(Note& note) const
+    {
+        note.setVibratoEnabled(enabled);
+        note.setVibratoRateHz(rateHz);
+        note.setVibratoDepthSemitones(depthSemitones);
+        note.setVibratoPhaseRadians(phaseRadians);
+    }
+} // namespace VibratoAnalysis
+
+void VibratoIndex::setProject(Project* newProject)
+{
+    noteSubscription.reset();
+    curveSubscription.reset();
+    project = newProject;
+    needsFullUpdate = true;
+    dirtyRanges.clear();
+    estimates.clear();
+    if (!project)
+        return;
+
+    noteSubscription = project->getNoteChanges().subscribe([this](const std::vector<NoteChange>& changes) {
+        for (const auto& change : changes)
+        {
+            if (change.type == NoteChange::Type::Reset)
+                needsFullUpdate = true;
+            else if (change.type == NoteChange::Type::Removed)
+                estimates.erase(change.id);
+            else
+                markDirty(change.startFrame, change.endFrame);
+        }
+    });
+    curveSubscription = project->getCurveChanges().subscribe([this](const std::vector<NoteChange>& changes) {
+        for (const auto& change : changes)
+            markDirty(change.startFrame, change.endFrame);
+    });
+}
+
+void VibratoIndex::markDirty(int startFrame, int endFrame)
+{
+    if (!needsFullUpdate && endFrame > startFrame)
+        dirtyRanges.emplace_back(startFrame, endFrame);
+}
+
+void VibratoIndex::update()
+{
+    if (!project)
+        return;
+
+    std::vector<Note*> notes;
+    if (std::exchange(needsFullUpdate, false))
+    {
+        estimates.clear();
+        for (auto& note : project->getNotes())
+            notes.push_back(&note);
+    }
+    else if (!dirtyRanges.empty())
+    {
+        for (const auto& [start, end] : dirtyRanges)
+            for (auto* note : project->getNotesInRange(start, end))
+                notes.push_back(note);
+        // A note over several ranges is estimated once
+        std::sort(notes.begin(), notes.end());
+        notes.erase(std::unique(notes.begin(), notes.end()), notes.end());
+    }
+    dirtyRanges.clear();
+
+    std::vector<std::pair<int, int>> segments;
+    std::vector<NoteId> ids;
+    for (auto* note : notes)
+    {
+        const NoteId id = project->getNoteId(*note);
+        if (note->isRest())
+        {
+            estimates.erase(id);
+            continue;
+        }
+        segments.emplace_back(note->getStartFrame(), note->getEndFrame());
+        ids.push_back(id);
+    }
+    if (segments.empty())
+        return;
+
+    const auto results = VibratoAnalysis::estimateSegments(project->getAudioData().deltaPitch, segments);
+    for (size_t i = 0; i < ids.size(); ++i)
+    {
+        if (results[i].found())
+            estimates[ids[i]] = results[i];
+        else
+            estimates.erase(ids[i]);
+    }
+}
+
+VibratoAnalysis::Estimate VibratoIndex::getEstimate(NoteId id) const
+{
+    const auto found = estimates.find(id);
+    return found != estimates.end() ? found->second : VibratoAnalysis::Estimate {};
+}
+
+std::vector<VibratoAnalysis::Change> VibratoIndex::planScale(float scale) const
+{
+    std::vector<VibratoAnalysis::Change> changes;
+    if (!project)
+        return changes;
+
+    scale = std::max(0.0f, scale);
+    for (auto& note : project->getNotes())
+    {
+        if (note.isRest())
+            continue;
+        const auto found = estimates.find(note.getId());
+        if (found == estimates.end())
+            continue;
+
+        // The added vibrato sums with the sung one; against it when it shrinks
+        const auto& sung = found->second;
+        VibratoAnalysis::Parameters added;
+        added.rateHz = sung.rateHz;
+        added.depthSemitones = std::abs(scale - 1.0f) * sung.depthSemitones;
+        added.phaseRadians = sung.phaseRadians + (scale < 1.0f ? static_cast<float>(pi) : 0.0f);
+        added.enabled = added.depthSemitones > 0.0001f;
+
+        const auto current = VibratoAnalysis::Parameters::of(note);
+        if (current.enabled == added.enabled
+            && (!added.enabled
+                || (current.rateHz == added.rateHz && current.depthSemitones == added.depthSemitones
+                    && current.phaseRadians == added.phaseRadians)))
+            continue;
+        changes.push_back({ note.getId(), current, added });
+    }
+    return changes;
+}
+
+std::vector<Note*> VibratoIndex::apply(Project& project, const std::vector<VibratoAnalysis::Change>& changes,
+                                       bool useNew)
+{
+    std::vector<Note*> notes;
+    notes.reserve(changes.size());
+    NoteChangeFeed::ScopedBatch batch(&project.getNoteChanges());
+    for (const auto& change : changes)
+    {
+        auto* note = project.findNote(change.noteId);
+        if (!note)
+            continue;
+        (useNew ? change.newParameters : change.oldParameters).applyTo(*note);
+        note->markDirty();
+        project.noteChanged(*note);
+        notes.push_back(note);
+    }
+    return notes;
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "../Models/NoteChangeFeed.h"
+#include "../Models/Project.h"
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/**
+ * Vibrato of the sung notes, estimated from deltaPitch, and scaling it
+ * across a whole take.
+ *
+ * A note's vibrato is the strongest periodicity of its drift between 3 and
+ * 9 Hz, found by autocorrelation once the onset and release and a linear
+ * trend are taken out; rate, depth and phase come from a least-squares sine
+ * fit at that rate. Scaling does not touch the curves: each note is given
+ * added vibrato (Note's vibrato parameters) in phase with its own to deepen
+ * it, or against it to flatten it, so any scale can be set and undone
+ * instantly.
+ */
+namespace VibratoAnalysis
+{
+    struct Estimate
+    {
+        float rateHz = 0.0f;
+        float depthSemitones = 0.0f; // Peak, as Note's vibrato depth; 0 for none
+        float phaseRadians = 0.0f;   // At the note's start frame
+
+        bool found() const { return depthSemitones > 0.0f; }
+    };
+
+    /** Vibrato of count frames of drift; none if it has no clear periodicity. */
+    Estimate estimate(const float* deltaPitch, int count);
+
+    /** estimate() for each [start, end) segment of deltaPitch, in parallel on the job system. */
+    std::vector<Estimate> estimateSegments(const std::vector<float>& deltaPitch,
+                                           const std::vector<std::pair<int, int>>& segments);
+
+    /** Note's added vibrato parameters. */
+    struct Parameters
+    {
+        bool enabled = false;
+        float rateHz = 5.0f;
+        float depthSemitones = 0.0f;
+        float phaseRadians = 0.0f;
+
+        static Parameters of(const Note& note);
+        void applyTo(Note& note) const;
+    };
+
+    struct Change
+    {
+        NoteId noteId = 0;
+        Parameters oldParameters;
+        Parameters newParameters;
+    };
+} // namespace VibratoAnalysis
+
+/**
+ * Vibrato estimates of every non-rest note of a project, kept up to date
+ * from its note and curve changes: update() re-estimates only the notes
+ * over frames that changed since the last call.
+ *
+ * Message thread only, like the project's change feeds.
+ */
+class VibratoIndex
+{
+public:
+    VibratoIndex() = default;
+
+    /** Follow project's edits (null to stop); every note is estimated on the next update(). */
+    void setProject(Project* project);
+
+    /** Re-estimate the notes edited since the last update, in parallel. */
+    void update();
+
+    /** The last estimate of a note; none if it has no vibrato or is unknown. */
+    VibratoAnalysis::Estimate getEstimate(NoteId id) const;
+
+    /**
+     * Changes giving every note with vibrato scale times its own depth
+     * (0 flattens it, 1 leaves it as sung); notes already there are left
+     * out. Call update() first.
+     */
+    std::vector<VibratoAnalysis::Change> planScale(float scale) const;
+
+    /** Give each note its new (or old) parameters, mark it dirty and post the changes as one batch. */
+    static std::vector<Note*> apply(Project& project, const std::vector<VibratoAnalysis::Change>& changes,
+                                    bool useNew);
+
+private:
+    void markDirty(int startFrame, int endFrame);
+
+    Project* project = nullptr;
+    NoteChangeFeed::Subscription noteSubscription;
+    NoteChangeFeed::Subscription curveSubscription;
+
+    bool needsFullUpdate = true;
+    std::vector<std::pair<int, int>> dirtyRanges; // Unsorted; merged by update()
+    std::unordered_map<NoteId, VibratoAnalysis::Estimate> estimates;
+};
@@ -0,0 +1,169 @@
+#include "VoicedMask.h"
+#include <algorithm>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace
+{
+    // Index of the lowest set bit; word must be non-zero
+    inline int lowestBit(uint64_t word)
+    {
+#if defined(_MSC_VER)
+        unsigned long index = 0;
+        _BitScanForward64(&index, word);
+        return static_cast<int>(index);
+#else
+        return __builtin_ctzll(word);
+#endif
+    }
+
+    // Index of the highest set bit; word must be non-zero
+    inline int highestBit(uint64_t word)
+    {
+#if defined(_MSC_VER)
+        unsigned long index = 0;
+        _BitScanReverse64(&index, word);
+        return static_cast<int>(index);
+#else
+        return 63 - __builtin_clzll(word);
+#endif
+    }
+
+    inline int popCount(uint64_t word)
+    {
+#if defined(_MSC_VER)
+        return static_cast<int>(__popcnt64(word));
+#else
+        return __builtin_popcountll(word);
+#endif
+    }
+
+    // Mask of bits [from, 64)
+    inline uint64_t bitsFrom(int from) { return from >= 64 ? 0 : ~uint64_t(0) << from; }
+
+    // Mask of bits [0, to)
+    inline uint64_t bitsBelow(int to) { return to >= 64 ? ~uint64_t(0) : (uint64_t(1) << to) - 1; }
+}
+
+VoicedMask::VoicedMask(const std::vector<bool>& values)
+{
+    assign(values.size(), false);
+    for (size_t i = 0; i < values.size(); ++i)
+        if (values[i])
+            set(i, true);
+}
+
+void VoicedMask::assign(size_t numFrames, bool value)
+{
+    numBits = numFrames;
+    words.assign((numFrames + 63) / 64, value ? ~uint64_t(0) : uint64_t(0));
+    clearTail();
+}
+
+void VoicedMask::resize(size_t numFrames, bool value)
+{
+    const size_t oldBits = numBits;
+    numBits = numFrames;
+    words.resize((numFrames + 63) / 64, value ? ~uint64_t(0) : uint64_t(0));
+    if (numFrames > oldBits && value)
+        fill(static_cast<int>(oldBits), static_cast<int>(numFrames), true);
+    clearTail();
+}
+
+void VoicedMask::assignWords(const uint64_t* source, size_t numFrames)
+{
+    numBits = numFrames;
+    words.assign(source, source + (numFrames + 63) / 64);
+    clearTail();
+}
+
+void VoicedMask::clearTail()
+{
+    const int tailBits = static_cast<int>(numBits & 63);
+    if (tailBits != 0 && !words.empty())
+        words.back() &= bitsBelow(tailBits);
+}
+
+void VoicedMask::fill(int start, int end, bool value)
+{
+    start = std::max(start, 0);
+    end = std::min(end, static_cast<int>(numBits));
+    while (start < end)
+    {
+        const int bit = start & 63;
+        const int count = std::min(64 - bit, end - start);
+        const uint64_t mask = bitsFrom(bit) & bitsBelow(bit + count);
+        auto& word = words[static_cast<size_t>(start >> 6)];
+        word = value ? (word | mask) : (word & ~mask);
+        start += count;
+    }
+}
+
+int VoicedMask::findNext(int from, bool value) const
+{
+    const int size = static_cast<int>(numBits);
+    from = std::max(from, 0);
+    if (from >= size)
+        return size;
+
+    size_t wordIndex = static_cast<size_t>(from >> 6);
+    uint64_t word = (value ? words[wordIndex] : ~words[wordIndex]) & bitsFrom(from & 63);
+    while (word == 0)
+    {
+        if (++wordIndex >= words.size())
+            return size;
+        word = value ? words[wordIndex] : ~words[wordIndex];
+    }
+    // Inverted tail bits may report a frame past the end
+    return std::min(size, static_cast<int>(wordIndex * 64) + lowestBit(word));
+}
+
+int VoicedMask::findPrev(int before, bool value) const
+{
+    before = std::min(before, static_cast<int>(numBits));
+    if (before <= 0)
+        return -1;
+
+    const int last = before - 1;
+    size_t wordIndex = static_cast<size_t>(last >> 6);
+    uint64_t word = (value ? words[wordIndex] : ~words[wordIndex]) & bitsBelow((last & 63) + 1);
+    while (word == 0)
+    {
+        if (wordIndex == 0)
+            return -1;
+        --wordIndex;
+        word = value ? words[wordIndex] : ~words[wordIndex];
+    }
+    return static_cast<int>(wordIndex * 64) + highestBit(word);
+}
+
+int VoicedMask::countVoiced(int start, int end) const
+{
+    start = std::max(start, 0);
+    end = std::min(end, static_cast<int>(numBits));
+    int count = 0;
+    while (start < end)
+    {
+        const int bit = start & 63;
+        const int span = std::min(64 - bit, end - start);
+        count += popCount(words[static_cast<size_t>(start >> 6)] & bitsFrom(bit) & bitsBelow(bit + span));
+        start += span;
+    }
+    return count;
+}
+
+std::vector<bool> VoicedMask::slice(int start, int end) const
+{
+    start = std::max(start, 0);
+    end = std::min(end, static_cast<int>(numBits));
+    std::vector<bool> result;
+    if (end <= start)
+        return result;
+
+    result.reserve(static_cast<size_t>(end - start));
+    for (int i = start; i < end; ++i)
+        result.push_back(test(static_cast<size_t>(i)));
+    return result;
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Packed per-frame voiced/unvoiced mask (true = voiced).
+ *
+ * Bits are stored 64 to a word. Alongside element access that mirrors
+ * std::vector<bool>, it offers run queries (next/previous frame with a given
+ * state, voiced count over a range) that skip whole words at a time, so
+ * walking silence gaps or voiced runs costs one step per 64 frames.
+ *
+ * Bits past size() in the last word are kept clear.
+ */
+class VoicedMask
+{
+public:
+    /** Writable proxy for one frame, as returned by the non-const operator[]. */
+    class Reference
+    {
+    public:
+        Reference(VoicedMask& maskIn, size_t indexIn) : mask(maskIn), index(indexIn) {}
+        operator bool() const { return mask.test(index); }
+        Reference& operator=(bool value) { mask.set(index, value); return *this; }
+        Reference& operator=(const Reference& other) { return *this = static_cast<bool>(other); }
+
+    private:
+        VoicedMask& mask;
+        size_t index;
+    };
+
+    VoicedMask() = default;
+    explicit VoicedMask(size_t numFrames, bool value = false) { assign(numFrames, value); }
+    explicit VoicedMask(const std::vector<bool>& values);
+
+    size_t size() const { return numBits; }
+    bool empty() const { return numBits == 0; }
+    size_t getNumBytes() const { return words.capacity() * sizeof(uint64_t); }
+
+    void assign(size_t numFrames, bool value);
+    void resize(size_t numFrames, bool value = false);
+    void clear() { words.clear(); numBits = 0; }
+
+    bool test(size_t index) const { return (words[index >> 6] >> (index & 63)) & 1u; }
+    void set(size_t index, bool value)
+    {
+        const uint64_t bit = uint64_t(1) << (index & 63);
+        if (value)
+            words[index >> 6] |= bit;
+        else
+            words[index >> 6] &= ~bit;
+    }
+
+    bool operator[](size_t index) const { return test(index); }
+    Reference operator[](size_t index) { return Reference(*this, index); }
+
+    /** Set frames [start, end) to value. */
+    void fill(int start, int end, bool value);
+
+    /** First frame >= from whose state is value, or size() if none. */
+    int findNext(int from, bool value) const;
+
+    /** Last frame < before whose state is value, or -1 if none. */
+    int findPrev(int before, bool value) const;
+
+    /** Number of voiced frames in [start, end). */
+    int countVoiced(int start, int end) const;
+
+    /** Copy of frames [start, end). */
+    std::vector<bool> slice(int start, int end) const;
+    std::vector<bool> toVector() const { return slice(0, static_cast<int>(numBits)); }
+
+    /** Raw storage, 64 frames per word with frame 0 in bit 0 of word 0. */
+    const uint64_t* getWords() const { return words.data(); }
+    size_t getNumWords() const { return words.size(); }
+
+    /** Replace contents with numFrames bits read from packed words. */
+    void assignWords(const uint64_t* source, size_t numFrames);
+
+    bool operator==(const VoicedMask& other) const { return numBits == other.numBits && words == other.words; }
+    bool operator!=(const VoicedMask& other) const { return !(*this == other); }
+
+private:
+    void clearTail();
+
+    std::vector<uint64_t> words;
+    size_t numBits = 0;
+};